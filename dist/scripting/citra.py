@@ -16,6 +16,11 @@ class RequestType(enum.IntEnum):
     WriteMemory = 2,
     ProcessList = 3,
     SetGetProcess = 4,
+    IPCLatencies = 5,
+    BatchReadMemory = 6,
+    SubscribeMemory = 7,
+    UnsubscribeMemory = 8,
+    MemoryChanged = 9,
 
 CITRA_PORT = 45987
 
@@ -67,6 +72,34 @@ class Citra:
                 break
         return processes
 
+    def ipc_latencies(self):
+        latencies = {}
+        read_entries = 0
+        while True:
+            request_data = struct.pack("II", read_entries, 0x7FFFFFFF)
+            request, request_id = self._generate_header(RequestType.IPCLatencies, len(request_data))
+            request += request_data
+            self.socket.sendto(request, (self.address, CITRA_PORT))
+
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.IPCLatencies)
+
+            if reply_data:
+                read_count = struct.unpack("I", reply_data[0:4])[0]
+                reply_data = reply_data[4:]
+                if read_count == 0:
+                    break
+                read_entries += read_count
+                for i in range(read_count):
+                    entry_data = reply_data[i * 0x58 : (i + 1) * 0x58]
+                    service_name, command_id, calls, total_ns = struct.unpack("<8sIIQ", entry_data[:0x18])
+                    buckets = struct.unpack("<16I", entry_data[0x18:])
+                    service_name = service_name.rstrip(b"\x00").decode("ascii")
+                    latencies[(service_name, command_id)] = (calls, total_ns, buckets)
+            else:
+                break
+        return latencies
+
     def get_process(self):
         request_data = struct.pack("II", 0, 0)
         request, request_id = self._generate_header(RequestType.SetGetProcess, len(request_data))
@@ -145,6 +178,70 @@ class Citra:
                 return False
         return True
 
+    def batch_read_memory(self, ranges):
+        """
+        Reads several (address, size) ranges in a single round trip. The sizes must add up to at
+        most MAX_REQUEST_DATA_SIZE bytes.
+        >>> c.batch_read_memory([(0x100000, 4), (0x100000, 2)])
+        [b'\\x07\\x00\\x00\\xeb', b'\\x07\\x00']
+        """
+        request_data = struct.pack("I", len(ranges))
+        for address, size in ranges:
+            request_data += struct.pack("II", address, size)
+        request, request_id = self._generate_header(RequestType.BatchReadMemory, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.BatchReadMemory)
+
+        if not reply_data:
+            return None
+        result = []
+        for _, size in ranges:
+            result.append(reply_data[:size])
+            reply_data = reply_data[size:]
+        return result
+
+    def subscribe_memory(self, address, size):
+        """
+        Asks for the changed bytes of a memory range to be pushed after every frame. Use a
+        dedicated Citra instance for subscriptions, as the pushes arrive on this socket.
+        Returns the subscription id, or None when the subscription was refused.
+        """
+        request_data = struct.pack("II", address, size)
+        request, request_id = self._generate_header(RequestType.SubscribeMemory, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.SubscribeMemory)
+
+        if reply_data:
+            return struct.unpack("I", reply_data)[0]
+        else:
+            return None
+
+    def unsubscribe_memory(self, subscription_id):
+        request_data = struct.pack("II", subscription_id, 0)
+        request, request_id = self._generate_header(RequestType.UnsubscribeMemory, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        self.socket.recv(MAX_PACKET_SIZE)
+
+    def wait_memory_change(self):
+        """
+        Blocks until a subscribed range changes. Returns (subscription_id, offset, data), where
+        data holds the bytes from offset up to the last changed byte of the range.
+        """
+        while True:
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            version, subscription_id, reply_type, data_size = struct.unpack("IIII", raw_reply[:4*4])
+            if RequestType.MemoryChanged == reply_type and data_size == len(raw_reply[4*4:]):
+                offset, size = struct.unpack("II", raw_reply[4*4:6*4])
+                return (subscription_id, offset, raw_reply[6*4:6*4 + size])
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
@@ -189,6 +189,23 @@ object NativeLibrary {
      */
     external fun getPerfStats(): DoubleArray
 
+    /**
+     * Returns the frame budget in milliseconds followed by, for each recent frame, its frame time,
+     * the time of each frame stage and a stutter flag. Empty when no game is running.
+     */
+    external fun getFrameBreakdown(): FloatArray
+
+    /**
+     * Starts or stops recording a performance trace
+     */
+    external fun setTracingEnabled(enabled: Boolean)
+
+    /**
+     * Writes the recorded performance trace to the log directory as a Chrome JSON trace.
+     * Returns the path of the trace, or an empty string on failure.
+     */
+    external fun exportTrace(): String
+
     /**
      * Notifies the core emulation that the layout should be updated
      */
@@ -689,6 +706,15 @@ object NativeLibrary {
             FileUtil.getFilesName(path)
         }
 
+    @Keep
+    @JvmStatic
+    fun getDirectoryEntries(path: String): Array<String?> =
+        if (FileUtil.isNativePath(path)) {
+            CitraApplication.documentsTree.getDirectoryEntries(path)
+        } else {
+            FileUtil.getDirectoryEntries(path)
+        }
+
     @Keep
     @JvmStatic
     fun getUserDirectory(uriOverride: Uri? = null): String {
@@ -1425,6 +1425,16 @@ class SettingsFragmentPresenter(private val fragmentView: SettingsFragmentView)
                     BooleanSetting.PERF_OVERLAY_SHOW_BATTERY_TEMP.defaultValue
                 )
             )
+
+            add(
+                SwitchSetting(
+                    BooleanSetting.PERF_OVERLAY_SHOW_FRAME_BREAKDOWN,
+                    R.string.performance_overlay_show_frame_breakdown,
+                    R.string.performance_overlay_show_frame_breakdown_description,
+                    BooleanSetting.PERF_OVERLAY_SHOW_FRAME_BREAKDOWN.key,
+                    BooleanSetting.PERF_OVERLAY_SHOW_FRAME_BREAKDOWN.defaultValue
+                )
+            )
         }
     }
 
@@ -89,6 +89,8 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
 
     private lateinit var emulationState: EmulationState
     private var perfStatsUpdater: Runnable? = null
+    private var frameBreakdownUpdater: Runnable? = null
+    private var isTracing = false
 
     private lateinit var emulationActivity: EmulationActivity
 
@@ -346,6 +348,24 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
                     true
                 }
 
+                R.id.menu_record_trace -> {
+                    isTracing = !isTracing
+                    NativeLibrary.setTracingEnabled(isTracing)
+                    if (isTracing) {
+                        it.title = resources.getString(R.string.emulation_stop_trace)
+                    } else {
+                        it.title = resources.getString(R.string.emulation_record_trace)
+                        val path = NativeLibrary.exportTrace()
+                        val message = if (path.isEmpty()) {
+                            getString(R.string.emulation_trace_failed)
+                        } else {
+                            getString(R.string.emulation_trace_saved, path)
+                        }
+                        Toast.makeText(requireContext(), message, Toast.LENGTH_LONG).show()
+                    }
+                    true
+                }
+
                 R.id.menu_cheats -> {
                     val action = EmulationNavigationDirections
                         .actionGlobalCheatsActivity(NativeLibrary.getRunningTitleId())
@@ -1229,6 +1249,9 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
         if (perfStatsUpdater != null) {
             perfStatsUpdateHandler.removeCallbacks(perfStatsUpdater!!)
         }
+        if (frameBreakdownUpdater != null) {
+            perfStatsUpdateHandler.removeCallbacks(frameBreakdownUpdater!!)
+        }
 
         if (BooleanSetting.PERF_OVERLAY_ENABLE.boolean) {
             val SYSTEM_FPS = 0
@@ -1240,6 +1263,12 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
             val TIME_GPU = 6
             val TIME_SWAP = 7
             val TIME_REM = 8
+            val TEXTURE_MEMORY = 9
+            val PEAK_TEXTURE_MEMORY = 10
+            val PRESENT_LATENCY = 11
+            val AUDIO_LATENCY = 12
+            val HOST_MEMORY = 13
+            val PEAK_HOST_MEMORY = 14
             perfStatsUpdater = Runnable {
                 val sb = StringBuilder()
                 val perfStats = NativeLibrary.getPerfStats()
@@ -1262,6 +1291,22 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
                                 (perfStats[TIME_REM] * 1000.0f).toFloat(),
                             )
                         )
+                        if (perfStats[PRESENT_LATENCY] > 0) {
+                            sb.append(
+                                String.format(
+                                    " Display:\u00A0%.1fms",
+                                    (perfStats[PRESENT_LATENCY] * 1000.0f).toFloat()
+                                )
+                            )
+                        }
+                        if (perfStats[AUDIO_LATENCY] > 0) {
+                            sb.append(
+                                String.format(
+                                    " Audio:\u00A0%.1fms",
+                                    (perfStats[AUDIO_LATENCY] * 1000.0f).toFloat()
+                                )
+                            )
+                        }
                     }
 
                     if (BooleanSetting.PERF_OVERLAY_SHOW_SPEED.boolean) {
@@ -1279,6 +1324,22 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
                         val appRamUsage =
                             File("/proc/self/statm").readLines()[0].split(' ')[1].toLong() * 4096 / 1000000
                         sb.append("Process\u00A0RAM:\u00A0$appRamUsage\u00A0MB")
+                        sb.append(dividerString)
+                        sb.append(
+                            String.format(
+                                "Textures:\u00A0%d\u00A0MB (Peak:\u00A0%d\u00A0MB)",
+                                (perfStats[TEXTURE_MEMORY] / 1048576).toLong(),
+                                (perfStats[PEAK_TEXTURE_MEMORY] / 1048576).toLong()
+                            )
+                        )
+                        sb.append(dividerString)
+                        sb.append(
+                            String.format(
+                                "Accounted:\u00A0%d\u00A0MB (Peak:\u00A0%d\u00A0MB)",
+                                (perfStats[HOST_MEMORY] / 1048576).toLong(),
+                                (perfStats[PEAK_HOST_MEMORY] / 1048576).toLong()
+                            )
+                        )
                     }
 
                     if (BooleanSetting.PERF_OVERLAY_SHOW_AVAILABLE_RAM.boolean) {
@@ -1316,6 +1377,20 @@ class EmulationFragment : Fragment(), SurfaceHolder.Callback, Choreographer.Fram
         } else {
             binding.performanceOverlayShowText.visibility = View.GONE
         }
+
+        if (BooleanSetting.PERF_OVERLAY_ENABLE.boolean &&
+            BooleanSetting.PERF_OVERLAY_SHOW_FRAME_BREAKDOWN.boolean
+        ) {
+            // The graph shows individual frames, so it refreshes more often than the text
+            frameBreakdownUpdater = Runnable {
+                binding.frameBreakdown.setBreakdown(NativeLibrary.getFrameBreakdown())
+                perfStatsUpdateHandler.postDelayed(frameBreakdownUpdater!!, 100)
+            }
+            perfStatsUpdateHandler.post(frameBreakdownUpdater!!)
+            binding.frameBreakdown.visibility = View.VISIBLE
+        } else {
+            binding.frameBreakdown.visibility = View.GONE
+        }
     }
 
     private fun updateStatsPosition(position: Int) {
@@ -0,0 +1,93 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+package org.citra.citra_emu.overlay
+
+import android.content.Context
+import android.graphics.Canvas
+import android.graphics.Color
+import android.graphics.DashPathEffect
+import android.graphics.Paint
+import android.util.AttributeSet
+import android.view.View
+
+/**
+ * Draws the per-frame stage breakdown reported by [org.citra.citra_emu.NativeLibrary.getFrameBreakdown]
+ * as stacked bars, with the frame budget as a dashed line and stutters marked in red.
+ */
+class FrameBreakdownView(context: Context, attrs: AttributeSet?) : View(context, attrs) {
+    private var breakdown = FloatArray(0)
+
+    private val stagePaints = STAGE_COLORS.map { color -> Paint().apply { this.color = color } }
+    private val stutterPaint = Paint().apply { color = Color.RED }
+    private val budgetPaint = Paint().apply {
+        color = Color.WHITE
+        style = Paint.Style.STROKE
+        strokeWidth = 2f
+        pathEffect = DashPathEffect(floatArrayOf(8f, 8f), 0f)
+    }
+
+    fun setBreakdown(breakdown: FloatArray) {
+        this.breakdown = breakdown
+        invalidate()
+    }
+
+    override fun onDraw(canvas: Canvas) {
+        super.onDraw(canvas)
+        canvas.drawColor(BACKGROUND_COLOR)
+        if (breakdown.isEmpty()) {
+            return
+        }
+
+        // The scale always shows twice the budget, growing when a frame takes even longer
+        val budget = breakdown[0]
+        val frameCount = (breakdown.size - 1) / FRAME_STRIDE
+        var maxTime = budget * 2
+        for (i in 0 until frameCount) {
+            maxTime = maxOf(maxTime, breakdown[1 + i * FRAME_STRIDE])
+        }
+        val yScale = height / maxTime
+        val barWidth = width.toFloat() / HISTORY_SIZE
+
+        // Newest frames are drawn on the right
+        var x = width - barWidth * frameCount
+        for (i in 0 until frameCount) {
+            val base = 1 + i * FRAME_STRIDE
+            var y = height.toFloat()
+            for (stage in STAGE_COLORS.indices) {
+                val barHeight = breakdown[base + 1 + stage] * yScale
+                canvas.drawRect(x, y - barHeight, x + barWidth, y, stagePaints[stage])
+                y -= barHeight
+            }
+            if (breakdown[base + 1 + STAGE_COLORS.size] != 0f) {
+                canvas.drawRect(x, 0f, x + barWidth, 4f, stutterPaint)
+            }
+            x += barWidth
+        }
+
+        val budgetY = height - budget * yScale
+        canvas.drawLine(0f, budgetY, width.toFloat(), budgetY, budgetPaint)
+    }
+
+    companion object {
+        // Must match Core::PerfStats::FrameStage and FrameHistorySize
+        private val STAGE_COLORS = intArrayOf(
+            Color.rgb(70, 130, 180), // CPU
+            Color.rgb(70, 200, 70), // Kernel
+            Color.rgb(160, 220, 90), // Services
+            Color.rgb(230, 160, 40), // PICA
+            Color.rgb(200, 110, 40), // Rasterizer submit
+            Color.rgb(220, 50, 50), // Pipeline compiles
+            Color.rgb(200, 80, 200), // Texture uploads
+            Color.rgb(60, 200, 200), // Audio
+            Color.rgb(150, 150, 150) // Present
+        )
+        private const val HISTORY_SIZE = 300
+
+        // Frame time, stage times and stutter flag of each frame
+        private val FRAME_STRIDE = STAGE_COLORS.size + 2
+
+        private val BACKGROUND_COLOR = Color.argb(128, 0, 0, 0)
+    }
+}
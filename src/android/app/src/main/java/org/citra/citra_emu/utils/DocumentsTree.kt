@@ -92,6 +92,20 @@ class DocumentsTree {
         return node.getChildNames()
     }
 
+    /**
+     * Lists a directory along with the type and size of every entry using a single query.
+     */
+    @Synchronized
+    fun getDirectoryEntries(filepath: String): Array<String?> {
+        val node = resolvePath(filepath)
+        if (node == null || !node.isDirectory) {
+            return arrayOfNulls(0)
+        }
+        val documents = FileUtil.listFiles(node.uri!!)
+        if (!node.loaded) structTree(node, documents)
+        return documents.map { it.toDirectoryEntry() }.toTypedArray<String?>()
+    }
+
     @Synchronized
     fun getFileSize(filepath: String): Long {
         val node = resolvePath(filepath)
@@ -284,10 +298,13 @@ class DocumentsTree {
      * Construct current level directory tree
      *
      * @param parent parent node of this level
+     * @param documents children of parent, if they were already queried
      */
     @Synchronized
-    private fun structTree(parent: DocumentsNode) {
-        val documents = FileUtil.listFiles(parent.uri!!)
+    private fun structTree(
+        parent: DocumentsNode,
+        documents: Array<CheapDocument> = FileUtil.listFiles(parent.uri!!)
+    ) {
         for (document in documents) {
             val node = DocumentsNode(document)
             node.parent = parent
@@ -129,7 +129,8 @@ object FileUtil {
         val columns = arrayOf(
             DocumentsContract.Document.COLUMN_DOCUMENT_ID,
             DocumentsContract.Document.COLUMN_DISPLAY_NAME,
-            DocumentsContract.Document.COLUMN_MIME_TYPE
+            DocumentsContract.Document.COLUMN_MIME_TYPE,
+            DocumentsContract.Document.COLUMN_SIZE
         )
         var c: Cursor? = null
         val results: MutableList<CheapDocument> = ArrayList()
@@ -146,8 +147,10 @@ object FileUtil {
                 val documentId = c.getString(0)
                 val documentName = c.getString(1)
                 val documentMimeType = c.getString(2)
+                val documentSize = if (c.isNull(3)) 0L else c.getLong(3)
                 val documentUri = DocumentsContract.buildDocumentUriUsingTree(uri, documentId)
-                val document = CheapDocument(documentName, documentMimeType, documentUri)
+                val document =
+                    CheapDocument(documentName, documentMimeType, documentUri, documentSize)
                 results.add(document)
             }
         } catch (e: Exception) {
@@ -248,6 +251,10 @@ object FileUtil {
         return files.toTypedArray<String?>()
     }
 
+    @JvmStatic
+    fun getDirectoryEntries(path: String): Array<String?> =
+        listFiles(Uri.parse(path)).map { it.toDirectoryEntry() }.toTypedArray<String?>()
+
     /**
      * Get file size from given path.
      *
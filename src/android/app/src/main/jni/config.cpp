@@ -129,9 +129,19 @@ void Config::ReadValues() {
                                                  InputCommon::CemuhookUDP::DEFAULT_PORT));
 
     ReadSetting("Controls", Settings::values.use_artic_base_controller);
+    ReadSetting("Controls", Settings::values.input_polling_rate);
 
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
+    ReadSetting("Core", Settings::values.jit_cache_budget);
+    ReadSetting("Core", Settings::values.use_fastmem);
+    ReadSetting("Core", Settings::values.use_multicore);
+    ReadSetting("Core", Settings::values.skip_busy_waits);
+    ReadSetting("Core", Settings::values.background_savestates);
+    ReadSetting("Core", Settings::values.fast_resume);
+    ReadSetting("Core", Settings::values.savestate_compression_level);
+    ReadSetting("Core", Settings::values.rewind_interval);
+    ReadSetting("Core", Settings::values.rewind_buffer_size);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
 
     // Renderer
@@ -140,12 +150,15 @@ void Config::ReadValues() {
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", false);
     ReadSetting("Renderer", Settings::values.graphics_api);
     ReadSetting("Renderer", Settings::values.async_presentation);
+    ReadSetting("Renderer", Settings::values.present_queue_depth);
     ReadSetting("Renderer", Settings::values.async_shader_compilation);
     ReadSetting("Renderer", Settings::values.spirv_shader_gen);
     ReadSetting("Renderer", Settings::values.disable_spirv_optimizer);
     ReadSetting("Renderer", Settings::values.use_hw_shader);
     ReadSetting("Renderer", Settings::values.use_shader_jit);
     ReadSetting("Renderer", Settings::values.resolution_factor);
+    ReadSetting("Renderer", Settings::values.dynamic_resolution);
+    ReadSetting("Renderer", Settings::values.auto_frame_skip);
     ReadSetting("Renderer", Settings::values.use_disk_shader_cache);
     ReadSetting("Renderer", Settings::values.use_vsync);
     ReadSetting("Renderer", Settings::values.texture_filter);
@@ -168,6 +181,7 @@ void Config::ReadValues() {
     Settings::values.pp_shader_name =
         sdl2_config->GetString("Renderer", "pp_shader_name", default_shader);
     ReadSetting("Renderer", Settings::values.filter_mode);
+    ReadSetting("Renderer", Settings::values.spatial_upscaling);
 
     ReadSetting("Renderer", Settings::values.bg_red);
     ReadSetting("Renderer", Settings::values.bg_green);
@@ -175,6 +189,16 @@ void Config::ReadValues() {
     ReadSetting("Renderer", Settings::values.custom_second_layer_opacity);
     ReadSetting("Renderer", Settings::values.delay_game_render_thread_us);
     ReadSetting("Renderer", Settings::values.disable_right_eye_render);
+    ReadSetting("Renderer", Settings::values.async_texture_upload);
+    ReadSetting("Renderer", Settings::values.gpu_texture_decode);
+    ReadSetting("Renderer", Settings::values.accurate_mipmaps);
+    ReadSetting("Renderer", Settings::values.texture_memory_budget);
+    ReadSetting("Renderer", Settings::values.use_descriptor_buffer);
+    ReadSetting("Renderer", Settings::values.parallel_command_recording);
+    ReadSetting("Renderer", Settings::values.async_compute);
+    ReadSetting("Renderer", Settings::values.frame_pacing);
+    ReadSetting("Renderer", Settings::values.async_gpu);
+    ReadSetting("Renderer", Settings::values.merge_stereo_renders);
     ReadSetting("Renderer", Settings::values.swap_eyes_3d);
     ReadSetting("Renderer", Settings::values.render_3d_which_display);
     // Layout
@@ -225,17 +249,21 @@ void Config::ReadValues() {
 
     // Storage
     ReadSetting("Storage", Settings::values.compress_cia_installs);
+    ReadSetting("Storage", Settings::values.cache_decrypted_romfs);
 
     // Utility
     ReadSetting("Utility", Settings::values.dump_textures);
+    ReadSetting("Utility", Settings::values.fast_texture_dumping);
     ReadSetting("Utility", Settings::values.custom_textures);
     ReadSetting("Utility", Settings::values.preload_textures);
     ReadSetting("Utility", Settings::values.async_custom_loading);
+    ReadSetting("Utility", Settings::values.transcode_custom_textures);
 
     // Audio
     ReadSetting("Audio", Settings::values.audio_emulation);
     ReadSetting("Audio", Settings::values.enable_audio_stretching);
     ReadSetting("Audio", Settings::values.enable_realtime_audio);
+    ReadSetting("Audio", Settings::values.async_audio_rendering);
     ReadSetting("Audio", Settings::values.volume);
     ReadSetting("Audio", Settings::values.output_type);
     ReadSetting("Audio", Settings::values.output_device);
@@ -244,6 +272,9 @@ void Config::ReadValues() {
 
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
+    ReadSetting("Data Storage", Settings::values.z3ds_frame_cache_size);
+    ReadSetting("Data Storage", Settings::values.z3ds_compression_level);
+    ReadSetting("Data Storage", Settings::values.z3ds_long_distance_matching);
 
     // System
     ReadSetting("System", Settings::values.is_new_3ds);
@@ -88,12 +88,56 @@ udp_pad_index=
 
 # Use Artic Controller when connected to Artic Base Server. (Default 0)
 use_artic_base_controller=
+# How many times per second the input devices are polled, on a thread of their own
+# 0: Poll them on the emulation thread when the game reads the input, 500 (default)
+input_polling_rate=
 
 [Core]
 # Whether to use the Just-In-Time (JIT) compiler for CPU emulation
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Memory the CPU JIT translation caches of a core may reserve, in MiB. The caches of the least
+# recently scheduled processes are released beyond it, 0 for no limit. Defaults to 1024.
+jit_cache_budget =
+
+# Whether the JIT accesses emulated memory directly through a host mirror of the address space
+# 0: Off, 1 (default): On
+use_fastmem =
+
+# Runs each emulated CPU core on its own host thread. Requires the CPU JIT. Not supported
+# by the OpenGL renderer.
+# 0 (default): Off, 1: On
+use_multicore =
+
+# Fast-forwards to the next scheduled event when the guest spins on svcGetSystemTick.
+# 0 (default): Off, 1: On
+skip_busy_waits =
+
+# Whether save states are compressed and written on a background thread.
+# The emulation only pauses to copy the state to memory, at the cost of holding a copy of it
+# while it is written.
+# 0 (default): Off, 1: On
+background_savestates =
+
+# Saves the state when the emulation is paused or sent to the background, and resumes from it
+# the next time the game is booted unless the emulation was stopped.
+# 0 (default): Off, 1: On
+fast_resume =
+
+# Zstandard compression level of save states, higher levels are smaller but slower to write.
+# Between 1 and 22. Default: 3
+savestate_compression_level =
+
+# Number of frames between the snapshots kept to rewind the emulation.
+# 0 (default): Rewind disabled
+rewind_interval =
+
+# Memory budget for the rewind snapshots, in MiB. The oldest snapshots are merged away
+# when it is exceeded.
+# Default: 256
+rewind_buffer_size =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance of the game at the risk of freezing.
 # Overclocking may fix lag that happens on console, but also comes with the risk of freezing.
@@ -109,7 +153,7 @@ graphics_api =
 # 0: Off, 1: On (default)
 async_shader_compilation =
 
-# Whether to emit PICA fragment shader using SPIRV or GLSL (Vulkan only)
+# Whether to emit PICA fragment and vertex shaders using SPIRV or GLSL (Vulkan only)
 # 0: GLSL, 1: SPIR-V (default)
 spirv_shader_gen =
 
@@ -139,6 +183,11 @@ texture_sampling =
 # 0 (default): Off, 1: On
 use_vsync =
 
+# Number of rendered frames that can wait for presentation when async presentation is enabled.
+# When the queue is full the oldest frame is dropped, so emulation does not wait for the display.
+# 0 (default): Never drop frames, 1: Lowest latency, 2-3: Smoothest
+present_queue_depth =
+
 # Reduce stuttering by storing and loading generated shaders to disk
 # 0: Off, 1 (default. On)
 use_disk_shader_cache =
@@ -148,6 +197,16 @@ use_disk_shader_cache =
 # factor for the 3DS resolution
 resolution_factor =
 
+# Lowers the resolution scale while the GPU can not keep up with the frame rate, and raises it
+# back up to resolution_factor once it can. Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+dynamic_resolution =
+
+# Skips the draws of the frame after one that ran slower than the speed limit, except for those
+# into surfaces that are later read. Skipped frames show the previous image.
+# 0 (default): Off, 1: On
+auto_frame_skip =
+
 # Turns on the frame limiter, which will limit frames output to the target game speed
 # 0: Off, 1: On (default)
 use_frame_limit =
@@ -200,6 +259,12 @@ anaglyph_shader_name =
 # 0: Nearest, 1 (default): Linear
 filter_mode =
 
+# Upscales the screens to the window with an edge adaptive filter (based on AMD FSR 1) instead
+# of bilinear filtering, so that a lower resolution factor still looks sharp.
+# Not used with stereoscopic 3D or a post processing shader.
+# 0 (default): Off, 1: On
+spatial_upscaling =
+
 # Delays the game render thread by the specified amount of microseconds
 # Set to 0 for no delay, only useful in dynamic-fps games to simulate GPU delay.
 delay_game_render_thread_us =
@@ -209,6 +274,57 @@ delay_game_render_thread_us =
 # 0 (default): Enable right eye rendering, 1: Disable right eye rendering
 disable_right_eye_render =
 
+# Splits the decoding of large tiled textures across worker threads.
+# Speeds up texture uploads on multi-core CPUs.
+# 0 (default): Off, 1: On
+async_texture_upload =
+
+# Converts guest textures to and from their tiled layout with compute shaders when
+# uploading and downloading them, instead of on the CPU.
+# Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+gpu_texture_decode =
+
+# Uploads every mip level of guest textures. When off, textures whose mip levels were found to
+# be box filtered from the base level get them generated on the GPU instead of decoded.
+# 0: Off, 1 (default): On
+accurate_mipmaps =
+
+# Limits the host memory used by cached textures, in MiB. When the limit is exceeded the
+# least recently used textures are written back to emulated memory and evicted.
+# 0 (default): Unlimited, otherwise the budget in MiB
+texture_memory_budget =
+
+# Writes the rasterizer descriptors straight into a descriptor buffer when the GPU supports it.
+# Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+use_descriptor_buffer =
+
+# Records render passes into secondary command buffers from several threads.
+# Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+parallel_command_recording =
+
+# Runs GPU texture decoding on a compute queue of its own next to the graphics queue, when the GPU
+# has one. Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+async_compute =
+
+# Schedules presents on whole display refresh cycles when vsync is on, using the display timing
+# reported by the driver. Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+frame_pacing =
+
+# Processes GPU commands on a dedicated thread, overlapping them with CPU emulation.
+# Only supported by the Vulkan renderer.
+# 0 (default): Off, 1: On
+async_gpu =
+
+# Copies the render of the left eye to the right eye when both eyes submit the same commands
+# for separate render targets, instead of drawing the frame twice. Only used with stereo output.
+# 0 (default): Off, 1: On
+merge_stereo_renders =
+
 [Layout]
 # Layout for the screen inside the render window, landscape mode
 # 0: Original (screens vertically aligned)
@@ -224,6 +340,11 @@ layout_option =
 # 0 (default): Do not compress, 1: Compress
 compress_cia_installs =
 
+# Whether to keep a decrypted copy of the RomFS of titles installed with console unique crypto, so
+# that reading them needs no decryption. The copy is written in the background on first boot.
+# 0 (default): No, 1: Yes
+cache_decrypted_romfs =
+
 # Position of the performance overlay
 # 0: Top Left
 # 1: Center Top
@@ -319,6 +440,11 @@ cardboard_y_shift =
 # 0 (default): Off, 1: On
 dump_textures =
 
+# Saves dumped textures with fast png compression, which keeps games playable while dumping.
+# The files are larger and can be recompressed by an external tool later.
+# 0: Off, 1 (default): On
+fast_texture_dumping =
+
 # Reads PNG files from load/textures/[Title ID]/ and replaces textures.
 # 0 (default): Off, 1: On
 custom_textures =
@@ -331,6 +457,10 @@ preload_textures =
 # 0: Off, 1 (default): On
 async_custom_loading =
 
+# Transcodes decoded custom textures to ETC2 and caches them on disk, when the GPU supports it.
+# 0 (default): Off, 1: On
+transcode_custom_textures =
+
 [Audio]
 # Whether or not to enable DSP LLE
 # 0 (default): No, 1: Yes
@@ -350,12 +480,17 @@ enable_audio_stretching =
 # 0 (default): No, 1: Yes
 enable_realtime_audio =
 
+# Whether HLE audio frames are rendered on a separate thread. The DSP status the application
+# reads then lags by one audio frame, which stays deterministic.
+# 0 (default): Off, 1: On
+async_audio_rendering =
+
 # Output volume.
 # 1.0 (default): 100%, 0.0; mute
 volume =
 
 # Which audio output type to use.
-# 0 (default): Auto-select, 1: No audio output, 2: Cubeb (if available), 3: OpenAL (if available), 4: SDL2 (if available)
+# 0 (default): Auto-select, 1: No audio output, 2: Cubeb (if available), 3: OpenAL (if available), 4: SDL2 (if available), 5: AAudio (if available)
 output_type =
 
 # Which audio output device to use.
@@ -375,6 +510,19 @@ input_device =
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Memory in MiB used to keep decompressed frames of compressed (.zcci, .zcxi) games and to
+# decompress the following frames ahead of sequential reads. 0: Decompress on every read
+# 32 (default)
+z3ds_frame_cache_size =
+
+# zstd compression level used when compressing games, higher levels are slower but smaller
+# 1 - 22, 3 (default)
+z3ds_compression_level =
+
+# Whether to look for repeated data far apart when compressing games, which mostly helps CIAs
+# 0 (default): No, 1: Yes
+z3ds_long_distance_matching =
+
 [System]
 # The system model that Citra will try to emulate
 # 0: Old 3DS (default), 1: New 3DS
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <codecvt>
+#include <ctime>
 #include <thread>
 #include <dlfcn.h>
 
@@ -34,6 +35,7 @@
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "common/string_util.h"
+#include "common/tracing.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
 #include "core/frontend/applets/default_applets.h"
@@ -103,6 +105,64 @@ std::condition_variable running_cv;
 
 std::string inserted_cartridge;
 
+/**
+ * Listens to the thermal status of the device, so that the resolution can be lowered before the
+ * device starts throttling the clocks. The NDK thermal API needs Android 11 and is loaded at
+ * runtime.
+ */
+class ThermalMonitor {
+public:
+    ThermalMonitor() {
+        if (!library.Load("libandroid.so")) {
+            return;
+        }
+        const auto acquire_manager = library.GetSymbol<void* (*)()>("AThermal_acquireManager");
+        release_manager = library.GetSymbol<void (*)(void*)>("AThermal_releaseManager");
+        const auto register_listener = library.GetSymbol<int (*)(void*, Listener, void*)>(
+            "AThermal_registerThermalStatusListener");
+        unregister_listener = library.GetSymbol<int (*)(void*, Listener, void*)>(
+            "AThermal_unregisterThermalStatusListener");
+        if (!acquire_manager || !release_manager || !register_listener || !unregister_listener) {
+            return;
+        }
+        manager = acquire_manager();
+        if (manager && register_listener(manager, &OnStatusChanged, this) != 0) {
+            release_manager(manager);
+            manager = nullptr;
+        }
+    }
+
+    ~ThermalMonitor() {
+        if (manager) {
+            unregister_listener(manager, &OnStatusChanged, this);
+            release_manager(manager);
+        }
+    }
+
+    /// Returns the throttle level for RendererBase::SetThermalThrottleLevel
+    u32 GetThrottleLevel() const {
+        return throttle_level.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Listener = void (*)(void*, int);
+
+    static void OnStatusChanged(void* data, int status) {
+        // Light, moderate and severe or worse map to the levels 1 to 3
+        const u32 level = static_cast<u32>(std::clamp(status, 0, 3));
+        auto* monitor = static_cast<ThermalMonitor*>(data);
+        if (monitor->throttle_level.exchange(level) != level) {
+            LOG_INFO(Frontend, "Thermal status {}, resolution throttle level {}", status, level);
+        }
+    }
+
+    Common::DynamicLibrary library;
+    void (*release_manager)(void*) = nullptr;
+    int (*unregister_listener)(void*, Listener, void*) = nullptr;
+    void* manager = nullptr;
+    std::atomic<u32> throttle_level = 0;
+};
+
 } // Anonymous namespace
 
 static jobject ToJavaCoreError(Core::System::ResultStatus result) {
@@ -277,11 +337,19 @@ static Core::System::ResultStatus RunCitra(const std::string& filepath) {
 
     LoadDiskCacheProgress(VideoCore::LoadCallbackStage::Complete, 0, 0);
 
+    if (Settings::values.fast_resume) {
+        system.LoadResumeState();
+    }
+
     SCOPE_EXIT({ TryShutdown(); });
 
     // Start running emulation
+    const ThermalMonitor thermal_monitor;
+    bool resume_state_saved = false;
     while (!stop_run) {
         if (!pause_emulation) {
+            resume_state_saved = false;
+            system.GPU().Renderer().SetThermalThrottleLevel(thermal_monitor.GetThrottleLevel());
             const auto result = system.RunLoop();
             if (result == Core::System::ResultStatus::Success) {
                 continue;
@@ -307,6 +375,11 @@ static Core::System::ResultStatus RunCitra(const std::string& filepath) {
                 }
             }
         } else {
+            // The process may be killed while the activity is in the background
+            if (Settings::values.fast_resume && !resume_state_saved) {
+                resume_state_saved = system.SaveResumeState();
+            }
+
             // Ensure no audio bleeds out while game is paused
             const float volume = Settings::values.volume.GetValue();
             SCOPE_EXIT({ Settings::values.volume = volume; });
@@ -318,6 +391,11 @@ static Core::System::ResultStatus RunCitra(const std::string& filepath) {
         }
     }
 
+    // Stopping the emulation on purpose boots the game from scratch the next time
+    if (Settings::values.fast_resume) {
+        Core::DeleteResumeState(program_id, system.Movie().GetCurrentMovieID());
+    }
+
     return Core::System::ResultStatus::Success;
 }
 
@@ -575,9 +653,13 @@ jint Java_org_citra_citra_1emu_NativeLibrary_compressFileNative(JNIEnv* env, job
                                   static_cast<jlong>(processed));
     };
 
+    const FileUtil::Z3DSCompressionOptions options{
+        .level = static_cast<int>(Settings::values.z3ds_compression_level.GetValue()),
+        .long_distance_matching = Settings::values.z3ds_long_distance_matching.GetValue(),
+    };
     bool success =
         FileUtil::CompressZ3DSFile(input_path, output_path, compress_info.underlying_magic,
-                                   frame_size, progress, compress_info.default_metadata);
+                                   frame_size, progress, compress_info.default_metadata, options);
     if (!success) {
         FileUtil::Delete(output_path);
         return static_cast<jint>(CompressionStatus::Compress_Failed);
@@ -923,24 +1005,77 @@ void Java_org_citra_citra_1emu_NativeLibrary_reloadSettings([[maybe_unused]] JNI
 jdoubleArray Java_org_citra_citra_1emu_NativeLibrary_getPerfStats(JNIEnv* env,
                                                                   [[maybe_unused]] jobject obj) {
     auto& core = Core::System::GetInstance();
-    jdoubleArray j_stats = env->NewDoubleArray(9);
+    jdoubleArray j_stats = env->NewDoubleArray(15);
 
     if (core.IsPoweredOn()) {
         auto results = core.GetAndResetPerfStats();
 
         // Converting the structure into an array makes it easier to pass it to the frontend
-        double stats[9] = {results.system_fps,      results.game_fps,
-                           results.emulation_speed, results.time_vblank_interval,
-                           results.time_hle_svc,    results.time_hle_ipc,
-                           results.time_gpu,        results.time_swap,
-                           results.time_remaining};
-
-        env->SetDoubleArrayRegion(j_stats, 0, 9, stats);
+        double stats[15] = {results.system_fps,
+                            results.game_fps,
+                            results.emulation_speed,
+                            results.time_vblank_interval,
+                            results.time_hle_svc,
+                            results.time_hle_ipc,
+                            results.time_gpu,
+                            results.time_swap,
+                            results.time_remaining,
+                            static_cast<double>(results.texture_memory),
+                            static_cast<double>(results.peak_texture_memory),
+                            results.present_latency,
+                            results.audio_latency,
+                            static_cast<double>(results.host_memory.TotalCurrent()),
+                            static_cast<double>(results.peak_host_memory)};
+
+        env->SetDoubleArrayRegion(j_stats, 0, 15, stats);
     }
 
     return j_stats;
 }
 
+jfloatArray Java_org_citra_citra_1emu_NativeLibrary_getFrameBreakdown(JNIEnv* env,
+                                                                     [[maybe_unused]] jobject obj) {
+    auto& core = Core::System::GetInstance();
+    if (!core.IsPoweredOn() || !core.perf_stats) {
+        return env->NewFloatArray(0);
+    }
+
+    // Budget, then frame time, stage times and stutter flag of each frame
+    using Core::PerfStats;
+    constexpr std::size_t FrameStride = PerfStats::FrameStageCount + 2;
+    const auto frames = core.perf_stats->GetFrameHistory();
+    std::vector<jfloat> breakdown;
+    breakdown.reserve(1 + frames.size() * FrameStride);
+    breakdown.push_back(static_cast<jfloat>(PerfStats::GetFrameBudget()));
+    for (const auto& frame : frames) {
+        breakdown.push_back(frame.frame_time);
+        breakdown.insert(breakdown.end(), frame.stages.begin(), frame.stages.end());
+        breakdown.push_back(frame.stutter ? 1.0f : 0.0f);
+    }
+
+    jfloatArray j_breakdown = env->NewFloatArray(static_cast<jsize>(breakdown.size()));
+    env->SetFloatArrayRegion(j_breakdown, 0, static_cast<jsize>(breakdown.size()),
+                             breakdown.data());
+    return j_breakdown;
+}
+
+void Java_org_citra_citra_1emu_NativeLibrary_setTracingEnabled([[maybe_unused]] JNIEnv* env,
+                                                               [[maybe_unused]] jobject obj,
+                                                               jboolean enabled) {
+    Common::Tracing::SetEnabled(enabled);
+}
+
+jstring Java_org_citra_citra_1emu_NativeLibrary_exportTrace(JNIEnv* env,
+                                                            [[maybe_unused]] jobject obj) {
+    const std::string path = fmt::format("{}trace_{}.json",
+                                         FileUtil::GetUserPath(FileUtil::UserPath::LogDir),
+                                         std::time(nullptr));
+    if (!Common::Tracing::ExportChromeTrace(path)) {
+        return ToJString(env, "");
+    }
+    return ToJString(env, path);
+}
+
 void Java_org_citra_citra_1emu_NativeLibrary_run__Ljava_lang_String_2(JNIEnv* env,
                                                                       [[maybe_unused]] jobject obj,
                                                                       jstring j_path) {
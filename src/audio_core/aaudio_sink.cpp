@@ -0,0 +1,207 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <aaudio/AAudio.h>
+#include "audio_core/aaudio_sink.h"
+#include "audio_core/audio_types.h"
+#include "common/cpu_affinity.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+struct AAudioSink::Impl {
+    /// Guards the stream against being reopened while it is queried.
+    mutable std::mutex stream_mutex;
+    AAudioStream* stream = nullptr;
+    unsigned int sample_rate = native_sample_rate;
+
+    s32 frames_per_burst = 0;
+    s32 buffer_capacity = 0;
+    s32 xrun_count = 0;
+
+    std::thread restart_thread;
+    std::atomic<bool> restarting = false;
+
+    std::function<void(s16*, std::size_t)> cb;
+
+    bool Open();
+    void Close();
+
+    /// Grows the buffer by one burst when the stream reports new underruns.
+    static void AdaptBufferSize(AAudioStream* stream, Impl* impl);
+
+    static aaudio_data_callback_result_t DataCallback(AAudioStream* stream, void* user_data,
+                                                      void* audio_data, s32 num_frames);
+    static void ErrorCallback(AAudioStream* stream, void* user_data, aaudio_result_t error);
+};
+
+bool AAudioSink::Impl::Open() {
+    AAudioStreamBuilder* builder = nullptr;
+    aaudio_result_t result = AAudio_createStreamBuilder(&builder);
+    if (result != AAUDIO_OK) {
+        LOG_CRITICAL(Audio_Sink, "AAudio_createStreamBuilder failed with: {}",
+                     AAudio_convertResultToText(result));
+        return false;
+    }
+
+    AAudioStreamBuilder_setDirection(builder, AAUDIO_DIRECTION_OUTPUT);
+    AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+    AAudioStreamBuilder_setChannelCount(builder, 2);
+    AAudioStreamBuilder_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    AAudioStreamBuilder_setSharingMode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+    // Samples are passed through untouched unless they are being stretched, so AAudio has to
+    // convert them to the rate of the device.
+    AAudioStreamBuilder_setSampleRate(builder, static_cast<s32>(native_sample_rate));
+    AAudioStreamBuilder_setDataCallback(builder, &DataCallback, this);
+    AAudioStreamBuilder_setErrorCallback(builder, &ErrorCallback, this);
+
+    result = AAudioStreamBuilder_openStream(builder, &stream);
+    AAudioStreamBuilder_delete(builder);
+    if (result != AAUDIO_OK) {
+        LOG_CRITICAL(Audio_Sink, "AAudioStreamBuilder_openStream failed with: {}",
+                     AAudio_convertResultToText(result));
+        stream = nullptr;
+        return false;
+    }
+
+    sample_rate = static_cast<unsigned int>(AAudioStream_getSampleRate(stream));
+    frames_per_burst = AAudioStream_getFramesPerBurst(stream);
+    buffer_capacity = AAudioStream_getBufferCapacityInFrames(stream);
+    xrun_count = AAudioStream_getXRunCount(stream);
+    AAudioStream_setBufferSizeInFrames(stream, 2 * frames_per_burst);
+
+    LOG_INFO(Audio_Sink, "Opened AAudio stream at {} Hz, {} frames per burst, {} sharing",
+             sample_rate, frames_per_burst,
+             AAudioStream_getSharingMode(stream) == AAUDIO_SHARING_MODE_EXCLUSIVE ? "exclusive"
+                                                                                 : "shared");
+
+    result = AAudioStream_requestStart(stream);
+    if (result != AAUDIO_OK) {
+        LOG_CRITICAL(Audio_Sink, "AAudioStream_requestStart failed with: {}",
+                     AAudio_convertResultToText(result));
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AAudioSink::Impl::Close() {
+    if (!stream) {
+        return;
+    }
+    AAudioStream_requestStop(stream);
+    AAudioStream_close(stream);
+    stream = nullptr;
+}
+
+void AAudioSink::Impl::AdaptBufferSize(AAudioStream* stream, Impl* impl) {
+    const s32 xruns = AAudioStream_getXRunCount(stream);
+    if (xruns <= impl->xrun_count) {
+        return;
+    }
+    impl->xrun_count = xruns;
+
+    const s32 buffer_size = AAudioStream_getBufferSizeInFrames(stream);
+    if (buffer_size + impl->frames_per_burst <= impl->buffer_capacity) {
+        AAudioStream_setBufferSizeInFrames(stream, buffer_size + impl->frames_per_burst);
+    }
+}
+
+aaudio_data_callback_result_t AAudioSink::Impl::DataCallback(AAudioStream* stream,
+                                                             void* user_data, void* audio_data,
+                                                             s32 num_frames) {
+    auto* impl = static_cast<Impl*>(user_data);
+    auto* buffer = static_cast<s16*>(audio_data);
+
+    // Underruns are as noticeable as dropped frames, so audio is clocked with the emulation
+    Common::JoinPerformanceHintSession();
+    AdaptBufferSize(stream, impl);
+
+    if (impl->cb) {
+        impl->cb(buffer, static_cast<std::size_t>(num_frames));
+    } else {
+        std::memset(buffer, 0, static_cast<std::size_t>(num_frames) * 2 * sizeof(s16));
+    }
+
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void AAudioSink::Impl::ErrorCallback(AAudioStream*, void* user_data, aaudio_result_t error) {
+    auto* impl = static_cast<Impl*>(user_data);
+    LOG_WARNING(Audio_Sink, "AAudio stream error: {}", AAudio_convertResultToText(error));
+    if (error != AAUDIO_ERROR_DISCONNECTED || impl->restarting.exchange(true)) {
+        return;
+    }
+
+    // The stream must not be closed from its own callback, so it is reopened on another thread.
+    if (impl->restart_thread.joinable()) {
+        impl->restart_thread.join();
+    }
+    impl->restart_thread = std::thread([impl] {
+        {
+            std::scoped_lock lock{impl->stream_mutex};
+            impl->Close();
+            impl->Open();
+        }
+        impl->restarting = false;
+    });
+}
+
+AAudioSink::AAudioSink(std::string_view) : impl(std::make_unique<Impl>()) {
+    std::scoped_lock lock{impl->stream_mutex};
+    impl->Open();
+}
+
+AAudioSink::~AAudioSink() {
+    if (impl->restart_thread.joinable()) {
+        impl->restart_thread.join();
+    }
+    std::scoped_lock lock{impl->stream_mutex};
+    impl->Close();
+}
+
+unsigned int AAudioSink::GetNativeSampleRate() const {
+    return impl->sample_rate;
+}
+
+void AAudioSink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
+    impl->cb = cb;
+}
+
+std::chrono::nanoseconds AAudioSink::GetOutputLatency() const {
+    std::scoped_lock lock{impl->stream_mutex};
+    if (!impl->stream) {
+        return {};
+    }
+
+    // The timestamp gives the time at which a past frame was presented. The last frame written
+    // is presented after the frames between the two.
+    s64 presented_frame = 0;
+    s64 presented_time = 0;
+    if (AAudioStream_getTimestamp(impl->stream, CLOCK_MONOTONIC, &presented_frame,
+                                  &presented_time) != AAUDIO_OK) {
+        return {};
+    }
+    const s64 written_frame = AAudioStream_getFramesWritten(impl->stream);
+    const s64 written_time =
+        presented_time + (written_frame - presented_frame) * 1'000'000'000 / impl->sample_rate;
+
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const s64 now_ns = static_cast<s64>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+    return std::chrono::nanoseconds{std::max<s64>(written_time - now_ns, 0)};
+}
+
+std::vector<std::string> ListAAudioSinkDevices() {
+    // Output devices are routed by the system, AAudio only exposes them through Java.
+    return {auto_device_name};
+}
+
+} // namespace AudioCore
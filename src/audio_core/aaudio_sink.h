@@ -0,0 +1,39 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Android output through an AAudio stream in low latency mode, which is reopened when the device
+ * is disconnected. The stream buffer starts at two bursts and grows by one burst whenever an
+ * underrun is reported.
+ */
+class AAudioSink final : public Sink {
+public:
+    explicit AAudioSink(std::string_view device_id);
+    ~AAudioSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void SetCallback(std::function<void(s16*, std::size_t)> cb) override;
+
+    std::chrono::nanoseconds GetOutputLatency() const override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+std::vector<std::string> ListAAudioSinkDevices();
+
+} // namespace AudioCore
@@ -14,7 +14,8 @@
 
 namespace AudioCore {
 
-DspInterface::DspInterface(Core::System& system_) : system(system_) {}
+DspInterface::DspInterface(Core::System& system_)
+    : system(system_), fifo_accounting{Common::MemoryAccounting::Category::Audio, sizeof(fifo)} {}
 
 DspInterface::~DspInterface() = default;
 
@@ -37,12 +38,40 @@ void DspInterface::EnableStretching(bool enable) {
     enable_time_stretching = enable;
 }
 
+std::chrono::nanoseconds DspInterface::GetOutputLatency() const {
+    if (!sink) {
+        return {};
+    }
+    const auto queued = std::chrono::nanoseconds{fifo.Size() * 1'000'000'000 / native_sample_rate};
+    return queued + sink->GetOutputLatency();
+}
+
+Core::PerfStats::AudioTimes DspInterface::GetAndResetStageTimes() {
+    const auto take = [this](AudioStage stage) {
+        return Core::PerfStats::Clock::duration{
+            stage_times[static_cast<std::size_t>(stage)].exchange(0, std::memory_order_relaxed)};
+    };
+    return {
+        .source_decode = take(AudioStage::SourceDecode),
+        .mixing = take(AudioStage::Mixing),
+        .time_stretch = take(AudioStage::TimeStretch),
+        .sink_enqueue = take(AudioStage::SinkEnqueue),
+    };
+}
+
+void DspInterface::AddStageTime(AudioStage stage, Core::PerfStats::Clock::duration time) {
+    stage_times[static_cast<std::size_t>(stage)].fetch_add(time.count(),
+                                                           std::memory_order_relaxed);
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink) {
         return;
     }
 
+    const auto enqueue_start = Core::PerfStats::Clock::now();
     fifo.Push(frame.data(), frame.size());
+    AddStageTime(AudioStage::SinkEnqueue, Core::PerfStats::Clock::now() - enqueue_start);
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -71,8 +100,12 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         // If we just stopped stretching, flush the stretcher before returning to normal output.
         flushing_time_stretcher = true;
     }
+    if (should_stretch && !performing_time_stretching) {
+        drift_corrector.Clear();
+    }
     performing_time_stretching = should_stretch;
 
+    const auto stretch_start = Core::PerfStats::Clock::now();
     std::size_t frames_written = 0;
     if (performing_time_stretching) {
         const std::vector<s16, Common::AlignedAllocator<s16>> in =
@@ -89,8 +122,15 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
             // so that they do not bleed into the next time the stretcher is enabled.
             time_stretcher.Clear();
         }
-        frames_written += fifo.Pop(buffer, num_frames - frames_written);
+        // At full speed only the drift between the emulated and host clocks is left to correct,
+        // which the drift corrector handles at a fraction of the cost of the time stretcher.
+        const std::vector<s16, Common::AlignedAllocator<s16>> in =
+            fifo.Pop<Common::AlignedAllocator<s16>>();
+        frames_written += drift_corrector.Process(in.data(), in.size() / 2,
+                                                  buffer + 2 * frames_written,
+                                                  num_frames - frames_written);
     }
+    AddStageTime(AudioStage::TimeStretch, Core::PerfStats::Clock::now() - stretch_start);
 
     if (frames_written > 0) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
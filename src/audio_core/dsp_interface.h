@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <span>
 #include <boost/serialization/access.hpp>
 #include "audio_core/audio_types.h"
 #include "audio_core/time_stretch.h"
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "common/ring_buffer.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 
 namespace Core {
 class System;
@@ -26,6 +29,15 @@ namespace AudioCore {
 class Sink;
 enum class SinkType : u32;
 
+/// Stages of the audio pipeline whose host time is reported to the performance statistics.
+enum class AudioStage : u32 {
+    SourceDecode,
+    Mixing,
+    TimeStretch,
+    SinkEnqueue,
+    Count,
+};
+
 class DspInterface {
 public:
     DspInterface(Core::System& system_);
@@ -102,10 +114,17 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /// Time between a frame being output and it being played, including the samples queued for
+    /// the sink.
+    std::chrono::nanoseconds GetOutputLatency() const;
+    /// Returns the host time spent in each stage of the audio pipeline since the previous call.
+    Core::PerfStats::AudioTimes GetAndResetStageTimes();
 
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
+    /// Adds to the host time spent in a stage. May be called from any thread.
+    void AddStageTime(AudioStage stage, Core::PerfStats::Clock::duration time);
 
 private:
     void FlushResidualStretcherAudio();
@@ -117,9 +136,13 @@ private:
     std::atomic<bool> performing_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
     Common::RingBuffer<s16, 0x2000, 2> fifo;
+    Common::MemoryAccounting::Allocation fifo_accounting;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
+    DriftCorrector drift_corrector;
     std::unique_ptr<Sink> sink;
+    static constexpr std::size_t NumAudioStages = static_cast<std::size_t>(AudioStage::Count);
+    std::array<std::atomic<Core::PerfStats::Clock::rep>, NumAudioStages> stage_times{};
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {}
@@ -2,8 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <neaacdec.h>
-#include "common/aligned_allocator.h"
 #include "audio_core/hle/aac_decoder.h"
 
 namespace AudioCore::HLE {
@@ -110,7 +111,10 @@ BinaryMessage AACDecoder::Decode(const BinaryMessage& request) {
         data_len -= init_result;
     }
 
-    std::array<std::vector<s16, Common::AlignedAllocator<s16>>, 2> out_streams;
+    // The channels are written straight into the FCRAM as each frame is decoded.
+    const std::array<PAddr, 2> dst_addrs{request.decode_aac_request.dst_addr_ch0,
+                                         request.decode_aac_request.dst_addr_ch1};
+    u32 num_samples_written = 0;
 
     while (data_len > 0) {
         NeAACDecFrameInfo frame_info;
@@ -126,36 +130,30 @@ BinaryMessage AACDecoder::Decode(const BinaryMessage& request) {
         response.decode_aac_response.num_channels = frame_info.channels;
 
         // Split the decode result into channels.
-        u32 num_samples = frame_info.samples / frame_info.channels;
-        for (u32 sample = 0; sample < num_samples; sample++) {
-            for (u32 ch = 0; ch < frame_info.channels; ch++) {
-                out_streams[ch].push_back(curr_sample_buffer[(sample * frame_info.channels) + ch]);
+        const u32 num_channels = std::min<u32>(frame_info.channels, 2);
+        const u32 num_samples = frame_info.samples / frame_info.channels;
+        for (u32 ch = 0; ch < num_channels; ch++) {
+            const PAddr dst = dst_addrs[ch] + num_samples_written * sizeof(s16);
+            if (dst < Memory::FCRAM_PADDR ||
+                dst + num_samples * sizeof(s16) > Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
+                LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch{} {:08x}", ch, dst_addrs[ch]);
+                return response;
+            }
+
+            u8* const out = memory.GetFCRAMPointer(dst - Memory::FCRAM_PADDR);
+            for (u32 sample = 0; sample < num_samples; sample++) {
+                const s16 value = curr_sample_buffer[(sample * frame_info.channels) + ch];
+                std::memcpy(out + sample * sizeof(s16), &value, sizeof(s16));
             }
         }
+        num_samples_written += num_samples;
 
         data += frame_info.bytesconsumed;
         data_len -= frame_info.bytesconsumed;
     }
 
-    // Transfer the decoded buffer from vector to the FCRAM.
-    for (std::size_t ch = 0; ch < out_streams.size(); ch++) {
-        if (out_streams[ch].empty()) {
-            continue;
-        }
-        auto byte_size = out_streams[ch].size() * sizeof(s16);
-        auto dst = ch == 0 ? request.decode_aac_request.dst_addr_ch0
-                           : request.decode_aac_request.dst_addr_ch1;
-        if (dst < Memory::FCRAM_PADDR ||
-            dst + byte_size > Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
-            LOG_ERROR(Audio_DSP, "Got out of bounds dst_addr_ch{} {:08x}", ch, dst);
-            return response;
-        }
-        std::memcpy(memory.GetFCRAMPointer(dst - Memory::FCRAM_PADDR), out_streams[ch].data(),
-                    byte_size);
-    }
-
     // Set the output frame info.
-    response.decode_aac_response.num_samples = static_cast<u32_le>(out_streams[0].size());
+    response.decode_aac_response.num_samples = static_cast<u32_le>(num_samples_written);
 
     return response;
 }
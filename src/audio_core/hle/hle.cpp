@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -25,6 +26,7 @@
 #include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -64,6 +66,9 @@ public:
     void SetInterruptHandler(
         std::function<void(Service::DSP::InterruptType type, DspPipe pipe)> handler);
 
+    /// Waits for the frame being rendered on the audio worker, if any, to be complete.
+    void WaitForPendingFrame();
+
 private:
     void Initialize();
     void Sleep();
@@ -77,7 +82,14 @@ private:
     HLE::SharedMemory& ReadRegion();
     HLE::SharedMemory& WriteRegion();
 
+    StereoFrame16 GenerateFrame(HLE::SharedMemory& read, HLE::SharedMemory& write);
     StereoFrame16 GenerateCurrentFrame();
+
+    /// Copies the shared memory regions of the current frame and renders it on the audio worker.
+    void StartPendingFrame();
+    /// Writes back the status and samples of the frame rendered on the audio worker, if any.
+    void FinishPendingFrame();
+
     bool Tick();
     void AudioTickCallback(s64 cycles_late);
 
@@ -107,8 +119,21 @@ private:
 
     std::function<void(Service::DSP::InterruptType type, DspPipe pipe)> interrupt_handler{};
 
+    /// A frame rendered on the audio worker, whose results are written back on the next tick.
+    struct PendingFrame {
+        HLE::SharedMemory read;
+        HLE::SharedMemory write;
+        std::size_t write_region_index;
+        StereoFrame16 output;
+    };
+    std::unique_ptr<PendingFrame> pending_frame{};
+    bool frame_pending = false;
+    std::unique_ptr<Common::ThreadWorker> render_worker{};
+
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
+    void serialize(Archive& ar, const unsigned int file_version) {
+        // The worker must not touch the sources while they are saved or replaced.
+        WaitForPendingFrame();
         ar& boost::serialization::make_binary_object(backup_dsp_memory.raw_memory.data(),
                                                      backup_dsp_memory.raw_memory.size());
         ar & dsp_state;
@@ -116,6 +141,20 @@ private:
         ar & sources;
         ar & mixers;
         // interrupt_handler is reregistered when loading state from DSP_DSP
+        if (file_version >= 1) {
+            ar & frame_pending;
+        } else {
+            frame_pending = false;
+        }
+        if (frame_pending) {
+            if (!pending_frame) {
+                pending_frame = std::make_unique<PendingFrame>();
+            }
+            ar& boost::serialization::make_binary_object(&pending_frame->write,
+                                                         sizeof(pending_frame->write));
+            ar & pending_frame->write_region_index;
+            ar & pending_frame->output;
+        }
     }
     friend class boost::serialization::access;
 };
@@ -138,6 +177,7 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory, Core::Timing&
 }
 
 DspHle::Impl::~Impl() {
+    WaitForPendingFrame();
     core_timing.UnscheduleEvent(tick_event, 0);
 }
 
@@ -219,6 +259,9 @@ void DspHle::Impl::PipeWrite(DspPipe pipe_number, std::span<const u8> buffer) {
             return;
         }
 
+        // State changes reset or back up the sources and the shared memory.
+        FinishPendingFrame();
+
         enum class StateChange {
             Initialize = 0,
             Shutdown = 1,
@@ -411,24 +454,33 @@ HLE::SharedMemory& DspHle::Impl::WriteRegion() {
     return CurrentRegionIndex() != 0 ? dsp_memory->region_0 : dsp_memory->region_1;
 }
 
-StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
-    HLE::SharedMemory& read = ReadRegion();
-    HLE::SharedMemory& write = WriteRegion();
-
+StereoFrame16 DspHle::Impl::GenerateFrame(HLE::SharedMemory& read, HLE::SharedMemory& write) {
+    using Clock = Core::PerfStats::Clock;
     std::array<QuadFrame32, 3> intermediate_mixes = {};
+    Clock::duration decode_time{};
+    Clock::duration mixing_time{};
 
     // Generate intermediate mixes
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        const auto decode_start = Clock::now();
         write.source_statuses.status[i] =
             sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        const auto mixing_start = Clock::now();
         for (std::size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
+        decode_time += mixing_start - decode_start;
+        mixing_time += Clock::now() - mixing_start;
     }
 
     // Generate final mix
+    const auto mixing_start = Clock::now();
     write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples,
                                    write.intermediate_mix_samples, intermediate_mixes);
+    mixing_time += Clock::now() - mixing_start;
+
+    parent.AddStageTime(AudioStage::SourceDecode, decode_time);
+    parent.AddStageTime(AudioStage::Mixing, mixing_time);
 
     StereoFrame16 output_frame = mixers.GetOutput();
 
@@ -442,17 +494,75 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
     return output_frame;
 }
 
+StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
+    return GenerateFrame(ReadRegion(), WriteRegion());
+}
+
+void DspHle::Impl::StartPendingFrame() {
+    if (!render_worker) {
+        render_worker = std::make_unique<Common::ThreadWorker>(1, "DspHle");
+    }
+    if (!pending_frame) {
+        pending_frame = std::make_unique<PendingFrame>();
+    }
+
+    // The frame is rendered from copies of the regions, so the application may update the read
+    // region in the meantime. The dirty flags are cleared right away as the DSP would have.
+    HLE::SharedMemory& read = ReadRegion();
+    std::memcpy(&pending_frame->read, &read, sizeof(read));
+    std::memcpy(&pending_frame->write, &WriteRegion(), sizeof(pending_frame->write));
+    pending_frame->write_region_index = CurrentRegionIndex() != 0 ? 0 : 1;
+    for (auto& config : read.source_configurations.config) {
+        HLE::Source::AcknowledgeConfig(config);
+    }
+    HLE::Mixers::AcknowledgeConfig(read.dsp_configuration);
+
+    frame_pending = true;
+    render_worker->QueueWork([this] {
+        pending_frame->output = GenerateFrame(pending_frame->read, pending_frame->write);
+    });
+}
+
+void DspHle::Impl::FinishPendingFrame() {
+    if (!frame_pending) {
+        return;
+    }
+    WaitForPendingFrame();
+    frame_pending = false;
+
+    HLE::SharedMemory& write =
+        pending_frame->write_region_index == 0 ? dsp_memory->region_0 : dsp_memory->region_1;
+    const HLE::SharedMemory& rendered = pending_frame->write;
+    std::memcpy(&write.dsp_status, &rendered.dsp_status, sizeof(write.dsp_status));
+    std::memcpy(&write.final_samples, &rendered.final_samples, sizeof(write.final_samples));
+    std::memcpy(&write.source_statuses, &rendered.source_statuses, sizeof(write.source_statuses));
+    std::memcpy(&write.intermediate_mix_samples, &rendered.intermediate_mix_samples,
+                sizeof(write.intermediate_mix_samples));
+
+    parent.OutputFrame(std::move(pending_frame->output));
+}
+
+void DspHle::Impl::WaitForPendingFrame() {
+    if (render_worker) {
+        render_worker->WaitForRequests();
+    }
+}
+
 bool DspHle::Impl::Tick() {
+    // A frame rendered on the audio worker becomes visible to the application one tick later, which
+    // keeps the timing of the status updates independent of the host.
+    FinishPendingFrame();
+
     bool is_on = GetDspState() == DspState::On;
 
     if (is_on) {
-        StereoFrame16 current_frame = {};
-
         // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing
         // to shared memory region)
-        current_frame = GenerateCurrentFrame();
-
-        parent.OutputFrame(std::move(current_frame));
+        if (Settings::values.async_audio_rendering.GetValue()) {
+            StartPendingFrame();
+        } else {
+            parent.OutputFrame(GenerateCurrentFrame());
+        }
     }
 
     return is_on;
@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 #include <boost/serialization/export.hpp>
+#include <boost/serialization/version.hpp>
 #include "audio_core/audio_types.h"
 #include "audio_core/dsp_interface.h"
 #include "common/common_types.h"
@@ -54,3 +55,5 @@ private:
 };
 
 } // namespace AudioCore
+
+BOOST_CLASS_VERSION(AudioCore::DspHle::Impl, 1)
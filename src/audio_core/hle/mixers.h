@@ -25,6 +25,12 @@ public:
     DspStatus Tick(DspConfiguration& config, const IntermediateMixSamples& read_samples,
                    IntermediateMixSamples& write_samples, const std::array<QuadFrame32, 3>& input);
 
+    /// Clears the dirty flags Tick consumes from the configuration, see
+    /// Source::AcknowledgeConfig.
+    static void AcknowledgeConfig(DspConfiguration& config) {
+        config.dirty_raw = 0;
+    }
+
     StereoFrame16 GetOutput() const {
         return current_frame;
     }
@@ -0,0 +1,173 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "audio_core/hle/mixing_simd.h"
+#include "common/arch.h"
+
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+namespace AudioCore::HLE {
+
+static_assert(samples_per_frame % 4 == 0, "The kernels process up to four samples at a time");
+
+#if CITRA_ARCH(x86_64)
+
+/// Loads the four channels of a sample as floats multiplied by `gain`.
+static __m128 LoadScaled(const std::array<s32, 4>& sample, __m128 gain) {
+    const __m128i channels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sample.data()));
+    return _mm_mul_ps(gain, _mm_cvtepi32_ps(channels));
+}
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& frame,
+                       const std::array<float, 4>& gains) {
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        // Widen {left, right} to {left, right, left, right} as 32-bit integers.
+        s32 stereo;
+        std::memcpy(&stereo, frame[i].data(), sizeof(stereo));
+        const __m128i lr = _mm_shuffle_epi32(_mm_cvtsi32_si128(stereo), 0);
+        const __m128i quad = _mm_srai_epi32(_mm_unpacklo_epi16(lr, lr), 16);
+
+        const __m128i product = _mm_cvttps_epi32(_mm_mul_ps(gain, _mm_cvtepi32_ps(quad)));
+        auto* const out = reinterpret_cast<__m128i*>(dest[i].data());
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), product));
+    }
+}
+
+void DownmixStereoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain) {
+    const __m128 vgain = _mm_set1_ps(gain);
+    for (std::size_t i = 0; i < samples_per_frame; i += 2) {
+        const __m128 a = LoadScaled(samples[i], vgain);
+        const __m128 b = LoadScaled(samples[i + 1], vgain);
+        // {a0 + a2, a1 + a3, b0 + b2, b1 + b3}
+        const __m128 sum = _mm_add_ps(_mm_movelh_ps(a, b), _mm_movehl_ps(b, a));
+        const __m128i mixed = _mm_packs_epi32(_mm_cvttps_epi32(sum), _mm_setzero_si128());
+
+        auto* const out = reinterpret_cast<__m128i*>(&accumulator[i]);
+        _mm_storel_epi64(out, _mm_adds_epi16(_mm_loadl_epi64(out), mixed));
+    }
+}
+
+void DownmixMonoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain) {
+    const __m128 vgain = _mm_set1_ps(gain);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128 channels[4];
+        for (std::size_t j = 0; j < 4; j++) {
+            channels[j] = LoadScaled(samples[i + j], vgain);
+        }
+        // Transpose so that each register holds one channel of the four samples, which keeps the
+        // channels summed in order.
+        _MM_TRANSPOSE4_PS(channels[0], channels[1], channels[2], channels[3]);
+        const __m128 sum =
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(channels[0], channels[1]), channels[2]), channels[3]);
+        const __m128i mono = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(sum, half)),
+                                             _mm_setzero_si128());
+
+        auto* const out = reinterpret_cast<__m128i*>(&accumulator[i]);
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), _mm_unpacklo_epi16(mono, mono)));
+    }
+}
+
+#elif CITRA_ARCH(arm64)
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& frame,
+                       const std::array<float, 4>& gains) {
+    const float32x4_t gain = vld1q_f32(gains.data());
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        // Widen {left, right} to {left, right, left, right} as 32-bit integers.
+        u32 stereo;
+        std::memcpy(&stereo, frame[i].data(), sizeof(stereo));
+        const int32x4_t quad = vmovl_s16(vreinterpret_s16_u32(vdup_n_u32(stereo)));
+
+        const int32x4_t product = vcvtq_s32_f32(vmulq_f32(gain, vcvtq_f32_s32(quad)));
+        s32* const out = dest[i].data();
+        vst1q_s32(out, vaddq_s32(vld1q_s32(out), product));
+    }
+}
+
+void DownmixStereoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 2) {
+        const float32x4_t a = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(samples[i].data())), gain);
+        const float32x4_t b = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(samples[i + 1].data())), gain);
+        // {a0 + a2, a1 + a3, b0 + b2, b1 + b3}
+        const float32x4_t sum = vaddq_f32(vcombine_f32(vget_low_f32(a), vget_low_f32(b)),
+                                          vcombine_f32(vget_high_f32(a), vget_high_f32(b)));
+        const int16x4_t mixed = vqmovn_s32(vcvtq_s32_f32(sum));
+
+        s16* const out = accumulator[i].data();
+        vst1_s16(out, vqadd_s16(vld1_s16(out), mixed));
+    }
+}
+
+void DownmixMonoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        // De-interleave so that each register holds one channel of the four samples, which keeps
+        // the channels summed in order.
+        const int32x4x4_t channels = vld4q_s32(samples[i].data());
+        float32x4_t sum = vmulq_n_f32(vcvtq_f32_s32(channels.val[0]), gain);
+        for (std::size_t j = 1; j < 4; j++) {
+            sum = vaddq_f32(sum, vmulq_n_f32(vcvtq_f32_s32(channels.val[j]), gain));
+        }
+        const int16x4_t mono = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(sum, 0.5f)));
+
+        s16* const out = accumulator[i].data();
+        const int16x4x2_t both = vzip_s16(mono, mono);
+        vst1q_s16(out, vqaddq_s16(vld1q_s16(out), vcombine_s16(both.val[0], both.val[1])));
+    }
+}
+
+#else
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& frame,
+                       const std::array<float, 4>& gains) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * frame[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * frame[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * frame[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * frame[samplei][1]);
+    }
+}
+
+void DownmixStereoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain) {
+    std::transform(
+        accumulator.begin(), accumulator.end(), samples.begin(), accumulator.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+            s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+            return AddAndClampToS16(accumulator, {left, right});
+        });
+}
+
+void DownmixMonoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain) {
+    std::transform(
+        accumulator.begin(), accumulator.end(), samples.begin(), accumulator.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            s16 mono = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+            return AddAndClampToS16(accumulator, {mono, mono});
+        });
+}
+
+#endif
+
+} // namespace AudioCore::HLE
@@ -0,0 +1,32 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/audio_types.h"
+
+namespace AudioCore::HLE {
+
+/**
+ * Gain and mixdown kernels of the HLE DSP. They are vectorized with SSE2 on x86-64 and NEON on
+ * arm64 and produce the same samples as the scalar code used on other hosts, which evaluates each
+ * product and sum in single precision and in the order written.
+ */
+
+/**
+ * Adds a stereo frame to a quadraphonic one, scaling it by the gain of each quad channel. The left
+ * channel feeds quad channels 0 and 2, the right channel 1 and 3.
+ */
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& frame,
+                       const std::array<float, 4>& gains);
+
+/// Downmixes a quadraphonic frame to stereo and adds it to `accumulator`, saturating to s16.
+void DownmixStereoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain);
+
+/// Downmixes a quadraphonic frame to mono and adds it to both channels of `accumulator`,
+/// saturating to s16.
+void DownmixMonoInto(StereoFrame16& accumulator, const QuadFrame32& samples, float gain);
+
+} // namespace AudioCore::HLE
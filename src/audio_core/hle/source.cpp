@@ -6,6 +6,7 @@
 #include <array>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
+#include "audio_core/hle/mixing_simd.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
@@ -21,6 +22,8 @@ SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
     if (state.enabled) {
         GenerateFrame();
     }
+    queue_accounting.Resize(state.current_buffer.size() * sizeof(std::array<s16, 2>) +
+                            state.input_queue.size() * sizeof(Buffer));
 
     return GetCurrentStatus();
 }
@@ -29,14 +32,18 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+    MixStereoIntoQuad(dest, current_frame, state.gain.at(intermediate_mix_id));
+}
+
+void Source::AcknowledgeConfig(SourceConfiguration::Configuration& config) {
+    if (!config.dirty_raw) {
+        return;
     }
+    if (config.buffer_queue_dirty) {
+        config.buffers_dirty = 0;
+    }
+    config.dirty_raw = 0;
 }
 
 void Source::Reset() {
@@ -17,6 +17,7 @@
 #include "audio_core/hle/filter.h"
 #include "audio_core/interpolate.h"
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 
 namespace Memory {
 class MemorySystem;
@@ -35,7 +36,9 @@ namespace AudioCore::HLE {
  */
 class Source final {
 public:
-    explicit Source(std::size_t source_id_) : source_id(source_id_) {
+    explicit Source(std::size_t source_id_)
+        : source_id(source_id_),
+          queue_accounting{Common::MemoryAccounting::Category::Audio, 0} {
         Reset();
     }
 
@@ -59,6 +62,12 @@ public:
     SourceStatus::Status Tick(SourceConfiguration::Configuration& config,
                               const s16_le (&adpcm_coeffs)[16]);
 
+    /**
+     * Clears the dirty flags Tick consumes from the configuration. Used when Tick is given a copy
+     * of the configuration, so that the application still sees its updates picked up.
+     */
+    static void AcknowledgeConfig(SourceConfiguration::Configuration& config);
+
     /**
      * Mix this source's output into dest, using the gains for the `intermediate_mix_id`-th
      * intermediate mixer.
@@ -72,6 +81,8 @@ private:
     Memory::MemorySystem* memory_system{};
     StereoFrame16 current_frame;
     StereoFrame16 backup_frame; // TODO(PabloMK7): Check if we actually need this
+    /// Accounts the queued buffers and the decoded samples of the current one
+    Common::MemoryAccounting::Allocation queue_accounting;
 
     using Format = SourceConfiguration::Configuration::Format;
     using InterpolationMode = SourceConfiguration::Configuration::InterpolationMode;
@@ -16,8 +16,9 @@ constexpr u64 scale_mask = scale_factor - 1;
 /// Here we step over the input in steps of rate, until we consume all of the input.
 /// Three adjacent samples are passed to fn each step.
 template <typename Function>
-static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-                            std::size_t& outputi, Function fn) {
+static void StepOverSamples(State& state, StereoBuffer16& input, float rate,
+                            std::span<std::array<s16, 2>> output, std::size_t& outputi,
+                            Function fn) {
     ASSERT(rate > 0);
 
     if (input.empty())
@@ -50,15 +51,15 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     input.erase(input.begin(), std::next(input.begin(), inputi + 2));
 }
 
-void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+void None(State& state, StereoBuffer16& input, float rate, std::span<std::array<s16, 2>> output,
           std::size_t& outputi) {
     StepOverSamples(
         state, input, rate, output, outputi,
         [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
 }
 
-void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-            std::size_t& outputi) {
+void Linear(State& state, StereoBuffer16& input, float rate,
+            std::span<std::array<s16, 2>> output, std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
     StepOverSamples(state, input, rate, output, outputi,
                     [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
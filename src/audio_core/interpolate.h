@@ -6,6 +6,7 @@
 
 #include <array>
 #include <deque>
+#include <span>
 #include "audio_core/audio_types.h"
 #include "common/common_types.h"
 
@@ -31,7 +32,7 @@ struct State {
  * @param output The resampled audio buffer.
  * @param outputi The index of output to start writing to.
  */
-void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+void None(State& state, StereoBuffer16& input, float rate, std::span<std::array<s16, 2>> output,
           std::size_t& outputi);
 
 /**
@@ -43,7 +44,7 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
  * @param output The resampled audio buffer.
  * @param outputi The index of output to start writing to.
  */
-void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+void Linear(State& state, StereoBuffer16& input, float rate, std::span<std::array<s16, 2>> output,
             std::size_t& outputi);
 
 } // namespace AudioCore::AudioInterp
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include "common/common_types.h"
 
@@ -30,6 +31,12 @@ public:
      * @param sample_count Number of samples.
      */
     virtual void SetCallback(std::function<void(s16*, std::size_t)> cb) = 0;
+
+    /// Time between a sample being passed to the sink and it being played, or zero if the sink
+    /// cannot tell.
+    virtual std::chrono::nanoseconds GetOutputLatency() const {
+        return {};
+    }
 };
 
 } // namespace AudioCore
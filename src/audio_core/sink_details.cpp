@@ -8,6 +8,9 @@
 #include <vector>
 #include "audio_core/null_sink.h"
 #include "audio_core/sink_details.h"
+#ifdef HAVE_AAUDIO
+#include "audio_core/aaudio_sink.h"
+#endif
 #ifdef HAVE_SDL2
 #include "audio_core/sdl2_sink.h"
 #endif
@@ -23,6 +26,13 @@ namespace AudioCore {
 namespace {
 // sink_details is ordered in terms of desirability, with the best choice at the top.
 constexpr std::array sink_details = {
+#ifdef HAVE_AAUDIO
+    SinkDetails{SinkType::AAudio, "AAudio",
+                [](std::string_view device_id) -> std::unique_ptr<Sink> {
+                    return std::make_unique<AAudioSink>(device_id);
+                },
+                &ListAAudioSinkDevices},
+#endif
 #ifdef HAVE_CUBEB
     SinkDetails{SinkType::Cubeb, "Cubeb",
                 [](std::string_view device_id) -> std::unique_ptr<Sink> {
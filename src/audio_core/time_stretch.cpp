@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <type_traits>
@@ -105,6 +106,44 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
     }
 }
 
+std::size_t DriftCorrector::Process(const s16* in, std::size_t num_in, s16* out,
+                                    std::size_t num_out) {
+    for (std::size_t i = 0; i < num_in; i++) {
+        backlog.push_back({in[2 * i], in[2 * i + 1]});
+    }
+
+    // The fifo normally bounds the backlog, so this only drops samples when the host clock stalls.
+    const std::size_t max_backlog = native_sample_rate / 4;
+    if (backlog.size() > max_backlog) {
+        backlog.erase(backlog.begin(), backlog.begin() + (backlog.size() - max_backlog));
+    }
+
+    // Aim for one callback worth of frames plus two DSP frames of headroom. The ratio saturates
+    // when the backlog is half again or half as large as that.
+    const double target = static_cast<double>(num_out + 2 * samples_per_frame);
+    const double error = (static_cast<double>(backlog.size()) - target) / target;
+    const double current_ratio =
+        1.0 + std::clamp(error * 2.0 * MaxAdjustment, -MaxAdjustment, MaxAdjustment);
+
+    // As in TimeStretcher::Process, smooth out the variance of the backlog between callbacks.
+    const double time_delta = static_cast<double>(num_out) / native_sample_rate; // seconds
+    constexpr double lpf_time_scale = 0.5;                                       // seconds
+    const double lpf_gain = 1.0 - std::exp(-time_delta / lpf_time_scale);
+    ratio += lpf_gain * (current_ratio - ratio);
+
+    output.resize(num_out);
+    std::size_t outputi = 0;
+    AudioInterp::Linear(state, backlog, static_cast<float>(ratio), output, outputi);
+    std::memcpy(out, output.data(), outputi * sizeof(output[0]));
+    return outputi;
+}
+
+void DriftCorrector::Clear() {
+    state = {};
+    backlog.clear();
+    ratio = 1.0;
+}
+
 void TimeStretcher::Clear() {
     sound_touch->clear();
 }
@@ -7,6 +7,8 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <vector>
+#include "audio_core/interpolate.h"
 #include "common/common_types.h"
 
 namespace soundtouch {
@@ -38,4 +40,40 @@ private:
     double stretch_ratio = 1.0;
 };
 
+/**
+ * Corrects the drift between the emulated and host audio clocks while emulation runs at full
+ * speed. The input is resampled with linear interpolation at a ratio within half a percent of 1,
+ * which steers the backlog towards a little more than one callback worth of frames. This is much
+ * cheaper than running SoundTouch and the pitch change is inaudible.
+ */
+class DriftCorrector {
+public:
+    /// Largest deviation of the resampling ratio from 1.
+    static constexpr double MaxAdjustment = 0.005;
+
+    /// @param in       Input sample buffer
+    /// @param num_in   Number of input frames in `in`
+    /// @param out      Output sample buffer
+    /// @param num_out  Desired number of output frames in `out`
+    /// @returns Actual number of frames written to `out`
+    std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
+
+    void Clear();
+
+    /// Returns the number of input frames waiting to be resampled.
+    std::size_t Backlog() const {
+        return backlog.size();
+    }
+
+    double Ratio() const {
+        return ratio;
+    }
+
+private:
+    AudioInterp::State state;
+    AudioInterp::StereoBuffer16 backlog;
+    std::vector<std::array<s16, 2>> output;
+    double ratio = 1.0;
+};
+
 } // namespace AudioCore
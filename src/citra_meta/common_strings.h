@@ -25,6 +25,13 @@ constexpr char help_string[] =
     // TODO: Move -m outside of this check when it is implemented in Qt frontend
     "-m, --multiplayer [nick:password@address:port]   Nickname, password, address and port for "
     "multiplayer (currently only usable with SDL frontend)\n"
+    "-b, --benchmark [path]      Play the movie given with --movie-play or the CiTrace given with "
+    "--replay-trace unthrottled and write per-frame timings to the given CSV file (SDL frontend "
+    "only)\n"
+    "-c, --checkpoint-interval [frames]   Hash the framebuffer every given number of frames in "
+    "benchmark mode, 0 disables it (default: 60)\n"
+    "-t, --replay-trace [path]   Replay a CiTrace recorded from the given application as fast as "
+    "possible instead of running it (SDL frontend only)\n"
 #endif
 #ifdef ENABLE_ROOM
     "    --room                  Utilize dedicated multiplayer room functionality (equivalent to "
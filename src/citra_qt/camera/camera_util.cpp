@@ -176,9 +176,12 @@ std::vector<u16> Rgb2Yuv(const QImage& source, int width, int height) {
     auto dest = buffer.begin();
     bool write = false;
     int py, pu, pv;
+    // QImage::pixel converts every pixel from the image format, so read 32-bit scanlines instead
+    const QImage image = source.convertToFormat(QImage::Format_RGB32);
     for (int j = 0; j < height; ++j) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(j));
         for (int i = 0; i < width; ++i) {
-            QRgb rgb = source.pixel(i, j);
+            QRgb rgb = line[i];
             int r = qRed(rgb);
             int g = qGreen(rgb);
             int b = qBlue(rgb);
@@ -49,6 +49,7 @@
 #include "citra_qt/configuration/configure_dialog.h"
 #include "citra_qt/configuration/configure_per_game.h"
 #include "citra_qt/debugger/console.h"
+#include "citra_qt/debugger/frame_breakdown.h"
 #include "citra_qt/debugger/graphics/graphics.h"
 #include "citra_qt/debugger/graphics/graphics_breakpoints.h"
 #include "citra_qt/debugger/graphics/graphics_cmdlists.h"
@@ -87,6 +88,7 @@
 #include "common/literals.h"
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/memory_detect.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
@@ -95,6 +97,7 @@
 #endif
 #include "common/settings.h"
 #include "common/string_util.h"
+#include "common/tracing.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
 #include "core/dumping/backend.h"
@@ -111,6 +114,7 @@
 #include "input_common/main.h"
 #include "network/network_settings.h"
 #include "ui_main.h"
+#include "video_core/custom_textures/custom_tex_manager.h"
 #include "video_core/gpu.h"
 #include "video_core/renderer_base.h"
 
@@ -542,9 +546,10 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    host_memory_label = new QLabel();
 
     for (auto& label : {loading_shaders_label, artic_traffic_label, emu_speed_label, game_fps_label,
-                        emu_frametime_label}) {
+                        emu_frametime_label, host_memory_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -686,6 +691,11 @@ void GMainWindow::InitializeDebugWidgets() {
     connect(this, &GMainWindow::EmulationStopping, waitTreeWidget,
             &WaitTreeWidget::OnEmulationStopping);
 
+    frameBreakdownWidget = new FrameBreakdownWidget(system, this);
+    addDockWidget(Qt::BottomDockWidgetArea, frameBreakdownWidget);
+    frameBreakdownWidget->hide();
+    debug_menu->addAction(frameBreakdownWidget->toggleViewAction());
+
     lleServiceModulesWidget = new LLEServiceModulesWidget(this);
     addDockWidget(Qt::RightDockWidgetArea, lleServiceModulesWidget);
     lleServiceModulesWidget->hide();
@@ -838,12 +848,17 @@ void GMainWindow::InitializeHotkeys() {
     });
     connect_shortcut(QStringLiteral("Toggle Texture Dumping"),
                      [&] { Settings::values.dump_textures = !Settings::values.dump_textures; });
-    connect_shortcut(QStringLiteral("Toggle Custom Textures"),
-                     [&] { Settings::values.custom_textures = !Settings::values.custom_textures; });
+    connect_shortcut(QStringLiteral("Toggle Custom Textures"), [&] {
+        Settings::values.custom_textures = !Settings::values.custom_textures;
+        Settings::UpdateRuntimeSettings();
+    });
 
     connect_shortcut(QStringLiteral("Toggle Turbo Mode"),
                      [&] { GMainWindow::SetTurboEnabled(!GMainWindow::IsTurboEnabled()); });
 
+    connect_shortcut(QStringLiteral("Rewind"),
+                     [&] { system.SendSignal(Core::System::Signal::Rewind); });
+
     connect_shortcut(QStringLiteral("Increase Speed Limit"), [&] { AdjustSpeedLimit(true); });
     connect_shortcut(QStringLiteral("Decrease Speed Limit"), [&] { AdjustSpeedLimit(false); });
 
@@ -988,6 +1003,8 @@ void GMainWindow::ConnectWidgetEvents() {
             &GMainWindow::OnGameListRemovePlayTimeData);
     connect(game_list, &GameList::CreateShortcut, this, &GMainWindow::OnGameListCreateShortcut);
     connect(game_list, &GameList::DumpRomFSRequested, this, &GMainWindow::OnGameListDumpRomFS);
+    connect(game_list, &GameList::BuildTexturePackRequested, this,
+            &GMainWindow::OnGameListBuildTexturePack);
     connect(game_list, &GameList::AddDirectory, this, &GMainWindow::OnGameListAddDirectory);
     connect(game_list_placeholder, &GameListPlaceholder::AddDirectory, this,
             &GMainWindow::OnGameListAddDirectory);
@@ -1107,6 +1124,9 @@ void GMainWindow::ConnectMenuEvents() {
     });
     connect_menu(ui->action_Capture_Screenshot, &GMainWindow::OnCaptureScreenshot);
     connect_menu(ui->action_Dump_Video, &GMainWindow::OnDumpVideo);
+    connect_menu(ui->action_Replay_Buffer, &GMainWindow::OnToggleReplayBuffer);
+    connect_menu(ui->action_Save_Replay, &GMainWindow::OnSaveReplay);
+    connect_menu(ui->action_Record_Trace, &GMainWindow::OnToggleTrace);
 
     // Tools
     connect_menu(ui->action_Compress_ROM_File, &GMainWindow::OnCompressFile);
@@ -1144,6 +1164,8 @@ void GMainWindow::UpdateMenuState() {
     }
 
     ui->action_Capture_Screenshot->setEnabled(emulation_running);
+    ui->action_Replay_Buffer->setEnabled(emulation_running);
+    ui->action_Save_Replay->setEnabled(emulation_running && ui->action_Replay_Buffer->isChecked());
     ui->action_Advance_Frame->setEnabled(emulation_running && is_paused);
 
     if (emulation_running && is_paused) {
@@ -1590,6 +1612,7 @@ void GMainWindow::ShutdownGame() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    host_memory_label->setVisible(false);
 
     UpdateSaveStates();
 
@@ -2126,6 +2149,35 @@ void GMainWindow::OnGameListDumpRomFS(QString game_path, u64 program_id) {
     future_watcher->setFuture(future);
 }
 
+void GMainWindow::OnGameListBuildTexturePack(u64 program_id) {
+    auto* dialog = new QProgressDialog(tr("Building texture pack..."), tr("Cancel"), 0, 0, this);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setWindowFlags(dialog->windowFlags() &
+                           ~(Qt::WindowCloseButtonHint | Qt::WindowContextHelpButtonHint));
+    dialog->setCancelButton(nullptr);
+    dialog->setMinimumDuration(0);
+    dialog->setValue(0);
+
+    auto* future_watcher = new QFutureWatcher<bool>(this);
+    connect(future_watcher, &QFutureWatcher<bool>::finished, this, [this, dialog, future_watcher] {
+        dialog->hide();
+        if (!future_watcher->result()) {
+            QMessageBox::critical(
+                this, tr("Azahar"),
+                tr("Could not build the custom texture pack.\nRefer to the log for details."));
+            return;
+        }
+        QMessageBox::information(this, tr("Azahar"),
+                                 tr("The custom texture pack was built successfully."));
+    });
+
+    auto future = QtConcurrent::run([this, program_id] {
+        VideoCore::CustomTexManager custom_tex_manager{system};
+        return custom_tex_manager.BuildPack(program_id);
+    });
+    future_watcher->setFuture(future);
+}
+
 void GMainWindow::OnGameListOpenDirectory(const QString& directory) {
     QString path;
     if (directory == QStringLiteral("INSTALLED")) {
@@ -3258,10 +3310,14 @@ void GMainWindow::OnCompressFile() {
             const auto progress = [&](std::size_t written, std::size_t total) {
                 emit UpdateProgress(written, total);
             };
-            bool success = FileUtil::CompressZ3DSFile(in_path, out_path,
-                                                      compress_info.value().first.underlying_magic,
-                                                      compress_info.value().second, progress,
-                                                      compress_info.value().first.default_metadata);
+            const FileUtil::Z3DSCompressionOptions options{
+                .level = static_cast<int>(Settings::values.z3ds_compression_level.GetValue()),
+                .long_distance_matching = Settings::values.z3ds_long_distance_matching.GetValue(),
+            };
+            bool success = FileUtil::CompressZ3DSFile(
+                in_path, out_path, compress_info.value().first.underlying_magic,
+                compress_info.value().second, progress,
+                compress_info.value().first.default_metadata, options);
             if (!success) {
                 total_success = false;
                 FileUtil::Delete(out_path);
@@ -3452,8 +3508,109 @@ void GMainWindow::StartVideoDumping(const QString& path) {
     }
 }
 
+void GMainWindow::OnToggleReplayBuffer() {
+    if (!DynamicLibrary::FFmpeg::LoadFFmpeg()) {
+        ui->action_Replay_Buffer->setChecked(false);
+        ShowFFmpegErrorMessage();
+        return;
+    }
+    if (!ui->action_Replay_Buffer->isChecked()) {
+        OnStopVideoDumping();
+        return;
+    }
+
+    // The replay buffer and video dumping share the single video dumper of the system.
+    auto video_dumper = system.GetVideoDumper();
+    if (video_dumper && video_dumper->IsDumping()) {
+        QMessageBox::warning(this, tr("Azahar"),
+                             tr("The replay buffer cannot be used while dumping video."));
+        ui->action_Replay_Buffer->setChecked(false);
+        return;
+    }
+
+    auto& renderer = system.GPU().Renderer();
+    const auto layout{Layout::FrameLayoutFromResolutionScale(renderer.GetResolutionScaleFactor())};
+    auto dumper = std::make_shared<VideoDumper::FFmpegBackend>(renderer);
+    if (!dumper->StartReplayBuffer(layout)) {
+        QMessageBox::critical(
+            this, tr("Azahar"),
+            tr("Could not start the replay buffer.<br>Please ensure that the video encoder is "
+               "configured correctly.<br>Refer to the log for details."));
+        ui->action_Replay_Buffer->setChecked(false);
+        return;
+    }
+    system.RegisterVideoDumper(dumper);
+    ui->action_Dump_Video->setEnabled(false);
+    ui->action_Save_Replay->setEnabled(true);
+}
+
+void GMainWindow::OnSaveReplay() {
+    auto dumper = system.GetVideoDumper();
+    if (!dumper) {
+        return;
+    }
+
+    std::string extension = "mkv";
+    for (const auto& format : VideoDumper::ListFormats()) {
+        if (format.name == Settings::values.output_format && !format.extensions.empty()) {
+            extension = format.extensions.front();
+            break;
+        }
+    }
+    static QRegularExpression expr(QStringLiteral("[\\/:?\"<>|]"));
+    const std::string filename = QString(game_title).remove(expr).toStdString();
+    const std::string timestamp = QDateTime::currentDateTime()
+                                      .toString(QStringLiteral("dd.MM.yy_hh.mm.ss.z"))
+                                      .toStdString();
+    const std::string path =
+        fmt::format("{}replays/{}_{}.{}", FileUtil::GetUserPath(FileUtil::UserPath::UserDir),
+                    filename, timestamp, extension);
+
+    // Writing out a minute of encoded video takes a moment, keep it off the UI thread.
+    auto future = QtConcurrent::run([dumper, path] { return dumper->SaveReplay(path); });
+    auto* future_watcher = new QFutureWatcher<bool>(this);
+    connect(future_watcher, &QFutureWatcher<bool>::finished, this, [this, future_watcher, path] {
+        if (future_watcher->result()) {
+            statusBar()->showMessage(tr("Replay saved to %1").arg(QString::fromStdString(path)),
+                                     5000);
+        } else {
+            QMessageBox::critical(
+                this, tr("Azahar"),
+                tr("Could not save the replay.<br>Refer to the log for details."));
+        }
+        future_watcher->deleteLater();
+    });
+    future_watcher->setFuture(future);
+}
+
+void GMainWindow::OnToggleTrace(bool checked) {
+    Common::Tracing::SetEnabled(checked);
+    if (checked) {
+        return;
+    }
+
+    const QString timestamp =
+        QDateTime::currentDateTime().toString(QStringLiteral("dd.MM.yy_hh.mm.ss.z"));
+    const QString default_path =
+        QStringLiteral("%1trace_%2.json")
+            .arg(QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::UserDir)),
+                 timestamp);
+    const QString path = QFileDialog::getSaveFileName(this, tr("Save Performance Trace"),
+                                                      default_path, tr("Trace (*.json)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    if (!Common::Tracing::ExportChromeTrace(path.toStdString())) {
+        QMessageBox::critical(this, tr("Azahar"),
+                              tr("Could not save the trace.<br>Refer to the log for details."));
+    }
+}
+
 void GMainWindow::OnStopVideoDumping() {
     ui->action_Dump_Video->setChecked(false);
+    ui->action_Dump_Video->setEnabled(true);
+    ui->action_Replay_Buffer->setChecked(false);
+    ui->action_Save_Replay->setEnabled(false);
 
     if (video_dumping_on_start) {
         video_dumping_on_start = false;
@@ -3584,12 +3741,29 @@ void GMainWindow::UpdateStatusBar() {
             tr("Frame: %1 ms").arg(results.time_vblank_interval * 1000.0, 2, 'f', 2));
     }
 
+    if (UISettings::values.show_advanced_frametime_info) {
+        constexpr double MiB = 1024.0 * 1024.0;
+        const auto& host_memory = results.host_memory;
+        host_memory_label->setText(tr("Memory: %1 MiB (Peak: %2 MiB)")
+                                       .arg(host_memory.TotalCurrent() / MiB, 0, 'f', 0)
+                                       .arg(results.peak_host_memory / MiB, 0, 'f', 0));
+        QStringList breakdown;
+        for (std::size_t i = 0; i < Common::MemoryAccounting::NumCategories; i++) {
+            breakdown.append(tr("%1: %2 MiB (Peak: %3 MiB)")
+                                 .arg(QString::fromUtf8(Common::MemoryAccounting::CategoryNames[i]))
+                                 .arg(host_memory.current[i] / MiB, 0, 'f', 1)
+                                 .arg(host_memory.peak[i] / MiB, 0, 'f', 1));
+        }
+        host_memory_label->setToolTip(breakdown.join(QLatin1Char('\n')));
+    }
+
     if (show_artic_label) {
         artic_traffic_label->setVisible(true);
     }
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    host_memory_label->setVisible(UISettings::values.show_advanced_frametime_info.GetValue());
 }
 
 void GMainWindow::UpdateBootHomeMenuState() {
@@ -61,6 +61,7 @@ class QPushButton;
 class QSlider;
 class RegistersWidget;
 class WaitTreeWidget;
+class FrameBreakdownWidget;
 
 namespace Camera {
 class QtMultimediaCameraHandlerFactory;
@@ -243,6 +244,7 @@ private slots:
     void OnGameListCreateShortcut(u64 program_id, const std::string& game_path,
                                   GameListShortcutTarget target);
     void OnGameListDumpRomFS(QString game_path, u64 program_id);
+    void OnGameListBuildTexturePack(u64 program_id);
     void OnGameListOpenDirectory(const QString& directory);
     void OnGameListAddDirectory();
     void OnGameListShowList(bool show);
@@ -289,6 +291,9 @@ private slots:
     void OnSaveMovie();
     void OnCaptureScreenshot();
     void OnDumpVideo();
+    void OnToggleReplayBuffer();
+    void OnSaveReplay();
+    void OnToggleTrace(bool checked);
     void OnCompressFile();
     void OnDecompressFile();
 #ifdef _WIN32
@@ -355,6 +360,7 @@ private:
     QLabel* emu_speed_label = nullptr;
     QLabel* game_fps_label = nullptr;
     QLabel* emu_frametime_label = nullptr;
+    QLabel* host_memory_label = nullptr;
     QPushButton* graphics_api_button = nullptr;
     QPushButton* volume_button = nullptr;
     QWidget* volume_popup = nullptr;
@@ -419,6 +425,7 @@ private:
     IPCRecorderWidget* ipcRecorderWidget;
     LLEServiceModulesWidget* lleServiceModulesWidget;
     WaitTreeWidget* waitTreeWidget;
+    FrameBreakdownWidget* frameBreakdownWidget;
 
     QAction* actions_recent_files[max_recent_files_item];
     std::array<QAction*, Core::SaveStateSlotCount> actions_load_state;
@@ -54,7 +54,7 @@ const std::array<std::array<int, 5>, Settings::NativeAnalog::NumAnalogs> QtConfi
 // This must be in alphabetical order according to action name as it must have the same order as
 // UISetting::values.shortcuts, which is alphabetically ordered.
 // clang-format off
-const std::array<UISettings::Shortcut, 38> QtConfig::default_hotkeys {{
+const std::array<UISettings::Shortcut, 39> QtConfig::default_hotkeys {{
      {QStringLiteral("Advance Frame"),            QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::ApplicationShortcut}},
      {QStringLiteral("Audio Mute/Unmute"),        QStringLiteral("Main Window"), {QStringLiteral("Ctrl+M"), Qt::WindowShortcut}},
      {QStringLiteral("Audio Volume Down"),        QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::WindowShortcut}},
@@ -80,6 +80,7 @@ const std::array<UISettings::Shortcut, 38> QtConfig::default_hotkeys {{
      {QStringLiteral("Quick Load"),               QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::WindowShortcut}},
      {QStringLiteral("Remove Amiibo"),            QStringLiteral("Main Window"), {QStringLiteral("F3"),     Qt::ApplicationShortcut}},
      {QStringLiteral("Restart Emulation"),        QStringLiteral("Main Window"), {QStringLiteral("F6"),     Qt::WindowShortcut}},
+     {QStringLiteral("Rewind"),                   QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::WindowShortcut}},
      {QStringLiteral("Rotate Screens Upright"),   QStringLiteral("Main Window"), {QStringLiteral("F8"),     Qt::WindowShortcut}},
      {QStringLiteral("Save to Oldest Non-Quicksave Slot"),  QStringLiteral("Main Window"), {QStringLiteral("Ctrl+C"), Qt::WindowShortcut}},
      {QStringLiteral("Stop Emulation"),           QStringLiteral("Main Window"), {QStringLiteral("F5"),     Qt::WindowShortcut}},
@@ -282,6 +283,7 @@ void QtConfig::ReadAudioValues() {
     ReadGlobalSetting(Settings::values.audio_emulation);
     ReadGlobalSetting(Settings::values.enable_audio_stretching);
     ReadGlobalSetting(Settings::values.enable_realtime_audio);
+    ReadGlobalSetting(Settings::values.async_audio_rendering);
     ReadGlobalSetting(Settings::values.volume);
 
     if (global) {
@@ -332,6 +334,7 @@ void QtConfig::ReadControlValues() {
     qt_config->beginGroup(QStringLiteral("Controls"));
 
     ReadBasicSetting(Settings::values.use_artic_base_controller);
+    ReadBasicSetting(Settings::values.input_polling_rate);
 
     int num_touch_from_button_maps =
         qt_config->beginReadArray(QStringLiteral("touch_from_button_maps"));
@@ -450,9 +453,11 @@ void QtConfig::ReadUtilityValues() {
     qt_config->beginGroup(QStringLiteral("Utility"));
 
     ReadGlobalSetting(Settings::values.dump_textures);
+    ReadGlobalSetting(Settings::values.fast_texture_dumping);
     ReadGlobalSetting(Settings::values.custom_textures);
     ReadGlobalSetting(Settings::values.preload_textures);
     ReadGlobalSetting(Settings::values.async_custom_loading);
+    ReadGlobalSetting(Settings::values.transcode_custom_textures);
 
     qt_config->endGroup();
 }
@@ -464,6 +469,14 @@ void QtConfig::ReadCoreValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_cpu_jit);
+        ReadBasicSetting(Settings::values.jit_cache_budget);
+        ReadBasicSetting(Settings::values.use_fastmem);
+        ReadBasicSetting(Settings::values.use_multicore);
+        ReadBasicSetting(Settings::values.skip_busy_waits);
+        ReadBasicSetting(Settings::values.background_savestates);
+        ReadBasicSetting(Settings::values.savestate_compression_level);
+        ReadBasicSetting(Settings::values.rewind_interval);
+        ReadBasicSetting(Settings::values.rewind_buffer_size);
         ReadBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -476,6 +489,10 @@ void QtConfig::ReadDataStorageValues() {
     ReadBasicSetting(Settings::values.use_virtual_sd);
     ReadBasicSetting(Settings::values.use_custom_storage);
     ReadBasicSetting(Settings::values.compress_cia_installs);
+    ReadBasicSetting(Settings::values.cache_decrypted_romfs);
+    ReadBasicSetting(Settings::values.z3ds_frame_cache_size);
+    ReadBasicSetting(Settings::values.z3ds_compression_level);
+    ReadBasicSetting(Settings::values.z3ds_long_distance_matching);
 
     const std::string nand_dir =
         ReadSetting(QStringLiteral("nand_directory"), QStringLiteral("")).toString().toStdString();
@@ -520,6 +537,7 @@ void QtConfig::ReadLayoutValues() {
     ReadGlobalSetting(Settings::values.swap_eyes_3d);
     ReadGlobalSetting(Settings::values.render_3d_which_display);
     ReadGlobalSetting(Settings::values.filter_mode);
+    ReadGlobalSetting(Settings::values.spatial_upscaling);
     ReadGlobalSetting(Settings::values.pp_shader_name);
     ReadGlobalSetting(Settings::values.anaglyph_shader_name);
     ReadGlobalSetting(Settings::values.layout_option);
@@ -694,6 +712,7 @@ void QtConfig::ReadRendererValues() {
     ReadGlobalSetting(Settings::values.disable_spirv_optimizer);
     ReadGlobalSetting(Settings::values.async_shader_compilation);
     ReadGlobalSetting(Settings::values.async_presentation);
+    ReadBasicSetting(Settings::values.present_queue_depth);
     ReadGlobalSetting(Settings::values.use_hw_shader);
     ReadGlobalSetting(Settings::values.shaders_accurate_mul);
     ReadGlobalSetting(Settings::values.use_disk_shader_cache);
@@ -711,6 +730,18 @@ void QtConfig::ReadRendererValues() {
 
     ReadGlobalSetting(Settings::values.delay_game_render_thread_us);
     ReadGlobalSetting(Settings::values.disable_right_eye_render);
+    ReadGlobalSetting(Settings::values.async_texture_upload);
+    ReadGlobalSetting(Settings::values.gpu_texture_decode);
+    ReadGlobalSetting(Settings::values.accurate_mipmaps);
+    ReadGlobalSetting(Settings::values.texture_memory_budget);
+    ReadGlobalSetting(Settings::values.use_descriptor_buffer);
+    ReadGlobalSetting(Settings::values.parallel_command_recording);
+    ReadGlobalSetting(Settings::values.async_compute);
+    ReadGlobalSetting(Settings::values.frame_pacing);
+    ReadGlobalSetting(Settings::values.dynamic_resolution);
+    ReadGlobalSetting(Settings::values.auto_frame_skip);
+    ReadGlobalSetting(Settings::values.async_gpu);
+    ReadGlobalSetting(Settings::values.merge_stereo_renders);
 
     if (global) {
         ReadBasicSetting(Settings::values.use_shader_jit);
@@ -928,6 +959,7 @@ void QtConfig::SaveAudioValues() {
     WriteGlobalSetting(Settings::values.audio_emulation);
     WriteGlobalSetting(Settings::values.enable_audio_stretching);
     WriteGlobalSetting(Settings::values.enable_realtime_audio);
+    WriteGlobalSetting(Settings::values.async_audio_rendering);
     WriteGlobalSetting(Settings::values.volume);
 
     if (global) {
@@ -974,6 +1006,7 @@ void QtConfig::SaveControlValues() {
     qt_config->beginGroup(QStringLiteral("Controls"));
 
     WriteBasicSetting(Settings::values.use_artic_base_controller);
+    WriteBasicSetting(Settings::values.input_polling_rate);
 
     WriteSetting(QStringLiteral("profile"), Settings::values.current_input_profile_index, 0);
     qt_config->beginWriteArray(QStringLiteral("profiles"));
@@ -1035,9 +1068,11 @@ void QtConfig::SaveUtilityValues() {
     qt_config->beginGroup(QStringLiteral("Utility"));
 
     WriteGlobalSetting(Settings::values.dump_textures);
+    WriteGlobalSetting(Settings::values.fast_texture_dumping);
     WriteGlobalSetting(Settings::values.custom_textures);
     WriteGlobalSetting(Settings::values.preload_textures);
     WriteGlobalSetting(Settings::values.async_custom_loading);
+    WriteGlobalSetting(Settings::values.transcode_custom_textures);
 
     qt_config->endGroup();
 }
@@ -1049,6 +1084,14 @@ void QtConfig::SaveCoreValues() {
 
     if (global) {
         WriteBasicSetting(Settings::values.use_cpu_jit);
+        WriteBasicSetting(Settings::values.jit_cache_budget);
+        WriteBasicSetting(Settings::values.use_fastmem);
+        WriteBasicSetting(Settings::values.use_multicore);
+        WriteBasicSetting(Settings::values.skip_busy_waits);
+        WriteBasicSetting(Settings::values.background_savestates);
+        WriteBasicSetting(Settings::values.savestate_compression_level);
+        WriteBasicSetting(Settings::values.rewind_interval);
+        WriteBasicSetting(Settings::values.rewind_buffer_size);
         WriteBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -1061,6 +1104,10 @@ void QtConfig::SaveDataStorageValues() {
     WriteBasicSetting(Settings::values.use_virtual_sd);
     WriteBasicSetting(Settings::values.use_custom_storage);
     WriteBasicSetting(Settings::values.compress_cia_installs);
+    WriteBasicSetting(Settings::values.cache_decrypted_romfs);
+    WriteBasicSetting(Settings::values.z3ds_frame_cache_size);
+    WriteBasicSetting(Settings::values.z3ds_compression_level);
+    WriteBasicSetting(Settings::values.z3ds_long_distance_matching);
     WriteSetting(QStringLiteral("nand_directory"),
                  QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)),
                  QStringLiteral(""));
@@ -1099,6 +1146,7 @@ void QtConfig::SaveLayoutValues() {
     WriteGlobalSetting(Settings::values.swap_eyes_3d);
     WriteGlobalSetting(Settings::values.render_3d_which_display);
     WriteGlobalSetting(Settings::values.filter_mode);
+    WriteGlobalSetting(Settings::values.spatial_upscaling);
     WriteGlobalSetting(Settings::values.pp_shader_name);
     WriteGlobalSetting(Settings::values.anaglyph_shader_name);
     WriteGlobalSetting(Settings::values.layout_option);
@@ -1234,6 +1282,7 @@ void QtConfig::SaveRendererValues() {
     WriteGlobalSetting(Settings::values.disable_spirv_optimizer);
     WriteGlobalSetting(Settings::values.async_shader_compilation);
     WriteGlobalSetting(Settings::values.async_presentation);
+    WriteBasicSetting(Settings::values.present_queue_depth);
     WriteGlobalSetting(Settings::values.use_hw_shader);
     WriteGlobalSetting(Settings::values.shaders_accurate_mul);
     WriteGlobalSetting(Settings::values.use_disk_shader_cache);
@@ -1251,6 +1300,18 @@ void QtConfig::SaveRendererValues() {
 
     WriteGlobalSetting(Settings::values.delay_game_render_thread_us);
     WriteGlobalSetting(Settings::values.disable_right_eye_render);
+    WriteGlobalSetting(Settings::values.async_texture_upload);
+    WriteGlobalSetting(Settings::values.gpu_texture_decode);
+    WriteGlobalSetting(Settings::values.accurate_mipmaps);
+    WriteGlobalSetting(Settings::values.texture_memory_budget);
+    WriteGlobalSetting(Settings::values.use_descriptor_buffer);
+    WriteGlobalSetting(Settings::values.parallel_command_recording);
+    WriteGlobalSetting(Settings::values.async_compute);
+    WriteGlobalSetting(Settings::values.frame_pacing);
+    WriteGlobalSetting(Settings::values.dynamic_resolution);
+    WriteGlobalSetting(Settings::values.auto_frame_skip);
+    WriteGlobalSetting(Settings::values.async_gpu);
+    WriteGlobalSetting(Settings::values.merge_stereo_renders);
 
     if (global) {
         WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit.GetValue(),
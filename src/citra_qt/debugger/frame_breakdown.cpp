@@ -0,0 +1,160 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <QCoreApplication>
+#include <QLabel>
+#include <QLayout>
+#include <QPainter>
+#include "citra_qt/debugger/frame_breakdown.h"
+#include "core/core.h"
+
+namespace {
+
+using FrameStage = Core::PerfStats::FrameStage;
+constexpr std::size_t FrameStageCount = Core::PerfStats::FrameStageCount;
+
+struct StageInfo {
+    const char* name;
+    QColor color;
+};
+
+const std::array<StageInfo, FrameStageCount> stage_info = {{
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "CPU"), QColor(70, 130, 180)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Kernel"), QColor(70, 200, 70)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Services"), QColor(160, 220, 90)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "PICA"), QColor(230, 160, 40)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Submit"), QColor(200, 110, 40)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Pipelines"), QColor(220, 50, 50)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Textures"), QColor(200, 80, 200)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Audio"), QColor(60, 200, 200)},
+    {QT_TRANSLATE_NOOP("FrameBreakdownWidget", "Present"), QColor(150, 150, 150)},
+}};
+
+QString StageName(std::size_t stage) {
+    return QCoreApplication::translate("FrameBreakdownWidget", stage_info[stage].name);
+}
+
+} // Anonymous namespace
+
+FrameBreakdownGraph::FrameBreakdownGraph(QWidget* parent) : QWidget(parent) {
+    setMinimumSize(320, 160);
+}
+
+void FrameBreakdownGraph::SetFrames(std::vector<Core::PerfStats::FrameBreakdown> frames_) {
+    frames = std::move(frames_);
+    update();
+}
+
+void FrameBreakdownGraph::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+
+    // The scale always shows twice the budget, growing when a frame takes even longer
+    const double budget = Core::PerfStats::GetFrameBudget();
+    double max_time = budget * 2;
+    for (const auto& frame : frames) {
+        max_time = std::max(max_time, static_cast<double>(frame.frame_time));
+    }
+    const qreal legend_height = fontMetrics().height() + 4;
+    const qreal graph_height = height() - legend_height;
+    const qreal y_scale = graph_height / max_time;
+    const qreal bar_width = static_cast<qreal>(width()) / Core::PerfStats::FrameHistorySize;
+
+    // Newest frames are drawn on the right
+    qreal x = width() - bar_width * frames.size();
+    for (const auto& frame : frames) {
+        qreal y = height();
+        for (std::size_t stage = 0; stage < FrameStageCount; stage++) {
+            const qreal bar_height = frame.stages[stage] * y_scale;
+            painter.fillRect(QRectF(x, y - bar_height, bar_width, bar_height),
+                             stage_info[stage].color);
+            y -= bar_height;
+        }
+        if (frame.stutter) {
+            painter.fillRect(QRectF(x, legend_height, bar_width, 3), Qt::red);
+        }
+        x += bar_width;
+    }
+
+    const qreal budget_y = height() - budget * y_scale;
+    painter.setPen(QPen(Qt::white, 1, Qt::DashLine));
+    painter.drawLine(QPointF(0, budget_y), QPointF(width(), budget_y));
+    painter.drawText(QPointF(4, budget_y - 4), tr("%1 ms").arg(budget, 0, 'f', 1));
+
+    qreal legend_x = 4;
+    const qreal swatch = fontMetrics().height() - 4;
+    for (std::size_t stage = 0; stage < FrameStageCount; stage++) {
+        painter.fillRect(QRectF(legend_x, 4, swatch, swatch), stage_info[stage].color);
+        legend_x += swatch + 4;
+        const QString name = StageName(stage);
+        painter.setPen(Qt::white);
+        painter.drawText(QPointF(legend_x, fontMetrics().ascent() + 2), name);
+        legend_x += fontMetrics().horizontalAdvance(name) + 8;
+    }
+}
+
+FrameBreakdownWidget::FrameBreakdownWidget(const Core::System& system_, QWidget* parent)
+    : QDockWidget(tr("Frame Time Breakdown"), parent), system{system_} {
+    setObjectName(QStringLiteral("FrameBreakdownWidget"));
+
+    graph = new FrameBreakdownGraph;
+    stutter_label = new QLabel;
+    stutter_label->setWordWrap(true);
+
+    QWidget* contents = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->addWidget(graph, 1);
+    layout->addWidget(stutter_label);
+    contents->setLayout(layout);
+    setWidget(contents);
+
+    update_timer.setInterval(100);
+    connect(&update_timer, &QTimer::timeout, this, &FrameBreakdownWidget::Update);
+}
+
+FrameBreakdownWidget::~FrameBreakdownWidget() = default;
+
+void FrameBreakdownWidget::showEvent(QShowEvent* event) {
+    update_timer.start();
+    QDockWidget::showEvent(event);
+}
+
+void FrameBreakdownWidget::hideEvent(QHideEvent* event) {
+    update_timer.stop();
+    QDockWidget::hideEvent(event);
+}
+
+void FrameBreakdownWidget::Update() {
+    if (!system.IsPoweredOn() || !system.perf_stats) {
+        graph->SetFrames({});
+        return;
+    }
+
+    auto frames = system.perf_stats->GetFrameHistory();
+    const auto last_stutter = std::find_if(frames.rbegin(), frames.rend(),
+                                           [](const auto& frame) { return frame.stutter; });
+    if (last_stutter != frames.rend()) {
+        const auto& stages = last_stutter->stages;
+        const std::size_t worst_stage = std::distance(
+            stages.begin(), std::max_element(stages.begin(), stages.end()));
+        QString text = tr("Last stutter: %1 ms, mostly %2 (%3 ms)")
+                           .arg(last_stutter->frame_time, 0, 'f', 1)
+                           .arg(StageName(worst_stage))
+                           .arg(stages[worst_stage], 0, 'f', 1);
+        if (last_stutter->slowest_service_time > 0) {
+            const auto& service = last_stutter->slowest_service;
+            const QString service_name = QString::fromLatin1(
+                service.data(), std::find(service.begin(), service.end(), '\0') - service.begin());
+            text += tr(", slowest service %1 (%2 ms)")
+                        .arg(service_name)
+                        .arg(last_stutter->slowest_service_time, 0, 'f', 1);
+        }
+        stutter_label->setText(text);
+    } else {
+        stutter_label->setText(tr("No stutter in the last %1 frames").arg(frames.size()));
+    }
+    graph->SetFrames(std::move(frames));
+}
@@ -0,0 +1,53 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include <QDockWidget>
+#include <QTimer>
+#include "core/perf_stats.h"
+
+class QLabel;
+
+namespace Core {
+class System;
+}
+
+/// Draws the stage breakdown of the recent frames as stacked bars against the frame budget
+class FrameBreakdownGraph : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit FrameBreakdownGraph(QWidget* parent = nullptr);
+
+    void SetFrames(std::vector<Core::PerfStats::FrameBreakdown> frames);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    std::vector<Core::PerfStats::FrameBreakdown> frames;
+};
+
+class FrameBreakdownWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit FrameBreakdownWidget(const Core::System& system, QWidget* parent = nullptr);
+    ~FrameBreakdownWidget();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void Update();
+
+    const Core::System& system;
+    FrameBreakdownGraph* graph;
+    QLabel* stutter_label;
+    /// Refreshes the graph. To save resources, it only runs while the widget is visible.
+    QTimer update_timer;
+};
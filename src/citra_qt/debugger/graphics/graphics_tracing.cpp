@@ -62,6 +62,14 @@ void GraphicsTracingWidget::StartRecording() {
     if (!context)
         return;
 
+    const QString filename = QFileDialog::getSaveFileName(
+        this, tr("Save CiTrace"), QStringLiteral("citrace.ctf"), tr("CiTrace File (*.ctf)"));
+
+    if (filename.isEmpty()) {
+        // If the user canceled the dialog, don't start recording
+        return;
+    }
+
     auto& pica = system.GPU().PicaCore();
     const auto& shader_binary = pica.vs_setup.GetProgramCode();
     const auto& swizzle_data = pica.vs_setup.GetSwizzleData();
@@ -70,7 +78,7 @@ void GraphicsTracingWidget::StartRecording() {
     // TODO: Drop this explicit conversion once we store float24 values bit-correctly internally.
     std::array<u32, 4 * 16> default_attributes;
     for (u32 i = 0; i < 16; ++i) {
-        for (u32 comp = 0; comp < 3; ++comp) {
+        for (u32 comp = 0; comp < 4; ++comp) {
             default_attributes[4 * i + comp] =
                 nihstro::to_float24(pica.input_default_attributes[i][comp].ToFloat32());
         }
@@ -78,7 +86,7 @@ void GraphicsTracingWidget::StartRecording() {
 
     std::array<u32, 4 * 96> vs_float_uniforms;
     for (u32 i = 0; i < 96; ++i) {
-        for (u32 comp = 0; comp < 3; ++comp) {
+        for (u32 comp = 0; comp < 4; ++comp) {
             vs_float_uniforms[4 * i + comp] =
                 nihstro::to_float24(pica.vs_setup.uniforms.f[i][comp].ToFloat32());
         }
@@ -87,7 +95,7 @@ void GraphicsTracingWidget::StartRecording() {
     CiTrace::Recorder::InitialState state;
 
     const auto copy = [&](std::vector<u32>& dest, const auto& data) {
-        dest.resize(sizeof(data));
+        dest.resize(sizeof(data) / sizeof(u32));
         std::memcpy(dest.data(), std::addressof(data), sizeof(data));
     };
 
@@ -101,7 +109,13 @@ void GraphicsTracingWidget::StartRecording() {
     // copy(TODO: Not implemented, std::back_inserter(state.gs_swizzle_data));
     // copy(TODO: Not implemented, std::back_inserter(state.gs_float_uniforms));
 
-    context->recorder = std::make_shared<CiTrace::Recorder>(state);
+    auto recorder = std::make_shared<CiTrace::Recorder>(filename.toStdString(), state);
+    if (!recorder->IsGood()) {
+        QMessageBox::critical(this, tr("CiTrace Recorder"),
+                              tr("Could not create the CiTrace file %1.").arg(filename));
+        return;
+    }
+    context->recorder = std::move(recorder);
 
     emit SetStartTracingButtonEnabled(false);
     emit SetStopTracingButtonEnabled(true);
@@ -113,15 +127,10 @@ void GraphicsTracingWidget::StopRecording() {
     if (!context)
         return;
 
-    QString filename = QFileDialog::getSaveFileName(
-        this, tr("Save CiTrace"), QStringLiteral("citrace.ctf"), tr("CiTrace File (*.ctf)"));
-
-    if (filename.isEmpty()) {
-        // If the user canceled the dialog, keep recording
-        return;
+    if (!context->recorder->Finish()) {
+        QMessageBox::critical(this, tr("CiTrace Recorder"),
+                              tr("Writing the CiTrace file failed, see the log for details."));
     }
-
-    context->recorder->Finish(filename.toStdString());
     context->recorder = nullptr;
 
     emit SetStopTracingButtonEnabled(false);
@@ -134,6 +143,9 @@ void GraphicsTracingWidget::AbortRecording() {
     if (!context)
         return;
 
+    if (context->recorder) {
+        context->recorder->Abort();
+    }
     context->recorder = nullptr;
 
     emit SetStopTracingButtonEnabled(false);
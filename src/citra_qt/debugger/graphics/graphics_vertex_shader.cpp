@@ -522,10 +522,12 @@ void GraphicsVertexShaderWidget::Reload(bool replace_vertex_data, const void* ve
     u32 entry_point = pica.regs.internal.vs.main_offset;
     info.labels.insert({entry_point, "main"});
 
-    // Generate debug information
+    // Generate debug information. The shader is set up on a copy, so that the emulated one keeps
+    // the programs of the engine running it.
+    Pica::ShaderSetup setup = pica.vs_setup;
     Pica::Shader::InterpreterEngine shader_engine;
-    shader_engine.SetupBatch(pica.vs_setup, entry_point);
-    debug_data = shader_engine.ProduceDebugInfo(pica.vs_setup, input_vertex, pica.regs.internal.vs);
+    shader_engine.SetupBatch(setup, entry_point);
+    debug_data = shader_engine.ProduceDebugInfo(setup, input_vertex, pica.regs.internal.vs);
 
     // Reload widget state
     for (int attr = 0; attr < num_attributes; ++attr) {
@@ -80,8 +80,14 @@ void IPCRecorderWidget::OnEntryUpdated(IPCDebugger::RequestRecord record) {
         service = QStringLiteral("%1 (%2)").arg(service, record.is_hle ? tr("HLE") : tr("LLE"));
     }
 
-    QTreeWidgetItem entry{
-        {QString::number(record.id), GetStatusStr(record), service, GetFunctionName(record)}};
+    QString handler_time;
+    if (record.is_hle && record.status == IPCDebugger::RequestStatus::Handled) {
+        handler_time = QStringLiteral("%1 us").arg(
+            std::chrono::duration<double, std::micro>(record.hle_handler_time).count(), 0, 'f', 1);
+    }
+
+    QTreeWidgetItem entry{{QString::number(record.id), GetStatusStr(record), service,
+                           GetFunctionName(record), handler_time}};
 
     const int row_id = record.id - id_offset;
     if (ui->main->invisibleRootItem()->childCount() > row_id) {
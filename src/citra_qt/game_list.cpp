@@ -634,6 +634,7 @@ void GameList::AddGamePopup(QMenu& context_menu, const QString& path, const QStr
     QAction* open_mods_location = open_menu->addAction(tr("Mods Location"));
 
     QAction* dump_romfs = context_menu.addAction(tr("Dump RomFS"));
+    QAction* build_texture_pack = context_menu.addAction(tr("Build Custom Texture Pack"));
 
     QMenu* shader_menu = context_menu.addMenu(tr("Disk Shader Cache"));
     QAction* open_shader_cache_location = shader_menu->addAction(tr("Open Shader Cache Location"));
@@ -716,6 +717,10 @@ void GameList::AddGamePopup(QMenu& context_menu, const QString& path, const QStr
     open_texture_load_location->setEnabled(is_application);
     open_mods_location->setEnabled(is_application);
     dump_romfs->setEnabled(is_application);
+    build_texture_pack->setEnabled(
+        is_application && FileUtil::Exists(fmt::format(
+                              "{}textures/{:016X}/",
+                              FileUtil::GetUserPath(FileUtil::UserPath::LoadDir), program_id)));
 
 #ifdef ENABLE_OPENGL
     delete_opengl_disk_shader_cache->setEnabled(opengl_cache_exists);
@@ -783,6 +788,8 @@ void GameList::AddGamePopup(QMenu& context_menu, const QString& path, const QStr
     });
     connect(dump_romfs, &QAction::triggered, this,
             [this, path, program_id] { emit DumpRomFSRequested(path, program_id); });
+    connect(build_texture_pack, &QAction::triggered, this,
+            [this, program_id] { emit BuildTexturePackRequested(program_id); });
     connect(remove_play_time_data, &QAction::triggered,
             [this, program_id]() { emit RemovePlayTimeRequested(program_id); });
 #ifdef ENABLE_DEVELOPER_OPTIONS
@@ -7,9 +7,12 @@
 // Refer to the license.txt file included.
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
+#include <fmt/format.h>
 #include <QDir>
 #include <QFileInfo>
 #include "citra_qt/compatibility_list.h"
@@ -17,17 +20,67 @@
 #include "citra_qt/game_list_p.h"
 #include "citra_qt/game_list_worker.h"
 #include "citra_qt/uisettings.h"
+#include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/task_scheduler.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
 
 namespace {
+
+constexpr u32 MetadataCacheMagic = 0x434D4C47; // "GLMC"
+/// Bump this whenever the loaders start reporting something different for the same file.
+constexpr u32 MetadataCacheVersion = 1;
+
+struct MetadataCacheHeader {
+    u32 magic;
+    u32 version;
+    u32 num_entries;
+};
+
+struct MetadataCacheEntry {
+    u64 size;
+    s64 last_write_time;
+    s64 update_write_time;
+    u64 program_id;
+    u64 extdata_id;
+    u32 file_type;
+    u8 listed;
+    u8 encrypted;
+    u8 compressed;
+    INSERT_PADDING_BYTES(1);
+    u32 path_length;
+    u32 smdh_size;
+};
+static_assert(std::is_trivially_copyable_v<MetadataCacheEntry>);
+
 bool HasSupportedFileExtension(const std::string& file_name) {
     const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
     return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
 }
+
+std::string GetMetadataCachePath() {
+    return fmt::format("{}game_list/metadata.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir));
+}
+
+/// Returns the path of the installed update of program_id, if it is an application.
+std::optional<std::string> GetUpdatePath(u64 program_id) {
+    if (program_id & ~0x00040000FFFFFFFF) {
+        return std::nullopt;
+    }
+    return Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC,
+                                            program_id | 0x0000000E00000000);
+}
+
+s64 GetUpdateWriteTime(u64 program_id) {
+    const auto update_path = GetUpdatePath(program_id);
+    return update_path ? FileUtil::GetLastWriteTime(*update_path) : 0;
+}
+
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
@@ -52,78 +105,28 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
         const std::string physical_name = directory + DIR_SEP + virtual_name;
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader) {
-                return true;
-            }
+            const u64 size = FileUtil::GetSize(physical_name);
+            const s64 last_write_time = FileUtil::GetLastWriteTime(physical_name);
 
-            bool executable = false;
-            const auto res = loader->IsExecutable(executable);
-            if (!executable && res != Loader::ResultStatus::ErrorEncrypted) {
+            // Files that haven't changed since the last scan don't need to be opened again.
+            const auto it = metadata_cache.find(physical_name);
+            if (it != metadata_cache.end() && last_write_time != 0 && it->second.size == size &&
+                it->second.last_write_time == last_write_time &&
+                it->second.update_write_time == GetUpdateWriteTime(it->second.program_id)) {
+                AddGameEntry(physical_name, it->second, parent_dir, media_type);
                 return true;
             }
 
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh;
-            // Look for an update icon if available
-            if (!(program_id & ~0x00040000FFFFFFFF)) {
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id | 0x0000000E00000000);
-                if (FileUtil::Exists(update_path)) {
-                    std::unique_ptr<Loader::AppLoader> update_loader =
-                        Loader::GetLoader(update_path);
-                    if (update_loader) {
-                        update_loader->ReadIcon(smdh);
-                    }
-                }
-            }
-
-            if (!Loader::IsValidSMDH(smdh)) {
-                // Read the original smdh if there is no valid update smdh
-                loader->ReadIcon(smdh);
-            }
-
-            const auto system_title = ((program_id >> 32) & 0xFFFFFFFF) == 0x00040010;
-            if (Loader::IsValidSMDH(smdh)) {
-                if (system_title) {
-                    auto smdh_struct = reinterpret_cast<Loader::SMDH*>(smdh.data());
-                    if (!smdh_struct->flags.visible) {
-                        // Skip system titles without the visible flag.
-                        return true;
+            pending_reads.push_back(Common::GetTaskScheduler().Enqueue(
+                [this, physical_name, size, last_write_time, parent_dir, media_type] {
+                    if (stop_processing) {
+                        return;
                     }
-                }
-            } else if (UISettings::values.game_list_hide_no_icon || system_title) {
-                // Skip this invalid entry
-                return true;
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility(QStringLiteral("99"));
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id, media_type,
-                                         res == Loader::ResultStatus::ErrorEncrypted,
-                                         loader->GetFileType() == Loader::FileType::CCI),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(QString::fromStdString(Loader::GetFileTypeString(
-                        loader->GetFileType(), loader->IsFileCompressed()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                    new GameListItemPlayTime(play_time_manager.GetPlayTime(program_id)),
+                    AddGameEntry(physical_name,
+                                 ReadGameMetadata(physical_name, size, last_write_time),
+                                 parent_dir, media_type);
                 },
-                parent_dir);
-
+                Common::TaskPriority::Background));
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
             AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir, media_type);
@@ -135,8 +138,174 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+GameListWorker::GameMetadata GameListWorker::ReadGameMetadata(const std::string& physical_name,
+                                                              u64 size, s64 last_write_time) {
+    GameMetadata metadata;
+    metadata.size = size;
+    metadata.last_write_time = last_write_time;
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
+    if (!loader) {
+        return metadata;
+    }
+
+    bool executable = false;
+    const auto res = loader->IsExecutable(executable);
+    if (!executable && res != Loader::ResultStatus::ErrorEncrypted) {
+        return metadata;
+    }
+
+    metadata.listed = true;
+    metadata.encrypted = res == Loader::ResultStatus::ErrorEncrypted;
+    metadata.file_type = static_cast<u32>(loader->GetFileType());
+    metadata.compressed = loader->IsFileCompressed();
+    loader->ReadProgramId(metadata.program_id);
+    loader->ReadExtdataId(metadata.extdata_id);
+
+    // Look for an update icon if available
+    if (const auto update_path = GetUpdatePath(metadata.program_id);
+        update_path && FileUtil::Exists(*update_path)) {
+        metadata.update_write_time = FileUtil::GetLastWriteTime(*update_path);
+        std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(*update_path);
+        if (update_loader) {
+            update_loader->ReadIcon(metadata.smdh);
+        }
+    }
+
+    if (!Loader::IsValidSMDH(metadata.smdh)) {
+        // Read the original smdh if there is no valid update smdh
+        loader->ReadIcon(metadata.smdh);
+    }
+
+    return metadata;
+}
+
+void GameListWorker::AddGameEntry(const std::string& physical_name, const GameMetadata& metadata,
+                                  GameListDir* parent_dir, Service::FS::MediaType media_type) {
+    {
+        std::scoped_lock lock{scanned_metadata_mutex};
+        scanned_metadata.insert_or_assign(physical_name, metadata);
+    }
+
+    if (!metadata.listed) {
+        return;
+    }
+
+    const u64 program_id = metadata.program_id;
+    const auto& smdh = metadata.smdh;
+    const auto system_title = ((program_id >> 32) & 0xFFFFFFFF) == 0x00040010;
+    if (Loader::IsValidSMDH(smdh)) {
+        if (system_title) {
+            auto smdh_struct = reinterpret_cast<const Loader::SMDH*>(smdh.data());
+            if (!smdh_struct->flags.visible) {
+                // Skip system titles without the visible flag.
+                return;
+            }
+        }
+    } else if (UISettings::values.game_list_hide_no_icon || system_title) {
+        // Skip this invalid entry
+        return;
+    }
+
+    auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
+
+    // The game list uses this as compatibility number for untested games
+    QString compatibility(QStringLiteral("99"));
+    if (it != compatibility_list.end())
+        compatibility = it->second.first;
+
+    const auto file_type = static_cast<Loader::FileType>(metadata.file_type);
+    emit EntryReady(
+        {
+            new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
+                                 metadata.extdata_id, media_type, metadata.encrypted,
+                                 file_type == Loader::FileType::CCI),
+            new GameListItemCompat(compatibility),
+            new GameListItemRegion(smdh),
+            new GameListItem(QString::fromStdString(
+                Loader::GetFileTypeString(file_type, metadata.compressed))),
+            new GameListItemSize(metadata.size),
+            new GameListItemPlayTime(play_time_manager.GetPlayTime(program_id)),
+        },
+        parent_dir);
+}
+
+void GameListWorker::LoadMetadataCache() {
+    FileUtil::IOFile file(GetMetadataCachePath(), "rb");
+    if (!file.IsOpen()) {
+        return;
+    }
+
+    MetadataCacheHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != MetadataCacheMagic || header.version != MetadataCacheVersion) {
+        return;
+    }
+
+    for (u32 i = 0; i < header.num_entries; i++) {
+        MetadataCacheEntry entry{};
+        if (file.ReadBytes(&entry, sizeof(entry)) != sizeof(entry)) {
+            break;
+        }
+        std::string path(entry.path_length, '\0');
+        GameMetadata metadata;
+        metadata.smdh.resize(entry.smdh_size);
+        if (file.ReadBytes(path.data(), path.size()) != path.size() ||
+            file.ReadBytes(metadata.smdh.data(), metadata.smdh.size()) != metadata.smdh.size()) {
+            break;
+        }
+        metadata.size = entry.size;
+        metadata.last_write_time = entry.last_write_time;
+        metadata.update_write_time = entry.update_write_time;
+        metadata.program_id = entry.program_id;
+        metadata.extdata_id = entry.extdata_id;
+        metadata.file_type = entry.file_type;
+        metadata.listed = entry.listed != 0;
+        metadata.encrypted = entry.encrypted != 0;
+        metadata.compressed = entry.compressed != 0;
+        metadata_cache.insert_or_assign(std::move(path), std::move(metadata));
+    }
+}
+
+void GameListWorker::SaveMetadataCache() const {
+    const std::string path = GetMetadataCachePath();
+    if (!FileUtil::CreateFullPath(path)) {
+        return;
+    }
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_WARNING(Frontend, "Unable to write game list cache {}", path);
+        return;
+    }
+
+    const MetadataCacheHeader header{
+        .magic = MetadataCacheMagic,
+        .version = MetadataCacheVersion,
+        .num_entries = static_cast<u32>(scanned_metadata.size()),
+    };
+    file.WriteObject(header);
+    for (const auto& [physical_name, metadata] : scanned_metadata) {
+        MetadataCacheEntry entry{};
+        entry.size = metadata.size;
+        entry.last_write_time = metadata.last_write_time;
+        entry.update_write_time = metadata.update_write_time;
+        entry.program_id = metadata.program_id;
+        entry.extdata_id = metadata.extdata_id;
+        entry.file_type = metadata.file_type;
+        entry.listed = metadata.listed;
+        entry.encrypted = metadata.encrypted;
+        entry.compressed = metadata.compressed;
+        entry.path_length = static_cast<u32>(physical_name.size());
+        entry.smdh_size = static_cast<u32>(metadata.smdh.size());
+        file.WriteObject(entry);
+        file.WriteString(physical_name);
+        file.WriteBytes(metadata.smdh.data(), metadata.smdh.size());
+    }
+}
+
 void GameListWorker::run() {
     stop_processing = false;
+    LoadMetadataCache();
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == QStringLiteral("INSTALLED")) {
             QString games_path =
@@ -176,6 +345,17 @@ void GameListWorker::run() {
         }
     }
 
+    // Files read on the task scheduler report their entries as they complete.
+    for (auto& read : pending_reads) {
+        read.wait();
+    }
+    pending_reads.clear();
+
+    // A cancelled scan only saw part of the library, keep the previous cache instead.
+    if (!stop_processing) {
+        SaveMetadataCache();
+    }
+
     emit Finished(watch_list);
 }
 
@@ -9,8 +9,12 @@
 #pragma once
 
 #include <atomic>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
@@ -61,13 +65,46 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    /// Everything the game list needs to know about a file, as read by its loader.
+    struct GameMetadata {
+        u64 size = 0;
+        s64 last_write_time = 0;
+        /// Last write time of the installed update the icon was taken from, 0 if there is none.
+        s64 update_write_time = 0;
+        /// Whether the file is something the game list should show at all.
+        bool listed = false;
+        bool encrypted = false;
+        bool compressed = false;
+        u32 file_type = 0;
+        u64 program_id = 0;
+        u64 extdata_id = 0;
+        std::vector<u8> smdh;
+    };
+
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir, Service::FS::MediaType media_type);
 
+    /// Opens the file with its loader and reads the metadata shown in the list.
+    static GameMetadata ReadGameMetadata(const std::string& physical_name, u64 size,
+                                         s64 last_write_time);
+    void AddGameEntry(const std::string& physical_name, const GameMetadata& metadata,
+                      GameListDir* parent_dir, Service::FS::MediaType media_type);
+
+    void LoadMetadataCache();
+    void SaveMetadataCache() const;
+
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
     const PlayTime::PlayTimeManager& play_time_manager;
 
+    /// Metadata from the previous scan, keyed by the path of the file.
+    std::unordered_map<std::string, GameMetadata> metadata_cache;
+    /// Metadata of the files found by this scan, written back to disk once it completes.
+    std::unordered_map<std::string, GameMetadata> scanned_metadata;
+    std::mutex scanned_metadata_mutex;
+    /// Files that missed the cache and are being read on the task scheduler.
+    std::vector<std::future<void>> pending_reads;
+
     QStringList watch_list;
     std::atomic_bool stop_processing;
 };
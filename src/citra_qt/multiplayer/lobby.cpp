@@ -31,6 +31,7 @@ Lobby::Lobby(Core::System& system_, QWidget* parent, QStandardItemModel* list,
     watcher = new QFutureWatcher<void>(this);
 
     model = new QStandardItemModel(ui->room_list);
+    ResetModel();
 
     // Create a proxy to the game list to get the list of games owned
     game_list = new QStandardItemModel(this);
@@ -97,6 +98,8 @@ void Lobby::UpdateGameList(QStandardItemModel* list) {
             game_list->appendRow(parent->child(j)->clone());
         }
     }
+    // Rebuild every row at the next refresh to update the icons of the owned games
+    shown_rooms.clear();
     if (proxy)
         proxy->UpdateGameList(game_list);
 }
@@ -195,6 +198,7 @@ void Lobby::OnJoinRoom(const QModelIndex& source) {
 
 void Lobby::ResetModel() {
     model->clear();
+    shown_rooms.clear();
     model->insertColumns(0, Column::TOTAL);
     model->setHeaderData(Column::EXPAND, Qt::Horizontal, QString(), Qt::DisplayRole);
     model->setHeaderData(Column::ROOM_NAME, Qt::Horizontal, tr("Room Name"), Qt::DisplayRole);
@@ -206,7 +210,6 @@ void Lobby::ResetModel() {
 
 void Lobby::RefreshLobby() {
     if (auto session = announce_multiplayer_session.lock()) {
-        ResetModel();
         ui->refresh_list->setEnabled(false);
         ui->refresh_list->setText(tr("Refreshing"));
         room_list_watcher.setFuture(
@@ -217,8 +220,41 @@ void Lobby::RefreshLobby() {
 }
 
 void Lobby::OnRefreshLobby() {
-    AnnounceMultiplayerRoom::RoomList new_room_list = room_list_watcher.result();
-    for (auto room : new_room_list) {
+    const AnnounceMultiplayerRoom::RoomList new_room_list = room_list_watcher.result();
+    const auto room_key = [](const AnnounceMultiplayerRoom::Room& room) {
+        return fmt::format("{}:{}", room.ip, room.port);
+    };
+    std::unordered_map<std::string, const AnnounceMultiplayerRoom::Room*> new_rooms;
+    for (const auto& room : new_room_list) {
+        new_rooms.emplace(room_key(room), &room);
+    }
+
+    // Only the rows of rooms that closed or changed since the last refresh are removed, the rows
+    // of unchanged rooms are kept as they are
+    for (int r = model->rowCount() - 1; r >= 0; --r) {
+        const std::string key =
+            model->item(r, 0)->data(LobbyItem::RoomKeyRole).toString().toStdString();
+        const auto new_room = new_rooms.find(key);
+        const auto shown_room = shown_rooms.find(key);
+        if (new_room != new_rooms.end() && shown_room != shown_rooms.end() &&
+            shown_room->second == *new_room->second) {
+            new_rooms.erase(new_room);
+            continue;
+        }
+        model->removeRow(r);
+        if (shown_room != shown_rooms.end()) {
+            shown_rooms.erase(shown_room);
+        }
+    }
+
+    for (const auto& room : new_room_list) {
+        const std::string key = room_key(room);
+        if (!new_rooms.contains(key)) {
+            continue;
+        }
+        new_rooms.erase(key);
+        shown_rooms.insert_or_assign(key, room);
+
         // find the icon for the game if this person owns that game.
         QPixmap smdh_icon;
         for (int r = 0; r < game_list->rowCount(); ++r) {
@@ -239,6 +275,7 @@ void Lobby::OnRefreshLobby() {
         }
 
         auto first_item = new LobbyItem();
+        first_item->setData(QString::fromStdString(key), LobbyItem::RoomKeyRole);
         auto row = QList<QStandardItem*>({
             first_item,
             new LobbyItemName(room.has_password, QString::fromStdString(room.name)),
@@ -5,6 +5,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <QDialog>
 #include <QFutureWatcher>
 #include <QSortFilterProxyModel>
@@ -78,7 +80,7 @@ signals:
 
 private:
     /**
-     * Removes all entries in the Lobby before refreshing.
+     * Removes all entries in the Lobby.
      */
     void ResetModel();
 
@@ -96,6 +98,9 @@ private:
     QStandardItemModel* game_list{};
     LobbyFilterProxyModel* proxy{};
 
+    /// The rooms shown in the model by their address, to only update the rows of changed rooms
+    std::unordered_map<std::string, AnnounceMultiplayerRoom::Room> shown_rooms;
+
     QFutureWatcher<AnnounceMultiplayerRoom::RoomList> room_list_watcher;
     std::weak_ptr<Network::AnnounceMultiplayerSession> announce_multiplayer_session;
     QFutureWatcher<void>* watcher;
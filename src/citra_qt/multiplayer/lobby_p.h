@@ -23,6 +23,9 @@ enum List {
 
 class LobbyItem : public QStandardItem {
 public:
+    /// Role of the first column holding the address of the room, which identifies its row
+    static const int RoomKeyRole = Qt::UserRole + 1;
+
     LobbyItem() = default;
     explicit LobbyItem(const QString& string) : QStandardItem(string) {}
     virtual ~LobbyItem() override = default;
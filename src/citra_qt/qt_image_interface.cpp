@@ -33,10 +33,12 @@ bool QtImageInterface::DecodePNG(std::vector<u8>& dst, u32& width, u32& height,
 }
 
 bool QtImageInterface::EncodePNG(const std::string& path, u32 width, u32 height,
-                                 std::span<const u8> src) {
+                                 std::span<const u8> src, bool fast) {
     QImage image(src.data(), width, height, QImage::Format_RGBA8888);
 
-    if (!image.save(QString::fromStdString(path), "PNG")) {
+    // Qt maps the quality of png files to the zlib level, 80 selects the fastest compression
+    const int quality = fast ? 80 : -1;
+    if (!image.save(QString::fromStdString(path), "PNG", quality)) {
         LOG_ERROR(Frontend, "Failed to save {}", path);
         return false;
     }
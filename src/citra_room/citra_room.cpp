@@ -2,12 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 #include <cryptopp/base64.h>
 
 #ifdef _WIN32
@@ -46,6 +48,7 @@ static void PrintHelp(const char* argv0) {
                  "--room-name         The name of the room\n"
                  "--room-description  The room description\n"
                  "--port              The port used for the room\n"
+                 "--room-count        The number of rooms hosted on consecutive ports\n"
                  "--max_members       The maximum number of players for this room\n"
                  "--password          The password for the room\n"
                  "--preferred-app     The preferred application for this room\n"
@@ -152,6 +155,19 @@ static void SaveBanList(const Network::Room::BanList& ban_list, const std::strin
     file.flush();
 }
 
+/// Adds the entries of ban_list that are missing from merged to merged.
+static void MergeBanList(Network::Room::BanList& merged, const Network::Room::BanList& ban_list) {
+    const auto merge = [](std::vector<std::string>& to, const std::vector<std::string>& from) {
+        for (const auto& entry : from) {
+            if (std::find(to.begin(), to.end(), entry) == to.end()) {
+                to.push_back(entry);
+            }
+        }
+    };
+    merge(merged.first, ban_list.first);
+    merge(merged.second, ban_list.second);
+}
+
 static void InitializeLogging(const std::string& log_file) {
     Common::Log::Initialize(log_file);
     Common::Log::SetColorConsoleBackendEnabled(true);
@@ -180,11 +196,13 @@ int LaunchRoom(int argc, char** argv, bool called_by_option) {
     u64 preferred_game_id = 0;
     u16 port = Network::DefaultRoomPort;
     u32 max_members = 16;
+    u32 room_count = 1;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
         {"room-description", required_argument, 0, 'd'},
         {"port", required_argument, 0, 'p'},
+        {"room-count", required_argument, 0, 'c'},
         {"max_members", required_argument, 0, 'm'},
         {"password", required_argument, 0, 'w'},
         {"preferred-app", required_argument, 0, 's'},
@@ -208,7 +226,7 @@ int LaunchRoom(int argc, char** argv, bool called_by_option) {
 
     while (optind < argc) {
         int arg =
-            getopt_long(argc, argv, "n:d:p:m:w:s:u:t:a:i:l:hveg", long_options, &option_index);
+            getopt_long(argc, argv, "n:d:p:c:m:w:s:u:t:a:i:l:hveg", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'n':
@@ -220,6 +238,9 @@ int LaunchRoom(int argc, char** argv, bool called_by_option) {
             case 'p':
                 port = static_cast<u16>(strtoul(optarg, &endarg, 0));
                 break;
+            case 'c':
+                room_count = strtoul(optarg, &endarg, 0);
+                break;
             case 'm':
                 max_members = strtoul(optarg, &endarg, 0);
                 break;
@@ -294,6 +315,12 @@ int LaunchRoom(int argc, char** argv, bool called_by_option) {
         PrintHelp(argv[0]);
         return -1;
     }
+    if (room_count < 1 || static_cast<u32>(port) + room_count - 1 > 65535) {
+        std::cout << "room-count needs to be at least 1 and the ports of the rooms need to be in "
+                     "the range 0 - 65535!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
     if (ban_list_file.empty()) {
         std::cout << "Ban list file not set!\nThis should get set to load and save room ban "
                      "list.\nSet with --ban-list-file <file>\n\n";
@@ -330,33 +357,58 @@ int LaunchRoom(int argc, char** argv, bool called_by_option) {
         ban_list = LoadBanList(ban_list_file);
     }
 
-    std::unique_ptr<Network::VerifyUser::Backend> verify_backend;
-    if (announce) {
+    const auto make_verify_backend = [announce]() -> std::unique_ptr<Network::VerifyUser::Backend> {
+        if (announce) {
 #ifdef ENABLE_WEB_SERVICE
-        verify_backend =
-            std::make_unique<WebService::VerifyUserJWT>(NetSettings::values.web_api_url);
-#else
+            return std::make_unique<WebService::VerifyUserJWT>(NetSettings::values.web_api_url);
+#endif
+        }
+        return std::make_unique<Network::VerifyUser::NullBackend>();
+    };
+#ifndef ENABLE_WEB_SERVICE
+    if (announce) {
         std::cout
             << "Citra Web Services is not available with this build: validation is disabled.\n\n";
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
-#endif
-    } else {
-        verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
     }
+#endif
 
     Network::Init();
-    if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
-        if (!room->Create(room_name, room_description, "", port, password, max_members, username,
-                          preferred_game, preferred_game_id, std::move(verify_backend), ban_list)) {
-            std::cout << "Failed to create room: \n\n";
-            return -1;
+    {
+        // Every room has its own socket, members and ban list, but one thread services all of them
+        Network::RoomHost room_host;
+        for (u32 i = 0; i < room_count; ++i) {
+            const std::string name =
+                room_count > 1 ? room_name + " " + std::to_string(i + 1) : room_name;
+            auto room = std::make_shared<Network::Room>();
+            if (!room->Create(name, room_description, "", static_cast<u16>(port + i), password,
+                              max_members, username, preferred_game, preferred_game_id,
+                              make_verify_backend(), ban_list, false)) {
+                std::cout << "Failed to create room: \n\n";
+                return -1;
+            }
+            room_host.AddRoom(std::move(room));
         }
-        std::cout << "Room is open. Close with Q+Enter...\n\n";
-        auto announce_session = std::make_unique<Network::AnnounceMultiplayerSession>();
-        if (announce) {
-            announce_session->Start();
+        room_host.Start();
+        std::cout << (room_count > 1 ? "Rooms are open" : "Room is open")
+                  << ". Close with Q+Enter...\n\n";
+
+        // The web service registers and updates rooms one at a time, so each room is announced
+        // by its own session.
+        std::vector<std::unique_ptr<Network::AnnounceMultiplayerSession>> announce_sessions;
+        for (const auto& room : room_host.GetRooms()) {
+            auto& session = announce_sessions.emplace_back(
+                std::make_unique<Network::AnnounceMultiplayerSession>(room));
+            if (announce) {
+                session->Start();
+            }
         }
-        while (room->GetState() == Network::Room::State::Open) {
+        const auto any_room_open = [&room_host] {
+            const auto& rooms = room_host.GetRooms();
+            return std::any_of(rooms.begin(), rooms.end(), [](const auto& room) {
+                return room->GetState() == Network::Room::State::Open;
+            });
+        };
+        while (any_room_open()) {
             std::string in;
             std::cin >> in;
             if (in.size() > 0) {
@@ -365,14 +417,20 @@ int LaunchRoom(int argc, char** argv, bool called_by_option) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         if (announce) {
-            announce_session->Stop();
+            for (auto& session : announce_sessions) {
+                session->Stop();
+            }
         }
-        announce_session.reset();
-        // Save the ban list
+        announce_sessions.clear();
+        // Save the ban list, holding the bans of every room
         if (!ban_list_file.empty()) {
-            SaveBanList(room->GetBanList(), ban_list_file);
+            Network::Room::BanList merged_ban_list;
+            for (const auto& room : room_host.GetRooms()) {
+                MergeBanList(merged_ban_list, room->GetBanList());
+            }
+            SaveBanList(merged_ban_list, ban_list_file);
         }
-        room->Destroy();
+        room_host.Stop();
     }
     Network::Shutdown();
     return 0;
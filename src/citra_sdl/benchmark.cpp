@@ -0,0 +1,70 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "citra_sdl/benchmark.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/frontend/framebuffer_layout.h"
+#include "video_core/gpu.h"
+#include "video_core/renderer_base.h"
+
+BenchmarkRecorder::BenchmarkRecorder(Core::System& system_, const std::string& path,
+                                     u32 checkpoint_interval_)
+    : system{system_}, file{path, "w"}, checkpoint_interval{checkpoint_interval_} {
+    if (!file.IsOpen()) {
+        LOG_CRITICAL(Frontend, "Could not open benchmark output {}", path);
+        return;
+    }
+    file.WriteString("frame,frametime_ms,svc_ms,ipc_ms,gpu_ms,swap_ms,remaining_ms,"
+                     "framebuffer_hash\n");
+}
+
+BenchmarkRecorder::~BenchmarkRecorder() = default;
+
+void BenchmarkRecorder::Update() {
+    auto& renderer = system.GPU().Renderer();
+    const s32 frame = renderer.GetCurrentFrame();
+    if (frame == last_frame) {
+        return;
+    }
+    last_frame = frame;
+
+    // Resetting the stats every frame turns their per-vblank averages into this frame's timings.
+    const auto stats = system.GetAndResetPerfStats();
+    const auto ms = [](double seconds) { return seconds * 1000.0; };
+
+    // The hash belongs to the frame the screenshot was requested for, which is presented before
+    // the frame being recorded now.
+    std::string hash_column;
+    if (hash_ready.exchange(false)) {
+        hash_column = fmt::format("{:016X}", hash);
+    }
+    file.WriteString(fmt::format("{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{}\n", frame,
+                                 ms(stats.time_vblank_interval), ms(stats.time_hle_svc),
+                                 ms(stats.time_hle_ipc), ms(stats.time_gpu), ms(stats.time_swap),
+                                 ms(stats.time_remaining), hash_column));
+
+    if (checkpoint_interval != 0 && frame % checkpoint_interval == 0) {
+        RequestCheckpoint();
+    }
+}
+
+void BenchmarkRecorder::RequestCheckpoint() {
+    auto& renderer = system.GPU().Renderer();
+    if (renderer.IsScreenshotPending()) {
+        return;
+    }
+    const auto layout =
+        Layout::FrameLayoutFromResolutionScale(renderer.GetResolutionScaleFactor());
+    screenshot.resize(static_cast<std::size_t>(layout.width) * layout.height * 4);
+    renderer.RequestScreenshot(
+        screenshot.data(),
+        [this]([[maybe_unused]] bool invert_y) {
+            hash = Common::ComputeHash64(screenshot.data(), screenshot.size());
+            hash_ready = true;
+        },
+        layout);
+}
@@ -0,0 +1,46 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace Core {
+class System;
+}
+
+/**
+ * Records the performance of a movie playback for regression benchmarking. Every presented frame
+ * gets a CSV row with the PerfStats timings of that frame, and every `checkpoint_interval` frames
+ * a screenshot is hashed so that the output of two runs can be compared.
+ */
+class BenchmarkRecorder {
+public:
+    explicit BenchmarkRecorder(Core::System& system, const std::string& path,
+                               u32 checkpoint_interval);
+    ~BenchmarkRecorder();
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    /// Records the frame presented since the last call, if any. Called after every run loop.
+    void Update();
+
+private:
+    void RequestCheckpoint();
+
+    Core::System& system;
+    FileUtil::IOFile file;
+    u32 checkpoint_interval;
+    s32 last_frame = 0;
+
+    std::vector<u8> screenshot;
+    std::atomic_bool hash_ready = false;
+    u64 hash = 0;
+};
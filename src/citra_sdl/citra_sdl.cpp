@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -11,6 +12,7 @@
 // This needs to be included before getopt.h because the latter #defines symbols used by it
 #include "common/microprofile.h"
 
+#include "citra_sdl/benchmark.h"
 #include "citra_sdl/config.h"
 #include "citra_sdl/emu_window/emu_window_sdl2.h"
 #ifdef ENABLE_OPENGL
@@ -40,6 +42,7 @@
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cfg/cfg.h"
 #include "core/movie.h"
+#include "core/tracer/player.h"
 #include "input_common/main.h"
 #include "network/network.h"
 #include "video_core/gpu.h"
@@ -182,6 +185,9 @@ int LaunchSdlFrontend(int argc, char** argv) {
     std::string movie_record_author;
     std::string movie_play;
     std::string dump_video;
+    std::string benchmark_output;
+    u32 checkpoint_interval = 60;
+    std::string replay_trace;
 
     char* endarg;
 #ifdef _WIN32
@@ -203,6 +209,8 @@ int LaunchSdlFrontend(int argc, char** argv) {
     u16 port = Network::DefaultRoomPort;
 
     static struct option long_options[] = {
+        {"benchmark", required_argument, 0, 'b'},
+        {"checkpoint-interval", required_argument, 0, 'c'},
         {"dump-video", required_argument, 0, 'd'},
         {"fullscreen", no_argument, 0, 'f'},
         {"gdbport", required_argument, 0, 'g'},
@@ -212,15 +220,30 @@ int LaunchSdlFrontend(int argc, char** argv) {
         {"movie-record", required_argument, 0, 'r'},
         {"movie-record-author", required_argument, 0, 'a'},
         {"multiplayer", required_argument, 0, 'm'},
+        {"replay-trace", required_argument, 0, 't'},
         {"version", no_argument, 0, 'v'},
         {"windowed", no_argument, 0, 'w'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "d:fg:hi:p:r:a:m:nvw", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "b:c:d:fg:hi:p:r:a:m:nt:vw", long_options,
+                              &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
+            case 'b':
+                benchmark_output = optarg;
+                break;
+            case 'c':
+                errno = 0;
+                checkpoint_interval = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--checkpoint-interval");
+                    return 1;
+                }
+                break;
             case 'd':
                 dump_video = optarg;
                 break;
@@ -294,6 +317,9 @@ int LaunchSdlFrontend(int argc, char** argv) {
                 }
                 break;
             }
+            case 't':
+                replay_trace = optarg;
+                break;
             case 'v':
                 const std::string version_string =
                     std::string("Azahar ") + Common::g_build_fullname;
@@ -327,6 +353,16 @@ int LaunchSdlFrontend(int argc, char** argv) {
         return -1;
     }
 
+    if (!benchmark_output.empty() && movie_play.empty() && replay_trace.empty()) {
+        LOG_CRITICAL(Frontend, "A benchmark needs a movie or a CiTrace to play");
+        return -1;
+    }
+
+    if (!replay_trace.empty() && (!movie_record.empty() || !movie_play.empty())) {
+        LOG_CRITICAL(Frontend, "Cannot use a movie while replaying a CiTrace");
+        return -1;
+    }
+
     auto& system = Core::System::GetInstance();
     auto& movie = system.Movie();
 
@@ -340,6 +376,11 @@ int LaunchSdlFrontend(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (!benchmark_output.empty() || !replay_trace.empty()) {
+        // Run as fast as possible, without the host audio device pacing the emulation.
+        Settings::values.frame_limit = 0;
+        Settings::values.output_type = AudioCore::SinkType::Null;
+    }
     system.ApplySettings();
 
     // Register frontend applets
@@ -443,11 +484,13 @@ int LaunchSdlFrontend(int argc, char** argv) {
         }
     }
 
+    bool benchmark_done = false;
     if (!movie_play.empty()) {
         auto metadata = movie.GetMovieMetadata(movie_play);
         LOG_INFO(Movie, "Author: {}", metadata.author);
         LOG_INFO(Movie, "Rerecord count: {}", metadata.rerecord_count);
         LOG_INFO(Movie, "Input count: {}", metadata.input_count);
+        movie.SetPlaybackCompletionCallback([&benchmark_done] { benchmark_done = true; });
         movie.StartPlayback(movie_play);
     }
     if (!movie_record.empty()) {
@@ -463,6 +506,15 @@ int LaunchSdlFrontend(int argc, char** argv) {
         }
     }
 
+    std::unique_ptr<BenchmarkRecorder> benchmark;
+    if (!benchmark_output.empty()) {
+        benchmark =
+            std::make_unique<BenchmarkRecorder>(system, benchmark_output, checkpoint_interval);
+        if (!benchmark->IsOpen()) {
+            return -1;
+        }
+    }
+
 #ifdef __unix__
     Common::Linux::StartGamemode();
 #endif
@@ -485,22 +537,55 @@ int LaunchSdlFrontend(int argc, char** argv) {
                       total);
         });
 
+    // The application is only loaded to set up the system, a trace replaces its execution
+    std::unique_ptr<CiTrace::Player> trace_player;
+    if (!replay_trace.empty()) {
+        trace_player = std::make_unique<CiTrace::Player>(replay_trace);
+        if (!trace_player->IsGood()) {
+            return -1;
+        }
+        trace_player->ApplyInitialState(system.GPU());
+    }
+    u32 replayed_frames = 0;
+    const auto replay_start = std::chrono::steady_clock::now();
+
     const auto secondary_is_open = [&secondary_window] {
         // if the secondary window isn't created, it shouldn't affect the main loop
         return secondary_window ? secondary_window->IsOpen() : true;
     };
     while (emu_window->IsOpen() && secondary_is_open()) {
-        const auto result = system.RunLoop();
-
-        switch (result) {
-        case Core::System::ResultStatus::ShutdownRequested:
-            emu_window->RequestClose();
-            break;
-        case Core::System::ResultStatus::Success:
-            break;
-        default:
-            LOG_ERROR(Frontend, "Error in main run loop: {}", result, system.GetStatusDetails());
-            break;
+        if (trace_player) {
+            if (trace_player->ReplayFrame(system.GPU(), system.Memory())) {
+                replayed_frames++;
+            } else {
+                const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - replay_start;
+                LOG_INFO(Frontend, "Replayed {} frames in {:.3f} s ({:.1f} FPS)",
+                         replayed_frames, elapsed.count(), replayed_frames / elapsed.count());
+                emu_window->RequestClose();
+            }
+        } else {
+            const auto result = system.RunLoop();
+
+            switch (result) {
+            case Core::System::ResultStatus::ShutdownRequested:
+                emu_window->RequestClose();
+                break;
+            case Core::System::ResultStatus::Success:
+                break;
+            default:
+                LOG_ERROR(Frontend, "Error in main run loop: {}", result,
+                          system.GetStatusDetails());
+                break;
+            }
+        }
+
+        if (benchmark) {
+            benchmark->Update();
+            if (benchmark_done) {
+                LOG_INFO(Frontend, "Benchmark movie playback completed");
+                emu_window->RequestClose();
+            }
         }
     }
     emu_window->RequestClose();
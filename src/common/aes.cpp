@@ -0,0 +1,311 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/aes.h"
+#include "common/arch.h"
+#include "common/assert.h"
+#include "common/swap.h"
+
+#if CITRA_ARCH(x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#include "common/aarch64/cpu_detect.h"
+#endif
+
+// The kernels are compiled for the AES instructions on their own, and only called when the host
+// reports them.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AES_TARGET
+#elif CITRA_ARCH(x86_64)
+#define AES_TARGET __attribute__((target("aes,sse2")))
+#elif defined(__clang__)
+#define AES_TARGET __attribute__((target("aes")))
+#else
+#define AES_TARGET __attribute__((target("+crypto")))
+#endif
+
+namespace Common::AES {
+
+namespace {
+
+constexpr std::size_t Rounds = 10;
+
+/// Number of blocks of key stream produced at a time.
+constexpr std::size_t Lanes = 8;
+
+// clang-format off
+constexpr std::array<u8, 256> SBox = {
+    0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+    0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+    0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+    0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+    0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+    0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+    0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+    0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+    0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+    0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+    0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+    0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+    0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+    0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+    0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+    0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16,
+};
+// clang-format on
+
+constexpr std::array<u8, Rounds> RoundConstants = {0x01, 0x02, 0x04, 0x08, 0x10,
+                                                   0x20, 0x40, 0x80, 0x1B, 0x36};
+
+void ExpandKey(const u8* key, u8* round_keys) {
+    std::memcpy(round_keys, key, BlockSize);
+    for (std::size_t i = 4; i < 4 * (Rounds + 1); i++) {
+        std::array<u8, 4> word;
+        std::memcpy(word.data(), round_keys + 4 * (i - 1), word.size());
+        if (i % 4 == 0) {
+            word = {static_cast<u8>(SBox[word[1]] ^ RoundConstants[i / 4 - 1]), SBox[word[2]],
+                    SBox[word[3]], SBox[word[0]]};
+        }
+        for (std::size_t j = 0; j < word.size(); j++) {
+            round_keys[4 * i + j] = round_keys[4 * (i - 4) + j] ^ word[j];
+        }
+    }
+}
+
+#if CITRA_ARCH(x86_64)
+
+AES_TARGET __m128i LoadCounter(const Counter& counter) {
+    return _mm_set_epi64x(static_cast<s64>(Common::swap64(counter.low)),
+                          static_cast<s64>(Common::swap64(counter.high)));
+}
+
+AES_TARGET void EncryptBlockImpl(const u8* round_keys, const u8* in, u8* out) {
+    const auto* keys = reinterpret_cast<const __m128i*>(round_keys);
+    __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), keys[0]);
+    for (std::size_t round = 1; round < Rounds; round++) {
+        block = _mm_aesenc_si128(block, keys[round]);
+    }
+    block = _mm_aesenclast_si128(block, keys[Rounds]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+}
+
+AES_TARGET void XorKeyStreamImpl(const u8* round_keys, Counter& counter, const u8* in, u8* out,
+                                 std::size_t count) {
+    __m128i keys[Rounds + 1];
+    for (std::size_t round = 0; round <= Rounds; round++) {
+        keys[round] = _mm_load_si128(reinterpret_cast<const __m128i*>(round_keys) + round);
+    }
+
+    while (count > 0) {
+        const std::size_t lanes = std::min(count, Lanes);
+        __m128i blocks[Lanes];
+        for (std::size_t i = 0; i < lanes; i++) {
+            blocks[i] = _mm_xor_si128(LoadCounter(counter), keys[0]);
+            counter.Advance(1);
+        }
+        for (std::size_t round = 1; round < Rounds; round++) {
+            for (std::size_t i = 0; i < lanes; i++) {
+                blocks[i] = _mm_aesenc_si128(blocks[i], keys[round]);
+            }
+        }
+        for (std::size_t i = 0; i < lanes; i++) {
+            const auto* src = reinterpret_cast<const __m128i*>(in) + i;
+            auto* dest = reinterpret_cast<__m128i*>(out) + i;
+            const __m128i stream = _mm_aesenclast_si128(blocks[i], keys[Rounds]);
+            _mm_storeu_si128(dest, _mm_xor_si128(_mm_loadu_si128(src), stream));
+        }
+        in += lanes * BlockSize;
+        out += lanes * BlockSize;
+        count -= lanes;
+    }
+}
+
+#elif CITRA_ARCH(arm64)
+
+AES_TARGET uint8x16_t LoadCounter(const Counter& counter) {
+    return vreinterpretq_u8_u64(
+        vcombine_u64(vcreate_u64(Common::swap64(counter.high)),
+                     vcreate_u64(Common::swap64(counter.low))));
+}
+
+// AESE adds the round key before substituting, so the last round key is added on its own.
+AES_TARGET uint8x16_t Encrypt(const std::array<uint8x16_t, Rounds + 1>& keys, uint8x16_t block) {
+    for (std::size_t round = 0; round < Rounds - 1; round++) {
+        block = vaesmcq_u8(vaeseq_u8(block, keys[round]));
+    }
+    return veorq_u8(vaeseq_u8(block, keys[Rounds - 1]), keys[Rounds]);
+}
+
+AES_TARGET std::array<uint8x16_t, Rounds + 1> LoadKeys(const u8* round_keys) {
+    std::array<uint8x16_t, Rounds + 1> keys;
+    for (std::size_t round = 0; round <= Rounds; round++) {
+        keys[round] = vld1q_u8(round_keys + round * BlockSize);
+    }
+    return keys;
+}
+
+AES_TARGET void EncryptBlockImpl(const u8* round_keys, const u8* in, u8* out) {
+    vst1q_u8(out, Encrypt(LoadKeys(round_keys), vld1q_u8(in)));
+}
+
+AES_TARGET void XorKeyStreamImpl(const u8* round_keys, Counter& counter, const u8* in, u8* out,
+                                 std::size_t count) {
+    const auto keys = LoadKeys(round_keys);
+
+    while (count > 0) {
+        const std::size_t lanes = std::min(count, Lanes);
+        std::array<uint8x16_t, Lanes> blocks;
+        for (std::size_t i = 0; i < lanes; i++) {
+            blocks[i] = LoadCounter(counter);
+            counter.Advance(1);
+        }
+        // Interleave the lanes round by round, like the x86-64 kernel.
+        for (std::size_t round = 0; round < Rounds - 1; round++) {
+            for (std::size_t i = 0; i < lanes; i++) {
+                blocks[i] = vaesmcq_u8(vaeseq_u8(blocks[i], keys[round]));
+            }
+        }
+        for (std::size_t i = 0; i < lanes; i++) {
+            const uint8x16_t stream =
+                veorq_u8(vaeseq_u8(blocks[i], keys[Rounds - 1]), keys[Rounds]);
+            vst1q_u8(out + i * BlockSize, veorq_u8(vld1q_u8(in + i * BlockSize), stream));
+        }
+        in += lanes * BlockSize;
+        out += lanes * BlockSize;
+        count -= lanes;
+    }
+}
+
+#else
+
+void EncryptBlockImpl(const u8*, const u8*, u8*) {
+    UNREACHABLE();
+}
+
+void XorKeyStreamImpl(const u8*, Counter&, const u8*, u8*, std::size_t) {
+    UNREACHABLE();
+}
+
+#endif
+
+} // Anonymous namespace
+
+bool IsAccelerated() {
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+    return GetCPUCaps().aes;
+#else
+    return false;
+#endif
+}
+
+Counter Counter::FromBytes(const u8* bytes) {
+    Counter counter;
+    std::memcpy(&counter.high, bytes, sizeof(counter.high));
+    std::memcpy(&counter.low, bytes + sizeof(counter.high), sizeof(counter.low));
+    counter.high = Common::swap64(counter.high);
+    counter.low = Common::swap64(counter.low);
+    return counter;
+}
+
+Cipher::Cipher(const u8* key) {
+    ASSERT(IsAccelerated());
+    ExpandKey(key, round_keys.data());
+}
+
+void Cipher::EncryptBlock(const u8* in, u8* out) const {
+    EncryptBlockImpl(round_keys.data(), in, out);
+}
+
+void Cipher::XorKeyStream(Counter& counter, const u8* in, u8* out, std::size_t count) const {
+    XorKeyStreamImpl(round_keys.data(), counter, in, out, count);
+}
+
+struct CTR::Impl {
+    std::optional<Cipher> cipher;
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption fallback;
+
+    Counter iv;
+    Counter counter;
+    /// Key stream of the block before `counter`, of which the first `used` bytes are consumed.
+    std::array<u8, BlockSize> stream{};
+    std::size_t used = BlockSize;
+
+    /// Computes the key stream block at `counter` and advances past it.
+    void NextStream() {
+        stream.fill(0);
+        cipher->XorKeyStream(counter, stream.data(), stream.data(), 1);
+        used = 0;
+    }
+};
+
+CTR::CTR() : impl(std::make_unique<Impl>()) {}
+
+CTR::CTR(const u8* key, std::size_t key_size, const u8* iv) : CTR() {
+    SetKeyWithIV(key, key_size, iv);
+}
+
+CTR::~CTR() = default;
+
+CTR::CTR(CTR&&) noexcept = default;
+CTR& CTR::operator=(CTR&&) noexcept = default;
+
+void CTR::SetKeyWithIV(const u8* key, std::size_t key_size, const u8* iv) {
+    if (!IsAccelerated() || key_size != BlockSize) {
+        impl->cipher.reset();
+        impl->fallback.SetKeyWithIV(key, key_size, iv);
+        return;
+    }
+    impl->cipher.emplace(key);
+    impl->iv = Counter::FromBytes(iv);
+    impl->counter = impl->iv;
+    impl->used = BlockSize;
+}
+
+void CTR::Seek(u64 position) {
+    if (!impl->cipher) {
+        impl->fallback.Seek(position);
+        return;
+    }
+    impl->counter = impl->iv;
+    impl->counter.Advance(position / BlockSize);
+    impl->used = BlockSize;
+    if (position % BlockSize != 0) {
+        impl->NextStream();
+        impl->used = position % BlockSize;
+    }
+}
+
+void CTR::ProcessData(u8* out, const u8* in, std::size_t size) {
+    if (!impl->cipher) {
+        impl->fallback.ProcessData(out, in, size);
+        return;
+    }
+
+    // Finish the block a previous call stopped in.
+    for (; size > 0 && impl->used < BlockSize; size--) {
+        *out++ = *in++ ^ impl->stream[impl->used++];
+    }
+
+    const std::size_t blocks = size / BlockSize;
+    impl->cipher->XorKeyStream(impl->counter, in, out, blocks);
+    in += blocks * BlockSize;
+    out += blocks * BlockSize;
+    size -= blocks * BlockSize;
+
+    if (size > 0) {
+        impl->NextStream();
+        for (; size > 0; size--) {
+            *out++ = *in++ ^ impl->stream[impl->used++];
+        }
+    }
+}
+
+} // namespace Common::AES
@@ -0,0 +1,80 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+
+namespace Common::AES {
+
+constexpr std::size_t BlockSize = 16;
+
+/// Returns whether the host has AES instructions, which Cipher requires.
+bool IsAccelerated();
+
+/// A 128-bit counter block, stored as big endian halves.
+struct Counter {
+    u64 high = 0;
+    u64 low = 0;
+
+    static Counter FromBytes(const u8* bytes);
+
+    /// Adds `count` blocks to the counter, carrying across the whole block.
+    void Advance(u64 count) {
+        const u64 old_low = low;
+        low += count;
+        high += low < old_low ? 1 : 0;
+    }
+};
+
+/**
+ * AES-128 encryption with AES-NI on x86-64 and the ARMv8 Crypto Extensions on arm64. The counter
+ * mode key stream is produced eight blocks at a time, so that the rounds of independent blocks
+ * overlap in the pipeline. Only usable when IsAccelerated() returns true.
+ */
+class Cipher {
+public:
+    explicit Cipher(const u8* key);
+
+    void EncryptBlock(const u8* in, u8* out) const;
+
+    /// XORs `count` blocks of key stream for the counters starting at `counter` with `in` into
+    /// `out`, which may be the same buffer, and advances the counter past them.
+    void XorKeyStream(Counter& counter, const u8* in, u8* out, std::size_t count) const;
+
+private:
+    alignas(16) std::array<u8, 11 * BlockSize> round_keys;
+};
+
+/**
+ * AES-128 in counter mode with a 128-bit big endian counter, matching
+ * CryptoPP::CTR_Mode<CryptoPP::AES>. Encryption and decryption are the same operation. Falls back
+ * to CryptoPP when the host has no AES instructions.
+ */
+class CTR {
+public:
+    CTR();
+    CTR(const u8* key, std::size_t key_size, const u8* iv);
+    ~CTR();
+
+    CTR(CTR&&) noexcept;
+    CTR& operator=(CTR&&) noexcept;
+
+    void SetKeyWithIV(const u8* key, std::size_t key_size, const u8* iv);
+
+    /// Moves to byte `position` of the key stream.
+    void Seek(u64 position);
+
+    /// XORs `size` bytes of key stream with `in` into `out`, which may be the same buffer.
+    void ProcessData(u8* out, const u8* in, std::size_t size);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace Common::AES
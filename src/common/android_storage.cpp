@@ -3,6 +3,16 @@
 // Refer to the license.txt file included.
 
 #ifdef ANDROID
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include "common/android_storage.h"
@@ -10,6 +20,119 @@
 #include "common/logging/log.h"
 
 namespace AndroidStorage {
+namespace {
+
+// Every query below is a JNI call that ends in a DocumentsProvider round trip, which is far slower
+// than the equivalent syscall on other platforms. Results for native paths are remembered until
+// the emulator itself touches the path again.
+struct PathInfo {
+    bool exists = false;
+    bool is_directory = false;
+    std::optional<std::uint64_t> size;
+    int writers = 0; ///< Number of files currently open for writing at this path.
+};
+
+constexpr std::size_t MaxCachedDescriptors = 64;
+
+std::mutex cache_mutex;
+std::unordered_map<std::string, PathInfo> info_cache;
+/// Read-only descriptors of recently opened documents, most recently used first.
+std::list<std::pair<std::string, int>> descriptor_cache;
+/// Cleared if the host refuses to reopen a descriptor through procfs.
+std::atomic<bool> descriptor_reuse{true};
+
+/// Paths are resolved case-insensitively on the Java side, so fold them the same way here.
+std::optional<std::string> CacheKey(const std::string& filepath) {
+    if (filepath.empty() || filepath.front() != '/') {
+        return std::nullopt;
+    }
+    std::string key;
+    key.reserve(filepath.size());
+    for (const char c : filepath) {
+        if (c == '/' && !key.empty() && key.back() == '/') {
+            continue;
+        }
+        key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+    while (key.size() > 1 && key.back() == '/') {
+        key.pop_back();
+    }
+    return key;
+}
+
+bool IsSameOrChild(const std::string& path, const std::string& key) {
+    return path.starts_with(key) &&
+           (path.size() == key.size() || path[key.size()] == '/' || key == "/");
+}
+
+/// Must be called with cache_mutex held.
+void DropDescriptors(const std::string& key) {
+    std::erase_if(descriptor_cache, [&key](const auto& entry) {
+        if (!IsSameOrChild(entry.first, key)) {
+            return false;
+        }
+        close(entry.second);
+        return true;
+    });
+}
+
+/// Forgets everything known about a path and everything beneath it.
+void Invalidate(const std::string& filepath) {
+    const auto key = CacheKey(filepath);
+    if (!key) {
+        return;
+    }
+    std::scoped_lock lock{cache_mutex};
+    std::erase_if(info_cache, [&key](const auto& entry) {
+        return IsSameOrChild(entry.first, *key) && entry.second.writers == 0;
+    });
+    DropDescriptors(*key);
+}
+
+int ReopenCachedDescriptor(const std::string& key) {
+    std::scoped_lock lock{cache_mutex};
+    const auto it = std::find_if(descriptor_cache.begin(), descriptor_cache.end(),
+                                 [&key](const auto& entry) { return entry.first == key; });
+    if (it == descriptor_cache.end()) {
+        return -1;
+    }
+    // Opening the procfs link yields a new open file description, so the offset isn't shared
+    // with the cached descriptor or any other user of it.
+    const std::string proc_path = "/proc/self/fd/" + std::to_string(it->second);
+    const int fd = open(proc_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        LOG_WARNING(Common_Filesystem, "Unable to reopen cached descriptor, disabling reuse");
+        descriptor_reuse = false;
+        for (const auto& [path, cached_fd] : descriptor_cache) {
+            close(cached_fd);
+        }
+        descriptor_cache.clear();
+        return -1;
+    }
+    descriptor_cache.splice(descriptor_cache.begin(), descriptor_cache, it);
+    return fd;
+}
+
+void CacheDescriptor(const std::string& key, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return;
+    }
+    const int cached_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (cached_fd == -1) {
+        return;
+    }
+    std::scoped_lock lock{cache_mutex};
+    DropDescriptors(key);
+    descriptor_cache.emplace_front(key, cached_fd);
+    if (descriptor_cache.size() > MaxCachedDescriptors) {
+        close(descriptor_cache.back().second);
+        descriptor_cache.pop_back();
+    }
+}
+
+} // Anonymous namespace
+
 JNIEnv* GetEnvForThread() {
     thread_local static struct OwnedEnv {
         OwnedEnv() {
@@ -59,34 +182,35 @@ void InitJNI(JNIEnv* env, jclass clazz) {
     env->GetJavaVM(&g_jvm);
     native_library = clazz;
 
-#define FR(FunctionName, ReturnValue, JMethodID, Caller, JMethodName, Signature)                   \
-    F(JMethodID, JMethodName, Signature)
 #define FS(FunctionName, ReturnValue, Parameters, JMethodID, JMethodName, Signature)               \
     F(JMethodID, JMethodName, Signature)
 #define F(JMethodID, JMethodName, Signature)                                                       \
     JMethodID = env->GetStaticMethodID(native_library, JMethodName, Signature);
-    ANDROID_SINGLE_PATH_DETERMINE_FUNCTIONS(FR)
     ANDROID_STORAGE_FUNCTIONS(FS)
 #undef F
 #undef FS
-#undef FR
 }
 
 void CleanupJNI() {
-#define FR(FunctionName, ReturnValue, JMethodID, Caller, JMethodName, Signature) F(JMethodID)
 #define FS(FunctionName, ReturnValue, Parameters, JMethodID, JMethodName, Signature) F(JMethodID)
 #define F(JMethodID) JMethodID = nullptr;
-    ANDROID_SINGLE_PATH_DETERMINE_FUNCTIONS(FR)
     ANDROID_STORAGE_FUNCTIONS(FS)
 #undef F
 #undef FS
-#undef FR
+
+    std::scoped_lock lock{cache_mutex};
+    info_cache.clear();
+    for (const auto& [path, fd] : descriptor_cache) {
+        close(fd);
+    }
+    descriptor_cache.clear();
 }
 
 bool CreateFile(const std::string& directory, const std::string& filename) {
     if (create_file == nullptr) {
         return false;
     }
+    Invalidate(directory + "/" + filename);
     auto env = GetEnvForThread();
     jstring j_directory = env->NewStringUTF(directory.c_str());
     jstring j_filename = env->NewStringUTF(filename.c_str());
@@ -97,6 +221,7 @@ bool CreateDir(const std::string& directory, const std::string& filename) {
     if (create_dir == nullptr) {
         return false;
     }
+    Invalidate(directory + "/" + filename);
     auto env = GetEnvForThread();
     jstring j_directory = env->NewStringUTF(directory.c_str());
     jstring j_directory_name = env->NewStringUTF(filename.c_str());
@@ -134,10 +259,28 @@ int OpenContentUri(const std::string& filepath, AndroidOpenMode openmode) {
     case AndroidOpenMode::NEVER:
         return -1;
     }
+
+    const auto key = CacheKey(filepath);
+    const bool reusable = key && openmode == AndroidOpenMode::READ && descriptor_reuse;
+    if (reusable) {
+        if (const int fd = ReopenCachedDescriptor(*key); fd != -1) {
+            return fd;
+        }
+    } else if (key) {
+        std::scoped_lock lock{cache_mutex};
+        DropDescriptors(*key);
+    }
+
     auto env = GetEnvForThread();
     jstring j_filepath = env->NewStringUTF(filepath.c_str());
     jstring j_mode = env->NewStringUTF(mode);
-    return env->CallStaticIntMethod(native_library, open_content_uri, j_filepath, j_mode);
+    const int fd = env->CallStaticIntMethod(native_library, open_content_uri, j_filepath, j_mode);
+    env->DeleteLocalRef(j_filepath);
+    env->DeleteLocalRef(j_mode);
+    if (fd != -1 && reusable && descriptor_reuse) {
+        CacheDescriptor(*key, fd);
+    }
+    return fd;
 }
 
 std::vector<std::string> GetFilesName(const std::string& filepath) {
@@ -158,6 +301,56 @@ std::vector<std::string> GetFilesName(const std::string& filepath) {
     return vector;
 }
 
+std::vector<DirectoryEntry> GetDirectoryEntries(const std::string& filepath) {
+    std::vector<DirectoryEntry> entries;
+    if (get_directory_entries == nullptr) {
+        return entries;
+    }
+    auto env = GetEnvForThread();
+    jstring j_filepath = env->NewStringUTF(filepath.c_str());
+    auto j_object = (jobjectArray)env->CallStaticObjectMethod(native_library,
+                                                               get_directory_entries, j_filepath);
+    env->DeleteLocalRef(j_filepath);
+    if (j_object == nullptr) {
+        return entries;
+    }
+    const jsize j_size = env->GetArrayLength(j_object);
+    entries.reserve(j_size);
+    // Each entry is encoded as "<d|f><size>/<name>" so that a single call returns everything
+    // needed to walk the directory.
+    for (jsize i = 0; i < j_size; i++) {
+        auto string = (jstring)(env->GetObjectArrayElement(j_object, i));
+        const char* chars = env->GetStringUTFChars(string, nullptr);
+        const std::string_view encoded{chars};
+        const auto separator = encoded.find('/');
+        if (encoded.size() >= 2 && separator != std::string_view::npos) {
+            DirectoryEntry entry;
+            entry.is_directory = encoded.front() == 'd';
+            entry.size = std::strtoull(chars + 1, nullptr, 10);
+            entry.name = std::string(encoded.substr(separator + 1));
+            entries.push_back(std::move(entry));
+        }
+        env->ReleaseStringUTFChars(string, chars);
+        env->DeleteLocalRef(string);
+    }
+    env->DeleteLocalRef(j_object);
+
+    if (const auto key = CacheKey(filepath)) {
+        std::scoped_lock lock{cache_mutex};
+        info_cache[*key] = PathInfo{.exists = true, .is_directory = true};
+        for (const auto& entry : entries) {
+            auto& info = info_cache[*CacheKey(filepath + "/" + entry.name)];
+            if (info.writers > 0) {
+                continue;
+            }
+            info.exists = true;
+            info.is_directory = entry.is_directory;
+            info.size = entry.is_directory ? std::nullopt : std::optional{entry.size};
+        }
+    }
+    return entries;
+}
+
 std::optional<std::string> GetUserDirectory() {
     if (get_user_directory == nullptr) {
         throw std::runtime_error(
@@ -189,6 +382,7 @@ bool CopyFile(const std::string& source, const std::string& destination_path,
     if (copy_file == nullptr) {
         return false;
     }
+    Invalidate(destination_path + "/" + destination_filename);
     auto env = GetEnvForThread();
     jstring j_source_path = env->NewStringUTF(source.c_str());
     jstring j_destination_path = env->NewStringUTF(destination_path.c_str());
@@ -206,6 +400,8 @@ bool RenameFile(const std::string& source, const std::string& filename) {
         // TODO: Should this be treated as a success or failure?
         return false;
     }
+    Invalidate(source);
+    Invalidate(std::string(FileUtil::GetParentPath(source)) + "/" + filename);
     auto env = GetEnvForThread();
     jstring j_source_path = env->NewStringUTF(source.c_str());
     jstring j_destination_path = env->NewStringUTF(filename.c_str());
@@ -217,6 +413,8 @@ bool UpdateDocumentLocation(const std::string& source_path, const std::string& d
     if (update_document_location == nullptr) {
         return false;
     }
+    Invalidate(source_path);
+    Invalidate(destination_path);
     auto env = GetEnvForThread();
     jstring j_source_path = env->NewStringUTF(source_path.c_str());
     jstring j_destination_path = env->NewStringUTF(destination_path.c_str());
@@ -233,6 +431,8 @@ bool MoveFile(const std::string& filename, const std::string& source_dir_path,
         // TODO: Should this be treated as a success or failure?
         return false;
     }
+    Invalidate(source_dir_path + "/" + filename);
+    Invalidate(destination_dir_path + "/" + filename);
     auto env = GetEnvForThread();
     jstring j_filename = env->NewStringUTF(filename.c_str());
     jstring j_source_dir_path = env->NewStringUTF(source_dir_path.c_str());
@@ -293,20 +493,116 @@ bool MoveAndRenameFile(const std::string& src_full_path, const std::string& dest
     return result;
 }
 
-#define FR(FunctionName, ReturnValue, JMethodID, Caller, JMethodName, Signature)                   \
-    F(FunctionName, ReturnValue, JMethodID, Caller)
-#define F(FunctionName, ReturnValue, JMethodID, Caller)                                            \
-    ReturnValue FunctionName(const std::string& filepath) {                                        \
-        if (JMethodID == nullptr) {                                                                \
-            return 0;                                                                              \
-        }                                                                                          \
-        auto env = GetEnvForThread();                                                              \
-        jstring j_filepath = env->NewStringUTF(filepath.c_str());                                  \
-        return env->Caller(native_library, JMethodID, j_filepath);                                 \
-    }
-ANDROID_SINGLE_PATH_DETERMINE_FUNCTIONS(FR)
-#undef F
-#undef FR
+bool IsDirectory(const std::string& filepath) {
+    const auto key = CacheKey(filepath);
+    if (key) {
+        std::scoped_lock lock{cache_mutex};
+        if (const auto it = info_cache.find(*key); it != info_cache.end() && it->second.exists) {
+            return it->second.is_directory;
+        }
+    }
+    if (is_directory == nullptr) {
+        return false;
+    }
+    auto env = GetEnvForThread();
+    jstring j_filepath = env->NewStringUTF(filepath.c_str());
+    const bool result = env->CallStaticBooleanMethod(native_library, is_directory, j_filepath);
+    env->DeleteLocalRef(j_filepath);
+    if (key && result) {
+        std::scoped_lock lock{cache_mutex};
+        info_cache[*key] = PathInfo{.exists = true, .is_directory = true};
+    }
+    return result;
+}
+
+bool FileExists(const std::string& filepath) {
+    const auto key = CacheKey(filepath);
+    if (key) {
+        std::scoped_lock lock{cache_mutex};
+        // Only positive results are remembered, the frontend may create files behind our back.
+        if (const auto it = info_cache.find(*key); it != info_cache.end() && it->second.exists) {
+            return true;
+        }
+    }
+    if (file_exists == nullptr) {
+        return false;
+    }
+    auto env = GetEnvForThread();
+    jstring j_filepath = env->NewStringUTF(filepath.c_str());
+    const bool result = env->CallStaticBooleanMethod(native_library, file_exists, j_filepath);
+    env->DeleteLocalRef(j_filepath);
+    return result;
+}
+
+std::uint64_t GetSize(const std::string& filepath) {
+    const auto key = CacheKey(filepath);
+    if (key) {
+        std::scoped_lock lock{cache_mutex};
+        if (const auto it = info_cache.find(*key); it != info_cache.end() && it->second.exists) {
+            if (it->second.is_directory) {
+                return 0;
+            }
+            if (it->second.size) {
+                return *it->second.size;
+            }
+        }
+    }
+    if (get_size == nullptr) {
+        return 0;
+    }
+    auto env = GetEnvForThread();
+    jstring j_filepath = env->NewStringUTF(filepath.c_str());
+    const std::uint64_t result = env->CallStaticLongMethod(native_library, get_size, j_filepath);
+    env->DeleteLocalRef(j_filepath);
+    if (key) {
+        std::scoped_lock lock{cache_mutex};
+        auto& info = info_cache[*key];
+        if (info.writers == 0) {
+            info.exists = true;
+            info.size = result;
+        }
+    }
+    return result;
+}
+
+bool DeleteDocument(const std::string& filepath) {
+    if (delete_document == nullptr) {
+        return false;
+    }
+    Invalidate(filepath);
+    auto env = GetEnvForThread();
+    jstring j_filepath = env->NewStringUTF(filepath.c_str());
+    const bool result = env->CallStaticBooleanMethod(native_library, delete_document, j_filepath);
+    env->DeleteLocalRef(j_filepath);
+    return result;
+}
+
+void BeginWrite(const std::string& filepath) {
+    const auto key = CacheKey(filepath);
+    if (!key) {
+        return;
+    }
+    std::scoped_lock lock{cache_mutex};
+    DropDescriptors(*key);
+    auto& info = info_cache[*key];
+    info.exists = true;
+    info.is_directory = false;
+    info.size.reset();
+    ++info.writers;
+}
+
+void EndWrite(const std::string& filepath) {
+    const auto key = CacheKey(filepath);
+    if (!key) {
+        return;
+    }
+    std::scoped_lock lock{cache_mutex};
+    auto& info = info_cache[*key];
+    info.size.reset();
+    if (info.writers > 0) {
+        --info.writers;
+    }
+}
 
 } // namespace AndroidStorage
 #endif
@@ -5,6 +5,8 @@
 #pragma once
 
 #ifdef ANDROID
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 #include <fcntl.h>
@@ -19,6 +21,8 @@
       open_content_uri, "openContentUri", "(Ljava/lang/String;Ljava/lang/String;)I")               \
     V(GetFilesName, std::vector<std::string>, (const std::string& filepath), get_files_name,       \
       "getFilesName", "(Ljava/lang/String;)[Ljava/lang/String;")                                   \
+    V(GetDirectoryEntries, std::vector<DirectoryEntry>, (const std::string& filepath),             \
+      get_directory_entries, "getDirectoryEntries", "(Ljava/lang/String;)[Ljava/lang/String;")     \
     V(GetUserDirectory, std::optional<std::string>, (), get_user_directory, "getUserDirectory",    \
       "(Landroid/net/Uri;)Ljava/lang/String;")                                                     \
     V(CopyFile, bool,                                                                              \
@@ -35,27 +39,24 @@
     V(MoveFile, bool,                                                                              \
       (const std::string& filename, const std::string& source_dir_path,                            \
        const std::string& destination_dir_path),                                                   \
-      move_file, "moveFile", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z")
-#define ANDROID_SINGLE_PATH_DETERMINE_FUNCTIONS(V)                                                 \
-    V(IsDirectory, bool, is_directory, CallStaticBooleanMethod, "isDirectory",                     \
+      move_file, "moveFile", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)Z")          \
+    V(IsDirectory, bool, (const std::string& filepath), is_directory, "isDirectory",               \
       "(Ljava/lang/String;)Z")                                                                     \
-    V(FileExists, bool, file_exists, CallStaticBooleanMethod, "fileExists",                        \
+    V(FileExists, bool, (const std::string& filepath), file_exists, "fileExists",                  \
       "(Ljava/lang/String;)Z")                                                                     \
-    V(GetSize, std::uint64_t, get_size, CallStaticLongMethod, "getSize", "(Ljava/lang/String;)J")  \
-    V(DeleteDocument, bool, delete_document, CallStaticBooleanMethod, "deleteDocument",            \
+    V(GetSize, std::uint64_t, (const std::string& filepath), get_size, "getSize",                  \
+      "(Ljava/lang/String;)J")                                                                     \
+    V(DeleteDocument, bool, (const std::string& filepath), delete_document, "deleteDocument",      \
       "(Ljava/lang/String;)Z")
 namespace AndroidStorage {
 
 static JavaVM* g_jvm = nullptr;
 static jclass native_library = nullptr;
-#define FR(FunctionName, ReturnValue, JMethodID, Caller, JMethodName, Signature) F(JMethodID)
 #define FS(FunctionName, ReturnValue, Parameters, JMethodID, JMethodName, Signature) F(JMethodID)
 #define F(JMethodID) static jmethodID JMethodID = nullptr;
-ANDROID_SINGLE_PATH_DETERMINE_FUNCTIONS(FR)
 ANDROID_STORAGE_FUNCTIONS(FS)
 #undef F
 #undef FS
-#undef FR
 bool MoveAndRenameFile(const std::string& src_full_path, const std::string& dest_full_path);
 // Reference:
 // https://developer.android.com/reference/android/os/ParcelFileDescriptor#parseMode(java.lang.String)
@@ -76,6 +77,13 @@ public:
     static constexpr std::string VANILLA = "vanilla";
 };
 
+/// Entry of a directory listing, with the metadata returned along with it.
+struct DirectoryEntry {
+    std::string name;
+    bool is_directory;
+    std::uint64_t size;
+};
+
 inline AndroidOpenMode operator|(AndroidOpenMode a, int b) {
     return static_cast<AndroidOpenMode>(static_cast<int>(a) | b);
 }
@@ -86,6 +94,13 @@ void InitJNI(JNIEnv* env, jclass clazz);
 
 void CleanupJNI();
 
+/**
+ * Tells the caches that the file at filepath is opened for writing or closed after it, so that
+ * its size and descriptor are not reused while it may change.
+ */
+void BeginWrite(const std::string& filepath);
+void EndWrite(const std::string& filepath);
+
 #define FS(FunctionName, ReturnValue, Parameters, JMethodID, JMethodName, Signature)               \
     F(FunctionName, Parameters, ReturnValue)
 #define F(FunctionName, Parameters, ReturnValue) ReturnValue FunctionName Parameters;
@@ -93,12 +108,5 @@ ANDROID_STORAGE_FUNCTIONS(FS)
 #undef F
 #undef FS
 
-#define FR(FunctionName, ReturnValue, JMethodID, Caller, JMethodName, Signature)                   \
-    F(FunctionName, ReturnValue)
-#define F(FunctionName, ReturnValue) ReturnValue FunctionName(const std::string& filepath);
-ANDROID_SINGLE_PATH_DETERMINE_FUNCTIONS(FR)
-#undef F
-#undef FR
-
 } // namespace AndroidStorage
 #endif
@@ -23,6 +23,8 @@ struct Room {
         MacAddress mac_address;
         std::string game_name;
         u64 game_id;
+
+        bool operator==(const Member&) const = default;
     };
     std::string id;
     std::string verify_UID; ///< UID used for verification
@@ -38,6 +40,8 @@ struct Room {
     u64 preferred_game_id;
 
     std::vector<Member> members;
+
+    bool operator==(const Room&) const = default;
 };
 using RoomList = std::vector<Room>;
 
@@ -20,7 +20,7 @@ constexpr std::size_t DefaultCapacity = 0x1000;
 } // namespace detail
 
 template <typename T, std::size_t Capacity = detail::DefaultCapacity>
-class SPSCQueue {
+class BoundedSPSCQueue {
     static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
 
 public:
@@ -163,7 +163,7 @@ private:
 };
 
 template <typename T, std::size_t Capacity = detail::DefaultCapacity>
-class MPSCQueue {
+class BoundedMPSCQueue {
 public:
     template <typename... Args>
     bool TryEmplace(Args&&... args) {
@@ -198,12 +198,12 @@ public:
     }
 
 private:
-    SPSCQueue<T, Capacity> spsc_queue;
+    BoundedSPSCQueue<T, Capacity> spsc_queue;
     std::mutex write_mutex;
 };
 
 template <typename T, std::size_t Capacity = detail::DefaultCapacity>
-class MPMCQueue {
+class BoundedMPMCQueue {
 public:
     template <typename... Args>
     bool TryEmplace(Args&&... args) {
@@ -243,7 +243,7 @@ public:
     }
 
 private:
-    SPSCQueue<T, Capacity> spsc_queue;
+    BoundedSPSCQueue<T, Capacity> spsc_queue;
     std::mutex write_mutex;
     std::mutex read_mutex;
 };
@@ -5,81 +5,249 @@
 #include "common/cpu_affinity.h"
 
 #ifdef __ANDROID__
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <sched.h>
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <fmt/format.h>
+#include "common/dynamic_library/dynamic_library.h"
+#include "common/file_util.h"
 #include "common/logging/log.h"
+#endif
 
 namespace Common {
 
-// Helper pour obtenir le TID (Thread ID) Linux
-static pid_t GetThreadId() {
-    return static_cast<pid_t>(syscall(SYS_gettid));
-}
+namespace {
+
+thread_local CoreClass current_core_class = CoreClass::Any;
+thread_local bool joined_performance_hint = false;
+
+#ifdef __ANDROID__
 
-void SetBigCoreAffinity() {
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
+constexpr std::size_t NumCoreClasses = 4;
 
-    // Snapdragon 8 Gen 2 topology:
-    // Cores 0-3: A510 (efficiency)
-    // Cores 4-6: A720 (performance)
-    // Core 7: X3 (prime)
+struct Topology {
+    std::array<cpu_set_t, NumCoreClasses> masks{};
+    /// False if every core is the same or the topology could not be read
+    bool heterogeneous = false;
+};
+
+u64 ReadCpuValue(long cpu, const char* file) {
+    std::string value;
+    const auto path = fmt::format("/sys/devices/system/cpu/cpu{}/{}", cpu, file);
+    if (FileUtil::ReadFileToString(true, path, value) == 0) {
+        return 0;
+    }
+    return std::strtoull(value.c_str(), nullptr, 10);
+}
+
+/// Reads a per core value that ranks the cores by speed, returns an empty vector if any is missing
+std::vector<u64> ReadCoreRanks(long num_cpus, const char* file) {
+    std::vector<u64> ranks(num_cpus);
+    for (long cpu = 0; cpu < num_cpus; cpu++) {
+        ranks[cpu] = ReadCpuValue(cpu, file);
+        if (ranks[cpu] == 0) {
+            return {};
+        }
+    }
+    return ranks;
+}
 
-    // Pin to big cores (4-7)
-    for (int i = 4; i < 8; i++) {
-        CPU_SET(i, &cpuset);
+Topology DetectTopology() {
+    Topology topology;
+    const long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < num_cpus; cpu++) {
+        CPU_SET(cpu, &topology.masks[static_cast<std::size_t>(CoreClass::Any)]);
     }
 
-    pid_t tid = GetThreadId();
-    int result = sched_setaffinity(tid, sizeof(cpuset), &cpuset);
+    // The scheduler capacity is the best ranking, older kernels only expose the clock speeds
+    auto ranks = ReadCoreRanks(num_cpus, "cpu_capacity");
+    if (ranks.empty()) {
+        ranks = ReadCoreRanks(num_cpus, "cpufreq/cpuinfo_max_freq");
+    }
+    std::vector<u64> clusters = ranks;
+    std::sort(clusters.begin(), clusters.end(), std::greater{});
+    clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+    if (clusters.size() < 2) {
+        LOG_INFO(Common, "CPU topology: {} identical cores", num_cpus);
+        return topology;
+    }
 
-    if (result != 0) {
-        LOG_WARNING(Common, "Failed to set big core affinity for TID {}: error {}", tid, errno);
-    } else {
-        LOG_INFO(Common, "Thread {} pinned to big cores (4-7)", tid);
+    // The fastest cluster is the prime cluster and the slowest the efficiency cluster. Clusters
+    // in between are the performance cores, with only two clusters the prime cores double as them.
+    const auto classify = [&clusters](u64 rank) {
+        if (rank == clusters.front()) {
+            return CoreClass::Prime;
+        }
+        return rank == clusters.back() ? CoreClass::Efficiency : CoreClass::Performance;
+    };
+    std::array<u32, NumCoreClasses> counts{};
+    for (long cpu = 0; cpu < num_cpus; cpu++) {
+        const auto index = static_cast<std::size_t>(classify(ranks[cpu]));
+        CPU_SET(cpu, &topology.masks[index]);
+        counts[index]++;
     }
+    auto& performance = topology.masks[static_cast<std::size_t>(CoreClass::Performance)];
+    if (clusters.size() == 2) {
+        performance = topology.masks[static_cast<std::size_t>(CoreClass::Prime)];
+    }
+    topology.heterogeneous = true;
+
+    LOG_INFO(Common, "CPU topology: {} prime, {} performance and {} efficiency cores",
+             counts[static_cast<std::size_t>(CoreClass::Prime)],
+             counts[static_cast<std::size_t>(CoreClass::Performance)],
+             counts[static_cast<std::size_t>(CoreClass::Efficiency)]);
+    return topology;
+}
+
+const Topology& GetTopology() {
+    static const Topology topology = DetectTopology();
+    return topology;
+}
+
+pid_t GetThreadId() {
+    return static_cast<pid_t>(syscall(SYS_gettid));
 }
 
-void SetLittleCoreAffinity() {
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
+/// Session of the NDK performance hint API, which is loaded at runtime as it needs Android 13
+class PerformanceHint {
+public:
+    PerformanceHint() {
+        if (!library.Load("libandroid.so")) {
+            return;
+        }
+        const auto get_manager = library.GetSymbol<void* (*)()>("APerformanceHint_getManager");
+        create_session = library.GetSymbol<CreateSession>("APerformanceHint_createSession");
+        update_target = library.GetSymbol<UpdateDuration>(
+            "APerformanceHint_updateTargetWorkDuration");
+        report_actual = library.GetSymbol<UpdateDuration>(
+            "APerformanceHint_reportActualWorkDuration");
+        close_session = library.GetSymbol<CloseSession>("APerformanceHint_closeSession");
+        if (get_manager && create_session && update_target && report_actual && close_session) {
+            manager = get_manager();
+        }
+    }
 
-    // Pin to little cores (0-3)
-    for (int i = 0; i < 4; i++) {
-        CPU_SET(i, &cpuset);
+    ~PerformanceHint() {
+        if (session) {
+            close_session(session);
+        }
     }
 
-    pid_t tid = GetThreadId();
-    int result = sched_setaffinity(tid, sizeof(cpuset), &cpuset);
+    void AddThread(pid_t tid) {
+        std::scoped_lock lock{mutex};
+        if (std::find(tids.begin(), tids.end(), tid) == tids.end()) {
+            tids.push_back(tid);
+            tids_changed = true;
+        }
+    }
 
-    if (result != 0) {
-        LOG_WARNING(Common, "Failed to set little core affinity for TID {}: error {}", tid, errno);
-    } else {
-        LOG_DEBUG(Common, "Thread {} pinned to little cores (0-3)", tid);
+    void Report(s64 actual_ns, s64 target_ns) {
+        std::scoped_lock lock{mutex};
+        if (!manager || tids.empty() || target_ns <= 0) {
+            return;
+        }
+        if (tids_changed) {
+            if (session) {
+                close_session(session);
+            }
+            session = create_session(manager, tids.data(), tids.size(), target_ns);
+            target = target_ns;
+            tids_changed = false;
+            if (!session) {
+                LOG_WARNING(Common, "Failed to create a performance hint session");
+                manager = nullptr;
+                return;
+            }
+        } else if (target != target_ns) {
+            update_target(session, target_ns);
+            target = target_ns;
+        }
+        report_actual(session, actual_ns);
     }
+
+private:
+    using CreateSession = void* (*)(void*, const s32*, std::size_t, s64);
+    using UpdateDuration = int (*)(void*, s64);
+    using CloseSession = void (*)(void*);
+
+    DynamicLibrary library;
+    CreateSession create_session = nullptr;
+    UpdateDuration update_target = nullptr;
+    UpdateDuration report_actual = nullptr;
+    CloseSession close_session = nullptr;
+    void* manager = nullptr;
+
+    std::mutex mutex;
+    void* session = nullptr;
+    std::vector<s32> tids;
+    bool tids_changed = false;
+    s64 target = 0;
+};
+
+PerformanceHint& GetPerformanceHint() {
+    static PerformanceHint hint;
+    return hint;
+}
+
+#endif // __ANDROID__
+
+} // Anonymous namespace
+
+bool HasEfficiencyCores() {
+#ifdef __ANDROID__
+    return GetTopology().heterogeneous;
+#else
+    return false;
+#endif
 }
 
-void ResetCoreAffinity() {
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
+void SetCurrentThreadCoreClass(CoreClass core_class) {
+    if (current_core_class == core_class) {
+        return;
+    }
+    current_core_class = core_class;
+
+#ifdef __ANDROID__
+    if (core_class == CoreClass::Prime || core_class == CoreClass::Performance) {
+        JoinPerformanceHintSession();
+    }
+    const Topology& topology = GetTopology();
+    if (!topology.heterogeneous) {
+        return;
+    }
 
-    // Allow all cores
-    int num_cores = sysconf(_SC_NPROCESSORS_CONF);
-    for (int i = 0; i < num_cores; i++) {
-        CPU_SET(i, &cpuset);
+    const pid_t tid = GetThreadId();
+    const auto& mask = topology.masks[static_cast<std::size_t>(core_class)];
+    if (sched_setaffinity(tid, sizeof(mask), &mask) != 0) {
+        LOG_WARNING(Common, "Failed to set the core affinity of thread {}: error {}", tid, errno);
     }
+#endif
+}
 
-    pid_t tid = GetThreadId();
-    int result = sched_setaffinity(tid, sizeof(cpuset), &cpuset);
+CoreClass GetCurrentThreadCoreClass() {
+    return current_core_class;
+}
 
-    if (result != 0) {
-        LOG_WARNING(Common, "Failed to reset core affinity for TID {}: error {}", tid, errno);
-    } else {
-        LOG_DEBUG(Common, "Thread {} affinity reset (all {} cores)", tid, num_cores);
+void JoinPerformanceHintSession() {
+    if (joined_performance_hint) {
+        return;
     }
+    joined_performance_hint = true;
+#ifdef __ANDROID__
+    GetPerformanceHint().AddThread(GetThreadId());
+#endif
 }
 
-} // namespace Common
+void ReportFrameWorkDuration(std::chrono::nanoseconds actual, std::chrono::nanoseconds target) {
+#ifdef __ANDROID__
+    GetPerformanceHint().Report(actual.count(), target.count());
+#endif
+}
 
-#endif // __ANDROID__
\ No newline at end of file
+} // namespace Common
@@ -4,31 +4,41 @@
 
 #pragma once
 
+#include <chrono>
+#include "common/common_types.h"
+
 namespace Common {
 
-#ifdef __ANDROID__
-    /**
- * Pin the current thread to big cores (performance cores)
- * On Snapdragon 8 Gen 2: Cores 4-7 (Cortex-X3 + A720)
- */
-void SetBigCoreAffinity();
+/// Clusters of cores on big.LITTLE devices, detected at runtime from the CPU topology
+enum class CoreClass : u8 {
+    Any,         ///< Every core
+    Prime,       ///< The fastest cluster, used by the emulated CPU
+    Performance, ///< The other big cores, used by the GPU thread and latency critical tasks
+    Efficiency,  ///< The little cores, used by audio and background tasks
+};
+
+/// Returns true if the device has a cluster of efficiency cores next to its big cores
+bool HasEfficiencyCores();
 
 /**
- * Pin the current thread to little cores (efficiency cores)
- * On Snapdragon 8 Gen 2: Cores 0-3 (Cortex-A510)
+ * Restricts the calling thread to the cores of the class. Does nothing on devices with a single
+ * cluster and on platforms other than Android.
  */
-void SetLittleCoreAffinity();
+void SetCurrentThreadCoreClass(CoreClass core_class);
+
+/// Returns the class last set for the calling thread
+CoreClass GetCurrentThreadCoreClass();
 
 /**
- * Allow the current thread to run on any core (reset affinity)
+ * Adds the calling thread to the performance hint session. Threads of the prime and performance
+ * classes are added when their class is set.
  */
-void ResetCoreAffinity();
+void JoinPerformanceHintSession();
 
-#else
-// Stubs pour les autres plateformes
-    inline void SetBigCoreAffinity() {}
-    inline void SetLittleCoreAffinity() {}
-    inline void ResetCoreAffinity() {}
-#endif
+/**
+ * Reports how long the work of a frame took to the Android performance hint manager, which tunes
+ * the clocks of the threads in the session to meet the target. Does nothing elsewhere.
+ */
+void ReportFrameWorkDuration(std::chrono::nanoseconds actual, std::chrono::nanoseconds target);
 
-} // namespace Common
\ No newline at end of file
+} // namespace Common
@@ -14,9 +14,8 @@
 #include <unordered_map>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream.hpp>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
 #include <fmt/format.h>
+#include "common/aes.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_funcs.h"
@@ -424,6 +423,27 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+s64 GetLastWriteTime(const std::string& filename) {
+#ifdef ANDROID
+    // Storage access framework paths do not expose the modification time.
+    return 0;
+#else
+#ifdef _WIN32
+    struct _stat64 buf;
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    struct stat buf;
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<s64>(buf.st_mtime);
+    }
+
+    LOG_ERROR(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+    return 0;
+#endif
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -483,8 +503,9 @@ bool ForeachDirectoryEntry(u64* num_entries_out, const std::string& directory,
         const std::string virtual_name(Common::UTF16ToUTF8(ffd.cFileName));
 #elif ANDROID
     // android loop
-    auto result = AndroidStorage::GetFilesName(directory);
-    for (auto virtual_name : result) {
+    const auto entries = AndroidStorage::GetDirectoryEntries(directory);
+    for (const auto& entry : entries) {
+        const std::string& virtual_name = entry.name;
 #else
     DIR* dirp = opendir(directory.c_str());
     if (!dirp)
@@ -1167,6 +1188,9 @@ bool IOFile::Open() {
     }
 
     m_good = m_file != nullptr;
+    if (m_good && android_open_mode != AndroidStorage::AndroidOpenMode::READ) {
+        AndroidStorage::BeginWrite(filename);
+    }
 #else
     m_file = std::fopen(filename.c_str(), openmode.c_str());
     m_good = m_file != nullptr;
@@ -1176,6 +1200,12 @@ bool IOFile::Open() {
 }
 
 bool IOFile::Close() {
+#ifdef ANDROID
+    if (IsOpen() &&
+        AndroidStorage::ParseOpenmode(openmode) != AndroidStorage::AndroidOpenMode::READ) {
+        AndroidStorage::EndWrite(filename);
+    }
+#endif
     if (!IsOpen() || 0 != std::fclose(m_file))
         m_good = false;
 
@@ -1306,16 +1336,15 @@ struct CryptoIOFileImpl {
     std::vector<u8> key;
     std::vector<u8> iv;
 
-    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d;
-    CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e;
+    Common::AES::CTR d;
+    Common::AES::CTR e;
 
     std::vector<u8> write_buffer;
 
     std::size_t ReadImpl(CryptoIOFile& f, void* data, std::size_t length, std::size_t data_size) {
         std::size_t res = f.IOFile::ReadImpl(data, length, data_size);
         if (res != std::numeric_limits<std::size_t>::max() && res != 0) {
-            d.ProcessData(reinterpret_cast<CryptoPP::byte*>(data),
-                          reinterpret_cast<CryptoPP::byte*>(data), length * data_size);
+            d.ProcessData(static_cast<u8*>(data), static_cast<u8*>(data), length * data_size);
             e.Seek(f.IOFile::Tell());
         }
         return res;
@@ -1326,8 +1355,7 @@ struct CryptoIOFileImpl {
         std::size_t res = f.IOFile::ReadAtImpl(data, length, data_size, offset);
         if (res != std::numeric_limits<std::size_t>::max() && res != 0) {
             d.Seek(offset);
-            d.ProcessData(reinterpret_cast<CryptoPP::byte*>(data),
-                          reinterpret_cast<CryptoPP::byte*>(data), length * data_size);
+            d.ProcessData(static_cast<u8*>(data), static_cast<u8*>(data), length * data_size);
             e.Seek(f.IOFile::Tell());
         }
         return res;
@@ -1338,8 +1366,7 @@ struct CryptoIOFileImpl {
         if (write_buffer.size() < length * data_size) {
             write_buffer.resize(length * data_size);
         }
-        e.ProcessData(write_buffer.data(), reinterpret_cast<const CryptoPP::byte*>(data),
-                      length * data_size);
+        e.ProcessData(write_buffer.data(), static_cast<const u8*>(data), length * data_size);
         std::size_t res = f.IOFile::WriteImpl(write_buffer.data(), length, data_size);
         if (res != std::numeric_limits<std::size_t>::max() && res != 0) {
             d.Seek(f.IOFile::Tell());
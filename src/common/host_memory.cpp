@@ -0,0 +1,238 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <fcntl.h>
+#include <linux/falloc.h>
+#include <linux/memfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAS_HOST_MEMORY_VIEWS
+#endif
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/host_memory.h"
+#include "common/logging/log.h"
+#include "common/memory_detect.h"
+
+namespace Common {
+
+namespace {
+
+/// Reserves zeroed private memory whose pages are only committed when first written to
+u8* AllocatePrivateMemory(std::size_t size) {
+#ifdef _WIN32
+    void* const ptr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    ASSERT_MSG(ptr, "Failed to allocate {:#x} bytes of host memory", size);
+#else
+    void* const ptr =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+             -1, 0);
+    ASSERT_MSG(ptr != MAP_FAILED, "Failed to allocate {:#x} bytes of host memory", size);
+#endif
+    return static_cast<u8*>(ptr);
+}
+
+void FreePrivateMemory(u8* ptr, [[maybe_unused]] std::size_t size) {
+#ifdef _WIN32
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif
+}
+
+/// Zeroes whole host pages of private memory and gives them back to the host
+void DiscardPrivatePages(u8* ptr, std::size_t size) {
+#ifdef _WIN32
+    // Pages committed again are zeroed
+    if (VirtualFree(ptr, size, MEM_DECOMMIT) &&
+        VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE)) {
+        return;
+    }
+#elif defined(__linux__) || defined(__ANDROID__)
+    // Private anonymous pages read as zeros again after being dropped
+    if (madvise(ptr, size, MADV_DONTNEED) == 0) {
+        return;
+    }
+#else
+    if (mmap(ptr, size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0) != MAP_FAILED) {
+        return;
+    }
+#endif
+    std::memset(ptr, 0, size);
+}
+
+} // Anonymous namespace
+
+void HostMemory::Discard(std::size_t offset, std::size_t length) {
+    ASSERT(offset + length <= backing_size);
+    const std::size_t end = offset + length;
+    const std::size_t pages_begin = std::min(AlignUp(offset, host_page_size), end);
+    const std::size_t pages_end = std::max(AlignDown(end, host_page_size), pages_begin);
+    std::memset(backing_base + offset, 0, pages_begin - offset);
+    std::memset(backing_base + pages_end, 0, end - pages_end);
+    if (pages_begin == pages_end) {
+        return;
+    }
+#ifdef HAS_HOST_MEMORY_VIEWS
+    // Punching a hole in the shared memory object drops the pages from every view as well
+    if (fd >= 0) {
+        if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                      static_cast<off_t>(pages_begin),
+                      static_cast<off_t>(pages_end - pages_begin)) != 0) {
+            std::memset(backing_base + pages_begin, 0, pages_end - pages_begin);
+        }
+        return;
+    }
+#endif
+    DiscardPrivatePages(backing_base + pages_begin, pages_end - pages_begin);
+}
+
+std::pair<std::size_t, std::size_t> HostMemory::FindTouchedRange(std::size_t offset) const {
+    if (offset >= backing_size) {
+        return {backing_size, backing_size};
+    }
+#ifdef HAS_HOST_MEMORY_VIEWS
+    // Pages of the shared memory object that were never written to, or were discarded, are holes
+    if (fd >= 0) {
+        const off_t data = lseek(fd, static_cast<off_t>(offset), SEEK_DATA);
+        if (data < 0) {
+            return {backing_size, backing_size};
+        }
+        const off_t hole = lseek(fd, data, SEEK_HOLE);
+        return {static_cast<std::size_t>(data),
+                hole < 0 ? backing_size : static_cast<std::size_t>(hole)};
+    }
+#endif
+    return {offset, backing_size};
+}
+
+#ifdef HAS_HOST_MEMORY_VIEWS
+
+namespace {
+
+int CreateSharedMemory(std::size_t size) {
+    if (GetPageSize() != HostMemoryView::PageSize) {
+        return -1;
+    }
+    // Called through syscall as older Android libc versions lack the wrapper.
+    const int fd = static_cast<int>(syscall(__NR_memfd_create, "HostMemory", MFD_CLOEXEC));
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // Anonymous namespace
+
+HostMemory::HostMemory(std::size_t backing_size_)
+    : backing_size{backing_size_}, host_page_size{static_cast<std::size_t>(GetPageSize())},
+      accounting{MemoryAccounting::Category::EmulatedMemory, backing_size} {
+    fd = CreateSharedMemory(backing_size);
+    if (fd >= 0) {
+        void* const ptr = mmap(nullptr, backing_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr != MAP_FAILED) {
+            backing_base = static_cast<u8*>(ptr);
+            return;
+        }
+        close(fd);
+        fd = -1;
+    }
+    LOG_WARNING(Common_Memory, "Shared memory is not available, host memory views are disabled");
+    backing_base = AllocatePrivateMemory(backing_size);
+}
+
+HostMemory::~HostMemory() {
+    if (fd >= 0) {
+        munmap(backing_base, backing_size);
+        close(fd);
+    } else {
+        FreePrivateMemory(backing_base, backing_size);
+    }
+}
+
+HostMemoryView::HostMemoryView(const HostMemory& memory, std::size_t size_)
+    : backing_base{memory.backing_base}, backing_size{memory.backing_size}, size{size_} {
+    if (!memory.SupportsViews()) {
+        return;
+    }
+    void* const ptr =
+        mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_WARNING(Common_Memory, "Failed to reserve {:#x} bytes for a host memory view", size);
+        return;
+    }
+    // Keep the shared memory object open for as long as pages may still be mapped.
+    fd = dup(memory.fd);
+    if (fd < 0) {
+        munmap(ptr, size);
+        return;
+    }
+    base = static_cast<u8*>(ptr);
+}
+
+HostMemoryView::~HostMemoryView() {
+    if (base) {
+        munmap(base, size);
+        close(fd);
+    }
+}
+
+void HostMemoryView::Map(std::size_t view_offset, std::size_t backing_offset,
+                         std::size_t length) {
+    ASSERT(base && view_offset + length <= size && backing_offset + length <= backing_size);
+    void* const ptr = mmap(base + view_offset, length, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_FIXED, fd, static_cast<off_t>(backing_offset));
+    ASSERT_MSG(ptr != MAP_FAILED, "Failed to map host memory at {:#x}", view_offset);
+}
+
+void HostMemoryView::Unmap(std::size_t view_offset, std::size_t length) {
+    ASSERT(base && view_offset + length <= size);
+    void* const ptr = mmap(base + view_offset, length, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+    ASSERT_MSG(ptr != MAP_FAILED, "Failed to unmap host memory at {:#x}", view_offset);
+}
+
+#else
+
+HostMemory::HostMemory(std::size_t backing_size_)
+    : backing_size{backing_size_}, host_page_size{static_cast<std::size_t>(GetPageSize())},
+      accounting{MemoryAccounting::Category::EmulatedMemory, backing_size},
+      backing_base{AllocatePrivateMemory(backing_size)} {}
+
+HostMemory::~HostMemory() {
+    FreePrivateMemory(backing_base, backing_size);
+}
+
+HostMemoryView::HostMemoryView(const HostMemory& memory, std::size_t size_)
+    : backing_base{memory.backing_base}, backing_size{memory.backing_size}, size{size_} {}
+
+HostMemoryView::~HostMemoryView() = default;
+
+void HostMemoryView::Map(std::size_t, std::size_t, std::size_t) {
+    UNREACHABLE();
+}
+
+void HostMemoryView::Unmap(std::size_t, std::size_t) {
+    UNREACHABLE();
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,107 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+
+namespace Common {
+
+/**
+ * Memory allocated from a shared memory object, so that its pages can also be mapped at other
+ * host addresses through a HostMemoryView. Where this is not supported, for example on hosts
+ * with pages larger than 4 KiB, it falls back to a plain allocation without views. Either way the
+ * memory starts out zeroed and host pages are only committed once they are written to.
+ */
+class HostMemory {
+public:
+    explicit HostMemory(std::size_t backing_size);
+    ~HostMemory();
+
+    HostMemory(const HostMemory&) = delete;
+    HostMemory& operator=(const HostMemory&) = delete;
+
+    u8* BackingBasePointer() const {
+        return backing_base;
+    }
+
+    std::size_t BackingSize() const {
+        return backing_size;
+    }
+
+    /// Returns true when views of the backing memory can be created
+    bool SupportsViews() const {
+        return fd >= 0;
+    }
+
+    /**
+     * Fills length bytes at offset with zeros. The whole host pages in the range are given back
+     * to the host, so that they stop counting towards the resident memory until written again.
+     */
+    void Discard(std::size_t offset, std::size_t length);
+
+    /**
+     * Returns the first range at or after offset that may have been written to since it was
+     * allocated or discarded, everything before it reads as zeros. Both ends are BackingSize()
+     * when there is no such range.
+     */
+    std::pair<std::size_t, std::size_t> FindTouchedRange(std::size_t offset) const;
+
+private:
+    friend class HostMemoryView;
+
+    std::size_t backing_size;
+    std::size_t host_page_size;
+    MemoryAccounting::Allocation accounting;
+    u8* backing_base{};
+    int fd{-1};
+};
+
+/**
+ * A reserved host address range that pages of a HostMemory can be mapped into. Any part of the
+ * range that is not mapped faults on access.
+ */
+class HostMemoryView {
+public:
+    static constexpr std::size_t PageSize = 0x1000;
+
+    explicit HostMemoryView(const HostMemory& memory, std::size_t size);
+    ~HostMemoryView();
+
+    HostMemoryView(const HostMemoryView&) = delete;
+    HostMemoryView& operator=(const HostMemoryView&) = delete;
+
+    /// Returns the start of the range, null when it could not be reserved
+    u8* BasePointer() const {
+        return base;
+    }
+
+    /// Returns the offset of pointer in the backing memory, if it points into it
+    std::optional<std::size_t> BackingOffset(const u8* pointer) const {
+        if (pointer < backing_base || pointer >= backing_base + backing_size) {
+            return std::nullopt;
+        }
+        return static_cast<std::size_t>(pointer - backing_base);
+    }
+
+    /// Maps length bytes of the backing memory at backing_offset to view_offset
+    void Map(std::size_t view_offset, std::size_t backing_offset, std::size_t length);
+
+    /// Makes accesses to length bytes at view_offset fault again
+    void Unmap(std::size_t view_offset, std::size_t length);
+
+private:
+    const u8* backing_base;
+    std::size_t backing_size;
+    u8* base{};
+    std::size_t size;
+    int fd{-1};
+};
+
+} // namespace Common
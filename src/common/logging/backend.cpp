@@ -2,7 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/regex.hpp>
 
@@ -22,7 +30,6 @@
 #include <signal.h>
 #endif
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/literals.h"
@@ -199,6 +206,85 @@ public:
 bool initialization_in_progress_suppress_logging = true;
 bool logging_initialized = false;
 
+constexpr std::size_t RecordsPerThread = 1024;
+/// Larger argument lists are formatted by the logging thread before they are queued
+constexpr std::size_t MaxDeferredArgsSize = 64;
+/// Messages allowed from a single call site per second before the rest are suppressed
+constexpr u32 MaxMessagesPerSite = 500;
+
+/**
+ * A queued log message. Either message holds the formatted text, or formatter is set and
+ * formats args with format once the logging thread writes the record.
+ */
+struct Record {
+    std::chrono::steady_clock::time_point time;
+    const char* filename;
+    const char* function;
+    fmt::string_view format;
+    Detail::DeferredFormatter formatter;
+    u32 line_num;
+    Class log_class;
+    Level log_level;
+    std::array<u8, MaxDeferredArgsSize> args;
+    std::string message;
+};
+
+/// Single producer, single consumer ring of records written by one thread only
+struct ThreadBuffer {
+    bool owned = true;
+    std::atomic<u64> write_index = 0;
+    std::atomic<u64> read_index = 0;
+    std::atomic<u64> dropped = 0;
+    std::array<Record, RecordsPerThread> records;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+/// Releases the thread's buffer for reuse by a later thread once the thread exits
+struct ThreadBufferHolder {
+    ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferHolder() {
+        if (buffer) {
+            std::scoped_lock lock{GetRegistry().mutex};
+            buffer->owned = false;
+        }
+    }
+};
+
+thread_local ThreadBufferHolder thread_buffer;
+
+ThreadBuffer& GetThreadBuffer() {
+    if (thread_buffer.buffer) [[likely]] {
+        return *thread_buffer.buffer;
+    }
+
+    // Records left behind by an exited thread are still read in order by the logging thread
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    ThreadBuffer* buffer = nullptr;
+    for (const auto& candidate : registry.buffers) {
+        if (!candidate->owned) {
+            buffer = candidate.get();
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = registry.buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+    }
+    buffer->owned = true;
+    thread_buffer.buffer = buffer;
+    return *buffer;
+}
+
 #ifdef CITRA_LINUX_GCC_BACKTRACE
 [[noreturn]] void SleepForever() {
     while (true) {
@@ -270,25 +356,59 @@ public:
         color_console_backend.SetEnabled(enabled);
     }
 
-    void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, std::string message) {
-        if (!filter.CheckMessage(log_class, log_level)) {
-            return;
-        }
-        Entry new_entry = CreateEntry(log_class, log_level, filename, line_num, function,
-                                      std::move(message), time_origin);
-        if (!regex_filter.empty() &&
-            !boost::regex_search(FormatLogMessage(new_entry), regex_filter)) {
-            return;
+    bool CheckMessage(Class log_class, Level log_level) const {
+        return filter.CheckMessage(log_class, log_level);
+    }
+
+    /**
+     * Queues a message to the buffer of the calling thread without taking any lock. The message is
+     * dropped if the buffer is full, the logging thread reports how many were lost.
+     */
+    void PushRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                    const char* function, fmt::string_view format,
+                    Detail::DeferredFormatter formatter, const u8* args, std::size_t args_size,
+                    std::string message) {
+        if (formatter && args_size > MaxDeferredArgsSize) {
+            message = formatter(format, args);
+            formatter = nullptr;
         }
         if (Settings::values.instant_debug_log.GetValue()) {
+            if (formatter) {
+                message = formatter(format, args);
+            }
+            Entry new_entry = CreateEntry(log_class, log_level, filename, line_num, function,
+                                          std::move(message), time_origin);
+            if (!regex_filter.empty() &&
+                !boost::regex_search(FormatLogMessage(new_entry), regex_filter)) {
+                return;
+            }
             ForEachBackend([&new_entry](Backend& backend) {
                 backend.Write(new_entry);
                 backend.Flush();
             });
-        } else {
-            message_queue.EmplaceWait(new_entry);
+            return;
+        }
+
+        ThreadBuffer& buffer = GetThreadBuffer();
+        const u64 write = buffer.write_index.load(std::memory_order_relaxed);
+        if (write - buffer.read_index.load(std::memory_order_acquire) >= RecordsPerThread) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Record& record = buffer.records[write % RecordsPerThread];
+        record.time = std::chrono::steady_clock::now();
+        record.filename = filename;
+        record.function = function;
+        record.format = format;
+        record.formatter = formatter;
+        record.line_num = line_num;
+        record.log_class = log_class;
+        record.log_level = log_level;
+        if (formatter) {
+            std::memcpy(record.args.data(), args, args_size);
         }
+        record.message = std::move(message);
+        buffer.write_index.store(write + 1, std::memory_order_release);
     }
 
     static Entry CreateEntry(Class log_class, Level log_level, const char* filename,
@@ -378,27 +498,127 @@ private:
     void StartBackendThread() {
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("citra:Log");
-            Entry entry;
-            const auto write_logs = [this, &entry]() {
-                ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
-            };
+            using namespace std::chrono_literals;
+            std::vector<Record> batch;
+            auto idle_wait = 1ms;
             while (!stop_token.stop_requested()) {
-                message_queue.PopWait(entry, stop_token);
-                // Only write the log if something was actually popped (entry.filename != nullptr)
-                // (for example, when the stop token is signaled).
-                if (entry.filename != nullptr) {
-                    write_logs();
+                if (DrainBuffers(batch)) {
+                    WriteRecords(batch);
+                    idle_wait = 1ms;
+                } else {
+                    // Back off while nothing is being logged
+                    Common::StoppableTimedWait(stop_token, idle_wait);
+                    idle_wait = std::min<std::chrono::milliseconds>(idle_wait + 1ms, 5ms);
                 }
             }
-            // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a
-            // case where a system is repeatedly spamming logs even on close.
-            int max_logs_to_write = filter.IsDebug() ? INT_MAX : 100;
-            while (max_logs_to_write-- && message_queue.TryPop(entry)) {
-                write_logs();
+            // The buffers are bounded, so whatever is left can be written out in full
+            if (DrainBuffers(batch)) {
+                WriteRecords(batch);
             }
+            FlushSuppressed();
         });
     }
 
+    /// Moves the records of all thread buffers into batch, in the order they were logged
+    bool DrainBuffers(std::vector<Record>& batch) {
+        batch.clear();
+        Registry& registry = GetRegistry();
+        std::scoped_lock lock{registry.mutex};
+        for (const auto& buffer : registry.buffers) {
+            if (const u64 dropped = buffer->dropped.exchange(0, std::memory_order_relaxed)) {
+                Record& record = batch.emplace_back();
+                record.time = std::chrono::steady_clock::now();
+                record.filename = __FILE__;
+                record.function = __func__;
+                record.formatter = nullptr;
+                record.line_num = __LINE__;
+                record.log_class = Class::Log;
+                record.log_level = Level::Warning;
+                record.message = fmt::format("Dropped {} messages, a log buffer was full", dropped);
+            }
+
+            const u64 read = buffer->read_index.load(std::memory_order_relaxed);
+            const u64 write = buffer->write_index.load(std::memory_order_acquire);
+            for (u64 i = read; i < write; i++) {
+                batch.push_back(std::move(buffer->records[i % RecordsPerThread]));
+            }
+            buffer->read_index.store(write, std::memory_order_release);
+        }
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const Record& a, const Record& b) { return a.time < b.time; });
+        return !batch.empty();
+    }
+
+    void WriteRecords(std::vector<Record>& batch) {
+        for (Record& record : batch) {
+            if (IsSuppressed(record)) {
+                continue;
+            }
+            if (record.formatter) {
+                record.message = record.formatter(record.format, record.args.data());
+            }
+            WriteEntry({
+                .timestamp = std::chrono::duration_cast<std::chrono::microseconds>(record.time -
+                                                                                   time_origin),
+                .log_class = record.log_class,
+                .log_level = record.log_level,
+                .filename = record.filename,
+                .line_num = record.line_num,
+                .function = record.function,
+                .message = std::move(record.message),
+            });
+        }
+    }
+
+    void WriteEntry(const Entry& entry) {
+        if (!regex_filter.empty() && !boost::regex_search(FormatLogMessage(entry), regex_filter)) {
+            return;
+        }
+        ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+    }
+
+    struct CallSite {
+        std::chrono::steady_clock::time_point window_start;
+        u32 count = 0;
+        u64 suppressed = 0;
+    };
+
+    /// Rate limits every call site to keep a spamming message from flooding the log
+    bool IsSuppressed(const Record& record) {
+        if (record.log_level >= Level::Critical) {
+            return false;
+        }
+        using namespace std::chrono_literals;
+        CallSite& site = call_sites[{record.filename, record.line_num}];
+        if (record.time - site.window_start >= 1s) {
+            ReportSuppressed(record.filename, record.line_num, site);
+            site.window_start = record.time;
+            site.count = 0;
+        }
+        if (++site.count > MaxMessagesPerSite) {
+            site.suppressed++;
+            return true;
+        }
+        return false;
+    }
+
+    void ReportSuppressed(const char* filename, u32 line_num, CallSite& site) {
+        if (site.suppressed == 0) {
+            return;
+        }
+        WriteEntry(CreateEntry(
+            Class::Log, Level::Warning, filename, line_num, "",
+            fmt::format("Suppressed {} messages from {}:{}", site.suppressed, filename, line_num),
+            time_origin));
+        site.suppressed = 0;
+    }
+
+    void FlushSuppressed() {
+        for (auto& [key, site] : call_sites) {
+            ReportSuppressed(key.first, key.second, site);
+        }
+    }
+
     void StopBackendThread() {
         backend_thread.request_stop();
         if (backend_thread.joinable()) {
@@ -465,7 +685,8 @@ private:
     LogcatBackend lc_backend{};
 #endif
 
-    MPSCQueue<Entry> message_queue{};
+    /// Only accessed by the logging thread
+    std::map<std::pair<const char*, u32>, CallSite> call_sites;
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
 
@@ -514,8 +735,11 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
     }
 
     if (logging_initialized) [[likely]] {
-        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
-                                   fmt::vformat(format, args));
+        Impl& impl = Impl::Instance();
+        if (impl.CheckMessage(log_class, log_level)) {
+            impl.PushRecord(log_class, log_level, filename, line_num, function, format, nullptr,
+                            nullptr, 0, fmt::vformat(format, args));
+        }
     } else {
         // In the rare case that logging occurs before initialization, write the
         // message to stderr to preserve useful debug information.
@@ -524,4 +748,28 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
         PrintMessage(new_entry);
     }
 }
+
+namespace Detail {
+
+void PushDeferred(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                  const char* function, fmt::string_view format, DeferredFormatter formatter,
+                  const u8* args, std::size_t args_size) {
+    if (initialization_in_progress_suppress_logging) [[unlikely]] {
+        return;
+    }
+
+    if (logging_initialized) [[likely]] {
+        Impl& impl = Impl::Instance();
+        if (impl.CheckMessage(log_class, log_level)) {
+            impl.PushRecord(log_class, log_level, filename, line_num, function, format, formatter,
+                            args, args_size, {});
+        }
+    } else {
+        Entry new_entry = Impl::CreateEntry(log_class, log_level, filename, line_num, function,
+                                            formatter(format, args), {});
+        PrintMessage(new_entry);
+    }
+}
+
+} // namespace Detail
 } // namespace Common::Log
@@ -98,6 +98,7 @@ bool ParseFilterRule(Filter& instance, Iterator begin, Iterator end) {
     SUB(Service, PTM)                                                                              \
     SUB(Service, LDR)                                                                              \
     SUB(Service, MIC)                                                                              \
+    SUB(Service, MVD)                                                                              \
     SUB(Service, NDM)                                                                              \
     SUB(Service, NFC)                                                                              \
     SUB(Service, NIM)                                                                              \
@@ -6,7 +6,11 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
@@ -27,11 +31,60 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
                        const fmt::format_args& args);
 
+namespace Detail {
+
+/// Formats arguments that were copied into a log record, called by the logging thread
+using DeferredFormatter = std::string (*)(fmt::string_view format, const u8* args);
+
+/**
+ * Arguments that are copied into the log record as they are and formatted by the logging thread.
+ * Strings and other types referencing memory are formatted right away, the memory could be gone
+ * by the time the record is written.
+ */
+template <typename T>
+constexpr bool IsDeferrable =
+    std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+    (std::is_pointer_v<T> && !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>);
+
+template <typename... Args>
+std::string FormatDeferred(fmt::string_view format, const u8* data) {
+    [[maybe_unused]] std::size_t offset = 0;
+    const auto read = [&]<typename T>(std::type_identity<T>) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    };
+    // Braced initialization reads the arguments in order
+    const std::tuple<Args...> args{read(std::type_identity<Args>{})...};
+    return std::apply(
+        [format](const auto&... values) {
+            return fmt::vformat(format, fmt::make_format_args(values...));
+        },
+        args);
+}
+
+/// Queues a record with the encoded arguments to the log buffer of the calling thread
+void PushDeferred(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                  const char* function, fmt::string_view format, DeferredFormatter formatter,
+                  const u8* args, std::size_t args_size);
+
+} // namespace Detail
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, fmt::format_string<Args...> format, const Args&... args) {
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+    if constexpr ((Detail::IsDeferrable<Args> && ...)) {
+        // Formatting is left to the logging thread, only the raw arguments are copied here
+        std::array<u8, (sizeof(Args) + ... + 0)> data;
+        [[maybe_unused]] std::size_t offset = 0;
+        ((std::memcpy(data.data() + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+        Detail::PushDeferred(log_class, log_level, filename, line_num, function, format,
+                             &Detail::FormatDeferred<Args...>, data.data(), data.size());
+    } else {
+        FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                          fmt::make_format_args(args...));
+    }
 }
 
 } // namespace Common::Log
@@ -65,6 +65,7 @@ enum class Class : u8 {
     Service_PTM,     ///< The PTM (Power status & misc.) service
     Service_LDR,     ///< The LDR (3ds dll loader) service
     Service_MIC,     ///< The MIC (Microphone) service
+    Service_MVD,     ///< The MVD (Video decoder) service
     Service_NDM,     ///< The NDM (Network daemon manager) service
     Service_NFC,     ///< The NFC service
     Service_NIM,     ///< The NIM (Network interface manager) service
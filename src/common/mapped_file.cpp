@@ -0,0 +1,67 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/file_util.h"
+#include "common/mapped_file.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Common {
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const FileUtil::IOFile& file) {
+    Close();
+
+    const int fd = file.GetFd();
+    const u64 file_size = file.GetSize();
+    if (fd < 0 || file_size == 0) {
+        return false;
+    }
+
+#ifdef _WIN32
+    const HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle) {
+        return false;
+    }
+    base = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+#else
+    void* const pointer = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    base = pointer != MAP_FAILED ? static_cast<u8*>(pointer) : nullptr;
+#endif
+    if (!base) {
+        Close();
+        return false;
+    }
+    size = static_cast<std::size_t>(file_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (base) {
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(base, size);
+#endif
+    }
+#ifdef _WIN32
+    if (mapping_handle) {
+        CloseHandle(mapping_handle);
+    }
+    mapping_handle = nullptr;
+#endif
+    base = nullptr;
+    size = 0;
+}
+
+} // namespace Common
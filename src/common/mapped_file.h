@@ -0,0 +1,51 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include "common/common_types.h"
+
+namespace FileUtil {
+class IOFile;
+}
+
+namespace Common {
+
+/**
+ * Read-only memory mapping of a whole file. The pages come from the page cache of the host, so
+ * every process mapping the same file shares them instead of holding a copy of its own.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Maps the contents of an open file. Returns false if the file could not be mapped.
+    bool Open(const FileUtil::IOFile& file);
+
+    /// Unmaps the file.
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return base != nullptr;
+    }
+
+    [[nodiscard]] std::span<const u8> Data() const noexcept {
+        return {base, size};
+    }
+
+private:
+    u8* base{};
+    std::size_t size{};
+#ifdef _WIN32
+    void* mapping_handle{};
+#endif
+};
+
+} // namespace Common
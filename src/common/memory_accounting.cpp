@@ -0,0 +1,59 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/memory_accounting.h"
+
+namespace Common::MemoryAccounting {
+
+namespace Detail {
+
+std::array<std::atomic<u64>, NumCategories> current{};
+std::array<std::atomic<u64>, NumCategories> peak{};
+std::atomic<u64> peak_total{};
+
+namespace {
+void RaisePeak(std::atomic<u64>& peak_value, u64 value) {
+    u64 previous = peak_value.load(std::memory_order_relaxed);
+    while (previous < value &&
+           !peak_value.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+    }
+}
+} // Anonymous namespace
+
+void UpdatePeak(Category category, u64 value) {
+    RaisePeak(peak[static_cast<std::size_t>(category)], value);
+
+    u64 total = 0;
+    for (const auto& bytes : current) {
+        total += bytes.load(std::memory_order_relaxed);
+    }
+    RaisePeak(peak_total, total);
+}
+
+} // namespace Detail
+
+Usage GetUsage() {
+    Usage usage;
+    for (std::size_t i = 0; i < NumCategories; i++) {
+        usage.current[i] = Detail::current[i].load(std::memory_order_relaxed);
+        usage.peak[i] = Detail::peak[i].load(std::memory_order_relaxed);
+    }
+    return usage;
+}
+
+u64 GetPeakTotal() {
+    return Detail::peak_total.load(std::memory_order_relaxed);
+}
+
+void ResetPeaks() {
+    u64 total = 0;
+    for (std::size_t i = 0; i < NumCategories; i++) {
+        const u64 bytes = Detail::current[i].load(std::memory_order_relaxed);
+        Detail::peak[i].store(bytes, std::memory_order_relaxed);
+        total += bytes;
+    }
+    Detail::peak_total.store(total, std::memory_order_relaxed);
+}
+
+} // namespace Common::MemoryAccounting
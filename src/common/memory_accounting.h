@@ -0,0 +1,145 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <utility>
+#include "common/common_types.h"
+
+/**
+ * Accounting of the host memory held by each subsystem, so that the memory use of the emulator
+ * can be broken down and checked against a budget. Owners report their allocations and frees,
+ * the current and peak bytes of each category are shown by the performance overlays and sampled
+ * into exported traces. Updating a category costs a relaxed atomic add.
+ */
+namespace Common::MemoryAccounting {
+
+enum class Category : u32 {
+    EmulatedMemory, ///< Backing of the emulated FCRAM, VRAM, DSP and N3DS memory
+    TextureCache,   ///< Host textures of the rasterizer cache
+    StagingBuffers, ///< Upload, download and stream buffers
+    JitCode,        ///< Code caches of the CPU JITs
+    ShaderCache,    ///< Compiled shader programs and pipelines
+    CustomTextures, ///< Decoded custom textures
+    Savestates,     ///< Serialized savestates held in memory
+    Audio,          ///< Sample queues of the audio core and sinks
+    Count,
+};
+
+constexpr std::size_t NumCategories = static_cast<std::size_t>(Category::Count);
+
+constexpr std::array<const char*, NumCategories> CategoryNames = {
+    "Emulated memory",
+    "Texture cache",
+    "Staging buffers",
+    "JIT code",
+    "Shader cache",
+    "Custom textures",
+    "Savestates",
+    "Audio",
+};
+
+/// Bytes of each category, current and peak
+struct Usage {
+    std::array<u64, NumCategories> current{};
+    std::array<u64, NumCategories> peak{};
+
+    [[nodiscard]] u64 TotalCurrent() const {
+        u64 total = 0;
+        for (const u64 bytes : current) {
+            total += bytes;
+        }
+        return total;
+    }
+};
+
+namespace Detail {
+extern std::array<std::atomic<u64>, NumCategories> current;
+extern std::array<std::atomic<u64>, NumCategories> peak;
+extern std::atomic<u64> peak_total;
+
+void UpdatePeak(Category category, u64 value);
+} // namespace Detail
+
+/// Records bytes allocated by the category
+inline void Allocate(Category category, u64 bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    const std::size_t index = static_cast<std::size_t>(category);
+    const u64 value = Detail::current[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    Detail::UpdatePeak(category, value);
+}
+
+/// Records bytes freed by the category
+inline void Free(Category category, u64 bytes) {
+    Detail::current[static_cast<std::size_t>(category)].fetch_sub(bytes,
+                                                                  std::memory_order_relaxed);
+}
+
+/// Sets the bytes of a category whose owner tracks its total itself
+inline void SetUsage(Category category, u64 bytes) {
+    Detail::current[static_cast<std::size_t>(category)].store(bytes, std::memory_order_relaxed);
+    Detail::UpdatePeak(category, bytes);
+}
+
+/// Returns the current and peak bytes of every category
+[[nodiscard]] Usage GetUsage();
+
+/// Returns the highest total of all categories seen so far
+[[nodiscard]] u64 GetPeakTotal();
+
+/// Starts the peaks over from the current values
+void ResetPeaks();
+
+/// Accounts bytes to a category for as long as the object lives
+class Allocation {
+public:
+    Allocation() = default;
+
+    explicit Allocation(Category category_, u64 bytes_) : category{category_}, bytes{bytes_} {
+        Allocate(category, bytes);
+    }
+
+    ~Allocation() {
+        Free(category, bytes);
+    }
+
+    Allocation(const Allocation&) = delete;
+    Allocation& operator=(const Allocation&) = delete;
+
+    Allocation(Allocation&& other) noexcept
+        : category{other.category}, bytes{std::exchange(other.bytes, 0)} {}
+
+    Allocation& operator=(Allocation&& other) noexcept {
+        if (this != &other) {
+            Free(category, bytes);
+            category = other.category;
+            bytes = std::exchange(other.bytes, 0);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] u64 Size() const {
+        return bytes;
+    }
+
+    /// Changes the accounted size, for owners that grow or shrink in place
+    void Resize(u64 new_bytes) {
+        if (new_bytes > bytes) {
+            Allocate(category, new_bytes - bytes);
+        } else {
+            Free(category, bytes - new_bytes);
+        }
+        bytes = new_bytes;
+    }
+
+private:
+    Category category{};
+    u64 bytes{};
+};
+
+} // namespace Common::MemoryAccounting
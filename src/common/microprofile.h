@@ -21,5 +21,32 @@ typedef void* HANDLE;
 #endif
 
 #include <microprofile.h>
+#include "common/tracing.h"
+
+// Every profiled scope is also recorded by the tracing backend, which stays available when the
+// MicroProfile UI is not (e.g. on Android).
+#undef MICROPROFILE_DECLARE
+#undef MICROPROFILE_DEFINE
+#undef MICROPROFILE_SCOPE
+#if MICROPROFILE_ENABLED
+#define MICROPROFILE_DECLARE(var)                                                                  \
+    extern MicroProfileToken g_mp_##var;                                                           \
+    extern const Common::Tracing::Scope g_trace_##var
+#define MICROPROFILE_DEFINE(var, group, name, color)                                               \
+    extern const Common::Tracing::Scope g_trace_##var;                                             \
+    const Common::Tracing::Scope g_trace_##var{group, name};                                       \
+    MicroProfileToken g_mp_##var =                                                                 \
+        MicroProfileGetToken(group, name, color, MicroProfileTokenTypeCpu)
+#define MICROPROFILE_SCOPE(var)                                                                    \
+    Common::Tracing::ScopedEvent MICROPROFILE_TOKEN_PASTE(trace, __LINE__)(g_trace_##var);         \
+    MicroProfileScopeHandler MICROPROFILE_TOKEN_PASTE(foo, __LINE__)(g_mp_##var)
+#else
+#define MICROPROFILE_DECLARE(var) extern const Common::Tracing::Scope g_trace_##var
+#define MICROPROFILE_DEFINE(var, group, name, color)                                               \
+    extern const Common::Tracing::Scope g_trace_##var;                                             \
+    const Common::Tracing::Scope g_trace_##var{group, name}
+#define MICROPROFILE_SCOPE(var)                                                                    \
+    Common::Tracing::ScopedEvent MICROPROFILE_TOKEN_PASTE(trace, __LINE__)(g_trace_##var)
+#endif
 
 #define MP_RGB(r, g, b) ((r) << 16 | (g) << 8 | (b) << 0)
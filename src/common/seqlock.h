@@ -0,0 +1,66 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Lock-free publication of a small value from a single writer to any number of readers. Readers
+ * copy the value and retry if the writer stored a new one in the meantime, the writer never waits.
+ * The value is kept in atomic words so that the racing copies are well defined.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values must be trivially copyable");
+
+public:
+    SeqLock() {
+        Store(T{});
+    }
+
+    /// Publishes a new value. Only called by the writer.
+    void Store(const T& value) noexcept {
+        std::array<u64, NumWords> copy{};
+        std::memcpy(copy.data(), &value, sizeof(T));
+        const u32 seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < NumWords; i++) {
+            words[i].store(copy[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Returns the last published value
+    [[nodiscard]] T Load() const noexcept {
+        std::array<u64, NumWords> copy;
+        u32 seq;
+        do {
+            seq = sequence.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < NumWords; i++) {
+                copy[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((seq & 1) != 0 || seq != sequence.load(std::memory_order_relaxed));
+
+        T value;
+        std::memcpy(&value, copy.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr std::size_t NumWords = (sizeof(T) + sizeof(u64) - 1) / sizeof(u64);
+
+    std::atomic<u32> sequence{0};
+    std::array<std::atomic<u64>, NumWords> words{};
+};
+
+} // namespace Common
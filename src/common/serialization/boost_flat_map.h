@@ -0,0 +1,34 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <boost/container/flat_map.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/split_free.hpp>
+
+namespace boost::serialization {
+
+// Uses the same format as std::map, so that containers can switch between the two without
+// breaking existing savestates.
+
+template <class Archive, class Key, class T>
+void save(Archive& ar, const boost::container::flat_map<Key, T>& map,
+          const unsigned int file_version) {
+    boost::serialization::stl::save_collection<Archive, boost::container::flat_map<Key, T>>(ar,
+                                                                                          map);
+}
+
+template <class Archive, class Key, class T>
+void load(Archive& ar, boost::container::flat_map<Key, T>& map, const unsigned int file_version) {
+    boost::serialization::load_map_collection(ar, map);
+}
+
+template <class Archive, class Key, class T>
+void serialize(Archive& ar, boost::container::flat_map<Key, T>& map,
+               const unsigned int file_version) {
+    boost::serialization::split_free(ar, map, file_version);
+}
+
+} // namespace boost::serialization
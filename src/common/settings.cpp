@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <mutex>
 #include <string_view>
 #include <utility>
 #include "audio_core/dsp_interface.h"
@@ -74,6 +75,8 @@ std::string_view GetTextureSamplingName(TextureSampling sampling) {
 
 Values values = {};
 static bool configuring_global = true;
+static std::mutex runtime_settings_mutex;
+static RuntimeSettings runtime_settings;
 bool is_temporary_frame_limit;
 double temporary_frame_limit;
 
@@ -84,12 +87,23 @@ void LogSettings() {
 
     LOG_INFO(Config, "Azahar Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit.GetValue());
+    log_setting("Core_JitCacheBudget", values.jit_cache_budget.GetValue());
+    log_setting("Core_UseFastmem", values.use_fastmem.GetValue());
+    log_setting("Core_UseMulticore", values.use_multicore.GetValue());
+    log_setting("Core_SkipBusyWaits", values.skip_busy_waits.GetValue());
+    log_setting("Background Save States", values.background_savestates.GetValue());
+    log_setting("Fast Resume", values.fast_resume.GetValue());
+    log_setting("Save State Compression Level", values.savestate_compression_level.GetValue());
+    log_setting("Rewind Interval", values.rewind_interval.GetValue());
+    log_setting("Rewind Buffer Size", values.rewind_buffer_size.GetValue());
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage.GetValue());
     log_setting("Controller_UseArticController", values.use_artic_base_controller.GetValue());
+    log_setting("Controller_InputPollingRate", values.input_polling_rate.GetValue());
     log_setting("Renderer_UseGLES", values.use_gles.GetValue());
     log_setting("Renderer_GraphicsAPI", GetGraphicsAPIName(values.graphics_api.GetValue()));
     log_setting("Renderer_AsyncShaders", values.async_shader_compilation.GetValue());
     log_setting("Renderer_AsyncPresentation", values.async_presentation.GetValue());
+    log_setting("Renderer_PresentQueueDepth", values.present_queue_depth.GetValue());
     log_setting("Renderer_SpirvShaderGen", values.spirv_shader_gen.GetValue());
     log_setting("Renderer_DisableSpirvOptimizer", values.disable_spirv_optimizer.GetValue());
     log_setting("Renderer_Debug", values.renderer_debug.GetValue());
@@ -97,15 +111,28 @@ void LogSettings() {
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul.GetValue());
     log_setting("Renderer_UseShaderJit", values.use_shader_jit.GetValue());
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor.GetValue());
+    log_setting("Renderer_DynamicResolution", values.dynamic_resolution.GetValue());
+    log_setting("Renderer_AutoFrameSkip", values.auto_frame_skip.GetValue());
     log_setting("Renderer_FrameLimit", values.frame_limit.GetValue());
     log_setting("Renderer_VSyncNew", values.use_vsync.GetValue());
     log_setting("Renderer_PostProcessingShader", values.pp_shader_name.GetValue());
     log_setting("Renderer_FilterMode", values.filter_mode.GetValue());
+    log_setting("Renderer_SpatialUpscaling", values.spatial_upscaling.GetValue());
     log_setting("Renderer_TextureFilter", GetTextureFilterName(values.texture_filter.GetValue()));
     log_setting("Renderer_TextureSampling",
                 GetTextureSamplingName(values.texture_sampling.GetValue()));
     log_setting("Renderer_DelayGameRenderThreasUs", values.delay_game_render_thread_us.GetValue());
     log_setting("Renderer_DisableRightEyeRender", values.disable_right_eye_render.GetValue());
+    log_setting("Renderer_AsyncTextureUpload", values.async_texture_upload.GetValue());
+    log_setting("Renderer_GpuTextureDecode", values.gpu_texture_decode.GetValue());
+    log_setting("Renderer_AccurateMipmaps", values.accurate_mipmaps.GetValue());
+    log_setting("Renderer_TextureMemoryBudget", values.texture_memory_budget.GetValue());
+    log_setting("Renderer_UseDescriptorBuffer", values.use_descriptor_buffer.GetValue());
+    log_setting("Renderer_ParallelCommandRecording", values.parallel_command_recording.GetValue());
+    log_setting("Renderer_AsyncCompute", values.async_compute.GetValue());
+    log_setting("Renderer_FramePacing", values.frame_pacing.GetValue());
+    log_setting("Renderer_AsyncGpu", values.async_gpu.GetValue());
+    log_setting("Renderer_MergeStereoRenders", values.merge_stereo_renders.GetValue());
     log_setting("Stereoscopy_Render3d", values.render_3d.GetValue());
     log_setting("Stereoscopy_Factor3d", values.factor_3d.GetValue());
     log_setting("Stereoscopy_Swap_Eyes", values.swap_eyes_3d.GetValue());
@@ -124,9 +151,11 @@ void LogSettings() {
     log_setting("Layout_LargeScreenProportion", values.large_screen_proportion.GetValue());
     log_setting("Layout_SmallScreenPosition", values.small_screen_position.GetValue());
     log_setting("Utility_DumpTextures", values.dump_textures.GetValue());
+    log_setting("Utility_FastTextureDumping", values.fast_texture_dumping.GetValue());
     log_setting("Utility_CustomTextures", values.custom_textures.GetValue());
     log_setting("Utility_PreloadTextures", values.preload_textures.GetValue());
     log_setting("Utility_AsyncCustomLoading", values.async_custom_loading.GetValue());
+    log_setting("Utility_TranscodeCustomTextures", values.transcode_custom_textures.GetValue());
     log_setting("Utility_UseDiskShaderCache", values.use_disk_shader_cache.GetValue());
     log_setting("Audio_Emulation", GetAudioEmulationName(values.audio_emulation.GetValue()));
     log_setting("Audio_OutputType", values.output_type.GetValue());
@@ -135,6 +164,7 @@ void LogSettings() {
     log_setting("Audio_InputDevice", values.input_device.GetValue());
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching.GetValue());
     log_setting("Audio_EnableRealtime", values.enable_realtime_audio.GetValue());
+    log_setting("Audio_AsyncRendering", values.async_audio_rendering.GetValue());
     using namespace Service::CAM;
     log_setting("Camera_OuterRightName", values.camera_name[OuterRightCamera]);
     log_setting("Camera_OuterRightConfig", values.camera_config[OuterRightCamera]);
@@ -147,6 +177,11 @@ void LogSettings() {
     log_setting("Camera_OuterLeftFlip", values.camera_flip[OuterLeftCamera]);
     log_setting("DataStorage_UseVirtualSd", values.use_virtual_sd.GetValue());
     log_setting("DataStorage_UseCustomStorage", values.use_custom_storage.GetValue());
+    log_setting("DataStorage_CacheDecryptedRomFS", values.cache_decrypted_romfs.GetValue());
+    log_setting("DataStorage_Z3DSFrameCacheSize", values.z3ds_frame_cache_size.GetValue());
+    log_setting("DataStorage_Z3DSCompressionLevel", values.z3ds_compression_level.GetValue());
+    log_setting("DataStorage_Z3DSLongDistanceMatching",
+                values.z3ds_long_distance_matching.GetValue());
     if (values.use_custom_storage) {
         log_setting("DataStorage_SdmcDir", FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir));
         log_setting("DataStorage_NandDir", FileUtil::GetUserPath(FileUtil::UserPath::NANDDir));
@@ -163,6 +198,46 @@ void LogSettings() {
     log_setting("Debugging_InstantDebugLog", values.instant_debug_log.GetValue());
 }
 
+void UpdateRuntimeSettings() {
+    RuntimeSettings snapshot;
+    snapshot.texture_memory_budget = u64{values.texture_memory_budget.GetValue()} << 20;
+    snapshot.texture_filter = values.texture_filter.GetValue();
+    snapshot.texture_sampling = values.texture_sampling.GetValue();
+    snapshot.mono_render_option = values.mono_render_option.GetValue();
+    snapshot.use_hw_shader = values.use_hw_shader.GetValue();
+    snapshot.filter_mode = values.filter_mode.GetValue();
+    snapshot.swap_eyes_3d = values.swap_eyes_3d.GetValue();
+    snapshot.custom_textures = values.custom_textures.GetValue();
+    snapshot.async_texture_upload = values.async_texture_upload.GetValue();
+    snapshot.gpu_texture_decode = values.gpu_texture_decode.GetValue();
+
+    std::scoped_lock lock{runtime_settings_mutex};
+    snapshot.generation = runtime_settings.generation + 1;
+    runtime_settings = snapshot;
+}
+
+RuntimeSettings GetRuntimeSettings() {
+    RuntimeSettings snapshot;
+    RefreshRuntimeSettings(snapshot);
+    return snapshot;
+}
+
+bool RefreshRuntimeSettings(RuntimeSettings& snapshot) {
+    {
+        std::scoped_lock lock{runtime_settings_mutex};
+        if (runtime_settings.generation != 0) {
+            if (snapshot.generation == runtime_settings.generation) {
+                return false;
+            }
+            snapshot = runtime_settings;
+            return true;
+        }
+    }
+    // No snapshot was taken yet
+    UpdateRuntimeSettings();
+    return RefreshRuntimeSettings(snapshot);
+}
+
 bool IsConfiguringGlobal() {
     return configuring_global;
 }
@@ -188,6 +263,7 @@ void RestoreGlobalState(bool is_powered_on) {
     values.audio_emulation.SetGlobal(true);
     values.enable_audio_stretching.SetGlobal(true);
     values.enable_realtime_audio.SetGlobal(true);
+    values.async_audio_rendering.SetGlobal(true);
     values.volume.SetGlobal(true);
 
     // Core
@@ -206,6 +282,8 @@ void RestoreGlobalState(bool is_powered_on) {
     values.shaders_accurate_mul.SetGlobal(true);
     values.use_vsync.SetGlobal(true);
     values.resolution_factor.SetGlobal(true);
+    values.dynamic_resolution.SetGlobal(true);
+    values.auto_frame_skip.SetGlobal(true);
     values.frame_limit.SetGlobal(true);
     values.texture_filter.SetGlobal(true);
     values.texture_sampling.SetGlobal(true);
@@ -225,12 +303,27 @@ void RestoreGlobalState(bool is_powered_on) {
     values.swap_eyes_3d.SetGlobal(true);
     values.factor_3d.SetGlobal(true);
     values.filter_mode.SetGlobal(true);
+    values.spatial_upscaling.SetGlobal(true);
     values.pp_shader_name.SetGlobal(true);
     values.anaglyph_shader_name.SetGlobal(true);
     values.dump_textures.SetGlobal(true);
+    values.fast_texture_dumping.SetGlobal(true);
     values.custom_textures.SetGlobal(true);
     values.preload_textures.SetGlobal(true);
+    values.transcode_custom_textures.SetGlobal(true);
     values.disable_right_eye_render.SetGlobal(true);
+    values.async_texture_upload.SetGlobal(true);
+    values.gpu_texture_decode.SetGlobal(true);
+    values.accurate_mipmaps.SetGlobal(true);
+    values.texture_memory_budget.SetGlobal(true);
+    values.use_descriptor_buffer.SetGlobal(true);
+    values.parallel_command_recording.SetGlobal(true);
+    values.async_compute.SetGlobal(true);
+    values.frame_pacing.SetGlobal(true);
+    values.async_gpu.SetGlobal(true);
+    values.merge_stereo_renders.SetGlobal(true);
+
+    UpdateRuntimeSettings();
 }
 
 void LoadProfile(int index) {
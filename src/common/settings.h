@@ -462,11 +462,21 @@ struct Values {
     std::vector<InputProfile> input_profiles; ///< The list of input profiles
     std::vector<TouchFromButtonMap> touch_from_button_maps;
     Setting<bool> use_artic_base_controller{false, "use_artic_base_controller"};
+    Setting<u16> input_polling_rate{500, "input_polling_rate"};
 
     SwitchableSetting<bool> enable_gamemode{true, "enable_gamemode"};
 
     // Core
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
+    Setting<u32> jit_cache_budget{1024, "jit_cache_budget"};
+    Setting<bool> use_fastmem{true, "use_fastmem"};
+    Setting<bool> use_multicore{false, "use_multicore"};
+    Setting<bool> skip_busy_waits{false, "skip_busy_waits"};
+    Setting<bool> background_savestates{false, "background_savestates"};
+    Setting<bool> fast_resume{false, "fast_resume"};
+    Setting<s32, true> savestate_compression_level{3, 1, 22, "savestate_compression_level"};
+    Setting<u32> rewind_interval{0, "rewind_interval"};
+    Setting<u32> rewind_buffer_size{256, "rewind_buffer_size"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
     SwitchableSetting<bool> lle_applets{true, "lle_applets"};
@@ -478,6 +488,10 @@ struct Values {
     Setting<bool> use_virtual_sd{true, "use_virtual_sd"};
     Setting<bool> use_custom_storage{false, "use_custom_storage"};
     Setting<bool> compress_cia_installs{false, "compress_cia_installs"};
+    Setting<bool> cache_decrypted_romfs{false, "cache_decrypted_romfs"};
+    Setting<u32, true> z3ds_frame_cache_size{32, 0, 1024, "z3ds_frame_cache_size"};
+    Setting<u32, true> z3ds_compression_level{3, 1, 22, "z3ds_compression_level"};
+    Setting<bool> z3ds_long_distance_matching{false, "z3ds_long_distance_matching"};
 
     // System
     SwitchableSetting<s32> region_value{REGION_VALUE_AUTO_SELECT, "region_value"};
@@ -512,6 +526,7 @@ struct Values {
     SwitchableSetting<bool> disable_spirv_optimizer{true, "disable_spirv_optimizer"};
     SwitchableSetting<bool> async_shader_compilation{false, "async_shader_compilation"};
     SwitchableSetting<bool> async_presentation{true, "async_presentation"};
+    Setting<u32, true> present_queue_depth{0, 0, 3, "present_queue_depth"};
     SwitchableSetting<bool> use_hw_shader{true, "use_hw_shader"};
     SwitchableSetting<bool> use_disk_shader_cache{true, "use_disk_shader_cache"};
     SwitchableSetting<bool> shaders_accurate_mul{true, "shaders_accurate_mul"};
@@ -522,6 +537,8 @@ struct Values {
 #endif
     Setting<bool> use_shader_jit{true, "use_shader_jit"};
     SwitchableSetting<u32, true> resolution_factor{1, 0, 10, "resolution_factor"};
+    SwitchableSetting<bool> dynamic_resolution{false, "dynamic_resolution"};
+    SwitchableSetting<bool> auto_frame_skip{false, "auto_frame_skip"};
     SwitchableSetting<double, true> frame_limit{100, 0, 1000, "frame_limit"};
     SwitchableSetting<double, true> turbo_limit{200, 0, 1000, "turbo_limit"};
     SwitchableSetting<TextureFilter> texture_filter{TextureFilter::NoFilter, "texture_filter"};
@@ -586,20 +603,34 @@ struct Values {
     Setting<s32> cardboard_y_shift{0, "cardboard_y_shift"};
 
     SwitchableSetting<bool> filter_mode{true, "filter_mode"};
+    SwitchableSetting<bool> spatial_upscaling{false, "spatial_upscaling"};
     SwitchableSetting<std::string> pp_shader_name{"None (builtin)", "pp_shader_name"};
     SwitchableSetting<std::string> anaglyph_shader_name{"Dubois (builtin)", "anaglyph_shader_name"};
 
     SwitchableSetting<bool> dump_textures{false, "dump_textures"};
+    SwitchableSetting<bool> fast_texture_dumping{true, "fast_texture_dumping"};
     SwitchableSetting<bool> custom_textures{false, "custom_textures"};
     SwitchableSetting<bool> preload_textures{false, "preload_textures"};
     SwitchableSetting<bool> async_custom_loading{true, "async_custom_loading"};
+    SwitchableSetting<bool> transcode_custom_textures{false, "transcode_custom_textures"};
     SwitchableSetting<bool> disable_right_eye_render{false, "disable_right_eye_render"};
+    SwitchableSetting<bool> async_texture_upload{false, "async_texture_upload"};
+    SwitchableSetting<bool> gpu_texture_decode{false, "gpu_texture_decode"};
+    SwitchableSetting<bool> accurate_mipmaps{true, "accurate_mipmaps"};
+    SwitchableSetting<u32, true> texture_memory_budget{0, 0, 16384, "texture_memory_budget"};
+    SwitchableSetting<bool> use_descriptor_buffer{false, "use_descriptor_buffer"};
+    SwitchableSetting<bool> parallel_command_recording{false, "parallel_command_recording"};
+    SwitchableSetting<bool> async_compute{false, "async_compute"};
+    SwitchableSetting<bool> frame_pacing{false, "frame_pacing"};
+    SwitchableSetting<bool> async_gpu{false, "async_gpu"};
+    SwitchableSetting<bool> merge_stereo_renders{false, "merge_stereo_renders"};
 
     // Audio
     bool audio_muted;
     SwitchableSetting<AudioEmulation> audio_emulation{AudioEmulation::HLE, "audio_emulation"};
     SwitchableSetting<bool> enable_audio_stretching{true, "enable_audio_stretching"};
     SwitchableSetting<bool> enable_realtime_audio{false, "enable_realtime_audio"};
+    SwitchableSetting<bool> async_audio_rendering{false, "async_audio_rendering"};
     SwitchableSetting<float, true> volume{1.f, 0.f, 1.f, "volume"};
     Setting<AudioCore::SinkType> output_type{AudioCore::SinkType::Auto, "output_type"};
     Setting<std::string> output_device{"Auto", "output_device"};
@@ -639,6 +670,35 @@ struct Values {
 
 extern Values values;
 
+/**
+ * Copy of the settings read on every draw or frame. Reading them from Values resolves the global
+ * and per-game state of each setting on every access, and a change made from the frontend could
+ * be seen in the middle of a frame. The snapshot is taken when the settings are applied and the
+ * GPU picks it up between two frames.
+ */
+struct alignas(64) RuntimeSettings {
+    u64 generation{}; ///< Incremented every time a new snapshot is taken
+    u64 texture_memory_budget{};
+    TextureFilter texture_filter{};
+    TextureSampling texture_sampling{};
+    MonoRenderOption mono_render_option{};
+    bool use_hw_shader{};
+    bool filter_mode{};
+    bool swap_eyes_3d{};
+    bool custom_textures{};
+    bool async_texture_upload{};
+    bool gpu_texture_decode{};
+};
+
+/// Takes a new snapshot of the runtime settings. Called whenever the settings change.
+void UpdateRuntimeSettings();
+
+/// Returns the latest snapshot of the runtime settings.
+RuntimeSettings GetRuntimeSettings();
+
+/// Replaces snapshot with the latest one if that is newer. Returns true if it was replaced.
+bool RefreshRuntimeSettings(RuntimeSettings& snapshot);
+
 bool IsConfiguringGlobal();
 void SetConfiguringGlobal(bool is_global);
 
@@ -646,7 +706,8 @@ float Volume();
 
 void LogSettings();
 
-// Restore the global state of all applicable settings in the Values struct
+// Restore the global state of all applicable settings in the Values struct and take a new
+// snapshot of the runtime settings
 void RestoreGlobalState(bool is_powered_on);
 
 // Input profiles
@@ -85,6 +85,21 @@ public:
         return values_capacity - free_list.size();
     }
 
+    /// Invokes func with the id and a reference of every stored object
+    template <typename Func>
+    void ForEach(Func&& func) const {
+        std::size_t index = 0;
+        for (u64 bits : stored_bitset) {
+            for (std::size_t bit = 0; bits; ++bit, bits >>= 1) {
+                if ((bits & 1) != 0) {
+                    const u32 slot = static_cast<u32>(index + bit);
+                    func(SlotId{slot}, static_cast<const T&>(values[slot].object));
+                }
+            }
+            index += 64;
+        }
+    }
+
 private:
     struct NonTrivialDummy {
         NonTrivialDummy() noexcept {}
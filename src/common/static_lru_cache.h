@@ -1,55 +1,69 @@
-// Modified version of: https://www.boost.org/doc/libs/1_79_0/boost/compute/detail/lru_cache.hpp
-// Most important change is the use of an array instead of a map, so that elements are
-// statically allocated. The insert and get methods have been merged into the request method.
-// Original license:
-//
-//---------------------------------------------------------------------------//
-// Copyright (c) 2013 Kyle Lutz <kyle.r.lutz@gmail.com>
-//
-// Distributed under the Boost Software License, Version 1.0
-// See accompanying file LICENSE_1_0.txt or copy at
-// http://www.boost.org/LICENSE_1_0.txt
-//
-// See http://boostorg.github.com/compute for more information.
-//---------------------------------------------------------------------------//
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
 #pragma once
 
-#include <algorithm>
 #include <array>
-#include <list>
-#include <tuple>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <utility>
+#include "common/common_types.h"
 
 namespace Common {
 
-// a cache which evicts the least recently used item when it is full
-// the cache elements are statically allocated.
-template <class Key, class Value, std::size_t Size>
+/// Hash used by the LRU caches, supporting the pairs of offset and length used as keys.
+template <class T>
+struct LRUCacheHash {
+    std::size_t operator()(const T& value) const {
+        return std::hash<T>{}(value);
+    }
+};
+
+template <class A, class B>
+struct LRUCacheHash<std::pair<A, B>> {
+    std::size_t operator()(const std::pair<A, B>& value) const {
+        const std::size_t first = LRUCacheHash<A>{}(value.first);
+        return first ^ (LRUCacheHash<B>{}(value.second) + 0x9E3779B97F4A7C15 + (first << 6) +
+                        (first >> 2));
+    }
+};
+
+/**
+ * A cache which evicts the least recently used item when it is full. The elements and the nodes
+ * of the recency list and of the hash index are statically allocated, so lookups take constant
+ * time and nothing is allocated after construction.
+ */
+template <class Key, class Value, std::size_t Size, class Hash = LRUCacheHash<Key>>
 class StaticLRUCache {
+    static_assert(Size > 0 && Size < std::numeric_limits<u32>::max());
+
 public:
     using key_type = Key;
     using value_type = Value;
-    using list_type = std::list<std::pair<Key, std::size_t>>;
-    using array_type = std::array<Value, Size>;
 
-    StaticLRUCache() = default;
+    StaticLRUCache() {
+        clear();
+    }
 
     ~StaticLRUCache() = default;
 
     std::size_t size() const {
-        return m_list.size();
+        return count;
     }
 
     constexpr std::size_t capacity() const {
-        return m_array.size();
+        return Size;
     }
 
     bool empty() const {
-        return m_list.empty();
+        return count == 0;
     }
 
     bool contains(const key_type& key) const {
-        return find(key) != m_list.end();
+        return find(key, BucketOf(key)) != None;
     }
 
     // Requests an element from the cache. If it is not found,
@@ -57,58 +71,153 @@ public:
     // Returns whether the element was present in the cache
     // and a reference to the element itself.
     std::pair<bool, value_type&> request(const key_type& key) {
-        // lookup value in the cache
-        auto i = find(key);
-        if (i == m_list.cend()) {
-            std::size_t next_index = size();
-            // insert item into the cache, but first check if it is full
-            if (next_index >= capacity()) {
-                // cache is full, evict the least recently used item
-                next_index = evict();
+        const std::size_t bucket = BucketOf(key);
+        u32 index = find(key, bucket);
+        if (index != None) {
+            // Move the item to the front of the most recently used list
+            if (index != head) {
+                Unlink(index);
+                PushFront(index);
             }
-
-            // insert the new item
-            m_list.push_front(std::make_pair(key, next_index));
-            return std::pair<bool, value_type&>(false, m_array[next_index]);
+            return std::pair<bool, value_type&>(true, values[index]);
         }
-        // return the value, but first update its place in the most
-        // recently used list
-        if (i != m_list.cbegin()) {
-            // move item to the front of the most recently used list
-            auto backup = *i;
-            m_list.erase(i);
-            m_list.push_front(backup);
-
-            // return the value
-            return std::pair<bool, value_type&>(true, m_array[backup.second]);
+
+        if (free_head != None) {
+            index = free_head;
+            free_head = nodes[index].next;
+            count++;
         } else {
-            // the item is already at the front of the most recently
-            // used list so just return it
-            return std::pair<bool, value_type&>(true, m_array[i->second]);
+            // The cache is full, evict the least recently used item
+            index = tail;
+            Unlink(index);
+            RemoveFromBucket(index);
         }
+
+        nodes[index].key = key;
+        nodes[index].hash_next = buckets[bucket];
+        buckets[bucket] = index;
+        PushFront(index);
+        return std::pair<bool, value_type&>(false, values[index]);
+    }
+
+    // Removes an element from the cache, for example when filling it in failed.
+    // Returns whether the element was present.
+    bool erase(const key_type& key) {
+        const u32 index = find(key, BucketOf(key));
+        if (index == None) {
+            return false;
+        }
+        Unlink(index);
+        RemoveFromBucket(index);
+        nodes[index].next = free_head;
+        free_head = index;
+        count--;
+        return true;
     }
 
     void clear() {
-        m_list.clear();
+        buckets.fill(None);
+        for (u32 i = 0; i < Size; i++) {
+            nodes[i].next = i + 1 < Size ? i + 1 : None;
+        }
+        free_head = 0;
+        head = None;
+        tail = None;
+        count = 0;
     }
 
 private:
-    typename list_type::const_iterator find(const key_type& key) const {
-        return std::find_if(m_list.cbegin(), m_list.cend(),
-                            [&key](const auto& el) { return el.first == key; });
+    static constexpr u32 None = std::numeric_limits<u32>::max();
+    static constexpr std::size_t NumBuckets = std::bit_ceil(Size * 2);
+    static constexpr int BucketShift = 64 - std::countr_zero(NumBuckets);
+
+    struct Node {
+        Key key{};
+        u32 prev;
+        u32 next;
+        u32 hash_next;
+    };
+
+    static std::size_t BucketOf(const key_type& key) {
+        // Keys such as page offsets differ only in their upper bits, so mix all of them in.
+        const u64 hash = static_cast<u64>(Hash{}(key)) * 0x9E3779B97F4A7C15;
+        return NumBuckets > 1 ? static_cast<std::size_t>(hash >> BucketShift) : 0;
+    }
+
+    u32 find(const key_type& key, std::size_t bucket) const {
+        u32 index = buckets[bucket];
+        while (index != None && !(nodes[index].key == key)) {
+            index = nodes[index].hash_next;
+        }
+        return index;
+    }
+
+    void RemoveFromBucket(u32 index) {
+        u32* link = &buckets[BucketOf(nodes[index].key)];
+        while (*link != index) {
+            link = &nodes[*link].hash_next;
+        }
+        *link = nodes[index].hash_next;
+    }
+
+    void Unlink(u32 index) {
+        Node& node = nodes[index];
+        (node.prev != None ? nodes[node.prev].next : head) = node.next;
+        (node.next != None ? nodes[node.next].prev : tail) = node.prev;
+    }
+
+    void PushFront(u32 index) {
+        nodes[index].prev = None;
+        nodes[index].next = head;
+        (head != None ? nodes[head].prev : tail) = index;
+        head = index;
+    }
+
+    std::array<Value, Size> values;
+    std::array<Node, Size> nodes;
+    std::array<u32, NumBuckets> buckets;
+    u32 free_head;
+    u32 head;
+    u32 tail;
+    std::size_t count;
+};
+
+/**
+ * StaticLRUCache split into shards by key, each with a mutex of its own, so that threads using
+ * different keys do not wait for each other. Every shard evicts its own least recently used item.
+ */
+template <class Key, class Value, std::size_t Size, std::size_t NumShards,
+          class Hash = LRUCacheHash<Key>>
+class ShardedStaticLRUCache {
+    static_assert(std::has_single_bit(NumShards) && Size % NumShards == 0);
+
+public:
+    struct Shard {
+        std::mutex mutex;
+        StaticLRUCache<Key, Value, Size / NumShards, Hash> cache;
+    };
+
+    /// Returns the shard holding the key, whose mutex must be held while using its cache.
+    Shard& GetShard(const Key& key) {
+        const u64 hash = static_cast<u64>(Hash{}(key)) * 0xC2B2AE3D27D4EB4F;
+        return shards[NumShards > 1 ? hash >> (64 - std::countr_zero(NumShards)) : 0];
     }
 
-    std::size_t evict() {
-        // evict item from the end of most recently used list
-        typename list_type::iterator i = --m_list.end();
-        std::size_t evicted_index = i->second;
-        m_list.erase(i);
-        return evicted_index;
+    bool contains(const Key& key) {
+        Shard& shard = GetShard(key);
+        std::scoped_lock lock{shard.mutex};
+        return shard.cache.contains(key);
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            std::scoped_lock lock{shard.mutex};
+            shard.cache.clear();
+        }
     }
 
 private:
-    array_type m_array;
-    list_type m_list;
+    std::array<Shard, NumShards> shards;
 };
 
-} // namespace Common
\ No newline at end of file
+} // namespace Common
@@ -0,0 +1,234 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <thread>
+#include <fmt/format.h>
+#include "common/cpu_affinity.h"
+#include "common/logging/log.h"
+#include "common/task_scheduler.h"
+#include "common/thread.h"
+
+namespace Common {
+
+namespace {
+
+/// Workers on the performance cores, which the emulated CPU and the renderer also run on
+constexpr std::size_t NumPerformanceWorkers = 2;
+
+thread_local const TaskScheduler* current_scheduler = nullptr;
+thread_local std::size_t current_worker = 0;
+
+std::size_t DefaultNumWorkers() {
+    // Leave a core each to the emulated CPU and the GPU thread
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 4) - 2;
+}
+
+} // Anonymous namespace
+
+TaskScheduler::TaskScheduler(std::size_t num_workers) {
+    num_workers = std::max<std::size_t>(num_workers, 1);
+    const std::size_t num_performance =
+        HasEfficiencyCores() && num_workers > NumPerformanceWorkers ? NumPerformanceWorkers : 0;
+
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; i++) {
+        auto& worker = workers.emplace_back(std::make_unique<Worker>());
+        if (num_performance == 0) {
+            worker->core_class = CoreClass::Any;
+        } else if (i < num_performance) {
+            worker->core_class = CoreClass::Performance;
+        } else {
+            worker->core_class = CoreClass::Efficiency;
+        }
+        worker->accepts[static_cast<std::size_t>(TaskPriority::Latency)] = true;
+        worker->accepts[static_cast<std::size_t>(TaskPriority::Background)] =
+            worker->core_class != CoreClass::Performance;
+    }
+    for (std::size_t i = 0; i < num_workers; i++) {
+        workers[i]->thread =
+            std::jthread([this, i](std::stop_token stop_token) { WorkerLoop(stop_token, i); });
+    }
+    LOG_INFO(Common, "Task scheduler started with {} workers, {} on performance cores",
+             num_workers, num_performance);
+}
+
+TaskScheduler::~TaskScheduler() {
+    for (auto& worker : workers) {
+        worker->thread.request_stop();
+    }
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+    // Tasks scheduled while the workers were exiting still have to run for their futures
+    for (auto& worker : workers) {
+        for (auto& queue : worker->queues) {
+            for (auto& task : queue) {
+                task();
+            }
+        }
+    }
+}
+
+void TaskScheduler::Schedule(UniqueFunction<void> task, TaskPriority priority) {
+    const auto index = static_cast<std::size_t>(priority);
+    std::size_t target = current_worker;
+    if (current_scheduler != this || !workers[target]->accepts[index]) {
+        target = next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        while (!workers[target]->accepts[index]) {
+            target = (target + 1) % workers.size();
+        }
+    }
+
+    {
+        Worker& worker = *workers[target];
+        std::scoped_lock lock{worker.queue_mutex};
+        worker.queues[index].push_back(std::move(task));
+        num_queued[index].fetch_add(1);
+    }
+    WakeWorker(index);
+}
+
+bool TaskScheduler::IsWorkerThread() const {
+    return current_scheduler == this;
+}
+
+bool TaskScheduler::RunPendingTask() {
+    if (!IsWorkerThread()) {
+        return false;
+    }
+    auto task = PopTask(current_worker);
+    if (!task) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void TaskScheduler::WorkerLoop(std::stop_token stop_token, std::size_t index) {
+    Worker& worker = *workers[index];
+    current_scheduler = this;
+    current_worker = index;
+    Common::SetCurrentThreadName(fmt::format("citra:Worker{}", index).c_str());
+    SetCurrentThreadCoreClass(worker.core_class);
+
+    while (true) {
+        if (auto task = PopTask(index)) {
+            task();
+            continue;
+        }
+        // Queued tasks are finished before the worker exits
+        if (stop_token.stop_requested()) {
+            break;
+        }
+
+        // A task queued after PopTask either sees the flag or is counted here
+        worker.sleeping.store(true);
+        bool has_work = false;
+        for (std::size_t priority = 0; priority < NumPriorities; priority++) {
+            has_work |= worker.accepts[priority] && num_queued[priority].load() != 0;
+        }
+        if (!has_work) {
+            std::unique_lock lock{worker.sleep_mutex};
+            Common::CondvarWait(worker.sleep_condition, lock, stop_token,
+                                [&worker] { return worker.wake; });
+            worker.wake = false;
+        }
+        worker.sleeping.store(false);
+    }
+}
+
+UniqueFunction<void> TaskScheduler::PopTask(std::size_t index) {
+    const Worker& worker = *workers[index];
+    for (std::size_t priority = 0; priority < NumPriorities; priority++) {
+        if (!worker.accepts[priority] ||
+            num_queued[priority].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        // The newest task of our own is the most likely to still be in the cache
+        if (auto task = TakeTask(*workers[index], priority, true)) {
+            return task;
+        }
+        for (std::size_t i = 1; i < workers.size(); i++) {
+            if (auto task = TakeTask(*workers[(index + i) % workers.size()], priority, false)) {
+                return task;
+            }
+        }
+    }
+    return {};
+}
+
+UniqueFunction<void> TaskScheduler::TakeTask(Worker& worker, std::size_t priority, bool newest) {
+    std::scoped_lock lock{worker.queue_mutex};
+    auto& queue = worker.queues[priority];
+    if (queue.empty()) {
+        return {};
+    }
+    UniqueFunction<void> task;
+    if (newest) {
+        task = std::move(queue.back());
+        queue.pop_back();
+    } else {
+        task = std::move(queue.front());
+        queue.pop_front();
+    }
+    num_queued[priority].fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+void TaskScheduler::WakeWorker(std::size_t priority) {
+    for (auto& worker : workers) {
+        if (!worker->accepts[priority] || !worker->sleeping.load()) {
+            continue;
+        }
+        std::scoped_lock lock{worker->sleep_mutex};
+        if (!worker->wake) {
+            worker->wake = true;
+            worker->sleep_condition.notify_one();
+            return;
+        }
+    }
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler_, TaskPriority priority_)
+    : scheduler{scheduler_}, priority{priority_} {}
+
+TaskGroup::~TaskGroup() {
+    Wait();
+}
+
+void TaskGroup::Run(UniqueFunction<void> task) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    scheduler.Schedule(
+        [this, task = std::move(task)] {
+            task();
+            std::scoped_lock lock{mutex};
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                condition.notify_all();
+            }
+        },
+        priority);
+}
+
+void TaskGroup::Wait() {
+    if (scheduler.IsWorkerThread()) {
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (!scheduler.RunPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+        // The last task may still hold the lock, which has to outlive it
+        std::scoped_lock lock{mutex};
+        return;
+    }
+    std::unique_lock lock{mutex};
+    condition.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+TaskScheduler& GetTaskScheduler() {
+    static TaskScheduler scheduler{DefaultNumWorkers()};
+    return scheduler;
+}
+
+} // namespace Common
@@ -0,0 +1,143 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "common/common_types.h"
+#include "common/cpu_affinity.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+enum class TaskPriority : u8 {
+    Latency,    ///< Something is waiting on the result right away, such as the current frame
+    Background, ///< Results are needed eventually, such as cache building and prefetching
+};
+
+/**
+ * Work stealing task scheduler shared by everything that runs work in parallel, so that the
+ * emulator does not start more threads than there are cores.
+ *
+ * Every worker owns a deque per priority. Tasks scheduled by a worker go to its own deque and are
+ * run newest first, tasks scheduled by other threads are spread over the workers. Idle workers
+ * steal the oldest tasks of busy ones. Latency tasks always run before background tasks.
+ *
+ * On big.LITTLE devices some workers are pinned to the performance cores, which leave background
+ * tasks to the workers on the efficiency cores.
+ */
+class TaskScheduler {
+public:
+    explicit TaskScheduler(std::size_t num_workers);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /// Queues a task to be run by a worker
+    void Schedule(UniqueFunction<void> task, TaskPriority priority = TaskPriority::Latency);
+
+    /// Queues a task and returns a future for its result
+    template <typename Func>
+    auto Enqueue(Func&& func, TaskPriority priority = TaskPriority::Latency)
+        -> std::future<std::invoke_result_t<std::decay_t<Func>&>> {
+        using ResultType = std::invoke_result_t<std::decay_t<Func>&>;
+        std::packaged_task<ResultType()> task{std::forward<Func>(func)};
+        auto future = task.get_future();
+        Schedule([task = std::move(task)]() mutable { task(); }, priority);
+        return future;
+    }
+
+    /**
+     * Waits until the future is ready. When called from a worker, queued tasks are run in the
+     * meantime so that waiting on other tasks can not deadlock the scheduler.
+     */
+    template <typename T>
+    void WaitFor(const std::future<T>& future) {
+        using namespace std::chrono_literals;
+        if (!IsWorkerThread()) {
+            future.wait();
+            return;
+        }
+        while (future.wait_for(0s) != std::future_status::ready) {
+            if (!RunPendingTask()) {
+                future.wait_for(50us);
+            }
+        }
+    }
+
+    /// Returns true if the calling thread is one of the workers of this scheduler
+    bool IsWorkerThread() const;
+
+    /// Runs a single queued task on the calling worker, returns false if none was found
+    bool RunPendingTask();
+
+    std::size_t NumWorkers() const noexcept {
+        return workers.size();
+    }
+
+private:
+    static constexpr std::size_t NumPriorities = 2;
+
+    struct Worker {
+        CoreClass core_class;
+        std::array<bool, NumPriorities> accepts;
+        std::mutex queue_mutex;
+        std::array<std::deque<UniqueFunction<void>>, NumPriorities> queues;
+        std::mutex sleep_mutex;
+        std::condition_variable_any sleep_condition;
+        std::atomic<bool> sleeping = false;
+        bool wake = false;
+        std::jthread thread;
+    };
+
+    void WorkerLoop(std::stop_token stop_token, std::size_t index);
+    UniqueFunction<void> PopTask(std::size_t index);
+    UniqueFunction<void> TakeTask(Worker& worker, std::size_t priority, bool newest);
+    void WakeWorker(std::size_t priority);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::array<std::atomic<std::size_t>, NumPriorities> num_queued{};
+    std::atomic<std::size_t> next_worker = 0;
+};
+
+/**
+ * Set of tasks that are waited for together. The group has to outlive its tasks, it waits for
+ * them when it is destroyed.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler, TaskPriority priority = TaskPriority::Latency);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Run(UniqueFunction<void> task);
+
+    /// Waits for every task run so far, running queued tasks if called from a worker
+    void Wait();
+
+private:
+    TaskScheduler& scheduler;
+    TaskPriority priority;
+    std::atomic<std::size_t> pending = 0;
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+/// Returns the scheduler shared by the whole emulator, created on first use
+TaskScheduler& GetTaskScheduler();
+
+} // namespace Common
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
@@ -13,26 +14,27 @@
 
 namespace Common {
 
+/**
+ * Priority queues of threads, where a lower priority value is scheduled first. Non-empty levels
+ * are tracked in a bitmap so that finding the first ready thread is a single bit scan instead of
+ * a walk over the levels.
+ *
+ * A level only becomes visible to the pop and get functions once it has been prepared.
+ */
 template <class T, unsigned int N>
 struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+    static_assert(N <= 64, "Priority levels are tracked in a 64-bit mask");
 
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
-
     // Only for debugging, returns priority level.
     [[nodiscard]] Priority contains(const T& uid) const {
         for (Priority i = 0; i < NUM_QUEUES; ++i) {
             const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
+            if (std::find(cur.cbegin(), cur.cend(), uid) != cur.cend()) {
                 return i;
             }
         }
@@ -41,54 +43,29 @@ struct ThreadQueueList {
     }
 
     [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        const u64 ready = nonempty & prepared;
+        if (ready == 0) {
+            return T();
         }
-
-        return T();
+        return queues[std::countr_zero(ready)].front();
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        return pop_from(nonempty & prepared);
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        return pop_from(nonempty & prepared & (Bit(priority) - 1));
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        queues[priority].push_front(thread_id);
+        nonempty |= Bit(priority);
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        queues[priority].push_back(thread_id);
+        nonempty |= Bit(priority);
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
@@ -98,98 +75,82 @@ struct ThreadQueueList {
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+        Queue& cur = queues[priority];
+        const auto iter = std::remove(cur.begin(), cur.end(), thread_id);
+        cur.erase(iter, cur.end());
+        if (cur.empty()) {
+            nonempty &= ~Bit(priority);
+        }
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        Queue& cur = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.size() > 1) {
+            cur.push_back(std::move(cur.front()));
+            cur.pop_front();
         }
     }
 
     void clear() {
         queues.fill(Queue());
-        first = nullptr;
+        nonempty = 0;
+        prepared = 0;
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
+        return queues[priority].empty();
     }
 
     void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        prepared |= Bit(priority);
     }
 
 private:
-    struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
-    };
-
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
-    }
-
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
+    using Queue = std::deque<T>;
 
-        cur->next_nonempty = first;
-        first = cur;
+    static constexpr u64 Bit(Priority priority) {
+        return u64{1} << priority;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
-
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
-        } else {
-            return q - queues.data();
+    T pop_from(u64 ready) {
+        if (ready == 0) {
+            return T();
+        }
+        const Priority priority = static_cast<Priority>(std::countr_zero(ready));
+        Queue& cur = queues[priority];
+        auto tmp = std::move(cur.front());
+        cur.pop_front();
+        if (cur.empty()) {
+            nonempty &= ~Bit(priority);
         }
+        return tmp;
     }
 
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
-        }
+    // The priority level queues of thread ids.
+    std::array<Queue, NUM_QUEUES> queues;
+    // Levels that currently hold at least one thread.
+    u64 nonempty = 0;
+    // Levels that have been prepared for use.
+    u64 prepared = 0;
+
+    // Savestates store the levels as the linked list of prepared queues the bitmaps replaced, as
+    // indices of the next prepared level, -1 for unprepared levels and -2 for the end of the list.
+    s64 NextPrepared(u64 above) const {
+        return above == 0 ? -2 : std::countr_zero(above);
     }
 
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
+        const s64 idx = NextPrepared(prepared);
         ar << idx;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
+            const s64 idx1 = (prepared & Bit(i)) == 0
+                                 ? -1
+                                 : NextPrepared(prepared & ~((Bit(i) << 1) - 1));
             ar << idx1;
-            ar << queues[i].data;
+            ar << queues[i];
         }
     }
 
@@ -197,11 +158,17 @@ private:
     void load(Archive& ar, const unsigned int file_version) {
         s64 idx;
         ar >> idx;
-        first = ToPointer(idx);
+        nonempty = 0;
+        prepared = 0;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
             ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            if (idx != -1) {
+                prepared |= Bit(i);
+            }
+            ar >> queues[i];
+            if (!queues[i].empty()) {
+                nonempty |= Bit(i);
+            }
         }
     }
 
@@ -186,4 +186,56 @@ private:
     SPSCQueue<T, with_stop_token> spsc_queue;
     std::mutex write_lock;
 };
+
+// a lock-free multiple writer queue,
+// the single reader takes all pending elements at once
+
+template <typename T>
+class MPSCMailbox {
+public:
+    ~MPSCMailbox() {
+        Drain([](T&&) {});
+    }
+
+    [[nodiscard]] bool Empty() const {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    template <typename Arg>
+    void Push(Arg&& t) {
+        Node* node = new Node{std::forward<Arg>(t), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+
+    // passes the pending elements to func in the order they were pushed
+    template <typename Func>
+    void Drain(Func&& func) {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+        // the list links the newest element first, reverse it to restore the push order
+        Node* first = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = first;
+            first = node;
+            node = next;
+        }
+        while (first) {
+            Node* next = first->next;
+            func(std::move(first->value));
+            delete first;
+            first = next;
+        }
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr};
+};
 } // namespace Common
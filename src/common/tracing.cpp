@@ -0,0 +1,319 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/memory_accounting.h"
+#include "common/tracing.h"
+
+namespace Common::Tracing {
+
+namespace {
+
+constexpr std::size_t EventsPerThread = 1 << 16;
+constexpr std::size_t MaxCounterSamples = 1 << 16;
+constexpr std::size_t NumCounters = static_cast<std::size_t>(Counter::Count);
+
+constexpr std::array<const char*, NumCounters> CounterNames = {
+    "SVCs",
+    "IPC commands",
+    "Draws",
+    "Pipeline compiles",
+    "Texture uploads",
+    "Image allocations",
+    "Image reuses",
+    "Render passes",
+    "Attachment load/store bytes",
+    "Z3DS frame cache hits",
+    "Z3DS frame cache misses",
+    "Z3DS decompress ns",
+    "Mip levels generated instead of decoded",
+    "Recorded Vulkan commands",
+    "Recorded Vulkan lambda commands",
+    "Recorded Vulkan command bytes",
+    "Pooled image bytes",
+};
+
+struct Event {
+    const char* category;
+    const char* name;
+    u64 begin_ns;
+    u64 duration_ns;
+};
+
+struct ThreadBuffer {
+    u32 tid;
+    std::string name;
+    bool owned = true;
+    // Events written during an older recording are discarded lazily by the owning thread
+    u32 generation = 0;
+    std::atomic<u64> write_index = 0;
+    std::array<Event, EventsPerThread> events;
+};
+
+struct CounterSample {
+    u64 time_ns;
+    std::array<u64, NumCounters> values;
+    std::array<u64, MemoryAccounting::NumCategories> host_memory;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<CounterSample> counter_samples;
+    std::size_t next_counter_sample = 0;
+    std::atomic<u32> generation = 0;
+    u64 start_ns = 0;
+    u32 next_tid = 1;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+/// Releases the thread's buffer for reuse by a later thread once the thread exits
+struct ThreadBufferHolder {
+    ThreadBuffer* buffer = nullptr;
+    std::string name;
+
+    ~ThreadBufferHolder() {
+        if (buffer) {
+            std::scoped_lock lock{GetRegistry().mutex};
+            buffer->owned = false;
+        }
+    }
+};
+
+thread_local ThreadBufferHolder thread_buffer;
+
+ThreadBuffer& GetThreadBuffer() {
+    if (thread_buffer.buffer) [[likely]] {
+        return *thread_buffer.buffer;
+    }
+
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    ThreadBuffer* buffer = nullptr;
+    for (const auto& candidate : registry.buffers) {
+        if (!candidate->owned) {
+            buffer = candidate.get();
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = registry.buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+    }
+    buffer->tid = registry.next_tid++;
+    buffer->name = thread_buffer.name.empty() ? fmt::format("Thread {}", buffer->tid)
+                                              : thread_buffer.name;
+    buffer->owned = true;
+    buffer->generation = registry.generation.load(std::memory_order_relaxed);
+    buffer->write_index.store(0, std::memory_order_relaxed);
+    thread_buffer.buffer = buffer;
+    return *buffer;
+}
+
+/// Returns the buffer of the host GPU track, which is never released
+ThreadBuffer& GetGpuBuffer() {
+    static ThreadBuffer* const gpu_buffer = [] {
+        Registry& registry = GetRegistry();
+        std::scoped_lock lock{registry.mutex};
+        ThreadBuffer* buffer =
+            registry.buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+        buffer->tid = registry.next_tid++;
+        buffer->name = "Host GPU";
+        buffer->generation = registry.generation.load(std::memory_order_relaxed);
+        return buffer;
+    }();
+    return *gpu_buffer;
+}
+
+void WriteEvent(ThreadBuffer& buffer, const Scope& scope, u64 begin_ns, u64 end_ns) {
+    const u32 generation = GetRegistry().generation.load(std::memory_order_relaxed);
+    if (buffer.generation != generation) {
+        buffer.generation = generation;
+        buffer.write_index.store(0, std::memory_order_relaxed);
+    }
+
+    const u64 index = buffer.write_index.load(std::memory_order_relaxed);
+    buffer.events[index % EventsPerThread] = {scope.category, scope.name, begin_ns,
+                                              end_ns - begin_ns};
+    buffer.write_index.store(index + 1, std::memory_order_release);
+}
+
+std::string EscapeJson(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+} // Anonymous namespace
+
+namespace Detail {
+
+std::atomic<bool> enabled = false;
+std::array<std::atomic<u64>, NumCounters> counters{};
+
+u64 Now() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+}
+
+void RecordScope(const Scope& scope, u64 begin_ns, u64 end_ns) {
+    WriteEvent(GetThreadBuffer(), scope, begin_ns, end_ns);
+}
+
+} // namespace Detail
+
+void SetEnabled(bool enabled) {
+    if (enabled == IsEnabled()) {
+        return;
+    }
+
+    if (enabled) {
+        Registry& registry = GetRegistry();
+        std::scoped_lock lock{registry.mutex};
+        registry.generation.fetch_add(1, std::memory_order_relaxed);
+        registry.counter_samples.clear();
+        registry.next_counter_sample = 0;
+        registry.start_ns = Detail::Now();
+        for (std::size_t i = 0; i < NumCounters; i++) {
+            if (!IsLevelCounter(static_cast<Counter>(i))) {
+                Detail::counters[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    Detail::enabled.store(enabled, std::memory_order_relaxed);
+    LOG_INFO(Common, "Tracing {}", enabled ? "started" : "stopped");
+}
+
+void SetThreadName(std::string_view name) {
+    thread_buffer.name = name;
+    if (thread_buffer.buffer) {
+        std::scoped_lock lock{GetRegistry().mutex};
+        thread_buffer.buffer->name = name;
+    }
+}
+
+void RecordGpuEvent(const Scope& scope, u64 begin_ns, u64 end_ns) {
+    if (!IsEnabled()) {
+        return;
+    }
+    WriteEvent(GetGpuBuffer(), scope, begin_ns, end_ns);
+}
+
+void SampleCounters() {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    CounterSample sample{Detail::Now(), {}, MemoryAccounting::GetUsage().current};
+    for (std::size_t i = 0; i < NumCounters; i++) {
+        sample.values[i] = IsLevelCounter(static_cast<Counter>(i))
+                               ? Detail::counters[i].load(std::memory_order_relaxed)
+                               : Detail::counters[i].exchange(0, std::memory_order_relaxed);
+    }
+
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+    if (registry.counter_samples.size() < MaxCounterSamples) {
+        registry.counter_samples.push_back(sample);
+    } else {
+        registry.counter_samples[registry.next_counter_sample] = sample;
+        registry.next_counter_sample = (registry.next_counter_sample + 1) % MaxCounterSamples;
+    }
+}
+
+bool ExportChromeTrace(const std::string& path) {
+    Registry& registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex};
+
+    const u32 generation = registry.generation.load(std::memory_order_relaxed);
+    const auto to_us = [&registry](u64 time_ns) {
+        return static_cast<double>(time_ns - std::min(time_ns, registry.start_ns)) / 1000.0;
+    };
+
+    std::string out;
+    auto it = std::back_inserter(out);
+    fmt::format_to(it, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    const auto separator = [&first] {
+        const char* sep = first ? "\n" : ",\n";
+        first = false;
+        return sep;
+    };
+
+    for (const auto& buffer : registry.buffers) {
+        if (buffer->generation != generation) {
+            continue;
+        }
+        fmt::format_to(it,
+                       "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+                       "\"args\":{{\"name\":\"{}\"}}}}",
+                       separator(), buffer->tid, EscapeJson(buffer->name));
+
+        const u64 end = buffer->write_index.load(std::memory_order_acquire);
+        const u64 count = std::min<u64>(end, EventsPerThread);
+        for (u64 i = end - count; i < end; i++) {
+            const Event& event = buffer->events[i % EventsPerThread];
+            fmt::format_to(it,
+                           "{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+                           "\"dur\":{:.3f},\"pid\":1,\"tid\":{}}}",
+                           separator(), event.name, event.category, to_us(event.begin_ns),
+                           static_cast<double>(event.duration_ns) / 1000.0, buffer->tid);
+        }
+    }
+
+    const std::size_t num_samples = registry.counter_samples.size();
+    for (std::size_t i = 0; i < num_samples; i++) {
+        const CounterSample& sample =
+            registry.counter_samples[(registry.next_counter_sample + i) % num_samples];
+        for (std::size_t counter = 0; counter < NumCounters; counter++) {
+            fmt::format_to(it,
+                           "{}{{\"name\":\"{}\",\"ph\":\"C\",\"ts\":{:.3f},\"pid\":1,"
+                           "\"args\":{{\"{}\":{}}}}}",
+                           separator(), CounterNames[counter], to_us(sample.time_ns),
+                           IsLevelCounter(static_cast<Counter>(counter)) ? "value" : "per frame",
+                           sample.values[counter]);
+        }
+
+        // The subsystems are the series of a single counter, which the viewers stack
+        fmt::format_to(it,
+                       "{}{{\"name\":\"Host memory bytes\",\"ph\":\"C\",\"ts\":{:.3f},\"pid\":1,"
+                       "\"args\":{{",
+                       separator(), to_us(sample.time_ns));
+        for (std::size_t category = 0; category < MemoryAccounting::NumCategories; category++) {
+            fmt::format_to(it, "{}\"{}\":{}", category == 0 ? "" : ",",
+                           MemoryAccounting::CategoryNames[category], sample.host_memory[category]);
+        }
+        fmt::format_to(it, "}}}}");
+    }
+    fmt::format_to(it, "\n]}}\n");
+
+    if (FileUtil::WriteStringToFile(false, path, out) != out.size()) {
+        LOG_ERROR(Common, "Failed to write trace to {}", path);
+        return false;
+    }
+    LOG_INFO(Common, "Wrote trace to {}", path);
+    return true;
+}
+
+} // namespace Common::Tracing
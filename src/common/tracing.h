@@ -0,0 +1,118 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include "common/common_types.h"
+
+/**
+ * Low overhead event tracing that can be toggled at runtime and exported as a Chrome JSON trace,
+ * which both chrome://tracing and the Perfetto UI can open.
+ *
+ * Every MICROPROFILE_SCOPE site also records a trace event (see common/microprofile.h). Events
+ * are written to a ring buffer owned by the recording thread, so recording never takes a lock.
+ * When tracing is disabled a scope costs a single relaxed load.
+ */
+namespace Common::Tracing {
+
+/// Static description of a traced scope
+struct Scope {
+    const char* category;
+    const char* name;
+};
+
+/// Counters that are sampled once per emulated frame
+enum class Counter : u32 {
+    SVC,
+    IPCCommand,
+    Draw,
+    PipelineCompile,
+    TextureUpload,
+    ImageAllocation,
+    ImageReuse,
+    RenderPass,
+    AttachmentTraffic,
+    Z3DSFrameCacheHit,
+    Z3DSFrameCacheMiss,
+    Z3DSDecompressTime,
+    GeneratedMipmap,
+    RecordedCommand,
+    RecordedLambda,
+    RecordedCommandBytes,
+    // Levels, which keep their value across samples
+    PooledImageMemory,
+    Count,
+};
+
+/// Returns true if the counter holds a level set with SetCounter rather than counting events
+[[nodiscard]] constexpr bool IsLevelCounter(Counter counter) {
+    return counter >= Counter::PooledImageMemory;
+}
+
+namespace Detail {
+extern std::atomic<bool> enabled;
+extern std::array<std::atomic<u64>, static_cast<std::size_t>(Counter::Count)> counters;
+
+u64 Now();
+void RecordScope(const Scope& scope, u64 begin_ns, u64 end_ns);
+} // namespace Detail
+
+[[nodiscard]] inline bool IsEnabled() {
+    return Detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Starts or stops recording. Starting discards the events of any previous recording.
+void SetEnabled(bool enabled);
+
+/// Names the calling thread in exported traces
+void SetThreadName(std::string_view name);
+
+inline void IncrementCounter(Counter counter, u64 value = 1) {
+    if (IsEnabled()) {
+        Detail::counters[static_cast<std::size_t>(counter)].fetch_add(value,
+                                                                      std::memory_order_relaxed);
+    }
+}
+
+/// Sets the value of a level counter. Levels are tracked even while tracing is disabled.
+inline void SetCounter(Counter counter, u64 value) {
+    Detail::counters[static_cast<std::size_t>(counter)].store(value, std::memory_order_relaxed);
+}
+
+/**
+ * Records an event of the host GPU on a track of its own. Times are steady_clock nanoseconds, the
+ * renderer maps its GPU timestamps to them. Must only be called by the renderer thread.
+ */
+void RecordGpuEvent(const Scope& scope, u64 begin_ns, u64 end_ns);
+
+/// Records the counter values accumulated since the previous call. Called at the end of a frame.
+void SampleCounters();
+
+/// Writes the recorded events to path in the Chrome JSON trace format
+bool ExportChromeTrace(const std::string& path);
+
+class ScopedEvent {
+public:
+    explicit ScopedEvent(const Scope& scope_)
+        : scope{scope_}, begin_ns{IsEnabled() ? Detail::Now() : 0} {}
+
+    ~ScopedEvent() {
+        if (begin_ns != 0 && IsEnabled()) {
+            Detail::RecordScope(scope, begin_ns, Detail::Now());
+        }
+    }
+
+    ScopedEvent(const ScopedEvent&) = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+    const Scope& scope;
+    u64 begin_ns;
+};
+
+} // namespace Common::Tracing
@@ -0,0 +1,49 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Lock-free exchange of the latest value from a single writer to a single reader. The writer fills
+ * its back buffer and publishes it by swapping it with the middle buffer, the reader swaps its
+ * front buffer with the middle one when a newer value was published. Neither side ever waits.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    /// Returns the buffer the next value is written to. Only called by the writer.
+    [[nodiscard]] T& WriteBuffer() noexcept {
+        return buffers[back];
+    }
+
+    /// Publishes the value written to the write buffer. Only called by the writer.
+    void Publish() noexcept {
+        back = middle.exchange(back | NewFlag, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    /// Returns the latest published value. Only called by the reader.
+    [[nodiscard]] const T& Read() noexcept {
+        if (middle.load(std::memory_order_relaxed) & NewFlag) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & IndexMask;
+        }
+        return buffers[front];
+    }
+
+private:
+    static constexpr u32 IndexMask = 0x3;
+    static constexpr u32 NewFlag = 0x4;
+
+    std::array<T, 3> buffers{};
+    std::atomic<u32> middle{1};
+    u32 back = 0;
+    u32 front = 2;
+};
+
+} // namespace Common
@@ -8,10 +8,18 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <ctime>
+#include <deque>
 #include <format>
+#include <future>
+#include <list>
 #include <mutex>
+#include <optional>
 #include <sstream>
+#include <thread>
+#include <typeinfo>
+#include <unordered_map>
 #include <zstd.h>
 #include <zstd_seekable.h>
 
@@ -23,6 +31,9 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/settings.h"
+#include "common/thread_worker.h"
+#include "common/tracing.h"
 #include "common/zstd_compression.h"
 
 namespace Common::Compression {
@@ -119,6 +130,137 @@ std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed) {
     return decompressed;
 }
 
+ZSTDOutputStreamBuf::ZSTDOutputStreamBuf(FileUtil::IOFile& file_)
+    : ZSTDOutputStreamBuf(file_, ZSTD_CLEVEL_DEFAULT) {}
+
+ZSTDOutputStreamBuf::ZSTDOutputStreamBuf(FileUtil::IOFile& file_, s32 compression_level,
+                                         u32 num_workers, std::span<const u8> dictionary)
+    : file{file_}, context{ZSTD_createCCtx()}, in_buffer(ZSTD_CStreamInSize()),
+      out_buffer(ZSTD_CStreamOutSize()) {
+    compression_level = std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, compression_level);
+    if (num_workers != 0) {
+        // Fails harmlessly when the library was built without multithreading support.
+        const std::size_t result = ZSTD_CCtx_setParameter(context, ZSTD_c_nbWorkers,
+                                                          static_cast<int>(num_workers));
+        if (ZSTD_isError(result)) {
+            LOG_WARNING(Common, "Could not enable multithreaded ZSTD compression: {}",
+                        ZSTD_getErrorName(result));
+        }
+    }
+    if (!dictionary.empty()) {
+        const std::size_t result =
+            ZSTD_CCtx_loadDictionary(context, dictionary.data(), dictionary.size());
+        if (ZSTD_isError(result)) {
+            LOG_ERROR(Common, "Could not load ZSTD dictionary: {}", ZSTD_getErrorName(result));
+            good = false;
+        }
+    }
+    setp(in_buffer.data(), in_buffer.data() + in_buffer.size());
+}
+
+ZSTDOutputStreamBuf::~ZSTDOutputStreamBuf() {
+    ZSTD_freeCCtx(context);
+}
+
+bool ZSTDOutputStreamBuf::Finish() {
+    return good && Compress(true);
+}
+
+ZSTDOutputStreamBuf::int_type ZSTDOutputStreamBuf::overflow(int_type ch) {
+    if (!good || !Compress(false)) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int ZSTDOutputStreamBuf::sync() {
+    // Only hand the pending input to the compressor, flushing a block here would hurt the ratio.
+    return good && Compress(false) ? 0 : -1;
+}
+
+bool ZSTDOutputStreamBuf::Compress(bool end_frame) {
+    ZSTD_inBuffer input{pbase(), static_cast<std::size_t>(pptr() - pbase()), 0};
+    const ZSTD_EndDirective mode = end_frame ? ZSTD_e_end : ZSTD_e_continue;
+    bool done = false;
+    while (!done) {
+        ZSTD_outBuffer output{out_buffer.data(), out_buffer.size(), 0};
+        const std::size_t remaining = ZSTD_compressStream2(context, &output, &input, mode);
+        if (ZSTD_isError(remaining)) {
+            LOG_ERROR(Common, "Error compressing ZSTD stream: {} ({})",
+                      ZSTD_getErrorName(remaining), remaining);
+            good = false;
+            return false;
+        }
+        if (output.pos != 0 && file.WriteBytes(out_buffer.data(), output.pos) != output.pos) {
+            LOG_ERROR(Common, "Could not write ZSTD stream to {}", file.Filename());
+            good = false;
+            return false;
+        }
+        done = end_frame ? remaining == 0 : input.pos == input.size;
+    }
+    setp(in_buffer.data(), in_buffer.data() + in_buffer.size());
+    return true;
+}
+
+ZSTDInputStreamBuf::ZSTDInputStreamBuf(FileUtil::IOFile& file_,
+                                       std::span<const u8> dictionary_)
+    : file{file_}, context{ZSTD_createDCtx()}, in_buffer(ZSTD_DStreamInSize()),
+      out_buffer(ZSTD_DStreamOutSize()), dictionary{dictionary_} {}
+
+ZSTDInputStreamBuf::~ZSTDInputStreamBuf() {
+    ZSTD_freeDCtx(context);
+}
+
+ZSTDInputStreamBuf::int_type ZSTDInputStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    while (true) {
+        // A full output buffer means the decompressor may still hold data for the consumed input.
+        if (in_pos == in_size && !output_pending) {
+            in_size = file.ReadBytes(in_buffer.data(), in_buffer.size());
+            in_pos = 0;
+            if (in_size == 0) {
+                return traits_type::eof();
+            }
+        }
+        if (!frame_started) {
+            frame_started = true;
+            // Only load the dictionary for frames that reference it, older files were written
+            // without one.
+            const unsigned dict_id = ZSTD_getDictID_fromFrame(in_buffer.data(), in_size);
+            if (dict_id != 0) {
+                if (dictionary.empty() ||
+                    ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size()) != dict_id) {
+                    LOG_ERROR(Common, "ZSTD stream needs dictionary {} which is not available",
+                              dict_id);
+                    return traits_type::eof();
+                }
+                ZSTD_DCtx_loadDictionary(context, dictionary.data(), dictionary.size());
+            }
+        }
+        ZSTD_inBuffer input{in_buffer.data(), in_size, in_pos};
+        ZSTD_outBuffer output{out_buffer.data(), out_buffer.size(), 0};
+        const std::size_t result = ZSTD_decompressStream(context, &output, &input);
+        if (ZSTD_isError(result)) {
+            LOG_ERROR(Common, "Error decompressing ZSTD stream: {} ({})",
+                      ZSTD_getErrorName(result), result);
+            return traits_type::eof();
+        }
+        in_pos = input.pos;
+        output_pending = output.pos == output.size;
+        if (output.pos != 0) {
+            setg(out_buffer.data(), out_buffer.data(), out_buffer.data() + output.pos);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+}
+
 } // namespace Common::Compression
 
 namespace FileUtil {
@@ -193,21 +335,34 @@ std::vector<u8> Z3DSMetadata::AsBinary() {
 }
 
 struct Z3DSWriteIOFile::Z3DSWriteIOFileImpl {
+    using CompressContext = std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>;
+
+    struct CompressedFrame {
+        std::vector<u8> data;
+        size_t uncompressed_size;
+        bool good;
+    };
+
     Z3DSWriteIOFileImpl() {}
-    Z3DSWriteIOFileImpl(size_t frame_size) {
+    Z3DSWriteIOFileImpl(size_t frame_size, const Z3DSCompressionOptions& options_ = {})
+        : options{options_} {
         zstd_frame_size = frame_size;
-        cstream = ZSTD_seekable_createCStream();
-        size_t init_result = ZSTD_seekable_initCStream(cstream, ZSTD_CLEVEL_DEFAULT, 0,
-                                                       static_cast<unsigned int>(frame_size));
-        if (ZSTD_isError(init_result)) {
-            LOG_ERROR(Common_Filesystem, "ZSTD_seekable_initCStream() error : {}",
-                      ZSTD_getErrorName(init_result));
-        }
+        effective_frame_size = frame_size ? frame_size : ZSTD_SEEKABLE_MAX_FRAME_DECOMPRESSED_SIZE;
+        frame_log = ZSTD_seekable_createFrameLog(0);
+
+        // Frames are compressed independently of each other, so they are compressed in parallel
+        // while the memory held by the frames in flight stays bounded.
+        const size_t num_workers = std::max(std::thread::hardware_concurrency(), 1U);
+        max_frames_in_flight = std::clamp<size_t>(MaxBytesInFlight / effective_frame_size, 2,
+                                                  num_workers * 2);
+        workers = std::make_unique<Common::StatefulThreadWorker<CompressContext>>(
+            num_workers, "Z3DSCompress",
+            [](size_t) { return CompressContext{ZSTD_createCCtx(), ZSTD_freeCCtx}; });
 
         write_header.magic = Z3DSFileHeader::EXPECTED_MAGIC;
         write_header.version = Z3DSFileHeader::EXPECTED_VERSION;
         write_header.header_size = sizeof(Z3DSFileHeader);
-        next_input_size_hint = ZSTD_CStreamInSize();
+        next_input_size_hint = std::min(effective_frame_size, ZSTD_CStreamInSize());
     }
 
     bool WriteHeader(IOFile* file) {
@@ -225,39 +380,104 @@ struct Z3DSWriteIOFile::Z3DSWriteIOFileImpl {
     }
 
     size_t Write(IOFile* file, const void* data, std::size_t length) {
-        size_t ret = length;
+        const u8* in = static_cast<const u8*>(data);
+        size_t remaining = length;
+        while (remaining > 0) {
+            const size_t copy_size = std::min(remaining, effective_frame_size - pending.size());
+            pending.insert(pending.end(), in, in + copy_size);
+            in += copy_size;
+            remaining -= copy_size;
+            if (pending.size() == effective_frame_size) {
+                SubmitFrame();
+                // Write the frames that are done, waiting for the oldest one when too many are
+                // in flight.
+                if (!WriteFrames(file, max_frames_in_flight - 1)) {
+                    return 0;
+                }
+            }
+        }
+        next_input_size_hint =
+            std::min(effective_frame_size - pending.size(), ZSTD_CStreamInSize());
+        return length;
+    }
 
-        const size_t out_size = ZSTD_CStreamOutSize();
-        const size_t in_size = ZSTD_CStreamInSize();
+    /// Queues the pending data to be compressed as a frame
+    void SubmitFrame() {
+        auto promise = std::make_shared<std::promise<CompressedFrame>>();
+        frames_in_flight.push_back(promise->get_future());
+        workers->QueueWork([this, input = std::move(pending), promise](CompressContext* cctx) {
+            promise->set_value(CompressFrame(cctx->get(), input));
+        });
+        pending = {};
+        pending.reserve(effective_frame_size);
+    }
 
-        if (write_buffer.size() < out_size) {
-            write_buffer.resize(out_size);
+    CompressedFrame CompressFrame(ZSTD_CCtx* cctx, std::span<const u8> input) const {
+        CompressedFrame frame{
+            .data = std::vector<u8>(ZSTD_compressBound(input.size())),
+            .uncompressed_size = input.size(),
+            .good = false,
+        };
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, options.level);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching,
+                               options.long_distance_matching ? 1 : 0);
+        const size_t result = ZSTD_compress2(cctx, frame.data.data(), frame.data.size(),
+                                             input.data(), input.size());
+        if (ZSTD_isError(result)) {
+            LOG_ERROR(Common_Filesystem, "ZSTD_compress2() error : {}", ZSTD_getErrorName(result));
+            return frame;
         }
+        frame.data.resize(result);
+        frame.good = true;
+        return frame;
+    }
 
-        ZSTD_inBuffer input = {data, length, 0};
-        while (input.pos < input.size) {
-            ZSTD_outBuffer output = {write_buffer.data(), write_buffer.size(), 0};
-            next_input_size_hint = ZSTD_seekable_compressStream(cstream, &output, &input);
-            if (ZSTD_isError(next_input_size_hint)) {
-                LOG_ERROR(Common_Filesystem, "ZSTD_seekable_compressStream() error : {}",
-                          ZSTD_getErrorName(next_input_size_hint));
-                ret = 0;
-                next_input_size_hint = ZSTD_CStreamInSize();
+    /// Writes the compressed frames in order until at most max_in_flight remain in flight.
+    /// Frames which are already compressed are written as well.
+    bool WriteFrames(IOFile* file, size_t max_in_flight) {
+        while (!frames_in_flight.empty()) {
+            auto& oldest = frames_in_flight.front();
+            if (frames_in_flight.size() <= max_in_flight &&
+                oldest.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
                 break;
             }
-            if (next_input_size_hint > in_size) {
-                next_input_size_hint = in_size;
+            const CompressedFrame frame = oldest.get();
+            frames_in_flight.pop_front();
+
+            if (!frame.good || file->WriteBytes(frame.data.data(), frame.data.size()) !=
+                                   frame.data.size()) {
+                return false;
             }
-            if (file->WriteBytes(static_cast<u8*>(output.dst), output.pos) != output.pos) {
-                ret = 0;
-                break;
+            const size_t log_result =
+                ZSTD_seekable_logFrame(frame_log, static_cast<unsigned>(frame.data.size()),
+                                       static_cast<unsigned>(frame.uncompressed_size), 0);
+            if (ZSTD_isError(log_result)) {
+                LOG_ERROR(Common_Filesystem, "ZSTD_seekable_logFrame() error : {}",
+                          ZSTD_getErrorName(log_result));
+                return false;
             }
-            written_compressed += output.pos;
+            written_compressed += frame.data.size();
         }
-        return ret;
+        return true;
     }
 
     bool Close(IOFile* file, size_t written_uncompressed) {
+        if (closed || !frame_log) {
+            return !closed;
+        }
+        closed = true;
+
+        if (!pending.empty()) {
+            SubmitFrame();
+        }
+        const bool frames_written = WriteFrames(file, 0);
+        workers.reset();
+        if (!frames_written) {
+            ZSTD_seekable_freeFrameLog(frame_log);
+            return false;
+        }
+
         const size_t out_size = ZSTD_CStreamOutSize();
 
         if (write_buffer.size() < out_size) {
@@ -267,14 +487,16 @@ struct Z3DSWriteIOFile::Z3DSWriteIOFileImpl {
         size_t remaining;
         do {
             ZSTD_outBuffer output = {write_buffer.data(), write_buffer.size(), 0};
-            remaining = ZSTD_seekable_endStream(cstream, &output); /* close stream */
+            remaining = ZSTD_seekable_writeSeekTable(frame_log, &output);
             if (ZSTD_isError(remaining)) {
-                LOG_ERROR(Common_Filesystem, "ZSTD_seekable_endStream() error : {}",
+                LOG_ERROR(Common_Filesystem, "ZSTD_seekable_writeSeekTable() error : {}",
                           ZSTD_getErrorName(remaining));
+                ZSTD_seekable_freeFrameLog(frame_log);
                 return false;
             }
 
             if (file->WriteBytes(static_cast<u8*>(output.dst), output.pos) != output.pos) {
+                ZSTD_seekable_freeFrameLog(frame_log);
                 return false;
             }
             written_compressed += output.pos;
@@ -283,17 +505,27 @@ struct Z3DSWriteIOFile::Z3DSWriteIOFileImpl {
         write_header.compressed_size = written_compressed;
         write_header.uncompressed_size = written_uncompressed;
 
-        ZSTD_seekable_freeCStream(cstream);
+        ZSTD_seekable_freeFrameLog(frame_log);
 
         return WriteHeader(file);
     }
 
+    /// Upper bound of the memory held by the uncompressed frames being compressed
+    static constexpr size_t MaxBytesInFlight = 512 * 1024 * 1024;
+
     std::vector<u8> write_buffer;
     size_t next_input_size_hint = 0;
     size_t zstd_frame_size = 0;
+    size_t effective_frame_size = 0;
     u64 written_compressed = 0;
-
-    ZSTD_seekable_CStream* cstream{};
+    bool closed = false;
+
+    Z3DSCompressionOptions options;
+    std::vector<u8> pending;
+    std::deque<std::future<CompressedFrame>> frames_in_flight;
+    size_t max_frames_in_flight = 0;
+    std::unique_ptr<Common::StatefulThreadWorker<CompressContext>> workers;
+    ZSTD_frameLog* frame_log{};
     Z3DSFileHeader write_header{};
 };
 
@@ -301,9 +533,10 @@ Z3DSWriteIOFile::Z3DSWriteIOFile()
     : IOFile(), file{std::make_unique<IOFile>()}, impl{std::make_unique<Z3DSWriteIOFileImpl>()} {}
 
 Z3DSWriteIOFile::Z3DSWriteIOFile(std::unique_ptr<IOFile>&& underlying_file,
-                                 const std::array<u8, 4>& underlying_magic, size_t frame_size)
+                                 const std::array<u8, 4>& underlying_magic, size_t frame_size,
+                                 const Z3DSCompressionOptions& options)
     : IOFile(), file{std::move(underlying_file)},
-      impl{std::make_unique<Z3DSWriteIOFileImpl>(frame_size)} {
+      impl{std::make_unique<Z3DSWriteIOFileImpl>(frame_size, options)} {
     ASSERT_MSG(!file->IsCompressed(), "Underlying file is already compressed!");
     impl->write_header.underlying_magic = underlying_magic;
     impl->WriteHeader(file.get());
@@ -459,6 +692,8 @@ struct Z3DSReadIOFile::Z3DSReadIOFileImpl {
     Z3DSReadIOFileImpl() {}
     Z3DSReadIOFileImpl(IOFile* file, bool load_metadata = true) {
         curr_file = file;
+        // Wrappers such as CryptoIOFile keep the state of their reads in the file
+        concurrent_file_reads = typeid(*file) == typeid(IOFile);
         m_good = file->ReadAtBytes(&header, sizeof(header), 0) == sizeof(header);
         m_good &= header.magic == Z3DSFileHeader::EXPECTED_MAGIC &&
                   header.version == Z3DSFileHeader::EXPECTED_VERSION;
@@ -489,6 +724,18 @@ struct Z3DSReadIOFile::Z3DSReadIOFileImpl {
             LOG_ERROR(Common_Filesystem, "ZSTD_seekable_initCStream() error : {}",
                       ZSTD_getErrorName(init_result));
             m_good = false;
+            return;
+        }
+
+        // Frames are only cached when the cache fits a few of them, which excludes the large
+        // frames of compressed CIAs.
+        const u64 cache_size = u64{Settings::values.z3ds_frame_cache_size.GetValue()} << 20;
+        const u64 frame_size = ZSTD_seekable_getFrameDecompressedSize(seekable, 0);
+        if (ZSTD_seekable_getNumFrames(seekable) > 1 && frame_size != 0) {
+            max_cached_frames = static_cast<std::size_t>(cache_size / frame_size);
+        }
+        if (max_cached_frames < MinCachedFrames) {
+            max_cached_frames = 0;
         }
     }
 
@@ -511,6 +758,11 @@ struct Z3DSReadIOFile::Z3DSReadIOFileImpl {
     size_t Read(void* data, std::size_t length) {
         if (!m_good)
             return 0;
+        if (max_cached_frames != 0) {
+            const size_t result = ReadFrames(data, length, uncompressed_pos);
+            uncompressed_pos += result;
+            return result;
+        }
         size_t result = ZSTD_seekable_decompress(seekable, data, length, uncompressed_pos);
         if (ZSTD_isError(result)) {
             LOG_ERROR(Common_Filesystem, "ZSTD_seekable_decompress() error : {}",
@@ -524,6 +776,9 @@ struct Z3DSReadIOFile::Z3DSReadIOFileImpl {
     size_t ReadAt(void* data, std::size_t length, size_t pos) {
         if (!m_good)
             return 0;
+        if (max_cached_frames != 0) {
+            return ReadFrames(data, length, pos);
+        }
         // ReadAt should be thread safe, but seekable compression is not,
         // so we are forced to use a lock.
         std::scoped_lock lock(read_mutex);
@@ -559,17 +814,175 @@ struct Z3DSReadIOFile::Z3DSReadIOFileImpl {
         return true;
     }
 
+    using FramePtr = std::shared_ptr<const std::vector<u8>>;
+
+    /// Copies the data at pos from the decompressed frames holding it
+    size_t ReadFrames(void* data, std::size_t length, u64 pos) {
+        u8* out = static_cast<u8*>(data);
+        size_t read = 0;
+        while (read < length && pos < header.uncompressed_size) {
+            const u32 index = ZSTD_seekable_offsetToFrameIndex(seekable, pos);
+            const FramePtr frame = GetFrame(index);
+            const u64 frame_offset = ZSTD_seekable_getFrameDecompressedOffset(seekable, index);
+            if (!frame || pos - frame_offset >= frame->size()) {
+                break;
+            }
+            const size_t offset = static_cast<size_t>(pos - frame_offset);
+            const size_t copy_size = std::min(length - read, frame->size() - offset);
+            std::memcpy(out + read, frame->data() + offset, copy_size);
+            read += copy_size;
+            pos += copy_size;
+        }
+        return read;
+    }
+
+    /**
+     * Returns a decompressed frame from the cache, decompressing it on the calling thread if it
+     * is not there. When the frames are read in order the following ones are decompressed ahead
+     * on worker threads.
+     */
+    FramePtr GetFrame(u32 index) {
+        std::optional<std::promise<FramePtr>> promise;
+        std::shared_future<FramePtr> frame;
+        {
+            std::scoped_lock lock{cache_mutex};
+            if (auto it = cached_frames.find(index); it != cached_frames.end()) {
+                frame_lru.splice(frame_lru.begin(), frame_lru, it->second.lru_it);
+                frame = it->second.frame;
+                Common::Tracing::IncrementCounter(Common::Tracing::Counter::Z3DSFrameCacheHit);
+            } else {
+                promise.emplace();
+                frame = InsertFrame(index, promise->get_future().share());
+                Common::Tracing::IncrementCounter(Common::Tracing::Counter::Z3DSFrameCacheMiss);
+            }
+
+            if (last_frame_index && index == *last_frame_index + 1) {
+                QueueReadAhead(index);
+            }
+            last_frame_index = index;
+        }
+
+        if (promise) {
+            promise->set_value(DecompressFrame(index));
+        }
+        FramePtr result = frame.get();
+        if (!result) {
+            // Do not keep the failure around, the next read retries
+            std::scoped_lock lock{cache_mutex};
+            if (auto it = cached_frames.find(index); it != cached_frames.end()) {
+                frame_lru.erase(it->second.lru_it);
+                cached_frames.erase(it);
+            }
+        }
+        return result;
+    }
+
+    std::shared_future<FramePtr> InsertFrame(u32 index, std::shared_future<FramePtr> frame) {
+        if (cached_frames.size() >= max_cached_frames) {
+            cached_frames.erase(frame_lru.back());
+            frame_lru.pop_back();
+        }
+        frame_lru.push_front(index);
+        cached_frames.emplace(index, CachedFrame{frame, frame_lru.begin()});
+        return frame;
+    }
+
+    void QueueReadAhead(u32 index) {
+        const u32 num_frames = ZSTD_seekable_getNumFrames(seekable);
+        const u32 read_ahead =
+            static_cast<u32>(std::min<std::size_t>(ReadAheadFrames, max_cached_frames / 2));
+        if (!read_ahead_worker) {
+            read_ahead_worker = std::make_unique<Common::ThreadWorker>(2, "Z3DSReadAhead");
+        }
+        for (u32 next = index + 1; next <= index + read_ahead && next < num_frames; next++) {
+            if (cached_frames.contains(next)) {
+                continue;
+            }
+            std::promise<FramePtr> promise;
+            InsertFrame(next, promise.get_future().share());
+            read_ahead_worker->QueueWork([this, next, promise = std::move(promise)]() mutable {
+                promise.set_value(DecompressFrame(next));
+            });
+        }
+    }
+
+    /// Reads from the underlying file, one thread at a time unless it is a plain file
+    std::size_t ReadFile(u8* data, std::size_t length, u64 offset) {
+        if (concurrent_file_reads) {
+            return curr_file->ReadAtBytes(data, length, offset);
+        }
+        std::scoped_lock lock{file_mutex};
+        return curr_file->ReadAtBytes(data, length, offset);
+    }
+
+    /// Decompresses a frame on its own, which unlike ZSTD_seekable_decompress is thread safe
+    FramePtr DecompressFrame(u32 index) {
+        using namespace std::chrono;
+        const auto start = Common::Tracing::IsEnabled() ? steady_clock::now()
+                                                        : steady_clock::time_point{};
+
+        thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx{
+            ZSTD_createDCtx(), ZSTD_freeDCtx};
+
+        const u64 compressed_offset = ZSTD_seekable_getFrameCompressedOffset(seekable, index);
+        std::vector<u8> compressed(ZSTD_seekable_getFrameCompressedSize(seekable, index));
+        const u64 file_offset = compressed_offset + header.metadata_size + header.header_size;
+        if (ReadFile(compressed.data(), compressed.size(), file_offset) != compressed.size()) {
+            LOG_ERROR(Common_Filesystem, "Failed to read Z3DS frame {}", index);
+            return nullptr;
+        }
+
+        const size_t frame_size = ZSTD_seekable_getFrameDecompressedSize(seekable, index);
+        auto frame = std::make_shared<std::vector<u8>>(frame_size);
+        const size_t result = ZSTD_decompressDCtx(dctx.get(), frame->data(), frame->size(),
+                                                  compressed.data(), compressed.size());
+        if (ZSTD_isError(result)) {
+            LOG_ERROR(Common_Filesystem, "ZSTD_decompressDCtx() error : {}",
+                      ZSTD_getErrorName(result));
+            return nullptr;
+        }
+
+        if (Common::Tracing::IsEnabled()) {
+            const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+            Common::Tracing::IncrementCounter(Common::Tracing::Counter::Z3DSDecompressTime,
+                                              static_cast<u64>(elapsed.count()));
+        }
+        return frame;
+    }
+
     void Close() {
+        // The read ahead tasks use the seek table, so wait for them first
+        read_ahead_worker.reset();
         ZSTD_seekable_free(seekable);
+        seekable = nullptr;
     }
 
+    /// Frames read ahead of a sequential read
+    static constexpr std::size_t ReadAheadFrames = 4;
+    /// Smallest number of frames worth caching, below it the frames are decompressed on demand
+    static constexpr std::size_t MinCachedFrames = 4;
+
+    struct CachedFrame {
+        std::shared_future<FramePtr> frame;
+        std::list<u32>::iterator lru_it;
+    };
+
     Z3DSFileHeader header{};
     ZSTD_seekable* seekable = nullptr;
     bool m_good = true;
     IOFile* curr_file = nullptr;
+    bool concurrent_file_reads = false; ///< Whether the file may be read by several threads at once
+    std::mutex file_mutex;
     std::mutex read_mutex;
     u64 uncompressed_pos = 0;
     Z3DSMetadata metadata;
+
+    std::size_t max_cached_frames = 0;
+    std::mutex cache_mutex;
+    std::unordered_map<u32, CachedFrame> cached_frames;
+    std::list<u32> frame_lru;
+    std::optional<u32> last_frame_index;
+    std::unique_ptr<Common::ThreadWorker> read_ahead_worker;
 };
 
 std::optional<u32> Z3DSReadIOFile::GetUnderlyingFileMagic(IOFile* underlying_file) {
@@ -701,7 +1114,8 @@ void Z3DSReadIOFile::serialize(Archive& ar, const unsigned int) {
 bool CompressZ3DSFile(const std::string& src_file_name, const std::string& dst_file_name,
                       const std::array<u8, 4>& underlying_magic, size_t frame_size,
                       std::function<ProgressCallback>&& update_callback,
-                      std::unordered_map<std::string, std::vector<u8>> metadata) {
+                      std::unordered_map<std::string, std::vector<u8>> metadata,
+                      const Z3DSCompressionOptions& options) {
 
     IOFile in_file(src_file_name, "rb");
     if (!in_file.IsOpen()) {
@@ -721,7 +1135,7 @@ bool CompressZ3DSFile(const std::string& src_file_name, const std::string& dst_f
         return false;
     }
 
-    Z3DSWriteIOFile out_compress_file(std::move(out_file), underlying_magic, frame_size);
+    Z3DSWriteIOFile out_compress_file(std::move(out_file), underlying_magic, frame_size, options);
 
     for (auto& it : metadata) {
         std::string val_str(it.second.size(), '\0');
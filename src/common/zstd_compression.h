@@ -9,6 +9,7 @@
 #pragma once
 
 #include <span>
+#include <streambuf>
 #include <unordered_map>
 #include <vector>
 
@@ -19,6 +20,9 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
 namespace Common::Compression {
 
 /**
@@ -52,6 +56,70 @@ namespace Common::Compression {
 
 [[nodiscard]] std::vector<u8, Common::AlignedAllocator<u8>>
     DecompressDataZSTDAligned(std::span<const u8> compressed);
+
+/**
+ * Stream buffer that compresses everything written to it into a single Zstandard frame and
+ * writes it to a file as it goes, so the uncompressed data never has to be held in memory.
+ * `Finish()` must be called once all the data has been written to end the frame.
+ */
+class ZSTDOutputStreamBuf final : public std::streambuf {
+public:
+    /// Compresses with the default compression level.
+    explicit ZSTDOutputStreamBuf(FileUtil::IOFile& file);
+
+    /**
+     * @param compression_level the used compression level. Should be between 1 and 22.
+     * @param num_workers number of threads compressing in the background, 0 compresses inline.
+     * @param dictionary optional trained dictionary, which is also needed to decompress the frame.
+     */
+    explicit ZSTDOutputStreamBuf(FileUtil::IOFile& file, s32 compression_level,
+                                 u32 num_workers = 0, std::span<const u8> dictionary = {});
+    ~ZSTDOutputStreamBuf() override;
+
+    /**
+     * Compresses the remaining buffered data and ends the frame.
+     * @return Whether every compression step and file write succeeded.
+     */
+    [[nodiscard]] bool Finish();
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    bool Compress(bool end_frame);
+
+    FileUtil::IOFile& file;
+    ZSTD_CCtx_s* context;
+    std::vector<char> in_buffer;
+    std::vector<u8> out_buffer;
+    bool good = true;
+};
+
+/**
+ * Stream buffer that reads a Zstandard frame from the current position of a file and
+ * decompresses it on demand, a buffer at a time. If the frame was compressed with a dictionary,
+ * a dictionary with the same ID has to be passed in, and must outlive the stream buffer.
+ */
+class ZSTDInputStreamBuf final : public std::streambuf {
+public:
+    explicit ZSTDInputStreamBuf(FileUtil::IOFile& file, std::span<const u8> dictionary = {});
+    ~ZSTDInputStreamBuf() override;
+
+protected:
+    int_type underflow() override;
+
+private:
+    FileUtil::IOFile& file;
+    ZSTD_DCtx_s* context;
+    std::vector<u8> in_buffer;
+    std::vector<char> out_buffer;
+    std::span<const u8> dictionary;
+    std::size_t in_pos = 0;
+    std::size_t in_size = 0;
+    bool output_pending = false;
+    bool frame_started = false;
+};
 } // namespace Common::Compression
 
 namespace FileUtil {
@@ -129,6 +197,13 @@ private:
     friend class boost::serialization::access;
 };
 
+struct Z3DSCompressionOptions {
+    /// zstd compression level, from 1 to 22. Higher levels are slower but produce smaller files.
+    int level = 3;
+    /// Whether to search for matches far apart, which helps large frames with repeated data.
+    bool long_distance_matching = false;
+};
+
 class Z3DSWriteIOFile : public IOFile {
 public:
     static constexpr size_t DEFAULT_FRAME_SIZE = 256 * 1024;           // 256KiB
@@ -138,7 +213,8 @@ public:
     Z3DSWriteIOFile();
 
     Z3DSWriteIOFile(std::unique_ptr<IOFile>&& underlying_file,
-                    const std::array<u8, 4>& underlying_magic, size_t frame_size);
+                    const std::array<u8, 4>& underlying_magic, size_t frame_size,
+                    const Z3DSCompressionOptions& options = {});
 
     ~Z3DSWriteIOFile();
 
@@ -265,7 +341,8 @@ using ProgressCallback = void(std::size_t, std::size_t);
 bool CompressZ3DSFile(const std::string& src_file, const std::string& dst_file,
                       const std::array<u8, 4>& underlying_magic, size_t frame_size,
                       std::function<ProgressCallback>&& update_callback = nullptr,
-                      std::unordered_map<std::string, std::vector<u8>> metadata = {});
+                      std::unordered_map<std::string, std::vector<u8>> metadata = {},
+                      const Z3DSCompressionOptions& options = {});
 
 bool DeCompressZ3DSFile(const std::string& src_file, const std::string& dst_file,
                         std::function<ProgressCallback>&& update_callback = nullptr);
@@ -3,10 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <utility>
 #include <dynarmic/interface/A32/a32.h>
 #include <dynarmic/interface/optimization_flags.h>
 #include "common/assert.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
 #include "core/arm/dynarmic/arm_exclusive_monitor.h"
@@ -17,8 +21,13 @@
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
 
+using namespace Common::Literals;
+
 namespace Core {
 
+/// Size of the translation cache reserved by each JIT, which is dynarmic's default.
+constexpr std::size_t JitCodeCacheSize = 128_MiB;
+
 class DynarmicUserCallbacks final : public Dynarmic::A32::UserCallbacks {
 public:
     explicit DynarmicUserCallbacks(ARM_Dynarmic& parent)
@@ -26,41 +35,53 @@ public:
     ~DynarmicUserCallbacks() = default;
 
     std::uint8_t MemoryRead8(VAddr vaddr) override {
+        const auto lock = LockCore();
         return memory.Read8(vaddr);
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
+        const auto lock = LockCore();
         return memory.Read16(vaddr);
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
+        const auto lock = LockCore();
         return memory.Read32(vaddr);
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
+        const auto lock = LockCore();
         return memory.Read64(vaddr);
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
+        const auto lock = LockCore();
         memory.Write8(vaddr, value);
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
+        const auto lock = LockCore();
         memory.Write16(vaddr, value);
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
+        const auto lock = LockCore();
         memory.Write32(vaddr, value);
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
+        const auto lock = LockCore();
         memory.Write64(vaddr, value);
     }
 
     bool MemoryWriteExclusive8(u32 vaddr, u8 value, u8 expected) override {
+        const auto lock = LockCore();
         return memory.WriteExclusive8(vaddr, value, expected);
     }
     bool MemoryWriteExclusive16(u32 vaddr, u16 value, u16 expected) override {
+        const auto lock = LockCore();
         return memory.WriteExclusive16(vaddr, value, expected);
     }
     bool MemoryWriteExclusive32(u32 vaddr, u32 value, u32 expected) override {
+        const auto lock = LockCore();
         return memory.WriteExclusive32(vaddr, value, expected);
     }
     bool MemoryWriteExclusive64(u32 vaddr, u64 value, u64 expected) override {
+        const auto lock = LockCore();
         return memory.WriteExclusive64(vaddr, value, expected);
     }
 
@@ -71,10 +92,12 @@ public:
     }
 
     void CallSVC(std::uint32_t swi) override {
+        const auto lock = LockCore();
         svc_context.CallSVC(swi);
     }
 
     void ExceptionRaised(VAddr pc, Dynarmic::A32::Exception exception) override {
+        const auto lock = LockCore();
         switch (exception) {
         case Dynarmic::A32::Exception::UndefinedInstruction:
         case Dynarmic::A32::Exception::UnpredictableInstruction:
@@ -85,6 +108,11 @@ public:
             if (GDBStub::IsConnected()) {
                 parent.jit->HaltExecution();
                 parent.SetPC(pc);
+                if (!GDBStub::CheckBreakpointCondition(pc, parent)) {
+                    // Stepped over by Run without leaving the emulation loop
+                    parent.skipped_breakpoint = pc;
+                    return;
+                }
                 parent.ServeBreak();
                 return;
             }
@@ -117,6 +145,11 @@ public:
         return Core::TicksForInstruction(is_thumb, instruction);
     }
 
+    /// Serializes the callbacks that touch shared state when the cores run in parallel
+    [[nodiscard]] std::unique_lock<std::recursive_mutex> LockCore() {
+        return parent.system.LockCore(parent);
+    }
+
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
@@ -136,10 +169,22 @@ ARM_Dynarmic::~ARM_Dynarmic() = default;
 MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    {
+        // While the cores run in parallel the current page table is only this core's once it
+        // holds the shared state.
+        const auto lock = system.LockCore(*this);
+        ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    }
     MICROPROFILE_SCOPE(ARM_Jit);
 
     jit->Run();
+
+    // Breakpoints whose condition does not hold are executed through without the debugger
+    while (skipped_breakpoint) {
+        const VAddr addr = *std::exchange(skipped_breakpoint, std::nullopt);
+        GDBStub::StepOverBreakpoint(addr, [this] { jit->Step(); });
+        jit->Run();
+    }
 }
 
 void ARM_Dynarmic::Step() {
@@ -258,12 +303,15 @@ void ARM_Dynarmic::PrepareReschedule() {
 
 void ARM_Dynarmic::ClearInstructionCache() {
     for (const auto& j : jits) {
-        j.second->ClearCache();
+        j.second.jit->ClearCache();
     }
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
-    jit->InvalidateCacheRange(start_address, length);
+    // The code may also have been compiled by the JIT of another process sharing the memory
+    for (const auto& j : jits) {
+        j.second.jit->InvalidateCacheRange(start_address, length);
+    }
 }
 
 void ARM_Dynarmic::ClearExclusiveState() {
@@ -281,17 +329,58 @@ void ARM_Dynarmic::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_t
         SaveContext(ctx);
     }
 
+    // JITs of processes that exited or of page tables replaced by a savestate load can never be
+    // selected again, release their code caches instead of keeping them for the whole session.
+    // The previous JIT may still be executing the SVC that switched the page table.
+    std::erase_if(jits, [this](const auto& entry) {
+        return entry.first.use_count() == 1 && entry.second.jit.get() != jit;
+    });
+
     auto iter = jits.find(current_page_table);
     if (iter != jits.end()) {
-        jit = iter->second.get();
+        jit = iter->second.jit.get();
+        iter->second.last_scheduled = ++schedule_count;
         LoadContext(ctx);
         return;
     }
 
+    TrimJits();
+
     auto new_jit = MakeJit();
     jit = new_jit.get();
     LoadContext(ctx);
-    jits.emplace(current_page_table, std::move(new_jit));
+    jits.emplace(current_page_table,
+                 CachedJit{std::move(new_jit), ++schedule_count,
+                           Common::MemoryAccounting::Allocation{
+                               Common::MemoryAccounting::Category::JitCode, JitCodeCacheSize}});
+    LOG_DEBUG(Core_ARM11, "Core {} created a JIT, {} cached using up to {} MiB", GetID(),
+              jits.size(), jits.size() * JitCodeCacheSize / 1_MiB);
+}
+
+void ARM_Dynarmic::TrimJits() {
+    const u64 budget = Settings::values.jit_cache_budget.GetValue() * 1_MiB;
+    if (budget == 0) {
+        return;
+    }
+
+    // Applets and LLE modules get a JIT each, which keeps its translations for as long as the
+    // process lives. Releasing one only costs recompiling its code if it is scheduled again.
+    while ((jits.size() + 1) * JitCodeCacheSize > budget) {
+        auto oldest = jits.end();
+        for (auto entry = jits.begin(); entry != jits.end(); ++entry) {
+            // The current JIT may still be executing the SVC that switched the page table.
+            if (entry->second.jit.get() != jit &&
+                (oldest == jits.end() ||
+                 entry->second.last_scheduled < oldest->second.last_scheduled)) {
+                oldest = entry;
+            }
+        }
+        if (oldest == jits.end()) {
+            break;
+        }
+        jits.erase(oldest);
+        LOG_DEBUG(Core_ARM11, "Core {} released the least recently scheduled JIT", GetID());
+    }
 }
 
 void ARM_Dynarmic::ServeBreak() {
@@ -306,9 +395,22 @@ std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     config.callbacks = cb.get();
     if (current_page_table) {
         config.page_table = &current_page_table->GetPointerArray();
+
+        // Accesses to pages missing from the arena fault and are recompiled through the page
+        // table instead.
+        if (u8* const fastmem_arena = current_page_table->GetFastmemArena()) {
+            config.fastmem_pointer = reinterpret_cast<uintptr_t>(fastmem_arena);
+
+            // LDREX/STREX then read and compare-and-swap the arena inline, holding the global
+            // monitor only around the reservation update. Pages missing from the arena fall back
+            // to the MemoryWriteExclusive callbacks like the other accesses.
+            config.fastmem_exclusive_access = true;
+            config.recompile_on_exclusive_fastmem_failure = true;
+        }
     }
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
     config.define_unpredictable_behaviour = true;
+    config.code_cache_size = JitCodeCacheSize;
 
     // Multi-process state
     config.processor_id = GetID();
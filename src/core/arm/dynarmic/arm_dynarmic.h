@@ -6,8 +6,10 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <dynarmic/interface/A32/a32.h>
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
 
@@ -68,13 +70,26 @@ private:
     std::unique_ptr<DynarmicUserCallbacks> cb;
     std::unique_ptr<Dynarmic::A32::Jit> MakeJit();
 
+    /// Releases the least recently scheduled JITs until a new one fits in the cache budget.
+    void TrimJits();
+
     u32 fpexc = 0;
     CP15State cp15_state;
     Core::DynarmicExclusiveMonitor& exclusive_monitor;
 
     Dynarmic::A32::Jit* jit = nullptr;
+    /// Address of a conditional GDB breakpoint hit whose condition did not hold
+    std::optional<VAddr> skipped_breakpoint;
     std::shared_ptr<Memory::PageTable> current_page_table = nullptr;
-    std::map<std::shared_ptr<Memory::PageTable>, std::unique_ptr<Dynarmic::A32::Jit>> jits;
+
+    struct CachedJit {
+        std::unique_ptr<Dynarmic::A32::Jit> jit;
+        u64 last_scheduled; ///< Value of `schedule_count` when the JIT was last selected
+        /// Accounts the code cache the JIT reserved
+        Common::MemoryAccounting::Allocation code_cache;
+    };
+    std::map<std::shared_ptr<Memory::PageTable>, CachedJit> jits;
+    u64 schedule_count = 0;
 };
 
 } // namespace Core
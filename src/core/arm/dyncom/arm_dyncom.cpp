@@ -11,6 +11,7 @@
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/memory.h"
 
 namespace Core {
 
@@ -33,11 +34,30 @@ void ARM_DynCom::Step() {
 
 void ARM_DynCom::ClearInstructionCache() {
     state->instruction_cache.clear();
+    state->instruction_cache_generation++;
     trans_cache_buf_top = 0;
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    // The translations of dropped blocks stay in the buffer, so start over once it fills up.
+    if (trans_cache_buf_top > TRANS_CACHE_SIZE / 4 * 3) {
+        ClearInstructionCache();
+        return;
+    }
+    if (length == 0) {
+        return;
+    }
+
+    // Blocks end at page boundaries, so only the ones starting in the pages of the range can
+    // contain it.
+    const u32 first_page = start_address >> Memory::CITRA_PAGE_BITS;
+    const u32 last_page = static_cast<u32>((u64{start_address} + length - 1) >>
+                                           Memory::CITRA_PAGE_BITS);
+    std::erase_if(state->instruction_cache, [&](const auto& entry) {
+        const u32 page = entry.first >> Memory::CITRA_PAGE_BITS;
+        return page >= first_page && page <= last_page;
+    });
+    state->instruction_cache_generation++;
 }
 
 void ARM_DynCom::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) {
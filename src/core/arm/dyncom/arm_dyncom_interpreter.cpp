@@ -1394,6 +1394,18 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     }
 #endif
 
+// Continues a direct branch with the block it was linked to. Stale links, pending interrupts and
+// attached debuggers go through DISPATCH instead, which looks the block up and links it again.
+#define GOTO_LINKED_BLOCK(link)                                                                    \
+    if (link_blocks && cpu->NirqSig &&                                                             \
+        (link).generation == cpu->instruction_cache_generation) {                                  \
+        ptr = (link).ptr;                                                                          \
+        inst_base = (arm_inst*)&trans_cache_buf[ptr];                                              \
+        GOTO_NEXT_INST;                                                                            \
+    }                                                                                              \
+    pending_link = &(link);                                                                        \
+    goto DISPATCH
+
 #define UPDATE_NFLAG(dst) (cpu->NFlag = BIT(dst, 31) ? 1 : 0)
 #define UPDATE_ZFLAG(dst) (cpu->ZFlag = dst ? 0 : 1)
 #define UPDATE_CFLAG_WITH_SC (cpu->CFlag = cpu->shifter_carry_out)
@@ -1625,6 +1637,14 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     unsigned int num_instrs = 0;
 
     std::size_t ptr;
+    // Link of the direct branch that last went through DISPATCH, set to the block it finds.
+    BlockLink* pending_link = nullptr;
+#ifdef ANDROID
+    const bool link_blocks = true;
+#else
+    // Linked blocks skip the breakpoint lookup done in DISPATCH.
+    const bool link_blocks = !GDBStub::IsConnected();
+#endif
 
     LOAD_NZCVT;
 DISPATCH: {
@@ -1651,6 +1671,12 @@ DISPATCH: {
             goto END;
     }
 
+    if (pending_link != nullptr) {
+        pending_link->ptr = ptr;
+        pending_link->generation = cpu->instruction_cache_generation;
+        pending_link = nullptr;
+    }
+
 #ifndef ANDROID
     // Find breakpoint if one exists within the block
     if (GDBStub::IsConnected()) {
@@ -1762,18 +1788,18 @@ AND_INST: {
     GOTO_NEXT_INST;
 }
 BBL_INST: {
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
         if (inst_cream->L) {
             LINK_RTN_ADDR;
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
-        goto DISPATCH;
+        GOTO_LINKED_BLOCK(inst_cream->taken);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(bbl_inst));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->not_taken);
 }
 BIC_INST: {
     bic_inst* inst_cream = (bic_inst*)inst_base->component;
@@ -4323,18 +4349,20 @@ B_2_THUMB: {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
     INC_PC(sizeof(b_2_thumb));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->taken);
 }
 B_COND_THUMB: {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
-        cpu->Reg[15] += 2;
+        INC_PC(sizeof(b_cond_thumb));
+        GOTO_LINKED_BLOCK(inst_cream->taken);
+    }
 
+    cpu->Reg[15] += 2;
     INC_PC(sizeof(b_cond_thumb));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->not_taken);
 }
 BL_1_THUMB: {
     bl_1_thumb* inst_cream = (bl_1_thumb*)inst_base->component;
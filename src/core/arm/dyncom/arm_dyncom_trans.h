@@ -22,6 +22,13 @@ enum class TransExtData {
     SINGLE_STEP = (1 << 8)
 };
 
+/// Translated block that a direct branch continues to. Only valid while the instruction cache
+/// generation is the one it was linked in, as invalidating the cache may drop the block.
+struct BlockLink {
+    std::size_t ptr;
+    u64 generation;
+};
+
 struct arm_inst {
     unsigned int idx;
     unsigned int cond;
@@ -88,6 +95,8 @@ struct bbl_inst {
     int signed_immed_24;
     unsigned int next_addr;
     unsigned int jmp_addr;
+    BlockLink taken;
+    BlockLink not_taken;
 };
 
 struct bx_inst {
@@ -451,10 +460,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    BlockLink taken;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    BlockLink taken;
+    BlockLink not_taken;
 };
 
 struct bl_1_thumb {
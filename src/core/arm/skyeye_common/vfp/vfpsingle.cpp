@@ -52,6 +52,10 @@
  */
 
 #include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -986,6 +990,84 @@ static u32 vfp_single_fnmsc(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr
                                           "fnmsc");
 }
 
+static bool vfp_single_is_normal(s32 val) {
+    const u32 exponent = (static_cast<u32>(val) >> 23) & 0xFF;
+    return exponent != 0 && exponent != 255;
+}
+
+/*
+ * Fast path computing an operation on the host FPU, used when both operands and the result are
+ * normal numbers so that flush-to-zero, default NaN and the other exceptions do not apply. The host
+ * rounds to nearest, op also returns the sign of the exact result minus the rounded one, which is
+ * enough to round in the FPSCR mode instead. Returns false if the soft-float code must be used.
+ */
+template <typename Op>
+static bool vfp_single_host_op(ARMul_State* state, int sd, s32 n, s32 m, u32 fpscr,
+                               u32* exceptions, Op op) {
+    if (!vfp_single_is_normal(n) || !vfp_single_is_normal(m)) {
+        return false;
+    }
+
+    auto [result, error] = op(std::bit_cast<float>(n), std::bit_cast<float>(m));
+    if (!vfp_single_is_normal(std::bit_cast<s32>(result))) {
+        // Zero, denormal and overflowed results need the soft-float sign and flag handling.
+        return false;
+    }
+
+    if (error != 0) {
+        switch (fpscr & FPSCR_RMODE_MASK) {
+        case FPSCR_ROUND_NEAREST:
+            break;
+        case FPSCR_ROUND_PLUSINF:
+            if (error > 0)
+                result = std::nextafter(result, std::numeric_limits<float>::infinity());
+            break;
+        case FPSCR_ROUND_MINUSINF:
+            if (error < 0)
+                result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+            break;
+        case FPSCR_ROUND_TOZERO:
+            if ((error > 0) != (result > 0))
+                result = std::nextafter(result, 0.0f);
+            break;
+        }
+    }
+
+    const s32 d = std::bit_cast<s32>(result);
+    if (!vfp_single_is_normal(d)) {
+        // Rounding crossed into the denormal or overflow range.
+        return false;
+    }
+
+    vfp_put_float(state, d, sd);
+    *exceptions = error != 0 ? FPSCR_IXC : 0;
+    return true;
+}
+
+/// Host sum and the sign of its rounding error, which is exact by the TwoSum algorithm.
+static std::pair<float, int> vfp_single_host_add(float a, float b) {
+    const float sum = a + b;
+    const float b_rounded = sum - a;
+    const float a_rounded = sum - b_rounded;
+    const float error = (a - a_rounded) + (b - b_rounded);
+    return {sum, (error > 0) - (error < 0)};
+}
+
+/// Host product and the sign of its rounding error. Products of floats are exact as doubles.
+static std::pair<float, int> vfp_single_host_mul(float a, float b) {
+    const double product = static_cast<double>(a) * b;
+    const float rounded = static_cast<float>(product);
+    return {rounded, (product > rounded) - (product < rounded)};
+}
+
+/// Host quotient and the sign of its rounding error, from the exact remainder a - q * b.
+static std::pair<float, int> vfp_single_host_div(float a, float b) {
+    const float quotient = a / b;
+    const double remainder = static_cast<double>(a) - static_cast<double>(quotient) * b;
+    const int sign = (remainder > 0) - (remainder < 0);
+    return {quotient, b > 0 ? sign : -sign};
+}
+
 /*
  * sd = sn * sm
  */
@@ -996,6 +1078,9 @@ static u32 vfp_single_fmul(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, n);
 
+    if (vfp_single_host_op(state, sd, n, m, fpscr, &exceptions, vfp_single_host_mul))
+        return exceptions;
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     if (vsn.exponent == 0 && vsn.significand)
         vfp_single_normalise_denormal(&vsn);
@@ -1041,6 +1126,9 @@ static u32 vfp_single_fadd(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, n);
 
+    if (vfp_single_host_op(state, sd, n, m, fpscr, &exceptions, vfp_single_host_add))
+        return exceptions;
+
     /*
      * Unpack and normalise denormals.
      */
@@ -1062,6 +1150,12 @@ static u32 vfp_single_fadd(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
  */
 static u32 vfp_single_fsub(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr) {
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, sd);
+
+    u32 host_exceptions;
+    if (vfp_single_host_op(state, sd, vfp_get_float(state, sn), m, fpscr, &host_exceptions,
+                           [](float a, float b) { return vfp_single_host_add(a, -b); }))
+        return host_exceptions;
+
     /*
      * Subtraction is addition with one sign inverted. Unpack the second operand to perform FTZ if
      * necessary, we can't let fadd do this because a denormal in m might get flushed to +0 in FTZ
@@ -1092,6 +1186,9 @@ static u32 vfp_single_fdiv(ARMul_State* state, int sd, int sn, s32 m, u32 fpscr)
 
     LOG_TRACE(Core_ARM11, "s{} = {:08x}", sn, n);
 
+    if (vfp_single_host_op(state, sd, n, m, fpscr, &exceptions, vfp_single_host_div))
+        return exceptions;
+
     exceptions |= vfp_single_unpack(&vsn, n, fpscr);
     exceptions |= vfp_single_unpack(&vsm, m, fpscr);
 
@@ -102,6 +102,8 @@ void CheatEngine::LoadCheatFile(u64 title_id) {
 void CheatEngine::RunCallback([[maybe_unused]] std::uintptr_t user_data, s64 cycles_late) {
     {
         std::shared_lock lock{cheats_list_mutex};
+        // Cheats may write code, which is invalidated once all of them ran
+        Core::CacheInvalidationBatch invalidation_batch{system};
         for (const auto& cheat : cheats_list) {
             if (cheat->IsEnabled()) {
                 cheat->Execute(system, process_id);
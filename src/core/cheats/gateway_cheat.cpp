@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <span>
@@ -16,6 +17,7 @@
 #include "common/string_util.h"
 #include "core/cheats/gateway_cheat.h"
 #include "core/core.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/memory.h"
 
@@ -31,8 +33,66 @@ struct State {
     bool loop_flag = false;
 };
 
+/**
+ * Accesses the memory of the process a cheat runs on. Pages backed by host memory are accessed
+ * through the host pointers of the process page table, which are looked up again on every run, so
+ * remapping never leaves stale pointers behind. Anything else goes through the memory system.
+ */
+class ProcessMemory {
+public:
+    ProcessMemory(Memory::MemorySystem& memory_, const Kernel::Process& process_)
+        : memory{memory_}, process{process_},
+          pointers{process_.vm_manager.page_table->GetPointerArray()} {}
+
+    template <typename T>
+    T Read(VAddr addr) {
+        if (const u8* host = GetHostPointer<T>(addr)) {
+            T value;
+            std::memcpy(&value, host, sizeof(T));
+            return value;
+        }
+        if constexpr (sizeof(T) == 1) {
+            return memory.Read8(process, addr);
+        } else if constexpr (sizeof(T) == 2) {
+            return memory.Read16(process, addr);
+        } else {
+            return memory.Read32(process, addr);
+        }
+    }
+
+    template <typename T>
+    void Write(VAddr addr, T value) {
+        if (u8* host = GetHostPointer<T>(addr)) {
+            std::memcpy(host, &value, sizeof(T));
+            return;
+        }
+        if constexpr (sizeof(T) == 1) {
+            memory.Write8(process, addr, value);
+        } else if constexpr (sizeof(T) == 2) {
+            memory.Write16(process, addr, value);
+        } else {
+            memory.Write32(process, addr, value);
+        }
+    }
+
+private:
+    template <typename T>
+    u8* GetHostPointer(VAddr addr) const {
+        // Accesses crossing a page boundary take the slow path.
+        if ((addr & Memory::CITRA_PAGE_MASK) > Memory::CITRA_PAGE_SIZE - sizeof(T)) {
+            return nullptr;
+        }
+        u8* page = pointers[addr >> Memory::CITRA_PAGE_BITS];
+        return page ? page + (addr & Memory::CITRA_PAGE_MASK) : nullptr;
+    }
+
+    Memory::MemorySystem& memory;
+    const Kernel::Process& process;
+    const std::array<u8*, Memory::PAGE_TABLE_NUM_ENTRIES>& pointers;
+};
+
 template <typename T, typename ReadFunction, typename WriteFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat::Instruction& line,
                                                               const State& state,
                                                               ReadFunction read_func,
                                                               WriteFunction write_func,
@@ -46,7 +106,7 @@ static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat
 }
 
 template <typename T, typename ReadFunction, typename CompareFunc>
-static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat::Instruction& line,
                                                              State& state, ReadFunction read_func,
                                                              CompareFunc comp) {
     u32 addr = line.address + state.offset;
@@ -56,13 +116,13 @@ static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat:
     }
 }
 
-static inline void LoadOffsetOp(Memory::MemorySystem& memory, const Kernel::Process& process,
-                                const GatewayCheat::CheatLine& line, State& state) {
+static inline void LoadOffsetOp(ProcessMemory& memory, const GatewayCheat::Instruction& line,
+                                State& state) {
     u32 addr = line.address + state.offset;
-    state.offset = memory.Read32(process, addr);
+    state.offset = memory.Read<u32>(addr);
 }
 
-static inline void LoopOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void LoopOp(const GatewayCheat::Instruction& line, State& state) {
     state.loop_flag = state.loop_count < line.value;
     state.loop_count++;
     state.loop_back_line = state.current_line_nr;
@@ -94,21 +154,21 @@ static inline void FullTerminateOp(State& state) {
     }
 }
 
-static inline void SetOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void SetOffsetOp(const GatewayCheat::Instruction& line, State& state) {
     state.offset = line.value;
 }
 
-static inline void AddValueOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void AddValueOp(const GatewayCheat::Instruction& line, State& state) {
     state.reg += line.value;
 }
 
-static inline void SetValueOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void SetValueOp(const GatewayCheat::Instruction& line, State& state) {
     state.reg = line.value;
 }
 
 template <typename T, typename ReadFunction, typename WriteFunction>
 static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(
-    const GatewayCheat::CheatLine& line, State& state, ReadFunction read_func,
+    const GatewayCheat::Instruction& line, State& state, ReadFunction read_func,
     WriteFunction write_func, Core::System& system) {
     u32 addr = line.value + state.offset;
     T val = read_func(addr);
@@ -120,18 +180,18 @@ static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(
 }
 
 template <typename T, typename ReadFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat::CheatLine& line,
+static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat::Instruction& line,
                                                              State& state, ReadFunction read_func) {
 
     u32 addr = line.value + state.offset;
     state.reg = read_func(addr);
 }
 
-static inline void AddOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
+static inline void AddOffsetOp(const GatewayCheat::Instruction& line, State& state) {
     state.offset += line.value;
 }
 
-static inline void JokerOp(const GatewayCheat::CheatLine& line, State& state,
+static inline void JokerOp(const GatewayCheat::Instruction& line, State& state,
                            const Core::System& system) {
     u32 pad_state = system.ServiceManager()
                         .GetService<Service::HID::Module::Interface>("hid:USER")
@@ -144,9 +204,9 @@ static inline void JokerOp(const GatewayCheat::CheatLine& line, State& state,
     }
 }
 
-static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Core::System& system,
-                           const Kernel::Process& process,
-                           std::span<const GatewayCheat::CheatLine> cheat_lines) {
+static inline void PatchOp(const GatewayCheat::Instruction& line, State& state,
+                           Core::System& system, ProcessMemory& memory,
+                           std::span<const GatewayCheat::Instruction> program) {
     if (state.if_flag > 0) {
         // Skip over the additional patch lines
         state.current_line_nr += static_cast<int>(std::ceil(line.value / 8.0));
@@ -161,21 +221,21 @@ static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Co
     if (num_bytes > 0)
         state.current_line_nr++; // skip over the current code
     while (num_bytes >= 4) {
-        u32 tmp = first ? cheat_lines[state.current_line_nr].first
-                        : cheat_lines[state.current_line_nr].value;
+        u32 tmp = first ? program[state.current_line_nr].first
+                        : program[state.current_line_nr].value;
         if (!first && num_bytes > 4) {
             state.current_line_nr++;
         }
         first = !first;
-        system.Memory().Write32(process, addr, tmp);
+        memory.Write<u32>(addr, tmp);
         addr += 4;
         num_bytes -= 4;
     }
     while (num_bytes > 0) {
-        u32 tmp = (first ? cheat_lines[state.current_line_nr].first
-                         : cheat_lines[state.current_line_nr].value) >>
+        u32 tmp = (first ? program[state.current_line_nr].first
+                         : program[state.current_line_nr].value) >>
                   bit_offset;
-        system.Memory().Write8(process, addr, static_cast<u8>(tmp));
+        memory.Write<u8>(addr, static_cast<u8>(tmp));
         addr += 1;
         num_bytes -= 1;
         bit_offset += 8;
@@ -213,6 +273,7 @@ GatewayCheat::CheatLine::CheatLine(const std::string& line) {
 GatewayCheat::GatewayCheat(std::string name_, std::vector<CheatLine> cheat_lines_,
                            std::string comments_)
     : name(std::move(name_)), cheat_lines(std::move(cheat_lines_)), comments(std::move(comments_)) {
+    Compile();
 }
 
 GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comments_)
@@ -226,35 +287,44 @@ GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comm
             temp_cheat_lines.emplace_back(line);
     }
     cheat_lines = std::move(temp_cheat_lines);
+    Compile();
 }
 
 GatewayCheat::~GatewayCheat() = default;
 
+void GatewayCheat::Compile() {
+    // Lines are kept one to one, patch codes refer to the data lines following them by index.
+    program.clear();
+    program.reserve(cheat_lines.size());
+    for (const auto& line : cheat_lines) {
+        program.push_back({
+            .type = line.valid ? line.type : CheatType::Null,
+            .address = line.valid ? line.address : 0,
+            .value = line.valid ? line.value : 0,
+            .first = line.valid ? line.first : 0,
+        });
+    }
+}
+
 void GatewayCheat::Execute(Core::System& system, u32 process_id) const {
     State state;
 
-    Memory::MemorySystem& memory = system.Memory();
     std::shared_ptr<Kernel::Process> process = system.Kernel().GetProcessById(process_id);
     if (!process) {
         return;
     }
+    ProcessMemory memory{system.Memory(), *process};
+
+    auto Read8 = [&memory](VAddr addr) { return memory.Read<u8>(addr); };
+    auto Read16 = [&memory](VAddr addr) { return memory.Read<u16>(addr); };
+    auto Read32 = [&memory](VAddr addr) { return memory.Read<u32>(addr); };
+    auto Write8 = [&memory](VAddr addr, u8 value) { memory.Write<u8>(addr, value); };
+    auto Write16 = [&memory](VAddr addr, u16 value) { memory.Write<u16>(addr, value); };
+    auto Write32 = [&memory](VAddr addr, u32 value) { memory.Write<u32>(addr, value); };
 
-    auto Read8 = [&memory, &process](VAddr addr) { return memory.Read8(*process, addr); };
-    auto Read16 = [&memory, &process](VAddr addr) { return memory.Read16(*process, addr); };
-    auto Read32 = [&memory, &process](VAddr addr) { return memory.Read32(*process, addr); };
-    auto Write8 = [&memory, &process](VAddr addr, u8 value) {
-        memory.Write8(*process, addr, value);
-    };
-    auto Write16 = [&memory, &process](VAddr addr, u16 value) {
-        memory.Write16(*process, addr, value);
-    };
-    auto Write32 = [&memory, &process](VAddr addr, u32 value) {
-        memory.Write32(*process, addr, value);
-    };
-
-    for (state.current_line_nr = 0; state.current_line_nr < cheat_lines.size();
+    for (state.current_line_nr = 0; state.current_line_nr < program.size();
          state.current_line_nr++) {
-        auto line = cheat_lines[state.current_line_nr];
+        const auto& line = program[state.current_line_nr];
         if (state.if_flag > 0) {
             switch (line.type) {
             case CheatType::GreaterThan32:
@@ -273,7 +343,7 @@ void GatewayCheat::Execute(Core::System& system, u32 process_id) const {
                 // EXXXXXXX YYYYYYYY
                 // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
                 // We need to call this here to skip the additional patch lines
-                PatchOp(line, state, system, *process, cheat_lines);
+                PatchOp(line, state, system, memory, program);
                 break;
             case CheatType::Terminator:
                 // D0000000 00000000 - ENDIF
@@ -348,7 +418,7 @@ void GatewayCheat::Execute(Core::System& system, u32 process_id) const {
             break;
         case CheatType::LoadOffset:
             // BXXXXXXX 00000000 - offset = word[XXXXXXX+offset]
-            LoadOffsetOp(system.Memory(), *process, line, state);
+            LoadOffsetOp(memory, line, state);
             break;
         case CheatType::Loop: {
             // C0000000 YYYYYYYY - LOOP next block YYYYYYYY times
@@ -429,7 +499,7 @@ void GatewayCheat::Execute(Core::System& system, u32 process_id) const {
         case CheatType::Patch: {
             // EXXXXXXX YYYYYYYY
             // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-            PatchOp(line, state, system, *process, cheat_lines);
+            PatchOp(line, state, system, memory, program);
             break;
         }
         }
@@ -55,6 +55,14 @@ public:
         bool valid = true;
     };
 
+    /// A cheat line reduced to what is needed to run it, compiled once when the cheat is created.
+    struct Instruction {
+        CheatType type;
+        u32 address;
+        u32 value;
+        u32 first;
+    };
+
     GatewayCheat(std::string name, std::vector<CheatLine> cheat_lines, std::string comments);
     GatewayCheat(std::string name, std::string code, std::string comments);
     ~GatewayCheat();
@@ -80,9 +88,14 @@ public:
     static std::vector<std::shared_ptr<CheatBase>> LoadFile(const std::string& filepath);
 
 private:
+    void Compile();
+
     std::atomic<bool> enabled = false;
     const std::string name;
     std::vector<CheatLine> cheat_lines;
+    /// The cheat lines in executable form. Editing a cheat creates a new GatewayCheat, so this
+    /// never has to be invalidated.
+    std::vector<Instruction> program;
     const std::string comments;
 };
 } // namespace Cheats
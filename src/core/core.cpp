@@ -2,6 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <optional>
 #include <stdexcept>
 #include <utility>
 #include <boost/serialization/array.hpp>
@@ -11,6 +15,7 @@
 #include "common/arch.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/tracing.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/hle/service/cam/cam.h"
@@ -25,6 +30,7 @@
 #include "core/core_timing.h"
 #include "core/dumping/backend.h"
 #include "core/file_sys/ncch_container.h"
+#include "core/file_sys/romfs_reader.h"
 #include "core/frontend/image_interface.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/global.h"
@@ -46,6 +52,7 @@
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
+#include "core/rewind.h"
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/server.h"
 #endif
@@ -54,10 +61,42 @@
 #include "video_core/gpu.h"
 #include "video_core/renderer_base.h"
 #include "common/cpu_affinity.h"
-#include "common/thread_pool.h"
+#include "common/task_scheduler.h"
 
 namespace Core {
 
+namespace {
+
+/// Logs how long a stage of the boot took once it goes out of scope
+class BootStage {
+public:
+    explicit BootStage(const char* name_) : name{name_}, start{std::chrono::steady_clock::now()} {}
+
+    ~BootStage() {
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        LOG_INFO(Core, "Boot stage '{}' took {:.1f} ms", name, duration.count() / 1000.0);
+    }
+
+    BootStage(const BootStage&) = delete;
+    BootStage& operator=(const BootStage&) = delete;
+
+private:
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+};
+
+/// Runs a boot stage that does not depend on the emulated system on the task scheduler
+template <typename Func>
+std::future<void> RunBootStageAsync(const char* name, Func&& func) {
+    return Common::GetTaskScheduler().Enqueue([name, func = std::forward<Func>(func)]() mutable {
+        BootStage stage{name};
+        func();
+    });
+}
+
+} // Anonymous namespace
+
 /*static*/ System System::s_instance;
 
 template <>
@@ -77,13 +116,10 @@ Core::Timing& Global() {
 
 System::System() : movie{*this}, cheat_engine{*this} {}
 
-System::~System() {
-    // Shutdown le thread pool
-    Common::ShutdownThreadPool();
-}
+System::~System() = default;
 
 System::ResultStatus System::RunLoop(bool tight_loop) {
-    Common::SetBigCoreAffinity();
+    Common::SetCurrentThreadCoreClass(Common::CoreClass::Prime);
     status = ResultStatus::Success;
     if (!IsPoweredOn()) {
         return ResultStatus::ErrorNotInitialized;
@@ -150,6 +186,9 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         save_state_request_status = SaveStateStatus::SAVING;
         break;
     }
+    case Signal::Rewind:
+        rewind_requested = Settings::values.rewind_interval.GetValue() != 0;
+        break;
     default:
         break;
     }
@@ -193,6 +232,16 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         return ResultStatus::ErrorSavestate;
     }
 
+    if (Settings::values.rewind_interval.GetValue() != 0 && kernel.get() &&
+        !kernel->AreAsyncOperationsPending()) {
+        if (rewind_requested) {
+            rewind_requested = false;
+            RewindState();
+            return ResultStatus::Success;
+        }
+        CaptureRewindState();
+    }
+
     // All cores should have executed the same amount of ticks. If this is not the case an event was
     // scheduled with a cycles_into_future smaller then the current downcount.
     // So we have to get those cores to the same global time first
@@ -251,27 +300,31 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
-        for (auto& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            auto start_ticks = cpu_core->GetTimer().GetTicks();
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
-            // If we don't have a currently active thread then don't execute instructions,
-            // instead advance to the next event and try to yield to the next thread
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (tight_loop) {
-                    cpu_core->Run();
+        if (!core_threads.empty() && tight_loop && !GDBStub::IsServerEnabled()) {
+            RunCoresInParallel(max_slice);
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                auto start_ticks = cpu_core->GetTimer().GetTicks();
+                LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                          cpu_core->GetTimer().GetDowncount());
+                running_core = cpu_core.get();
+                kernel->SetRunningCPU(running_core);
+                // If we don't have a currently active thread then don't execute instructions,
+                // instead advance to the next event and try to yield to the next thread
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
                 } else {
-                    cpu_core->Step();
+                    if (tight_loop) {
+                        cpu_core->Run();
+                    } else {
+                        cpu_core->Step();
+                    }
                 }
+                max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
             }
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
         }
     }
 
@@ -434,7 +487,11 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     }
 
     std::shared_ptr<Kernel::Process> process;
-    const Loader::ResultStatus load_result{app_loader->Load(process)};
+    Loader::ResultStatus load_result;
+    {
+        BootStage stage{"Application"};
+        load_result = app_loader->Load(process);
+    }
     if (Loader::ResultStatus::Success != load_result) {
         LOG_CRITICAL(Core, "Failed to load ROM (Error {})!", load_result);
         System::Shutdown();
@@ -467,8 +524,8 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     if (Settings::values.dump_textures) {
         custom_tex_manager->PrepareDumping(title_id);
     }
-    if (Settings::values.custom_textures) {
-        custom_tex_manager->FindCustomTextures();
+    if (custom_textures_task.valid()) {
+        custom_textures_task.get();
     }
 
     status = ResultStatus::Success;
@@ -483,16 +540,91 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     return status;
 }
 
+std::unique_lock<std::recursive_mutex> System::LockCore(ARM_Interface& core) {
+    if (!running_multicore.load(std::memory_order_relaxed)) {
+        return {};
+    }
+    std::unique_lock lock{core_mutex};
+    if (running_core != &core) {
+        // The other cores keep running, so only the bookkeeping is switched. Their page tables
+        // are left alone.
+        running_core = &core;
+        kernel->SwitchRunningCPU(running_core);
+    }
+    return lock;
+}
+
+void System::RunCoresInParallel(s64 slice_length) {
+    // Idle cores only skip to their next event, which is done before the others start running.
+    std::vector<bool> active_cores(cpu_cores.size());
+    for (std::size_t i = 0; i < cpu_cores.size(); i++) {
+        ARM_Interface* cpu_core = cpu_cores[i].get();
+        cpu_core->GetTimer().SetNextSlice(slice_length);
+        running_core = cpu_core;
+        kernel->SetRunningCPU(running_core);
+        if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+            cpu_core->GetTimer().Idle();
+            PrepareReschedule();
+        } else {
+            active_cores[i] = true;
+        }
+    }
+
+    running_multicore.store(true, std::memory_order_relaxed);
+    for (std::size_t i = 1; i < cpu_cores.size(); i++) {
+        if (active_cores[i]) {
+            core_threads[i - 1]->QueueWork([cpu_core = cpu_cores[i].get()] { cpu_core->Run(); });
+        }
+    }
+    // The first core stays on the emulation thread, which the renderer is bound to.
+    if (active_cores[0]) {
+        cpu_cores[0]->Run();
+    }
+    for (auto& core_thread : core_threads) {
+        core_thread->WaitForRequests();
+    }
+    running_multicore.store(false, std::memory_order_relaxed);
+
+    running_core = cpu_cores.back().get();
+    kernel->SetRunningCPU(running_core);
+}
+
 void System::PrepareReschedule() {
     running_core->PrepareReschedule();
     reschedule_pending = true;
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
+    if (perf_stats && dsp_core) {
+        perf_stats->ReportAudioLatency(dsp_core->GetOutputLatency());
+    }
+    if (perf_stats) {
+        const auto [romfs_hits, romfs_misses] = FileSys::DirectRomFSReader::GetAndResetCacheStats();
+        perf_stats->ReportRomFSCacheStats(romfs_hits, romfs_misses);
+    }
     return (perf_stats && timing) ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
                                   : PerfStats::Results{};
 }
 
+void System::EndSystemFrame() {
+    // Audio stage times are collected every frame so that they show in the frame breakdown
+    if (dsp_core) {
+        perf_stats->ReportAudioTimes(dsp_core->GetAndResetStageTimes());
+    }
+    perf_stats->EndSystemFrame();
+}
+
+void System::EndGameFrame() {
+    perf_stats->EndGameFrame();
+    Common::Tracing::SampleCounters();
+#ifdef ENABLE_SCRIPTING
+    if (rpc_server) {
+        rpc_server->OnFrameEnd();
+    }
+#endif
+}
+
 PerfStats::Results System::GetLastPerfStats() {
     return perf_stats ? perf_stats->GetLastStats() : PerfStats::Results{};
 }
@@ -516,10 +648,14 @@ void System::Reschedule() {
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
                                   Frontend::EmuWindow* secondary_window,
                                   Kernel::MemoryMode memory_mode, u32 num_cores) {
-    // Initialiser le thread pool au démarrage
-    Common::InitializeThreadPool(3);  // 3 threads pour 8 Gen 2
-    LOG_DEBUG(HW_Memory, "initialized OK");
+    // Independent stages run on the task scheduler while the emulated hardware is created, each
+    // is waited for right before the first stage that needs its result.
+    BootStage init_stage{"System"};
+
+    // Keys are first needed by the services, which decrypt the system archives they mount
+    auto keys_task = RunBootStageAsync("Keys", [] { HW::AES::InitKeys(); });
 
+    std::optional<BootStage> core_stage{"Memory, kernel and CPU"};
     memory = std::make_unique<Memory::MemorySystem>(*this);
 
     timing = std::make_unique<Timing>(num_cores, Settings::values.cpu_clock_percentage.GetValue(),
@@ -555,6 +691,17 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     kernel->SetCPUs(cpu_cores);
     kernel->SetRunningCPU(cpu_cores[0].get());
 
+    if (Settings::values.use_multicore && num_cores > 1) {
+        if (!Settings::values.use_cpu_jit ||
+            Settings::values.graphics_api.GetValue() == Settings::GraphicsAPI::OpenGL) {
+            LOG_WARNING(Core, "Multicore requires the CPU JIT and a renderer other than OpenGL");
+        } else {
+            for (u32 i = 1; i < num_cores; ++i) {
+                core_threads.push_back(std::make_unique<Common::ThreadWorker>(1, "CPU Core"));
+            }
+        }
+    }
+
     const auto audio_emulation = Settings::values.audio_emulation.GetValue();
     if (audio_emulation == Settings::AudioEmulation::HLE) {
         dsp_core = std::make_unique<AudioCore::DspHle>(*this);
@@ -562,10 +709,14 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
         const bool multithread = audio_emulation == Settings::AudioEmulation::LLEMultithreaded;
         dsp_core = std::make_unique<AudioCore::DspLle>(*this, multithread);
     }
+    core_stage.reset();
 
-    dsp_core->SetSink(Settings::values.output_type.GetValue(),
-                      Settings::values.output_device.GetValue());
-    dsp_core->EnableStretching(Settings::values.enable_audio_stretching.GetValue());
+    // Opening the audio device can block for a while, nothing touches the DSP until booted
+    auto audio_task = RunBootStageAsync("Audio output", [this] {
+        dsp_core->SetSink(Settings::values.output_type.GetValue(),
+                          Settings::values.output_device.GetValue());
+        dsp_core->EnableStretching(Settings::values.enable_audio_stretching.GetValue());
+    });
 
 #ifdef ENABLE_SCRIPTING
     if (Settings::values.enable_rpc_server.GetValue()) {
@@ -578,8 +729,11 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
 
     u64 loading_title_id = 0;
     app_loader->ReadProgramId(loading_title_id);
-    HW::AES::InitKeys();
-    Service::Init(*this, loading_title_id, lle_modules, !app_loader->DoingInitialSetup());
+    keys_task.get();
+    {
+        BootStage stage{"Services"};
+        Service::Init(*this, loading_title_id, lle_modules, !app_loader->DoingInitialSetup());
+    }
     GDBStub::DeferStart();
 
     if (!registered_image_interface) {
@@ -588,17 +742,31 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
 
     custom_tex_manager = std::make_unique<VideoCore::CustomTexManager>(*this);
 
+    // The renderer stays on this thread, the graphics context of the window is current on it
     auto gsp = service_manager->GetService<Service::GSP::GSP_GPU>("gsp::Gpu");
-    gpu = std::make_unique<VideoCore::GPU>(*this, emu_window, secondary_window);
+    {
+        BootStage stage{"Renderer"};
+        gpu = std::make_unique<VideoCore::GPU>(*this, emu_window, secondary_window);
+    }
     gpu->SetInterruptHandler(
         [gsp](Service::GSP::InterruptId interrupt_id) { gsp->SignalInterrupt(interrupt_id); });
 
+    // Indexing a texture pack only needs the renderer capabilities, so it overlaps with loading
+    // the application and is waited for at the end of Load.
+    if (Settings::values.custom_textures) {
+        custom_textures_task = RunBootStageAsync("Custom textures", [this, loading_title_id] {
+            custom_tex_manager->FindCustomTextures(loading_title_id);
+        });
+    }
+
     auto plg_ldr = Service::PLGLDR::GetService(*this);
     if (plg_ldr) {
         plg_ldr->SetEnabled(Settings::values.plugin_loader_enabled.GetValue());
         plg_ldr->SetAllowGameChangeState(Settings::values.allow_plugin_loader.GetValue());
     }
 
+    audio_task.get();
+
     LOG_DEBUG(Core, "Initialized OK");
 
     is_powered_on = true;
@@ -699,6 +867,12 @@ void System::Shutdown(bool is_deserializing) {
     // Shutdown emulation session
     is_powered_on = false;
 
+    // Loading the application may have failed while the custom textures were being indexed
+    if (custom_textures_task.valid()) {
+        custom_textures_task.wait();
+        custom_textures_task = {};
+    }
+
     gpu.reset();
     if (!is_deserializing) {
         lle_modules.clear();
@@ -714,6 +888,7 @@ void System::Shutdown(bool is_deserializing) {
     service_manager.reset();
     dsp_core.reset();
     kernel.reset();
+    core_threads.clear();
     cpu_cores.clear();
     exclusive_monitor.reset();
     timing.reset();
@@ -729,6 +904,13 @@ void System::Shutdown(bool is_deserializing) {
 
     memory.reset();
 
+    if (!is_deserializing) {
+        if (savestate_worker) {
+            savestate_worker->WaitForRequests();
+        }
+        rewind_buffer.reset();
+    }
+
     if (self_delete_pending)
         FileUtil::Delete(m_filepath);
     self_delete_pending = false;
@@ -766,7 +948,35 @@ void System::Reset() {
         Load(*m_emu_window, m_filepath, m_secondary_window);
 }
 
+void System::EndCacheInvalidationBatch() {
+    ASSERT(cache_invalidation_batch_depth != 0);
+    if (--cache_invalidation_batch_depth != 0 || pending_cache_invalidations.empty()) {
+        return;
+    }
+
+    auto& ranges = pending_cache_invalidations;
+    std::sort(ranges.begin(), ranges.end());
+    u32 start = ranges.front().first;
+    u32 end = ranges.front().second;
+    const auto invalidate = [this](u32 start_address, u32 end_address) {
+        for (const auto& cpu : cpu_cores) {
+            cpu->InvalidateCacheRange(start_address, end_address - start_address);
+        }
+    };
+    for (const auto& [range_start, range_end] : ranges) {
+        if (range_start > end) {
+            invalidate(start, end);
+            start = range_start;
+        }
+        end = std::max(end, range_end);
+    }
+    invalidate(start, end);
+    ranges.clear();
+}
+
 void System::ApplySettings() {
+    Settings::UpdateRuntimeSettings();
+
     GDBStub::SetServerPort(Settings::values.gdbstub_port.GetValue());
     GDBStub::ToggleServer(Settings::values.use_gdbstub.GetValue());
 
@@ -892,6 +1102,7 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
         throw std::runtime_error("LLE audio not supported for save states");
     }
 
+    memory->SetSerializeRAM(serialize_guest_ram);
     ar&* memory.get();
     ar&* kernel.get();
     ar&* gpu.get();
@@ -6,12 +6,16 @@
 
 #include <atomic>
 #include <chrono>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include <boost/optional.hpp>
 #include <boost/serialization/version.hpp>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/arm/arm_interface.h"
 #include "core/cheats/cheats.h"
 #include "core/hle/service/apt/applet_manager.h"
@@ -74,6 +78,7 @@ namespace Core {
 
 class ARM_Interface;
 class ExclusiveMonitor;
+class RewindBuffer;
 class Timing;
 
 class System {
@@ -133,7 +138,7 @@ public:
     /// Shutdown and then load again
     void Reset();
 
-    enum class Signal : u32 { None, Shutdown, Reset, Save, Load };
+    enum class Signal : u32 { None, Shutdown, Reset, Save, Load, Rewind };
 
     bool SendSignal(Signal signal, u32 param = 0);
 
@@ -179,6 +184,12 @@ public:
         }
     }
 
+    void ReportArticLatency(std::chrono::nanoseconds latency) {
+        if (perf_stats) {
+            perf_stats->AddArticBaseLatency(latency);
+        }
+    }
+
     void ReportPerfArticEvent(PerfStats::PerfArticEventBits event, bool set) {
         if (perf_stats) {
             perf_stats->ReportPerfArticEvent(event, set);
@@ -187,6 +198,12 @@ public:
 
     [[nodiscard]] PerfStats::Results GetLastPerfStats();
 
+    /// Marks the end of a system frame, closing its frame time breakdown
+    void EndSystemFrame();
+
+    /// Marks the end of a game frame, sampling trace counters and pushing RPC memory subscriptions
+    void EndGameFrame();
+
     double GetStableFrameTimeScale();
 
     /**
@@ -198,6 +215,18 @@ public:
         return *running_core;
     };
 
+    /**
+     * Serializes the work of a core on state shared with the other cores while they run in
+     * parallel, and makes it the running core for as long as the lock is held. The returned lock
+     * is empty when the cores run one after another.
+     */
+    [[nodiscard]] std::unique_lock<std::recursive_mutex> LockCore(ARM_Interface& core);
+
+    /// Returns true while the cores are executing their slices on separate host threads
+    [[nodiscard]] bool IsRunningMulticore() const {
+        return running_multicore.load(std::memory_order_relaxed);
+    }
+
     /**
      * Gets a reference to the emulated CPU.
      * @param core_id The id of the core requested.
@@ -217,11 +246,27 @@ public:
     }
 
     void InvalidateCacheRange(u32 start_address, std::size_t length) {
+        if (cache_invalidation_batch_depth != 0) {
+            pending_cache_invalidations.emplace_back(start_address,
+                                                     start_address + static_cast<u32>(length));
+            return;
+        }
         for (const auto& cpu : cpu_cores) {
             cpu->InvalidateCacheRange(start_address, length);
         }
     }
 
+    /**
+     * Defers the invalidations of InvalidateCacheRange until the matching
+     * EndCacheInvalidationBatch, which merges the deferred ranges and invalidates each merged
+     * range once. Used when patching code writes many small ranges. Batches can be nested.
+     */
+    void BeginCacheInvalidationBatch() {
+        ++cache_invalidation_batch_depth;
+    }
+
+    void EndCacheInvalidationBatch();
+
     /**
      * Gets a reference to the emulated DSP.
      * @returns A reference to the emulated DSP.
@@ -362,6 +407,19 @@ public:
 
     void LoadState(u32 slot);
 
+    /**
+     * Saves the state to resume from when the frontend is suspended and may be killed, along with
+     * the disk caches of the renderer. Must be called while the emulation is stopped.
+     * @returns true if the state was saved.
+     */
+    bool SaveResumeState();
+
+    /**
+     * Restores the state saved by SaveResumeState, if there is one for the running title.
+     * @returns true if the emulation was resumed.
+     */
+    bool LoadResumeState();
+
     /// Self delete ncch
     bool SetSelfDelete(const std::string& file) {
         if (m_filepath == file) {
@@ -401,6 +459,15 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Runs the slice of every core at once, each on its own host thread
+    void RunCoresInParallel(s64 slice_length);
+
+    /// Records a rewind snapshot if the configured interval has passed since the last one
+    void CaptureRewindState();
+
+    /// Restores the newest rewind snapshot
+    void RewindState();
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -414,6 +481,15 @@ private:
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
 
+    /// Host threads running the cores other than the first one in multicore mode
+    std::vector<std::unique_ptr<Common::ThreadWorker>> core_threads;
+    std::recursive_mutex core_mutex;
+    std::atomic<bool> running_multicore{};
+
+    /// Ranges [start, end) whose invalidation is deferred by the open invalidation batches
+    std::vector<std::pair<u32, u32>> pending_cache_invalidations;
+    u32 cache_invalidation_batch_depth{};
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -440,6 +516,8 @@ private:
 
     /// Custom texture cache system
     std::unique_ptr<VideoCore::CustomTexManager> custom_tex_manager;
+    /// Indexing of the custom textures started during Init, finished by the end of Load
+    std::future<void> custom_textures_task;
 
     /// Image interface
     std::shared_ptr<Frontend::ImageInterface> registered_image_interface;
@@ -467,6 +545,15 @@ private:
     u32 save_state_slot = 0;
     std::chrono::steady_clock::time_point save_state_request_time{};
 
+    /// Compresses and writes save states captured in the background mode
+    mutable std::unique_ptr<Common::ThreadWorker> savestate_worker;
+
+    std::unique_ptr<RewindBuffer> rewind_buffer;
+    u64 rewind_last_ticks = 0;
+    bool rewind_requested = false;
+    /// Cleared while taking rewind snapshots, which store the emulated RAM themselves
+    bool serialize_guest_ram = true;
+
     ResultStatus status = ResultStatus::Success;
     std::string status_details = "";
     /// Saved variables for reset
@@ -498,6 +585,24 @@ private:
     void serialize(Archive& ar, const unsigned int file_version);
 };
 
+/// Batches the cache invalidations of the system for as long as it is alive
+class CacheInvalidationBatch {
+public:
+    explicit CacheInvalidationBatch(System& system_) : system{system_} {
+        system.BeginCacheInvalidationBatch();
+    }
+
+    ~CacheInvalidationBatch() {
+        system.EndCacheInvalidationBatch();
+    }
+
+    CacheInvalidationBatch(const CacheInvalidationBatch&) = delete;
+    CacheInvalidationBatch& operator=(const CacheInvalidationBatch&) = delete;
+
+private:
+    System& system;
+};
+
 [[nodiscard]] inline ARM_Interface& GetRunningCore() {
     return System::GetInstance().GetRunningCore();
 }
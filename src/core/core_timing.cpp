@@ -83,8 +83,8 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
         // of MAX_SLICE_LENGTH * 2 cycles into the future.
         cycles_into_future = std::max(static_cast<s64>(MAX_SLICE_LENGTH * 2), cycles_into_future);
 
-        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                   user_data, event_type});
+        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetSharedTicks() + cycles_into_future),
+                                   0, user_data, event_type});
     } else {
         s64 timeout = timer->GetTicks() + cycles_into_future;
         if (current_timer == timer) {
@@ -92,12 +92,12 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            timer->PushEvent(Event{timeout, timer->event_fifo_id++, user_data, event_type});
         } else {
-            timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                       user_data, event_type});
+            // The other core may be running, its ticks are only read through the shared copy
+            timer->ts_queue.Push(Event{
+                static_cast<s64>(timer->GetSharedTicks() + cycles_into_future), 0, user_data,
+                event_type});
         }
     }
 }
@@ -106,16 +106,9 @@ void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t u
     if (event_queue_locked) {
         return;
     }
+    const Timer::EventKey key{event_type, user_data};
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->CancelEvents(key);
     }
     // TODO:remove events from ts_queue
 }
@@ -125,14 +118,8 @@ void Timing::RemoveEvent(const TimingEventType* event_type) {
         return;
     }
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->CancelEvents(
+            [event_type](const auto& entry) { return entry.first.first == event_type; });
     }
     // TODO:remove events from ts_queue
 }
@@ -148,9 +135,9 @@ s64 Timing::GetTicks() const {
 s64 Timing::GetGlobalTicks() const {
     const auto& timer =
         std::max_element(timers.cbegin(), timers.cend(), [](const auto& a, const auto& b) {
-            return a->GetTicks() < b->GetTicks();
+            return a->GetSharedTicks() < b->GetSharedTicks();
         });
-    return (*timer)->GetTicks();
+    return (*timer)->GetSharedTicks();
 }
 
 std::chrono::microseconds Timing::GetGlobalTimeUs() const {
@@ -161,7 +148,9 @@ std::shared_ptr<Timing::Timer> Timing::GetTimer(std::size_t cpu_id) {
     return timers[cpu_id];
 }
 
-Timing::Timer::Timer(s64 base_ticks) : executed_ticks(base_ticks) {}
+Timing::Timer::Timer(s64 base_ticks) : executed_ticks(base_ticks) {
+    PublishTicks();
+}
 
 Timing::Timer::~Timer() {
     MoveEvents();
@@ -175,8 +164,17 @@ u64 Timing::Timer::GetTicks() const {
     return ticks;
 }
 
+u64 Timing::Timer::GetSharedTicks() const {
+    return shared_ticks.load(std::memory_order_relaxed);
+}
+
+void Timing::Timer::PublishTicks() {
+    shared_ticks.store(GetTicks(), std::memory_order_relaxed);
+}
+
 void Timing::Timer::AddTicks(u64 ticks) {
     downcount -= static_cast<u64>(ticks * cpu_clock_scale);
+    PublishTicks();
 }
 
 u64 Timing::Timer::GetIdleTicks() const {
@@ -192,14 +190,89 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 }
 
 void Timing::Timer::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
+    if (ts_queue.Empty()) {
+        return;
+    }
+    ts_queue.Drain([this](Event&& ev) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        PushEvent(std::move(ev));
+    });
+}
+
+void Timing::Timer::PushEvent(Event&& event) {
+    event_index.emplace(EventKey{event.type, event.user_data}, event.fifo_order);
+    event_queue.emplace_back(std::move(event));
+    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+}
+
+Timing::Event Timing::Timer::PopEvent() {
+    std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    Event event = std::move(event_queue.back());
+    event_queue.pop_back();
+
+    const auto [begin, end] = event_index.equal_range(EventKey{event.type, event.user_data});
+    const auto it = std::find_if(begin, end, [&event](const auto& entry) {
+        return entry.second == event.fifo_order;
+    });
+    if (it != end) {
+        event_index.erase(it);
+    }
+    return event;
+}
+
+void Timing::Timer::SkipCancelledEvents() {
+    while (!cancelled_events.empty() && !event_queue.empty() &&
+           cancelled_events.erase(event_queue.front().fifo_order) != 0) {
+        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.pop_back();
     }
 }
 
-s64 Timing::Timer::GetMaxSliceLength() const {
+void Timing::Timer::CancelEvents(const EventKey& key) {
+    const auto [begin, end] = event_index.equal_range(key);
+    if (begin == end) {
+        return;
+    }
+    for (auto it = begin; it != end; ++it) {
+        cancelled_events.insert(it->second);
+    }
+    event_index.erase(begin, end);
+    CompactCancelledEvents();
+}
+
+template <typename Pred>
+void Timing::Timer::CancelEvents(Pred&& pred) {
+    std::erase_if(event_index, [this, &pred](const auto& entry) {
+        if (!pred(entry)) {
+            return false;
+        }
+        cancelled_events.insert(entry.second);
+        return true;
+    });
+    CompactCancelledEvents();
+}
+
+void Timing::Timer::CompactCancelledEvents() {
+    // Events far in the future may stay queued for a long time, compact the queue once most of
+    // it is cancelled so that repeatedly cancelled timeouts can't grow it without bound.
+    if (cancelled_events.size() > 64 && cancelled_events.size() * 2 > event_queue.size()) {
+        PurgeCancelledEvents();
+    }
+}
+
+void Timing::Timer::PurgeCancelledEvents() {
+    if (cancelled_events.empty()) {
+        return;
+    }
+    std::erase_if(event_queue, [this](const Event& event) {
+        return cancelled_events.contains(event.fifo_order);
+    });
+    std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    cancelled_events.clear();
+}
+
+s64 Timing::Timer::GetMaxSliceLength() {
+    SkipCancelledEvents();
     const auto& next_event = event_queue.begin();
     if (next_event != event_queue.end()) {
         ASSERT(next_event->time - executed_ticks > 0);
@@ -218,11 +291,14 @@ void Timing::Timer::Advance() {
     downcount = 0;
 
     is_timer_sane = true;
+    PublishTicks();
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    while (true) {
+        SkipCancelledEvents();
+        if (event_queue.empty() || event_queue.front().time > executed_ticks) {
+            break;
+        }
+        Event evt = PopEvent();
         if (evt.type->callback != nullptr) {
             evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
         } else {
@@ -237,17 +313,20 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
     slice_length = max_slice_length;
 
     // Still events left (scheduled in the future)
+    SkipCancelledEvents();
     if (!event_queue.empty()) {
         slice_length = static_cast<int>(
             std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length;
+    PublishTicks();
 }
 
 void Timing::Timer::Idle() {
     idled_cycles += downcount;
     downcount = 0;
+    PublishTicks();
 }
 
 s64 Timing::Timer::GetDowncount() const {
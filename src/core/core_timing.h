@@ -17,11 +17,14 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <limits>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/vector.hpp>
@@ -188,7 +191,7 @@ public:
         Timer(s64 base_ticks = 0);
         ~Timer();
 
-        s64 GetMaxSliceLength() const;
+        s64 GetMaxSliceLength();
 
         void Advance();
 
@@ -199,6 +202,9 @@ public:
         u64 GetTicks() const;
         u64 GetIdleTicks() const;
 
+        /// Returns the ticks of the timer as of its last update, safe to call from other threads
+        u64 GetSharedTicks() const;
+
         void AddTicks(u64 ticks);
 
         s64 GetDowncount() const;
@@ -209,15 +215,55 @@ public:
 
     private:
         friend class Timing;
+
+        /// Makes the current ticks visible to GetSharedTicks
+        void PublishTicks();
+
+        /// Identifies the events cancelled by UnscheduleEvent()
+        using EventKey = std::pair<const TimingEventType*, std::uintptr_t>;
+
+        struct EventKeyHash {
+            std::size_t operator()(const EventKey& key) const noexcept {
+                return std::hash<const void*>{}(key.first) ^
+                       (std::hash<std::uintptr_t>{}(key.second) << 1);
+            }
+        };
+
+        /// Adds an event to the queue and to the index
+        void PushEvent(Event&& event);
+
+        /// Pops the front event of the queue, which must not be cancelled
+        Event PopEvent();
+
+        /// Discards the cancelled events at the front of the queue
+        void SkipCancelledEvents();
+
+        /// Marks the queued events with the given key as cancelled
+        void CancelEvents(const EventKey& key);
+
+        /// Marks the queued events matching the predicate on their index entry as cancelled
+        template <typename Pred>
+        void CancelEvents(Pred&& pred);
+
+        /// Drops every cancelled event from the queue once most of it is cancelled
+        void CompactCancelledEvents();
+
+        /// Drops every cancelled event from the queue
+        void PurgeCancelledEvents();
+
         // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
         // We don't use std::priority_queue because we need to be able to serialize, unserialize and
         // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
         // accommodated by the standard adaptor class.
         std::vector<Event> event_queue;
         u64 event_fifo_id = 0;
-        // the queue for storing the events from other threads threadsafe until they will be added
+        // The fifo_order of the queued events by key. Cancelling an event only marks its
+        // fifo_order as cancelled, the event is dropped when it reaches the front of the queue.
+        std::unordered_multimap<EventKey, u64, EventKeyHash> event_index;
+        std::unordered_set<u64> cancelled_events;
+        // the lock-free mailbox storing the events from other threads until they will be added
         // to the event_queue by the emu thread
-        Common::MPSCQueue<Event> ts_queue;
+        Common::MPSCMailbox<Event> ts_queue;
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
         // don't change slice_length and downcount.
@@ -231,6 +277,9 @@ public:
         s64 downcount = MAX_SLICE_LENGTH;
         s64 executed_ticks = 0;
         u64 idled_cycles = 0;
+        // GetTicks() as of the last change, read by the other cores and threads scheduling events
+        // on this timer while it runs
+        std::atomic<u64> shared_ticks = 0;
 
         // Stores a scaling for the internal clockspeed. Changing this number results in
         // under/overclocking the guest cpu
@@ -239,12 +288,22 @@ public:
         template <class Archive>
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
+            PurgeCancelledEvents();
             ar & event_queue;
+            if (Archive::is_loading::value) {
+                event_index.clear();
+                for (const Event& event : event_queue) {
+                    event_index.emplace(EventKey{event.type, event.user_data}, event.fifo_order);
+                }
+            }
             ar & event_fifo_id;
             ar & slice_length;
             ar & downcount;
             ar & executed_ticks;
             ar & idled_cycles;
+            if (Archive::is_loading::value) {
+                PublishTicks();
+            }
         }
         friend class boost::serialization::access;
     };
@@ -7,11 +7,16 @@
 
 namespace VideoDumper {
 
-VideoFrame::VideoFrame(std::size_t width_, std::size_t height_, u8* data_)
+VideoFrame::VideoFrame(std::size_t width_, std::size_t height_, const u8* data_)
     : width(width_), height(height_), stride(static_cast<u32>(width * 4)),
       data(data_, data_ + width * height * 4) {}
 
 Backend::~Backend() = default;
+
+void Backend::AddVideoFrame(std::size_t width, std::size_t height, const u8* data) {
+    AddVideoFrame(VideoFrame{width, height, data});
+}
+
 NullBackend::~NullBackend() = default;
 
 } // namespace VideoDumper
\ No newline at end of file
@@ -22,14 +22,30 @@ public:
     u32 stride;
     std::vector<u8> data;
 
-    VideoFrame(std::size_t width_ = 0, std::size_t height_ = 0, u8* data_ = nullptr);
+    VideoFrame(std::size_t width_ = 0, std::size_t height_ = 0, const u8* data_ = nullptr);
 };
 
 class Backend {
 public:
     virtual ~Backend();
     virtual bool StartDumping(const std::string& path, const Layout::FramebufferLayout& layout) = 0;
+    /**
+     * Starts encoding into a rolling in-memory buffer holding the last minute of gameplay, which
+     * is only written to disk by SaveReplay. Stopped with StopDumping like a normal dump.
+     */
+    virtual bool StartReplayBuffer(const Layout::FramebufferLayout& /*layout*/) {
+        return false;
+    }
+    /// Writes the contents of the replay buffer to a file.
+    virtual bool SaveReplay(const std::string& /*path*/) {
+        return false;
+    }
     virtual void AddVideoFrame(VideoFrame frame) = 0;
+    /**
+     * Adds a frame read from the given RGBA8 pixels. Backends may copy them into a recycled buffer
+     * instead of allocating a new frame each time.
+     */
+    virtual void AddVideoFrame(std::size_t width, std::size_t height, const u8* data);
     virtual void AddAudioFrame(AudioCore::StereoFrame16 frame) = 0;
     virtual void AddAudioSample(const std::array<s16, 2>& sample) = 0;
     virtual void StopDumping() = 0;
@@ -45,6 +61,8 @@ public:
         return false;
     }
     void AddVideoFrame(VideoFrame /*frame*/) override {}
+    void AddVideoFrame(std::size_t /*width*/, std::size_t /*height*/,
+                       const u8* /*data*/) override {}
     void AddAudioFrame(AudioCore::StereoFrame16 /*frame*/) override {}
     void AddAudioSample(const std::array<s16, 2>& /*sample*/) override {}
     void StopDumping() override {}
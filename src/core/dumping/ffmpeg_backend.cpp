@@ -39,6 +39,55 @@ AVDictionary* ToAVDictionary(const std::string& serialized) {
     return result;
 }
 
+void FFmpegReplayBuffer::Push(const AVPacket& packet, bool is_video, AVRational time_base) {
+    auto entry = std::make_shared<Packet>(Packet{
+        .data{packet.data, packet.data + packet.size},
+        .pts = packet.pts,
+        .dts = packet.dts,
+        .duration = packet.duration,
+        .flags = packet.flags,
+        .is_video = is_video,
+    });
+    const bool is_keyframe = is_video && (packet.flags & AV_PKT_FLAG_KEY);
+
+    std::scoped_lock lock{mutex};
+    if (is_video) {
+        newest_time = packet.dts * av_q2d(time_base);
+    }
+    if (is_keyframe) {
+        groups.push_back({.start_time = newest_time, .packets{}});
+    } else if (groups.empty()) {
+        // A replay has to start with a keyframe, anything before the first one is useless.
+        return;
+    }
+    buffered_bytes += entry->data.size();
+    groups.back().packets.push_back(std::move(entry));
+
+    // Drop the oldest group while the remaining ones still cover the whole replay duration.
+    const auto group_bytes = [](const PacketGroup& group) {
+        std::size_t bytes = 0;
+        for (const auto& buffered : group.packets) {
+            bytes += buffered->data.size();
+        }
+        return bytes;
+    };
+    while (groups.size() > 1 && (newest_time - groups[1].start_time >= ReplayDuration ||
+                                 buffered_bytes > MaxBufferedBytes)) {
+        buffered_bytes -= group_bytes(groups.front());
+        groups.pop_front();
+    }
+}
+
+std::vector<std::shared_ptr<const FFmpegReplayBuffer::Packet>> FFmpegReplayBuffer::Snapshot()
+    const {
+    std::scoped_lock lock{mutex};
+    std::vector<std::shared_ptr<const Packet>> packets;
+    for (const auto& group : groups) {
+        packets.insert(packets.end(), group.packets.begin(), group.packets.end());
+    }
+    return packets;
+}
+
 FFmpegStream::~FFmpegStream() {
     Free();
 }
@@ -48,10 +97,21 @@ bool FFmpegStream::Init(FFmpegMuxer& muxer) {
 
     format_context = muxer.format_context.get();
     format_context_mutex = &muxer.format_context_mutex;
+    replay_buffer = muxer.replay_buffer.get();
 
     return true;
 }
 
+AVStream* FFmpegStream::CreateStream(AVFormatContext* context) const {
+    AVStream* new_stream = FFmpeg::avformat_new_stream(context, nullptr);
+    if (!new_stream ||
+        FFmpeg::avcodec_parameters_from_context(new_stream->codecpar, codec_context.get()) < 0) {
+        return nullptr;
+    }
+    new_stream->time_base = codec_context->time_base;
+    return new_stream;
+}
+
 void FFmpegStream::Free() {
     codec_context.reset();
 }
@@ -61,6 +121,11 @@ void FFmpegStream::Flush() {
 }
 
 void FFmpegStream::WritePacket(AVPacket* packet) {
+    if (replay_buffer) {
+        replay_buffer->Push(*packet, codec_context->codec_type == AVMEDIA_TYPE_VIDEO,
+                            codec_context->time_base);
+        return;
+    }
     FFmpeg::av_packet_rescale_ts(packet, codec_context->time_base, stream->time_base);
     packet->stream_index = stream->index;
     {
@@ -671,10 +736,54 @@ bool FFmpegMuxer::Init(const std::string& path, const Layout::FramebufferLayout&
         return false;
     }
 
+    if (!InitContext(output_format, path.c_str(), layout)) {
+        return false;
+    }
+
+    AVDictionary* options = ToAVDictionary(Settings::values.format_options);
+    // Open video file
+    if (FFmpeg::avio_open(&format_context->pb, path.c_str(), AVIO_FLAG_WRITE) < 0 ||
+        FFmpeg::avformat_write_header(format_context.get(), &options)) {
+
+        LOG_ERROR(Render, "Could not open {}", path);
+        return false;
+    }
+    if (FFmpeg::av_dict_count(options) != 0) { // Successfully set options are removed from the dict
+        char* buf = nullptr;
+        FFmpeg::av_dict_get_string(options, &buf, ':', ';');
+        LOG_WARNING(Render, "Format options not found: {}", buf);
+    }
+
+    LOG_INFO(Render, "Dumping frames to {} ({}x{})", path, layout.width, layout.height);
+    return true;
+}
+
+bool FFmpegMuxer::InitReplay(const Layout::FramebufferLayout& layout) {
+    InitializeFFmpegLibraries();
+
+    // Packets are kept in memory, the format is only needed to pick matching encoder settings.
+    const auto format = Settings::values.output_format;
+    auto* output_format = FFmpeg::av_guess_format(format.c_str(), nullptr, nullptr);
+    if (!output_format) {
+        LOG_ERROR(Render, "Could not get format {}", format);
+        return false;
+    }
+
+    replay_buffer = std::make_unique<FFmpegReplayBuffer>();
+    if (!InitContext(output_format, nullptr, layout)) {
+        return false;
+    }
+
+    LOG_INFO(Render, "Buffering frames for replays ({}x{})", layout.width, layout.height);
+    return true;
+}
+
+bool FFmpegMuxer::InitContext(const AVOutputFormat* output_format, const char* path,
+                              const Layout::FramebufferLayout& layout) {
     // Initialize format context
     auto* format_context_raw = format_context.get();
     if (FFmpeg::avformat_alloc_output_context2(&format_context_raw, output_format, nullptr,
-                                               path.c_str()) < 0) {
+                                               path) < 0) {
         LOG_ERROR(Render, "Could not allocate output context");
         return false;
     }
@@ -685,21 +794,80 @@ bool FFmpegMuxer::Init(const std::string& path, const Layout::FramebufferLayout&
     if (!audio_stream.Init(*this))
         return false;
 
-    AVDictionary* options = ToAVDictionary(Settings::values.format_options);
-    // Open video file
-    if (FFmpeg::avio_open(&format_context->pb, path.c_str(), AVIO_FLAG_WRITE) < 0 ||
-        FFmpeg::avformat_write_header(format_context.get(), &options)) {
+    return true;
+}
+
+bool FFmpegMuxer::SaveReplay(const std::string& path) {
+    if (!replay_buffer) {
+        return false;
+    }
+    const auto packets = replay_buffer->Snapshot();
+    if (packets.empty()) {
+        LOG_ERROR(Render, "Replay buffer is empty");
+        return false;
+    }
+    if (!FileUtil::CreateFullPath(path)) {
+        return false;
+    }
+
+    AVFormatContext* output_raw = nullptr;
+    if (FFmpeg::avformat_alloc_output_context2(&output_raw, format_context->oformat, nullptr,
+                                               path.c_str()) < 0) {
+        LOG_ERROR(Render, "Could not allocate output context");
+        return false;
+    }
+    std::unique_ptr<AVFormatContext, AVFormatContextDeleter> output{output_raw};
 
+    AVStream* output_video = video_stream.CreateStream(output.get());
+    AVStream* output_audio = audio_stream.CreateStream(output.get());
+    if (!output_video || !output_audio) {
+        LOG_ERROR(Render, "Could not create replay streams");
+        return false;
+    }
+
+    AVDictionary* options = ToAVDictionary(Settings::values.format_options);
+    if (FFmpeg::avio_open(&output->pb, path.c_str(), AVIO_FLAG_WRITE) < 0 ||
+        FFmpeg::avformat_write_header(output.get(), &options) < 0) {
         LOG_ERROR(Render, "Could not open {}", path);
         return false;
     }
-    if (FFmpeg::av_dict_count(options) != 0) { // Successfully set options are removed from the dict
-        char* buf = nullptr;
-        FFmpeg::av_dict_get_string(options, &buf, ':', ';');
-        LOG_WARNING(Render, "Format options not found: {}", buf);
+
+    // Shift both streams so that the replay starts at zero. The first packet is always the
+    // keyframe the replay begins with.
+    const AVRational video_time_base = video_stream.TimeBase();
+    const AVRational audio_time_base = audio_stream.TimeBase();
+    const double start_time = packets.front()->dts * av_q2d(video_time_base);
+    const s64 video_offset = packets.front()->dts;
+    const s64 audio_offset = static_cast<s64>(start_time / av_q2d(audio_time_base));
+
+    AVPacket* packet = FFmpeg::av_packet_alloc();
+    SCOPE_EXIT({ FFmpeg::av_packet_free(&packet); });
+    for (const auto& buffered : packets) {
+        const s64 offset = buffered->is_video ? video_offset : audio_offset;
+        if (buffered->dts < offset) {
+            continue;
+        }
+        packet->data = const_cast<u8*>(buffered->data.data());
+        packet->size = static_cast<int>(buffered->data.size());
+        packet->pts = buffered->pts - offset;
+        packet->dts = buffered->dts - offset;
+        packet->duration = buffered->duration;
+        packet->flags = buffered->flags;
+
+        AVStream* output_stream = buffered->is_video ? output_video : output_audio;
+        packet->stream_index = output_stream->index;
+        FFmpeg::av_packet_rescale_ts(packet,
+                                     buffered->is_video ? video_time_base : audio_time_base,
+                                     output_stream->time_base);
+        if (FFmpeg::av_interleaved_write_frame(output.get(), packet) < 0) {
+            LOG_ERROR(Render, "Could not write replay packet");
+            return false;
+        }
     }
+    FFmpeg::av_interleaved_write_frame(output.get(), nullptr);
+    FFmpeg::av_write_trailer(output.get());
 
-    LOG_INFO(Render, "Dumping frames to {} ({}x{})", path, layout.width, layout.height);
+    LOG_INFO(Render, "Saved replay of {} packets to {}", packets.size(), path);
     return true;
 }
 
@@ -707,6 +875,7 @@ void FFmpegMuxer::Free() {
     video_stream.Free();
     audio_stream.Free();
     format_context.reset();
+    replay_buffer.reset();
 }
 
 void FFmpegMuxer::ProcessVideoFrame(VideoFrame& frame) {
@@ -752,6 +921,29 @@ bool FFmpegBackend::StartDumping(const std::string& path, const Layout::Framebuf
         return false;
     }
 
+    return StartProcessing(layout);
+}
+
+bool FFmpegBackend::StartReplayBuffer(const Layout::FramebufferLayout& layout) {
+    InitializeFFmpegLibraries();
+
+    if (!ffmpeg.InitReplay(layout)) {
+        ffmpeg.Free();
+        return false;
+    }
+
+    return StartProcessing(layout);
+}
+
+bool FFmpegBackend::SaveReplay(const std::string& path) {
+    std::scoped_lock lock{replay_mutex};
+    if (!IsDumping() || !ffmpeg.IsReplay()) {
+        return false;
+    }
+    return ffmpeg.SaveReplay(path);
+}
+
+bool FFmpegBackend::StartProcessing(const Layout::FramebufferLayout& layout) {
     video_layout = layout;
 
     if (video_processing_thread.joinable()) {
@@ -808,6 +1000,17 @@ void FFmpegBackend::AddVideoFrame(VideoFrame frame) {
     event2.Set();
 }
 
+void FFmpegBackend::AddVideoFrame(std::size_t width, std::size_t height, const u8* data) {
+    event1.Wait();
+    // The buffers keep their allocation between frames, so this is only a copy.
+    auto& frame = video_frame_buffers[next_buffer];
+    frame.width = width;
+    frame.height = height;
+    frame.stride = static_cast<u32>(width * 4);
+    frame.data.assign(data, data + width * height * 4);
+    event2.Set();
+}
+
 void FFmpegBackend::AddAudioFrame(AudioCore::StereoFrame16 frame) {
     std::array<VariableAudioFrame, 2> refactored_frame;
     for (auto& channel : refactored_frame) {
@@ -852,8 +1055,13 @@ Layout::FramebufferLayout FFmpegBackend::GetLayout() const {
 void FFmpegBackend::EndDumping() {
     LOG_INFO(Render, "Ending frame dumping");
 
-    ffmpeg.WriteTrailer();
-    ffmpeg.Free();
+    {
+        std::scoped_lock lock{replay_mutex};
+        if (!ffmpeg.IsReplay()) {
+            ffmpeg.WriteTrailer();
+        }
+        ffmpeg.Free();
+    }
     processing_ended.Set();
 }
 
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -28,6 +29,45 @@ using VariableAudioFrame = std::vector<s16>;
 
 class FFmpegMuxer;
 
+/**
+ * Rolling in-memory buffer of encoded packets, used to save instant replays.
+ * Packets are grouped by video keyframe and only whole groups are dropped, so a replay always
+ * starts with a keyframe. Memory use is bounded by both duration and size.
+ */
+class FFmpegReplayBuffer {
+public:
+    struct Packet {
+        std::vector<u8> data;
+        s64 pts;
+        s64 dts;
+        s64 duration;
+        int flags;
+        bool is_video;
+    };
+
+    /// Adds a packet, with timestamps in the time base of the codec that produced it.
+    void Push(const AVPacket& packet, bool is_video, AVRational time_base);
+
+    /// Returns the buffered packets in the order they were added.
+    std::vector<std::shared_ptr<const Packet>> Snapshot() const;
+
+private:
+    struct PacketGroup {
+        double start_time;
+        std::vector<std::shared_ptr<const Packet>> packets;
+    };
+
+    /// How much gameplay a replay covers
+    static constexpr double ReplayDuration = 60.0;
+    /// Upper bound on the memory held by the buffer
+    static constexpr std::size_t MaxBufferedBytes = 256 * 1024 * 1024;
+
+    mutable std::mutex mutex;
+    std::deque<PacketGroup> groups;
+    std::size_t buffered_bytes = 0;
+    double newest_time = 0.0;
+};
+
 /**
  * Wrapper around FFmpeg AVCodecContext + AVStream.
  * Rescales/Resamples, encodes and writes a frame.
@@ -38,6 +78,13 @@ public:
     void Free();
     void Flush();
 
+    /// Adds a stream using this encoder's parameters to another output context.
+    AVStream* CreateStream(AVFormatContext* context) const;
+
+    AVRational TimeBase() const {
+        return codec_context->time_base;
+    }
+
 protected:
     ~FFmpegStream();
 
@@ -64,6 +111,7 @@ protected:
 
     AVFormatContext* format_context{};
     std::mutex* format_context_mutex{};
+    FFmpegReplayBuffer* replay_buffer{};
     std::unique_ptr<AVCodecContext, AVCodecContextDeleter> codec_context{};
     AVStream* stream{};
 };
@@ -156,6 +204,13 @@ public:
     ~FFmpegMuxer();
 
     bool Init(const std::string& path, const Layout::FramebufferLayout& layout);
+    /// Starts encoding into a rolling replay buffer instead of a file.
+    bool InitReplay(const Layout::FramebufferLayout& layout);
+    /// Writes the current contents of the replay buffer to a file.
+    bool SaveReplay(const std::string& path);
+    bool IsReplay() const {
+        return replay_buffer != nullptr;
+    }
     void Free();
     void ProcessVideoFrame(VideoFrame& frame);
     void ProcessAudioFrame(const VariableAudioFrame& channel0, const VariableAudioFrame& channel1);
@@ -171,10 +226,14 @@ private:
         }
     };
 
+    bool InitContext(const AVOutputFormat* format, const char* path,
+                     const Layout::FramebufferLayout& layout);
+
     FFmpegAudioStream audio_stream{};
     FFmpegVideoStream video_stream{};
     std::unique_ptr<AVFormatContext, AVFormatContextDeleter> format_context{};
     std::mutex format_context_mutex;
+    std::unique_ptr<FFmpegReplayBuffer> replay_buffer{};
 
     friend class FFmpegStream;
 };
@@ -188,7 +247,10 @@ public:
     FFmpegBackend(VideoCore::RendererBase& renderer);
     ~FFmpegBackend() override;
     bool StartDumping(const std::string& path, const Layout::FramebufferLayout& layout) override;
+    bool StartReplayBuffer(const Layout::FramebufferLayout& layout) override;
+    bool SaveReplay(const std::string& path) override;
     void AddVideoFrame(VideoFrame frame) override;
+    void AddVideoFrame(std::size_t width, std::size_t height, const u8* data) override;
     void AddAudioFrame(AudioCore::StereoFrame16 frame) override;
     void AddAudioSample(const std::array<s16, 2>& sample) override;
     void StopDumping() override;
@@ -196,12 +258,15 @@ public:
     Layout::FramebufferLayout GetLayout() const override;
 
 private:
+    bool StartProcessing(const Layout::FramebufferLayout& layout);
     void EndDumping();
 
     VideoCore::RendererBase& renderer;
     std::atomic_bool is_dumping = false; ///< Whether the backend is currently dumping
 
     FFmpegMuxer ffmpeg{};
+    /// Keeps the muxer alive while a replay is being saved
+    std::mutex replay_mutex;
 
     Layout::FramebufferLayout video_layout;
     std::array<VideoFrame, 2> video_frame_buffers;
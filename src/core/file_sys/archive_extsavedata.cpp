@@ -112,9 +112,9 @@ public:
                                                      u32 attributes) override {
         LOG_DEBUG(Service_FS, "called path={} mode={:01X}", path.DebugStr(), mode.hex);
 
-        const PathParser path_parser(path);
+        const auto resolution = path_cache.Resolve(path, mount_point);
 
-        if (!path_parser.IsValid()) {
+        if (!resolution.is_valid) {
             LOG_ERROR(Service_FS, "Invalid path {}", path.DebugStr());
             return ResultInvalidPath;
         }
@@ -129,9 +129,9 @@ public:
             return ResultUnsupportedOpenFlags;
         }
 
-        const auto full_path = path_parser.BuildHostPath(mount_point);
+        const auto& full_path = resolution.host_path;
 
-        switch (path_parser.GetHostStatus(mount_point)) {
+        switch (resolution.status) {
         case PathParser::InvalidMountPoint:
             LOG_CRITICAL(Service_FS, "(unreachable) Invalid mount point {}", mount_point);
             return ResultFileNotFound;
@@ -151,6 +151,11 @@ public:
 
         FileUtil::IOFile file(full_path, "r+b");
         if (!file.IsOpen()) {
+            if (resolution.cached) {
+                // The file was removed from outside of the archive, check the path again
+                path_cache.Clear();
+                return OpenFile(path, mode, attributes);
+            }
             LOG_CRITICAL(Service_FS, "(unreachable) Unknown error opening {}", full_path);
             return ResultFileNotFound;
         }
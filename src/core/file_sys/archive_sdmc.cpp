@@ -58,9 +58,9 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
                                                                   const Mode& mode) const {
     LOG_DEBUG(Service_FS, "called path={} mode={:01X}", path.DebugStr(), mode.hex);
 
-    const PathParser path_parser(path);
+    const auto resolution = path_cache.Resolve(path, mount_point);
 
-    if (!path_parser.IsValid()) {
+    if (!resolution.is_valid) {
         LOG_ERROR(Service_FS, "Invalid path {}", path.DebugStr());
         return ResultInvalidPath;
     }
@@ -75,9 +75,9 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
         return ResultInvalidOpenFlags;
     }
 
-    const auto full_path = path_parser.BuildHostPath(mount_point);
+    const auto& full_path = resolution.host_path;
 
-    switch (path_parser.GetHostStatus(mount_point)) {
+    switch (resolution.status) {
     case PathParser::InvalidMountPoint:
         LOG_CRITICAL(Service_FS, "(unreachable) Invalid mount point {}", mount_point);
         return ResultNotFound;
@@ -104,6 +104,11 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
 
     FileUtil::IOFile file(full_path, mode.write_flag ? "r+b" : "rb");
     if (!file.IsOpen()) {
+        if (resolution.cached) {
+            // The file was removed from outside of the archive, check the path again
+            path_cache.Clear();
+            return OpenFileBase(path, mode);
+        }
         LOG_CRITICAL(Service_FS, "Error opening {}: {}", full_path, Common::GetLastErrorMsg());
         return ResultNotFound;
     }
@@ -113,6 +118,8 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
 }
 
 Result SDMCArchive::DeleteFile(const Path& path) const {
+    path_cache.Clear();
+
     const PathParser path_parser(path);
 
     if (!path_parser.IsValid()) {
@@ -147,6 +154,8 @@ Result SDMCArchive::DeleteFile(const Path& path) const {
 }
 
 Result SDMCArchive::RenameFile(const Path& src_path, const Path& dest_path) const {
+    path_cache.Clear();
+
     const PathParser path_parser_src(src_path);
 
     // TODO: Verify these return codes with HW
@@ -214,15 +223,19 @@ static Result DeleteDirectoryHelper(const Path& path, const std::string& mount_p
 }
 
 Result SDMCArchive::DeleteDirectory(const Path& path) const {
+    path_cache.Clear();
     return DeleteDirectoryHelper(path, mount_point, FileUtil::DeleteDir);
 }
 
 Result SDMCArchive::DeleteDirectoryRecursively(const Path& path) const {
+    path_cache.Clear();
     return DeleteDirectoryHelper(
         path, mount_point, [](const std::string& p) { return FileUtil::DeleteDirRecursively(p); });
 }
 
 Result SDMCArchive::CreateFile(const FileSys::Path& path, u64 size, u32 attributes) const {
+    path_cache.Clear();
+
     const PathParser path_parser(path);
 
     if (!path_parser.IsValid()) {
@@ -268,6 +281,8 @@ Result SDMCArchive::CreateFile(const FileSys::Path& path, u64 size, u32 attribut
 }
 
 Result SDMCArchive::CreateDirectory(const Path& path, u32 attributes) const {
+    path_cache.Clear();
+
     const PathParser path_parser(path);
 
     if (!path_parser.IsValid()) {
@@ -303,6 +318,8 @@ Result SDMCArchive::CreateDirectory(const Path& path, u32 attributes) const {
 }
 
 Result SDMCArchive::RenameDirectory(const Path& src_path, const Path& dest_path) const {
+    path_cache.Clear();
+
     const PathParser path_parser_src(src_path);
 
     // TODO: Verify these return codes with HW
@@ -332,16 +349,16 @@ Result SDMCArchive::RenameDirectory(const Path& src_path, const Path& dest_path)
 }
 
 ResultVal<std::unique_ptr<DirectoryBackend>> SDMCArchive::OpenDirectory(const Path& path) {
-    const PathParser path_parser(path);
+    const auto resolution = path_cache.Resolve(path, mount_point);
 
-    if (!path_parser.IsValid()) {
+    if (!resolution.is_valid) {
         LOG_ERROR(Service_FS, "Invalid path {}", path.DebugStr());
         return ResultInvalidPath;
     }
 
-    const auto full_path = path_parser.BuildHostPath(mount_point);
+    const auto& full_path = resolution.host_path;
 
-    switch (path_parser.GetHostStatus(mount_point)) {
+    switch (resolution.status) {
     case PathParser::InvalidMountPoint:
         LOG_CRITICAL(Service_FS, "(unreachable) Invalid mount point {}", mount_point);
         return ResultNotFound;
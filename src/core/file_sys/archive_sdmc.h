@@ -10,6 +10,7 @@
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/string.hpp>
 #include "core/file_sys/archive_backend.h"
+#include "core/file_sys/path_parser.h"
 #include "core/hle/result.h"
 
 namespace FileSys {
@@ -42,6 +43,7 @@ public:
 protected:
     ResultVal<std::unique_ptr<FileBackend>> OpenFileBase(const Path& path, const Mode& mode) const;
     std::string mount_point;
+    mutable PathCache path_cache;
 
     SDMCArchive() = default;
     template <class Archive>
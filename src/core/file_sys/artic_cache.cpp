@@ -16,8 +16,10 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
     // Skip cache if the read is too big
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         if (segments[0].second < big_cache_skip) {
-            std::unique_lock big_read_guard(big_cache_mutex);
-            auto big_cache_entry = big_cache.request(std::make_pair(offset, length));
+            const auto key = std::make_pair(offset, length);
+            auto& shard = big_cache.GetShard(key);
+            std::scoped_lock big_read_guard(shard.mutex);
+            auto big_cache_entry = shard.cache.request(key);
             if (!big_cache_entry.first) {
                 LOG_TRACE(Service_FS, "ArticCache BMISS: offset={}, length={}", offset, length);
                 big_cache_entry.second.clear();
@@ -25,8 +27,10 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
                 auto res =
                     ReadFromArtic(file_handle, reinterpret_cast<u8*>(big_cache_entry.second.data()),
                                   length, offset);
-                if (res.Failed())
+                if (res.Failed()) {
+                    shard.cache.erase(key);
                     return res;
+                }
                 length = res.Unwrap();
             } else {
                 LOG_TRACE(Service_FS, "ArticCache BHIT: offset={}, length={}", offset, length);
@@ -44,8 +48,10 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
                     auto res = ReadFromArtic(
                         file_handle, reinterpret_cast<u8*>(very_big_cache_entry.second.data()),
                         length, offset);
-                    if (res.Failed())
+                    if (res.Failed()) {
+                        very_big_cache.erase(std::make_pair(offset, length));
                         return res;
+                    }
                     length = res.Unwrap();
                 } else {
                     LOG_TRACE(Service_FS, "ArticCache VBHIT: offset={}, length={}", offset, length);
@@ -70,14 +76,32 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
         std::size_t page = OffsetToPage(seg.first);
         // Check if segment is in cache
         auto cache_entry = cache.request(page);
+        std::vector<u8> read_ahead;
         if (!cache_entry.first) {
-            // If not found, read from artic and cache the data
-            auto res = ReadFromArtic(file_handle, cache_entry.second.data(), read_size, page);
-            if (res.Failed())
-                return res;
-            read_size = res.Unwrap();
-            LOG_TRACE(Service_FS, "ArticCache MISS: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
+            // If not found, read from artic and cache the data. Sequential misses fetch the next
+            // pages too, with a window that grows as long as the pattern holds.
+            if (page == next_sequential_page) {
+                read_ahead_pages = std::min(read_ahead_pages * 2, max_read_ahead_pages);
+            } else {
+                read_ahead_pages = 1;
+            }
+            if (read_ahead_pages > 1) {
+                read_ahead.resize(read_ahead_pages * cache_line_size);
+                auto res = ReadFromArtic(file_handle, read_ahead.data(), read_ahead.size(), page);
+                if (res.Failed())
+                    return res;
+                read_ahead.resize(res.Unwrap());
+                read_size = std::min(read_ahead.size(), cache_line_size);
+                std::memcpy(cache_entry.second.data(), read_ahead.data(), read_size);
+            } else {
+                auto res = ReadFromArtic(file_handle, cache_entry.second.data(), read_size, page);
+                if (res.Failed())
+                    return res;
+                read_size = res.Unwrap();
+            }
+            next_sequential_page = page + read_ahead_pages * cache_line_size;
+            LOG_TRACE(Service_FS, "ArticCache MISS: page={}, length={}, into={}, ahead={}", page,
+                      seg.second, (seg.first - page), read_ahead_pages - 1);
         } else {
             LOG_TRACE(Service_FS, "ArticCache HIT: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
@@ -89,6 +113,16 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
         std::memcpy(buffer + read_progress, cache_entry.second.data() + (seg.first - page),
                     copy_amount);
         read_progress += copy_amount;
+
+        // Filling the following lines may evict the current one, so only do it once it's used.
+        // Partial pages at the end of the file are left out, hits assume whole lines.
+        for (std::size_t i = 1; (i + 1) * cache_line_size <= read_ahead.size(); i++) {
+            auto ahead_entry = cache.request(page + i * cache_line_size);
+            if (!ahead_entry.first) {
+                std::memcpy(ahead_entry.second.data(), read_ahead.data() + i * cache_line_size,
+                            cache_line_size);
+            }
+        }
     }
     return read_progress;
 }
@@ -108,10 +142,12 @@ bool ArticCache::CacheReady(std::size_t file_offset, std::size_t length) {
 }
 
 void ArticCache::Clear() {
-    std::unique_lock l1(cache_mutex), l2(big_cache_mutex), l3(very_big_cache_mutex);
+    std::unique_lock l1(cache_mutex), l2(very_big_cache_mutex);
     cache.clear();
     big_cache.clear();
     very_big_cache.clear();
+    next_sequential_page = std::numeric_limits<std::size_t>::max();
+    read_ahead_pages = 1;
     data_size = std::nullopt;
 }
 
@@ -182,33 +218,44 @@ ResultVal<size_t> ArticCache::GetSize(s32 file_handle) {
 
 ResultVal<size_t> ArticCache::ReadFromArtic(s32 file_handle, u8* buffer, size_t len,
                                             size_t offset) {
+    const size_t chunk_size = client->GetServerRequestMaxSize() - 0x100;
     size_t read_amount = 0;
     while (read_amount != len) {
-        size_t to_read =
-            std::min<size_t>(client->GetServerRequestMaxSize() - 0x100, len - read_amount);
+        // Queue up several chunks at once so that they are pipelined by the client, but not so
+        // many that all of their responses have to be held in memory at the same time.
+        std::vector<Network::ArticBase::Client::Request> requests;
+        std::vector<size_t> request_sizes;
+        for (size_t pos = read_amount; pos < len && requests.size() < max_batched_reads;
+             pos += chunk_size) {
+            const size_t to_read = std::min<size_t>(chunk_size, len - pos);
+            auto& req = requests.emplace_back(client->NewRequest("FSFILE_Read"));
+            req.AddParameterS32(file_handle);
+            req.AddParameterS64(static_cast<s64>(offset + pos));
+            req.AddParameterS32(static_cast<s32>(to_read));
+            request_sizes.push_back(to_read);
+        }
 
-        auto req = client->NewRequest("FSFILE_Read");
-        req.AddParameterS32(file_handle);
-        req.AddParameterS64(static_cast<s64>(offset + read_amount));
-        req.AddParameterS32(static_cast<s32>(to_read));
-        auto resp = client->Send(req);
-        if (!resp.has_value() || !resp->Succeeded())
-            return Result(-1);
+        auto responses = client->SendBatch(requests);
+        for (size_t i = 0; i < responses.size(); i++) {
+            auto& resp = responses[i];
+            if (!resp.has_value() || !resp->Succeeded())
+                return Result(-1);
 
-        auto res = Result(static_cast<u32>(resp->GetMethodResult()));
-        if (res.IsError())
-            return res;
+            auto res = Result(static_cast<u32>(resp->GetMethodResult()));
+            if (res.IsError())
+                return res;
 
-        auto read_buff = resp->GetResponseBuffer(0);
-        size_t actually_read = 0;
-        if (read_buff.has_value()) {
-            actually_read = read_buff->second;
-            memcpy(buffer + read_amount, read_buff->first, actually_read);
-        }
+            auto read_buff = resp->GetResponseBuffer(0);
+            size_t actually_read = 0;
+            if (read_buff.has_value()) {
+                actually_read = std::min(read_buff->second, request_sizes[i]);
+                memcpy(buffer + read_amount, read_buff->first, actually_read);
+            }
 
-        read_amount += actually_read;
-        if (actually_read != to_read)
-            break;
+            read_amount += actually_read;
+            if (actually_read != request_sizes[i])
+                return read_amount;
+        }
     }
     return read_amount;
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <limits>
 #include <shared_mutex>
 #include "vector"
 
@@ -53,12 +54,22 @@ private:
 
     static constexpr std::size_t big_cache_skip = 1 * 1024 * 1024;
     static constexpr std::size_t big_cache_lines = 1024;
+    static constexpr std::size_t big_cache_shards = 8;
 
     static constexpr std::size_t very_big_cache_skip = 10 * 1024 * 1024;
     static constexpr std::size_t very_big_cache_lines = 24;
 
+    // Cache misses that continue the previous one read up to this many lines at once.
+    static constexpr std::size_t max_read_ahead_pages = 16;
+    // Number of read requests handed to the client at once to be pipelined.
+    static constexpr std::size_t max_batched_reads =
+        4 * Network::ArticBase::Client::MaxPipelinedRequests;
+
     Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
     std::shared_mutex cache_mutex;
+    // Page right after the last one fetched, guarded by cache_mutex.
+    std::size_t next_sequential_page = std::numeric_limits<std::size_t>::max();
+    std::size_t read_ahead_pages = 1;
 
     struct NoInitChar {
         u8 value;
@@ -67,10 +78,10 @@ private:
             static_assert(sizeof *this == sizeof value, "invalid size");
         }
     };
-    Common::StaticLRUCache<std::pair<std::size_t, std::size_t>, std::vector<NoInitChar>,
-                           big_cache_lines>
+    // Sharded so that reads of different big lines can be fetched from the client in parallel.
+    Common::ShardedStaticLRUCache<std::pair<std::size_t, std::size_t>, std::vector<NoInitChar>,
+                                  big_cache_lines, big_cache_shards>
         big_cache;
-    std::shared_mutex big_cache_mutex;
     Common::StaticLRUCache<std::pair<std::size_t, std::size_t>, std::vector<NoInitChar>,
                            very_big_cache_lines>
         very_big_cache;
@@ -0,0 +1,127 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/decompressed_code_cache.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+namespace {
+
+struct CopyHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le program_id;
+    std::array<u8, 0x20> section_hash;
+    u64_le section_size;
+    u64_le code_size;
+    u64_le code_hash;
+};
+
+constexpr u32 CopyMagic = Loader::MakeMagic('D', 'C', 'O', 'D');
+constexpr u32 CopyVersion = 1;
+
+/// Largest code the copies are made of, well above the size of the biggest titles.
+constexpr u64 MaxCodeSize = 64 * 1024 * 1024;
+
+} // Anonymous namespace
+
+DecompressedCodeCache::DecompressedCodeCache(u64 program_id,
+                                             const std::array<u8, 0x20>& section_hash,
+                                             u64 section_size)
+    : program_id(program_id), section_hash(section_hash), section_size(section_size) {
+    u64 short_hash;
+    std::memcpy(&short_hash, section_hash.data(), sizeof(short_hash));
+
+    directory = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "code" DIR_SEP;
+    path = fmt::format("{}{:016X}_{:016X}.code", directory, program_id, short_hash);
+}
+
+bool DecompressedCodeCache::Load(std::vector<u8>& code) const {
+    FileUtil::IOFile file(path, "rb");
+    CopyHeader header;
+    if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    if (header.magic != CopyMagic || header.version != CopyVersion ||
+        header.program_id != program_id || header.section_hash != section_hash ||
+        header.section_size != section_size || header.code_size > MaxCodeSize ||
+        file.GetSize() != sizeof(header) + header.code_size) {
+        LOG_INFO(Service_FS, "Decompressed code copy {} is out of date", path);
+        return false;
+    }
+
+    std::vector<u8> data(header.code_size);
+    if (file.ReadBytes(data.data(), data.size()) != data.size() ||
+        Common::ComputeHash64(data.data(), data.size()) != header.code_hash) {
+        LOG_WARNING(Service_FS, "Decompressed code copy {} is corrupted", path);
+        return false;
+    }
+    code = std::move(data);
+    return true;
+}
+
+void DecompressedCodeCache::Store(std::span<const u8> code) const {
+    if (code.size() > MaxCodeSize) {
+        return;
+    }
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Service_FS, "Could not create {}", directory);
+        return;
+    }
+
+    // The copy is written under another name first, so that an interrupted one is never opened.
+    // The name is unique, as instances running the same title may write the copy concurrently.
+    const std::string temp_path = fmt::format("{}.{:08x}.tmp", path, std::random_device{}());
+    bool success = false;
+    {
+        const CopyHeader header{
+            .magic = CopyMagic,
+            .version = CopyVersion,
+            .program_id = program_id,
+            .section_hash = section_hash,
+            .section_size = section_size,
+            .code_size = code.size(),
+            .code_hash = Common::ComputeHash64(code.data(), code.size()),
+        };
+        FileUtil::IOFile out(temp_path, "wb");
+        success = out.IsOpen() && out.WriteObject(header) == 1 &&
+                  out.WriteBytes(code.data(), code.size()) == code.size() && out.Flush();
+    }
+
+    if (!success) {
+        FileUtil::Delete(temp_path);
+        return;
+    }
+
+    RemoveOldCopies();
+    if (!FileUtil::Rename(temp_path, path)) {
+        LOG_ERROR(Service_FS, "Could not move the decompressed code copy to {}", path);
+        FileUtil::Delete(temp_path);
+        return;
+    }
+    LOG_INFO(Service_FS, "Wrote decompressed code copy {}", path);
+}
+
+void DecompressedCodeCache::RemoveOldCopies() const {
+    const std::string prefix = fmt::format("{:016X}_", program_id);
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, directory,
+        [&prefix](u64*, const std::string& directory, const std::string& virtual_name) {
+            if (virtual_name.starts_with(prefix) && virtual_name.ends_with(".code")) {
+                FileUtil::Delete(directory + virtual_name);
+            }
+            return true;
+        });
+}
+
+} // namespace FileSys
@@ -0,0 +1,43 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace FileSys {
+
+/**
+ * Decompressed and decrypted copy of the .code section of a title, stored in the cache directory
+ * so that later boots read it directly instead of decrypting the ExeFS and running the LZSS
+ * decompression again. The copy is named after the program ID and the hash the ExeFS header
+ * records for the section, and holds a checksum of the code to catch corrupted copies.
+ */
+class DecompressedCodeCache {
+public:
+    DecompressedCodeCache(u64 program_id, const std::array<u8, 0x20>& section_hash,
+                          u64 section_size);
+
+    /// Reads the copy into `code` if it is complete and was made from the same section.
+    bool Load(std::vector<u8>& code) const;
+
+    /// Writes a new copy of the code and removes the older copies of the title.
+    void Store(std::span<const u8> code) const;
+
+private:
+    u64 program_id;
+    std::array<u8, 0x20> section_hash;
+    u64 section_size;
+
+    std::string directory;
+    std::string path;
+
+    void RemoveOldCopies() const;
+};
+
+} // namespace FileSys
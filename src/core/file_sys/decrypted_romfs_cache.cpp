@@ -0,0 +1,135 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/decrypted_romfs_cache.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+namespace {
+
+struct CopyHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le program_id;
+    std::array<u8, 0x20> romfs_hash;
+    u64_le source_size;
+    u64_le romfs_size;
+};
+static_assert(sizeof(CopyHeader) <= DecryptedRomFSCache::DataOffset);
+
+constexpr u32 CopyMagic = Loader::MakeMagic('D', 'R', 'F', 'S');
+constexpr u32 CopyVersion = 1;
+
+/// Size of the blocks the RomFS is decrypted in.
+constexpr std::size_t BlockSize = 1 << 20;
+
+} // Anonymous namespace
+
+DecryptedRomFSCache::DecryptedRomFSCache(u64 program_id, const std::array<u8, 0x20>& romfs_hash,
+                                         u64 source_size)
+    : program_id(program_id), romfs_hash(romfs_hash), source_size(source_size) {
+    u64 short_hash;
+    std::memcpy(&short_hash, romfs_hash.data(), sizeof(short_hash));
+
+    directory = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "romfs" DIR_SEP;
+    path = fmt::format("{}{:016X}_{:016X}.romfs", directory, program_id, short_hash);
+}
+
+std::unique_ptr<FileUtil::IOFile> DecryptedRomFSCache::Open(u64 romfs_size) const {
+    if (FileUtil::GetSize(path) != DataOffset + romfs_size) {
+        return nullptr;
+    }
+
+    auto file = std::make_unique<FileUtil::IOFile>(path, "rb");
+    CopyHeader header;
+    if (!file->IsOpen() || file->ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        return nullptr;
+    }
+    if (header.magic != CopyMagic || header.version != CopyVersion ||
+        header.program_id != program_id || header.romfs_hash != romfs_hash ||
+        header.source_size != source_size || header.romfs_size != romfs_size) {
+        LOG_INFO(Service_FS, "Decrypted RomFS copy {} is out of date", path);
+        return nullptr;
+    }
+    return file;
+}
+
+std::unique_ptr<FileUtil::IOFile> DecryptedRomFSCache::Build(FileUtil::IOFile& source, u64 offset,
+                                                             u64 romfs_size,
+                                                             std::stop_token stop) const {
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Service_FS, "Could not create {}", directory);
+        return nullptr;
+    }
+
+    // The copy is written under another name first, so that an interrupted one is never opened.
+    // The name is unique, as instances running the same title may build the copy concurrently.
+    const std::string temp_path = fmt::format("{}.{:08x}.tmp", path, std::random_device{}());
+    bool success = false;
+    {
+        FileUtil::IOFile out(temp_path, "wb");
+        std::vector<u8> block(BlockSize);
+        success = out.IsOpen() && out.Seek(DataOffset, SEEK_SET);
+        for (u64 pos = 0; success && pos < romfs_size; pos += BlockSize) {
+            if (stop.stop_requested()) {
+                success = false;
+                break;
+            }
+            const auto size = static_cast<std::size_t>(std::min<u64>(BlockSize, romfs_size - pos));
+            success = source.ReadAtBytes(block.data(), size, offset + pos) == size &&
+                      out.WriteBytes(block.data(), size) == size;
+        }
+
+        if (success) {
+            const CopyHeader header{
+                .magic = CopyMagic,
+                .version = CopyVersion,
+                .program_id = program_id,
+                .romfs_hash = romfs_hash,
+                .source_size = source_size,
+                .romfs_size = romfs_size,
+            };
+            success = out.Seek(0, SEEK_SET) && out.WriteObject(header) == 1 && out.Flush();
+        }
+    }
+
+    if (!success) {
+        FileUtil::Delete(temp_path);
+        return nullptr;
+    }
+
+    RemoveOldCopies();
+    if (!FileUtil::Rename(temp_path, path)) {
+        LOG_ERROR(Service_FS, "Could not move the decrypted RomFS copy to {}", path);
+        FileUtil::Delete(temp_path);
+        return nullptr;
+    }
+
+    LOG_INFO(Service_FS, "Wrote decrypted RomFS copy {}", path);
+    return Open(romfs_size);
+}
+
+void DecryptedRomFSCache::RemoveOldCopies() const {
+    const std::string prefix = fmt::format("{:016X}_", program_id);
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, directory,
+        [&prefix](u64*, const std::string& directory, const std::string& virtual_name) {
+            if (virtual_name.starts_with(prefix) && virtual_name.ends_with(".romfs")) {
+                FileUtil::Delete(directory + virtual_name);
+            }
+            return true;
+        });
+}
+
+} // namespace FileSys
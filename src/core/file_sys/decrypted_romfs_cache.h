@@ -0,0 +1,54 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include "common/common_types.h"
+
+namespace FileUtil {
+class IOFile;
+}
+
+namespace FileSys {
+
+/**
+ * Decrypted copy of the RomFS of a title installed with console unique crypto, stored in the
+ * cache directory so that it can be read without decrypting it. The copy is named after the
+ * program ID and the RomFS superblock hash, which covers the whole RomFS, and records the size of
+ * the file it was made from.
+ */
+class DecryptedRomFSCache {
+public:
+    /// Offset of the RomFS in the copy, after its header.
+    static constexpr u64 DataOffset = 0x200;
+
+    DecryptedRomFSCache(u64 program_id, const std::array<u8, 0x20>& romfs_hash, u64 source_size);
+
+    /// Opens the copy if it is complete and was made from the same source, or returns nullptr.
+    std::unique_ptr<FileUtil::IOFile> Open(u64 romfs_size) const;
+
+    /**
+     * Writes a new copy of the RomFS found at `offset` in `source` and removes the older copies
+     * of the title.
+     * @return the opened copy, or nullptr if it failed or `stop` was requested.
+     */
+    std::unique_ptr<FileUtil::IOFile> Build(FileUtil::IOFile& source, u64 offset, u64 romfs_size,
+                                            std::stop_token stop) const;
+
+private:
+    u64 program_id;
+    std::array<u8, 0x20> romfs_hash;
+    u64 source_size;
+
+    std::string directory;
+    std::string path;
+
+    void RemoveOldCopies() const;
+};
+
+} // namespace FileSys
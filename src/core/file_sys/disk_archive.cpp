@@ -3,11 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <condition_variable>
+#include <cstring>
 #include <memory>
+#include <unordered_map>
 #include "common/archives.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
 #include "core/file_sys/disk_archive.h"
 #include "core/file_sys/errors.h"
 
@@ -16,11 +22,140 @@ SERIALIZE_EXPORT_IMPL(FileSys::DiskDirectory)
 
 namespace FileSys {
 
+using namespace Common::Literals;
+
+namespace {
+
+/// Largest amount of data gathered before it is written out.
+constexpr std::size_t MaxWriteBufferSize = 1_MiB;
+
+/// Longest time written data is kept in the buffer, after which the flushing timer writes it out.
+constexpr std::chrono::seconds MaxWriteBufferAge{2};
+
+} // Anonymous namespace
+
+/**
+ * Tracks the open disk files by path, so that buffering is turned off while a file has several
+ * handles, and writes out the buffers that got too old on a thread of its own.
+ */
+class DiskFileRegistry {
+public:
+    static DiskFileRegistry& Instance() {
+        static DiskFileRegistry registry;
+        return registry;
+    }
+
+    void Register(DiskFile& disk_file) {
+        std::scoped_lock lock{mutex};
+        disk_file.registered_path = disk_file.file->Filename();
+        std::vector<DiskFile*>& handles = files[disk_file.registered_path];
+        // The other handles have not replaced the file since it was opened, as that only happens
+        // on the emulation thread, so the buffered data is written in place.
+        for (DiskFile* const other : handles) {
+            std::scoped_lock file_lock{other->mutex};
+            other->FlushWriteBuffer(false);
+            other->direct_writes = true;
+        }
+        disk_file.direct_writes = !handles.empty();
+        handles.push_back(&disk_file);
+    }
+
+    void Unregister(DiskFile& disk_file) {
+        std::scoped_lock lock{mutex};
+        const auto it = files.find(disk_file.registered_path);
+        if (it == files.end()) {
+            return;
+        }
+        std::vector<DiskFile*>& handles = it->second;
+        std::erase(handles, &disk_file);
+        if (handles.empty()) {
+            files.erase(it);
+        } else if (handles.size() == 1) {
+            std::scoped_lock file_lock{handles.front()->mutex};
+            handles.front()->direct_writes = false;
+        }
+        disk_file.registered_path.clear();
+    }
+
+    /// Makes the flushing thread write out the buffers once they got too old.
+    void ScheduleFlush() {
+        std::scoped_lock lock{mutex};
+        flush_pending = true;
+        if (!flush_thread.joinable()) {
+            flush_thread = std::jthread([this](std::stop_token stop) { RunFlushes(stop); });
+        }
+        flush_cv.notify_one();
+    }
+
+private:
+    void RunFlushes(std::stop_token stop) {
+        Common::SetCurrentThreadName("DiskFileFlush");
+        std::unique_lock lock{mutex};
+        while (!stop.stop_requested()) {
+            Common::CondvarWait(flush_cv, lock, stop, [this] { return flush_pending; });
+            flush_pending = false;
+
+            lock.unlock();
+            if (!Common::StoppableTimedWait(stop, MaxWriteBufferAge)) {
+                return;
+            }
+            lock.lock();
+
+            // Buffers started meanwhile are written out on a later round
+            const auto now = std::chrono::steady_clock::now();
+            for (const auto& [path, handles] : files) {
+                for (DiskFile* const disk_file : handles) {
+                    std::scoped_lock file_lock{disk_file->mutex};
+                    if (disk_file->write_buffer.empty()) {
+                        continue;
+                    }
+                    if (now - disk_file->write_buffer_time >= MaxWriteBufferAge) {
+                        disk_file->FlushWriteBuffer(false);
+                    } else {
+                        flush_pending = true;
+                    }
+                }
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<DiskFile*>> files;
+    std::condition_variable_any flush_cv;
+    bool flush_pending = false;
+    std::jthread flush_thread;
+};
+
+DiskFile::DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
+                   std::unique_ptr<DelayGenerator> delay_generator_)
+    : file(new FileUtil::IOFile(std::move(file_))) {
+    delay_generator = std::move(delay_generator_);
+    mode.hex = mode_.hex;
+    if (file->IsOpen()) {
+        DiskFileRegistry::Instance().Register(*this);
+    }
+}
+
+DiskFile::~DiskFile() {
+    DiskFileRegistry::Instance().Unregister(*this);
+    if (file) {
+        std::scoped_lock lock{mutex};
+        FlushWriteBuffer(true);
+    }
+}
+
 ResultVal<std::size_t> DiskFile::Read(const u64 offset, const std::size_t length,
                                       u8* buffer) const {
     if (!mode.read_flag)
         return ResultInvalidOpenFlags;
 
+    // Reads may run on an IO worker, where the file must not be replaced
+    std::scoped_lock lock{mutex};
+    if (!write_buffer.empty() && offset < write_buffer_offset + write_buffer.size() &&
+        offset + length > write_buffer_offset) {
+        FlushWriteBuffer(false);
+    }
+
     file->Seek(offset, SEEK_SET);
     return file->ReadBytes(buffer, length);
 }
@@ -30,27 +165,131 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
     if (!mode.write_flag)
         return ResultInvalidOpenFlags;
 
-    file->Seek(offset, SEEK_SET);
-    std::size_t written = file->WriteBytes(buffer, length);
-    if (flush)
-        file->Flush();
-    return written;
+    std::unique_lock lock{mutex};
+
+    // Only writes that overlap or continue the buffered data are gathered with it.
+    if (!write_buffer.empty() &&
+        (offset < write_buffer_offset || offset > write_buffer_offset + write_buffer.size() ||
+         offset + length - write_buffer_offset > MaxWriteBufferSize)) {
+        FlushWriteBuffer(true);
+    }
+
+    if (direct_writes || length > MaxWriteBufferSize) {
+        FlushWriteBuffer(!direct_writes);
+        file->Seek(offset, SEEK_SET);
+        std::size_t written = file->WriteBytes(buffer, length);
+        if (flush)
+            file->Flush();
+        return written;
+    }
+
+    const bool started = write_buffer.empty();
+    if (started) {
+        write_buffer_offset = offset;
+        write_buffer_time = std::chrono::steady_clock::now();
+    }
+    const std::size_t buffer_offset = static_cast<std::size_t>(offset - write_buffer_offset);
+    if (buffer_offset + length > write_buffer.size()) {
+        write_buffer.resize(buffer_offset + length);
+    }
+    std::memcpy(write_buffer.data() + buffer_offset, buffer, length);
+
+    if (flush) {
+        FlushWriteBuffer(true);
+        return length;
+    }
+    lock.unlock();
+    if (started) {
+        DiskFileRegistry::Instance().ScheduleFlush();
+    }
+    return length;
 }
 
 u64 DiskFile::GetSize() const {
-    return file->GetSize();
+    std::scoped_lock lock{mutex};
+    const u64 size = file->GetSize();
+    if (write_buffer.empty()) {
+        return size;
+    }
+    return std::max<u64>(size, write_buffer_offset + write_buffer.size());
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    std::scoped_lock lock{mutex};
+    FlushWriteBuffer(true);
     file->Resize(size);
     file->Flush();
     return true;
 }
 
 bool DiskFile::Close() {
+    DiskFileRegistry::Instance().Unregister(*this);
+    std::scoped_lock lock{mutex};
+    FlushWriteBuffer(true);
     return file->Close();
 }
 
+void DiskFile::Flush() const {
+    std::scoped_lock lock{mutex};
+    FlushWriteBuffer(true);
+    file->Flush();
+}
+
+void DiskFile::FlushForSave() {
+    std::scoped_lock lock{mutex};
+    FlushWriteBuffer(true);
+}
+
+void DiskFile::RegisterLoaded() {
+    if (file && file->IsOpen()) {
+        DiskFileRegistry::Instance().Register(*this);
+    }
+}
+
+void DiskFile::FlushWriteBuffer(bool allow_replace) const {
+    if (write_buffer.empty()) {
+        return;
+    }
+
+    if (!allow_replace || write_buffer_offset != 0 || write_buffer.size() < file->GetSize() ||
+        !ReplaceWithWriteBuffer()) {
+        file->Seek(write_buffer_offset, SEEK_SET);
+        if (file->WriteBytes(write_buffer.data(), write_buffer.size()) != write_buffer.size()) {
+            LOG_ERROR(Service_FS, "Could not write {} bytes to {}", write_buffer.size(),
+                      file->Filename());
+        }
+        file->Flush();
+    }
+    write_buffer.clear();
+}
+
+bool DiskFile::ReplaceWithWriteBuffer() const {
+    const std::string path = file->Filename();
+    const std::string temp_path = path + ".tmp";
+
+    bool success;
+    {
+        FileUtil::IOFile temp_file(temp_path, "wb");
+        success = temp_file.IsOpen() &&
+                  temp_file.WriteBytes(write_buffer.data(), write_buffer.size()) ==
+                      write_buffer.size() &&
+                  temp_file.Flush();
+    }
+
+    // Renaming onto an existing file fails on some hosts, such as Windows. The file is written in
+    // place instead there.
+    if (!success || !FileUtil::Rename(temp_path, path)) {
+        FileUtil::Delete(temp_path);
+        return false;
+    }
+
+    *file = FileUtil::IOFile(path, "r+b");
+    if (!file->IsOpen()) {
+        LOG_ERROR(Service_FS, "Could not reopen {}", path);
+    }
+    return true;
+}
+
 DiskDirectory::DiskDirectory(const std::string& path) {
     directory.size = FileUtil::ScanDirectoryTree(path, directory);
     directory.isDirectory = true;
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <boost/serialization/base_object.hpp>
@@ -20,14 +22,21 @@
 
 namespace FileSys {
 
+class DiskFileRegistry;
+
+/**
+ * File on the host file system. Writes are gathered in a write-back buffer while they are adjacent
+ * to each other, and written out on close, on flush, on a flushing write, when the buffer gets too
+ * large, before a savestate and by a timer once the data is a couple of seconds old. A buffer
+ * holding the whole contents of the file is written to a temporary file that then replaces the
+ * file, so that an interrupted save leaves the old contents. Writes are not buffered while the
+ * file is opened through more than one handle, so that every handle sees the same contents.
+ */
 class DiskFile : public FileBackend {
 public:
     DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
-             std::unique_ptr<DelayGenerator> delay_generator_)
-        : file(new FileUtil::IOFile(std::move(file_))) {
-        delay_generator = std::move(delay_generator_);
-        mode.hex = mode_.hex;
-    }
+             std::unique_ptr<DelayGenerator> delay_generator_);
+    ~DiskFile() override;
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush, bool update_timestamp,
@@ -35,10 +44,7 @@ public:
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
     bool Close() override;
-
-    void Flush() const override {
-        file->Flush();
-    }
+    void Flush() const override;
 
 protected:
     Mode mode;
@@ -47,11 +53,45 @@ protected:
     DiskFile() = default;
 
 private:
+    /**
+     * Writes the buffered data to the file. The file may only be replaced on the emulation thread,
+     * which opens the other handles. The mutex must be held.
+     */
+    void FlushWriteBuffer(bool allow_replace) const;
+
+    /// Replaces the file with one holding the buffered data. Returns whether it succeeded.
+    bool ReplaceWithWriteBuffer() const;
+
+    /// Guards the file and the buffer, which the flushing timer also writes out
+    mutable std::mutex mutex;
+
+    // The buffered data starts at write_buffer_offset in the file, and was first written at
+    // write_buffer_time.
+    mutable std::vector<u8> write_buffer;
+    mutable u64 write_buffer_offset = 0;
+    mutable std::chrono::steady_clock::time_point write_buffer_time;
+    bool direct_writes = false; ///< Set while other handles to the file are open
+    std::string registered_path;
+
+    friend class DiskFileRegistry;
+
+    /// Writes out the buffered data before a savestate.
+    void FlushForSave();
+
+    /// Registers the file of a loaded savestate.
+    void RegisterLoaded();
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
+        if (Archive::is_saving::value) {
+            FlushForSave();
+        }
         ar& boost::serialization::base_object<FileBackend>(*this);
         ar & mode.hex;
         ar & file;
+        if (Archive::is_loading::value) {
+            RegisterLoaded();
+        }
     }
     friend class boost::serialization::access;
 };
@@ -4,15 +4,18 @@
 
 #include <algorithm>
 #include <cstring>
+#include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/patch.h"
+#include "core/loader/loader.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::LayeredFS)
 
@@ -54,12 +57,38 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    std::array<u8, 0x20> romfs_hash;
+    u64_le patch_hash;
+    u64_le metadata_size;
+    u64_le data_size;
+    u64_le file_count;
+};
+static_assert(sizeof(CacheHeader) == 0x48, "Size of CacheHeader is not correct");
+
+// Followed by the name of the file, and by its contents for a patched file
+struct CacheFileEntry {
+    u64_le data_offset;
+    u64_le original_offset;
+    u64_le size;
+    u32_le type;
+    u32_le path_length;
+};
+static_assert(sizeof(CacheFileEntry) == 0x20, "Size of CacheFileEntry is not correct");
+
+constexpr u32 CacheMagic = Loader::MakeMagic('L', 'F', 'S', 'C');
+constexpr u32 CacheVersion = 1;
+
 LayeredFS::LayeredFS() = default;
 
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
-                     std::string patch_ext_path_, bool load_relocations_)
+                     std::string patch_ext_path_, bool load_relocations_, std::string cache_path_,
+                     const std::array<u8, 0x20>& romfs_hash_)
     : romfs(std::move(romfs_)), patch_path(std::move(patch_path_)),
-      patch_ext_path(std::move(patch_ext_path_)), load_relocations(load_relocations_) {
+      patch_ext_path(std::move(patch_ext_path_)), load_relocations(load_relocations_),
+      cache_path(std::move(cache_path_)), romfs_hash(romfs_hash_) {
     Load();
 }
 
@@ -68,6 +97,15 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    std::optional<u64> patch_hash;
+    if (load_relocations && !cache_path.empty()) {
+        patch_hash = HashPatchPaths();
+        if (patch_hash && LoadCache(*patch_hash)) {
+            LOG_INFO(Service_FS, "LayeredFS metadata loaded from {}", cache_path);
+            return;
+        }
+    }
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
@@ -78,6 +116,10 @@ void LayeredFS::Load() {
     }
 
     RebuildMetadata();
+
+    if (patch_hash) {
+        SaveCache(*patch_hash);
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
@@ -522,10 +564,9 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
             romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
                             buffer + read_size);
         } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+            auto& replace_file = GetReplaceFile(*current->second);
             if (replace_file) {
-                replace_file.Seek(relative_offset, SEEK_SET);
-                replace_file.ReadBytes(buffer + read_size, to_read);
+                replace_file.ReadAtBytes(buffer + read_size, to_read, relative_offset);
             } else {
                 LOG_ERROR(Service_FS, "Could not open replacement file for {}",
                           current->second->path);
@@ -547,6 +588,169 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
     return read_size;
 }
 
+FileUtil::IOFile& LayeredFS::GetReplaceFile(const File& file) {
+    auto [found, replace_file] = replace_files.request(&file);
+    if (!found || !replace_file.IsOpen()) {
+        replace_file = FileUtil::IOFile(file.relocation.replace_file_path, "rb");
+    }
+    return replace_file;
+}
+
+std::optional<u64> LayeredFS::HashPatchPaths() const {
+    std::vector<std::string> entries;
+    bool known_times = true;
+
+    // Each entry is tagged with the patch path it was found in.
+    const auto scan = [&entries, &known_times](const std::string& base, char tag) {
+        if (!FileUtil::Exists(base)) {
+            return;
+        }
+        const FileUtil::DirectoryEntryCallable callback =
+            [&](u64*, const std::string& directory, const std::string& virtual_name) {
+                const auto physical_name = directory + virtual_name;
+                const auto path = physical_name.substr(base.size());
+                if (FileUtil::IsDirectory(physical_name + DIR_SEP)) {
+                    entries.emplace_back(fmt::format("{}{}{}", tag, path, DIR_SEP));
+                    return FileUtil::ForeachDirectoryEntry(nullptr, physical_name + DIR_SEP,
+                                                           callback);
+                }
+                const s64 time = FileUtil::GetLastWriteTime(physical_name);
+                known_times &= time != 0;
+                entries.emplace_back(fmt::format("{}{}:{}:{}", tag, path,
+                                                 FileUtil::GetSize(physical_name), time));
+                return true;
+            };
+        FileUtil::ForeachDirectoryEntry(nullptr, base, callback);
+    };
+
+    scan(patch_path, 'R');
+    scan(patch_ext_path, 'E');
+    if (!known_times) {
+        return std::nullopt;
+    }
+
+    // Sort the entries so that the directory listing order does not matter.
+    std::sort(entries.begin(), entries.end());
+    std::string joined;
+    for (const auto& entry : entries) {
+        joined.append(entry).push_back('\n');
+    }
+    return Common::ComputeHash64(joined.data(), joined.size());
+}
+
+bool LayeredFS::LoadCache(u64 patch_hash) {
+    FileUtil::IOFile file(cache_path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    CacheHeader cache_header;
+    if (file.ReadBytes(&cache_header, sizeof(cache_header)) != sizeof(cache_header) ||
+        cache_header.magic != CacheMagic || cache_header.version != CacheVersion ||
+        cache_header.romfs_hash != romfs_hash || cache_header.patch_hash != patch_hash) {
+        LOG_INFO(Service_FS, "LayeredFS metadata cache {} is out of date", cache_path);
+        return false;
+    }
+
+    std::vector<u8> cached_metadata(cache_header.metadata_size);
+    if (file.ReadBytes(cached_metadata.data(), cached_metadata.size()) != cached_metadata.size()) {
+        return false;
+    }
+
+    std::vector<std::unique_ptr<File>> files;
+    std::map<u64, File*> offset_map;
+    const auto replace_base = patch_path.substr(0, patch_path.size() - 1);
+    for (u64 i = 0; i < cache_header.file_count; ++i) {
+        CacheFileEntry entry;
+        if (file.ReadBytes(&entry, sizeof(entry)) != sizeof(entry) || entry.type > 2) {
+            return false;
+        }
+
+        auto cached_file = std::make_unique<File>();
+        cached_file->path.resize(entry.path_length);
+        if (file.ReadBytes(cached_file->path.data(), entry.path_length) != entry.path_length) {
+            return false;
+        }
+
+        auto& relocation = cached_file->relocation;
+        relocation.type = entry.type;
+        relocation.original_offset = entry.original_offset;
+        relocation.size = entry.size;
+        if (relocation.type == 1) {
+            relocation.replace_file_path = replace_base + cached_file->path;
+        } else if (relocation.type == 2) {
+            relocation.patched_file.resize(entry.size);
+            if (file.ReadBytes(relocation.patched_file.data(), entry.size) != entry.size) {
+                return false;
+            }
+        }
+
+        offset_map.emplace(entry.data_offset, cached_file.get());
+        files.emplace_back(std::move(cached_file));
+    }
+
+    metadata = std::move(cached_metadata);
+    current_data_offset = cache_header.data_size;
+    cached_files = std::move(files);
+    data_offset_map = std::move(offset_map);
+    return true;
+}
+
+void LayeredFS::SaveCache(u64 patch_hash) const {
+    if (!FileUtil::CreateFullPath(cache_path)) {
+        LOG_ERROR(Service_FS, "Could not create the directory of {}", cache_path);
+        return;
+    }
+
+    // The cache is written under another name first, so that an incomplete one is never read.
+    const std::string temp_path = cache_path + ".tmp";
+    bool success = false;
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        const CacheHeader cache_header{
+            .magic = CacheMagic,
+            .version = CacheVersion,
+            .romfs_hash = romfs_hash,
+            .patch_hash = patch_hash,
+            .metadata_size = metadata.size(),
+            .data_size = current_data_offset,
+            .file_count = data_offset_map.size(),
+        };
+        success = file.IsOpen() && file.WriteObject(cache_header) == 1 &&
+                  file.WriteBytes(metadata.data(), metadata.size()) == metadata.size();
+
+        for (const auto& [data_offset, cached_file] : data_offset_map) {
+            if (!success) {
+                break;
+            }
+            const auto& relocation = cached_file->relocation;
+            const CacheFileEntry entry{
+                .data_offset = data_offset,
+                .original_offset = relocation.original_offset,
+                .size = relocation.size,
+                .type = static_cast<u32>(relocation.type),
+                .path_length = static_cast<u32>(cached_file->path.size()),
+            };
+            success = file.WriteObject(entry) == 1 &&
+                      file.WriteBytes(cached_file->path.data(), cached_file->path.size()) ==
+                          cached_file->path.size();
+            if (success && relocation.type == 2) {
+                success = file.WriteBytes(relocation.patched_file.data(),
+                                          relocation.patched_file.size()) ==
+                          relocation.patched_file.size();
+            }
+        }
+        success = success && file.Flush();
+    }
+
+    if (!success || !FileUtil::Delete(cache_path) || !FileUtil::Rename(temp_path, cache_path)) {
+        LOG_ERROR(Service_FS, "Could not write LayeredFS metadata cache {}", cache_path);
+        FileUtil::Delete(temp_path);
+        return;
+    }
+    LOG_INFO(Service_FS, "Wrote LayeredFS metadata cache {}", cache_path);
+}
+
 bool LayeredFS::ExtractDirectory(Directory& current, const std::string& target_path) {
     if (!FileUtil::CreateFullPath(target_path + current.path)) {
         LOG_ERROR(Service_FS, "Could not create path {}", target_path + current.path);
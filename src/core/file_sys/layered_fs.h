@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <array>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,6 +16,8 @@
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/string.hpp>
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/static_lru_cache.h"
 #include "common/swap.h"
 #include "core/file_sys/romfs_reader.h"
 
@@ -41,11 +45,16 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ * cache_path: Optional file where the rebuilt metadata and the relocations are kept between
+ * boots. It is used again as long as romfs_hash and the size and modification time of every file
+ * in the patch paths are unchanged. The directory tree is not loaded when the cache is used, so
+ * DumpRomFS is only supported without a cache.
  */
 class LayeredFS : public RomFSReader {
 public:
     explicit LayeredFS(std::shared_ptr<RomFSReader> romfs, std::string patch_path,
-                       std::string patch_ext_path, bool load_relocations = true);
+                       std::string patch_ext_path, bool load_relocations = true,
+                       std::string cache_path = "", const std::array<u8, 0x20>& romfs_hash = {});
     ~LayeredFS() override;
 
     std::size_t GetSize() const override;
@@ -106,15 +115,31 @@ private:
 
     void RebuildMetadata();
 
+    // Returns a hash of the paths, sizes and modification times of the files in the patch paths,
+    // or std::nullopt if a modification time is not known.
+    std::optional<u64> HashPatchPaths() const;
+
+    // Loads the metadata and relocations from the cache. Returns whether it was up to date.
+    bool LoadCache(u64 patch_hash);
+
+    // Writes the metadata and relocations to the cache.
+    void SaveCache(u64 patch_hash) const;
+
+    // Returns the replacement file of `file`, opening it if it is not already open.
+    FileUtil::IOFile& GetReplaceFile(const File& file);
+
     void Load();
 
     std::shared_ptr<RomFSReader> romfs;
     std::string patch_path;
     std::string patch_ext_path;
     bool load_relocations;
+    std::string cache_path;
+    std::array<u8, 0x20> romfs_hash{};
 
     RomFSHeader header;
     Directory root;
+    std::vector<std::unique_ptr<File>> cached_files; // files loaded from the cache, without a tree
     std::unordered_map<std::string, File*> file_path_map;
     std::unordered_map<std::string, Directory*> directory_path_map;
     std::map<u64, File*> data_offset_map; // assigned data offset -> file
@@ -136,6 +161,10 @@ private:
     std::vector<u8> file_metadata_table; // rebuilt file metadata table
     u64 current_data_offset{};           // current assigned data offset
 
+    // Replacement files are kept open while they are read, up to a limit.
+    static constexpr std::size_t ReplaceFileCacheSize = 16;
+    Common::StaticLRUCache<const File*, FileUtil::IOFile, ReplaceFileCacheSize> replace_files;
+
     LayeredFS();
 
     template <class Archive>
@@ -4,6 +4,7 @@
 
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <span>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
@@ -11,7 +12,10 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/zstd_compression.h"
+#include "common/settings.h"
 #include "core/core.h"
+#include "core/file_sys/decompressed_code_cache.h"
+#include "core/file_sys/decrypted_romfs_cache.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/patch.h"
@@ -40,42 +44,96 @@ u64 GetModId(u64 program_id) {
  * @return Size of decompressed buffer
  */
 static std::size_t LZSS_GetDecompressedSize(std::span<const u8> buffer) {
+    if (buffer.size() < sizeof(u32)) {
+        return buffer.size();
+    }
     u32 offset_size;
     std::memcpy(&offset_size, buffer.data() + buffer.size() - sizeof(u32), sizeof(u32));
     return offset_size + buffer.size();
 }
 
+/**
+ * Copies an LZSS match, which is read backwards from `distance` bytes above the output like the
+ * rest of the stream. Matches that do not overlap the bytes they produce are copied at once.
+ * @param out Offset the match ends at, it is written to [out - size, out)
+ */
+static void LZSS_CopyMatch(u8* decompressed, std::size_t out, std::size_t distance,
+                           std::size_t size) {
+    u8* const dest = decompressed + out - size;
+    if (distance >= size) {
+        std::memcpy(dest, dest + distance, size);
+        return;
+    }
+    for (std::size_t i = size; i-- > 0;) {
+        dest[i] = dest[i + distance];
+    }
+}
+
 /**
  * Decompress ExeFS file (compressed with LZSS)
  * @param compressed Compressed buffer
- * @param compressed_size Size of compressed buffer
  * @param decompressed Decompressed buffer
- * @param decompressed_size Size of decompressed buffer
  * @return True on success, otherwise false
  */
 static bool LZSS_Decompress(std::span<const u8> compressed, std::span<u8> decompressed) {
+    if (compressed.size() < 8) {
+        return false;
+    }
     const u8* footer = compressed.data() + compressed.size() - 8;
 
     u32 buffer_top_and_bottom;
     std::memcpy(&buffer_top_and_bottom, footer, sizeof(u32));
 
+    const std::size_t top = (buffer_top_and_bottom >> 24) & 0xFF;
+    const std::size_t bottom = buffer_top_and_bottom & 0xFFFFFF;
+    if (top > compressed.size() || bottom > compressed.size()) {
+        return false;
+    }
+
     std::size_t out = decompressed.size();
-    std::size_t index = compressed.size() - ((buffer_top_and_bottom >> 24) & 0xFF);
-    std::size_t stop_index = compressed.size() - (buffer_top_and_bottom & 0xFFFFFF);
+    std::size_t index = compressed.size() - top;
+    const std::size_t stop_index = compressed.size() - bottom;
 
-    std::memset(decompressed.data(), 0, decompressed.size());
     std::memcpy(decompressed.data(), compressed.data(), compressed.size());
+    std::memset(decompressed.data() + compressed.size(), 0,
+                decompressed.size() - compressed.size());
+
+    // Largest input and output a group of eight tokens can take
+    constexpr std::size_t MaxGroupInput = 8 * 2;
+    constexpr std::size_t MaxMatchSize = 15 + 3;
+    constexpr std::size_t MaxGroupOutput = 8 * MaxMatchSize;
 
+    const u8* const src = compressed.data();
+    u8* const dest = decompressed.data();
     while (index > stop_index) {
-        u8 control = compressed[--index];
+        u8 control = src[--index];
+
+        // Most groups are far from both ends of the buffers, their tokens are decoded without
+        // checking the bounds of each one.
+        if (index >= stop_index + MaxGroupInput && out >= MaxGroupOutput) {
+            for (unsigned i = 0; i < 8; i++, control <<= 1) {
+                if (!(control & 0x80)) {
+                    dest[--out] = src[--index];
+                    continue;
+                }
+                index -= 2;
+                const u32 token = src[index] | (src[index + 1] << 8);
+                const std::size_t size = ((token >> 12) & 15) + 3;
+                const std::size_t distance = (token & 0x0FFF) + 3;
+                // The match is read downwards from its highest byte
+                if (out + distance - 1 >= decompressed.size()) {
+                    return false;
+                }
+                LZSS_CopyMatch(dest, out, distance, size);
+                out -= size;
+            }
+            continue;
+        }
 
-        for (unsigned i = 0; i < 8; i++) {
-            if (index <= stop_index)
-                break;
-            if (index <= 0)
-                break;
-            if (out <= 0)
+        for (unsigned i = 0; i < 8; i++, control <<= 1) {
+            if (index <= stop_index || out == 0) {
                 break;
+            }
 
             if (control & 0x80) {
                 // Check if compression is out of bounds
@@ -83,30 +141,19 @@ static bool LZSS_Decompress(std::span<const u8> compressed, std::span<u8> decomp
                     return false;
                 index -= 2;
 
-                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
-                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
-                segment_offset &= 0x0FFF;
-                segment_offset += 2;
+                const u32 token = src[index] | (src[index + 1] << 8);
+                const std::size_t size = ((token >> 12) & 15) + 3;
+                const std::size_t distance = (token & 0x0FFF) + 3;
 
                 // Check if compression is out of bounds
-                if (out < segment_size)
+                if (out < size || out + distance - 1 >= decompressed.size())
                     return false;
 
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed.size())
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
-                }
+                LZSS_CopyMatch(dest, out, distance, size);
+                out -= size;
             } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
-                decompressed[--out] = compressed[--index];
+                dest[--out] = src[--index];
             }
-            control <<= 1;
         }
     }
     return true;
@@ -484,10 +531,26 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
             s64 section_offset =
                 is_proto ? section.offset
                          : (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset);
-            exefs_file->Seek(section_offset, SEEK_SET);
 
             size_t section_size = is_proto ? Common::AlignUp(section.size, 0x10) : section.size;
 
+            // Decompressing or decrypting the code of large titles takes a while, a copy of the
+            // result is kept and used on the next boots.
+            std::optional<DecompressedCodeCache> code_cache;
+            if (strcmp(section.name, ".code") == 0 && !is_proto &&
+                (is_compressed || exefs_file->IsCrypto() || exefs_file->IsCompressed())) {
+                // The ExeFS header stores the hashes of the sections in reverse order
+                const u8* const hash = exefs_header.hashes[kMaxSections - 1 - section_number];
+                std::array<u8, 0x20> section_hash;
+                std::memcpy(section_hash.data(), hash, section_hash.size());
+                code_cache.emplace(ncch_header.program_id, section_hash, section.size);
+                if (code_cache->Load(buffer)) {
+                    LOG_DEBUG(Service_FS, "Read .code from its decompressed copy");
+                    return Loader::ResultStatus::Success;
+                }
+            }
+
+            exefs_file->Seek(section_offset, SEEK_SET);
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
                 std::vector<u8> temp_buffer(section_size);
@@ -507,6 +570,9 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                     return Loader::ResultStatus::Error;
             }
 
+            if (code_cache) {
+                code_cache->Store(buffer);
+            }
             return Loader::ResultStatus::Success;
         }
     }
@@ -641,8 +707,26 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     if (!romfs_file_inner->IsOpen())
         return Loader::ResultStatus::Error;
 
-    std::shared_ptr<RomFSReader> direct_romfs =
-        std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), romfs_offset, romfs_size);
+    std::shared_ptr<RomFSReader> direct_romfs;
+    if (Settings::values.cache_decrypted_romfs && romfs_file_inner->IsCrypto() && !is_proto) {
+        std::array<u8, 0x20> romfs_hash;
+        std::memcpy(romfs_hash.data(), ncch_header.romfs_super_block_hash, romfs_hash.size());
+        const DecryptedRomFSCache copy{ncch_header.program_id, romfs_hash, file->GetSize()};
+
+        if (auto decrypted = copy.Open(romfs_size)) {
+            LOG_DEBUG(Service_FS, "Reading RomFS from its decrypted copy");
+            direct_romfs = std::make_shared<DirectRomFSReader>(
+                std::move(decrypted), DecryptedRomFSCache::DataOffset, romfs_size);
+        } else {
+            auto reader = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner),
+                                                              romfs_offset, romfs_size);
+            reader->StartDecryptedCopy(copy, Reopen(file, filepath));
+            direct_romfs = std::move(reader);
+        }
+    } else {
+        direct_romfs = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner),
+                                                           romfs_offset, romfs_size);
+    }
 
     const auto path =
         fmt::format("{}mods/{:016X}/", FileUtil::GetUserPath(FileUtil::UserPath::LoadDir),
@@ -650,8 +734,13 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     if (!is_proto && use_layered_fs &&
         (FileUtil::Exists(path + "romfs/") || FileUtil::Exists(path + "romfs_ext/"))) {
 
+        std::array<u8, 0x20> romfs_hash;
+        std::memcpy(romfs_hash.data(), ncch_header.romfs_super_block_hash, romfs_hash.size());
+        const auto cache_path = fmt::format("{}layeredfs/{:016X}.bin",
+                                            FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                                            ncch_header.program_id);
         romfs_file = std::make_shared<LayeredFS>(std::move(direct_romfs), path + "romfs/",
-                                                 path + "romfs_ext/");
+                                                 path + "romfs_ext/", true, cache_path, romfs_hash);
     } else {
         romfs_file = std::move(direct_romfs);
     }
@@ -95,4 +95,50 @@ std::string PathParser::BuildHostPath(std::string_view mount_point) const {
     return path;
 }
 
+PathCache::Resolution PathCache::Resolve(const Path& path, std::string_view mount_point) {
+    const auto type = path.GetType();
+    if (type != LowPathType::Char && type != LowPathType::Wchar) {
+        return {};
+    }
+
+    const auto binary = path.AsBinary();
+    std::string key(1, static_cast<char>(type));
+    key.append(binary.begin(), binary.end());
+
+    std::scoped_lock lock{mutex};
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        if (entries.size() >= MaxEntries) {
+            entries.clear();
+        }
+        PathParser parser(path);
+        std::string host_path = parser.IsValid() ? parser.BuildHostPath(mount_point) : "";
+        it = entries.emplace(std::move(key), Entry{std::move(parser), std::move(host_path)}).first;
+    }
+
+    Entry& entry = it->second;
+    Resolution resolution{
+        .is_valid = entry.parser.IsValid(),
+        .is_root = entry.parser.IsRootDirectory(),
+        .host_path = entry.host_path,
+    };
+    if (!resolution.is_valid) {
+        return resolution;
+    }
+
+    if (entry.is_file) {
+        resolution.status = PathParser::FileFound;
+        resolution.cached = true;
+    } else {
+        resolution.status = entry.parser.GetHostStatus(mount_point);
+        entry.is_file = resolution.status == PathParser::FileFound;
+    }
+    return resolution;
+}
+
+void PathCache::Clear() {
+    std::scoped_lock lock{mutex};
+    entries.clear();
+}
+
 } // namespace FileSys
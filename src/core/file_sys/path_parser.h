@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "core/file_sys/archive_backend.h"
 
@@ -58,4 +60,41 @@ private:
     bool is_root{};
 };
 
+/**
+ * Remembers how the paths used with an archive resolve on the host file system, so that opening the
+ * same file again neither parses the path nor checks every component on the host again.
+ * Only files found on the host have their status remembered; everything else is checked on every
+ * use. The archive must clear the cache whenever it creates, deletes or renames anything.
+ */
+class PathCache {
+public:
+    struct Resolution {
+        bool is_valid{};
+        bool is_root{};
+        std::string host_path;
+        PathParser::HostStatus status{};
+        /// Whether the status was remembered rather than checked on the host. A cached file may
+        /// have been removed by something other than the archive since.
+        bool cached{};
+    };
+
+    /// Resolves the path, which must be used with the same mount point every time.
+    Resolution Resolve(const Path& path, std::string_view mount_point);
+
+    /// Forgets every resolved path.
+    void Clear();
+
+private:
+    struct Entry {
+        PathParser parser;
+        std::string host_path;
+        bool is_file{};
+    };
+
+    static constexpr std::size_t MaxEntries = 256;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
 } // namespace FileSys
@@ -3,11 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "common/archives.h"
 #include "common/logging/log.h"
+#include "common/task_scheduler.h"
+#include "common/thread.h"
 #include "core/file_sys/archive_artic.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/romfs_reader.h"
@@ -18,34 +21,78 @@ SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
+namespace {
+std::atomic<u64> romfs_cache_hits = 0;
+std::atomic<u64> romfs_cache_misses = 0;
+} // Anonymous namespace
+
+DirectRomFSReader::~DirectRomFSReader() {
+    if (prefetch.valid()) {
+        prefetch.wait();
+    }
+}
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     if (length == 0)
         return 0; // Crypto++ does not like zero size buffer
 
+    {
+        std::scoped_lock lock{file_mutex};
+        if (mapping.IsOpen()) {
+            std::memcpy(buffer, mapping.Data().data() + file_offset + offset, length);
+            return length;
+        }
+    }
+
     const auto segments = BreakupRead(offset, length);
     std::size_t read_progress = 0;
 
     // Skip cache if the read is too big
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
-        length = file->ReadAtBytes(buffer, length, file_offset + offset);
+        length = ReadAt(buffer, length, offset);
         LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
         return length;
     }
 
+    // Files are laid out one after the other with some padding, so a read that starts within a
+    // line of the end of the previous one is part of a sequential walk. Reads that skip the cache
+    // may come from other threads and are left out.
+    const bool sequential = offset >= sequential_end && offset - sequential_end < cache_line_size;
+    sequential_reads = sequential ? sequential_reads + 1 : 0;
+    sequential_end = offset + length;
+
+    if (!cache) {
+        cache = std::make_unique<LineCache>();
+    }
+
     // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
     // std::unique_lock<std::shared_mutex> read_guard(cache_mutex);
     for (const auto& seg : segments) {
         std::size_t read_size = cache_line_size;
         std::size_t page = OffsetToPage(seg.first);
+        if (!cache->contains(page)) {
+            if (TakePrefetch(page)) {
+                LOG_TRACE(Service_FS, "RomFS Cache PREFETCHED: page={}", page);
+            } else if (sequential_reads >= sequential_threshold) {
+                // Read the whole chunk holding the page, the next reads are likely to need it.
+                const std::size_t chunk = Common::AlignDown(page, read_ahead_size);
+                chunk_buffer.resize(read_ahead_size);
+                const std::size_t chunk_size = ReadAt(chunk_buffer.data(), read_ahead_size, chunk);
+                FillCache(chunk, chunk_buffer.data(), chunk_size);
+                LOG_TRACE(Service_FS, "RomFS Cache CHUNK: chunk={}, length={}", chunk, chunk_size);
+            }
+        }
         // Check if segment is in cache
-        auto cache_entry = cache.request(page);
+        auto cache_entry = cache->request(page);
         if (!cache_entry.first) {
             // If not found, read from disk and cache the data
-            read_size = file->ReadAtBytes(cache_entry.second.data(), read_size, file_offset + page);
+            read_size = ReadAt(cache_entry.second.data(), read_size, page);
+            ++romfs_cache_misses;
             LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
         } else {
+            ++romfs_cache_hits;
             LOG_TRACE(Service_FS, "RomFS Cache HIT: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
         }
@@ -57,9 +104,88 @@ std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length,
                     copy_amount);
         read_progress += copy_amount;
     }
+
+    if (sequential_reads >= sequential_threshold) {
+        StartPrefetch(offset + length);
+    }
     return read_progress;
 }
 
+std::pair<u64, u64> DirectRomFSReader::GetAndResetCacheStats() {
+    return {romfs_cache_hits.exchange(0), romfs_cache_misses.exchange(0)};
+}
+
+void DirectRomFSReader::StartDecryptedCopy(const DecryptedRomFSCache& copy,
+                                           std::unique_ptr<FileUtil::IOFile>&& source) {
+    copy_thread = std::jthread([this, copy, source = std::move(source), offset = file_offset,
+                                size = data_size](std::stop_token stop) {
+        Common::SetCurrentThreadName("RomFSDecrypt");
+        Common::SetCurrentThreadPriority(Common::ThreadPriority::Low);
+
+        auto decrypted = copy.Build(*source, offset, size, stop);
+        if (!decrypted) {
+            return;
+        }
+        // The copy holds the same data, so the cached lines stay valid.
+        std::scoped_lock lock{file_mutex};
+        file = std::move(decrypted);
+        file_offset = DecryptedRomFSCache::DataOffset;
+        MapFile();
+    });
+}
+
+void DirectRomFSReader::MapFile() {
+    mapping.Close();
+    if (!file || file->IsCrypto() || file->IsCompressed() || !mapping.Open(*file)) {
+        return;
+    }
+    if (mapping.Data().size() < file_offset + data_size) {
+        mapping.Close();
+        return;
+    }
+    LOG_DEBUG(Service_FS, "Reading RomFS from a mapping of {}", file->Filename());
+}
+
+std::size_t DirectRomFSReader::ReadAt(u8* buffer, std::size_t length, std::size_t offset) {
+    std::scoped_lock lock{file_mutex};
+    return file->ReadAtBytes(buffer, length, file_offset + offset);
+}
+
+void DirectRomFSReader::FillCache(std::size_t offset, const u8* data, std::size_t size) {
+    for (std::size_t line = 0; line < size; line += cache_line_size) {
+        auto cache_entry = cache->request(offset + line);
+        if (!cache_entry.first) {
+            std::memcpy(cache_entry.second.data(), data + line,
+                        std::min(cache_line_size, size - line));
+        }
+    }
+}
+
+bool DirectRomFSReader::TakePrefetch(std::size_t page) {
+    if (!prefetch.valid() || page < prefetch_offset || page >= prefetch_offset + read_ahead_size) {
+        return false;
+    }
+    const std::vector<u8> data = prefetch.get();
+    FillCache(prefetch_offset, data.data(), data.size());
+    return page < prefetch_offset + data.size();
+}
+
+void DirectRomFSReader::StartPrefetch(std::size_t offset) {
+    const std::size_t next_chunk = Common::AlignDown(offset, read_ahead_size) + read_ahead_size;
+    if (prefetch.valid() || next_chunk >= data_size || cache->contains(next_chunk)) {
+        return;
+    }
+
+    prefetch_offset = next_chunk;
+    prefetch = Common::GetTaskScheduler().Enqueue(
+        [this, next_chunk] {
+            std::vector<u8> data(read_ahead_size);
+            data.resize(ReadAt(data.data(), data.size(), next_chunk));
+            return data;
+        },
+        Common::TaskPriority::Background);
+}
+
 bool DirectRomFSReader::AllowsCachedReads() const {
     return true;
 }
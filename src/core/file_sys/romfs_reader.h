@@ -5,15 +5,22 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <future>
+#include <mutex>
 #include <shared_mutex>
+#include <thread>
+#include <utility>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "common/mapped_file.h"
 #include "common/static_lru_cache.h"
 #include "core/file_sys/artic_cache.h"
+#include "core/file_sys/decrypted_romfs_cache.h"
 #include "network/artic_base/artic_base_client.h"
 
 namespace Loader {
@@ -42,14 +49,23 @@ private:
 
 /**
  * A RomFS reader that directly reads the RomFS file.
+ *
+ * Files that are neither encrypted nor compressed, including decrypted copies, are memory mapped
+ * and read from the mapping, so that instances running the same title share the page cache.
+ *
+ * Otherwise small reads go through a cache of 8KB lines. Once reads are found to walk the RomFS
+ * forwards, misses are served by reading a whole 128KB chunk at once, and the next chunk is read
+ * ahead on the task scheduler.
  */
 class DirectRomFSReader : public RomFSReader {
 public:
     DirectRomFSReader(std::unique_ptr<FileUtil::IOFile>&& file, std::size_t file_offset,
                       std::size_t data_size)
-        : file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+        : file(std::move(file)), file_offset(file_offset), data_size(data_size) {
+        MapFile();
+    }
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -61,21 +77,71 @@ public:
 
     bool CacheReady(std::size_t file_offset, std::size_t length) override;
 
+    /// Returns the number of cache hits and misses of all the readers since the previous call.
+    static std::pair<u64, u64> GetAndResetCacheStats();
+
+    /**
+     * Writes a decrypted copy of the RomFS read from `source` on a separate thread, and reads from
+     * the copy once it is complete.
+     */
+    void StartDecryptedCopy(const DecryptedRomFSCache& copy,
+                            std::unique_ptr<FileUtil::IOFile>&& source);
+
 private:
     std::unique_ptr<FileUtil::IOFile> file;
     u64 file_offset;
     u64 data_size;
 
-    // Total cache size: 128KB
-    static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
-    static constexpr std::size_t cache_line_count = 16;
+    /// Serializes the file accesses, as an encrypted file keeps the position of its cipher.
+    std::mutex file_mutex;
 
-    Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
+    /// Mapping of the file, open when it can be read directly.
+    Common::MappedFile mapping;
+
+    // Total cache size: 512KB
+    static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
+    static constexpr std::size_t cache_line_count = 64;
+    // Sequential reads are served in chunks of 128KB
+    static constexpr std::size_t read_ahead_size = (1 << 17);
+    // Number of consecutive sequential reads after which chunks are read
+    static constexpr u32 sequential_threshold = 2;
+
+    using LineCache =
+        Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count>;
+    /// Created on the first read that is not served from the mapping.
+    std::unique_ptr<LineCache> cache;
     // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
     // std::shared_mutex cache_mutex;
 
+    /// End of the previous read, and how many reads in a row started shortly after the previous.
+    std::size_t sequential_end = 0;
+    u32 sequential_reads = 0;
+
+    /// Chunk being read ahead on the task scheduler.
+    std::size_t prefetch_offset = 0;
+    std::future<std::vector<u8>> prefetch;
+
+    std::vector<u8> chunk_buffer;
+
+    /// Writes the decrypted copy, and is stopped when the reader is destroyed.
+    std::jthread copy_thread;
+
     DirectRomFSReader() = default;
 
+    /// Maps the file if it can be read directly. Called with the file mutex held.
+    void MapFile();
+
+    std::size_t ReadAt(u8* buffer, std::size_t length, std::size_t offset);
+
+    /// Stores a chunk of data starting at a cache line boundary in the lines it covers.
+    void FillCache(std::size_t offset, const u8* data, std::size_t size);
+
+    /// Moves the chunk read ahead into the cache if it covers `page`, waiting for it if needed.
+    bool TakePrefetch(std::size_t page);
+
+    /// Starts reading the chunk after the one holding `offset` ahead, unless it is cached.
+    void StartPrefetch(std::size_t offset);
+
     std::size_t OffsetToPage(std::size_t offset) {
         return Common::AlignDown<std::size_t>(offset, cache_line_size);
     }
@@ -85,10 +151,14 @@ private:
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
+        std::scoped_lock lock{file_mutex};
         ar& boost::serialization::base_object<RomFSReader>(*this);
         ar & file;
         ar & file_offset;
         ar & data_size;
+        if (Archive::is_loading::value) {
+            MapFile();
+        }
     }
     friend class boost::serialization::access;
 };
@@ -40,9 +40,9 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
                                                                   u32 attributes) {
     LOG_DEBUG(Service_FS, "called path={} mode={:01X}", path.DebugStr(), mode.hex);
 
-    const PathParser path_parser(path);
+    const auto resolution = path_cache.Resolve(path, mount_point);
 
-    if (!path_parser.IsValid()) {
+    if (!resolution.is_valid) {
         LOG_ERROR(Service_FS, "Invalid path {}", path.DebugStr());
         return ResultInvalidPath;
     }
@@ -57,9 +57,9 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
         return ResultUnsupportedOpenFlags;
     }
 
-    const auto full_path = path_parser.BuildHostPath(mount_point);
+    const auto& full_path = resolution.host_path;
 
-    switch (path_parser.GetHostStatus(mount_point)) {
+    switch (resolution.status) {
     case PathParser::InvalidMountPoint:
         LOG_CRITICAL(Service_FS, "(unreachable) Invalid mount point {}", mount_point);
         return ResultFileNotFound;
@@ -86,6 +86,11 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
 
     FileUtil::IOFile file(full_path, mode.write_flag ? "r+b" : "rb");
     if (!file.IsOpen()) {
+        if (resolution.cached) {
+            // The file was removed from outside of the archive, check the path again
+            path_cache.Clear();
+            return OpenFile(path, mode, attributes);
+        }
         LOG_CRITICAL(Service_FS, "(unreachable) Unknown error opening {}", full_path);
         return ResultFileNotFound;
     }
@@ -95,6 +100,8 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
 }
 
 Result SaveDataArchive::DeleteFile(const Path& path) const {
+    path_cache.Clear();
+
     const PathParser path_parser(path);
 
     if (!path_parser.IsValid()) {
@@ -129,6 +136,8 @@ Result SaveDataArchive::DeleteFile(const Path& path) const {
 }
 
 Result SaveDataArchive::RenameFile(const Path& src_path, const Path& dest_path) const {
+    path_cache.Clear();
+
     const PathParser path_parser_src(src_path);
 
     // TODO: Verify these return codes with HW
@@ -196,15 +205,19 @@ static Result DeleteDirectoryHelper(const Path& path, const std::string& mount_p
 }
 
 Result SaveDataArchive::DeleteDirectory(const Path& path) const {
+    path_cache.Clear();
     return DeleteDirectoryHelper(path, mount_point, FileUtil::DeleteDir);
 }
 
 Result SaveDataArchive::DeleteDirectoryRecursively(const Path& path) const {
+    path_cache.Clear();
     return DeleteDirectoryHelper(
         path, mount_point, [](const std::string& p) { return FileUtil::DeleteDirRecursively(p); });
 }
 
 Result SaveDataArchive::CreateFile(const FileSys::Path& path, u64 size, u32 attributes) const {
+    path_cache.Clear();
+
     const PathParser path_parser(path);
 
     if (!path_parser.IsValid()) {
@@ -255,6 +268,8 @@ Result SaveDataArchive::CreateFile(const FileSys::Path& path, u64 size, u32 attr
 }
 
 Result SaveDataArchive::CreateDirectory(const Path& path, u32 attributes) const {
+    path_cache.Clear();
+
     const PathParser path_parser(path);
 
     if (!path_parser.IsValid()) {
@@ -292,6 +307,8 @@ Result SaveDataArchive::CreateDirectory(const Path& path, u32 attributes) const
 }
 
 Result SaveDataArchive::RenameDirectory(const Path& src_path, const Path& dest_path) const {
+    path_cache.Clear();
+
     const PathParser path_parser_src(src_path);
 
     // TODO: Verify these return codes with HW
@@ -321,16 +338,16 @@ Result SaveDataArchive::RenameDirectory(const Path& src_path, const Path& dest_p
 }
 
 ResultVal<std::unique_ptr<DirectoryBackend>> SaveDataArchive::OpenDirectory(const Path& path) {
-    const PathParser path_parser(path);
+    const auto resolution = path_cache.Resolve(path, mount_point);
 
-    if (!path_parser.IsValid()) {
+    if (!resolution.is_valid) {
         LOG_ERROR(Service_FS, "Invalid path {}", path.DebugStr());
         return ResultInvalidPath;
     }
 
-    const auto full_path = path_parser.BuildHostPath(mount_point);
+    const auto& full_path = resolution.host_path;
 
-    switch (path_parser.GetHostStatus(mount_point)) {
+    switch (resolution.status) {
     case PathParser::InvalidMountPoint:
         LOG_CRITICAL(Service_FS, "(unreachable) Invalid mount point {}", mount_point);
         return ResultFileNotFound;
@@ -8,6 +8,7 @@
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/directory_backend.h"
 #include "core/file_sys/file_backend.h"
+#include "core/file_sys/path_parser.h"
 #include "core/hle/result.h"
 
 namespace FileSys {
@@ -37,6 +38,7 @@ public:
 protected:
     std::string mount_point;
     bool allow_zero_size_create;
+    mutable PathCache path_cache;
     SaveDataArchive() = default;
 
 private:
@@ -44,9 +44,17 @@ bool ImageInterface::DecodeDDS(std::vector<u8>& dst, u32& width, u32& height, dd
 }
 
 bool ImageInterface::EncodePNG(const std::string& path, u32 width, u32 height,
-                               std::span<const u8> src) {
+                               std::span<const u8> src, bool fast) {
+    lodepng::State state;
+    if (fast) {
+        // Skip the filter search and use a small window, which is several times faster to encode
+        state.encoder.filter_strategy = LFS_ZERO;
+        state.encoder.zlibsettings.windowsize = 512;
+        state.encoder.zlibsettings.lazymatching = 0;
+        state.encoder.auto_convert = 0;
+    }
     std::vector<u8> out;
-    const u32 lodepng_ret = lodepng::encode(out, src.data(), width, height);
+    const u32 lodepng_ret = lodepng::encode(out, src.data(), width, height, state);
     if (lodepng_ret) {
         LOG_ERROR(Frontend, "Failed to encode {} because {}", path,
                   lodepng_error_text(lodepng_ret));
@@ -23,7 +23,13 @@ public:
     virtual bool DecodePNG(std::vector<u8>& dst, u32& width, u32& height, std::span<const u8> src);
     virtual bool DecodeDDS(std::vector<u8>& dst, u32& width, u32& height, ddsktx_format& format,
                            std::span<const u8> src);
-    virtual bool EncodePNG(const std::string& path, u32 width, u32 height, std::span<const u8> src);
+
+    /**
+     * Encodes src as an RGBA8 png and saves it to path.
+     * @param fast Trades a larger file for a much faster encode, for example when dumping
+     */
+    virtual bool EncodePNG(const std::string& path, u32 width, u32 height, std::span<const u8> src,
+                           bool fast = false);
 };
 
 } // namespace Frontend
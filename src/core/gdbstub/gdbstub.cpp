@@ -10,8 +10,11 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <map>
 #include <numeric>
+#include <optional>
+#include <vector>
 #include <fcntl.h>
 #include <fmt/format.h>
 
@@ -40,7 +43,8 @@
 
 namespace GDBStub {
 namespace {
-constexpr int GDB_BUFFER_SIZE = 10000;
+// Large enough for the target xml and for transferring big memory blocks in a single packet
+constexpr int GDB_BUFFER_SIZE = 0x10000;
 
 constexpr char GDB_STUB_START = '$';
 constexpr char GDB_STUB_END = '#';
@@ -55,6 +59,11 @@ constexpr u32 SIGTRAP = 5;
 constexpr u32 SIGTERM = 15;
 #endif
 
+// Binary data escapes the special characters as the escape byte followed by the character ^ 0x20
+constexpr u8 GDB_STUB_ESCAPE = '}';
+constexpr u8 GDB_STUB_ESCAPE_XOR = 0x20;
+constexpr u8 GDB_STUB_RUN_LENGTH = '*';
+
 #ifndef MSG_WAITALL
 constexpr u32 MSG_WAITALL = 8;
 #endif
@@ -151,8 +160,13 @@ struct Breakpoint {
     VAddr addr;
     u32 len;
     std::array<u8, 4> inst;
+    /// Agent expression bytecode of the target-side conditions, any of which triggers the break
+    std::vector<std::vector<u8>> conditions;
 };
 
+/// ARM BKPT instruction patched over the instruction of an execute breakpoint
+constexpr std::array<u8, 4> btrap{0x70, 0x00, 0x20, 0xe1};
+
 using BreakpointMap = std::map<VAddr, Breakpoint>;
 BreakpointMap breakpoints_execute;
 BreakpointMap breakpoints_read;
@@ -412,10 +426,7 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
         Core::System::GetInstance().Memory().WriteBlock(
             *Core::System::GetInstance().Kernel().GetCurrentProcess(), bp->second.addr,
             bp->second.inst.data(), bp->second.inst.size());
-        u32 num_cores = Core::GetNumCores();
-        for (u32 i = 0; i < num_cores; ++i) {
-            Core::GetCore(i).ClearInstructionCache();
-        }
+        Core::System::GetInstance().InvalidateCacheRange(bp->second.addr, bp->second.inst.size());
     }
     p.erase(addr);
 }
@@ -436,6 +447,305 @@ BreakpointAddress GetNextBreakpointFromAddress(VAddr addr, BreakpointType type)
     return breakpoint;
 }
 
+/**
+ * Evaluate a GDB agent expression, as sent for target-side breakpoint conditions.
+ *
+ * @param bytecode Agent expression bytecode.
+ * @param cpu CPU whose registers the expression reads.
+ * @return Value left on top of the stack, or std::nullopt if the expression could not be evaluated.
+ */
+static std::optional<u64> EvaluateAgentExpression(const std::vector<u8>& bytecode,
+                                                  const Core::ARM_Interface& cpu) {
+    // Bounds the evaluation of expressions that loop forever
+    constexpr std::size_t MaxSteps = 0x10000;
+    constexpr std::size_t MaxStackSize = 0x100;
+
+    auto& system = Core::System::GetInstance();
+    auto& memory = system.Memory();
+    const auto& process = *system.Kernel().GetCurrentProcess();
+
+    std::vector<u64> stack;
+    std::size_t pc = 0;
+    const auto operand = [&](std::size_t size) -> std::optional<u64> {
+        if (pc + size > bytecode.size()) {
+            return std::nullopt;
+        }
+        u64 value = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            value = (value << 8) | bytecode[pc++];
+        }
+        return value;
+    };
+    const auto sign_extend = [](u64 value, u64 bits) {
+        if (bits == 0 || bits >= 64) {
+            return value;
+        }
+        const u64 sign = u64{1} << (bits - 1);
+        value &= (sign << 1) - 1;
+        return (value ^ sign) - sign;
+    };
+
+    for (std::size_t step = 0; step < MaxSteps && pc < bytecode.size(); ++step) {
+        const u8 op = bytecode[pc++];
+
+        // Operations taking two operands, a being the one below the top of the stack
+        if ((op >= 0x02 && op <= 0x0b) || (op >= 0x0f && op <= 0x11) || op == 0x13 ||
+            op == 0x14 || op == 0x15) {
+            if (stack.size() < 2) {
+                return std::nullopt;
+            }
+            const u64 b = stack.back();
+            stack.pop_back();
+            const u64 a = stack.back();
+            const s64 sa = static_cast<s64>(a);
+            const s64 sb = static_cast<s64>(b);
+            if (b == 0 && op >= 0x05 && op <= 0x08) {
+                return std::nullopt;
+            }
+            u64& result = stack.back();
+            switch (op) {
+            case 0x02: // add
+                result = a + b;
+                break;
+            case 0x03: // sub
+                result = a - b;
+                break;
+            case 0x04: // mul
+                result = a * b;
+                break;
+            case 0x05: // div_signed
+                result = static_cast<u64>(sa / sb);
+                break;
+            case 0x06: // div_unsigned
+                result = a / b;
+                break;
+            case 0x07: // rem_signed
+                result = static_cast<u64>(sa % sb);
+                break;
+            case 0x08: // rem_unsigned
+                result = a % b;
+                break;
+            case 0x09: // lsh
+                result = b < 64 ? a << b : 0;
+                break;
+            case 0x0a: // rsh_signed
+                result = static_cast<u64>(sa >> std::min<u64>(b, 63));
+                break;
+            case 0x0b: // rsh_unsigned
+                result = b < 64 ? a >> b : 0;
+                break;
+            case 0x0f: // bit_and
+                result = a & b;
+                break;
+            case 0x10: // bit_or
+                result = a | b;
+                break;
+            case 0x11: // bit_xor
+                result = a ^ b;
+                break;
+            case 0x13: // equal
+                result = a == b;
+                break;
+            case 0x14: // less_signed
+                result = sa < sb;
+                break;
+            case 0x15: // less_unsigned
+                result = a < b;
+                break;
+            }
+            continue;
+        }
+
+        switch (op) {
+        case 0x0e: // log_not
+        case 0x12: // bit_not
+        case 0x16: // ext
+        case 0x2a: // zero_ext
+        case 0x17: // ref8
+        case 0x18: // ref16
+        case 0x19: // ref32
+        case 0x1a: { // ref64
+            if (stack.empty()) {
+                return std::nullopt;
+            }
+            u64& value = stack.back();
+            if (op == 0x0e) {
+                value = value == 0;
+            } else if (op == 0x12) {
+                value = ~value;
+            } else if (op == 0x16 || op == 0x2a) {
+                const auto bits = operand(1);
+                if (!bits) {
+                    return std::nullopt;
+                }
+                if (op == 0x16) {
+                    value = sign_extend(value, *bits);
+                } else if (*bits < 64) {
+                    value &= (u64{1} << *bits) - 1;
+                }
+            } else {
+                const auto address = static_cast<VAddr>(value);
+                if (!memory.IsValidVirtualAddress(process, address)) {
+                    return std::nullopt;
+                }
+                switch (op) {
+                case 0x17:
+                    value = memory.Read8(process, address);
+                    break;
+                case 0x18:
+                    value = memory.Read16(process, address);
+                    break;
+                case 0x19:
+                    value = memory.Read32(process, address);
+                    break;
+                default:
+                    value = memory.Read64(process, address);
+                    break;
+                }
+            }
+            break;
+        }
+        case 0x20:   // if_goto
+        case 0x21: { // goto
+            const auto target = operand(2);
+            if (!target) {
+                return std::nullopt;
+            }
+            bool jump = true;
+            if (op == 0x20) {
+                if (stack.empty()) {
+                    return std::nullopt;
+                }
+                jump = stack.back() != 0;
+                stack.pop_back();
+            }
+            if (jump) {
+                pc = static_cast<std::size_t>(*target);
+            }
+            break;
+        }
+        case 0x22:   // const8
+        case 0x23:   // const16
+        case 0x24:   // const32
+        case 0x25: { // const64
+            const auto value = operand(std::size_t{1} << (op - 0x22));
+            if (!value) {
+                return std::nullopt;
+            }
+            stack.push_back(*value);
+            break;
+        }
+        case 0x26: { // reg
+            const auto reg = operand(2);
+            if (!reg) {
+                return std::nullopt;
+            }
+            if (*reg <= PC_REGISTER) {
+                stack.push_back(cpu.GetReg(static_cast<int>(*reg)));
+            } else if (*reg == CPSR_REGISTER) {
+                stack.push_back(cpu.GetCPSR());
+            } else if (*reg >= D0_REGISTER && *reg < FPSCR_REGISTER) {
+                const int index = static_cast<int>(2 * (*reg - D0_REGISTER));
+                stack.push_back(cpu.GetVFPReg(index) |
+                                static_cast<u64>(cpu.GetVFPReg(index + 1)) << 32);
+            } else {
+                return std::nullopt;
+            }
+            break;
+        }
+        case 0x27: // end
+            if (stack.empty()) {
+                return std::nullopt;
+            }
+            return stack.back();
+        case 0x28: // dup
+            if (stack.empty()) {
+                return std::nullopt;
+            }
+            stack.push_back(stack.back());
+            break;
+        case 0x29: // pop
+            if (stack.empty()) {
+                return std::nullopt;
+            }
+            stack.pop_back();
+            break;
+        case 0x2b: // swap
+            if (stack.size() < 2) {
+                return std::nullopt;
+            }
+            std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+            break;
+        case 0x32: { // pick
+            const auto index = operand(1);
+            if (!index || *index >= stack.size()) {
+                return std::nullopt;
+            }
+            stack.push_back(stack[stack.size() - 1 - *index]);
+            break;
+        }
+        case 0x33: // rot
+            if (stack.size() < 3) {
+                return std::nullopt;
+            }
+            std::rotate(stack.end() - 3, stack.end() - 1, stack.end());
+            break;
+        default:
+            // Tracing, floating point and trace state variables are not supported
+            LOG_DEBUG(Debug_GDBStub, "Unsupported agent expression opcode {:02x}", op);
+            return std::nullopt;
+        }
+
+        if (stack.size() > MaxStackSize) {
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * Check if any of the conditions of a breakpoint holds. Conditions that can not be evaluated
+ * are treated as true, so that the breakpoint is reported rather than silently skipped.
+ *
+ * @param breakpoint Breakpoint to check.
+ * @param cpu CPU that hit the breakpoint.
+ */
+static bool EvaluateBreakpointConditions(const Breakpoint& breakpoint,
+                                         const Core::ARM_Interface& cpu) {
+    if (breakpoint.conditions.empty()) {
+        return true;
+    }
+    return std::any_of(breakpoint.conditions.begin(), breakpoint.conditions.end(),
+                       [&cpu](const std::vector<u8>& condition) {
+                           return EvaluateAgentExpression(condition, cpu).value_or(1) != 0;
+                       });
+}
+
+bool CheckBreakpointCondition(VAddr addr, const Core::ARM_Interface& cpu) {
+    const auto bp = breakpoints_execute.find(addr);
+    if (bp == breakpoints_execute.end()) {
+        return true;
+    }
+    return EvaluateBreakpointConditions(bp->second, cpu);
+}
+
+void StepOverBreakpoint(VAddr addr, const std::function<void()>& step) {
+    const auto bp = breakpoints_execute.find(addr);
+    if (bp == breakpoints_execute.end()) {
+        // The breakpoint was removed and its instruction restored in the meantime
+        return;
+    }
+
+    auto& system = Core::System::GetInstance();
+    auto& memory = system.Memory();
+    const auto& process = *system.Kernel().GetCurrentProcess();
+    memory.WriteBlock(process, addr, bp->second.inst.data(), bp->second.inst.size());
+    system.InvalidateCacheRange(addr, bp->second.inst.size());
+    step();
+    memory.WriteBlock(process, addr, btrap.data(), btrap.size());
+    system.InvalidateCacheRange(addr, btrap.size());
+}
+
 bool CheckBreakpoint(VAddr addr, BreakpointType type) {
     if (!IsConnected()) {
         return false;
@@ -462,7 +772,8 @@ bool CheckBreakpoint(VAddr addr, BreakpointType type) {
         len = 1;
     }
 
-    if (bp->second.active && (addr >= bp->second.addr && addr < bp->second.addr + len)) {
+    if (bp->second.active && (addr >= bp->second.addr && addr < bp->second.addr + len) &&
+        EvaluateBreakpointConditions(bp->second, Core::GetRunningCore())) {
         LOG_DEBUG(Debug_GDBStub,
                   "Found breakpoint type {} @ {:08x}, range: {:08x}"
                   " - {:08x} ({:x} bytes)",
@@ -485,19 +796,23 @@ static void SendPacket(const char packet) {
     }
 }
 
-void SendReply(const char* reply) {
+/**
+ * Send reply to gdb client. The reply may contain binary data.
+ *
+ * @param reply Reply to be sent to client.
+ * @param length Length of the reply in bytes.
+ */
+static void SendReply(const u8* reply, std::size_t length) {
     if (!IsConnected()) {
         return;
     }
 
-    std::memset(command_buffer, 0, sizeof(command_buffer));
-
-    command_length = static_cast<u32>(strlen(reply));
-    if (command_length + 4 > sizeof(command_buffer)) {
+    if (length + 4 > sizeof(command_buffer)) {
         LOG_ERROR(Debug_GDBStub, "command_buffer overflow in SendReply");
         return;
     }
 
+    command_length = static_cast<u32>(length);
     std::memcpy(command_buffer + 1, reply, command_length);
 
     u8 checksum = CalculateChecksum(command_buffer, command_length + 1);
@@ -521,6 +836,10 @@ void SendReply(const char* reply) {
     }
 }
 
+void SendReply(const char* reply) {
+    SendReply(reinterpret_cast<const u8*>(reply), std::strlen(reply));
+}
+
 /// Handle query command from gdb client.
 static void HandleQuery() {
     const char* query = reinterpret_cast<const char*>(command_buffer + 1);
@@ -530,7 +849,11 @@ static void HandleQuery() {
         SendReply("T0");
     } else if (strncmp(query, "Supported", strlen("Supported")) == 0) {
         // PacketSize needs to be large enough for target xml
-        SendReply("PacketSize=2000;qXfer:features:read+;qXfer:threads:read+");
+        const std::string supported =
+            fmt::format("PacketSize={:x};qXfer:features:read+;qXfer:threads:read+;"
+                        "ConditionalBreakpoints+",
+                        GDB_BUFFER_SIZE - 4);
+        SendReply(supported.c_str());
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
         SendReply(target_xml);
@@ -835,7 +1158,7 @@ static void ReadMemory() {
     LOG_DEBUG(Debug_GDBStub, "ReadMemory addr: {:08x} len: {:08x}", addr, len);
 
     if (len * 2 > sizeof(reply)) {
-        SendReply("E01");
+        return SendReply("E01");
     }
 
     auto& memory = Core::System::GetInstance().Memory();
@@ -876,7 +1199,90 @@ static void WriteMemory() {
 
     GdbHexToMem(data.data(), len_pos + 1, len);
     memory.WriteBlock(addr, data.data(), len);
-    Core::GetRunningCore().ClearInstructionCache();
+    Core::System::GetInstance().InvalidateCacheRange(addr, len);
+    SendReply("OK");
+}
+
+/// Read location in memory specified by gdb client, replying with binary data.
+static void ReadMemoryBinary() {
+    static u8 reply[GDB_BUFFER_SIZE - 4];
+
+    auto start_offset = command_buffer + 1;
+    auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
+    VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
+
+    start_offset = addr_pos + 1;
+    u32 len =
+        HexToInt(start_offset, static_cast<u32>((command_buffer + command_length) - start_offset));
+
+    LOG_DEBUG(Debug_GDBStub, "ReadMemoryBinary addr: {:08x} len: {:08x}", addr, len);
+
+    auto& memory = Core::System::GetInstance().Memory();
+    if (!memory.IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
+                                      addr)) {
+        return SendReply("E00");
+    }
+
+    // Escaping may grow the data, the client accepts a reply with fewer bytes than requested
+    len = std::min<u32>(len, sizeof(reply) - 1);
+    std::vector<u8> data(len);
+    memory.ReadBlock(addr, data.data(), len);
+
+    std::size_t reply_length = 0;
+    reply[reply_length++] = 'b';
+    for (const u8 byte : data) {
+        const bool escape = byte == GDB_STUB_START || byte == GDB_STUB_END ||
+                            byte == GDB_STUB_ESCAPE || byte == GDB_STUB_RUN_LENGTH;
+        if (reply_length + (escape ? 2 : 1) > sizeof(reply)) {
+            break;
+        }
+        if (escape) {
+            reply[reply_length++] = GDB_STUB_ESCAPE;
+            reply[reply_length++] = static_cast<u8>(byte ^ GDB_STUB_ESCAPE_XOR);
+        } else {
+            reply[reply_length++] = byte;
+        }
+    }
+    SendReply(reply, reply_length);
+}
+
+/// Modify location in memory with binary data received from the gdb client.
+static void WriteMemoryBinary() {
+    const auto end = command_buffer + command_length;
+    auto start_offset = command_buffer + 1;
+    auto addr_pos = std::find(start_offset, end, ',');
+    VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
+
+    start_offset = addr_pos + 1;
+    auto len_pos = std::find(start_offset, end, ':');
+    u32 len = HexToInt(start_offset, static_cast<u32>(len_pos - start_offset));
+
+    // GDB probes for support of the packet with an empty write
+    if (len == 0) {
+        return SendReply("OK");
+    }
+
+    auto& memory = Core::System::GetInstance().Memory();
+    if (!memory.IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
+                                      addr)) {
+        return SendReply("E00");
+    }
+
+    std::vector<u8> data;
+    data.reserve(len);
+    for (auto src = len_pos + 1; src < end && data.size() < len; ++src) {
+        if (*src == GDB_STUB_ESCAPE && src + 1 < end) {
+            data.push_back(static_cast<u8>(*++src ^ GDB_STUB_ESCAPE_XOR));
+        } else {
+            data.push_back(*src);
+        }
+    }
+    if (data.size() != len) {
+        return SendReply("E01");
+    }
+
+    memory.WriteBlock(addr, data.data(), len);
+    Core::System::GetInstance().InvalidateCacheRange(addr, len);
     SendReply("OK");
 }
 
@@ -895,7 +1301,6 @@ static void Step() {
     step_loop = true;
     halt_loop = true;
     send_trap = true;
-    Core::GetRunningCore().ClearInstructionCache();
 }
 
 bool IsMemoryBreak() {
@@ -911,7 +1316,6 @@ static void Continue() {
     memory_break = false;
     step_loop = false;
     halt_loop = false;
-    Core::GetRunningCore().ClearInstructionCache();
 }
 
 /**
@@ -920,24 +1324,34 @@ static void Continue() {
  * @param type Type of breakpoint.
  * @param addr Address of breakpoint.
  * @param len Length of breakpoint.
+ * @param conditions Agent expressions of the target-side conditions of the breakpoint.
  */
-static bool CommitBreakpoint(BreakpointType type, VAddr addr, u32 len) {
+static bool CommitBreakpoint(BreakpointType type, VAddr addr, u32 len,
+                             const std::vector<std::vector<u8>>& conditions) {
     BreakpointMap& p = GetBreakpointMap(type);
 
+    // GDB sends the breakpoint again when its conditions change, the instruction is patched already
+    const auto existing = p.find(addr);
+    if (existing != p.end()) {
+        existing->second.len = len;
+        existing->second.conditions = conditions;
+        return true;
+    }
+
     Breakpoint breakpoint;
     breakpoint.active = true;
     breakpoint.addr = addr;
     breakpoint.len = len;
+    breakpoint.conditions = conditions;
     Core::System::GetInstance().Memory().ReadBlock(
         *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, breakpoint.inst.data(),
         breakpoint.inst.size());
 
-    static constexpr std::array<u8, 4> btrap{0x70, 0x00, 0x20, 0xe1};
     if (type == BreakpointType::Execute) {
         Core::System::GetInstance().Memory().WriteBlock(
             *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, btrap.data(),
             btrap.size());
-        Core::GetRunningCore().ClearInstructionCache();
+        Core::System::GetInstance().InvalidateCacheRange(addr, btrap.size());
     }
     p.insert({addr, breakpoint});
 
@@ -974,22 +1388,36 @@ static void AddBreakpoint() {
     auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
     VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
 
+    const auto end = command_buffer + command_length;
     start_offset = addr_pos + 1;
-    u32 len =
-        HexToInt(start_offset, static_cast<u32>((command_buffer + command_length) - start_offset));
+    auto len_pos = std::find(start_offset, end, ';');
+    u32 len = HexToInt(start_offset, static_cast<u32>(len_pos - start_offset));
+
+    // Target-side conditions follow the length as ";X<size>,<agent expression bytecode in hex>"
+    std::vector<std::vector<u8>> conditions;
+    for (auto cond_pos = len_pos; end - cond_pos > 2 && cond_pos[1] == 'X';) {
+        auto size_pos = std::find(cond_pos + 2, end, ',');
+        u32 size = HexToInt(cond_pos + 2, static_cast<u32>(size_pos - (cond_pos + 2)));
+        if (size_pos == end || static_cast<std::size_t>(end - (size_pos + 1)) < size * 2) {
+            return SendReply("E01");
+        }
+        auto& condition = conditions.emplace_back(size);
+        GdbHexToMem(condition.data(), size_pos + 1, size);
+        cond_pos = size_pos + 1 + size * 2;
+    }
 
     if (type == BreakpointType::Access) {
         // Access is made up of Read and Write types, so add both breakpoints
         type = BreakpointType::Read;
 
-        if (!CommitBreakpoint(type, addr, len)) {
+        if (!CommitBreakpoint(type, addr, len, conditions)) {
             return SendReply("E02");
         }
 
         type = BreakpointType::Write;
     }
 
-    if (!CommitBreakpoint(type, addr, len)) {
+    if (!CommitBreakpoint(type, addr, len, conditions)) {
         return SendReply("E02");
     }
 
@@ -1059,6 +1487,9 @@ void HandlePacket(Core::System& system) {
 
     LOG_DEBUG(Debug_GDBStub, "Packet: {0:d} ('{0:c}')", command_buffer[0]);
 
+    // Memory writes and breakpoints of the packet are invalidated once it was handled
+    Core::CacheInvalidationBatch invalidation_batch{system};
+
     switch (command_buffer[0]) {
     case 'q':
         HandleQuery();
@@ -1096,6 +1527,12 @@ void HandlePacket(Core::System& system) {
     case 'M':
         WriteMemory();
         break;
+    case 'x':
+        ReadMemoryBinary();
+        break;
+    case 'X':
+        WriteMemoryBinary();
+        break;
     case 's':
         Step();
         return;
@@ -6,13 +6,15 @@
 
 #pragma once
 
+#include <functional>
 #include <span>
 #include "common/common_types.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Core {
+class ARM_Interface;
 class System;
-}
+} // namespace Core
 
 namespace GDBStub {
 
@@ -92,6 +94,24 @@ BreakpointAddress GetNextBreakpointFromAddress(VAddr addr, GDBStub::BreakpointTy
  */
 bool CheckBreakpoint(VAddr addr, GDBStub::BreakpointType type);
 
+/**
+ * Check if any of the target-side conditions of the execute breakpoint at the given address holds.
+ * Breakpoints without conditions always hold.
+ *
+ * @param addr Address of breakpoint.
+ * @param cpu CPU that hit the breakpoint.
+ */
+bool CheckBreakpointCondition(VAddr addr, const Core::ARM_Interface& cpu);
+
+/**
+ * Execute the instruction under the execute breakpoint at the given address without reporting
+ * the breakpoint. Only the code cache range of the instruction is invalidated.
+ *
+ * @param addr Address of breakpoint.
+ * @param step Callback that steps the CPU over a single instruction.
+ */
+void StepOverBreakpoint(VAddr addr, const std::function<void()>& step);
+
 // If set to true, the CPU will halt at the beginning of the next CPU loop.
 bool GetCpuHaltFlag();
 
@@ -25,51 +25,92 @@ namespace Kernel {
 void AddressArbiter::WaitThread(std::shared_ptr<Thread> thread, VAddr wait_address) {
     thread->wait_address = wait_address;
     thread->status = ThreadStatus::WaitArb;
-    waiting_threads.emplace_back(std::move(thread));
+    InsertThread(std::move(thread));
+}
+
+void AddressArbiter::InsertThread(std::shared_ptr<Thread> thread) {
+    auto& queue = waiting_threads[thread->wait_address];
+    // Note: The real kernel will pick the first thread in the list if more than one have the
+    // same highest priority value. Lower priority values mean higher priority.
+    const auto itr = std::upper_bound(queue.begin(), queue.end(), thread->current_priority,
+                                      [](u32 priority, const auto& other) {
+                                          return priority < other->current_priority;
+                                      });
+    thread->waiting_arbiter = this;
+    queue.insert(itr, std::move(thread));
+}
+
+std::shared_ptr<Thread> AddressArbiter::RemoveThread(const Thread& thread) {
+    const auto queue = waiting_threads.find(thread.wait_address);
+    if (queue == waiting_threads.end()) {
+        return nullptr;
+    }
+
+    auto& threads = queue->second;
+    const auto itr = std::find_if(threads.begin(), threads.end(),
+                                  [&thread](const auto& other) { return other.get() == &thread; });
+    if (itr == threads.end()) {
+        return nullptr;
+    }
+
+    auto removed = std::move(*itr);
+    threads.erase(itr);
+    if (threads.empty()) {
+        waiting_threads.erase(queue);
+    }
+    removed->waiting_arbiter = nullptr;
+    return removed;
+}
+
+void AddressArbiter::UpdateThreadPriority(Thread& thread) {
+    IndexLoadedThreads();
+    if (auto removed = RemoveThread(thread)) {
+        InsertThread(std::move(removed));
+    }
+}
+
+void AddressArbiter::IndexLoadedThreads() {
+    for (auto& thread : loaded_threads) {
+        InsertThread(std::move(thread));
+    }
+    loaded_threads.clear();
 }
 
 u64 AddressArbiter::ResumeAllThreads(VAddr address) {
     // Determine which threads are waiting on this address, those should be woken up.
-    auto itr = std::stable_partition(waiting_threads.begin(), waiting_threads.end(),
-                                     [address](const auto& thread) {
-                                         ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                                                    "Inconsistent AddressArbiter state");
-                                         return thread->wait_address != address;
-                                     });
+    const auto queue = waiting_threads.find(address);
+    if (queue == waiting_threads.end()) {
+        return 0;
+    }
+    const auto threads = std::move(queue->second);
+    waiting_threads.erase(queue);
 
     // Wake up all the found threads
-    const u64 num_threads = std::distance(itr, waiting_threads.end());
-    std::for_each(itr, waiting_threads.end(), [](auto& thread) { thread->ResumeFromWait(); });
-
-    // Remove the woken up threads from the wait list.
-    waiting_threads.erase(itr, waiting_threads.end());
-    return num_threads;
+    for (const auto& thread : threads) {
+        ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+        thread->waiting_arbiter = nullptr;
+        thread->ResumeFromWait();
+    }
+    return threads.size();
 }
 
 bool AddressArbiter::ResumeHighestPriorityThread(VAddr address) {
-    // Determine which threads are waiting on this address, those should be considered for wakeup.
-    auto matches_start = std::stable_partition(
-        waiting_threads.begin(), waiting_threads.end(), [address](const auto& thread) {
-            ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                       "Inconsistent AddressArbiter state");
-            return thread->wait_address != address;
-        });
-
-    // Iterate through threads, find highest priority thread that is waiting to be arbitrated.
-    // Note: The real kernel will pick the first thread in the list if more than one have the
-    // same highest priority value. Lower priority values mean higher priority.
-    auto itr = std::min_element(matches_start, waiting_threads.end(),
-                                [](const auto& lhs, const auto& rhs) {
-                                    return lhs->current_priority < rhs->current_priority;
-                                });
-
-    if (itr == waiting_threads.end()) {
+    const auto queue = waiting_threads.find(address);
+    if (queue == waiting_threads.end()) {
         return false;
     }
 
-    auto thread = *itr;
+    // The queue is ordered by priority, so the first thread is the one to wake up.
+    auto& threads = queue->second;
+    const auto thread = std::move(threads.front());
+    threads.pop_front();
+    if (threads.empty()) {
+        waiting_threads.erase(queue);
+    }
+
+    ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+    thread->waiting_arbiter = nullptr;
     thread->ResumeFromWait();
-    waiting_threads.erase(itr);
 
     return true;
 }
@@ -78,6 +119,14 @@ AddressArbiter::AddressArbiter(KernelSystem& kernel)
     : Object(kernel), kernel(kernel), timeout_callback(std::make_shared<Callback>(*this)) {}
 
 AddressArbiter::~AddressArbiter() {
+    for (const auto& [address, threads] : waiting_threads) {
+        for (const auto& thread : threads) {
+            thread->waiting_arbiter = nullptr;
+        }
+    }
+    for (const auto& thread : loaded_threads) {
+        thread->waiting_arbiter = nullptr;
+    }
     if (resource_limit) {
         resource_limit->Release(ResourceLimitType::AddressArbiter, 1);
     }
@@ -111,12 +160,14 @@ void AddressArbiter::WakeUp(ThreadWakeupReason reason, std::shared_ptr<Thread> t
                             std::shared_ptr<WaitObject> object) {
     ASSERT(reason == ThreadWakeupReason::Timeout);
     // Remove the newly-awakened thread from the Arbiter's waiting list.
-    waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                          waiting_threads.end());
+    IndexLoadedThreads();
+    RemoveThread(*thread);
 };
 
 Result AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type,
                                         VAddr address, s32 value, u64 nanoseconds) {
+    IndexLoadedThreads();
+
     switch (type) {
 
     // Signal thread(s) waiting for arbitrate address...
@@ -194,7 +245,20 @@ template <class Archive>
 void AddressArbiter::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Object>(*this);
     ar & name;
-    ar & waiting_threads;
+    // The waiting threads are stored as a single list, as they were before they were queued per
+    // address, which keeps older savestates loadable.
+    if (Archive::is_loading::value) {
+        ar & loaded_threads;
+        for (const auto& thread : loaded_threads) {
+            thread->waiting_arbiter = this;
+        }
+    } else {
+        std::vector<std::shared_ptr<Thread>> threads = loaded_threads;
+        for (const auto& [address, queue] : waiting_threads) {
+            threads.insert(threads.end(), queue.begin(), queue.end());
+        }
+        ar & threads;
+    }
     ar & timeout_callback;
     ar & resource_limit;
 }
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <boost/serialization/export.hpp>
 #include "common/common_types.h"
@@ -53,6 +55,10 @@ public:
     Result ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type, VAddr address,
                             s32 value, u64 nanoseconds);
 
+    /// Moves a waiting thread to its new place in the queue of its address after its priority
+    /// changed.
+    void UpdateThreadPriority(Thread& thread);
+
     class Callback;
 
 private:
@@ -61,6 +67,15 @@ private:
     /// Puts the thread to wait on the specified arbitration address under this address arbiter.
     void WaitThread(std::shared_ptr<Thread> thread, VAddr wait_address);
 
+    /// Inserts a thread in the queue of its wait address, after the threads of the same priority.
+    void InsertThread(std::shared_ptr<Thread> thread);
+
+    /// Removes a thread from the queue of its wait address and returns it, if it was waiting.
+    std::shared_ptr<Thread> RemoveThread(const Thread& thread);
+
+    /// Moves the threads read from a savestate into their queues.
+    void IndexLoadedThreads();
+
     /// Resume all threads found to be waiting on the address under this address arbiter
     u64 ResumeAllThreads(VAddr address);
 
@@ -68,8 +83,13 @@ private:
     /// the resumed thread.
     bool ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Threads waiting for the address arbiter to be signaled, per address. Each queue is ordered
+    /// by priority, then by the time the threads started waiting.
+    std::unordered_map<VAddr, std::deque<std::shared_ptr<Thread>>> waiting_threads;
+
+    /// Threads read from a savestate that are not in `waiting_threads` yet. Their wait address and
+    /// priority may not be loaded when the arbiter is, so they are only queued on first use.
+    std::vector<std::shared_ptr<Thread>> loaded_threads;
 
     std::shared_ptr<Callback> timeout_callback;
 
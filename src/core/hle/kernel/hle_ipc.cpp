@@ -326,6 +326,12 @@ void HLERequestContext::ReportUnimplemented() const {
     }
 }
 
+void HLERequestContext::ReportHandlerTime(std::chrono::nanoseconds handler_time) const {
+    if (kernel.GetIPCRecorder().IsEnabled()) {
+        kernel.GetIPCRecorder().SetHLEHandlerTime(thread, handler_time);
+    }
+}
+
 template <class Archive>
 void HLERequestContext::serialize(Archive& ar, const unsigned int) {
     ar & cmd_buf;
@@ -359,4 +365,9 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+std::vector<std::span<u8>> MappedBuffer::GetSegments(std::size_t offset, std::size_t size) {
+    ASSERT(offset + size <= this->size);
+    return memory->GetHostSegments(*process, address + static_cast<VAddr>(offset), size);
+}
+
 } // namespace Kernel
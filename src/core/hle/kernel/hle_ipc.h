@@ -9,6 +9,7 @@
 #include <chrono>
 #include <future>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <boost/container/small_vector.hpp>
@@ -127,6 +128,14 @@ public:
     // interface for service
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
+
+    /**
+     * Returns the guest memory of a range of the buffer as host segments, letting services read
+     * into or write from it without a temporary copy. Returns nothing when the range is not
+     * plain memory, Read and Write must be used then.
+     */
+    std::vector<std::span<u8>> GetSegments(std::size_t offset, std::size_t size);
+
     std::size_t GetSize() const {
         return size;
     }
@@ -269,6 +278,10 @@ private:
 
         void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
                     Kernel::ThreadWakeupReason reason) override {
+            // A thread woken at a fixed time can get there before its async section is done
+            if (future.valid()) {
+                future.wait();
+            }
             functor(ctx);
             kernel.ReportAsyncState(false);
         }
@@ -327,6 +340,66 @@ public:
         }
     }
 
+    /**
+     * Same as RunAsync, but queues async_section on a worker owned by the service instead of
+     * starting a thread for it. Sections queued on a single threaded worker run one at a time, in
+     * the order they were requested.
+     * @param worker Worker with a QueueWork method, such as Common::ThreadWorker
+     */
+    template <typename Worker, typename AsyncFunctor, typename ResultFunctor>
+    void RunAsyncOn(Worker& worker, AsyncFunctor async_section, ResultFunctor result_function) {
+        if (Settings::values.deterministic_async_operations) {
+            RunAsync(std::move(async_section), std::move(result_function), false);
+            return;
+        }
+
+        std::packaged_task<void()> task([this, async_section] {
+            s64 sleep_for = async_section(*this);
+            this->thread->WakeAfterDelay(sleep_for, true);
+        });
+        auto future = task.get_future();
+
+        kernel.ReportAsyncState(true);
+        this->SleepClientThread("RunAsync", std::chrono::nanoseconds(-1),
+                                std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
+                                    kernel, result_function, std::move(future)));
+        worker.QueueWork([task = std::move(task)]() mutable { task(); });
+    }
+
+    /**
+     * Same as RunAsyncOn, but the client thread is woken a fixed delay after the request instead
+     * of once async_section finishes, waiting for it if it is still running then. The result is
+     * delivered at the same emulated time however long the host takes, so that movies and
+     * savestates stay reproducible.
+     * @param worker Worker with a QueueWork method, such as Common::ThreadWorker
+     * @param delay Emulated duration of the operation
+     * @param async_section Callable that takes Kernel::HLERequestContext& as argument and
+     * doesn't return anything. This callable is ran asynchronously.
+     */
+    template <typename Worker, typename AsyncFunctor, typename ResultFunctor>
+    void RunAsyncOnWithDelay(Worker& worker, std::chrono::nanoseconds delay,
+                             AsyncFunctor async_section, ResultFunctor result_function) {
+        // A zero timeout would leave the thread waiting forever
+        delay = std::max(delay, std::chrono::nanoseconds{1});
+        if (Settings::values.deterministic_async_operations) {
+            async_section(*this);
+            kernel.ReportAsyncState(true);
+            this->SleepClientThread("RunAsync", delay,
+                                    std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
+                                        kernel, result_function, std::future<void>()));
+            return;
+        }
+
+        std::packaged_task<void()> task([this, async_section] { async_section(*this); });
+        auto future = task.get_future();
+
+        kernel.ReportAsyncState(true);
+        this->SleepClientThread("RunAsync", delay,
+                                std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
+                                    kernel, result_function, std::move(future)));
+        worker.QueueWork([task = std::move(task)]() mutable { task(); });
+    }
+
     /**
      * Resolves a object id from the request command buffer into a pointer to an object. See the
      * "HLE handle protocol" section in the class documentation for more details.
@@ -373,6 +446,9 @@ public:
     /// Reports an unimplemented function.
     void ReportUnimplemented() const;
 
+    /// Reports the host time the HLE handler spent on the request.
+    void ReportHandlerTime(std::chrono::nanoseconds handler_time) const;
+
     class ThreadCallback;
     friend class ThreadCallback;
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <optional>
 #include <boost/serialization/shared_ptr.hpp>
 #include "common/alignment.h"
 #include "common/archives.h"
@@ -22,6 +23,88 @@ SERIALIZE_EXPORT_IMPL(Kernel::MappedBufferContext)
 
 namespace Kernel {
 
+/// Returns whether the range overlaps a region whose pages may be cached by the rasterizer
+static bool IsRasterizerCacheable(VAddr address, u32 size) {
+    const auto overlaps = [address, size](VAddr region_start, VAddr region_end) {
+        return address < region_end && address + size > region_start;
+    };
+    return overlaps(Memory::LINEAR_HEAP_VADDR, Memory::LINEAR_HEAP_VADDR_END) ||
+           overlaps(Memory::NEW_LINEAR_HEAP_VADDR, Memory::NEW_LINEAR_HEAP_VADDR_END) ||
+           overlaps(Memory::VRAM_VADDR, Memory::VRAM_VADDR_END) ||
+           overlaps(Memory::PLUGIN_3GX_FB_VADDR, Memory::PLUGIN_3GX_FB_VADDR_END);
+}
+
+/**
+ * Returns the memory blocks backing a mapped buffer if its pages can be mapped into the target
+ * process directly. This requires the buffer to span whole pages outside of the regions the
+ * rasterizer caches. The cached page tracking only covers those regions at their fixed addresses,
+ * so accesses through the alias would neither flush nor invalidate the rasterizer cache.
+ */
+static std::optional<std::vector<std::pair<MemoryRef, u32>>> GetAliasableBlocks(Process& process,
+                                                                               VAddr address,
+                                                                               u32 size) {
+    if ((address & Memory::CITRA_PAGE_MASK) != 0 || (size & Memory::CITRA_PAGE_MASK) != 0) {
+        return std::nullopt;
+    }
+    if (IsRasterizerCacheable(address, size)) {
+        return std::nullopt;
+    }
+
+    const auto& page_table = *process.vm_manager.page_table;
+    for (VAddr page = address; page != address + size; page += Memory::CITRA_PAGE_SIZE) {
+        if (page_table.attributes[page >> Memory::CITRA_PAGE_BITS] != Memory::PageType::Memory) {
+            return std::nullopt;
+        }
+    }
+
+    auto blocks = process.vm_manager.GetBackingBlocksForRange(address, size);
+    if (blocks.Failed()) {
+        return std::nullopt;
+    }
+    return blocks.Unwrap();
+}
+
+/**
+ * Maps the blocks of an aliased mapped buffer between two guard pages in the IPC mapping region.
+ * The buffer pages are given the permissions of the mapped buffer instead of read/write.
+ */
+static VAddr MapAliasedBuffer(VMManager& vm_manager,
+                              const std::vector<std::pair<MemoryRef, u32>>& blocks, u32 num_pages,
+                              IPC::MappedBufferPermissions permissions) {
+    auto target_address_result = vm_manager.FindFreeRegion(
+        Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE,
+        (num_pages + 2) * Memory::CITRA_PAGE_SIZE);
+    ASSERT_MSG(target_address_result.Succeeded(), "Failed to map target address");
+    const VAddr target_address = target_address_result.Unwrap();
+
+    // The guard pages are never accessible, they only need to be backed by something.
+    std::shared_ptr<BackingMem> guard_pages =
+        std::make_shared<BufferMem>(2 * Memory::CITRA_PAGE_SIZE);
+    ASSERT(vm_manager
+               .MapBackingMemory(target_address, guard_pages, Memory::CITRA_PAGE_SIZE,
+                                 Kernel::MemoryState::Shared)
+               .Succeeded());
+
+    VAddr block_address = target_address + Memory::CITRA_PAGE_SIZE;
+    for (const auto& [backing_memory, block_size] : blocks) {
+        ASSERT(vm_manager
+                   .MapBackingMemory(block_address, backing_memory, block_size,
+                                     Kernel::MemoryState::Shared)
+                   .Succeeded());
+        block_address += block_size;
+    }
+    ASSERT(vm_manager.ReprotectRange(target_address + Memory::CITRA_PAGE_SIZE,
+                                     num_pages * Memory::CITRA_PAGE_SIZE,
+                                     static_cast<VMAPermission>(permissions & IPC::RW)) ==
+           ResultSuccess);
+
+    ASSERT(vm_manager
+               .MapBackingMemory(block_address, MemoryRef(guard_pages, Memory::CITRA_PAGE_SIZE),
+                                 Memory::CITRA_PAGE_SIZE, Kernel::MemoryState::Shared)
+               .Succeeded());
+    return target_address;
+}
+
 Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem& memory,
                               std::shared_ptr<Thread> src_thread,
                               std::shared_ptr<Thread> dst_thread, VAddr src_address,
@@ -104,9 +187,6 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
             IPC::StaticBufferDescInfo bufferInfo{descriptor};
             VAddr static_buffer_src_address = cmd_buf[i];
 
-            std::vector<u8> data(bufferInfo.size);
-            memory.ReadBlock(*src_process, static_buffer_src_address, data.data(), data.size());
-
             // Grab the address that the target thread set up to receive the response static buffer
             // and write our data there. The static buffers area is located right after the command
             // buffer area.
@@ -126,10 +206,12 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
 
             // Note: The real kernel doesn't seem to have any error recovery mechanisms for this
             // case.
-            ASSERT_MSG(target_buffer.descriptor.size >= data.size(),
+            ASSERT_MSG(target_buffer.descriptor.size >= bufferInfo.size,
                        "Static buffer data is too big");
 
-            memory.WriteBlock(*dst_process, target_buffer.address, data.data(), data.size());
+            // Copy the data straight from the source pages into the target ones.
+            memory.CopyBlock(*dst_process, *src_process, target_buffer.address,
+                             static_buffer_src_address, bufferInfo.size);
 
             cmd_buf[i++] = target_buffer.address;
             break;
@@ -166,7 +248,8 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
 
                 ASSERT(found != mapped_buffer_context.end());
 
-                if (permissions != IPC::MappedBufferPermissions::R) {
+                // Aliased buffers were modified in place.
+                if (permissions != IPC::MappedBufferPermissions::R && found->buffer) {
                     // Copy the modified buffer back into the target process
                     // NOTE: As this is a reply the "source" is the destination and the
                     //       "target" is the source.
@@ -198,24 +281,30 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
 
             // TODO(Subv): Perform permission checks.
 
-            // Create a buffer which contains the mapped buffer and two additional guard pages.
-            std::shared_ptr<BackingMem> buffer =
-                std::make_shared<BufferMem>((num_pages + 2) * Memory::CITRA_PAGE_SIZE);
-            memory.ReadBlock(*src_process, source_address,
-                             buffer->GetPtr() + Memory::CITRA_PAGE_SIZE + page_offset, size);
-
-            // Map the guard pages and mapped pages at once.
-            auto target_address_result = dst_process->vm_manager.MapBackingMemoryToBase(
-                Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE, buffer,
-                static_cast<u32>(buffer->GetSize()), Kernel::MemoryState::Shared);
-
-            ASSERT_MSG(target_address_result.Succeeded(), "Failed to map target address");
-            target_address = target_address_result.Unwrap();
+            std::shared_ptr<BackingMem> buffer;
+            if (const auto blocks = GetAliasableBlocks(*src_process, source_address, size)) {
+                // Map the source pages themselves, so nothing has to be copied either way.
+                target_address = MapAliasedBuffer(dst_process->vm_manager, *blocks, num_pages,
+                                                  permissions);
+            } else {
+                // Create a buffer which contains the mapped buffer and two additional guard pages.
+                buffer = std::make_shared<BufferMem>((num_pages + 2) * Memory::CITRA_PAGE_SIZE);
+                memory.ReadBlock(*src_process, source_address,
+                                 buffer->GetPtr() + Memory::CITRA_PAGE_SIZE + page_offset, size);
+
+                // Map the guard pages and mapped pages at once.
+                auto target_address_result = dst_process->vm_manager.MapBackingMemoryToBase(
+                    Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE, buffer,
+                    static_cast<u32>(buffer->GetSize()), Kernel::MemoryState::Shared);
+
+                ASSERT_MSG(target_address_result.Succeeded(), "Failed to map target address");
+                target_address = target_address_result.Unwrap();
+            }
 
             // Change the permissions and state of the guard pages.
             const VAddr low_guard_address = target_address;
             const VAddr high_guard_address =
-                low_guard_address + static_cast<VAddr>(buffer->GetSize()) - Memory::CITRA_PAGE_SIZE;
+                low_guard_address + (num_pages + 1) * Memory::CITRA_PAGE_SIZE;
             ASSERT(dst_process->vm_manager.ChangeMemoryState(
                        low_guard_address, Memory::CITRA_PAGE_SIZE, Kernel::MemoryState::Shared,
                        Kernel::VMAPermission::ReadWrite, Kernel::MemoryState::Reserved,
@@ -25,6 +25,8 @@ struct MappedBufferContext {
     VAddr source_address;
     VAddr target_address;
 
+    /// Copy of the buffer mapped into the target process, or null when the source pages were
+    /// mapped there directly.
     std::shared_ptr<BackingMem> buffer;
 
 private:
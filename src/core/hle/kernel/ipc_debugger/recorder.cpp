@@ -141,6 +141,18 @@ void Recorder::SetHLEUnimplemented(const std::shared_ptr<Kernel::Thread>& client
     record.status = RequestStatus::HLEUnimplemented;
 }
 
+void Recorder::SetHLEHandlerTime(const std::shared_ptr<Kernel::Thread>& client_thread,
+                                 std::chrono::nanoseconds handler_time) {
+    const u32 thread_id = client_thread->GetThreadId();
+    if (!record_map.count(thread_id)) {
+        // The reply was already written when the handler returned, or the recorder was enabled
+        // during the request
+        return;
+    }
+
+    record_map[thread_id]->hle_handler_time = handler_time;
+}
+
 CallbackHandle Recorder::BindCallback(CallbackType callback) {
     std::unique_lock lock(callback_mutex);
     CallbackHandle handle = std::make_shared<CallbackType>(callback);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <set>
@@ -56,6 +57,7 @@ struct RequestRecord {
     ObjectInfo server_session;
     std::string function_name; // Not available for LLE or portless
     bool is_hle = false;
+    std::chrono::nanoseconds hle_handler_time{}; // Only available for handled HLE requests
     // Request info is only available when status is not `Invalid` or `Sent`
     std::vector<u32> untranslated_request_cmdbuf;
     std::vector<u32> translated_request_cmdbuf;
@@ -103,6 +105,12 @@ public:
      */
     void SetHLEUnimplemented(const std::shared_ptr<Kernel::Thread>& client_thread);
 
+    /**
+     * Set the host time the HLE handler spent on the request of a record.
+     */
+    void SetHLEHandlerTime(const std::shared_ptr<Kernel::Thread>& client_thread,
+                           std::chrono::nanoseconds handler_time);
+
     /**
      * Set the status of the debugger (enabled/disabled).
      */
@@ -107,6 +107,18 @@ void KernelSystem::SetRunningCPU(Core::ARM_Interface* cpu) {
     }
 }
 
+void KernelSystem::SwitchRunningCPU(Core::ARM_Interface* cpu) {
+    if (current_process) {
+        stored_processes[current_cpu->GetID()] = current_process;
+    }
+    current_cpu = cpu;
+    timing.SetCurrentTimer(cpu->GetID());
+    if (const auto& process = stored_processes[current_cpu->GetID()]) {
+        current_process = process;
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+    }
+}
+
 ThreadManager& KernelSystem::GetThreadManager(u32 core_id) {
     return *thread_managers[core_id];
 }
@@ -289,6 +289,13 @@ public:
 
     void SetRunningCPU(Core::ARM_Interface* cpu);
 
+    /**
+     * Makes cpu the running CPU of the kernel and the timing without changing the page table of
+     * any CPU, for switching between cores that run in parallel. The page table of each core
+     * already belongs to its current process, as processes are only switched between slices.
+     */
+    void SwitchRunningCPU(Core::ARM_Interface* cpu);
+
     ThreadManager& GetThreadManager(u32 core_id);
     const ThreadManager& GetThreadManager(u32 core_id) const;
 
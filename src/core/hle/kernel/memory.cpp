@@ -269,15 +269,16 @@ std::optional<u32> MemoryRegionInfo::RLinearAllocate(u32 size) {
     return std::nullopt;
 }
 
-void MemoryRegionInfo::Free(u32 offset, u32 size) {
+bool MemoryRegionInfo::Free(u32 offset, u32 size) {
     if (is_locked) {
-        return;
+        return false;
     }
 
     Interval interval(offset, offset + size);
     ASSERT(!boost::icl::intersects(free_blocks, interval)); // must be allocated blocks
     free_blocks += interval;
     used -= size;
+    return true;
 }
 
 void MemoryRegionInfo::Unlock() {
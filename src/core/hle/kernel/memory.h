@@ -72,8 +72,9 @@ struct MemoryRegionInfo {
      * Frees one segment of memory. The memory must have been allocated as heap or linear heap.
      * @param offset the region address offset to the beginning of FCRAM.
      * @param size the size of the region to free.
+     * @returns true if the memory was freed, false if the region is locked.
      */
-    void Free(u32 offset, u32 size);
+    bool Free(u32 offset, u32 size);
 
     /**
      * Unlock the MemoryRegion. Used after loading is completed.
@@ -119,10 +119,10 @@ void Mutex::UpdatePriority() {
         return;
 
     u32 best_priority = ThreadPrioLowest;
-    for (auto& waiter : GetWaitingThreads()) {
-        if (waiter->current_priority < best_priority)
-            best_priority = waiter->current_priority;
-    }
+    ForEachWaitingThread([&best_priority](const Thread& waiter) {
+        if (waiter.current_priority < best_priority)
+            best_priority = waiter.current_priority;
+    });
 
     if (best_priority != priority) {
         priority = best_priority;
@@ -313,8 +313,7 @@ Result Process::HeapAllocate(VAddr* out_addr, VAddr target, u32 size, VMAPermiss
         u32 interval_size = interval.upper() - interval.lower();
         LOG_DEBUG(Kernel, "Allocated FCRAM region lower={:08X}, upper={:08X}", interval.lower(),
                   interval.upper());
-        std::fill(kernel.memory.GetFCRAMPointer(interval.lower()),
-                  kernel.memory.GetFCRAMPointer(interval.upper()), 0);
+        kernel.memory.DiscardFCRAM(interval.lower(), interval_size);
         auto vma = vm_manager.MapBackingMemory(interval_target,
                                                kernel.memory.GetFCRAMRef(interval.lower()),
                                                interval_size, memory_state);
@@ -345,7 +344,9 @@ Result Process::HeapFree(VAddr target, u32 size) {
     CASCADE_RESULT(auto backing_blocks, vm_manager.GetBackingBlocksForRange(target, size));
     for (const auto& [backing_memory, block_size] : backing_blocks) {
         const auto backing_offset = kernel.memory.GetFCRAMOffset(backing_memory.GetPtr());
-        memory_region->Free(backing_offset, block_size);
+        if (memory_region->Free(backing_offset, block_size)) {
+            kernel.memory.DiscardFCRAM(backing_offset, block_size);
+        }
         holding_memory -= MemoryRegionInfo::Interval(backing_offset, backing_offset + block_size);
     }
 
@@ -392,7 +393,7 @@ Result Process::LinearAllocate(VAddr* out_addr, VAddr target, u32 size, VMAPermi
 
     auto backing_memory = kernel.memory.GetFCRAMRef(physical_offset);
 
-    std::fill(backing_memory.GetPtr(), backing_memory.GetPtr() + size, 0);
+    kernel.memory.DiscardFCRAM(physical_offset, size);
     auto vma = vm_manager.MapBackingMemory(target, backing_memory, size, MemoryState::Continuous);
     ASSERT(vma.Succeeded());
     vm_manager.Reprotect(vma.Unwrap(), perms);
@@ -418,7 +419,9 @@ Result Process::LinearFree(VAddr target, u32 size) {
     R_TRY(vm_manager.UnmapRange(target, size));
 
     u32 physical_offset = target - GetLinearHeapAreaAddress(); // relative to FCRAM
-    memory_region->Free(physical_offset, size);
+    if (memory_region->Free(physical_offset, size)) {
+        kernel.memory.DiscardFCRAM(physical_offset, size);
+    }
 
     holding_memory -= MemoryRegionInfo::Interval(physical_offset, physical_offset + size);
     memory_used -= size;
@@ -602,7 +605,9 @@ void Process::FreeAllMemory() {
         LOG_DEBUG(Kernel, "Freeing process memory region 0x{:08X} - 0x{:08X}", entry.lower(),
                   entry.upper());
         auto size = entry.upper() - entry.lower();
-        memory_region->Free(entry.lower(), size);
+        if (memory_region->Free(entry.lower(), size)) {
+            kernel.memory.DiscardFCRAM(entry.lower(), size);
+        }
         memory_used -= size;
         resource_limit->Release(ResourceLimitType::Commit, size);
     }
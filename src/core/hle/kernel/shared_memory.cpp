@@ -22,7 +22,10 @@ SharedMemory::SharedMemory(KernelSystem& kernel) : Object(kernel), kernel(kernel
 
 SharedMemory::~SharedMemory() {
     for (const auto& interval : holding_memory) {
-        memory_region->Free(interval.lower(), interval.upper() - interval.lower());
+        const u32 size = interval.upper() - interval.lower();
+        if (memory_region->Free(interval.lower(), size)) {
+            kernel.memory.DiscardFCRAM(interval.lower(), size);
+        }
     }
 
     auto process = owner_process.lock();
@@ -58,7 +61,7 @@ ResultVal<std::shared_ptr<SharedMemory>> KernelSystem::CreateSharedMemory(
 
         ASSERT_MSG(offset, "Not enough space in region to allocate shared memory!");
 
-        std::fill(memory.GetFCRAMPointer(*offset), memory.GetFCRAMPointer(*offset + size), 0);
+        memory.DiscardFCRAM(*offset, size);
         shared_memory->backing_blocks = {{memory.GetFCRAMRef(*offset), size}};
         shared_memory->holding_memory += MemoryRegionInfo::Interval(*offset, *offset + size);
         shared_memory->linear_heap_phys_offset = *offset;
@@ -103,8 +106,7 @@ std::shared_ptr<SharedMemory> KernelSystem::CreateSharedMemoryForApplet(
     for (const auto& interval : backing_blocks) {
         shared_memory->backing_blocks.emplace_back(memory.GetFCRAMRef(interval.lower()),
                                                    interval.upper() - interval.lower());
-        std::fill(memory.GetFCRAMPointer(interval.lower()),
-                  memory.GetFCRAMPointer(interval.upper()), 0);
+        memory.DiscardFCRAM(interval.lower(), interval.upper() - interval.lower());
     }
     shared_memory->base_address = Memory::HEAP_VADDR + offset;
 
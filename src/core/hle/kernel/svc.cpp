@@ -11,6 +11,7 @@
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
 #include "common/settings.h"
+#include "common/tracing.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -410,6 +411,11 @@ private:
     Kernel::KernelSystem& kernel;
     Memory::MemorySystem& memory;
 
+    // Busy-wait detection state of the svcGetSystemTick polling loop running on this core
+    u32 tick_poll_pc{};
+    u64 tick_poll_ticks{};
+    u32 tick_poll_count{};
+
     friend class SVCWrapper<SVC>;
 
     // ARM interfaces
@@ -678,7 +684,7 @@ Result SVC::SendSyncRequest(Handle handle) {
     }
     const auto res = session->SendSyncRequest(thread);
     if (is_hle) {
-        system.perf_stats->EndIPCProcessing();
+        system.perf_stats->EndIPCProcessing(session->GetName());
     }
 
     return res;
@@ -1390,7 +1396,7 @@ Result SVC::CreateMutex(Handle* out_handle, u32 initial_locked) {
 Result SVC::ReleaseMutex(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called handle=0x{:08X}", handle);
 
-    std::shared_ptr<Mutex> mutex = kernel.GetCurrentProcess()->handle_table.Get<Mutex>(handle);
+    Mutex* mutex = kernel.GetCurrentProcess()->handle_table.GetBorrowed<Mutex>(handle);
     R_UNLESS(mutex, ResultInvalidHandle);
 
     return mutex->Release(kernel.GetCurrentThreadManager().GetCurrentThread());
@@ -1457,8 +1463,8 @@ Result SVC::CreateSemaphore(Handle* out_handle, s32 initial_count, s32 max_count
 Result SVC::ReleaseSemaphore(s32* count, Handle handle, s32 release_count) {
     LOG_TRACE(Kernel_SVC, "called release_count={}, handle=0x{:08X}", release_count, handle);
 
-    std::shared_ptr<Semaphore> semaphore =
-        kernel.GetCurrentProcess()->handle_table.Get<Semaphore>(handle);
+    Semaphore* semaphore =
+        kernel.GetCurrentProcess()->handle_table.GetBorrowed<Semaphore>(handle);
     R_UNLESS(semaphore, ResultInvalidHandle);
 
     return semaphore->Release(count, release_count);
@@ -1511,7 +1517,7 @@ Result SVC::QueryProcessMemory(MemoryInfo* memory_info, PageInfo* page_info, Han
         return v.second.permissions != permissions || v.second.meminfo_state != state;
     };
 
-    std::reverse_iterator rvma(vma);
+    decltype(process->vm_manager.vma_map)::const_reverse_iterator rvma(vma);
 
     auto lower = std::find_if(rvma, process->vm_manager.vma_map.crend(), mismatch);
     --lower;
@@ -1559,7 +1565,7 @@ Result SVC::DuplicateHandle(Handle* out, Handle handle) {
 Result SVC::SignalEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.GetBorrowed<Event>(handle);
     R_UNLESS(evt, ResultInvalidHandle);
 
     evt->Signal();
@@ -1570,7 +1576,7 @@ Result SVC::SignalEvent(Handle handle) {
 Result SVC::ClearEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.GetBorrowed<Event>(handle);
     R_UNLESS(evt, ResultInvalidHandle);
 
     evt->Clear();
@@ -1598,7 +1604,7 @@ Result SVC::CreateTimer(Handle* out_handle, u32 reset_type) {
 Result SVC::ClearTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.GetBorrowed<Timer>(handle);
     R_UNLESS(timer, ResultInvalidHandle);
 
     timer->Clear();
@@ -1611,7 +1617,7 @@ Result SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
 
     R_UNLESS(initial >= 0 && interval >= 0, ResultOutOfRangeKernel);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.GetBorrowed<Timer>(handle);
     R_UNLESS(timer, ResultInvalidHandle);
 
     timer->Set(initial, interval);
@@ -1623,7 +1629,7 @@ Result SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
 Result SVC::CancelTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.GetBorrowed<Timer>(handle);
     R_UNLESS(timer, ResultInvalidHandle);
 
     timer->Cancel();
@@ -1653,8 +1659,35 @@ void SVC::SleepThread(s64 nanoseconds) {
 
 /// This returns the total CPU ticks elapsed since the CPU was powered-on
 s64 SVC::GetSystemTick() {
-    // TODO: Use globalTicks here?
-    return system.GetRunningCore().GetTimer().GetTicks();
+    /// Number of consecutive polls from the same loop after which it is treated as a busy-wait
+    constexpr u32 BusyWaitPollThreshold = 8;
+    /// Longest time between two polls of a loop that only waits for the tick counter
+    constexpr u64 BusyWaitMaxLoopTicks = 1000;
+
+    auto& core = system.GetRunningCore();
+    auto& timer = core.GetTimer();
+    const u32 pc = core.GetPC();
+    const u64 ticks = timer.GetTicks();
+
+    // The guest reading the tick counter in a tight loop without any other SVC can only be
+    // waiting for time to pass, so jump to the next scheduled event instead of executing it.
+    if (pc == tick_poll_pc && ticks - tick_poll_ticks <= BusyWaitMaxLoopTicks) {
+        tick_poll_count++;
+    } else {
+        tick_poll_count = 0;
+    }
+    tick_poll_pc = pc;
+    tick_poll_ticks = ticks;
+
+    if (tick_poll_count < BusyWaitPollThreshold || !Settings::values.skip_busy_waits) {
+        // TODO: Use globalTicks here?
+        return ticks;
+    }
+
+    timer.Idle();
+    core.PrepareReschedule();
+    tick_poll_ticks = timer.GetTicks();
+    return tick_poll_ticks;
 }
 
 // Returns information of the specified handle
@@ -2152,8 +2185,9 @@ Result SVC::ControlProcess(Handle process_handle, u32 process_OP, u32 varg2, u32
     case ControlProcessOP::PROCESSOP_SET_MMU_TO_RWX: {
         for (auto it = process->vm_manager.vma_map.cbegin();
              it != process->vm_manager.vma_map.cend(); it++) {
+            // Reprotecting can merge VMAs, which invalidates the iterator
             if (it->second.meminfo_state != MemoryState::Free)
-                process->vm_manager.Reprotect(it, Kernel::VMAPermission::ReadWriteExecute);
+                it = process->vm_manager.Reprotect(it, Kernel::VMAPermission::ReadWriteExecute);
         }
         return ResultSuccess;
     }
@@ -2414,6 +2448,7 @@ MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
 
 void SVC::CallSVC(u32 immediate) {
     MICROPROFILE_SCOPE(Kernel_SVC);
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::SVC);
     system.perf_stats->BeginSVCProcessing();
 
     // Lock the kernel mutex when we enter the kernel HLE.
@@ -2424,6 +2459,10 @@ void SVC::CallSVC(u32 immediate) {
 
     const FunctionDef* info = GetSVCInfo(immediate);
     LOG_TRACE(Kernel_SVC, "calling {}", info->name);
+    if (immediate != 0x28) {
+        // Any other SVC means the loop polling the tick counter does more than waiting.
+        tick_poll_count = 0;
+    }
     if (info) {
         if (info->func) {
             system.GetRunningCore().GetTimer().AddTicks(info->cycles);
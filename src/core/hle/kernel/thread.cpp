@@ -17,6 +17,7 @@
 #include "core/arm/arm_interface.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
+#include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
@@ -91,7 +92,14 @@ void Thread::Acquire(Thread* thread) {
 Thread::Thread(KernelSystem& kernel, u32 core_id)
     : WaitObject(kernel), core_id(core_id), thread_manager(kernel.GetThreadManager(core_id)) {}
 
-Thread::~Thread() = default;
+Thread::~Thread() {
+    for (std::size_t i = 0; i < num_waiter_nodes_used; ++i) {
+        WaiterNode& node = waiter_nodes[i];
+        if (node.object) {
+            node.object->UnlinkWaiter(node);
+        }
+    }
+}
 
 Thread* ThreadManager::GetCurrentThread() const {
     return current_thread.get();
@@ -416,7 +424,11 @@ void Thread::SetPriority(u32 priority) {
     else
         thread_manager.ready_queue.prepare(priority);
 
+    const bool changed = priority != current_priority;
     nominal_priority = current_priority = priority;
+    if (changed && waiting_arbiter) {
+        waiting_arbiter->UpdateThreadPriority(*this);
+    }
 }
 
 void Thread::UpdatePriority() {
@@ -434,7 +446,11 @@ void Thread::BoostPriority(u32 priority) {
         thread_manager.ready_queue.move(this, current_priority, priority);
     else
         thread_manager.ready_queue.prepare(priority);
+    const bool changed = priority != current_priority;
     current_priority = priority;
+    if (changed && waiting_arbiter) {
+        waiting_arbiter->UpdateThreadPriority(*this);
+    }
 }
 
 std::shared_ptr<Thread> SetupMainThread(KernelSystem& kernel, u32 entry_point, u32 priority,
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <span>
 #include <string>
@@ -25,6 +26,7 @@
 
 namespace Kernel {
 
+class AddressArbiter;
 class Mutex;
 class Process;
 
@@ -320,8 +322,17 @@ public:
     /// passed to WaitSynchronization1/N.
     std::vector<std::shared_ptr<WaitObject>> wait_objects{};
 
+    /// Nodes that link the thread into the waiting lists of `wait_objects`. Slots are reused by
+    /// later waits and never freed, so their addresses stay valid while they are linked.
+    std::deque<WaiterNode> waiter_nodes{};
+    std::size_t num_waiter_nodes_used = 0;   ///< Slots handed out since none was last linked
+    std::size_t num_waiter_nodes_linked = 0; ///< Slots currently linked into a waiting list
+
     VAddr wait_address; ///< If waiting on an AddressArbiter, this is the arbitration address
 
+    /// Arbiter the thread is waiting on, which has to be told when the thread's priority changes.
+    AddressArbiter* waiting_arbiter = nullptr;
+
     std::string name{};
 
     /// Callback that will be invoked when the thread is resumed from a waiting state. If the thread
@@ -4,11 +4,11 @@
 
 #include <algorithm>
 #include <iterator>
-#include <boost/serialization/map.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/split_member.hpp>
 #include "common/archives.h"
 #include "common/assert.h"
+#include "common/serialization/boost_flat_map.h"
 #include "core/core.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/vm_manager.h"
@@ -77,15 +77,22 @@ void VMManager::Reset() {
 VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
     if (target >= MAX_ADDRESS) {
         return vma_map.end();
-    } else {
-        return std::prev(vma_map.upper_bound(target));
     }
-}
 
-ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, MemoryRef memory,
-                                                   u32 size, MemoryState state) {
-    ASSERT(!is_locked);
+    const std::size_t last_index = last_vma_index.load(std::memory_order_relaxed);
+    if (last_index < vma_map.size()) {
+        const VMAHandle last = vma_map.nth(last_index);
+        if (target >= last->second.base && target - last->second.base < last->second.size) {
+            return last;
+        }
+    }
+
+    const VMAHandle vma = std::prev(vma_map.upper_bound(target));
+    last_vma_index.store(vma_map.index_of(vma), std::memory_order_relaxed);
+    return vma;
+}
 
+ResultVal<VAddr> VMManager::FindFreeRegion(VAddr base, u32 region_size, u32 size) const {
     // Find the first Free VMA.
     VMAHandle vma_handle = std::find_if(vma_map.begin(), vma_map.end(), [&](const auto& vma) {
         if (vma.second.type != VMAType::Free)
@@ -95,15 +102,28 @@ ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size,
         return vma_end > base && vma_end >= base + size;
     });
 
-    VAddr target = std::max(base, vma_handle->second.base);
-
     // Do not try to allocate the block if there are no available addresses within the desired
     // region.
-    if (vma_handle == vma_map.end() || target + size > base + region_size) {
+    if (vma_handle == vma_map.end()) {
+        return Result(ErrorDescription::OutOfMemory, ErrorModule::Kernel,
+                      ErrorSummary::OutOfResource, ErrorLevel::Permanent);
+    }
+
+    VAddr target = std::max(base, vma_handle->second.base);
+    if (target + size > base + region_size) {
         return Result(ErrorDescription::OutOfMemory, ErrorModule::Kernel,
                       ErrorSummary::OutOfResource, ErrorLevel::Permanent);
     }
 
+    return target;
+}
+
+ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, MemoryRef memory,
+                                                   u32 size, MemoryState state) {
+    ASSERT(!is_locked);
+
+    CASCADE_RESULT(const VAddr target, FindFreeRegion(base, region_size, size));
+
     auto result = MapBackingMemory(target, memory, size, state);
 
     if (result.Failed())
@@ -158,10 +178,9 @@ Result VMManager::ChangeMemoryState(VAddr target, u32 size, MemoryState expected
 
     CASCADE_RESULT(auto vma, CarveVMARange(target, size));
 
-    const VMAIter end = vma_map.end();
     // The comparison against the end of the range must be done using addresses since VMAs can be
     // merged during this process, causing invalidation of the iterators.
-    while (vma != end && vma->second.base < target_end) {
+    while (vma != vma_map.end() && vma->second.base < target_end) {
         vma->second.permissions = new_perms;
         vma->second.meminfo_state = new_state;
         UpdatePageTableForVMA(vma->second);
@@ -191,10 +210,9 @@ Result VMManager::UnmapRange(VAddr target, u32 size) {
     CASCADE_RESULT(VMAIter vma, CarveVMARange(target, size));
     const VAddr target_end = target + size;
 
-    const VMAIter end = vma_map.end();
     // The comparison against the end of the range must be done using addresses since VMAs can be
     // merged during this process, causing invalidation of the iterators.
-    while (vma != end && vma->second.base < target_end) {
+    while (vma != vma_map.end() && vma->second.base < target_end) {
         vma = std::next(Unmap(vma));
     }
 
@@ -220,10 +238,9 @@ Result VMManager::ReprotectRange(VAddr target, u32 size, VMAPermission new_perms
     CASCADE_RESULT(VMAIter vma, CarveVMARange(target, size));
     const VAddr target_end = target + size;
 
-    const VMAIter end = vma_map.end();
     // The comparison against the end of the range must be done using addresses since VMAs can be
     // merged during this process, causing invalidation of the iterators.
-    while (vma != end && vma->second.base < target_end) {
+    while (vma != vma_map.end() && vma->second.base < target_end) {
         vma = std::next(StripIterConstness(Reprotect(vma, new_perms)));
     }
 
@@ -247,9 +264,7 @@ void VMManager::Unlock() {
 }
 
 VMManager::VMAIter VMManager::StripIterConstness(const VMAHandle& iter) {
-    // This uses a neat C++ trick to convert a const_iterator to a regular iterator, given
-    // non-const access to its container.
-    return vma_map.erase(iter, iter); // Erases an empty range of elements
+    return vma_map.nth(vma_map.index_of(iter));
 }
 
 ResultVal<VMManager::VMAIter> VMManager::CarveVMA(VAddr base, u32 size) {
@@ -278,7 +293,7 @@ ResultVal<VMManager::VMAIter> VMManager::CarveVMA(VAddr base, u32 size) {
 
     if (end_in_vma != vma.size) {
         // Split VMA at the end of the allocated region
-        SplitVMA(vma_handle, end_in_vma);
+        vma_handle = std::prev(SplitVMA(vma_handle, end_in_vma));
     }
     if (start_in_vma != 0) {
         // Split VMA at the start of the allocated region
@@ -304,13 +319,15 @@ ResultVal<VMManager::VMAIter> VMManager::CarveVMARange(VAddr target, u32 size) {
         return ResultInvalidAddressState;
     }
 
-    if (target != begin_vma->second.base) {
-        begin_vma = SplitVMA(begin_vma, target - begin_vma->second.base);
-    }
-
+    // The end is split first, as splitting invalidates the iterators to the map
     VMAIter end_vma = StripIterConstness(FindVMA(target_end));
     if (end_vma != vma_map.end() && target_end != end_vma->second.base) {
-        end_vma = SplitVMA(end_vma, target_end - end_vma->second.base);
+        SplitVMA(end_vma, target_end - end_vma->second.base);
+    }
+
+    begin_vma = StripIterConstness(FindVMA(target));
+    if (target != begin_vma->second.base) {
+        begin_vma = SplitVMA(begin_vma, target - begin_vma->second.base);
     }
 
     return begin_vma;
@@ -4,8 +4,9 @@
 
 #pragma once
 
-#include <map>
+#include <atomic>
 #include <memory>
+#include <boost/container/flat_map.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/common_types.h"
 #include "common/memory_ref.h"
@@ -106,9 +107,9 @@ public:
      * VMA. It must always be modified by splitting or merging VMAs, so that the invariant
      * `elem.base + elem.size == next.base` is preserved, and mergeable regions must always be
      * merged when possible so that no two similar and adjacent regions exist that have not been
-     * merged.
+     * merged. The VMAs are stored contiguously, so any modification invalidates iterators.
      */
-    std::map<VAddr, VirtualMemoryArea> vma_map;
+    boost::container::flat_map<VAddr, VirtualMemoryArea> vma_map;
     using VMAHandle = decltype(vma_map)::const_iterator;
 
     explicit VMManager(Memory::MemorySystem& memory, Kernel::Process& proc);
@@ -117,9 +118,22 @@ public:
     /// Clears the address space map, re-initializing with a single free area.
     void Reset();
 
-    /// Finds the VMA in which the given address is included in, or `vma_map.end()`.
+    /**
+     * Finds the VMA in which the given address is included in, or `vma_map.end()`. The last VMA
+     * found is checked first, as consecutive lookups mostly land in the same one.
+     */
     VMAHandle FindVMA(VAddr target) const;
 
+    /**
+     * Finds the first free address range of the given size after the given base.
+     *
+     * @param base The base address to start searching at.
+     * @param region_size The max size of the region from where we'll try to find an address.
+     * @param size Size of the free range.
+     * @returns The address at which the free range starts.
+     */
+    ResultVal<VAddr> FindFreeRegion(VAddr base, u32 region_size, u32 size) const;
+
     // TODO(yuriks): Should these functions actually return the handle?
 
     /**
@@ -208,7 +222,8 @@ private:
 
     /**
      * Splits a VMA in two, at the specified offset.
-     * @returns the right side of the split, with the original iterator becoming the left side.
+     * @returns the right side of the split, the left side being the element before it. Like any
+     * modification of the map, this invalidates the original iterator.
      */
     VMAIter SplitVMA(VMAIter vma, u32 offset_in_vma);
 
@@ -224,6 +239,9 @@ private:
     Memory::MemorySystem& memory;
     Kernel::Process& process;
 
+    /// Index of the VMA last returned by FindVMA, which may be stale and is checked before use.
+    mutable std::atomic<std::size_t> last_vma_index{0};
+
     // When locked, ChangeMemoryState calls will be ignored, other modification calls will hit an
     // assert. VMManager locks itself after deserialization.
     bool is_locked{};
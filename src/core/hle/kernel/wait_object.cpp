@@ -25,33 +25,85 @@ namespace Kernel {
 template <class Archive>
 void WaitObject::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Object>(*this);
+    // The waiting threads are stored as a list of threads, as they were before the list became
+    // intrusive, which keeps older savestates loadable.
+    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    if (!Archive::is_loading::value) {
+        waiting_threads = GetWaitingThreads();
+    }
     ar & waiting_threads;
+    if (Archive::is_loading::value) {
+        for (const auto& thread : waiting_threads) {
+            LinkWaiter(*thread);
+        }
+    }
     // NB: hle_notifier *not* serialized since it's a callback!
     // Fortunately it's only used in one place (DSP) so we can reconstruct it there
 }
 SERIALIZE_IMPL(WaitObject)
 
+WaitObject::~WaitObject() {
+    while (first_waiter) {
+        UnlinkWaiter(*first_waiter);
+    }
+}
+
+void WaitObject::LinkWaiter(Thread& thread) {
+    if (thread.num_waiter_nodes_used == thread.waiter_nodes.size()) {
+        thread.waiter_nodes.emplace_back();
+    }
+    WaiterNode& node = thread.waiter_nodes[thread.num_waiter_nodes_used++];
+    thread.num_waiter_nodes_linked++;
+
+    node.thread = &thread;
+    node.object = this;
+    node.prev = last_waiter;
+    node.next = nullptr;
+    (last_waiter ? last_waiter->next : first_waiter) = &node;
+    last_waiter = &node;
+}
+
+void WaitObject::UnlinkWaiter(WaiterNode& node) {
+    (node.prev ? node.prev->next : first_waiter) = node.next;
+    (node.next ? node.next->prev : last_waiter) = node.prev;
+    node.object = nullptr;
+    node.prev = nullptr;
+    node.next = nullptr;
+
+    // Once the thread has left every list its slots can be handed out again from the start.
+    Thread& thread = *node.thread;
+    if (--thread.num_waiter_nodes_linked == 0) {
+        thread.num_waiter_nodes_used = 0;
+    }
+}
+
 void WaitObject::AddWaitingThread(std::shared_ptr<Thread> thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    // A thread is only listed once, even if it passed the same object several times. All the
+    // objects of a wait are added together, so a repeat is always the last thread in the list.
+    if (last_waiter && last_waiter->thread == thread.get())
+        return;
+    LinkWaiter(*thread);
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
-    auto itr = std::find_if(waiting_threads.begin(), waiting_threads.end(),
-                            [thread](const auto& p) { return p.get() == thread; });
     // If a thread passed multiple handles to the same object,
     // the kernel might attempt to remove the thread from the object's
     // waiting threads list multiple times.
-    if (itr != waiting_threads.end())
-        waiting_threads.erase(itr);
+    for (std::size_t i = 0; i < thread->num_waiter_nodes_used; ++i) {
+        WaiterNode& node = thread->waiter_nodes[i];
+        if (node.object == this) {
+            UnlinkWaiter(node);
+            return;
+        }
+    }
 }
 
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
     Thread* candidate = nullptr;
     u32 candidate_priority = ThreadPrioLowest + 1;
 
-    for (const auto& thread : waiting_threads) {
+    for (const WaiterNode* node = first_waiter; node != nullptr; node = node->next) {
+        Thread* const thread = node->thread;
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
                        thread->status == ThreadStatus::WaitSynchAll ||
@@ -61,7 +113,7 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
         if (thread->current_priority >= candidate_priority)
             continue;
 
-        if (ShouldWait(thread.get()))
+        if (ShouldWait(thread))
             continue;
 
         // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
@@ -69,13 +121,13 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
         bool ready_to_run = true;
         if (thread->status == ThreadStatus::WaitSynchAll) {
             ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const std::shared_ptr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
+                                        [thread](const std::shared_ptr<WaitObject>& object) {
+                                            return object->ShouldWait(thread);
                                         });
         }
 
         if (ready_to_run) {
-            candidate = thread.get();
+            candidate = thread;
             candidate_priority = thread->current_priority;
         }
     }
@@ -108,8 +160,10 @@ void WaitObject::WakeupAllWaitingThreads() {
         hle_notifier();
 }
 
-const std::vector<std::shared_ptr<Thread>>& WaitObject::GetWaitingThreads() const {
-    return waiting_threads;
+std::vector<std::shared_ptr<Thread>> WaitObject::GetWaitingThreads() const {
+    std::vector<std::shared_ptr<Thread>> threads;
+    ForEachWaitingThread([&threads](Thread& thread) { threads.push_back(SharedFrom(&thread)); });
+    return threads;
 }
 
 void WaitObject::SetHLENotifier(std::function<void()> callback) {
@@ -13,11 +13,24 @@
 namespace Kernel {
 
 class Thread;
+class WaitObject;
+
+/**
+ * Entry of a thread in the list of threads waiting on an object. Each thread owns one node per
+ * object it waits on, so joining and leaving a wait list never allocates.
+ */
+struct WaiterNode {
+    Thread* thread = nullptr;
+    WaitObject* object = nullptr; ///< Object whose list the node is linked into, if any
+    WaiterNode* prev = nullptr;
+    WaiterNode* next = nullptr;
+};
 
 /// Class that represents a Kernel object that a thread can be waiting on
 class WaitObject : public Object {
 public:
     using Object::Object;
+    ~WaitObject() override;
 
     /**
      * Check if the specified thread should wait until the object is available
@@ -50,20 +63,40 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     std::shared_ptr<Thread> GetHighestPriorityReadyThread() const;
 
-    /// Get a const reference to the waiting threads list for debug use
-    const std::vector<std::shared_ptr<Thread>>& GetWaitingThreads() const;
+    /// Calls `func` with every thread waiting on this object, in the order they started waiting.
+    template <typename Func>
+    void ForEachWaitingThread(Func&& func) const {
+        for (const WaiterNode* node = first_waiter; node != nullptr;) {
+            // Fetch the next node first, in case `func` removes the thread from the list.
+            const WaiterNode* next = node->next;
+            func(*node->thread);
+            node = next;
+        }
+    }
+
+    /// Get a copy of the waiting threads list for debug use
+    std::vector<std::shared_ptr<Thread>> GetWaitingThreads() const;
 
     /// Sets a callback which is called when the object becomes available
     void SetHLENotifier(std::function<void()> callback);
 
 private:
-    /// Threads waiting for this object to become available
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Links a node of the thread to the end of the waiting threads list.
+    void LinkWaiter(Thread& thread);
+
+    /// Unlinks a node from the waiting threads list.
+    void UnlinkWaiter(WaiterNode& node);
+
+    /// Threads waiting for this object to become available, as an intrusive list of the
+    /// threads' nodes.
+    WaiterNode* first_waiter = nullptr;
+    WaiterNode* last_waiter = nullptr;
 
     /// Function to call when this object becomes available
     std::function<void()> hle_notifier;
 
 private:
+    friend class Thread;
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
@@ -9,12 +9,15 @@
 #include <cryptopp/modes.h>
 #include <fmt/format.h>
 #include <openssl/rand.h>
+#include "common/aes.h"
 #include "common/alignment.h"
 #include "common/archives.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/hacks/hack_manager.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
@@ -49,6 +52,8 @@ SERVICE_CONSTRUCT_IMPL(Service::AM::Module)
 
 namespace Service::AM {
 
+using namespace Common::Literals;
+
 constexpr u16 PLATFORM_CTR = 0x0004;
 constexpr u16 CATEGORY_SYSTEM = 0x0010;
 constexpr u16 CATEGORY_DLP = 0x0001;
@@ -59,6 +64,10 @@ constexpr u32 TID_HIGH_DLC = 0x0004008C;
 constexpr u8 OWNERSHIP_DOWNLOADED = 0x01;
 constexpr u8 OWNERSHIP_OWNED = 0x02;
 
+// InstallCIA reads the CIA in chunks of this size, keeping at most this many chunks read ahead
+constexpr std::size_t InstallChunkSize = 1_MiB;
+constexpr std::size_t InstallReadQueueDepth = 8;
+
 struct ContentInfo {
     u16_le index;
     u16_le type;
@@ -104,6 +113,36 @@ NCCHCryptoFile::NCCHCryptoFile(const std::string& out_file, bool encrypted_conte
 
     if (!file->IsOpen()) {
         is_error = true;
+        return;
+    }
+
+    writer = std::jthread([this] {
+        // An empty buffer marks the end of the writes.
+        for (std::vector<u8> data = write_queue.PopWait(); !data.empty();
+             data = write_queue.PopWait()) {
+            if (file->WriteBytes(data.data(), data.size()) != data.size()) {
+                write_failed = true;
+            }
+        }
+    });
+}
+
+NCCHCryptoFile::~NCCHCryptoFile() {
+    if (writer.joinable()) {
+        write_queue.EmplaceWait();
+        writer.join();
+    }
+}
+
+void NCCHCryptoFile::WriteOut(const void* data, std::size_t length) {
+    const auto bytes = static_cast<const u8*>(data);
+    pending.insert(pending.end(), bytes, bytes + length);
+}
+
+void NCCHCryptoFile::SubmitPending() {
+    if (!pending.empty()) {
+        write_queue.EmplaceWait(std::move(pending));
+        pending = {};
     }
 }
 
@@ -111,8 +150,10 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
     if (is_error)
         return;
 
+    SCOPE_EXIT({ SubmitPending(); });
+
     if (is_not_ncch) {
-        file->WriteBytes(buffer, length);
+        WriteOut(buffer, length);
         return;
     }
 
@@ -130,8 +171,8 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
         if (Loader::MakeMagic('N', 'C', 'C', 'H') != ncch_header.magic) {
             // Most likely DS contents, store without additional operations
             is_not_ncch = true;
-            file->WriteBytes(&ncch_header, sizeof(ncch_header));
-            file->WriteBytes(buffer, length);
+            WriteOut(&ncch_header, sizeof(ncch_header));
+            WriteOut(buffer, length);
             return;
         }
 
@@ -295,7 +336,7 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
 
         u8 prev_crypto = ncch_header.no_crypto;
         ncch_header.no_crypto.Assign(1);
-        file->WriteBytes(&ncch_header, sizeof(ncch_header));
+        WriteOut(&ncch_header, sizeof(ncch_header));
         written += sizeof(ncch_header);
         ncch_header.no_crypto.Assign(prev_crypto);
     }
@@ -326,7 +367,7 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
         if (!reg.has_value()) {
             // This file has no encryption
             size_t to_write = length;
-            file->WriteBytes(buffer, to_write);
+            WriteOut(buffer, to_write);
             written += to_write;
             buffer += to_write;
             length -= to_write;
@@ -334,14 +375,17 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
             if (written < reg->offset) {
                 // Not inside a crypto region
                 size_t to_write = std::min(length, reg->offset - written);
-                file->WriteBytes(buffer, to_write);
+                WriteOut(buffer, to_write);
                 written += to_write;
                 buffer += to_write;
                 length -= to_write;
             } else {
                 size_t to_write = std::min(length, (reg->offset + reg->size) - written);
                 if (is_encrypted) {
-                    std::vector<u8> temp(to_write);
+                    // Decrypt straight into the data handed to the writer thread.
+                    const std::size_t pending_offset = pending.size();
+                    pending.resize(pending_offset + to_write);
+                    u8* const temp = pending.data() + pending_offset;
 
                     std::array<u8, 16>* key = nullptr;
                     std::array<u8, 16>* ctr = nullptr;
@@ -361,19 +405,17 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
                         ctr = &romfs_ctr;
                     }
 
-                    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key->data(), key->size(),
-                                                                    ctr->data());
+                    Common::AES::CTR d(key->data(), key->size(), ctr->data());
                     size_t offset = written - reg->seek_from;
                     if (offset != 0) {
                         d.Seek(offset);
                     }
-                    d.ProcessData(temp.data(), buffer, to_write);
-                    file->WriteBytes(temp.data(), to_write);
+                    d.ProcessData(temp, buffer, to_write);
 
                     if (reg->type == CryptoRegion::EXEFS_HDR) {
                         if (exefs_header_written != sizeof(ExeFs_Header)) {
                             memcpy(reinterpret_cast<u8*>(&exefs_header) + exefs_header_written,
-                                   temp.data(), to_write);
+                                   temp, to_write);
                             exefs_header_written += to_write;
                         }
                         if (!exefs_header_processed &&
@@ -397,7 +439,7 @@ void NCCHCryptoFile::Write(const u8* buffer, std::size_t length) {
                         }
                     }
                 } else {
-                    file->WriteBytes(buffer, to_write);
+                    WriteOut(buffer, to_write);
                 }
                 written += to_write;
                 buffer += to_write;
@@ -850,6 +892,9 @@ bool CIAFile::Close() {
         current_content_install_result.type = InstallResult::Type::NONE;
     }
 
+    // Wait for the writes of the last content, so that it is complete once this returns
+    current_content_file.reset();
+
     bool complete;
 
     if (is_cancel) {
@@ -1086,14 +1131,38 @@ InstallStatus InstallCIA(const std::string& path,
             return InstallStatus::ErrorEncrypted;
         }
 
-        std::vector<u8> buffer;
-        buffer.resize(0x10000);
-        auto file_size = in_file->GetSize();
+        // The CIA is read on its own thread, ahead of the installation done here, which in turn
+        // hands the contents to a writer thread. An empty chunk marks the end of the reads.
+        const auto file_size = in_file->GetSize();
+        Common::BoundedSPSCQueue<std::vector<u8>, InstallReadQueueDepth> read_queue;
+        std::jthread reader([&](std::stop_token stop) {
+            for (u64 pos = 0; pos < file_size && !stop.stop_requested();) {
+                std::vector<u8> chunk(std::min<u64>(InstallChunkSize, file_size - pos));
+                chunk.resize(in_file->ReadBytes(chunk.data(), chunk.size()));
+                if (chunk.empty()) {
+                    break;
+                }
+                pos += chunk.size();
+                read_queue.EmplaceWait(std::move(chunk));
+            }
+            read_queue.EmplaceWait();
+        });
+        const auto stop_reader = [&] {
+            reader.request_stop();
+            while (!read_queue.PopWait().empty()) {
+            }
+        };
+
         std::size_t total_bytes_read = 0;
         while (total_bytes_read != file_size) {
-            std::size_t bytes_read = in_file->ReadBytes(buffer.data(), buffer.size());
-            auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            false, static_cast<u8*>(buffer.data()));
+            const std::vector<u8> chunk = read_queue.PopWait();
+            if (chunk.empty()) {
+                LOG_ERROR(Service_AM, "Could not read CIA file {}", path);
+                return InstallStatus::ErrorAborted;
+            }
+
+            auto result = installFile.Write(static_cast<u64>(total_bytes_read), chunk.size(),
+                                            true, false, chunk.data());
 
             if (update_callback) {
                 update_callback(total_bytes_read, file_size);
@@ -1101,9 +1170,10 @@ InstallStatus InstallCIA(const std::string& path,
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
+                stop_reader();
                 return InstallStatus::ErrorAborted;
             }
-            total_bytes_read += bytes_read;
+            total_bytes_read += chunk.size();
         }
         installFile.Close();
 
@@ -1427,6 +1497,15 @@ void Module::ScanForTitlesImpl(Service::FS::MediaType media_type) {
     } else {
         std::string title_path = GetMediaTitlePath(media_type);
 
+        // Opening the contents of every title is slow with large libraries, so only the titles
+        // whose content directory changed since the previous scan are loaded again.
+        auto& title_index = title_indices[static_cast<u32>(media_type)];
+        if (!title_index || title_index->GetTitlePath() != title_path) {
+            title_index = std::make_unique<TitleIndex>(
+                media_type == FS::MediaType::NAND ? "am_titles_nand.bin" : "am_titles_sdmc.bin",
+                title_path);
+        }
+
         FileUtil::FSTEntry entries;
         FileUtil::ScanDirectoryTree(title_path, entries, 1, &stop_scan_flag);
         for (const FileUtil::FSTEntry& tid_high : entries.children) {
@@ -1450,14 +1529,23 @@ void Module::ScanForTitlesImpl(Service::FS::MediaType media_type) {
                             am_title_list[static_cast<u32>(media_type)].push_back(tid);
                         }
                     } else {
-                        FileSys::NCCHContainer container(GetTitleContentPath(media_type, tid));
-                        if (container.Load() == Loader::ResultStatus::Success) {
+                        const u64 signature = TitleIndex::GetContentSignature(
+                            GetTitlePath(media_type, tid) + "content/");
+                        bool valid = title_index->IsValid(tid, signature);
+                        if (!valid) {
+                            FileSys::NCCHContainer container(GetTitleContentPath(media_type, tid));
+                            valid = container.Load() == Loader::ResultStatus::Success;
+                        }
+                        if (valid) {
                             am_title_list[static_cast<u32>(media_type)].push_back(tid);
+                            title_index->Add(tid, signature);
                         }
                     }
                 }
             }
         }
+
+        title_index->EndScan(!stop_scan_flag);
     }
 
     LOG_DEBUG(Service_AM, "Finished title scan for media_type={}", static_cast<int>(media_type));
@@ -3412,7 +3500,7 @@ void Module::Interface::BeginImportProgram(Kernel::HLERequestContext& ctx) {
     // Citra will store contents out to sdmc/nand
     const FileSys::Path cia_path = {};
     auto file = std::make_shared<Service::FS::File>(
-        am->system.Kernel(), std::make_unique<CIAFile>(am->system, media_type), cia_path);
+        am->system, std::make_unique<CIAFile>(am->system, media_type), cia_path);
 
     am->cia_installing = true;
 
@@ -3445,7 +3533,7 @@ void Module::Interface::BeginImportProgramTemporarily(Kernel::HLERequestContext&
         AuthorizeCIAFileDecryption(cia_file.get(), ctx);
 
         file =
-            std::make_shared<Service::FS::File>(am->system.Kernel(), std::move(cia_file), cia_path);
+            std::make_shared<Service::FS::File>(am->system, std::move(cia_file), cia_path);
     }
     am->cia_installing = true;
 
@@ -3891,7 +3979,7 @@ void Module::Interface::BeginImportTicket(Kernel::HLERequestContext& ctx) {
 
     // Create our TicketFile handle for the app to write to
     auto file = std::make_shared<Service::FS::File>(
-        am->system.Kernel(), std::make_unique<TicketFile>(), FileSys::Path{});
+        am->system, std::make_unique<TicketFile>(), FileSys::Path{});
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
     rb.Push(ResultSuccess); // No error
@@ -4089,7 +4177,7 @@ void Module::Interface::BeginImportTmd(Kernel::HLERequestContext& ctx) {
 
     // Create our TMD handle for the app to write to
     auto file = std::make_shared<Service::FS::File>(
-        am->system.Kernel(), std::make_unique<TMDFile>(am->importing_title), FileSys::Path{});
+        am->system, std::make_unique<TMDFile>(am->importing_title), FileSys::Path{});
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
     rb.Push(ResultSuccess); // No error
@@ -4265,8 +4353,7 @@ void Module::Interface::BeginImportContent(Kernel::HLERequestContext& ctx) {
 
     // Create our TMD handle for the app to write to
     auto file = std::make_shared<Service::FS::File>(
-        am->system.Kernel(),
-        std::make_unique<ContentFile>(am->importing_title, content_index, it->second),
+        am->system, std::make_unique<ContentFile>(am->importing_title, content_index, it->second),
         FileSys::Path{});
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
@@ -4308,7 +4395,7 @@ void Module::Interface::ResumeImportContent(Kernel::HLERequestContext& ctx) {
     content_file->SetWritten(it->second.current_size);
 
     // Create our TMD handle for the app to write to
-    auto file = std::make_shared<Service::FS::File>(am->system.Kernel(), std::move(content_file),
+    auto file = std::make_shared<Service::FS::File>(am->system, std::move(content_file),
                                                     FileSys::Path{});
 
     IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
@@ -14,8 +14,10 @@
 #include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include "common/bounded_threadsafe_queue.h"
 #include "common/common_types.h"
 #include "common/construct.h"
+#include "common/polyfill_thread.h"
 #include "common/swap.h"
 #include "core/file_sys/cia_container.h"
 #include "core/file_sys/file_backend.h"
@@ -23,6 +25,7 @@
 #include "core/global.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/result.h"
+#include "core/hle/service/am/title_index.h"
 #include "core/hle/service/service.h"
 #include "network/artic_base/artic_base_client.h"
 
@@ -125,16 +128,32 @@ using ProgressCallback = void(std::size_t, std::size_t);
 class NCCHCryptoFile final {
 public:
     NCCHCryptoFile(const std::string& out_file, bool encrypted_content);
+    ~NCCHCryptoFile();
 
     void Write(const u8* buffer, std::size_t length);
     bool IsError() {
-        return is_error;
+        return is_error || write_failed;
     }
 
 private:
     friend class CIAFile;
+
+    // Appends data to what the current Write hands to the writer thread.
+    void WriteOut(const void* data, std::size_t length);
+
+    // Hands the data of the current Write to the writer thread, in order.
+    void SubmitPending();
+
     std::unique_ptr<FileUtil::IOFile> file;
     bool is_error = false;
+
+    // The decrypted data is written to the file on its own thread, so that decryption and
+    // compression overlap with the writes. At most WriteQueueDepth writes are queued.
+    static constexpr std::size_t WriteQueueDepth = 8;
+    std::vector<u8> pending;
+    Common::BoundedSPSCQueue<std::vector<u8>, WriteQueueDepth> write_queue;
+    std::atomic<bool> write_failed{false};
+    std::jthread writer;
     bool is_not_ncch = false;
     bool decryption_authorized = false;
 
@@ -1125,6 +1144,8 @@ private:
     std::future<void> scan_all_future;
     std::mutex am_lists_mutex;
     std::array<std::vector<u64_le>, 3> am_title_list;
+    /// Indices of the valid titles in NAND and SDMC, loaded by the first scan of each medium
+    std::array<std::unique_ptr<TitleIndex>, 2> title_indices;
     std::multimap<u64, u64> am_ticket_list;
 
     std::shared_ptr<Kernel::Mutex> system_updater_mutex;
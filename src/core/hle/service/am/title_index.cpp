@@ -0,0 +1,133 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/hle/service/am/title_index.h"
+#include "core/loader/loader.h"
+
+namespace Service::AM {
+
+namespace {
+
+struct IndexHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le title_path_hash;
+    u64_le num_entries;
+};
+static_assert(sizeof(IndexHeader) == 0x18);
+
+struct IndexEntry {
+    u64_le title_id;
+    u64_le signature;
+};
+static_assert(sizeof(IndexEntry) == 0x10);
+
+constexpr u32 IndexMagic = Loader::MakeMagic('A', 'M', 'T', 'I');
+constexpr u32 IndexVersion = 1;
+
+/// Appends the names and sizes of the files in a directory tree, sorted by name.
+void ListFiles(const FileUtil::FSTEntry& directory, const std::string& prefix,
+               std::vector<std::pair<std::string, const FileUtil::FSTEntry*>>& files) {
+    for (const FileUtil::FSTEntry& entry : directory.children) {
+        if (entry.isDirectory) {
+            ListFiles(entry, prefix + entry.virtualName + "/", files);
+        } else {
+            files.emplace_back(prefix + entry.virtualName, &entry);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+TitleIndex::TitleIndex(const std::string& name, const std::string& title_path_)
+    : path{FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + name}, title_path{title_path_},
+      title_path_hash{Common::ComputeHash64(title_path.data(), title_path.size())} {
+    FileUtil::IOFile file(path, "rb");
+    IndexHeader header{};
+    if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != IndexMagic || header.version != IndexVersion ||
+        header.title_path_hash != title_path_hash) {
+        return;
+    }
+
+    std::vector<IndexEntry> saved_entries(header.num_entries);
+    if (file.ReadArray(saved_entries.data(), saved_entries.size()) != saved_entries.size()) {
+        LOG_WARNING(Service_AM, "Title index {} is truncated", path);
+        return;
+    }
+    for (const IndexEntry& entry : saved_entries) {
+        entries.emplace(entry.title_id, entry.signature);
+    }
+}
+
+bool TitleIndex::IsValid(u64 title_id, u64 signature) const {
+    const auto it = entries.find(title_id);
+    return it != entries.end() && it->second == signature;
+}
+
+void TitleIndex::Add(u64 title_id, u64 signature) {
+    scanned_entries.insert_or_assign(title_id, signature);
+}
+
+void TitleIndex::EndScan(bool complete) {
+    if (complete && scanned_entries != entries) {
+        entries = std::move(scanned_entries);
+        Save();
+    }
+    scanned_entries.clear();
+}
+
+void TitleIndex::Save() const {
+    std::vector<IndexEntry> saved_entries;
+    saved_entries.reserve(entries.size());
+    for (const auto& [title_id, signature] : entries) {
+        saved_entries.push_back({.title_id = title_id, .signature = signature});
+    }
+    const IndexHeader header{
+        .magic = IndexMagic,
+        .version = IndexVersion,
+        .title_path_hash = title_path_hash,
+        .num_entries = saved_entries.size(),
+    };
+
+    // The index is only an optimization, a missing one makes the next scan validate every title.
+    FileUtil::CreateFullPath(path);
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteObject(header) != 1 ||
+        file.WriteArray(saved_entries.data(), saved_entries.size()) != saved_entries.size()) {
+        LOG_WARNING(Service_AM, "Could not write title index {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+}
+
+u64 TitleIndex::GetContentSignature(const std::string& content_path) {
+    FileUtil::FSTEntry content;
+    FileUtil::ScanDirectoryTree(content_path, content, 1);
+
+    std::vector<std::pair<std::string, const FileUtil::FSTEntry*>> files;
+    ListFiles(content, "", files);
+    std::ranges::sort(files, {}, &decltype(files)::value_type::first);
+
+    std::string data;
+    for (const auto& [name, entry] : files) {
+        data += name;
+        data.push_back('\0');
+        data.append(reinterpret_cast<const char*>(&entry->size), sizeof(entry->size));
+        if (name.ends_with(".tmd")) {
+            std::string tmd;
+            FileUtil::ReadFileToString(false, entry->physicalName, tmd);
+            data += tmd;
+        }
+    }
+    return Common::ComputeHash64(data.data(), data.size());
+}
+
+} // namespace Service::AM
@@ -0,0 +1,62 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "common/common_types.h"
+
+namespace Service::AM {
+
+/**
+ * Index of the valid titles installed in a storage medium, stored in the cache directory. For each
+ * title it records a signature of its content directory, so that the title scans only open the
+ * contents of the titles that were installed or updated since the previous scan. Titles which
+ * failed to load are not recorded, as they may load once the missing keys are provided.
+ */
+class TitleIndex {
+public:
+    /**
+     * Loads the index saved for a storage medium.
+     * @param name Name of the index file
+     * @param title_path Path of the title directory of the medium, an index saved for another
+     * path is discarded.
+     */
+    TitleIndex(const std::string& name, const std::string& title_path);
+
+    /// Returns whether the title was valid in the previous scan and its content did not change.
+    bool IsValid(u64 title_id, u64 signature) const;
+
+    /// Records a title found valid in the current scan.
+    void Add(u64 title_id, u64 signature);
+
+    /**
+     * Ends the current scan. A complete scan replaces the previous one and is saved if it changed,
+     * an interrupted one is discarded.
+     */
+    void EndScan(bool complete);
+
+    const std::string& GetTitlePath() const {
+        return title_path;
+    }
+
+    /**
+     * Returns the signature of the content directory of a title. It covers the names and sizes
+     * of its files and the contents of its TMDs, which are rewritten on every install.
+     */
+    static u64 GetContentSignature(const std::string& content_path);
+
+private:
+    void Save() const;
+
+    std::string path;
+    std::string title_path;
+    u64 title_path_hash;
+    /// Signatures of the valid titles, by title ID
+    std::unordered_map<u64, u64> entries;
+    std::unordered_map<u64, u64> scanned_entries;
+};
+
+} // namespace Service::AM
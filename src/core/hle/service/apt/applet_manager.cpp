@@ -612,7 +612,8 @@ Result AppletManager::PrepareToStartLibraryApplet(AppletId applet_id) {
         auto cfg = Service::CFG::GetModule(system);
         auto process =
             NS::LaunchTitle(system, FS::MediaType::NAND,
-                            GetTitleIdForApplet(applet_id, cfg->GetRegionValue(is_setup)));
+                            GetTitleIdForApplet(applet_id, cfg->GetRegionValue(is_setup)),
+                            &applet_code_cache);
         if (process) {
             return ResultSuccess;
         }
@@ -643,7 +644,8 @@ Result AppletManager::PreloadLibraryApplet(AppletId applet_id) {
         auto cfg = Service::CFG::GetModule(system);
         auto process =
             NS::LaunchTitle(system, FS::MediaType::NAND,
-                            GetTitleIdForApplet(applet_id, cfg->GetRegionValue(is_setup)));
+                            GetTitleIdForApplet(applet_id, cfg->GetRegionValue(is_setup)),
+                            &applet_code_cache);
         if (process) {
             return ResultSuccess;
         }
@@ -857,7 +859,8 @@ Result AppletManager::StartSystemApplet(AppletId applet_id, std::shared_ptr<Kern
         auto cfg = Service::CFG::GetModule(system);
         auto process =
             NS::LaunchTitle(system, FS::MediaType::NAND,
-                            GetTitleIdForApplet(applet_id, cfg->GetRegionValue(is_setup)));
+                            GetTitleIdForApplet(applet_id, cfg->GetRegionValue(is_setup)),
+                            &applet_code_cache);
         if (!process) {
             // TODO: Find the right error code.
             return {ErrorDescription::NotFound, ErrorModule::Applet, ErrorSummary::NotSupported,
@@ -18,6 +18,7 @@
 #include "core/hle/kernel/event.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/archive.h"
+#include "core/loader/loader.h"
 
 namespace Core {
 class System;
@@ -509,6 +510,10 @@ private:
     std::unordered_map<AppletId, std::shared_ptr<HLE::Applets::Applet>> hle_applets;
     Core::TimingEventType* hle_applet_update_event;
 
+    /// Code of the recently launched LLE applets, so that opening them again is quick
+    static constexpr std::size_t AppletCodeCacheBudget = 32 * 1024 * 1024;
+    Loader::CodeCache applet_code_cache{AppletCodeCacheBudget};
+
     Core::TimingEventType* button_update_event;
     std::atomic<bool> is_device_reload_pending{true};
     std::unique_ptr<Input::ButtonDevice> home_button;
@@ -7,11 +7,13 @@
 #include "common/archives.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
 #include "core/core.h"
 #include "core/file_sys/archive_ncch.h"
 #include "core/file_sys/file_backend.h"
+#include "core/file_sys/title_metadata.h"
 #include "core/hle/applets/applet.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/shared_memory.h"
@@ -206,6 +208,102 @@ static u32 DecompressLZ11(const u8* in, u8* out) {
     return decompressed_size;
 }
 
+/**
+ * Header of the decompressed shared font kept in the cache directory, which is read straight into
+ * the shared font memory instead of reading the whole RomFS and decompressing the font again. It is
+ * only used for the same region and installed font title, and the data is checked against its hash.
+ */
+struct SharedFontCacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le title_id;
+    u64_le content_size;
+    u64_le data_hash;
+    u32_le data_size;
+    u16_le title_version;
+    u8 region;
+    INSERT_PADDING_BYTES(1);
+};
+static_assert(sizeof(SharedFontCacheHeader) == 0x28, "SharedFontCacheHeader has incorrect size");
+
+constexpr u32 SharedFontCacheMagic = Loader::MakeMagic('S', 'F', 'N', 'C');
+constexpr u32 SharedFontCacheVersion = 1;
+
+static std::string GetSharedFontCachePath(u64 title_id) {
+    return fmt::format("{}sharedfont" DIR_SEP "{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), title_id);
+}
+
+/// Identifies the installed font title, returns nothing if it isn't installed.
+static std::optional<SharedFontCacheHeader> GetSharedFontCacheKey(u64 title_id, u8 region) {
+    // Same lookup as the NCCH archive the font is read from
+    u64 content_title_id = title_id | 0x20000000;
+    std::string content_path;
+    if (Settings::values.is_new_3ds) {
+        content_path =
+            Service::AM::GetTitleContentPath(Service::FS::MediaType::NAND, content_title_id);
+    }
+    if (!Settings::values.is_new_3ds || !FileUtil::Exists(content_path)) {
+        content_title_id = title_id;
+        content_path = Service::AM::GetTitleContentPath(Service::FS::MediaType::NAND, title_id);
+    }
+
+    FileSys::TitleMetadata tmd;
+    const auto tmd_path =
+        Service::AM::GetTitleMetadataPath(Service::FS::MediaType::NAND, content_title_id);
+    if (!FileUtil::Exists(content_path) || tmd.Load(tmd_path) != Loader::ResultStatus::Success) {
+        return std::nullopt;
+    }
+
+    return SharedFontCacheHeader{
+        .magic = SharedFontCacheMagic,
+        .version = SharedFontCacheVersion,
+        .title_id = title_id,
+        .content_size = FileUtil::GetSize(content_path),
+        .title_version = tmd.GetTitleVersion(),
+        .region = region,
+    };
+}
+
+static bool ReadCachedSharedFont(const SharedFontCacheHeader& key, Kernel::SharedMemory& memory) {
+    FileUtil::IOFile file(GetSharedFontCachePath(key.title_id), "rb");
+    SharedFontCacheHeader header;
+    if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    if (header.magic != key.magic || header.version != key.version ||
+        header.title_id != key.title_id || header.content_size != key.content_size ||
+        header.title_version != key.title_version || header.region != key.region ||
+        header.data_size > memory.GetSize()) {
+        LOG_INFO(Service_APT, "Cached shared font is out of date");
+        return false;
+    }
+
+    u8* data = memory.GetPointer();
+    if (file.ReadBytes(data, header.data_size) != header.data_size ||
+        Common::ComputeHash64(data, header.data_size) != header.data_hash) {
+        LOG_WARNING(Service_APT, "Cached shared font is corrupted");
+        return false;
+    }
+    return true;
+}
+
+static void WriteCachedSharedFont(SharedFontCacheHeader header, const u8* data, u32 size) {
+    const std::string path = GetSharedFontCachePath(header.title_id);
+    if (!FileUtil::CreateFullPath(path)) {
+        return;
+    }
+
+    header.data_size = size;
+    header.data_hash = Common::ComputeHash64(data, size);
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteObject(header) != 1 || file.WriteBytes(data, size) != size) {
+        LOG_WARNING(Service_APT, "Could not write the shared font cache {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+}
+
 bool Module::LoadSharedFont() {
     auto cfg = Service::CFG::GetModule(system);
     u8 font_region_code;
@@ -226,6 +324,12 @@ bool Module::LoadSharedFont() {
 
     const u64_le shared_font_archive_id_low = 0x0004009b00014002 | ((font_region_code - 1) << 8);
 
+    const auto cache_key = GetSharedFontCacheKey(shared_font_archive_id_low, font_region_code);
+    if (cache_key && ReadCachedSharedFont(*cache_key, *shared_font_mem)) {
+        LOG_DEBUG(Service_APT, "Loaded shared font from the cache");
+        return true;
+    }
+
     FileSys::NCCHArchive archive(shared_font_archive_id_low, Service::FS::MediaType::NAND);
     // 20-byte all zero path for opening RomFS
     const FileSys::Path file_path(std::vector<u8>(20, 0));
@@ -270,6 +374,11 @@ bool Module::LoadSharedFont() {
     std::memcpy(shared_font_mem->GetPointer(), &shared_font_header, sizeof(shared_font_header));
     *shared_font_mem->GetPointer(0x83) = 'U'; // Change the magic from "CFNT" to "CFNU"
 
+    if (cache_key) {
+        WriteCachedSharedFont(*cache_key, shared_font_mem->GetPointer(),
+                              sizeof(shared_font_header) + shared_font_header.decompressed_size);
+    }
+
     return true;
 }
 
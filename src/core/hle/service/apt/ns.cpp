@@ -10,7 +10,7 @@
 namespace Service::NS {
 
 std::shared_ptr<Kernel::Process> LaunchTitle(Core::System& system, FS::MediaType media_type,
-                                             u64 title_id) {
+                                             u64 title_id, Loader::CodeCache* code_cache) {
     std::string path;
 
     if (media_type == FS::MediaType::GameCard) {
@@ -57,6 +57,8 @@ std::shared_ptr<Kernel::Process> LaunchTitle(Core::System& system, FS::MediaType
         system.Kernel().UpdateCPUAndMemoryState(title_id, mem_mode, n3ds_hw_cap);
     }
 
+    loader->SetCodeCache(code_cache);
+
     std::shared_ptr<Kernel::Process> process;
     Loader::ResultStatus result = loader->Load(process);
 
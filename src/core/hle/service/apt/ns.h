@@ -13,11 +13,17 @@ namespace Core {
 class System;
 }
 
+namespace Loader {
+class CodeCache;
+}
+
 namespace Service::NS {
 
-/// Loads and launches the title identified by title_id in the specified media type.
+/// Loads and launches the title identified by title_id in the specified media type. The code of
+/// the title is looked up in and stored to code_cache when one is given.
 std::shared_ptr<Kernel::Process> LaunchTitle(Core::System& system, FS::MediaType media_type,
-                                             u64 title_id);
+                                             u64 title_id,
+                                             Loader::CodeCache* code_cache = nullptr);
 
 /// Reboots the system to the specified title.
 void RebootToTitle(Core::System& system, FS::MediaType media_type, u64 title_id,
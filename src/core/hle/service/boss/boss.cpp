@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include "common/archives.h"
+#include "common/cpu_affinity.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/result.h"
@@ -65,12 +67,20 @@ void Module::Interface::InitializeSession(Kernel::HLERequestContext& ctx) {
             std::make_shared<OnlineService>(curr_program_id, curr_extdata_id);
     }
 
-    const auto result = session_data->online_service->InitializeSession(program_id);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(result);
-
     LOG_DEBUG(Service_BOSS, "called, program_id={:#018x}", program_id);
+
+    auto result = std::make_shared<Result>(ResultSuccess);
+    ctx.RunAsyncOn(
+        *boss->io_worker,
+        [online_service = session_data->online_service, program_id,
+         result](Kernel::HLERequestContext& ctx) {
+            *result = online_service->InitializeSession(program_id);
+            return 0;
+        },
+        [result](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 0);
+            rb.Push(*result);
+        });
 }
 
 void Module::Interface::SetStorageInfo(Kernel::HLERequestContext& ctx) {
@@ -254,7 +264,7 @@ void Module::Interface::GetStepIdList(Kernel::HLERequestContext& ctx) {
     LOG_WARNING(Service_BOSS, "(STUBBED) size={:#010x}", size);
 }
 
-void Module::Interface::GetNsDataIdList(Kernel::HLERequestContext& ctx) {
+void Module::Interface::GetNsDataIdListImpl(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
     const u32 filter = rp.Pop<u32>();
     const u32 max_entries = rp.Pop<u32>(); /// buffer size in words
@@ -266,96 +276,44 @@ void Module::Interface::GetNsDataIdList(Kernel::HLERequestContext& ctx) {
     if (online_service == nullptr) {
         return;
     }
-    const u16 entries_count = online_service->GetNsDataIdList(filter, max_entries, buffer);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
-    rb.Push(ResultSuccess);
-    rb.Push<u16>(entries_count); /// Actual number of output entries
-    rb.Push<u16>(0);             /// Last word-index copied to output in the internal NsDataId list.
-    rb.PushMappedBuffer(buffer);
 
     LOG_DEBUG(Service_BOSS,
               "filter={:#010x}, max_entries={:#010x}, "
               "word_index_start={:#06x}, start_ns_data_id={:#010x}",
               filter, max_entries, word_index_start, start_ns_data_id);
-}
 
-void Module::Interface::GetNsDataIdList1(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp(ctx);
-    const u32 filter = rp.Pop<u32>();
-    const u32 max_entries = rp.Pop<u32>(); /// buffer size in words
-    const u16 word_index_start = rp.Pop<u16>();
-    const u32 start_ns_data_id = rp.Pop<u32>();
-    auto& buffer = rp.PopMappedBuffer();
+    auto ns_data_ids = std::make_shared<std::vector<u32>>();
+    ctx.RunAsyncOn(
+        *boss->io_worker,
+        [online_service, filter, max_entries, ns_data_ids](Kernel::HLERequestContext& ctx) {
+            *ns_data_ids = online_service->GetNsDataIdList(filter, max_entries);
+            return 0;
+        },
+        [ns_data_ids, &buffer](Kernel::HLERequestContext& ctx) {
+            buffer.Write(ns_data_ids->data(), 0, ns_data_ids->size() * sizeof(u32));
 
-    const auto online_service = GetSessionService(ctx, rp);
-    if (online_service == nullptr) {
-        return;
-    }
-    const u16 entries_count = online_service->GetNsDataIdList(filter, max_entries, buffer);
+            IPC::RequestBuilder rb(ctx, 3, 2);
+            rb.Push(ResultSuccess);
+            rb.Push<u16>(static_cast<u16>(ns_data_ids->size())); /// Actual number of output entries
+            rb.Push<u16>(0); /// Last word-index copied to output in the internal NsDataId list.
+            rb.PushMappedBuffer(buffer);
+        });
+}
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
-    rb.Push(ResultSuccess);
-    rb.Push<u16>(entries_count); /// Actual number of output entries
-    rb.Push<u16>(0);             /// Last word-index copied to output in the internal NsDataId list.
-    rb.PushMappedBuffer(buffer);
+void Module::Interface::GetNsDataIdList(Kernel::HLERequestContext& ctx) {
+    GetNsDataIdListImpl(ctx);
+}
 
-    LOG_DEBUG(Service_BOSS,
-              "filter={:#010x}, max_entries={:#010x}, "
-              "word_index_start={:#06x}, start_ns_data_id={:#010x}",
-              filter, max_entries, word_index_start, start_ns_data_id);
+void Module::Interface::GetNsDataIdList1(Kernel::HLERequestContext& ctx) {
+    GetNsDataIdListImpl(ctx);
 }
 
 void Module::Interface::GetNsDataIdList2(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp(ctx);
-    const u32 filter = rp.Pop<u32>();
-    const u32 max_entries = rp.Pop<u32>(); /// buffer size in words
-    const u16 word_index_start = rp.Pop<u16>();
-    const u32 start_ns_data_id = rp.Pop<u32>();
-    auto& buffer = rp.PopMappedBuffer();
-
-    const auto online_service = GetSessionService(ctx, rp);
-    if (online_service == nullptr) {
-        return;
-    }
-    const u16 entries_count = online_service->GetNsDataIdList(filter, max_entries, buffer);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
-    rb.Push(ResultSuccess);
-    rb.Push<u16>(entries_count); /// Actual number of output entries
-    rb.Push<u16>(0);             /// Last word-index copied to output in the internal NsDataId list.
-    rb.PushMappedBuffer(buffer);
-
-    LOG_DEBUG(Service_BOSS,
-              "filter={:#010x}, max_entries={:#010x}, "
-              "word_index_start={:#06x}, start_ns_data_id={:#010x}",
-              filter, max_entries, word_index_start, start_ns_data_id);
+    GetNsDataIdListImpl(ctx);
 }
 
 void Module::Interface::GetNsDataIdList3(Kernel::HLERequestContext& ctx) {
-    IPC::RequestParser rp(ctx);
-    const u32 filter = rp.Pop<u32>();
-    const u32 max_entries = rp.Pop<u32>(); /// buffer size in words
-    const u16 word_index_start = rp.Pop<u16>();
-    const u32 start_ns_data_id = rp.Pop<u32>();
-    auto& buffer = rp.PopMappedBuffer();
-
-    const auto online_service = GetSessionService(ctx, rp);
-    if (online_service == nullptr) {
-        return;
-    }
-    const u16 entries_count = online_service->GetNsDataIdList(filter, max_entries, buffer);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
-    rb.Push(ResultSuccess);
-    rb.Push<u16>(entries_count); /// Actual number of output entries
-    rb.Push<u16>(0);             /// Last word-index copied to output in the internal NsDataId list.
-    rb.PushMappedBuffer(buffer);
-
-    LOG_DEBUG(Service_BOSS,
-              "filter={:#010x}, max_entries={:#010x}, "
-              "word_index_start={:#06x}, start_ns_data_id={:#010x}",
-              filter, max_entries, word_index_start, start_ns_data_id);
+    GetNsDataIdListImpl(ctx);
 }
 
 void Module::Interface::SendProperty(Kernel::HLERequestContext& ctx) {
@@ -640,14 +598,33 @@ void Module::Interface::GetNsDataHeaderInfo(Kernel::HLERequestContext& ctx) {
     if (online_service == nullptr) {
         return;
     }
-    const auto result = online_service->GetNsDataHeaderInfo(ns_data_id, type, size, buffer);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    rb.Push(result);
-    rb.PushMappedBuffer(buffer);
 
     LOG_DEBUG(Service_BOSS, "called, ns_data_id={:#010x}, type={:#04x}, size={:#010x}", ns_data_id,
               type, size);
+
+    struct AsyncData {
+        std::vector<u8> data;
+        Result result = ResultSuccess;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->data.resize(size);
+
+    ctx.RunAsyncOn(
+        *boss->io_worker,
+        [online_service, ns_data_id, type, size, async_data](Kernel::HLERequestContext& ctx) {
+            async_data->result =
+                online_service->GetNsDataHeaderInfo(ns_data_id, type, size, async_data->data);
+            return 0;
+        },
+        [async_data, &buffer](Kernel::HLERequestContext& ctx) {
+            if (async_data->result.IsSuccess()) {
+                buffer.Write(async_data->data.data(), 0, async_data->data.size());
+            }
+
+            IPC::RequestBuilder rb(ctx, 1, 2);
+            rb.Push(async_data->result);
+            rb.PushMappedBuffer(buffer);
+        });
 }
 
 void Module::Interface::ReadNsData(Kernel::HLERequestContext& ctx) {
@@ -661,21 +638,40 @@ void Module::Interface::ReadNsData(Kernel::HLERequestContext& ctx) {
     if (online_service == nullptr) {
         return;
     }
-    const auto result = online_service->ReadNsData(ns_data_id, offset, size, buffer);
-
-    if (result.Succeeded()) {
-        IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
-        rb.Push(result.Code());
-        rb.Push<u32>(static_cast<u32>(result.Unwrap()));
-        rb.Push<u32>(0); /// unknown
-        rb.PushMappedBuffer(buffer);
-    } else {
-        IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-        rb.Push(result.Code());
-    }
 
     LOG_DEBUG(Service_BOSS, "called, ns_data_id={:#010x}, offset={:#018x}, size={:#010x}",
               ns_data_id, offset, size);
+
+    struct AsyncData {
+        std::vector<u8> data;
+        ResultVal<std::size_t> result = std::size_t{0};
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->data.resize(size);
+
+    ctx.RunAsyncOn(
+        *boss->io_worker,
+        [online_service, ns_data_id, offset, size, async_data](Kernel::HLERequestContext& ctx) {
+            async_data->result =
+                online_service->ReadNsData(ns_data_id, offset, size, async_data->data);
+            return 0;
+        },
+        [async_data, &buffer](Kernel::HLERequestContext& ctx) {
+            const auto& result = async_data->result;
+            if (result.Succeeded()) {
+                const std::size_t read_size = *result;
+                buffer.Write(async_data->data.data(), 0, read_size);
+
+                IPC::RequestBuilder rb(ctx, 3, 2);
+                rb.Push(result.Code());
+                rb.Push<u32>(static_cast<u32>(read_size));
+                rb.Push<u32>(0); /// unknown
+                rb.PushMappedBuffer(buffer);
+            } else {
+                IPC::RequestBuilder rb(ctx, 1, 0);
+                rb.Push(result.Code());
+            }
+        });
 }
 
 void Module::Interface::SetNsDataAdditionalInfo(Kernel::HLERequestContext& ctx) {
@@ -1053,6 +1049,12 @@ Module::Module(Core::System& system_) : system(system_) {
     // TODO: verify ResetType
     task_finish_event =
         system.Kernel().CreateEvent(Kernel::ResetType::OneShot, "BOSS::task_finish_event");
+
+    io_worker = std::make_unique<Common::ThreadWorker>(1, "BOSS:IO");
+    io_worker->QueueWork([] {
+        Common::SetCurrentThreadPriority(Common::ThreadPriority::Low);
+        Common::SetCurrentThreadCoreClass(Common::CoreClass::Efficiency);
+    });
 }
 
 void InstallInterfaces(Core::System& system) {
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <boost/serialization/export.hpp>
+#include "common/thread_worker.h"
 #include "core/global.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/resource_limit.h"
@@ -974,12 +975,18 @@ public:
 
         std::shared_ptr<OnlineService> GetSessionService(Kernel::HLERequestContext& ctx,
                                                          IPC::RequestParser& rp);
+
+        /// Shared implementation of the GetNsDataIdList service functions
+        void GetNsDataIdListImpl(Kernel::HLERequestContext& ctx);
     };
 
 private:
     Core::System& system;
     std::shared_ptr<Kernel::Event> task_finish_event;
 
+    /// Low priority thread running the handlers that access the BOSS storage, in request order
+    std::unique_ptr<Common::ThreadWorker> io_worker;
+
     u8 new_arrival_flag;
     u8 ns_data_new_flag;
     u8 ns_data_new_flag_privileged;
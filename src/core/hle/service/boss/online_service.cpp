@@ -244,13 +244,19 @@ std::vector<FileSys::Entry> OnlineService::GetBossExtDataFiles(
     return boss_files;
 }
 
-std::vector<NsDataEntry> OnlineService::GetNsDataEntries() {
+const std::vector<NsDataEntry>& OnlineService::GetNsDataEntries() {
+    // The index is built by whichever of the IO worker and the emulation thread gets here first
+    std::scoped_lock lock{ns_data_index_mutex};
+    if (ns_data_index) {
+        return *ns_data_index;
+    }
+
+    auto& ns_data = ns_data_index.emplace();
     auto boss_archive = OpenBossExtData();
     if (!boss_archive) {
-        return {};
+        return ns_data;
     }
 
-    std::vector<NsDataEntry> ns_data;
     const auto boss_files = GetBossExtDataFiles(boss_archive.get());
     for (const auto& current_file : boss_files) {
         constexpr u32 boss_header_length = 0x34;
@@ -304,9 +310,8 @@ std::vector<NsDataEntry> OnlineService::GetNsDataEntries() {
     return ns_data;
 }
 
-u16 OnlineService::GetNsDataIdList(const u32 filter, const u32 max_entries,
-                                   Kernel::MappedBuffer& buffer) {
-    std::vector<NsDataEntry> ns_data = GetNsDataEntries();
+std::vector<u32> OnlineService::GetNsDataIdList(const u32 filter, const u32 max_entries) {
+    const auto& ns_data = GetNsDataEntries();
     std::vector<u32> output_entries;
     for (const auto& current_entry : ns_data) {
         const u32 datatype_raw = static_cast<u32>(current_entry.header.datatype);
@@ -327,15 +332,15 @@ u16 OnlineService::GetNsDataIdList(const u32 filter, const u32 max_entries,
         output_entries.push_back(current_entry.header.ns_data_id);
     }
 
-    buffer.Write(output_entries.data(), 0, sizeof(u32) * output_entries.size());
-    return static_cast<u16>(output_entries.size());
+    return output_entries;
 }
 
 std::optional<NsDataEntry> OnlineService::GetNsDataEntryFromId(const u32 ns_data_id) {
-    std::vector<NsDataEntry> ns_data = GetNsDataEntries();
-    const auto entry_iter = std::find_if(ns_data.begin(), ns_data.end(), [ns_data_id](auto entry) {
-        return entry.header.ns_data_id == ns_data_id;
-    });
+    const auto& ns_data = GetNsDataEntries();
+    const auto entry_iter =
+        std::find_if(ns_data.begin(), ns_data.end(), [ns_data_id](const auto& entry) {
+            return entry.header.ns_data_id == ns_data_id;
+        });
     if (entry_iter == ns_data.end()) {
         LOG_WARNING(Service_BOSS, "Could not find NsData with ID {:#010X}", ns_data_id);
         return std::nullopt;
@@ -344,7 +349,7 @@ std::optional<NsDataEntry> OnlineService::GetNsDataEntryFromId(const u32 ns_data
 }
 
 Result OnlineService::GetNsDataHeaderInfo(const u32 ns_data_id, const NsDataHeaderInfoType type,
-                                          const u32 size, Kernel::MappedBuffer& buffer) {
+                                          const u32 size, std::span<u8> out) {
     const auto entry = GetNsDataEntryFromId(ns_data_id);
     if (!entry.has_value()) {
         LOG_WARNING(Service_BOSS, "Failed to find NsData entry for ID {:#010X}", ns_data_id);
@@ -369,25 +374,25 @@ Result OnlineService::GetNsDataHeaderInfo(const u32 ns_data_id, const NsDataHead
 
     switch (type) {
     case NsDataHeaderInfoType::ProgramId:
-        buffer.Write(&entry->header.program_id, 0, size);
+        std::memcpy(out.data(), &entry->header.program_id, size);
         return ResultSuccess;
     case NsDataHeaderInfoType::Unknown: {
         // TODO: Figure out what this is. Stubbed to zero for now.
         const u32 zero = 0;
-        buffer.Write(&zero, 0, size);
+        std::memcpy(out.data(), &zero, size);
         return ResultSuccess;
     }
     case NsDataHeaderInfoType::Datatype:
-        buffer.Write(&entry->header.datatype, 0, size);
+        std::memcpy(out.data(), &entry->header.datatype, size);
         return ResultSuccess;
     case NsDataHeaderInfoType::PayloadSize:
-        buffer.Write(&entry->header.payload_size, 0, size);
+        std::memcpy(out.data(), &entry->header.payload_size, size);
         return ResultSuccess;
     case NsDataHeaderInfoType::NsDataId:
-        buffer.Write(&entry->header.ns_data_id, 0, size);
+        std::memcpy(out.data(), &entry->header.ns_data_id, size);
         return ResultSuccess;
     case NsDataHeaderInfoType::Version:
-        buffer.Write(&entry->header.version, 0, size);
+        std::memcpy(out.data(), &entry->header.version, size);
         return ResultSuccess;
     case NsDataHeaderInfoType::Everything: {
         const NsDataHeaderInfo info = {
@@ -397,7 +402,7 @@ Result OnlineService::GetNsDataHeaderInfo(const u32 ns_data_id, const NsDataHead
             .ns_data_id = entry->header.ns_data_id,
             .version = entry->header.version,
         };
-        buffer.Write(&info, 0, size);
+        std::memcpy(out.data(), &info, size);
         return ResultSuccess;
     }
     default:
@@ -408,7 +413,7 @@ Result OnlineService::GetNsDataHeaderInfo(const u32 ns_data_id, const NsDataHead
 }
 
 ResultVal<std::size_t> OnlineService::ReadNsData(const u32 ns_data_id, const u64 offset,
-                                                 const u32 size, Kernel::MappedBuffer& buffer) {
+                                                 const u32 size, std::span<u8> out) {
     std::optional<NsDataEntry> entry = GetNsDataEntryFromId(ns_data_id);
     if (!entry.has_value()) {
         LOG_WARNING(Service_BOSS, "Failed to find NsData entry for ID {:#010X}", ns_data_id);
@@ -442,15 +447,13 @@ ResultVal<std::size_t> OnlineService::ReadNsData(const u32 ns_data_id, const u64
     }
 
     auto file = std::move(file_result).Unwrap();
-    std::vector<u8> ns_data_array(size);
-    auto read_result = file->Read(sizeof(BossHeader) + offset, size, ns_data_array.data());
+    auto read_result = file->Read(sizeof(BossHeader) + offset, size, out.data());
     if (!read_result.Succeeded()) {
         LOG_WARNING(Service_BOSS, "Failed to read SpotPass extdata file '{}'.", entry->filename);
         // TODO: Proper error code.
         return ResultUnknown;
     }
 
-    buffer.Write(ns_data_array.data(), 0, size);
     return read_result;
 }
 
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <variant>
 #include <vector>
@@ -184,12 +187,12 @@ public:
     void RegisterTask(const u32 size, Kernel::MappedBuffer& buffer);
     Result UnregisterTask(const u32 size, Kernel::MappedBuffer& buffer);
     void GetTaskIdList();
-    u16 GetNsDataIdList(const u32 filter, const u32 max_entries, Kernel::MappedBuffer& buffer);
+    std::vector<u32> GetNsDataIdList(const u32 filter, const u32 max_entries);
     std::optional<NsDataEntry> GetNsDataEntryFromId(const u32 ns_data_id);
     Result GetNsDataHeaderInfo(const u32 ns_data_id, const NsDataHeaderInfoType type,
-                               const u32 size, Kernel::MappedBuffer& buffer);
+                               const u32 size, std::span<u8> out);
     ResultVal<std::size_t> ReadNsData(const u32 ns_data_id, const u64 offset, const u32 size,
-                                      Kernel::MappedBuffer& buffer);
+                                      std::span<u8> out);
     Result SendProperty(const u16 id, const u32 size, Kernel::MappedBuffer& buffer);
     Result ReceiveProperty(const u16 id, const u32 size, Kernel::MappedBuffer& buffer);
 
@@ -197,11 +200,16 @@ private:
     std::unique_ptr<FileSys::ArchiveBackend> OpenBossExtData();
     std::vector<FileSys::Entry> GetBossExtDataFiles(FileSys::ArchiveBackend* boss_archive);
     FileSys::Path GetBossDataDir();
-    std::vector<NsDataEntry> GetNsDataEntries();
+    const std::vector<NsDataEntry>& GetNsDataEntries();
 
     BossTaskProperties current_props;
     std::map<std::string, BossTaskProperties> task_id_list;
 
+    /// Headers of the SpotPass data in the ext data, read on first use so that listing the data
+    /// and reading from it does not open every file again.
+    std::optional<std::vector<NsDataEntry>> ns_data_index;
+    std::mutex ns_data_index_mutex;
+
     u64 program_id;
     u64 extdata_id;
 
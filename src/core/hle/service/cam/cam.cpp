@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include "common/archives.h"
 #include "common/bit_set.h"
 #include "common/logging/log.h"
@@ -102,7 +103,16 @@ void Module::PortConfig::Clear() {
 void Module::CompletionEventCallBack(u64 port_id, s64) {
     PortConfig& port = ports[port_id];
     const CameraConfig& camera = cameras[port.camera_id];
-    const auto buffer = port.capture_result.get();
+
+    // Only wait for the camera when the last frame does not fit the current resolution
+    const Resolution& resolution = camera.contexts[camera.current_context].resolution;
+    const std::size_t frame_size = static_cast<std::size_t>(resolution.width) * resolution.height;
+    if (port.capture_result.valid() &&
+        (port.frame.size() != frame_size ||
+         port.capture_result.wait_for(std::chrono::seconds{0}) == std::future_status::ready)) {
+        port.frame = port.capture_result.get();
+    }
+    const std::vector<u16>& buffer = port.frame;
 
     if (port.is_trimming) {
         u32 trim_width;
@@ -185,20 +195,22 @@ void Module::StartReceiving(int port_id) {
     PortConfig& port = ports[port_id];
     port.is_receiving = true;
 
-    // launches a capture task asynchronously
+    // launches a capture task asynchronously, unless the previous one is still running
     CameraConfig& camera = cameras[port.camera_id];
-    port.capture_result = std::async(std::launch::async, [&camera, &port, this] {
-        if (is_camera_reload_pending.exchange(false)) {
-            // reinitialize the camera according to new settings
-            camera.impl->StopCapture();
-            LoadCameraImplementation(camera, port.camera_id);
-            camera.impl->StartCapture();
-        }
-        return camera.impl->ReceiveFrame();
-    });
+    if (!port.capture_result.valid()) {
+        port.capture_result = std::async(std::launch::async, [&camera, &port, this] {
+            if (is_camera_reload_pending.exchange(false)) {
+                // reinitialize the camera according to new settings
+                camera.impl->StopCapture();
+                LoadCameraImplementation(camera, port.camera_id);
+                camera.impl->StartCapture();
+            }
+            return camera.impl->ReceiveFrame();
+        });
+    }
 
-    // schedules a completion event according to the frame rate. The event will block on the
-    // capture task if it is not finished within the expected time
+    // schedules a completion event according to the frame rate. The event only blocks on the
+    // capture task if it is not finished within the expected time and there is no earlier frame
     system.CoreTiming().ScheduleEvent(
         msToCycles(LATENCY_BY_FRAME_RATE[static_cast<int>(camera.frame_rate)]),
         completion_event_callback, port_id);
@@ -209,13 +221,20 @@ void Module::CancelReceiving(int port_id) {
         return;
     LOG_WARNING(Service_CAM, "tries to cancel an ongoing receiving process.");
     system.CoreTiming().UnscheduleEvent(completion_event_callback, port_id);
-    ports[port_id].capture_result.wait();
+    WaitForCapture(port_id);
     ports[port_id].is_receiving = false;
 }
 
+void Module::WaitForCapture(int port_id) {
+    if (ports[port_id].capture_result.valid()) {
+        ports[port_id].capture_result.wait();
+    }
+}
+
 void Module::ActivatePort(int port_id, int camera_id) {
     if (ports[port_id].is_busy && ports[port_id].camera_id != camera_id) {
         CancelReceiving(port_id);
+        WaitForCapture(port_id);
         cameras[ports[port_id].camera_id].impl->StopCapture();
         ports[port_id].is_busy = false;
     }
@@ -302,6 +321,7 @@ void Module::Interface::StopCapture(Kernel::HLERequestContext& ctx) {
         for (int i : port_select) {
             if (cam->ports[i].is_busy) {
                 cam->CancelReceiving(i);
+                cam->WaitForCapture(i);
                 cam->cameras[cam->ports[i].camera_id].impl->StopCapture();
                 cam->ports[i].is_busy = false;
             } else {
@@ -683,6 +703,7 @@ void Module::Interface::Activate(Kernel::HLERequestContext& ctx) {
             for (int i = 0; i < 2; ++i) {
                 if (cam->ports[i].is_busy) {
                     cam->CancelReceiving(i);
+                    cam->WaitForCapture(i);
                     cam->cameras[cam->ports[i].camera_id].impl->StopCapture();
                     cam->ports[i].is_busy = false;
                 }
@@ -1094,6 +1115,8 @@ void Module::Interface::DriverInitialize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
+    cam->WaitForCapture(0);
+    cam->WaitForCapture(1);
     for (int camera_id = 0; camera_id < NumCameras; ++camera_id) {
         CameraConfig& camera = cam->cameras[camera_id];
         camera.current_context = 0;
@@ -1126,6 +1149,8 @@ void Module::Interface::DriverFinalize(Kernel::HLERequestContext& ctx) {
 
     cam->CancelReceiving(0);
     cam->CancelReceiving(1);
+    cam->WaitForCapture(0);
+    cam->WaitForCapture(1);
 
     for (CameraConfig& camera : cam->cameras) {
         camera.impl = nullptr;
@@ -1161,6 +1186,8 @@ Module::Module(Core::System& system) : system(system) {
 Module::~Module() {
     CancelReceiving(0);
     CancelReceiving(1);
+    WaitForCapture(0);
+    WaitForCapture(1);
 }
 
 void Module::ReloadCameraDevices() {
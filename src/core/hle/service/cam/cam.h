@@ -649,6 +649,10 @@ private:
     //       process? Will the completion event still be signaled?
     void CancelReceiving(int port_id);
 
+    // Waits for the capture of the next frame at the specified port, which may still run after a
+    // receiving process completed. This must be called before the camera is stopped or replaced.
+    void WaitForCapture(int port_id);
+
     // Activates the specified port with the specfied camera.
     void ActivatePort(int port_id, int camera_id);
 
@@ -716,7 +720,11 @@ private:
 
         std::deque<s64> vsync_timings;
 
-        std::future<std::vector<u16>> capture_result; // will hold the received frame.
+        // The frames are double buffered: frame holds the last received frame, while
+        // capture_result will hold the next one. A receiving process that completes before the
+        // next frame arrives delivers the last one again instead of waiting for the camera.
+        std::future<std::vector<u16>> capture_result;
+        std::vector<u16> frame;
         Kernel::Process* dest_process{nullptr};
         VAddr dest{0};    // the destination address of the receiving process
         u32 dest_size{0}; // the destination size of the receiving process
@@ -741,7 +749,8 @@ private:
             ar & buffer_error_interrupt_event;
             ar & vsync_interrupt_event;
             ar & vsync_timings;
-            // Ignore capture_result. In-progress captures might be affected but this is OK.
+            // Ignore capture_result and frame. In-progress captures might be affected but this is
+            // OK.
             ar & dest_process;
             ar & dest;
             ar & dest_size;
@@ -10,9 +10,11 @@
 #include <fmt/format.h>
 #include "common/archives.h"
 #include "common/common_paths.h"
+#include "common/cpu_affinity.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/file_sys/archive_systemsavedata.h"
 #include "core/file_sys/directory_backend.h"
@@ -44,9 +46,41 @@ void Module::serialize(Archive& ar, const unsigned int) {
 SERIALIZE_IMPL(Module)
 
 using CecDataPathType = Module::CecDataPathType;
+using CecMessageHeader = Module::CecMessageHeader;
 using CecOpenMode = Module::CecOpenMode;
 using CecSystemInfoType = Module::CecSystemInfoType;
 
+static bool IsDirectoryPathType(CecDataPathType path_type) {
+    switch (path_type) {
+    case CecDataPathType::RootDir:
+    case CecDataPathType::MboxDir:
+    case CecDataPathType::InboxDir:
+    case CecDataPathType::OutboxDir:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void LogMessageHeader(const CecMessageHeader& msg_header) {
+    LOG_DEBUG(Service_CECD,
+              "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
+              "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
+              "batch_id={:#010x}",
+              msg_header.magic, msg_header.message_size, msg_header.header_size,
+              msg_header.body_size, msg_header.title_id, msg_header.title_id2,
+              msg_header.batch_id);
+    LOG_DEBUG(Service_CECD,
+              "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
+              "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
+              "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
+              "forward_count={:#04x}, user_data={:#06x}, ",
+              msg_header.unknown_id, msg_header.version, msg_header.flag,
+              msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
+              msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
+              msg_header.forward_count, msg_header.user_data);
+}
+
 void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
     const u32 ncch_program_id = rp.Pop<u32>();
@@ -55,11 +89,8 @@ void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
     open_mode.raw = rp.Pop<u32>();
     rp.PopPID();
 
-    FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.read_flag.Assign(1);
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
+    const std::string path_string = cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id);
+    FileSys::Path path(path_string.data());
 
     SessionData* session_data = GetSessionData(ctx.Session());
     session_data->ncch_program_id = ncch_program_id;
@@ -67,61 +98,67 @@ void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
     session_data->data_path_type = path_type;
     session_data->path = path;
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    switch (path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir: {
-        auto dir_result = cecd->cecd_system_save_data_archive->OpenDirectory(path);
-        if (dir_result.Failed()) {
-            if (open_mode.create) {
-                cecd->cecd_system_save_data_archive->CreateDirectory(path);
-                rb.Push(ResultSuccess);
-            } else {
-                LOG_DEBUG(Service_CECD, "Failed to open directory: {}", path.AsString());
-                rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                               ErrorLevel::Status));
-            }
-            rb.Push<u32>(0); // Zero entries
-        } else {
-            constexpr u32 max_entries = 32; // reasonable value, just over max boxes 24
-            auto directory = std::move(dir_result).Unwrap();
-
-            // Actual reading into vector seems to be required for entry count
-            std::vector<FileSys::Entry> entries(max_entries);
-            const u32 entry_count = directory->Read(max_entries, entries.data());
+    struct AsyncData {
+        Result result{ResultSuccess};
+        u32 size = 0; ///< Number of entries of a directory, or size of a file
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    const u64 current_program_id = cecd->system.Kernel().GetCurrentProcess()->codeset->program_id;
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, session_data, path_type, open_mode, path_string, current_program_id,
+         async_data](Kernel::HLERequestContext& ctx) {
+            const FileSys::Path path(path_string.data());
+            if (IsDirectoryPathType(path_type)) {
+                const auto* entries = cecd->ListDirectory(path_string);
+                if (!entries) {
+                    if (open_mode.create) {
+                        cecd->cecd_system_save_data_archive->CreateDirectory(path);
+                        cecd->AddIndexEntry(path_string);
+                    } else {
+                        LOG_DEBUG(Service_CECD, "Failed to open directory: {}", path_string);
+                        async_data->result = Result(ErrorDescription::NoData, ErrorModule::CEC,
+                                                    ErrorSummary::NotFound, ErrorLevel::Status);
+                    }
+                    return 0;
+                }
 
-            LOG_DEBUG(Service_CECD, "Number of entries found: {}", entry_count);
+                constexpr u32 max_entries = 32; // reasonable value, just over max boxes 24
+                async_data->size = std::min(static_cast<u32>(entries->size()), max_entries);
+                LOG_DEBUG(Service_CECD, "Number of entries found: {}", async_data->size);
+                return 0;
+            }
 
-            rb.Push(ResultSuccess);
-            rb.Push<u32>(entry_count); // Entry count
-            directory->Close();
-        }
-        break;
-    }
-    default: { // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Failed()) {
-            LOG_DEBUG(Service_CECD, "Failed to open file: {}", path.AsString());
-            rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                           ErrorLevel::Status));
-            rb.Push<u32>(0); // No file size
-        } else {
+            // If not directory, then it is a file
+            FileSys::Mode mode;
+            mode.read_flag.Assign(1);
+            mode.write_flag.Assign(1);
+            mode.create_flag.Assign(1);
+            auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
+            if (file_result.Failed()) {
+                LOG_DEBUG(Service_CECD, "Failed to open file: {}", path_string);
+                async_data->result = Result(ErrorDescription::NoData, ErrorModule::CEC,
+                                            ErrorSummary::NotFound, ErrorLevel::Status);
+                return 0;
+            }
+            cecd->AddIndexEntry(path_string);
             session_data->file = std::move(file_result).Unwrap();
-            rb.Push(ResultSuccess);
-            rb.Push<u32>(static_cast<u32>(session_data->file->GetSize())); // Return file size
-        }
+            async_data->size = static_cast<u32>(session_data->file->GetSize());
 
-        if (path_type == CecDataPathType::MboxProgramId) {
-            std::vector<u8> program_id(8);
-            u64_le le_program_id = cecd->system.Kernel().GetCurrentProcess()->codeset->program_id;
-            std::memcpy(program_id.data(), &le_program_id, sizeof(u64));
-            session_data->file->Write(0, sizeof(u64), true, false, program_id.data());
-            session_data->file->Close();
-        }
-    }
-    }
+            if (path_type == CecDataPathType::MboxProgramId) {
+                const u64_le le_program_id = current_program_id;
+                session_data->file->Write(0, sizeof(u64), true, false,
+                                          reinterpret_cast<const u8*>(&le_program_id));
+                session_data->file->Close();
+            }
+            return 0;
+        },
+        [async_data](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 2, 0);
+            rb.Push(async_data->result);
+            rb.Push<u32>(async_data->size);
+        });
 
     LOG_DEBUG(Service_CECD,
               "called, ncch_program_id={:#010x}, path_type={:#04x}, path={}, "
@@ -145,32 +182,42 @@ void Module::Interface::Read(Kernel::HLERequestContext& ctx) {
               session_data->open_mode.unknown.Value(), session_data->open_mode.read.Value(),
               session_data->open_mode.write.Value(), session_data->open_mode.create.Value(),
               session_data->open_mode.check.Value());
+    LOG_DEBUG(Service_CECD, "called, write_buffer_size={:#x}, path={}", write_buffer_size,
+              session_data->path.AsString());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    switch (session_data->data_path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir:
+    if (IsDirectoryPathType(session_data->data_path_type)) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
         rb.Push(Result(ErrorDescription::NotAuthorized, ErrorModule::CEC, ErrorSummary::NotFound,
                        ErrorLevel::Status));
         rb.Push<u32>(0); // No bytes read
-        break;
-    default: // If not directory, then it is a file
-        std::vector<u8> buffer(write_buffer_size);
-        const u32 bytes_read = static_cast<u32>(
-            session_data->file->Read(0, write_buffer_size, buffer.data()).Unwrap());
-
-        write_buffer.Write(buffer.data(), 0, write_buffer_size);
-        session_data->file->Close();
-
-        rb.Push(ResultSuccess);
-        rb.Push<u32>(bytes_read);
+        rb.PushMappedBuffer(write_buffer);
+        return;
     }
-    rb.PushMappedBuffer(write_buffer);
 
-    LOG_DEBUG(Service_CECD, "called, write_buffer_size={:#x}, path={}", write_buffer_size,
-              session_data->path.AsString());
+    struct AsyncData {
+        std::vector<u8> buffer;
+        u32 bytes_read = 0;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->buffer.resize(write_buffer_size);
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [session_data, async_data](Kernel::HLERequestContext& ctx) {
+            async_data->bytes_read = static_cast<u32>(
+                session_data->file
+                    ->Read(0, async_data->buffer.size(), async_data->buffer.data())
+                    .Unwrap());
+            session_data->file->Close();
+            return 0;
+        },
+        [async_data, &write_buffer](Kernel::HLERequestContext& ctx) {
+            write_buffer.Write(async_data->buffer.data(), 0, async_data->buffer.size());
+            IPC::RequestBuilder rb(ctx, 2, 2);
+            rb.Push(ResultSuccess);
+            rb.Push<u32>(async_data->bytes_read);
+            rb.PushMappedBuffer(write_buffer);
+        });
 }
 
 void Module::Interface::ReadMessage(Kernel::HLERequestContext& ctx) {
@@ -182,59 +229,46 @@ void Module::Interface::ReadMessage(Kernel::HLERequestContext& ctx) {
     auto& message_id_buffer = rp.PopMappedBuffer();
     auto& write_buffer = rp.PopMappedBuffer();
 
-    FileSys::Mode mode;
-    mode.read_flag.Assign(1);
-
     std::vector<u8> id_buffer(message_id_size);
     message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
 
-    FileSys::Path message_path =
+    const std::string message_path =
         cecd->GetCecDataPathTypeAsString(is_outbox ? CecDataPathType::OutboxMsg
                                                    : CecDataPathType::InboxMsg,
-                                         ncch_program_id, id_buffer)
-            .data();
-
-    auto message_result = cecd->cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 4);
-    if (message_result.Succeeded()) {
-        auto message = std::move(message_result).Unwrap();
-        std::vector<u8> buffer(buffer_size);
-
-        const u32 bytes_read =
-            static_cast<u32>(message->Read(0, buffer_size, buffer.data()).Unwrap());
-        write_buffer.Write(buffer.data(), 0, buffer_size);
-        message->Close();
-
-        CecMessageHeader msg_header;
-        std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
-
-        LOG_DEBUG(Service_CECD,
-                  "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
-                  "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
-                  "batch_id={:#010x}",
-                  msg_header.magic, msg_header.message_size, msg_header.header_size,
-                  msg_header.body_size, msg_header.title_id, msg_header.title_id2,
-                  msg_header.batch_id);
-        LOG_DEBUG(Service_CECD,
-                  "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
-                  "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
-                  "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
-                  "forward_count={:#04x}, user_data={:#06x}, ",
-                  msg_header.unknown_id, msg_header.version, msg_header.flag,
-                  msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
-                  msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
-                  msg_header.forward_count, msg_header.user_data);
-
-        rb.Push(ResultSuccess);
-        rb.Push<u32>(bytes_read);
-    } else {
-        rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                       ErrorLevel::Status));
-        rb.Push<u32>(0); // zero bytes read
-    }
-    rb.PushMappedBuffer(message_id_buffer);
-    rb.PushMappedBuffer(write_buffer);
+                                         ncch_program_id, id_buffer);
+
+    struct AsyncData {
+        ResultVal<u32> bytes_read;
+        std::vector<u8> buffer;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->buffer.resize(buffer_size);
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, message_path, async_data](Kernel::HLERequestContext& ctx) {
+            async_data->bytes_read = cecd->ReadArchiveFile(message_path, async_data->buffer);
+            if (async_data->bytes_read.Succeeded() &&
+                async_data->buffer.size() >= sizeof(CecMessageHeader)) {
+                CecMessageHeader msg_header;
+                std::memcpy(&msg_header, async_data->buffer.data(), sizeof(CecMessageHeader));
+                LogMessageHeader(msg_header);
+            }
+            return 0;
+        },
+        [async_data, &message_id_buffer, &write_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 2, 4);
+            if (async_data->bytes_read.Succeeded()) {
+                write_buffer.Write(async_data->buffer.data(), 0, async_data->buffer.size());
+                rb.Push(ResultSuccess);
+                rb.Push<u32>(async_data->bytes_read.Unwrap());
+            } else {
+                rb.Push(async_data->bytes_read.Code());
+                rb.Push<u32>(0); // zero bytes read
+            }
+            rb.PushMappedBuffer(message_id_buffer);
+            rb.PushMappedBuffer(write_buffer);
+        });
 
     LOG_DEBUG(
         Service_CECD,
@@ -252,83 +286,72 @@ void Module::Interface::ReadMessageWithHMAC(Kernel::HLERequestContext& ctx) {
     auto& hmac_key_buffer = rp.PopMappedBuffer();
     auto& write_buffer = rp.PopMappedBuffer();
 
-    FileSys::Mode mode;
-    mode.read_flag.Assign(1);
-
     std::vector<u8> id_buffer(message_id_size);
     message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
 
-    FileSys::Path message_path =
+    const std::string message_path =
         cecd->GetCecDataPathTypeAsString(is_outbox ? CecDataPathType::OutboxMsg
                                                    : CecDataPathType::InboxMsg,
-                                         ncch_program_id, id_buffer)
-            .data();
-
-    auto message_result = cecd->cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 6);
-    if (message_result.Succeeded()) {
-        auto message = std::move(message_result).Unwrap();
-        std::vector<u8> buffer(buffer_size);
-
-        const u32 bytes_read =
-            static_cast<u32>(message->Read(0, buffer_size, buffer.data()).Unwrap());
-        write_buffer.Write(buffer.data(), 0, buffer_size);
-        message->Close();
-
-        CecMessageHeader msg_header;
-        std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
-
-        LOG_DEBUG(Service_CECD,
-                  "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
-                  "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
-                  "batch_id={:#010x}",
-                  msg_header.magic, msg_header.message_size, msg_header.header_size,
-                  msg_header.body_size, msg_header.title_id, msg_header.title_id2,
-                  msg_header.batch_id);
-        LOG_DEBUG(Service_CECD,
-                  "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
-                  "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
-                  "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
-                  "forward_count={:#04x}, user_data={:#06x}, ",
-                  msg_header.unknown_id, msg_header.version, msg_header.flag,
-                  msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
-                  msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
-                  msg_header.forward_count, msg_header.user_data);
-
-        std::vector<u8> hmac_digest(0x20);
-        std::memcpy(hmac_digest.data(),
-                    buffer.data() + msg_header.header_size + msg_header.body_size, 0x20);
+                                         ncch_program_id, id_buffer);
+
+    struct AsyncData {
+        ResultVal<u32> bytes_read;
+        std::vector<u8> buffer;
+        std::array<u8, 0x20> key;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->buffer.resize(buffer_size);
+    hmac_key_buffer.Read(async_data->key.data(), 0, async_data->key.size());
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, message_path, async_data](Kernel::HLERequestContext& ctx) {
+            async_data->bytes_read = cecd->ReadArchiveFile(message_path, async_data->buffer);
+            if (async_data->bytes_read.Failed() ||
+                async_data->buffer.size() < sizeof(CecMessageHeader)) {
+                return 0;
+            }
 
-        std::vector<u8> message_body(msg_header.body_size);
-        std::memcpy(message_body.data(), buffer.data() + msg_header.header_size,
-                    msg_header.body_size);
+            const auto& buffer = async_data->buffer;
+            CecMessageHeader msg_header;
+            std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
+            LogMessageHeader(msg_header);
 
-        using namespace CryptoPP;
-        SecByteBlock key(0x20);
-        hmac_key_buffer.Read(key.data(), 0, key.size());
+            std::vector<u8> hmac_digest(0x20);
+            std::memcpy(hmac_digest.data(),
+                        buffer.data() + msg_header.header_size + msg_header.body_size, 0x20);
 
-        HMAC<SHA256> hmac(key, key.size());
+            std::vector<u8> message_body(msg_header.body_size);
+            std::memcpy(message_body.data(), buffer.data() + msg_header.header_size,
+                        msg_header.body_size);
 
-        const bool verify_hmac =
-            hmac.VerifyDigest(hmac_digest.data(), message_body.data(), message_body.size());
+            using namespace CryptoPP;
+            HMAC<SHA256> hmac(async_data->key.data(), async_data->key.size());
 
-        if (verify_hmac)
-            LOG_DEBUG(Service_CECD, "Verification succeeded");
-        else
-            LOG_DEBUG(Service_CECD, "Verification failed");
+            const bool verify_hmac =
+                hmac.VerifyDigest(hmac_digest.data(), message_body.data(), message_body.size());
 
-        rb.Push(ResultSuccess);
-        rb.Push<u32>(bytes_read);
-    } else {
-        rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                       ErrorLevel::Status));
-        rb.Push<u32>(0); // zero bytes read
-    }
-
-    rb.PushMappedBuffer(message_id_buffer);
-    rb.PushMappedBuffer(hmac_key_buffer);
-    rb.PushMappedBuffer(write_buffer);
+            if (verify_hmac)
+                LOG_DEBUG(Service_CECD, "Verification succeeded");
+            else
+                LOG_DEBUG(Service_CECD, "Verification failed");
+            return 0;
+        },
+        [async_data, &message_id_buffer, &hmac_key_buffer,
+         &write_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 2, 6);
+            if (async_data->bytes_read.Succeeded()) {
+                write_buffer.Write(async_data->buffer.data(), 0, async_data->buffer.size());
+                rb.Push(ResultSuccess);
+                rb.Push<u32>(async_data->bytes_read.Unwrap());
+            } else {
+                rb.Push(async_data->bytes_read.Code());
+                rb.Push<u32>(0); // zero bytes read
+            }
+            rb.PushMappedBuffer(message_id_buffer);
+            rb.PushMappedBuffer(hmac_key_buffer);
+            rb.PushMappedBuffer(write_buffer);
+        });
 
     LOG_DEBUG(
         Service_CECD,
@@ -350,38 +373,44 @@ void Module::Interface::Write(Kernel::HLERequestContext& ctx) {
               session_data->open_mode.unknown.Value(), session_data->open_mode.read.Value(),
               session_data->open_mode.write.Value(), session_data->open_mode.create.Value(),
               session_data->open_mode.check.Value());
+    LOG_DEBUG(Service_CECD, "called, read_buffer_size={:#x}", read_buffer_size);
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    switch (session_data->data_path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir:
+    if (IsDirectoryPathType(session_data->data_path_type)) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
         rb.Push(Result(ErrorDescription::NotAuthorized, ErrorModule::CEC, ErrorSummary::NotFound,
                        ErrorLevel::Status));
-        break;
-    default: // If not directory, then it is a file
-        std::vector<u8> buffer(read_buffer_size);
-        read_buffer.Read(buffer.data(), 0, read_buffer_size);
-
-        if (session_data->file->GetSize() != read_buffer_size) {
-            session_data->file->SetSize(read_buffer_size);
-        }
+        rb.PushMappedBuffer(read_buffer);
+        return;
+    }
 
-        if (session_data->open_mode.check) {
-            cecd->CheckAndUpdateFile(session_data->data_path_type, session_data->ncch_program_id,
-                                     buffer);
-        }
+    // If not directory, then it is a file
+    auto buffer = std::make_shared<std::vector<u8>>(read_buffer_size);
+    read_buffer.Read(buffer->data(), 0, read_buffer_size);
 
-        [[maybe_unused]] const u32 bytes_written = static_cast<u32>(
-            session_data->file->Write(0, buffer.size(), true, false, buffer.data()).Unwrap());
-        session_data->file->Close();
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, session_data, buffer](Kernel::HLERequestContext& ctx) {
+            if (session_data->file->GetSize() != buffer->size()) {
+                session_data->file->SetSize(buffer->size());
+            }
 
-        rb.Push(ResultSuccess);
-    }
-    rb.PushMappedBuffer(read_buffer);
+            if (session_data->open_mode.check) {
+                cecd->CheckAndUpdateFile(session_data->data_path_type,
+                                         session_data->ncch_program_id, *buffer);
+            }
 
-    LOG_DEBUG(Service_CECD, "called, read_buffer_size={:#x}", read_buffer_size);
+            [[maybe_unused]] const u32 bytes_written = static_cast<u32>(
+                session_data->file->Write(0, buffer->size(), true, false, buffer->data())
+                    .Unwrap());
+            session_data->file->Close();
+            cecd->message_header_index.erase(session_data->path.AsString());
+            return 0;
+        },
+        [&read_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 2);
+            rb.Push(ResultSuccess);
+            rb.PushMappedBuffer(read_buffer);
+        });
 }
 
 void Module::Interface::WriteMessage(Kernel::HLERequestContext& ctx) {
@@ -393,60 +422,35 @@ void Module::Interface::WriteMessage(Kernel::HLERequestContext& ctx) {
     auto& read_buffer = rp.PopMappedBuffer();
     auto& message_id_buffer = rp.PopMappedBuffer();
 
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
-
     std::vector<u8> id_buffer(message_id_size);
     message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
 
-    FileSys::Path message_path =
+    const std::string message_path =
         cecd->GetCecDataPathTypeAsString(is_outbox ? CecDataPathType::OutboxMsg
                                                    : CecDataPathType::InboxMsg,
-                                         ncch_program_id, id_buffer)
-            .data();
-
-    auto message_result = cecd->cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 4);
-    if (message_result.Succeeded()) {
-        auto message = std::move(message_result).Unwrap();
-
-        std::vector<u8> buffer(buffer_size);
-        read_buffer.Read(buffer.data(), 0, buffer_size);
-
-        CecMessageHeader msg_header;
-        std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
-
-        LOG_DEBUG(Service_CECD,
-                  "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
-                  "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
-                  "batch_id={:#010x}",
-                  msg_header.magic, msg_header.message_size, msg_header.header_size,
-                  msg_header.body_size, msg_header.title_id, msg_header.title_id2,
-                  msg_header.batch_id);
-        LOG_DEBUG(Service_CECD,
-                  "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
-                  "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
-                  "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
-                  "forward_count={:#04x}, user_data={:#06x}, ",
-                  msg_header.unknown_id, msg_header.version, msg_header.flag,
-                  msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
-                  msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
-                  msg_header.forward_count, msg_header.user_data);
-
-        [[maybe_unused]] const u32 bytes_written =
-            static_cast<u32>(message->Write(0, buffer_size, true, false, buffer.data()).Unwrap());
-        message->Close();
-
-        rb.Push(ResultSuccess);
-    } else {
-        rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                       ErrorLevel::Status));
-    }
-
-    rb.PushMappedBuffer(read_buffer);
-    rb.PushMappedBuffer(message_id_buffer);
+                                         ncch_program_id, id_buffer);
+
+    auto buffer = std::make_shared<std::vector<u8>>(buffer_size);
+    read_buffer.Read(buffer->data(), 0, buffer_size);
+    auto result = std::make_shared<Result>(ResultSuccess);
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, message_path, buffer, result](Kernel::HLERequestContext& ctx) {
+            if (buffer->size() >= sizeof(CecMessageHeader)) {
+                CecMessageHeader msg_header;
+                std::memcpy(&msg_header, buffer->data(), sizeof(CecMessageHeader));
+                LogMessageHeader(msg_header);
+            }
+            *result = cecd->WriteArchiveFile(message_path, *buffer, false);
+            return 0;
+        },
+        [result, &read_buffer, &message_id_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 4);
+            rb.Push(*result);
+            rb.PushMappedBuffer(read_buffer);
+            rb.PushMappedBuffer(message_id_buffer);
+        });
 
     LOG_DEBUG(
         Service_CECD,
@@ -464,77 +468,58 @@ void Module::Interface::WriteMessageWithHMAC(Kernel::HLERequestContext& ctx) {
     auto& hmac_key_buffer = rp.PopMappedBuffer();
     auto& message_id_buffer = rp.PopMappedBuffer();
 
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
-
     std::vector<u8> id_buffer(message_id_size);
     message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
 
-    FileSys::Path message_path =
+    const std::string message_path =
         cecd->GetCecDataPathTypeAsString(is_outbox ? CecDataPathType::OutboxMsg
                                                    : CecDataPathType::InboxMsg,
-                                         ncch_program_id, id_buffer)
-            .data();
-
-    auto message_result = cecd->cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 6);
-    if (message_result.Succeeded()) {
-        auto message = std::move(message_result).Unwrap();
-
-        std::vector<u8> buffer(buffer_size);
-        read_buffer.Read(buffer.data(), 0, buffer_size);
-
-        CecMessageHeader msg_header;
-        std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
-
-        LOG_DEBUG(Service_CECD,
-                  "magic={:#06x}, message_size={:#010x}, header_size={:#010x}, "
-                  "body_size={:#010x}, title_id={:#010x}, title_id_2={:#010x}, "
-                  "batch_id={:#010x}",
-                  msg_header.magic, msg_header.message_size, msg_header.header_size,
-                  msg_header.body_size, msg_header.title_id, msg_header.title_id2,
-                  msg_header.batch_id);
-        LOG_DEBUG(Service_CECD,
-                  "unknown_id={:#010x}, version={:#010x}, flag={:#04x}, "
-                  "send_method={:#04x}, is_unopen={:#04x}, is_new={:#04x}, "
-                  "sender_id={:#018x}, sender_id2={:#018x}, send_count={:#04x}, "
-                  "forward_count={:#04x}, user_data={:#06x}, ",
-                  msg_header.unknown_id, msg_header.version, msg_header.flag,
-                  msg_header.send_method, msg_header.is_unopen, msg_header.is_new,
-                  msg_header.sender_id, msg_header.sender_id2, msg_header.send_count,
-                  msg_header.forward_count, msg_header.user_data);
-
-        const u32 hmac_offset = msg_header.header_size + msg_header.body_size;
-        const u32 hmac_size = 0x20;
-
-        std::vector<u8> hmac_digest(hmac_size);
-        std::vector<u8> message_body(msg_header.body_size);
-        std::memcpy(message_body.data(), buffer.data() + msg_header.header_size,
-                    msg_header.body_size);
-
-        using namespace CryptoPP;
-        SecByteBlock key(hmac_size);
-        hmac_key_buffer.Read(key.data(), 0, hmac_size);
-
-        HMAC<SHA256> hmac(key, hmac_size);
-        hmac.CalculateDigest(hmac_digest.data(), message_body.data(), msg_header.body_size);
-        std::memcpy(buffer.data() + hmac_offset, hmac_digest.data(), hmac_size);
-
-        [[maybe_unused]] const u32 bytes_written =
-            static_cast<u32>(message->Write(0, buffer_size, true, false, buffer.data()).Unwrap());
-        message->Close();
-
-        rb.Push(ResultSuccess);
-    } else {
-        rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                       ErrorLevel::Status));
-    }
-
-    rb.PushMappedBuffer(read_buffer);
-    rb.PushMappedBuffer(hmac_key_buffer);
-    rb.PushMappedBuffer(message_id_buffer);
+                                         ncch_program_id, id_buffer);
+
+    struct AsyncData {
+        Result result{ResultSuccess};
+        std::vector<u8> buffer;
+        std::array<u8, 0x20> key;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->buffer.resize(buffer_size);
+    read_buffer.Read(async_data->buffer.data(), 0, buffer_size);
+    hmac_key_buffer.Read(async_data->key.data(), 0, async_data->key.size());
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, message_path, async_data](Kernel::HLERequestContext& ctx) {
+            auto& buffer = async_data->buffer;
+            if (buffer.size() >= sizeof(CecMessageHeader)) {
+                CecMessageHeader msg_header;
+                std::memcpy(&msg_header, buffer.data(), sizeof(CecMessageHeader));
+                LogMessageHeader(msg_header);
+
+                const u32 hmac_offset = msg_header.header_size + msg_header.body_size;
+                const u32 hmac_size = 0x20;
+
+                std::vector<u8> hmac_digest(hmac_size);
+                std::vector<u8> message_body(msg_header.body_size);
+                std::memcpy(message_body.data(), buffer.data() + msg_header.header_size,
+                            msg_header.body_size);
+
+                using namespace CryptoPP;
+                HMAC<SHA256> hmac(async_data->key.data(), hmac_size);
+                hmac.CalculateDigest(hmac_digest.data(), message_body.data(),
+                                     msg_header.body_size);
+                std::memcpy(buffer.data() + hmac_offset, hmac_digest.data(), hmac_size);
+            }
+            async_data->result = cecd->WriteArchiveFile(message_path, buffer, false);
+            return 0;
+        },
+        [async_data, &read_buffer, &hmac_key_buffer,
+         &message_id_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 6);
+            rb.Push(async_data->result);
+            rb.PushMappedBuffer(read_buffer);
+            rb.PushMappedBuffer(hmac_key_buffer);
+            rb.PushMappedBuffer(message_id_buffer);
+        });
 
     LOG_DEBUG(
         Service_CECD,
@@ -550,40 +535,39 @@ void Module::Interface::Delete(Kernel::HLERequestContext& ctx) {
     const u32 message_id_size = rp.Pop<u32>();
     auto& message_id_buffer = rp.PopMappedBuffer();
 
-    FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    switch (path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir:
-        rb.Push(cecd->cecd_system_save_data_archive->DeleteDirectoryRecursively(path));
-        break;
-    default: // If not directory, then it is a file
-        if (message_id_size == 0) {
-            rb.Push(cecd->cecd_system_save_data_archive->DeleteFile(path));
-        } else {
-            std::vector<u8> id_buffer(message_id_size);
-            message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
-
-            FileSys::Path message_path =
-                cecd->GetCecDataPathTypeAsString(is_outbox ? CecDataPathType::OutboxMsg
-                                                           : CecDataPathType::InboxMsg,
-                                                 ncch_program_id, id_buffer)
-                    .data();
-            rb.Push(cecd->cecd_system_save_data_archive->DeleteFile(message_path));
-        }
+    std::string path = cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id);
+    const bool is_directory = IsDirectoryPathType(path_type);
+    if (!is_directory && message_id_size != 0) {
+        std::vector<u8> id_buffer(message_id_size);
+        message_id_buffer.Read(id_buffer.data(), 0, message_id_size);
+        path = cecd->GetCecDataPathTypeAsString(is_outbox ? CecDataPathType::OutboxMsg
+                                                          : CecDataPathType::InboxMsg,
+                                                ncch_program_id, id_buffer);
     }
 
-    rb.PushMappedBuffer(message_id_buffer);
+    auto result = std::make_shared<Result>(ResultSuccess);
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, path, is_directory, result](Kernel::HLERequestContext& ctx) {
+            const FileSys::Path archive_path(path.data());
+            auto& archive = cecd->cecd_system_save_data_archive;
+            *result = is_directory ? archive->DeleteDirectoryRecursively(archive_path)
+                                   : archive->DeleteFile(archive_path);
+            if (result->IsSuccess()) {
+                cecd->RemoveIndexEntry(path);
+            }
+            return 0;
+        },
+        [result, &message_id_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 2);
+            rb.Push(*result);
+            rb.PushMappedBuffer(message_id_buffer);
+        });
 
     LOG_DEBUG(Service_CECD,
               "called, ncch_program_id={:#010x}, path_type={:#04x}, path={}, "
               "is_outbox={}, message_id_size={:#x}",
-              ncch_program_id, path_type, path.AsString(), is_outbox, message_id_size);
+              ncch_program_id, path_type, path, is_outbox, message_id_size);
 }
 
 void Module::Interface::SetData(Kernel::HLERequestContext& ctx) {
@@ -593,32 +577,34 @@ void Module::Interface::SetData(Kernel::HLERequestContext& ctx) {
     const u32 option = rp.Pop<u32>();
     auto& read_buffer = rp.PopMappedBuffer();
 
-    if (option == 2 && buffer_size > 0) { // update obindex?
-        FileSys::Path path(
-            cecd->GetCecDataPathTypeAsString(CecDataPathType::OutboxIndex, ncch_program_id).data());
-        FileSys::Mode mode;
-        mode.write_flag.Assign(1);
-        mode.create_flag.Assign(1);
-
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-            std::vector<u8> buffer(buffer_size);
-            read_buffer.Read(buffer.data(), 0, buffer_size);
-
-            cecd->CheckAndUpdateFile(CecDataPathType::OutboxIndex, ncch_program_id, buffer);
+    LOG_DEBUG(Service_CECD, "called, ncch_program_id={:#010x}, buffer_size={:#x}, option={:#x}",
+              ncch_program_id, buffer_size, option);
 
-            file->Write(0, buffer.size(), true, false, buffer.data());
-            file->Close();
-        }
+    if (option != 2 || buffer_size == 0) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(ResultSuccess);
+        rb.PushMappedBuffer(read_buffer);
+        return;
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    rb.Push(ResultSuccess);
-    rb.PushMappedBuffer(read_buffer);
-
-    LOG_DEBUG(Service_CECD, "called, ncch_program_id={:#010x}, buffer_size={:#x}, option={:#x}",
-              ncch_program_id, buffer_size, option);
+    // update obindex?
+    auto buffer = std::make_shared<std::vector<u8>>(buffer_size);
+    read_buffer.Read(buffer->data(), 0, buffer_size);
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, ncch_program_id, buffer](Kernel::HLERequestContext& ctx) {
+            cecd->CheckAndUpdateFile(CecDataPathType::OutboxIndex, ncch_program_id, *buffer);
+            void(cecd->WriteArchiveFile(
+                cecd->GetCecDataPathTypeAsString(CecDataPathType::OutboxIndex, ncch_program_id),
+                *buffer, false));
+            return 0;
+        },
+        [&read_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 2);
+            rb.Push(ResultSuccess);
+            rb.PushMappedBuffer(read_buffer);
+        });
 }
 
 void Module::Interface::ReadData(Kernel::HLERequestContext& ctx) {
@@ -735,54 +721,47 @@ void Module::Interface::OpenAndWrite(Kernel::HLERequestContext& ctx) {
     rp.PopPID();
     auto& read_buffer = rp.PopMappedBuffer();
 
-    FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    switch (path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir:
-        rb.Push(Result(ErrorDescription::NotAuthorized, ErrorModule::CEC, ErrorSummary::NotFound,
-                       ErrorLevel::Status));
-        break;
-    default: // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-
-            std::vector<u8> buffer(buffer_size);
-            read_buffer.Read(buffer.data(), 0, buffer_size);
-
-            if (file->GetSize() != buffer_size) {
-                file->SetSize(buffer_size);
-            }
-
-            if (open_mode.check) {
-                cecd->CheckAndUpdateFile(path_type, ncch_program_id, buffer);
-            }
-
-            [[maybe_unused]] const u32 bytes_written = static_cast<u32>(
-                file->Write(0, buffer.size(), true, false, buffer.data()).Unwrap());
-            file->Close();
-
-            rb.Push(ResultSuccess);
-        } else {
-            rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                           ErrorLevel::Status));
-        }
-    }
-    rb.PushMappedBuffer(read_buffer);
+    const std::string path = cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id);
 
     LOG_DEBUG(Service_CECD,
               "called, ncch_program_id={:#010x}, path_type={:#04x}, path={}, buffer_size={:#x} "
               "open_mode: raw={:#x}, unknown={}, read={}, write={}, create={}, check={}",
-              ncch_program_id, path_type, path.AsString(), buffer_size, open_mode.raw,
+              ncch_program_id, path_type, path, buffer_size, open_mode.raw,
               open_mode.unknown.Value(), open_mode.read.Value(), open_mode.write.Value(),
               open_mode.create.Value(), open_mode.check.Value());
+
+    if (IsDirectoryPathType(path_type)) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(Result(ErrorDescription::NotAuthorized, ErrorModule::CEC, ErrorSummary::NotFound,
+                       ErrorLevel::Status));
+        rb.PushMappedBuffer(read_buffer);
+        return;
+    }
+
+    // If not directory, then it is a file
+    struct AsyncData {
+        Result result{ResultSuccess};
+        std::vector<u8> buffer;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->buffer.resize(buffer_size);
+    read_buffer.Read(async_data->buffer.data(), 0, buffer_size);
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, path, path_type, ncch_program_id, open_mode,
+         async_data](Kernel::HLERequestContext& ctx) {
+            if (open_mode.check) {
+                cecd->CheckAndUpdateFile(path_type, ncch_program_id, async_data->buffer);
+            }
+            async_data->result = cecd->WriteArchiveFile(path, async_data->buffer, true);
+            return 0;
+        },
+        [async_data, &read_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 1, 2);
+            rb.Push(async_data->result);
+            rb.PushMappedBuffer(read_buffer);
+        });
 }
 
 void Module::Interface::OpenAndRead(Kernel::HLERequestContext& ctx) {
@@ -795,47 +774,50 @@ void Module::Interface::OpenAndRead(Kernel::HLERequestContext& ctx) {
     rp.PopPID();
     auto& write_buffer = rp.PopMappedBuffer();
 
-    FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.read_flag.Assign(1);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    switch (path_type) {
-    case CecDataPathType::RootDir:
-    case CecDataPathType::MboxDir:
-    case CecDataPathType::InboxDir:
-    case CecDataPathType::OutboxDir:
-        rb.Push(Result(ErrorDescription::NotAuthorized, ErrorModule::CEC, ErrorSummary::NotFound,
-                       ErrorLevel::Status));
-        rb.Push<u32>(0); // No entries read
-        break;
-    default: // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-            std::vector<u8> buffer(buffer_size);
-
-            const u32 bytes_read =
-                static_cast<u32>(file->Read(0, buffer_size, buffer.data()).Unwrap());
-            write_buffer.Write(buffer.data(), 0, buffer_size);
-            file->Close();
-
-            rb.Push(ResultSuccess);
-            rb.Push<u32>(bytes_read);
-        } else {
-            rb.Push(Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                           ErrorLevel::Status));
-            rb.Push<u32>(0); // No bytes read
-        }
-    }
-    rb.PushMappedBuffer(write_buffer);
+    const std::string path = cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id);
 
     LOG_DEBUG(Service_CECD,
               "called, ncch_program_id={:#010x}, path_type={:#04x}, path={}, buffer_size={:#x} "
               "open_mode: raw={:#x}, unknown={}, read={}, write={}, create={}, check={}",
-              ncch_program_id, path_type, path.AsString(), buffer_size, open_mode.raw,
+              ncch_program_id, path_type, path, buffer_size, open_mode.raw,
               open_mode.unknown.Value(), open_mode.read.Value(), open_mode.write.Value(),
               open_mode.create.Value(), open_mode.check.Value());
+
+    if (IsDirectoryPathType(path_type)) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+        rb.Push(Result(ErrorDescription::NotAuthorized, ErrorModule::CEC, ErrorSummary::NotFound,
+                       ErrorLevel::Status));
+        rb.Push<u32>(0); // No entries read
+        rb.PushMappedBuffer(write_buffer);
+        return;
+    }
+
+    // If not directory, then it is a file
+    struct AsyncData {
+        ResultVal<u32> bytes_read;
+        std::vector<u8> buffer;
+    };
+    auto async_data = std::make_shared<AsyncData>();
+    async_data->buffer.resize(buffer_size);
+
+    ctx.RunAsyncOn(
+        *cecd->io_worker,
+        [this, path, async_data](Kernel::HLERequestContext& ctx) {
+            async_data->bytes_read = cecd->ReadArchiveFile(path, async_data->buffer);
+            return 0;
+        },
+        [async_data, &write_buffer](Kernel::HLERequestContext& ctx) {
+            IPC::RequestBuilder rb(ctx, 2, 2);
+            if (async_data->bytes_read.Succeeded()) {
+                write_buffer.Write(async_data->buffer.data(), 0, async_data->buffer.size());
+                rb.Push(ResultSuccess);
+                rb.Push<u32>(async_data->bytes_read.Unwrap());
+            } else {
+                rb.Push(async_data->bytes_read.Code());
+                rb.Push<u32>(0); // No bytes read
+            }
+            rb.PushMappedBuffer(write_buffer);
+        });
 }
 
 void Module::Interface::GetCecInfoEventHandleSys(Kernel::HLERequestContext& ctx) {
@@ -1025,26 +1007,20 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
                 /// We need to read the /CEC directory to find out which titles, if any,
                 /// are activated. The num_of_titles = (total_read_count) - 1, to adjust for
                 /// the MBoxList____ file that is present in the directory as well.
-                FileSys::Path root_path(
-                    GetCecDataPathTypeAsString(CecDataPathType::RootDir, 0).data());
-
-                auto dir_result = cecd_system_save_data_archive->OpenDirectory(root_path);
-
-                auto root_dir = std::move(dir_result).Unwrap();
-                std::vector<FileSys::Entry> entries(max_num_boxes + 1); // + 1 mboxlist
-                const u32 entry_count = root_dir->Read(max_num_boxes + 1, entries.data());
-                root_dir->Close();
+                const auto* root_entries =
+                    ListDirectory(GetCecDataPathTypeAsString(CecDataPathType::RootDir, 0));
+                const u32 entry_count =
+                    root_entries ? std::min(static_cast<u32>(root_entries->size()),
+                                            max_num_boxes + 1) // + 1 mboxlist
+                                 : 0;
 
                 LOG_DEBUG(Service_CECD, "Number of entries found in /CEC: {}", entry_count);
 
                 std::string mbox_list_name("MBoxList____");
-                std::string file_name;
-                std::u16string u16_filename;
 
                 // Loop through entries but don't add mboxlist____ to itself.
                 for (u32 i = 0; i < entry_count; i++) {
-                    u16_filename = std::u16string(entries[i].filename);
-                    file_name = Common::UTF16ToUTF8(u16_filename);
+                    const std::string& file_name = (*root_entries)[i];
 
                     if (mbox_list_name.compare(file_name) != 0) {
                         LOG_DEBUG(Service_CECD, "Adding title to mboxlist____: {}", file_name);
@@ -1214,51 +1190,31 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
         /// We need to read the /CEC/<id>/OutBox directory to find out which messages, if any,
         /// are present. The num_of_messages = (total_read_count) - 2, to adjust for
         /// the BoxInfo____ and OBIndex_____files that are present in the directory as well.
-        FileSys::Path outbox_path(
-            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id).data());
-
-        auto dir_result = cecd_system_save_data_archive->OpenDirectory(outbox_path);
-
-        auto outbox_dir = std::move(dir_result).Unwrap();
-        std::vector<FileSys::Entry> entries(outbox_info_header.max_message_num + 2);
+        const std::string outbox_path =
+            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id);
+        const auto* outbox_entries = ListDirectory(outbox_path);
         const u32 entry_count =
-            outbox_dir->Read(outbox_info_header.max_message_num + 2, entries.data());
-        outbox_dir->Close();
+            outbox_entries ? std::min(static_cast<u32>(outbox_entries->size()),
+                                      outbox_info_header.max_message_num + 2)
+                           : 0;
 
         LOG_DEBUG(Service_CECD, "Number of entries found in /OutBox: {}", entry_count);
         std::array<CecMessageHeader, 8> message_headers;
 
         std::string boxinfo_name("BoxInfo_____");
         std::string obindex_name("OBIndex_____");
-        std::string file_name;
-        std::u16string u16_filename;
 
         for (u32 i = 0; i < entry_count; i++) {
-            u16_filename = std::u16string(entries[i].filename);
-            file_name = Common::UTF16ToUTF8(u16_filename);
+            const std::string& file_name = (*outbox_entries)[i];
 
-            if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0) {
+            if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0 &&
+                outbox_info_header.message_num < message_headers.size()) {
                 LOG_DEBUG(Service_CECD, "Adding message to BoxInfo_____: {}", file_name);
 
-                FileSys::Path message_path(
-                    (GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
-                     file_name)
-                        .data());
-
-                FileSys::Mode mode;
-                mode.read_flag.Assign(1);
-
-                auto message_result = cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-                auto message = std::move(message_result).Unwrap();
-                const u32 message_size = static_cast<u32>(message->GetSize());
-                std::vector<u8> buffer(message_size);
-
-                void(message->Read(0, message_size, buffer.data()).Unwrap());
-                message->Close();
-
-                std::memcpy(&message_headers[outbox_info_header.message_num++], buffer.data(),
-                            sizeof(CecMessageHeader));
+                const auto header = GetMessageHeader(outbox_path + "/" + file_name);
+                if (header) {
+                    message_headers[outbox_info_header.message_num++] = *header;
+                }
             }
         }
 
@@ -1307,48 +1263,27 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
         /// We need to read the /CEC/<id>/OutBox directory to find out which messages, if any,
         /// are present. The num_of_messages = (total_read_count) - 2, to adjust for
         /// the BoxInfo____ and OBIndex_____files that are present in the directory as well.
-        FileSys::Path outbox_path(
-            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id).data());
-
-        auto dir_result = cecd_system_save_data_archive->OpenDirectory(outbox_path);
-
-        auto outbox_dir = std::move(dir_result).Unwrap();
-        std::vector<FileSys::Entry> entries(8);
-        const u32 entry_count = outbox_dir->Read(8, entries.data());
-        outbox_dir->Close();
+        const std::string outbox_path =
+            GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id);
+        const auto* outbox_entries = ListDirectory(outbox_path);
+        const u32 entry_count =
+            outbox_entries ? std::min(static_cast<u32>(outbox_entries->size()), 8u) : 0;
 
         LOG_DEBUG(Service_CECD, "Number of entries found in /OutBox: {}", entry_count);
         std::array<std::array<u8, 8>, 8> message_ids;
 
         std::string boxinfo_name("BoxInfo_____");
         std::string obindex_name("OBIndex_____");
-        std::string file_name;
-        std::u16string u16_filename;
 
         for (u32 i = 0; i < entry_count; i++) {
-            u16_filename = std::u16string(entries[i].filename);
-            file_name = Common::UTF16ToUTF8(u16_filename);
-
-            if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0) {
-                FileSys::Path message_path(
-                    (GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
-                     file_name)
-                        .data());
-
-                FileSys::Mode mode;
-                mode.read_flag.Assign(1);
-
-                auto message_result = cecd_system_save_data_archive->OpenFile(message_path, mode);
+            const std::string& file_name = (*outbox_entries)[i];
 
-                auto message = std::move(message_result).Unwrap();
-                const u32 message_size = static_cast<u32>(message->GetSize());
-                std::vector<u8> buffer(message_size);
-
-                void(message->Read(0, message_size, buffer.data()).Unwrap());
-                message->Close();
-
-                // Message id is at offset 0x20, and is 8 bytes
-                std::memcpy(&message_ids[obindex_header.message_num++], buffer.data() + 0x20, 8);
+            if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0 &&
+                obindex_header.message_num < message_ids.size()) {
+                const auto header = GetMessageHeader(outbox_path + "/" + file_name);
+                if (header) {
+                    message_ids[obindex_header.message_num++] = header->message_id;
+                }
             }
         }
 
@@ -1379,6 +1314,123 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
     }
 }
 
+ResultVal<u32> Module::ReadArchiveFile(const std::string& path, std::vector<u8>& buffer) {
+    FileSys::Mode mode;
+    mode.read_flag.Assign(1);
+
+    auto file_result = cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (file_result.Failed()) {
+        LOG_DEBUG(Service_CECD, "Failed to open file: {}", path);
+        return Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
+                      ErrorLevel::Status);
+    }
+
+    auto file = std::move(file_result).Unwrap();
+    const u32 bytes_read = static_cast<u32>(file->Read(0, buffer.size(), buffer.data()).Unwrap());
+    file->Close();
+    return bytes_read;
+}
+
+Result Module::WriteArchiveFile(const std::string& path, std::span<const u8> buffer,
+                                bool resize) {
+    FileSys::Mode mode;
+    mode.write_flag.Assign(1);
+    mode.create_flag.Assign(1);
+
+    auto file_result = cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (file_result.Failed()) {
+        LOG_DEBUG(Service_CECD, "Failed to open file: {}", path);
+        return Result(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
+                      ErrorLevel::Status);
+    }
+    AddIndexEntry(path);
+    message_header_index.erase(path);
+
+    auto file = std::move(file_result).Unwrap();
+    if (resize && file->GetSize() != buffer.size()) {
+        file->SetSize(buffer.size());
+    }
+    [[maybe_unused]] const u32 bytes_written =
+        static_cast<u32>(file->Write(0, buffer.size(), true, false, buffer.data()).Unwrap());
+    file->Close();
+    return ResultSuccess;
+}
+
+const std::vector<std::string>* Module::ListDirectory(const std::string& path) {
+    if (const auto it = directory_index.find(path); it != directory_index.end()) {
+        return &it->second;
+    }
+
+    auto dir_result = cecd_system_save_data_archive->OpenDirectory(FileSys::Path(path.data()));
+    if (dir_result.Failed()) {
+        return nullptr;
+    }
+    auto directory = std::move(dir_result).Unwrap();
+
+    std::vector<std::string> names;
+    std::array<FileSys::Entry, 32> entries;
+    u32 entry_count;
+    while ((entry_count = directory->Read(static_cast<u32>(entries.size()), entries.data())) > 0) {
+        for (u32 i = 0; i < entry_count; i++) {
+            names.push_back(Common::UTF16ToUTF8(std::u16string(entries[i].filename)));
+        }
+    }
+    directory->Close();
+
+    LOG_DEBUG(Service_CECD, "Indexed {} entries in {}", names.size(), path);
+    return &directory_index.emplace(path, std::move(names)).first->second;
+}
+
+void Module::AddIndexEntry(const std::string& path) {
+    const std::size_t separator = path.rfind('/');
+    const auto parent = directory_index.find(path.substr(0, separator));
+    if (parent == directory_index.end()) {
+        return;
+    }
+    auto& names = parent->second;
+    std::string name = path.substr(separator + 1);
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+        names.push_back(std::move(name));
+    }
+}
+
+void Module::RemoveIndexEntry(const std::string& path) {
+    const std::size_t separator = path.rfind('/');
+    const auto parent = directory_index.find(path.substr(0, separator));
+    if (parent != directory_index.end()) {
+        std::erase(parent->second, path.substr(separator + 1));
+    }
+
+    const auto is_removed = [&path](const auto& entry) {
+        return entry.first == path || entry.first.starts_with(path + '/');
+    };
+    std::erase_if(directory_index, is_removed);
+    std::erase_if(message_header_index, is_removed);
+}
+
+std::optional<CecMessageHeader> Module::GetMessageHeader(const std::string& path) {
+    if (const auto it = message_header_index.find(path); it != message_header_index.end()) {
+        return it->second;
+    }
+
+    FileSys::Mode mode;
+    mode.read_flag.Assign(1);
+    auto message_result =
+        cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (message_result.Failed()) {
+        return std::nullopt;
+    }
+
+    auto message = std::move(message_result).Unwrap();
+    CecMessageHeader header{};
+    const u64 header_size = std::min<u64>(message->GetSize(), sizeof(CecMessageHeader));
+    void(message->Read(0, header_size, reinterpret_cast<u8*>(&header)).Unwrap());
+    message->Close();
+
+    message_header_index.emplace(path, header);
+    return header;
+}
+
 Module::SessionData::SessionData() {}
 
 Module::SessionData::~SessionData() {
@@ -1391,6 +1443,12 @@ Module::Interface::Interface(std::shared_ptr<Module> cecd, const char* name, u32
 
 Module::Module(Core::System& system) : system(system) {
     using namespace Kernel;
+    io_worker = std::make_unique<Common::ThreadWorker>(1, "CECD:IO");
+    io_worker->QueueWork([] {
+        Common::SetCurrentThreadPriority(Common::ThreadPriority::Low);
+        Common::SetCurrentThreadCoreClass(Common::CoreClass::Efficiency);
+    });
+
     cecinfo_event = system.Kernel().CreateEvent(Kernel::ResetType::OneShot, "CECD::cecinfo_event");
     cecinfosys_event =
         system.Kernel().CreateEvent(Kernel::ResetType::OneShot, "CECD::cecinfosys_event");
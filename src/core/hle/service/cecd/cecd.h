@@ -5,9 +5,14 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
+#include "common/thread_worker.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/service.h"
@@ -622,12 +627,43 @@ private:
     void CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_program_id,
                             std::vector<u8>& file_buffer);
 
+    /// Reads the start of the file at path into buffer, returns the number of bytes read
+    ResultVal<u32> ReadArchiveFile(const std::string& path, std::vector<u8>& buffer);
+
+    /**
+     * Writes buffer to the start of the file at path, creating the file if needed
+     * @param resize Whether to set the size of the file to the size of buffer
+     */
+    Result WriteArchiveFile(const std::string& path, std::span<const u8> buffer, bool resize);
+
+    /// Returns the names of the entries in the directory at path, or nullptr if it does not exist
+    const std::vector<std::string>* ListDirectory(const std::string& path);
+
+    /// Records the file or directory at path in the index of its parent directory
+    void AddIndexEntry(const std::string& path);
+
+    /// Drops the file or directory at path, and everything below it, from the index
+    void RemoveIndexEntry(const std::string& path);
+
+    /// Returns the header of the message file at path, or std::nullopt if it does not exist
+    std::optional<CecMessageHeader> GetMessageHeader(const std::string& path);
+
     std::unique_ptr<FileSys::ArchiveBackend> cecd_system_save_data_archive;
 
     std::shared_ptr<Kernel::Event> cecinfo_event;
     std::shared_ptr<Kernel::Event> cecinfosys_event;
     std::shared_ptr<Kernel::Event> change_state_event;
 
+    /// In-memory index of the mailboxes, only used by the handlers running on io_worker.
+    /// Directories are listed from the archive once and then kept up to date by the handlers that
+    /// create and delete files, so listing them and reading the message headers of a box does not
+    /// touch the disk again.
+    std::unordered_map<std::string, std::vector<std::string>> directory_index;
+    std::unordered_map<std::string, CecMessageHeader> message_header_index;
+
+    /// Low priority thread running the handlers that access the archive, in request order
+    std::unique_ptr<Common::ThreadWorker> io_worker;
+
     Core::System& system;
 
     template <class Archive>
@@ -121,7 +121,7 @@ ArchiveManager::OpenFileFromArchive(ArchiveHandle archive_handle, const FileSys:
         return std::make_pair(backend.Code(), open_timeout_ns);
     }
 
-    auto file = std::make_shared<File>(system.Kernel(), std::move(backend).Unwrap(), path);
+    auto file = std::make_shared<File>(system, std::move(backend).Unwrap(), path);
     return std::make_pair(std::move(file), open_timeout_ns);
 }
 
@@ -474,7 +474,14 @@ void ArchiveManager::RegisterArticSystemSaveData(
 }
 
 ArchiveManager::ArchiveManager(Core::System& system) : system(system) {
+    io_worker = std::make_unique<Common::ThreadWorker>(2, "FS:IO");
     RegisterArchiveTypes();
 }
 
+ArchiveManager::~ArchiveManager() {
+    // The queued reads reference the Files and requests owned by the kernel, finish them while
+    // those are still alive.
+    io_worker->WaitForRequests();
+}
+
 } // namespace Service::FS
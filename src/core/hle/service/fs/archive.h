@@ -11,6 +11,7 @@
 #include <boost/serialization/unique_ptr.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/archive_source_sd_savedata.h"
 #include "core/hle/result.h"
@@ -89,6 +90,7 @@ using FileSys::ArchiveFactory;
 class ArchiveManager {
 public:
     explicit ArchiveManager(Core::System& system);
+    ~ArchiveManager();
 
     /**
      * Opens an archive
@@ -300,9 +302,17 @@ public:
 
     void RegisterArticSystemSaveData(std::shared_ptr<Network::ArticBase::Client>& client);
 
+    /// Returns the worker servicing the large reads of files that do not allow cached reads
+    Common::ThreadWorker& GetIOWorker() {
+        return *io_worker;
+    }
+
 private:
     Core::System& system;
 
+    /// Threads servicing the large reads of files, queued by File::Read
+    std::unique_ptr<Common::ThreadWorker> io_worker;
+
     /**
      * Registers an Archive type, instances of which can later be opened using its IdCode.
      * @param factory File system backend interface to the archive
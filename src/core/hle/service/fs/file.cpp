@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <optional>
+#include <span>
 #include <boost/serialization/unique_ptr.hpp>
 #include "common/archives.h"
 #include "common/logging/log.h"
@@ -13,6 +15,7 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
 
 SERIALIZE_EXPORT_IMPL(Service::FS::File)
@@ -20,6 +23,62 @@ SERIALIZE_EXPORT_IMPL(Service::FS::FileSessionSlot)
 
 namespace Service::FS {
 
+namespace {
+
+/// Reads of at least this size are serviced on the IO worker while the other guest threads run
+constexpr u32 ASYNC_READ_THRESHOLD = 64 * 1024;
+
+/// Reads the file straight into the buffer when it is plain guest memory, returns nothing when
+/// the data has to be written with MappedBuffer::Write instead.
+std::optional<ResultVal<std::size_t>> ReadToBuffer(const FileSys::FileBackend& backend,
+                                                   u64 offset, std::size_t length,
+                                                   Kernel::MappedBuffer& buffer) {
+    const auto segments = buffer.GetSegments(0, length);
+    if (segments.empty()) {
+        return std::nullopt;
+    }
+    std::size_t total_read = 0;
+    for (const std::span<u8> segment : segments) {
+        const auto read = backend.Read(offset + total_read, segment.size(), segment.data());
+        if (read.Failed()) {
+            return read.Code();
+        }
+        total_read += *read;
+        if (*read < segment.size()) {
+            break;
+        }
+    }
+    return total_read;
+}
+
+/// Writes the buffer straight from guest memory when it is plain memory, returns nothing when
+/// the data has to be read with MappedBuffer::Read instead.
+std::optional<ResultVal<std::size_t>> WriteFromBuffer(FileSys::FileBackend& backend, u64 offset,
+                                                      std::size_t length, bool flush,
+                                                      bool update_timestamp,
+                                                      Kernel::MappedBuffer& buffer) {
+    const auto segments = buffer.GetSegments(0, length);
+    if (segments.empty()) {
+        return std::nullopt;
+    }
+    std::size_t total_written = 0;
+    for (std::size_t i = 0; i < segments.size(); i++) {
+        const bool last = i == segments.size() - 1;
+        const auto written = backend.Write(offset + total_written, segments[i].size(),
+                                           flush && last, update_timestamp, segments[i].data());
+        if (written.Failed()) {
+            return written.Code();
+        }
+        total_written += *written;
+        if (*written < segments[i].size()) {
+            break;
+        }
+    }
+    return total_written;
+}
+
+} // Anonymous namespace
+
 template <class Archive>
 void File::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
@@ -27,17 +86,18 @@ void File::serialize(Archive& ar, const unsigned int) {
     ar & backend;
 }
 
-File::File() : File(Core::Global<Kernel::KernelSystem>()) {}
+File::File() : File(Core::Global<Core::System>()) {}
 
-File::File(Kernel::KernelSystem& kernel, std::unique_ptr<FileSys::FileBackend>&& backend,
+File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
            const FileSys::Path& path)
-    : File(kernel) {
+    : File(system) {
     this->backend = std::move(backend);
     this->path = path;
 }
 
-File::File(Kernel::KernelSystem& kernel)
-    : ServiceFramework("", 1), path(""), backend(nullptr), kernel(kernel) {
+File::File(Core::System& system)
+    : ServiceFramework("", 1), path(""), backend(nullptr), system(system),
+      kernel(system.Kernel()) {
     static const FunctionInfo functions[] = {
         {0x0801, &File::OpenSubFile, "OpenSubFile"},
         {0x0802, &File::Read, "Read"},
@@ -75,19 +135,64 @@ void File::Read(Kernel::HLERequestContext& ctx) {
                   offset, length, backend->GetSize());
     }
 
-    // Conventional reading if the backend does not support cache.
+    // Conventional reading if the backend does not support cache. Large reads are done on the IO
+    // worker, the client thread is woken after the same delay either way.
+    if (!backend->AllowsCachedReads() && length >= ASYNC_READ_THRESHOLD) {
+        struct AsyncData {
+            Kernel::MappedBuffer* buffer;
+            std::unique_ptr<u8[]> data;
+            ResultVal<std::size_t> read;
+        };
+        auto async_data = std::make_shared<AsyncData>();
+        async_data->buffer = &rp.PopMappedBuffer();
+
+        const std::chrono::nanoseconds read_delay{backend->GetReadDelayNs(length)};
+        ctx.RunAsyncOnWithDelay(
+            system.ArchiveManager().GetIOWorker(), read_delay,
+            [this, async_data, offset, length](Kernel::HLERequestContext& ctx) {
+                std::scoped_lock lock{backend_mutex};
+                auto read = ReadToBuffer(*backend, offset, length, *async_data->buffer);
+                if (!read) {
+                    async_data->data = std::make_unique_for_overwrite<u8[]>(length);
+                    read = backend->Read(offset, length, async_data->data.get());
+                }
+                async_data->read = std::move(*read);
+            },
+            [async_data](Kernel::HLERequestContext& ctx) {
+                IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+                if (async_data->read.Failed()) {
+                    rb.Push(async_data->read.Code());
+                    rb.Push<u32>(0);
+                } else {
+                    if (async_data->data) {
+                        async_data->buffer->Write(async_data->data.get(), 0, *async_data->read);
+                    }
+                    rb.Push(ResultSuccess);
+                    rb.Push<u32>(static_cast<u32>(*async_data->read));
+                }
+                rb.PushMappedBuffer(*async_data->buffer);
+            });
+        return;
+    }
     if (!backend->AllowsCachedReads()) {
+        std::scoped_lock lock{backend_mutex};
         auto& buffer = rp.PopMappedBuffer();
         IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-        std::unique_ptr<u8[]> data = std::make_unique_for_overwrite<u8[]>(length);
-        const auto read = backend->Read(offset, length, data.get());
-        if (read.Failed()) {
-            rb.Push(read.Code());
+        std::unique_ptr<u8[]> data;
+        auto read = ReadToBuffer(*backend, offset, length, buffer);
+        if (!read) {
+            data = std::make_unique_for_overwrite<u8[]>(length);
+            read = backend->Read(offset, length, data.get());
+        }
+        if (read->Failed()) {
+            rb.Push(read->Code());
             rb.Push<u32>(0);
         } else {
-            buffer.Write(data.get(), 0, *read);
+            if (data) {
+                buffer.Write(data.get(), 0, **read);
+            }
             rb.Push(ResultSuccess);
-            rb.Push<u32>(static_cast<u32>(*read));
+            rb.Push<u32>(static_cast<u32>(**read));
         }
         rb.PushMappedBuffer(buffer);
 
@@ -122,15 +227,19 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     // LOG_DEBUG(Service_FS, "cache={}, offset={}, length={}", cache_ready, offset, length);
     ctx.RunAsync(
         [this, async_data](Kernel::HLERequestContext& ctx) {
-            async_data->data = std::make_unique_for_overwrite<u8[]>(async_data->length);
-            const auto read =
-                backend->Read(async_data->offset, async_data->length, async_data->data.get());
-            if (read.Failed()) {
-                async_data->ret = read.Code();
+            auto read = ReadToBuffer(*backend, async_data->offset, async_data->length,
+                                     *async_data->buffer);
+            if (!read) {
+                async_data->data = std::make_unique_for_overwrite<u8[]>(async_data->length);
+                read = backend->Read(async_data->offset, async_data->length,
+                                     async_data->data.get());
+            }
+            if (read->Failed()) {
+                async_data->ret = read->Code();
                 async_data->read_size = 0;
             } else {
                 async_data->ret = ResultSuccess;
-                async_data->read_size = *read;
+                async_data->read_size = **read;
             }
 
             const auto read_delay = static_cast<s64>(backend->GetReadDelayNs(async_data->length));
@@ -155,7 +264,9 @@ void File::Read(Kernel::HLERequestContext& ctx) {
                 rb.Push(async_data->ret);
                 rb.Push<u32>(0);
             } else {
-                async_data->buffer->Write(async_data->data.get(), 0, async_data->read_size);
+                if (async_data->data) {
+                    async_data->buffer->Write(async_data->data.get(), 0, async_data->read_size);
+                }
                 rb.Push(ResultSuccess);
                 rb.Push<u32>(static_cast<u32>(async_data->read_size));
             }
@@ -187,20 +298,23 @@ void File::Write(Kernel::HLERequestContext& ctx) {
     bool flush = (flags & 0xFF) != 0, update_timestamp = (flags & 0xFF00) != 0;
 
     if (!backend->AllowsCachedReads()) {
-        std::vector<u8> data(length);
-        buffer.Read(data.data(), 0, data.size());
-        ResultVal<std::size_t> written =
-            backend->Write(offset, data.size(), flush, update_timestamp, data.data());
+        std::scoped_lock lock{backend_mutex};
+        auto written = WriteFromBuffer(*backend, offset, length, flush, update_timestamp, buffer);
+        if (!written) {
+            std::vector<u8> data(length);
+            buffer.Read(data.data(), 0, data.size());
+            written = backend->Write(offset, data.size(), flush, update_timestamp, data.data());
+        }
 
         // Update file size
         file->size = backend->GetSize();
 
-        if (written.Failed()) {
-            rb.Push(written.Code());
+        if (written->Failed()) {
+            rb.Push(written->Code());
             rb.Push<u32>(0);
         } else {
             rb.Push(ResultSuccess);
-            rb.Push<u32>(static_cast<u32>(*written));
+            rb.Push<u32>(static_cast<u32>(**written));
         }
         rb.PushMappedBuffer(buffer);
         return;
@@ -228,10 +342,16 @@ void File::Write(Kernel::HLERequestContext& ctx) {
 
     ctx.RunAsync(
         [this, async_data](Kernel::HLERequestContext& ctx) {
-            std::vector<u8> data(async_data->length);
-            async_data->buffer->Read(data.data(), 0, data.size());
-            async_data->written = backend->Write(async_data->offset, data.size(), async_data->flush,
-                                                 async_data->update_timestamp, data.data());
+            auto written = WriteFromBuffer(*backend, async_data->offset, async_data->length,
+                                           async_data->flush, async_data->update_timestamp,
+                                           *async_data->buffer);
+            if (!written) {
+                std::vector<u8> data(async_data->length);
+                async_data->buffer->Read(data.data(), 0, data.size());
+                written = backend->Write(async_data->offset, data.size(), async_data->flush,
+                                         async_data->update_timestamp, data.data());
+            }
+            async_data->written = std::move(*written);
 
             // Update file size
             async_data->file->size = backend->GetSize();
@@ -275,6 +395,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     }
 
     if (!backend->AllowsCachedReads()) {
+        std::scoped_lock lock{backend_mutex};
         IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
         file->size = size;
         backend->SetSize(size);
@@ -304,6 +425,7 @@ void File::Close(Kernel::HLERequestContext& ctx) {
                     connected_sessions.size());
 
     if (!backend->AllowsCachedReads()) {
+        std::scoped_lock lock{backend_mutex};
         backend->Close();
         IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
         rb.Push(ResultSuccess);
@@ -335,6 +457,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
     }
 
     if (!backend->AllowsCachedReads()) {
+        std::scoped_lock lock{backend_mutex};
         IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
         backend->Flush();
         rb.Push(ResultSuccess);
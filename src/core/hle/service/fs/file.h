@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <boost/serialization/base_object.hpp>
 #include "core/file_sys/archive_backend.h"
 #include "core/global.h"
@@ -39,7 +40,7 @@ private:
 // Consider splitting ServiceFramework interface.
 class File final : public ServiceFramework<File, FileSessionSlot> {
 public:
-    File(Kernel::KernelSystem& kernel, std::unique_ptr<FileSys::FileBackend>&& backend,
+    File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
          const FileSys::Path& path);
     ~File() = default;
 
@@ -73,9 +74,14 @@ private:
     void OpenLinkFile(Kernel::HLERequestContext& ctx);
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
+    Core::System& system;
     Kernel::KernelSystem& kernel;
 
-    File(Kernel::KernelSystem& kernel);
+    /// Serializes the use of backends that do not allow cached reads between the IPC handlers and
+    /// the reads serviced on the IO worker
+    std::mutex backend_mutex;
+
+    File(Core::System& system);
     File();
 
     template <class Archive>
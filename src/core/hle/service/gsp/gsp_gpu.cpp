@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <span>
+#include <utility>
 #include <vector>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/optional.hpp>
@@ -371,9 +372,35 @@ void GSP_GPU::SignalInterruptForThread(InterruptId interrupt_id, u32 thread_id)
         }
     }
 
+    // While batching, every thread is woken up once at the end with all its interrupts queued.
+    if (interrupt_batch_depth > 0) {
+        pending_interrupt_signals[thread_id] = true;
+        return;
+    }
     interrupt_event->Signal();
 }
 
+void GSP_GPU::BeginInterruptBatch() {
+    interrupt_batch_depth++;
+}
+
+void GSP_GPU::EndInterruptBatch() {
+    ASSERT(interrupt_batch_depth > 0);
+    if (--interrupt_batch_depth > 0) {
+        return;
+    }
+    for (u32 thread_id = 0; thread_id < MaxGSPThreads; ++thread_id) {
+        if (!std::exchange(pending_interrupt_signals[thread_id], false)) {
+            continue;
+        }
+        // The session may have unregistered while its signal was pending
+        SessionData* session_data = FindRegisteredThreadData(thread_id);
+        if (session_data && session_data->interrupt_event) {
+            session_data->interrupt_event->Signal();
+        }
+    }
+}
+
 void GSP_GPU::SignalInterrupt(InterruptId interrupt_id) {
     if (nullptr == shared_memory) {
         LOG_WARNING(Service_GSP, "cannot synchronize until GSP shared memory has been created!");
@@ -418,6 +445,11 @@ void GSP_GPU::TriggerCmdReqQueue(Kernel::HLERequestContext& ctx) {
 
     bool requires_delay = false;
 
+    // Run every queued command in one pass and wake up the client once for all the interrupts
+    // they raise, instead of once per interrupt.
+    BeginInterruptBatch();
+    system.perf_stats->BeginGPUProcessing();
+
     while (command_buffer->number_commands) {
         if (command_buffer->should_stop) {
             command_buffer->status.Assign(CommandBuffer::STATUS_STOPPED);
@@ -440,15 +472,16 @@ void GSP_GPU::TriggerCmdReqQueue(Kernel::HLERequestContext& ctx) {
         gpu.Debugger().GXCommandProcessed(command);
 
         // Decode and execute command
-        system.perf_stats->BeginGPUProcessing();
         gpu.Execute(command);
-        system.perf_stats->EndGPUProcessing();
 
         if (command.stop) {
             command_buffer->status.Assign(CommandBuffer::STATUS_STOPPED);
         }
     }
 
+    system.perf_stats->EndGPUProcessing();
+    EndInterruptBatch();
+
     if (requires_delay) {
         ctx.RunAsync(
             [](Kernel::HLERequestContext& ctx) {
@@ -106,6 +106,15 @@ public:
      */
     void SignalInterrupt(InterruptId interrupt_id);
 
+    /**
+     * Starts deferring the interrupt event signals. The interrupts are still written to the relay
+     * queues as they occur, but each thread is only signalled once when the batch ends.
+     */
+    void BeginInterruptBatch();
+
+    /// Ends an interrupt batch, signalling every thread that received interrupts during it
+    void EndInterruptBatch();
+
     /**
      * Retrieves the framebuffer info stored in the GSP shared memory for the
      * specified screen index and thread id.
@@ -405,6 +414,12 @@ private:
     /// Thread ids currently in use by the sessions connected to the GSPGPU service.
     std::array<bool, MaxGSPThreads> used_thread_ids{};
 
+    /// Nesting depth of the interrupt batches, interrupt events are signalled when it is zero.
+    u32 interrupt_batch_depth = 0;
+
+    /// Threads whose interrupt event must be signalled when the current batch ends.
+    std::array<bool, MaxGSPThreads> pending_interrupt_signals{};
+
     friend class SessionData;
 
     template <class Archive>
@@ -46,7 +46,7 @@ void Module::serialize(Archive& ar, const unsigned int file_version) {
     ar & enable_accelerometer_count;
     ar & enable_gyroscope_count;
     if (Archive::is_loading::value) {
-        LoadInputDevices();
+        input_poller.ReloadDevices();
     }
     ar & state.hex;
     ar & circle_pad_old_x;
@@ -114,31 +114,9 @@ DirectionState GetStickDirectionState(s16 circle_pad_x, s16 circle_pad_y) {
     return state;
 }
 
-void Module::LoadInputDevices() {
-    std::transform(Settings::values.current_input_profile.buttons.begin() +
-                       Settings::NativeButton::BUTTON_HID_BEGIN,
-                   Settings::values.current_input_profile.buttons.begin() +
-                       Settings::NativeButton::BUTTON_HID_END,
-                   buttons.begin(), Input::CreateDevice<Input::ButtonDevice>);
-    circle_pad = Input::CreateDevice<Input::AnalogDevice>(
-        Settings::values.current_input_profile.analogs[Settings::NativeAnalog::CirclePad]);
-    motion_device = Input::CreateDevice<Input::MotionDevice>(
-        Settings::values.current_input_profile.motion_device);
-    touch_device = Input::CreateDevice<Input::TouchDevice>(
-        Settings::values.current_input_profile.touch_device);
-    if (Settings::values.current_input_profile.use_touch_from_button) {
-        touch_btn_device = Input::CreateDevice<Input::TouchDevice>("engine:touch_from_button");
-    } else {
-        touch_btn_device.reset();
-    }
-}
-
 void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
     SharedMem* mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
-    if (is_device_reload_pending.exchange(false))
-        LoadInputDevices();
-
     using namespace Settings::NativeButton;
 
     if (artic_controller.get() && artic_controller->IsReady()) {
@@ -194,24 +172,26 @@ void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
 
         system.Movie().HandleTouchStatus(touch_entry);
     } else {
-        state.a.Assign(buttons[A - BUTTON_HID_BEGIN]->GetStatus());
-        state.b.Assign(buttons[B - BUTTON_HID_BEGIN]->GetStatus());
-        state.x.Assign(buttons[X - BUTTON_HID_BEGIN]->GetStatus());
-        state.y.Assign(buttons[Y - BUTTON_HID_BEGIN]->GetStatus());
-        state.right.Assign(buttons[Right - BUTTON_HID_BEGIN]->GetStatus());
-        state.left.Assign(buttons[Left - BUTTON_HID_BEGIN]->GetStatus());
-        state.up.Assign(buttons[Up - BUTTON_HID_BEGIN]->GetStatus());
-        state.down.Assign(buttons[Down - BUTTON_HID_BEGIN]->GetStatus());
-        state.l.Assign(buttons[L - BUTTON_HID_BEGIN]->GetStatus());
-        state.r.Assign(buttons[R - BUTTON_HID_BEGIN]->GetStatus());
-        state.start.Assign(buttons[Start - BUTTON_HID_BEGIN]->GetStatus());
-        state.select.Assign(buttons[Select - BUTTON_HID_BEGIN]->GetStatus());
-        state.debug.Assign(buttons[Debug - BUTTON_HID_BEGIN]->GetStatus());
-        state.gpio14.Assign(buttons[Gpio14 - BUTTON_HID_BEGIN]->GetStatus());
+        const InputSnapshot& input = input_poller.GetSnapshot();
+        const auto& buttons = input.buttons;
+        state.a.Assign(buttons[A - BUTTON_HID_BEGIN]);
+        state.b.Assign(buttons[B - BUTTON_HID_BEGIN]);
+        state.x.Assign(buttons[X - BUTTON_HID_BEGIN]);
+        state.y.Assign(buttons[Y - BUTTON_HID_BEGIN]);
+        state.right.Assign(buttons[Right - BUTTON_HID_BEGIN]);
+        state.left.Assign(buttons[Left - BUTTON_HID_BEGIN]);
+        state.up.Assign(buttons[Up - BUTTON_HID_BEGIN]);
+        state.down.Assign(buttons[Down - BUTTON_HID_BEGIN]);
+        state.l.Assign(buttons[L - BUTTON_HID_BEGIN]);
+        state.r.Assign(buttons[R - BUTTON_HID_BEGIN]);
+        state.start.Assign(buttons[Start - BUTTON_HID_BEGIN]);
+        state.select.Assign(buttons[Select - BUTTON_HID_BEGIN]);
+        state.debug.Assign(buttons[Debug - BUTTON_HID_BEGIN]);
+        state.gpio14.Assign(buttons[Gpio14 - BUTTON_HID_BEGIN]);
 
         // Get current circle pad position and update circle pad direction
-        float circle_pad_x_f, circle_pad_y_f;
-        std::tie(circle_pad_x_f, circle_pad_y_f) = circle_pad->GetStatus();
+        const float circle_pad_x_f = input.circle_pad_x;
+        const float circle_pad_y_f = input.circle_pad_y;
 
         // xperia64: 0x9A seems to be the calibrated limit of the circle pad
         // Verified by using Input Redirector with very large-value digital inputs
@@ -272,15 +252,9 @@ void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
 
         // Get the current touch entry
         TouchDataEntry& touch_entry = mem->touch.entries[mem->touch.index];
-        bool pressed = false;
-        float x, y;
-        std::tie(x, y, pressed) = touch_device->GetStatus();
-        if (!pressed && touch_btn_device) {
-            std::tie(x, y, pressed) = touch_btn_device->GetStatus();
-        }
-        touch_entry.x = static_cast<u16>(x * Core::kScreenBottomWidth);
-        touch_entry.y = static_cast<u16>(y * Core::kScreenBottomHeight);
-        touch_entry.valid.Assign(pressed ? 1 : 0);
+        touch_entry.x = static_cast<u16>(input.touch_x * Core::kScreenBottomWidth);
+        touch_entry.y = static_cast<u16>(input.touch_y * Core::kScreenBottomHeight);
+        touch_entry.valid.Assign(input.touch_pressed ? 1 : 0);
 
         system.Movie().HandleTouchStatus(touch_entry);
     }
@@ -325,8 +299,7 @@ void Module::UpdateAccelerometerCallback(std::uintptr_t user_data, s64 cycles_la
         accelerometer_entry.y = data.accel_y;
         accelerometer_entry.z = data.accel_z;
     } else {
-        Common::Vec3<float> accel;
-        std::tie(accel, std::ignore) = motion_device->GetStatus();
+        Common::Vec3<float> accel = input_poller.GetSnapshot().accel;
         accel *= accelerometer_coef;
         // TODO(wwylele): do a time stretch like the one in UpdateGyroscopeCallback
         // The time stretch formula should be like
@@ -377,8 +350,7 @@ void Module::UpdateGyroscopeCallback(std::uintptr_t user_data, s64 cycles_late)
         gyroscope_entry.y = data.gyro_y;
         gyroscope_entry.z = data.gyro_z;
     } else {
-        Common::Vec3<float> gyro;
-        std::tie(std::ignore, gyro) = motion_device->GetStatus();
+        Common::Vec3<float> gyro = input_poller.GetSnapshot().gyro;
         double stretch = system.perf_stats->GetLastFrameTimeScale();
         gyro *= gyroscope_coef * static_cast<float>(stretch);
         gyroscope_entry.x = static_cast<s16>(gyro.x);
@@ -694,7 +666,7 @@ void Module::UseArticClient(const std::shared_ptr<Network::ArticBase::Client>& c
 }
 
 void Module::ReloadInputDevices() {
-    is_device_reload_pending.store(true);
+    input_poller.ReloadDevices();
 }
 
 const PadState& Module::GetState() const {
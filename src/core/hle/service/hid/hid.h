@@ -16,7 +16,7 @@
 #include "common/settings.h"
 #include "core/core.h"
 #include "core/core_timing.h"
-#include "core/frontend/input.h"
+#include "core/hle/service/hid/input_poller.h"
 #include "core/hle/service/service.h"
 #include "network/artic_base/artic_base_client.h"
 
@@ -344,7 +344,6 @@ public:
     static constexpr u64 gyroscope_update_ticks = BASE_CLOCK_RATE_ARM11 / 101;
 
 private:
-    void LoadInputDevices();
     void UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late);
     void UpdateAccelerometerCallback(std::uintptr_t user_data, s64 cycles_late);
     void UpdateGyroscopeCallback(std::uintptr_t user_data, s64 cycles_late);
@@ -385,13 +384,7 @@ private:
     Core::TimingEventType* accelerometer_update_event;
     Core::TimingEventType* gyroscope_update_event;
 
-    std::atomic<bool> is_device_reload_pending{true};
-    std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeButton::NUM_BUTTONS_HID>
-        buttons;
-    std::unique_ptr<Input::AnalogDevice> circle_pad;
-    std::unique_ptr<Input::MotionDevice> motion_device;
-    std::unique_ptr<Input::TouchDevice> touch_device;
-    std::unique_ptr<Input::TouchDevice> touch_btn_device;
+    InputPoller input_poller;
 
     std::shared_ptr<ArticBaseController> artic_controller;
     std::shared_ptr<Network::ArticBase::Client> artic_client;
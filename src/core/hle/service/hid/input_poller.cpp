@@ -0,0 +1,83 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+#include "common/cpu_affinity.h"
+#include "common/thread.h"
+#include "core/hle/service/hid/input_poller.h"
+
+namespace Service::HID {
+
+InputPoller::InputPoller() {
+    const u32 rate = Settings::values.input_polling_rate.GetValue();
+    if (rate != 0) {
+        thread = std::jthread([this, rate](std::stop_token stop_token) {
+            PollLoop(stop_token, rate);
+        });
+    }
+}
+
+InputPoller::~InputPoller() = default;
+
+const InputSnapshot& InputPoller::GetSnapshot() {
+    if (!thread.joinable()) {
+        Poll();
+    }
+    return snapshots.Read();
+}
+
+void InputPoller::PollLoop(std::stop_token stop_token, u32 rate) {
+    Common::SetCurrentThreadName("InputPoller");
+    Common::SetCurrentThreadCoreClass(Common::CoreClass::Efficiency);
+
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::nanoseconds{1'000'000'000 / rate};
+    auto next_poll = Clock::now();
+    while (!stop_token.stop_requested()) {
+        Poll();
+        // Polls missed while the thread was descheduled are skipped rather than caught up on
+        next_poll = std::max(next_poll + period, Clock::now());
+        Common::StoppableTimedWait(stop_token, next_poll - Clock::now());
+    }
+}
+
+void InputPoller::LoadDevices() {
+    const auto& profile = Settings::values.current_input_profile;
+    std::transform(profile.buttons.begin() + Settings::NativeButton::BUTTON_HID_BEGIN,
+                   profile.buttons.begin() + Settings::NativeButton::BUTTON_HID_END,
+                   buttons.begin(), Input::CreateDevice<Input::ButtonDevice>);
+    circle_pad = Input::CreateDevice<Input::AnalogDevice>(
+        profile.analogs[Settings::NativeAnalog::CirclePad]);
+    motion_device = Input::CreateDevice<Input::MotionDevice>(profile.motion_device);
+    touch_device = Input::CreateDevice<Input::TouchDevice>(profile.touch_device);
+    if (profile.use_touch_from_button) {
+        touch_btn_device = Input::CreateDevice<Input::TouchDevice>("engine:touch_from_button");
+    } else {
+        touch_btn_device.reset();
+    }
+}
+
+void InputPoller::Poll() {
+    if (reload_pending.exchange(false)) {
+        LoadDevices();
+    }
+
+    InputSnapshot& snapshot = snapshots.WriteBuffer();
+    for (std::size_t i = 0; i < buttons.size(); i++) {
+        snapshot.buttons[i] = buttons[i]->GetStatus();
+    }
+    std::tie(snapshot.circle_pad_x, snapshot.circle_pad_y) = circle_pad->GetStatus();
+    std::tie(snapshot.accel, snapshot.gyro) = motion_device->GetStatus();
+    std::tie(snapshot.touch_x, snapshot.touch_y, snapshot.touch_pressed) =
+        touch_device->GetStatus();
+    if (!snapshot.touch_pressed && touch_btn_device) {
+        std::tie(snapshot.touch_x, snapshot.touch_y, snapshot.touch_pressed) =
+            touch_btn_device->GetStatus();
+    }
+    snapshots.Publish();
+}
+
+} // namespace Service::HID
@@ -0,0 +1,68 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include "common/polyfill_thread.h"
+#include "common/settings.h"
+#include "common/triple_buffer.h"
+#include "common/vector_math.h"
+#include "core/frontend/input.h"
+
+namespace Service::HID {
+
+/// State of the HID input devices at the time they were last polled
+struct InputSnapshot {
+    std::array<bool, Settings::NativeButton::NUM_BUTTONS_HID> buttons{};
+    float circle_pad_x = 0.0f;
+    float circle_pad_y = 0.0f;
+    Common::Vec3<float> accel{};
+    Common::Vec3<float> gyro{};
+    float touch_x = 0.0f;
+    float touch_y = 0.0f;
+    bool touch_pressed = false;
+};
+
+/**
+ * Polls the HID input devices on a thread of its own at the rate set by input_polling_rate, so that
+ * the emulation thread never waits on the locks of the input backends. The HID update events read
+ * the latest snapshot without locking. With a rate of 0 the devices are polled by the reader.
+ */
+class InputPoller {
+public:
+    InputPoller();
+    ~InputPoller();
+
+    InputPoller(const InputPoller&) = delete;
+    InputPoller& operator=(const InputPoller&) = delete;
+
+    /// Recreates the devices from the current input profile before the next poll
+    void ReloadDevices() {
+        reload_pending.store(true);
+    }
+
+    /// Returns the latest snapshot. Must only be called by the emulation thread.
+    const InputSnapshot& GetSnapshot();
+
+private:
+    void PollLoop(std::stop_token stop_token, u32 rate);
+    void LoadDevices();
+    void Poll();
+
+    std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeButton::NUM_BUTTONS_HID>
+        buttons;
+    std::unique_ptr<Input::AnalogDevice> circle_pad;
+    std::unique_ptr<Input::MotionDevice> motion_device;
+    std::unique_ptr<Input::TouchDevice> touch_device;
+    std::unique_ptr<Input::TouchDevice> touch_btn_device;
+
+    std::atomic<bool> reload_pending{true};
+    Common::TripleBuffer<InputSnapshot> snapshots;
+    std::jthread thread;
+};
+
+} // namespace Service::HID
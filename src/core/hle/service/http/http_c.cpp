@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
 #include <tuple>
 #include <unordered_map>
@@ -256,6 +257,25 @@ std::size_t Context::HandleHeaderWrite(std::vector<Context::RequestHeader>& pend
     return WriteHeaders(strm, final_headers);
 };
 
+ClientPool::Client ClientPool::Acquire(const std::string& key) {
+    std::scoped_lock lock{mutex};
+    const auto it = idle_clients.find(key);
+    if (it == idle_clients.end() || it->second.empty()) {
+        return nullptr;
+    }
+    Client client = std::move(it->second.back());
+    it->second.pop_back();
+    return client;
+}
+
+void ClientPool::Release(const std::string& key, Client client) {
+    std::scoped_lock lock{mutex};
+    auto& clients = idle_clients[key];
+    if (clients.size() < MaxIdleClientsPerKey) {
+        clients.push_back(std::move(client));
+    }
+}
+
 void Context::ParseAsciiPostData() {
     httplib::Params ascii_form;
     for (auto param : post_data) {
@@ -364,36 +384,69 @@ void Context::MakeRequest() {
         request.is_chunked_content_provider_ = true;
     }
 
-    if (url_info.is_https) {
-        MakeRequestSSL(request, url_info, pending_headers);
-    } else {
-        MakeRequestNonSSL(request, url_info, pending_headers);
-    }
-}
-
-void Context::MakeRequestNonSSL(httplib::Request& request, const URLInfo& url_info,
-                                std::vector<Context::RequestHeader>& pending_headers) {
-    httplib::Error error{-1};
-    std::unique_ptr<httplib::Client> client =
-        std::make_unique<httplib::Client>(url_info.host, url_info.port);
+    // The body is handed to ReceiveData as it arrives instead of once the download is complete
+    request.response_handler = [this](const httplib::Response&) {
+        {
+            std::scoped_lock lock{response_mutex};
+            response_headers_received = true;
+        }
+        state = RequestState::ReceivingBody;
+        response_cv.notify_all();
+        return true;
+    };
+    request.content_receiver = [this](const char* data, size_t data_length, u64, u64) {
+        {
+            std::scoped_lock lock{response_mutex};
+            response_body.insert(response_body.end(), data, data + data_length);
+        }
+        response_cv.notify_all();
+        return true;
+    };
 
+    const std::string pool_key = ClientPoolKey(url_info);
+    ClientPool::Client client = client_pool->Acquire(pool_key);
+    if (!client) {
+        client = CreateClient(url_info);
+    }
+    client->set_keep_alive(keep_alive);
     client->set_header_writer(
         [this, &pending_headers](httplib::Stream& strm, httplib::Headers& httplib_headers) {
             return HandleHeaderWrite(pending_headers, strm, httplib_headers);
         });
 
+    httplib::Error error{-1};
     if (!client->send(request, response, error)) {
         LOG_ERROR(Service_HTTP, "Request failed: {}: {}", error, httplib::to_string(error));
         state = RequestState::Completed;
     } else {
         LOG_DEBUG(Service_HTTP, "Request successful");
         state = RequestState::ReceivingBody;
+        if (keep_alive) {
+            client_pool->Release(pool_key, std::move(client));
+        }
     }
+    FinishResponse();
 }
 
-void Context::MakeRequestSSL(httplib::Request& request, const URLInfo& url_info,
-                             std::vector<Context::RequestHeader>& pending_headers) {
-    httplib::Error error{-1};
+std::string Context::ClientPoolKey(const URLInfo& url_info) const {
+    // Connections authenticated with a client certificate may only be reused with the same one
+    std::string cert;
+    if (url_info.is_https) {
+        if (uses_default_client_cert) {
+            cert = "default";
+        } else if (auto client_cert = ssl_config.client_cert_ctx.lock()) {
+            cert = fmt::format("{}", client_cert->handle);
+        }
+    }
+    return fmt::format("{}://{}:{}/{}", url_info.is_https ? "https" : "http", url_info.host,
+                       url_info.port, cert);
+}
+
+ClientPool::Client Context::CreateClient(const URLInfo& url_info) const {
+    if (!url_info.is_https) {
+        return std::make_unique<httplib::ClientImpl>(url_info.host, url_info.port);
+    }
+
     X509* cert = nullptr;
     EVP_PKEY* key = nullptr;
     const unsigned char* cert_data = nullptr;
@@ -434,19 +487,28 @@ void Context::MakeRequestSSL(httplib::Request& request, const URLInfo& url_info,
     // https://www.3dbrew.org/wiki/SSL_Services#SSLOpt
     // Hack: Since for now RootCerts are not implemented we set the VerifyMode to None.
     client->enable_server_certificate_verification(false);
+    return client;
+}
 
-    client->set_header_writer(
-        [this, &pending_headers](httplib::Stream& strm, httplib::Headers& httplib_headers) {
-            return HandleHeaderWrite(pending_headers, strm, httplib_headers);
-        });
+void Context::FinishResponse() {
+    {
+        std::scoped_lock lock{response_mutex};
+        response_finished = true;
+    }
+    response_cv.notify_all();
+}
 
-    if (!client->send(request, response, error)) {
-        LOG_ERROR(Service_HTTP, "Request failed: {}: {}", error, httplib::to_string(error));
-        state = RequestState::Completed;
-    } else {
-        LOG_DEBUG(Service_HTTP, "Request successful");
-        state = RequestState::ReceivingBody;
+bool Context::WaitForResponse(std::size_t body_size, std::optional<u64> timeout_nanos) {
+    std::unique_lock lock{response_mutex};
+    const auto is_ready = [this, body_size] {
+        return response_finished ||
+               (response_headers_received && response_body.size() >= body_size);
+    };
+    if (!timeout_nanos) {
+        response_cv.wait(lock, is_ready);
+        return true;
     }
+    return response_cv.wait_for(lock, std::chrono::nanoseconds(*timeout_nanos), is_ready);
 }
 
 bool Context::ContentProvider(size_t offset, size_t length, httplib::DataSink& sink) {
@@ -679,14 +741,11 @@ void HTTP_C::ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
         [this, async_data](Kernel::HLERequestContext& ctx) {
             Context& http_context = GetContext(async_data->context_handle);
 
-            if (async_data->timeout) {
-                const auto wait_res = http_context.request_future.wait_for(
-                    std::chrono::nanoseconds(async_data->timeout_nanos));
-                if (wait_res == std::future_status::timeout) {
-                    async_data->async_res = ErrorTimeout;
-                }
-            } else {
-                http_context.request_future.wait();
+            const auto timeout_nanos =
+                async_data->timeout ? std::optional{async_data->timeout_nanos} : std::nullopt;
+            if (!http_context.WaitForResponse(
+                    http_context.current_copied_data + async_data->buffer_size, timeout_nanos)) {
+                async_data->async_res = ErrorTimeout;
             }
             // Simulate small delay from HTTP receive.
             return 1'000'000;
@@ -699,27 +758,31 @@ void HTTP_C::ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
                 return;
             }
             Context& http_context = GetContext(async_data->context_handle);
+            std::scoped_lock lock{http_context.response_mutex};
 
+            // Until the request finished, more data may still arrive after what was received
             const std::size_t remaining_data =
-                http_context.response.body.size() - http_context.current_copied_data;
+                http_context.response_body.size() - http_context.current_copied_data;
 
-            if (async_data->buffer_size >= remaining_data) {
-                async_data->buffer->Write(http_context.response.body.data() +
+            if (http_context.response_finished && async_data->buffer_size >= remaining_data) {
+                async_data->buffer->Write(http_context.response_body.data() +
                                               http_context.current_copied_data,
                                           0, remaining_data);
                 http_context.current_copied_data += remaining_data;
                 http_context.state = RequestState::Completed;
                 rb.Push(ResultSuccess);
             } else {
-                async_data->buffer->Write(http_context.response.body.data() +
+                const std::size_t copy_size =
+                    std::min<std::size_t>(async_data->buffer_size, remaining_data);
+                async_data->buffer->Write(http_context.response_body.data() +
                                               http_context.current_copied_data,
-                                          0, async_data->buffer_size);
-                http_context.current_copied_data += async_data->buffer_size;
+                                          0, copy_size);
+                http_context.current_copied_data += copy_size;
                 rb.Push(ErrorBufferSmall);
             }
-            LOG_DEBUG(Service_HTTP, "Receive: buffer_size= {}, total_copied={}, total_body={}",
+            LOG_DEBUG(Service_HTTP, "Receive: buffer_size= {}, total_copied={}, total_received={}",
                       async_data->buffer_size, http_context.current_copied_data,
-                      http_context.response.body.size());
+                      http_context.response_body.size());
         });
 }
 
@@ -788,6 +851,7 @@ void HTTP_C::CreateContext(Kernel::HLERequestContext& ctx) {
     contexts[context_counter].socket_buffer_size = 0;
     contexts[context_counter].handle = context_counter;
     contexts[context_counter].session_id = session_data->session_id;
+    contexts[context_counter].client_pool = &client_pool;
 
     session_data->num_http_contexts++;
 
@@ -1449,14 +1513,10 @@ void HTTP_C::GetResponseDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
         [this, async_data](Kernel::HLERequestContext& ctx) {
             Context& http_context = GetContext(async_data->context_handle);
 
-            if (async_data->timeout) {
-                const auto wait_res = http_context.request_future.wait_for(
-                    std::chrono::nanoseconds(async_data->timeout_nanos));
-                if (wait_res == std::future_status::timeout) {
-                    async_data->async_res = ErrorTimeout;
-                }
-            } else {
-                http_context.request_future.wait();
+            const auto timeout_nanos =
+                async_data->timeout ? std::optional{async_data->timeout_nanos} : std::nullopt;
+            if (!http_context.WaitForResponse(0, timeout_nanos)) {
+                async_data->async_res = ErrorTimeout;
             }
 
             return 0;
@@ -1544,14 +1604,10 @@ void HTTP_C::GetResponseHeaderImpl(Kernel::HLERequestContext& ctx, bool timeout)
         [this, async_data](Kernel::HLERequestContext& ctx) {
             Context& http_context = GetContext(async_data->context_handle);
 
-            if (async_data->timeout) {
-                const auto wait_res = http_context.request_future.wait_for(
-                    std::chrono::nanoseconds(async_data->timeout_nanos));
-                if (wait_res == std::future_status::timeout) {
-                    async_data->async_res = ErrorTimeout;
-                }
-            } else {
-                http_context.request_future.wait();
+            const auto timeout_nanos =
+                async_data->timeout ? std::optional{async_data->timeout_nanos} : std::nullopt;
+            if (!http_context.WaitForResponse(0, timeout_nanos)) {
+                async_data->async_res = ErrorTimeout;
             }
 
             return 0;
@@ -1644,15 +1700,11 @@ void HTTP_C::GetResponseStatusCodeImpl(Kernel::HLERequestContext& ctx, bool time
         [this, async_data](Kernel::HLERequestContext& ctx) {
             Context& http_context = GetContext(async_data->context_handle);
 
-            if (async_data->timeout) {
-                const auto wait_res = http_context.request_future.wait_for(
-                    std::chrono::nanoseconds(async_data->timeout_nanos));
-                if (wait_res == std::future_status::timeout) {
-                    LOG_DEBUG(Service_HTTP, "Status code: {}", "timeout");
-                    async_data->async_res = ErrorTimeout;
-                }
-            } else {
-                http_context.request_future.wait();
+            const auto timeout_nanos =
+                async_data->timeout ? std::optional{async_data->timeout_nanos} : std::nullopt;
+            if (!http_context.WaitForResponse(0, timeout_nanos)) {
+                LOG_DEBUG(Service_HTTP, "Status code: {}", "timeout");
+                async_data->async_res = ErrorTimeout;
             }
             return 0;
         },
@@ -1939,7 +1991,16 @@ void HTTP_C::SetKeepAlive(Kernel::HLERequestContext& ctx) {
     const u32 context_handle = rp.Pop<u32>();
     const u32 option = rp.Pop<u32>();
 
-    LOG_WARNING(Service_HTTP, "(STUBBED) called, handle={}, option={}", context_handle, option);
+    LOG_DEBUG(Service_HTTP, "called, handle={}, option={}", context_handle, option);
+
+    if (!PerformStateChecks(ctx, rp, context_handle)) {
+        return;
+    }
+
+    // Connections of contexts without keep-alive are closed once the request is done, instead of
+    // being kept in the client pool
+    Context& http_context = GetContext(context_handle);
+    http_context.keep_alive = option != 0;
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(ResultSuccess);
@@ -2018,12 +2079,14 @@ void HTTP_C::GetDownloadSizeState(Kernel::HLERequestContext& ctx) {
     Context& http_context = GetContext(context_handle);
 
     // On the real console, the current downloaded progress and the total size of the content gets
-    // returned. Since we do not support chunked downloads on the host, always return the content
-    // length if the download is complete and 0 otherwise.
+    // returned. Return the content length once the response headers were received and 0 otherwise.
     u32 content_length = 0;
-    const bool is_complete = http_context.request_future.wait_for(std::chrono::milliseconds(0)) ==
-                             std::future_status::ready;
-    if (is_complete) {
+    bool headers_received;
+    {
+        std::scoped_lock lock{http_context.response_mutex};
+        headers_received = http_context.response_headers_received;
+    }
+    if (headers_received) {
         const auto& headers = http_context.response.headers;
         const auto& it = headers.find("Content-Length");
         if (it != headers.end()) {
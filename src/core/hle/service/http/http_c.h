@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -160,6 +162,27 @@ struct ClCertAData {
     bool init = false;
 };
 
+/**
+ * Keeps the connections of finished requests open, so that later requests to the same server reuse
+ * them instead of connecting and doing the TLS handshake again.
+ */
+class ClientPool final {
+public:
+    using Client = std::unique_ptr<httplib::ClientImpl>;
+
+    /// Takes an idle client for the given key, returns nullptr if there is none.
+    Client Acquire(const std::string& key);
+
+    /// Keeps a client whose connection may be reused by later requests with the same key.
+    void Release(const std::string& key, Client client);
+
+private:
+    static constexpr std::size_t MaxIdleClientsPerKey = 4;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<Client>> idle_clients;
+};
+
 /// Represents an HTTP context.
 class Context final {
 public:
@@ -290,16 +313,34 @@ public:
     std::atomic<u64> total_download_size_bytes;
     std::size_t current_copied_data;
     bool uses_default_client_cert{};
+    bool keep_alive = true;
+    ClientPool* client_pool = nullptr;
     httplib::Response response;
     Common::Event finish_post_data;
 
+    /// The response body is appended to as it arrives, the headers in response are valid once
+    /// response_headers_received is set.
+    std::mutex response_mutex;
+    std::condition_variable response_cv;
+    std::vector<u8> response_body;
+    bool response_headers_received = false;
+    bool response_finished = false;
+
+    /**
+     * Waits until the response headers and the given amount of body data were received, or until
+     * the request finished.
+     * @param body_size the amount of body data to wait for
+     * @param timeout_nanos the maximum time to wait, no limit if empty
+     * @returns false if the wait timed out
+     */
+    bool WaitForResponse(std::size_t body_size, std::optional<u64> timeout_nanos);
+
     void ParseAsciiPostData();
     std::string ParseMultipartFormData();
     void MakeRequest();
-    void MakeRequestNonSSL(httplib::Request& request, const URLInfo& url_info,
-                           std::vector<Context::RequestHeader>& pending_headers);
-    void MakeRequestSSL(httplib::Request& request, const URLInfo& url_info,
-                        std::vector<Context::RequestHeader>& pending_headers);
+    std::string ClientPoolKey(const URLInfo& url_info) const;
+    ClientPool::Client CreateClient(const URLInfo& url_info) const;
+    void FinishResponse();
     bool ContentProvider(size_t offset, size_t length, httplib::DataSink& sink);
     bool ChunkedContentProvider(size_t offset, httplib::DataSink& sink);
     std::size_t HandleHeaderWrite(std::vector<Context::RequestHeader>& pending_headers,
@@ -883,6 +924,10 @@ private:
     /// The next handle number to use when a new ClientCert context is created.
     ClientCertContext::Handle client_certs_counter = 0;
 
+    /// Connections kept open for the requests of all contexts. Declared before the contexts, whose
+    /// pending requests return their connections to it when the service is destroyed.
+    ClientPool client_pool;
+
     /// Global list of HTTP contexts currently opened.
     std::unordered_map<Context::Handle, Context> contexts;
 
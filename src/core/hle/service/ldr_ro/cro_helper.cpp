@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
@@ -63,6 +64,27 @@ VAddr CROHelper::SegmentTagToAddress(SegmentTag segment_tag) const {
     return entry.offset + segment_tag.offset_into_segment;
 }
 
+CROHelper::SegmentTable CROHelper::ReadSegmentTable() const {
+    SegmentTable segments(GetField(SegmentNum));
+    if (!segments.empty()) {
+        system.Memory().ReadBlock(process, GetField(SegmentTableOffset), segments.data(),
+                                  segments.size() * sizeof(SegmentEntry));
+    }
+    return segments;
+}
+
+VAddr CROHelper::SegmentTagToAddress(const SegmentTable& segments, SegmentTag segment_tag) {
+    if (segment_tag.segment_index >= segments.size())
+        return 0;
+
+    const SegmentEntry& entry = segments[segment_tag.segment_index];
+
+    if (segment_tag.offset_into_segment >= entry.size)
+        return 0;
+
+    return entry.offset + segment_tag.offset_into_segment;
+}
+
 Result CROHelper::ApplyRelocation(VAddr target_address, RelocationType relocation_type, u32 addend,
                                   u32 symbol_address, u32 target_future_address) {
 
@@ -72,11 +94,9 @@ Result CROHelper::ApplyRelocation(VAddr target_address, RelocationType relocatio
     case RelocationType::AbsoluteAddress:
     case RelocationType::AbsoluteAddress2:
         system.Memory().Write32(target_address, symbol_address + addend);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
         break;
     case RelocationType::RelativeAddress:
         system.Memory().Write32(target_address, symbol_address + addend - target_future_address);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -99,7 +119,6 @@ Result CROHelper::ClearRelocation(VAddr target_address, RelocationType relocatio
     case RelocationType::AbsoluteAddress2:
     case RelocationType::RelativeAddress:
         system.Memory().Write32(target_address, 0);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -118,28 +137,43 @@ Result CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool res
     if (symbol_address == 0 && !reset)
         return CROFormatError(0x10);
 
-    VAddr relocation_address = batch;
-    while (true) {
-        RelocationEntry relocation;
-        system.Memory().ReadBlock(process, relocation_address, &relocation,
-                                  sizeof(RelocationEntry));
+    // Relocations are read in chunks that don't go past the end of the relocation table, and their
+    // targets are resolved against a single read of the segment table.
+    constexpr u32 CHUNK_SIZE = 32;
+    std::array<RelocationEntry, CHUNK_SIZE> chunk;
+    const SegmentTable segments = ReadSegmentTable();
+    const VAddr table_end = GetField(ExternalRelocationTableOffset) +
+                            GetField(ExternalRelocationNum) * sizeof(ExternalRelocationEntry);
 
-        VAddr relocation_target = SegmentTagToAddress(relocation.target_position);
-        if (relocation_target == 0) {
-            return CROFormatError(0x12);
+    VAddr relocation_address = batch;
+    bool batch_end = false;
+    while (!batch_end) {
+        u32 chunk_num = 1;
+        if (relocation_address < table_end) {
+            chunk_num = std::clamp<u32>((table_end - relocation_address) / sizeof(RelocationEntry),
+                                        1, CHUNK_SIZE);
         }
+        system.Memory().ReadBlock(process, relocation_address, chunk.data(),
+                                  chunk_num * sizeof(RelocationEntry));
+
+        for (u32 i = 0; i < chunk_num && !batch_end; ++i) {
+            const RelocationEntry& relocation = chunk[i];
+            VAddr relocation_target = SegmentTagToAddress(segments, relocation.target_position);
+            if (relocation_target == 0) {
+                return CROFormatError(0x12);
+            }
 
-        Result result = ApplyRelocation(relocation_target, relocation.type, relocation.addend,
-                                        symbol_address, relocation_target);
-        if (result.IsError()) {
-            LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
-            return result;
-        }
+            Result result = ApplyRelocation(relocation_target, relocation.type, relocation.addend,
+                                            symbol_address, relocation_target);
+            if (result.IsError()) {
+                LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
+                return result;
+            }
 
-        if (relocation.is_batch_end)
-            break;
+            batch_end = relocation.is_batch_end;
+        }
 
-        relocation_address += sizeof(RelocationEntry);
+        relocation_address += chunk_num * sizeof(RelocationEntry);
     }
 
     RelocationEntry relocation;
@@ -195,6 +229,34 @@ VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
     return SegmentTagToAddress(symbol_entry.symbol_position);
 }
 
+CROHelper::ExportSymbolIndex CROHelper::BuildExportSymbolIndex() const {
+    ExportSymbolIndex exports;
+    // Without an export tree FindExportNamedSymbol finds nothing either
+    if (!GetField(ExportTreeNum))
+        return exports;
+
+    std::vector<ExportNamedSymbolEntry> entries(GetField(ExportNamedSymbolNum));
+    if (entries.empty())
+        return exports;
+
+    system.Memory().ReadBlock(process, GetField(ExportNamedSymbolTableOffset), entries.data(),
+                              entries.size() * sizeof(ExportNamedSymbolEntry));
+
+    const SegmentTable segments = ReadSegmentTable();
+    u32 export_strings_size = GetField(ExportStringsSize);
+    exports.reserve(entries.size());
+    for (const ExportNamedSymbolEntry& entry : entries) {
+        exports.emplace(system.Memory().ReadCString(entry.name_offset, export_strings_size),
+                        SegmentTagToAddress(segments, entry.symbol_position));
+    }
+    return exports;
+}
+
+VAddr CROHelper::FindExportNamedSymbol(const ExportSymbolIndex& exports, const std::string& name) {
+    const auto it = exports.find(name);
+    return it != exports.end() ? it->second : 0;
+}
+
 Result CROHelper::RebaseHeader(u32 cro_size) {
     Result error = CROFormatError(0x11);
 
@@ -748,6 +810,11 @@ void CROHelper::UnrebaseHeader() {
 }
 
 Result CROHelper::ApplyImportNamedSymbol(VAddr crs_address) {
+    // The auto-link modules are indexed on the first unresolved import, and searched in the same
+    // order as ForEachAutoLinkCRO for each import.
+    std::vector<std::pair<std::string, ExportSymbolIndex>> sources;
+    bool sources_indexed = false;
+
     u32 import_strings_size = GetField(ImportStringsSize);
     u32 symbol_import_num = GetField(ImportNamedSymbolNum);
     for (u32 i = 0; i < symbol_import_num; ++i) {
@@ -759,30 +826,34 @@ Result CROHelper::ApplyImportNamedSymbol(VAddr crs_address) {
                                   sizeof(ExternalRelocationEntry));
 
         if (!relocation_entry.is_batch_resolved) {
-            Result result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
-                    std::string symbol_name =
-                        system.Memory().ReadCString(entry.name_offset, import_strings_size);
-                    u32 symbol_address = source.FindExportNamedSymbol(symbol_name);
-
-                    if (symbol_address != 0) {
-                        LOG_TRACE(Service_LDR, "CRO \"{}\" imports \"{}\" from \"{}\"",
-                                  ModuleName(), symbol_name, source.ModuleName());
+            if (!sources_indexed) {
+                Result result = ForEachAutoLinkCRO(
+                    process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+                        sources.emplace_back(source.ModuleName(), source.BuildExportSymbolIndex());
+                        return true;
+                    });
+                if (result.IsError()) {
+                    return result;
+                }
+                sources_indexed = true;
+            }
 
-                        Result result = ApplyRelocationBatch(relocation_addr, symbol_address);
-                        if (result.IsError()) {
-                            LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}",
-                                      result.raw);
-                            return result;
-                        }
+            std::string symbol_name =
+                system.Memory().ReadCString(entry.name_offset, import_strings_size);
+            for (const auto& [source_name, exports] : sources) {
+                u32 symbol_address = FindExportNamedSymbol(exports, symbol_name);
+                if (symbol_address == 0)
+                    continue;
 
-                        return false;
-                    }
+                LOG_TRACE(Service_LDR, "CRO \"{}\" imports \"{}\" from \"{}\"", ModuleName(),
+                          symbol_name, source_name);
 
-                    return true;
-                });
-            if (result.IsError()) {
-                return result;
+                Result result = ApplyRelocationBatch(relocation_addr, symbol_address);
+                if (result.IsError()) {
+                    LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}", result.raw);
+                    return result;
+                }
+                break;
             }
         }
     }
@@ -908,7 +979,7 @@ Result CROHelper::ApplyModuleImport(VAddr crs_address) {
     return ResultSuccess;
 }
 
-Result CROHelper::ApplyExportNamedSymbol(CROHelper target) {
+Result CROHelper::ApplyExportNamedSymbol(CROHelper target, const ExportSymbolIndex& exports) {
     LOG_DEBUG(Service_LDR, "CRO \"{}\" exports named symbols to \"{}\"", ModuleName(),
               target.ModuleName());
     u32 target_import_strings_size = target.GetField(ImportStringsSize);
@@ -924,7 +995,7 @@ Result CROHelper::ApplyExportNamedSymbol(CROHelper target) {
         if (!relocation_entry.is_batch_resolved) {
             std::string symbol_name =
                 system.Memory().ReadCString(entry.name_offset, target_import_strings_size);
-            u32 symbol_address = FindExportNamedSymbol(symbol_name);
+            u32 symbol_address = FindExportNamedSymbol(exports, symbol_name);
             if (symbol_address != 0) {
                 LOG_TRACE(Service_LDR, "    exports symbol \"{}\"", symbol_name);
                 Result result = target.ApplyRelocationBatch(relocation_addr, symbol_address);
@@ -938,7 +1009,7 @@ Result CROHelper::ApplyExportNamedSymbol(CROHelper target) {
     return ResultSuccess;
 }
 
-Result CROHelper::ResetExportNamedSymbol(CROHelper target) {
+Result CROHelper::ResetExportNamedSymbol(CROHelper target, const ExportSymbolIndex& exports) {
     LOG_DEBUG(Service_LDR, "CRO \"{}\" unexports named symbols to \"{}\"", ModuleName(),
               target.ModuleName());
     u32 unresolved_symbol = target.GetOnUnresolvedAddress();
@@ -955,7 +1026,7 @@ Result CROHelper::ResetExportNamedSymbol(CROHelper target) {
         if (relocation_entry.is_batch_resolved) {
             std::string symbol_name =
                 system.Memory().ReadCString(entry.name_offset, target_import_strings_size);
-            u32 symbol_address = FindExportNamedSymbol(symbol_name);
+            u32 symbol_address = FindExportNamedSymbol(exports, symbol_name);
             if (symbol_address != 0) {
                 LOG_TRACE(Service_LDR, "    unexports symbol \"{}\"", symbol_name);
                 Result result =
@@ -1305,9 +1376,10 @@ Result CROHelper::Link(VAddr crs_address, bool link_on_load_bug_fix) {
     }
 
     // Exports symbols to other modules
+    const ExportSymbolIndex exports = BuildExportSymbolIndex();
     result = ForEachAutoLinkCRO(process, system, crs_address,
-                                [this](CROHelper target) -> ResultVal<bool> {
-                                    Result result = ApplyExportNamedSymbol(target);
+                                [this, &exports](CROHelper target) -> ResultVal<bool> {
+                                    Result result = ApplyExportNamedSymbol(target, exports);
                                     if (result.IsError())
                                         return result;
 
@@ -1350,9 +1422,10 @@ Result CROHelper::Unlink(VAddr crs_address) {
 
     // Resets all symbols in other modules imported from this module
     // Note: the RO service seems only searching in auto-link modules
+    const ExportSymbolIndex exports = BuildExportSymbolIndex();
     result = ForEachAutoLinkCRO(process, system, crs_address,
-                                [this](CROHelper target) -> ResultVal<bool> {
-                                    Result result = ResetExportNamedSymbol(target);
+                                [this, &exports](CROHelper target) -> ResultVal<bool> {
+                                    Result result = ResetExportNamedSymbol(target, exports);
                                     if (result.IsError())
                                         return result;
 
@@ -1531,4 +1604,22 @@ std::tuple<VAddr, u32> CROHelper::GetExecutablePages() const {
     return std::make_tuple(0, 0);
 }
 
+void CROHelper::InvalidateLinkedSegments(VAddr crs_address) const {
+    const auto invalidate_segments = [this](const CROHelper& cro) {
+        for (const SegmentEntry& segment : cro.ReadSegmentTable()) {
+            if (segment.offset != 0 && segment.size != 0) {
+                system.InvalidateCacheRange(segment.offset, segment.size);
+            }
+        }
+    };
+
+    invalidate_segments(*this);
+    ForEachAutoLinkCRO(process, system, crs_address, [&](CROHelper cro) -> ResultVal<bool> {
+        if (cro.module_address != module_address) {
+            invalidate_segments(cro);
+        }
+        return true;
+    });
+}
+
 } // namespace Service::LDR
@@ -5,7 +5,10 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/result.h"
@@ -138,6 +141,14 @@ public:
      */
     std::tuple<VAddr, u32> GetExecutablePages() const;
 
+    /**
+     * Invalidates the JIT cache over the segments of this module and of all registered auto-link
+     * modules. Relocations don't invalidate the words they patch, so this is called once after a
+     * pass of relocations across the modules.
+     * @param crs_address the virtual address of the static module
+     */
+    void InvalidateLinkedSegments(VAddr crs_address) const;
+
 private:
     const VAddr module_address; ///< the virtual address of this module
     Kernel::Process& process;   ///< the owner process of this module
@@ -441,6 +452,22 @@ private:
      */
     VAddr SegmentTagToAddress(SegmentTag segment_tag) const;
 
+    using SegmentTable = std::vector<SegmentEntry>;
+
+    /// Reads the whole segment table, to resolve many segment tags without further guest reads.
+    SegmentTable ReadSegmentTable() const;
+
+    /**
+     * Converts a segment tag to virtual address using a segment table read beforehand.
+     * @param segments the segment table of this module
+     * @param segment_tag the segment tag to convert
+     * @returns VAddr the virtual address the segment tag points to; 0 if invalid.
+     */
+    static VAddr SegmentTagToAddress(const SegmentTable& segments, SegmentTag segment_tag);
+
+    /// Maps the names of the named symbols exported by a module to their virtual addresses.
+    using ExportSymbolIndex = std::unordered_map<std::string, VAddr>;
+
     VAddr NextModule() const {
         return GetField(NextCRO);
     }
@@ -492,6 +519,7 @@ private:
      * @param target_future_address the future address of the target.
      *        Usually equals to target_address, but will be different for a target in .data segment
      * @returns Result ResultSuccess on success, otherwise error code.
+     * @note the JIT cache isn't invalidated here, see InvalidateLinkedSegments.
      */
     Result ApplyRelocation(VAddr target_address, RelocationType relocation_type, u32 addend,
                            u32 symbol_address, u32 target_future_address);
@@ -501,6 +529,7 @@ private:
      * @param target_address where to apply the relocation
      * @param relocation_type the type of the relocation
      * @returns Result ResultSuccess on success, otherwise error code.
+     * @note the JIT cache isn't invalidated here, see InvalidateLinkedSegments.
      */
     Result ClearRelocation(VAddr target_address, RelocationType relocation_type);
 
@@ -521,6 +550,21 @@ private:
      */
     VAddr FindExportNamedSymbol(const std::string& name) const;
 
+    /**
+     * Builds the index of the named symbols exported by this module, so that resolving many
+     * imports against it doesn't walk the export tree once per import.
+     * @returns ExportSymbolIndex the exported named symbols by name.
+     */
+    ExportSymbolIndex BuildExportSymbolIndex() const;
+
+    /**
+     * Finds an exported named symbol in the index of a module.
+     * @param exports the index built by BuildExportSymbolIndex
+     * @param name the name of the symbol to find
+     * @return VAddr the virtual address of the symbol; 0 if not found.
+     */
+    static VAddr FindExportNamedSymbol(const ExportSymbolIndex& exports, const std::string& name);
+
     /**
      * Rebases offsets in module header according to module address.
      * @param cro_size the size of the CRO file
@@ -681,16 +725,18 @@ private:
     /**
      * Resolves target module's imported named symbols that exported by this module.
      * @param target the module to resolve.
+     * @param exports the index of the named symbols exported by this module
      * @returns Result ResultSuccess on success, otherwise error code.
      */
-    Result ApplyExportNamedSymbol(CROHelper target);
+    Result ApplyExportNamedSymbol(CROHelper target, const ExportSymbolIndex& exports);
 
     /**
      * Resets target's named symbols imported from this module to unresolved state.
      * @param target the module to reset.
+     * @param exports the index of the named symbols exported by this module
      * @returns Result ResultSuccess on success, otherwise error code.
      */
-    Result ResetExportNamedSymbol(CROHelper target);
+    Result ResetExportNamedSymbol(CROHelper target, const ExportSymbolIndex& exports);
 
     /**
      * Resolves imported indexed and anonymous symbols in the target module which imports this
@@ -61,6 +61,9 @@ static bool VerifyBufferState(Kernel::Process& process, VAddr buffer_ptr, u32 si
 
 void RO::Initialize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
+    // Relocations patch code in every linked module. The patched ranges are merged and
+    // invalidated once when the request is done.
+    Core::CacheInvalidationBatch invalidation_batch{system};
     VAddr crs_buffer_ptr = rp.Pop<u32>();
     u32 crs_size = rp.Pop<u32>();
     VAddr crs_address = rp.Pop<u32>();
@@ -131,6 +134,7 @@ void RO::Initialize(Kernel::HLERequestContext& ctx) {
     crs.InitCRS();
 
     result = crs.Rebase(0, crs_size, 0, 0, 0, 0, true);
+    crs.InvalidateLinkedSegments(crs_address);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error rebasing CRS 0x{:08X}", result.raw);
         rb.Push(result);
@@ -168,6 +172,7 @@ void RO::UnloadCRR(Kernel::HLERequestContext& ctx) {
 
 void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
     IPC::RequestParser rp(ctx);
+    Core::CacheInvalidationBatch invalidation_batch{system};
     VAddr cro_buffer_ptr = rp.Pop<u32>();
     VAddr cro_address = rp.Pop<u32>();
     u32 cro_size = rp.Pop<u32>();
@@ -277,6 +282,7 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
                         bss_segment_address, bss_segment_size, false);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error rebasing CRO {:08X}", result.raw);
+        cro.InvalidateLinkedSegments(slot->loaded_crs);
         process->Unmap(cro_address, cro_buffer_ptr, cro_size, Kernel::VMAPermission::ReadWrite,
                        true);
         rb.Push(result);
@@ -285,6 +291,7 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
     }
 
     result = cro.Link(slot->loaded_crs, link_on_load_bug_fix);
+    cro.InvalidateLinkedSegments(slot->loaded_crs);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error linking CRO {:08X}", result.raw);
         process->Unmap(cro_address, cro_buffer_ptr, cro_size, Kernel::VMAPermission::ReadWrite,
@@ -335,6 +342,7 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
 
 void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
+    Core::CacheInvalidationBatch invalidation_batch{system};
     VAddr cro_address = rp.Pop<u32>();
     u32 zero = rp.Pop<u32>();
     VAddr cro_buffer_ptr = rp.Pop<u32>();
@@ -375,6 +383,7 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
     Result result = cro.Unlink(slot->loaded_crs);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error unlinking CRO {:08X}", result.raw);
+        cro.InvalidateLinkedSegments(slot->loaded_crs);
         rb.Push(result);
         return;
     }
@@ -385,11 +394,13 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
         result = cro.ClearRelocations();
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error clearing relocations {:08X}", result.raw);
+            cro.InvalidateLinkedSegments(slot->loaded_crs);
             rb.Push(result);
             return;
         }
     }
 
+    cro.InvalidateLinkedSegments(slot->loaded_crs);
     cro.Unrebase(false);
 
     result = process->Unmap(cro_address, cro_buffer_ptr, fixed_size,
@@ -405,6 +416,7 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
 
 void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
+    Core::CacheInvalidationBatch invalidation_batch{system};
     VAddr cro_address = rp.Pop<u32>();
     auto process = rp.PopObject<Kernel::Process>();
 
@@ -436,6 +448,7 @@ void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
     LOG_INFO(Service_LDR, "Linking CRO \"{}\"", cro.ModuleName());
 
     Result result = cro.Link(slot->loaded_crs, false);
+    cro.InvalidateLinkedSegments(slot->loaded_crs);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error linking CRO {:08X}", result.raw);
     }
@@ -445,6 +458,7 @@ void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
 
 void RO::UnlinkCRO(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
+    Core::CacheInvalidationBatch invalidation_batch{system};
     VAddr cro_address = rp.Pop<u32>();
     auto process = rp.PopObject<Kernel::Process>();
 
@@ -476,6 +490,7 @@ void RO::UnlinkCRO(Kernel::HLERequestContext& ctx) {
     LOG_INFO(Service_LDR, "Unlinking CRO \"{}\"", cro.ModuleName());
 
     Result result = cro.Unlink(slot->loaded_crs);
+    cro.InvalidateLinkedSegments(slot->loaded_crs);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error unlinking CRO {:08X}", result.raw);
     }
@@ -0,0 +1,139 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/dynamic_library/ffmpeg.h"
+#include "common/logging/log.h"
+#include "core/hle/service/mvd/mvd_decoder.h"
+
+using namespace DynamicLibrary;
+
+namespace Service::MVD {
+
+namespace {
+
+class FFmpegDecoder final : public Decoder {
+public:
+    FFmpegDecoder() {
+        codec = FFmpeg::avcodec_find_decoder(AV_CODEC_ID_H264);
+        if (!codec) {
+            LOG_ERROR(Service_MVD, "FFmpeg has no H.264 decoder");
+            return;
+        }
+        packet.reset(FFmpeg::av_packet_alloc());
+        frame.reset(FFmpeg::av_frame_alloc());
+        Reset();
+    }
+
+    bool IsValid() const {
+        return codec_context != nullptr;
+    }
+
+    std::optional<DecodedFrame> DecodeNALUnit(std::span<const u8> nal_unit) override {
+        // The guest usually sends the start code along with the NAL unit, but it is optional.
+        static constexpr std::array<u8, 4> start_code{0x00, 0x00, 0x00, 0x01};
+        const bool has_start_code =
+            nal_unit.size() >= 3 && nal_unit[0] == 0 && nal_unit[1] == 0 &&
+            (nal_unit[2] == 1 || (nal_unit.size() >= 4 && nal_unit[2] == 0 && nal_unit[3] == 1));
+        input.clear();
+        if (!has_start_code) {
+            input.insert(input.end(), start_code.begin(), start_code.end());
+        }
+        input.insert(input.end(), nal_unit.begin(), nal_unit.end());
+        input.resize(input.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+
+        packet->data = input.data();
+        packet->size = static_cast<int>(input.size() - AV_INPUT_BUFFER_PADDING_SIZE);
+        int ret = FFmpeg::avcodec_send_packet(codec_context.get(), packet.get());
+        if (ret < 0) {
+            LOG_WARNING(Service_MVD, "Could not send NAL unit to the decoder: {}", ret);
+            return std::nullopt;
+        }
+
+        std::optional<DecodedFrame> result;
+        while ((ret = FFmpeg::avcodec_receive_frame(codec_context.get(), frame.get())) >= 0) {
+            result = CopyFrame();
+            FFmpeg::av_frame_unref(frame.get());
+        }
+        return result;
+    }
+
+    void Reset() override {
+        codec_context.reset(FFmpeg::avcodec_alloc_context3(codec));
+        if (!codec_context) {
+            return;
+        }
+        // Pictures have to be returned as soon as they are complete, like the hardware does.
+        codec_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        codec_context->thread_type = FF_THREAD_SLICE;
+        if (FFmpeg::avcodec_open2(codec_context.get(), codec, nullptr) < 0) {
+            LOG_ERROR(Service_MVD, "Could not open the H.264 decoder");
+            codec_context.reset();
+        }
+    }
+
+private:
+    std::optional<DecodedFrame> CopyFrame() const {
+        if (frame->format != AV_PIX_FMT_YUV420P && frame->format != AV_PIX_FMT_YUVJ420P) {
+            LOG_ERROR(Service_MVD, "Unsupported decoded pixel format {}", frame->format);
+            return std::nullopt;
+        }
+
+        DecodedFrame result;
+        result.width = static_cast<u32>(frame->width);
+        result.height = static_cast<u32>(frame->height);
+        const auto copy_plane = [this](std::vector<u8>& out, int plane, u32 width, u32 height) {
+            out.resize(width * height);
+            for (u32 row = 0; row < height; ++row) {
+                std::memcpy(out.data() + row * width,
+                            frame->data[plane] + row * frame->linesize[plane], width);
+            }
+        };
+        copy_plane(result.y, 0, result.width, result.height);
+        copy_plane(result.u, 1, (result.width + 1) / 2, (result.height + 1) / 2);
+        copy_plane(result.v, 2, (result.width + 1) / 2, (result.height + 1) / 2);
+        return result;
+    }
+
+    struct AVCodecContextDeleter {
+        void operator()(AVCodecContext* codec_context) const {
+            FFmpeg::avcodec_free_context(&codec_context);
+        }
+    };
+
+    struct AVFrameDeleter {
+        void operator()(AVFrame* frame) const {
+            FFmpeg::av_frame_free(&frame);
+        }
+    };
+
+    struct AVPacketDeleter {
+        void operator()(AVPacket* packet) const {
+            FFmpeg::av_packet_free(&packet);
+        }
+    };
+
+    const AVCodec* codec{};
+    std::unique_ptr<AVCodecContext, AVCodecContextDeleter> codec_context{};
+    std::unique_ptr<AVFrame, AVFrameDeleter> frame{};
+    std::unique_ptr<AVPacket, AVPacketDeleter> packet{};
+    std::vector<u8> input;
+};
+
+} // Anonymous namespace
+
+std::unique_ptr<Decoder> CreateDecoder() {
+    if (!FFmpeg::LoadFFmpeg()) {
+        LOG_ERROR(Service_MVD, "FFmpeg is not available, H.264 video will not be decoded");
+        return nullptr;
+    }
+    auto decoder = std::make_unique<FFmpegDecoder>();
+    if (!decoder->IsValid()) {
+        return nullptr;
+    }
+    return decoder;
+}
+
+} // namespace Service::MVD
@@ -0,0 +1,42 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Service::MVD {
+
+/// A decoded picture in planar YUV 4:2:0, with tightly packed planes.
+struct DecodedFrame {
+    u32 width{};
+    u32 height{};
+    std::vector<u8> y;
+    std::vector<u8> u;
+    std::vector<u8> v;
+};
+
+/// Host H.264 decoder used to emulate the MVD hardware decoder.
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    /**
+     * Decodes a single NAL unit in Annex B format.
+     * @returns The newest picture completed by this NAL unit, if any.
+     */
+    virtual std::optional<DecodedFrame> DecodeNALUnit(std::span<const u8> nal_unit) = 0;
+
+    /// Drops all decoder state, to be called when the guest restarts processing.
+    virtual void Reset() = 0;
+};
+
+/// Creates the best decoder available on the host, or nullptr if there is none.
+std::unique_ptr<Decoder> CreateDecoder();
+
+} // namespace Service::MVD
@@ -2,27 +2,236 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <boost/serialization/binary_object.hpp>
 #include "common/archives.h"
+#include "common/task_scheduler.h"
+#include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/service/mvd/mvd_std.h"
+#include "core/memory.h"
 
+SERVICE_CONSTRUCT_IMPL(Service::MVD::MVD_STD)
 SERIALIZE_EXPORT_IMPL(Service::MVD::MVD_STD)
 
 namespace Service::MVD {
 
-MVD_STD::MVD_STD() : ServiceFramework("mvd:std", 1) {
+template <class Archive>
+void MVD_STD::serialize(Archive& ar, const unsigned int) {
+    ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
+    ar& boost::serialization::make_binary_object(&config, sizeof(config));
+}
+
+// Status codes returned by the MVD processing functions, as defined by libctru.
+constexpr Result ResultStatusOk{0x17000};
+constexpr Result ResultStatusParamSet{0x17001};
+
+// H.264 NAL unit types carrying parameter sets.
+constexpr u8 NalUnitTypeSPS = 7;
+constexpr u8 NalUnitTypePPS = 8;
+
+/// Returns the type of an Annex B NAL unit, skipping its start code.
+static u8 GetNalUnitType(std::span<const u8> nal_unit) {
+    std::size_t offset = 0;
+    while (offset < nal_unit.size() && nal_unit[offset] == 0) {
+        ++offset;
+    }
+    if (offset < nal_unit.size() && nal_unit[offset] == 1) {
+        ++offset;
+    }
+    return offset < nal_unit.size() ? nal_unit[offset] & 0x1F : 0;
+}
+
+static void WriteRGB565(u8* output, u8 r, u8 g, u8 b) {
+    const u16 color = static_cast<u16>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    output[0] = static_cast<u8>(color);
+    output[1] = static_cast<u8>(color >> 8);
+}
+
+void MVD_STD::Initialize(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx);
+    const u32 work_buffer_address = rp.Pop<u32>();
+    const u32 work_buffer_size = rp.Pop<u32>();
+    rp.PopObject<Kernel::Process>();
+
+    FinishPendingDecode();
+    pending_frame.reset();
+    if (!decoder) {
+        decoder = CreateDecoder();
+    } else {
+        decoder->Reset();
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(ResultSuccess);
+
+    LOG_DEBUG(Service_MVD, "called, work_buffer_address=0x{:08X}, work_buffer_size=0x{:X}",
+              work_buffer_address, work_buffer_size);
+}
+
+void MVD_STD::Shutdown(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx);
+
+    FinishPendingDecode();
+    pending_frame.reset();
+    if (decoder) {
+        decoder->Reset();
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(ResultSuccess);
+
+    LOG_DEBUG(Service_MVD, "called");
+}
+
+void MVD_STD::ProcessNALUnit(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx);
+    const u32 vaddr = rp.Pop<u32>();
+    const u32 paddr = rp.Pop<u32>();
+    const u32 size = rp.Pop<u32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_TRACE(Service_MVD, "called, vaddr=0x{:08X}, paddr=0x{:08X}, size=0x{:X}, flags={}", vaddr,
+              paddr, size, flags);
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+
+    const u8* data = system.Memory().GetPhysicalPointer(paddr);
+    if (!data || !decoder) {
+        rb.Push(ResultStatusOk);
+        return;
+    }
+    std::vector<u8> nal_unit(data, data + size);
+    const u8 nal_unit_type = GetNalUnitType(nal_unit);
+    const bool is_param_set = nal_unit_type == NalUnitTypeSPS || nal_unit_type == NalUnitTypePPS;
+
+    // Decoding runs one NAL unit ahead of the guest: it is only waited for when the next unit
+    // arrives or when the guest asks for the picture to be rendered.
+    FinishPendingDecode();
+    pending_decode = Common::GetTaskScheduler().Enqueue(
+        [decoder = decoder.get(), nal_unit = std::move(nal_unit)] {
+            return decoder->DecodeNALUnit(nal_unit);
+        });
+
+    rb.Push(is_param_set ? ResultStatusParamSet : ResultStatusOk);
+}
+
+void MVD_STD::ControlFrameRendering(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx);
+    const s8 type = static_cast<s8>(rp.Pop<u8>());
+
+    if (type == 0) {
+        FinishPendingDecode();
+        if (pending_frame) {
+            WriteOutputFrame(*pending_frame);
+            pending_frame.reset();
+        }
+    }
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
+    rb.Push(ResultSuccess);
+
+    LOG_TRACE(Service_MVD, "called, type={}", type);
+}
+
+void MVD_STD::SetConfig(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx);
+    const u32 size = rp.Pop<u32>();
+    rp.PopObject<Kernel::Process>();
+    auto& buffer = rp.PopMappedBuffer();
+
+    buffer.Read(&config, 0, std::min<std::size_t>({size, buffer.GetSize(), sizeof(config)}));
+
+    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+    rb.Push(ResultSuccess);
+    rb.PushMappedBuffer(buffer);
+
+    LOG_DEBUG(Service_MVD,
+              "called, input_type=0x{:08X}, output_type=0x{:08X}, output={}x{} at 0x{:08X}",
+              static_cast<u32>(config.input_type),
+              static_cast<u32>(config.output_type), config.output_width,
+              config.output_height, config.output_address0);
+}
+
+void MVD_STD::FinishPendingDecode() {
+    if (!pending_decode.valid()) {
+        return;
+    }
+    if (auto frame = pending_decode.get()) {
+        pending_frame = std::make_unique<DecodedFrame>(std::move(*frame));
+    }
+}
+
+void MVD_STD::WriteOutputFrame(const DecodedFrame& frame) {
+    const u32 bytes_per_pixel = 2;
+    const u32 width = config.output_width;
+    const u32 height = config.output_height;
+    const u32 output_size = width * height * bytes_per_pixel;
+    const PAddr output_address = config.output_address0;
+    if (output_address < Memory::FCRAM_PADDR ||
+        output_address + output_size > Memory::FCRAM_N3DS_PADDR_END) {
+        LOG_ERROR(Service_MVD, "Invalid output buffer 0x{:08X}", output_address);
+        return;
+    }
+
+    // The output is usually displayed or sampled as a texture right after.
+    auto& memory = system.Memory();
+    memory.RasterizerFlushVirtualRegion(
+        Memory::NEW_LINEAR_HEAP_VADDR + (output_address - Memory::FCRAM_PADDR), output_size,
+        Memory::FlushMode::FlushAndInvalidate);
+    u8* output = memory.GetPhysicalPointer(output_address);
+
+    const OutputFormat format = config.output_type;
+    const u32 copy_width = std::min(width, frame.width);
+    const u32 copy_height = std::min(height, frame.height);
+    const u32 chroma_stride = (frame.width + 1) / 2;
+    for (u32 y = 0; y < copy_height; ++y) {
+        u8* line = output + y * width * bytes_per_pixel;
+        const u8* line_y = frame.y.data() + y * frame.width;
+        const u8* line_u = frame.u.data() + (y / 2) * chroma_stride;
+        const u8* line_v = frame.v.data() + (y / 2) * chroma_stride;
+        for (u32 x = 0; x < copy_width; ++x) {
+            const s32 Y = line_y[x];
+            const s32 U = line_u[x / 2];
+            const s32 V = line_v[x / 2];
+            u8* pixel = line + x * bytes_per_pixel;
+
+            if (format == OutputFormat::YUYV422) {
+                pixel[0] = static_cast<u8>(Y);
+                pixel[1] = static_cast<u8>(x % 2 == 0 ? U : V);
+                continue;
+            }
+
+            // BT.601 limited range, as encoded by the 3DS video tools.
+            const s32 c = (Y - 16) * 298;
+            const s32 d = U - 128;
+            const s32 e = V - 128;
+            const u8 r = static_cast<u8>(std::clamp((c + 409 * e + 128) >> 8, 0, 0xFF));
+            const u8 g = static_cast<u8>(std::clamp((c - 100 * d - 208 * e + 128) >> 8, 0, 0xFF));
+            const u8 b = static_cast<u8>(std::clamp((c + 516 * d + 128) >> 8, 0, 0xFF));
+            if (format == OutputFormat::BGR565) {
+                WriteRGB565(pixel, b, g, r);
+            } else {
+                WriteRGB565(pixel, r, g, b);
+            }
+        }
+    }
+}
+
+MVD_STD::MVD_STD(Core::System& system) : ServiceFramework("mvd:std", 1), system(system) {
     static const FunctionInfo functions[] = {
         // clang-format off
-        {0x0001, nullptr, "Initialize"},
-        {0x0002, nullptr, "Shutdown"},
+        {0x0001, &MVD_STD::Initialize, "Initialize"},
+        {0x0002, &MVD_STD::Shutdown, "Shutdown"},
         {0x0003, nullptr, "CalculateWorkBufSize"},
         {0x0004, nullptr, "CalculateImageSize"},
-        {0x0008, nullptr, "ProcessNALUnit"},
-        {0x0009, nullptr, "ControlFrameRendering"},
+        {0x0008, &MVD_STD::ProcessNALUnit, "ProcessNALUnit"},
+        {0x0009, &MVD_STD::ControlFrameRendering, "ControlFrameRendering"},
         {0x000A, nullptr, "GetStatus"},
         {0x000B, nullptr, "GetStatusOther"},
         {0x001D, nullptr, "GetConfig"},
-        {0x001E, nullptr, "SetConfig"},
+        {0x001E, &MVD_STD::SetConfig, "SetConfig"},
         {0x001F, nullptr, "SetOutputBuffer"},
         {0x0021, nullptr, "OverrideOutputBuffers"} // clang-format on
     };
@@ -30,4 +239,10 @@ MVD_STD::MVD_STD() : ServiceFramework("mvd:std", 1) {
     RegisterHandlers(functions);
 };
 
+MVD_STD::~MVD_STD() {
+    if (pending_decode.valid()) {
+        pending_decode.wait();
+    }
+}
+
 } // namespace Service::MVD
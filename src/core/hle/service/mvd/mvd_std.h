@@ -4,19 +4,135 @@
 
 #pragma once
 
+#include <future>
+#include <memory>
+#include <optional>
+#include "common/common_funcs.h"
+#include "common/swap.h"
+#include "core/hle/service/mvd/mvd_decoder.h"
 #include "core/hle/service/service.h"
 
+namespace Core {
+class System;
+}
+
 namespace Service::MVD {
 
+enum class InputFormat : u32 {
+    YUYV422 = 0x00010001,
+    H264 = 0x00020001,
+};
+
+enum class OutputFormat : u32 {
+    YUYV422 = 0x00010001,
+    BGR565 = 0x00040002,
+    RGB565 = 0x00040004,
+};
+
+/// Leading part of the MVD configuration, holding all the fields the emulation looks at.
+struct MVDConfig {
+    enum_le<InputFormat> input_type;
+    INSERT_PADDING_WORDS(2);
+    u32_le input_width;
+    u32_le input_height;
+    INSERT_PADDING_WORDS(11);
+    u32_le enable_cropping;
+    u16_le input_crop_x_pos;
+    u16_le input_crop_y_pos;
+    u16_le input_crop_height;
+    u16_le input_crop_width;
+    INSERT_PADDING_WORDS(1);
+    enum_le<OutputFormat> output_type;
+    u32_le output_width;
+    u32_le output_height;
+    u32_le output_address0;
+    u32_le output_address1;
+};
+static_assert(offsetof(MVDConfig, enable_cropping) == 0x40);
+static_assert(offsetof(MVDConfig, output_type) == 0x50);
+static_assert(sizeof(MVDConfig) == 0x64);
+
 class MVD_STD final : public ServiceFramework<MVD_STD> {
 public:
-    MVD_STD();
-    ~MVD_STD() = default;
+    explicit MVD_STD(Core::System& system);
+    ~MVD_STD() override;
 
 private:
-    SERVICE_SERIALIZATION_SIMPLE
+    /**
+     * MVD_STD::Initialize service function
+     *  Inputs:
+     *      1 : Work buffer address
+     *      2 : Work buffer size
+     *      3 : Copy handle descriptor
+     *      4 : Process handle
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void Initialize(Kernel::HLERequestContext& ctx);
+
+    /**
+     * MVD_STD::Shutdown service function
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void Shutdown(Kernel::HLERequestContext& ctx);
+
+    /**
+     * MVD_STD::ProcessNALUnit service function
+     *  Inputs:
+     *      1 : NAL unit virtual address
+     *      2 : NAL unit physical address
+     *      3 : NAL unit size
+     *      4 : Flags
+     *  Outputs:
+     *      1 : MVD status code, reporting whether a frame was output
+     */
+    void ProcessNALUnit(Kernel::HLERequestContext& ctx);
+
+    /**
+     * MVD_STD::ControlFrameRendering service function
+     *  Inputs:
+     *      1 : Rendering control type
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void ControlFrameRendering(Kernel::HLERequestContext& ctx);
+
+    /**
+     * MVD_STD::SetConfig service function
+     *  Inputs:
+     *      1 : Config size
+     *      2 : Copy handle descriptor
+     *      3 : Process handle
+     *      4 : Buffer descriptor
+     *      5 : Config address
+     *  Outputs:
+     *      1 : Result of function, 0 on success, otherwise error code
+     */
+    void SetConfig(Kernel::HLERequestContext& ctx);
+
+    /// Waits for the NAL unit currently being decoded and keeps its picture, if it produced one.
+    void FinishPendingDecode();
+
+    /// Converts a decoded frame to the configured output format and writes it to guest memory.
+    void WriteOutputFrame(const DecodedFrame& frame);
+
+    Core::System& system;
+
+    MVDConfig config{};
+    std::unique_ptr<Decoder> decoder;
+
+    /// Decode of the last NAL unit, running on the task scheduler while the guest continues.
+    std::future<std::optional<DecodedFrame>> pending_decode;
+    /// Newest decoded picture that has not been rendered to the output buffer yet.
+    std::unique_ptr<DecodedFrame> pending_frame;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int);
+    friend class boost::serialization::access;
 };
 
 } // namespace Service::MVD
 
+SERVICE_CONSTRUCT(Service::MVD::MVD_STD)
 BOOST_CLASS_EXPORT_KEY(Service::MVD::MVD_STD)
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <limits>
 #include <boost/serialization/list.hpp>
 #include <boost/serialization/map.hpp>
 #include <cryptopp/osrng.h>
@@ -58,6 +59,10 @@ constexpr u16 BroadcastNetworkNodeId = 0xFFFF;
 // The Host has always dest_node_id 1
 constexpr u16 HostDestNodeId = 1;
 
+// Number of beacon intervals after which an unchanged beacon frame is sent again. Two intervals
+// (204.8ms) stay below the 300ms that RecvBeaconBroadcastData waits for beacons.
+constexpr u32 BeaconResendInterval = 2;
+
 std::list<Network::WifiPacket> NWM_UDS::GetReceivedBeacons(const MacAddress& sender) {
     std::scoped_lock lock(beacon_mutex);
     if (sender != Network::BroadcastMac) {
@@ -350,7 +355,7 @@ void NWM_UDS::HandleEAPoLPacket(const Network::WifiPacket& packet) {
 
 void NWM_UDS::HandleSecureDataPacket(const Network::WifiPacket& packet) {
     const auto secure_data = ParseSecureDataHeader(packet.data);
-    std::scoped_lock lock{connection_status_mutex, system.Kernel().GetHLELock()};
+    std::scoped_lock lock{connection_status_mutex};
 
     if (connection_status.status != NetworkStatus::ConnectedAsHost &&
         connection_status.status != NetworkStatus::ConnectedAsClient &&
@@ -407,8 +412,25 @@ void NWM_UDS::HandleSecureDataPacket(const Network::WifiPacket& packet) {
     // Add the received packet to the data queue.
     channel_info->second.received_packets.emplace_back(packet.data);
 
-    // Signal the data event. We can do this directly because we locked hle_lock
-    channel_info->second.event->Signal();
+    // Frames tend to arrive in bursts, signal the data event once for all the frames received
+    // before the emulation thread gets to it.
+    pending_data_channels.insert(secure_data.data_channel);
+    if (!data_delivery_scheduled.exchange(true)) {
+        system.CoreTiming().ScheduleEvent(0, data_delivery_event, 0,
+                                          std::numeric_limits<std::size_t>::max(), true);
+    }
+}
+
+void NWM_UDS::DataDeliveryCallback(std::uintptr_t user_data, s64 cycles_late) {
+    std::scoped_lock lock{connection_status_mutex};
+    data_delivery_scheduled = false;
+    for (const u32 data_channel : pending_data_channels) {
+        if (const auto channel_info = channel_data.find(data_channel);
+            channel_info != channel_data.end()) {
+            channel_info->second.event->Signal();
+        }
+    }
+    pending_data_channels.clear();
 }
 
 void NWM_UDS::StartConnectionSequence(const MacAddress& server) {
@@ -866,6 +888,7 @@ Result NWM_UDS::BeginHostingNetwork(std::span<const u8> network_info_buffer,
     connection_status_event->Signal();
 
     // Start broadcasting the network, send a beacon frame every 102.4ms.
+    last_beacon_frame.clear();
     system.CoreTiming().ScheduleEvent(msToCycles(DefaultBeaconInterval * MillisecondsPerTU),
                                       beacon_broadcast_event, 0);
 
@@ -1481,6 +1504,17 @@ void NWM_UDS::BeaconBroadcastCallback(std::uintptr_t user_data, s64 cycles_late)
 
     std::vector<u8> frame = GenerateBeaconFrame(network_info, node_info);
 
+    // Changes go out right away. An unchanged beacon is only resent every few intervals, which
+    // still lands within the scan window of RecvBeaconBroadcastData.
+    if (frame == last_beacon_frame && ++skipped_beacons < BeaconResendInterval) {
+        system.CoreTiming().ScheduleEvent(msToCycles(DefaultBeaconInterval * MillisecondsPerTU) -
+                                              cycles_late,
+                                          beacon_broadcast_event, 0);
+        return;
+    }
+    last_beacon_frame = frame;
+    skipped_beacons = 0;
+
     using Network::WifiPacket;
     WifiPacket packet;
     packet.type = WifiPacket::PacketType::Beacon;
@@ -1539,6 +1573,10 @@ NWM_UDS::NWM_UDS(Core::System& system) : ServiceFramework("nwm::UDS"), system(sy
         "UDS::BeaconBroadcastCallback", [this](std::uintptr_t user_data, s64 cycles_late) {
             BeaconBroadcastCallback(user_data, cycles_late);
         });
+    data_delivery_event = system.CoreTiming().RegisterEvent(
+        "UDS::DataDeliveryCallback", [this](std::uintptr_t user_data, s64 cycles_late) {
+            DataDeliveryCallback(user_data, cycles_late);
+        });
 
     MacAddress mac;
 
@@ -1569,6 +1607,7 @@ NWM_UDS::~NWM_UDS() {
         room_member->Unbind(wifi_packet_received);
 
     system.CoreTiming().UnscheduleEvent(beacon_broadcast_event, 0);
+    system.CoreTiming().UnscheduleEvent(data_delivery_event, 0);
 }
 
 } // namespace Service::NWM
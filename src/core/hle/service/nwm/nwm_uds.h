@@ -13,6 +13,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <boost/optional.hpp>
 #include <boost/serialization/export.hpp>
@@ -460,6 +461,9 @@ private:
 
     void BeaconBroadcastCallback(std::uintptr_t user_data, s64 cycles_late);
 
+    /// Signals the receive events of the channels that got data since the previous call.
+    void DataDeliveryCallback(std::uintptr_t user_data, s64 cycles_late);
+
     /**
      * Returns a list of received 802.11 beacon frames from the specified sender since the last
      * call.
@@ -571,6 +575,17 @@ private:
     // Event that will generate and send the 802.11 beacon frames.
     Core::TimingEventType* beacon_broadcast_event;
 
+    // Last beacon frame sent and the number of intervals it has been skipped since, unchanged
+    // beacons are only resent often enough for scanning consoles to find the network.
+    std::vector<u8> last_beacon_frame;
+    u32 skipped_beacons = 0;
+
+    // Event that signals the receive events of the channels in pending_data_channels, so that all
+    // frames received within the same slice wake the application only once.
+    Core::TimingEventType* data_delivery_event;
+    std::unordered_set<u32> pending_data_channels;
+    std::atomic<bool> data_delivery_scheduled{false};
+
     // Callback identifier for the OnWifiPacketReceived event.
     Network::RoomMember::CallbackHandle<Network::WifiPacket> wifi_packet_received;
 
@@ -3,10 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <bit>
+#include <limits>
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/hacks/hack_manager.h"
 #include "common/logging/log.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
@@ -150,6 +153,16 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
         // Usually this array is sorted by id already, so hint to insert at the end
         handlers.emplace_hint(handlers.cend(), functions[i].command_id, functions[i]);
     }
+
+    // Command ids are small, so commands are dispatched with a table indexed by id instead of
+    // searching the map on every request.
+    ASSERT(handlers.size() < std::numeric_limits<u16>::max());
+    dispatch_table.assign(handlers.empty() ? 0 : handlers.rbegin()->first + 1, 0);
+    u16 index = 0;
+    for (const auto& [command_id, info] : handlers) {
+        dispatch_table[command_id] = ++index;
+    }
+    latencies = std::make_unique<LatencyCounters[]>(handlers.size());
 }
 
 void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info) {
@@ -175,9 +188,22 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
     cmd_buf[1] = 0;
 }
 
+void ServiceFrameworkBase::RecordLatency(std::size_t handler_index,
+                                         std::chrono::nanoseconds latency) {
+    const u64 latency_ns = static_cast<u64>(latency.count());
+    const std::size_t bucket =
+        std::min<std::size_t>(std::bit_width(latency_ns / 1000), LatencyBuckets - 1);
+
+    LatencyCounters& counters = latencies[handler_index];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.total_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+    counters.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
 void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
-    auto itr = handlers.find(context.CommandHeader().command_id.Value());
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    const u32 command_id = context.CommandHeader().command_id.Value();
+    const u16 index = command_id < dispatch_table.size() ? dispatch_table[command_id] : 0;
+    const FunctionInfoBase* info = index == 0 ? nullptr : &handlers.nth(index - 1)->second;
     if (info == nullptr || !info->implemented) {
         context.ReportUnimplemented();
         return ReportUnimplementedFunction(context.CommandBuffer(), info);
@@ -185,7 +211,35 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::IPCCommand);
+    const auto start = std::chrono::steady_clock::now();
     handler_invoker(this, info->handler_callback, context);
+    const auto latency = std::chrono::steady_clock::now() - start;
+
+    RecordLatency(index - 1, latency);
+    context.ReportHandlerTime(latency);
+}
+
+std::vector<ServiceFrameworkBase::CommandLatency> ServiceFrameworkBase::GetCommandLatencies()
+    const {
+    std::vector<CommandLatency> result;
+    std::size_t index = 0;
+    for (const auto& [command_id, info] : handlers) {
+        const LatencyCounters& counters = latencies[index++];
+        const u64 calls = counters.calls.load(std::memory_order_relaxed);
+        if (calls == 0) {
+            continue;
+        }
+        CommandLatency& latency = result.emplace_back();
+        latency.command_id = command_id;
+        latency.name = info.name;
+        latency.calls = calls;
+        latency.total_ns = counters.total_ns.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < LatencyBuckets; i++) {
+            latency.buckets[i] = counters.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(IPC::Header header) const {
@@ -5,10 +5,13 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -71,6 +74,22 @@ public:
     /// Retrieves name of a function based on the header code. For IPC Recorder.
     std::string GetFunctionName(IPC::Header header) const;
 
+    /// Number of buckets of the command latency histograms. Bucket 0 counts the calls that took
+    /// less than 1us, bucket i the calls in [2^(i-1), 2^i) us and the last one every slower call.
+    static constexpr std::size_t LatencyBuckets = 16;
+
+    /// Host time spent in the handler of a command, collected for every call.
+    struct CommandLatency {
+        u32 command_id;
+        const char* name;
+        u64 calls;
+        u64 total_ns;
+        std::array<u64, LatencyBuckets> buckets;
+    };
+
+    /// Returns the latency statistics of the commands of the service that were called.
+    std::vector<CommandLatency> GetCommandLatencies() const;
+
 protected:
     /// Member-function pointer type of SyncRequest handlers.
     template <typename Self>
@@ -94,8 +113,15 @@ private:
     ServiceFrameworkBase(const char* service_name, u32 max_sessions, InvokerFn* handler_invoker);
     ~ServiceFrameworkBase() override;
 
+    struct LatencyCounters {
+        std::atomic<u64> calls;
+        std::atomic<u64> total_ns;
+        std::array<std::atomic<u64>, LatencyBuckets> buckets;
+    };
+
     void RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n);
     void ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info);
+    void RecordLatency(std::size_t handler_index, std::chrono::nanoseconds latency);
 
     void Empty(Kernel::HLERequestContext& ctx) {}
 
@@ -107,6 +133,10 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    /// Index + 1 in handlers of the handler of each command id, 0 for unknown commands.
+    std::vector<u16> dispatch_table;
+    /// Latency counters of the handlers, in the order of handlers.
+    std::unique_ptr<LatencyCounters[]> latencies;
 };
 
 /**
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -76,6 +77,19 @@ public:
         return std::static_pointer_cast<T>(port->hle_handler);
     }
 
+    /// Returns the registered services implemented by an HLE handler of type T, by name.
+    template <typename T>
+    std::map<std::string, std::shared_ptr<T>> GetServices() const {
+        std::map<std::string, std::shared_ptr<T>> services;
+        for (const auto& [name, client_port] : registered_services) {
+            auto port = client_port->GetServerPort();
+            if (auto service = port ? std::dynamic_pointer_cast<T>(port->hle_handler) : nullptr) {
+                services.emplace(name, std::move(service));
+            }
+        }
+        return services;
+    }
+
 private:
     Core::System& system;
     std::weak_ptr<SRV> srv_interface;
@@ -979,6 +979,9 @@ void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
     async_data->pid = pid;
     async_data->socket_handle = socket_handle;
 
+    // Accepting only blocks if there is no pending connection yet.
+    const bool needs_async = GetSocketBlocking(holder) && !IsSocketReady(holder, POLLIN);
+
     ctx.RunAsync(
         [async_data](Kernel::HLERequestContext& ctx) {
             socklen_t addr_len = sizeof(async_data->addr);
@@ -1022,7 +1025,8 @@ void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
             rb.Push(ResultSuccess);
             rb.Push(async_data->ret);
             rb.PushStaticBuffer(std::move(ctr_addr_buf), 0);
-        });
+        },
+        needs_async);
 }
 
 void SOC_U::SockAtMark(Kernel::HLERequestContext& ctx) {
@@ -1262,6 +1266,14 @@ void SOC_U::RecvBusyWaitForEvent(SocketHolder& holder) {
     }
 }
 
+bool SOC_U::IsSocketReady(const SocketHolder& holder, short events) {
+    pollfd poll_fd{};
+    poll_fd.fd = holder.socket_fd;
+    poll_fd.events = events;
+    // Errors are reported as ready too, the actual call will return them without blocking.
+    return ::poll(&poll_fd, 1, 0) != 0;
+}
+
 void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
     const u32 socket_handle = rp.Pop<u32>();
@@ -1290,7 +1302,8 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     }
 #endif // _WIN32
 
-    bool needs_async = GetSocketBlocking(holder) && !dont_wait;
+    // Blocking receives only need a worker thread if there is no data to return yet.
+    bool needs_async = GetSocketBlocking(holder) && !dont_wait && !IsSocketReady(holder, POLLIN);
     struct AsyncData {
         // Input
         u32 len{};
@@ -1409,7 +1422,8 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     }
 #endif // _WIN32
 
-    bool needs_async = GetSocketBlocking(holder) && !dont_wait;
+    // Blocking receives only need a worker thread if there is no data to return yet.
+    bool needs_async = GetSocketBlocking(holder) && !dont_wait && !IsSocketReady(holder, POLLIN);
     struct AsyncData {
         // Input
         u32 len{};
@@ -1546,6 +1560,14 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
             CTRPollFD::ToPlatform(*this, async_data->ctr_fds[i], async_data->has_libctru_bug[i]);
     }
 
+    // Only hand the poll to a worker thread if it would actually have to wait. If any socket is
+    // already ready, answering with a zero timeout returns the same result right away.
+    bool needs_async = timeout != 0;
+    if (needs_async && ::poll(async_data->platform_pollfd.data(), nfds, 0) != 0) {
+        async_data->timeout = 0;
+        needs_async = false;
+    }
+
     ctx.RunAsync(
         [async_data](Kernel::HLERequestContext& ctx) {
             async_data->ret =
@@ -1579,7 +1601,7 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
             LOG_POLL(Service_SOC, "called, fd_count={}, ret={}", async_data->nfds,
                      static_cast<s32>(async_data->ret));
         },
-        timeout != 0);
+        needs_async);
 }
 
 void SOC_U::GetSockName(Kernel::HLERequestContext& ctx) {
@@ -100,6 +100,9 @@ private:
 
     static void RecvBusyWaitForEvent(SocketHolder& holder);
 
+    // Checks without blocking whether the socket has any of the requested poll events pending.
+    static bool IsSocketReady(const SocketHolder& holder, short events);
+
     // From
     // https://github.com/devkitPro/libctru/blob/1de86ea38aec419744149daf692556e187d4678a/libctru/include/3ds/services/soc.h#L15
     enum class NetworkOpt {
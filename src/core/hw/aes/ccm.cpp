@@ -7,6 +7,7 @@
 #include <cryptopp/ccm.h>
 #include <cryptopp/cryptlib.h>
 #include <cryptopp/filters.h>
+#include "common/aes.h"
 #include "common/alignment.h"
 #include "common/logging/log.h"
 #include "core/hw/aes/ccm.h"
@@ -40,6 +41,63 @@ public:
     using Decryption = CCM_3DSVariant_Final<false>;
 };
 
+// The same algorithm on top of the AES instructions of the host. The MAC is a chain of single
+// block encryptions, but the payload is encrypted several counter blocks at a time.
+
+constexpr std::size_t CCM_LENGTH_SIZE = AES_BLOCK_SIZE - 1 - CCM_NONCE_SIZE;
+
+/// Whether the message length, aligned the way the 3DS does, fits in the B0 length field.
+bool FitsLengthField(std::size_t message_length) {
+    return Common::AlignUp(message_length, AES_BLOCK_SIZE) < (1ULL << (8 * CCM_LENGTH_SIZE));
+}
+
+AESKey ComputeMAC(const Common::AES::Cipher& cipher, std::span<const u8> pdata,
+                  const CCMNonce& nonce) {
+    // B0 holds the flags for the MAC size with no associated data, the nonce and the length.
+    AESKey mac{};
+    mac[0] = ((CCM_MAC_SIZE - 2) / 2) << 3 | (CCM_LENGTH_SIZE - 1);
+    std::copy(nonce.begin(), nonce.end(), mac.begin() + 1);
+    const std::size_t aligned_length = Common::AlignUp(pdata.size(), AES_BLOCK_SIZE);
+    for (std::size_t i = 0; i < CCM_LENGTH_SIZE; i++) {
+        mac[AES_BLOCK_SIZE - 1 - i] = static_cast<u8>(aligned_length >> (8 * i));
+    }
+    cipher.EncryptBlock(mac.data(), mac.data());
+
+    // The last block is padded with zeros.
+    for (std::size_t pos = 0; pos < pdata.size(); pos += AES_BLOCK_SIZE) {
+        const std::size_t size = std::min(AES_BLOCK_SIZE, pdata.size() - pos);
+        for (std::size_t i = 0; i < size; i++) {
+            mac[i] ^= pdata[pos + i];
+        }
+        cipher.EncryptBlock(mac.data(), mac.data());
+    }
+    return mac;
+}
+
+/// Encrypts the MAC with the first counter block and XORs the key stream of the following ones
+/// with `in` into `out`.
+AESKey CounterCrypt(const Common::AES::Cipher& cipher, const CCMNonce& nonce, const u8* in,
+                    u8* out, std::size_t size, const AESKey& mac) {
+    AESKey block{};
+    block[0] = CCM_LENGTH_SIZE - 1;
+    std::copy(nonce.begin(), nonce.end(), block.begin() + 1);
+    auto counter = Common::AES::Counter::FromBytes(block.data());
+
+    AESKey encrypted_mac = mac;
+    cipher.XorKeyStream(counter, encrypted_mac.data(), encrypted_mac.data(), 1);
+
+    const std::size_t blocks = size / AES_BLOCK_SIZE;
+    cipher.XorKeyStream(counter, in, out, blocks);
+    const std::size_t tail = size - blocks * AES_BLOCK_SIZE;
+    if (tail > 0) {
+        block.fill(0);
+        std::copy_n(in + blocks * AES_BLOCK_SIZE, tail, block.begin());
+        cipher.XorKeyStream(counter, block.data(), block.data(), 1);
+        std::copy_n(block.begin(), tail, out + blocks * AES_BLOCK_SIZE);
+    }
+    return encrypted_mac;
+}
+
 } // namespace
 
 std::vector<u8> EncryptSignCCM(std::span<const u8> pdata, const CCMNonce& nonce,
@@ -50,6 +108,15 @@ std::vector<u8> EncryptSignCCM(std::span<const u8> pdata, const CCMNonce& nonce,
     const AESKey normal = GetNormalKey(slot_id);
     std::vector<u8> cipher(pdata.size() + CCM_MAC_SIZE);
 
+    if (Common::AES::IsAccelerated() && FitsLengthField(pdata.size())) {
+        const Common::AES::Cipher aes(normal.data());
+        const AESKey mac = ComputeMAC(aes, pdata, nonce);
+        const AESKey encrypted_mac =
+            CounterCrypt(aes, nonce, pdata.data(), cipher.data(), pdata.size(), mac);
+        std::copy(encrypted_mac.begin(), encrypted_mac.end(), cipher.end() - CCM_MAC_SIZE);
+        return cipher;
+    }
+
     try {
         CCM_3DSVariant::Encryption e;
         e.SetKeyWithIV(normal.data(), AES_BLOCK_SIZE, nonce.data(), CCM_NONCE_SIZE);
@@ -72,6 +139,21 @@ std::vector<u8> DecryptVerifyCCM(std::span<const u8> cipher, const CCMNonce& non
     const std::size_t pdata_size = cipher.size() - CCM_MAC_SIZE;
     std::vector<u8> pdata(pdata_size);
 
+    if (Common::AES::IsAccelerated() && FitsLengthField(pdata_size)) {
+        const Common::AES::Cipher aes(normal.data());
+        // The MAC is checked on the decrypted data, so decrypt with a zero MAC first.
+        const AESKey mask = CounterCrypt(aes, nonce, cipher.data(), pdata.data(), pdata_size, {});
+        AESKey mac = ComputeMAC(aes, pdata, nonce);
+        for (std::size_t i = 0; i < CCM_MAC_SIZE; i++) {
+            mac[i] ^= mask[i];
+        }
+        if (!std::equal(mac.begin(), mac.end(), cipher.end() - CCM_MAC_SIZE)) {
+            LOG_ERROR(HW_AES, "FAILED");
+            return {};
+        }
+        return pdata;
+    }
+
     try {
         CCM_3DSVariant::Decryption d;
         d.SetKeyWithIV(normal.data(), AES_BLOCK_SIZE, nonce.data(), CCM_NONCE_SIZE);
@@ -16,6 +16,15 @@
 #include "core/hw/y2r.h"
 #include "core/memory.h"
 
+#if defined(CITRA_HAS_SSE42)
+#include <smmintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#define CITRA_HAS_NEON
+#include <arm_neon.h>
+#endif
+
 namespace HW::Y2R {
 
 using namespace Service::Y2R;
@@ -24,55 +33,125 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
+/// Converts 8 YUV tuples to RGB32, writing them to 8 consecutive pixels of a tile line.
+static void ConvertPixels(const s32 Y[8], const s32 U[8], const s32 V[8], u32* out,
+                          const CoefficientSet& c) {
+    // This conversion process is bit-exact with hardware, as far as could be tested.
+    constexpr s32 rounding_offset = 0x18;
+#if defined(CITRA_HAS_SSE42)
+    const __m128i c0 = _mm_set1_epi32(c[0]);
+    const __m128i c1 = _mm_set1_epi32(c[1]);
+    const __m128i c2 = _mm_set1_epi32(c[2]);
+    const __m128i c3 = _mm_set1_epi32(c[3]);
+    const __m128i c4 = _mm_set1_epi32(c[4]);
+    const __m128i offset_r = _mm_set1_epi32(c[5] + rounding_offset);
+    const __m128i offset_g = _mm_set1_epi32(c[6] + rounding_offset);
+    const __m128i offset_b = _mm_set1_epi32(c[7] + rounding_offset);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi32(0xFF);
+    for (int i = 0; i < 8; i += 4) {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Y + i));
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(U + i));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(V + i));
+        const __m128i cY = _mm_mullo_epi32(c0, y);
+
+        __m128i r = _mm_add_epi32(cY, _mm_mullo_epi32(c1, v));
+        __m128i g = _mm_sub_epi32(_mm_sub_epi32(cY, _mm_mullo_epi32(c2, v)),
+                                  _mm_mullo_epi32(c3, u));
+        __m128i b = _mm_add_epi32(cY, _mm_mullo_epi32(c4, u));
+
+        r = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(r, 3), offset_r), 5);
+        g = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(g, 3), offset_g), 5);
+        b = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(b, 3), offset_b), 5);
+        r = _mm_min_epi32(_mm_max_epi32(r, zero), max);
+        g = _mm_min_epi32(_mm_max_epi32(g, zero), max);
+        b = _mm_min_epi32(_mm_max_epi32(b, zero), max);
+
+        const __m128i rgb = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+                                         _mm_slli_epi32(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), rgb);
+    }
+#elif defined(CITRA_HAS_NEON)
+    const int32x4_t offset_r = vdupq_n_s32(c[5] + rounding_offset);
+    const int32x4_t offset_g = vdupq_n_s32(c[6] + rounding_offset);
+    const int32x4_t offset_b = vdupq_n_s32(c[7] + rounding_offset);
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t max = vdupq_n_s32(0xFF);
+    for (int i = 0; i < 8; i += 4) {
+        const int32x4_t y = vld1q_s32(Y + i);
+        const int32x4_t u = vld1q_s32(U + i);
+        const int32x4_t v = vld1q_s32(V + i);
+        const int32x4_t cY = vmulq_n_s32(y, c[0]);
+
+        int32x4_t r = vmlaq_n_s32(cY, v, c[1]);
+        int32x4_t g = vmlsq_n_s32(vmlsq_n_s32(cY, v, c[2]), u, c[3]);
+        int32x4_t b = vmlaq_n_s32(cY, u, c[4]);
+
+        r = vshrq_n_s32(vaddq_s32(vshrq_n_s32(r, 3), offset_r), 5);
+        g = vshrq_n_s32(vaddq_s32(vshrq_n_s32(g, 3), offset_g), 5);
+        b = vshrq_n_s32(vaddq_s32(vshrq_n_s32(b, 3), offset_b), 5);
+        const uint32x4_t r8 = vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(r, zero), max));
+        const uint32x4_t g8 = vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(g, zero), max));
+        const uint32x4_t b8 = vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(b, zero), max));
+
+        const uint32x4_t rgb =
+            vorrq_u32(vorrq_u32(vshlq_n_u32(r8, 24), vshlq_n_u32(g8, 16)), vshlq_n_u32(b8, 8));
+        vst1q_u32(out + i, rgb);
+    }
+#else
+    for (int i = 0; i < 8; ++i) {
+        s32 cY = c[0] * Y[i];
+
+        s32 r = cY + c[1] * V[i];
+        s32 g = cY - c[2] * V[i] - c[3] * U[i];
+        s32 b = cY + c[4] * U[i];
+
+        r = (r >> 3) + c[5] + rounding_offset;
+        g = (g >> 3) + c[6] + rounding_offset;
+        b = (b >> 3) + c[7] + rounding_offset;
+
+        out[i] = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
+                 ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
+                 ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+    }
+#endif
+}
+
 /// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
 template <InputFormat input_format>
 static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
                             ImageTile output[], unsigned int width, unsigned int height,
                             const CoefficientSet& coefficients) {
+    // The width is always a multiple of 8, so each tile line is decoded and converted at once.
+    s32 Y[8];
+    s32 U[8];
+    s32 V[8];
 
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            s32 Y;
-            s32 U;
-            s32 V;
-            if constexpr (input_format == InputFormat::YUV422_Indiv8 ||
-                          input_format == InputFormat::YUV422_Indiv16) {
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
-            } else if constexpr (input_format == InputFormat::YUV420_Indiv8 ||
-                                 input_format == InputFormat::YUV420_Indiv16) {
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
-            } else if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
-            } else {
-                UNREACHABLE_MSG("Unknown Y2R input format {}", input_format);
-                return;
+        for (unsigned int tile = 0; tile < width / 8; ++tile) {
+            for (unsigned int tile_x = 0; tile_x < 8; ++tile_x) {
+                const unsigned int x = tile * 8 + tile_x;
+                if constexpr (input_format == InputFormat::YUV422_Indiv8 ||
+                              input_format == InputFormat::YUV422_Indiv16) {
+                    Y[tile_x] = input_Y[y * width + x];
+                    U[tile_x] = input_U[(y * width + x) / 2];
+                    V[tile_x] = input_V[(y * width + x) / 2];
+                } else if constexpr (input_format == InputFormat::YUV420_Indiv8 ||
+                                     input_format == InputFormat::YUV420_Indiv16) {
+                    Y[tile_x] = input_Y[y * width + x];
+                    U[tile_x] = input_U[((y / 2) * width + x) / 2];
+                    V[tile_x] = input_V[((y / 2) * width + x) / 2];
+                } else if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
+                    Y[tile_x] = input_Y[(y * width + x) * 2];
+                    U[tile_x] = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
+                    V[tile_x] = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
+                } else {
+                    UNREACHABLE_MSG("Unknown Y2R input format {}", input_format);
+                    return;
+                }
             }
 
-            // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+            ConvertPixels(Y, U, V, &output[tile][y * 8], coefficients);
         }
     }
 }
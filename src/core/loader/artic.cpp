@@ -53,6 +53,8 @@ Apploader_Artic::Apploader_Artic(Core::System& system_, const std::string& serve
     });
     client->SetArticReportTrafficCallback(
         [&system_](u32 bytes) { system_.ReportArticTraffic(bytes); });
+    client->SetReportArticLatencyCallback(
+        [&system_](std::chrono::nanoseconds latency) { system_.ReportArticLatency(latency); });
     client->SetReportArticEventCallback([&system_](u64 event) {
         Core::PerfStats::PerfArticEventBits ev =
             static_cast<Core::PerfStats::PerfArticEventBits>(event & 0xFFFFFFFF);
@@ -144,6 +144,35 @@ static std::unique_ptr<AppLoader> GetFileLoader(Core::System& system, FileUtil::
     }
 }
 
+std::shared_ptr<const std::vector<u8>> CodeCache::Find(const std::string& path) {
+    const auto it = std::find_if(entries.begin(), entries.end(),
+                                 [&path](const Entry& entry) { return entry.path == path; });
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it);
+    return it->code;
+}
+
+void CodeCache::Insert(const std::string& path, std::shared_ptr<const std::vector<u8>> code) {
+    std::erase_if(entries, [this, &path](const Entry& entry) {
+        if (entry.path != path) {
+            return false;
+        }
+        size -= entry.code->size();
+        return true;
+    });
+    if (code->size() > budget) {
+        return;
+    }
+    while (size + code->size() > budget) {
+        size -= entries.back().code->size();
+        entries.pop_back();
+    }
+    size += code->size();
+    entries.push_front({path, std::move(code)});
+}
+
 std::unique_ptr<AppLoader> GetLoader(const std::string& filename) {
     if (filename.starts_with("articbase://") || filename.starts_with("articinio://") ||
         filename.starts_with("articinin://")) {
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <algorithm>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -82,6 +83,31 @@ constexpr u32 MakeMagic(char a, char b, char c, char d) {
     return a | b << 8 | c << 16 | d << 24;
 }
 
+/**
+ * Keeps the decompressed code of recently launched titles under a memory budget, so that launching
+ * them again skips reading, decrypting and decompressing their executable.
+ */
+class CodeCache : NonCopyable {
+public:
+    explicit CodeCache(std::size_t budget_) : budget(budget_) {}
+
+    /// Returns the code cached for the content at path, or nullptr if there is none
+    std::shared_ptr<const std::vector<u8>> Find(const std::string& path);
+
+    /// Caches the code of the content at path, evicting the least recently used entries
+    void Insert(const std::string& path, std::shared_ptr<const std::vector<u8>> code);
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const std::vector<u8>> code;
+    };
+
+    std::list<Entry> entries; ///< Most recently used first
+    std::size_t size = 0;
+    std::size_t budget;
+};
+
 /// Interface for loading an application
 class AppLoader : NonCopyable {
 public:
@@ -306,11 +332,17 @@ public:
         return file ? file->Filename() : "";
     }
 
+    /// Sets the cache the executable code is looked up in and stored to when loading
+    void SetCodeCache(CodeCache* cache) {
+        code_cache = cache;
+    }
+
 protected:
     Core::System& system;
     std::unique_ptr<FileUtil::IOFile> file;
     bool is_loaded = false;
     std::optional<Kernel::MemoryMode> memory_mode_override = std::nullopt;
+    CodeCache* code_cache = nullptr;
 };
 
 /**
@@ -150,7 +150,7 @@ ResultStatus AppLoader_NCCH::LoadExec(std::shared_ptr<Kernel::Process>& process)
 
     std::vector<u8> code;
     u64_le program_id;
-    if (ResultStatus::Success == ReadCode(code) &&
+    if (ResultStatus::Success == ReadExecCode(code) &&
         ResultStatus::Success == ReadProgramId(program_id)) {
         if (IsGbaVirtualConsole(code)) {
             LOG_ERROR(Loader, "Encountered unsupported GBA Virtual Console code section.");
@@ -351,6 +351,24 @@ ResultStatus AppLoader_NCCH::IsExecutable(bool& out_executable) {
     return ResultStatus::Success;
 }
 
+ResultStatus AppLoader_NCCH::ReadExecCode(std::vector<u8>& buffer) {
+    // The cache is keyed by the base content path, so titles overlaid by an update bypass it.
+    if (!code_cache || overlay_ncch != &base_ncch) {
+        return ReadCode(buffer);
+    }
+
+    if (const auto cached = code_cache->Find(filepath)) {
+        buffer = *cached;
+        return ResultStatus::Success;
+    }
+
+    const ResultStatus result = ReadCode(buffer);
+    if (result == ResultStatus::Success) {
+        code_cache->Insert(filepath, std::make_shared<const std::vector<u8>>(buffer));
+    }
+    return result;
+}
+
 ResultStatus AppLoader_NCCH::ReadCode(std::vector<u8>& buffer) {
     return overlay_ncch->LoadSectionExeFS(".code", buffer);
 }
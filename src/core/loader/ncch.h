@@ -92,6 +92,9 @@ private:
      */
     ResultStatus LoadExec(std::shared_ptr<Kernel::Process>& process);
 
+    /// Reads the .code section through the code cache, if one was set
+    ResultStatus ReadExecCode(std::vector<u8>& buffer);
+
     /// Reads the region lockout info in the SMDH and send it to CFG service
     /// If an SMDH is not present, the program ID is compared against a list
     /// of known system titles to determine the region.
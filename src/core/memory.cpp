@@ -2,10 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cstring>
+#include <mutex>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
+#include <boost/serialization/vector.hpp>
 #include "audio_core/dsp_interface.h"
 #include "common/archives.h"
 #include "common/assert.h"
@@ -31,7 +36,60 @@ SERIALIZE_EXPORT_IMPL(Memory::MemorySystem::BackingMemImpl<Memory::Region::N3DS>
 
 namespace Memory {
 
+namespace {
+
+/// Set on threads whose rasterizer cached transitions are queued for the emulation thread
+thread_local bool defer_rasterizer_marks = false;
+
+} // Anonymous namespace
+
+void PageTable::Pointers::Mirror(VAddr idx, u8* pointer) {
+    if (!fastmem || raw[idx] == pointer) {
+        return;
+    }
+    const std::size_t page_offset = static_cast<std::size_t>(idx) * CITRA_PAGE_SIZE;
+    if (const auto backing_offset = fastmem->BackingOffset(pointer)) {
+        fastmem->Map(page_offset, *backing_offset, CITRA_PAGE_SIZE);
+    } else if (fastmem->BackingOffset(raw[idx])) {
+        fastmem->Unmap(page_offset, CITRA_PAGE_SIZE);
+    }
+}
+
+void PageTable::EnableFastmem(const Common::HostMemory& host_memory) {
+    pointers.fastmem.reset();
+    if (!host_memory.SupportsViews()) {
+        return;
+    }
+    auto view = std::make_unique<Common::HostMemoryView>(
+        host_memory, PAGE_TABLE_NUM_ENTRIES * std::size_t{CITRA_PAGE_SIZE});
+    if (!view->BasePointer()) {
+        return;
+    }
+
+    // Mirror runs of consecutive pages at once to keep the number of mappings low.
+    std::size_t page = 0;
+    while (page < PAGE_TABLE_NUM_ENTRIES) {
+        const auto backing_offset = view->BackingOffset(pointers.raw[page]);
+        if (!backing_offset) {
+            page++;
+            continue;
+        }
+        std::size_t count = 1;
+        while (page + count < PAGE_TABLE_NUM_ENTRIES &&
+               pointers.raw[page + count] == pointers.raw[page] + count * CITRA_PAGE_SIZE &&
+               view->BackingOffset(pointers.raw[page + count])) {
+            count++;
+        }
+        view->Map(page * CITRA_PAGE_SIZE, *backing_offset, count * CITRA_PAGE_SIZE);
+        page += count;
+    }
+    pointers.fastmem = std::move(view);
+}
+
 void PageTable::Clear() {
+    if (pointers.fastmem) {
+        pointers.fastmem->Unmap(0, PAGE_TABLE_NUM_ENTRIES * std::size_t{CITRA_PAGE_SIZE});
+    }
     pointers.raw.fill(nullptr);
     pointers.refs.fill(MemoryRef());
     attributes.fill(PageType::Unmapped);
@@ -85,19 +143,145 @@ private:
     }
 };
 
+/**
+ * Reverse map from the pages of the regions cached by the rasterizer to the registered page tables
+ * mapping them, so that changing the cached state of a page only visits those page tables.
+ */
+class RasterizerPageMappings {
+public:
+    /// Starts tracking a page table, picking up the pages it already maps
+    void Register(PageTable& page_table) {
+        const auto slot = std::find(tables.begin(), tables.end(), nullptr);
+        if (slot == tables.end()) {
+            // Out of slots, the page table is visited for every page instead.
+            untracked.push_back(&page_table);
+            return;
+        }
+        *slot = &page_table;
+
+        const u64 bit = u64{1} << (slot - tables.begin());
+        for (const auto& region : Regions) {
+            for (u32 page = 0; page < region.size / CITRA_PAGE_SIZE; page++) {
+                if (page_table.attributes[region.vaddr / CITRA_PAGE_SIZE + page] !=
+                    PageType::Unmapped) {
+                    mappings[region.first_index + page] |= bit;
+                }
+            }
+        }
+    }
+
+    void Unregister(PageTable& page_table) {
+        std::erase(untracked, &page_table);
+        const auto slot = std::find(tables.begin(), tables.end(), &page_table);
+        if (slot == tables.end()) {
+            return;
+        }
+        *slot = nullptr;
+
+        const u64 mask = ~(u64{1} << (slot - tables.begin()));
+        for (u64& tables_mapping : mappings) {
+            tables_mapping &= mask;
+        }
+    }
+
+    void Clear() {
+        tables.fill(nullptr);
+        untracked.clear();
+        mappings.fill(0);
+    }
+
+    /// Records a change of the mapped state of a range of pages, given as page numbers
+    void Update(const PageTable& page_table, u32 first_page, u32 num_pages, bool mapped) {
+        const auto slot = std::find(tables.begin(), tables.end(), &page_table);
+        if (slot == tables.end()) {
+            return;
+        }
+
+        const u64 bit = u64{1} << (slot - tables.begin());
+        for (const auto& region : Regions) {
+            const u32 region_page = region.vaddr / CITRA_PAGE_SIZE;
+            const u32 begin = std::max(first_page, region_page);
+            const u32 end =
+                std::min(first_page + num_pages, region_page + region.size / CITRA_PAGE_SIZE);
+            for (u32 page = begin; page < end; page++) {
+                u64& tables_mapping = mappings[region.first_index + page - region_page];
+                tables_mapping = mapped ? (tables_mapping | bit) : (tables_mapping & ~bit);
+            }
+        }
+    }
+
+    /**
+     * Calls the function for each registered page table that may map the page at the address.
+     * Page tables cleared without unmapping their pages may still be visited.
+     */
+    template <typename Func>
+    void ForEach(VAddr vaddr, Func&& func) {
+        for (const auto& region : Regions) {
+            if (vaddr >= region.vaddr && vaddr - region.vaddr < region.size) {
+                u64 tables_mapping = mappings[region.first_index +
+                                              (vaddr - region.vaddr) / CITRA_PAGE_SIZE];
+                while (tables_mapping != 0) {
+                    func(*tables[std::countr_zero(tables_mapping)]);
+                    tables_mapping &= tables_mapping - 1;
+                }
+                break;
+            }
+        }
+        for (PageTable* page_table : untracked) {
+            func(*page_table);
+        }
+    }
+
+private:
+    struct MappedRegion {
+        VAddr vaddr;
+        u32 size;
+        std::size_t first_index;
+    };
+
+    static constexpr std::array Regions{
+        MappedRegion{VRAM_VADDR, VRAM_SIZE, 0},
+        MappedRegion{LINEAR_HEAP_VADDR, LINEAR_HEAP_SIZE, VRAM_SIZE / CITRA_PAGE_SIZE},
+        MappedRegion{NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_SIZE,
+                     (VRAM_SIZE + LINEAR_HEAP_SIZE) / CITRA_PAGE_SIZE},
+        MappedRegion{PLUGIN_3GX_FB_VADDR, PLUGIN_3GX_FB_SIZE,
+                     (VRAM_SIZE + LINEAR_HEAP_SIZE + NEW_LINEAR_HEAP_SIZE) / CITRA_PAGE_SIZE},
+    };
+    static constexpr std::size_t NumPages =
+        (VRAM_SIZE + LINEAR_HEAP_SIZE + NEW_LINEAR_HEAP_SIZE + PLUGIN_3GX_FB_SIZE) /
+        CITRA_PAGE_SIZE;
+
+    std::array<PageTable*, 64> tables{};
+    std::vector<PageTable*> untracked;
+    /// Bit mask of the slots in tables mapping each page
+    std::array<u64, NumPages> mappings{};
+};
+
 class MemorySystem::Impl {
 public:
-    // Visual Studio would try to allocate these on compile time
-    // if they are std::array which would exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
-    std::unique_ptr<u8[]> dsp_ram = std::make_unique<u8[]>(Memory::DSP_RAM_SIZE);
+    // All the emulated RAM shares one host allocation, so that fastmem arenas can mirror it.
+    Common::HostMemory host_memory{Memory::FCRAM_N3DS_SIZE + Memory::VRAM_SIZE +
+                                   Memory::N3DS_EXTRA_RAM_SIZE + Memory::DSP_RAM_SIZE};
+    u8* const fcram = host_memory.BackingBasePointer();
+    u8* const vram = fcram + Memory::FCRAM_N3DS_SIZE;
+    u8* const n3ds_extra_ram = vram + Memory::VRAM_SIZE;
+    u8* const dsp_ram = n3ds_extra_ram + Memory::N3DS_EXTRA_RAM_SIZE;
 
     Core::System& system;
     std::shared_ptr<PageTable> current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
     std::vector<std::shared_ptr<PageTable>> page_table_list;
+    RasterizerPageMappings page_mappings;
+
+    /// A transition requested by a thread other than the emulation thread.
+    struct DeferredMark {
+        PAddr start;
+        u32 size;
+        bool cached;
+    };
+    std::mutex deferred_marks_mutex;
+    std::vector<DeferredMark> deferred_marks;
+    std::atomic<bool> has_deferred_marks{false};
 
     std::shared_ptr<BackingMem> fcram_mem;
     std::shared_ptr<BackingMem> vram_mem;
@@ -106,18 +290,20 @@ public:
 
     PAddr plugin_fb_address{};
 
+    bool serialize_ram = true;
+
     Impl(Core::System& system_);
 
     const u8* GetPtr(Region r) const {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram;
         case Region::DSP:
-            return dsp_ram.get();
+            return dsp_ram;
         case Region::FCRAM:
-            return fcram.get();
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
@@ -126,13 +312,13 @@ public:
     u8* GetPtr(Region r) {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram;
         case Region::DSP:
-            return dsp_ram.get();
+            return dsp_ram;
         case Region::FCRAM:
-            return fcram.get();
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
@@ -157,24 +343,64 @@ public:
         return system.GetRunningCore().GetPC();
     }
 
+    /**
+     * Returns the length of the run of pages starting at vaddr, capped to size, that share the
+     * page type of vaddr and are backed by contiguous host memory, so that block accesses can
+     * copy and flush each run at once instead of page by page.
+     */
+    std::size_t ContiguousRunSize(PageTable& page_table, VAddr vaddr, std::size_t size) const {
+        std::size_t page_index = vaddr >> CITRA_PAGE_BITS;
+        const PageType type = page_table.attributes[page_index];
+        const auto host_page = [&](std::size_t index) -> const u8* {
+            switch (type) {
+            case PageType::Memory:
+                return page_table.pointers[index];
+            case PageType::RasterizerCachedMemory:
+                return GetPointerForRasterizerCache(static_cast<VAddr>(index << CITRA_PAGE_BITS))
+                    .GetPtr();
+            default:
+                return nullptr;
+            }
+        };
+
+        std::size_t run_size =
+            std::min<std::size_t>(CITRA_PAGE_SIZE - (vaddr & CITRA_PAGE_MASK), size);
+        const bool has_host_pages =
+            type == PageType::Memory || type == PageType::RasterizerCachedMemory;
+        if (!has_host_pages && type != PageType::Unmapped) {
+            // Special pages have no host memory, they are accessed one page at a time
+            return run_size;
+        }
+        const u8* next_page = has_host_pages ? host_page(page_index) + CITRA_PAGE_SIZE : nullptr;
+        while (run_size < size) {
+            page_index++;
+            if (page_table.attributes[page_index] != type) {
+                break;
+            }
+            if (has_host_pages) {
+                if (host_page(page_index) != next_page) {
+                    break;
+                }
+                next_page += CITRA_PAGE_SIZE;
+            }
+            run_size += std::min<std::size_t>(CITRA_PAGE_SIZE, size - run_size);
+        }
+        return run_size;
+    }
+
     template <bool UNSAFE>
     void ReadBlockImpl(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
                        const std::size_t size) {
-        // Prefetch toute la plage si le pointeur est valide
-        auto src_ptr = GetPointerForRasterizerCache(src_addr);
-        if (src_ptr) {
-            Common::PrefetchRange(src_ptr.GetPtr(), size);
-        }
         auto& page_table = *process.vm_manager.page_table;
 
         std::size_t remaining_size = size;
-        std::size_t page_index = src_addr >> CITRA_PAGE_BITS;
-        std::size_t page_offset = src_addr & CITRA_PAGE_MASK;
+        VAddr current_vaddr = src_addr;
 
         while (remaining_size > 0) {
-            const std::size_t copy_amount = std::min(CITRA_PAGE_SIZE - page_offset, remaining_size);
-            const VAddr current_vaddr =
-                static_cast<VAddr>((page_index << CITRA_PAGE_BITS) + page_offset);
+            const std::size_t copy_amount =
+                ContiguousRunSize(page_table, current_vaddr, remaining_size);
+            const std::size_t page_index = current_vaddr >> CITRA_PAGE_BITS;
+            const std::size_t page_offset = current_vaddr & CITRA_PAGE_MASK;
 
             switch (page_table.attributes[page_index]) {
             case PageType::Unmapped: {
@@ -205,8 +431,7 @@ public:
                 UNREACHABLE();
             }
 
-            page_index++;
-            page_offset = 0;
+            current_vaddr += static_cast<VAddr>(copy_amount);
             dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
             remaining_size -= copy_amount;
         }
@@ -217,13 +442,13 @@ public:
                         const void* src_buffer, const std::size_t size) {
         auto& page_table = *process.vm_manager.page_table;
         std::size_t remaining_size = size;
-        std::size_t page_index = dest_addr >> CITRA_PAGE_BITS;
-        std::size_t page_offset = dest_addr & CITRA_PAGE_MASK;
+        VAddr current_vaddr = dest_addr;
 
         while (remaining_size > 0) {
-            const std::size_t copy_amount = std::min(CITRA_PAGE_SIZE - page_offset, remaining_size);
-            const VAddr current_vaddr =
-                static_cast<VAddr>((page_index << CITRA_PAGE_BITS) + page_offset);
+            const std::size_t copy_amount =
+                ContiguousRunSize(page_table, current_vaddr, remaining_size);
+            const std::size_t page_index = current_vaddr >> CITRA_PAGE_BITS;
+            const std::size_t page_offset = current_vaddr & CITRA_PAGE_MASK;
 
             switch (page_table.attributes[page_index]) {
             case PageType::Unmapped: {
@@ -253,8 +478,7 @@ public:
                 UNREACHABLE();
             }
 
-            page_index++;
-            page_offset = 0;
+            current_vaddr += static_cast<VAddr>(copy_amount);
             src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
             remaining_size -= copy_amount;
         }
@@ -287,7 +511,10 @@ public:
                 return;
             }
 
-            auto& renderer = system.GPU().Renderer();
+            // The rasterizer may only be used once the GPU thread is done with it
+            auto& gpu = system.GPU();
+            gpu.WaitIdle();
+            auto& renderer = gpu.Renderer();
             VAddr overlap_start = std::max(start, region_start);
             VAddr overlap_end = std::min(end, region_end);
             PAddr physical_start = paddr_region_start + (overlap_start - region_start);
@@ -315,20 +542,91 @@ public:
         }
     }
 
+    /// Mirrors the memory of the page table in a fastmem arena when the JIT can use it
+    void EnableFastmem(PageTable& page_table) {
+        if (Settings::values.use_cpu_jit.GetValue() && Settings::values.use_fastmem.GetValue()) {
+            page_table.EnableFastmem(host_memory);
+        }
+    }
+
 private:
+    /**
+     * Serializes a bitmap of the pages of a RAM region holding data, followed by the contents of
+     * only those pages. The other pages are zero, mostly because they were never touched.
+     */
+    template <class Archive>
+    void SerializeRAM(Archive& ar, u8* ram, std::size_t size) {
+        const std::size_t offset = static_cast<std::size_t>(ram - fcram);
+        const std::size_t num_pages = size / CITRA_PAGE_SIZE;
+        std::vector<u64> used_pages((num_pages + 63) / 64);
+        const auto is_used = [&used_pages](std::size_t page) {
+            return ((used_pages[page / 64] >> (page % 64)) & 1) != 0;
+        };
+
+        if constexpr (Archive::is_saving::value) {
+            static constexpr std::array<u8, CITRA_PAGE_SIZE> zero_page{};
+            std::size_t page = 0;
+            while (page < num_pages) {
+                const auto [begin, end] =
+                    host_memory.FindTouchedRange(offset + page * CITRA_PAGE_SIZE);
+                page = std::max(page, (begin - offset) / CITRA_PAGE_SIZE);
+                const std::size_t last_page =
+                    std::min((end - offset + CITRA_PAGE_SIZE - 1) / CITRA_PAGE_SIZE, num_pages);
+                for (; page < last_page; page++) {
+                    if (std::memcmp(ram + page * CITRA_PAGE_SIZE, zero_page.data(),
+                                    CITRA_PAGE_SIZE) != 0) {
+                        used_pages[page / 64] |= u64{1} << (page % 64);
+                    }
+                }
+            }
+        }
+        ar & used_pages;
+        if constexpr (Archive::is_loading::value) {
+            host_memory.Discard(offset, size);
+        }
+
+        for (std::size_t page = 0; page < num_pages;) {
+            if (!is_used(page)) {
+                page++;
+                continue;
+            }
+            const std::size_t first_page = page;
+            while (page < num_pages && is_used(page)) {
+                page++;
+            }
+            ar& boost::serialization::make_binary_object(ram + first_page * CITRA_PAGE_SIZE,
+                                                         (page - first_page) * CITRA_PAGE_SIZE);
+        }
+    }
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int file_version) {
         bool save_n3ds_ram = Settings::values.is_new_3ds.GetValue();
         ar & save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
-        ar& boost::serialization::make_binary_object(dsp_ram.get(), Memory::DSP_RAM_SIZE);
+        if (serialize_ram && file_version >= 1) {
+            SerializeRAM(ar, vram, Memory::VRAM_SIZE);
+            SerializeRAM(ar, fcram, save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
+            SerializeRAM(ar, n3ds_extra_ram, save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+            SerializeRAM(ar, dsp_ram, Memory::DSP_RAM_SIZE);
+        } else if (serialize_ram) {
+            // Older states hold the whole of each region
+            ar& boost::serialization::make_binary_object(vram, Memory::VRAM_SIZE);
+            ar& boost::serialization::make_binary_object(
+                fcram, save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
+            ar& boost::serialization::make_binary_object(
+                n3ds_extra_ram, save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+            ar& boost::serialization::make_binary_object(dsp_ram, Memory::DSP_RAM_SIZE);
+        }
         ar & cache_marker;
         ar & page_table_list;
+        if (Archive::is_loading::value) {
+            page_mappings.Clear();
+            for (auto& page_table : page_table_list) {
+                EnableFastmem(*page_table);
+                page_mappings.Register(*page_table);
+            }
+        }
         // dsp is set from Core::System at startup
         ar & current_page_table;
         ar & fcram_mem;
@@ -408,6 +706,8 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
                                      FlushMode::FlushAndInvalidate);
     }
 
+    impl->page_mappings.Update(page_table, base, size, type != PageType::Unmapped);
+
     u32 end = base + size;
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
@@ -445,12 +745,15 @@ MemoryRef MemorySystem::GetPointerForRasterizerCache(VAddr addr) const {
 }
 
 void MemorySystem::RegisterPageTable(std::shared_ptr<PageTable> page_table) {
+    impl->EnableFastmem(*page_table);
+    impl->page_mappings.Register(*page_table);
     impl->page_table_list.push_back(page_table);
 }
 
 void MemorySystem::UnregisterPageTable(std::shared_ptr<PageTable> page_table) {
     auto it = std::find(impl->page_table_list.begin(), impl->page_table_list.end(), page_table);
     if (it != impl->page_table_list.end()) {
+        impl->page_mappings.Unregister(**it);
         impl->page_table_list.erase(it);
     }
 }
@@ -744,14 +1047,46 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
+    if (defer_rasterizer_marks) {
+        std::scoped_lock lock{impl->deferred_marks_mutex};
+        impl->deferred_marks.push_back({start, size, cached});
+        impl->has_deferred_marks.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    // Transitions of the same pages must be applied in the order they were made
+    ApplyDeferredRasterizerMarks();
+    MarkRegionCached(start, size, cached);
+}
+
+void MemorySystem::SetDeferRasterizerMarks(bool defer) {
+    defer_rasterizer_marks = defer;
+}
+
+void MemorySystem::ApplyDeferredRasterizerMarks() {
+    if (!impl->has_deferred_marks.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::vector<Impl::DeferredMark> marks;
+    {
+        std::scoped_lock lock{impl->deferred_marks_mutex};
+        marks.swap(impl->deferred_marks);
+        impl->has_deferred_marks.store(false, std::memory_order_relaxed);
+    }
+    for (const Impl::DeferredMark& mark : marks) {
+        MarkRegionCached(mark.start, mark.size, mark.cached);
+    }
+}
+
+void MemorySystem::MarkRegionCached(PAddr start, u32 size, bool cached) {
     u32 num_pages = ((start + size - 1) >> CITRA_PAGE_BITS) - (start >> CITRA_PAGE_BITS) + 1;
     PAddr paddr = start;
 
     for (unsigned i = 0; i < num_pages; ++i, paddr += CITRA_PAGE_SIZE) {
         for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
             impl->cache_marker.Mark(vaddr, cached);
-            for (auto& page_table : impl->page_table_list) {
-                PageType& page_type = page_table->attributes[vaddr >> CITRA_PAGE_BITS];
+            impl->page_mappings.ForEach(vaddr, [&](PageTable& page_table) {
+                PageType& page_type = page_table.attributes[vaddr >> CITRA_PAGE_BITS];
 
                 if (cached) {
                     // Switch page type to cached if now cached
@@ -762,7 +1097,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         break;
                     case PageType::Memory:
                         page_type = PageType::RasterizerCachedMemory;
-                        page_table->pointers[vaddr >> CITRA_PAGE_BITS] = nullptr;
+                        page_table.pointers[vaddr >> CITRA_PAGE_BITS] = nullptr;
                         break;
                     default:
                         UNREACHABLE();
@@ -776,7 +1111,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         break;
                     case PageType::RasterizerCachedMemory: {
                         page_type = PageType::Memory;
-                        page_table->pointers[vaddr >> CITRA_PAGE_BITS] =
+                        page_table.pointers[vaddr >> CITRA_PAGE_BITS] =
                             GetPointerForRasterizerCache(vaddr & ~CITRA_PAGE_MASK);
                         break;
                     }
@@ -784,7 +1119,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         UNREACHABLE();
                     }
                 }
-            }
+            });
         }
     }
 }
@@ -932,17 +1267,36 @@ void MemorySystem::WriteBlock(const VAddr dest_addr, const void* src_buffer,
     return impl->WriteBlockImpl<false>(process, dest_addr, src_buffer, size);
 }
 
+std::vector<std::span<u8>> MemorySystem::GetHostSegments(const Kernel::Process& process,
+                                                         const VAddr vaddr, std::size_t size) {
+    auto& page_table = *process.vm_manager.page_table;
+    std::vector<std::span<u8>> segments;
+    VAddr current_vaddr = vaddr;
+    while (size > 0) {
+        const std::size_t page_index = current_vaddr >> CITRA_PAGE_BITS;
+        if (page_table.attributes[page_index] != PageType::Memory) {
+            return {};
+        }
+        const std::size_t segment_size = impl->ContiguousRunSize(page_table, current_vaddr, size);
+        u8* const segment = page_table.pointers[page_index] + (current_vaddr & CITRA_PAGE_MASK);
+        segments.emplace_back(segment, segment_size);
+        current_vaddr += static_cast<VAddr>(segment_size);
+        size -= segment_size;
+    }
+    return segments;
+}
+
 void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_addr,
                              const std::size_t size) {
     auto& page_table = *process.vm_manager.page_table;
     std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> CITRA_PAGE_BITS;
-    std::size_t page_offset = dest_addr & CITRA_PAGE_MASK;
+    VAddr current_vaddr = dest_addr;
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(CITRA_PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr =
-            static_cast<VAddr>((page_index << CITRA_PAGE_BITS) + page_offset);
+        const std::size_t copy_amount =
+            impl->ContiguousRunSize(page_table, current_vaddr, remaining_size);
+        const std::size_t page_index = current_vaddr >> CITRA_PAGE_BITS;
+        const std::size_t page_offset = current_vaddr & CITRA_PAGE_MASK;
 
         switch (page_table.attributes[page_index]) {
         case PageType::Unmapped: {
@@ -969,8 +1323,7 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
+        current_vaddr += static_cast<VAddr>(copy_amount);
         remaining_size -= copy_amount;
     }
 }
@@ -985,13 +1338,13 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
                              std::size_t size) {
     auto& page_table = *src_process.vm_manager.page_table;
     std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> CITRA_PAGE_BITS;
-    std::size_t page_offset = src_addr & CITRA_PAGE_MASK;
+    VAddr current_vaddr = src_addr;
 
     while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(CITRA_PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr =
-            static_cast<VAddr>((page_index << CITRA_PAGE_BITS) + page_offset);
+        const std::size_t copy_amount =
+            impl->ContiguousRunSize(page_table, current_vaddr, remaining_size);
+        const std::size_t page_index = current_vaddr >> CITRA_PAGE_BITS;
+        const std::size_t page_offset = current_vaddr & CITRA_PAGE_MASK;
 
         switch (page_table.attributes[page_index]) {
         case PageType::Unmapped: {
@@ -1019,27 +1372,25 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
+        current_vaddr += static_cast<VAddr>(copy_amount);
         dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
         remaining_size -= copy_amount;
     }
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) const {
-    ASSERT(pointer >= impl->fcram.get() && pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return static_cast<u32>(pointer - impl->fcram.get());
+    ASSERT(pointer >= impl->fcram && pointer <= impl->fcram + Memory::FCRAM_N3DS_SIZE);
+    return static_cast<u32>(pointer - impl->fcram);
 }
 
 u8* MemorySystem::GetFCRAMPointer(std::size_t offset) {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 const u8* MemorySystem::GetFCRAMPointer(std::size_t offset) const {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 MemoryRef MemorySystem::GetFCRAMRef(std::size_t offset) const {
@@ -1047,9 +1398,22 @@ MemoryRef MemorySystem::GetFCRAMRef(std::size_t offset) const {
     return MemoryRef(impl->fcram_mem, offset);
 }
 
+void MemorySystem::DiscardFCRAM(std::size_t offset, std::size_t size) {
+    ASSERT(offset + size <= Memory::FCRAM_N3DS_SIZE);
+    impl->host_memory.Discard(offset, size);
+}
+
 u8* MemorySystem::GetDspMemory(std::size_t offset) const {
     ASSERT(offset <= Memory::DSP_RAM_SIZE);
-    return impl->dsp_ram.get() + offset;
+    return impl->dsp_ram + offset;
+}
+
+std::span<u8> MemorySystem::GetBackingRAM() {
+    return {impl->fcram, impl->host_memory.BackingSize()};
+}
+
+void MemorySystem::SetSerializeRAM(bool serialize) {
+    impl->serialize_ram = serialize;
 }
 
 } // namespace Memory
@@ -5,10 +5,14 @@
 #pragma once
 #include <array>
 #include <cstddef>
+#include <span>
 #include <string>
+#include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 #include "common/common_types.h"
+#include "common/host_memory.h"
 #include "common/memory_ref.h"
 
 namespace Kernel {
@@ -64,6 +68,7 @@ struct PageTable {
             Entry(Pointers& pointers_, VAddr idx_) : pointers(pointers_), idx(idx_) {}
 
             Entry& operator=(MemoryRef value) {
+                pointers.Mirror(idx, value.GetPtr());
                 pointers.raw[idx] = value.GetPtr();
                 pointers.refs[idx] = std::move(value);
                 return *this;
@@ -83,8 +88,12 @@ struct PageTable {
         }
 
     private:
+        /// Mirrors the new pointer of a page to the fastmem arena, if there is one
+        void Mirror(VAddr idx, u8* pointer);
+
         std::array<u8*, PAGE_TABLE_NUM_ENTRIES> raw;
         std::array<MemoryRef, PAGE_TABLE_NUM_ENTRIES> refs;
+        std::unique_ptr<Common::HostMemoryView> fastmem;
         friend struct PageTable;
     };
 
@@ -100,6 +109,18 @@ struct PageTable {
         return pointers.raw;
     }
 
+    /**
+     * Returns the host address range mirroring the pages backed by host memory at their virtual
+     * addresses, so that the JIT can access them directly. Other pages fault on access. Null when
+     * fastmem is not enabled for the page table.
+     */
+    u8* GetFastmemArena() const {
+        return pointers.fastmem ? pointers.fastmem->BasePointer() : nullptr;
+    }
+
+    /// Creates the fastmem arena and mirrors the pages already mapped into it
+    void EnableFastmem(const Common::HostMemory& host_memory);
+
     void Clear();
 
 private:
@@ -568,6 +589,20 @@ public:
      */
     void WriteBlock(VAddr dest_addr, const void* src_buffer, std::size_t size);
 
+    /**
+     * Returns the host memory backing a range of a process' address space, split in the
+     * segments that are contiguous in host memory.
+     *
+     * @param process The process whose address space holds the range.
+     * @param vaddr   The virtual address the range starts at.
+     * @param size    The size of the range, in bytes.
+     *
+     * @returns The segments covering the range in order, or nothing when part of the range is
+     *          unmapped or cached by the rasterizer and must go through ReadBlock/WriteBlock.
+     */
+    std::vector<std::span<u8>> GetHostSegments(const Kernel::Process& process, VAddr vaddr,
+                                               std::size_t size);
+
     /**
      * Zeros a range of bytes within the current process' address space at the specified
      * virtual address.
@@ -608,6 +643,16 @@ public:
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Makes RasterizerMarkRegionCached queue the transitions requested by the calling thread
+     * instead of applying them. The page tables belong to the emulation thread, which keeps
+     * running guest code while other threads create and destroy cached surfaces.
+     */
+    static void SetDeferRasterizerMarks(bool defer);
+
+    /// Applies the transitions queued by other threads, in order. Called by the emulation thread.
+    void ApplyDeferredRasterizerMarks();
+
     /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
     std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr);
 
@@ -635,6 +680,9 @@ public:
     /// Gets a serializable ref to FCRAM with the given offset
     MemoryRef GetFCRAMRef(std::size_t offset) const;
 
+    /// Zeroes a range of FCRAM, giving its whole pages back to the host until they are written
+    void DiscardFCRAM(std::size_t offset, std::size_t size);
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(std::shared_ptr<PageTable> page_table);
 
@@ -644,6 +692,16 @@ public:
     /// Gets pointer to DSP shared memory with given offset
     u8* GetDspMemory(std::size_t offset) const;
 
+    /// Returns the host memory holding all of the emulated RAM: FCRAM, VRAM, the New 3DS extra RAM
+    /// and the DSP RAM.
+    std::span<u8> GetBackingRAM();
+
+    /**
+     * Sets whether serializing this object includes the contents of the emulated RAM. Rewind
+     * snapshots keep the RAM themselves and only need the rest of the memory state.
+     */
+    void SetSerializeRAM(bool serialize);
+
     void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
     /// Returns a reference to the framebuffer address of the currently loaded 3GX plugin.
@@ -690,6 +748,9 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef memory, PageType type);
 
+    /// Switches the pages of the region between cached and uncached in every page table.
+    void MarkRegionCached(PAddr start, u32 size, bool cached);
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl;
@@ -711,3 +772,4 @@ BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::FCRA
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::VRAM>)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::DSP>)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::N3DS>)
+BOOST_CLASS_VERSION(Memory::MemorySystem::Impl, 1)
@@ -2,48 +2,121 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <memory>
+#include <fmt/format.h>
 #include <httplib.h>
 #include "common/logging/log.h"
 #include "core/nus_download.h"
 
 namespace Core::NUS {
 
+constexpr auto HOST = "http://nus.cdn.c.shop.nintendowifi.net";
+
+// Number of times a transfer is attempted before giving up, each retry resumes the transfer
+constexpr u32 MaxAttempts = 4;
+
+// Number of files DownloadAll downloads at the same time
+constexpr std::size_t MaxParallelDownloads = 4;
+
 std::optional<std::vector<u8>> Download(const std::string& path) {
-    constexpr auto HOST = "http://nus.cdn.c.shop.nintendowifi.net";
+    std::vector<u8> data;
+    const bool success = Download(path, [&data](std::span<const u8> chunk) {
+        data.insert(data.end(), chunk.begin(), chunk.end());
+        return true;
+    });
+    if (!success) {
+        return {};
+    }
+    return data;
+}
 
+bool Download(const std::string& path, const DataSink& sink) {
     std::unique_ptr<httplib::Client> client = std::make_unique<httplib::Client>(HOST);
-    if (client == nullptr) {
+    if (client == nullptr || !client->is_valid()) {
         LOG_ERROR(WebService, "Invalid URL {}{}", HOST, path);
-        return {};
+        return false;
     }
 
-    httplib::Request request{
-        .method = "GET",
-        .path = path,
-        // Needed when httplib is included on android
-        .matches = httplib::Match(),
-    };
-
     client->set_follow_location(true);
-    const auto result = client->send(request);
-    if (!result) {
-        LOG_ERROR(WebService, "GET to {}{} returned null", HOST, path);
-        return {};
+    client->set_keep_alive(true);
+
+    u64 received = 0;
+    for (u32 attempt = 0; attempt < MaxAttempts; attempt++) {
+        httplib::Headers headers;
+        if (received != 0) {
+            LOG_WARNING(WebService, "Resuming GET to {}{} at offset {}", HOST, path, received);
+            headers.emplace("Range", fmt::format("bytes={}-", received));
+        }
+
+        // Bytes to drop from the start of the response, when the server ignored the range
+        u64 skip = 0;
+        bool failed = false;
+        const auto result = client->Get(
+            path, headers,
+            [&](const httplib::Response& response) {
+                if (response.status >= 400) {
+                    LOG_ERROR(WebService, "GET to {}{} returned error status code: {}", HOST, path,
+                              response.status);
+                    failed = true;
+                    return false;
+                }
+                if (!response.has_header("content-type")) {
+                    LOG_ERROR(WebService, "GET to {}{} returned no content", HOST, path);
+                    failed = true;
+                    return false;
+                }
+                skip = response.status == 206 ? 0 : received;
+                return true;
+            },
+            [&](const char* data, std::size_t length) {
+                const u64 skipped = std::min<u64>(skip, length);
+                skip -= skipped;
+                const std::span chunk{reinterpret_cast<const u8*>(data) + skipped,
+                                      length - skipped};
+                if (chunk.empty()) {
+                    return true;
+                }
+                if (!sink(chunk)) {
+                    failed = true;
+                    return false;
+                }
+                received += chunk.size();
+                return true;
+            });
+
+        if (result && result->status < 400) {
+            return true;
+        }
+        if (failed) {
+            return false;
+        }
+        LOG_ERROR(WebService, "GET to {}{} failed: {}", HOST, path,
+                  httplib::to_string(result.error()));
     }
+    return false;
+}
 
-    const auto& response = result.value();
-    if (response.status >= 400) {
-        LOG_ERROR(WebService, "GET to {}{} returned error status code: {}", HOST, path,
-                  response.status);
-        return {};
+std::vector<std::optional<std::vector<u8>>> DownloadAll(std::span<const std::string> paths) {
+    std::vector<std::optional<std::vector<u8>>> contents(paths.size());
+    std::atomic<std::size_t> next_path{0};
+    const auto worker = [&] {
+        for (std::size_t i = next_path++; i < paths.size(); i = next_path++) {
+            contents[i] = Download(paths[i]);
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    const std::size_t num_workers = std::min(paths.size(), MaxParallelDownloads);
+    for (std::size_t i = 0; i < num_workers; i++) {
+        workers.push_back(std::async(std::launch::async, worker));
     }
-    if (!response.headers.contains("content-type")) {
-        LOG_ERROR(WebService, "GET to {}{} returned no content", HOST, path);
-        return {};
+    for (auto& future : workers) {
+        future.wait();
     }
-
-    return std::vector<u8>(response.body.begin(), response.body.end());
+    return contents;
 }
 
 } // namespace Core::NUS
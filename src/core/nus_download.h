@@ -4,12 +4,31 @@
 
 #pragma once
 
+#include <functional>
 #include <optional>
+#include <span>
+#include <string>
 #include <vector>
 #include "common/common_types.h"
 
 namespace Core::NUS {
 
+/// Receives downloaded data in order. Returns false to abort the download.
+using DataSink = std::function<bool(std::span<const u8> data)>;
+
 std::optional<std::vector<u8>> Download(const std::string& path);
 
+/**
+ * Downloads a file, handing the data to the sink as it arrives instead of buffering the whole file.
+ * An interrupted transfer is resumed with a range request starting where it stopped.
+ * @returns true if the whole file was passed to the sink
+ */
+bool Download(const std::string& path, const DataSink& sink);
+
+/**
+ * Downloads several files at once.
+ * @returns the contents of each file in the order of the paths, empty for failed downloads
+ */
+std::vector<std::optional<std::vector<u8>>> DownloadAll(std::span<const std::string> paths);
+
 } // namespace Core::NUS
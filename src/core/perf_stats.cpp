@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iterator>
 #include <mutex>
 #include <numeric>
@@ -11,6 +12,7 @@
 #include <thread>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
+#include "common/cpu_affinity.h"
 #include "common/file_util.h"
 #include "common/settings.h"
 #include "core/core_timing.h"
@@ -53,15 +55,30 @@ void PerfStats::BeginSVCProcessing() {
 }
 
 void PerfStats::EndSVCProcessing() {
-    accumulated_svc_time += (Clock::now() - start_svc_time);
+    const auto time = Clock::now() - start_svc_time;
+    accumulated_svc_time += time;
+    frame_times.svc += time;
 }
 
 void PerfStats::BeginIPCProcessing() {
     start_ipc_time = Clock::now();
 }
 
-void PerfStats::EndIPCProcessing() {
-    accumulated_ipc_time += (Clock::now() - start_ipc_time);
+void PerfStats::EndIPCProcessing(std::string_view service_name) {
+    const auto time = Clock::now() - start_ipc_time;
+    accumulated_ipc_time += time;
+
+    std::scoped_lock lock{object_mutex};
+    frame_times.ipc += time;
+    const auto it = std::find_if(frame_times.services.begin(), frame_times.services.end(),
+                                 [service_name](const auto& service) {
+                                     return service.first == service_name;
+                                 });
+    if (it != frame_times.services.end()) {
+        it->second += time;
+    } else {
+        frame_times.services.emplace_back(service_name, time);
+    }
 }
 
 void PerfStats::BeginGPUProcessing() {
@@ -69,7 +86,9 @@ void PerfStats::BeginGPUProcessing() {
 }
 
 void PerfStats::EndGPUProcessing() {
-    accumulated_gpu_time += (Clock::now() - start_gpu_time);
+    const auto time = Clock::now() - start_gpu_time;
+    accumulated_gpu_time += time;
+    frame_times.gpu += time;
 }
 
 void PerfStats::StartSwap() {
@@ -77,7 +96,49 @@ void PerfStats::StartSwap() {
 }
 
 void PerfStats::EndSwap() {
-    accumulated_swap_time += (Clock::now() - start_swap_time);
+    const auto time = Clock::now() - start_swap_time;
+    accumulated_swap_time += time;
+    frame_times.swap += time;
+}
+
+void PerfStats::ReportAudioTimes(const AudioTimes& times) {
+    std::scoped_lock lock{object_mutex};
+
+    accumulated_audio_times.source_decode += times.source_decode;
+    accumulated_audio_times.mixing += times.mixing;
+    accumulated_audio_times.time_stretch += times.time_stretch;
+    accumulated_audio_times.sink_enqueue += times.sink_enqueue;
+    frame_times.audio +=
+        times.source_decode + times.mixing + times.time_stretch + times.sink_enqueue;
+}
+
+void PerfStats::ReportGpuTimes(const GpuTimes& times) {
+    std::scoped_lock lock{object_mutex};
+
+    accumulated_host_gpu_times.busy += times.busy;
+    for (std::size_t i = 0; i < GpuPassCount; i++) {
+        accumulated_host_gpu_times.passes[i] += times.passes[i];
+    }
+    host_gpu_frames++;
+}
+
+void PerfStats::ReportRomFSCacheStats(u64 hits, u64 misses) {
+    std::scoped_lock lock{object_mutex};
+
+    romfs_cache_hits += hits;
+    romfs_cache_misses += misses;
+}
+
+void PerfStats::AddArticBaseLatency(std::chrono::nanoseconds latency) {
+    std::scoped_lock lock{object_mutex};
+
+    accumulated_artic_latency += latency;
+    std::size_t bucket = 0;
+    for (auto limit = std::chrono::milliseconds{1};
+         bucket < ArticLatencyBuckets - 1 && latency >= limit; limit *= 2) {
+        bucket++;
+    }
+    artic_latency_histogram[bucket]++;
 }
 
 void PerfStats::BeginSystemFrame() {
@@ -98,11 +159,86 @@ void PerfStats::EndSystemFrame() {
     accumulated_frametime += frame_time;
     system_frames += 1;
 
+    // Lets Android clock the emulation threads just high enough for the current speed limit
+    const double speed_limit = Settings::GetFrameLimit();
+    if (speed_limit != 0) {
+        const DoubleSecs target{FRAME_LENGTH * 100.0 / speed_limit};
+        Common::ReportFrameWorkDuration(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(frame_time),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(target));
+    }
+
     // TODO: Track previous frame times in a less stupid way. -OS
     previous_previous_frame_length = previous_frame_length;
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
+
+    RecordFrameBreakdown(frame_time);
+}
+
+void PerfStats::RecordFrameBreakdown(Clock::duration frame_time) {
+    const auto to_ms = [](Clock::duration time) {
+        return std::max(std::chrono::duration<float, std::milli>(time).count(), 0.0f);
+    };
+    const auto stage_time = [](FrameStage stage) {
+        return Clock::duration{renderer_stage_times[static_cast<std::size_t>(stage)].exchange(
+            0, std::memory_order_relaxed)};
+    };
+
+    const auto submit = stage_time(FrameStage::RasterizerSubmit);
+    const auto compile = stage_time(FrameStage::PipelineCompile);
+    const auto upload = stage_time(FrameStage::TextureUpload);
+
+    FrameBreakdown& frame = frame_history[frame_history_index];
+    frame = {};
+    frame.frame_time = to_ms(frame_time);
+    const auto set_stage = [&frame, &to_ms](FrameStage stage, Clock::duration time) {
+        frame.stages[static_cast<std::size_t>(stage)] = to_ms(time);
+    };
+    set_stage(FrameStage::CPU, frame_time - frame_times.svc - frame_times.swap - frame_times.audio);
+    set_stage(FrameStage::Kernel, frame_times.svc - frame_times.ipc);
+    set_stage(FrameStage::Services, frame_times.ipc - frame_times.gpu);
+    // Draws fetch their surfaces and pipelines, so uploads and compiles are usually nested in them
+    set_stage(FrameStage::PICA, frame_times.gpu - submit);
+    set_stage(FrameStage::RasterizerSubmit, submit - compile - upload);
+    set_stage(FrameStage::PipelineCompile, compile);
+    set_stage(FrameStage::TextureUpload, upload);
+    set_stage(FrameStage::Audio, frame_times.audio);
+    set_stage(FrameStage::Present, frame_times.swap);
+
+    const auto slowest = std::max_element(
+        frame_times.services.begin(), frame_times.services.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+    if (slowest != frame_times.services.end()) {
+        std::memcpy(frame.slowest_service.data(), slowest->first.data(),
+                    std::min(slowest->first.size(), frame.slowest_service.size()));
+        frame.slowest_service_time = to_ms(slowest->second);
+    }
+    frame.stutter = frame.frame_time > GetFrameBudget();
+
+    frame_history_index = (frame_history_index + 1) % FrameHistorySize;
+    frame_history_count = std::min(frame_history_count + 1, FrameHistorySize);
+    frame_times.svc = frame_times.ipc = frame_times.gpu = Clock::duration::zero();
+    frame_times.swap = frame_times.audio = Clock::duration::zero();
+    frame_times.services.clear();
+}
+
+double PerfStats::GetFrameBudget() {
+    return FRAME_LENGTH * 1000.0;
+}
+
+std::vector<PerfStats::FrameBreakdown> PerfStats::GetFrameHistory() const {
+    std::scoped_lock lock{object_mutex};
+
+    std::vector<FrameBreakdown> history;
+    history.reserve(frame_history_count);
+    const std::size_t first =
+        (frame_history_index + FrameHistorySize - frame_history_count) % FrameHistorySize;
+    for (std::size_t i = 0; i < frame_history_count; i++) {
+        history.push_back(frame_history[(first + i) % FrameHistorySize]);
+    }
+    return history;
 }
 
 void PerfStats::EndGameFrame() {
@@ -165,6 +301,41 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     last_stats.emulation_speed = system_us_per_second.count() / 1'000'000.0;
     last_stats.artic_transmitted = static_cast<double>(artic_transmitted) / interval;
     last_stats.artic_events.raw = artic_events.raw | prev_artic_event.raw;
+    const u32 artic_requests = std::accumulate(artic_latency_histogram.begin(),
+                                               artic_latency_histogram.end(), u32{0});
+    last_stats.artic_latency =
+        artic_requests ? std::chrono::duration<double>(accumulated_artic_latency).count() /
+                             artic_requests
+                       : 0;
+    last_stats.artic_latency_histogram = artic_latency_histogram;
+    last_stats.texture_memory = texture_memory;
+    last_stats.peak_texture_memory = peak_texture_memory;
+    last_stats.host_memory = Common::MemoryAccounting::GetUsage();
+    last_stats.peak_host_memory = Common::MemoryAccounting::GetPeakTotal();
+    last_stats.present_latency = static_cast<double>(present_latency) / 1'000'000'000.0;
+    last_stats.audio_latency = static_cast<double>(audio_latency) / 1'000'000'000.0;
+
+    const auto per_frame = [this](Clock::duration time) {
+        return system_frames
+                   ? duration_cast<DoubleSecs>(time).count() / static_cast<double>(system_frames)
+                   : 0;
+    };
+    last_stats.time_audio_source = per_frame(accumulated_audio_times.source_decode);
+    last_stats.time_audio_mixing = per_frame(accumulated_audio_times.mixing);
+    last_stats.time_audio_stretch = per_frame(accumulated_audio_times.time_stretch);
+    last_stats.time_audio_enqueue = per_frame(accumulated_audio_times.sink_enqueue);
+    const u64 romfs_cache_lookups = romfs_cache_hits + romfs_cache_misses;
+    last_stats.romfs_cache_hit_rate =
+        romfs_cache_lookups ? static_cast<double>(romfs_cache_hits) / romfs_cache_lookups : 0;
+    const auto per_gpu_frame = [this](Clock::duration time) {
+        return host_gpu_frames
+                   ? duration_cast<DoubleSecs>(time).count() / static_cast<double>(host_gpu_frames)
+                   : 0;
+    };
+    last_stats.time_host_gpu = per_gpu_frame(accumulated_host_gpu_times.busy);
+    for (std::size_t i = 0; i < GpuPassCount; i++) {
+        last_stats.time_host_gpu_passes[i] = per_gpu_frame(accumulated_host_gpu_times.passes[i]);
+    }
 
     // Reset counters
     reset_point = now;
@@ -175,8 +346,15 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_ipc_time = Clock::duration::zero();
     accumulated_gpu_time = Clock::duration::zero();
     accumulated_swap_time = Clock::duration::zero();
+    accumulated_audio_times = {};
+    accumulated_host_gpu_times = {};
+    host_gpu_frames = 0;
+    romfs_cache_hits = 0;
+    romfs_cache_misses = 0;
     game_frames = 0;
     artic_transmitted = 0;
+    accumulated_artic_latency = std::chrono::nanoseconds::zero();
+    artic_latency_histogram.fill(0);
     prev_artic_event.raw &= artic_events.raw;
 
     return last_stats;
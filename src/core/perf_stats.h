@@ -9,8 +9,12 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "common/thread.h"
 
 namespace Core {
@@ -26,6 +30,10 @@ public:
 
     using Clock = std::chrono::high_resolution_clock;
 
+    /// Number of buckets of the Artic Base latency histogram. Bucket N counts the requests that
+    /// took less than 2^N milliseconds, the last one counts everything slower.
+    static constexpr std::size_t ArticLatencyBuckets = 8;
+
     enum class PerfArticEventBits {
         NONE = 0,
         ARTIC_SAVE_DATA = (1 << 0),
@@ -49,6 +57,104 @@ public:
         }
     };
 
+    /// Host time spent in each stage of the audio pipeline
+    struct AudioTimes {
+        Clock::duration source_decode{};
+        Clock::duration mixing{};
+        Clock::duration time_stretch{};
+        Clock::duration sink_enqueue{};
+    };
+
+    /// Passes of the host GPU timed by the renderer
+    enum class GpuPass : u32 {
+        /// Draws of the emulated GPU
+        Scene,
+        /// Draws of the emulated GPU to shadow maps
+        Shadow,
+        /// Surface copies, clears, blits, reinterpretations, uploads and downloads
+        Blit,
+        /// Texture scaling and mipmap generation
+        TextureFilter,
+        /// Drawing the screens to the window
+        Present,
+        Count,
+    };
+    static constexpr std::size_t GpuPassCount = static_cast<std::size_t>(GpuPass::Count);
+
+    /// Host GPU time of a frame, measured with timestamp queries
+    struct GpuTimes {
+        /// Time the GPU was executing the frame, including work not part of a timed pass
+        Clock::duration busy{};
+        std::array<Clock::duration, GpuPassCount> passes{};
+    };
+
+    /// Stages of the per-frame breakdown. Stages nested in another one are subtracted from it, so
+    /// the stages of a frame add up to its frame time.
+    enum class FrameStage : u32 {
+        /// JIT execution and everything not covered by another stage
+        CPU,
+        /// SVC processing, excluding IPC
+        Kernel,
+        /// HLE service IPC processing, excluding GPU command processing
+        Services,
+        /// PICA command processing, excluding the renderer stages below
+        PICA,
+        /// Rasterizer draws, excluding the pipeline compiles and texture uploads they trigger
+        RasterizerSubmit,
+        PipelineCompile,
+        TextureUpload,
+        Audio,
+        /// Renderer::SwapBuffers, including waiting for the host GPU
+        Present,
+        Count,
+    };
+    static constexpr std::size_t FrameStageCount = static_cast<std::size_t>(FrameStage::Count);
+
+    /// Number of frames kept in the frame breakdown history
+    static constexpr std::size_t FrameHistorySize = 300;
+
+    struct FrameBreakdown {
+        /// Walltime in milliseconds of the system frame, excluding frame limiting
+        float frame_time = 0;
+        /// Walltime in milliseconds spent in each stage
+        std::array<float, FrameStageCount> stages{};
+        /// Service that spent the most time handling IPC requests during the frame
+        std::array<char, 8> slowest_service{};
+        /// Walltime in milliseconds the slowest service spent handling IPC requests
+        float slowest_service_time = 0;
+        /// Whether the frame went over the budget of one LCD refresh
+        bool stutter = false;
+    };
+
+    /// Walltime budget of a frame in milliseconds
+    static double GetFrameBudget();
+
+    /**
+     * Adds time spent in a renderer stage to the current frame. Unlike the other timing functions
+     * this is static, as pipelines and textures are also built on threads that have no access to
+     * the System instance.
+     */
+    static void AddRendererTime(FrameStage stage, Clock::duration time) {
+        renderer_stage_times[static_cast<std::size_t>(stage)].fetch_add(
+            time.count(), std::memory_order_relaxed);
+    }
+
+    /// Measures the lifetime of the object as time spent in a renderer stage
+    class ScopedRendererTimer {
+    public:
+        explicit ScopedRendererTimer(FrameStage stage_) : stage{stage_} {}
+        ~ScopedRendererTimer() {
+            AddRendererTime(stage, Clock::now() - start);
+        }
+
+        ScopedRendererTimer(const ScopedRendererTimer&) = delete;
+        ScopedRendererTimer& operator=(const ScopedRendererTimer&) = delete;
+
+    private:
+        FrameStage stage;
+        Clock::time_point start = Clock::now();
+    };
+
     struct Results {
         /// System FPS (LCD VBlanks) in Hz
         double system_fps;
@@ -73,12 +179,43 @@ public:
         double artic_transmitted = 0;
         /// Artic base events
         PerfArticEvents artic_events{};
+        /// Mean walltime in seconds between sending an Artic Base request and its response
+        double artic_latency = 0;
+        /// Number of Artic Base requests per latency bucket
+        std::array<u32, ArticLatencyBuckets> artic_latency_histogram{};
+        /// Host memory used by cached textures in bytes
+        u64 texture_memory = 0;
+        /// Highest host memory used by cached textures in bytes
+        u64 peak_texture_memory = 0;
+        /// Host memory held by each subsystem, current and peak bytes
+        Common::MemoryAccounting::Usage host_memory{};
+        /// Highest total host memory held by the accounted subsystems in bytes
+        u64 peak_host_memory = 0;
+        /// Walltime in seconds between queueing a frame for presentation and its display, 0 when
+        /// the presentation engine does not report it
+        double present_latency = 0;
+        /// Walltime in seconds between the DSP outputting an audio frame and its playback
+        double audio_latency = 0;
+        // Walltime in seconds of the vblank interval spent decoding the DSP sources
+        double time_audio_source = 0;
+        // Walltime in seconds of the vblank interval spent mixing the DSP sources and outputs
+        double time_audio_mixing = 0;
+        // Walltime in seconds of the vblank interval spent stretching or resampling the output
+        double time_audio_stretch = 0;
+        // Walltime in seconds of the vblank interval spent queueing frames for the sink
+        double time_audio_enqueue = 0;
+        /// Fraction of the RomFS cache lookups that hit, 0 when there were none
+        double romfs_cache_hit_rate = 0;
+        /// Mean time in seconds the host GPU was busy with a frame, 0 when it is not measured
+        double time_host_gpu = 0;
+        /// Mean time in seconds the host GPU spent in each pass of a frame
+        std::array<double, GpuPassCount> time_host_gpu_passes{};
     };
 
     void BeginSVCProcessing();
     void EndSVCProcessing();
     void BeginIPCProcessing();
-    void EndIPCProcessing();
+    void EndIPCProcessing(std::string_view service_name);
     void BeginGPUProcessing();
     void EndGPUProcessing();
     void StartSwap();
@@ -91,6 +228,9 @@ public:
 
     Results GetLastStats();
 
+    /// Returns the breakdown of the most recent frames, oldest first
+    std::vector<FrameBreakdown> GetFrameHistory() const;
+
     /**
      * Returns the arithmetic mean of all frametime values stored in the performance history.
      */
@@ -112,6 +252,35 @@ public:
         artic_transmitted += bytes;
     }
 
+    /// Adds the round trip time of a completed Artic Base request.
+    void AddArticBaseLatency(std::chrono::nanoseconds latency);
+
+    void ReportTextureMemoryUsage(u64 bytes) {
+        Common::MemoryAccounting::SetUsage(Common::MemoryAccounting::Category::TextureCache, bytes);
+        texture_memory = bytes;
+        u64 peak = peak_texture_memory;
+        while (bytes > peak && !peak_texture_memory.compare_exchange_weak(peak, bytes)) {
+        }
+    }
+
+    void ReportPresentLatency(std::chrono::nanoseconds latency) {
+        present_latency = latency.count();
+    }
+
+    void ReportAudioLatency(std::chrono::nanoseconds latency) {
+        audio_latency = latency.count();
+    }
+
+    /// Adds the host time the audio pipeline spent in each stage since the previous report.
+    void ReportAudioTimes(const AudioTimes& times);
+
+    /// Adds the RomFS cache lookups made since the previous report.
+    void ReportRomFSCacheStats(u64 hits, u64 misses);
+
+    /// Adds the host GPU times of a frame. Frames are reported a few frames late, once the GPU
+    /// has finished them.
+    void ReportGpuTimes(const GpuTimes& times);
+
     void ReportPerfArticEvent(PerfArticEventBits event, bool set) {
         if (set) {
             artic_events.Set(event, set);
@@ -122,6 +291,9 @@ public:
     }
 
 private:
+    /// Closes the breakdown of the current system frame. Called with object_mutex held.
+    void RecordFrameBreakdown(Clock::duration frame_time);
+
     mutable std::mutex object_mutex;
 
     /// Title ID for the game that is running. 0 if there is no game running yet
@@ -150,6 +322,15 @@ private:
 
     PerfArticEvents prev_artic_event;
 
+    /// Host memory used by cached textures, reported by the renderer every frame
+    std::atomic<u64> texture_memory = 0;
+    /// Highest host memory used by cached textures since the stats were created
+    std::atomic<u64> peak_texture_memory = 0;
+    /// Latest present to display latency reported by the renderer, in nanoseconds
+    std::atomic<s64> present_latency = 0;
+    /// Latest audio output latency reported by the DSP, in nanoseconds
+    std::atomic<s64> audio_latency = 0;
+
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
     /// Point when the current system frame began
@@ -171,6 +352,35 @@ private:
     Clock::time_point start_swap_time = reset_point;
     Clock::duration accumulated_swap_time = Clock::duration::zero();
 
+    AudioTimes accumulated_audio_times{};
+
+    GpuTimes accumulated_host_gpu_times{};
+    u32 host_gpu_frames = 0;
+
+    /// Time spent in each timed section during the current system frame
+    struct FrameTimes {
+        Clock::duration svc{};
+        Clock::duration ipc{};
+        Clock::duration gpu{};
+        Clock::duration swap{};
+        Clock::duration audio{};
+        /// IPC processing time of each service that handled a request
+        std::vector<std::pair<std::string, Clock::duration>> services;
+    };
+    FrameTimes frame_times;
+
+    static inline std::array<std::atomic<Clock::rep>, FrameStageCount> renderer_stage_times{};
+
+    std::array<FrameBreakdown, FrameHistorySize> frame_history{};
+    std::size_t frame_history_index = 0;
+    std::size_t frame_history_count = 0;
+
+    u64 romfs_cache_hits = 0;
+    u64 romfs_cache_misses = 0;
+
+    std::chrono::nanoseconds accumulated_artic_latency{0};
+    std::array<u32, ArticLatencyBuckets> artic_latency_histogram{};
+
     /// Last recorded performance statistics.
     Results last_stats;
 };
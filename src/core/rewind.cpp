@@ -0,0 +1,155 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "core/memory.h"
+#include "core/rewind.h"
+
+namespace Core {
+
+namespace {
+
+constexpr std::size_t PageSize = Memory::CITRA_PAGE_SIZE;
+
+u64 HashPage(const u8* page) {
+    return Common::ComputeHash64(page, PageSize);
+}
+
+u64 ZeroPageHash() {
+    static const u64 hash = [] {
+        const std::array<u8, PageSize> zero{};
+        return HashPage(zero.data());
+    }();
+    return hash;
+}
+
+} // Anonymous namespace
+
+std::size_t RewindBuffer::Snapshot::Size() const {
+    return state.size() + pages.size() * sizeof(u32) + data.size();
+}
+
+RewindBuffer::RewindBuffer(std::size_t budget_)
+    : budget{budget_}, accounting{Common::MemoryAccounting::Category::Savestates, 0} {}
+
+RewindBuffer::~RewindBuffer() = default;
+
+void RewindBuffer::Push(std::string state, std::span<const u8> ram) {
+    const std::size_t num_pages = ram.size() / PageSize;
+    if (page_hashes.size() != num_pages) {
+        Clear();
+        page_hashes.assign(num_pages, ZeroPageHash());
+    }
+
+    Snapshot snapshot{std::move(state)};
+    for (u32 page = 0; page < num_pages; ++page) {
+        const u8* const src = ram.data() + page * PageSize;
+        const u64 hash = HashPage(src);
+        if (hash == page_hashes[page]) {
+            continue;
+        }
+        page_hashes[page] = hash;
+        snapshot.pages.push_back(page);
+        snapshot.data.insert(snapshot.data.end(), src, src + PageSize);
+    }
+
+    usage += snapshot.Size();
+    snapshots.push_back(std::move(snapshot));
+    Trim();
+    accounting.Resize(usage);
+}
+
+void RewindBuffer::Pop(std::span<u8> ram) {
+    ASSERT(!snapshots.empty());
+    const std::size_t num_pages = ram.size() / PageSize;
+    ASSERT(page_hashes.size() == num_pages);
+
+    // Walk back from the newest snapshot, the first copy of a page found is the one it had then.
+    std::vector<bool> restored(num_pages);
+    for (std::size_t i = snapshots.size(); i-- > 0;) {
+        const Snapshot& snapshot = snapshots[i];
+        for (std::size_t j = 0; j < snapshot.pages.size(); ++j) {
+            const u32 page = snapshot.pages[j];
+            if (!restored[page]) {
+                restored[page] = true;
+                std::memcpy(ram.data() + page * PageSize, snapshot.data.data() + j * PageSize,
+                            PageSize);
+            }
+        }
+    }
+    for (u32 page = 0; page < num_pages; ++page) {
+        if (!restored[page]) {
+            std::memset(ram.data() + page * PageSize, 0, PageSize);
+        }
+    }
+
+    const Snapshot snapshot = std::move(snapshots.back());
+    snapshots.pop_back();
+    usage -= snapshot.Size();
+    accounting.Resize(usage);
+
+    // The next snapshot is compared against the one that is now the newest.
+    for (const u32 page : snapshot.pages) {
+        const u8* const previous =
+            snapshots.empty() ? nullptr : FindPage(snapshots.size() - 1, page);
+        page_hashes[page] = previous ? HashPage(previous) : ZeroPageHash();
+    }
+}
+
+void RewindBuffer::Clear() {
+    snapshots.clear();
+    page_hashes.clear();
+    usage = 0;
+    accounting.Resize(0);
+}
+
+const u8* RewindBuffer::FindPage(std::size_t newest, u32 page) const {
+    for (std::size_t i = newest + 1; i-- > 0;) {
+        const Snapshot& snapshot = snapshots[i];
+        const auto it = std::lower_bound(snapshot.pages.begin(), snapshot.pages.end(), page);
+        if (it != snapshot.pages.end() && *it == page) {
+            return snapshot.data.data() + (it - snapshot.pages.begin()) * PageSize;
+        }
+    }
+    return nullptr;
+}
+
+void RewindBuffer::Trim() {
+    while (usage > budget && snapshots.size() > 1) {
+        const Snapshot& oldest = snapshots[0];
+        Snapshot& next = snapshots[1];
+        usage -= oldest.Size() + next.Size();
+
+        // Both page lists are sorted, merge them keeping the newer copy of shared pages.
+        std::vector<u32> pages;
+        std::vector<u8> data;
+        pages.reserve(oldest.pages.size() + next.pages.size());
+        data.reserve(oldest.data.size() + next.data.size());
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < oldest.pages.size() || j < next.pages.size()) {
+            const bool take_next = j < next.pages.size() &&
+                                   (i == oldest.pages.size() || next.pages[j] <= oldest.pages[i]);
+            const Snapshot& source = take_next ? next : oldest;
+            const std::size_t index = take_next ? j++ : i++;
+            if (take_next && i < oldest.pages.size() && oldest.pages[i] == next.pages[index]) {
+                ++i;
+            }
+            const u8* const src = source.data.data() + index * PageSize;
+            pages.push_back(source.pages[index]);
+            data.insert(data.end(), src, src + PageSize);
+        }
+        next.pages = std::move(pages);
+        next.data = std::move(data);
+
+        usage += next.Size();
+        snapshots.pop_front();
+    }
+}
+
+} // namespace Core
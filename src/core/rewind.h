@@ -0,0 +1,91 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <span>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+
+namespace Core {
+
+/**
+ * Ring buffer of snapshots used to rewind the emulation.
+ *
+ * Each snapshot holds the serialized system state without the emulated RAM, plus the RAM pages
+ * that changed since the previous snapshot. Changes are found by comparing a hash of every page
+ * with the one taken for the previous snapshot, which also catches the writes the JIT makes
+ * through fastmem without going through MemorySystem. The state before the oldest snapshot is
+ * taken to be all zeros, so zero pages are never stored.
+ *
+ * When the buffer exceeds its budget, the oldest snapshot is folded into the next one, keeping the
+ * pages it has that the next one lacks.
+ */
+class RewindBuffer {
+public:
+    /// @param budget Maximum number of bytes the snapshots may use.
+    explicit RewindBuffer(std::size_t budget);
+    ~RewindBuffer();
+
+    /**
+     * Records a snapshot.
+     * @param state Serialized state of everything but the RAM.
+     * @param ram The emulated RAM, which must be the same size on every call.
+     */
+    void Push(std::string state, std::span<const u8> ram);
+
+    /// Returns the serialized state of the newest snapshot. The buffer must not be empty.
+    const std::string& NewestState() const {
+        return snapshots.back().state;
+    }
+
+    /**
+     * Copies the RAM contents of the newest snapshot to `ram` and removes it. The buffer must not
+     * be empty.
+     */
+    void Pop(std::span<u8> ram);
+
+    void Clear();
+
+    bool Empty() const {
+        return snapshots.empty();
+    }
+
+    std::size_t Count() const {
+        return snapshots.size();
+    }
+
+    /// Returns the number of bytes used by the snapshots.
+    std::size_t MemoryUsage() const {
+        return usage;
+    }
+
+private:
+    struct Snapshot {
+        std::string state;
+        std::vector<u32> pages;
+        std::vector<u8> data;
+
+        std::size_t Size() const;
+    };
+
+    /// Finds the newest copy of a page in the snapshots up to and including `newest`.
+    const u8* FindPage(std::size_t newest, u32 page) const;
+
+    /// Folds the oldest snapshot into the next one until the budget is respected.
+    void Trim();
+
+    std::size_t budget;
+    std::size_t usage = 0;
+    Common::MemoryAccounting::Allocation accounting;
+    std::deque<Snapshot> snapshots;
+
+    /// Hash of every page of the RAM as of the newest snapshot.
+    std::vector<u64> page_hashes;
+};
+
+} // namespace Core
@@ -17,6 +17,11 @@ enum class PacketType : u32 {
     WriteMemory = 2,
     ProcessList = 3,
     SetGetProcess = 4,
+    IPCLatencies = 5,
+    BatchReadMemory = 6,
+    SubscribeMemory = 7,
+    UnsubscribeMemory = 8,
+    MemoryChanged = 9,
 };
 
 struct PacketHeader {
@@ -33,6 +38,19 @@ struct ProcessInfo {
     std::array<u8, 8> process_name;
 };
 static_assert(sizeof(ProcessInfo) == 0x14, "Incorrect ProcessInfo size");
+
+constexpr u32 IPC_LATENCY_BUCKETS = 16;
+
+struct IPCLatencyInfo {
+    std::array<u8, 8> service_name;
+    u32 command_id;
+    u32 calls;
+    u64 total_ns;
+    // Bucket 0 counts the calls under 1us, bucket i the calls in [2^(i-1), 2^i) us and the
+    // last one every slower call
+    std::array<u32, IPC_LATENCY_BUCKETS> buckets;
+};
+static_assert(sizeof(IPCLatencyInfo) == 0x58, "Incorrect IPCLatencyInfo size");
 #pragma pack(pop)
 
 constexpr u32 CURRENT_VERSION = 1;
@@ -41,6 +59,12 @@ constexpr u32 MAX_PACKET_DATA_SIZE = 1024;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_PROCESSES_IN_LIST = (MAX_PACKET_DATA_SIZE - sizeof(u32)) / sizeof(ProcessInfo);
+constexpr u32 MAX_IPC_LATENCIES_IN_LIST =
+    (MAX_PACKET_DATA_SIZE - sizeof(u32)) / sizeof(IPCLatencyInfo);
+constexpr u32 MAX_BATCH_READ_RANGES = (MAX_PACKET_DATA_SIZE - sizeof(u32)) / (sizeof(u32) * 2);
+constexpr u32 MAX_MEMORY_SUBSCRIPTIONS = 32;
+// MemoryChanged notifications carry the offset and size of the changed span before its bytes
+constexpr u32 MAX_SUBSCRIPTION_SIZE = MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2);
 
 class Packet {
 public:
@@ -80,6 +104,10 @@ public:
         send_reply_callback(*this);
     }
 
+    const std::function<void(Packet&)>& GetReplyCallback() const {
+        return send_reply_callback;
+    }
+
 private:
     struct PacketHeader header;
     std::array<u8, MAX_PACKET_DATA_SIZE> packet_data;
@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/service/service.h"
 #include "core/memory.h"
 #include "core/rpc/packet.h"
 #include "core/rpc/rpc_server.h"
@@ -19,24 +21,33 @@ RPCServer::RPCServer(Core::System& system_) : system{system_} {
 
 RPCServer::~RPCServer() = default;
 
+bool RPCServer::ReadMemory(u32 address, u8* dest, u32 size) {
+    // Note: Memory read occurs asynchronously from the state of the emulator
+    const u32 pid = selected_pid;
+    if (pid == 0xFFFFFFFF) {
+        system.Memory().ReadBlock(address, dest, size);
+        return true;
+    }
+    auto process = system.Kernel().GetProcessById(pid);
+    if (!process) {
+        return false;
+    }
+    system.Memory().ReadBlock(*process, address, dest, size);
+    return true;
+}
+
 void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
     if (data_size > MAX_READ_SIZE) {
         return;
     }
     u32 read_size = data_size;
 
-    // Note: Memory read occurs asynchronously from the state of the emulator
     if (selected_pid == 0xFFFFFFFF) {
         LOG_ERROR(RPC_Server, "No target process selected, memory access may be invalid.");
-        system.Memory().ReadBlock(address, packet.GetPacketData().data(), data_size);
-    } else {
-        auto process = system.Kernel().GetProcessById(selected_pid);
-        if (process) {
-            system.Memory().ReadBlock(*process, address, packet.GetPacketData().data(), data_size);
-        } else {
-            LOG_ERROR(RPC_Server, "Selected process does not exist.");
-            read_size = 0;
-        }
+    }
+    if (!ReadMemory(address, packet.GetPacketData().data(), data_size)) {
+        LOG_ERROR(RPC_Server, "Selected process does not exist.");
+        read_size = 0;
     }
 
     packet.SetPacketDataSize(read_size);
@@ -104,8 +115,9 @@ void RPCServer::HandleSetGetProcess(Packet& packet, u32 operation, u32 process_i
 
     if (operation == 0) {
         // Get
-        memcpy(out_data + written_bytes, &selected_pid, sizeof(selected_pid));
-        written_bytes += sizeof(selected_pid);
+        const u32 pid = selected_pid;
+        memcpy(out_data + written_bytes, &pid, sizeof(pid));
+        written_bytes += sizeof(pid);
     } else {
         // Set
         selected_pid = process_id;
@@ -115,6 +127,159 @@ void RPCServer::HandleSetGetProcess(Packet& packet, u32 operation, u32 process_i
     packet.SendReply();
 }
 
+void RPCServer::HandleIPCLatencies(Packet& packet, u32 start_index, u32 max_amount) {
+    using Service::ServiceFrameworkBase;
+    static_assert(ServiceFrameworkBase::LatencyBuckets == IPC_LATENCY_BUCKETS);
+
+    // Commands are listed by service name, then by command id
+    std::vector<IPCLatencyInfo> latencies;
+    const auto services = system.ServiceManager().GetServices<ServiceFrameworkBase>();
+    for (const auto& [name, service] : services) {
+        for (const auto& command : service->GetCommandLatencies()) {
+            IPCLatencyInfo& info = latencies.emplace_back();
+            std::memcpy(info.service_name.data(), name.data(),
+                        std::min(name.size(), info.service_name.size()));
+            info.command_id = command.command_id;
+            info.calls = static_cast<u32>(command.calls);
+            info.total_ns = command.total_ns;
+            for (std::size_t i = 0; i < IPC_LATENCY_BUCKETS; i++) {
+                info.buckets[i] = static_cast<u32>(command.buckets[i]);
+            }
+        }
+    }
+
+    const u32 start = std::min(start_index, static_cast<u32>(latencies.size()));
+    const u32 end = std::min(start + max_amount, static_cast<u32>(latencies.size()));
+    const u32 count = std::min(end - start, MAX_IPC_LATENCIES_IN_LIST);
+
+    u8* out_data = packet.GetPacketData().data();
+    u32 written_bytes = 0;
+
+    memcpy(out_data + written_bytes, &count, sizeof(count));
+    written_bytes += sizeof(count);
+
+    memcpy(out_data + written_bytes, latencies.data() + start, count * sizeof(IPCLatencyInfo));
+    written_bytes += count * sizeof(IPCLatencyInfo);
+
+    packet.SetPacketDataSize(written_bytes);
+    packet.SendReply();
+}
+
+void RPCServer::HandleBatchReadMemory(Packet& packet, u32 count, std::span<const u8> ranges) {
+    u8* out_data = packet.GetPacketData().data();
+    u32 written_bytes = 0;
+
+    // All ranges are validated up front so that a reply never holds a partial batch
+    u32 total_size = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 size = 0;
+        std::memcpy(&size, ranges.data() + i * sizeof(u32) * 2 + sizeof(u32), sizeof(size));
+        total_size += size;
+        if (size > MAX_READ_SIZE || total_size > MAX_READ_SIZE) {
+            LOG_ERROR(RPC_Server, "Batch read of {} ranges exceeds the maximum reply size", count);
+            packet.SetPacketDataSize(0);
+            packet.SendReply();
+            return;
+        }
+    }
+
+    if (selected_pid == 0xFFFFFFFF) {
+        LOG_ERROR(RPC_Server, "No target process selected, memory access may be invalid.");
+    }
+    for (u32 i = 0; i < count; i++) {
+        u32 address = 0;
+        u32 size = 0;
+        std::memcpy(&address, ranges.data() + i * sizeof(u32) * 2, sizeof(address));
+        std::memcpy(&size, ranges.data() + i * sizeof(u32) * 2 + sizeof(u32), sizeof(size));
+        if (!ReadMemory(address, out_data + written_bytes, size)) {
+            LOG_ERROR(RPC_Server, "Selected process does not exist.");
+            written_bytes = 0;
+            break;
+        }
+        written_bytes += size;
+    }
+
+    packet.SetPacketDataSize(written_bytes);
+    packet.SendReply();
+}
+
+void RPCServer::HandleSubscribeMemory(Packet& packet, u32 address, u32 size) {
+    u8* out_data = packet.GetPacketData().data();
+    u32 written_bytes = 0;
+
+    {
+        std::scoped_lock lock{subscription_mutex};
+        if (subscriptions.size() < MAX_MEMORY_SUBSCRIPTIONS) {
+            // The snapshot starts out empty, so the first notification carries the whole range
+            const u32 id = next_subscription_id++;
+            subscriptions.push_back({id, address, size, {}, packet.GetReplyCallback()});
+
+            memcpy(out_data + written_bytes, &id, sizeof(id));
+            written_bytes += sizeof(id);
+        } else {
+            LOG_ERROR(RPC_Server, "Too many memory subscriptions");
+        }
+    }
+
+    packet.SetPacketDataSize(written_bytes);
+    packet.SendReply();
+}
+
+void RPCServer::HandleUnsubscribeMemory(Packet& packet, u32 subscription_id) {
+    {
+        std::scoped_lock lock{subscription_mutex};
+        std::erase_if(subscriptions, [subscription_id](const Subscription& subscription) {
+            return subscription.id == subscription_id;
+        });
+    }
+
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::OnFrameEnd() {
+    std::scoped_lock lock{subscription_mutex};
+    if (subscriptions.empty()) {
+        return;
+    }
+
+    std::array<u8, MAX_SUBSCRIPTION_SIZE> current;
+    std::array<u8, MAX_PACKET_DATA_SIZE> notification_data;
+    for (auto& subscription : subscriptions) {
+        const u32 size = subscription.size;
+        if (!ReadMemory(subscription.address, current.data(), size)) {
+            continue;
+        }
+
+        // Only the span between the first and the last changed byte is sent
+        u32 begin = 0;
+        u32 end = size;
+        if (!subscription.last_data.empty()) {
+            const auto mismatch = std::mismatch(current.begin(), current.begin() + size,
+                                                subscription.last_data.begin());
+            begin = static_cast<u32>(mismatch.first - current.begin());
+            if (begin == size) {
+                continue;
+            }
+            while (current[end - 1] == subscription.last_data[end - 1]) {
+                end--;
+            }
+        }
+        subscription.last_data.assign(current.begin(), current.begin() + size);
+
+        const u32 changed_size = end - begin;
+        std::memcpy(notification_data.data(), &begin, sizeof(begin));
+        std::memcpy(notification_data.data() + sizeof(u32), &changed_size, sizeof(changed_size));
+        std::memcpy(notification_data.data() + sizeof(u32) * 2, current.data() + begin,
+                    changed_size);
+
+        const PacketHeader header{CURRENT_VERSION, subscription.id, PacketType::MemoryChanged,
+                                  static_cast<u32>(sizeof(u32) * 2) + changed_size};
+        Packet notification(header, notification_data.data(), subscription.send_callback);
+        notification.SendReply();
+    }
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
@@ -122,6 +287,10 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
         case PacketType::WriteMemory:
         case PacketType::ProcessList:
         case PacketType::SetGetProcess:
+        case PacketType::IPCLatencies:
+        case PacketType::BatchReadMemory:
+        case PacketType::SubscribeMemory:
+        case PacketType::UnsubscribeMemory:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
@@ -166,6 +335,29 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
             HandleSetGetProcess(*request_packet, arg1, arg2);
             success = true;
             break;
+        case PacketType::IPCLatencies:
+            HandleIPCLatencies(*request_packet, arg1, arg2);
+            success = true;
+            break;
+        case PacketType::BatchReadMemory:
+            // The first argument is the range count, followed by that many address/size pairs
+            if (arg1 > 0 && arg1 <= MAX_BATCH_READ_RANGES &&
+                request_packet->GetPacketDataSize() >= sizeof(u32) + arg1 * sizeof(u32) * 2) {
+                const auto ranges = packet_data.subspan(sizeof(u32), arg1 * sizeof(u32) * 2);
+                HandleBatchReadMemory(*request_packet, arg1, ranges);
+                success = true;
+            }
+            break;
+        case PacketType::SubscribeMemory:
+            if (arg2 > 0 && arg2 <= MAX_SUBSCRIPTION_SIZE) {
+                HandleSubscribeMemory(*request_packet, arg1, arg2);
+                success = true;
+            }
+            break;
+        case PacketType::UnsubscribeMemory:
+            HandleUnsubscribeMemory(*request_packet, arg1);
+            success = true;
+            break;
         default:
             break;
         }
@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <span>
+#include <vector>
 #include "common/polyfill_thread.h"
 #include "common/threadsafe_queue.h"
 
@@ -26,11 +30,28 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /// Sends the changed bytes of every subscribed memory range to its subscriber. Called by the
+    /// emulation thread at the end of each game frame, so every push reflects a complete frame.
+    void OnFrameEnd();
+
 private:
+    struct Subscription {
+        u32 id;
+        u32 address;
+        u32 size;
+        std::vector<u8> last_data;
+        std::function<void(Packet&)> send_callback;
+    };
+
+    bool ReadMemory(u32 address, u8* dest, u32 size);
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data);
     void HandleProcessList(Packet& packet, u32 start_index, u32 max_amount);
     void HandleSetGetProcess(Packet& packet, u32 operation, u32 process_id);
+    void HandleIPCLatencies(Packet& packet, u32 start_index, u32 max_amount);
+    void HandleBatchReadMemory(Packet& packet, u32 count, std::span<const u8> ranges);
+    void HandleSubscribeMemory(Packet& packet, u32 address, u32 size);
+    void HandleUnsubscribeMemory(Packet& packet, u32 subscription_id);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop(std::stop_token stop_token);
@@ -39,7 +60,11 @@ private:
     Core::System& system;
     Common::SPSCQueue<std::unique_ptr<Packet>, true> request_queue;
     std::jthread request_handler_thread;
-    u32 selected_pid = 0xFFFFFFFF;
+    std::atomic<u32> selected_pid = 0xFFFFFFFF;
+
+    std::mutex subscription_mutex;
+    std::vector<Subscription> subscriptions;
+    u32 next_subscription_id = 1;
 };
 
 } // namespace Core::RPC
@@ -23,6 +23,10 @@ public:
 
     void NewRequestCallback(std::unique_ptr<Packet> new_request);
 
+    void OnFrameEnd() {
+        rpc_server.OnFrameEnd();
+    }
+
 private:
     RPCServer rpc_server;
     std::unique_ptr<UDPServer> udp_server;
@@ -3,21 +3,32 @@
 // Refer to the license.txt file included.
 
 #include <chrono>
+#include <functional>
+#include <optional>
 #include <sstream>
+#include <thread>
 #include <cryptopp/hex.h>
 #include <fmt/ranges.h>
 #include "common/archives.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
 #include "common/swap.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/loader/loader.h"
+#include "core/memory.h"
 #include "core/movie.h"
+#include "core/rewind.h"
 #include "core/savestate.h"
 #include "core/savestate_data.h"
 #include "network/network.h"
+#include "video_core/gpu.h"
+#include "video_core/renderer_base.h"
 
 namespace Core {
 
@@ -38,16 +49,34 @@ static_assert(sizeof(CSTHeader) == 256, "CSTHeader should be 256 bytes");
 constexpr std::array<u8, 4> header_magic_bytes{{'C', 'S', 'T', 0x1B}};
 
 static std::string GetSaveStatePath(u64 program_id, u64 movie_id, u32 slot) {
+    const std::string slot_name =
+        slot == ResumeSaveStateSlot ? "resume" : fmt::format("{:02d}", slot);
     if (movie_id) {
-        return fmt::format("{}{:016X}.movie{:016X}.{:02d}.cst",
+        return fmt::format("{}{:016X}.movie{:016X}.{}.cst",
                            FileUtil::GetUserPath(FileUtil::UserPath::StatesDir), program_id,
-                           movie_id, slot);
+                           movie_id, slot_name);
     } else {
-        return fmt::format("{}{:016X}.{:02d}.cst",
-                           FileUtil::GetUserPath(FileUtil::UserPath::StatesDir), program_id, slot);
+        return fmt::format("{}{:016X}.{}.cst", FileUtil::GetUserPath(FileUtil::UserPath::StatesDir),
+                           program_id, slot_name);
     }
 }
 
+/// Optional dictionary trained on the save states of a title, e.g. with `zstd --train`.
+static std::vector<u8> LoadSaveStateDictionary(u64 program_id) {
+    const auto path = fmt::format("{}{:016X}.zdict",
+                                  FileUtil::GetUserPath(FileUtil::UserPath::StatesDir), program_id);
+    std::vector<u8> dictionary;
+    if (FileUtil::Exists(path)) {
+        FileUtil::IOFile file(path, "rb");
+        dictionary.resize(file.GetSize());
+        if (file.ReadBytes(dictionary.data(), dictionary.size()) != dictionary.size()) {
+            LOG_ERROR(Core, "Could not read save state dictionary {}", path);
+            dictionary.clear();
+        }
+    }
+    return dictionary;
+}
+
 static bool ValidateSaveState(const CSTHeader& header, SaveStateInfo& info, u64 program_id,
                               u64 movie_id) {
     const auto path = GetSaveStatePath(program_id, movie_id, info.slot);
@@ -87,71 +116,63 @@ static bool ValidateSaveState(const CSTHeader& header, SaveStateInfo& info, u64
     return true;
 }
 
+static std::optional<SaveStateInfo> ReadSaveStateInfo(u64 program_id, u64 movie_id, u32 slot) {
+    const auto path = GetSaveStatePath(program_id, movie_id, slot);
+    if (!FileUtil::Exists(path)) {
+        return std::nullopt;
+    }
+
+    SaveStateInfo info;
+    info.slot = slot;
+
+    FileUtil::IOFile file(path, "rb");
+    if (!file) {
+        LOG_ERROR(Core, "Could not open file {}", path);
+        return std::nullopt;
+    }
+    CSTHeader header;
+    if (file.GetSize() < sizeof(header)) {
+        LOG_ERROR(Core, "File too small {}", path);
+        return std::nullopt;
+    }
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        LOG_ERROR(Core, "Could not read from file {}", path);
+        return std::nullopt;
+    }
+    if (!ValidateSaveState(header, info, program_id, movie_id)) {
+        return std::nullopt;
+    }
+    return info;
+}
+
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id) {
     std::vector<SaveStateInfo> result;
     result.reserve(SaveStateSlotCount);
     for (u32 slot = 0; slot <= SaveStateSlotCount; ++slot) {
-        const auto path = GetSaveStatePath(program_id, movie_id, slot);
-        if (!FileUtil::Exists(path)) {
-            continue;
+        if (auto info = ReadSaveStateInfo(program_id, movie_id, slot)) {
+            result.emplace_back(std::move(*info));
         }
-
-        SaveStateInfo info;
-        info.slot = slot;
-
-        FileUtil::IOFile file(path, "rb");
-        if (!file) {
-            LOG_ERROR(Core, "Could not open file {}", path);
-            continue;
-        }
-        CSTHeader header;
-        if (file.GetSize() < sizeof(header)) {
-            LOG_ERROR(Core, "File too small {}", path);
-            continue;
-        }
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
-            LOG_ERROR(Core, "Could not read from file {}", path);
-            continue;
-        }
-        if (!ValidateSaveState(header, info, program_id, movie_id)) {
-            continue;
-        }
-
-        result.emplace_back(std::move(info));
     }
     return result;
 }
 
-void System::SaveState(u32 slot) const {
-    if (app_loader) {
-        if (!app_loader->SupportsSaveStates()) {
-            throw std::runtime_error("The current app loader doesn't support save states");
-        }
-    }
-
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
-
-    const std::string& str{sstream.str()};
-    const auto data = std::span<const u8>{reinterpret_cast<const u8*>(str.data()), str.size()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(data);
-
-    const u64 movie_id = movie.GetCurrentMovieID();
-    const auto path = GetSaveStatePath(title_id, movie_id, slot);
-    if (!FileUtil::CreateFullPath(path)) {
-        throw std::runtime_error("Could not create path " + path);
-    }
+bool HasResumeState(u64 program_id, u64 movie_id) {
+    // Resuming is meant to be seamless, so states of other builds are not offered
+    const auto info = ReadSaveStateInfo(program_id, movie_id, ResumeSaveStateSlot);
+    return info && info->status == SaveStateInfo::ValidationStatus::OK;
+}
 
-    FileUtil::IOFile file(path, "wb");
-    if (!file) {
-        throw std::runtime_error("Could not open file " + path);
+void DeleteResumeState(u64 program_id, u64 movie_id) {
+    const auto path = GetSaveStatePath(program_id, movie_id, ResumeSaveStateSlot);
+    if (FileUtil::Exists(path)) {
+        FileUtil::Delete(path);
     }
+}
 
+static CSTHeader MakeSaveStateHeader(u64 program_id) {
     CSTHeader header{};
     header.filetype = header_magic_bytes;
-    header.program_id = title_id;
+    header.program_id = program_id;
     std::string rev_bytes;
     CryptoPP::StringSource ss(Common::g_scm_rev, true,
                               new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
@@ -163,58 +184,233 @@ void System::SaveState(u32 slot) const {
     std::memset(header.build_name.data(), 0, sizeof(header.build_name));
     std::memcpy(header.build_name.data(), build_fullname.c_str(),
                 std::min(build_fullname.length(), sizeof(header.build_name) - 1));
+    return header;
+}
+
+/// Writes the header followed by the compressed stream produced by `write`, which returns whether
+/// it succeeded. A partially written file is removed on failure. The header is only written once
+/// the stream is complete, so a file left behind by a process killed while writing is rejected.
+static void WriteSaveStateFile(const std::string& path, const CSTHeader& header,
+                               std::span<const u8> dictionary,
+                               const std::function<bool(std::streambuf&)>& write) {
+    if (!FileUtil::CreateFullPath(path)) {
+        throw std::runtime_error("Could not create path " + path);
+    }
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file) {
+        throw std::runtime_error("Could not open file " + path);
+    }
 
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+    bool written = false;
+    try {
+        const CSTHeader placeholder{};
+        if (file.WriteBytes(&placeholder, sizeof(placeholder)) == sizeof(placeholder)) {
+            const u32 num_workers = std::min(std::thread::hardware_concurrency(), 8u);
+            Common::Compression::ZSTDOutputStreamBuf stream{
+                file, Settings::values.savestate_compression_level.GetValue(),
+                num_workers > 1 ? num_workers : 0, dictionary};
+            written = write(stream) && stream.Finish() && file.Flush() &&
+                      file.Seek(0, SEEK_SET) &&
+                      file.WriteBytes(&header, sizeof(header)) == sizeof(header);
+        }
+    } catch (...) {
+        file.Close();
+        FileUtil::Delete(path);
+        throw;
+    }
+    if (!written) {
+        file.Close();
+        FileUtil::Delete(path);
         throw std::runtime_error("Could not write to file " + path);
     }
 }
 
-void System::LoadState(u32 slot) {
+void System::SaveState(u32 slot) const {
     if (app_loader) {
         if (!app_loader->SupportsSaveStates()) {
             throw std::runtime_error("The current app loader doesn't support save states");
         }
     }
-    if (Network::GetRoomMember().lock()->IsConnected()) {
-        throw std::runtime_error("Unable to load while connected to multiplayer");
-    }
 
     const u64 movie_id = movie.GetCurrentMovieID();
     const auto path = GetSaveStatePath(title_id, movie_id, slot);
+    const CSTHeader header = MakeSaveStateHeader(title_id);
+    std::vector<u8> dictionary = LoadSaveStateDictionary(title_id);
 
-    std::vector<u8> decompressed;
-    {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
+    if (savestate_worker) {
+        // Don't race a previous background save of the same slot.
+        savestate_worker->WaitForRequests();
+    }
 
-        FileUtil::IOFile file(path, "rb");
+    if (!Settings::values.background_savestates) {
+        // Serialize straight into the compressor, which writes to the file as its buffers fill up.
+        WriteSaveStateFile(path, header, dictionary, [this](std::streambuf& stream) {
+            oarchive oa{stream};
+            oa&* this;
+            return true;
+        });
+        return;
+    }
 
-        // load header
-        CSTHeader header;
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
-            throw std::runtime_error("Could not read from file at " + path);
-        }
+    // Only the serialization itself, which mostly copies guest memory, has to happen while the
+    // emulation is stopped. Compressing and writing the snapshot is left to a worker thread.
+    std::ostringstream sstream{std::ios_base::binary};
+    {
+        oarchive oa{sstream};
+        oa&* this;
+    }
+    std::string snapshot = std::move(sstream).str();
+    const u64 snapshot_size = snapshot.size();
+    Common::MemoryAccounting::Allocate(Common::MemoryAccounting::Category::Savestates,
+                                       snapshot_size);
 
-        // validate header
-        SaveStateInfo info;
-        info.slot = slot;
-        if (!ValidateSaveState(header, info, title_id, movie_id)) {
-            throw std::runtime_error("Invalid savestate");
+    if (!savestate_worker) {
+        savestate_worker = std::make_unique<Common::ThreadWorker>(1, "SaveState");
+    }
+    savestate_worker->QueueWork([path, header, dictionary = std::move(dictionary),
+                                 snapshot = std::move(snapshot), snapshot_size] {
+        try {
+            WriteSaveStateFile(path, header, dictionary, [&snapshot](std::streambuf& stream) {
+                const auto size = static_cast<std::streamsize>(snapshot.size());
+                return stream.sputn(snapshot.data(), size) == size;
+            });
+            LOG_INFO(Core, "Background save to {} completed", path);
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error saving in the background: {}", e.what());
         }
+        Common::MemoryAccounting::Free(Common::MemoryAccounting::Category::Savestates,
+                                       snapshot_size);
+    });
+}
 
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+void System::LoadState(u32 slot) {
+    if (app_loader) {
+        if (!app_loader->SupportsSaveStates()) {
+            throw std::runtime_error("The current app loader doesn't support save states");
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
     }
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
+    if (Network::GetRoomMember().lock()->IsConnected()) {
+        throw std::runtime_error("Unable to load while connected to multiplayer");
+    }
+
+    if (savestate_worker) {
+        savestate_worker->WaitForRequests();
+    }
+
+    const u64 movie_id = movie.GetCurrentMovieID();
+    const auto path = GetSaveStatePath(title_id, movie_id, slot);
+
+    FileUtil::IOFile file(path, "rb");
+
+    // load header
+    CSTHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+
+    // validate header
+    SaveStateInfo info;
+    info.slot = slot;
+    if (!ValidateSaveState(header, info, title_id, movie_id)) {
+        throw std::runtime_error("Invalid savestate");
+    }
 
     // Deserialize
-    iarchive ia{sstream};
+    const std::vector<u8> dictionary = LoadSaveStateDictionary(title_id);
+    Common::Compression::ZSTDInputStreamBuf stream{file, dictionary};
+    iarchive ia{stream};
     ia&* this;
 }
 
+bool System::SaveResumeState() {
+    if (!IsPoweredOn() || kernel->AreAsyncOperationsPending()) {
+        LOG_WARNING(Core, "Cannot save the resume state while operations are pending");
+        return false;
+    }
+
+    try {
+        SaveState(ResumeSaveStateSlot);
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error saving the resume state: {}", e.what());
+        return false;
+    }
+
+    // The pipeline cache is otherwise only written on shutdown, which a killed process never
+    // reaches, leaving the resumed session to compile everything again.
+    gpu->Renderer().Rasterizer()->SaveDiskResources();
+    LOG_INFO(Core, "Saved the resume state");
+    return true;
+}
+
+bool System::LoadResumeState() {
+    const u64 movie_id = movie.GetCurrentMovieID();
+    if (!HasResumeState(title_id, movie_id)) {
+        return false;
+    }
+
+    try {
+        LoadState(ResumeSaveStateSlot);
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error loading the resume state: {}", e.what());
+        DeleteResumeState(title_id, movie_id);
+        return false;
+    }
+    LOG_INFO(Core, "Resumed from the state saved on suspend");
+    return true;
+}
+
+void System::CaptureRewindState() {
+    const u64 ticks = timing->GetGlobalTicks();
+    const u64 interval = Settings::values.rewind_interval.GetValue() * VideoCore::FRAME_TICKS;
+    if (rewind_buffer && ticks - rewind_last_ticks < interval) {
+        return;
+    }
+    if (!rewind_buffer) {
+        const std::size_t budget = std::size_t{Settings::values.rewind_buffer_size.GetValue()};
+        rewind_buffer = std::make_unique<RewindBuffer>(budget * 1024 * 1024);
+    }
+    rewind_last_ticks = ticks;
+
+    // The RAM is most of the state, the rewind buffer takes it directly and only keeps the pages
+    // that changed since the previous snapshot.
+    std::ostringstream sstream{std::ios_base::binary};
+    try {
+        serialize_guest_ram = false;
+        SCOPE_EXIT({ serialize_guest_ram = true; });
+        oarchive oa{sstream};
+        oa&* this;
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error capturing rewind state: {}", e.what());
+        return;
+    }
+    rewind_buffer->Push(std::move(sstream).str(), memory->GetBackingRAM());
+}
+
+void System::RewindState() {
+    if (!rewind_buffer || rewind_buffer->Empty()) {
+        LOG_WARNING(Core, "No rewind state to restore");
+        return;
+    }
+    if (Network::GetRoomMember().lock()->IsConnected()) {
+        LOG_ERROR(Core, "Unable to rewind while connected to multiplayer");
+        return;
+    }
+
+    // Loading recreates the memory system, so the RAM can only be restored afterwards.
+    try {
+        serialize_guest_ram = false;
+        SCOPE_EXIT({ serialize_guest_ram = true; });
+        std::istringstream sstream{rewind_buffer->NewestState(), std::ios_base::binary};
+        iarchive ia{sstream};
+        ia&* this;
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error restoring rewind state: {}", e.what());
+        rewind_buffer->Clear();
+        return;
+    }
+    rewind_buffer->Pop(memory->GetBackingRAM());
+    rewind_last_ticks = timing->GetGlobalTicks();
+}
+
 } // namespace Core
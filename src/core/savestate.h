@@ -22,6 +22,15 @@ struct SaveStateInfo {
 
 constexpr u32 SaveStateSlotCount = 11; // Maximum count of savestate slots
 
+/// Slot of the state saved when the frontend is suspended, it is not listed with the others.
+constexpr u32 ResumeSaveStateSlot = SaveStateSlotCount + 1;
+
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id);
 
+/// Returns true if there is a resume state for the program that was saved by this build.
+bool HasResumeState(u64 program_id, u64 movie_id);
+
+/// Deletes the resume state of the program, so that the next boot starts from scratch.
+void DeleteResumeState(u64 program_id, u64 movie_id);
+
 } // namespace Core
@@ -18,7 +18,7 @@ struct CTHeader {
     }
 
     static u32 ExpectedVersion() {
-        return 1;
+        return 2;
     }
 
     char magic[4];
@@ -56,7 +56,9 @@ struct CTHeader {
         // - Lookup tables for procedural textures
     } initial_state_offsets;
 
+    /// File offset of the Zstandard frame holding the command stream
     u32 stream_offset;
+    /// Number of stream elements in the command stream
     u32 stream_size;
 };
 
@@ -66,8 +68,13 @@ enum CTStreamElementType : u32 {
     RegisterWrite = 0xE3,
 };
 
+/**
+ * Memory contents are deduplicated: every distinct memory blob is stored once, right after the
+ * stream element that first references it. Blobs are numbered in order of appearance, so an
+ * element whose blob index equals the number of blobs seen so far is followed by `size` bytes.
+ */
 struct CTMemoryLoad {
-    u32 file_offset;
+    u32 blob_index;
     u32 size;
     u32 physical_address;
     u32 pad;
@@ -0,0 +1,182 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/memory.h"
+#include "core/tracer/player.h"
+#include "video_core/gpu.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/renderer_base.h"
+
+namespace CiTrace {
+
+Player::Player(const std::string& filename) : file{filename, "rb"} {
+    try {
+        if (!file.IsOpen())
+            throw "Failed to open file";
+
+        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header))
+            throw "Failed to read header";
+
+        if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), 4) != 0)
+            throw "Not a CiTrace file";
+
+        if (header.version != CTHeader::ExpectedVersion())
+            throw "Unsupported CiTrace version";
+
+        const auto read_section = [this](std::vector<u32>& dest, u32 offset, u32 size) {
+            dest.resize(size);
+            if (!file.Seek(offset, SEEK_SET) || file.ReadArray(dest.data(), size) != size)
+                throw "Failed to read initial state";
+        };
+        const auto& initial = header.initial_state_offsets;
+        read_section(initial_state.lcd_registers, initial.lcd_registers,
+                     initial.lcd_registers_size);
+        read_section(initial_state.pica_registers, initial.pica_registers,
+                     initial.pica_registers_size);
+        read_section(initial_state.default_attributes, initial.default_attributes,
+                     initial.default_attributes_size);
+        read_section(initial_state.vs_program_binary, initial.vs_program_binary,
+                     initial.vs_program_binary_size);
+        read_section(initial_state.vs_swizzle_data, initial.vs_swizzle_data,
+                     initial.vs_swizzle_data_size);
+        read_section(initial_state.vs_float_uniforms, initial.vs_float_uniforms,
+                     initial.vs_float_uniforms_size);
+        read_section(initial_state.gs_program_binary, initial.gs_program_binary,
+                     initial.gs_program_binary_size);
+        read_section(initial_state.gs_swizzle_data, initial.gs_swizzle_data,
+                     initial.gs_swizzle_data_size);
+        read_section(initial_state.gs_float_uniforms, initial.gs_float_uniforms,
+                     initial.gs_float_uniforms_size);
+
+        if (!file.Seek(header.stream_offset, SEEK_SET))
+            throw "Failed to seek to the command stream";
+    } catch (const char* str) {
+        LOG_ERROR(HW_GPU, "Reading CiTrace file failed: {}", str);
+        good = false;
+        return;
+    }
+
+    stream = std::make_unique<Common::Compression::ZSTDInputStreamBuf>(file);
+}
+
+Player::~Player() = default;
+
+void Player::ApplyInitialState(VideoCore::GPU& gpu) {
+    gpu.WaitIdle();
+    auto& pica = gpu.PicaCore();
+
+    const auto copy_words = [](auto& dest, const std::vector<u32>& src) {
+        std::memcpy(std::addressof(dest), src.data(),
+                    std::min(sizeof(dest), src.size() * sizeof(u32)));
+    };
+    copy_words(pica.regs_lcd, initial_state.lcd_registers);
+    copy_words(pica.regs.reg_array, initial_state.pica_registers);
+
+    // Floating point values are stored as raw 24-bit floats, four components per vector
+    const auto copy_vectors = [](auto& dest, const std::vector<u32>& src) {
+        const std::size_t count = std::min<std::size_t>(dest.size(), src.size() / 4);
+        for (std::size_t i = 0; i < count; ++i) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                dest[i][comp] = Pica::f24::FromRaw(src[4 * i + comp]);
+            }
+        }
+    };
+    copy_vectors(pica.input_default_attributes, initial_state.default_attributes);
+
+    const auto apply_shader = [&](Pica::ShaderSetup& setup, const std::vector<u32>& program,
+                                  const std::vector<u32>& swizzle,
+                                  const std::vector<u32>& uniforms) {
+        if (!program.empty()) {
+            Pica::ProgramCode program_code{};
+            std::copy_n(program.begin(), std::min(program.size(), program_code.size()),
+                        program_code.begin());
+            setup.UpdateProgramCode(program_code);
+        }
+        if (!swizzle.empty()) {
+            Pica::SwizzleData swizzle_data{};
+            std::copy_n(swizzle.begin(), std::min(swizzle.size(), swizzle_data.size()),
+                        swizzle_data.begin());
+            setup.UpdateSwizzleData(swizzle_data);
+        }
+        copy_vectors(setup.uniforms.f, uniforms);
+        setup.MarkUniformsDirty();
+    };
+    apply_shader(pica.vs_setup, initial_state.vs_program_binary, initial_state.vs_swizzle_data,
+                 initial_state.vs_float_uniforms);
+    apply_shader(pica.gs_setup, initial_state.gs_program_binary, initial_state.gs_swizzle_data,
+                 initial_state.gs_float_uniforms);
+
+    pica.dirty_regs.SetAllDirty();
+}
+
+bool Player::ReplayFrame(VideoCore::GPU& gpu, Memory::MemorySystem& memory) {
+    if (!good) {
+        return false;
+    }
+
+    try {
+        while (next_element < header.stream_size) {
+            CTStreamElement element;
+            if (stream->sgetn(reinterpret_cast<char*>(&element), sizeof(element)) !=
+                sizeof(element))
+                throw "Failed to read stream element";
+            next_element++;
+
+            switch (element.type) {
+            case FrameMarker:
+                gpu.Renderer().SwapBuffers();
+                return true;
+
+            case MemoryLoad: {
+                // Copied out of the packed element so that they can be bound to references
+                const u32 blob_index = element.memory_load.blob_index;
+                const u32 size = element.memory_load.size;
+                const PAddr address = element.memory_load.physical_address;
+                if (blob_index == memory_blobs.size()) {
+                    auto& blob = memory_blobs.emplace_back(size);
+                    if (stream->sgetn(reinterpret_cast<char*>(blob.data()), size) !=
+                        static_cast<std::streamsize>(size))
+                        throw "Failed to read memory blob";
+                } else if (blob_index > memory_blobs.size()) {
+                    throw "Invalid memory blob index";
+                }
+
+                const auto& blob = memory_blobs[blob_index];
+                u8* dest = memory.GetPhysicalPointer(address);
+                if (!dest || blob.size() != size) {
+                    LOG_WARNING(HW_GPU, "Skipping memory load to {:#010X}", address);
+                    break;
+                }
+                std::memcpy(dest, blob.data(), size);
+                gpu.InvalidateRegion(address, size);
+                break;
+            }
+
+            case RegisterWrite: {
+                const PAddr address = element.register_write.physical_address;
+                if (address < Memory::IO_AREA_PADDR || address >= Memory::IO_AREA_PADDR_END) {
+                    LOG_WARNING(HW_GPU, "Skipping register write to {:#010X}", address);
+                    break;
+                }
+                gpu.WriteReg(address - Memory::IO_AREA_PADDR + Memory::IO_AREA_VADDR,
+                             element.register_write.value);
+                break;
+            }
+
+            default:
+                throw "Unknown stream element";
+            }
+        }
+    } catch (const char* str) {
+        LOG_ERROR(HW_GPU, "Replaying CiTrace failed at element {}: {}", next_element, str);
+        good = false;
+    }
+    return false;
+}
+
+} // namespace CiTrace
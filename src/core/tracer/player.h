@@ -0,0 +1,68 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/tracer/citrace.h"
+#include "core/tracer/recorder.h"
+
+namespace Common::Compression {
+class ZSTDInputStreamBuf;
+}
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace VideoCore {
+class GPU;
+}
+
+namespace CiTrace {
+
+/**
+ * Replays a CiTrace through the PICA core and the active renderer, without running the emulated
+ * CPU. The command stream is decompressed while it is replayed, only the distinct memory blobs are
+ * kept around.
+ */
+class Player {
+public:
+    explicit Player(const std::string& filename);
+    ~Player();
+
+    /// Returns true if the trace was opened and nothing failed to be read so far.
+    bool IsGood() const {
+        return good;
+    }
+
+    /// Returns the number of stream elements in the trace
+    u32 NumElements() const {
+        return header.stream_size;
+    }
+
+    /// Loads the initial state of the trace into the PICA core.
+    void ApplyInitialState(VideoCore::GPU& gpu);
+
+    /**
+     * Replays the stream up to and including the next frame marker, which presents the frame.
+     * @return false once the end of the trace has been reached.
+     */
+    bool ReplayFrame(VideoCore::GPU& gpu, Memory::MemorySystem& memory);
+
+private:
+    FileUtil::IOFile file;
+    CTHeader header{};
+    Recorder::InitialState initial_state;
+    std::unique_ptr<Common::Compression::ZSTDInputStreamBuf> stream;
+    std::vector<std::vector<u8>> memory_blobs;
+    u32 next_element = 0;
+    bool good = true;
+};
+
+} // namespace CiTrace
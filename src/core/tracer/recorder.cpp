@@ -3,190 +3,173 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <thread>
 #include "common/assert.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/zstd_compression.h"
 #include "core/tracer/recorder.h"
 
 namespace CiTrace {
 
-Recorder::Recorder(const InitialState& initial_state) : initial_state(initial_state) {}
+namespace {
+/// Trace streams are large and repetitive, a fast level keeps up with the GPU thread.
+constexpr s32 CompressionLevel = 3;
+} // Anonymous namespace
 
-void Recorder::Finish(const std::string& filename) {
+Recorder::Recorder(const std::string& filename_, const InitialState& initial_state)
+    : filename{filename_}, file{filename_, "wb"} {
     // Setup CiTrace header
-    CTHeader header;
     std::memcpy(header.magic, CTHeader::ExpectedMagicWord(), 4);
     header.version = CTHeader::ExpectedVersion();
     header.header_size = sizeof(CTHeader);
 
-    // Calculate file offsets
+    // Initial state sections follow the header in the order of the offsets in the header
     auto& initial = header.initial_state_offsets;
-
-    initial.pica_registers_size = static_cast<u32>(initial_state.pica_registers.size());
-    initial.lcd_registers_size = static_cast<u32>(initial_state.lcd_registers.size());
-    initial.default_attributes_size = static_cast<u32>(initial_state.default_attributes.size());
-    initial.vs_program_binary_size = static_cast<u32>(initial_state.vs_program_binary.size());
-    initial.vs_swizzle_data_size = static_cast<u32>(initial_state.vs_swizzle_data.size());
-    initial.vs_float_uniforms_size = static_cast<u32>(initial_state.vs_float_uniforms.size());
-    initial.gs_program_binary_size = static_cast<u32>(initial_state.gs_program_binary.size());
-    initial.gs_swizzle_data_size = static_cast<u32>(initial_state.gs_swizzle_data.size());
-    initial.gs_float_uniforms_size = static_cast<u32>(initial_state.gs_float_uniforms.size());
-    header.stream_size = static_cast<u32>(stream.size());
-
-    initial.gpu_registers = sizeof(header);
-    initial.lcd_registers = initial.gpu_registers + initial.gpu_registers_size * sizeof(u32);
-    initial.pica_registers = initial.lcd_registers + initial.lcd_registers_size * sizeof(u32);
-    ;
-    initial.default_attributes = initial.pica_registers + initial.pica_registers_size * sizeof(u32);
-    initial.vs_program_binary =
-        initial.default_attributes + initial.default_attributes_size * sizeof(u32);
-    initial.vs_swizzle_data =
-        initial.vs_program_binary + initial.vs_program_binary_size * sizeof(u32);
-    initial.vs_float_uniforms =
-        initial.vs_swizzle_data + initial.vs_swizzle_data_size * sizeof(u32);
-    initial.gs_program_binary =
-        initial.vs_float_uniforms + initial.vs_float_uniforms_size * sizeof(u32);
-    initial.gs_swizzle_data =
-        initial.gs_program_binary + initial.gs_program_binary_size * sizeof(u32);
-    initial.gs_float_uniforms =
-        initial.gs_swizzle_data + initial.gs_swizzle_data_size * sizeof(u32);
-    header.stream_offset = initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
-
-    // Iterate through stream elements, update relevant stream element data
-    for (auto& stream_element : stream) {
-        switch (stream_element.data.type) {
-        case MemoryLoad: {
-            auto& file_offset = memory_regions[stream_element.hash];
-            if (!stream_element.uses_existing_data) {
-                file_offset = header.stream_offset;
-            }
-            stream_element.data.memory_load.file_offset = file_offset;
-            break;
-        }
-
-        default:
-            // Other commands don't use any extra data
-            DEBUG_ASSERT(stream_element.extra_data.size() == 0);
-            break;
-        }
-        header.stream_offset += static_cast<u32>(stream_element.extra_data.size());
-    }
+    u32 offset = sizeof(CTHeader);
+    const auto layout = [&offset](u32& section_offset, u32& section_size,
+                                  const std::vector<u32>& data) {
+        section_offset = offset;
+        section_size = static_cast<u32>(data.size());
+        offset += section_size * sizeof(u32);
+    };
+    initial.gpu_registers = offset;
+    layout(initial.lcd_registers, initial.lcd_registers_size, initial_state.lcd_registers);
+    layout(initial.pica_registers, initial.pica_registers_size, initial_state.pica_registers);
+    layout(initial.default_attributes, initial.default_attributes_size,
+           initial_state.default_attributes);
+    layout(initial.vs_program_binary, initial.vs_program_binary_size,
+           initial_state.vs_program_binary);
+    layout(initial.vs_swizzle_data, initial.vs_swizzle_data_size, initial_state.vs_swizzle_data);
+    layout(initial.vs_float_uniforms, initial.vs_float_uniforms_size,
+           initial_state.vs_float_uniforms);
+    layout(initial.gs_program_binary, initial.gs_program_binary_size,
+           initial_state.gs_program_binary);
+    layout(initial.gs_swizzle_data, initial.gs_swizzle_data_size, initial_state.gs_swizzle_data);
+    layout(initial.gs_float_uniforms, initial.gs_float_uniforms_size,
+           initial_state.gs_float_uniforms);
+    header.stream_offset = offset;
 
     try {
-        // Open file and write header
-        FileUtil::IOFile file(filename, "wb");
-        std::size_t written = file.WriteObject(header);
-        if (written != 1 || file.Tell() != initial.gpu_registers)
+        if (!file.IsOpen())
+            throw "Failed to open file";
+
+        // The stream size is filled in once the recording is finished
+        if (file.WriteObject(header) != 1)
             throw "Failed to write header";
 
-        // Write initial state
-        written = file.WriteArray(initial_state.pica_registers.data(),
-                                  initial_state.pica_registers.size());
-        if (written != initial_state.pica_registers.size() ||
-            file.Tell() != initial.default_attributes)
-            throw "Failed to write Pica registers";
-
-        written =
-            file.WriteArray(initial_state.lcd_registers.data(), initial_state.lcd_registers.size());
-        if (written != initial_state.lcd_registers.size() || file.Tell() != initial.pica_registers)
-            throw "Failed to write LCD registers";
-
-        written = file.WriteArray(initial_state.default_attributes.data(),
-                                  initial_state.default_attributes.size());
-        if (written != initial_state.default_attributes.size() ||
-            file.Tell() != initial.vs_program_binary)
-            throw "Failed to write default vertex attributes";
-
-        written = file.WriteArray(initial_state.vs_program_binary.data(),
-                                  initial_state.vs_program_binary.size());
-        if (written != initial_state.vs_program_binary.size() ||
-            file.Tell() != initial.vs_swizzle_data)
-            throw "Failed to write vertex shader program binary";
-
-        written = file.WriteArray(initial_state.vs_swizzle_data.data(),
-                                  initial_state.vs_swizzle_data.size());
-        if (written != initial_state.vs_swizzle_data.size() ||
-            file.Tell() != initial.vs_float_uniforms)
-            throw "Failed to write vertex shader swizzle data";
-
-        written = file.WriteArray(initial_state.vs_float_uniforms.data(),
-                                  initial_state.vs_float_uniforms.size());
-        if (written != initial_state.vs_float_uniforms.size() ||
-            file.Tell() != initial.gs_program_binary)
-            throw "Failed to write vertex shader float uniforms";
-
-        written = file.WriteArray(initial_state.gs_program_binary.data(),
-                                  initial_state.gs_program_binary.size());
-        if (written != initial_state.gs_program_binary.size() ||
-            file.Tell() != initial.gs_swizzle_data)
-            throw "Failed to write geomtry shader program binary";
-
-        written = file.WriteArray(initial_state.gs_swizzle_data.data(),
-                                  initial_state.gs_swizzle_data.size());
-        if (written != initial_state.gs_swizzle_data.size() ||
-            file.Tell() != initial.gs_float_uniforms)
-            throw "Failed to write geometry shader swizzle data";
-
-        written = file.WriteArray(initial_state.gs_float_uniforms.data(),
-                                  initial_state.gs_float_uniforms.size());
-        if (written != initial_state.gs_float_uniforms.size() ||
-            file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
-            throw "Failed to write geometry shader float uniforms";
-
-        // Iterate through stream elements, write "extra data"
-        for (const auto& stream_element : stream) {
-            if (stream_element.extra_data.size() == 0)
-                continue;
-
-            written =
-                file.WriteBytes(stream_element.extra_data.data(), stream_element.extra_data.size());
-            if (written != stream_element.extra_data.size())
-                throw "Failed to write extra data";
+        for (const auto* section :
+             {&initial_state.lcd_registers, &initial_state.pica_registers,
+              &initial_state.default_attributes, &initial_state.vs_program_binary,
+              &initial_state.vs_swizzle_data, &initial_state.vs_float_uniforms,
+              &initial_state.gs_program_binary, &initial_state.gs_swizzle_data,
+              &initial_state.gs_float_uniforms}) {
+            if (file.WriteArray(section->data(), section->size()) != section->size())
+                throw "Failed to write initial state";
         }
 
         if (file.Tell() != header.stream_offset)
-            throw "Unexpected end of extra data";
+            throw "Unexpected end of initial state";
+    } catch (const char* str) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
+        good = false;
+        return;
+    }
 
-        // Write actual stream elements
-        for (const auto& stream_element : stream) {
-            if (1 != file.WriteObject(stream_element.data))
-                throw "Failed to write stream element";
-        }
+    // Compress on a background thread so that recording stalls the GPU as little as possible
+    const u32 num_workers = std::thread::hardware_concurrency() > 2 ? 1 : 0;
+    stream = std::make_unique<Common::Compression::ZSTDOutputStreamBuf>(file, CompressionLevel,
+                                                                        num_workers);
+}
+
+Recorder::~Recorder() {
+    if (stream) {
+        Finish();
+    }
+}
+
+bool Recorder::Finish() {
+    if (!stream) {
+        return false;
+    }
+
+    try {
+        const bool finished = stream->Finish();
+        stream.reset();
+        if (!good || !finished)
+            throw "Failed to write stream";
+
+        header.stream_size = num_elements;
+        if (!file.Seek(0, SEEK_SET) || file.WriteObject(header) != 1)
+            throw "Failed to update header";
     } catch (const char* str) {
         LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
+        good = false;
     }
+
+    file.Close();
+    LOG_INFO(HW_GPU, "Recorded {} CiTrace elements with {} distinct memory blobs to {}",
+             num_elements, memory_blobs.size(), filename);
+    return good;
+}
+
+void Recorder::Abort() {
+    stream.reset();
+    file.Close();
+    FileUtil::Delete(filename);
 }
 
 void Recorder::FrameFinished() {
-    stream.push_back({{FrameMarker}});
+    CTStreamElement element{FrameMarker};
+    WriteElement(element);
 }
 
 void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
-    StreamElement element = {{MemoryLoad}};
-    element.data.memory_load.size = size;
-    element.data.memory_load.physical_address = physical_address;
-
-    // Compute hash over given memory region to check if the contents are already stored internally
-    boost::crc_32_type result;
-    result.process_bytes(data, size);
-    element.hash = result.checksum();
-
-    element.uses_existing_data = (memory_regions.find(element.hash) != memory_regions.end());
-    if (!element.uses_existing_data) {
-        element.extra_data.resize(size);
-        std::memcpy(element.extra_data.data(), data, size);
-        memory_regions.insert({element.hash, 0}); // file offset will be initialized in Finish()
+    if (!stream || size == 0) {
+        return;
+    }
+
+    // Skip the load if the memory still holds what was recorded for it last time
+    const u64 hash = Common::ComputeHash64(data, size);
+    auto [last, inserted] = last_loads.try_emplace(physical_address, hash, size);
+    if (!inserted) {
+        if (last->second == std::make_pair(hash, size)) {
+            return;
+        }
+        last->second = {hash, size};
     }
 
-    stream.push_back(element);
+    CTStreamElement element{MemoryLoad};
+    element.memory_load.size = size;
+    element.memory_load.physical_address = physical_address;
+
+    // Contents seen before at any address are referenced instead of being stored again
+    const auto next_index = static_cast<u32>(memory_blobs.size());
+    const auto [blob, is_new] = memory_blobs.try_emplace(hash, next_index);
+    element.memory_load.blob_index = blob->second;
+
+    WriteElement(element);
+    if (is_new) {
+        const auto written = stream->sputn(reinterpret_cast<const char*>(data), size);
+        good &= written == static_cast<std::streamsize>(size);
+    }
 }
 
 void Recorder::RegisterWritten(u32 physical_address, u32 value) {
-    StreamElement element = {{RegisterWrite}};
-    element.data.register_write.physical_address = physical_address;
-    element.data.register_write.value = value;
+    CTStreamElement element{RegisterWrite};
+    element.register_write.physical_address = physical_address;
+    element.register_write.value = value;
+    WriteElement(element);
+}
 
-    stream.push_back(element);
+void Recorder::WriteElement(const CTStreamElement& element) {
+    if (!stream) {
+        return;
+    }
+    const auto written = stream->sputn(reinterpret_cast<const char*>(&element), sizeof(element));
+    good &= written == static_cast<std::streamsize>(sizeof(element));
+    num_elements++;
 }
 
 } // namespace CiTrace
@@ -4,13 +4,19 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
-#include <boost/crc.hpp>
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "core/tracer/citrace.h"
 
+namespace Common::Compression {
+class ZSTDOutputStreamBuf;
+}
+
 namespace CiTrace {
 
 class Recorder {
@@ -28,13 +34,24 @@ public:
     };
 
     /**
-     * Recorder constructor
+     * Recorder constructor. The initial state is written to the file right away, everything
+     * recorded afterwards is compressed and streamed to it as it comes in.
+     * @param filename Path of the CiTrace file to write
      * @param initial_state Initial recorder state
      */
-    explicit Recorder(const InitialState& initial_state);
+    explicit Recorder(const std::string& filename, const InitialState& initial_state);
+    ~Recorder();
+
+    /// Returns true if the trace file could be created and nothing failed to be written so far.
+    bool IsGood() const {
+        return good;
+    }
 
-    /// Finish recording of this Citrace and save it using the given filename.
-    void Finish(const std::string& filename);
+    /// Finish recording of this CiTrace. Returns true if the whole trace was written.
+    bool Finish();
+
+    /// Stop recording and delete the partially written trace.
+    void Abort();
 
     /// Mark end of a frame
     void FrameFinished();
@@ -53,33 +70,23 @@ public:
     void RegisterWritten(u32 physical_address, u32 value);
 
 private:
-    // Initial state of recording start
-    InitialState initial_state;
-
-    // Command stream
-    struct StreamElement {
-        CTStreamElement data;
+    void WriteElement(const CTStreamElement& element);
 
-        /**
-         * Extra data to store along "core" data.
-         * This is e.g. used for data used in MemoryUpdates.
-         */
-        std::vector<u8> extra_data;
-
-        /// Optional CRC hash (e.g. for hashing memory regions)
-        boost::crc_32_type::value_type hash;
-
-        /// If true, refer to data already written to the output file instead of extra_data
-        bool uses_existing_data;
-    };
+    std::string filename;
+    FileUtil::IOFile file;
+    CTHeader header{};
+    std::unique_ptr<Common::Compression::ZSTDOutputStreamBuf> stream;
+    u32 num_elements = 0;
+    bool good = true;
 
-    std::vector<StreamElement> stream;
+    /// Maps hashes of memory contents to the index of the blob storing them.
+    std::unordered_map<u64 /*hash*/, u32 /*blob_index*/> memory_blobs;
 
     /**
-     * Internal cache which maps hashes of memory contents to file offsets at which those memory
-     * contents are stored.
+     * Hash and size of the last contents recorded at each address. Unchanged memory that is
+     * accessed again, like the vertex buffers of a static mesh, is not recorded a second time.
      */
-    std::unordered_map<boost::crc_32_type::value_type /*hash*/, u32 /*file_offset*/> memory_regions;
+    std::unordered_map<u32 /*physical_address*/, std::pair<u64, u32>> last_loads;
 };
 
 } // namespace CiTrace
@@ -9,6 +9,9 @@
 #include <functional>
 #include <thread>
 #include <boost/asio.hpp>
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
 #include "common/logging/log.h"
 #include "input_common/udp/client.h"
 #include "input_common/udp/protocol.h"
@@ -17,10 +20,17 @@ using boost::asio::ip::udp;
 
 namespace InputCommon::CemuhookUDP {
 
+/// How fast the estimated offset to the server clock follows drift, per motion sample
+constexpr s64 CLOCK_OFFSET_CREEP_US = 1;
+constexpr s64 JITTER_SMOOTHING = 16;
+constexpr s64 MAX_JITTER_DELAY_US = 20000;
+
 struct SocketCallback {
     std::function<void(Response::Version)> version;
     std::function<void(Response::PortInfo)> port_info;
     std::function<void(Response::PadData)> pad_data;
+    /// Called after the packets that were queued on the socket have been handled, if set
+    std::function<void()> batch_end;
 };
 
 class Socket {
@@ -65,30 +75,67 @@ public:
 
 private:
     void HandleReceive(const boost::system::error_code& error, std::size_t bytes_transferred) {
-        if (auto type = Response::Validate(receive_buffer.data(), bytes_transferred)) {
+        HandlePacket(receive_buffer.data(), bytes_transferred);
+        ReceiveQueued();
+        if (callback.batch_end) {
+            callback.batch_end();
+        }
+        StartReceive();
+    }
+
+    /// Handles the packets that arrived in the meantime without a wakeup of the io_context each
+    void ReceiveQueued() {
+#ifdef __linux__
+        std::array<mmsghdr, BATCH_SIZE> headers{};
+        std::array<iovec, BATCH_SIZE> vectors{};
+        for (std::size_t i = 0; i < BATCH_SIZE; i++) {
+            vectors[i] = {batch_buffers[i].data(), MAX_PACKET_SIZE};
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+        int received;
+        do {
+            received = recvmmsg(socket.native_handle(), headers.data(), BATCH_SIZE, MSG_DONTWAIT,
+                                nullptr);
+            for (int i = 0; i < received; i++) {
+                HandlePacket(batch_buffers[i].data(), headers[i].msg_len);
+            }
+        } while (received == static_cast<int>(BATCH_SIZE));
+#else
+        boost::system::error_code ec{};
+        while (socket.available(ec) > 0 && !ec) {
+            const std::size_t size = socket.receive(boost::asio::buffer(receive_buffer), 0, ec);
+            if (ec) {
+                break;
+            }
+            HandlePacket(receive_buffer.data(), size);
+        }
+#endif
+    }
+
+    void HandlePacket(u8* data, std::size_t size) {
+        if (auto type = Response::Validate(data, size)) {
             switch (*type) {
             case Type::Version: {
                 Response::Version version;
-                std::memcpy(&version, &receive_buffer[sizeof(Header)], sizeof(Response::Version));
+                std::memcpy(&version, &data[sizeof(Header)], sizeof(Response::Version));
                 callback.version(std::move(version));
                 break;
             }
             case Type::PortInfo: {
                 Response::PortInfo port_info;
-                std::memcpy(&port_info, &receive_buffer[sizeof(Header)],
-                            sizeof(Response::PortInfo));
+                std::memcpy(&port_info, &data[sizeof(Header)], sizeof(Response::PortInfo));
                 callback.port_info(std::move(port_info));
                 break;
             }
             case Type::PadData: {
                 Response::PadData pad_data;
-                std::memcpy(&pad_data, &receive_buffer[sizeof(Header)], sizeof(Response::PadData));
+                std::memcpy(&pad_data, &data[sizeof(Header)], sizeof(Response::PadData));
                 callback.pad_data(std::move(pad_data));
                 break;
             }
             }
         }
-        StartReceive();
     }
 
     void HandleSend(const boost::system::error_code& error) {
@@ -123,8 +170,48 @@ private:
 
     std::array<u8, MAX_PACKET_SIZE> receive_buffer;
     udp::endpoint receive_endpoint;
+#ifdef __linux__
+    static constexpr std::size_t BATCH_SIZE = 16;
+    std::array<std::array<u8, MAX_PACKET_SIZE>, BATCH_SIZE> batch_buffers;
+#endif
 };
 
+static s64 GetSteadyTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::tuple<Common::Vec3<float>, Common::Vec3<float>> DeviceStatus::GetMotionStatus() const {
+    const MotionHistory history = motion_history.Load();
+    if (history.count == 0) {
+        return {};
+    }
+    const auto sample = [&history](u32 age) -> const MotionHistory::Sample& {
+        return history.samples[(history.count - 1 - age) % MotionHistory::MaxSamples];
+    };
+
+    // Find the samples around the time the server clock showed a delay ago and interpolate
+    const s64 target = GetSteadyTimeUs() - history.clock_offset - history.delay;
+    const u32 num_samples = std::min<u32>(history.count, MotionHistory::MaxSamples);
+    const auto& newest = sample(0);
+    if (target >= static_cast<s64>(newest.timestamp)) {
+        return {newest.accel, newest.gyro};
+    }
+    for (u32 age = 1; age < num_samples; age++) {
+        const auto& older = sample(age);
+        if (target < static_cast<s64>(older.timestamp)) {
+            continue;
+        }
+        const auto& newer = sample(age - 1);
+        const float t = static_cast<float>(target - static_cast<s64>(older.timestamp)) /
+                        static_cast<float>(newer.timestamp - older.timestamp);
+        return {Common::Lerp(older.accel, newer.accel, t), Common::Lerp(older.gyro, newer.gyro, t)};
+    }
+    const auto& oldest = sample(num_samples - 1);
+    return {oldest.accel, oldest.gyro};
+}
+
 static void SocketLoop(Socket* socket) {
     socket->StartReceive();
     socket->StartSend(Socket::clock::now());
@@ -171,38 +258,72 @@ void Client::OnPadData(Response::PadData data) {
     // https://github.com/citra-emu/citra/pull/4049 for more details on gyro/accel
     Common::Vec3f accel = Common::MakeVec<float>(-data.accel.x, data.accel.y, -data.accel.z);
     Common::Vec3f gyro = Common::MakeVec<float>(-data.gyro.pitch, -data.gyro.yaw, data.gyro.roll);
-    {
-        std::lock_guard guard(status->update_mutex);
 
-        status->motion_status = {accel, gyro};
+    // Servers that leave the motion timestamp out are timed by the arrival of their packets
+    const s64 now = GetSteadyTimeUs();
+    const u64 timestamp = data.motion_timestamp != 0 ? static_cast<u64>(data.motion_timestamp)
+                                                     : static_cast<u64>(now);
+    const s64 offset = now - static_cast<s64>(timestamp);
+    auto& history = motion_history;
+    const u64 newest_timestamp =
+        history.samples[(history.count - 1) % MotionHistory::MaxSamples].timestamp;
+    if (history.count != 0 && timestamp < newest_timestamp) {
+        // The server was restarted
+        history.count = 0;
+    }
+    if (history.count == 0) {
+        history.clock_offset = offset;
+        jitter = 0;
+    }
+    if (history.count == 0 || timestamp > newest_timestamp) {
+        // The lowest offset belongs to the packet that was delayed the least. It creeps up
+        // slowly to follow the drift between the clocks, and the jitter delay covers how much
+        // later the packets usually arrive.
+        history.clock_offset = std::min(history.clock_offset + CLOCK_OFFSET_CREEP_US, offset);
+        jitter += (offset - history.clock_offset - jitter) / JITTER_SMOOTHING;
+        history.delay = std::min(jitter * 2, MAX_JITTER_DELAY_US);
+        history.samples[history.count % MotionHistory::MaxSamples] = {timestamp, accel, gyro};
+        history.count++;
+    }
 
-        // TODO: add a setting for "click" touch. Click touch refers to a device that differentiates
-        // between a simple "tap" and a hard press that causes the touch screen to click.
-        const bool is_active = data.touch_1.is_active != 0;
+    // TODO: add a setting for "click" touch. Click touch refers to a device that differentiates
+    // between a simple "tap" and a hard press that causes the touch screen to click.
+    const bool is_active = data.touch_1.is_active != 0;
 
-        float x = 0;
-        float y = 0;
+    float x = 0;
+    float y = 0;
 
-        if (is_active && status->touch_calibration) {
-            const u16 min_x = status->touch_calibration->min_x;
-            const u16 max_x = status->touch_calibration->max_x;
-            const u16 min_y = status->touch_calibration->min_y;
-            const u16 max_y = status->touch_calibration->max_y;
+    const auto touch_calibration = status->touch_calibration.Load();
+    if (is_active && touch_calibration) {
+        const u16 min_x = touch_calibration->min_x;
+        const u16 max_x = touch_calibration->max_x;
+        const u16 min_y = touch_calibration->min_y;
+        const u16 max_y = touch_calibration->max_y;
 
-            x = (std::clamp(static_cast<u16>(data.touch_1.x), min_x, max_x) - min_x) /
-                static_cast<float>(max_x - min_x);
-            y = (std::clamp(static_cast<u16>(data.touch_1.y), min_y, max_y) - min_y) /
-                static_cast<float>(max_y - min_y);
-        }
+        x = (std::clamp(static_cast<u16>(data.touch_1.x), min_x, max_x) - min_x) /
+            static_cast<float>(max_x - min_x);
+        y = (std::clamp(static_cast<u16>(data.touch_1.y), min_y, max_y) - min_y) /
+            static_cast<float>(max_y - min_y);
+    }
 
-        status->touch_status = {x, y, is_active};
+    touch_status = {x, y, is_active};
+    has_new_data = true;
+}
+
+void Client::OnBatchEnd() {
+    if (!has_new_data) {
+        return;
     }
+    has_new_data = false;
+    status->motion_history.Store(motion_history);
+    status->touch_status.Store(touch_status);
 }
 
 void Client::StartCommunication(const std::string& host, u16 port, u8 pad_index, u32 client_id) {
     SocketCallback callback{[this](Response::Version version) { OnVersion(version); },
                             [this](Response::PortInfo info) { OnPortInfo(info); },
-                            [this](Response::PadData data) { OnPadData(data); }};
+                            [this](Response::PadData data) { OnPadData(data); },
+                            [this] { OnBatchEnd(); }};
     LOG_INFO(Input, "Starting communication with UDP input server on {}:{}", host, port);
     socket = std::make_unique<Socket>(host, port, pad_index, client_id, callback);
     thread = std::thread{SocketLoop, this->socket.get()};
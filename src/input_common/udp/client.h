@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -12,6 +13,7 @@
 #include <thread>
 #include <tuple>
 #include "common/common_types.h"
+#include "common/seqlock.h"
 #include "common/thread.h"
 #include "common/vector_math.h"
 
@@ -28,10 +30,32 @@ struct PortInfo;
 struct Version;
 } // namespace Response
 
+/// Motion samples received from the server, used to interpolate the motion to the time it is read
+struct MotionHistory {
+    static constexpr std::size_t MaxSamples = 16;
+
+    struct Sample {
+        u64 timestamp; ///< Time the server took the sample at, in microseconds
+        Common::Vec3<float> accel;
+        Common::Vec3<float> gyro;
+    };
+    std::array<Sample, MaxSamples> samples{}; ///< Ring of the latest samples
+    u32 count = 0;                            ///< Total number of samples received
+    /// Lowest difference seen between the host steady clock and the server clock, in microseconds
+    s64 clock_offset = 0;
+    /// How far behind the newest sample the motion is read to hide the network jitter
+    s64 delay = 0;
+};
+
+struct TouchStatus {
+    float x = 0.0f;
+    float y = 0.0f;
+    bool pressed = false;
+};
+
 struct DeviceStatus {
-    std::mutex update_mutex;
-    std::tuple<Common::Vec3<float>, Common::Vec3<float>> motion_status;
-    std::tuple<float, float, bool> touch_status;
+    Common::SeqLock<MotionHistory> motion_history;
+    Common::SeqLock<TouchStatus> touch_status;
 
     // calibration data for scaling the device's touch area to 3ds
     struct CalibrationData {
@@ -40,7 +64,11 @@ struct DeviceStatus {
         u16 max_x{};
         u16 max_y{};
     };
-    std::optional<CalibrationData> touch_calibration;
+    std::mutex calibration_mutex; ///< Serializes the factories storing the calibration
+    Common::SeqLock<std::optional<CalibrationData>> touch_calibration;
+
+    /// Returns the motion interpolated to the current time minus the jitter delay
+    std::tuple<Common::Vec3<float>, Common::Vec3<float>> GetMotionStatus() const;
 };
 
 class Client {
@@ -55,12 +83,19 @@ private:
     void OnVersion(Response::Version);
     void OnPortInfo(Response::PortInfo);
     void OnPadData(Response::PadData);
+    void OnBatchEnd();
     void StartCommunication(const std::string& host, u16 port, u8 pad_index, u32 client_id);
 
     std::unique_ptr<Socket> socket;
     std::shared_ptr<DeviceStatus> status;
     std::thread thread;
     u64 packet_sequence = 0;
+
+    // Written by the socket thread and published at the end of each batch of packets
+    MotionHistory motion_history;
+    TouchStatus touch_status;
+    s64 jitter = 0;
+    bool has_new_data = false;
 };
 
 /// An async job allowing configuration of the touchpad calibration.
@@ -17,8 +17,8 @@ class UDPTouchDevice final : public Input::TouchDevice {
 public:
     explicit UDPTouchDevice(std::shared_ptr<DeviceStatus> status_) : status(std::move(status_)) {}
     std::tuple<float, float, bool> GetStatus() const override {
-        std::lock_guard guard(status->update_mutex);
-        return status->touch_status;
+        const TouchStatus touch = status->touch_status.Load();
+        return {touch.x, touch.y, touch.pressed};
     }
 
 private:
@@ -29,8 +29,7 @@ class UDPMotionDevice final : public Input::MotionDevice {
 public:
     explicit UDPMotionDevice(std::shared_ptr<DeviceStatus> status_) : status(std::move(status_)) {}
     std::tuple<Common::Vec3<float>, Common::Vec3<float>> GetStatus() const override {
-        std::lock_guard guard(status->update_mutex);
-        return status->motion_status;
+        return status->GetMotionStatus();
     }
 
 private:
@@ -43,13 +42,14 @@ public:
 
     std::unique_ptr<Input::TouchDevice> Create(const Common::ParamPackage& params) override {
         {
-            std::lock_guard guard(status->update_mutex);
-            status->touch_calibration = DeviceStatus::CalibrationData{};
+            std::lock_guard guard(status->calibration_mutex);
+            DeviceStatus::CalibrationData calibration;
             // These default values work well for DS4 but probably not other touch inputs
-            status->touch_calibration->min_x = params.Get("min_x", 100);
-            status->touch_calibration->min_y = params.Get("min_y", 50);
-            status->touch_calibration->max_x = params.Get("max_x", 1800);
-            status->touch_calibration->max_y = params.Get("max_y", 850);
+            calibration.min_x = params.Get("min_x", 100);
+            calibration.min_y = params.Get("min_y", 50);
+            calibration.max_x = params.Get("max_x", 1800);
+            calibration.max_y = params.Get("max_y", 850);
+            status->touch_calibration.Store(calibration);
         }
         return std::make_unique<UDPTouchDevice>(status);
     }
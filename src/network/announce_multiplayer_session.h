@@ -26,7 +26,10 @@ class Room;
 class AnnounceMultiplayerSession : NonCopyable {
 public:
     using CallbackHandle = std::shared_ptr<std::function<void(const Common::WebResult&)>>;
+    /// Creates a session announcing the room of Network::GetRoom.
     AnnounceMultiplayerSession();
+    /// Creates a session announcing the given room, such as one of the rooms of a RoomHost.
+    explicit AnnounceMultiplayerSession(std::weak_ptr<Room> room);
     ~AnnounceMultiplayerSession();
 
     /**
@@ -82,6 +85,8 @@ private:
     std::set<CallbackHandle> error_callbacks;
     std::unique_ptr<std::thread> announce_multiplayer_thread;
 
+    std::weak_ptr<Room> announced_room; ///< The room that is announced
+
     /// Backend interface that logs fields
     std::unique_ptr<AnnounceMultiplayerRoom::Backend> backend;
 
@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <fmt/format.h>
 #include "artic_base_client.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/zstd_compression.h"
 
 #include "algorithm"
 #include "chrono"
@@ -285,10 +287,11 @@ bool Client::Connect() {
         return false;
     }
 
+    int version_value = -1;
     auto version = SendSimpleRequest("VERSION");
     if (version.has_value()) {
-        int version_value = str_to_int(*version);
-        if (version_value != SERVER_VERSION) {
+        version_value = str_to_int(*version);
+        if (version_value < SERVER_VERSION || version_value > SERVER_VERSION_COMPRESSION) {
             shutdown(main_socket, SHUT_RDWR);
             closesocket(main_socket);
             LOG_ERROR(Network, "Incompatible server version: {}", version_value);
@@ -332,6 +335,17 @@ bool Client::Connect() {
     }
     max_parameter_count = max_param_value;
 
+    // Ask the server to compress big responses, it replies with the algorithm it will use. Older
+    // servers don't know the request, so only send it to those that announce support.
+    if (version_value >= SERVER_VERSION_COMPRESSION) {
+        auto compression =
+            SendSimpleRequest(fmt::format("COMPRESS:zstd:{}", COMPRESSION_THRESHOLD));
+        if (compression.has_value() && *compression == "zstd") {
+            LOG_INFO(Network, "Artic Base responses over {} bytes will be compressed",
+                     COMPRESSION_THRESHOLD);
+        }
+    }
+
     auto worker_ports = SendSimpleRequest("PORTS");
     if (!worker_ports.has_value()) {
         shutdown(main_socket, SHUT_RDWR);
@@ -467,29 +481,73 @@ std::optional<std::pair<void*, size_t>> Client::Response::GetResponseBuffer(u32
     return std::nullopt;
 }
 
-std::optional<Client::Response> Client::Send(Request& request) {
-    if (stopped)
-        return std::nullopt;
-
+bool Client::SendPending(Request& request, PendingResponse& pending) {
     request.request_packet.parameterCount = static_cast<u32>(request.parameters.size());
-    PendingResponse resp(request);
 
     {
         std::scoped_lock l(recv_map_mutex);
-        pending_responses[request.request_packet.requestID] = &resp;
+        pending_responses[request.request_packet.requestID] = &pending;
     }
 
+    pending.sent_time = std::chrono::steady_clock::now();
     auto respPacket = SendRequestPacket(request.request_packet, false, request.parameters);
     if (stopped || !respPacket.has_value()) {
         std::scoped_lock l(recv_map_mutex);
         pending_responses.erase(request.request_packet.requestID);
+        return false;
+    }
+    return true;
+}
+
+Client::Response Client::WaitPending(PendingResponse& pending) {
+    {
+        std::unique_lock cv_lk(pending.cv_mutex);
+        pending.cv.wait(cv_lk, [&pending]() { return pending.is_done; });
+    }
+
+    if (report_latency_callback) {
+        report_latency_callback(std::chrono::steady_clock::now() - pending.sent_time);
+    }
+    return std::move(pending.response);
+}
+
+std::optional<Client::Response> Client::Send(Request& request) {
+    if (stopped)
+        return std::nullopt;
+
+    PendingResponse resp(request);
+    if (!SendPending(request, resp)) {
         return std::nullopt;
     }
+    return std::optional<Client::Response>(WaitPending(resp));
+}
 
-    std::unique_lock cv_lk(resp.cv_mutex);
-    resp.cv.wait(cv_lk, [&resp]() { return resp.is_done; });
+std::vector<std::optional<Client::Response>> Client::SendBatch(std::vector<Request>& requests) {
+    std::vector<std::optional<Response>> responses(requests.size());
 
-    return std::optional<Client::Response>(std::move(resp.response));
+    // Responses are matched by request ID, so the next request can go out while the server is
+    // still working on the previous ones. This hides most of the round trip on slow links.
+    std::deque<std::pair<std::size_t, std::unique_ptr<PendingResponse>>> in_flight;
+    const auto wait_oldest = [&] {
+        auto& [index, pending] = in_flight.front();
+        responses[index] = WaitPending(*pending);
+        in_flight.pop_front();
+    };
+
+    for (std::size_t i = 0; i < requests.size() && !stopped; i++) {
+        if (in_flight.size() == MaxPipelinedRequests) {
+            wait_oldest();
+        }
+        auto pending = std::unique_ptr<PendingResponse>(new PendingResponse(requests[i]));
+        if (!SendPending(requests[i], *pending)) {
+            break;
+        }
+        in_flight.emplace_back(i, std::move(pending));
+    }
+    while (!in_flight.empty()) {
+        wait_oldest();
+    }
+    return responses;
 }
 
 void Client::LogOnServer(ArticBaseCommon::LogOnServerType log_type, const std::string& message) {
@@ -715,6 +773,24 @@ Client::Handler::Handler(Client& _client, u32 _addr, u16 _port, int _id)
         this);
 }
 
+bool Client::Handler::DecompressResponse(Response& response,
+                                         ArticBaseCommon::CompressionType compression,
+                                         u32 uncompressed_size) {
+    if (compression != ArticBaseCommon::CompressionType::ZSTD) {
+        return false;
+    }
+    const auto decompressed = Common::Compression::DecompressDataZSTD(
+        {reinterpret_cast<const u8*>(response.resp_data_buffer), response.resp_data_size});
+    if (decompressed.size() != uncompressed_size) {
+        return false;
+    }
+    operator delete(response.resp_data_buffer);
+    response.resp_data_buffer = reinterpret_cast<char*>(operator new(decompressed.size()));
+    std::memcpy(response.resp_data_buffer, decompressed.data(), decompressed.size());
+    response.resp_data_size = decompressed.size();
+    return true;
+}
+
 void Client::Handler::RunLoop() {
     handler_socket = ::socket(AF_INET, SOCK_STREAM, 0);
     if (handler_socket == static_cast<SocketHolder>(-1)) {
@@ -789,6 +865,15 @@ void Client::Handler::RunLoop() {
                 if (!client.Read(handler_socket, pending_response->response.resp_data_buffer,
                                  dataPacket.resp.bufferSize)) {
                     signal_error();
+                } else if (dataPacket.resp.compression !=
+                               ArticBaseCommon::CompressionType::NONE &&
+                           !DecompressResponse(pending_response->response,
+                                               dataPacket.resp.compression,
+                                               dataPacket.resp.uncompressedSize)) {
+                    LOG_ERROR(Network, "Method {} sent a malformed compressed response",
+                              pending_response->request.method_name);
+                    pending_response->response.articResult =
+                        ArticBaseCommon::ResponseMethod::ArticResult::METHOD_ERROR;
                 }
             }
         } break;
@@ -3,8 +3,10 @@
 // Refer to the license.txt file included.
 
 #pragma once
+#include "chrono"
 #include "condition_variable"
 #include "cstring"
+#include "deque"
 #include "functional"
 #include "map"
 #include "memory"
@@ -147,6 +149,11 @@ public:
         report_traffic_callback = callback;
     }
 
+    void SetReportArticLatencyCallback(
+        const std::function<void(std::chrono::nanoseconds)>& callback) {
+        report_latency_callback = callback;
+    }
+
     void ReportArticEvent(u64 event) {
         if (report_artic_event_callback) {
             report_artic_event_callback(event);
@@ -169,6 +176,10 @@ public:
 
 private:
     static constexpr const int SERVER_VERSION = 2;
+    // First server version that can compress responses.
+    static constexpr const int SERVER_VERSION_COMPRESSION = 3;
+    // Responses smaller than this are never worth compressing.
+    static constexpr const int COMPRESSION_THRESHOLD = 4 * 1024;
 
     std::string address;
     u16 port;
@@ -210,6 +221,7 @@ private:
     bool Write(SocketHolder sockFD, const void* buffer, size_t size,
                const std::chrono::nanoseconds& timeout = std::chrono::nanoseconds(0));
     std::function<void(u32)> report_traffic_callback;
+    std::function<void(std::chrono::nanoseconds)> report_latency_callback;
 
     std::optional<ArticBaseCommon::DataPacket> SendRequestPacket(
         const ArticBaseCommon::RequestPacket& req, bool expect_response,
@@ -219,6 +231,10 @@ private:
 
     std::vector<std::shared_ptr<UDPStream>> udp_streams;
 
+public:
+    class Response;
+
+private:
     class Handler {
     public:
         Handler(Client& _client, u32 _addr, u16 _port, int _id);
@@ -227,6 +243,11 @@ private:
         }
         void RunLoop();
 
+        /// Replaces the response buffer with its decompressed contents.
+        static bool DecompressResponse(Response& response,
+                                       ArticBaseCommon::CompressionType compression,
+                                       u32 uncompressed_size);
+
         int id = 0;
         bool should_run = true;
         SocketHolder handler_socket = -1;
@@ -343,6 +364,16 @@ public:
 
     std::optional<Response> Send(Request& request);
 
+    /**
+     * Sends all the requests keeping up to MaxPipelinedRequests of them in flight at once, instead
+     * of waiting for every response before sending the next request. The requests must stay alive
+     * until this returns. Responses are returned in the same order as the requests, requests that
+     * could not be sent have no response.
+     */
+    std::vector<std::optional<Response>> SendBatch(std::vector<Request>& requests);
+
+    static constexpr std::size_t MaxPipelinedRequests = 4;
+
 private:
     class PendingResponse {
     public:
@@ -356,6 +387,7 @@ private:
         std::mutex cv_mutex;
 
         const Request& request;
+        std::chrono::steady_clock::time_point sent_time;
 
         Response response{};
     };
@@ -366,5 +398,10 @@ private:
     std::vector<Handler*> handlers;
     std::atomic<size_t> running_handlers;
     void OnAllHandlersFinished();
+
+    /// Registers the response and sends the request, returns false if it could not be sent.
+    bool SendPending(Request& request, PendingResponse& pending);
+    /// Waits for the response of a request sent with SendPending.
+    Response WaitPending(PendingResponse& pending);
 };
 } // namespace Network::ArticBase
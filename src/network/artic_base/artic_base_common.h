@@ -67,6 +67,13 @@ struct Buffer {
 #pragma warning(pop)
 #endif
 
+// Compression applied by the server to a response buffer. Servers only compress after the client
+// enabled it with the "$COMPRESS" request, which is available from protocol version 3.
+enum class CompressionType : u8 {
+    NONE = 0,
+    ZSTD = 1,
+};
+
 struct ResponseMethod {
     enum class ArticResult : u32 {
         SUCCESS = 0,
@@ -79,9 +86,15 @@ struct ResponseMethod {
         int methodResult{};
         int provideInputBufferID;
     };
+    // Size of the buffer that follows on the wire, compressed if compression is set.
     int bufferSize{};
-    u8 padding[0x10]{};
+    CompressionType compression{};
+    u8 padding0[3]{};
+    // Size of the buffer once decompressed, only meaningful if compression is set.
+    u32 uncompressedSize{};
+    u8 padding[0x8]{};
 };
+static_assert(sizeof(ResponseMethod) == 0x1C);
 
 struct DataPacket {
     DataPacket() {}
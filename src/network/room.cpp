@@ -4,11 +4,16 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <mutex>
 #include <random>
 #include <regex>
+#include <shared_mutex>
 #include <sstream>
 #include <thread>
+#include <utility>
+#include "common/assert.h"
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
@@ -43,9 +48,23 @@ public:
         ENetPeer* peer; ///< The remote peer.
     };
     using MemberList = std::vector<Member>;
-    MemberList members;              ///< Information about the members of this room
-    mutable std::mutex member_mutex; ///< Mutex for locking the members list
-    /// This should be a std::shared_mutex as soon as C++17 is supported
+    MemberList members; ///< Information about the members of this room
+    /// Mutex for locking the members list. Forwarding packets only needs shared access, so it
+    /// isn't blocked by other threads reading the list.
+    mutable std::shared_mutex member_mutex;
+
+    /// Traffic statistics of the room, only accessed by the room thread.
+    struct TrafficStats {
+        u64 received_packets = 0;
+        u64 received_bytes = 0;
+        u64 sent_packets = 0;
+        u64 sent_bytes = 0;
+    };
+    TrafficStats traffic_stats{};
+    std::chrono::steady_clock::time_point last_traffic_report{};
+
+    /// Interval between two reports of the traffic statistics in the log.
+    static constexpr std::chrono::seconds TrafficReportInterval{60};
 
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
@@ -64,6 +83,15 @@ public:
     void ServerLoop();
     void StartLoop();
 
+    /// Dispatches the events pending on the socket without waiting. Used by RoomHost.
+    void ServiceEvents();
+
+    /// Dispatches a received packet or a disconnection to its handler.
+    void HandleEvent(ENetEvent* event);
+
+    /// Logs the traffic of the room since the previous report, if the interval has elapsed.
+    void ReportTrafficStats();
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -248,60 +276,108 @@ public:
 
 // RoomImpl
 void Room::RoomImpl::ServerLoop() {
+    last_traffic_report = std::chrono::steady_clock::now();
     while (state != State::Closed) {
+        ReportTrafficStats();
         ENetEvent event;
         if (enet_host_service(server, &event, 16) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+            HandleEvent(&event);
         }
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::ServiceEvents() {
+    ENetEvent event;
+    while (enet_host_service(server, &event, 0) > 0) {
+        HandleEvent(&event);
+    }
+}
+
+void Room::RoomImpl::HandleEvent(ENetEvent* event) {
+    switch (event->type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event->packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(event);
+            break;
+        case IdSetGameInfo:
+            HandleGameNamePacket(event);
+            break;
+        case IdWifiPacket:
+            HandleWifiPacket(event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(event);
+            break;
+        // Moderation
+        case IdModKick:
+            HandleModKickPacket(event);
+            break;
+        case IdModBan:
+            HandleModBanPacket(event);
+            break;
+        case IdModUnban:
+            HandleModUnbanPacket(event);
+            break;
+        case IdModGetBanList:
+            HandleModGetBanListPacket(event);
+            break;
+        }
+        // Forwarded packets are owned by ENet until every recipient has been sent them.
+        if (event->packet->referenceCount == 0) {
+            enet_packet_destroy(event->packet);
+        }
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event->peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
+void Room::RoomImpl::ReportTrafficStats() {
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = now - last_traffic_report;
+    if (elapsed < TrafficReportInterval) {
+        return;
+    }
+    last_traffic_report = now;
+
+    const TrafficStats stats = std::exchange(traffic_stats, {});
+    if (stats.received_packets == 0) {
+        return;
+    }
+
+    std::size_t num_members = 0;
+    u64 bytes_in_flight = 0;
+    {
+        std::shared_lock lock(member_mutex);
+        num_members = members.size();
+        for (const auto& member : members) {
+            bytes_in_flight += member.peer->reliableDataInTransit;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    LOG_INFO(Network,
+             "Traffic: {} members, in {:.1f} packets/s {:.1f} KiB/s, out {:.1f} packets/s {:.1f} "
+             "KiB/s, {} bytes in flight",
+             num_members, stats.received_packets / seconds,
+             stats.received_bytes / seconds / 1024.0, stats.sent_packets / seconds,
+             stats.sent_bytes / seconds / 1024.0, bytes_in_flight);
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
 
 void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     {
-        std::lock_guard lock(member_mutex);
+        std::shared_lock lock(member_mutex);
         if (members.size() >= room_information.member_slots) {
             SendRoomIsFull(event->peer);
             return;
@@ -575,28 +651,28 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
     if (!std::regex_match(nickname, nickname_regex))
         return false;
 
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     return std::all_of(members.begin(), members.end(),
                        [&nickname](const auto& member) { return member.nickname != nickname; });
 }
 
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     return std::all_of(members.begin(), members.end(),
                        [&address](const auto& member) { return member.mac_address != address; });
 }
 
 bool Room::RoomImpl::IsValidConsoleId(const std::string& console_id_hash) const {
     // A Console ID is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     return std::all_of(members.begin(), members.end(), [&console_id_hash](const auto& member) {
         return member.console_id_hash != console_id_hash;
     });
 }
 
 bool Room::RoomImpl::HasModPermission(const ENetPeer* client) const {
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     const auto sending_member =
         std::find_if(members.begin(), members.end(),
                      [client](const auto& member) { return member.peer == client; });
@@ -754,7 +830,7 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
 void Room::RoomImpl::SendCloseMessage() {
     Packet packet;
     packet << static_cast<u8>(IdCloseRoom);
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     if (!members.empty()) {
         ENetPacket* enet_packet =
             enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
@@ -775,7 +851,7 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
     packet << static_cast<u8>(type);
     packet << nickname;
     packet << username;
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     if (!members.empty()) {
         ENetPacket* enet_packet =
             enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
@@ -817,9 +893,9 @@ void Room::RoomImpl::BroadcastRoomInformation() {
     packet << room_information.preferred_game;
     packet << room_information.host_username;
 
-    packet << static_cast<u32>(members.size());
     {
-        std::lock_guard lock(member_mutex);
+        std::shared_lock lock(member_mutex);
+        packet << static_cast<u32>(members.size());
         for (const auto& member : members) {
             packet << member.nickname;
             packet << member.mac_address;
@@ -850,50 +926,51 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // Only the destination is needed, read it in place instead of copying the whole packet. It
+    // follows the message type, WifiPacket type, channel and transmitter address.
+    constexpr std::size_t DestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < DestinationOffset + sizeof(MacAddress)) {
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
+    std::memcpy(destination_address.data(), enet_packet->data + DestinationOffset,
+                sizeof(MacAddress));
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    traffic_stats.received_packets++;
+    traffic_stats.received_bytes += enet_packet->dataLength;
 
+    // The received packet is forwarded as is. ENet counts the references of every peer it is
+    // queued on, so a single buffer serves all the recipients and is freed after the last send.
+    enet_packet->flags |= ENET_PACKET_FLAG_RELIABLE;
+    u32 recipients = 0;
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
+        std::shared_lock lock(member_mutex);
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
                 enet_peer_send(member.peer, 0, enet_packet);
+                recipients++;
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
+        std::shared_lock lock(member_mutex);
         auto member = std::find_if(members.begin(), members.end(),
                                    [destination_address](const Member& member) -> bool {
                                        return member.mac_address == destination_address;
                                    });
         if (member != members.end()) {
             enet_peer_send(member->peer, 0, enet_packet);
+            recipients++;
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
+    traffic_stats.sent_packets += recipients;
+    traffic_stats.sent_bytes += static_cast<u64>(recipients) * enet_packet->dataLength;
     enet_host_flush(server);
 }
 
@@ -908,7 +985,7 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
         return member.peer == event->peer;
     };
 
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     const auto sending_member = std::find_if(members.begin(), members.end(), CompareNetworkAddress);
     if (sending_member == members.end()) {
         return; // Received a chat message from a unknown sender
@@ -1017,7 +1094,7 @@ bool Room::Create(const std::string& name, const std::string& description,
                   const u32 max_connections, const std::string& host_username,
                   const std::string& preferred_game, u64 preferred_game_id,
                   std::unique_ptr<VerifyUser::Backend> verify_backend,
-                  const Room::BanList& ban_list) {
+                  const Room::BanList& ban_list, bool own_thread) {
     ENetAddress address;
     address.host = ENET_HOST_ANY;
     if (!server_address.empty()) {
@@ -1045,7 +1122,9 @@ bool Room::Create(const std::string& name, const std::string& description,
     room_impl->username_ban_list = ban_list.first;
     room_impl->ip_ban_list = ban_list.second;
 
-    room_impl->StartLoop();
+    if (own_thread) {
+        room_impl->StartLoop();
+    }
     return true;
 }
 
@@ -1069,7 +1148,7 @@ Room::BanList Room::GetBanList() const {
 
 std::vector<Room::Member> Room::GetRoomMemberList() const {
     std::vector<Room::Member> member_list;
-    std::lock_guard lock(room_impl->member_mutex);
+    std::shared_lock lock(room_impl->member_mutex);
     for (const auto& member_impl : room_impl->members) {
         Member member;
         member.nickname = member_impl.nickname;
@@ -1094,8 +1173,10 @@ void Room::SetVerifyUID(const std::string& uid) {
 
 void Room::Destroy() {
     room_impl->state = State::Closed;
-    room_impl->room_thread->join();
-    room_impl->room_thread.reset();
+    if (room_impl->room_thread) {
+        room_impl->room_thread->join();
+        room_impl->room_thread.reset();
+    }
 
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
@@ -1110,4 +1191,67 @@ void Room::Destroy() {
     room_impl->room_information.name.clear();
 }
 
+// RoomHost
+RoomHost::RoomHost() = default;
+
+RoomHost::~RoomHost() {
+    Stop();
+}
+
+void RoomHost::AddRoom(std::shared_ptr<Room> room) {
+    ASSERT_MSG(!running, "Rooms can only be added when the host is not running");
+    ASSERT(!room->room_impl->room_thread);
+    rooms.push_back(std::move(room));
+}
+
+const std::vector<std::shared_ptr<Room>>& RoomHost::GetRooms() const {
+    return rooms;
+}
+
+void RoomHost::Start() {
+    if (service_thread) {
+        return;
+    }
+    running = true;
+    service_thread = std::make_unique<std::thread>(&RoomHost::ServiceLoop, this);
+}
+
+void RoomHost::Stop() {
+    if (service_thread) {
+        running = false;
+        service_thread->join();
+        service_thread.reset();
+    }
+    for (auto& room : rooms) {
+        if (room->GetState() == Room::State::Open) {
+            room->room_impl->SendCloseMessage();
+            room->Destroy();
+        }
+    }
+    rooms.clear();
+}
+
+void RoomHost::ServiceLoop() {
+    for (auto& room : rooms) {
+        room->room_impl->last_traffic_report = std::chrono::steady_clock::now();
+    }
+    while (running) {
+        ENetSocketSet read_set;
+        ENET_SOCKETSET_EMPTY(read_set);
+        ENetSocket max_socket = 0;
+        for (const auto& room : rooms) {
+            const ENetSocket socket = room->room_impl->server->socket;
+            ENET_SOCKETSET_ADD(read_set, socket);
+            max_socket = std::max(max_socket, socket);
+        }
+        // One wait covers the sockets of every room. The timeout keeps the resends and timeouts
+        // of ENet going for rooms that receive nothing, as the thread of a single room does.
+        enet_socketset_select(max_socket, &read_set, nullptr, 16);
+        for (auto& room : rooms) {
+            room->room_impl->ReportTrafficStats();
+            room->room_impl->ServiceEvents();
+        }
+    }
+}
+
 } // namespace Network
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include "common/common_types.h"
 #include "network/verify_user.h"
@@ -139,6 +141,8 @@ public:
     /**
      * Creates the socket for this room. Will bind to default address if
      * server is empty string.
+     * @param own_thread Whether the room services its socket from a thread of its own. Rooms
+     * created without one have to be added to a RoomHost.
      */
     bool Create(const std::string& name, const std::string& description = "",
                 const std::string& server = "", u16 server_port = DefaultRoomPort,
@@ -147,7 +151,7 @@ public:
                 const std::string& host_username = "", const std::string& preferred_game = "",
                 u64 preferred_game_id = 0,
                 std::unique_ptr<VerifyUser::Backend> verify_backend = nullptr,
-                const BanList& ban_list = {});
+                const BanList& ban_list = {}, bool own_thread = true);
 
     /**
      * Sets the verification GUID of the room.
@@ -165,8 +169,50 @@ public:
     void Destroy();
 
 private:
+    friend class RoomHost;
+
     class RoomImpl;
     std::unique_ptr<RoomImpl> room_impl;
 };
 
+/**
+ * Services the sockets of several rooms from a single thread, so that a process hosting many
+ * rooms does not wake up a thread per room. Each room keeps its own members, ban list and
+ * settings; only the thread waiting for their packets is shared.
+ */
+class RoomHost final {
+public:
+    RoomHost();
+    ~RoomHost();
+
+    /**
+     * Adds a room that was created without a thread of its own. Rooms can only be added while
+     * the host is not running.
+     */
+    void AddRoom(std::shared_ptr<Room> room);
+
+    /**
+     * Gets the rooms serviced by this host.
+     */
+    const std::vector<std::shared_ptr<Room>>& GetRooms() const;
+
+    /**
+     * Starts the thread servicing the rooms.
+     */
+    void Start();
+
+    /**
+     * Stops the thread and closes every room, telling their members that the room was closed.
+     */
+    void Stop();
+
+private:
+    /// Thread function that waits for packets on any of the rooms and dispatches them.
+    void ServiceLoop();
+
+    std::vector<std::shared_ptr<Room>> rooms;
+    std::atomic_bool running{false};
+    std::unique_ptr<std::thread> service_thread;
+};
+
 } // namespace Network
@@ -0,0 +1,92 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/mixing_simd.h"
+
+namespace {
+
+using namespace AudioCore;
+
+constexpr std::array<float, 5> Gains{0.0f, 0.3125f, 1.0f, 1.7f, -2.5f};
+
+s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+s16 AddAndClampToS16(s16 a, s16 b) {
+    return ClampToS16(static_cast<s32>(a) + static_cast<s32>(b));
+}
+
+StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+    }
+    return frame;
+}
+
+QuadFrame32 RandomQuadFrame(std::mt19937& rng) {
+    // Wide enough for the downmix to saturate.
+    std::uniform_int_distribution<s32> dist(-100000, 100000);
+    QuadFrame32 frame;
+    for (auto& sample : frame) {
+        sample = {dist(rng), dist(rng), dist(rng), dist(rng)};
+    }
+    return frame;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("HLE Mixing[MixStereoIntoQuad]", "[audio_core][hle]") {
+    std::mt19937 rng(1234);
+    for (const float gain : Gains) {
+        const std::array<float, 4> gains{gain, gain * 0.5f, -gain, 0.75f};
+        const StereoFrame16 frame = RandomStereoFrame(rng);
+        QuadFrame32 dest = RandomQuadFrame(rng);
+        QuadFrame32 expected = dest;
+
+        for (std::size_t i = 0; i < samples_per_frame; i++) {
+            expected[i][0] += static_cast<s32>(gains[0] * frame[i][0]);
+            expected[i][1] += static_cast<s32>(gains[1] * frame[i][1]);
+            expected[i][2] += static_cast<s32>(gains[2] * frame[i][0]);
+            expected[i][3] += static_cast<s32>(gains[3] * frame[i][1]);
+        }
+        HLE::MixStereoIntoQuad(dest, frame, gains);
+        REQUIRE(dest == expected);
+    }
+}
+
+TEST_CASE("HLE Mixing[Downmix]", "[audio_core][hle]") {
+    std::mt19937 rng(5678);
+    for (const float gain : Gains) {
+        const QuadFrame32 samples = RandomQuadFrame(rng);
+        const StereoFrame16 accumulator = RandomStereoFrame(rng);
+
+        StereoFrame16 stereo = accumulator;
+        StereoFrame16 mono = accumulator;
+        StereoFrame16 expected_stereo;
+        StereoFrame16 expected_mono;
+        for (std::size_t i = 0; i < samples_per_frame; i++) {
+            const auto& s = samples[i];
+            const s16 left = ClampToS16(static_cast<s32>(gain * s[0] + gain * s[2]));
+            const s16 right = ClampToS16(static_cast<s32>(gain * s[1] + gain * s[3]));
+            expected_stereo[i] = {AddAndClampToS16(accumulator[i][0], left),
+                                  AddAndClampToS16(accumulator[i][1], right)};
+
+            const s16 downmix = ClampToS16(
+                static_cast<s32>((gain * s[0] + gain * s[1] + gain * s[2] + gain * s[3]) / 2));
+            expected_mono[i] = {AddAndClampToS16(accumulator[i][0], downmix),
+                                AddAndClampToS16(accumulator[i][1], downmix)};
+        }
+
+        HLE::DownmixStereoInto(stereo, samples, gain);
+        HLE::DownmixMonoInto(mono, samples, gain);
+        REQUIRE(stereo == expected_stereo);
+        REQUIRE(mono == expected_mono);
+    }
+}
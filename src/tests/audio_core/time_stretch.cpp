@@ -0,0 +1,71 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/time_stretch.h"
+
+namespace {
+
+using namespace AudioCore;
+
+constexpr std::size_t CallbackFrames = 256;
+
+/// Feeds the corrector as if the emulated clock ran `clock_ratio` times as fast as the host one,
+/// and checks that every callback is filled once the ratio has settled.
+void RunWithClockRatio(double clock_ratio) {
+    DriftCorrector corrector;
+    std::vector<s16> in;
+    std::vector<s16> out(2 * CallbackFrames);
+    double pending = 0.0;
+    s16 sample = 0;
+
+    for (int callback = 0; callback < 4000; callback++) {
+        pending += CallbackFrames * clock_ratio;
+        const auto num_in = static_cast<std::size_t>(pending);
+        pending -= static_cast<double>(num_in);
+
+        in.resize(2 * num_in);
+        for (std::size_t i = 0; i < num_in; i++) {
+            in[2 * i] = in[2 * i + 1] = sample++;
+        }
+
+        const std::size_t written =
+            corrector.Process(in.data(), num_in, out.data(), CallbackFrames);
+        if (callback >= 2000) {
+            REQUIRE(written == CallbackFrames);
+            REQUIRE(corrector.Backlog() < 2 * (CallbackFrames + 2 * samples_per_frame));
+        }
+    }
+
+    REQUIRE(std::abs(corrector.Ratio() - clock_ratio) < 0.0005);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DriftCorrector[Settle]", "[audio_core]") {
+    RunWithClockRatio(1.0);
+    RunWithClockRatio(1.003);
+    RunWithClockRatio(0.997);
+}
+
+TEST_CASE("DriftCorrector[Passthrough]", "[audio_core]") {
+    // A backlog right on target leaves the ratio at 1, so the input comes out untouched behind the
+    // two history samples.
+    constexpr std::size_t NumIn = CallbackFrames + 2 * samples_per_frame;
+    DriftCorrector corrector;
+    std::vector<s16> in(2 * NumIn);
+    for (std::size_t i = 0; i < in.size(); i++) {
+        in[i] = static_cast<s16>(i);
+    }
+
+    std::vector<s16> out(2 * CallbackFrames);
+    REQUIRE(corrector.Process(in.data(), NumIn, out.data(), CallbackFrames) == CallbackFrames);
+    REQUIRE(corrector.Ratio() == 1.0);
+    for (std::size_t i = 2; i < CallbackFrames; i++) {
+        REQUIRE(out[2 * i] == in[2 * (i - 2)]);
+        REQUIRE(out[2 * i + 1] == in[2 * (i - 2) + 1]);
+    }
+}
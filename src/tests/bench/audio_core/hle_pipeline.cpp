@@ -0,0 +1,169 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/mixers.h"
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "common/settings.h"
+#include "core/memory.h"
+#include "tests/audio_core/merryhime_3ds_audio/merry_audio/merry_audio.h"
+
+namespace {
+
+using namespace AudioCore::HLE;
+using AudioCore::QuadFrame32;
+using Configuration = SourceConfiguration::Configuration;
+
+/// Long enough that the looping buffers are not restarted within a benchmark sample.
+constexpr u32 NumSamples = 14 * 160 * 64;
+constexpr std::size_t AdpcmBytes = NumSamples / 14 * 8;
+
+/// Fills `data` with ADPCM frames of random nibbles, using every predictor and a moderate scale.
+void FillAdpcm(u8* data, std::mt19937& rng) {
+    std::uniform_int_distribution<int> byte(0, 0xFF);
+    for (std::size_t i = 0; i < AdpcmBytes; i++) {
+        data[i] = static_cast<u8>(byte(rng));
+        if (i % 8 == 0) {
+            data[i] = static_cast<u8>(((i / 8) % 8) << 4 | (data[i] % 12));
+        }
+    }
+}
+
+void FillCoefficients(s16_le (&coeffs)[16], std::mt19937& rng) {
+    std::uniform_int_distribution<int> coeff(-2048, 2047);
+    for (auto& c : coeffs) {
+        c = static_cast<s16>(coeff(rng));
+    }
+}
+
+/// Plays a looping mono ADPCM buffer through a biquad filter into every intermediate mix.
+void ConfigureSource(Configuration& config, PAddr address, u8 first_header) {
+    config.enable = true;
+    config.enable_dirty.Assign(true);
+
+    config.interpolation_mode = Configuration::InterpolationMode::Polyphase;
+    config.interpolation_dirty.Assign(true);
+    config.rate_multiplier = 1.0f;
+    config.rate_multiplier_dirty.Assign(true);
+
+    for (auto& gain : config.gain) {
+        for (auto& g : gain) {
+            g = 0.5f;
+        }
+    }
+    config.gain_0_dirty.Assign(true);
+    config.gain_1_dirty.Assign(true);
+    config.gain_2_dirty.Assign(true);
+
+    config.biquad_filter_enabled.Assign(true);
+    config.biquad_filter.b0 = 0x0EA6;
+    config.biquad_filter.b1 = 0x1D4C;
+    config.biquad_filter.b2 = 0x0EA6;
+    config.biquad_filter.a1 = 0x4E02;
+    config.biquad_filter.a2 = -0x1C96;
+    config.filters_enabled_dirty.Assign(true);
+    config.biquad_filter_dirty.Assign(true);
+
+    config.physical_address = address;
+    config.length = NumSamples;
+    config.mono_or_stereo.Assign(Configuration::MonoOrStereo::Mono);
+    config.format.Assign(Configuration::Format::ADPCM);
+    config.adpcm_ps = first_header;
+    config.adpcm_yn[0] = 0;
+    config.adpcm_yn[1] = 0;
+    config.adpcm_dirty.Assign(true);
+    config.adpcm_coefficients_dirty.Assign(true);
+    config.is_looping.Assign(true);
+    config.buffer_id = 1;
+    config.play_position = 0;
+    config.play_position_dirty.Assign(true);
+    config.partial_reset_flag.Assign(true);
+    config.embedded_buffer_dirty.Assign(true);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("HLE DSP pipeline stages", "[audio_core][hle]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    std::mt19937 rng{0x3D5};
+
+    SourceConfiguration source_configs{};
+    AdpcmCoefficients adpcm_coefficients{};
+    std::vector<Source> sources;
+    for (std::size_t i = 0; i < num_sources; i++) {
+        const std::size_t offset = i * AdpcmBytes;
+        u8* const data = memory.GetFCRAMPointer(offset);
+        FillAdpcm(data, rng);
+        FillCoefficients(adpcm_coefficients.coeff[i], rng);
+        ConfigureSource(source_configs.config[i],
+                        static_cast<PAddr>(Memory::FCRAM_PADDR + offset), data[0]);
+
+        sources.emplace_back(i);
+        sources.back().SetMemory(memory);
+    }
+
+    DspConfiguration dsp_config{};
+    IntermediateMixSamples read_samples{};
+    IntermediateMixSamples write_samples{};
+    Mixers mixers;
+    std::array<QuadFrame32, 3> intermediate_mixes{};
+
+    BENCHMARK("Decode and filter 24 ADPCM sources") {
+        for (std::size_t i = 0; i < num_sources; i++) {
+            sources[i].Tick(source_configs.config[i], adpcm_coefficients.coeff[i]);
+        }
+        return sources.size();
+    };
+
+    BENCHMARK("Mix 24 sources into the intermediate mixes") {
+        intermediate_mixes = {};
+        for (const auto& source : sources) {
+            for (std::size_t mix = 0; mix < intermediate_mixes.size(); mix++) {
+                source.MixInto(intermediate_mixes[mix], mix);
+            }
+        }
+        return intermediate_mixes[0][0][0];
+    };
+
+    BENCHMARK("Final mix") {
+        return mixers.Tick(dsp_config, read_samples, write_samples, intermediate_mixes).unknown;
+    };
+}
+
+TEST_CASE_METHOD(MerryAudio::MerryAudioFixture, "HLE DSP frame with 24 ADPCM sources",
+                 "[audio_core][hle]") {
+    std::mt19937 rng{0x3D5};
+    std::array<u8*, AudioCore::HLE::num_sources> buffers;
+    for (auto& buffer : buffers) {
+        buffer = static_cast<u8*>(linearAlloc(AdpcmBytes));
+        FillAdpcm(buffer, rng);
+        DSP_FlushDataCache(buffer, AdpcmBytes);
+    }
+
+    InitDspCore(Settings::AudioEmulation::HLE);
+    // The HLE DSP does not need a valid firmware.
+    auto state = audioInit({0});
+    REQUIRE(state);
+
+    state->waitForSync();
+    initSharedMem(*state);
+    for (std::size_t i = 0; i < buffers.size(); i++) {
+        FillCoefficients(state->write().adpcm_coefficients->coeff[i], rng);
+        ConfigureSource(state->write().source_configurations->config[i],
+                        osConvertVirtToPhys(buffers[i]), buffers[i][0]);
+    }
+    state->notifyDsp();
+
+    BENCHMARK("Generate one DSP frame") {
+        state->waitForSync();
+        state->notifyDsp();
+        return state->frame_id;
+    };
+
+    audioExit(*state);
+}
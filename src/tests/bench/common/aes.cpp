@@ -0,0 +1,30 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/aes.h"
+
+TEST_CASE("AES CTR throughput", "[common][aes]") {
+    constexpr std::array<u8, 16> key{0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                                     0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+    constexpr std::array<u8, 16> counter{};
+    Common::AES::CTR ctr(key.data(), key.size(), counter.data());
+    std::vector<u8> data(1 << 20);
+
+    BENCHMARK("Decrypt 1MB") {
+        ctr.ProcessData(data.data(), data.data(), data.size());
+        return data[0];
+    };
+
+    BENCHMARK("Decrypt 1MB in 0x200 byte sectors") {
+        for (std::size_t offset = 0; offset < data.size(); offset += 0x200) {
+            ctr.Seek(offset);
+            ctr.ProcessData(data.data() + offset, data.data() + offset, 0x200);
+        }
+        return data[0];
+    };
+}
@@ -0,0 +1,57 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "common/zstd_compression.h"
+
+namespace {
+
+/// Resembles the memory in a savestate: mostly empty pages between pages of varied data.
+std::vector<u8> MakeSaveStateData(std::size_t size) {
+    constexpr std::size_t page_size = 0x1000;
+    std::mt19937 rng{0x5A7E};
+    std::uniform_int_distribution<u32> byte{0, 255};
+    std::vector<u8> data(size);
+    for (std::size_t page = 0; page < size / page_size; page++) {
+        if (page % 4 != 0) {
+            continue;
+        }
+        for (std::size_t i = 0; i < page_size; i++) {
+            // Small values are far more common than large ones
+            data[page * page_size + i] = static_cast<u8>(byte(rng) % (i % 64 == 0 ? 256 : 16));
+        }
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Zstandard savestate compression", "[common][zstd]") {
+    const auto data = MakeSaveStateData(32 * 1024 * 1024);
+    const auto compressed = Common::Compression::CompressDataZSTDDefault(data);
+
+    BENCHMARK("Compress 32MB") {
+        return Common::Compression::CompressDataZSTDDefault(data).size();
+    };
+
+    BENCHMARK("Decompress 32MB") {
+        return Common::Compression::DecompressDataZSTD(compressed).size();
+    };
+
+    const std::string path = "./bench_savestate.bin";
+    BENCHMARK("Stream 32MB to a file with 4 workers") {
+        FileUtil::IOFile file(path, "wb");
+        Common::Compression::ZSTDOutputStreamBuf stream{file, 3, 4};
+        std::ostream os{&stream};
+        os.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return stream.Finish();
+    };
+    FileUtil::Delete(path);
+}
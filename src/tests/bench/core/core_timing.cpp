@@ -0,0 +1,82 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core_timing.h"
+
+TEST_CASE("CoreTiming schedule and advance", "[core][core_timing]") {
+    Core::Timing timing(1, 100);
+    auto* timer = timing.GetTimer(0).get();
+
+    static u64 callbacks_ran = 0;
+    Core::TimingEventType* event =
+        timing.RegisterEvent("benchmark", [](std::uintptr_t, s64) { ++callbacks_ran; });
+
+    // Enter slice 0
+    timer->Advance();
+    timer->SetNextSlice();
+
+    constexpr int num_events = 1000;
+    BENCHMARK("Schedule and run " + std::to_string(num_events) + " events") {
+        for (int i = 0; i < num_events; i++) {
+            // Spread the events over the slice so that the queue has to be kept ordered
+            timing.ScheduleEvent((i * 7919) % 10000 + 1, event, i, 0);
+        }
+        const u64 target = callbacks_ran + num_events;
+        while (callbacks_ran < target) {
+            timer->AddTicks(timer->GetDowncount());
+            timer->Advance();
+            timer->SetNextSlice();
+        }
+        return callbacks_ran;
+    };
+}
+
+TEST_CASE("CoreTiming thread safe scheduling", "[core][core_timing]") {
+    Core::Timing timing(1, 100);
+    auto timer = timing.GetTimer(0);
+
+    static u64 callbacks_ran = 0;
+    Core::TimingEventType* event =
+        timing.RegisterEvent("benchmark_ts", [](std::uintptr_t, s64) { ++callbacks_ran; });
+
+    // Enter slice 0
+    timer->Advance();
+    timer->SetNextSlice();
+
+    static constexpr u32 num_producers = 4;
+    static constexpr u32 events_per_producer = 1000;
+    BENCHMARK("Schedule and advance " + std::to_string(num_producers * events_per_producer) +
+              " events from " + std::to_string(num_producers) + " threads") {
+        const u64 target = callbacks_ran + num_producers * events_per_producer;
+        std::atomic<u32> producers_done = 0;
+        {
+            std::array<std::jthread, num_producers> producers;
+            for (auto& producer : producers) {
+                producer = std::jthread([&timing, &producers_done, event] {
+                    for (u32 i = 0; i < events_per_producer; i++) {
+                        timing.ScheduleEvent(0, event, i, 0, true);
+                    }
+                    ++producers_done;
+                });
+            }
+            while (producers_done != num_producers) {
+                timer->MoveEvents();
+            }
+        }
+
+        // Thread safe events are scheduled at least two slices ahead.
+        while (callbacks_ran < target) {
+            timer->AddTicks(timer->GetDowncount());
+            timer->Advance();
+            timer->SetNextSlice();
+        }
+        return callbacks_ran;
+    };
+}
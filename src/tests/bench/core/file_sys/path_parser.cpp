@@ -0,0 +1,34 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/path_parser.h"
+
+namespace FileSys {
+
+TEST_CASE("PathParser throughput", "[core][file_sys]") {
+    std::string test_dir = "./test";
+    FileUtil::CreateDir(test_dir);
+    FileUtil::CreateDir(test_dir + "/data");
+    FileUtil::CreateEmptyFile(test_dir + "/data/save.bin");
+
+    const Path path("/data/./save.bin");
+    PathCache cache;
+
+    BENCHMARK("Parse and check host status") {
+        const PathParser parser(path);
+        return parser.GetHostStatus(test_dir);
+    };
+
+    BENCHMARK("Resolve through the cache") {
+        return cache.Resolve(path, test_dir).status;
+    };
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
+} // namespace FileSys
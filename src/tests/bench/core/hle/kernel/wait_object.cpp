@@ -0,0 +1,45 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+
+TEST_CASE("WaitObject wait all and time out", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(memory, timing, [] {}, Kernel::MemoryMode::NewProd, 1);
+
+    constexpr std::size_t num_events = 64;
+    std::vector<std::shared_ptr<Kernel::WaitObject>> events;
+    for (std::size_t i = 0; i < num_events; ++i) {
+        events.push_back(kernel.CreateEvent(Kernel::ResetType::OneShot));
+    }
+    auto thread = std::make_shared<Kernel::Thread>(kernel, 0);
+    thread->current_priority = Kernel::ThreadPrioDefault;
+
+    BENCHMARK("Wait on " + std::to_string(num_events) + " objects and time out") {
+        // Sleep on all the objects the way WaitSynchronizationN does with wait_all, then take the
+        // thread off their lists the way a wait timeout does.
+        thread->status = Kernel::ThreadStatus::WaitSynchAll;
+        for (const auto& event : events) {
+            event->AddWaitingThread(thread);
+        }
+        thread->wait_objects = events;
+        for (const auto& event : thread->wait_objects) {
+            event->RemoveWaitingThread(thread.get());
+        }
+        thread->wait_objects.clear();
+        return thread->num_waiter_nodes_used;
+    };
+}
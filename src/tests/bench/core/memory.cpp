@@ -0,0 +1,31 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+
+TEST_CASE("MemorySystem::ReadBlock", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(memory, timing, [] {}, Kernel::MemoryMode::NewProd, 1);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+
+    const std::size_t size = GENERATE(0x10, 0x200, 0x1000, 0x10000);
+    std::vector<u8> buffer(size);
+
+    BENCHMARK("Read " + std::to_string(size) + " bytes") {
+        memory.ReadBlock(*process, Memory::VRAM_VADDR + 0x100, buffer.data(), buffer.size());
+        return buffer[0];
+    };
+}
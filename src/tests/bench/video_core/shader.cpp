@@ -0,0 +1,155 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/shader/shader_interpreter.h"
+#if CITRA_ARCH(x86_64)
+#include "video_core/shader/shader_jit_x64_compiler.h"
+#elif CITRA_ARCH(arm64)
+#include "video_core/shader/shader_jit_a64_compiler.h"
+#endif
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+using Type = nihstro::InlineAsm::Type;
+
+namespace {
+
+/// Number of vertices each benchmark sample runs the shader for
+constexpr u32 NUM_VERTICES = 1024;
+
+std::unique_ptr<Pica::ShaderSetup> CompileShaderSetup(
+    std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    auto shader = std::make_unique<Pica::ShaderSetup>();
+    Pica::ProgramCode program_code{};
+    Pica::SwizzleData swizzle_data{};
+    std::transform(shbin.program.begin(), shbin.program.end(), program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+                   [](const auto& x) { return x.hex; });
+
+    shader->UpdateProgramCode(program_code);
+    shader->UpdateSwizzleData(swizzle_data);
+    for (std::size_t i = 0; i < shader->uniforms.f.size(); i++) {
+        const auto value = Pica::f24::FromFloat32(0.25f * static_cast<float>(i % 8));
+        shader->uniforms.f[i] = Common::Vec4<Pica::f24>::AssignToAll(value);
+    }
+    shader->uniforms.i[0] = {15, 0, 1, 0};
+
+    return shader;
+}
+
+struct OpcodeMix {
+    std::string name;
+    std::unique_ptr<Pica::ShaderSetup> shader_setup;
+};
+
+/// Vertex shaders representative of the instruction mixes games use
+OpcodeMix MakeOpcodeMix(int mix) {
+    const auto in_pos = SourceRegister::MakeInput(0);
+    const auto in_color = SourceRegister::MakeInput(1);
+    const auto temp = SourceRegister::MakeTemporary(0);
+    const auto out_pos = DestRegister::MakeOutput(0);
+    const auto out_color = DestRegister::MakeOutput(1);
+
+    switch (mix) {
+    case 0:
+        return {"transform", CompileShaderSetup({
+                                 {OpCode::Id::DP4, temp, in_pos, SourceRegister::MakeFloat(0)},
+                                 {OpCode::Id::DP4, temp, in_pos, SourceRegister::MakeFloat(1)},
+                                 {OpCode::Id::DP4, temp, in_pos, SourceRegister::MakeFloat(2)},
+                                 {OpCode::Id::DP4, temp, in_pos, SourceRegister::MakeFloat(3)},
+                                 {OpCode::Id::DP4, out_pos, temp, SourceRegister::MakeFloat(4)},
+                                 {OpCode::Id::MOV, out_color, in_color},
+                                 {OpCode::Id::END},
+                             })};
+    case 1:
+        return {"arithmetic", CompileShaderSetup({
+                                  {OpCode::Id::ADD, temp, in_pos, in_color},
+                                  {OpCode::Id::MUL, temp, temp, in_pos},
+                                  {OpCode::Id::MAX, temp, temp, in_color},
+                                  {OpCode::Id::MIN, temp, temp, SourceRegister::MakeFloat(5)},
+                                  {OpCode::Id::DP3, temp, temp, in_pos},
+                                  {OpCode::Id::FLR, temp, temp},
+                                  {OpCode::Id::SGE, temp, temp, in_color},
+                                  {OpCode::Id::MOV, out_pos, temp},
+                                  {OpCode::Id::MOV, out_color, in_color},
+                                  {OpCode::Id::END},
+                              })};
+    case 2:
+        return {"transcendental", CompileShaderSetup({
+                                      {OpCode::Id::RCP, temp, in_pos},
+                                      {OpCode::Id::RSQ, temp, temp},
+                                      {OpCode::Id::EX2, temp, temp},
+                                      {OpCode::Id::LG2, temp, temp},
+                                      {OpCode::Id::MOV, out_pos, temp},
+                                      {OpCode::Id::MOV, out_color, in_color},
+                                      {OpCode::Id::END},
+                                  })};
+    default:
+        return {"loop", CompileShaderSetup({
+                            // clang-format off
+                            {OpCode::Id::MOV, temp, in_pos},
+                            {OpCode::Id::LOOP, 0},
+                                {OpCode::Id::ADD, temp, temp, in_color},
+                            {Type::EndLoop},
+                            {OpCode::Id::MOV, out_pos, temp},
+                            {OpCode::Id::MOV, out_color, in_color},
+                            {OpCode::Id::END},
+                            // clang-format on
+                        })};
+    }
+}
+
+void SetupInputs(Pica::ShaderUnit& shader_unit, u32 vertex) {
+    const auto value = Pica::f24::FromFloat32(1.0f + static_cast<float>(vertex % 16) / 16.0f);
+    shader_unit.input[0] = Common::Vec4<Pica::f24>::AssignToAll(value);
+    shader_unit.input[1] = Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::One());
+    shader_unit.temporary.fill(Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::Zero()));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Vertex shader interpreter and JIT", "[video_core][shader]") {
+    const auto mix = MakeOpcodeMix(GENERATE(0, 1, 2, 3));
+    Pica::ShaderSetup& setup = *mix.shader_setup;
+
+    Pica::Shader::InterpreterEngine interpreter;
+    interpreter.SetupBatch(setup, 0);
+    Pica::Shader::JitShader jit;
+    jit.Compile(&setup.GetProgramCode(), &setup.GetSwizzleData());
+
+    Pica::ShaderUnit shader_unit;
+    BENCHMARK("Interpreter " + mix.name + " " + std::to_string(NUM_VERTICES) + " vertices") {
+        for (u32 vertex = 0; vertex < NUM_VERTICES; vertex++) {
+            SetupInputs(shader_unit, vertex);
+            interpreter.Run(setup, shader_unit);
+        }
+        return shader_unit.output[0].x.ToFloat32();
+    };
+
+    BENCHMARK("JIT " + mix.name + " " + std::to_string(NUM_VERTICES) + " vertices") {
+        for (u32 vertex = 0; vertex < NUM_VERTICES; vertex++) {
+            SetupInputs(shader_unit, vertex);
+            jit.Run(setup, shader_unit, 0);
+        }
+        return shader_unit.output[0].x.ToFloat32();
+    };
+}
+
+#endif
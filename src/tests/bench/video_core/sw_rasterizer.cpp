@@ -0,0 +1,80 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <bit>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "core/core.h"
+#include "core/memory.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/renderer_software/sw_rasterizer.h"
+
+using Pica::f24;
+using Pica::FramebufferRegs;
+
+namespace {
+
+constexpr u32 WIDTH = 400;
+constexpr u32 HEIGHT = 240;
+
+/// Returns the raw float24 encoding of a positive normal value.
+u32 ToFloat24Raw(float value) {
+    const u32 hex = std::bit_cast<u32>(value);
+    const u32 exponent = ((hex >> 23) & 0xFF) - 64;
+    return (exponent << 16) | ((hex & 0x7FFFFF) >> 7);
+}
+
+Pica::OutputVertex MakeVertex(float x, float y) {
+    Pica::OutputVertex vertex{};
+    vertex.pos = {f24::FromFloat32(x), f24::FromFloat32(y), f24::FromFloat32(0.5f), f24::One()};
+    vertex.color = {f24::FromFloat32(0.5f), f24::FromFloat32(0.25f), f24::One(), f24::One()};
+    return vertex;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Software rasterizer triangles", "[video_core][renderer_software]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Pica::PicaCore pica{memory, nullptr};
+
+    // Render the triangles to a top screen sized RGBA8 color buffer in VRAM
+    auto& regs = pica.regs.internal;
+    auto& framebuffer = regs.framebuffer.framebuffer;
+    framebuffer.color_buffer_address.Assign(Memory::VRAM_PADDR / 8);
+    framebuffer.color_format.Assign(FramebufferRegs::ColorFormat::RGBA8);
+    framebuffer.width.Assign(WIDTH);
+    framebuffer.height.Assign(HEIGHT - 1);
+    framebuffer.allow_color_write.Assign(0xF);
+    auto& output_merger = regs.framebuffer.output_merger;
+    output_merger.red_enable.Assign(1);
+    output_merger.green_enable.Assign(1);
+    output_merger.blue_enable.Assign(1);
+    output_merger.alpha_enable.Assign(1);
+    regs.rasterizer.viewport_size_x.Assign(ToFloat24Raw(WIDTH / 2.0f));
+    regs.rasterizer.viewport_size_y.Assign(ToFloat24Raw(HEIGHT / 2.0f));
+
+    SwRenderer::RasterizerSoftware rasterizer{memory, pica};
+
+    // Triangles covering roughly the given number of pixels each, spread over the screen
+    const u32 triangle_size = GENERATE(16u, 64u, 256u);
+    const u32 num_triangles = 256;
+    const float half_width = static_cast<float>(triangle_size) / WIDTH;
+    const float half_height = static_cast<float>(triangle_size) / HEIGHT;
+
+    BENCHMARK(std::to_string(num_triangles) + " triangles of " + std::to_string(triangle_size) +
+              "x" + std::to_string(triangle_size) + " pixels") {
+        for (u32 i = 0; i < num_triangles; i++) {
+            const float x = -0.75f + 1.5f * static_cast<float>(i % 16) / 16.0f;
+            const float y = -0.75f + 1.5f * static_cast<float>(i / 16) / 16.0f;
+            rasterizer.AddTriangle(MakeVertex(x - half_width, y - half_height),
+                                   MakeVertex(x + half_width, y - half_height),
+                                   MakeVertex(x, y + half_height));
+        }
+        rasterizer.DrawTriangles();
+        return memory.GetPhysicalPointer(Memory::VRAM_PADDR)[0];
+    };
+}
@@ -0,0 +1,97 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "video_core/rasterizer_cache/texture_codec.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
+
+using namespace VideoCore;
+
+namespace {
+
+constexpr u32 WIDTH = 256;
+constexpr u32 HEIGHT = 256;
+
+std::vector<u8> RandomBytes(std::size_t size) {
+    std::mt19937 rng{static_cast<u32>(size)};
+    std::uniform_int_distribution<u32> dist{0, 255};
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return data;
+}
+
+std::size_t TiledSize(PixelFormat format) {
+    return WIDTH * HEIGHT * GetFormatBpp(format) / 8;
+}
+
+std::size_t LinearSize(PixelFormat format, bool converted) {
+    return WIDTH * HEIGHT * (converted ? 4 : GetFormatBytesPerPixel(format));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Texture decode", "[video_core][texture_codec]") {
+    const auto format = static_cast<PixelFormat>(GENERATE(range(0u, 18u)));
+    const bool converted = GENERATE(false, true);
+    const std::size_t index = static_cast<std::size_t>(format);
+    const MortonFunc scalar_func = (converted ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[index];
+    if (!scalar_func) {
+        return;
+    }
+    const MortonFunc vector_func = GetVectorizedMortonFunc(format, true, converted);
+
+    const std::size_t tiled_size = TiledSize(format);
+    auto tiled = RandomBytes(tiled_size);
+    std::vector<u8> linear(LinearSize(format, converted));
+    const std::string name =
+        std::string{PixelFormatAsString(format)} + (converted ? " to RGBA8" : "");
+
+    BENCHMARK("Scalar decode " + name) {
+        scalar_func(WIDTH, HEIGHT, 0, static_cast<u32>(tiled_size), linear, tiled);
+        return linear[0];
+    };
+
+    if (vector_func) {
+        BENCHMARK("Vectorized decode " + name) {
+            vector_func(WIDTH, HEIGHT, 0, static_cast<u32>(tiled_size), linear, tiled);
+            return linear[0];
+        };
+    }
+}
+
+TEST_CASE("Texture encode", "[video_core][texture_codec]") {
+    const auto format = static_cast<PixelFormat>(GENERATE(range(0u, 18u)));
+    const bool converted = GENERATE(false, true);
+    const std::size_t index = static_cast<std::size_t>(format);
+    const MortonFunc scalar_func = (converted ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[index];
+    if (!scalar_func) {
+        return;
+    }
+    const MortonFunc vector_func = GetVectorizedMortonFunc(format, false, converted);
+
+    const std::size_t tiled_size = TiledSize(format);
+    std::vector<u8> tiled(tiled_size);
+    auto linear = RandomBytes(LinearSize(format, converted));
+    const std::string name =
+        std::string{PixelFormatAsString(format)} + (converted ? " from RGBA8" : "");
+
+    BENCHMARK("Scalar encode " + name) {
+        scalar_func(WIDTH, HEIGHT, 0, static_cast<u32>(tiled_size), linear, tiled);
+        return tiled[0];
+    };
+
+    if (vector_func) {
+        BENCHMARK("Vectorized encode " + name) {
+            vector_func(WIDTH, HEIGHT, 0, static_cast<u32>(tiled_size), linear, tiled);
+            return tiled[0];
+        };
+    }
+}
@@ -0,0 +1,55 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/memory.h"
+#include "video_core/pica/vertex_loader.h"
+
+using Format = Pica::PipelineRegs::VertexAttributeFormat;
+
+TEST_CASE("Vertex loader", "[video_core][vertex_loader]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+
+    // Interleaved position (3 floats), color (4 unsigned bytes) and texture coordinates
+    // (2 shorts), the most common layout.
+    constexpr u32 stride = 3 * 4 + 4 + 2 * 2;
+    constexpr u32 num_vertices = 4096;
+    std::memset(memory.GetFCRAMPointer(0), 0x3F, stride * num_vertices);
+
+    Pica::PipelineRegs regs{};
+    auto& attributes = regs.vertex_attributes;
+    attributes.base_address.Assign(Memory::FCRAM_PADDR / 16);
+    attributes.format0.Assign(Format::FLOAT);
+    attributes.size0.Assign(2);
+    attributes.format1.Assign(Format::UBYTE);
+    attributes.size1.Assign(3);
+    attributes.format2.Assign(Format::SHORT);
+    attributes.size2.Assign(1);
+    attributes.max_attribute_index.Assign(2);
+
+    auto& loader = attributes.attribute_loaders[0];
+    loader.data_offset.Assign(0);
+    loader.comp0.Assign(0);
+    loader.comp1.Assign(1);
+    loader.comp2.Assign(2);
+    loader.byte_count.Assign(stride);
+    loader.component_count.Assign(3);
+
+    const Pica::VertexLoader vertex_loader{memory, regs};
+    const PAddr base_address = attributes.GetPhysicalBaseAddress();
+    Pica::AttributeBuffer input{};
+    Pica::AttributeBuffer default_attributes{};
+
+    BENCHMARK("Load " + std::to_string(num_vertices) + " vertices") {
+        for (u32 vertex = 0; vertex < num_vertices; vertex++) {
+            vertex_loader.LoadVertex(base_address, vertex, vertex, input, default_attributes);
+        }
+        return input[0].x.ToFloat32();
+    };
+}
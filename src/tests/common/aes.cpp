@@ -0,0 +1,55 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include "common/aes.h"
+
+namespace {
+
+// NIST SP 800-38A, F.5.1 CTR-AES128.Encrypt. The counter carries into its second to last byte
+// after the second block.
+constexpr std::array<u8, 16> Key = {0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                                    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+constexpr std::array<u8, 16> InitialCounter = {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+                                               0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF};
+constexpr std::array<u8, 64> Plaintext = {
+    0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+    0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+    0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+    0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10,
+};
+constexpr std::array<u8, 64> Ciphertext = {
+    0x87, 0x4D, 0x61, 0x91, 0xB6, 0x20, 0xE3, 0x26, 0x1B, 0xEF, 0x68, 0x64, 0x99, 0x0D, 0xB6, 0xCE,
+    0x98, 0x06, 0xF6, 0x6B, 0x79, 0x70, 0xFD, 0xFF, 0x86, 0x17, 0x18, 0x7B, 0xB9, 0xFF, 0xFD, 0xFF,
+    0x5A, 0xE4, 0xDF, 0x3E, 0xDB, 0xD5, 0xD3, 0x5E, 0x5B, 0x4F, 0x09, 0x02, 0x0D, 0xB0, 0x3E, 0xAB,
+    0x1E, 0x03, 0x1D, 0xDA, 0x2F, 0xBE, 0x03, 0xD1, 0x79, 0x21, 0x70, 0xA0, 0xF3, 0x00, 0x9C, 0xEE,
+};
+
+} // Anonymous namespace
+
+TEST_CASE("AES CTR matches the NIST vectors", "[common]") {
+    Common::AES::CTR ctr(Key.data(), Key.size(), InitialCounter.data());
+    std::array<u8, 64> out{};
+    ctr.ProcessData(out.data(), Plaintext.data(), out.size());
+    REQUIRE(out == Ciphertext);
+}
+
+TEST_CASE("AES CTR handles partial blocks and seeking", "[common]") {
+    Common::AES::CTR ctr(Key.data(), Key.size(), InitialCounter.data());
+    std::array<u8, 64> out{};
+
+    // Uneven pieces go through the buffered key stream of a partial block.
+    ctr.ProcessData(out.data(), Plaintext.data(), 5);
+    ctr.ProcessData(out.data() + 5, Plaintext.data() + 5, 30);
+    ctr.ProcessData(out.data() + 35, Plaintext.data() + 35, 29);
+    REQUIRE(out == Ciphertext);
+
+    out = Plaintext;
+    ctr.Seek(21);
+    ctr.ProcessData(out.data() + 21, out.data() + 21, 43);
+    ctr.Seek(0);
+    ctr.ProcessData(out.data(), out.data(), 21);
+    REQUIRE(out == Ciphertext);
+}
@@ -0,0 +1,55 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include <catch2/catch_test_macros.hpp>
+#include "common/memory_accounting.h"
+
+using namespace Common::MemoryAccounting;
+
+namespace {
+
+u64 Current(Category category) {
+    return GetUsage().current[static_cast<std::size_t>(category)];
+}
+
+u64 Peak(Category category) {
+    return GetUsage().peak[static_cast<std::size_t>(category)];
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MemoryAccounting: Allocations are freed with their owner", "[common]") {
+    const u64 base = Current(Category::Audio);
+    {
+        Allocation first{Category::Audio, 100};
+        REQUIRE(Current(Category::Audio) == base + 100);
+
+        Allocation second = std::move(first);
+        REQUIRE(Current(Category::Audio) == base + 100);
+
+        second.Resize(40);
+        REQUIRE(Current(Category::Audio) == base + 40);
+        REQUIRE(second.Size() == 40);
+    }
+    REQUIRE(Current(Category::Audio) == base);
+}
+
+TEST_CASE("MemoryAccounting: Peaks keep the highest usage", "[common]") {
+    ResetPeaks();
+    const u64 base = Current(Category::Savestates);
+    Allocate(Category::Savestates, 1000);
+    Free(Category::Savestates, 1000);
+    REQUIRE(Peak(Category::Savestates) == base + 1000);
+    REQUIRE(GetPeakTotal() >= base + 1000);
+
+    ResetPeaks();
+    REQUIRE(Peak(Category::Savestates) == base);
+
+    SetUsage(Category::TextureCache, 500);
+    SetUsage(Category::TextureCache, 200);
+    REQUIRE(Current(Category::TextureCache) == 200);
+    REQUIRE(Peak(Category::TextureCache) == 500);
+    SetUsage(Category::TextureCache, 0);
+}
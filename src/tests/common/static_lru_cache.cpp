@@ -0,0 +1,70 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <mutex>
+#include <utility>
+#include <catch2/catch_test_macros.hpp>
+#include "common/static_lru_cache.h"
+
+namespace Common {
+
+TEST_CASE("StaticLRUCache evicts the least recently used item", "[common]") {
+    StaticLRUCache<std::size_t, int, 3> cache;
+    REQUIRE(cache.empty());
+
+    for (std::size_t key = 0; key < 3; key++) {
+        auto [hit, value] = cache.request(key * 0x1000);
+        REQUIRE(!hit);
+        value = static_cast<int>(key);
+    }
+    REQUIRE(cache.size() == 3);
+
+    // Touching the oldest item makes the second one the next to go
+    REQUIRE(cache.request(0).first);
+    REQUIRE(!cache.request(0x3000).first);
+    REQUIRE(cache.contains(0));
+    REQUIRE(!cache.contains(0x1000));
+    REQUIRE(cache.contains(0x2000));
+    REQUIRE(cache.size() == 3);
+
+    auto [hit, value] = cache.request(0x2000);
+    REQUIRE(hit);
+    REQUIRE(value == 2);
+}
+
+TEST_CASE("StaticLRUCache erase and clear", "[common]") {
+    StaticLRUCache<std::pair<std::size_t, std::size_t>, int, 2> cache;
+    cache.request({0, 16});
+    cache.request({16, 16});
+    REQUIRE(cache.erase({0, 16}));
+    REQUIRE(!cache.erase({0, 16}));
+    REQUIRE(cache.size() == 1);
+
+    // The erased slot is reused before anything is evicted
+    cache.request({32, 16});
+    REQUIRE(cache.contains({16, 16}));
+    REQUIRE(cache.contains({32, 16}));
+
+    cache.clear();
+    REQUIRE(cache.empty());
+    REQUIRE(!cache.contains({16, 16}));
+    REQUIRE(!cache.request({16, 16}).first);
+}
+
+TEST_CASE("ShardedStaticLRUCache", "[common]") {
+    ShardedStaticLRUCache<std::size_t, int, 64, 4> cache;
+    for (std::size_t key = 0; key < 16; key++) {
+        auto& shard = cache.GetShard(key);
+        std::scoped_lock lock{shard.mutex};
+        shard.cache.request(key).second = static_cast<int>(key);
+    }
+    for (std::size_t key = 0; key < 16; key++) {
+        REQUIRE(cache.contains(key));
+        REQUIRE(&cache.GetShard(key) == &cache.GetShard(key));
+    }
+    cache.clear();
+    REQUIRE(!cache.contains(0));
+}
+
+} // namespace Common
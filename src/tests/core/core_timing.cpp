@@ -5,8 +5,10 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <string>
+#include <thread>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -140,6 +142,31 @@ TEST_CASE("CoreTiming[PredictableLateness]", "[core]") {
     AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH, 50, -50);
 }
 
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    timing.ScheduleEvent(100, cb_a, CB_IDS[0], 0);
+    timing.ScheduleEvent(200, cb_b, CB_IDS[1], 0);
+    timing.UnscheduleEvent(cb_a, CB_IDS[0]);
+
+    // The slice still ends at the cancelled event, which must not run.
+    callbacks_ran_flags = 0;
+    timing.GetTimer(0)->AddTicks(timing.GetTimer(0)->GetDowncount());
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(callbacks_ran_flags.none());
+    REQUIRE(100 == timing.GetTimer(0)->GetDowncount());
+
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+}
+
 namespace ChainSchedulingTest {
 static int reschedules = 0;
 
@@ -196,4 +223,55 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
+namespace ThreadSafeTest {
+static constexpr u32 NUM_PRODUCERS = 4;
+static constexpr u32 EVENTS_PER_PRODUCER = 1000;
+static u32 callbacks_ran = 0;
+
+// Schedules events from several threads while the emu thread keeps moving them to its queue,
+// then runs the slices until all of them fired.
+static void ScheduleFromThreads(Core::Timing& timing, Core::TimingEventType* event_type) {
+    auto timer = timing.GetTimer(0);
+    std::atomic<u32> producers_done = 0;
+    callbacks_ran = 0;
+    {
+        std::array<std::jthread, NUM_PRODUCERS> producers;
+        for (auto& producer : producers) {
+            producer = std::jthread([&timing, &producers_done, event_type] {
+                for (u32 i = 0; i < EVENTS_PER_PRODUCER; i++) {
+                    timing.ScheduleEvent(0, event_type, i, 0, true);
+                }
+                ++producers_done;
+            });
+        }
+        while (producers_done != NUM_PRODUCERS) {
+            timer->MoveEvents();
+        }
+    }
+
+    // Thread safe events are scheduled at least two slices ahead.
+    for (int slice = 0; slice < 3; slice++) {
+        timer->AddTicks(timer->GetDowncount());
+        timer->Advance();
+        timer->SetNextSlice();
+    }
+}
+} // namespace ThreadSafeTest
+
+TEST_CASE("CoreTiming[ThreadSafeScheduling]", "[core]") {
+    using namespace ThreadSafeTest;
+
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb =
+        timing.RegisterEvent("callbackThreadSafe", [](std::uintptr_t, s64) { ++callbacks_ran; });
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    ScheduleFromThreads(timing, cb);
+    REQUIRE(NUM_PRODUCERS * EVENTS_PER_PRODUCER == callbacks_ran);
+}
+
 // TODO: Add tests for multiple timers
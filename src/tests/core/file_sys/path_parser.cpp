@@ -35,4 +35,31 @@ TEST_CASE("PathParser - Host file system", "[core][file_sys]") {
     FileUtil::DeleteDirRecursively(test_dir);
 }
 
+TEST_CASE("PathCache", "[core][file_sys]") {
+    std::string test_dir = "./test";
+    FileUtil::CreateDir(test_dir);
+    FileUtil::CreateEmptyFile(test_dir + "/a");
+
+    PathCache cache;
+    REQUIRE(!cache.Resolve(Path("a"), test_dir).is_valid);
+    REQUIRE(cache.Resolve(Path("/"), test_dir).is_root);
+
+    auto resolution = cache.Resolve(Path("/a"), test_dir);
+    REQUIRE(resolution.status == PathParser::FileFound);
+    REQUIRE(resolution.host_path == test_dir + "/a");
+    REQUIRE(!resolution.cached);
+    REQUIRE(cache.Resolve(Path("/a"), test_dir).cached);
+
+    // Files that do not exist yet are checked on every use
+    REQUIRE(cache.Resolve(Path("/b"), test_dir).status == PathParser::NotFound);
+    FileUtil::CreateEmptyFile(test_dir + "/b");
+    REQUIRE(cache.Resolve(Path("/b"), test_dir).status == PathParser::FileFound);
+
+    FileUtil::Delete(test_dir + "/a");
+    cache.Clear();
+    REQUIRE(cache.Resolve(Path("/a"), test_dir).status == PathParser::NotFound);
+
+    FileUtil::DeleteDirRecursively(test_dir);
+}
+
 } // namespace FileSys
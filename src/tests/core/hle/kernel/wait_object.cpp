@@ -0,0 +1,88 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+static constexpr std::size_t NUM_EVENTS = 64;
+
+static std::vector<std::shared_ptr<WaitObject>> MakeEvents(KernelSystem& kernel) {
+    std::vector<std::shared_ptr<WaitObject>> events;
+    for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+        events.push_back(kernel.CreateEvent(ResetType::OneShot));
+    }
+    return events;
+}
+
+/// Puts the thread to sleep on all the objects, the way WaitSynchronizationN does with wait_all.
+static void WaitOnAll(const std::shared_ptr<Thread>& thread,
+                      const std::vector<std::shared_ptr<WaitObject>>& objects) {
+    thread->status = ThreadStatus::WaitSynchAll;
+    for (const auto& object : objects) {
+        object->AddWaitingThread(thread);
+    }
+    thread->wait_objects = objects;
+}
+
+/// Takes the thread off the objects' lists, the way a wait timeout does.
+static void CancelWait(const std::shared_ptr<Thread>& thread) {
+    for (const auto& object : thread->wait_objects) {
+        object->RemoveWaitingThread(thread.get());
+    }
+    thread->wait_objects.clear();
+}
+
+TEST_CASE("WaitObject[WaitAll]", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    KernelSystem kernel(memory, timing, [] {}, MemoryMode::NewProd, 1);
+
+    const auto events = MakeEvents(kernel);
+    auto thread = std::make_shared<Thread>(kernel, 0);
+    thread->current_priority = ThreadPrioDefault;
+
+    SECTION("wakes up once every object is signaled") {
+        WaitOnAll(thread, events);
+        for (std::size_t i = 0; i + 1 < NUM_EVENTS; ++i) {
+            std::static_pointer_cast<Event>(events[i])->Signal();
+            REQUIRE(thread->status == ThreadStatus::WaitSynchAll);
+        }
+
+        std::static_pointer_cast<Event>(events.back())->Signal();
+        REQUIRE(thread->status == ThreadStatus::Ready);
+        REQUIRE(thread->wait_objects.empty());
+        for (const auto& event : events) {
+            REQUIRE(event->GetWaitingThreads().empty());
+        }
+    }
+
+    SECTION("lists a thread once per object") {
+        WaitOnAll(thread, {events[0], events[1], events[0]});
+        REQUIRE(events[0]->GetWaitingThreads().size() == 1);
+
+        CancelWait(thread);
+        REQUIRE(events[0]->GetWaitingThreads().empty());
+        REQUIRE(events[1]->GetWaitingThreads().empty());
+    }
+
+    SECTION("keeps the lists intact when a waiting thread is destroyed") {
+        auto other = std::make_shared<Thread>(kernel, 0);
+        WaitOnAll(other, events);
+        WaitOnAll(thread, events);
+        other.reset();
+
+        REQUIRE(events[0]->GetWaitingThreads() == std::vector{thread});
+        CancelWait(thread);
+    }
+}
+
+} // namespace Kernel
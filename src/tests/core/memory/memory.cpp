@@ -53,3 +53,32 @@ TEST_CASE("memory.IsValidVirtualAddress", "[core][memory]") {
         CHECK(memory.IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("memory.RasterizerMarkRegionCached", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(memory, timing, [] {}, Kernel::MemoryMode::NewProd, 1);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    auto other_process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+
+    const auto& page_table = *process->vm_manager.page_table;
+    const auto& other_page_table = *other_process->vm_manager.page_table;
+    const std::size_t page = Memory::VRAM_VADDR >> Memory::CITRA_PAGE_BITS;
+
+    memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::CITRA_PAGE_SIZE, true);
+    CHECK(page_table.attributes[page] == Memory::PageType::RasterizerCachedMemory);
+    CHECK(page_table.attributes[page + 1] == Memory::PageType::Memory);
+    CHECK(other_page_table.attributes[page] == Memory::PageType::Unmapped);
+
+    // Pages mapped later pick up the cached state, and are updated from then on
+    kernel.HandleSpecialMapping(other_process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    CHECK(other_page_table.attributes[page] == Memory::PageType::RasterizerCachedMemory);
+
+    memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::CITRA_PAGE_SIZE, false);
+    CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+    CHECK(other_page_table.attributes[page] == Memory::PageType::Memory);
+}
@@ -149,4 +149,47 @@ TEST_CASE("Memory Basics", "[kernel][memory]") {
         Result code = manager->UnmapRange(Memory::HEAP_VADDR, static_cast<u32>(block.GetSize()));
         REQUIRE(code == ResultSuccess);
     }
+
+    SECTION("splitting and merging memory") {
+        auto big_mem = std::make_shared<BufferMem>(4 * Memory::CITRA_PAGE_SIZE);
+        MemoryRef big_block{big_mem};
+        const u32 page = Memory::CITRA_PAGE_SIZE;
+
+        // Because of the PageTable, Kernel::VMManager is too big to be created on the stack.
+        auto manager = std::make_unique<Kernel::VMManager>(memory, process);
+        auto result = manager->MapBackingMemory(Memory::HEAP_VADDR, big_block, 4 * page,
+                                                Kernel::MemoryState::Private);
+        REQUIRE(result.Code() == ResultSuccess);
+        REQUIRE(manager->vma_map.size() == 3);
+
+        // Protecting the middle pages splits the mapping in three
+        Result code = manager->ReprotectRange(Memory::HEAP_VADDR + page, 2 * page,
+                                              Kernel::VMAPermission::Read);
+        REQUIRE(code == ResultSuccess);
+        REQUIRE(manager->vma_map.size() == 5);
+        for (u32 i = 0; i < 4; i++) {
+            // Lookups alternate between VMAs so that the last found one is also missed
+            auto vma = manager->FindVMA(Memory::HEAP_VADDR + i * page);
+            REQUIRE(vma != manager->vma_map.end());
+            CHECK(vma->second.base <= Memory::HEAP_VADDR + i * page);
+            CHECK(vma->second.base + vma->second.size > Memory::HEAP_VADDR + i * page);
+            CHECK(vma->second.permissions == (i == 1 || i == 2 ? Kernel::VMAPermission::Read
+                                                               : Kernel::VMAPermission::ReadWrite));
+            CHECK(manager->FindVMA(0)->second.type == Kernel::VMAType::Free);
+        }
+
+        // Restoring the permissions merges them back together
+        code = manager->ReprotectRange(Memory::HEAP_VADDR + page, 2 * page,
+                                       Kernel::VMAPermission::ReadWrite);
+        REQUIRE(code == ResultSuccess);
+        REQUIRE(manager->vma_map.size() == 3);
+        auto vma = manager->FindVMA(Memory::HEAP_VADDR + 3 * page);
+        CHECK(vma->second.base == Memory::HEAP_VADDR);
+        CHECK(vma->second.size == 4 * page);
+
+        code = manager->UnmapRange(Memory::HEAP_VADDR, 4 * page);
+        REQUIRE(code == ResultSuccess);
+        REQUIRE(manager->vma_map.size() == 1);
+        CHECK(manager->FindVMA(Memory::HEAP_VADDR)->second.type == Kernel::VMAType::Free);
+    }
 }
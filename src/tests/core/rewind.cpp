@@ -0,0 +1,67 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+#include "core/memory.h"
+#include "core/rewind.h"
+
+static constexpr std::size_t PAGE_SIZE = Memory::CITRA_PAGE_SIZE;
+static constexpr std::size_t NUM_PAGES = 16;
+
+static void FillPage(std::vector<u8>& ram, std::size_t page, u8 value) {
+    std::fill_n(ram.begin() + page * PAGE_SIZE, PAGE_SIZE, value);
+}
+
+TEST_CASE("RewindBuffer[Restore]", "[core]") {
+    Core::RewindBuffer buffer{std::size_t{1} << 30};
+    std::vector<u8> ram(NUM_PAGES * PAGE_SIZE);
+
+    FillPage(ram, 1, 0x11);
+    buffer.Push("first", ram);
+    const std::vector<u8> first = ram;
+
+    FillPage(ram, 2, 0x22);
+    buffer.Push("second", ram);
+    const std::vector<u8> second = ram;
+
+    // Zero pages are never stored, only the pages that changed since the previous snapshot are.
+    REQUIRE(buffer.MemoryUsage() < 3 * PAGE_SIZE);
+
+    FillPage(ram, 1, 0x33);
+    FillPage(ram, 3, 0x44);
+
+    REQUIRE(buffer.NewestState() == "second");
+    buffer.Pop(ram);
+    REQUIRE(ram == second);
+
+    // The snapshot taken after a rewind must be compared against the one before it.
+    FillPage(ram, 4, 0x55);
+    buffer.Push("third", ram);
+    const std::vector<u8> third = ram;
+    buffer.Pop(ram);
+    REQUIRE(ram == third);
+
+    REQUIRE(buffer.NewestState() == "first");
+    buffer.Pop(ram);
+    REQUIRE(ram == first);
+    REQUIRE(buffer.Empty());
+}
+
+TEST_CASE("RewindBuffer[Budget]", "[core]") {
+    Core::RewindBuffer buffer{4 * PAGE_SIZE};
+    std::vector<u8> ram(NUM_PAGES * PAGE_SIZE);
+
+    for (u8 i = 0; i < 8; ++i) {
+        FillPage(ram, i, i + 1);
+        buffer.Push({}, ram);
+    }
+
+    // The oldest snapshots are folded into the next ones, which keeps the newest state intact.
+    REQUIRE(buffer.Count() == 1);
+    std::vector<u8> restored(NUM_PAGES * PAGE_SIZE, 0xFF);
+    buffer.Pop(restored);
+    REQUIRE(restored == ram);
+}
@@ -0,0 +1,80 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/custom_textures/etc2_encoder.h"
+#include "video_core/texture/etc1.h"
+
+using namespace VideoCore;
+
+namespace {
+
+constexpr std::array<std::array<s32, 8>, 16> ALPHA_MODIFIERS = {{
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+}};
+
+u64 ReadBigEndian(const u8* data) {
+    u64 value = 0;
+    for (u32 i = 0; i < 8; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+u8 DecodeAlpha(u64 block, u32 texel) {
+    const s32 base = static_cast<s32>(block >> 56);
+    const s32 multiplier = static_cast<s32>((block >> 52) & 0xF);
+    const u32 table = static_cast<u32>((block >> 48) & 0xF);
+    const u32 index = static_cast<u32>((block >> (45 - texel * 3)) & 0x7);
+    return static_cast<u8>(std::clamp(base + ALPHA_MODIFIERS[table][index] * multiplier, 0, 255));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ETC2 encoder round trips smooth images", "[video_core][etc2_encoder]") {
+    constexpr u32 width = 30;
+    constexpr u32 height = 18;
+    std::vector<u8> image(width * height * 4);
+    for (u32 y = 0; y < height; y++) {
+        for (u32 x = 0; x < width; x++) {
+            u8* texel = &image[(y * width + x) * 4];
+            texel[0] = static_cast<u8>(x * 8);
+            texel[1] = static_cast<u8>(y * 12);
+            texel[2] = static_cast<u8>((x + y) * 4);
+            texel[3] = static_cast<u8>(255 - x * 3);
+        }
+    }
+
+    std::vector<u8> encoded(ETC2Size(width, height));
+    REQUIRE(encoded.size() == 8 * 5 * 16);
+    EncodeETC2(image, width, height, encoded);
+
+    const u32 blocks_x = (width + 3) / 4;
+    s32 max_color_error = 0;
+    s32 max_alpha_error = 0;
+    for (u32 y = 0; y < height; y++) {
+        for (u32 x = 0; x < width; x++) {
+            const u8* block = &encoded[((y / 4) * blocks_x + x / 4) * 16];
+            const u32 texel = (x % 4) * 4 + y % 4;
+            const u8* expected = &image[(y * width + x) * 4];
+            const auto color = Pica::Texture::SampleETC1Subtile(ReadBigEndian(block + 8), x % 4,
+                                                                y % 4);
+            for (u32 c = 0; c < 3; c++) {
+                max_color_error = std::max(max_color_error, std::abs(color[c] - expected[c]));
+            }
+            const u8 alpha = DecodeAlpha(ReadBigEndian(block), texel);
+            max_alpha_error = std::max(max_alpha_error, std::abs(alpha - expected[3]));
+        }
+    }
+    REQUIRE(max_color_error <= 16);
+    REQUIRE(max_alpha_error <= 2);
+}
@@ -137,6 +137,7 @@ public:
             shader_unit.input[i].w = Pica::f24::FromFloat32(input.w);
         }
         shader_unit.temporary.fill(Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::Zero()));
+        shader_interpreter.SetupBatch(*shader_setup, 0);
         shader_interpreter.Run(*shader_setup, shader_unit);
     }
 
@@ -770,6 +771,103 @@ SHADER_TEST_CASE("Conditional", "[video_core][shader]") {
     }
 }
 
+TEST_CASE("Control Uniform Specialization", "[video_core][shader]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader_setup = CompileShaderSetup({
+        // clang-format off
+        // IFU configured later
+        {OpCode::Id::NOP},
+        {OpCode::Id::MOV, sh_temp, sh_input},
+        {OpCode::Id::LOOP, 0},
+            {OpCode::Id::ADD, sh_temp, sh_temp, sh_input},
+        {Type::EndLoop},
+        {OpCode::Id::MOV, sh_output, sh_temp},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    nihstro::Instruction IFU = {};
+    IFU.opcode = nihstro::OpCode::Id::IFU;
+    IFU.flow_control.num_instructions = 0;
+    IFU.flow_control.dest_offset = 4;
+    IFU.flow_control.bool_uniform_id = 0;
+    shader_setup->UpdateProgramCode(0, IFU.hex);
+
+    const bool condition = GENERATE(false, true);
+    const u8 iterations = static_cast<u8>(GENERATE(0, 3));
+    shader_setup->uniforms.b[0] = condition;
+    shader_setup->uniforms.i[0] = {iterations, 0, 1, 0};
+
+    Pica::ControlUniforms control{};
+    control.b = condition ? 1 : 0;
+    control.i[0] = iterations | 1U << 16;
+
+    // The shader compiled with the uniforms as constants must behave like the generic one
+    JitShader generic;
+    generic.Compile(&shader_setup->GetProgramCode(), &shader_setup->GetSwizzleData());
+    JitShader specialized;
+    specialized.Compile(&shader_setup->GetProgramCode(), &shader_setup->GetSwizzleData(),
+                        &control);
+
+    const float input = 2.0f;
+    const float expected = condition ? input * (iterations + 2) : 0.0f;
+    for (const JitShader* shader : {&generic, &specialized}) {
+        Pica::ShaderUnit shader_unit;
+        shader_unit.input[0].x = Pica::f24::FromFloat32(input);
+        shader_unit.temporary.fill(Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::Zero()));
+        shader->Run(*shader_setup, shader_unit, 0);
+
+        REQUIRE(shader_unit.output[0].x.ToFloat32() == Catch::Approx(expected));
+    }
+}
+
+TEST_CASE("Interpreter Batch", "[video_core][shader]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader_setup = CompileShaderSetup({
+        // clang-format off
+        {OpCode::Id::MOV, sh_temp, sh_input},
+        {OpCode::Id::LOOP, 0},
+            {OpCode::Id::MUL, sh_temp, sh_temp, sh_input},
+            {OpCode::Id::ADD, sh_temp, sh_temp, sh_input},
+        {Type::EndLoop},
+        {OpCode::Id::MUL, sh_output, "xyzw", sh_temp, "wzyx", sh_input, "xyzw"},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+    shader_setup->uniforms.i[0] = {2, 0, 1, 0};
+
+    ShaderInterpreter interpreter;
+    interpreter.SetupBatch(*shader_setup, 0);
+
+    // The units of a batch run the program together and must match running them one by one
+    std::array<Pica::ShaderUnit, Pica::SHADER_BATCH_SIZE> batch_units;
+    std::array<Pica::ShaderUnit, Pica::SHADER_BATCH_SIZE> single_units;
+    for (std::size_t i = 0; i < batch_units.size(); ++i) {
+        const auto value = Pica::f24::FromFloat32(0.5f + static_cast<float>(i));
+        batch_units[i].input[0] = {value, value * value, -value, Pica::f24::One()};
+        single_units[i].input[0] = batch_units[i].input[0];
+    }
+
+    interpreter.RunBatch(*shader_setup, batch_units);
+    for (Pica::ShaderUnit& unit : single_units) {
+        interpreter.Run(*shader_setup, unit);
+    }
+
+    for (std::size_t i = 0; i < batch_units.size(); ++i) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            REQUIRE(batch_units[i].output[0][comp].ToFloat32() ==
+                    single_units[i].output[0][comp].ToFloat32());
+        }
+        REQUIRE(batch_units[i].address_registers[2] == single_units[i].address_registers[2]);
+    }
+}
+
 SHADER_TEST_CASE("Source Swizzle", "[video_core][shader]") {
     const auto sh_input = SourceRegister::MakeInput(0);
     const auto sh_output = DestRegister::MakeOutput(0);
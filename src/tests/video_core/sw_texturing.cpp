@@ -0,0 +1,103 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/renderer_software/sw_texturing.h"
+
+using namespace SwRenderer;
+using TevStageConfig = Pica::TexturingRegs::TevStageConfig;
+
+namespace {
+
+constexpr std::size_t NUM_ITERATIONS = 256;
+
+FragmentQuad RandomQuad(std::mt19937& rng) {
+    std::uniform_int_distribution<u32> dist{0, 255};
+    FragmentQuad quad;
+    for (auto& color : quad) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            color[comp] = static_cast<u8>(dist(rng));
+        }
+    }
+    return quad;
+}
+
+constexpr std::array COLOR_MODIFIERS = {
+    TevStageConfig::ColorModifier::SourceColor, TevStageConfig::ColorModifier::OneMinusSourceColor,
+    TevStageConfig::ColorModifier::SourceAlpha, TevStageConfig::ColorModifier::OneMinusSourceAlpha,
+    TevStageConfig::ColorModifier::SourceRed,   TevStageConfig::ColorModifier::OneMinusSourceRed,
+    TevStageConfig::ColorModifier::SourceGreen, TevStageConfig::ColorModifier::OneMinusSourceGreen,
+    TevStageConfig::ColorModifier::SourceBlue,  TevStageConfig::ColorModifier::OneMinusSourceBlue,
+};
+
+constexpr std::array ALPHA_MODIFIERS = {
+    TevStageConfig::AlphaModifier::SourceAlpha, TevStageConfig::AlphaModifier::OneMinusSourceAlpha,
+    TevStageConfig::AlphaModifier::SourceRed,   TevStageConfig::AlphaModifier::OneMinusSourceRed,
+    TevStageConfig::AlphaModifier::SourceGreen, TevStageConfig::AlphaModifier::OneMinusSourceGreen,
+    TevStageConfig::AlphaModifier::SourceBlue,  TevStageConfig::AlphaModifier::OneMinusSourceBlue,
+};
+
+constexpr std::array OPERATIONS = {
+    TevStageConfig::Operation::Replace,         TevStageConfig::Operation::Modulate,
+    TevStageConfig::Operation::Add,             TevStageConfig::Operation::AddSigned,
+    TevStageConfig::Operation::Lerp,            TevStageConfig::Operation::Subtract,
+    TevStageConfig::Operation::Dot3_RGB,        TevStageConfig::Operation::Dot3_RGBA,
+    TevStageConfig::Operation::MultiplyThenAdd, TevStageConfig::Operation::AddThenMultiply,
+};
+
+} // Anonymous namespace
+
+TEST_CASE("Quad color modifiers match the scalar ones", "[video_core][sw_texturing]") {
+    std::mt19937 rng{1};
+    for (std::size_t iteration = 0; iteration < NUM_ITERATIONS; ++iteration) {
+        const FragmentQuad values = RandomQuad(rng);
+        for (const auto modifier : COLOR_MODIFIERS) {
+            const FragmentQuad quad = GetColorModifier(modifier, values);
+            for (std::size_t lane = 0; lane < quad.size(); ++lane) {
+                REQUIRE(quad[lane].rgb() == GetColorModifier(modifier, values[lane]));
+            }
+        }
+        for (const auto modifier : ALPHA_MODIFIERS) {
+            const AlphaQuad quad = GetAlphaModifier(modifier, values);
+            for (std::size_t lane = 0; lane < quad.size(); ++lane) {
+                REQUIRE(quad[lane] == GetAlphaModifier(modifier, values[lane]));
+            }
+        }
+    }
+}
+
+TEST_CASE("Quad combiners match the scalar ones", "[video_core][sw_texturing]") {
+    std::mt19937 rng{2};
+    for (std::size_t iteration = 0; iteration < NUM_ITERATIONS; ++iteration) {
+        const std::array<FragmentQuad, 3> colors = {RandomQuad(rng), RandomQuad(rng),
+                                                    RandomQuad(rng)};
+        for (const auto op : OPERATIONS) {
+            const FragmentQuad quad = ColorCombine(op, colors);
+            for (std::size_t lane = 0; lane < quad.size(); ++lane) {
+                const std::array<Common::Vec3<u8>, 3> input = {
+                    colors[0][lane].rgb(), colors[1][lane].rgb(), colors[2][lane].rgb()};
+                REQUIRE(quad[lane].rgb() == ColorCombine(op, input));
+            }
+
+            // The Dot3 operations are not valid alpha combiner operations.
+            if (op == TevStageConfig::Operation::Dot3_RGB ||
+                op == TevStageConfig::Operation::Dot3_RGBA) {
+                continue;
+            }
+            const std::array<AlphaQuad, 3> alphas = {
+                AlphaQuad{colors[0][0].a(), colors[0][1].a(), colors[0][2].a(), colors[0][3].a()},
+                AlphaQuad{colors[1][0].a(), colors[1][1].a(), colors[1][2].a(), colors[1][3].a()},
+                AlphaQuad{colors[2][0].a(), colors[2][1].a(), colors[2][2].a(), colors[2][3].a()},
+            };
+            const AlphaQuad alpha_quad = AlphaCombine(op, alphas);
+            for (std::size_t lane = 0; lane < alpha_quad.size(); ++lane) {
+                const std::array<u8, 3> input = {alphas[0][lane], alphas[1][lane],
+                                                 alphas[2][lane]};
+                REQUIRE(alpha_quad[lane] == AlphaCombine(op, input));
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "video_core/rasterizer_cache/texture_codec.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
+#include "video_core/texture/etc1.h"
+
+using namespace VideoCore;
+
+namespace {
+
+constexpr u32 WIDTH = 128;
+constexpr u32 HEIGHT = 64;
+
+std::vector<u8> RandomBytes(std::size_t size) {
+    std::mt19937 rng{static_cast<u32>(size)};
+    std::uniform_int_distribution<u32> dist{0, 255};
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return data;
+}
+
+std::size_t TiledSize(PixelFormat format) {
+    return WIDTH * HEIGHT * GetFormatBpp(format) / 8;
+}
+
+std::size_t LinearSize(PixelFormat format, bool converted) {
+    return WIDTH * HEIGHT * (converted ? 4 : GetFormatBytesPerPixel(format));
+}
+
+MortonFunc ScalarMortonFunc(PixelFormat format, bool morton_to_linear, bool converted) {
+    const std::size_t index = static_cast<std::size_t>(format);
+    if (morton_to_linear) {
+        return (converted ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[index];
+    }
+    return (converted ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[index];
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Vectorized morton copy matches scalar", "[video_core][texture_codec]") {
+    const auto format = static_cast<PixelFormat>(GENERATE(range(0u, 18u)));
+    const bool morton_to_linear = GENERATE(true, false);
+    const bool converted = GENERATE(true, false);
+
+    const MortonFunc vector_func = GetVectorizedMortonFunc(format, morton_to_linear, converted);
+    if (!vector_func) {
+        return;
+    }
+    const MortonFunc scalar_func = ScalarMortonFunc(format, morton_to_linear, converted);
+    REQUIRE(scalar_func);
+
+    const std::size_t tiled_size = TiledSize(format);
+    const std::size_t linear_size = LinearSize(format, converted);
+
+    if (morton_to_linear) {
+        auto tiled = RandomBytes(tiled_size);
+        std::vector<u8> expected(linear_size);
+        std::vector<u8> result(linear_size);
+        scalar_func(WIDTH, HEIGHT, 0, static_cast<u32>(tiled_size), expected, tiled);
+        vector_func(WIDTH, HEIGHT, 0, static_cast<u32>(tiled_size), result, tiled);
+        REQUIRE(expected == result);
+        return;
+    }
+
+    // Encode a region that does not start or end at a tile boundary to exercise partial tiles.
+    auto linear = RandomBytes(linear_size);
+    const u32 tile_size = GetFormatBpp(format) * 64 / 8;
+    const u32 start_offset = tile_size + tile_size / 2;
+    const u32 end_offset = static_cast<u32>(tiled_size) - tile_size / 4;
+    std::vector<u8> expected(end_offset - start_offset);
+    std::vector<u8> result(end_offset - start_offset);
+    scalar_func(WIDTH, HEIGHT, start_offset, end_offset, linear, expected);
+    vector_func(WIDTH, HEIGHT, start_offset, end_offset, linear, result);
+    REQUIRE(expected == result);
+}
+
+TEST_CASE("ETC1 subtile decode matches sampling", "[video_core][texture_codec]") {
+    const auto blocks = RandomBytes(256 * sizeof(u64));
+    for (std::size_t offset = 0; offset < blocks.size(); offset += sizeof(u64)) {
+        u64 value;
+        std::memcpy(&value, blocks.data() + offset, sizeof(u64));
+
+        std::array<Common::Vec4<u8>, 16> texels;
+        Pica::Texture::DecodeETC1Subtile(value, texels);
+        for (u32 y = 0; y < 4; y++) {
+            for (u32 x = 0; x < 4; x++) {
+                const Common::Vec3<u8> expected = Pica::Texture::SampleETC1Subtile(value, x, y);
+                REQUIRE(texels[4 * y + x] == Common::MakeVec(expected, u8{255}));
+            }
+        }
+    }
+}
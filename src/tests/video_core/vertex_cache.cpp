@@ -0,0 +1,49 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/pica/vertex_cache.h"
+
+using namespace Pica;
+
+namespace {
+
+AttributeBuffer MakeOutput(u32 vertex) {
+    AttributeBuffer output{};
+    output[0].x = f24::FromFloat32(static_cast<float>(vertex));
+    return output;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VertexCache keeps every vertex of a small index range", "[video_core][vertex_cache]") {
+    VertexCache cache;
+    cache.Reset(1000, 1999);
+    for (u32 vertex = 1000; vertex < 2000; ++vertex) {
+        REQUIRE(cache.Find(vertex) == nullptr);
+        cache.Insert(vertex, MakeOutput(vertex));
+    }
+    for (u32 vertex = 1000; vertex < 2000; ++vertex) {
+        const AttributeBuffer* output = cache.Find(vertex);
+        REQUIRE(output != nullptr);
+        REQUIRE((*output)[0].x.ToFloat32() == static_cast<float>(vertex));
+    }
+
+    cache.Reset(1000, 1999);
+    REQUIRE(cache.Find(1000) == nullptr);
+}
+
+TEST_CASE("VertexCache evicts vertices sharing a slot", "[video_core][vertex_cache]") {
+    VertexCache cache;
+    cache.Reset(0, 0xFFFF);
+    cache.Insert(5, MakeOutput(5));
+    REQUIRE(cache.Find(5) != nullptr);
+
+    // The largest cache has 4096 slots
+    cache.Insert(5 + 4096, MakeOutput(5 + 4096));
+    REQUIRE(cache.Find(5) == nullptr);
+    const AttributeBuffer* output = cache.Find(5 + 4096);
+    REQUIRE(output != nullptr);
+    REQUIRE((*output)[0].x.ToFloat32() == 4101.0f);
+}
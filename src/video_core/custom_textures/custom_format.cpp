@@ -24,6 +24,8 @@ std::string_view CustomPixelFormatAsString(CustomPixelFormat format) {
         return "ASTC6";
     case CustomPixelFormat::ASTC8:
         return "ASTC8";
+    case CustomPixelFormat::ETC2:
+        return "ETC2";
     default:
         return "NotReal";
     }
@@ -19,6 +19,7 @@ enum class CustomPixelFormat : u32 {
     ASTC4 = 5,
     ASTC6 = 6,
     ASTC8 = 7,
+    ETC2 = 8,
     Invalid = std::numeric_limits<u32>::max(),
 };
 
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <json.hpp>
 #include "common/file_util.h"
 #include "common/literals.h"
@@ -25,9 +27,12 @@ namespace {
 MICROPROFILE_DEFINE(CustomTexManager_TickFrame, "CustomTexManager", "TickFrame",
                     MP_RGB(54, 16, 32));
 
-constexpr std::size_t MAX_UPLOADS_PER_TICK = 8;
-
 using namespace Common::Literals;
+using namespace std::chrono_literals;
+
+constexpr u64 UPLOAD_BYTES_PER_TICK = 32_MiB;
+constexpr auto UPLOAD_TIME_PER_TICK = 2ms;
+constexpr u64 MAX_PENDING_DUMP_BYTES = 64_MiB;
 
 bool IsPow2(u32 value) {
     return value != 0 && (value & (value - 1)) == 0;
@@ -52,11 +57,17 @@ MapType MakeMapType(std::string_view ext) {
     return MapType::Color;
 }
 
+std::string GetPackPath(u64 title_id) {
+    return fmt::format("{}textures/{:016X}/{}", GetUserPath(FileUtil::UserPath::LoadDir),
+                       title_id, TEXTURE_PACK_FILENAME);
+}
+
 } // Anonymous namespace
 
 CustomTexManager::CustomTexManager(Core::System& system_)
     : system{system_}, image_interface{*system.GetImageInterface()},
-      async_custom_loading{Settings::values.async_custom_loading.GetValue()} {}
+      async_custom_loading{Settings::values.async_custom_loading.GetValue()},
+      fast_texture_dumping{Settings::values.fast_texture_dumping.GetValue()} {}
 
 CustomTexManager::~CustomTexManager() = default;
 
@@ -65,15 +76,11 @@ void CustomTexManager::TickFrame() {
     if (!textures_loaded) {
         return;
     }
-    std::size_t num_uploads = 0;
+    frame_tick++;
     for (auto it = async_uploads.begin(); it != async_uploads.end();) {
-        if (num_uploads >= MAX_UPLOADS_PER_TICK) {
-            return;
-        }
         switch (it->material->state) {
         case DecodeState::Decoded:
-            it->func();
-            num_uploads++;
+            ready_uploads.push_back(std::move(*it));
             [[fallthrough]];
         case DecodeState::Failed:
             it = async_uploads.erase(it);
@@ -83,17 +90,59 @@ void CustomTexManager::TickFrame() {
             break;
         }
     }
+    if (ready_uploads.empty()) {
+        return;
+    }
+
+    // Upload the most recently requested textures first, smaller ones before larger ones,
+    // until the budget of the frame is spent. The surface keeps the guest texture until then.
+    std::ranges::sort(ready_uploads, [](const AsyncUpload& lhs, const AsyncUpload& rhs) {
+        if (lhs.tick != rhs.tick) {
+            return lhs.tick > rhs.tick;
+        }
+        return lhs.material->size < rhs.material->size;
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    u64 uploaded_bytes = 0;
+    auto it = ready_uploads.begin();
+    for (; it != ready_uploads.end(); it++) {
+        const bool over_budget =
+            uploaded_bytes + it->material->size > UPLOAD_BYTES_PER_TICK ||
+            std::chrono::steady_clock::now() - start > UPLOAD_TIME_PER_TICK;
+        if (it != ready_uploads.begin() && over_budget) {
+            break;
+        }
+        it->func();
+        uploaded_bytes += it->material->size;
+    }
+    ready_uploads.erase(ready_uploads.begin(), it);
 }
 
 void CustomTexManager::FindCustomTextures() {
+    FindCustomTextures(system.Kernel().GetCurrentProcess()->codeset->program_id);
+}
+
+void CustomTexManager::FindCustomTextures(u64 title_id) {
     if (textures_loaded) {
         return;
     }
-    if (!workers) {
-        CreateWorkers();
+    if (etc2_supported && Settings::values.transcode_custom_textures.GetValue()) {
+        transcode_dir = fmt::format("{}custom_textures/{:016X}/",
+                                    GetUserPath(FileUtil::UserPath::CacheDir), title_id);
+        FileUtil::CreateFullPath(transcode_dir);
+    }
+
+    // When a texture pack exists materials are looked up from its index on demand.
+    if (pack.Open(GetPackPath(title_id))) {
+        const TexturePackOptions& options = pack.Options();
+        skip_mipmap = options.skip_mipmap;
+        flip_png_files = options.flip_png_files;
+        use_new_hash = options.use_new_hash;
+        textures_loaded = true;
+        return;
     }
 
-    const u64 title_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
     const auto textures = GetTextures(title_id);
     if (!ReadConfig(title_id)) {
         use_new_hash = false;
@@ -216,7 +265,15 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
     const u64 max_mem =
         (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
 
-    workers->QueueWork([&]() {
+    if (pack.IsOpen()) {
+        for (const TexturePackEntry& entry : pack.Entries()) {
+            if (!material_map.contains(entry.hash)) {
+                LoadPackMaterial(entry.hash);
+            }
+        }
+    }
+
+    load_tasks.Run([&]() {
         for (auto& [hash, material] : material_map) {
             if (size_sum > max_mem) {
                 LOG_WARNING(Render, "Aborting texture preload due to insufficient memory");
@@ -225,7 +282,7 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
             if (stop_run) {
                 return;
             }
-            material->LoadFromDisk(flip_png_files);
+            material->LoadFromDisk(flip_png_files, transcode_dir);
             size_sum += material->size;
             if (callback) {
                 callback(VideoCore::LoadCallbackStage::Preload, preloaded, custom_textures.size());
@@ -233,16 +290,28 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
             preloaded++;
         }
     });
-    workers->WaitForRequests();
+    load_tasks.Wait();
     async_custom_loading = false;
 }
 
 void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::span<u8> data,
                                    u64 data_hash) {
-    const u64 program_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
+    if (dumped_textures.contains(data_hash)) {
+        return;
+    }
+
+    // Leave the texture to a later upload when the queued dumps hold too much memory, so that
+    // the encoders never fall far behind the emulation when a new area is entered.
     const u32 data_size = static_cast<u32>(data.size());
     const u32 width = params.width;
     const u32 height = params.height;
+    const u32 decoded_size = width * height * 4;
+    const u64 dump_size = data_size + decoded_size;
+    if (pending_dump_bytes.load(std::memory_order_relaxed) + dump_size > MAX_PENDING_DUMP_BYTES) {
+        return;
+    }
+
+    const u64 program_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
     const PixelFormat format = params.pixel_format;
 
     std::string dump_path = fmt::format(
@@ -254,7 +323,8 @@ void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::
 
     dump_path +=
         fmt::format("tex1_{}x{}_{:016X}_{}_mip{}.png", width, height, data_hash, format, level);
-    if (dumped_textures.contains(data_hash) || FileUtil::Exists(dump_path)) {
+    if (FileUtil::Exists(dump_path)) {
+        dumped_textures.insert(data_hash);
         return;
     }
 
@@ -266,8 +336,7 @@ void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::
         return;
     }
 
-    const u32 decoded_size = width * height * 4;
-    std::vector<u8> pixels(data_size + decoded_size);
+    std::vector<u8> pixels(dump_size);
     std::memcpy(pixels.data(), data.data(), data_size);
 
     auto dump = [this, width, height, params, data_size, decoded_size, pixels = std::move(pixels),
@@ -277,36 +346,101 @@ void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::
         DecodeTexture(params, params.addr, params.end, encoded, decoded,
                       params.type == SurfaceType::Color);
         Common::FlipRGBA8Texture(decoded, width, height);
-        image_interface.EncodePNG(dump_path, width, height, decoded);
+        image_interface.EncodePNG(dump_path, width, height, decoded, fast_texture_dumping);
+        pending_dump_bytes.fetch_sub(pixels.size(), std::memory_order_relaxed);
     };
-    if (!workers) {
-        CreateWorkers();
-    }
-    workers->QueueWork(std::move(dump));
+    pending_dump_bytes.fetch_add(dump_size, std::memory_order_relaxed);
+    dump_tasks.Run(std::move(dump));
     dumped_textures.insert(data_hash);
 }
 
 Material* CustomTexManager::GetMaterial(u64 data_hash) {
     const auto it = material_map.find(data_hash);
-    if (it == material_map.end()) {
-        LOG_WARNING(Render, "Unable to find replacement for surface with hash {:016X}", data_hash);
+    if (it != material_map.end()) {
+        return it->second.get();
+    }
+    if (pack.IsOpen()) {
+        if (Material* const material = LoadPackMaterial(data_hash)) {
+            return material;
+        }
+    }
+    LOG_WARNING(Render, "Unable to find replacement for surface with hash {:016X}", data_hash);
+    return nullptr;
+}
+
+Material* CustomTexManager::LoadPackMaterial(u64 data_hash) {
+    const auto entries = pack.Find(data_hash);
+    if (entries.empty()) {
         return nullptr;
     }
-    return it->second.get();
+    auto& material = material_map[data_hash];
+    material = std::make_unique<Material>();
+    material->hash = data_hash;
+    for (const TexturePackEntry& entry : entries) {
+        // Files mapped to multiple hashes share the same payload, decode those only once.
+        auto [it, is_new] = pack_textures.try_emplace(entry.offset);
+        if (is_new) {
+            custom_textures.push_back(std::make_unique<CustomTexture>(image_interface));
+            CustomTexture* const texture{custom_textures.back().get()};
+            texture->path = fmt::format("{}@{:#x}", TEXTURE_PACK_FILENAME, entry.offset);
+            texture->packed_data = pack.Payload(entry);
+            texture->file_format = static_cast<CustomFileFormat>(entry.file_format);
+            texture->type = static_cast<MapType>(entry.map_type);
+            it->second = texture;
+        }
+        it->second->hashes.push_back(data_hash);
+        material->AddMapTexture(it->second);
+    }
+    return material.get();
+}
+
+bool CustomTexManager::BuildPack(u64 title_id) {
+    if (!ReadConfig(title_id)) {
+        use_new_hash = false;
+        skip_mipmap = true;
+    }
+
+    std::vector<TexturePackSource> sources;
+    CustomTexture texture{image_interface};
+    for (const FileUtil::FSTEntry& file : GetTextures(title_id)) {
+        texture.hashes.clear();
+        if (file.isDirectory || !ParseFilename(file, &texture) || texture.hashes.empty()) {
+            continue;
+        }
+        sources.push_back({
+            .path = texture.path,
+            .hashes = texture.hashes,
+            .file_format = texture.file_format,
+            .map_type = texture.type,
+        });
+    }
+    if (sources.empty()) {
+        LOG_ERROR(Render, "No custom textures found for title {:016X}", title_id);
+        return false;
+    }
+
+    const TexturePackOptions options = {
+        .skip_mipmap = skip_mipmap,
+        .flip_png_files = flip_png_files,
+        .use_new_hash = use_new_hash,
+    };
+    return TexturePack::Write(GetPackPath(title_id), sources, options);
 }
 
 bool CustomTexManager::Decode(Material* material, std::function<bool()>&& upload) {
     if (!async_custom_loading) {
-        material->LoadFromDisk(flip_png_files);
+        material->LoadFromDisk(flip_png_files, transcode_dir);
         return upload();
     }
     if (material->IsUnloaded()) {
         material->state = DecodeState::Pending;
-        workers->QueueWork([material, this] { material->LoadFromDisk(flip_png_files); });
+        load_tasks.Run(
+            [material, this] { material->LoadFromDisk(flip_png_files, transcode_dir); });
     }
     async_uploads.push_back({
         .material = material,
         .func = std::move(upload),
+        .tick = frame_tick,
     });
     return false;
 }
@@ -384,9 +518,4 @@ std::vector<FileUtil::FSTEntry> CustomTexManager::GetTextures(u64 title_id) {
     return textures;
 }
 
-void CustomTexManager::CreateWorkers() {
-    const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 2U) >> 1;
-    workers = std::make_unique<Common::ThreadWorker>(num_workers, "Custom textures");
-}
-
 } // namespace VideoCore
@@ -4,12 +4,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <span>
 #include <unordered_map>
 #include <unordered_set>
-#include "common/thread_worker.h"
+#include "common/task_scheduler.h"
 #include "video_core/custom_textures/material.h"
+#include "video_core/custom_textures/texture_pack.h"
 #include "video_core/rasterizer_interface.h"
 
 namespace Core {
@@ -27,6 +29,7 @@ class SurfaceParams;
 struct AsyncUpload {
     const Material* material;
     std::function<bool()> func;
+    u64 tick; ///< Frame the upload was requested in
 };
 
 class CustomTexManager {
@@ -34,12 +37,15 @@ public:
     explicit CustomTexManager(Core::System& system);
     ~CustomTexManager();
 
-    /// Processes queued texture uploads
+    /// Processes queued texture uploads within the per-frame upload budget
     void TickFrame();
 
-    /// Searches the load directory assigned to program_id for any custom textures and loads them
+    /// Searches the load directory of the running program for any custom textures and loads them
     void FindCustomTextures();
 
+    /// Searches the load directory assigned to title_id for any custom textures and loads them
+    void FindCustomTextures(u64 title_id);
+
     /// Reads the pack configuration file
     bool ReadConfig(u64 title_id, bool options_only = false);
 
@@ -50,12 +56,18 @@ public:
     void PreloadTextures(const std::atomic_bool& stop_run,
                          const VideoCore::DiskResourceLoadCallback& callback);
 
-    /// Saves the provided pixel data described by params to disk as png
+    /**
+     * Queues the provided pixel data described by params to be saved to disk as png. Textures
+     * that arrive while too many dumps are queued are skipped and dumped on a later upload.
+     */
     void DumpTexture(const SurfaceParams& params, u32 level, std::span<u8> data, u64 data_hash);
 
     /// Returns the material assigned to the provided data hash
     Material* GetMaterial(u64 data_hash);
 
+    /// Converts the loose files in the load directory of title_id to a texture pack file
+    bool BuildPack(u64 title_id);
+
     /// Decodes the textures in material to a consumable format and uploads it.
     bool Decode(Material* material, std::function<bool()>&& upload);
 
@@ -64,6 +76,11 @@ public:
         return skip_mipmap;
     }
 
+    /// Enables transcoding decoded textures to ETC2 when the backend can sample them.
+    void SetTranscodeSupport(bool etc2_supported_) noexcept {
+        etc2_supported = etc2_supported_;
+    }
+
     /// Returns true if the pack uses the new hashing method.
     bool UseNewHash() const noexcept {
         return use_new_hash;
@@ -76,8 +93,8 @@ private:
     /// Returns a vector of all custom texture files.
     std::vector<FileUtil::FSTEntry> GetTextures(u64 title_id);
 
-    /// Creates the thread workers.
-    void CreateWorkers();
+    /// Creates the material assigned to the provided hash from the texture pack index.
+    Material* LoadPackMaterial(u64 data_hash);
 
 private:
     Core::System& system;
@@ -86,13 +103,23 @@ private:
     std::unordered_map<u64, std::unique_ptr<Material>> material_map;
     std::unordered_map<std::string, std::vector<u64>> path_to_hash_map;
     std::vector<std::unique_ptr<CustomTexture>> custom_textures;
+    TexturePack pack;
+    std::unordered_map<u64, CustomTexture*> pack_textures;
+    std::string transcode_dir;
     std::list<AsyncUpload> async_uploads;
-    std::unique_ptr<Common::ThreadWorker> workers;
+    std::vector<AsyncUpload> ready_uploads;
+    u64 frame_tick{};
+    std::atomic<u64> pending_dump_bytes{};
     bool textures_loaded{false};
     bool async_custom_loading{true};
+    bool fast_texture_dumping{true};
     bool skip_mipmap{false};
     bool flip_png_files{true};
     bool use_new_hash{true};
+    bool etc2_supported{false};
+    // Declared last so that pending tasks finish before the state they use is destroyed
+    Common::TaskGroup load_tasks{Common::GetTaskScheduler()};
+    Common::TaskGroup dump_tasks{Common::GetTaskScheduler(), Common::TaskPriority::Background};
 };
 
 } // namespace VideoCore
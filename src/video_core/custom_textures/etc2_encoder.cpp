@@ -0,0 +1,248 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include "video_core/custom_textures/etc2_encoder.h"
+
+namespace VideoCore {
+
+namespace {
+
+constexpr u32 BLOCK_SIZE = 16;
+
+constexpr std::array<std::array<s32, 2>, 8> COLOR_MODIFIERS = {{
+    {2, 8},
+    {5, 17},
+    {9, 29},
+    {13, 42},
+    {18, 60},
+    {24, 80},
+    {33, 106},
+    {47, 183},
+}};
+
+constexpr std::array<std::array<s32, 8>, 16> ALPHA_MODIFIERS = {{
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+}};
+
+/// Texels of a block, indexed in column major order like the ETC2 pixel indices.
+using Texels = std::array<std::array<s32, 4>, 16>;
+
+/// Texel indices of the two sub-blocks, for the non flipped and the flipped layout.
+constexpr std::array<std::array<std::array<u32, 8>, 2>, 2> SUBBLOCKS = {{
+    {{{0, 1, 2, 3, 4, 5, 6, 7}, {8, 9, 10, 11, 12, 13, 14, 15}}},
+    {{{0, 1, 4, 5, 8, 9, 12, 13}, {2, 3, 6, 7, 10, 11, 14, 15}}},
+}};
+
+struct SubblockFit {
+    u64 error;
+    u32 table;
+    u32 indices; ///< Selector bits already placed at the texel positions of the block
+};
+
+struct ColorFit {
+    u64 error;
+    u64 block;
+};
+
+s32 Expand4(s32 value) {
+    return (value << 4) | value;
+}
+
+s32 Expand5(s32 value) {
+    return (value << 3) | (value >> 2);
+}
+
+s32 Quantize(s32 value, s32 max) {
+    return (value * max + 127) / 255;
+}
+
+SubblockFit FitSubblock(const Texels& texels, std::span<const u32, 8> subblock,
+                        const std::array<s32, 3>& base) {
+    SubblockFit best{std::numeric_limits<u64>::max(), 0, 0};
+    for (u32 table = 0; table < COLOR_MODIFIERS.size(); table++) {
+        u64 error = 0;
+        u32 indices = 0;
+        for (const u32 texel : subblock) {
+            u64 best_error = std::numeric_limits<u64>::max();
+            u32 best_index = 0;
+            for (u32 index = 0; index < 4; index++) {
+                const s32 modifier = (index & 2 ? -1 : 1) * COLOR_MODIFIERS[table][index & 1];
+                u64 texel_error = 0;
+                for (u32 c = 0; c < 3; c++) {
+                    const s32 diff = std::clamp(base[c] + modifier, 0, 255) - texels[texel][c];
+                    texel_error += static_cast<u64>(diff * diff);
+                }
+                if (texel_error < best_error) {
+                    best_error = texel_error;
+                    best_index = index;
+                }
+            }
+            error += best_error;
+            indices |= ((best_index >> 1) << (16 + texel)) | ((best_index & 1) << texel);
+        }
+        if (error < best.error) {
+            best = {error, table, indices};
+        }
+    }
+    return best;
+}
+
+ColorFit FitColor(const Texels& texels, u32 flip) {
+    std::array<std::array<s32, 3>, 2> average{};
+    for (u32 i = 0; i < 2; i++) {
+        for (const u32 texel : SUBBLOCKS[flip][i]) {
+            for (u32 c = 0; c < 3; c++) {
+                average[i][c] += texels[texel][c];
+            }
+        }
+        for (s32& value : average[i]) {
+            value = (value + 4) / 8;
+        }
+    }
+
+    const auto fit = [&](const std::array<std::array<s32, 3>, 2>& bases, u64 header) {
+        const SubblockFit first = FitSubblock(texels, SUBBLOCKS[flip][0], bases[0]);
+        const SubblockFit second = FitSubblock(texels, SUBBLOCKS[flip][1], bases[1]);
+        return ColorFit{
+            .error = first.error + second.error,
+            .block = header | (u64{first.table} << 37) | (u64{second.table} << 34) |
+                     (u64{flip} << 32) | first.indices | second.indices,
+        };
+    };
+
+    // Individual mode stores a 4 bit base color per sub-block.
+    std::array<std::array<s32, 3>, 2> individual;
+    u64 individual_header = 0;
+    for (u32 c = 0; c < 3; c++) {
+        const s32 first = Quantize(average[0][c], 15);
+        const s32 second = Quantize(average[1][c], 15);
+        individual[0][c] = Expand4(first);
+        individual[1][c] = Expand4(second);
+        individual_header |= (u64(first) << (60 - c * 8)) | (u64(second) << (56 - c * 8));
+    }
+    ColorFit best = fit(individual, individual_header);
+
+    // Differential mode stores a 5 bit base color and a 3 bit signed delta for the second one.
+    // The delta is clamped, as an overflowing sum selects one of the other ETC2 modes.
+    std::array<std::array<s32, 3>, 2> differential;
+    u64 differential_header = u64{1} << 33;
+    for (u32 c = 0; c < 3; c++) {
+        const s32 first = Quantize(average[0][c], 31);
+        const s32 delta = std::clamp(Quantize(average[1][c], 31) - first, -4, 3);
+        const s32 second = std::clamp(first + delta, 0, 31);
+        differential[0][c] = Expand5(first);
+        differential[1][c] = Expand5(second);
+        differential_header |= (u64(first) << (59 - c * 8)) |
+                               (u64((second - first) & 7) << (56 - c * 8));
+    }
+    const ColorFit candidate = fit(differential, differential_header);
+    if (candidate.error < best.error) {
+        best = candidate;
+    }
+    return best;
+}
+
+u64 EncodeColor(const Texels& texels) {
+    const ColorFit normal = FitColor(texels, 0);
+    const ColorFit flipped = FitColor(texels, 1);
+    return flipped.error < normal.error ? flipped.block : normal.block;
+}
+
+u64 EncodeAlpha(const Texels& texels) {
+    s32 min = 255;
+    s32 max = 0;
+    for (const auto& texel : texels) {
+        min = std::min(min, texel[3]);
+        max = std::max(max, texel[3]);
+    }
+
+    u64 best_error = std::numeric_limits<u64>::max();
+    u64 best_block = 0;
+    for (u32 table = 0; table < ALPHA_MODIFIERS.size(); table++) {
+        const auto& modifiers = ALPHA_MODIFIERS[table];
+        const s32 range = modifiers[7] - modifiers[3];
+        const s32 multiplier = std::clamp((max - min + range / 2) / range, 1, 15);
+        const s32 base = std::clamp(
+            (min - modifiers[3] * multiplier + max - modifiers[7] * multiplier + 1) / 2, 0, 255);
+
+        u64 error = 0;
+        u64 block = (u64(base) << 56) | (u64(multiplier) << 52) | (u64{table} << 48);
+        for (u32 texel = 0; texel < texels.size(); texel++) {
+            u64 texel_error = std::numeric_limits<u64>::max();
+            u32 texel_index = 0;
+            for (u32 index = 0; index < modifiers.size(); index++) {
+                const s32 diff =
+                    std::clamp(base + modifiers[index] * multiplier, 0, 255) - texels[texel][3];
+                if (static_cast<u64>(diff * diff) < texel_error) {
+                    texel_error = static_cast<u64>(diff * diff);
+                    texel_index = index;
+                }
+            }
+            error += texel_error;
+            block |= u64{texel_index} << (45 - texel * 3);
+        }
+        if (error < best_error) {
+            best_error = error;
+            best_block = block;
+        }
+        if (error == 0) {
+            break;
+        }
+    }
+    return best_block;
+}
+
+void WriteBigEndian(u64 value, u8* dest) {
+    for (u32 i = 0; i < 8; i++) {
+        dest[i] = static_cast<u8>(value >> (56 - i * 8));
+    }
+}
+
+} // Anonymous namespace
+
+std::size_t ETC2Size(u32 width, u32 height) {
+    return std::size_t{(width + 3) / 4} * ((height + 3) / 4) * BLOCK_SIZE;
+}
+
+void EncodeETC2(std::span<const u8> rgba, u32 width, u32 height, std::span<u8> output) {
+    const u32 blocks_x = (width + 3) / 4;
+    const u32 blocks_y = (height + 3) / 4;
+    u8* dest = output.data();
+    for (u32 block_y = 0; block_y < blocks_y; block_y++) {
+        for (u32 block_x = 0; block_x < blocks_x; block_x++) {
+            Texels texels;
+            for (u32 x = 0; x < 4; x++) {
+                for (u32 y = 0; y < 4; y++) {
+                    const u32 src_x = std::min(block_x * 4 + x, width - 1);
+                    const u32 src_y = std::min(block_y * 4 + y, height - 1);
+                    const u8* texel = rgba.data() + (src_y * width + src_x) * 4;
+                    texels[x * 4 + y] = {texel[0], texel[1], texel[2], texel[3]};
+                }
+            }
+            WriteBigEndian(EncodeAlpha(texels), dest);
+            WriteBigEndian(EncodeColor(texels), dest + 8);
+            dest += BLOCK_SIZE;
+        }
+    }
+}
+
+} // namespace VideoCore
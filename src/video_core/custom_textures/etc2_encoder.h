@@ -0,0 +1,22 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include "common/common_types.h"
+
+namespace VideoCore {
+
+/// Returns the size in bytes of an ETC2 RGBA8 EAC image with the provided dimensions.
+[[nodiscard]] std::size_t ETC2Size(u32 width, u32 height);
+
+/**
+ * Encodes an RGBA8 image to ETC2 RGBA8 EAC blocks. The color part only uses the ETC1 compatible
+ * modes, which keeps the encoder fast enough to run on device. Partial blocks at the edges
+ * are padded by repeating the last row and column.
+ */
+void EncodeETC2(std::span<const u8> rgba, u32 width, u32 height, std::span<u8> output);
+
+} // namespace VideoCore
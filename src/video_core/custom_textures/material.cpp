@@ -3,15 +3,27 @@
 // Refer to the license.txt file included.
 
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/texture.h"
 #include "core/frontend/image_interface.h"
+#include "video_core/custom_textures/etc2_encoder.h"
 #include "video_core/custom_textures/material.h"
 
 namespace VideoCore {
 
 namespace {
 
+constexpr u32 TRANSCODE_MAGIC = 0x43545445; // "ETTC"
+constexpr u32 TRANSCODE_VERSION = 1;
+
+struct TranscodeHeader {
+    u32 magic;
+    u32 version;
+    u32 width;
+    u32 height;
+};
+
 CustomPixelFormat ToCustomPixelFormat(ddsktx_format format) {
     switch (format) {
     case DDSKTX_FORMAT_RGBA8:
@@ -54,18 +66,34 @@ CustomTexture::CustomTexture(Frontend::ImageInterface& image_interface_)
 
 CustomTexture::~CustomTexture() = default;
 
-void CustomTexture::LoadFromDisk(bool flip_png) {
+void CustomTexture::LoadFromDisk(bool flip_png, const std::string& transcode_dir) {
     std::scoped_lock lock{decode_mutex};
     if (IsLoaded()) {
         return;
     }
 
-    FileUtil::IOFile file{path, "rb"};
-    std::vector<u8> input(file.GetSize());
-    if (file.ReadBytes(input.data(), input.size()) != input.size()) {
-        LOG_CRITICAL(Render, "Failed to open custom texture: {}", path);
-        return;
+    std::vector<u8> file_data;
+    std::span<const u8> input = packed_data;
+    if (input.empty()) {
+        FileUtil::IOFile file{path, "rb"};
+        file_data.resize(file.GetSize());
+        if (file.ReadBytes(file_data.data(), file_data.size()) != file_data.size()) {
+            LOG_CRITICAL(Render, "Failed to open custom texture: {}", path);
+            return;
+        }
+        input = file_data;
     }
+
+    // Transcoded textures are keyed by the source file contents, so edited files are picked up.
+    std::string transcode_path;
+    if (!transcode_dir.empty()) {
+        const u64 source_hash = Common::ComputeHash64(input.data(), input.size()) ^ flip_png;
+        transcode_path = fmt::format("{}{:016X}.etc2", transcode_dir, source_hash);
+        if (LoadTranscoded(transcode_path)) {
+            return;
+        }
+    }
+
     switch (file_format) {
     case CustomFileFormat::PNG:
         LoadPNG(input, flip_png);
@@ -77,6 +105,9 @@ void CustomTexture::LoadFromDisk(bool flip_png) {
     default:
         LOG_ERROR(Render, "Unknown file format {}", file_format);
     }
+    if (!transcode_path.empty() && IsLoaded() && format == CustomPixelFormat::RGBA8) {
+        Transcode(transcode_path);
+    }
 }
 
 void CustomTexture::LoadPNG(std::span<const u8> input, bool flip_png) {
@@ -96,7 +127,47 @@ void CustomTexture::LoadDDS(std::span<const u8> input) {
     format = ToCustomPixelFormat(dds_format);
 }
 
-void Material::LoadFromDisk(bool flip_png) noexcept {
+bool CustomTexture::LoadTranscoded(const std::string& transcode_path) {
+    FileUtil::IOFile file{transcode_path, "rb"};
+    TranscodeHeader header;
+    if (!file.IsOpen() || file.ReadArray(&header, 1) != 1 || header.magic != TRANSCODE_MAGIC ||
+        header.version != TRANSCODE_VERSION) {
+        return false;
+    }
+    const std::size_t size = ETC2Size(header.width, header.height);
+    if (file.GetSize() != sizeof(header) + size) {
+        return false;
+    }
+    data.resize(size);
+    if (file.ReadBytes(data.data(), size) != size) {
+        data.clear();
+        return false;
+    }
+    width = header.width;
+    height = header.height;
+    format = CustomPixelFormat::ETC2;
+    return true;
+}
+
+void CustomTexture::Transcode(const std::string& transcode_path) {
+    std::vector<u8> compressed(ETC2Size(width, height));
+    EncodeETC2(data, width, height, compressed);
+    data = std::move(compressed);
+    format = CustomPixelFormat::ETC2;
+
+    const TranscodeHeader header = {
+        .magic = TRANSCODE_MAGIC,
+        .version = TRANSCODE_VERSION,
+        .width = width,
+        .height = height,
+    };
+    FileUtil::IOFile file{transcode_path, "wb"};
+    if (file.WriteObject(header) != 1 || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Render, "Failed to write transcoded texture {}", transcode_path);
+    }
+}
+
+void Material::LoadFromDisk(bool flip_png, const std::string& transcode_dir) noexcept {
     if (IsDecoded()) {
         return;
     }
@@ -104,8 +175,10 @@ void Material::LoadFromDisk(bool flip_png) noexcept {
         if (!texture || texture->IsLoaded()) {
             continue;
         }
-        texture->LoadFromDisk(flip_png);
+        texture->LoadFromDisk(flip_png, transcode_dir);
         size += texture->data.size();
+        texture->data_accounting = Common::MemoryAccounting::Allocation{
+            Common::MemoryAccounting::Category::CustomTextures, texture->data.size()};
         LOG_DEBUG(Render, "Loading {} map {}", MapTypeName(texture->type), texture->path);
     }
     if (!textures[0]) {
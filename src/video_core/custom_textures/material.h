@@ -10,6 +10,7 @@
 #include <span>
 #include <string>
 #include <vector>
+#include "common/memory_accounting.h"
 #include "video_core/custom_textures/custom_format.h"
 
 namespace Frontend {
@@ -37,7 +38,7 @@ public:
     explicit CustomTexture(Frontend::ImageInterface& image_interface);
     ~CustomTexture();
 
-    void LoadFromDisk(bool flip_png);
+    void LoadFromDisk(bool flip_png, const std::string& transcode_dir);
 
     [[nodiscard]] bool IsParsed() const noexcept {
         return file_format != CustomFileFormat::None && !hashes.empty();
@@ -52,9 +53,14 @@ private:
 
     void LoadDDS(std::span<const u8> input);
 
+    bool LoadTranscoded(const std::string& transcode_path);
+
+    void Transcode(const std::string& transcode_path);
+
 public:
     Frontend::ImageInterface& image_interface;
     std::string path;
+    std::span<const u8> packed_data; ///< Encoded file contents when loaded from a texture pack
     u32 width;
     u32 height;
     std::vector<u64> hashes;
@@ -62,6 +68,7 @@ public:
     CustomPixelFormat format;
     CustomFileFormat file_format;
     std::vector<u8> data;
+    Common::MemoryAccounting::Allocation data_accounting; ///< Accounts the decoded data
     MapType type;
 };
 
@@ -74,7 +81,7 @@ struct Material {
     std::array<CustomTexture*, MAX_MAPS> textures;
     std::atomic<DecodeState> state{};
 
-    void LoadFromDisk(bool flip_png) noexcept;
+    void LoadFromDisk(bool flip_png, const std::string& transcode_dir) noexcept;
 
     void AddMapTexture(CustomTexture* texture) noexcept;
 
@@ -0,0 +1,232 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "video_core/custom_textures/texture_pack.h"
+
+namespace VideoCore {
+
+namespace {
+
+constexpr u32 PACK_MAGIC = 0x4B505443; // "CTPK"
+constexpr u32 PACK_VERSION = 1;
+constexpr u64 PAYLOAD_ALIGNMENT = 16;
+
+enum PackFlags : u32 {
+    SkipMipmap = 1 << 0,
+    FlipPngFiles = 1 << 1,
+    UseNewHash = 1 << 2,
+};
+
+struct PackHeader {
+    u32 magic;
+    u32 version;
+    u32 num_entries;
+    u32 flags;
+    u64 entries_offset;
+    u64 payload_offset;
+};
+static_assert(sizeof(PackHeader) == 32);
+
+u32 ReadLE32(std::span<const u8> data, std::size_t offset) {
+    return data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) |
+           (static_cast<u32>(data[offset + 3]) << 24);
+}
+
+u32 ReadBE32(std::span<const u8> data, std::size_t offset) {
+    return (static_cast<u32>(data[offset]) << 24) | (data[offset + 1] << 16) |
+           (data[offset + 2] << 8) | data[offset + 3];
+}
+
+/// Fills the dimensions of the entry from the header of the encoded file, when it can be parsed.
+void ReadImageInfo(std::span<const u8> data, TexturePackEntry& entry) {
+    switch (static_cast<CustomFileFormat>(entry.file_format)) {
+    case CustomFileFormat::PNG:
+        // The IHDR chunk always directly follows the 8 byte signature.
+        if (data.size() >= 24) {
+            entry.width = ReadBE32(data, 16);
+            entry.height = ReadBE32(data, 20);
+            entry.levels = 1;
+        }
+        break;
+    case CustomFileFormat::DDS:
+        if (data.size() >= 32) {
+            entry.height = ReadLE32(data, 12);
+            entry.width = ReadLE32(data, 16);
+            entry.levels = static_cast<u16>(std::max(ReadLE32(data, 28), 1U));
+        }
+        break;
+    case CustomFileFormat::KTX:
+        if (data.size() >= 60) {
+            entry.width = ReadLE32(data, 36);
+            entry.height = ReadLE32(data, 40);
+            entry.levels = static_cast<u16>(std::max(ReadLE32(data, 56), 1U));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+} // Anonymous namespace
+
+TexturePack::TexturePack() = default;
+
+TexturePack::~TexturePack() {
+    Close();
+}
+
+bool TexturePack::Open(const std::string& path) {
+    Close();
+
+    FileUtil::IOFile file{path, "rb"};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    const u64 file_size = file.GetSize();
+    if (file_size < sizeof(PackHeader)) {
+        LOG_ERROR(Render, "Texture pack {} is too small", path);
+        return false;
+    }
+
+    if (!mapping.Open(file)) {
+        LOG_ERROR(Render, "Unable to map texture pack {}", path);
+        return false;
+    }
+    const u8* const base = mapping.Data().data();
+    const std::size_t size = mapping.Data().size();
+
+    PackHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const u64 entries_end =
+        header.entries_offset + u64{header.num_entries} * sizeof(TexturePackEntry);
+    if (header.magic != PACK_MAGIC || header.version != PACK_VERSION ||
+        header.entries_offset % alignof(TexturePackEntry) != 0 || entries_end > size) {
+        LOG_ERROR(Render, "Texture pack {} has an invalid header", path);
+        Close();
+        return false;
+    }
+
+    entries = std::span{reinterpret_cast<const TexturePackEntry*>(base + header.entries_offset),
+                        header.num_entries};
+    options = {
+        .skip_mipmap = (header.flags & SkipMipmap) != 0,
+        .flip_png_files = (header.flags & FlipPngFiles) != 0,
+        .use_new_hash = (header.flags & UseNewHash) != 0,
+    };
+    LOG_INFO(Render, "Opened texture pack {} with {} entries", path, entries.size());
+    return true;
+}
+
+void TexturePack::Close() {
+    entries = {};
+    mapping.Close();
+}
+
+std::span<const TexturePackEntry> TexturePack::Find(u64 hash) const {
+    const auto [first, last] = std::equal_range(
+        entries.begin(), entries.end(), hash, [](const auto& lhs, const auto& rhs) {
+            using Lhs = std::decay_t<decltype(lhs)>;
+            if constexpr (std::is_same_v<Lhs, u64>) {
+                return lhs < rhs.hash;
+            } else {
+                return lhs.hash < rhs;
+            }
+        });
+    return {first, last};
+}
+
+std::span<const u8> TexturePack::Payload(const TexturePackEntry& entry) const {
+    const std::span<const u8> data = mapping.Data();
+    if (entry.offset > data.size() || entry.size > data.size() - entry.offset) {
+        LOG_ERROR(Render, "Texture pack entry {:016X} is out of bounds", entry.hash);
+        return {};
+    }
+    return data.subspan(entry.offset, entry.size);
+}
+
+bool TexturePack::Write(const std::string& path, std::span<const TexturePackSource> sources,
+                        const TexturePackOptions& options) {
+    std::size_t num_entries = 0;
+    for (const TexturePackSource& source : sources) {
+        num_entries += source.hashes.size();
+    }
+
+    const u64 entries_offset = sizeof(PackHeader);
+    const u64 payload_offset = Common::AlignUp(
+        entries_offset + num_entries * sizeof(TexturePackEntry), PAYLOAD_ALIGNMENT);
+
+    FileUtil::IOFile file{path, "wb"};
+    if (!file.IsOpen() || !file.Seek(payload_offset, SEEK_SET)) {
+        LOG_ERROR(Render, "Unable to create texture pack {}", path);
+        return false;
+    }
+
+    // Stream every file into the payload once, then write the sorted index in front of it.
+    std::vector<TexturePackEntry> index;
+    index.reserve(num_entries);
+    std::vector<u8> data;
+    u64 offset = payload_offset;
+    for (const TexturePackSource& source : sources) {
+        FileUtil::IOFile input{source.path, "rb"};
+        data.resize(input.GetSize());
+        if (!input.IsOpen() || input.ReadBytes(data.data(), data.size()) != data.size()) {
+            LOG_ERROR(Render, "Unable to read custom texture {}, skipping", source.path);
+            continue;
+        }
+
+        TexturePackEntry entry = {
+            .hash = 0,
+            .offset = offset,
+            .size = static_cast<u32>(data.size()),
+            .width = 0,
+            .height = 0,
+            .levels = 0,
+            .file_format = static_cast<u8>(source.file_format),
+            .map_type = static_cast<u8>(source.map_type),
+        };
+        ReadImageInfo(data, entry);
+        for (const u64 hash : source.hashes) {
+            entry.hash = hash;
+            index.push_back(entry);
+        }
+
+        const u64 padded_size = Common::AlignUp<u64>(data.size(), PAYLOAD_ALIGNMENT);
+        data.resize(padded_size);
+        if (file.WriteBytes(data.data(), data.size()) != data.size()) {
+            LOG_ERROR(Render, "Failed to write texture pack {}", path);
+            return false;
+        }
+        offset += padded_size;
+    }
+
+    std::sort(index.begin(), index.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.hash != rhs.hash ? lhs.hash < rhs.hash : lhs.map_type < rhs.map_type;
+    });
+
+    const PackHeader header = {
+        .magic = PACK_MAGIC,
+        .version = PACK_VERSION,
+        .num_entries = static_cast<u32>(index.size()),
+        .flags = (options.skip_mipmap ? SkipMipmap : 0U) |
+                 (options.flip_png_files ? FlipPngFiles : 0U) |
+                 (options.use_new_hash ? UseNewHash : 0U),
+        .entries_offset = entries_offset,
+        .payload_offset = payload_offset,
+    };
+    if (!file.Seek(0, SEEK_SET) || file.WriteObject(header) != 1 ||
+        file.WriteArray(index.data(), index.size()) != index.size()) {
+        LOG_ERROR(Render, "Failed to write texture pack index {}", path);
+        return false;
+    }
+
+    LOG_INFO(Render, "Wrote texture pack {} with {} entries", path, index.size());
+    return true;
+}
+
+} // namespace VideoCore
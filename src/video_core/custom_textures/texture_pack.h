@@ -0,0 +1,94 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "common/mapped_file.h"
+#include "video_core/custom_textures/material.h"
+
+namespace VideoCore {
+
+/// Name of the single file pack container inside a title's texture load directory
+constexpr std::string_view TEXTURE_PACK_FILENAME = "textures.pack";
+
+/// Index entry of a packed custom texture. Entries are sorted by hash, then map type.
+struct TexturePackEntry {
+    u64 hash;       ///< Data hash of the guest texture
+    u64 offset;     ///< Offset of the encoded file in the pack
+    u32 size;       ///< Size of the encoded file in bytes
+    u32 width;      ///< Width of the texture, 0 if unknown
+    u32 height;     ///< Height of the texture, 0 if unknown
+    u16 levels;     ///< Number of mip levels stored in the file, 0 if unknown
+    u8 file_format; ///< CustomFileFormat of the encoded file
+    u8 map_type;    ///< MapType the texture is assigned to
+};
+static_assert(sizeof(TexturePackEntry) == 32 && std::is_trivially_copyable_v<TexturePackEntry>);
+
+/// Pack options stored in the header, mirroring the pack.json options
+struct TexturePackOptions {
+    bool skip_mipmap{false};
+    bool flip_png_files{true};
+    bool use_new_hash{true};
+};
+
+/// Source loose file for a pack entry, consumed by TexturePack::Write
+struct TexturePackSource {
+    std::string path;
+    std::vector<u64> hashes;
+    CustomFileFormat file_format;
+    MapType map_type;
+};
+
+/**
+ * Read-only view of a texture pack file. The file is memory mapped so the index lookup
+ * and the payload of each texture do not need any further file accesses.
+ */
+class TexturePack {
+public:
+    TexturePack();
+    ~TexturePack();
+
+    TexturePack(const TexturePack&) = delete;
+    TexturePack& operator=(const TexturePack&) = delete;
+
+    /// Maps the pack file at path, returns false if the file is missing or malformed.
+    bool Open(const std::string& path);
+
+    /// Unmaps the pack file.
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return mapping.IsOpen();
+    }
+
+    [[nodiscard]] const TexturePackOptions& Options() const noexcept {
+        return options;
+    }
+
+    [[nodiscard]] std::span<const TexturePackEntry> Entries() const noexcept {
+        return entries;
+    }
+
+    /// Returns all the entries assigned to the provided hash.
+    [[nodiscard]] std::span<const TexturePackEntry> Find(u64 hash) const;
+
+    /// Returns the encoded file bytes of the entry.
+    [[nodiscard]] std::span<const u8> Payload(const TexturePackEntry& entry) const;
+
+    /// Writes a pack file at path with the provided loose files and options.
+    static bool Write(const std::string& path, std::span<const TexturePackSource> sources,
+                      const TexturePackOptions& options);
+
+private:
+    Common::MappedFile mapping;
+    std::span<const TexturePackEntry> entries;
+    TexturePackOptions options;
+};
+
+} // namespace VideoCore
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <condition_variable>
 #include <iterator>
 #include <list>
@@ -129,6 +131,12 @@ public:
 
     void DoOnEvent(Event event, const void* data);
 
+    /// Returns whether any breakpoint is enabled or a CiTrace is being recorded, in which case the
+    /// emulation core has to report its events.
+    bool IsActive() const {
+        return recorder != nullptr || std::ranges::any_of(breakpoints, &BreakPoint::enabled);
+    }
+
     /**
      * Resume from the current breakpoint.
      * @warning Calling this from the same thread that OnEvent was called in will cause a deadlock.
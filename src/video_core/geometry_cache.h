@@ -0,0 +1,169 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <utility>
+#include <tsl/robin_map.h>
+#include "common/hash.h"
+
+namespace VideoCore {
+
+/**
+ * Remembers where in a geometry buffer the vertex and index data of earlier draws were uploaded.
+ * A range drawn again is uploaded to the geometry buffer and its pages are counted as cached by
+ * the rasterizer cache, so that writes to them bump the page generations. Later draws from the
+ * range reuse the upload for as long as its generation stays the same. Ranges that keep being
+ * rewritten are left to the stream buffer, as every write to a cached page is slow.
+ */
+class GeometryCache {
+    /// Number of draws from a range before it is uploaded to the geometry buffer
+    static constexpr u8 DRAWS_BEFORE_UPLOAD = 2;
+
+    /// Number of writes to an uploaded range before it is left to the stream buffer
+    static constexpr u8 MAX_REWRITES = 2;
+
+    /// Number of ranges remembered before all of them are forgotten
+    static constexpr std::size_t MAX_ENTRIES = 8192;
+
+    /// Room left at the end of the buffer for the alignment of its uploads
+    static constexpr u32 ALIGNMENT_SLACK = 256;
+
+public:
+    /// Size of the geometry buffer created by the backends
+    static constexpr u32 BUFFER_SIZE = 32 * 1024 * 1024;
+
+    struct Key {
+        PAddr addr;
+        u32 size;
+        u32 format; ///< How the range is laid out in the buffer, see VertexFormat and IndexFormat
+
+        bool operator==(const Key&) const = default;
+    };
+
+    /// Format of an attribute loader range with byte_count bytes per vertex stored stride apart
+    [[nodiscard]] static constexpr u32 VertexFormat(u32 byte_count, u32 stride) {
+        return stride << 8 | byte_count;
+    }
+
+    /// Format of an index range, whose indices may be widened to 16 bits when uploaded
+    [[nodiscard]] static constexpr u32 IndexFormat(bool guest_u16, bool host_u16) {
+        return 1U << 31 | static_cast<u32>(guest_u16) << 1 | static_cast<u32>(host_u16);
+    }
+
+    /**
+     * Returns the offset in the geometry buffer of an earlier upload of the range, or
+     * std::nullopt when the range has to be uploaded because it was not or was written since.
+     */
+    template <class Cache>
+    [[nodiscard]] std::optional<u32> Find(Cache& res_cache, const Key& key) {
+        const auto it = entries.find(key);
+        if (it == entries.end()) {
+            return std::nullopt;
+        }
+        Entry& entry = it.value();
+        if (!entry.resident || entry.epoch != epoch) {
+            return std::nullopt;
+        }
+        if (res_cache.GetRegionGeneration(key.addr, key.size) == entry.generation) {
+            return entry.offset;
+        }
+        entry.resident = false;
+        if (++entry.rewrites >= MAX_REWRITES) {
+            res_cache.TrackRegion(key.addr, key.size, false);
+            entry.registered = false;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Returns true when a range that was not found should be uploaded to the geometry buffer,
+     * in which case Insert must be called with the offset of the upload.
+     * @param upload_size Number of bytes the range takes in the geometry buffer
+     */
+    template <class Cache>
+    [[nodiscard]] bool Reserve(Cache& res_cache, const Key& key, u32 upload_size) {
+        if (entries.size() >= MAX_ENTRIES && !entries.contains(key)) {
+            Clear(res_cache);
+        }
+        Entry& entry = entries[key];
+        if (entry.rewrites >= MAX_REWRITES) {
+            return false;
+        }
+        if (!entry.registered && ++entry.draws < DRAWS_BEFORE_UPLOAD) {
+            return false;
+        }
+        if (head + upload_size + ALIGNMENT_SLACK > BUFFER_SIZE) {
+            // Wrapping around now would discard uploads that the current draw may already use
+            wrap_pending = true;
+            return false;
+        }
+        if (!entry.registered) {
+            res_cache.TrackRegion(key.addr, key.size, true);
+            entry.registered = true;
+        }
+        const std::optional<u64> generation = res_cache.GetRegionGeneration(key.addr, key.size);
+        if (!generation) {
+            return false;
+        }
+        entry.generation = *generation;
+        return true;
+    }
+
+    /// Records that the range was uploaded to offset after a successful Reserve
+    void Insert(const Key& key, u32 offset, u32 upload_size) {
+        Entry& entry = entries[key];
+        entry.offset = offset;
+        entry.epoch = epoch;
+        entry.resident = true;
+        head = offset + upload_size;
+    }
+
+    /// Returns true once when the buffer is full and should wrap around before the next draw
+    [[nodiscard]] bool TakePendingWrap() {
+        return std::exchange(wrap_pending, false);
+    }
+
+    /// Forgets every upload. Called when the buffer wraps around and its contents are discarded.
+    void Invalidate() {
+        epoch++;
+        head = 0;
+    }
+
+    /// Forgets every range, no longer counting their pages as cached
+    template <class Cache>
+    void Clear(Cache& res_cache) {
+        for (const auto& [key, entry] : entries) {
+            if (entry.registered) {
+                res_cache.TrackRegion(key.addr, key.size, false);
+            }
+        }
+        entries.clear();
+    }
+
+private:
+    struct Entry {
+        u64 generation{};  ///< Generation of the pages of the range when it was uploaded
+        u32 offset{};      ///< Offset of the upload in the geometry buffer
+        u32 epoch{};       ///< Epoch of the geometry buffer the range was uploaded in
+        u8 draws{};        ///< Draws from the range before it was uploaded
+        u8 rewrites{};     ///< Writes to the range after its pages were counted as cached
+        bool registered{}; ///< Whether the pages of the range are counted as cached
+        bool resident{};   ///< Whether offset holds the contents of the range
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            return Common::HashCombine(static_cast<u64>(key.addr) << 32 | key.size, key.format);
+        }
+    };
+
+    tsl::robin_map<Key, Entry, KeyHash> entries;
+    u32 epoch{};
+    u32 head{};
+    bool wrap_pending{};
+};
+
+} // namespace VideoCore
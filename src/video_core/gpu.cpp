@@ -5,10 +5,12 @@
 #include "common/archives.h"
 #include "common/hacks/hack_manager.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp_gpu.h"
 #include "core/hle/service/plgldr/plgldr.h"
+#include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_debugger.h"
@@ -18,12 +20,26 @@
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_software/sw_blitter.h"
 #include "video_core/right_eye_disabler.h"
+#include "video_core/stereo_pair_merger.h"
 #include "video_core/video_core.h"
 
 namespace VideoCore {
 
 constexpr VAddr VADDR_LCD = 0x1ED02000;
 constexpr VAddr VADDR_GPU = 0x1EF00000;
+constexpr PAddr PADDR_LCD = 0x10202000;
+constexpr PAddr PADDR_GPU = 0x10400000;
+
+namespace {
+
+/// Guest time after which the emulation thread catches up with the GPU thread once a command has
+/// been queued, delivering its interrupts.
+constexpr s64 GPU_SYNC_TICKS = static_cast<s64>(BASE_CLOCK_RATE_ARM11 / 10000);
+
+/// Set on the thread running the queued GSP commands.
+thread_local bool is_gpu_thread = false;
+
+} // Anonymous namespace
 
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
@@ -31,14 +47,25 @@ MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(1
 GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
          Frontend::EmuWindow* secondary_window)
     : right_eye_disabler{std::make_unique<RightEyeDisabler>(*this)},
+      stereo_pair_merger{std::make_unique<StereoPairMerger>(*this)},
       impl{std::make_unique<Impl>(system, emu_window, secondary_window)} {
     impl->vblank_event = impl->timing.RegisterEvent(
         "GPU::VBlankCallback",
         [this](uintptr_t user_data, s64 cycles_late) { VBlankCallback(user_data, cycles_late); });
     impl->timing.ScheduleEvent(FRAME_TICKS, impl->vblank_event);
+    impl->gpu_sync_event = impl->timing.RegisterEvent(
+        "GPU::GpuSyncCallback",
+        [this](uintptr_t user_data, s64 cycles_late) { GpuSyncCallback(user_data, cycles_late); });
 
     // Bind the rasterizer to the PICA GPU
     impl->pica.BindRasterizer(impl->rasterizer);
+
+    // The OpenGL context is current on the emulation thread and the software renderer writes to
+    // guest memory without tracking, so only Vulkan can process commands on another thread.
+    if (Settings::values.async_gpu.GetValue() &&
+        Settings::values.graphics_api.GetValue() == Settings::GraphicsAPI::Vulkan) {
+        impl->gpu_thread = std::make_unique<Common::ThreadWorker>(1, "GPU");
+    }
 }
 
 GPU::~GPU() = default;
@@ -68,23 +95,65 @@ PAddr GPU::VirtualToPhysicalAddress(VAddr addr) {
 }
 
 void GPU::SetInterruptHandler(Service::GSP::InterruptHandler handler) {
-    impl->signal_interrupt = handler;
-    impl->pica.SetInterruptHandler(handler);
+    WaitIdle();
+    impl->interrupt_handler = handler;
+    // Interrupts raised by the GPU thread are signalled by the emulation thread once it waits
+    impl->signal_interrupt = [this](Service::GSP::InterruptId interrupt_id) {
+        if (!is_gpu_thread) {
+            impl->interrupt_handler(interrupt_id);
+            return;
+        }
+        std::scoped_lock lock{impl->interrupt_mutex};
+        impl->pending_interrupts.push_back(interrupt_id);
+    };
+    impl->pica.SetInterruptHandler(impl->signal_interrupt);
+}
+
+void GPU::WaitIdle() {
+    if (!impl->gpu_thread || is_gpu_thread) {
+        return;
+    }
+    impl->gpu_thread->WaitForRequests();
+    // The surfaces the GPU thread created are tracked before the guest is told it is done
+    impl->system.Memory().ApplyDeferredRasterizerMarks();
+    SignalPendingInterrupts();
 }
 
 void GPU::FlushRegion(PAddr addr, u32 size) {
+    WaitIdle();
     impl->rasterizer->FlushRegion(addr, size);
 }
 
 void GPU::InvalidateRegion(PAddr addr, u32 size) {
+    WaitIdle();
     impl->rasterizer->InvalidateRegion(addr, size);
 }
 
 void GPU::ClearAll(bool flush) {
+    WaitIdle();
     impl->rasterizer->ClearAll(flush);
 }
 
 void GPU::Execute(const Service::GSP::Command& command) {
+    // DMA copies through the memory of the current process, which only the emulation thread may
+    // access. Everything else runs on the GPU thread until the next synchronization point.
+    if (impl->gpu_thread && command.id != Service::GSP::CommandId::RequestDma) {
+        impl->gpu_thread->QueueWork([this, command] {
+            is_gpu_thread = true;
+            Memory::MemorySystem::SetDeferRasterizerMarks(true);
+            ExecuteCommand(command);
+        });
+        if (!impl->gpu_sync_scheduled) {
+            impl->gpu_sync_scheduled = true;
+            impl->timing.ScheduleEvent(GPU_SYNC_TICKS, impl->gpu_sync_event);
+        }
+        return;
+    }
+    WaitIdle();
+    ExecuteCommand(command);
+}
+
+void GPU::ExecuteCommand(const Service::GSP::Command& command) {
     using Service::GSP::CommandId;
     auto& regs = impl->pica.regs;
 
@@ -189,6 +258,7 @@ void GPU::Execute(const Service::GSP::Command& command) {
 }
 
 void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info) {
+    WaitIdle();
     const PAddr phys_address_left = VirtualToPhysicalAddress(info.address_left);
     const PAddr phys_address_right = VirtualToPhysicalAddress(info.address_right);
 
@@ -206,6 +276,13 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
     framebuffer.format = info.format;
     framebuffer.active_fb = info.shown_fb;
 
+    constexpr u32 framebuffer_regs = sizeof(Pica::FramebufferConfig) / sizeof(u32);
+    RecordRegisters(GPU_REG_INDEX(framebuffer_config) + screen_id * framebuffer_regs,
+                    framebuffer_regs);
+    if (screen_id == 0 && impl->debug_context && impl->debug_context->recorder) {
+        impl->debug_context->recorder->FrameFinished();
+    }
+
     // Notify debugger about the buffer swap.
     if (impl->debug_context) {
         impl->debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
@@ -213,17 +290,19 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
 
     if (screen_id == 0) {
         MicroProfileFlip();
-        impl->system.perf_stats->EndGameFrame();
+        impl->system.EndGameFrame();
         right_eye_disabler->ReportEndFrame();
     }
 }
 
 void GPU::SetColorFill(const Pica::ColorFill& fill) {
+    WaitIdle();
     impl->pica.regs_lcd.color_fill_top = fill;
     impl->pica.regs_lcd.color_fill_bottom = fill;
 }
 
 u32 GPU::ReadReg(VAddr addr) {
+    WaitIdle();
     switch (addr & 0xFFFFF000) {
     case VADDR_LCD: {
         const u32 offset = addr - VADDR_LCD;
@@ -246,6 +325,7 @@ u32 GPU::ReadReg(VAddr addr) {
 }
 
 void GPU::WriteReg(VAddr addr, u32 data) {
+    WaitIdle();
     switch (addr & 0xFFFFF000) {
     case VADDR_LCD: {
         const u32 offset = addr - VADDR_LCD;
@@ -253,6 +333,9 @@ void GPU::WriteReg(VAddr addr, u32 data) {
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::RegsLcd::NumIds());
         impl->pica.regs_lcd[index] = data;
+        if (impl->debug_context && impl->debug_context->recorder) {
+            impl->debug_context->recorder->RegisterWritten(PADDR_LCD + offset, data);
+        }
         break;
     }
     case VADDR_GPU:
@@ -312,6 +395,7 @@ GraphicsDebugger& GPU::Debugger() {
 }
 
 void GPU::ApplyPerProgramSettings(u64 program_ID) {
+    WaitIdle();
     auto hack = Common::Hacks::hack_manager.GetHack(
         Common::Hacks::HackType::ACCURATE_MULTIPLICATION, program_ID);
     bool use_accurate_mul = Settings::values.shaders_accurate_mul.GetValue();
@@ -329,6 +413,9 @@ void GPU::ApplyPerProgramSettings(u64 program_ID) {
         }
     }
     impl->rasterizer->SetAccurateMul(use_accurate_mul);
+
+    // Compiled shaders are cached per title, start compiling the ones of this program in advance.
+    impl->pica.SwitchShaderDiskCache(program_ID);
 }
 
 void GPU::SubmitCmdList(u32 index) {
@@ -340,11 +427,16 @@ void GPU::SubmitCmdList(u32 index) {
 
     MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
 
+    // The size and address registers of both channels precede the trigger registers
+    const u32 command_buffer_regs = GPU_REG_INDEX(internal.pipeline.command_buffer);
+    RecordRegisters(command_buffer_regs, 4, command_buffer_regs + 4 + index);
+
     // Forward command list processing to the PICA core.
     const PAddr addr = config.GetPhysicalAddress(index);
     const u32 size = config.GetSize(index);
-    impl->pica.ProcessCmdList(addr, size,
-                              !right_eye_disabler->ShouldAllowCmdQueueTrigger(addr, size));
+    const bool ignore_list = !right_eye_disabler->ShouldAllowCmdQueueTrigger(addr, size);
+    const bool skip_draws = !ignore_list && stereo_pair_merger->ShouldSkipDraws(addr, size);
+    impl->pica.ProcessCmdList(addr, size, ignore_list, skip_draws);
     config.trigger[index] = 0;
 }
 
@@ -355,6 +447,12 @@ void GPU::MemoryFill(u32 index, u32 intr_index) {
         return;
     }
 
+    // The control register holding the trigger is the last one of the configuration
+    constexpr u32 memory_fill_regs = sizeof(Pica::MemoryFillConfig) / sizeof(u32);
+    const u32 memory_fill_first = GPU_REG_INDEX(memory_fill_config) + index * memory_fill_regs;
+    RecordRegisters(memory_fill_first, memory_fill_regs - 1,
+                    memory_fill_first + memory_fill_regs - 1);
+
     // Perform memory fill.
     if (!impl->rasterizer->AccelerateFill(config)) {
         impl->sw_blitter->MemoryFill(config);
@@ -385,6 +483,10 @@ void GPU::MemoryTransfer() {
 
     MICROPROFILE_SCOPE(GPU_DisplayTransfer);
 
+    RecordRegisters(GPU_REG_INDEX(display_transfer_config),
+                    sizeof(Pica::DisplayTransferConfig) / sizeof(u32),
+                    GPU_REG_INDEX(display_transfer_config.trigger));
+
     // Notify debugger about the display transfer.
     if (impl->debug_context) {
         impl->debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
@@ -409,7 +511,39 @@ void GPU::MemoryTransfer() {
     impl->signal_interrupt(Service::GSP::InterruptId::PPF);
 }
 
+void GPU::RecordRegisters(u32 first, u32 count, std::optional<u32> trigger) {
+    if (!impl->debug_context || !impl->debug_context->recorder) {
+        return;
+    }
+    auto& recorder = *impl->debug_context->recorder;
+    const auto& reg_array = impl->pica.regs.reg_array;
+    for (u32 index = first; index < first + count; ++index) {
+        if (index != trigger) {
+            recorder.RegisterWritten(PADDR_GPU + index * sizeof(u32), reg_array[index]);
+        }
+    }
+    if (trigger) {
+        recorder.RegisterWritten(PADDR_GPU + *trigger * sizeof(u32), reg_array[*trigger]);
+    }
+}
+
+void GPU::SignalPendingInterrupts() {
+    std::vector<Service::GSP::InterruptId> interrupts;
+    {
+        std::scoped_lock lock{impl->interrupt_mutex};
+        interrupts.swap(impl->pending_interrupts);
+    }
+    for (const auto interrupt_id : interrupts) {
+        impl->interrupt_handler(interrupt_id);
+    }
+}
+
 void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
+    WaitIdle();
+
+    // Settings changes take effect between two frames, while the GPU thread is idle
+    Settings::RefreshRuntimeSettings(impl->runtime_settings);
+
     // Present renderered frame.
     impl->renderer->SwapBuffers();
 
@@ -421,8 +555,14 @@ void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     impl->timing.ScheduleEvent(FRAME_TICKS - cycles_late, impl->vblank_event);
 }
 
+void GPU::GpuSyncCallback(std::uintptr_t user_data, s64 cycles_late) {
+    impl->gpu_sync_scheduled = false;
+    WaitIdle();
+}
+
 template <class Archive>
 void GPU::serialize(Archive& ar, const u32 file_version) {
+    WaitIdle();
     ar & impl->pica;
 }
 
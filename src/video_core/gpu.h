@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <boost/serialization/access.hpp>
 
 #include "core/hle/service/gsp/gsp_interrupt.h"
@@ -38,6 +39,7 @@ constexpr u64 FRAME_TICKS = 4481136ull;
 class GraphicsDebugger;
 class RendererBase;
 class RightEyeDisabler;
+class StereoPairMerger;
 
 /**
  * The GPU class is the high level interface to the video_core for core services.
@@ -51,6 +53,10 @@ public:
     /// Sets the function to call for signalling GSP interrupts.
     void SetInterruptHandler(Service::GSP::InterruptHandler handler);
 
+    /// Waits for the GPU thread to finish the queued GSP commands and signals the interrupts they
+    /// raised. Does nothing when the GPU is emulated synchronously or on the GPU thread itself.
+    void WaitIdle();
+
     /// Notify rasterizer that any caches of the specified region should be flushed to Switch memory
     void FlushRegion(PAddr addr, u32 size);
 
@@ -97,6 +103,12 @@ public:
     void ApplyPerProgramSettings(u64 program_ID);
 
 private:
+    /// Executes the provided GSP command on the current thread.
+    void ExecuteCommand(const Service::GSP::Command& command);
+
+    /// Signals the interrupts raised by the GPU thread since the last call.
+    void SignalPendingInterrupts();
+
     void SubmitCmdList(u32 index);
 
     // Interrupt index must be 0 or 1 to signal the relative PSC interrupt.
@@ -104,16 +116,24 @@ private:
 
     void MemoryTransfer();
 
+    /// Records the registers [first, first + count) in the CiTrace being recorded, if there is
+    /// one. The trigger register, which starts the operation they configure, is written last.
+    void RecordRegisters(u32 first, u32 count, std::optional<u32> trigger = std::nullopt);
+
     void VBlankCallback(uintptr_t user_data, s64 cycles_late);
 
+    void GpuSyncCallback(uintptr_t user_data, s64 cycles_late);
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const u32 file_version);
 
     std::unique_ptr<RightEyeDisabler> right_eye_disabler;
+    std::unique_ptr<StereoPairMerger> stereo_pair_merger;
 
 private:
     friend class RightEyeDisabler;
+    friend class StereoPairMerger;
     struct Impl;
     std::unique_ptr<Impl> impl;
 
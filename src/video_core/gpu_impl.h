@@ -5,8 +5,12 @@
 
 #pragma once
 
+#include <mutex>
+#include <vector>
 #include "common/archives.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp_gpu.h"
@@ -28,18 +32,27 @@ struct GPU::Impl {
     Core::System& system;
     Memory::MemorySystem& memory;
     std::shared_ptr<Pica::DebugContext> debug_context;
+    Settings::RuntimeSettings runtime_settings;
     Pica::PicaCore pica;
     GraphicsDebugger gpu_debugger;
     std::unique_ptr<RendererBase> renderer;
     RasterizerInterface* rasterizer;
     std::unique_ptr<SwRenderer::SwBlitter> sw_blitter;
     Core::TimingEventType* vblank_event;
+    Core::TimingEventType* gpu_sync_event;
+    bool gpu_sync_scheduled{};
     Service::GSP::InterruptHandler signal_interrupt;
+    Service::GSP::InterruptHandler interrupt_handler;
+    std::mutex interrupt_mutex;
+    std::vector<Service::GSP::InterruptId> pending_interrupts;
+    // Declared last so that it stops before the state it works on is destroyed
+    std::unique_ptr<Common::ThreadWorker> gpu_thread;
 
     explicit Impl(Core::System& system, Frontend::EmuWindow& emu_window,
                   Frontend::EmuWindow* secondary_window)
         : timing{system.CoreTiming()}, system{system}, memory{system.Memory()},
-          debug_context{Pica::g_debug_context}, pica{memory, debug_context},
+          debug_context{Pica::g_debug_context}, runtime_settings{Settings::GetRuntimeSettings()},
+          pica{memory, debug_context, runtime_settings},
           renderer{VideoCore::CreateRenderer(emu_window, secondary_window, pica, system)},
           rasterizer{renderer->Rasterizer()},
           sw_blitter{std::make_unique<SwRenderer::SwBlitter>(memory, rasterizer)} {}
@@ -0,0 +1,187 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#version 450 core
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (location = 0) in vec2 frag_tex_coord;
+layout (location = 0) out vec4 color;
+
+layout (push_constant, std140) uniform DrawInfo {
+    mat4 modelview_matrix;
+    vec4 i_resolution;
+    vec4 o_resolution;
+    int screen_id_l;
+    int screen_id_r;
+    int layer;
+    int reverse_interlaced;
+};
+
+layout (set = 0, binding = 0) uniform sampler2D screen_textures[3];
+
+// Returns the texel at offset from the texel at base
+vec4 Fetch(vec2 base, vec2 offset) {
+    vec2 coord = (base + offset + 0.5) * i_resolution.zw;
+#ifdef ARRAY_DYNAMIC_INDEX
+    return textureLod(screen_textures[screen_id_l], coord, 0.0);
+#else
+    switch (screen_id_l) {
+    case 0:
+        return textureLod(screen_textures[0], coord, 0.0);
+    case 1:
+        return textureLod(screen_textures[1], coord, 0.0);
+    case 2:
+        return textureLod(screen_textures[2], coord, 0.0);
+    }
+#endif
+}
+
+// Edge adaptive spatial upscaler based on AMD FidelityFX Super Resolution 1.0 (MIT license).
+// EASU estimates the direction and length of the local edge from the luma of the 12 nearest
+// texels and filters them with a Lanczos2-like kernel stretched along that edge. The RCAS
+// pass of FSR works on the upscaled image, which would need another render target. Its
+// limiter is applied here to the input one texel away from the pixel instead.
+
+// Sharpening amount, exp2(-0.2) like the default 0.2 stops of FSR
+const float SHARPNESS = 0.87;
+// Largest negative lobe of the sharpening filter
+const float RCAS_LIMIT = 0.25 - (1.0 / 16.0);
+
+float Luma(vec3 rgb) {
+    return rgb.g + 0.5 * (rgb.r + rgb.b);
+}
+
+// Accumulates the direction and length of the edge seen by one of the 4 nearest texels, C is
+// the texel and A, B, D, E are its neighbours above, left, right and below.
+void EasuSet(inout vec2 dir, inout float len, float w, float lA, float lB, float lC, float lD,
+             float lE) {
+    float dc = lD - lC;
+    float cb = lC - lB;
+    float len_x = max(abs(dc), abs(cb));
+    len_x = len_x > 0.0 ? 1.0 / len_x : 0.0;
+    float dir_x = lD - lB;
+    len_x = clamp(abs(dir_x) * len_x, 0.0, 1.0);
+    dir.x += dir_x * w;
+    len += len_x * len_x * w;
+
+    float ec = lE - lC;
+    float ca = lC - lA;
+    float len_y = max(abs(ec), abs(ca));
+    len_y = len_y > 0.0 ? 1.0 / len_y : 0.0;
+    float dir_y = lE - lA;
+    len_y = clamp(abs(dir_y) * len_y, 0.0, 1.0);
+    dir.y += dir_y * w;
+    len += len_y * len_y * w;
+}
+
+// Accumulates the contribution of the texel at offset from the pixel.
+void EasuTap(inout vec3 sum, inout float sum_w, vec2 offset, vec2 dir, vec2 len, float lob,
+             float clp, vec3 texel) {
+    vec2 v = vec2(dot(offset, dir), dot(offset, vec2(-dir.y, dir.x))) * len;
+    float d2 = min(dot(v, v), clp);
+    float w_b = (2.0 / 5.0) * d2 - 1.0;
+    float w_a = lob * d2 - 1.0;
+    w_b *= w_b;
+    w_a *= w_a;
+    w_b = (25.0 / 16.0) * w_b - (25.0 / 16.0 - 1.0);
+    float w = w_b * w_a;
+    sum += texel * w;
+    sum_w += w;
+}
+
+vec4 Upscale() {
+    vec2 pp = frag_tex_coord * i_resolution.xy - 0.5;
+    vec2 fp = floor(pp);
+    pp -= fp;
+
+    //    b c
+    //  e f g h
+    //  i j k l
+    //    n o
+    vec3 b = Fetch(fp, vec2(0.0, -1.0)).rgb;
+    vec3 c = Fetch(fp, vec2(1.0, -1.0)).rgb;
+    vec3 e = Fetch(fp, vec2(-1.0, 0.0)).rgb;
+    vec4 f = Fetch(fp, vec2(0.0, 0.0));
+    vec3 g = Fetch(fp, vec2(1.0, 0.0)).rgb;
+    vec3 h = Fetch(fp, vec2(2.0, 0.0)).rgb;
+    vec3 i = Fetch(fp, vec2(-1.0, 1.0)).rgb;
+    vec3 j = Fetch(fp, vec2(0.0, 1.0)).rgb;
+    vec3 k = Fetch(fp, vec2(1.0, 1.0)).rgb;
+    vec3 l = Fetch(fp, vec2(2.0, 1.0)).rgb;
+    vec3 n = Fetch(fp, vec2(0.0, 2.0)).rgb;
+    vec3 o = Fetch(fp, vec2(1.0, 2.0)).rgb;
+
+    float lb = Luma(b);
+    float lc = Luma(c);
+    float le = Luma(e);
+    float lf = Luma(f.rgb);
+    float lg = Luma(g);
+    float lh = Luma(h);
+    float li = Luma(i);
+    float lj = Luma(j);
+    float lk = Luma(k);
+    float ll = Luma(l);
+    float ln = Luma(n);
+    float lo = Luma(o);
+
+    // Direction and length of the edge, bilinearly weighted between the 4 nearest texels
+    vec2 dir = vec2(0.0);
+    float len = 0.0;
+    EasuSet(dir, len, (1.0 - pp.x) * (1.0 - pp.y), lb, le, lf, lg, lj);
+    EasuSet(dir, len, pp.x * (1.0 - pp.y), lc, lf, lg, lh, lk);
+    EasuSet(dir, len, (1.0 - pp.x) * pp.y, lf, li, lj, lk, ln);
+    EasuSet(dir, len, pp.x * pp.y, lg, lj, lk, ll, lo);
+
+    float dir_r = dot(dir, dir);
+    bool zero = dir_r < (1.0 / 32768.0);
+    dir_r = zero ? 1.0 : inversesqrt(dir_r);
+    dir.x = zero ? 1.0 : dir.x;
+    dir *= dir_r;
+    len = len * 0.5;
+    len *= len;
+    float stretch = dot(dir, dir) / max(abs(dir.x), abs(dir.y));
+    vec2 len2 = vec2(1.0 + (stretch - 1.0) * len, 1.0 - 0.5 * len);
+    float lob = 0.5 + ((1.0 / 4.0 - 0.04) - 0.5) * len;
+    float clp = 1.0 / lob;
+
+    vec3 sum = vec3(0.0);
+    float sum_w = 0.0;
+    EasuTap(sum, sum_w, vec2(0.0, -1.0) - pp, dir, len2, lob, clp, b);
+    EasuTap(sum, sum_w, vec2(1.0, -1.0) - pp, dir, len2, lob, clp, c);
+    EasuTap(sum, sum_w, vec2(-1.0, 1.0) - pp, dir, len2, lob, clp, i);
+    EasuTap(sum, sum_w, vec2(0.0, 1.0) - pp, dir, len2, lob, clp, j);
+    EasuTap(sum, sum_w, vec2(0.0, 0.0) - pp, dir, len2, lob, clp, f.rgb);
+    EasuTap(sum, sum_w, vec2(-1.0, 0.0) - pp, dir, len2, lob, clp, e);
+    EasuTap(sum, sum_w, vec2(1.0, 1.0) - pp, dir, len2, lob, clp, k);
+    EasuTap(sum, sum_w, vec2(2.0, 1.0) - pp, dir, len2, lob, clp, l);
+    EasuTap(sum, sum_w, vec2(2.0, 0.0) - pp, dir, len2, lob, clp, h);
+    EasuTap(sum, sum_w, vec2(1.0, 0.0) - pp, dir, len2, lob, clp, g);
+    EasuTap(sum, sum_w, vec2(1.0, 2.0) - pp, dir, len2, lob, clp, o);
+    EasuTap(sum, sum_w, vec2(0.0, 2.0) - pp, dir, len2, lob, clp, n);
+
+    // Clamping to the 4 nearest texels removes the ringing of the negative lobes
+    vec3 min4 = min(min(f.rgb, g), min(j, k));
+    vec3 max4 = max(max(f.rgb, g), max(j, k));
+    vec3 result = clamp(sum / sum_w, min4, max4);
+
+    // Sharpen against the input one texel away from the pixel, limiting the negative lobe so that
+    // the result does not clip
+    vec3 ring_n = mix(mix(b, c, pp.x), mix(f.rgb, g, pp.x), pp.y);
+    vec3 ring_w = mix(mix(e, f.rgb, pp.x), mix(i, j, pp.x), pp.y);
+    vec3 ring_e = mix(mix(g, h, pp.x), mix(k, l, pp.x), pp.y);
+    vec3 ring_s = mix(mix(j, k, pp.x), mix(n, o, pp.x), pp.y);
+    vec3 ring_min = min(min(ring_n, ring_w), min(ring_e, ring_s));
+    vec3 ring_max = max(max(ring_n, ring_w), max(ring_e, ring_s));
+    vec3 hit_min = min(ring_min, result) / max(4.0 * ring_max, vec3(1.0 / 256.0));
+    vec3 hit_max = (1.0 - ring_max) / min(4.0 * ring_min - 4.0, vec3(-1.0 / 256.0));
+    vec3 lobe_rgb = max(-hit_min, hit_max);
+    float lobe = max(-RCAS_LIMIT, min(max(lobe_rgb.r, max(lobe_rgb.g, lobe_rgb.b)), 0.0)) *
+                 SHARPNESS;
+    result = (lobe * (ring_n + ring_w + ring_e + ring_s) + result) / (4.0 * lobe + 1.0);
+    return vec4(result, f.a);
+}
+
+void main() {
+    color = Upscale();
+}
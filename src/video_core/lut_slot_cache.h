@@ -0,0 +1,56 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <tsl/robin_map.h>
+#include "common/hash.h"
+
+namespace VideoCore {
+
+/**
+ * Remembers where in a texel stream buffer LUTs were uploaded since the buffer last wrapped around,
+ * keyed by their contents. A LUT rewritten with contents that were uploaded before is pointed at
+ * the earlier upload instead of being converted and uploaded again.
+ */
+class LutSlotCache {
+public:
+    /// How the entries of a LUT are converted, equal raw contents of different LUTs convert apart
+    enum class Format : u8 {
+        Lighting,
+        Fog,
+        ProcTexValue,
+        ProcTexColor,
+        ProcTexColorDifference,
+    };
+
+    /// Returns the key identifying the contents of the LUT
+    template <typename T, std::size_t N>
+    [[nodiscard]] static u64 Key(const std::array<T, N>& lut, Format format) {
+        return Common::HashCombine(Common::ComputeHash64(lut.data(), sizeof(lut)),
+                                   static_cast<u64>(format));
+    }
+
+    /// Returns the offset, in elements of the buffer, the contents with the key were uploaded to
+    [[nodiscard]] std::optional<int> Find(u64 key) const {
+        const auto it = slots.find(key);
+        return it != slots.end() ? std::optional<int>{it->second} : std::nullopt;
+    }
+
+    void Insert(u64 key, int offset) {
+        slots.insert_or_assign(key, offset);
+    }
+
+    /// Forgets every slot. Called when the buffer wraps around and its contents are discarded.
+    void Clear() {
+        slots.clear();
+    }
+
+private:
+    tsl::robin_map<u64, int, Common::IdentityHash<u64>> slots;
+};
+
+} // namespace VideoCore
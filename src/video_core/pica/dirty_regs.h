@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include "video_core/pica/regs_internal.h"
 
 namespace Pica {
@@ -86,6 +87,27 @@ union DirtyRegs {
         return framebuffer & BlendMask;
     }
 
+    bool CheckFSConfig() const {
+        // Checks if any reg the fragment shader config is built from may be dirty. The TEV constant
+        // colors and the fog color only feed uniforms and change often, so they are left out.
+        static constexpr u64 TexEnvUniformMask =
+            M(texturing.tev_combiner_buffer_color) | M(texturing.tev_stage0.const_color) |
+            M(texturing.tev_stage1.const_color) | M(texturing.tev_stage2.const_color) |
+            M(texturing.tev_stage3.const_color) | M(texturing.tev_stage4.const_color) |
+            M(texturing.tev_stage5.const_color) | M(texturing.fog_color);
+        const bool lights_dirty =
+            std::any_of(lights.begin(), lights.end(), [](u16 mask) { return mask != 0; });
+        return rasterizer || tex_units || (texenv & ~TexEnvUniformMask) || framebuffer ||
+               light_lut || lights_dirty;
+    }
+
+    bool CheckFixedState() const {
+        // Checks if GPUREG_FACECULLING_CONFIG, GPUREG_FRAGOP_CLIP or any output merger or
+        // framebuffer reg is dirty
+        static constexpr u64 RasterizerMask = M(rasterizer.cull_mode) | M(rasterizer.clip_enable);
+        return (rasterizer & RasterizerMask) || framebuffer;
+    }
+
     bool CheckShadow() const {
         // Checks if GPUREG_FRAGOP_SHADOW or GPUREG_TEXUNIT0_SHADOW are dirty
         static constexpr u64 ShadowMask1 = M(framebuffer.shadow);
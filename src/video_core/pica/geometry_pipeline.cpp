@@ -309,7 +309,10 @@ private:
 
 GeometryPipeline::GeometryPipeline(RegsInternal& regs_, GeometryShaderUnit& gs_unit_,
                                    ShaderSetup& gs_)
-    : regs(regs_), gs_unit(gs_unit_), gs(gs_) {}
+    : regs(regs_), gs_unit(gs_unit_), gs(gs_) {
+    emitted_primitives.reserve(MAX_EMITTED_PRIMITIVES);
+    gs_unit.emitter.primitives = &emitted_primitives;
+}
 
 GeometryPipeline::~GeometryPipeline() = default;
 
@@ -317,6 +320,10 @@ void GeometryPipeline::SetVertexHandler(VertexHandler vertex_handler) {
     this->vertex_handler = std::move(vertex_handler);
 }
 
+void GeometryPipeline::SetPrimitiveHandler(PrimitiveHandler primitive_handler) {
+    this->primitive_handler = std::move(primitive_handler);
+}
+
 void GeometryPipeline::Setup(ShaderEngine* shader_engine) {
     if (!backend) {
         return;
@@ -383,10 +390,22 @@ void GeometryPipeline::SubmitVertex(const AttributeBuffer& input) {
             // for the shader to know if this is the first invocation in a batch, if the program set
             // b15 to false first.
             gs.uniforms.b[15] = true;
+
+            if (emitted_primitives.size() >= MAX_EMITTED_PRIMITIVES) {
+                FlushPrimitives();
+            }
         }
     }
 }
 
+void GeometryPipeline::FlushPrimitives() {
+    if (emitted_primitives.empty()) {
+        return;
+    }
+    primitive_handler(emitted_primitives);
+    emitted_primitives.clear();
+}
+
 template <class Archive>
 void GeometryPipeline::serialize(Archive& ar, const unsigned int version) {
     // vertex_handler and shader_engine are always set to the same value
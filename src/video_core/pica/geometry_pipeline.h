@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <span>
+#include <vector>
 #include <boost/serialization/export.hpp>
 #include "video_core/pica/shader_unit.h"
 
@@ -20,6 +23,9 @@ class GeometryPipeline_Point;
 class GeometryPipeline_VariablePrimitive;
 class GeometryPipeline_FixedPrimitive;
 
+/// Handler type for receiving the primitives emitted by the geometry shader, in emission order
+using PrimitiveHandler = std::function<void(std::span<const EmittedPrimitive>)>;
+
 /// A pipeline receiving from vertex shader and sending to geometry shader and primitive assembler
 class GeometryPipeline {
 public:
@@ -29,6 +35,9 @@ public:
     /// Sets the handler for receiving vertex outputs from vertex shader
     void SetVertexHandler(VertexHandler vertex_handler);
 
+    /// Sets the handler for receiving the primitives emitted by geometry shader
+    void SetPrimitiveHandler(PrimitiveHandler primitive_handler);
+
     /// Setup the geometry shader unit if it is in use
     void Setup(ShaderEngine* shader_engine);
 
@@ -44,8 +53,20 @@ public:
     /// Submits vertex attributes output from vertex shader
     void SubmitVertex(const AttributeBuffer& input);
 
+    /**
+     * Sends the primitives emitted by the geometry shader since the last call to the primitive
+     * handler. The primitives of a draw are collected and sent together, this must be called
+     * before its triangles are drawn.
+     */
+    void FlushPrimitives();
+
 private:
+    /// Number of emitted primitives the arena holds before they are flushed
+    static constexpr std::size_t MAX_EMITTED_PRIMITIVES = 256;
+
     VertexHandler vertex_handler;
+    PrimitiveHandler primitive_handler;
+    std::vector<EmittedPrimitive> emitted_primitives;
     ShaderEngine* shader_engine;
     std::unique_ptr<GeometryPipelineBackend> backend;
     RegsInternal& regs;
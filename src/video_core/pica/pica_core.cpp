@@ -2,15 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <thread>
 #include "common/arch.h"
 #include "common/archives.h"
+#include "common/hash.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/memory.h"
+#include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica/pica_core.h"
+#include "video_core/pica/vertex_cache.h"
 #include "video_core/pica/vertex_loader.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/shader/shader.h"
@@ -30,24 +38,85 @@ union CommandHeader {
 };
 static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect size!");
 
-PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_)
-    : memory{memory_}, debug_context{std::move(debug_context_)},
-      geometry_pipeline{regs.internal, gs_unit, gs_setup},
+namespace {
+
+/// Draws with fewer vertices than this are shaded on the emulation thread.
+constexpr u32 MIN_PARALLEL_VERTICES = 512;
+
+/// Upper bound of threads helping the emulation thread with vertex shading.
+constexpr u32 MAX_VS_WORKERS = 3;
+
+/// Attribute layouts kept decoded, the cache is dropped entirely once it holds this many.
+constexpr std::size_t MAX_VERTEX_LOADERS = 256;
+
+/// Number of consecutive registers that make up a data port.
+constexpr u32 DATA_PORT_SIZE = 8;
+
+/// Copies a burst of data port writes to the table starting at index, wrapping around its end.
+/// Returns true when any entry changed.
+template <typename Entry, std::size_t N>
+bool CopyLutBurst(std::array<Entry, N>& table, u32 index, std::span<const u32> values) {
+    static_assert(sizeof(Entry) == sizeof(u32), "LUT entries must be a single word");
+    bool changed = false;
+    while (!values.empty()) {
+        index %= N;
+        const std::size_t count = std::min<std::size_t>(values.size(), N - index);
+        const std::size_t size = count * sizeof(u32);
+        void* dest = table.data() + index;
+        if (std::memcmp(dest, values.data(), size) != 0) {
+            std::memcpy(dest, values.data(), size);
+            changed = true;
+        }
+        values = values.subspan(count);
+        index += static_cast<u32>(count);
+    }
+    return changed;
+}
+
+} // Anonymous namespace
+
+PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_,
+                   const Settings::RuntimeSettings& runtime_settings_)
+    : runtime_settings{runtime_settings_}, memory{memory_},
+      debug_context{std::move(debug_context_)}, geometry_pipeline{regs.internal, gs_unit, gs_setup},
       shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())} {
     InitializeRegs();
     dirty_regs.SetAllDirty();
 
+    // Large draws are split between the emulation thread and a few workers, each of them
+    // running the vertex shader with its own shader units.
+    if (const u32 num_threads = std::thread::hardware_concurrency(); num_threads > 2) {
+        vs_workers = std::make_unique<Common::StatefulThreadWorker<VertexShaderUnits>>(
+            std::min(num_threads - 2, MAX_VS_WORKERS), "VertexShader workers",
+            [](std::size_t) {
+                VertexShaderUnits units;
+                return units;
+            });
+    }
+    vertex_caches.resize(vs_workers ? vs_workers->NumWorkers() + 1 : 1);
+
     const auto submit_vertex = [this](const AttributeBuffer& buffer) {
         const auto add_triangle = [this](const OutputVertex& v0, const OutputVertex& v1,
                                          const OutputVertex& v2) {
             rasterizer->AddTriangle(v0, v1, v2);
         };
-        const auto vertex = OutputVertex(regs.internal.rasterizer, buffer);
-        primitive_assembler.SubmitVertex(vertex, add_triangle);
+        primitive_assembler.NextVertex() = OutputVertex(regs.internal.rasterizer, buffer);
+        primitive_assembler.SubmitVertex(add_triangle);
+    };
+
+    const auto submit_primitives = [this, submit_vertex](std::span<const EmittedPrimitive> prims) {
+        for (const EmittedPrimitive& primitive : prims) {
+            if (primitive.winding) {
+                primitive_assembler.SetWinding();
+            }
+            for (const AttributeBuffer& vertex : primitive.vertices) {
+                submit_vertex(vertex);
+            }
+        }
     };
 
-    gs_unit.SetVertexHandlers(submit_vertex, [this]() { primitive_assembler.SetWinding(); });
     geometry_pipeline.SetVertexHandler(submit_vertex);
+    geometry_pipeline.SetPrimitiveHandler(submit_primitives);
 
     primitive_assembler.Reconfigure(PipelineRegs::TriangleTopology::List);
 }
@@ -96,15 +165,32 @@ void PicaCore::SetInterruptHandler(Service::GSP::InterruptHandler& signal_interr
     this->signal_interrupt = signal_interrupt;
 }
 
-void PicaCore::ProcessCmdList(PAddr list, u32 size, bool ignore_list) {
+void PicaCore::ProcessCmdList(PAddr list, u32 size, bool ignore_list, bool skip_draws_) {
     if (ignore_list) {
         signal_interrupt(Service::GSP::InterruptId::P3D);
         return;
     }
+    skip_draws = skip_draws_;
+    // Attaching the debugger or starting a trace takes effect from the next command list.
+    debugging = debug_context && debug_context->IsActive();
+    RecordMemory(list, size);
     // Initialize command list tracking.
     const u8* head = memory.GetPhysicalPointer(list);
     cmd_list.Reset(list, head, size);
 
+    if (debugging || DebugUtils::IsPicaTracing()) [[unlikely]] {
+        RunCmdList<true>();
+    } else {
+        RunCmdList<false>();
+    }
+
+    // Merged draws never outlive the command list, the state they use may change outside of it.
+    FlushTriangles();
+    skip_draws = false;
+}
+
+template <bool Debugging>
+void PicaCore::RunCmdList() {
     bool stop_requested = false;
     while (cmd_list.current_index < cmd_list.length) {
         if (stop_requested) [[unlikely]] {
@@ -119,8 +205,18 @@ void PicaCore::ProcessCmdList(PAddr list, u32 size, bool ignore_list) {
         const u32 value = cmd_list.head[cmd_list.current_index++];
         const CommandHeader header{cmd_list.head[cmd_list.current_index++]};
 
+        // Bursts into data ports skip the per-word register dispatch
+        const std::span<const u32> extra_values{cmd_list.head + cmd_list.current_index,
+                                                header.extra_data_length.Value()};
+        if (!Debugging && header.extra_data_length > 0 &&
+            WriteDataPortBurst(header.cmd_id, value, extra_values, header.group_commands,
+                               header.parameter_mask)) {
+            cmd_list.current_index += header.extra_data_length;
+            continue;
+        }
+
         // Write to the requested PICA register.
-        WriteInternalReg(header.cmd_id, value, header.parameter_mask, stop_requested);
+        WriteInternalReg<Debugging>(header.cmd_id, value, header.parameter_mask, stop_requested);
 
         // Write any extra paramters as well.
         for (u32 i = 0; i < header.extra_data_length; ++i) {
@@ -129,16 +225,29 @@ void PicaCore::ProcessCmdList(PAddr list, u32 size, bool ignore_list) {
             }
             const u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
             const u32 extra_value = cmd_list.head[cmd_list.current_index++];
-            WriteInternalReg(cmd, extra_value, header.parameter_mask, stop_requested);
+            WriteInternalReg<Debugging>(cmd, extra_value, header.parameter_mask, stop_requested);
         }
     }
 }
 
+void PicaCore::SwitchShaderDiskCache(u64 title_id) {
+    shader_engine->SwitchDiskCache(title_id);
+}
+
+/// Returns true when writing the register changes state other than the register itself.
+static constexpr bool IsLutDataReg(u32 id) {
+    const auto in_port = [id](u32 port) { return id >= port && id < port + DATA_PORT_SIZE; };
+    return in_port(PICA_REG_INDEX(lighting.lut_data[0])) ||
+           in_port(PICA_REG_INDEX(texturing.fog_lut_data[0])) ||
+           in_port(PICA_REG_INDEX(texturing.proctex_lut_data[0]));
+}
+
 static bool any_byte_match(u32 a, u32 b) {
     return ((a & 0xFF) == (b & 0xFF)) || (((a >> 8) & 0xFF) == ((b >> 8) & 0xFF)) ||
            (((a >> 16) & 0xFF) == ((b >> 16) & 0xFF)) || (((a >> 24) & 0xFF) == ((b >> 24) & 0xFF));
 }
 
+template <bool Debugging>
 void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask, bool& stop_requested) {
     if (id >= RegsInternal::NUM_REGS) {
         LOG_ERROR(
@@ -158,14 +267,24 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask, bool& stop_requeste
     // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
     const u32 old_value = regs.internal.reg_array[id];
     const u32 write_mask = ExpandBitsToBytes[mask];
-    regs.internal.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
 
-    // Track register write.
-    DebugUtils::OnPicaRegWrite(id, mask, regs.internal.reg_array[id]);
+    // Pending triangles are already shaded, only the state used to rasterize them stops the
+    // following draws from being merged with them.
+    if (triangles_pending && id < PICA_REG_INDEX(pipeline) &&
+        (new_value != old_value || IsLutDataReg(id))) {
+        FlushTriangles();
+    }
+    regs.internal.reg_array[id] = new_value;
+
+    if constexpr (Debugging) {
+        // Track register write.
+        DebugUtils::OnPicaRegWrite(id, mask, regs.internal.reg_array[id]);
 
-    // Track events.
-    if (debug_context) {
-        debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded, &id);
+        // Track events.
+        if (debugging) {
+            debug_context->OnEvent(DebugContext::Event::PicaCommandLoaded, &id);
+        }
     }
 
     switch (id) {
@@ -209,6 +328,7 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask, bool& stop_requeste
         const u32 index = static_cast<u32>(id - PICA_REG_INDEX(pipeline.command_buffer.trigger[0]));
         const PAddr addr = regs.internal.pipeline.command_buffer.GetPhysicalAddress(index);
         const u32 size = regs.internal.pipeline.command_buffer.GetSize(index);
+        RecordMemory(addr, size);
         const u8* head = memory.GetPhysicalPointer(addr);
         cmd_list.Reset(addr, head, size);
         break;
@@ -445,11 +565,131 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask, bool& stop_requeste
 
     dirty_regs.Set(id);
 
-    if (debug_context) {
-        debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed, &id);
+    if constexpr (Debugging) {
+        if (debugging) {
+            debug_context->OnEvent(DebugContext::Event::PicaCommandProcessed, &id);
+        }
     }
 }
 
+bool PicaCore::WriteDataPortBurst(u32 id, u32 value, std::span<const u32> extra_values,
+                                  bool grouped, u32 mask) {
+    // Masked writes need every word to be merged with the register.
+    if (mask != 0xF) {
+        return false;
+    }
+
+    const auto in_port = [id, grouped, &extra_values](u32 port) {
+        const u32 last_id = grouped ? id + static_cast<u32>(extra_values.size()) : id;
+        return id >= port && last_id < port + DATA_PORT_SIZE;
+    };
+    const std::array<std::span<const u32>, 2> bursts = {std::span<const u32>{&value, 1},
+                                                        extra_values};
+    const bool gs_mirrors_vs = !regs.internal.pipeline.gs_unit_exclusive_configuration &&
+                               regs.internal.pipeline.use_gs == PipelineRegs::UseGS::No;
+
+    if (in_port(PICA_REG_INDEX(lighting.lut_data[0]))) {
+        FlushTriangles();
+        auto& lut_config = regs.internal.lighting.lut_config;
+        const u32 type = lut_config.type;
+        if (type >= lighting.luts.size()) {
+            return false;
+        }
+        u32 index = lut_config.index;
+        bool changed = false;
+        for (const auto burst : bursts) {
+            changed |= CopyLutBurst(lighting.luts[type], index, burst);
+            index += static_cast<u32>(burst.size());
+        }
+        lighting.lut_dirty |= changed << type;
+        lut_config.index.Assign(index);
+    } else if (in_port(PICA_REG_INDEX(texturing.fog_lut_data[0]))) {
+        FlushTriangles();
+        auto& offset = regs.internal.texturing.fog_lut_offset;
+        u32 index = offset;
+        bool changed = false;
+        for (const auto burst : bursts) {
+            changed |= CopyLutBurst(fog.lut, index, burst);
+            index += static_cast<u32>(burst.size());
+        }
+        fog.lut_dirty |= changed;
+        offset.Assign(index);
+    } else if (in_port(PICA_REG_INDEX(texturing.proctex_lut_data[0]))) {
+        FlushTriangles();
+        auto& lut_config = regs.internal.texturing.proctex_lut_config;
+        const auto lut_table = lut_config.ref_table.Value();
+        u32 index = lut_config.index;
+        bool changed = false;
+        const auto sync_lut = [&](auto& proctex_table) {
+            for (const auto burst : bursts) {
+                changed |= CopyLutBurst(proctex_table, index, burst);
+                index += static_cast<u32>(burst.size());
+            }
+        };
+        switch (lut_table) {
+        case TexturingRegs::ProcTexLutTable::Noise:
+            sync_lut(proctex.noise_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::ColorMap:
+            sync_lut(proctex.color_map_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::AlphaMap:
+            sync_lut(proctex.alpha_map_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::Color:
+            sync_lut(proctex.color_table);
+            break;
+        case TexturingRegs::ProcTexLutTable::ColorDiff:
+            sync_lut(proctex.color_diff_table);
+            break;
+        default:
+            // Writes to unknown tables are dropped but still advance the index
+            index += static_cast<u32>(extra_values.size()) + 1;
+            break;
+        }
+        proctex.table_dirty |= changed << u32(lut_table);
+        lut_config.index.Assign(index);
+    } else if (in_port(PICA_REG_INDEX(vs.uniform_setup.set_value[0]))) {
+        for (const auto burst : bursts) {
+            for (const u32 word : burst) {
+                const auto index = vs_setup.WriteUniformFloatReg(regs.internal.vs, word);
+                if (gs_mirrors_vs && index) {
+                    gs_setup.uniforms.f[index.value()] = vs_setup.uniforms.f[index.value()];
+                }
+            }
+        }
+    } else if (in_port(PICA_REG_INDEX(gs.uniform_setup.set_value[0]))) {
+        for (const auto burst : bursts) {
+            for (const u32 word : burst) {
+                gs_setup.WriteUniformFloatReg(regs.internal.gs, word);
+            }
+        }
+    } else if (id >= PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[0]) &&
+               (grouped ? id + extra_values.size() : id) <=
+                   PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[2])) {
+        for (const auto burst : bursts) {
+            for (const u32 word : burst) {
+                SubmitImmediate(word);
+            }
+        }
+    } else {
+        return false;
+    }
+
+    // Leave the port registers with the last value written to each of them
+    if (grouped) {
+        regs.internal.reg_array[id] = value;
+        for (u32 i = 0; i < extra_values.size(); ++i) {
+            regs.internal.reg_array[id + i + 1] = extra_values[i];
+            dirty_regs.Set(id + i + 1);
+        }
+    } else {
+        regs.internal.reg_array[id] = extra_values.back();
+    }
+    dirty_regs.Set(id);
+    return true;
+}
+
 void PicaCore::SubmitImmediate(u32 value) {
     // Push to word to the queue. This returns true when a full attribute is formed.
     if (!immediate.queue.Push(value)) {
@@ -484,11 +724,16 @@ void PicaCore::SubmitImmediate(u32 value) {
 }
 
 void PicaCore::DrawImmediate() {
+    if (skip_draws) {
+        immediate.current_attribute = 0;
+        return;
+    }
+
     // Compile the vertex shader.
     shader_engine->SetupBatch(vs_setup, regs.internal.vs.main_offset);
 
     // Track vertex in the debug recorder.
-    if (debug_context) {
+    if (debugging) {
         debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
                                std::addressof(immediate.input_vertex));
     }
@@ -513,20 +758,28 @@ void PicaCore::DrawImmediate() {
     geometry_pipeline.SubmitVertex(output);
 
     // Flush the immediate triangle.
-    rasterizer->DrawTriangles();
+    SubmitTriangles();
     immediate.current_attribute = 0;
 
-    if (debug_context) {
+    if (debugging) {
         debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
     }
 }
 
 void PicaCore::DrawArrays(bool is_indexed) {
+    if (skip_draws) {
+        return;
+    }
+
     MICROPROFILE_SCOPE(GPU_Drawing);
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::Draw);
 
     // Track vertex in the debug recorder.
-    if (debug_context) {
+    if (debugging) {
         debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
+        if (debug_context->recorder) {
+            RecordDrawMemory(is_indexed);
+        }
     }
 
     const bool accelerate_draw = [this] {
@@ -542,7 +795,7 @@ void PicaCore::DrawArrays(bool is_indexed) {
         // this, so this is left unimplemented for now. Revisit this when an issue is found in
         // games.
 
-        bool accelerate_draw = Settings::values.use_hw_shader && primitive_assembler.IsEmpty();
+        bool accelerate_draw = runtime_settings.use_hw_shader && primitive_assembler.IsEmpty();
         const auto topology = primitive_assembler.GetTopology();
         if (topology == PipelineRegs::TriangleTopology::Shader ||
             topology == PipelineRegs::TriangleTopology::List) {
@@ -552,26 +805,130 @@ void PicaCore::DrawArrays(bool is_indexed) {
     }();
 
     // Attempt to use hardware vertex shaders if possible.
-    if (accelerate_draw && rasterizer->AccelerateDrawBatch(is_indexed)) {
-        return;
+    if (accelerate_draw) {
+        FlushTriangles();
+        if (rasterizer->AccelerateDrawBatch(is_indexed)) {
+            return;
+        }
     }
 
     // We cannot accelerate the draw, so load and execute the vertex shader for each vertex.
     LoadVertices(is_indexed);
 
     // Draw emitted triangles.
-    rasterizer->DrawTriangles();
+    SubmitTriangles();
 
-    if (debug_context) {
+    if (debugging) {
         debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
     }
 }
 
+void PicaCore::SubmitTriangles() {
+    geometry_pipeline.FlushPrimitives();
+    triangles_pending = true;
+    if (rasterizer->ShouldDrawTriangles()) {
+        FlushTriangles();
+    }
+}
+
+void PicaCore::FlushTriangles() {
+    if (triangles_pending) {
+        rasterizer->DrawTriangles();
+        triangles_pending = false;
+    }
+}
+
+bool PicaCore::CanDeferVertexShading(bool is_indexed) const {
+    // The debugger expects to observe every shader invocation in order and geometry shaders
+    // consuming raw indices bypass the vertex shader altogether.
+    if (debugging &&
+        debug_context->breakpoints[static_cast<int>(DebugContext::Event::VertexShaderInvocation)]
+            .enabled) {
+        return false;
+    }
+    return !is_indexed || !geometry_pipeline.NeedIndexInput();
+}
+
+void PicaCore::RecordMemory(PAddr address, u32 size) {
+    if (!debug_context || !debug_context->recorder || size == 0) {
+        return;
+    }
+    // The memory may be stale while the rasterizer cache holds newer data written by the GPU
+    rasterizer->FlushRegion(address, size);
+    if (const u8* data = memory.GetPhysicalPointer(address)) {
+        debug_context->recorder->MemoryAccessed(data, size, address);
+    }
+}
+
+void PicaCore::RecordDrawMemory(bool is_indexed) {
+    const auto& pipeline = regs.internal.pipeline;
+    if (pipeline.num_vertices == 0) {
+        return;
+    }
+    const PAddr base_address = pipeline.vertex_attributes.GetPhysicalBaseAddress();
+
+    u32 vertex_min = pipeline.vertex_offset;
+    u32 vertex_max = pipeline.vertex_offset + pipeline.num_vertices - 1;
+    if (is_indexed) {
+        const auto& index_info = pipeline.index_array;
+        const PAddr index_address = base_address + index_info.offset;
+        const bool index_u16 = index_info.format != 0;
+        RecordMemory(index_address, pipeline.num_vertices * (index_u16 ? 2 : 1));
+
+        const u8* index_address_8 = memory.GetPhysicalPointer(index_address);
+        if (!index_address_8) {
+            return;
+        }
+        const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+        vertex_min = 0xFFFF;
+        vertex_max = 0;
+        for (u32 i = 0; i < pipeline.num_vertices; ++i) {
+            const u32 vertex = index_u16 ? index_address_16[i] : index_address_8[i];
+            vertex_min = std::min(vertex_min, vertex);
+            vertex_max = std::max(vertex_max, vertex);
+        }
+    }
+
+    if (vertex_min <= vertex_max) {
+        for (const auto& loader : pipeline.vertex_attributes.attribute_loaders) {
+            if (loader.component_count == 0) {
+                continue;
+            }
+            const u32 stride = loader.byte_count;
+            RecordMemory(base_address + loader.data_offset + vertex_min * stride,
+                         (vertex_max - vertex_min + 1) * stride);
+        }
+    }
+
+    for (const auto& texture : regs.internal.texturing.GetTextures()) {
+        if (!texture.enabled) {
+            continue;
+        }
+        // Every mipmap level is stored right after the previous one
+        const u32 nibbles_per_pixel = TexturingRegs::NibblesPerPixel(texture.format);
+        u32 size = 0;
+        for (u32 level = 0; level <= texture.config.lod.max_level; ++level) {
+            size += (texture.config.width >> level) * (texture.config.height >> level) *
+                    nibbles_per_pixel / 2;
+        }
+        RecordMemory(texture.config.GetPhysicalAddress(), size);
+    }
+}
+
+const VertexLoader& PicaCore::GetVertexLoader() {
+    const auto& pipeline = regs.internal.pipeline;
+    const u64 layout_hash = VertexLoader::ComputeLayoutHash(pipeline);
+    if (vertex_loaders.size() >= MAX_VERTEX_LOADERS && !vertex_loaders.contains(layout_hash)) {
+        vertex_loaders.clear();
+    }
+    return vertex_loaders.try_emplace(layout_hash, memory, pipeline).first->second;
+}
+
 void PicaCore::LoadVertices(bool is_indexed) {
     // Read and validate vertex information from the loaders
     const auto& pipeline = regs.internal.pipeline;
     const PAddr base_address = pipeline.vertex_attributes.GetPhysicalBaseAddress();
-    const auto loader = VertexLoader(memory, pipeline);
+    const VertexLoader& loader = GetVertexLoader();
     regs.internal.rasterizer.ValidateSemantics();
 
     // Locate index buffer.
@@ -580,16 +937,25 @@ void PicaCore::LoadVertices(bool is_indexed) {
     const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
     const bool index_u16 = index_info.format != 0;
 
-    // Simple circular-replacement vertex cache
-    const std::size_t VERTEX_CACHE_SIZE = 64;
-    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-    std::array<AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-    u32 vertex_cache_pos = 0;
+    const auto get_vertex = [&](u32 index) -> u32 {
+        // Indexed rendering doesn't use the start offset
+        return is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                          : (index + pipeline.vertex_offset);
+    };
+
+    // The vertex caches of indexed draws are sized to the range of their indices
+    u32 vertex_min = 0;
+    u32 vertex_max = 0;
+    if (is_indexed) {
+        vertex_min = 0xFFFF;
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            const u32 vertex = get_vertex(index);
+            vertex_min = std::min(vertex_min, vertex);
+            vertex_max = std::max(vertex_max, vertex);
+        }
+    }
 
     // Compile the vertex shader for this batch.
-    ShaderUnit shader_unit;
-    AttributeBuffer vs_output;
     shader_engine->SetupBatch(vs_setup, regs.internal.vs.main_offset);
 
     // Setup geometry pipeline in case we are using a geometry shader.
@@ -597,11 +963,98 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
+    if (CanDeferVertexShading(is_indexed)) {
+        const u32 num_vertices = pipeline.num_vertices;
+        vs_outputs.resize(num_vertices);
+
+        // Shades a contiguous range of the draw into vs_outputs, handing cache misses to the
+        // shader engine SHADER_BATCH_SIZE at a time. Each range keeps its own vertex cache so that
+        // the outputs do not depend on how the draw was split.
+        const auto shade_range = [&](VertexShaderUnits& shader_units, VertexCache& vertex_cache,
+                                     u32 begin, u32 end) {
+            if (is_indexed) {
+                vertex_cache.Reset(vertex_min, vertex_max);
+            }
+            std::array<u32, SHADER_BATCH_SIZE> pending_indices;
+            std::array<u32, SHADER_BATCH_SIZE> pending_vertices;
+            std::size_t num_pending = 0;
+
+            const auto flush = [&] {
+                shader_engine->RunBatch(vs_setup, std::span{shader_units.data(), num_pending});
+                for (std::size_t i = 0; i < num_pending; ++i) {
+                    AttributeBuffer& vs_output = vs_outputs[pending_indices[i]];
+                    shader_units[i].WriteOutput(regs.internal.vs, vs_output);
+                    if (is_indexed) {
+                        vertex_cache.Insert(pending_vertices[i], vs_output);
+                    }
+                }
+                num_pending = 0;
+            };
+
+            for (u32 index = begin; index < end; ++index) {
+                const u32 vertex = get_vertex(index);
+                if (is_indexed) {
+                    // A vertex repeated within the pending batch only has its output once the
+                    // batch ran.
+                    const auto pending_end = pending_vertices.begin() + num_pending;
+                    if (std::find(pending_vertices.begin(), pending_end, vertex) != pending_end) {
+                        flush();
+                    }
+                    if (const AttributeBuffer* cached = vertex_cache.Find(vertex)) {
+                        vs_outputs[index] = *cached;
+                        continue;
+                    }
+                }
+
+                AttributeBuffer input;
+                loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
+                shader_units[num_pending].LoadInput(regs.internal.vs, input);
+                pending_indices[num_pending] = index;
+                pending_vertices[num_pending] = vertex;
+                if (++num_pending == SHADER_BATCH_SIZE) {
+                    flush();
+                }
+            }
+            if (num_pending != 0) {
+                flush();
+            }
+        };
+
+        VertexShaderUnits shader_units;
+        if (vs_workers && num_vertices >= MIN_PARALLEL_VERTICES) {
+            // The emulation thread shades the first range itself while the workers take the rest.
+            const u32 num_ranges = static_cast<u32>(vs_workers->NumWorkers()) + 1;
+            const u32 range_size = (num_vertices + num_ranges - 1) / num_ranges;
+            for (u32 begin = range_size; begin < num_vertices; begin += range_size) {
+                const u32 end = std::min(begin + range_size, num_vertices);
+                VertexCache& vertex_cache = vertex_caches[begin / range_size];
+                vs_workers->QueueWork(
+                    [&shade_range, &vertex_cache, begin, end](VertexShaderUnits* units) {
+                        shade_range(*units, vertex_cache, begin, end);
+                    });
+            }
+            shade_range(shader_units, vertex_caches[0], 0, std::min(range_size, num_vertices));
+            vs_workers->WaitForRequests();
+        } else {
+            shade_range(shader_units, vertex_caches[0], 0, num_vertices);
+        }
+
+        // Primitive assembly and geometry shaders rely on submission order.
+        for (u32 index = 0; index < num_vertices; ++index) {
+            geometry_pipeline.SubmitVertex(vs_outputs[index]);
+        }
+        return;
+    }
+
+    VertexCache& vertex_cache = vertex_caches[0];
+    if (is_indexed) {
+        vertex_cache.Reset(vertex_min, vertex_max);
+    }
+    ShaderUnit shader_unit;
+    AttributeBuffer vs_output;
+
     for (u32 index = 0; index < pipeline.num_vertices; ++index) {
-        // Indexed rendering doesn't use the start offset
-        const u32 vertex = is_indexed
-                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                               : (index + pipeline.vertex_offset);
+        const u32 vertex = get_vertex(index);
 
         bool vertex_cache_hit = false;
         if (is_indexed) {
@@ -610,12 +1063,9 @@ void PicaCore::LoadVertices(bool is_indexed) {
                 continue;
             }
 
-            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                    vs_output = vertex_cache[i];
-                    vertex_cache_hit = true;
-                    break;
-                }
+            if (const AttributeBuffer* cached = vertex_cache.Find(vertex)) {
+                vs_output = *cached;
+                vertex_cache_hit = true;
             }
         }
 
@@ -625,7 +1075,7 @@ void PicaCore::LoadVertices(bool is_indexed) {
             loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
 
             // Record vertex processing to the debugger.
-            if (debug_context) {
+            if (debugging) {
                 debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
                                        std::addressof(input));
             }
@@ -637,10 +1087,7 @@ void PicaCore::LoadVertices(bool is_indexed) {
 
             // Cache the vertex when doing indexed rendering.
             if (is_indexed) {
-                vertex_cache[vertex_cache_pos] = vs_output;
-                vertex_cache_valid[vertex_cache_pos] = true;
-                vertex_cache_ids[vertex_cache_pos] = vertex;
-                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                vertex_cache.Insert(vertex, vs_output);
             }
         }
 
@@ -716,6 +1163,64 @@ PicaCore::RenderPropertiesGuess PicaCore::GuessCmdRenderProperties(PAddr list, u
     return find_info;
 }
 
+std::optional<PicaCore::CmdListSignature> PicaCore::SignCmdList(PAddr list, u32 size) {
+    const u8* head = memory.GetPhysicalPointer(list);
+    if (!head) {
+        return std::nullopt;
+    }
+
+    // Work on a copy so the render target addresses can be cleared before hashing.
+    std::vector<u32> words(size / sizeof(u32));
+    std::memcpy(words.data(), head, words.size() * sizeof(u32));
+
+    CmdListSignature signature{};
+    bool color_found = false;
+    std::size_t index = 0;
+    while (index + 1 < words.size()) {
+        // Align read pointer to 8 bytes
+        if (index % 2 != 0) {
+            index++;
+            continue;
+        }
+
+        const std::size_t value_index = index;
+        const CommandHeader header{words[index + 1]};
+        index += 2;
+
+        for (u32 i = 0; i <= header.extra_data_length; ++i) {
+            const std::size_t pos = i == 0 ? value_index : index++;
+            if (pos >= words.size()) {
+                return std::nullopt;
+            }
+            const u32 cmd = header.cmd_id + (header.group_commands ? i : 0);
+            switch (cmd) {
+            case PICA_REG_INDEX(framebuffer.framebuffer.color_buffer_address):
+                if (color_found) {
+                    return std::nullopt;
+                }
+                color_found = true;
+                signature.color_address = DecodeAddressRegister(words[pos] & 0xFFFFFFF);
+                words[pos] = 0;
+                break;
+            case PICA_REG_INDEX(framebuffer.framebuffer.depth_buffer_address):
+                words[pos] = 0;
+                break;
+            case PICA_REG_INDEX(pipeline.command_buffer.trigger[0]):
+            case PICA_REG_INDEX(pipeline.command_buffer.trigger[1]):
+                return std::nullopt;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (!color_found) {
+        return std::nullopt;
+    }
+    signature.hash = Common::ComputeHash64(words.data(), words.size() * sizeof(u32));
+    return signature;
+}
+
 template <class Archive>
 void PicaCore::CommandList::serialize(Archive& ar, const u32 file_version) {
     ar & addr;
@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/dirty_regs.h"
 #include "video_core/pica/geometry_pipeline.h"
@@ -15,6 +19,7 @@
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_loader.h"
 
 namespace Memory {
 class MemorySystem;
@@ -24,35 +29,76 @@ namespace VideoCore {
 class RasterizerInterface;
 }
 
+namespace Settings {
+struct RuntimeSettings;
+}
+
 namespace Pica {
 
 class DebugContext;
 class ShaderEngine;
+class VertexCache;
 
 class PicaCore {
 public:
-    explicit PicaCore(Memory::MemorySystem& memory, std::shared_ptr<DebugContext> debug_context_);
+    explicit PicaCore(Memory::MemorySystem& memory, std::shared_ptr<DebugContext> debug_context_,
+                      const Settings::RuntimeSettings& runtime_settings);
     ~PicaCore();
 
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
     void SetInterruptHandler(Service::GSP::InterruptHandler& signal_interrupt);
 
-    void ProcessCmdList(PAddr list, u32 size, bool ignore_list);
+    /// Processes the command list. When skip_draws is set only the register writes are applied.
+    void ProcessCmdList(PAddr list, u32 size, bool ignore_list, bool skip_draws = false);
+
+    /// Switches the shader engine disk cache to the specified title.
+    void SwitchShaderDiskCache(u64 title_id);
 
 private:
     void InitializeRegs();
 
+    /// Runs the current command list. The debugging instantiation reports every register write
+    /// to the debugger and the PICA tracer, the other one skips all the hooks.
+    template <bool Debugging>
+    void RunCmdList();
+
+    template <bool Debugging>
     void WriteInternalReg(u32 id, u32 value, u32 mask, bool& stop_requested);
 
+    /// Writes all the values of a command into the data ports of the LUTs, float uniforms or
+    /// immediate vertices at once. Returns false when the command has to be written word by word.
+    bool WriteDataPortBurst(u32 id, u32 value, std::span<const u32> extra_values, bool grouped,
+                            u32 mask);
+
     void SubmitImmediate(u32 data);
 
     void DrawImmediate();
 
     void DrawArrays(bool is_indexed);
 
+    /// Draws the triangles of the current draw, or leaves them pending so that they are merged
+    /// with the following draws as long as no state they depend on changes in between.
+    void SubmitTriangles();
+
+    /// Draws the pending triangles of the previous draws.
+    void FlushTriangles();
+
+    /// Returns the vertex loader for the current attribute layout, decoding it on first use.
+    const VertexLoader& GetVertexLoader();
+
     void LoadVertices(bool is_indexed);
 
+    /// Returns true when the vertices of the current draw can be shaded in batches before being
+    /// submitted, possibly on the worker threads.
+    bool CanDeferVertexShading(bool is_indexed) const;
+
+    /// Stores memory the GPU is about to read in the CiTrace being recorded, if there is one.
+    void RecordMemory(PAddr address, u32 size);
+
+    /// Stores the index, vertex and texture memory read by the current draw in the CiTrace.
+    void RecordDrawMemory(bool is_indexed);
+
 public:
     union Regs {
         static constexpr std::size_t NUM_REGS = 0x732;
@@ -277,6 +323,9 @@ public:
     AttributeBuffer input_default_attributes{};
     ImmediateModeState immediate{};
 
+    /// Settings snapshot of the GPU, refreshed between frames
+    const Settings::RuntimeSettings& runtime_settings;
+
 private:
     friend class boost::serialization::access;
     template <class Archive>
@@ -309,6 +358,15 @@ public:
 
     RenderPropertiesGuess GuessCmdRenderProperties(PAddr list, u32 size);
 
+    struct CmdListSignature {
+        u64 hash;
+        PAddr color_address;
+    };
+
+    /// Hashes the command list without the render target addresses it writes. Returns nothing
+    /// when the list calls other lists or does not render to exactly one color buffer.
+    std::optional<CmdListSignature> SignCmdList(PAddr list, u32 size);
+
 private:
     Memory::MemorySystem& memory;
     VideoCore::RasterizerInterface* rasterizer;
@@ -318,6 +376,16 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+    using VertexShaderUnits = std::array<ShaderUnit, SHADER_BATCH_SIZE>;
+    std::unique_ptr<Common::StatefulThreadWorker<VertexShaderUnits>> vs_workers;
+    std::vector<AttributeBuffer> vs_outputs;
+    /// Post-transform caches of the ranges a draw is split in, the first one is used by the
+    /// emulation thread
+    std::vector<VertexCache> vertex_caches;
+    std::unordered_map<u64, VertexLoader> vertex_loaders;
+    bool triangles_pending{};
+    bool skip_draws{};
+    bool debugging{};
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
@@ -10,20 +10,21 @@ namespace Pica {
 PrimitiveAssembler::PrimitiveAssembler(PipelineRegs::TriangleTopology topology)
     : topology(topology) {}
 
-void PrimitiveAssembler::SubmitVertex(const OutputVertex& vtx,
-                                      const TriangleHandler& triangle_handler) {
+void PrimitiveAssembler::SubmitVertex(const TriangleHandler& triangle_handler) {
+    const u32 slot = FreeSlot();
+    const OutputVertex& vtx = buffer[slot];
     switch (topology) {
     case PipelineRegs::TriangleTopology::List:
     case PipelineRegs::TriangleTopology::Shader:
         if (buffer_index < 2) {
-            buffer[buffer_index++] = vtx;
+            slots[buffer_index++] = slot;
         } else {
             buffer_index = 0;
             if (topology == PipelineRegs::TriangleTopology::Shader && winding) {
-                triangle_handler(buffer[1], buffer[0], vtx);
+                triangle_handler(buffer[slots[1]], buffer[slots[0]], vtx);
                 winding = false;
             } else {
-                triangle_handler(buffer[0], buffer[1], vtx);
+                triangle_handler(buffer[slots[0]], buffer[slots[1]], vtx);
             }
         }
         break;
@@ -31,10 +32,10 @@ void PrimitiveAssembler::SubmitVertex(const OutputVertex& vtx,
     case PipelineRegs::TriangleTopology::Strip:
     case PipelineRegs::TriangleTopology::Fan:
         if (strip_ready) {
-            triangle_handler(buffer[0], buffer[1], vtx);
+            triangle_handler(buffer[slots[0]], buffer[slots[1]], vtx);
         }
 
-        buffer[buffer_index] = vtx;
+        slots[buffer_index] = slot;
         strip_ready |= (buffer_index == 1);
 
         if (topology == PipelineRegs::TriangleTopology::Strip) {
@@ -25,12 +25,20 @@ struct PrimitiveAssembler {
         PipelineRegs::TriangleTopology topology = PipelineRegs::TriangleTopology::List);
 
     /**
-     * Queues a vertex, builds primitives from the vertex queue according to the given
-     * triangle topology, and calls triangle_handler for each generated primitive.
+     * Returns the storage of the next vertex to submit. The assembler keeps its vertices in
+     * place and refers to them by index, so the vertex is never copied once written.
+     */
+    OutputVertex& NextVertex() noexcept {
+        return buffer[FreeSlot()];
+    }
+
+    /**
+     * Queues the vertex written to NextVertex, builds primitives from the vertex queue according
+     * to the given triangle topology, and calls triangle_handler for each generated primitive.
      * NOTE: We could specify the triangle handler in the constructor, but this way we can
      * keep event and handler code next to each other.
      */
-    void SubmitVertex(const OutputVertex& vtx, const TriangleHandler& triangle_handler);
+    void SubmitVertex(const TriangleHandler& triangle_handler);
 
     /**
      * Invert the vertex order of the next triangle. Called by geometry shader emitter.
@@ -72,19 +80,32 @@ struct PrimitiveAssembler {
     }
 
 private:
+    /// Returns the slot of the buffer that holds neither of the queued vertices
+    u32 FreeSlot() const noexcept {
+        return 3 - slots[0] - slots[1];
+    }
+
     PipelineRegs::TriangleTopology topology;
     int buffer_index = 0;
-    std::array<OutputVertex, 2> buffer;
+    std::array<OutputVertex, 3> buffer;
+    std::array<u32, 2> slots{0, 1}; ///< Slots of the buffer holding the queued vertices
     bool strip_ready = false;
     bool winding = false;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int version) {
+        // The queued vertices are stored in queue order, independently of their slots
+        std::array<OutputVertex, 2> queued{buffer[slots[0]], buffer[slots[1]]};
         ar & topology;
         ar & buffer_index;
-        ar & buffer;
+        ar & queued;
         ar & strip_ready;
         ar & winding;
+        if (Archive::is_loading::value) {
+            buffer[0] = queued[0];
+            buffer[1] = queued[1];
+            slots = {0, 1};
+        }
     }
     friend class boost::serialization::access;
 };
@@ -45,7 +45,11 @@ std::optional<u32> ShaderSetup::WriteUniformFloatReg(ShaderRegs& config, u32 val
 
     const u32 index = uniform_setup.index.Value();
     const auto prev = std::exchange(uniforms.f[index], uniform);
-    uniforms_dirty |= prev != uniform;
+    if (prev != uniform) {
+        uniforms_dirty = true;
+        dirty_float_begin = std::min(dirty_float_begin, index);
+        dirty_float_end = std::max(dirty_float_end, index + 1);
+    }
     uniform_setup.index.Assign(index + 1);
     return index;
 }
@@ -13,12 +13,13 @@ namespace Pica {
 
 constexpr u32 MAX_PROGRAM_CODE_LENGTH = 4096;
 constexpr u32 MAX_SWIZZLE_DATA_LENGTH = 4096;
+constexpr u32 NUM_FLOAT_UNIFORMS = 96;
 
 using ProgramCode = std::array<u32, MAX_PROGRAM_CODE_LENGTH>;
 using SwizzleData = std::array<u32, MAX_SWIZZLE_DATA_LENGTH>;
 
 struct Uniforms {
-    alignas(16) std::array<Common::Vec4<f24>, 96> f;
+    alignas(16) std::array<Common::Vec4<f24>, NUM_FLOAT_UNIFORMS> f;
     std::array<bool, 16> b;
     std::array<Common::Vec4<u8>, 4> i;
 
@@ -44,6 +45,15 @@ private:
     }
 };
 
+/**
+ * Values of the bool and integer uniforms a program branches and loops on. The shader JIT can
+ * compile a program with them as constants, which skips the reads and tests of the uniforms.
+ */
+struct ControlUniforms {
+    u16 b{};                ///< Bool uniform i is stored in bit i
+    std::array<u32, 4> i{}; ///< Integer uniforms, x in the lowest byte
+};
+
 struct ShaderRegs;
 
 /**
@@ -72,6 +82,21 @@ public:
 
     std::optional<u32> WriteUniformFloatReg(ShaderRegs& config, u32 value);
 
+    /// Marks every uniform as modified.
+    void MarkUniformsDirty() {
+        uniforms_dirty = true;
+        dirty_float_begin = 0;
+        dirty_float_end = NUM_FLOAT_UNIFORMS;
+    }
+
+    /// Clears the modified state after the uniforms were consumed. Float uniforms are tracked by
+    /// the range [dirty_float_begin, dirty_float_end) so that only those have to be converted.
+    void ClearDirtyUniforms() {
+        uniforms_dirty = false;
+        dirty_float_begin = NUM_FLOAT_UNIFORMS;
+        dirty_float_end = 0;
+    }
+
     u64 GetProgramCodeHash();
 
     u64 GetSwizzleDataHash();
@@ -135,7 +160,10 @@ public:
     PackedAttribute uniform_queue;
     u32 entry_point{};
     const void* cached_shader{};
+    const void* cached_batch_shader{};
     bool uniforms_dirty = true;
+    u32 dirty_float_begin = 0;
+    u32 dirty_float_end = NUM_FLOAT_UNIFORMS;
     bool requires_fixup = false;
     bool has_fixup = false;
 
@@ -169,7 +197,7 @@ private:
         ar & requires_fixup;
         ar & has_fixup;
         if (Archive::is_loading::value) {
-            uniforms_dirty = true;
+            MarkUniformsDirty();
         }
     }
 };
@@ -37,12 +37,7 @@ void GeometryEmitter::Emit(std::span<Common::Vec4<f24>, 16> output_regs) {
     }
 
     if (prim_emit) {
-        if (winding) {
-            handlers->winding_setter();
-        }
-        for (std::size_t i = 0; i < buffer.size(); ++i) {
-            handlers->vertex_handler(buffer[i]);
-        }
+        primitives->push_back({buffer, winding});
     }
 }
 
@@ -50,13 +45,6 @@ GeometryShaderUnit::GeometryShaderUnit() : ShaderUnit{&emitter} {}
 
 GeometryShaderUnit::~GeometryShaderUnit() = default;
 
-void GeometryShaderUnit::SetVertexHandlers(VertexHandler vertex_handler,
-                                           WindingSetter winding_setter) {
-    emitter.handlers = new Handlers;
-    emitter.handlers->vertex_handler = vertex_handler;
-    emitter.handlers->winding_setter = winding_setter;
-}
-
 void GeometryShaderUnit::ConfigOutput(const ShaderRegs& config) {
     emitter.output_mask = config.output_mask;
 }
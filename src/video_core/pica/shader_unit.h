@@ -6,17 +6,21 @@
 
 #include <functional>
 #include <span>
+#include <vector>
 #include <boost/serialization/base_object.hpp>
 
 #include "video_core/pica/output_vertex.h"
 
 namespace Pica {
 
-/// Handler type for receiving vertex outputs from vertex shader or geometry shader
+/// Handler type for receiving vertex outputs from vertex shader
 using VertexHandler = std::function<void(const AttributeBuffer&)>;
 
-/// Handler type for signaling to invert the vertex order of the next triangle
-using WindingSetter = std::function<void()>;
+/// A primitive emitted by the geometry shader
+struct EmittedPrimitive {
+    std::array<AttributeBuffer, 3> vertices;
+    bool winding; ///< Inverts the vertex order of the primitive
+};
 
 struct ShaderRegs;
 struct GeometryEmitter;
@@ -65,10 +69,8 @@ private:
     }
 };
 
-struct Handlers {
-    VertexHandler vertex_handler;
-    WindingSetter winding_setter;
-};
+/// Number of shader units a shader engine may run with a single batched invocation.
+constexpr std::size_t SHADER_BATCH_SIZE = 4;
 
 /// This structure contains state information for primitive emitting in geometry shader.
 struct GeometryEmitter {
@@ -80,7 +82,8 @@ public:
     bool prim_emit;
     bool winding;
     u32 output_mask;
-    Handlers* handlers;
+    /// Arena the emitted primitives are collected to, owned by the geometry pipeline
+    std::vector<EmittedPrimitive>* primitives;
 
 private:
     friend class boost::serialization::access;
@@ -103,7 +106,6 @@ struct GeometryShaderUnit : public ShaderUnit {
     GeometryShaderUnit();
     ~GeometryShaderUnit();
 
-    void SetVertexHandlers(VertexHandler vertex_handler, WindingSetter winding_setter);
     void ConfigOutput(const ShaderRegs& config);
 
     GeometryEmitter emitter;
@@ -0,0 +1,63 @@
+// Copyright Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
+
+namespace Pica {
+
+/**
+ * Post-transform cache of an indexed draw, holding the vertex shader outputs of its vertices so
+ * that each of them is shaded once. The slots are direct-mapped by the distance of the vertex
+ * from the lowest index of the draw. When the indices span no more than MAX_SLOTS vertices every
+ * vertex has a slot of its own, otherwise vertices sharing a slot evict each other.
+ */
+class VertexCache {
+    /// Largest number of slots, which takes 1 MiB of outputs
+    static constexpr u32 MAX_SLOTS = 4096;
+
+public:
+    /// Empties the cache for a draw whose indices are all within [vertex_min, vertex_max]
+    void Reset(u32 vertex_min, u32 vertex_max) {
+        const u32 num_slots = std::bit_ceil(std::min(vertex_max - vertex_min + 1, MAX_SLOTS));
+        base = vertex_min;
+        mask = num_slots - 1;
+        if (entries.size() < num_slots) {
+            entries.resize(num_slots);
+            tags.resize(num_slots);
+        }
+        valid.assign((num_slots + 63) / 64, 0);
+    }
+
+    /// Returns the cached output of the vertex, or nullptr if it was not shaded yet
+    [[nodiscard]] const AttributeBuffer* Find(u32 vertex) const {
+        const u32 slot = (vertex - base) & mask;
+        if (!(valid[slot / 64] >> (slot % 64) & 1) || tags[slot] != vertex) {
+            return nullptr;
+        }
+        return &entries[slot];
+    }
+
+    /// Stores the output of the vertex
+    void Insert(u32 vertex, const AttributeBuffer& output) {
+        const u32 slot = (vertex - base) & mask;
+        entries[slot] = output;
+        tags[slot] = vertex;
+        valid[slot / 64] |= u64{1} << (slot % 64);
+    }
+
+private:
+    std::vector<AttributeBuffer> entries;
+    std::vector<u32> tags;  ///< Vertex whose output each slot holds
+    std::vector<u64> valid; ///< Bitmap of the slots holding an output
+    u32 base{};
+    u32 mask{};
+};
+
+} // namespace Pica
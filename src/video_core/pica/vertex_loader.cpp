@@ -2,23 +2,60 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include "common/alignment.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "video_core/pica/vertex_loader.h"
 
 namespace Pica {
 
+namespace {
+
+template <typename T, u32 NumElements>
+void DecodeAttribute(const u8* data, Common::Vec4<f24>& out) {
+    // Attribute data is only aligned to the element size by the loaders.
+    std::array<T, NumElements> elements;
+    std::memcpy(elements.data(), data, sizeof(elements));
+    for (u32 comp = 0; comp < NumElements; ++comp) {
+        out[comp] = f24::FromFloat32(static_cast<float>(elements[comp]));
+    }
+
+    // Default attribute values set if array elements have < 4 components. This
+    // is *not* carried over from the default attribute settings even if they're
+    // enabled for this attribute.
+    for (u32 comp = NumElements; comp < 4; ++comp) {
+        out[comp] = comp == 3 ? f24::One() : f24::Zero();
+    }
+}
+
+template <typename T>
+constexpr std::array<void (*)(const u8*, Common::Vec4<f24>&), 4> MakeDecoders() {
+    return {&DecodeAttribute<T, 1>, &DecodeAttribute<T, 2>, &DecodeAttribute<T, 3>,
+            &DecodeAttribute<T, 4>};
+}
+
+/// Decoders indexed by the attribute format and the number of elements minus 1.
+constexpr std::array<std::array<void (*)(const u8*, Common::Vec4<f24>&), 4>, 4> DECODERS = {
+    MakeDecoders<s8>(),
+    MakeDecoders<u8>(),
+    MakeDecoders<s16>(),
+    MakeDecoders<f32>(),
+};
+
+} // Anonymous namespace
+
 VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs)
     : memory{memory_} {
     const auto& attribute_config = regs.vertex_attributes;
     num_total_attributes = attribute_config.GetNumTotalAttributes();
 
+    std::array<u32, 16> vertex_attribute_sources;
+    std::array<u32, 16> vertex_attribute_strides{};
+    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
+    std::array<u32, 16> vertex_attribute_elements{};
     vertex_attribute_sources.fill(0xdeadbeef);
 
-    for (u32 i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
-    }
-
     // Setup attribute data from loaders
     for (u32 loader = 0; loader < 12; ++loader) {
         const auto& loader_config = attribute_config.attribute_loaders[loader];
@@ -57,16 +94,11 @@ VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& re
             }
         }
     }
-}
-
-VertexLoader::~VertexLoader() = default;
 
-void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
-                              AttributeBuffer& input_default_attributes) const {
     for (s32 i = 0; i < num_total_attributes; ++i) {
         // Load the default attribute if we're configured to do so
-        if (vertex_attribute_is_default[i]) {
-            input[i] = input_default_attributes[i];
+        if (attribute_config.IsDefaultAttribute(i)) {
+            default_attributes[num_default_attributes++] = static_cast<u32>(i);
             continue;
         }
 
@@ -78,31 +110,40 @@ void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, Attribu
             continue;
         }
 
-        // Load per-vertex data from the loader arrays
-        const PAddr source_addr =
-            base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
-
-        switch (vertex_attribute_formats[i]) {
-        case PipelineRegs::VertexAttributeFormat::BYTE:
-            LoadAttribute<s8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::UBYTE:
-            LoadAttribute<u8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::SHORT:
-            LoadAttribute<s16>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::FLOAT:
-            LoadAttribute<f32>(source_addr, i, input);
-            break;
-        }
+        const auto format = static_cast<std::size_t>(vertex_attribute_formats[i]);
+        attribute_loaders[num_attribute_loaders++] = {
+            .attribute = static_cast<u32>(i),
+            .source = vertex_attribute_sources[i],
+            .stride = vertex_attribute_strides[i],
+            .decode = DECODERS[format][vertex_attribute_elements[i] - 1],
+        };
+    }
+}
 
-        // Default attribute values set if array elements have < 4 components. This
-        // is *not* carried over from the default attribute settings even if they're
-        // enabled for this attribute.
-        for (u32 comp = vertex_attribute_elements[i]; comp < 4; comp++) {
-            input[i][comp] = comp == 3 ? f24::One() : f24::Zero();
-        }
+VertexLoader::~VertexLoader() = default;
+
+u64 VertexLoader::ComputeLayoutHash(const PipelineRegs& regs) {
+    // The layout depends on every attribute register except the base address, which is read
+    // again for each draw.
+    const auto& attribute_config = regs.vertex_attributes;
+    constexpr std::size_t base_address_size = sizeof(u32);
+    return Common::ComputeHash64(reinterpret_cast<const u8*>(&attribute_config) +
+                                     base_address_size,
+                                 sizeof(attribute_config) - base_address_size);
+}
+
+void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
+                              AttributeBuffer& input_default_attributes) const {
+    for (u32 i = 0; i < num_default_attributes; ++i) {
+        const u32 attribute = default_attributes[i];
+        input[attribute] = input_default_attributes[attribute];
+    }
+
+    // Load per-vertex data from the loader arrays
+    for (u32 i = 0; i < num_attribute_loaders; ++i) {
+        const AttributeLoader& loader = attribute_loaders[i];
+        const PAddr source_addr = base_address + loader.source + loader.stride * vertex;
+        loader.decode(memory.GetPhysicalPointer(source_addr), input[loader.attribute]);
     }
 }
 
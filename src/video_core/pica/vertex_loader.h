@@ -14,33 +14,42 @@ class MemorySystem;
 
 namespace Pica {
 
+/**
+ * Loads the vertex shader inputs from the attribute arrays. The attribute layout is decoded from
+ * the registers once, resolving every loaded attribute to a decoder specialized for its format
+ * and number of elements, so loading a vertex does not interpret the registers again.
+ */
 class VertexLoader {
 public:
     explicit VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs);
     ~VertexLoader();
 
+    /// Returns a hash of the registers the attribute layout is decoded from.
+    static u64 ComputeLayoutHash(const PipelineRegs& regs);
+
     void LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
                     AttributeBuffer& input_default_attributes) const;
 
-    template <typename T>
-    void LoadAttribute(PAddr source_addr, u32 attrib, AttributeBuffer& out) const {
-        const T* data = reinterpret_cast<const T*>(memory.GetPhysicalPointer(source_addr));
-        for (u32 comp = 0; comp < vertex_attribute_elements[attrib]; ++comp) {
-            out[attrib][comp] = f24::FromFloat32(data[comp]);
-        }
-    }
-
     int GetNumTotalAttributes() const {
         return num_total_attributes;
     }
 
 private:
+    /// Decodes the elements of one attribute and fills the missing ones with the defaults.
+    using AttributeDecoder = void (*)(const u8* data, Common::Vec4<f24>& out);
+
+    struct AttributeLoader {
+        u32 attribute;
+        u32 source;
+        u32 stride;
+        AttributeDecoder decode;
+    };
+
     Memory::MemorySystem& memory;
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
+    std::array<AttributeLoader, 16> attribute_loaders;
+    std::array<u32, 16> default_attributes;
+    u32 num_attribute_loaders = 0;
+    u32 num_default_attributes = 0;
     int num_total_attributes = 0;
 };
 
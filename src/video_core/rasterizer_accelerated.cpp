@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bit>
 #include "common/alignment.h"
 #include "common/math_util.h"
 #include "core/memory.h"
@@ -55,7 +56,71 @@ RasterizerAccelerated::HardwareVertex::HardwareVertex(const Pica::OutputVertex&
 }
 
 RasterizerAccelerated::RasterizerAccelerated(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
-    : memory{memory_}, pica{pica_}, regs{pica.regs.internal} {}
+    : memory{memory_}, pica{pica_}, regs{pica.regs.internal} {
+    // vs_pica_data starts out empty, whatever the PICA state is
+    pica.vs_setup.MarkUniformsDirty();
+}
+
+void RasterizerAccelerated::SyncVSPicaUniforms() {
+    auto& setup = pica.vs_setup;
+    vs_pica_data.SetFromRegs(setup, setup.dirty_float_begin, setup.dirty_float_end);
+    setup.ClearDirtyUniforms();
+}
+
+void RasterizerAccelerated::RebindCachedLUTsLF() {
+    using Format = LutSlotCache::Format;
+    auto& lighting = pica.lighting;
+    for (u32 dirty = lighting.lut_dirty; dirty != 0; dirty &= dirty - 1) {
+        const u32 index = std::countr_zero(dirty);
+        const u64 key = LutSlotCache::Key(lighting.luts[index], Format::Lighting);
+        if (const auto slot = lut_lf_slots.Find(key)) {
+            fs_data.lighting_lut_offset[index / 4][index % 4] = *slot;
+            fs_data_dirty = true;
+            lighting.lut_dirty &= ~(1 << index);
+        }
+    }
+
+    auto& fog = pica.fog;
+    if (fog.lut_dirty) {
+        if (const auto slot = lut_lf_slots.Find(LutSlotCache::Key(fog.lut, Format::Fog))) {
+            fs_data.fog_lut_offset = *slot;
+            fs_data_dirty = true;
+            fog.lut_dirty = false;
+        }
+    }
+}
+
+void RasterizerAccelerated::RebindCachedLUTs() {
+    using Format = LutSlotCache::Format;
+    auto& proctex = pica.proctex;
+    const auto rebind = [this](const auto& lut, Format format, int& lut_offset, auto& dirty) {
+        if (!dirty) {
+            return;
+        }
+        if (const auto slot = lut_slots.Find(LutSlotCache::Key(lut, format))) {
+            lut_offset = *slot;
+            fs_data_dirty = true;
+            dirty.Assign(0);
+        }
+    };
+
+    rebind(proctex.noise_table, Format::ProcTexValue, fs_data.proctex_noise_lut_offset,
+           proctex.noise_lut_dirty);
+    rebind(proctex.color_map_table, Format::ProcTexValue, fs_data.proctex_color_map_offset,
+           proctex.color_map_dirty);
+    rebind(proctex.alpha_map_table, Format::ProcTexValue, fs_data.proctex_alpha_map_offset,
+           proctex.alpha_map_dirty);
+    rebind(proctex.color_table, Format::ProcTexColor, fs_data.proctex_lut_offset,
+           proctex.lut_dirty);
+    rebind(proctex.color_diff_table, Format::ProcTexColorDifference,
+           fs_data.proctex_diff_lut_offset, proctex.diff_lut_dirty);
+
+    // The unused bits of the dirty mask are only set to force a full upload
+    if (!proctex.noise_lut_dirty && !proctex.color_map_dirty && !proctex.alpha_map_dirty &&
+        !proctex.lut_dirty && !proctex.diff_lut_dirty) {
+        proctex.table_dirty = 0;
+    }
+}
 
 /**
  * This is a helper function to resolve an issue when interpolating opposite quaternions. See below
@@ -260,6 +325,17 @@ void RasterizerAccelerated::SyncDrawUniforms() {
         fs_data_dirty = true;
     }
 
+    // The fragment shader config is only rebuilt once one of its regs was written
+    if (dirty.CheckFSConfig()) {
+        fs_config_dirty = true;
+    }
+
+    // The blend, depth, stencil and cull state of the backends is only rebuilt once one of its
+    // regs was written
+    if (dirty.CheckFixedState()) {
+        fixed_state_dirty = true;
+    }
+
     // We have synched all uniforms, reset dirty state.
     pica.dirty_regs.Reset();
 }
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "common/vector_math.h"
+#include "video_core/geometry_cache.h"
+#include "video_core/lut_slot_cache.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/shader/generator/pica_fs_config.h"
 #include "video_core/shader/generator/shader_uniforms.h"
@@ -27,10 +29,32 @@ public:
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
 
+    bool ShouldDrawTriangles() const override {
+        return vertex_batch.size() >= MAX_BATCH_VERTICES;
+    }
+
+    void SetFrameSkip(bool skip) override {
+        skip_frame = skip;
+    }
+
 protected:
+    /// Number of vertices after which merged draws are submitted to the host
+    static constexpr std::size_t MAX_BATCH_VERTICES = 3 * 4096;
+
     /// Sync vertex and framgent uniforms from PICA registers
     void SyncDrawUniforms();
 
+    /// Converts the PICA vertex shader uniforms modified since the last call into vs_pica_data
+    void SyncVSPicaUniforms();
+
+    /// Points the dirty lighting and fog LUTs whose contents are still in the texel buffer at their
+    /// earlier upload and clears their dirty flags
+    void RebindCachedLUTsLF();
+
+    /// Points the dirty proctex LUTs whose contents are still in the texel buffer at their earlier
+    /// upload and clears their dirty flags
+    void RebindCachedLUTs();
+
 protected:
     /// Structure that the hardware rendered vertices are composed of
     struct HardwareVertex {
@@ -64,8 +88,15 @@ protected:
     Pica::Shader::UserConfig user_config{};
     Pica::Shader::Generator::VSUniformData vs_data{};
     Pica::Shader::Generator::FSUniformData fs_data{};
+    Pica::Shader::Generator::VSPicaUniformData vs_pica_data{};
     bool vs_data_dirty = true;
     bool fs_data_dirty = true;
+    bool fs_config_dirty = true;   ///< Set when a reg of the fragment shader config was written
+    bool fixed_state_dirty = true; ///< Set when a reg of the fixed function state was written
+    bool skip_frame = false;       ///< Set while the draws of the current frame may be skipped
+    LutSlotCache lut_lf_slots;     ///< Slots of the lighting and fog LUTs in texture_lf_buffer
+    LutSlotCache lut_slots;        ///< Slots of the proctex LUTs in texture_buffer
+    GeometryCache geometry_cache;  ///< Uploads of vertex and index data in the geometry buffer
 };
 
 } // namespace VideoCore
@@ -0,0 +1,94 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/rasterizer_cache/page_tracker.h"
+
+namespace VideoCore {
+
+PageTracker::PageTracker()
+    : counts(NUM_PAGES), bitmap(NUM_PAGES / 64), generations(NUM_PAGES) {}
+
+PageTracker::~PageTracker() = default;
+
+bool PageTracker::IsRegionCached(PAddr addr, u32 size) const {
+    if (size == 0) {
+        return false;
+    }
+
+    const u32 page_start = addr >> PAGE_BITS;
+    const u32 page_end = ((addr + size - 1) >> PAGE_BITS) + 1;
+    for (const Region& region : REGIONS) {
+        if (page_start < region.first_page || page_end > region.first_page + region.num_pages) {
+            continue;
+        }
+        const u32 index = region.index + page_start - region.first_page;
+        const u32 end = index + page_end - page_start;
+        return FindNext(index, end, true) != end;
+    }
+
+    return true;
+}
+
+void PageTracker::Clear() {
+    std::fill(counts.begin(), counts.end(), u16{0});
+    std::fill(bitmap.begin(), bitmap.end(), u64{0});
+}
+
+void PageTracker::BumpGeneration(PAddr addr, u32 size) {
+    if (size == 0) {
+        return;
+    }
+
+    const u32 page_start = addr >> PAGE_BITS;
+    const u32 page_end = ((addr + size - 1) >> PAGE_BITS) + 1;
+    for (const Region& region : REGIONS) {
+        const u32 first = std::max(page_start, region.first_page);
+        const u32 last = std::min(page_end, region.first_page + region.num_pages);
+        for (u32 page = first; page < last; page++) {
+            generations[region.index + page - region.first_page]++;
+        }
+    }
+}
+
+std::optional<u64> PageTracker::GetGeneration(PAddr addr, u32 size) const {
+    if (size == 0) {
+        return std::nullopt;
+    }
+
+    const u32 page_start = addr >> PAGE_BITS;
+    const u32 page_end = ((addr + size - 1) >> PAGE_BITS) + 1;
+    for (const Region& region : REGIONS) {
+        if (page_start < region.first_page || page_end > region.first_page + region.num_pages) {
+            continue;
+        }
+        const u32 index = region.index + page_start - region.first_page;
+        const u32 end = index + page_end - page_start;
+        if (FindNext(index, end, false) != end) {
+            return std::nullopt;
+        }
+        // Generations only grow, so the sum changes whenever any of them does.
+        u64 generation = 0;
+        for (u32 i = index; i < end; i++) {
+            generation += generations[i];
+        }
+        return generation;
+    }
+
+    return std::nullopt;
+}
+
+u32 PageTracker::FindNext(u32 index, u32 end, bool value) const {
+    const u64 invert = value ? 0 : ~u64{0};
+    while (index < end) {
+        const u32 bit = index % 64;
+        const u64 word = (bitmap[index / 64] ^ invert) >> bit;
+        if (word != 0) {
+            return std::min(index + static_cast<u32>(std::countr_zero(word)), end);
+        }
+        index += 64 - bit;
+    }
+    return end;
+}
+
+} // namespace VideoCore
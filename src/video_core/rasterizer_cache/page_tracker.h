@@ -0,0 +1,146 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <optional>
+#include <vector>
+#include "common/assert.h"
+#include "core/memory.h"
+
+namespace VideoCore {
+
+/**
+ * Tracks how many cached surfaces overlap each guest page of VRAM and FCRAM.
+ * Counts live in a flat array indexed by page and a bitmap with one bit per page mirrors
+ * which counts are non-zero, so range queries only test one word per 64 pages.
+ * Each page also has a write generation, so callers can tell when the contents of a range may
+ * have changed since they last looked at it.
+ */
+class PageTracker {
+    static constexpr u32 PAGE_BITS = Memory::CITRA_PAGE_BITS;
+
+    struct Region {
+        u32 first_page; ///< First guest page covered by the region
+        u32 num_pages;  ///< Number of pages in the region
+        u32 index;      ///< Index of first_page in the flat arrays
+    };
+
+    static constexpr std::array<Region, 3> REGIONS = {{
+        {Memory::VRAM_PADDR >> PAGE_BITS, Memory::VRAM_SIZE >> PAGE_BITS, 0},
+        {Memory::N3DS_EXTRA_RAM_PADDR >> PAGE_BITS, Memory::N3DS_EXTRA_RAM_SIZE >> PAGE_BITS,
+         Memory::VRAM_SIZE >> PAGE_BITS},
+        {Memory::FCRAM_PADDR >> PAGE_BITS, Memory::FCRAM_N3DS_SIZE >> PAGE_BITS,
+         (Memory::VRAM_SIZE + Memory::N3DS_EXTRA_RAM_SIZE) >> PAGE_BITS},
+    }};
+
+    static constexpr u32 NUM_PAGES =
+        (Memory::VRAM_SIZE + Memory::N3DS_EXTRA_RAM_SIZE + Memory::FCRAM_N3DS_SIZE) >> PAGE_BITS;
+    static_assert(NUM_PAGES % 64 == 0);
+
+public:
+    PageTracker();
+    ~PageTracker();
+
+    /// Returns true if any page in [addr, addr + size) is overlapped by a cached surface.
+    /// Ranges that extend outside of the tracked regions are conservatively reported as cached.
+    [[nodiscard]] bool IsRegionCached(PAddr addr, u32 size) const;
+
+    /// Resets all page counts to zero
+    void Clear();
+
+    /// Marks the contents of all pages in [addr, addr + size) as changed.
+    void BumpGeneration(PAddr addr, u32 size);
+
+    /**
+     * Returns a value that changes whenever any page in [addr, addr + size) is written.
+     * Writes to pages that are not cached are not reported, so std::nullopt is returned
+     * when any page of the range is not cached or the range is not tracked.
+     */
+    [[nodiscard]] std::optional<u64> GetGeneration(PAddr addr, u32 size) const;
+
+    /**
+     * Adds delta to the count of every page in [addr, addr + size).
+     * @param func Invoked with (addr, size) for each run of pages whose count either became
+     * non-zero (delta > 0) or dropped to zero (delta < 0).
+     */
+    template <typename Func>
+    void Update(PAddr addr, u32 size, int delta, Func&& func) {
+        const u32 page_start = addr >> PAGE_BITS;
+        const u32 page_end = ((addr + size - 1) >> PAGE_BITS) + 1;
+        for (const Region& region : REGIONS) {
+            const u32 first = std::max(page_start, region.first_page);
+            const u32 last = std::min(page_end, region.first_page + region.num_pages);
+            if (first >= last) {
+                continue;
+            }
+
+            u32 run_start = 0;
+            u32 run_length = 0;
+            for (u32 page = first; page < last; page++) {
+                const u32 index = region.index + page - region.first_page;
+                const int old_count = counts[index];
+                const int new_count = old_count + delta;
+                ASSERT(new_count >= 0 && new_count <= 0xFFFF);
+                counts[index] = static_cast<u16>(new_count);
+
+                if ((old_count == 0) == (new_count == 0)) {
+                    if (run_length != 0) {
+                        func(run_start << PAGE_BITS, run_length << PAGE_BITS);
+                        run_length = 0;
+                    }
+                    continue;
+                }
+
+                const u64 bit = u64{1} << (index % 64);
+                if (new_count != 0) {
+                    // The page may have been written while it was not cached.
+                    bitmap[index / 64] |= bit;
+                    generations[index]++;
+                } else {
+                    bitmap[index / 64] &= ~bit;
+                }
+                if (run_length++ == 0) {
+                    run_start = page;
+                }
+            }
+            if (run_length != 0) {
+                func(run_start << PAGE_BITS, run_length << PAGE_BITS);
+            }
+        }
+    }
+
+    /// Invokes func with (addr, size) for each run of pages overlapped by a cached surface.
+    template <typename Func>
+    void ForEachCachedRegion(Func&& func) const {
+        for (const Region& region : REGIONS) {
+            const u32 end = region.index + region.num_pages;
+            u32 index = region.index;
+            while (index < end) {
+                index = FindNext(index, end, true);
+                if (index == end) {
+                    break;
+                }
+                const u32 run_end = FindNext(index, end, false);
+                func((region.first_page + index - region.index) << PAGE_BITS,
+                     (run_end - index) << PAGE_BITS);
+                index = run_end;
+            }
+        }
+    }
+
+private:
+    /// Returns the first index in [index, end) whose bit equals value, or end if there is none
+    [[nodiscard]] u32 FindNext(u32 index, u32 end, bool value) const;
+
+private:
+    std::vector<u16> counts;
+    std::vector<u64> bitmap;
+    std::vector<u32> generations;
+};
+
+} // namespace VideoCore
@@ -14,5 +14,11 @@ MICROPROFILE_DEFINE(RasterizerCache_DownloadSurface, "RasterizerCache", "Downloa
                     MP_RGB(128, 192, 64));
 MICROPROFILE_DEFINE(RasterizerCache_Invalidation, "RasterizerCache", "Invalidation",
                     MP_RGB(128, 64, 192));
+MICROPROFILE_DEFINE(RasterizerCache_PageTracking, "RasterizerCache", "PageTracking",
+                    MP_RGB(64, 128, 192));
+MICROPROFILE_DEFINE(RasterizerCache_MemoryBudget, "RasterizerCache", "MemoryBudget",
+                    MP_RGB(192, 128, 64));
+MICROPROFILE_DEFINE(RasterizerCache_ComputeHash, "RasterizerCache", "ComputeHash",
+                    MP_RGB(128, 192, 64));
 
 } // namespace VideoCore
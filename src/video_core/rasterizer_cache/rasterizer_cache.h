@@ -8,12 +8,15 @@
 #include <boost/container/small_vector.hpp>
 #include <boost/range/iterator_range.hpp>
 #include "common/alignment.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
+#include "common/tracing.h"
 #include "common/aligned_allocator.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "video_core/custom_textures/custom_tex_manager.h"
 #include "video_core/pica/regs_external.h"
 #include "video_core/pica/regs_internal.h"
@@ -28,22 +31,61 @@ MICROPROFILE_DECLARE(RasterizerCache_CopySurface);
 MICROPROFILE_DECLARE(RasterizerCache_UploadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_DownloadSurface);
 MICROPROFILE_DECLARE(RasterizerCache_Invalidation);
+MICROPROFILE_DECLARE(RasterizerCache_PageTracking);
+MICROPROFILE_DECLARE(RasterizerCache_MemoryBudget);
+MICROPROFILE_DECLARE(RasterizerCache_ComputeHash);
 
 constexpr auto RangeFromInterval(const auto& map, const auto& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
 }
 
+/// Size of the aligned blocks downloaded around small CPU accesses to dirty surfaces.
+constexpr u32 CPU_FLUSH_BLOCK_SIZE = 0x10000;
+
+/// Largest difference of a channel between a mip level and its box filtered base level that is
+/// still caused by the precision of the format, or 0 when the format is not compared.
+constexpr u32 MipmapTolerance(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB8:
+    case PixelFormat::IA8:
+    case PixelFormat::RG8:
+    case PixelFormat::I8:
+    case PixelFormat::A8:
+        return 2;
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+        return 9;
+    case PixelFormat::RGBA4:
+    case PixelFormat::IA4:
+    case PixelFormat::I4:
+    case PixelFormat::A4:
+        return 17;
+    default:
+        return 0;
+    }
+}
+
 template <class T>
 RasterizerCache<T>::RasterizerCache(Memory::MemorySystem& memory_,
                                     CustomTexManager& custom_tex_manager_, Runtime& runtime_,
-                                    Pica::RegsInternal& regs_, RendererBase& renderer_)
+                                    Pica::RegsInternal& regs_, RendererBase& renderer_,
+                                    const Settings::RuntimeSettings& runtime_settings_)
     : memory{memory_}, custom_tex_manager{custom_tex_manager_}, runtime{runtime_}, regs{regs_},
-      renderer{renderer_}, resolution_scale_factor{renderer.GetResolutionScaleFactor()},
-      filter{Settings::values.texture_filter.GetValue()},
+      renderer{renderer_}, runtime_settings{runtime_settings_},
+      resolution_scale_factor{renderer.GetResolutionScaleFactor()},
+      texture_memory_budget{runtime_settings.texture_memory_budget},
+      filter{runtime_settings.texture_filter},
       dump_textures{Settings::values.dump_textures.GetValue()},
-      use_custom_textures{Settings::values.custom_textures.GetValue()} {
+      use_custom_textures{runtime_settings.custom_textures},
+      async_texture_upload{runtime_settings.async_texture_upload},
+      gpu_texture_decode{runtime_settings.gpu_texture_decode},
+      accurate_mipmaps{Settings::values.accurate_mipmaps.GetValue()} {
     using TextureConfig = Pica::TexturingRegs::TextureConfig;
 
+    custom_tex_manager.SetTranscodeSupport(
+        runtime.IsCustomFormatSupported(CustomPixelFormat::ETC2));
+
     // Create null handles for all cached resources
     void(slot_surfaces.insert(runtime, SurfaceParams{
                                            .width = 1,
@@ -90,7 +132,12 @@ void RasterizerCache<T>::TickFrame() {
     custom_tex_manager.TickFrame();
     RunGarbageCollector();
 
-    const auto new_filter = Settings::values.texture_filter.GetValue();
+    async_texture_upload = runtime_settings.async_texture_upload;
+    gpu_texture_decode = runtime_settings.gpu_texture_decode;
+    texture_memory_budget = runtime_settings.texture_memory_budget;
+    RunMemoryBudget();
+
+    const auto new_filter = runtime_settings.texture_filter;
     if (filter != new_filter) [[unlikely]] {
         filter = new_filter;
         UnregisterAll();
@@ -98,12 +145,11 @@ void RasterizerCache<T>::TickFrame() {
 
     const u32 scale_factor = renderer.GetResolutionScaleFactor();
     const bool resolution_scale_changed = resolution_scale_factor != scale_factor;
-    const bool use_custom_texture_changed =
-        Settings::values.custom_textures.GetValue() != use_custom_textures;
+    const bool use_custom_texture_changed = runtime_settings.custom_textures != use_custom_textures;
 
     if (resolution_scale_changed || use_custom_texture_changed) {
         resolution_scale_factor = scale_factor;
-        use_custom_textures = Settings::values.custom_textures.GetValue();
+        use_custom_textures = runtime_settings.custom_textures;
         if (use_custom_textures) {
             custom_tex_manager.FindCustomTextures();
         }
@@ -126,6 +172,46 @@ void RasterizerCache<T>::RunGarbageCollector() {
     }
 }
 
+template <class T>
+void RasterizerCache<T>::RunMemoryBudget() {
+    MICROPROFILE_SCOPE(RasterizerCache_MemoryBudget);
+
+    texture_memory = 0;
+    lru_surfaces.clear();
+    slot_surfaces.ForEach([&](SurfaceId surface_id, const Surface& surface) {
+        texture_memory += surface.MemoryUsage();
+        // Never evict surfaces that were used by the frame that was just presented.
+        if (True(surface.flags & SurfaceFlagBits::Registered) &&
+            surface.type != SurfaceType::Fill && surface.last_use_tick + 1 < frame_tick) {
+            lru_surfaces.emplace_back(surface.last_use_tick, surface_id);
+        }
+    });
+
+    // Sentenced surfaces are already going to be destroyed by the garbage collector.
+    u64 live_memory = texture_memory;
+    for (const auto& [surface_id, tick] : sentenced) {
+        live_memory -= slot_surfaces[surface_id].MemoryUsage();
+    }
+    if (texture_memory_budget == 0 || live_memory <= texture_memory_budget) {
+        return;
+    }
+
+    std::sort(lru_surfaces.begin(), lru_surfaces.end());
+    u64 evicted_memory = 0;
+    for (const auto& [tick, surface_id] : lru_surfaces) {
+        if (live_memory - evicted_memory <= texture_memory_budget) {
+            break;
+        }
+        const Surface& surface = slot_surfaces[surface_id];
+        evicted_memory += surface.MemoryUsage();
+        FlushRegion(surface.addr, surface.size, surface_id);
+        UnregisterSurface(surface_id);
+    }
+
+    LOG_DEBUG(HW_GPU, "Evicted {} KiB of textures to fit the {} MiB budget", evicted_memory >> 10,
+              texture_memory_budget >> 20);
+}
+
 template <class T>
 void RasterizerCache<T>::RemoveFramebuffers(SurfaceId surface_id) {
     for (auto it = framebuffers.begin(); it != framebuffers.end();) {
@@ -162,6 +248,23 @@ void RasterizerCache<T>::RemoveTextureCubeFace(SurfaceId surface_id) {
     }
 }
 
+template <class T>
+bool RasterizerCache<T>::CanSkipDraw(const Framebuffer& framebuffer) const {
+    const auto is_sampled = [this](SurfaceId surface_id) {
+        return surface_id && True(slot_surfaces[surface_id].flags & SurfaceFlagBits::Sampled);
+    };
+    return !framebuffer.shadow_rendering && !is_sampled(framebuffer.color_id) &&
+           !is_sampled(framebuffer.depth_id);
+}
+
+template <class T>
+void RasterizerCache<T>::PropagateSampled(Surface& src_surface, const Surface& dst_surface) {
+    // A source only transferred to the screen stays skippable, skipped frames show the last image
+    if (True(dst_surface.flags & SurfaceFlagBits::Sampled)) {
+        src_surface.flags |= SurfaceFlagBits::Sampled;
+    }
+}
+
 template <class T>
 bool RasterizerCache<T>::AccelerateTextureCopy(const Pica::DisplayTransferConfig& config) {
     const DebugScope scope{runtime, Common::Vec4f{0.f, 0.f, 1.f, 1.f},
@@ -261,6 +364,7 @@ bool RasterizerCache<T>::AccelerateTextureCopy(const Pica::DisplayTransferConfig
         .extent = {src_rect.GetWidth(), src_rect.GetHeight()},
     };
     runtime.CopyTextures(src_surface, dst_surface, texture_copy);
+    PropagateSampled(src_surface, dst_surface);
 
     InvalidateRegion(dst_params.addr, dst_params.size, dst_surface_id);
     return true;
@@ -331,6 +435,7 @@ bool RasterizerCache<T>::AccelerateDisplayTransfer(const Pica::DisplayTransferCo
         .dst_rect = dst_rect,
     };
     runtime.BlitTextures(src_surface, dst_surface, texture_blit);
+    PropagateSampled(src_surface, dst_surface);
 
     InvalidateRegion(dst_params.addr, dst_params.size, dst_surface_id);
     return true;
@@ -380,8 +485,8 @@ typename T::Sampler& RasterizerCache<T>::GetSampler(
     const Pica::TexturingRegs::TextureConfig& config) {
     using TextureFilter = Pica::TexturingRegs::TextureConfig::TextureFilter;
 
-    const auto get_filter = [](TextureFilter filter) {
-        switch (Settings::values.texture_sampling.GetValue()) {
+    const auto get_filter = [this](TextureFilter filter) {
+        switch (runtime_settings.texture_sampling) {
         case Settings::TextureSampling::GameControlled:
             return filter;
         case Settings::TextureSampling::NearestNeighbor:
@@ -417,6 +522,7 @@ template <class T>
 void RasterizerCache<T>::CopySurface(Surface& src_surface, Surface& dst_surface,
                                      SurfaceInterval copy_interval) {
     MICROPROFILE_SCOPE(RasterizerCache_CopySurface);
+    src_surface.flags |= SurfaceFlagBits::Sampled;
     const PAddr copy_addr = copy_interval.lower();
     const SurfaceParams subrect_params = dst_surface.FromInterval(copy_interval);
     ASSERT(subrect_params.GetInterval() == copy_interval);
@@ -573,6 +679,7 @@ SurfaceId RasterizerCache<T>::GetTextureSurface(const Pica::Texture::TextureInfo
         }
         const auto [src_surface_id, rect] = GetSurfaceSubRect(params, ScaleMatch::Ignore, true);
         Surface& src_surface = slot_surfaces[src_surface_id];
+        src_surface.flags |= SurfaceFlagBits::Sampled;
 
         params.res_scale = src_surface.res_scale;
         SurfaceId tmp_surface_id = CreateSurface(params);
@@ -595,7 +702,11 @@ SurfaceId RasterizerCache<T>::GetTextureSurface(const Pica::Texture::TextureInfo
     }
 
     SurfaceId surface_id = GetSurface(params, ScaleMatch::Ignore, true);
-    return surface_id ? surface_id : NULL_SURFACE_ID;
+    if (!surface_id) {
+        return NULL_SURFACE_ID;
+    }
+    slot_surfaces[surface_id].flags |= SurfaceFlagBits::Sampled;
+    return surface_id;
 }
 
 template <class T>
@@ -609,14 +720,23 @@ typename T::Surface& RasterizerCache<T>::GetTextureCube(const TextureCubeConfig&
 
     const std::array addresses = {config.px, config.nx, config.py, config.ny, config.pz, config.nz};
 
-    if (new_surface) {
-        Pica::Texture::TextureInfo info = {
-            .width = config.width,
-            .height = config.width,
-            .format = config.format,
-        };
-        info.SetDefaultStride();
+    Pica::Texture::TextureInfo info = {
+        .width = config.width,
+        .height = config.width,
+        .format = config.format,
+    };
+    info.SetDefaultStride();
+    const auto find_face = [&](u32 index) {
+        info.physical_address = addresses[index];
+        const SurfaceId face_id = GetTextureSurface(info, config.levels - 1);
+        Surface& surface = slot_surfaces[face_id];
+        ASSERT_MSG(surface.levels >= config.levels,
+                   "Texture cube face levels are not enough to validate the levels requested");
+        surface.flags |= SurfaceFlagBits::Tracked;
+        return face_id;
+    };
 
+    if (new_surface) {
         u32 res_scale = 1;
         for (u32 i = 0; i < addresses.size(); i++) {
             if (!addresses[i]) {
@@ -625,13 +745,7 @@ typename T::Surface& RasterizerCache<T>::GetTextureCube(const TextureCubeConfig&
 
             SurfaceId& face_id = cube.face_ids[i];
             if (!face_id) {
-                info.physical_address = addresses[i];
-                face_id = GetTextureSurface(info, config.levels - 1);
-                Surface& surface = slot_surfaces[face_id];
-                ASSERT_MSG(
-                    surface.levels >= config.levels,
-                    "Texture cube face levels are not enough to validate the levels requested");
-                surface.flags |= SurfaceFlagBits::Tracked;
+                face_id = find_face(i);
             }
             Surface& surface = slot_surfaces[face_id];
             res_scale = std::max(surface.res_scale, res_scale);
@@ -652,12 +766,22 @@ typename T::Surface& RasterizerCache<T>::GetTextureCube(const TextureCubeConfig&
         cube.surface_id = CreateSurface(cube_params);
     }
 
-    Surface& cube_surface = slot_surfaces[cube.surface_id];
+    // Only the faces modified since they were last copied are copied again. Faces are validated
+    // first, so that a face written by the CPU is copied once its new contents were uploaded
+    // instead of once when it was invalidated and again when it was validated.
     for (u32 i = 0; i < addresses.size(); i++) {
-        const SurfaceId& face_id = cube.face_ids[i];
-        if (!addresses[i] || !face_id) {
+        SurfaceId& face_id = cube.face_ids[i];
+        if (!addresses[i]) {
             continue;
         }
+        if (!face_id) {
+            // The face surface was removed from the cache since the cube was assembled
+            face_id = find_face(i);
+            cube.ticks[i] = 0;
+        } else if (!slot_surfaces[face_id].invalid_regions.empty()) {
+            const Surface& surface = slot_surfaces[face_id];
+            ValidateSurface(face_id, surface.addr, surface.size);
+        }
         Surface& surface = slot_surfaces[face_id];
         if (cube.ticks[i] == surface.modification_tick) {
             continue;
@@ -676,7 +800,7 @@ typename T::Surface& RasterizerCache<T>::GetTextureCube(const TextureCubeConfig&
                 .extent = {width_lod, width_lod},
             });
         }
-        runtime.CopyTextures(surface, cube_surface, upload_copies);
+        runtime.CopyTextures(surface, slot_surfaces[cube.surface_id], upload_copies);
     }
 
     return slot_surfaces[cube.surface_id];
@@ -943,6 +1067,7 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
 
     Surface& surface = slot_surfaces[surface_id];
     const SurfaceInterval validate_interval(addr, addr + size);
+    surface.last_use_tick = frame_tick;
 
     if (surface.type == SurfaceType::Fill) {
         ASSERT_MSG(surface.IsRegionValid(validate_interval),
@@ -960,6 +1085,7 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
         surface.MarkValid(interval);
         validate_regions.erase(interval);
     };
+    bool generate_mipmaps = false;
 
     const DebugScope scope{runtime, Common::Vec4f{0.f, 1.f, 0.f, 1.f},
                            "RasterizerCache::ValidateSurface (from {:#x} to {:#x})", addr,
@@ -996,39 +1122,157 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
             continue;
         }
 
+        // Mip levels that games filter from the base level are generated instead of decoded
+        if (level != 0 && CanGenerateMipmaps(surface)) {
+            Common::Tracing::IncrementCounter(Common::Tracing::Counter::GeneratedMipmap);
+            generate_mipmaps = true;
+            notify_validated(params.GetInterval());
+            continue;
+        }
+
         FlushRegion(params.addr, params.size);
         if (!use_custom_textures || !UploadCustomSurface(surface_id, interval)) {
             UploadSurface(surface, interval);
         }
         notify_validated(params.GetInterval());
+        generate_mipmaps |= level == 0 && CanGenerateMipmaps(surface);
     }
 
     // Filtered mipmaps often look really bad. We can achieve better quality by
     // generating them from the base level.
-    if (surface.res_scale != 1 && level != 0) {
+    if ((surface.res_scale != 1 && level != 0) || generate_mipmaps) {
         runtime.GenerateMipmaps(surface);
     }
 }
 
+template <class T>
+bool RasterizerCache<T>::CanGenerateMipmaps(const Surface& surface) {
+    if (accurate_mipmaps || surface.levels < 2 ||
+        True(surface.flags & (SurfaceFlagBits::Custom | SurfaceFlagBits::RenderTarget))) {
+        return false;
+    }
+
+    const u64 key = Common::HashCombine(
+        static_cast<u64>(surface.addr) << 32 | surface.width << 16 | surface.height,
+        static_cast<u64>(surface.pixel_format) << 8 | surface.levels);
+    const auto it = mipmap_policies.find(key);
+    if (it != mipmap_policies.end()) {
+        return it->second == MipmapPolicy::Generate;
+    }
+
+    const std::optional<bool> box_filtered = HasBoxFilteredMipmaps(surface);
+    if (!box_filtered) {
+        return false;
+    }
+    if (mipmap_policies.size() >= MAX_MIPMAP_POLICIES) {
+        mipmap_policies.clear();
+    }
+    LOG_DEBUG(HW_GPU, "Mip levels of {} are {}", surface.DebugName(false),
+              *box_filtered ? "generated" : "decoded");
+    mipmap_policies.emplace(key, *box_filtered ? MipmapPolicy::Generate : MipmapPolicy::Decode);
+    return *box_filtered;
+}
+
+template <class T>
+std::optional<bool> RasterizerCache<T>::HasBoxFilteredMipmaps(const Surface& surface) {
+    const u32 tolerance = MipmapTolerance(surface.pixel_format);
+    const SurfaceParams base = surface.FromInterval(surface.LevelInterval(0));
+    const SurfaceParams mip = surface.FromInterval(surface.LevelInterval(1));
+    if (tolerance == 0 || !surface.is_tiled || mip.width < 8 || mip.height < 8) {
+        return false;
+    }
+
+    // The guest memory is only compared while it holds what the game wrote
+    const SurfaceInterval sample_interval{base.addr, mip.end};
+    if (boost::icl::intersects(dirty_regions, sample_interval)) {
+        return std::nullopt;
+    }
+    MemoryRef base_ptr = memory.GetPhysicalRef(base.addr);
+    MemoryRef mip_ptr = memory.GetPhysicalRef(mip.addr);
+    if (!base_ptr || !mip_ptr || base_ptr.GetSize() < base.size || mip_ptr.GetSize() < mip.size) {
+        return false;
+    }
+
+    // Each sampled tile of the first mip level is decoded with the four tiles of the base level
+    // it is filtered from, which together are the tiled layout of a 16x16 texture.
+    SurfaceParams sample_base = {
+        .width = 16,
+        .height = 16,
+        .stride = 16,
+        .is_tiled = true,
+        .pixel_format = surface.pixel_format,
+        .type = surface.type,
+    };
+    sample_base.UpdateParams();
+    SurfaceParams sample_mip = sample_base;
+    sample_mip.width = sample_mip.height = sample_mip.stride = 8;
+    sample_mip.UpdateParams();
+
+    const u32 tile_size = base.BytesInPixels(64);
+    const u32 base_tiles_x = base.width / 8;
+    const u32 mip_tiles_x = mip.width / 8;
+    const u32 mip_tiles_y = mip.height / 8;
+    const bool convert = surface.type == SurfaceType::Color;
+
+    std::array<u8, 4 * 64 * 4> base_tiles;
+    std::array<u8, 64 * 4> mip_tile;
+    std::array<u8, 16 * 16 * 4> base_texels;
+    std::array<u8, 8 * 8 * 4> mip_texels;
+
+    const std::array<std::pair<u32, u32>, 3> samples = {{
+        {0, 0},
+        {mip_tiles_x / 2, mip_tiles_y / 2},
+        {mip_tiles_x - 1, mip_tiles_y - 1},
+    }};
+    for (const auto& [tile_x, tile_y] : samples) {
+        for (u32 i = 0; i < 4; i++) {
+            const u32 base_tile = (2 * tile_y + i / 2) * base_tiles_x + 2 * tile_x + i % 2;
+            const u8* const source = base_ptr.GetPtr() + base_tile * tile_size;
+            std::memcpy(base_tiles.data() + i * tile_size, source, tile_size);
+        }
+        const u32 mip_tile_index = tile_y * mip_tiles_x + tile_x;
+        std::memcpy(mip_tile.data(), mip_ptr.GetPtr() + mip_tile_index * tile_size, tile_size);
+
+        DecodeTexture(sample_base, sample_base.addr, sample_base.end, base_tiles, base_texels,
+                      convert);
+        DecodeTexture(sample_mip, sample_mip.addr, sample_mip.end, mip_tile, mip_texels,
+                      convert);
+
+        for (u32 y = 0; y < 8; y++) {
+            for (u32 x = 0; x < 8; x++) {
+                for (u32 c = 0; c < 4; c++) {
+                    const auto texel = [&](u32 tx, u32 ty) {
+                        return u32{base_texels[(ty * 16 + tx) * 4 + c]};
+                    };
+                    const u32 sum = texel(2 * x, 2 * y) + texel(2 * x + 1, 2 * y) +
+                                    texel(2 * x, 2 * y + 1) + texel(2 * x + 1, 2 * y + 1);
+                    const u32 filtered = (sum + 2) / 4;
+                    const u32 actual = mip_texels[(y * 8 + x) * 4 + c];
+                    if (std::max(filtered, actual) - std::min(filtered, actual) > tolerance) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
 template <class T>
 void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interval) {
     MICROPROFILE_SCOPE(RasterizerCache_UploadSurface);
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::TextureUpload);
+    Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::TextureUpload};
 
     const SurfaceParams load_info = surface.FromInterval(interval);
     ASSERT(load_info.addr >= surface.addr && load_info.end <= surface.end);
 
-    const auto staging = runtime.FindStaging(
-        load_info.width * load_info.height * surface.GetInternalBytesPerPixel(), true);
-
     MemoryRef source_ptr = memory.GetPhysicalRef(load_info.addr);
     if (!source_ptr) [[unlikely]] {
         return;
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
-                  runtime.NeedsConversion(surface.pixel_format));
-
     const bool should_dump = False(surface.flags & SurfaceFlagBits::Custom) &&
                              False(surface.flags & SurfaceFlagBits::RenderTarget);
     if (dump_textures && should_dump) {
@@ -1037,17 +1281,77 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
         custom_tex_manager.DumpTexture(load_info, level, upload_data, hash);
     }
 
-    const BufferTextureCopy upload = {
-        .buffer_offset = staging.offset,
-        .buffer_size = staging.size,
+    BufferTextureCopy upload = {
+        .buffer_offset = 0,
+        .buffer_size = 0,
         .texture_rect = surface.GetSubRect(load_info),
         .texture_level = surface.LevelOf(load_info.addr),
     };
+
+    // Filtered uploads of whole textures are keyed by their contents, so that textures uploaded
+    // many times with the same data, such as fonts and UI elements, are only filtered once.
+    if (filter != Settings::TextureFilter::NoFilter && surface.res_scale != 1 &&
+        upload.texture_level == 0 && upload.texture_rect == surface.GetRect()) {
+        upload.content_hash = ComputeHash(load_info, upload_data);
+    }
+
+    // Let the runtime detile the raw guest data on the GPU when it is able to.
+    if (gpu_texture_decode && load_info.is_tiled && surface.UploadTiled(upload, upload_data)) {
+        return;
+    }
+
+    const auto staging = runtime.FindStaging(
+        load_info.width * load_info.height * surface.GetInternalBytesPerPixel(), true);
+    const bool convert = runtime.NeedsConversion(surface.pixel_format);
+    if (async_texture_upload) {
+        DecodeTextureParallel(load_info, upload_data, staging.mapped, convert);
+    } else {
+        DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
+                      convert);
+    }
+
+    upload.buffer_offset = staging.offset;
+    upload.buffer_size = staging.size;
     surface.Upload(upload, staging);
 }
 
 template <class T>
 u64 RasterizerCache<T>::ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data) {
+    const TextureHashKey key = {
+        .addr = load_info.addr,
+        .end = load_info.end,
+        .width = load_info.width,
+        .height = load_info.height,
+        .stride = load_info.stride,
+        .pixel_format = static_cast<u32>(load_info.pixel_format),
+        .is_tiled = load_info.is_tiled,
+        .use_new_hash = custom_tex_manager.UseNewHash(),
+    };
+    const u64 key_hash = Common::ComputeStructHash64(key);
+    const std::optional<u64> generation =
+        cached_pages.GetGeneration(load_info.addr, load_info.end - load_info.addr);
+    if (!generation) {
+        return HashTextureData(load_info, upload_data);
+    }
+
+    const auto it = texture_hashes.find(key_hash);
+    if (it != texture_hashes.end() && it->second.key == key &&
+        it->second.generation == *generation) {
+        return it->second.hash;
+    }
+
+    if (texture_hashes.size() >= MAX_TEXTURE_HASHES) {
+        texture_hashes.clear();
+    }
+    const u64 hash = HashTextureData(load_info, upload_data);
+    texture_hashes.insert_or_assign(key_hash, TextureHash{key, *generation, hash});
+    return hash;
+}
+
+template <class T>
+u64 RasterizerCache<T>::HashTextureData(const SurfaceParams& load_info,
+                                        std::span<u8> upload_data) {
+    MICROPROFILE_SCOPE(RasterizerCache_ComputeHash);
     if (!custom_tex_manager.UseNewHash()) {
         const u32 width = load_info.width;
         const u32 height = load_info.height;
@@ -1065,6 +1369,8 @@ u64 RasterizerCache<T>::ComputeHash(const SurfaceParams& load_info, std::span<u8
 template <class T>
 bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterval interval) {
     MICROPROFILE_SCOPE(RasterizerCache_UploadSurface);
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::TextureUpload);
+    Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::TextureUpload};
 
     Surface& surface = slot_surfaces[surface_id];
     const SurfaceParams load_info = surface.FromInterval(interval);
@@ -1113,31 +1419,69 @@ bool RasterizerCache<T>::UploadCustomSurface(SurfaceId surface_id, SurfaceInterv
 template <class T>
 void RasterizerCache<T>::DownloadSurface(Surface& surface, SurfaceInterval interval) {
     MICROPROFILE_SCOPE(RasterizerCache_DownloadSurface);
+    surface.flags |= SurfaceFlagBits::Sampled;
 
     const SurfaceParams flush_info = surface.FromInterval(interval);
     const u32 flush_start = boost::icl::first(interval);
     const u32 flush_end = boost::icl::last_next(interval);
     ASSERT(flush_start >= surface.addr && flush_end <= surface.end);
 
-    const auto staging = runtime.FindStaging(
-        flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel(), false);
+    MemoryRef dest_ptr = memory.GetPhysicalRef(flush_start);
+    if (!dest_ptr) [[unlikely]] {
+        return;
+    }
 
-    const BufferTextureCopy download = {
-        .buffer_offset = staging.offset,
-        .buffer_size = staging.size,
+    const auto download_dest = dest_ptr.GetWriteBytes(flush_end - flush_start);
+    BufferTextureCopy download = {
+        .buffer_offset = 0,
+        .buffer_size = 0,
         .texture_rect = surface.GetSubRect(flush_info),
         .texture_level = surface.LevelOf(flush_start),
     };
+    if (gpu_texture_decode && flush_info.is_tiled &&
+        surface.DownloadTiled(download, flush_start - flush_info.addr, download_dest)) {
+        return;
+    }
+
+    // Downloads are batched so that the host GPU copies every surface of a flush before the
+    // CPU waits on the first, as long as the staging memory of the runtime can hold them.
+    const u32 staging_size =
+        flush_info.width * flush_info.height * surface.GetInternalBytesPerPixel();
+    if (pending_download_bytes + staging_size > runtime.DownloadBatchSize()) {
+        FinishDownloads();
+    }
+
+    const auto staging = runtime.FindStaging(staging_size, false);
+    download.buffer_offset = staging.offset;
+    download.buffer_size = staging.size;
     surface.Download(download, staging);
 
-    MemoryRef dest_ptr = memory.GetPhysicalRef(flush_start);
-    if (!dest_ptr) [[unlikely]] {
-        return;
+    pending_downloads.push_back({
+        .info = flush_info,
+        .start = flush_start,
+        .end = flush_end,
+        .staging = staging,
+        .dest = download_dest,
+        .convert = runtime.NeedsConversion(surface.pixel_format),
+    });
+    pending_download_bytes += staging_size;
+    if (pending_download_bytes >= runtime.DownloadBatchSize()) {
+        FinishDownloads();
     }
+}
 
-    const auto download_dest = dest_ptr.GetWriteBytes(flush_end - flush_start);
-    EncodeTexture(flush_info, flush_start, flush_end, staging.mapped, download_dest,
-                  runtime.NeedsConversion(surface.pixel_format));
+template <class T>
+void RasterizerCache<T>::FinishDownloads() {
+    if (pending_downloads.empty()) {
+        return;
+    }
+    runtime.WaitDownloads();
+    for (const PendingDownload& pending : pending_downloads) {
+        EncodeTexture(pending.info, pending.start, pending.end, pending.staging.mapped,
+                      pending.dest, pending.convert);
+    }
+    pending_downloads.clear();
+    pending_download_bytes = 0;
 }
 
 template <class T>
@@ -1216,24 +1560,17 @@ bool RasterizerCache<T>::ValidateByReinterpretation(Surface& surface, SurfacePar
 
 template <class T>
 void RasterizerCache<T>::ClearAll(bool flush) {
-    const auto flush_interval = PageMap::interval_type::right_open(0x0, 0xFFFFFFFF);
     // Force flush all surfaces from the cache
     if (flush) {
         FlushRegion(0x0, 0xFFFFFFFF);
     }
     // Unmark all of the marked pages
-    for (auto& pair : RangeFromInterval(cached_pages, flush_interval)) {
-        const auto interval = pair.first & flush_interval;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::CITRA_PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::CITRA_PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-    }
+    cached_pages.ForEachCachedRegion([this](PAddr addr, u32 size) {
+        memory.RasterizerMarkRegionCached(addr, size, false);
+    });
 
     // Remove the whole cache without really looking at it.
-    cached_pages -= flush_interval;
+    cached_pages.Clear();
     dirty_regions.clear();
     page_table.clear();
 }
@@ -1247,15 +1584,22 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
     const SurfaceInterval flush_interval(addr, addr + size);
     SurfaceRegions flushed_intervals;
 
-    for (const auto& [region, surface_id] : RangeFromInterval(dirty_regions, flush_interval)) {
+    // Small sizes imply that this most likely comes from the cpu, flush the whole block around
+    // the access, the point is to avoid thousands of small writes every frame if the cpu decides
+    // to access that region, anything higher than 8 you're guaranteed it comes from a service.
+    // Limiting it to a block keeps a few probed pixels from downscaling and reading back the
+    // entire render target.
+    const PAddr block_start = Common::AlignDown(addr, CPU_FLUSH_BLOCK_SIZE);
+    const SurfaceInterval requested_interval =
+        size <= 8 ? SurfaceInterval(block_start, block_start + CPU_FLUSH_BLOCK_SIZE)
+                  : flush_interval;
+
+    for (const auto& [region, surface_id] : RangeFromInterval(dirty_regions, requested_interval)) {
         if (flush_surface_id && surface_id != flush_surface_id) {
             continue;
         }
 
-        // Small sizes imply that this most likely comes from the cpu, flush the entire region
-        // the point is to avoid thousands of small writes every frame if the cpu decides to
-        // access that region, anything higher than 8 you're guaranteed it comes from a service
-        const auto interval = size <= 8 ? region : region & flush_interval;
+        const auto interval = region & requested_interval;
         Surface& surface = slot_surfaces[surface_id];
         ASSERT_MSG(surface.IsRegionValid(interval), "Region owner has invalid regions");
 
@@ -1281,6 +1625,8 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, SurfaceId flush_surfa
         }
     }
 
+    FinishDownloads();
+
     // Reset dirty regions
     dirty_regions -= flushed_intervals;
 }
@@ -1297,6 +1643,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     }
 
     const SurfaceInterval invalid_interval(addr, addr + size);
+    cached_pages.BumpGeneration(addr, size);
 
     if (region_owner_id) {
         Surface& region_owner = slot_surfaces[region_owner_id];
@@ -1304,6 +1651,10 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
         ASSERT(addr >= region_owner.addr && addr + size <= region_owner.end);
         ASSERT(region_owner.width == region_owner.stride);
         region_owner.MarkValid(invalid_interval);
+    } else if (!IsRegionCached(addr, size)) {
+        // Nothing overlaps the region, so there are no surfaces to invalidate.
+        dirty_regions.erase(invalid_interval);
+        return;
     }
 
     boost::container::small_vector<SurfaceId, 4> remove_surfaces;
@@ -1355,6 +1706,7 @@ SurfaceId RasterizerCache<T>::CreateSurface(const SurfaceParams& params) {
         surface.ScaleUp(params.res_scale);
     }
     surface.MarkInvalid(surface.GetInterval());
+    surface.last_use_tick = frame_tick;
     return surface_id;
 }
 
@@ -1417,39 +1769,28 @@ void RasterizerCache<T>::UnregisterAll() {
 }
 
 template <class T>
-void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
-    const u32 num_pages =
-        ((addr + size - 1) >> Memory::CITRA_PAGE_BITS) - (addr >> Memory::CITRA_PAGE_BITS) + 1;
-    const u32 page_start = addr >> Memory::CITRA_PAGE_BITS;
-    const u32 page_end = page_start + num_pages;
-
-    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
-    // subtract after iterating
-    const auto pages_interval = PageMap::interval_type::right_open(page_start, page_end);
-    if (delta > 0) {
-        cached_pages.add({pages_interval, delta});
-    }
-
-    for (const auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
-        const auto interval = pair.first & pages_interval;
-        const int count = pair.second;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::CITRA_PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::CITRA_PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        if (delta > 0 && count == delta) {
-            memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
-        } else if (delta < 0 && count == -delta) {
-            memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-        } else {
-            ASSERT(count >= 0);
-        }
-    }
+bool RasterizerCache<T>::IsRegionCached(PAddr addr, u32 size) const {
+    MICROPROFILE_SCOPE(RasterizerCache_PageTracking);
+    return cached_pages.IsRegionCached(addr, size);
+}
 
-    if (delta < 0) {
-        cached_pages.add({pages_interval, delta});
-    }
+template <class T>
+void RasterizerCache<T>::TrackRegion(PAddr addr, u32 size, bool track) {
+    UpdatePagesCachedCount(addr, size, track ? 1 : -1);
+}
+
+template <class T>
+std::optional<u64> RasterizerCache<T>::GetRegionGeneration(PAddr addr, u32 size) const {
+    MICROPROFILE_SCOPE(RasterizerCache_PageTracking);
+    return cached_pages.GetGeneration(addr, size);
+}
+
+template <class T>
+void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
+    MICROPROFILE_SCOPE(RasterizerCache_PageTracking);
+    cached_pages.Update(addr, size, delta, [this, delta](PAddr run_addr, u32 run_size) {
+        memory.RasterizerMarkRegionCached(run_addr, run_size, delta > 0);
+    });
 }
 
 } // namespace VideoCore
@@ -14,9 +14,11 @@
 #include <tsl/robin_map.h>
 
 #include "video_core/rasterizer_cache/framebuffer_base.h"
+#include "video_core/rasterizer_cache/page_tracker.h"
 #include "video_core/rasterizer_cache/sampler_params.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/texture_cube.h"
+#include "video_core/rasterizer_cache/utils.h"
 
 namespace Memory {
 class MemorySystem;
@@ -34,6 +36,7 @@ struct TextureInfo;
 
 namespace Settings {
 enum class TextureFilter : u32;
+struct RuntimeSettings;
 }
 
 namespace VideoCore {
@@ -62,6 +65,12 @@ class RasterizerCache {
     /// Address shift for caching surfaces into a hash table
     static constexpr u64 CITRA_PAGEBITS = 18;
 
+    /// Maximum number of memoized texture hashes before they are discarded
+    static constexpr std::size_t MAX_TEXTURE_HASHES = 16384;
+
+    /// Maximum number of textures whose mip levels were classified before they are forgotten
+    static constexpr std::size_t MAX_MIPMAP_POLICIES = 4096;
+
     using Runtime = typename T::Runtime;
     using Sampler = typename T::Sampler;
     using Surface = typename T::Surface;
@@ -72,17 +81,47 @@ class RasterizerCache {
                                                 std::less, boost::icl::inplace_plus,
                                                 boost::icl::inter_section, SurfaceInterval>;
 
+    /// Describes the guest texture a memoized hash was computed for
+    struct TextureHashKey {
+        PAddr addr;
+        PAddr end;
+        u32 width;
+        u32 height;
+        u32 stride;
+        u32 pixel_format;
+        u32 is_tiled;
+        u32 use_new_hash;
+
+        bool operator==(const TextureHashKey&) const = default;
+    };
+
+    struct TextureHash {
+        TextureHashKey key;
+        u64 generation;
+        u64 hash;
+    };
+
+    /// How the mip levels of a texture are validated when accurate mipmaps are off
+    enum class MipmapPolicy : u8 {
+        Decode,   ///< The guest levels differ from the base level filtered, they are uploaded
+        Generate, ///< The guest levels are box filtered from the base level, they are generated
+    };
+
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
-    using PageMap = boost::icl::interval_map<u32, int>;
 
 public:
     explicit RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
-                             Runtime& runtime, Pica::RegsInternal& regs, RendererBase& renderer);
+                             Runtime& runtime, Pica::RegsInternal& regs, RendererBase& renderer,
+                             const Settings::RuntimeSettings& runtime_settings);
     ~RasterizerCache();
 
     /// Notify the cache that a new frame has been queued
     void TickFrame();
 
+    /// Returns true when the surfaces of the framebuffer were never read, so that the draws into
+    /// them may be skipped without affecting anything but the displayed image
+    bool CanSkipDraw(const Framebuffer& framebuffer) const;
+
     /// Perform hardware accelerated texture copy according to the provided configuration
     bool AccelerateTextureCopy(const Pica::DisplayTransferConfig& config);
 
@@ -136,6 +175,19 @@ public:
     /// Clear all cached resources tracked by this cache manager
     void ClearAll(bool flush);
 
+    /// Returns the host memory used by all allocated surfaces, as of the last frame
+    u64 GetTextureMemoryUsage() const noexcept {
+        return texture_memory;
+    }
+
+    /// Counts the pages of a region of other cached guest data as cached, so that writes to them
+    /// are reported, or stops counting them when track is false
+    void TrackRegion(PAddr addr, u32 size, bool track);
+
+    /// Returns a value that changes whenever the region is written, or std::nullopt when any of
+    /// its pages is not cached
+    std::optional<u64> GetRegionGeneration(PAddr addr, u32 size) const;
+
 private:
     /// Iterate over all page indices in a range
     template <typename Func>
@@ -165,15 +217,25 @@ private:
     /// Unregisters sentenced surfaces that have surpassed the destruction threshold.
     void RunGarbageCollector();
 
+    /// Evicts the least recently used surfaces until host memory usage fits in the budget.
+    void RunMemoryBudget();
+
+    /// Marks the source of a transfer as read when its destination is read.
+    void PropagateSampled(Surface& src_surface, const Surface& dst_surface);
+
     /// Removes any framebuffers that reference the provided surface_id.
     void RemoveFramebuffers(SurfaceId surface_id);
 
     /// Removes any references of the provided surface id from cached texture cubes.
     void RemoveTextureCubeFace(SurfaceId surface_id);
 
-    /// Computes the hash of the provided texture data.
+    /// Computes the hash of the provided texture data, reusing the previous one when the
+    /// guest pages backing it have not been written since.
     u64 ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data);
 
+    /// Hashes the provided texture data.
+    u64 HashTextureData(const SurfaceParams& load_info, std::span<u8> upload_data);
+
     /// Update surface's texture for given region when necessary
     void ValidateSurface(SurfaceId surface, PAddr addr, u32 size);
 
@@ -183,12 +245,23 @@ private:
     /// Uploads a custom texture identified with hash to the target surface
     bool UploadCustomSurface(SurfaceId surface_id, SurfaceInterval interval);
 
-    /// Copies pixel data in interval from the host GPU surface to the guest VRAM
+    /// Copies pixel data in interval from the host GPU surface to the guest VRAM. The copy may
+    /// only be issued, FinishDownloads writes the pixel data of every issued copy to VRAM.
     void DownloadSurface(Surface& surface, SurfaceInterval interval);
 
+    /// Waits for the issued downloads and encodes their pixel data to the guest VRAM
+    void FinishDownloads();
+
     /// Downloads a fill surface to guest VRAM
     void DownloadFillSurface(Surface& surface, SurfaceInterval interval);
 
+    /// Returns true if the mip levels of the surface may be generated from its base level
+    bool CanGenerateMipmaps(const Surface& surface);
+
+    /// Compares samples of the first mip level with the box filtered base level in guest memory.
+    /// Returns std::nullopt when the guest memory can not be sampled yet.
+    std::optional<bool> HasBoxFilteredMipmaps(const Surface& surface);
+
     /// Attempt to find a reinterpretable surface in the cache and use it to copy for validation
     bool ValidateByReinterpretation(Surface& surface, SurfaceParams params,
                                     const SurfaceInterval& interval);
@@ -205,31 +278,55 @@ private:
     /// Unregisters all surfaces from the cache
     void UnregisterAll();
 
+    /// Returns true if any registered surface may overlap the specified region
+    bool IsRegionCached(PAddr addr, u32 size) const;
+
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
 private:
+    /// Download whose pixel data is written to VRAM once the runtime finished it
+    struct PendingDownload {
+        SurfaceParams info;
+        PAddr start;
+        PAddr end;
+        StagingData staging;
+        std::span<u8> dest;
+        bool convert;
+    };
+
     Memory::MemorySystem& memory;
     CustomTexManager& custom_tex_manager;
     Runtime& runtime;
     Pica::RegsInternal& regs;
     RendererBase& renderer;
+    const Settings::RuntimeSettings& runtime_settings;
     std::unordered_map<TextureCubeConfig, TextureCube> texture_cube_cache;
     tsl::robin_pg_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> page_table;
     std::unordered_map<FramebufferParams, FramebufferId> framebuffers;
     std::unordered_map<SamplerParams, SamplerId> samplers;
+    std::unordered_map<u64, TextureHash> texture_hashes;
+    std::unordered_map<u64, MipmapPolicy> mipmap_policies;
     std::list<std::pair<SurfaceId, u64>> sentenced;
+    std::vector<std::pair<u64, SurfaceId>> lru_surfaces;
+    std::vector<PendingDownload> pending_downloads;
+    u32 pending_download_bytes{};
     Common::SlotVector<Surface> slot_surfaces;
     Common::SlotVector<Sampler> slot_samplers;
     Common::SlotVector<Framebuffer> slot_framebuffers;
     SurfaceMap dirty_regions;
-    PageMap cached_pages;
+    PageTracker cached_pages;
     u32 resolution_scale_factor;
     u64 frame_tick{};
+    u64 texture_memory{};
+    u64 texture_memory_budget;
     FramebufferParams fb_params;
     Settings::TextureFilter filter;
     bool dump_textures;
     bool use_custom_textures;
+    bool async_texture_upload;
+    bool gpu_texture_decode;
+    bool accurate_mipmaps;
 };
 
 } // namespace VideoCore
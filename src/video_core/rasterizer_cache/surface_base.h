@@ -21,6 +21,7 @@ enum class SurfaceFlagBits : u32 {
     Custom = 1 << 3,       ///< Surface texture has been replaced with a custom texture.
     ShadowMap = 1 << 4,    ///< Surface is used during shadow rendering.
     RenderTarget = 1 << 5, ///< Surface was a render target.
+    Sampled = 1 << 6,      ///< Surface was read by a draw, a copy or the CPU.
 };
 DECLARE_ENUM_FLAG_OPERATORS(SurfaceFlagBits);
 
@@ -90,6 +91,7 @@ public:
     u32 fill_size = 0;
     std::array<u8, 4> fill_data;
     u64 modification_tick = 1;
+    u64 last_use_tick = 0;
 };
 
 } // namespace VideoCore
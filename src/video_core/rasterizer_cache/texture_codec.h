@@ -84,34 +84,38 @@ constexpr void DecodePixel4(u32 x, u32 y, const u8* source_tile, u8* dest_pixel)
     }
 }
 
+/// Decodes an 8x8 ETC1 tile a 4x4 subtile at a time to RGBA8 pixels
 template <PixelFormat format>
-constexpr void DecodePixelETC1(u32 x, u32 y, const u8* source_tile, u8* dest_pixel) {
-    constexpr u32 subtile_width = 4;
-    constexpr u32 subtile_height = 4;
+void DecodeTileETC1(u32 stride, std::span<const u8> tile_buffer, std::span<u8> linear_buffer) {
     constexpr bool has_alpha = format == PixelFormat::ETC1A4;
     constexpr std::size_t subtile_size = has_alpha ? 16 : 8;
-
-    const u32 subtile_index = (x / subtile_width) + 2 * (y / subtile_height);
-    x %= subtile_width;
-    y %= subtile_height;
-
-    const u8* subtile_ptr = source_tile + subtile_index * subtile_size;
-
-    u8 alpha = 255;
-    if constexpr (has_alpha) {
-        u64_le packed_alpha;
-        std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
-        subtile_ptr += sizeof(u64);
-
-        alpha = Common::Color::Convert4To8((packed_alpha >> (4 * (x * subtile_width + y))) & 0xF);
+    constexpr u32 bytes_per_pixel = 4;
+
+    std::array<Common::Vec4<u8>, 16> texels;
+    for (u32 subtile_index = 0; subtile_index < 4; subtile_index++) {
+        const u8* subtile_ptr = tile_buffer.data() + subtile_index * subtile_size;
+        u64_le packed_alpha{};
+        if constexpr (has_alpha) {
+            std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+        Pica::Texture::DecodeETC1Subtile(MakeInt<u64_le>(subtile_ptr), texels);
+
+        const u32 subtile_x = (subtile_index % 2) * 4;
+        const u32 subtile_y = (subtile_index / 2) * 4;
+        for (u32 y = 0; y < 4; y++) {
+            u8* linear_row =
+                linear_buffer.data() + ((7 - subtile_y - y) * stride + subtile_x) * bytes_per_pixel;
+            for (u32 x = 0; x < 4; x++) {
+                Common::Vec4<u8>& texel = texels[4 * y + x];
+                if constexpr (has_alpha) {
+                    const u32 alpha = (packed_alpha >> (4 * (x * 4 + y))) & 0xF;
+                    texel.a() = Common::Color::Convert4To8(static_cast<u8>(alpha));
+                }
+                std::memcpy(linear_row + x * bytes_per_pixel, texel.AsArray(), bytes_per_pixel);
+            }
+        }
     }
-
-    const u64_le subtile_data = MakeInt<u64_le>(subtile_ptr);
-    const auto rgb = Pica::Texture::SampleETC1Subtile(subtile_data, x, y);
-
-    // Copy the uncompressed pixel to the destination
-    std::memcpy(dest_pixel, rgb.AsArray(), 3);
-    dest_pixel[3] = alpha;
 }
 
 template <PixelFormat format, bool converted>
@@ -203,6 +207,11 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
     constexpr bool is_compressed = format == PixelFormat::ETC1 || format == PixelFormat::ETC1A4;
     constexpr bool is_4bit = format == PixelFormat::I4 || format == PixelFormat::A4;
 
+    if constexpr (morton_to_linear && is_compressed) {
+        DecodeTileETC1<format>(stride, tile_buffer, linear_buffer);
+        return;
+    }
+
     for (u32 y = 0; y < 8; y++) {
         for (u32 x = 0; x < 8; x++) {
             const auto tiled_pixel = tile_buffer.subspan(
@@ -210,9 +219,7 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
             const auto linear_pixel = linear_buffer.subspan(
                 ((7 - y) * stride + x) * linear_bytes_per_pixel, linear_bytes_per_pixel);
             if constexpr (morton_to_linear) {
-                if constexpr (is_compressed) {
-                    DecodePixelETC1<format>(x, y, tile_buffer.data(), linear_pixel.data());
-                } else if constexpr (is_4bit) {
+                if constexpr (is_4bit) {
                     DecodePixel4<format>(x, y, tile_buffer.data(), linear_pixel.data());
                 } else {
                     DecodePixel<format, converted>(tiled_pixel.data(), linear_pixel.data());
@@ -228,9 +235,12 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
     }
 }
 
+using MortonTileFunc = void (*)(u32, std::span<u8>, std::span<u8>);
+
 /**
  * @brief Performs morton to/from linear convertions on the provided pixel data
  * @param converted If true performs RGBA8 to/from convertion to all color formats
+ * @param CopyTile The function used to (un)swizzle a single 8x8 tile, defaults to the scalar one
  * @param width, height The dimentions of the rectangular region of pixels in linear_buffer
  * @param start_offset The number of bytes from the start of the first tile to the start of
  * tiled_buffer
@@ -253,7 +263,8 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
  * start_offset/end_offset are useful here as they tell us exactly where the data should be placed
  * in the linear_buffer.
  */
-template <bool morton_to_linear, PixelFormat format, bool converted = false>
+template <bool morton_to_linear, PixelFormat format, bool converted = false,
+          MortonTileFunc CopyTile = MortonCopyTile<morton_to_linear, format, converted>>
 static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 end_offset,
                                  std::span<u8> linear_buffer, std::span<u8> tiled_buffer) {
     constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
@@ -296,7 +307,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (start_offset < aligned_start_offset && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        CopyTile(width, tmp_buf, linear_data);
 
         std::memcpy(tiled_buffer.data(), tmp_buf.data() + start_offset - aligned_down_start_offset,
                     std::min(aligned_start_offset, end_offset) - start_offset);
@@ -313,7 +324,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
         while (tiled_offset < buffer_end) {
             auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
             auto tiled_data = tiled_buffer.subspan(tiled_offset, tile_size);
-            MortonCopyTile<morton_to_linear, format, converted>(width, tiled_data, linear_data);
+            CopyTile(width, tiled_data, linear_data);
             tiled_offset += tile_size;
             linear_next_tile();
         }
@@ -324,7 +335,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (end_offset > std::max(aligned_start_offset, aligned_end_offset) && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        CopyTile(width, tmp_buf, linear_data);
         std::memcpy(tiled_buffer.data() + tiled_offset, tmp_buf.data(),
                     end_offset - aligned_end_offset);
     }
@@ -0,0 +1,556 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
+
+#if defined(CITRA_HAS_SSE42)
+#include <smmintrin.h>
+#include "common/x64/cpu_detect.h"
+#define CITRA_TEXTURE_CODEC_SIMD
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#include "common/aarch64/cpu_detect.h"
+#define CITRA_TEXTURE_CODEC_SIMD
+#endif
+
+namespace VideoCore {
+
+#ifdef CITRA_TEXTURE_CODEC_SIMD
+
+namespace {
+
+/**
+ * Thin wrappers over the 128-bit integer intrinsics of each architecture so the tile kernels
+ * below can be written once. Shuffle follows pshufb/tbl semantics, any index with the high bit
+ * set produces a zero byte.
+ */
+#if defined(CITRA_HAS_SSE42)
+using Vec = __m128i;
+
+Vec Load(const u8* src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+Vec Load64(const u8* src) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+}
+
+void Store(u8* dest, Vec value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), value);
+}
+
+Vec MakeMask(const std::array<u8, 16>& mask) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data()));
+}
+
+Vec Splat8(u8 value) {
+    return _mm_set1_epi8(static_cast<char>(value));
+}
+
+Vec Splat16(u16 value) {
+    return _mm_set1_epi16(static_cast<short>(value));
+}
+
+Vec Splat32(u32 value) {
+    return _mm_set1_epi32(static_cast<int>(value));
+}
+
+Vec Shuffle(Vec value, Vec mask) {
+    return _mm_shuffle_epi8(value, mask);
+}
+
+Vec And(Vec a, Vec b) {
+    return _mm_and_si128(a, b);
+}
+
+Vec Or(Vec a, Vec b) {
+    return _mm_or_si128(a, b);
+}
+
+Vec Sub16(Vec a, Vec b) {
+    return _mm_sub_epi16(a, b);
+}
+
+template <int shift>
+Vec Shl16(Vec value) {
+    return _mm_slli_epi16(value, shift);
+}
+
+template <int shift>
+Vec Shr16(Vec value) {
+    return _mm_srli_epi16(value, shift);
+}
+
+template <int shift>
+Vec Shl32(Vec value) {
+    return _mm_slli_epi32(value, shift);
+}
+
+template <int shift>
+Vec Shr32(Vec value) {
+    return _mm_srli_epi32(value, shift);
+}
+
+Vec ZipLo8(Vec a, Vec b) {
+    return _mm_unpacklo_epi8(a, b);
+}
+
+Vec ZipLo16(Vec a, Vec b) {
+    return _mm_unpacklo_epi16(a, b);
+}
+
+Vec ZipHi16(Vec a, Vec b) {
+    return _mm_unpackhi_epi16(a, b);
+}
+
+Vec ZipLo64(Vec a, Vec b) {
+    return _mm_unpacklo_epi64(a, b);
+}
+
+Vec ZipHi64(Vec a, Vec b) {
+    return _mm_unpackhi_epi64(a, b);
+}
+
+/// Narrows the 32-bit lanes of lo and hi, which must fit in 16 bits, into a single vector
+Vec Narrow32To16(Vec lo, Vec hi) {
+    return _mm_packus_epi32(lo, hi);
+}
+
+bool HostSupportsSimd() {
+    return Common::GetCPUCaps().sse4_1;
+}
+#elif CITRA_ARCH(arm64)
+using Vec = uint8x16_t;
+
+Vec Load(const u8* src) {
+    return vld1q_u8(src);
+}
+
+Vec Load64(const u8* src) {
+    return vcombine_u8(vld1_u8(src), vdup_n_u8(0));
+}
+
+void Store(u8* dest, Vec value) {
+    vst1q_u8(dest, value);
+}
+
+Vec MakeMask(const std::array<u8, 16>& mask) {
+    return vld1q_u8(mask.data());
+}
+
+Vec Splat8(u8 value) {
+    return vdupq_n_u8(value);
+}
+
+Vec Splat16(u16 value) {
+    return vreinterpretq_u8_u16(vdupq_n_u16(value));
+}
+
+Vec Splat32(u32 value) {
+    return vreinterpretq_u8_u32(vdupq_n_u32(value));
+}
+
+Vec Shuffle(Vec value, Vec mask) {
+    return vqtbl1q_u8(value, mask);
+}
+
+Vec And(Vec a, Vec b) {
+    return vandq_u8(a, b);
+}
+
+Vec Or(Vec a, Vec b) {
+    return vorrq_u8(a, b);
+}
+
+Vec Sub16(Vec a, Vec b) {
+    return vreinterpretq_u8_u16(vsubq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+}
+
+template <int shift>
+Vec Shl16(Vec value) {
+    return vreinterpretq_u8_u16(vshlq_n_u16(vreinterpretq_u16_u8(value), shift));
+}
+
+template <int shift>
+Vec Shr16(Vec value) {
+    return vreinterpretq_u8_u16(vshrq_n_u16(vreinterpretq_u16_u8(value), shift));
+}
+
+template <int shift>
+Vec Shl32(Vec value) {
+    return vreinterpretq_u8_u32(vshlq_n_u32(vreinterpretq_u32_u8(value), shift));
+}
+
+template <int shift>
+Vec Shr32(Vec value) {
+    return vreinterpretq_u8_u32(vshrq_n_u32(vreinterpretq_u32_u8(value), shift));
+}
+
+Vec ZipLo8(Vec a, Vec b) {
+    return vzip1q_u8(a, b);
+}
+
+Vec ZipLo16(Vec a, Vec b) {
+    return vreinterpretq_u8_u16(vzip1q_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+}
+
+Vec ZipHi16(Vec a, Vec b) {
+    return vreinterpretq_u8_u16(vzip2q_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+}
+
+Vec ZipLo64(Vec a, Vec b) {
+    return vreinterpretq_u8_u64(vzip1q_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+}
+
+Vec ZipHi64(Vec a, Vec b) {
+    return vreinterpretq_u8_u64(vzip2q_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+}
+
+/// Narrows the 32-bit lanes of lo and hi, which must fit in 16 bits, into a single vector
+Vec Narrow32To16(Vec lo, Vec hi) {
+    return vreinterpretq_u8_u16(
+        vcombine_u16(vmovn_u32(vreinterpretq_u32_u8(lo)), vmovn_u32(vreinterpretq_u32_u8(hi))));
+}
+
+bool HostSupportsSimd() {
+    return Common::GetCPUCaps().asimd;
+}
+#endif
+
+constexpr u8 Z = 0x80;
+
+/// Swaps the second and third dwords, this permutation is its own inverse
+constexpr std::array<u8, 16> DWORD_0213 = {0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15};
+/// Moves the even bytes pairs of four 2x2 quads to the low half and the odd pairs to the high half
+constexpr std::array<u8, 16> QUAD_ROWS_8 = {0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15};
+constexpr std::array<u8, 16> REVERSE_32 = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+
+/// Vectorized tile kernels operate on rows of 8 pixels in the tiled (guest) format.
+/// Depending on the format size a row occupies one (lo) or two (lo, hi) vectors.
+struct Row {
+    Vec lo;
+    Vec hi;
+};
+
+constexpr u32 RowBase(u32 y) {
+    return MortonInterleave(0, y);
+}
+
+/**
+ * Loads rows y and y + 1 of an 8x8 tile, with y even.
+ * Each row pair is made of four 2x2 quads that are contiguous in morton order, found at pixel
+ * offsets 0, 4, 16 and 20 from the start of the pair. The low half of each quad belongs to row y
+ * and the high half to row y + 1.
+ */
+template <u32 bytes_per_pixel>
+void LoadRowPair(const u8* tile, u32 y, Row& row0, Row& row1) {
+    const u8* src = tile + RowBase(y) * bytes_per_pixel;
+    if constexpr (bytes_per_pixel == 4) {
+        const Vec q0 = Load(src);
+        const Vec q1 = Load(src + 16);
+        const Vec q2 = Load(src + 64);
+        const Vec q3 = Load(src + 80);
+        row0 = {ZipLo64(q0, q1), ZipLo64(q2, q3)};
+        row1 = {ZipHi64(q0, q1), ZipHi64(q2, q3)};
+    } else if constexpr (bytes_per_pixel == 2) {
+        const Vec a = Shuffle(Load(src), MakeMask(DWORD_0213));
+        const Vec b = Shuffle(Load(src + 32), MakeMask(DWORD_0213));
+        row0.lo = ZipLo64(a, b);
+        row1.lo = ZipHi64(a, b);
+    } else {
+        static_assert(bytes_per_pixel == 1);
+        const Vec pair = Shuffle(ZipLo64(Load64(src), Load64(src + 16)), MakeMask(QUAD_ROWS_8));
+        row0.lo = pair;
+        row1.lo = ZipHi64(pair, pair);
+    }
+}
+
+/// Performs the inverse of LoadRowPair.
+template <u32 bytes_per_pixel>
+void StoreRowPair(u8* tile, u32 y, const Row& row0, const Row& row1) {
+    u8* dest = tile + RowBase(y) * bytes_per_pixel;
+    if constexpr (bytes_per_pixel == 4) {
+        Store(dest, ZipLo64(row0.lo, row1.lo));
+        Store(dest + 16, ZipHi64(row0.lo, row1.lo));
+        Store(dest + 64, ZipLo64(row0.hi, row1.hi));
+        Store(dest + 80, ZipHi64(row0.hi, row1.hi));
+    } else {
+        static_assert(bytes_per_pixel == 2);
+        Store(dest, Shuffle(ZipLo64(row0.lo, row1.lo), MakeMask(DWORD_0213)));
+        Store(dest + 32, Shuffle(ZipHi64(row0.lo, row1.lo), MakeMask(DWORD_0213)));
+    }
+}
+
+/// Expands 8 16-bit unorm channels to 8 bits, given the number of bits of each channel
+template <int bits>
+Vec ExpandChannel16(Vec value) {
+    if constexpr (bits == 1) {
+        return Sub16(Shl16<8>(value), value);
+    } else if constexpr (bits == 4) {
+        return Or(Shl16<4>(value), value);
+    } else {
+        return Or(Shl16<8 - bits>(value), Shr16<2 * bits - 8>(value));
+    }
+}
+
+/// Interleaves 8 16-bit lane channels into 8 RGBA8 pixels
+void StoreRGBA(u8* dest, Vec r, Vec g, Vec b, Vec a) {
+    const Vec rg = Or(r, Shl16<8>(g));
+    const Vec ba = Or(b, Shl16<8>(a));
+    Store(dest, ZipLo16(rg, ba));
+    Store(dest + 16, ZipHi16(rg, ba));
+}
+
+/// Converts a row of 8 guest pixels to the linear (host) representation
+template <PixelFormat format, bool converted>
+void DecodeRow(const Row& row, u8* dest) {
+    [[maybe_unused]] const Vec src = row.lo;
+    if constexpr (format == PixelFormat::RGBA8 && converted) {
+        Store(dest, Shuffle(row.lo, MakeMask(REVERSE_32)));
+        Store(dest + 16, Shuffle(row.hi, MakeMask(REVERSE_32)));
+    } else if constexpr (format == PixelFormat::RGB565 && converted) {
+        const Vec r = Shr16<11>(src);
+        const Vec g = And(Shr16<5>(src), Splat16(0x3F));
+        const Vec b = And(src, Splat16(0x1F));
+        StoreRGBA(dest, ExpandChannel16<5>(r), ExpandChannel16<6>(g), ExpandChannel16<5>(b),
+                  Splat16(0xFF));
+    } else if constexpr (format == PixelFormat::RGB5A1 && converted) {
+        const Vec r = Shr16<11>(src);
+        const Vec g = And(Shr16<6>(src), Splat16(0x1F));
+        const Vec b = And(Shr16<1>(src), Splat16(0x1F));
+        const Vec a = And(src, Splat16(0x1));
+        StoreRGBA(dest, ExpandChannel16<5>(r), ExpandChannel16<5>(g), ExpandChannel16<5>(b),
+                  ExpandChannel16<1>(a));
+    } else if constexpr (format == PixelFormat::RGBA4 && converted) {
+        const Vec r = Shr16<12>(src);
+        const Vec g = And(Shr16<8>(src), Splat16(0xF));
+        const Vec b = And(Shr16<4>(src), Splat16(0xF));
+        const Vec a = And(src, Splat16(0xF));
+        StoreRGBA(dest, ExpandChannel16<4>(r), ExpandChannel16<4>(g), ExpandChannel16<4>(b),
+                  ExpandChannel16<4>(a));
+    } else if constexpr (format == PixelFormat::IA8) {
+        constexpr std::array<u8, 16> lo = {1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6};
+        constexpr std::array<u8, 16> hi = {9,  9,  9,  8,  11, 11, 11, 10,
+                                           13, 13, 13, 12, 15, 15, 15, 14};
+        Store(dest, Shuffle(src, MakeMask(lo)));
+        Store(dest + 16, Shuffle(src, MakeMask(hi)));
+    } else if constexpr (format == PixelFormat::RG8) {
+        constexpr std::array<u8, 16> lo = {1, 0, Z, Z, 3, 2, Z, Z, 5, 4, Z, Z, 7, 6, Z, Z};
+        constexpr std::array<u8, 16> hi = {9, 8, Z, Z, 11, 10, Z, Z, 13, 12, Z, Z, 15, 14, Z, Z};
+        const Vec alpha = Splat32(0xFF000000);
+        Store(dest, Or(Shuffle(src, MakeMask(lo)), alpha));
+        Store(dest + 16, Or(Shuffle(src, MakeMask(hi)), alpha));
+    } else if constexpr (format == PixelFormat::I8) {
+        constexpr std::array<u8, 16> lo = {0, 0, 0, Z, 1, 1, 1, Z, 2, 2, 2, Z, 3, 3, 3, Z};
+        constexpr std::array<u8, 16> hi = {4, 4, 4, Z, 5, 5, 5, Z, 6, 6, 6, Z, 7, 7, 7, Z};
+        const Vec alpha = Splat32(0xFF000000);
+        Store(dest, Or(Shuffle(src, MakeMask(lo)), alpha));
+        Store(dest + 16, Or(Shuffle(src, MakeMask(hi)), alpha));
+    } else if constexpr (format == PixelFormat::A8) {
+        constexpr std::array<u8, 16> lo = {Z, Z, Z, 0, Z, Z, Z, 1, Z, Z, Z, 2, Z, Z, Z, 3};
+        constexpr std::array<u8, 16> hi = {Z, Z, Z, 4, Z, Z, Z, 5, Z, Z, Z, 6, Z, Z, Z, 7};
+        Store(dest, Shuffle(src, MakeMask(lo)));
+        Store(dest + 16, Shuffle(src, MakeMask(hi)));
+    } else if constexpr (format == PixelFormat::IA4) {
+        // Nibbles are smaller than 16, so 16-bit shifts never leak into the neighbouring byte.
+        const Vec nibble_mask = Splat8(0xF);
+        const Vec i = And(Shr16<4>(src), nibble_mask);
+        const Vec a = And(src, nibble_mask);
+        const Vec ia = ZipLo8(Or(Shl16<4>(i), i), Or(Shl16<4>(a), a));
+        constexpr std::array<u8, 16> lo = {0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7};
+        constexpr std::array<u8, 16> hi = {8,  8,  8,  9,  10, 10, 10, 11,
+                                           12, 12, 12, 13, 14, 14, 14, 15};
+        Store(dest, Shuffle(ia, MakeMask(lo)));
+        Store(dest + 16, Shuffle(ia, MakeMask(hi)));
+    } else if constexpr (format == PixelFormat::D24S8) {
+        Store(dest, Or(Shl32<8>(row.lo), Shr32<24>(row.lo)));
+        Store(dest + 16, Or(Shl32<8>(row.hi), Shr32<24>(row.hi)));
+    } else if constexpr (GetFormatBpp(format) == 32) {
+        Store(dest, row.lo);
+        Store(dest + 16, row.hi);
+    } else {
+        static_assert(GetFormatBpp(format) == 16 && !converted);
+        Store(dest, src);
+    }
+}
+
+/// Packs 4 linear RGBA8 pixels to 16-bit guest pixels in 32-bit lanes
+template <PixelFormat format>
+Vec PackRGBA16(Vec rgba) {
+    const Vec byte_mask = Splat32(0xFF);
+    const Vec r = And(rgba, byte_mask);
+    const Vec g = And(Shr32<8>(rgba), byte_mask);
+    const Vec b = And(Shr32<16>(rgba), byte_mask);
+    if constexpr (format == PixelFormat::RGB565) {
+        return Or(Or(Shl32<8>(And(r, Splat32(0xF8))), Shl32<3>(And(g, Splat32(0xFC)))),
+                  Shr32<3>(b));
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return Or(Or(Shl32<8>(And(r, Splat32(0xF8))), Shl32<3>(And(g, Splat32(0xF8)))),
+                  Or(Shr32<2>(And(b, Splat32(0xF8))), Shr32<31>(rgba)));
+    } else {
+        static_assert(format == PixelFormat::RGBA4);
+        return Or(Or(Shl32<8>(And(r, Splat32(0xF0))), Shl32<4>(And(g, Splat32(0xF0)))),
+                  Or(And(b, Splat32(0xF0)), Shr32<28>(rgba)));
+    }
+}
+
+/// Converts a row of 8 linear (host) pixels to the guest representation
+template <PixelFormat format, bool converted>
+void EncodeRow(const u8* src, Row& row) {
+    if constexpr (format == PixelFormat::RGBA8 && converted) {
+        row = {Shuffle(Load(src), MakeMask(REVERSE_32)),
+                 Shuffle(Load(src + 16), MakeMask(REVERSE_32))};
+    } else if constexpr ((format == PixelFormat::RGB565 || format == PixelFormat::RGB5A1 ||
+                          format == PixelFormat::RGBA4) &&
+                         converted) {
+        row.lo = Narrow32To16(PackRGBA16<format>(Load(src)), PackRGBA16<format>(Load(src + 16)));
+    } else if constexpr (format == PixelFormat::D24S8) {
+        const Vec lo = Load(src);
+        const Vec hi = Load(src + 16);
+        row = {Or(Shr32<8>(lo), Shl32<24>(lo)), Or(Shr32<8>(hi), Shl32<24>(hi))};
+    } else if constexpr (GetFormatBpp(format) == 32) {
+        row = {Load(src), Load(src + 16)};
+    } else {
+        static_assert(GetFormatBpp(format) == 16 && !converted);
+        row.lo = Load(src);
+    }
+}
+
+template <bool morton_to_linear, PixelFormat format, bool converted>
+void VectorMortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u8> linear_buffer) {
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
+    constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
+    const u32 linear_stride = stride * linear_bytes_per_pixel;
+
+    // Rows are stored bottom up in the linear buffer, see MortonCopyTile.
+    for (u32 y = 0; y < 8; y += 2) {
+        u8* linear_row0 = linear_buffer.data() + (7 - y) * linear_stride;
+        u8* linear_row1 = linear_row0 - linear_stride;
+        Row row0, row1;
+        if constexpr (morton_to_linear) {
+            LoadRowPair<bytes_per_pixel>(tile_buffer.data(), y, row0, row1);
+            DecodeRow<format, converted>(row0, linear_row0);
+            DecodeRow<format, converted>(row1, linear_row1);
+        } else {
+            EncodeRow<format, converted>(linear_row0, row0);
+            EncodeRow<format, converted>(linear_row1, row1);
+            StoreRowPair<bytes_per_pixel>(tile_buffer.data(), y, row0, row1);
+        }
+    }
+}
+
+template <bool morton_to_linear, PixelFormat format, bool converted = false>
+constexpr MortonFunc VectorMortonCopy =
+    MortonCopy<morton_to_linear, format, converted,
+               VectorMortonCopyTile<morton_to_linear, format, converted>>;
+
+// 24-bit, 4-bit and ETC1 formats do not map well to 128-bit lanes and use the scalar path.
+constexpr std::array<MortonFunc, 18> VECTOR_UNSWIZZLE_TABLE = {
+    VectorMortonCopy<true, PixelFormat::RGBA8>,  // 0
+    nullptr,                                     // 1
+    VectorMortonCopy<true, PixelFormat::RGB5A1>, // 2
+    VectorMortonCopy<true, PixelFormat::RGB565>, // 3
+    VectorMortonCopy<true, PixelFormat::RGBA4>,  // 4
+    VectorMortonCopy<true, PixelFormat::IA8>,    // 5
+    VectorMortonCopy<true, PixelFormat::RG8>,    // 6
+    VectorMortonCopy<true, PixelFormat::I8>,     // 7
+    VectorMortonCopy<true, PixelFormat::A8>,     // 8
+    VectorMortonCopy<true, PixelFormat::IA4>,    // 9
+    nullptr,                                     // 10
+    nullptr,                                     // 11
+    nullptr,                                     // 12
+    nullptr,                                     // 13
+    VectorMortonCopy<true, PixelFormat::D16>,    // 14
+    nullptr,                                     // 15
+    nullptr,                                     // 16
+    VectorMortonCopy<true, PixelFormat::D24S8>,  // 17
+};
+
+constexpr std::array<MortonFunc, 18> VECTOR_UNSWIZZLE_TABLE_CONVERTED = {
+    VectorMortonCopy<true, PixelFormat::RGBA8, true>,  // 0
+    nullptr,                                           // 1
+    VectorMortonCopy<true, PixelFormat::RGB5A1, true>, // 2
+    VectorMortonCopy<true, PixelFormat::RGB565, true>, // 3
+    VectorMortonCopy<true, PixelFormat::RGBA4, true>,  // 4
+    nullptr,                                           // 5
+    nullptr,                                           // 6
+    nullptr,                                           // 7
+    nullptr,                                           // 8
+    nullptr,                                           // 9
+    nullptr,                                           // 10
+    nullptr,                                           // 11
+    nullptr,                                           // 12
+    nullptr,                                           // 13
+    nullptr,                                           // 14
+    nullptr,                                           // 15
+    nullptr,                                           // 16
+    nullptr,                                           // 17
+};
+
+constexpr std::array<MortonFunc, 18> VECTOR_SWIZZLE_TABLE = {
+    VectorMortonCopy<false, PixelFormat::RGBA8>,  // 0
+    nullptr,                                      // 1
+    VectorMortonCopy<false, PixelFormat::RGB5A1>, // 2
+    VectorMortonCopy<false, PixelFormat::RGB565>, // 3
+    VectorMortonCopy<false, PixelFormat::RGBA4>,  // 4
+    nullptr,                                      // 5
+    nullptr,                                      // 6
+    nullptr,                                      // 7
+    nullptr,                                      // 8
+    nullptr,                                      // 9
+    nullptr,                                      // 10
+    nullptr,                                      // 11
+    nullptr,                                      // 12
+    nullptr,                                      // 13
+    VectorMortonCopy<false, PixelFormat::D16>,    // 14
+    nullptr,                                      // 15
+    nullptr,                                      // 16
+    VectorMortonCopy<false, PixelFormat::D24S8>,  // 17
+};
+
+constexpr std::array<MortonFunc, 18> VECTOR_SWIZZLE_TABLE_CONVERTED = {
+    VectorMortonCopy<false, PixelFormat::RGBA8, true>,  // 0
+    nullptr,                                            // 1
+    VectorMortonCopy<false, PixelFormat::RGB5A1, true>, // 2
+    VectorMortonCopy<false, PixelFormat::RGB565, true>, // 3
+    VectorMortonCopy<false, PixelFormat::RGBA4, true>,  // 4
+    nullptr,                                            // 5
+    nullptr,                                            // 6
+    nullptr,                                            // 7
+    nullptr,                                            // 8
+    nullptr,                                            // 9
+    nullptr,                                            // 10
+    nullptr,                                            // 11
+    nullptr,                                            // 12
+    nullptr,                                            // 13
+    nullptr,                                            // 14
+    nullptr,                                            // 15
+    nullptr,                                            // 16
+    nullptr,                                            // 17
+};
+
+} // Anonymous namespace
+
+MortonFunc GetVectorizedMortonFunc(PixelFormat format, bool morton_to_linear, bool converted) {
+    static const bool host_supported = HostSupportsSimd();
+    const std::size_t index = static_cast<std::size_t>(format);
+    if (!host_supported || index >= PIXEL_FORMAT_COUNT) {
+        return nullptr;
+    }
+    if (morton_to_linear) {
+        return (converted ? VECTOR_UNSWIZZLE_TABLE_CONVERTED : VECTOR_UNSWIZZLE_TABLE)[index];
+    }
+    return (converted ? VECTOR_SWIZZLE_TABLE_CONVERTED : VECTOR_SWIZZLE_TABLE)[index];
+}
+
+#else
+
+MortonFunc GetVectorizedMortonFunc(PixelFormat, bool, bool) {
+    return nullptr;
+}
+
+#endif // CITRA_TEXTURE_CODEC_SIMD
+
+} // namespace VideoCore
@@ -0,0 +1,20 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/rasterizer_cache/texture_codec.h"
+
+namespace VideoCore {
+
+/**
+ * Returns a vectorized implementation of MortonCopy for the provided format.
+ * @param morton_to_linear If true returns an unswizzle (decode) function, otherwise a swizzle one
+ * @param converted If true the function converts to/from RGBA8 just like the scalar tables
+ * @return The vectorized function or nullptr when the host CPU or the format is not supported,
+ * in which case the scalar tables in texture_codec.h should be used.
+ */
+MortonFunc GetVectorizedMortonFunc(PixelFormat format, bool morton_to_linear, bool converted);
+
+} // namespace VideoCore
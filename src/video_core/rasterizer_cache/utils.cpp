@@ -2,12 +2,25 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <vector>
+#include "common/task_scheduler.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/texture_codec.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
 #include "video_core/rasterizer_cache/utils.h"
 
 namespace VideoCore {
 
+namespace {
+
+/// Minimum amount of tiled data worth splitting across threads.
+constexpr u32 MIN_PARALLEL_DECODE_SIZE = 64 * 1024;
+
+/// Minimum number of tile rows (8 pixel rows each) handed to a single band.
+constexpr u32 MIN_BAND_TILE_ROWS = 4;
+
+} // Anonymous namespace
+
 u32 MipLevels(u32 width, u32 height, u32 max_level) {
     u32 levels = 1;
     while (width > 8 && height > 8) {
@@ -25,8 +38,10 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     const u32 func_index = static_cast<u32>(format);
 
     if (surface_info.is_tiled) {
-        const MortonFunc SwizzleImpl =
-            (convert ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[func_index];
+        MortonFunc SwizzleImpl = GetVectorizedMortonFunc(format, false, convert);
+        if (!SwizzleImpl) {
+            SwizzleImpl = (convert ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[func_index];
+        }
         if (SwizzleImpl) {
             SwizzleImpl(surface_info.width, surface_info.height, start_addr - surface_info.addr,
                         end_addr - surface_info.addr, source, dest);
@@ -52,8 +67,10 @@ void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     const u32 func_index = static_cast<u32>(format);
 
     if (surface_info.is_tiled) {
-        const MortonFunc UnswizzleImpl =
-            (convert ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[func_index];
+        MortonFunc UnswizzleImpl = GetVectorizedMortonFunc(format, true, convert);
+        if (!UnswizzleImpl) {
+            UnswizzleImpl = (convert ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[func_index];
+        }
         if (UnswizzleImpl) {
             UnswizzleImpl(surface_info.width, surface_info.height, start_addr - surface_info.addr,
                           end_addr - surface_info.addr, dest, source);
@@ -73,4 +90,50 @@ void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     UNIMPLEMENTED();
 }
 
+void DecodeTextureParallel(const SurfaceParams& surface_info, std::span<u8> source,
+                           std::span<u8> dest, bool convert) {
+    auto& scheduler = Common::GetTaskScheduler();
+    const u32 tile_rows = surface_info.height / 8;
+    const u32 num_bands = std::min<u32>(tile_rows / MIN_BAND_TILE_ROWS,
+                                        static_cast<u32>(scheduler.NumWorkers()) + 1);
+
+    // Bands must map to contiguous ranges of both buffers, which only holds when the
+    // surface covers whole tile rows.
+    if (!surface_info.is_tiled || surface_info.width != surface_info.stride || num_bands < 2 ||
+        source.size() < MIN_PARALLEL_DECODE_SIZE) {
+        DecodeTexture(surface_info, surface_info.addr, surface_info.end, source, dest, convert);
+        return;
+    }
+
+    const u32 tiled_row_bytes = surface_info.BytesInPixels(surface_info.stride * 8);
+    const u32 linear_bpp = convert ? 4 : GetFormatBytesPerPixel(surface_info.pixel_format);
+    const u32 linear_row_bytes = surface_info.width * 8 * linear_bpp;
+
+    const auto decode_band = [&](u32 first_row, u32 last_row) {
+        const u32 band_rows = last_row - first_row;
+        SurfaceParams band_info = surface_info;
+        band_info.addr = surface_info.addr + first_row * tiled_row_bytes;
+        band_info.end = band_info.addr + band_rows * tiled_row_bytes;
+        band_info.height = band_rows * 8;
+
+        // The linear buffer is written bottom-up, so the first band lands at the end of dest.
+        const auto band_source =
+            source.subspan(first_row * tiled_row_bytes, band_rows * tiled_row_bytes);
+        const auto band_dest =
+            dest.subspan((tile_rows - last_row) * linear_row_bytes, band_rows * linear_row_bytes);
+        DecodeTexture(band_info, band_info.addr, band_info.end, band_source, band_dest, convert);
+    };
+
+    Common::TaskGroup group{scheduler};
+    for (u32 band = 0; band < num_bands - 1; band++) {
+        group.Run([&decode_band, band, num_bands, tile_rows] {
+            decode_band(band * tile_rows / num_bands, (band + 1) * tile_rows / num_bands);
+        });
+    }
+
+    // Decode the last band on the calling thread instead of idling until the workers finish.
+    decode_band((num_bands - 1) * tile_rows / num_bands, tile_rows);
+    group.Wait();
+}
+
 } // namespace VideoCore
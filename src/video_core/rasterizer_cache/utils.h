@@ -58,6 +58,7 @@ struct BufferTextureCopy {
     u32 buffer_size;
     Common::Rectangle<u32> texture_rect;
     u32 texture_level;
+    u64 content_hash = 0; ///< Hash of the guest data of a whole base level upload, 0 if unknown
 };
 
 struct StagingData {
@@ -97,4 +98,13 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
 void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
                    std::span<u8> source, std::span<u8> dest, bool convert = false);
 
+/**
+ * Decodes the whole of the provided surface like DecodeTexture, splitting large tiled surfaces
+ * into bands of tile rows that are decoded concurrently on the task scheduler.
+ * The function returns only after every band has been written to dest, so the caller may
+ * record the upload immediately afterwards.
+ */
+void DecodeTextureParallel(const SurfaceParams& surface_info, std::span<u8> source,
+                           std::span<u8> dest, bool convert = false);
+
 } // namespace VideoCore
@@ -39,6 +39,15 @@ public:
     /// Draw the current batch of triangles
     virtual void DrawTriangles() = 0;
 
+    /// Returns false when the current batch of triangles may keep growing with the triangles of
+    /// the following draws before being drawn.
+    virtual bool ShouldDrawTriangles() const {
+        return true;
+    }
+
+    /// Sets whether the draws of the next frame that only affect the displayed image are skipped
+    virtual void SetFrameSkip([[maybe_unused]] bool skip) {}
+
     /// Notify rasterizer that all caches should be flushed to 3DS memory
     virtual void FlushAll() = 0;
 
@@ -81,6 +90,9 @@ public:
 
     virtual void SwitchDiskResources([[maybe_unused]] u64 title_id) {}
 
+    /// Writes the disk resources that are otherwise only stored on shutdown
+    virtual void SaveDiskResources() {}
+
     static void SetSwitchDiskResourcesCallback(const DiskResourceLoadCallback& callback) {
         switch_disk_resources_callback = callback;
     }
@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/settings.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/frontend/emu_window.h"
 #include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
@@ -11,6 +13,21 @@
 
 namespace VideoCore {
 
+namespace {
+
+/// Frames after a scale change that are not measured, as they recreate the surfaces
+constexpr u32 DynamicResolutionSettleFrames = 30;
+/// Frames between scale changes, so that the scale does not bounce on short spikes
+constexpr u32 DynamicResolutionIntervalFrames = 120;
+/// The scale is lowered when the GPU is busy for more than this share of the frame time...
+constexpr double DynamicResolutionLowerLoad = 0.9;
+/// ...and raised when the next scale is estimated to need less than this share
+constexpr double DynamicResolutionRaiseLoad = 0.75;
+/// A frame overran when it took this much longer than its emulated time at the speed limit
+constexpr double FrameSkipOverrunScale = 1.05;
+
+} // Anonymous namespace
+
 RendererBase::RendererBase(Core::System& system_, Frontend::EmuWindow& window,
                            Frontend::EmuWindow* secondary_window_)
     : system{system_}, render_window{window}, secondary_window{secondary_window_} {}
@@ -24,9 +41,75 @@ u32 RendererBase::GetResolutionScaleFactor() {
         return 1;
     }
 
+    u32 scale_factor = GetConfiguredScaleFactor();
+    const u32 dynamic_scale = dynamic_scale_factor.load(std::memory_order_relaxed);
+    if (dynamic_scale != 0 && Settings::values.dynamic_resolution.GetValue()) {
+        scale_factor = std::min(scale_factor, dynamic_scale);
+    }
+    switch (thermal_throttle_level.load(std::memory_order_relaxed)) {
+    case 0:
+        return scale_factor;
+    case 1:
+        return std::max(scale_factor - 1, 1U);
+    case 2:
+        return std::max(scale_factor / 2, 1U);
+    default:
+        return 1;
+    }
+}
+
+u32 RendererBase::GetConfiguredScaleFactor() const {
     const u32 scale_factor = Settings::values.resolution_factor.GetValue();
-    return scale_factor != 0 ? scale_factor
-                             : render_window.GetFramebufferLayout().GetScalingRatio();
+    if (scale_factor == 0) {
+        return render_window.GetFramebufferLayout().GetScalingRatio();
+    }
+    return scale_factor;
+}
+
+void RendererBase::ReportGpuFrameTime(std::chrono::nanoseconds gpu_time) {
+    if (!Settings::values.dynamic_resolution.GetValue()) {
+        dynamic_scale_factor.store(0, std::memory_order_relaxed);
+        return;
+    }
+    const u32 max_scale = std::max(GetConfiguredScaleFactor(), 1U);
+    const u32 dynamic_scale = dynamic_scale_factor.load(std::memory_order_relaxed);
+    const u32 scale = dynamic_scale == 0 ? max_scale : std::min(dynamic_scale, max_scale);
+
+    frames_since_scale_change++;
+    if (frames_since_scale_change < DynamicResolutionSettleFrames) {
+        return;
+    }
+    const double sample = std::chrono::duration<double>(gpu_time).count();
+    if (frames_since_scale_change == DynamicResolutionSettleFrames) {
+        average_gpu_time = sample;
+    } else {
+        average_gpu_time = average_gpu_time * 0.95 + sample * 0.05;
+    }
+    if (frames_since_scale_change < DynamicResolutionIntervalFrames) {
+        return;
+    }
+
+    // Frames have to fit in the emulated frame time at the current speed limit
+    const double speed = Settings::GetFrameLimit() == 0 ? 1.0 : Settings::GetFrameLimit() / 100.0;
+    const double frame_time = 1.0 / (SCREEN_REFRESH_RATE * speed);
+    u32 new_scale = scale;
+    if (average_gpu_time > frame_time * DynamicResolutionLowerLoad) {
+        new_scale = std::max(scale - 1, 1U);
+    } else if (scale < max_scale) {
+        // Rendering cost mostly grows with the number of pixels
+        const double growth = static_cast<double>((scale + 1) * (scale + 1)) / (scale * scale);
+        if (average_gpu_time * growth < frame_time * DynamicResolutionRaiseLoad) {
+            new_scale = scale + 1;
+        }
+    }
+    if (new_scale != scale || dynamic_scale == 0) {
+        dynamic_scale_factor.store(new_scale, std::memory_order_relaxed);
+    }
+    if (new_scale != scale) {
+        LOG_INFO(Render, "Dynamic resolution scale changed to {}x, GPU frame time {:.2f} ms",
+                 new_scale, average_gpu_time * 1000.0);
+        frames_since_scale_change = 0;
+    }
 }
 
 void RendererBase::UpdateCurrentFramebufferLayout(bool is_portrait_mode) {
@@ -43,7 +126,8 @@ void RendererBase::UpdateCurrentFramebufferLayout(bool is_portrait_mode) {
 void RendererBase::EndFrame() {
     current_frame++;
 
-    system.perf_stats->EndSystemFrame();
+    system.EndSystemFrame();
+    UpdateFrameSkip();
 
     render_window.PollEvents();
 
@@ -51,6 +135,23 @@ void RendererBase::EndFrame() {
     system.perf_stats->BeginSystemFrame();
 }
 
+void RendererBase::UpdateFrameSkip() {
+    VideoCore::RasterizerInterface* rasterizer = Rasterizer();
+    if (!rasterizer) {
+        return;
+    }
+
+    // Frames are never skipped twice in a row, so that at least every other one is rendered
+    bool skip = false;
+    if (Settings::values.auto_frame_skip.GetValue() && !frame_skipped) {
+        const double speed =
+            Settings::GetFrameLimit() == 0 ? 1.0 : Settings::GetFrameLimit() / 100.0;
+        skip = system.perf_stats->GetLastFrameTimeScale() * speed > FrameSkipOverrunScale;
+    }
+    frame_skipped = skip;
+    rasterizer->SetFrameSkip(skip);
+}
+
 bool RendererBase::IsScreenshotPending() const {
     return settings.screenshot_requested;
 }
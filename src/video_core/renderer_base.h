@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include "common/common_types.h"
 #include "core/frontend/framebuffer_layout.h"
 #include "video_core/rasterizer_interface.h"
@@ -67,6 +69,21 @@ public:
     /// Returns the resolution scale factor relative to the native 3DS screen resolution
     u32 GetResolutionScaleFactor();
 
+    /**
+     * Lowers the resolution scale to cool the device down. Level 0 keeps the configured scale,
+     * 1 lowers it by one step, 2 halves it and higher levels render at native resolution.
+     */
+    void SetThermalThrottleLevel(u32 level) {
+        thermal_throttle_level.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * Feeds the time the GPU was busy with the last frame to the dynamic resolution, which lowers
+     * the resolution scale while frames take longer than the frame time and raises it back up to
+     * the configured scale once they would fit.
+     */
+    void ReportGpuFrameTime(std::chrono::nanoseconds gpu_time);
+
     /// Updates the framebuffer layout of the contained render window handle.
     void UpdateCurrentFramebufferLayout(bool is_portrait_mode = {});
 
@@ -110,9 +127,21 @@ protected:
     Frontend::EmuWindow& render_window;    /// Reference to the render window handle.
     Frontend::EmuWindow* secondary_window; /// Reference to the secondary render window handle.
 
+private:
+    /// Returns the resolution scale set by the user
+    u32 GetConfiguredScaleFactor() const;
+
+    /// Decides whether the next frame is skipped, after the previous one overran its time
+    void UpdateFrameSkip();
+
 protected:
     f32 current_fps = 0.0f; /// Current framerate, should be set by the renderer
     s32 current_frame = 0;  /// Current frame, should be set by the renderer
+    std::atomic<u32> thermal_throttle_level = 0;
+    std::atomic<u32> dynamic_scale_factor = 0; ///< Zero until the GPU frame time is first reported
+    double average_gpu_time = 0.0;
+    u32 frames_since_scale_change = 0;
+    bool frame_skipped = false; ///< Whether the draws of the current frame may be skipped
 };
 
 } // namespace VideoCore
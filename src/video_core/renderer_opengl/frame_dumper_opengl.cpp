@@ -68,18 +68,19 @@ void FrameDumperOpenGL::PresentLoop(std::stop_token stop_token) {
 
         auto video_dumper = system.GetVideoDumper();
         if (video_dumper) {
-            // Bind the previous PBO and read the pixels
-            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next_pbo].handle);
-            GLubyte* pixels =
-                static_cast<GLubyte*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
-            VideoDumper::VideoFrame frame_data{layout.width, layout.height, pixels};
-            video_dumper->AddVideoFrame(std::move(frame_data));
-            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            // Bind the oldest PBO and read the pixels
+            const auto oldest_pbo = (current_pbo + 1) % pbos.size();
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[oldest_pbo].handle);
+            const GLubyte* pixels =
+                static_cast<const GLubyte*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+            if (pixels) {
+                video_dumper->AddVideoFrame(layout.width, layout.height, pixels);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
             glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
         }
 
-        current_pbo = (current_pbo + 1) % 2;
-        next_pbo = (current_pbo + 1) % 2;
+        current_pbo = static_cast<GLuint>((current_pbo + 1) % pbos.size());
     }
 
     CleanupOpenGLObjects();
@@ -52,10 +52,10 @@ private:
     std::unique_ptr<Frontend::GraphicsContext> context;
     std::jthread present_thread;
 
-    // PBOs used to dump frames faster
-    std::array<OGLBuffer, 2> pbos;
-    GLuint current_pbo = 1;
-    GLuint next_pbo = 0;
+    // PBOs used to dump frames faster. Each one is mapped two frames after its readback was
+    // issued, so mapping does not have to wait for the GPU to finish the copy.
+    std::array<OGLBuffer, 3> pbos;
+    GLuint current_pbo = 0;
 };
 
 } // namespace OpenGL
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
@@ -92,12 +93,7 @@ bool BlitHelper::ConvertDS24S8ToRGBA8(Surface& source, Surface& dest,
     state.texture_units[1].sampler = 0;
 
     if (use_texture_view) {
-        temp_tex.Create();
-        glActiveTexture(GL_TEXTURE1);
-        glTextureView(temp_tex.handle, GL_TEXTURE_2D, source.Handle(), GL_DEPTH24_STENCIL8, 0, 1, 0,
-                      1);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        state.texture_units[1].texture_2d = source.StencilView();
     } else if (copy.extent.width > temp_extent.width || copy.extent.height > temp_extent.height) {
         temp_extent = copy.extent;
         temp_tex.Release();
@@ -109,17 +105,17 @@ bool BlitHelper::ConvertDS24S8ToRGBA8(Surface& source, Surface& dest,
                        temp_extent.height);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_STENCIL_INDEX);
     }
-    state.texture_units[1].texture_2d = temp_tex.handle;
-    state.Apply();
 
-    glActiveTexture(GL_TEXTURE1);
+    // Without texture views the stencil is copied to the intermediate texture first
     if (!use_texture_view) {
+        state.texture_units[1].texture_2d = temp_tex.handle;
         glCopyImageSubData(source.Handle(), GL_TEXTURE_2D, 0, copy.src_offset.x, copy.src_offset.y,
                            0, temp_tex.handle, GL_TEXTURE_2D, 0, copy.src_offset.x,
                            copy.src_offset.y, 0, copy.extent.width, copy.extent.height, 1);
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_STENCIL_INDEX);
+    state.Apply();
 
     const Common::Rectangle src_rect{copy.src_offset.x, copy.src_offset.y + copy.extent.height,
                                      copy.src_offset.x + copy.extent.width, copy.src_offset.x};
@@ -128,10 +124,6 @@ bool BlitHelper::ConvertDS24S8ToRGBA8(Surface& source, Surface& dest,
     SetParams(d24s8_to_rgba8, source.RealExtent(), src_rect);
     Draw(d24s8_to_rgba8, dest.Handle(), draw_fbo.handle, 0, dst_rect);
 
-    if (use_texture_view) {
-        temp_tex.Release();
-    }
-
     // Restore the sampler handles
     state.texture_units[0].sampler = linear_sampler.handle;
     state.texture_units[1].sampler = linear_sampler.handle;
@@ -156,7 +148,7 @@ bool BlitHelper::ConvertRGBA4ToRGB5A1(Surface& source, Surface& dest,
     return true;
 }
 
-bool BlitHelper::Filter(Surface& surface, const VideoCore::TextureBlit& blit) {
+bool BlitHelper::Filter(Surface& surface, const VideoCore::TextureBlit& blit, u64 content_hash) {
     const auto filter = Settings::values.texture_filter.GetValue();
     const bool is_depth =
         surface.type == SurfaceType::Depth || surface.type == SurfaceType::DepthStencil;
@@ -167,6 +159,17 @@ bool BlitHelper::Filter(Surface& surface, const VideoCore::TextureBlit& blit) {
         return true;
     }
 
+    u64 cache_key = 0;
+    if (content_hash != 0) {
+        cache_key = Common::HashCombine(content_hash, static_cast<u64>(filter));
+        cache_key = Common::HashCombine(cache_key, static_cast<u64>(surface.pixel_format));
+        cache_key = Common::HashCombine(cache_key, surface.res_scale);
+        cache_key = Common::HashCombine(cache_key, (u64{surface.width} << 32) | surface.height);
+        if (CopyCachedFilter(surface, blit, cache_key)) {
+            return true;
+        }
+    }
+
     switch (filter) {
     case TextureFilter::Anime4K:
         FilterAnime4K(surface, blit);
@@ -187,9 +190,45 @@ bool BlitHelper::Filter(Surface& surface, const VideoCore::TextureBlit& blit) {
         LOG_ERROR(Render_OpenGL, "Unknown texture filter {}", filter);
     }
 
+    if (cache_key != 0) {
+        CacheFilter(surface, blit, cache_key);
+    }
     return true;
 }
 
+bool BlitHelper::CopyCachedFilter(Surface& surface, const VideoCore::TextureBlit& blit, u64 key) {
+    const auto it = filter_cache.find(key);
+    if (it == filter_cache.end()) {
+        return false;
+    }
+    it.value().last_use = ++filter_cache_tick;
+    const auto& rect = blit.dst_rect;
+    glCopyImageSubData(it->second.texture.handle, GL_TEXTURE_2D, 0, 0, 0, 0, surface.Handle(),
+                       GL_TEXTURE_2D, blit.dst_level, rect.left, rect.bottom, 0, rect.GetWidth(),
+                       rect.GetHeight(), 1);
+    return true;
+}
+
+void BlitHelper::CacheFilter(Surface& surface, const VideoCore::TextureBlit& blit, u64 key) {
+    static constexpr std::size_t MAX_FILTER_CACHE_SIZE = 256;
+    if (filter_cache.size() >= MAX_FILTER_CACHE_SIZE) {
+        const auto oldest = std::min_element(
+            filter_cache.begin(), filter_cache.end(),
+            [](const auto& a, const auto& b) { return a.second.last_use < b.second.last_use; });
+        filter_cache.erase(oldest);
+    }
+
+    const auto& rect = blit.dst_rect;
+    FilteredTexture filtered{.last_use = ++filter_cache_tick};
+    filtered.texture.Create();
+    filtered.texture.Allocate(GL_TEXTURE_2D, 1, surface.Tuple().internal_format, rect.GetWidth(),
+                              rect.GetHeight());
+    glCopyImageSubData(surface.Handle(), GL_TEXTURE_2D, blit.dst_level, rect.left, rect.bottom, 0,
+                       filtered.texture.handle, GL_TEXTURE_2D, 0, 0, 0, 0, rect.GetWidth(),
+                       rect.GetHeight(), 1);
+    filter_cache.insert_or_assign(key, std::move(filtered));
+}
+
 void BlitHelper::FilterAnime4K(Surface& surface, const VideoCore::TextureBlit& blit) {
     static constexpr u8 internal_scale_factor = 2;
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <tsl/robin_map.h>
+#include "common/hash.h"
 #include "common/math_util.h"
 #include "video_core/rasterizer_cache/utils.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
@@ -25,7 +27,12 @@ public:
     explicit BlitHelper(const Driver& driver);
     ~BlitHelper();
 
-    bool Filter(Surface& surface, const VideoCore::TextureBlit& blit);
+    /**
+     * Upscales the blit region of the surface with the configured texture filter. Returns false
+     * when no filter applies. A non zero content_hash identifies the guest data of a whole base
+     * level, whose filtered result is cached and copied on later uploads of the same data.
+     */
+    bool Filter(Surface& surface, const VideoCore::TextureBlit& blit, u64 content_hash = 0);
 
     bool ConvertDS24S8ToRGBA8(Surface& source, Surface& dest, const VideoCore::TextureCopy& copy);
 
@@ -38,6 +45,9 @@ private:
     void FilterXbrz(Surface& surface, const VideoCore::TextureBlit& blit);
     void FilterMMPX(Surface& surface, const VideoCore::TextureBlit& blit);
 
+    bool CopyCachedFilter(Surface& surface, const VideoCore::TextureBlit& blit, u64 key);
+    void CacheFilter(Surface& surface, const VideoCore::TextureBlit& blit, u64 key);
+
     void SetParams(OGLProgram& program, const VideoCore::Extent& src_extent,
                    Common::Rectangle<u32> src_rect);
     void Draw(OGLProgram& program, GLuint dst_tex, GLuint dst_fbo, u32 dst_level,
@@ -64,6 +74,13 @@ private:
     OGLTexture temp_tex;
     VideoCore::Extent temp_extent{};
     bool use_texture_view{true};
+
+    struct FilteredTexture {
+        OGLTexture texture;
+        u64 last_use;
+    };
+    tsl::robin_map<u64, FilteredTexture, Common::IdentityHash<u64>> filter_cache;
+    u64 filter_cache_tick{};
 };
 
 } // namespace OpenGL
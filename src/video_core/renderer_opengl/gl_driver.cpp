@@ -118,6 +118,7 @@ bool Driver::IsCustomFormatSupported(VideoCore::CustomPixelFormat format) const
     case VideoCore::CustomPixelFormat::ASTC4:
     case VideoCore::CustomPixelFormat::ASTC6:
     case VideoCore::CustomPixelFormat::ASTC8:
+    case VideoCore::CustomPixelFormat::ETC2:
         return is_gles;
     default:
         return false;
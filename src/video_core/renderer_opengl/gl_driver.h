@@ -89,6 +89,11 @@ public:
         return ext_buffer_storage;
     }
 
+    /// Returns true if stream buffers can be persistently mapped rings
+    bool HasPersistentStreamBuffers() const {
+        return arb_buffer_storage || ext_buffer_storage;
+    }
+
     /// Returns true if the implementation supports ARB_clear_texture
     bool HasArbClearTexture() const {
         return arb_clear_texture;
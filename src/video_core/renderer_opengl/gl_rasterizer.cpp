@@ -9,6 +9,7 @@
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "core/loader/loader.h"
+#include "core/perf_stats.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
@@ -26,6 +27,8 @@ MICROPROFILE_DEFINE(OpenGL_GS, "OpenGL", "Geometry Shader Setup", MP_RGB(128, 19
 MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Display, "OpenGL", "Display", MP_RGB(128, 128, 192));
 
+using VideoCore::GeometryCache;
+using VideoCore::LutSlotCache;
 using VideoCore::SurfaceType;
 using namespace Common::Literals;
 using namespace Pica::Shader::Generator;
@@ -86,12 +89,13 @@ RasterizerOpenGL::RasterizerOpenGL(Memory::MemorySystem& memory, Pica::PicaCore&
                                    VideoCore::RendererBase& renderer, Driver& driver_)
     : VideoCore::RasterizerAccelerated{memory, pica}, driver{driver_},
       render_window{renderer.GetRenderWindow()}, runtime{driver, renderer},
-      res_cache{memory, custom_tex_manager, runtime, regs, renderer},
+      res_cache{memory, custom_tex_manager, runtime, regs, renderer, pica.runtime_settings},
       vertex_buffer{driver, GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE},
       uniform_buffer{driver, GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE},
       index_buffer{driver, GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE},
       texture_buffer{driver, GL_TEXTURE_BUFFER, TextureBufferSize(driver, false)},
-      texture_lf_buffer{driver, GL_TEXTURE_BUFFER, TextureBufferSize(driver, true)} {
+      texture_lf_buffer{driver, GL_TEXTURE_BUFFER, TextureBufferSize(driver, true)},
+      geometry_buffer{driver, GL_ARRAY_BUFFER, GeometryCache::BUFFER_SIZE} {
 
     // Clipping plane 0 is always enabled for PICA fixed clip plane z <= 0
     state.clip_distance[0] = true;
@@ -172,6 +176,10 @@ void RasterizerOpenGL::TickFrame() {
     res_cache.TickFrame();
 }
 
+u64 RasterizerOpenGL::GetTextureMemoryUsage() const {
+    return res_cache.GetTextureMemoryUsage();
+}
+
 void RasterizerOpenGL::LoadDefaultDiskResources(
     const std::atomic_bool& stop_loading, const VideoCore::DiskResourceLoadCallback& callback) {
     // First element in vector is the default one and cannot be removed.
@@ -230,6 +238,7 @@ void RasterizerOpenGL::SwitchDiskResources(u64 title_id) {
     bool prev_applet = curr_shader_manager ? is_applet(curr_shader_manager->GetProgramID()) : false;
     bool new_applet = is_applet(shader_managers[new_pos]->GetProgramID());
     curr_shader_manager = shader_managers[new_pos];
+    fs_config_dirty = true;
 
     if (prev_applet) {
         // If we came from an applet, clean up all other applets
@@ -256,6 +265,9 @@ void RasterizerOpenGL::SwitchDiskResources(u64 title_id) {
 
 void RasterizerOpenGL::SyncDrawState() {
     SyncDrawUniforms();
+    if (!std::exchange(fixed_state_dirty, false)) {
+        return;
+    }
 
     // SyncClipEnabled();
     state.clip_distance[1] = regs.rasterizer.clip_enable != 0;
@@ -370,7 +382,6 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
     PAddr base_address = vertex_attributes.GetPhysicalBaseAddress();
 
     state.draw.vertex_array = hw_vao.handle;
-    state.draw.vertex_buffer = vertex_buffer.GetHandle();
     state.Apply();
 
     std::array<bool, 16> enable_attributes{};
@@ -380,6 +391,38 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
             continue;
         }
 
+        const PAddr data_addr =
+            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
+
+        const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+        const u32 data_size = loader.byte_count * vertex_num;
+
+        // Static meshes are read from their upload to the geometry buffer by an earlier draw
+        const GeometryCache::Key key = {
+            .addr = data_addr,
+            .size = data_size,
+            .format = GeometryCache::VertexFormat(loader.byte_count, loader.byte_count),
+        };
+        GLintptr loader_offset = buffer_offset;
+        GLuint loader_buffer = vertex_buffer.GetHandle();
+        if (const auto cached_offset = geometry_cache.Find(res_cache, key)) {
+            loader_offset = *cached_offset;
+            loader_buffer = geometry_buffer.GetHandle();
+        } else {
+            res_cache.FlushRegion(data_addr, data_size);
+            const u8* data = memory.GetPhysicalPointer(data_addr);
+            if (geometry_cache.Reserve(res_cache, key, data_size)) {
+                loader_offset = UploadGeometry(key, data, data_size);
+                loader_buffer = geometry_buffer.GetHandle();
+            } else {
+                std::memcpy(array_ptr, data, data_size);
+                array_ptr += data_size;
+                buffer_offset += data_size;
+            }
+        }
+        state.draw.vertex_buffer = loader_buffer;
+        state.Apply();
+
         u32 offset = 0;
         for (u32 comp = 0; comp < loader.component_count && comp < 12; ++comp) {
             u32 attribute_index = loader.GetComponent(comp);
@@ -393,7 +436,7 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                     GLenum type = MakeAttributeType(vertex_attributes.GetFormat(attribute_index));
                     GLsizei stride = loader.byte_count;
                     glVertexAttribPointer(input_reg, size, type, GL_FALSE, stride,
-                                          reinterpret_cast<GLvoid*>(buffer_offset + offset));
+                                          reinterpret_cast<GLvoid*>(loader_offset + offset));
                     enable_attributes[input_reg] = true;
 
                     offset += vertex_attributes.GetStride(attribute_index);
@@ -405,20 +448,11 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                 offset += (attribute_index - 11) * 4;
             }
         }
-
-        const PAddr data_addr =
-            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
-
-        const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
-        const u32 data_size = loader.byte_count * vertex_num;
-
-        res_cache.FlushRegion(data_addr, data_size);
-        std::memcpy(array_ptr, memory.GetPhysicalPointer(data_addr), data_size);
-
-        array_ptr += data_size;
-        buffer_offset += data_size;
     }
 
+    state.draw.vertex_buffer = vertex_buffer.GetHandle();
+    state.Apply();
+
     for (std::size_t i = 0; i < enable_attributes.size(); ++i) {
         if (enable_attributes[i] != hw_vao_enabled_attributes[i]) {
             if (enable_attributes[i]) {
@@ -440,6 +474,32 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
     }
 }
 
+GLintptr RasterizerOpenGL::UploadGeometry(const GeometryCache::Key& key, const u8* data,
+                                          u32 size) {
+    state.draw.vertex_buffer = geometry_buffer.GetHandle();
+    state.Apply();
+
+    const auto [buffer_ptr, buffer_offset, invalidate] = geometry_buffer.Map(size, 4);
+    if (invalidate) {
+        geometry_cache.Invalidate();
+    }
+    std::memcpy(buffer_ptr, data, size);
+    geometry_buffer.Unmap(size);
+
+    geometry_cache.Insert(key, static_cast<u32>(buffer_offset), size);
+    return buffer_offset;
+}
+
+void RasterizerOpenGL::WrapGeometryBuffer() {
+    state.draw.vertex_buffer = geometry_buffer.GetHandle();
+    state.Apply();
+
+    // Mapping the whole buffer makes it start over from the beginning
+    std::ignore = geometry_buffer.Map(GeometryCache::BUFFER_SIZE, 0);
+    geometry_buffer.Unmap(0);
+    geometry_cache.Invalidate();
+}
+
 bool RasterizerOpenGL::SetupVertexShader() {
     MICROPROFILE_SCOPE(OpenGL_VS);
     return curr_shader_manager->UseProgrammableVertexShader(regs, pica.vs_setup, accurate_mul);
@@ -495,6 +555,10 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
         return false;
     }
 
+    if (geometry_cache.TakePendingWrap()) {
+        WrapGeometryBuffer();
+    }
+
     state.draw.vertex_buffer = vertex_buffer.GetHandle();
     state.Apply();
 
@@ -516,17 +580,37 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
             return false;
         }
 
-        const u8* index_data =
-            memory.GetPhysicalPointer(regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
-                                      regs.pipeline.index_array.offset);
-        std::tie(buffer_ptr, buffer_offset, std::ignore) = index_buffer.Map(index_buffer_size, 4);
-        std::memcpy(buffer_ptr, index_data, index_buffer_size);
-        index_buffer.Unmap(index_buffer_size);
+        const PAddr index_addr = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
+                                 regs.pipeline.index_array.offset;
+        const u8* index_data = memory.GetPhysicalPointer(index_addr);
+        const GeometryCache::Key key = {
+            .addr = index_addr,
+            .size = static_cast<u32>(index_buffer_size),
+            .format = GeometryCache::IndexFormat(index_u16, index_u16),
+        };
+        std::optional<GLintptr> geometry_offset = geometry_cache.Find(res_cache, key);
+        if (!geometry_offset && geometry_cache.Reserve(res_cache, key, key.size)) {
+            geometry_offset = UploadGeometry(key, index_data, key.size);
+        }
+
+        if (geometry_offset) {
+            buffer_offset = *geometry_offset;
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry_buffer.GetHandle());
+        } else {
+            std::tie(buffer_ptr, buffer_offset, std::ignore) =
+                index_buffer.Map(index_buffer_size, 4);
+            std::memcpy(buffer_ptr, index_data, index_buffer_size);
+            index_buffer.Unmap(index_buffer_size);
+        }
 
         glDrawRangeElementsBaseVertex(
             primitive_mode, vs_input_index_min, vs_input_index_max, regs.pipeline.num_vertices,
             index_u16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
             reinterpret_cast<const void*>(buffer_offset), -static_cast<GLint>(vs_input_index_min));
+
+        if (geometry_offset) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer.GetHandle());
+        }
     } else {
         glDrawArrays(primitive_mode, 0, regs.pipeline.num_vertices);
     }
@@ -541,6 +625,7 @@ void RasterizerOpenGL::DrawTriangles() {
 
 bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
+    Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::RasterizerSubmit};
     SyncDrawState();
 
     const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
@@ -568,6 +653,12 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         return true;
     }
 
+    // The surfaces are still invalidated as if drawn to when fb_helper goes out of scope
+    if (skip_frame && res_cache.CanSkipDraw(*framebuffer)) {
+        vertex_batch.clear();
+        return true;
+    }
+
     // Bind the framebuffer surfaces
     if (shadow_rendering) {
         state.image_shadow_buffer = framebuffer->Attachment(SurfaceType::Color);
@@ -607,7 +698,8 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     state.Apply();
 
     // Sync and bind the shader
-    curr_shader_manager->UseFragmentShader(regs, user_config);
+    curr_shader_manager->UseFragmentShader(regs, user_config,
+                                           std::exchange(fs_config_dirty, false));
 
     // Sync the LUTs within the texture buffer
     SyncAndUploadLUTs();
@@ -809,6 +901,7 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
 }
 
 void RasterizerOpenGL::ClearAll(bool flush) {
+    geometry_cache.Clear(res_cache);
     res_cache.ClearAll(flush);
 }
 
@@ -877,12 +970,19 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
         return;
     }
 
+    // Only LUTs whose contents are not in the buffer yet are converted and uploaded
+    RebindCachedLUTsLF();
+    if (!pica.lighting.lut_dirty && !pica.fog.lut_dirty) {
+        return;
+    }
+
     std::size_t bytes_used = 0;
     glBindBuffer(GL_TEXTURE_BUFFER, texture_lf_buffer.GetHandle());
     const auto [buffer, offset, invalidate] =
         texture_lf_buffer.Map(max_size, sizeof(Common::Vec4f));
 
     if (invalidate) {
+        lut_lf_slots.Clear();
         pica.lighting.lut_dirty = pica.lighting.LutAllDirty;
         pica.fog.lut_dirty = true;
     }
@@ -897,8 +997,10 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
         for (u32 i = 0; i < source_lut.size(); i++) {
             new_data[i] = {source_lut[i].ToFloat(), source_lut[i].DiffToFloat()};
         }
-        fs_data.lighting_lut_offset[index / 4][index % 4] =
-            static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        const int lut_offset = static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        fs_data.lighting_lut_offset[index / 4][index % 4] = lut_offset;
+        lut_lf_slots.Insert(LutSlotCache::Key(source_lut, LutSlotCache::Format::Lighting),
+                            lut_offset);
         fs_data_dirty = true;
         bytes_used += source_lut.size() * sizeof(Common::Vec2f);
     }
@@ -910,6 +1012,8 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
             new_data[i] = {pica.fog.lut[i].ToFloat(), pica.fog.lut[i].DiffToFloat()};
         }
         fs_data.fog_lut_offset = static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        lut_lf_slots.Insert(LutSlotCache::Key(pica.fog.lut, LutSlotCache::Format::Fog),
+                            fs_data.fog_lut_offset);
         fs_data_dirty = true;
         bytes_used += pica.fog.lut.size() * sizeof(Common::Vec2f);
         pica.fog.lut_dirty = false;
@@ -928,11 +1032,18 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
         return;
     }
 
+    // Only LUTs whose contents are not in the buffer yet are converted and uploaded
+    RebindCachedLUTs();
+    if (!pica.proctex.table_dirty) {
+        return;
+    }
+
     std::size_t bytes_used = 0;
     glBindBuffer(GL_TEXTURE_BUFFER, texture_buffer.GetHandle());
     const auto [buffer, offset, invalidate] = texture_buffer.Map(max_size, sizeof(Common::Vec4f));
 
     if (invalidate) {
+        lut_slots.Clear();
         pica.proctex.table_dirty = pica.proctex.TableAllDirty;
     }
 
@@ -943,6 +1054,7 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
             new_data[i] = {lut[i].ToFloat(), lut[i].DiffToFloat()};
         }
         lut_offset = static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        lut_slots.Insert(LutSlotCache::Key(lut, LutSlotCache::Format::ProcTexValue), lut_offset);
         fs_data_dirty = true;
         bytes_used += lut.size() * sizeof(Common::Vec2f);
     };
@@ -970,6 +1082,9 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
         }
         fs_data.proctex_lut_offset =
             static_cast<int>((offset + bytes_used) / sizeof(Common::Vec4f));
+        lut_slots.Insert(
+            LutSlotCache::Key(pica.proctex.color_table, LutSlotCache::Format::ProcTexColor),
+            fs_data.proctex_lut_offset);
         fs_data_dirty = true;
         bytes_used += pica.proctex.color_table.size() * sizeof(Common::Vec4f);
     }
@@ -982,6 +1097,9 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
         }
         fs_data.proctex_diff_lut_offset =
             static_cast<int>((offset + bytes_used) / sizeof(Common::Vec4f));
+        lut_slots.Insert(LutSlotCache::Key(pica.proctex.color_diff_table,
+                                           LutSlotCache::Format::ProcTexColorDifference),
+                         fs_data.proctex_diff_lut_offset);
         fs_data_dirty = true;
         bytes_used += pica.proctex.color_diff_table.size() * sizeof(Common::Vec4f);
     }
@@ -1025,12 +1143,10 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     }
 
     if (sync_vs_pica || invalidate) {
-        VSPicaUniformData vs_uniforms;
-        vs_uniforms.SetFromRegs(pica.vs_setup);
-        std::memcpy(uniforms + used_bytes, &vs_uniforms, sizeof(vs_uniforms));
+        SyncVSPicaUniforms();
+        std::memcpy(uniforms + used_bytes, &vs_pica_data, sizeof(vs_pica_data));
         glBindBufferRange(GL_UNIFORM_BUFFER, UniformBindings::VSPicaData,
-                          uniform_buffer.GetHandle(), offset + used_bytes, sizeof(vs_uniforms));
-        pica.vs_setup.uniforms_dirty = false;
+                          uniform_buffer.GetHandle(), offset + used_bytes, sizeof(vs_pica_data));
         used_bytes += uniform_size_aligned_vs_pica;
     }
 
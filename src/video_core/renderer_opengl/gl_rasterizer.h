@@ -40,6 +40,7 @@ public:
     ~RasterizerOpenGL() override;
 
     void TickFrame();
+    u64 GetTextureMemoryUsage() const;
     void LoadDefaultDiskResources(const std::atomic_bool& stop_loading,
                                   const VideoCore::DiskResourceLoadCallback& callback) override;
     void SwitchDiskResources(u64 title_id) override;
@@ -96,6 +97,13 @@ private:
     void SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
                           GLuint vs_input_index_max);
 
+    /// Copies vertex or index data whose range the geometry cache reserved into the geometry
+    /// buffer and returns the offset of the copy
+    GLintptr UploadGeometry(const VideoCore::GeometryCache::Key& key, const u8* data, u32 size);
+
+    /// Starts the geometry buffer over from the beginning once it is full
+    void WrapGeometryBuffer();
+
     /// Setup vertex shader for AccelerateDrawBatch
     bool SetupVertexShader();
 
@@ -120,6 +128,7 @@ private:
     OGLStreamBuffer index_buffer;
     OGLStreamBuffer texture_buffer;
     OGLStreamBuffer texture_lf_buffer;
+    OGLStreamBuffer geometry_buffer;
     GLint uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs_pica;
     std::size_t uniform_size_aligned_vs;
@@ -6,6 +6,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <cstring>
 #include <fmt/format.h>
 
@@ -14,9 +15,12 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/mapped_file.h"
 #include "common/scm_rev.h"
 #include "common/settings.h"
+#include "common/task_scheduler.h"
 #include "common/zstd_compression.h"
+#include "video_core/pica/shader_setup.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 
 namespace OpenGL {
@@ -35,6 +39,26 @@ enum class PrecompiledEntryKind : u32 {
 
 constexpr u32 NativeVersion = 1;
 
+constexpr std::array<u8, 4> PrecompiledMagic = {'G', 'L', 'P', 'C'};
+constexpr u32 PrecompiledVersion = 2;
+
+struct PrecompiledHeader {
+    std::array<u8, 4> magic;
+    u32 version;
+    ShaderCacheVersionHash hash;
+};
+static_assert(sizeof(PrecompiledHeader) == 72, "PrecompiledHeader has incorrect size!");
+
+/// Header of a precompiled entry, followed by its data compressed in a zstd frame of its own
+struct PrecompiledEntryHeader {
+    PrecompiledEntryKind kind;
+    u32 param; ///< sanitize_mul of decompiled entries, binary format of dumps
+    u64 unique_identifier;
+    u32 compressed_size;
+    u32 size;
+};
+static_assert(sizeof(PrecompiledEntryHeader) == 24, "PrecompiledEntryHeader has incorrect size!");
+
 // The hash is based on relevant files. The list of files can be found at src/common/CMakeLists.txt
 // and CMakeModules/GenerateSCMRev.cmake
 ShaderCacheVersionHash GetShaderCacheVersionHash() {
@@ -44,34 +68,42 @@ ShaderCacheVersionHash GetShaderCacheVersionHash() {
     return hash;
 }
 
+PrecompiledHeader MakePrecompiledHeader() {
+    return PrecompiledHeader{
+        .magic = PrecompiledMagic,
+        .version = PrecompiledVersion,
+        .hash = GetShaderCacheVersionHash(),
+    };
+}
+
 ShaderDiskCacheRaw::ShaderDiskCacheRaw(u64 unique_identifier, ProgramType program_type,
                                        RawShaderConfig config, ProgramCode program_code)
     : unique_identifier{unique_identifier}, program_type{program_type}, config{config},
       program_code{std::move(program_code)} {}
 
-bool ShaderDiskCacheRaw::Load(FileUtil::IOFile& file) {
-    if (file.ReadBytes(&unique_identifier, sizeof(u64)) != sizeof(u64) ||
-        file.ReadBytes(&program_type, sizeof(u32)) != sizeof(u32)) {
+bool ShaderDiskCacheRaw::Load(ShaderDiskCacheReader& reader) {
+    if (!reader.ReadObject(unique_identifier) || !reader.ReadObject(program_type)) {
         return false;
     }
 
     u64 reg_array_len{};
-    if (file.ReadBytes(&reg_array_len, sizeof(u64)) != sizeof(u64)) {
+    if (!reader.ReadObject(reg_array_len) || reg_array_len > config.reg_array.size()) {
         return false;
     }
 
-    if (file.ReadArray(config.reg_array.data(), reg_array_len) != reg_array_len) {
+    if (!reader.ReadArray(config.reg_array.data(), reg_array_len)) {
         return false;
     }
 
     // Read in type specific configuration
     if (program_type == ProgramType::VS) {
         u64 code_len{};
-        if (file.ReadBytes(&code_len, sizeof(u64)) != sizeof(u64)) {
+        constexpr u64 max_code_len = Pica::MAX_PROGRAM_CODE_LENGTH + Pica::MAX_SWIZZLE_DATA_LENGTH;
+        if (!reader.ReadObject(code_len) || code_len > max_code_len) {
             return false;
         }
         program_code.resize(code_len);
-        if (file.ReadArray(program_code.data(), code_len) != code_len) {
+        if (!reader.ReadArray(program_code.data(), code_len)) {
             return false;
         }
     }
@@ -108,8 +140,7 @@ bool ShaderDiskCacheRaw::Save(FileUtil::IOFile& file) const {
 
 ShaderDiskCache::ShaderDiskCache(u64 program_id, bool separable)
     : separable{separable}, program_id{program_id}, transferable_file(AppendTransferableFile()),
-      // seperable shaders use the virtual precompile file, that already has a header.
-      precompiled_file(AppendPrecompiledFile(!separable)) {}
+      precompiled_file(AppendPrecompiledFile()) {}
 
 std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable() {
     const bool has_title_id = GetProgramID() != 0;
@@ -125,8 +156,17 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         return std::nullopt;
     }
 
+    // The entries are parsed from a mapping of the file instead of being read one by one
+    Common::MappedFile mapping;
+    if (!mapping.Open(transferable_file)) {
+        LOG_ERROR(Render_OpenGL, "Failed to map transferable cache for title id={}",
+                  GetTitleID());
+        return std::nullopt;
+    }
+    ShaderDiskCacheReader reader{mapping.Data()};
+
     u32 version{};
-    if (transferable_file.ReadBytes(&version, sizeof(version)) != sizeof(version)) {
+    if (!reader.ReadObject(version)) {
         LOG_ERROR(Render_OpenGL,
                   "Failed to get transferable cache version for title id={} - removing",
                   GetTitleID());
@@ -147,9 +187,9 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
 
     // Version is valid, load the shaders
     std::vector<ShaderDiskCacheRaw> raws;
-    while (transferable_file.Tell() < transferable_file.GetSize()) {
+    while (!reader.IsAtEnd()) {
         TransferableEntryKind kind{};
-        if (transferable_file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
+        if (!reader.ReadObject(kind)) {
             LOG_ERROR(Render_OpenGL, "Failed to read transferable file - removing");
             InvalidateAll();
             return std::nullopt;
@@ -158,7 +198,7 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
         switch (kind) {
         case TransferableEntryKind::Raw: {
             ShaderDiskCacheRaw entry;
-            if (!entry.Load(transferable_file)) {
+            if (!entry.Load(reader)) {
                 LOG_ERROR(Render_OpenGL, "Failed to load transferable raw entry - removing");
                 InvalidateAll();
                 return std::nullopt;
@@ -180,17 +220,17 @@ std::optional<std::vector<ShaderDiskCacheRaw>> ShaderDiskCache::LoadTransferable
 }
 
 std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>
-ShaderDiskCache::LoadPrecompiled(bool compressed) {
+ShaderDiskCache::LoadPrecompiled() {
     if (!IsUsable())
         return {};
 
-    if (precompiled_file.GetSize() == 0) {
+    if (precompiled_file.GetSize() <= sizeof(PrecompiledHeader)) {
         LOG_INFO(Render_OpenGL, "No precompiled shader cache found for game with title id={}",
                  GetTitleID());
         return {};
     }
 
-    const auto result = LoadPrecompiledFile(precompiled_file, compressed);
+    const auto result = LoadPrecompiledFile(precompiled_file);
     if (!result) {
         LOG_INFO(Render_OpenGL,
                  "Failed to load precompiled cache for game with title id={} - removing",
@@ -202,77 +242,106 @@ ShaderDiskCache::LoadPrecompiled(bool compressed) {
 }
 
 std::optional<std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>>
-ShaderDiskCache::LoadPrecompiledFile(FileUtil::IOFile& file, bool compressed) {
-    // Read compressed file from disk and decompress to virtual precompiled cache file
-    std::vector<u8, Common::AlignedAllocator<u8>> precompiled_file(file.GetSize());
-    file.ReadBytes(precompiled_file.data(), precompiled_file.size());
-    if (compressed) {
-    auto decompressed =
-            Common::Compression::DecompressDataZSTDAligned(std::span<const u8>(precompiled_file.data(), precompiled_file.size()));
-        if (decompressed.empty()) {
-            LOG_ERROR(Render_OpenGL, "Could not decompress precompiled shader cache.");
-            return std::nullopt;
-        }
-        SaveArrayToPrecompiled(decompressed.data(), decompressed.size());
-    } else {
-        SaveArrayToPrecompiled(precompiled_file.data(), precompiled_file.size());
+ShaderDiskCache::LoadPrecompiledFile(FileUtil::IOFile& file) {
+    Common::MappedFile mapping;
+    if (!mapping.Open(file)) {
+        LOG_ERROR(Render_OpenGL, "Could not map precompiled shader cache.");
+        return std::nullopt;
     }
+    ShaderDiskCacheReader reader{mapping.Data()};
 
-    decompressed_precompiled_cache_offset = 0;
-
-    ShaderCacheVersionHash file_hash{};
-    if (!LoadArrayFromPrecompiled(file_hash.data(), file_hash.size())) {
+    PrecompiledHeader header;
+    if (!reader.ReadObject(header) || header.magic != PrecompiledMagic ||
+        header.version != PrecompiledVersion) {
+        LOG_INFO(Render_OpenGL, "Precompiled cache has an old format");
         return std::nullopt;
     }
-    if (GetShaderCacheVersionHash() != file_hash) {
+    if (GetShaderCacheVersionHash() != header.hash) {
         LOG_INFO(Render_OpenGL, "Precompiled cache is from another version of the emulator");
         return std::nullopt;
     }
 
-    std::unordered_map<u64, ShaderDiskCacheDecompiled> decompiled;
-    ShaderDumpsMap dumps;
-    while (decompressed_precompiled_cache_offset < decompressed_precompiled_cache.size()) {
-        PrecompiledEntryKind kind{};
-        if (!LoadObjectFromPrecompiled(kind)) {
+    // The entry headers are walked first, the entries point into the mapping until they are
+    // decompressed
+    struct PendingEntry {
+        PrecompiledEntryHeader header;
+        std::span<const u8> compressed;
+        std::vector<u8, Common::AlignedAllocator<u8>> data;
+    };
+    // An interrupted write leaves a partial entry at the end of the file, the entries before it
+    // are kept
+    std::vector<PendingEntry> entries;
+    std::size_t complete_size = reader.GetOffset();
+    bool truncated = false;
+    while (!reader.IsAtEnd()) {
+        PendingEntry entry;
+        if (!reader.ReadObject(entry.header)) {
+            truncated = true;
+            break;
+        }
+        entry.compressed = reader.ReadSpan(entry.header.compressed_size);
+        if (entry.compressed.size() != entry.header.compressed_size) {
+            truncated = true;
+            break;
+        }
+        entries.push_back(std::move(entry));
+        complete_size = reader.GetOffset();
+    }
+
+    // Each entry is a zstd frame of its own, so they are decompressed in parallel
+    auto& task_scheduler = Common::GetTaskScheduler();
+    const std::size_t num_workers{std::max<std::size_t>(
+        std::min(task_scheduler.NumWorkers(), entries.size()), 1)};
+    const std::size_t bucket_size{entries.size() / num_workers};
+    std::atomic_bool decompression_failed = false;
+    {
+        Common::TaskGroup group{task_scheduler};
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            const std::size_t begin{bucket_size * i};
+            const std::size_t end{i + 1 == num_workers ? entries.size() : begin + bucket_size};
+            group.Run([&entries, &decompression_failed, begin, end] {
+                for (std::size_t j = begin; j < end && !decompression_failed; ++j) {
+                    PendingEntry& entry = entries[j];
+                    entry.data = Common::Compression::DecompressDataZSTDAligned(entry.compressed);
+                    if (entry.data.size() != entry.header.size) {
+                        decompression_failed = true;
+                    }
+                }
+            });
+        }
+        group.Wait();
+    }
+    if (decompression_failed) {
+        LOG_ERROR(Render_OpenGL, "Could not decompress precompiled shader cache.");
+        return std::nullopt;
+    }
+
+    // New entries are appended, so the partial one is cut off for them to follow the complete ones
+    if (truncated) {
+        LOG_WARNING(Render_OpenGL, "Precompiled cache ends with a truncated entry - dropping it");
+        mapping.Close();
+        if (!file.Resize(complete_size)) {
             return std::nullopt;
         }
+    }
 
-        switch (kind) {
+    std::unordered_map<u64, ShaderDiskCacheDecompiled> decompiled;
+    ShaderDumpsMap dumps;
+    for (PendingEntry& entry : entries) {
+        const u64 unique_identifier = entry.header.unique_identifier;
+        switch (entry.header.kind) {
         case PrecompiledEntryKind::Decompiled: {
-            u64 unique_identifier{};
-            if (!LoadObjectFromPrecompiled(unique_identifier)) {
-                return std::nullopt;
-            }
-
-            auto entry = LoadDecompiledEntry();
-            if (!entry) {
-                return std::nullopt;
-            }
-            decompiled.insert({unique_identifier, std::move(*entry)});
+            ShaderDiskCacheDecompiled decompiled_entry;
+            decompiled_entry.code.assign(entry.data.begin(), entry.data.end());
+            decompiled_entry.sanitize_mul = entry.header.param != 0;
+            decompiled.insert({unique_identifier, std::move(decompiled_entry)});
             break;
         }
         case PrecompiledEntryKind::Dump: {
-            u64 unique_identifier;
-            if (!LoadObjectFromPrecompiled(unique_identifier)) {
-                return std::nullopt;
-            }
-
             ShaderDiskCacheDump dump;
-            if (!LoadObjectFromPrecompiled(dump.binary_format)) {
-                return std::nullopt;
-            }
-
-            u32 binary_length{};
-            if (!LoadObjectFromPrecompiled(binary_length)) {
-                return std::nullopt;
-            }
-
-            dump.binary.resize(binary_length);
-            if (!LoadArrayFromPrecompiled(dump.binary.data(), dump.binary.size())) {
-                return std::nullopt;
-            }
-
-            dumps.insert({unique_identifier, dump});
+            dump.binary_format = entry.header.param;
+            dump.binary = std::move(entry.data);
+            dumps.insert({unique_identifier, std::move(dump)});
             break;
         }
         default:
@@ -283,57 +352,29 @@ ShaderDiskCache::LoadPrecompiledFile(FileUtil::IOFile& file, bool compressed) {
     LOG_INFO(Render_OpenGL,
              "Found a precompiled disk cache with {} decompiled entries and {} binary entries",
              decompiled.size(), dumps.size());
-    return {{decompiled, dumps}};
-}
-
-std::optional<ShaderDiskCacheDecompiled> ShaderDiskCache::LoadDecompiledEntry() {
-
-    bool sanitize_mul;
-    if (!LoadObjectFromPrecompiled(sanitize_mul)) {
-        return std::nullopt;
-    }
-
-    u32 code_size{};
-    if (!LoadObjectFromPrecompiled(code_size)) {
-        return std::nullopt;
-    }
-
-    std::string code(code_size, '\0');
-    if (!LoadArrayFromPrecompiled(code.data(), code.size())) {
-        return std::nullopt;
-    }
-
-    ShaderDiskCacheDecompiled entry;
-    entry.code = std::move(code);
-    entry.sanitize_mul = sanitize_mul;
-
-    return entry;
+    return {{std::move(decompiled), std::move(dumps)}};
 }
 
-void ShaderDiskCache::SaveDecompiledToFile(FileUtil::IOFile& file, u64 unique_identifier,
-                                           const std::string& code, bool sanitize_mul) {
-    if (!IsUsable())
-        return;
-
-    if (file.WriteObject(static_cast<u32>(PrecompiledEntryKind::Decompiled)) != 1 ||
-        file.WriteObject(unique_identifier) != 1 || file.WriteObject(sanitize_mul) != 1 ||
-        file.WriteObject(static_cast<u32>(code.size())) != 1 ||
-        file.WriteArray(code.data(), code.size()) != code.size()) {
-        LOG_ERROR(Render_OpenGL, "Failed to save decompiled cache entry - removing");
-        file.Close();
-        InvalidatePrecompiled();
-    }
-}
+bool ShaderDiskCache::AppendPrecompiledEntry(u32 kind, u64 unique_identifier, u32 param,
+                                             std::span<const u8> data) {
+    const auto compressed = Common::Compression::CompressDataZSTDDefault(data);
+    const PrecompiledEntryHeader header{
+        .kind = static_cast<PrecompiledEntryKind>(kind),
+        .param = param,
+        .unique_identifier = unique_identifier,
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .size = static_cast<u32>(data.size()),
+    };
 
-bool ShaderDiskCache::SaveDecompiledToCache(u64 unique_identifier, const std::string& code,
-                                            bool sanitize_mul) {
-    if (!SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Decompiled)) ||
-        !SaveObjectToPrecompiled(unique_identifier) || !SaveObjectToPrecompiled(sanitize_mul) ||
-        !SaveObjectToPrecompiled(static_cast<u32>(code.size())) ||
-        !SaveArrayToPrecompiled(code.data(), code.size())) {
+    // The entry is written at once so that an interrupted write only truncates the last entry,
+    // which LoadPrecompiledFile drops
+    std::vector<u8> entry(sizeof(header) + compressed.size());
+    std::memcpy(entry.data(), &header, sizeof(header));
+    std::memcpy(entry.data() + sizeof(header), compressed.data(), compressed.size());
+    if (precompiled_file.WriteBytes(entry.data(), entry.size()) != entry.size()) {
         return false;
     }
-
+    precompiled_file.Flush();
     return true;
 }
 
@@ -349,14 +390,11 @@ void ShaderDiskCache::InvalidateAll() {
 }
 
 void ShaderDiskCache::InvalidatePrecompiled() {
-    // Clear virtual precompiled cache file
-    decompressed_precompiled_cache.resize(0);
-
     precompiled_file.Close();
     if (!FileUtil::Delete(GetPrecompiledPath())) {
         LOG_ERROR(Render_OpenGL, "Failed to invalidate precompiled file={}", GetPrecompiledPath());
     }
-    precompiled_file = AppendPrecompiledFile(!separable);
+    precompiled_file = AppendPrecompiledFile();
 }
 
 void ShaderDiskCache::SaveRaw(const ShaderDiskCacheRaw& entry) {
@@ -384,11 +422,9 @@ void ShaderDiskCache::SaveDecompiled(u64 unique_identifier, const std::string& c
     if (!IsUsable())
         return;
 
-    if (decompressed_precompiled_cache.empty()) {
-        SavePrecompiledHeaderToVirtualPrecompiledCache();
-    }
-
-    if (!SaveDecompiledToCache(unique_identifier, code, sanitize_mul)) {
+    if (!AppendPrecompiledEntry(static_cast<u32>(PrecompiledEntryKind::Decompiled),
+                                unique_identifier, sanitize_mul,
+                                {reinterpret_cast<const u8*>(code.data()), code.size()})) {
         LOG_ERROR(Render_OpenGL,
                   "Failed to save decompiled entry to the precompiled file - removing");
         InvalidatePrecompiled();
@@ -406,15 +442,11 @@ void ShaderDiskCache::SaveDump(u64 unique_identifier, GLuint program) {
     std::vector<u8, Common::AlignedAllocator<u8>> binary(binary_length);
     glGetProgramBinary(program, binary_length, nullptr, &binary_format, binary.data());
 
-    if (!SaveObjectToPrecompiled(static_cast<u32>(PrecompiledEntryKind::Dump)) ||
-        !SaveObjectToPrecompiled(unique_identifier) ||
-        !SaveObjectToPrecompiled(static_cast<u32>(binary_format)) ||
-        !SaveObjectToPrecompiled(static_cast<u32>(binary_length)) ||
-        !SaveArrayToPrecompiled(binary.data(), binary.size())) {
+    if (!AppendPrecompiledEntry(static_cast<u32>(PrecompiledEntryKind::Dump), unique_identifier,
+                                static_cast<u32>(binary_format), binary)) {
         LOG_ERROR(Render_OpenGL, "Failed to save binary program file in shader={:016x} - removing",
                   unique_identifier);
         InvalidatePrecompiled();
-        return;
     }
 }
 
@@ -422,29 +454,11 @@ void ShaderDiskCache::SaveDumpToFile(u64 unique_identifier, GLuint program, bool
     if (!IsUsable())
         return;
 
-    GLint binary_length{};
-    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
-
-    GLenum binary_format{};
-    std::vector<u8, Common::AlignedAllocator<u8>> binary(binary_length);
-    glGetProgramBinary(program, binary_length, nullptr, &binary_format, binary.data());
-
-    if (precompiled_file.WriteObject(static_cast<u32>(PrecompiledEntryKind::Dump)) != 1 ||
-        precompiled_file.WriteObject(unique_identifier) != 1 ||
-        precompiled_file.WriteObject(static_cast<u32>(binary_format)) != 1 ||
-        precompiled_file.WriteObject(static_cast<u32>(binary_length)) != 1 ||
-        precompiled_file.WriteArray(binary.data(), binary.size()) != binary.size()) {
-        LOG_ERROR(Render_OpenGL, "Failed to save binary program file in shader={:016x} - removing",
-                  unique_identifier);
-        InvalidatePrecompiled();
-        return;
-    }
+    SaveDump(unique_identifier, program);
 
     // SaveDecompiled is used only to store the accurate multiplication setting, a better way is to
     // probably change the header in SaveDump
-    SaveDecompiledToFile(precompiled_file, unique_identifier, {}, sanitize_mul);
-
-    precompiled_file.Flush();
+    SaveDecompiled(unique_identifier, {}, sanitize_mul);
 }
 
 bool ShaderDiskCache::IsUsable() const {
@@ -474,12 +488,31 @@ FileUtil::IOFile ShaderDiskCache::AppendTransferableFile() {
     return file;
 }
 
-FileUtil::IOFile ShaderDiskCache::AppendPrecompiledFile(bool write_header) {
+FileUtil::IOFile ShaderDiskCache::AppendPrecompiledFile() {
     if (!EnsureDirectories())
         return {};
 
     const auto precompiled_path{GetPrecompiledPath()};
-    const bool existed = FileUtil::Exists(precompiled_path);
+    const auto header{MakePrecompiledHeader()};
+
+    // Entries are appended to the file as they are saved, so one of an older format or another
+    // version of the emulator is replaced before anything is written to it
+    if (FileUtil::Exists(precompiled_path)) {
+        PrecompiledHeader file_header{};
+        FileUtil::IOFile file(precompiled_path, "rb");
+        const bool matches = file.ReadBytes(&file_header, sizeof(file_header)) ==
+                                 sizeof(file_header) &&
+                             std::memcmp(&file_header, &header, sizeof(header)) == 0;
+        file.Close();
+        if (!matches) {
+            LOG_INFO(Render_OpenGL, "Precompiled cache has an old format - removing");
+            if (!FileUtil::Delete(precompiled_path)) {
+                LOG_ERROR(Render_OpenGL, "Failed to invalidate precompiled file={}",
+                          precompiled_path);
+                return {};
+            }
+        }
+    }
 
     FileUtil::IOFile file(precompiled_path, "ab+");
     if (!file.IsOpen()) {
@@ -487,49 +520,18 @@ FileUtil::IOFile ShaderDiskCache::AppendPrecompiledFile(bool write_header) {
         return {};
     }
 
-    // If the file didn't exist, write its version
-    if (write_header && (!existed || file.GetSize() == 0)) {
-        const auto hash{GetShaderCacheVersionHash()};
-        if (file.WriteArray(hash.data(), hash.size()) != hash.size()) {
+    // If the file didn't exist, write its header
+    if (file.GetSize() == 0) {
+        if (file.WriteObject(header) != 1) {
             LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache version in path={}",
                       precompiled_path);
             return {};
         }
+        file.Flush();
     }
     return file;
 }
 
-void ShaderDiskCache::SavePrecompiledHeaderToVirtualPrecompiledCache() {
-    const auto hash{GetShaderCacheVersionHash()};
-    if (!SaveArrayToPrecompiled(hash.data(), hash.size())) {
-        LOG_ERROR(
-            Render_OpenGL,
-            "Failed to write precompiled cache version hash to virtual precompiled cache file");
-    }
-}
-
-void ShaderDiskCache::SaveVirtualPrecompiledFile() {
-    decompressed_precompiled_cache_offset = 0;
-    const auto compressed =
-        Common::Compression::CompressDataZSTDDefault(decompressed_precompiled_cache);
-
-    const auto precompiled_path{GetPrecompiledPath()};
-
-    precompiled_file.Close();
-    if (!FileUtil::Delete(GetPrecompiledPath())) {
-        LOG_ERROR(Render_OpenGL, "Failed to invalidate precompiled file={}", GetPrecompiledPath());
-    }
-    precompiled_file = AppendPrecompiledFile(!separable);
-
-    if (precompiled_file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
-        LOG_ERROR(Render_OpenGL, "Failed to write precompiled cache version in path={}",
-                  precompiled_path);
-        return;
-    }
-
-    precompiled_file.Flush();
-}
-
 bool ShaderDiskCache::EnsureDirectories() const {
     const auto CreateDir = [](const std::string& dir) {
         if (!FileUtil::CreateDir(dir)) {
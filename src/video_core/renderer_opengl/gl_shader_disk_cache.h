@@ -8,7 +8,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -39,6 +42,46 @@ using ProgramType = Pica::Shader::Generator::ProgramType;
 using ShaderDecompiledMap = std::unordered_map<u64, ShaderDiskCacheDecompiled>;
 using ShaderDumpsMap = std::unordered_map<u64, ShaderDiskCacheDump>;
 
+/// Reads the entries of a cache file that was mapped to memory
+class ShaderDiskCacheReader {
+public:
+    explicit ShaderDiskCacheReader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    bool ReadArray(T* array, std::size_t length) {
+        if (length > (data.size() - offset) / sizeof(T)) {
+            return false;
+        }
+        std::memcpy(array, data.data() + offset, length * sizeof(T));
+        offset += length * sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool ReadObject(T& object) {
+        return ReadArray(&object, 1);
+    }
+
+    /// Returns the next size bytes without copying them, or fewer bytes at the end of the data
+    std::span<const u8> ReadSpan(std::size_t size) {
+        const std::span<const u8> span = data.subspan(offset, std::min(size, data.size() - offset));
+        offset += span.size();
+        return span;
+    }
+
+    bool IsAtEnd() const {
+        return offset == data.size();
+    }
+
+    std::size_t GetOffset() const {
+        return offset;
+    }
+
+private:
+    std::span<const u8> data;
+    std::size_t offset = 0;
+};
+
 /// Describes a shader how it's used by the guest GPU
 class ShaderDiskCacheRaw {
 public:
@@ -47,7 +90,7 @@ public:
     ShaderDiskCacheRaw() = default;
     ~ShaderDiskCacheRaw() = default;
 
-    bool Load(FileUtil::IOFile& file);
+    bool Load(ShaderDiskCacheReader& reader);
 
     bool Save(FileUtil::IOFile& file) const;
 
@@ -95,12 +138,12 @@ public:
     std::optional<std::vector<ShaderDiskCacheRaw>> LoadTransferable();
 
     /// Loads current game's precompiled cache. Invalidates on failure.
-    std::pair<ShaderDecompiledMap, ShaderDumpsMap> LoadPrecompiled(bool compressed);
+    std::pair<ShaderDecompiledMap, ShaderDumpsMap> LoadPrecompiled();
 
     /// Removes the transferable (and precompiled) cache file.
     void InvalidateAll();
 
-    /// Removes the precompiled cache file and clears virtual precompiled cache file.
+    /// Removes the precompiled cache file.
     void InvalidatePrecompiled();
 
     /// Saves a raw dump to the transferable file. Checks for collisions.
@@ -112,30 +155,21 @@ public:
     /// Saves a dump entry to the precompiled file. Does not check for collisions.
     void SaveDump(u64 unique_identifier, GLuint program);
 
-    /// Saves a dump entry to the precompiled file. Does not check for collisions.
+    /// Saves a dump entry of a linked program to the precompiled file, along with its
+    /// sanitize_mul setting. Does not check for collisions.
     void SaveDumpToFile(u64 unique_identifier, GLuint program, bool sanitize_mul);
 
-    /// Serializes virtual precompiled shader cache file to real file
-    void SaveVirtualPrecompiledFile();
-
     /// Get current game's title id as u64
     u64 GetProgramID() const;
 
 private:
-    /// Loads the transferable cache. Returns empty on failure.
+    /// Loads the precompiled cache. Returns empty on failure.
     std::optional<std::pair<ShaderDecompiledMap, ShaderDumpsMap>> LoadPrecompiledFile(
-        FileUtil::IOFile& file, bool compressed);
+        FileUtil::IOFile& file);
 
-    /// Loads a decompiled cache entry from m_precompiled_cache_virtual_file. Returns empty on
-    /// failure.
-    std::optional<ShaderDiskCacheDecompiled> LoadDecompiledEntry();
-
-    /// Saves a decompiled entry to the passed file. Does not check for collisions.
-    void SaveDecompiledToFile(FileUtil::IOFile& file, u64 unique_identifier,
-                              const std::string& code, bool sanitize_mul);
-
-    /// Saves a decompiled entry to the virtual precompiled cache. Does not check for collisions.
-    bool SaveDecompiledToCache(u64 unique_identifier, const std::string& code, bool sanitize_mul);
+    /// Compresses an entry and appends it to the precompiled file. Returns true on success.
+    bool AppendPrecompiledEntry(u32 kind, u64 unique_identifier, u32 param,
+                                std::span<const u8> data);
 
     /// Returns if the cache can be used
     bool IsUsable() const;
@@ -143,11 +177,9 @@ private:
     /// Opens current game's transferable file and write it's header if it doesn't exist.
     FileUtil::IOFile AppendTransferableFile();
 
-    /// Opens current game's precompiled file and write it's header if it doesn't exist
-    FileUtil::IOFile AppendPrecompiledFile(bool write_header);
-
-    /// Save precompiled header to precompiled_cache_in_memory
-    void SavePrecompiledHeaderToVirtualPrecompiledCache();
+    /// Opens current game's precompiled file and write it's header if it doesn't exist. A file
+    /// of an older format is replaced.
+    FileUtil::IOFile AppendPrecompiledFile();
 
     /// Create shader disk cache directories. Returns true on success.
     bool EnsureDirectories() const;
@@ -172,45 +204,6 @@ private:
     /// Get current game's title id
     std::string GetTitleID();
 
-    template <typename T>
-    bool SaveArrayToPrecompiled(const T* data, std::size_t length) {
-        const u8* data_view = reinterpret_cast<const u8*>(data);
-        decompressed_precompiled_cache.insert(decompressed_precompiled_cache.end(), &data_view[0],
-                                              &data_view[length * sizeof(T)]);
-        decompressed_precompiled_cache_offset += length * sizeof(T);
-        return true;
-    }
-
-    template <typename T>
-    bool LoadArrayFromPrecompiled(T* data, std::size_t length) {
-        u8* data_view = reinterpret_cast<u8*>(data);
-        std::copy_n(decompressed_precompiled_cache.data() + decompressed_precompiled_cache_offset,
-                    length * sizeof(T), data_view);
-        decompressed_precompiled_cache_offset += length * sizeof(T);
-        return true;
-    }
-
-    template <typename T>
-    bool SaveObjectToPrecompiled(const T& object) {
-        return SaveArrayToPrecompiled(&object, 1);
-    }
-
-    bool SaveObjectToPrecompiled(bool object) {
-        const auto value = static_cast<u8>(object);
-        return SaveArrayToPrecompiled(&value, 1);
-    }
-
-    template <typename T>
-    bool LoadObjectFromPrecompiled(T& object) {
-        return LoadArrayFromPrecompiled(&object, 1);
-    }
-
-    // Stores whole precompiled cache which will be read from or saved to the precompiled cache
-    // file
-    std::vector<u8, Common::AlignedAllocator<u8>> decompressed_precompiled_cache;
-    // Stores the current offset of the precompiled cache file for IO purposes
-    std::size_t decompressed_precompiled_cache_offset = 0;
-
     // Stored transferable shaders
     std::unordered_map<u64, ShaderDiskCacheRaw> transferable;
 
@@ -6,10 +6,12 @@
 #include <mutex>
 #include <set>
 #include <span>
-#include <thread>
 #include <unordered_map>
 #include <variant>
+#include <tsl/robin_map.h>
+#include "common/microprofile.h"
 #include "common/settings.h"
+#include "common/task_scheduler.h"
 #include "core/frontend/emu_window.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/renderer_opengl/gl_driver.h"
@@ -26,6 +28,10 @@ using Pica::Shader::FSConfig;
 
 namespace OpenGL {
 
+MICROPROFILE_DEFINE(OpenGL_FragmentShaderLookup, "OpenGL", "Fragment Shader Lookup",
+                    MP_RGB(192, 96, 32));
+MICROPROFILE_DEFINE(OpenGL_ShaderGen, "OpenGL", "Shader Generation", MP_RGB(192, 160, 32));
+
 static u64 GetUniqueIdentifier(const Pica::RegsInternal& regs, const ProgramCode& code) {
     std::size_t hash = 0;
     u64 regs_uid =
@@ -165,10 +171,11 @@ public:
     template <typename... Args>
     std::tuple<GLuint, std::optional<std::string>> Get(const KeyConfigType& config,
                                                        Args&&... args) {
-        auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
-        OGLShaderStage& cached_shader = iter->second;
+        auto [iter, new_shader] = shaders.try_emplace(config, separable);
+        OGLShaderStage& cached_shader = iter.value();
         std::optional<std::string> result{};
         if (new_shader) {
+            MICROPROFILE_SCOPE(OpenGL_ShaderGen);
             result = CodeGenerator(config, args...);
             cached_shader.Create(result->c_str(), ShaderType);
         }
@@ -187,7 +194,7 @@ public:
 
 private:
     bool separable;
-    std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
+    tsl::robin_map<KeyConfigType, OGLShaderStage> shaders;
 };
 
 // This is a cache designed for shaders translated from PICA shaders. The first cache matches the
@@ -316,6 +323,7 @@ public:
     bool separable;
     Pica::Shader::Profile profile{};
     ShaderTuple current;
+    Pica::Shader::UserConfig current_fs_user{};
 
     ProgrammableVertexShaders programmable_vertex_shaders;
     TrivialVertexShader trivial_vertex_shader;
@@ -385,11 +393,19 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
 }
 
 void ShaderProgramManager::UseFragmentShader(const Pica::RegsInternal& regs,
-                                             const Pica::Shader::UserConfig& user) {
+                                             const Pica::Shader::UserConfig& user,
+                                             bool regs_dirty) {
+    // The config only changes when one of the regs it is built from was written
+    if (!regs_dirty && impl->current.fs != 0 && user.raw == impl->current_fs_user.raw) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_FragmentShaderLookup);
     const FSConfig fs_config{regs, user, impl->profile};
     auto [handle, result] = impl->fragment_shaders.Get(fs_config, impl->profile);
     impl->current.fs = handle;
     impl->current.fs_hash = fs_config.Hash();
+    impl->current_fs_user = user;
     // Save FS to the disk cache if its a new shader
     if (result) {
         auto& disk_cache = impl->disk_cache;
@@ -440,9 +456,7 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
     }
     const auto& raws = *transferable;
 
-    // Load uncompressed precompiled file for non-separable shaders.
-    // Precompiled file for separable shaders is compressed.
-    auto [decompiled, dumps] = disk_cache.LoadPrecompiled(impl->separable);
+    auto [decompiled, dumps] = disk_cache.LoadPrecompiled();
 
     if (stop_loading) {
         return;
@@ -450,10 +464,6 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
 
     std::set<GLenum> supported_formats = GetSupportedFormats();
 
-    // Track if precompiled cache was altered during loading to know if we have to serialize the
-    // virtual precompiled cache file back to the hard drive
-    bool precompiled_cache_altered = false;
-
     std::mutex mutex;
     std::atomic_bool compilation_failed = false;
     if (callback) {
@@ -535,33 +545,87 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
         }
     };
 
+    // Splits [0, count) between scheduler tasks with their own shared context. When the frontend
+    // cannot share its context the work is done on the current thread instead.
+    const auto RunWorkers = [&](std::size_t count, const auto& work) {
+        if (count == 0) {
+            return;
+        }
+        if (strict_context_required) {
+            const auto dummy_context{std::make_unique<Frontend::GraphicsContext>()};
+            work(0, count, dummy_context.get());
+            return;
+        }
+
+        auto& task_scheduler = Common::GetTaskScheduler();
+        const std::size_t num_workers{std::min(task_scheduler.NumWorkers(), count)};
+        const std::size_t bucket_size{count / num_workers};
+        std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts(num_workers);
+        Common::TaskGroup group{task_scheduler};
+
+        emu_window.SaveContext();
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            const bool is_last_worker = i + 1 == num_workers;
+            const std::size_t start{bucket_size * i};
+            const std::size_t end{is_last_worker ? count : start + bucket_size};
+
+            // On some platforms the shared context has to be created from the GUI thread
+            contexts[i] = emu_window.CreateSharedContext();
+            // Release the context, so it can be immediately used by the worker
+            contexts[i]->DoneCurrent();
+            group.Run([&work, start, end, context = contexts[i].get()] {
+                work(start, end, context);
+            });
+        }
+        group.Wait();
+        emu_window.RestoreContext();
+    };
+
     const auto LoadPrecompiledProgram = [&](const ShaderDecompiledMap& decompiled_map,
                                             const ShaderDumpsMap& dump_map) {
-        std::size_t i{0};
-        for (const auto& dump : dump_map) {
-            if (stop_loading) {
-                break;
-            }
-            const u64 unique_identifier{dump.first};
+        // Only load the programs whose sanitize_mul setting matches
+        std::vector<std::pair<u64, const ShaderDiskCacheDump*>> entries;
+        entries.reserve(dump_map.size());
+        for (const auto& [unique_identifier, dump] : dump_map) {
             const auto decomp{decompiled_map.find(unique_identifier)};
-
-            // Only load the program if its sanitize_mul setting matches
-            if (decomp->second.sanitize_mul != accurate_mul) {
-                continue;
+            if (decomp != decompiled_map.end() && decomp->second.sanitize_mul == accurate_mul) {
+                entries.emplace_back(unique_identifier, &dump);
             }
+        }
 
-            // If the shader program is dumped, attempt to load it
-            OGLProgram shader =
-                GeneratePrecompiledProgram(dump.second, supported_formats, impl->separable);
-            if (shader.handle != 0) {
-                impl->program_cache.emplace(unique_identifier, std::move(shader));
-            } else {
-                LOG_ERROR(Frontend, "Failed to link Precompiled program!");
-                compilation_failed = true;
-                break;
+        // Programs are linked from their binaries on the workers and handed back to the main
+        // context once all of them are done
+        std::vector<OGLProgram> programs(entries.size());
+        std::size_t loaded_programs = 0;
+        const auto LoadPrograms = [&](std::size_t begin, std::size_t end,
+                                      Frontend::GraphicsContext* context) {
+            const auto scope = context->Acquire();
+            for (std::size_t i = begin; i < end; ++i) {
+                if (stop_loading || compilation_failed) {
+                    break;
+                }
+                // If the shader program is dumped, attempt to load it
+                programs[i] = GeneratePrecompiledProgram(*entries[i].second, supported_formats,
+                                                         impl->separable);
+                if (programs[i].handle == 0) {
+                    LOG_ERROR(Frontend, "Failed to link Precompiled program!");
+                    compilation_failed = true;
+                    break;
+                }
+                if (callback) {
+                    std::scoped_lock lock(mutex);
+                    callback(VideoCore::LoadCallbackStage::Decompile, ++loaded_programs,
+                             entries.size());
+                }
             }
-            if (callback) {
-                callback(VideoCore::LoadCallbackStage::Decompile, ++i, dump_map.size());
+            // The programs must be complete before another context uses them
+            glFinish();
+        };
+        RunWorkers(entries.size(), LoadPrograms);
+
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (programs[i].handle != 0) {
+                impl->program_cache.emplace(entries[i].first, std::move(programs[i]));
             }
         }
     };
@@ -578,7 +642,6 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
         impl->program_cache.clear();
         disk_cache.InvalidatePrecompiled();
         dumps.clear();
-        precompiled_cache_altered = true;
         load_all_raws = true;
     }
     // TODO(SachinV): Skip loading raws until we implement a proper way to link non-seperable
@@ -649,7 +712,6 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
             if (!code.empty()) {
                 disk_cache.SaveDecompiled(unique_identifier, code, sanitize_mul);
                 disk_cache.SaveDump(unique_identifier, handle);
-                precompiled_cache_altered = true;
             }
 
             if (callback) {
@@ -658,40 +720,11 @@ void ShaderProgramManager::LoadDiskCache(const std::atomic_bool& stop_loading,
         }
     };
 
-    if (!strict_context_required) {
-        const std::size_t num_workers{std::max(1U, std::thread::hardware_concurrency())};
-        const std::size_t bucket_size{load_raws_size / num_workers};
-        std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts(num_workers);
-        std::vector<std::thread> threads(num_workers);
-
-        emu_window.SaveContext();
-        for (std::size_t i = 0; i < num_workers; ++i) {
-            const bool is_last_worker = i + 1 == num_workers;
-            const std::size_t start{bucket_size * i};
-            const std::size_t end{is_last_worker ? load_raws_size : start + bucket_size};
-
-            // On some platforms the shared context has to be created from the GUI thread
-            contexts[i] = emu_window.CreateSharedContext();
-            // Release the context, so it can be immediately used by the spawned thread
-            contexts[i]->DoneCurrent();
-            threads[i] = std::thread(LoadRawSepareble, start, end, contexts[i].get());
-        }
-        for (auto& thread : threads) {
-            thread.join();
-        }
-        emu_window.RestoreContext();
-    } else {
-        const auto dummy_context{std::make_unique<Frontend::GraphicsContext>()};
-        LoadRawSepareble(0, load_raws_size, dummy_context.get());
-    }
+    RunWorkers(load_raws_size, LoadRawSepareble);
 
     if (compilation_failed) {
         disk_cache.InvalidateAll();
     }
-
-    if (precompiled_cache_altered) {
-        disk_cache.SaveVirtualPrecompiledFile();
-    }
 }
 
 } // namespace OpenGL
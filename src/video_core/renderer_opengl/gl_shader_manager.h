@@ -50,7 +50,12 @@ public:
 
     void UseTrivialGeometryShader();
 
-    void UseFragmentShader(const Pica::RegsInternal& config, const Pica::Shader::UserConfig& user);
+    /**
+     * Binds the fragment shader of the PICA state. The config is only rebuilt and looked up when
+     * regs_dirty is set or the user config changed.
+     */
+    void UseFragmentShader(const Pica::RegsInternal& config, const Pica::Shader::UserConfig& user,
+                           bool regs_dirty = true);
 
     void ApplyTo(OpenGLState& state, bool accurate_mul);
 
@@ -8,6 +8,8 @@
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/tracing.h"
+#include "core/perf_stats.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 
@@ -101,7 +103,11 @@ GLuint LoadProgram(bool separable_program, std::span<const GLuint> shaders,
     }
 
     glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
-    glLinkProgram(program_id);
+    {
+        Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::PipelineCompile};
+        glLinkProgram(program_id);
+    }
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::PipelineCompile);
 
     // Check the program
     GLint result = GL_FALSE;
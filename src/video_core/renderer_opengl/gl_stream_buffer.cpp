@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/microprofile.h"
@@ -10,6 +11,8 @@
 
 MICROPROFILE_DEFINE(OpenGL_StreamBuffer, "OpenGL", "Stream Buffer Orphaning",
                     MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(OpenGL_StreamBufferWait, "OpenGL", "Stream Buffer Wait",
+                    MP_RGB(192, 128, 128));
 
 namespace OpenGL {
 
@@ -23,13 +26,20 @@ OGLStreamBuffer::OGLStreamBuffer(Driver& driver, GLenum target, GLsizeiptr size,
     if (driver.HasBug(DriverBug::VertexArrayOutOfBound) && target == GL_ARRAY_BUFFER) {
         allocate_size *= 2;
     }
+    accounting = Common::MemoryAccounting::Allocation{
+        Common::MemoryAccounting::Category::StagingBuffers, static_cast<u64>(allocate_size)};
 
-    if (GLAD_GL_ARB_buffer_storage) {
+    if (driver.HasPersistentStreamBuffers()) {
         persistent = true;
         coherent = prefer_coherent;
+        segment_size = (buffer_size + NumSegments - 1) / NumSegments;
         GLbitfield flags =
             GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | (coherent ? GL_MAP_COHERENT_BIT : 0);
-        glBufferStorage(gl_target, allocate_size, nullptr, flags);
+        if (driver.HasArbBufferStorage()) {
+            glBufferStorage(gl_target, allocate_size, nullptr, flags);
+        } else {
+            glBufferStorageEXT(gl_target, allocate_size, nullptr, flags);
+        }
         mapped_ptr = static_cast<u8*>(glMapBufferRange(
             gl_target, 0, buffer_size, flags | (coherent ? 0 : GL_MAP_FLUSH_EXPLICIT_BIT)));
     } else {
@@ -42,6 +52,11 @@ OGLStreamBuffer::~OGLStreamBuffer() {
         glBindBuffer(gl_target, gl_buffer.handle);
         glUnmapBuffer(gl_target);
     }
+    for (GLsync fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
     gl_buffer.Release();
 }
 
@@ -68,13 +83,21 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
         invalidate = true;
 
         if (persistent) {
-            glUnmapBuffer(gl_target);
+            FenceSegments(write_segment, NumSegments);
+            write_segment = 0;
+            acquired_segments = 0;
         }
     }
 
-    if (invalidate || !persistent) {
+    if (persistent) {
+        // Fence the segments the writer is leaving and wait for the ones it is entering
+        const u32 begin_segment = static_cast<u32>(buffer_pos / segment_size);
+        const u32 end_segment = static_cast<u32>((buffer_pos + size - 1) / segment_size);
+        FenceSegments(write_segment, begin_segment);
+        WaitSegments(acquired_segments, end_segment + 1);
+    } else {
         MICROPROFILE_SCOPE(OpenGL_StreamBuffer);
-        GLbitfield flags = GL_MAP_WRITE_BIT | (persistent ? GL_MAP_PERSISTENT_BIT : 0) |
+        GLbitfield flags = GL_MAP_WRITE_BIT |
                            (coherent ? GL_MAP_COHERENT_BIT : GL_MAP_FLUSH_EXPLICIT_BIT) |
                            (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
         mapped_ptr = static_cast<u8*>(
@@ -99,4 +122,34 @@ void OGLStreamBuffer::Unmap(GLsizeiptr size) {
     buffer_pos += size;
 }
 
+void OGLStreamBuffer::FenceSegments(u32 begin, u32 end) {
+    for (u32 segment = begin; segment < end; segment++) {
+        // A segment skipped over by an alignment was never waited on, the new fence supersedes
+        if (fences[segment]) {
+            glDeleteSync(fences[segment]);
+        }
+        fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    write_segment = std::max(write_segment, end);
+}
+
+void OGLStreamBuffer::WaitSegments(u32 begin, u32 end) {
+    for (u32 segment = begin; segment < end; segment++) {
+        GLsync& fence = fences[segment];
+        if (!fence) {
+            continue;
+        }
+        const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            MICROPROFILE_META_CPU("Stream Buffer Stalls Avoided", 1);
+        } else {
+            MICROPROFILE_SCOPE(OpenGL_StreamBufferWait);
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    acquired_segments = std::max(acquired_segments, end);
+}
+
 } // namespace OpenGL
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
+#include "common/memory_accounting.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 
 namespace OpenGL {
@@ -24,6 +26,8 @@ public:
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
      * If the buffer is full, the whole buffer is reallocated which invalidates old chunks.
+     * Persistent buffers wrap around instead, waiting for the GPU to release the segments
+     * that are written again, which also invalidates old chunks.
      * The return values are the pointer to the new chunk, the offset within the buffer,
      * and the invalidation flag for previous chunks.
      * The actual used size must be specified on unmapping the chunk.
@@ -33,8 +37,17 @@ public:
     void Unmap(GLsizeiptr size);
 
 private:
+    static constexpr u32 NumSegments = 3;
+
+    /// Fences the GPU reads of the segments in [begin, end) for their reuse
+    void FenceSegments(u32 begin, u32 end);
+
+    /// Waits until the GPU is done with the segments in [begin, end)
+    void WaitSegments(u32 begin, u32 end);
+
     OGLBuffer gl_buffer;
     GLenum gl_target;
+    Common::MemoryAccounting::Allocation accounting;
 
     bool coherent = false;
     bool persistent = false;
@@ -44,6 +57,13 @@ private:
     GLintptr mapped_offset = 0;
     GLsizeiptr mapped_size = 0;
     u8* mapped_ptr = nullptr;
+
+    // Persistent buffers never remap, they are split in segments fenced when the writer leaves
+    // them and waited on before the next pass writes them again.
+    GLsizeiptr segment_size = 0;
+    u32 write_segment = 0;
+    u32 acquired_segments = 0;
+    std::array<GLsync, NumSegments> fences{};
 };
 
 } // namespace OpenGL
@@ -23,6 +23,7 @@ using VideoCore::SurfaceType;
 using VideoCore::TextureType;
 
 constexpr GLenum TEMP_UNIT = GL_TEXTURE15;
+constexpr u32 DOWNLOAD_BUFFER_SIZE = 16 * 1024 * 1024;
 
 constexpr FormatTuple DEFAULT_TUPLE = {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
 
@@ -49,7 +50,7 @@ static constexpr std::array<FormatTuple, 5> COLOR_TUPLES_OES = {{
     {GL_RGBA4, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4},   // RGBA4
 }};
 
-static constexpr std::array<FormatTuple, 8> CUSTOM_TUPLES = {{
+static constexpr std::array<FormatTuple, 9> CUSTOM_TUPLES = {{
     DEFAULT_TUPLE,
     {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_UNSIGNED_BYTE},
     {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_UNSIGNED_BYTE},
@@ -58,6 +59,7 @@ static constexpr std::array<FormatTuple, 8> CUSTOM_TUPLES = {{
     {GL_COMPRESSED_RGBA_ASTC_4x4, GL_COMPRESSED_RGBA_ASTC_4x4, GL_UNSIGNED_BYTE},
     {GL_COMPRESSED_RGBA_ASTC_6x6, GL_COMPRESSED_RGBA_ASTC_6x6, GL_UNSIGNED_BYTE},
     {GL_COMPRESSED_RGBA_ASTC_8x6, GL_COMPRESSED_RGBA_ASTC_8x6, GL_UNSIGNED_BYTE},
+    {GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_RGBA8_ETC2_EAC, GL_UNSIGNED_BYTE},
 }};
 
 [[nodiscard]] GLbitfield MakeBufferMask(SurfaceType type) {
@@ -119,6 +121,25 @@ TextureRuntime::TextureRuntime(const Driver& driver_, VideoCore::RendererBase& r
         draw_fbos[i].Create();
         read_fbos[i].Create();
     }
+
+    // Downloads go to a persistently mapped pixel pack buffer, so that the copies of a batch are
+    // queued on the GPU and the CPU only waits once before reading all of them.
+    if (driver.HasPersistentStreamBuffers()) {
+        constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        download_buffer.Create();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download_buffer.handle);
+        if (driver.HasArbBufferStorage()) {
+            glBufferStorage(GL_PIXEL_PACK_BUFFER, DOWNLOAD_BUFFER_SIZE, nullptr, flags);
+        } else {
+            glBufferStorageEXT(GL_PIXEL_PACK_BUFFER, DOWNLOAD_BUFFER_SIZE, nullptr, flags);
+        }
+        download_mapped = static_cast<u8*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, DOWNLOAD_BUFFER_SIZE, flags));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!download_mapped) {
+            download_buffer.Release();
+        }
+    }
 }
 
 TextureRuntime::~TextureRuntime() = default;
@@ -133,7 +154,34 @@ bool TextureRuntime::NeedsConversion(VideoCore::PixelFormat pixel_format) const
     return driver.IsOpenGLES() && should_convert;
 }
 
+bool TextureRuntime::IsCustomFormatSupported(VideoCore::CustomPixelFormat format) const {
+    return driver.IsCustomFormatSupported(format);
+}
+
+u32 TextureRuntime::DownloadBatchSize() const {
+    return download_mapped ? DOWNLOAD_BUFFER_SIZE : 0;
+}
+
+void TextureRuntime::WaitDownloads() {
+    if (download_offset == 0) {
+        return;
+    }
+    const GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(fence);
+    download_offset = 0;
+}
+
 VideoCore::StagingData TextureRuntime::FindStaging(u32 size, bool upload) {
+    if (!upload && download_mapped && download_offset + size <= DOWNLOAD_BUFFER_SIZE) {
+        const u32 offset = download_offset;
+        download_offset += size;
+        return VideoCore::StagingData{
+            .size = size,
+            .offset = offset,
+            .mapped = std::span{download_mapped + offset, size},
+        };
+    }
     if (size > staging_buffer.size()) {
         staging_buffer.resize(size);
     }
@@ -385,6 +433,20 @@ GLuint Surface::CopyHandle() noexcept {
     return copy_texture.handle;
 }
 
+GLuint Surface::StencilView() noexcept {
+    if (!stencil_view.handle) {
+        stencil_view.Create();
+        glTextureView(stencil_view.handle, GL_TEXTURE_2D, Handle(), GL_DEPTH24_STENCIL8, 0, 1, 0,
+                      1);
+        glActiveTexture(TEMP_UNIT);
+        glBindTexture(GL_TEXTURE_2D, stencil_view.handle);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_STENCIL_INDEX);
+    }
+    return stencil_view.handle;
+}
+
 void Surface::Upload(const VideoCore::BufferTextureCopy& upload,
                      const VideoCore::StagingData& staging) {
     ASSERT(stride * GetFormatBytesPerPixel(pixel_format) % 4 == 0);
@@ -408,7 +470,7 @@ void Surface::Upload(const VideoCore::BufferTextureCopy& upload,
         .src_rect = upload.texture_rect,
         .dst_rect = upload.texture_rect * res_scale,
     };
-    if (res_scale != 1 && !runtime->blit_helper.Filter(*this, blit)) {
+    if (res_scale != 1 && !runtime->blit_helper.Filter(*this, blit, upload.content_hash)) {
         BlitScale(blit, true);
     }
 }
@@ -473,8 +535,21 @@ void Surface::Download(const VideoCore::BufferTextureCopy& download,
         BlitScale(blit, false);
     }
 
+    // Downloads to the pixel pack buffer pass the offset in it instead of a pointer
+    const bool to_buffer = runtime->IsDownloadBuffer(staging);
+    if (to_buffer) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, runtime->download_buffer.handle);
+    }
+    SCOPE_EXIT({
+        if (to_buffer) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+    });
+    void* const pixels = to_buffer ? reinterpret_cast<void*>(static_cast<uintptr_t>(staging.offset))
+                                   : staging.mapped.data();
+
     // Try to download without using an fbo. This should succeed on recent desktop drivers
-    if (DownloadWithoutFbo(download, staging)) {
+    if (DownloadWithoutFbo(download, staging, pixels)) {
         return;
     }
 
@@ -488,13 +563,13 @@ void Surface::Download(const VideoCore::BufferTextureCopy& download,
     // Read the pixel data to the staging buffer
     const auto& tuple = runtime->GetFormatTuple(pixel_format);
     glReadPixels(download.texture_rect.left, download.texture_rect.bottom, unscaled_width,
-                 unscaled_height, tuple.format, tuple.type, staging.mapped.data());
+                 unscaled_height, tuple.format, tuple.type, pixels);
 
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 }
 
 bool Surface::DownloadWithoutFbo(const VideoCore::BufferTextureCopy& download,
-                                 const VideoCore::StagingData& staging) {
+                                 const VideoCore::StagingData& staging, void* pixels) {
     if (driver->IsOpenGLES()) {
         return false;
     }
@@ -514,7 +589,7 @@ bool Surface::DownloadWithoutFbo(const VideoCore::BufferTextureCopy& download,
         glGetTextureSubImage(Handle(0), download.texture_level, download.texture_rect.left,
                              download.texture_rect.bottom, 0, download.texture_rect.GetWidth(),
                              download.texture_rect.GetHeight(), 1, tuple.format, tuple.type,
-                             buf_size, staging.mapped.data());
+                             buf_size, pixels);
         return true;
     } else if (is_full_download) {
         // This should only trigger for full texture downloads in oldish intel drivers
@@ -523,8 +598,7 @@ bool Surface::DownloadWithoutFbo(const VideoCore::BufferTextureCopy& download,
         state.texture_units[0].texture_2d = Handle(0);
         state.Apply();
 
-        glGetTexImage(GL_TEXTURE_2D, download.texture_level, tuple.format, tuple.type,
-                      staging.mapped.data());
+        glGetTexImage(GL_TEXTURE_2D, download.texture_level, tuple.format, tuple.type, pixels);
 
         return true;
     }
@@ -559,6 +633,7 @@ void Surface::ScaleUp(u32 new_scale) {
     }
 
     res_scale = new_scale;
+    stencil_view.Release();
     textures[1] = MakeHandle(GL_TEXTURE_2D, GetScaledWidth(), GetScaledHeight(), levels, tuple,
                              DebugName(true));
 
@@ -581,6 +656,36 @@ u32 Surface::GetInternalBytesPerPixel() const {
     return GetFormatBytesPerPixel(pixel_format);
 }
 
+u64 Surface::MemoryUsage() const {
+    const u32 layers = texture_type == VideoCore::TextureType::CubeMap ? 6 : 1;
+    const auto texture_size = [&](u32 texture_width, u32 texture_height, u32 bytes_per_pixel) {
+        u64 size = 0;
+        for (u32 level = 0; level < levels; level++) {
+            size += u64{std::max(texture_width >> level, 1U)} *
+                    std::max(texture_height >> level, 1U);
+        }
+        return size * bytes_per_pixel * layers;
+    };
+
+    // Custom textures are uploaded as is, while their scaled copy is always RGBA8
+    if (material) {
+        const u64 scaled_size =
+            textures[1].handle ? texture_size(material->width, material->height, 4) : 0;
+        return material->size + scaled_size;
+    }
+
+    const u32 bytes_per_pixel = GetInternalBytesPerPixel();
+    const u64 scaled_size = texture_size(GetScaledWidth(), GetScaledHeight(), bytes_per_pixel);
+    u64 usage = textures[0].handle ? texture_size(width, height, bytes_per_pixel) : 0;
+    if (textures[1].handle) {
+        usage += scaled_size;
+    }
+    if (copy_texture.handle) {
+        usage += scaled_size;
+    }
+    return usage;
+}
+
 void Surface::BlitScale(const VideoCore::TextureBlit& blit, bool up_scale) {
     const u32 fbo_index = FboIndex(type);
 
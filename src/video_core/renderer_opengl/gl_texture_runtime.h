@@ -52,9 +52,18 @@ public:
     /// Returns true if the provided pixel format cannot be used natively by the runtime.
     bool NeedsConversion(VideoCore::PixelFormat pixel_format) const;
 
+    /// Returns true if textures of the provided custom format can be created.
+    bool IsCustomFormatSupported(VideoCore::CustomPixelFormat format) const;
+
     /// Maps an internal staging buffer of the provided size of pixel uploads/downloads
     VideoCore::StagingData FindStaging(u32 size, bool upload);
 
+    /// Returns the number of bytes that can be downloaded before WaitDownloads has to be called
+    u32 DownloadBatchSize() const;
+
+    /// Waits for the downloads since the last call, after which their staging data can be read
+    void WaitDownloads();
+
     /// Returns the OpenGL format tuple associated with the provided pixel format
     const FormatTuple& GetFormatTuple(VideoCore::PixelFormat pixel_format) const;
     const FormatTuple& GetFormatTuple(VideoCore::CustomPixelFormat pixel_format);
@@ -88,10 +97,18 @@ private:
     /// Fills the rectangle of the surface with the value provided, without an fbo.
     bool ClearTextureWithoutFbo(Surface& surface, const VideoCore::TextureClear& clear);
 
+    /// Returns true if the staging data of a download is in the pixel pack buffer
+    bool IsDownloadBuffer(const VideoCore::StagingData& staging) const {
+        return download_mapped && staging.mapped.data() == download_mapped + staging.offset;
+    }
+
 private:
     const Driver& driver;
     BlitHelper blit_helper;
     std::vector<u8, Common::AlignedAllocator<u8>> staging_buffer;
+    OGLBuffer download_buffer;
+    u8* download_mapped{};
+    u32 download_offset{};
     std::array<OGLFramebuffer, 3> draw_fbos;
     std::array<OGLFramebuffer, 3> read_fbos;
 };
@@ -119,9 +136,21 @@ public:
     /// Returns a copy of the upscaled texture handle, used for feedback loops.
     GLuint CopyHandle() noexcept;
 
+    /**
+     * Returns a view of the upscaled depth stencil texture that samples its stencil component.
+     * The view is kept for as long as the texture exists, so reinterpreting the surface every
+     * frame does not create a new one each time.
+     */
+    GLuint StencilView() noexcept;
+
     /// Uploads pixel data in staging to a rectangle region of the surface texture
     void Upload(const VideoCore::BufferTextureCopy& upload, const VideoCore::StagingData& staging);
 
+    /// Tiled uploads are always decoded on the CPU by the rasterizer cache
+    bool UploadTiled(const VideoCore::BufferTextureCopy&, std::span<const u8>) {
+        return false;
+    }
+
     /// Uploads the custom material to the surface allocation.
     void UploadCustom(const VideoCore::Material* material, u32 level);
 
@@ -129,6 +158,11 @@ public:
     void Download(const VideoCore::BufferTextureCopy& download,
                   const VideoCore::StagingData& staging);
 
+    /// Tiled downloads are always encoded on the CPU by the rasterizer cache
+    bool DownloadTiled(const VideoCore::BufferTextureCopy&, u32, std::span<u8>) {
+        return false;
+    }
+
     /// Attaches a handle of surface to the specified framebuffer target
     void Attach(GLenum target, u32 level, u32 layer, bool scaled = true);
 
@@ -138,19 +172,23 @@ public:
     /// Returns the bpp of the internal surface format
     u32 GetInternalBytesPerPixel() const;
 
+    /// Returns an estimate of the host memory used by the surface textures
+    u64 MemoryUsage() const;
+
 private:
     /// Performs blit between the scaled/unscaled images
     void BlitScale(const VideoCore::TextureBlit& blit, bool up_scale);
 
     /// Attempts to download without using an fbo
     bool DownloadWithoutFbo(const VideoCore::BufferTextureCopy& download,
-                            const VideoCore::StagingData& staging);
+                            const VideoCore::StagingData& staging, void* pixels);
 
 private:
     const Driver* driver;
     TextureRuntime* runtime;
     std::array<OGLTexture, 3> textures;
     OGLTexture copy_texture;
+    OGLTexture stencil_view;
     FormatTuple tuple;
 };
 
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
@@ -19,6 +21,7 @@
 #include "video_core/host_shaders/opengl_present_anaglyph_frag.h"
 #include "video_core/host_shaders/opengl_present_frag.h"
 #include "video_core/host_shaders/opengl_present_interlaced_frag.h"
+#include "video_core/host_shaders/opengl_present_upscale_frag.h"
 #include "video_core/host_shaders/opengl_present_vert.h"
 
 namespace OpenGL {
@@ -129,6 +132,7 @@ void RendererOpenGL::SwapBuffers() {
     EndFrame();
     prev_state.Apply();
     rasterizer.TickFrame();
+    system.perf_stats->ReportTextureMemoryUsage(rasterizer.GetTextureMemoryUsage());
 }
 
 void RendererOpenGL::RenderScreenshot() {
@@ -182,6 +186,7 @@ void RendererOpenGL::PrepareRendertarget() {
         if (texture.width != framebuffer.width || texture.height != framebuffer.height ||
             texture.format != framebuffer.color_format) {
             ConfigureFramebufferTexture(texture, framebuffer, color_fill);
+            screen_infos[i].uploaded_row_hashes.clear();
         }
         LoadFBToScreenInfo(framebuffer, screen_infos[i], i == 1, color_fill);
     }
@@ -279,6 +284,7 @@ void RendererOpenGL::LoadFBToScreenInfo(const Pica::FramebufferConfig& framebuff
         rasterizer.FlushRegion(framebuffer_addr, framebuffer.stride * framebuffer.height);
 
         u8* framebuffer_data = system.Memory().GetPhysicalPointer(framebuffer_addr);
+        u32 first_row = 0;
 
         if (color_fill.is_enabled) {
             memcpy(fill_pixel, color_fill.AsVector().AsArray(), sizeof(fill_pixel));
@@ -286,6 +292,38 @@ void RendererOpenGL::LoadFBToScreenInfo(const Pica::FramebufferConfig& framebuff
             width = 1;
             height = 1;
             pixel_stride = 0;
+            screen_info.uploaded_row_hashes.clear();
+        } else if (framebuffer_data) {
+            // Framebuffers drawn by the CPU often stay the same for many frames or only change in
+            // a few rows, so only upload the rows between the first and the last changed one.
+            auto& row_hashes = screen_info.uploaded_row_hashes;
+            if (screen_info.uploaded_address != framebuffer_addr ||
+                screen_info.uploaded_stride != framebuffer.stride || row_hashes.size() != height) {
+                row_hashes.assign(height, 0);
+                screen_info.uploaded_address = framebuffer_addr;
+                screen_info.uploaded_stride = framebuffer.stride;
+                for (u32 row = 0; row < height; row++) {
+                    row_hashes[row] = Common::ComputeHash64(
+                        framebuffer_data + row * framebuffer.stride, width * bpp);
+                }
+            } else {
+                u32 last_row = 0;
+                first_row = height;
+                for (u32 row = 0; row < height; row++) {
+                    const u64 hash = Common::ComputeHash64(
+                        framebuffer_data + row * framebuffer.stride, width * bpp);
+                    if (hash != row_hashes[row]) {
+                        row_hashes[row] = hash;
+                        first_row = std::min(first_row, row);
+                        last_row = row;
+                    }
+                }
+                if (first_row == height) {
+                    return;
+                }
+                height = last_row - first_row + 1;
+                framebuffer_data += first_row * framebuffer.stride;
+            }
         }
 
         state.texture_units[0].texture_2d = screen_info.texture.resource.handle;
@@ -299,8 +337,9 @@ void RendererOpenGL::LoadFBToScreenInfo(const Pica::FramebufferConfig& framebuff
         //       they differ from the LCD resolution.
         // TODO: Applications could theoretically crash Citra here by specifying too large
         //       framebuffer sizes. We should make sure that this cannot happen.
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, screen_info.texture.gl_format,
-                        screen_info.texture.gl_type, framebuffer_data);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(first_row), width, height,
+                        screen_info.texture.gl_format, screen_info.texture.gl_type,
+                        framebuffer_data);
 
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
@@ -393,7 +432,9 @@ void RendererOpenGL::ReloadShader(Settings::StereoRenderOption render_3d) {
         shader_data += HostShaders::OPENGL_PRESENT_INTERLACED_FRAG;
     } else {
         if (Settings::values.pp_shader_name.GetValue() == "None (builtin)") {
-            shader_data += HostShaders::OPENGL_PRESENT_FRAG;
+            shader_data += Settings::values.spatial_upscaling.GetValue()
+                               ? HostShaders::OPENGL_PRESENT_UPSCALE_FRAG
+                               : HostShaders::OPENGL_PRESENT_FRAG;
         } else {
             std::string shader_text = OpenGL::GetPostProcessingShaderCode(
                 false, Settings::values.pp_shader_name.GetValue());
@@ -549,7 +590,7 @@ void RendererOpenGL::DrawSingleScreen(const ScreenInfo& screen_info, float x, fl
     }
 
     const u32 scale_factor = GetResolutionScaleFactor();
-    const GLuint sampler = samplers[Settings::values.filter_mode.GetValue()].handle;
+    const GLuint sampler = samplers[pica.runtime_settings.filter_mode].handle;
     glUniform4f(uniform_i_resolution, static_cast<float>(screen_info.texture.width * scale_factor),
                 static_cast<float>(screen_info.texture.height * scale_factor),
                 1.0f / static_cast<float>(screen_info.texture.width * scale_factor),
@@ -619,7 +660,7 @@ void RendererOpenGL::DrawSingleScreenStereo(const ScreenInfo& screen_info_l,
     }
 
     const u32 scale_factor = GetResolutionScaleFactor();
-    const GLuint sampler = samplers[Settings::values.filter_mode.GetValue()].handle;
+    const GLuint sampler = samplers[pica.runtime_settings.filter_mode].handle;
     glUniform4f(uniform_i_resolution,
                 static_cast<float>(screen_info_l.texture.width * scale_factor),
                 static_cast<float>(screen_info_l.texture.height * scale_factor),
@@ -729,8 +770,8 @@ void RendererOpenGL::DrawTopScreen(const Layout::FramebufferLayout& layout,
         return;
     }
     int leftside, rightside;
-    leftside = Settings::values.swap_eyes_3d.GetValue() ? 1 : 0;
-    rightside = Settings::values.swap_eyes_3d.GetValue() ? 0 : 1;
+    leftside = pica.runtime_settings.swap_eyes_3d ? 1 : 0;
+    rightside = pica.runtime_settings.swap_eyes_3d ? 0 : 1;
 
     const float top_screen_left = static_cast<float>(top_screen.left);
     const float top_screen_top = static_cast<float>(top_screen.top);
@@ -741,7 +782,7 @@ void RendererOpenGL::DrawTopScreen(const Layout::FramebufferLayout& layout,
                                                : Layout::DisplayOrientation::Portrait;
     switch (layout.render_3d_mode) {
     case Settings::StereoRenderOption::Off: {
-        const int eye = static_cast<int>(Settings::values.mono_render_option.GetValue());
+        const int eye = static_cast<int>(pica.runtime_settings.mono_render_option);
         DrawSingleScreen(screen_infos[eye], top_screen_left, top_screen_top, top_screen_width,
                          top_screen_height, orientation);
         break;
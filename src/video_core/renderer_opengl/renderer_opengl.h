@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/frame_dumper_opengl.h"
 #include "video_core/renderer_opengl/gl_driver.h"
@@ -37,6 +38,11 @@ struct ScreenInfo {
     GLuint display_texture;
     Common::Rectangle<float> display_texcoords;
     TextureInfo texture;
+    /// Guest framebuffer uploaded to the texture, along with the hash of each of its rows, used
+    /// to only upload the rows that changed since the last frame.
+    PAddr uploaded_address{};
+    u32 uploaded_stride{};
+    std::vector<u64> uploaded_row_hashes;
 };
 
 class RendererOpenGL : public VideoCore::RendererBase {
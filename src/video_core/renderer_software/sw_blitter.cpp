@@ -2,6 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/vector_math.h"
@@ -13,24 +17,188 @@
 
 namespace SwRenderer {
 
-static Common::Vec4<u8> DecodePixel(Pica::PixelFormat input_format, const u8* src_pixel) {
+namespace {
+
+using ScalingMode = Pica::DisplayTransferConfig::ScalingMode;
+
+template <Pica::PixelFormat format>
+Common::Vec4<u8> DecodePixel(const u8* src_pixel) {
+    if constexpr (format == Pica::PixelFormat::RGBA8) {
+        return Common::Color::DecodeRGBA8(src_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB8) {
+        return Common::Color::DecodeRGB8(src_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB565) {
+        return Common::Color::DecodeRGB565(src_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB5A1) {
+        return Common::Color::DecodeRGB5A1(src_pixel);
+    } else {
+        return Common::Color::DecodeRGBA4(src_pixel);
+    }
+}
+
+template <Pica::PixelFormat format>
+void EncodePixel(const Common::Vec4<u8>& color, u8* dst_pixel) {
+    if constexpr (format == Pica::PixelFormat::RGBA8) {
+        Common::Color::EncodeRGBA8(color, dst_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB8) {
+        Common::Color::EncodeRGB8(color, dst_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB565) {
+        Common::Color::EncodeRGB565(color, dst_pixel);
+    } else if constexpr (format == Pica::PixelFormat::RGB5A1) {
+        Common::Color::EncodeRGB5A1(color, dst_pixel);
+    } else {
+        Common::Color::EncodeRGBA4(color, dst_pixel);
+    }
+}
+
+/**
+ * Byte offsets of the pixels of a display transfer. The offset of a pixel is the sum of the
+ * offsets of its row and its column, which holds for tiled images as the tile index and the
+ * position in the tile are interleaved from separate bits of x and y.
+ */
+struct TransferLayout {
+    std::vector<u32> src_rows;
+    std::vector<u32> src_columns;
+    std::vector<u32> dst_rows;
+    std::vector<u32> dst_columns;
+};
+
+u32 ColumnOffset(u32 x, bool tiled, u32 bytes_per_pixel) {
+    if (!tiled) {
+        return x * bytes_per_pixel;
+    }
+    return (VideoCore::MortonInterleave(x, 0) + (x & ~7) * 8) * bytes_per_pixel;
+}
+
+u32 RowOffset(u32 y, bool tiled, u32 width, u32 bytes_per_pixel) {
+    if (!tiled) {
+        return y * width * bytes_per_pixel;
+    }
+    return (VideoCore::MortonInterleave(0, y) + (y & ~7) * width) * bytes_per_pixel;
+}
+
+/// Reads the pixel of the source at the position, averaging it with its neighbours when scaling.
+/// The pixels averaged by the box filter follow each other in tiled images.
+template <Pica::PixelFormat input_format, ScalingMode scaling>
+Common::Vec4<u8> FilterPixel(const u8* src_pixel) {
+    constexpr u32 src_bytes_per_pixel = Pica::BytesPerPixel(input_format);
+    const auto src_color = DecodePixel<input_format>(src_pixel);
+    if constexpr (scaling == ScalingMode::ScaleX) {
+        const auto pixel = DecodePixel<input_format>(src_pixel + src_bytes_per_pixel);
+        return ((src_color + pixel) / 2).template Cast<u8>();
+    } else if constexpr (scaling == ScalingMode::ScaleXY) {
+        const auto pixel1 = DecodePixel<input_format>(src_pixel + 1 * src_bytes_per_pixel);
+        const auto pixel2 = DecodePixel<input_format>(src_pixel + 2 * src_bytes_per_pixel);
+        const auto pixel3 = DecodePixel<input_format>(src_pixel + 3 * src_bytes_per_pixel);
+        return (((src_color + pixel1) + (pixel2 + pixel3)) / 4).template Cast<u8>();
+    } else {
+        return src_color;
+    }
+}
+
+using ConvertFunc = void (*)(const TransferLayout& layout, const u8* src, u8* dst);
+
+/// Converts the pixels of a display transfer, each combination of formats and scaling mode is
+/// compiled to a loop of its own without any format switches.
+template <Pica::PixelFormat input_format, Pica::PixelFormat output_format, ScalingMode scaling>
+void ConvertPixels(const TransferLayout& layout, const u8* src, u8* dst) {
+    constexpr u32 dst_bytes_per_pixel = Pica::BytesPerPixel(output_format);
+
+    for (std::size_t y = 0; y < layout.dst_rows.size(); ++y) {
+        const u8* src_row = src + layout.src_rows[y];
+        u8* dst_row = dst + layout.dst_rows[y];
+        for (std::size_t x = 0; x < layout.dst_columns.size(); ++x) {
+            const u8* src_pixel = src_row + layout.src_columns[x];
+            u8* dst_pixel = dst_row + layout.dst_columns[x];
+            if constexpr (input_format == output_format && scaling == ScalingMode::NoScale) {
+                std::memcpy(dst_pixel, src_pixel, dst_bytes_per_pixel);
+            } else {
+                EncodePixel<output_format>(FilterPixel<input_format, scaling>(src_pixel),
+                                           dst_pixel);
+            }
+        }
+    }
+}
+
+template <Pica::PixelFormat input_format, Pica::PixelFormat output_format>
+ConvertFunc SelectScaling(ScalingMode scaling) {
+    switch (scaling) {
+    case ScalingMode::NoScale:
+        return &ConvertPixels<input_format, output_format, ScalingMode::NoScale>;
+    case ScalingMode::ScaleX:
+        return &ConvertPixels<input_format, output_format, ScalingMode::ScaleX>;
+    case ScalingMode::ScaleXY:
+        return &ConvertPixels<input_format, output_format, ScalingMode::ScaleXY>;
+    default:
+        return nullptr;
+    }
+}
+
+template <Pica::PixelFormat input_format>
+ConvertFunc SelectOutputFormat(Pica::PixelFormat output_format, ScalingMode scaling) {
+    switch (output_format) {
+    case Pica::PixelFormat::RGBA8:
+        return SelectScaling<input_format, Pica::PixelFormat::RGBA8>(scaling);
+    case Pica::PixelFormat::RGB8:
+        return SelectScaling<input_format, Pica::PixelFormat::RGB8>(scaling);
+    case Pica::PixelFormat::RGB565:
+        return SelectScaling<input_format, Pica::PixelFormat::RGB565>(scaling);
+    case Pica::PixelFormat::RGB5A1:
+        return SelectScaling<input_format, Pica::PixelFormat::RGB5A1>(scaling);
+    case Pica::PixelFormat::RGBA4:
+        return SelectScaling<input_format, Pica::PixelFormat::RGBA4>(scaling);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
+                  static_cast<u32>(output_format));
+        return nullptr;
+    }
+}
+
+ConvertFunc GetConvertFunc(Pica::PixelFormat input_format, Pica::PixelFormat output_format,
+                           ScalingMode scaling) {
     switch (input_format) {
     case Pica::PixelFormat::RGBA8:
-        return Common::Color::DecodeRGBA8(src_pixel);
+        return SelectOutputFormat<Pica::PixelFormat::RGBA8>(output_format, scaling);
     case Pica::PixelFormat::RGB8:
-        return Common::Color::DecodeRGB8(src_pixel);
+        return SelectOutputFormat<Pica::PixelFormat::RGB8>(output_format, scaling);
     case Pica::PixelFormat::RGB565:
-        return Common::Color::DecodeRGB565(src_pixel);
+        return SelectOutputFormat<Pica::PixelFormat::RGB565>(output_format, scaling);
     case Pica::PixelFormat::RGB5A1:
-        return Common::Color::DecodeRGB5A1(src_pixel);
+        return SelectOutputFormat<Pica::PixelFormat::RGB5A1>(output_format, scaling);
     case Pica::PixelFormat::RGBA4:
-        return Common::Color::DecodeRGBA4(src_pixel);
+        return SelectOutputFormat<Pica::PixelFormat::RGBA4>(output_format, scaling);
     default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", input_format);
-        return {0, 0, 0, 0};
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}",
+                  static_cast<u32>(input_format));
+        return nullptr;
     }
 }
 
+/**
+ * Fills the range with copies of the pattern. The filled prefix is copied over the rest in
+ * chunks that stay in the cache, which keeps the pattern aligned as they are multiples of it.
+ */
+template <typename T>
+void FillPattern(u8* dest, std::size_t size, const T& value) {
+    std::array<u8, sizeof(T)> pattern;
+    std::memcpy(pattern.data(), &value, sizeof(T));
+    if (std::all_of(pattern.begin(), pattern.end(), [&](u8 byte) { return byte == pattern[0]; })) {
+        std::memset(dest, pattern[0], size);
+        return;
+    }
+
+    constexpr std::size_t MaxChunkSize = 12 * 512;
+    std::size_t filled = std::min(pattern.size(), size);
+    std::memcpy(dest, pattern.data(), filled);
+    while (filled < size) {
+        const std::size_t copy_size = std::min({filled, MaxChunkSize, size - filled});
+        std::memcpy(dest + filled, dest, copy_size);
+        filled += copy_size;
+    }
+}
+
+} // Anonymous namespace
+
 SwBlitter::SwBlitter(Memory::MemorySystem& memory_, VideoCore::RasterizerInterface* rasterizer_)
     : memory{memory_}, rasterizer{rasterizer_} {}
 
@@ -185,111 +353,51 @@ void SwBlitter::DisplayTransfer(const Pica::DisplayTransferConfig& config) {
         config.input_width * config.input_height * BytesPerPixel(config.input_format);
     const u32 output_size = output_width * output_height * BytesPerPixel(config.output_format);
 
+    const ConvertFunc convert =
+        GetConvertFunc(config.input_format, config.output_format, config.scaling);
+    if (!convert) {
+        return;
+    }
+
     rasterizer->FlushRegion(config.GetPhysicalInputAddress(), input_size);
     rasterizer->InvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            const u32 input_x = x << horizontal_scale;
-            const u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            const u32 dst_bytes_per_pixel = BytesPerPixel(config.output_format);
-            const u32 src_bytes_per_pixel = BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    const u32 coarse_y = input_y & ~7;
-                    const u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    const u32 out_coarse_y = output_y & ~7;
-                    const u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    const u32 in_coarse_y = input_y & ~7;
-                    const u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
+    // Linear input is written tiled unless dont_swizzle is set, tiled input is written linear
+    const bool src_tiled = !config.input_linear;
+    const bool dst_tiled = src_tiled == static_cast<bool>(config.dont_swizzle);
+    const u32 src_bytes_per_pixel = BytesPerPixel(config.input_format);
+    const u32 dst_bytes_per_pixel = BytesPerPixel(config.output_format);
 
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                const auto pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                const auto pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                const auto pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                const auto pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
+    TransferLayout layout;
+    layout.src_rows.resize(output_height);
+    layout.dst_rows.resize(output_height);
+    for (u32 y = 0; y < output_height; ++y) {
+        // The output is flipped after calculating the input position to account for scaling
+        const u32 input_y = y << vertical_scale;
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+        layout.src_rows[y] =
+            RowOffset(input_y, src_tiled, config.input_width, src_bytes_per_pixel);
+        layout.dst_rows[y] = RowOffset(output_y, dst_tiled, output_width, dst_bytes_per_pixel);
+    }
+    layout.src_columns.resize(output_width);
+    layout.dst_columns.resize(output_width);
+    for (u32 x = 0; x < output_width; ++x) {
+        const u32 input_x = x << horizontal_scale;
+        layout.src_columns[x] = ColumnOffset(input_x, src_tiled, src_bytes_per_pixel);
+        layout.dst_columns[x] = ColumnOffset(x, dst_tiled, dst_bytes_per_pixel);
+    }
 
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Pica::PixelFormat::RGBA8:
-                Common::Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB8:
-                Common::Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB565:
-                Common::Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGB5A1:
-                Common::Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-            case Pica::PixelFormat::RGBA4:
-                Common::Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
+    // Rows of the same format that are linear on both sides are copied whole
+    if (!src_tiled && !dst_tiled && config.input_format == config.output_format) {
+        const u32 row_size = output_width * dst_bytes_per_pixel;
+        for (u32 y = 0; y < output_height; ++y) {
+            std::memcpy(dst_pointer + layout.dst_rows[y], src_pointer + layout.src_rows[y],
+                        row_size);
         }
+        return;
     }
+
+    convert(layout, src_pointer, dst_pointer);
 }
 
 void SwBlitter::MemoryFill(const Pica::MemoryFillConfig& config) {
@@ -318,28 +426,21 @@ void SwBlitter::MemoryFill(const Pica::MemoryFillConfig& config) {
 
     rasterizer->InvalidateRegion(start_addr, end_addr - start_addr);
 
+    // The 16-bit and 24-bit fills write their last value whole, even past an unaligned end
+    const std::size_t size = end - start;
     if (config.fill_24bit) {
-        // Fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        const std::array<u8, 3> value = {
+            static_cast<u8>(config.value_24bit_r),
+            static_cast<u8>(config.value_24bit_g),
+            static_cast<u8>(config.value_24bit_b),
+        };
+        FillPattern(start, Common::AlignUp(size, value.size()), value);
     } else if (config.fill_32bit) {
-        // Fill with 32-bit values
-        if (end > start) {
-            const u32 value = config.value_32bit;
-            const std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i) {
-                std::memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-            }
-        }
+        const u32 value = config.value_32bit;
+        FillPattern(start, Common::AlignDown(size, sizeof(u32)), value);
     } else {
-        // Fill with 16-bit values
-        const u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16)) {
-            std::memcpy(ptr, &value_16bit, sizeof(u16));
-        }
+        const u16 value = config.value_16bit.Value();
+        FillPattern(start, Common::AlignUp(size, sizeof(u16)), value);
     }
 }
 
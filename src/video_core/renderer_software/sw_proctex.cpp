@@ -2,8 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <utility>
+#include "common/hash.h"
 #include "video_core/renderer_software/sw_proctex.h"
 
 namespace SwRenderer {
@@ -155,10 +158,10 @@ float CombineAndMap(float u, float v, ProcTexCombiner combiner,
     }
     return LookupLUT(map_table, f);
 }
-} // Anonymous namespace
 
-Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
-                         const Pica::PicaCore::ProcTex& state) {
+/// Applies the noise, shift and clamp stages, leaving both coordinates within [0, 1]
+std::pair<float, float> ClampedCoords(float u, float v, const Pica::TexturingRegs& regs,
+                                      const Pica::PicaCore::ProcTex& state) {
     u = std::abs(u);
     v = std::abs(v);
 
@@ -182,7 +185,12 @@ Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
     // Clamp
     ClampCoord(u, regs.proctex.u_clamp);
     ClampCoord(v, regs.proctex.v_clamp);
+    return {u, v};
+}
 
+/// Applies the combine and color lookup stages to the clamped coordinates
+Common::Vec4<u8> LookupColor(float u, float v, const Pica::TexturingRegs& regs,
+                             const Pica::PicaCore::ProcTex& state) {
     // Combine and map
     const float lut_coord = CombineAndMap(u, v, regs.proctex.color_combiner, state.color_map_table);
 
@@ -221,5 +229,67 @@ Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
         return final_color;
     }
 }
+} // Anonymous namespace
+
+Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
+                         const Pica::PicaCore::ProcTex& state) {
+    const auto [clamped_u, clamped_v] = ClampedCoords(u, v, regs, state);
+    return LookupColor(clamped_u, clamped_v, regs, state);
+}
+
+ProcTexCache::ProcTexCache() = default;
+
+ProcTexCache::~ProcTexCache() = default;
+
+void ProcTexCache::Sync(const Pica::TexturingRegs& regs_, const Pica::PicaCore::ProcTex& state_) {
+    regs = &regs_;
+    state = &state_;
+
+    // The noise, shift and clamp stages run per fragment, so their fields are left out
+    u64 hash = Common::ComputeStructHash64(regs->proctex_lut);
+    hash = Common::HashCombine(hash, Common::ComputeStructHash64(regs->proctex_lut_offset));
+    hash = Common::HashCombine(hash, static_cast<u64>(regs->proctex.color_combiner.Value()));
+    hash = Common::HashCombine(hash, static_cast<u64>(regs->proctex.alpha_combiner.Value()));
+    hash = Common::HashCombine(hash, regs->proctex.separate_alpha.Value());
+    hash = Common::HashCombine(hash, Common::ComputeStructHash64(state->color_map_table));
+    hash = Common::HashCombine(hash, Common::ComputeStructHash64(state->alpha_map_table));
+    hash = Common::HashCombine(hash, Common::ComputeStructHash64(state->color_table));
+    hash = Common::HashCombine(hash, Common::ComputeStructHash64(state->color_diff_table));
+    if (texels && hash == config_hash) {
+        return;
+    }
+
+    config_hash = hash;
+    if (!texels) {
+        texels = std::make_unique<std::atomic<u64>[]>(CacheSize * CacheSize);
+    }
+    // Texels stamped with an older generation are stale. Generation 0 marks unfilled texels, so
+    // they are cleared before the counter comes back to it.
+    if (++generation == 0) {
+        for (u32 i = 0; i < CacheSize * CacheSize; i++) {
+            texels[i].store(0, std::memory_order_relaxed);
+        }
+        generation = 1;
+    }
+}
+
+Common::Vec4<u8> ProcTexCache::Sample(float u, float v) const {
+    const auto [clamped_u, clamped_v] = ClampedCoords(u, v, *regs, *state);
+    constexpr float scale = static_cast<float>(CacheSize - 1);
+    const u32 x = std::min(static_cast<u32>(std::lround(clamped_u * scale)), CacheSize - 1);
+    const u32 y = std::min(static_cast<u32>(std::lround(clamped_v * scale)), CacheSize - 1);
+
+    std::atomic<u64>& texel = texels[y * CacheSize + x];
+    u64 value = texel.load(std::memory_order_relaxed);
+    if (static_cast<u32>(value >> 32) != generation) {
+        // The color of the texel center is used, so threads filling the same texel agree
+        const auto color = LookupColor(x / scale, y / scale, *regs, *state);
+        value = (u64{generation} << 32) | color.r() | (color.g() << 8) | (color.b() << 16) |
+                (u32{color.a()} << 24);
+        texel.store(value, std::memory_order_relaxed);
+    }
+    return {static_cast<u8>(value), static_cast<u8>(value >> 8), static_cast<u8>(value >> 16),
+            static_cast<u8>(value >> 24)};
+}
 
 } // namespace SwRenderer
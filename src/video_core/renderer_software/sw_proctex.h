@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/pica/pica_core.h"
@@ -14,4 +16,32 @@ namespace SwRenderer {
 Common::Vec4<u8> ProcTex(float u, float v, const Pica::TexturingRegs& regs,
                          const Pica::PicaCore::ProcTex& state);
 
+/**
+ * Caches the procedural texture colors of the coordinates left after noise and clamping, which
+ * only depend on the combiners and the LUTs. Games mostly keep those unchanged across frames, so
+ * the combine and color lookup stages run once per texel of the cache instead of once per fragment.
+ * The texels are filled on first use and may be filled by several rasterizer threads at once.
+ */
+class ProcTexCache {
+public:
+    ProcTexCache();
+    ~ProcTexCache();
+
+    /// Invalidates the cached texels if the proctex configuration changed since the last call
+    void Sync(const Pica::TexturingRegs& regs, const Pica::PicaCore::ProcTex& state);
+
+    /// Generates procedural texture color for the given coordinates with the synced configuration
+    Common::Vec4<u8> Sample(float u, float v) const;
+
+private:
+    /// Number of texels along each axis, finer than the LUTs the colors are interpolated from
+    static constexpr u32 CacheSize = 512;
+
+    const Pica::TexturingRegs* regs{};
+    const Pica::PicaCore::ProcTex* state{};
+    u64 config_hash{};
+    u32 generation{};
+    std::unique_ptr<std::atomic<u64>[]> texels; ///< Generation in the upper half, color below
+};
+
 } // namespace SwRenderer
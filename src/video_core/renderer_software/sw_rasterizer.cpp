@@ -6,6 +6,7 @@
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
+#include "common/task_scheduler.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
 #include "video_core/pica/output_vertex.h"
@@ -77,11 +78,11 @@ public:
                                                                       f24::Zero(), f24::Zero()))
         : pos(f24::Zero()), coeffs(coeffs), bias(bias) {}
 
-    bool IsInside(const Vertex& vertex) const {
+    bool IsInside(const Pica::OutputVertex& vertex) const {
         return Common::Dot(vertex.pos + bias, coeffs) >= f24::FromFloat32(-EPSILON_Z);
     }
 
-    bool IsOutSide(const Vertex& vertex) const {
+    bool IsOutSide(const Pica::OutputVertex& vertex) const {
         return !IsInside(vertex);
     }
 
@@ -98,31 +99,96 @@ private:
     Common::Vec4<f24> bias;
 };
 
+/**
+ * Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
+ * the new edge (or less in degenerate cases). As such, we can say that each clipping plane
+ * introduces at most 1 new vertex to the polygon. Since we start with a triangle and have 7 fixed
+ * planes and the custom one, the maximum number of vertices of the clipped polygon is 3 + 8 = 11.
+ **/
+constexpr std::size_t MAX_POLYGON_VERTICES = 11;
+/// Each plane creates at most 2 vertices, the ones it removes stay in the pool.
+constexpr std::size_t MAX_POOL_VERTICES = 3 + 8 * 2;
+
+/// A polygon being clipped, its vertices are indices into a pool so they are never copied.
+struct ClippedPolygon {
+    boost::container::static_vector<Vertex, MAX_POOL_VERTICES> vertices;
+    boost::container::static_vector<u8, MAX_POLYGON_VERTICES> indices;
+};
+
+/**
+ * Clips the polygon against the edges whose bit is set in the clip mask with the
+ * Sutherland-Hodgman algorithm. A polygon with all its vertices inside of an edge is left as is.
+ */
+void ClipPolygon(ClippedPolygon& polygon, std::span<const ClippingEdge> edges, u32 clip_mask) {
+    decltype(ClippedPolygon::indices) input;
+    for (std::size_t i = 0; i < edges.size(); i++) {
+        if ((clip_mask & (1U << i)) == 0) {
+            continue;
+        }
+
+        const ClippingEdge& edge = edges[i];
+        std::swap(input, polygon.indices);
+        polygon.indices.clear();
+
+        const auto add_intersection = [&](u8 index, u8 reference) {
+            polygon.vertices.push_back(
+                edge.GetIntersection(polygon.vertices[index], polygon.vertices[reference]));
+            polygon.indices.push_back(static_cast<u8>(polygon.vertices.size() - 1));
+        };
+
+        u8 reference = input.back();
+        for (const u8 index : input) {
+            // NOTE: This algorithm changes vertex order in some cases!
+            if (edge.IsInside(polygon.vertices[index])) {
+                if (edge.IsOutSide(polygon.vertices[reference])) {
+                    add_intersection(index, reference);
+                }
+                polygon.indices.push_back(index);
+            } else if (edge.IsInside(polygon.vertices[reference])) {
+                add_intersection(index, reference);
+            }
+            reference = index;
+        }
+
+        if (polygon.indices.size() < 3) {
+            return;
+        }
+    }
+}
+
 } // Anonymous namespace
 
+struct RasterizerSoftware::Triangle {
+    std::array<Vertex, 3> vertices;
+    std::array<Common::Vec3<Fix12P4>, 3> vtxpos;
+    std::array<int, 3> bias;
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
 RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
-    : memory{memory_}, pica{pica_}, regs{pica.regs.internal},
-      num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
+    : memory{memory_}, pica{pica_}, regs{pica.regs.internal}, fb{memory, regs.framebuffer},
+      tile_bins(TILE_GRID_SIZE * TILE_GRID_SIZE) {}
+
+RasterizerSoftware::~RasterizerSoftware() = default;
 
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
-    /**
-     * Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
-     * the new edge (or less in degenerate cases). As such, we can say that each clipping plane
-     * introduces at most 1 new vertex to the polygon. Since we start with a triangle and have a
-     * fixed 6 clipping planes, the maximum number of vertices of the clipped polygon is 3 + 6 = 9.
-     **/
-    static constexpr std::size_t MAX_VERTICES = 9;
-
-    boost::container::static_vector<Vertex, MAX_VERTICES> buffer_a = {v0, v1, v2};
-    boost::container::static_vector<Vertex, MAX_VERTICES> buffer_b;
-
-    FlipQuaternionIfOpposite(buffer_a[1].quat, buffer_a[0].quat);
-    FlipQuaternionIfOpposite(buffer_a[2].quat, buffer_a[0].quat);
+    Pica::OutputVertex* const vertices = &clip_batch[num_clip_batch * 3];
+    vertices[0] = v0;
+    vertices[1] = v1;
+    vertices[2] = v2;
+    if (++num_clip_batch == CLIP_BATCH_SIZE) {
+        ClipTriangles();
+    }
+}
 
-    auto* output_list = &buffer_a;
-    auto* input_list = &buffer_b;
+void RasterizerSoftware::ClipTriangles() {
+    if (num_clip_batch == 0) {
+        return;
+    }
 
     // NOTE: We clip against a w=epsilon plane to guarantee that the output has a positive w value.
     // TODO: Not sure if this is a valid approach. Also should probably instead use the smallest
@@ -130,7 +196,7 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
     static constexpr f24 EPSILON = f24::FromFloat32(0.00001f);
     static constexpr f24 f0 = f24::Zero();
     static constexpr f24 f1 = f24::One();
-    static constexpr std::array<ClippingEdge, 7> clipping_edges = {{
+    const std::array<ClippingEdge, 8> clipping_edges = {{
         {Common::MakeVec(-f1, f0, f0, f1)},                                        // x = +w
         {Common::MakeVec(f1, f0, f0, f1)},                                         // x = -w
         {Common::MakeVec(f0, -f1, f0, f1)},                                        // y = +w
@@ -138,51 +204,55 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
         {Common::MakeVec(f0, f0, -f1, f0)},                                        // z =  0
         {Common::MakeVec(f0, f0, f1, f1)},                                         // z = -w
         {Common::MakeVec(f0, f0, f0, f1), Common::Vec4<f24>(f0, f0, f0, EPSILON)}, // w = EPSILON
+        {regs.rasterizer.GetClipCoef()},                                           // custom
     }};
-
-    // Simple implementation of the Sutherland-Hodgman clipping algorithm.
-    // TODO: Make this less inefficient (currently lots of useless buffering overhead happens here)
-    const auto clip = [&](const ClippingEdge& edge) {
-        std::swap(input_list, output_list);
-        output_list->clear();
-
-        const Vertex* reference_vertex = &input_list->back();
-        for (const auto& vertex : *input_list) {
-            // NOTE: This algorithm changes vertex order in some cases!
-            if (edge.IsInside(vertex)) {
-                if (edge.IsOutSide(*reference_vertex)) {
-                    output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
-                }
-                output_list->push_back(vertex);
-            } else if (edge.IsInside(*reference_vertex)) {
-                output_list->push_back(edge.GetIntersection(vertex, *reference_vertex));
-            }
-            reference_vertex = &vertex;
+    const std::span<const ClippingEdge> edges{clipping_edges.data(),
+                                              regs.rasterizer.clip_enable ? 8U : 7U};
+
+    // The clip codes of the whole batch are computed one edge at a time, so that the loop over
+    // the vertices has no dependencies. Each bit is set when the vertex is outside of the edge.
+    const std::size_t num_vertices = num_clip_batch * 3;
+    std::array<u32, CLIP_BATCH_SIZE * 3> clip_codes{};
+    for (std::size_t i = 0; i < edges.size(); i++) {
+        for (std::size_t v = 0; v < num_vertices; v++) {
+            clip_codes[v] |= static_cast<u32>(edges[i].IsOutSide(clip_batch[v])) << i;
         }
-    };
+    }
 
-    for (const ClippingEdge& edge : clipping_edges) {
-        clip(edge);
-        if (output_list->size() < 3) {
-            return;
+    for (std::size_t t = 0; t < num_clip_batch; t++) {
+        const u32* codes = &clip_codes[t * 3];
+        // Triangles with all vertices outside of the same edge are rejected, the ones with all
+        // vertices inside of every edge are accepted without clipping.
+        if ((codes[0] & codes[1] & codes[2]) != 0) {
+            continue;
         }
-    }
 
-    if (regs.rasterizer.clip_enable) {
-        const ClippingEdge custom_edge{regs.rasterizer.GetClipCoef()};
-        clip(custom_edge);
-        if (output_list->size() < 3) {
-            return;
+        const Pica::OutputVertex* triangle = &clip_batch[t * 3];
+        ClippedPolygon polygon{
+            .vertices = {triangle[0], triangle[1], triangle[2]},
+            .indices = {0, 1, 2},
+        };
+        FlipQuaternionIfOpposite(polygon.vertices[1].quat, polygon.vertices[0].quat);
+        FlipQuaternionIfOpposite(polygon.vertices[2].quat, polygon.vertices[0].quat);
+
+        ClipPolygon(polygon, edges, codes[0] | codes[1] | codes[2]);
+        if (polygon.indices.size() < 3) {
+            continue;
         }
+        SetupPolygon({polygon.vertices.data(), polygon.vertices.size()},
+                     {polygon.indices.data(), polygon.indices.size()});
     }
+    num_clip_batch = 0;
+}
 
-    MakeScreenCoords((*output_list)[0]);
-    MakeScreenCoords((*output_list)[1]);
+void RasterizerSoftware::SetupPolygon(std::span<Vertex> vertices, std::span<const u8> indices) {
+    MakeScreenCoords(vertices[indices[0]]);
+    MakeScreenCoords(vertices[indices[1]]);
 
-    for (std::size_t i = 0; i < output_list->size() - 2; i++) {
-        Vertex& vtx0 = (*output_list)[0];
-        Vertex& vtx1 = (*output_list)[i + 1];
-        Vertex& vtx2 = (*output_list)[i + 2];
+    for (std::size_t i = 0; i < indices.size() - 2; i++) {
+        Vertex& vtx0 = vertices[indices[0]];
+        Vertex& vtx1 = vertices[indices[i + 1]];
+        Vertex& vtx2 = vertices[indices[i + 2]];
 
         MakeScreenCoords(vtx2);
 
@@ -191,7 +261,7 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
             "Triangle {}/{} at position ({:.3}, {:.3}, {:.3}, {:.3f}), "
             "({:.3}, {:.3}, {:.3}, {:.3}), ({:.3}, {:.3}, {:.3}, {:.3}) and "
             "screen position ({:.2}, {:.2}, {:.2}), ({:.2}, {:.2}, {:.2}), ({:.2}, {:.2}, {:.2})",
-            i + 1, output_list->size() - 2, vtx0.pos.x.ToFloat32(), vtx0.pos.y.ToFloat32(),
+            i + 1, indices.size() - 2, vtx0.pos.x.ToFloat32(), vtx0.pos.y.ToFloat32(),
             vtx0.pos.z.ToFloat32(), vtx0.pos.w.ToFloat32(), vtx1.pos.x.ToFloat32(),
             vtx1.pos.y.ToFloat32(), vtx1.pos.z.ToFloat32(), vtx1.pos.w.ToFloat32(),
             vtx2.pos.x.ToFloat32(), vtx2.pos.y.ToFloat32(), vtx2.pos.z.ToFloat32(),
@@ -293,18 +363,131 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     const int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
 
-    const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+    triangles.push_back(Triangle{
+        .vertices = {v0, v1, v2},
+        .vtxpos = vtxpos,
+        .bias = {bias0, bias1, bias2},
+        .min_x = min_x,
+        .min_y = min_y,
+        .max_x = max_x,
+        .max_y = max_y,
+    });
+
+    // Queue the triangle to every tile its bounding box overlaps, the last pixel covered by the
+    // box is the one before max.
+    const u32 tile_x0 = (min_x >> 4) / TILE_SIZE;
+    const u32 tile_y0 = (min_y >> 4) / TILE_SIZE;
+    const u32 tile_x1 = ((max_x >> 4) - 1) / TILE_SIZE;
+    const u32 tile_y1 = ((max_y >> 4) - 1) / TILE_SIZE;
+    for (u32 tile_y = tile_y0; tile_y <= tile_y1; ++tile_y) {
+        for (u32 tile_x = tile_x0; tile_x <= tile_x1; ++tile_x) {
+            const u32 tile = tile_y * TILE_GRID_SIZE + tile_x;
+            if (tile_bins[tile].empty()) {
+                active_tiles.push_back(tile);
+            }
+            tile_bins[tile].push_back(triangle_index);
+        }
+    }
+}
 
+void RasterizerSoftware::FlushTiles() {
+    if (active_tiles.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Rasterization);
+
+    // The registers do not change within a draw, so every triangle binned since the last flush
+    // uses the current state.
+    fb.Bind();
     const auto textures = regs.texturing.GetTextures();
     const auto tev_stages = regs.texturing.GetTevStages();
+    if (regs.texturing.main_config.texture3_enable) {
+        proctex_cache.Sync(regs.texturing, pica.proctex);
+    }
 
-    fb.Bind();
+    // Each pixel belongs to a single tile, so processing the triangles of a tile in submission
+    // order keeps the output identical to rasterizing them one after another.
+    const auto rasterize_tile = [this, &textures, &tev_stages](u32 tile) {
+        const u32 tile_x = (tile % TILE_GRID_SIZE) * TILE_SIZE;
+        const u32 tile_y = (tile / TILE_GRID_SIZE) * TILE_SIZE;
+        for (const u32 triangle_index : tile_bins[tile]) {
+            const Triangle& triangle = triangles[triangle_index];
+            const u16 begin_x = static_cast<u16>(std::max<u32>(triangle.min_x, tile_x << 4));
+            const u16 begin_y = static_cast<u16>(std::max<u32>(triangle.min_y, tile_y << 4));
+            const u16 end_x =
+                static_cast<u16>(std::min<u32>(triangle.max_x, (tile_x + TILE_SIZE) << 4));
+            const u16 end_y =
+                static_cast<u16>(std::min<u32>(triangle.max_y, (tile_y + TILE_SIZE) << 4));
+            RasterizeTriangle(triangle, begin_x, begin_y, end_x, end_y, textures, tev_stages);
+        }
+    };
+
+    // The first tile is rasterized on the calling thread instead of idling until the rest finish
+    Common::TaskGroup group{Common::GetTaskScheduler()};
+    for (std::size_t i = 1; i < active_tiles.size(); i++) {
+        group.Run([&rasterize_tile, tile = active_tiles[i]] { rasterize_tile(tile); });
+    }
+    rasterize_tile(active_tiles.front());
+    group.Wait();
+
+    for (const u32 tile : active_tiles) {
+        tile_bins[tile].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+void RasterizerSoftware::RasterizeTriangle(
+    const Triangle& triangle, u16 begin_x, u16 begin_y, u16 end_x, u16 end_y,
+    std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures,
+    std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages) {
+    const Vertex& v0 = triangle.vertices[0];
+    const Vertex& v1 = triangle.vertices[1];
+    const Vertex& v2 = triangle.vertices[2];
+    const auto& vtxpos = triangle.vtxpos;
+    const int bias0 = triangle.bias[0];
+    const int bias1 = triangle.bias[1];
+    const int bias2 = triangle.bias[2];
+
+    const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+
+    // Convert the scissor box coordinates to 12.4 fixed point
+    const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
+    const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
+    const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
+
+    // Not fully accurate. About 3 bits in precision are missing.
+    // Z-Buffer (z / w * scale + offset)
+    const float depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    const float depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
-    // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        const auto process_scanline = [&, y] {
-            for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+    // Fragments are set up one at a time, and then go through the combiners together in groups
+    // of QUAD_SIZE horizontally adjacent pixels.
+    for (u16 y = begin_y + 8; y < end_y; y += 0x10) {
+        for (u32 quad_x = begin_x + 8u; quad_x < end_x; quad_x += QUAD_SIZE * 0x10) {
+            u32 coverage = 0;
+            std::array<float, QUAD_SIZE> depths{};
+            FragmentQuad primary_color{};
+            FragmentQuad primary_fragment_color{};
+            FragmentQuad secondary_fragment_color{};
+            std::array<FragmentQuad, 4> texture_color{};
+
+            for (u32 lane = 0; lane < QUAD_SIZE; ++lane) {
+                const u32 lane_x = quad_x + lane * 0x10;
+                if (lane_x >= end_x) {
+                    break;
+                }
+                const u16 x = static_cast<u16>(lane_x);
+
                 // Do not process the pixel if it's inside the scissor box and the scissor mode is
                 // set to Exclude.
                 if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
@@ -323,6 +506,7 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                 if (w0 < 0 || w1 < 0 || w2 < 0) {
                     continue;
                 }
+                coverage |= 1U << lane;
 
                 const auto baricentric_coordinates = Common::MakeVec(
                     f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
@@ -336,12 +520,6 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                      v2.screenpos[2].ToFloat32() * w2) /
                     wsum;
 
-                // Not fully accurate. About 3 bits in precision are missing.
-                // Z-Buffer (z / w * scale + offset)
-                const float depth_scale =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-                const float depth_offset =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
                 float depth = interpolated_z_over_w * depth_scale + depth_offset;
 
                 // Potentially switch to W-Buffer
@@ -352,7 +530,7 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                 }
 
                 // Clamp the result
-                depth = std::clamp(depth, 0.0f, 1.0f);
+                depths[lane] = std::clamp(depth, 0.0f, 1.0f);
 
                 /**
                  * Perspective correct attribute interpolation:
@@ -378,24 +556,16 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                         Common::Dot(attr_over_w, baricentric_coordinates);
                     return interpolated_attr_over_w * interpolated_w_inverse;
                 };
+                const auto get_interpolated_color = [&](f24 attr0, f24 attr1, f24 attr2) {
+                    return static_cast<u8>(
+                        round(get_interpolated_attribute(attr0, attr1, attr2).ToFloat32() * 255));
+                };
 
-                const Common::Vec4<u8> primary_color{
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
-                                  .ToFloat32() *
-                              255)),
+                primary_color[lane] = {
+                    get_interpolated_color(v0.color.r(), v1.color.r(), v2.color.r()),
+                    get_interpolated_color(v0.color.g(), v1.color.g(), v2.color.g()),
+                    get_interpolated_color(v0.color.b(), v1.color.b(), v2.color.b()),
+                    get_interpolated_color(v0.color.a(), v1.color.a(), v2.color.a()),
                 };
 
                 std::array<Common::Vec2<f24>, 3> uv;
@@ -408,10 +578,10 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
 
                 // Sample bound texture units.
                 const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-                const auto texture_color = TextureColor(uv, textures, tc0_w);
-
-                Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
-                Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+                const auto lane_texture_color = TextureColor(uv, textures, tc0_w);
+                for (std::size_t unit = 0; unit < texture_color.size(); ++unit) {
+                    texture_color[unit][lane] = lane_texture_color[unit];
+                }
 
                 if (!regs.lighting.disable) {
                     const auto normquat =
@@ -431,17 +601,30 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                         get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
                         get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                     };
-                    std::tie(primary_fragment_color, secondary_fragment_color) =
+                    std::tie(primary_fragment_color[lane], secondary_fragment_color[lane]) =
                         ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
-                                               texture_color);
+                                               lane_texture_color);
                 }
+            }
 
-                // Write the TEV stages.
-                auto combiner_output =
-                    WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
-                                   secondary_fragment_color);
+            if (coverage == 0) {
+                continue;
+            }
+
+            // Write the TEV stages.
+            auto combiner_outputs =
+                WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
+                               secondary_fragment_color);
+
+            const auto& output_merger = regs.framebuffer.output_merger;
+            for (u32 lane = 0; lane < QUAD_SIZE; ++lane) {
+                if ((coverage & (1U << lane)) == 0) {
+                    continue;
+                }
+                const u16 x = static_cast<u16>(quad_x + lane * 0x10);
+                const float depth = depths[lane];
+                Common::Vec4<u8>& combiner_output = combiner_outputs[lane];
 
-                const auto& output_merger = regs.framebuffer.output_merger;
                 if (output_merger.fragment_operation_mode ==
                     FramebufferRegs::FragmentOperationMode::Shadow) {
                     const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
@@ -465,10 +648,8 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                     fb.DrawPixel(x >> 4, y >> 4, result);
                 }
             }
-        };
-        sw_workers.QueueWork(std::move(process_scanline));
+        }
     }
-    sw_workers.WaitForRequests();
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -584,8 +765,8 @@ std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
     // Sample procedural texture
     if (regs.texturing.main_config.texture3_enable) {
         const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
-        texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
-                                   regs.texturing, pica.proctex);
+        texture_color[3] =
+            proctex_cache.Sample(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32());
     }
 
     return texture_color;
@@ -682,11 +863,11 @@ Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
     return result;
 }
 
-Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
-    std::span<const Common::Vec4<u8>, 4> texture_color,
+FragmentQuad RasterizerSoftware::WriteTevConfig(
+    std::span<const FragmentQuad, 4> texture_color,
     std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-    Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-    Common::Vec4<u8> secondary_fragment_color) {
+    const FragmentQuad& primary_color, const FragmentQuad& primary_fragment_color,
+    const FragmentQuad& secondary_fragment_color) {
     /**
      * Texture environment - consists of 6 stages of color and alpha combining.
      * Color combiners take three input color values from some source (e.g. interpolated
@@ -695,20 +876,32 @@ Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
      * with some basic arithmetic. Alpha combiners can be configured separately but work
      * analogously.
      **/
-    Common::Vec4<u8> combiner_output = {0, 0, 0, 0};
-    Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-    Common::Vec4<u8> next_combiner_buffer =
-        Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                        regs.texturing.tev_combiner_buffer_color.g.Value(),
-                        regs.texturing.tev_combiner_buffer_color.b.Value(),
-                        regs.texturing.tev_combiner_buffer_color.a.Value())
-            .Cast<u8>();
+    const auto splat = [](Common::Vec4<u8> value) {
+        FragmentQuad quad;
+        quad.fill(value);
+        return quad;
+    };
+
+    FragmentQuad combiner_output = splat({0, 0, 0, 0});
+    FragmentQuad combiner_buffer = splat({0, 0, 0, 0});
+    FragmentQuad next_combiner_buffer =
+        splat(Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
+                              regs.texturing.tev_combiner_buffer_color.g.Value(),
+                              regs.texturing.tev_combiner_buffer_color.b.Value(),
+                              regs.texturing.tev_combiner_buffer_color.a.Value())
+                  .Cast<u8>());
 
     for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
         const auto& tev_stage = tev_stages[tev_stage_index];
         using Source = TexturingRegs::TevStageConfig::Source;
 
-        auto get_source = [&](Source source) -> Common::Vec4<u8> {
+        const FragmentQuad constant =
+            splat(Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                  tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                      .Cast<u8>());
+        const FragmentQuad zero = splat({0, 0, 0, 0});
+
+        auto get_source = [&](Source source) -> const FragmentQuad& {
             switch (source) {
             case Source::PrimaryColor:
                 return primary_color;
@@ -727,15 +920,13 @@ Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
             case Source::PreviousBuffer:
                 return combiner_buffer;
             case Source::Constant:
-                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                    .Cast<u8>();
+                return constant;
             case Source::Previous:
                 return combiner_output;
             default:
                 LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
                 UNIMPLEMENTED();
-                return {0, 0, 0, 0};
+                return zero;
             }
         };
 
@@ -752,20 +943,22 @@ Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
         const auto source2 = tev_stage_index == 0 && tev_stage.color_source2 == Source::Previous
                                  ? tev_stage.color_source3.Value()
                                  : tev_stage.color_source2.Value();
-        const std::array<Common::Vec3<u8>, 3> color_result = {
+        const std::array<FragmentQuad, 3> color_result = {
             GetColorModifier(tev_stage.color_modifier1, get_source(source1)),
             GetColorModifier(tev_stage.color_modifier2, get_source(source2)),
             GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
         };
-        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
+        const FragmentQuad color_output = ColorCombine(tev_stage.color_op, color_result);
 
-        u8 alpha_output;
+        AlphaQuad alpha_output;
         if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
             // result of Dot3_RGBA operation is also placed to the alpha component
-            alpha_output = color_output.x;
+            for (std::size_t lane = 0; lane < alpha_output.size(); ++lane) {
+                alpha_output[lane] = color_output[lane].x;
+            }
         } else {
             // alpha combiner
-            const std::array<u8, 3> alpha_result = {{
+            const std::array<AlphaQuad, 3> alpha_result = {{
                 GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
                 GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
                 GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
@@ -773,23 +966,34 @@ Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
             alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
         }
 
-        combiner_output[0] = std::min(255U, color_output.r() * tev_stage.GetColorMultiplier());
-        combiner_output[1] = std::min(255U, color_output.g() * tev_stage.GetColorMultiplier());
-        combiner_output[2] = std::min(255U, color_output.b() * tev_stage.GetColorMultiplier());
-        combiner_output[3] = std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier());
+        const u32 color_multiplier = tev_stage.GetColorMultiplier();
+        const u32 alpha_multiplier = tev_stage.GetAlphaMultiplier();
+        for (std::size_t lane = 0; lane < combiner_output.size(); ++lane) {
+            for (std::size_t comp = 0; comp < 3; ++comp) {
+                combiner_output[lane][comp] =
+                    static_cast<u8>(std::min(255U, color_output[lane][comp] * color_multiplier));
+            }
+            combiner_output[lane][3] =
+                static_cast<u8>(std::min(255U, alpha_output[lane] * alpha_multiplier));
+        }
 
         combiner_buffer = next_combiner_buffer;
 
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                tev_stage_index)) {
-            next_combiner_buffer.r() = combiner_output.r();
-            next_combiner_buffer.g() = combiner_output.g();
-            next_combiner_buffer.b() = combiner_output.b();
-        }
-
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                tev_stage_index)) {
-            next_combiner_buffer.a() = combiner_output.a();
+        const bool update_color =
+            regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
+                tev_stage_index);
+        const bool update_alpha =
+            regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
+                tev_stage_index);
+        for (std::size_t lane = 0; lane < next_combiner_buffer.size(); ++lane) {
+            if (update_color) {
+                next_combiner_buffer[lane].r() = combiner_output[lane].r();
+                next_combiner_buffer[lane].g() = combiner_output[lane].g();
+                next_combiner_buffer[lane].b() = combiner_output[lane].b();
+            }
+            if (update_alpha) {
+                next_combiner_buffer[lane].a() = combiner_output[lane].a();
+            }
         }
     }
 
@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <array>
 #include <span>
-#include "common/thread_worker.h"
+#include <vector>
+#include "video_core/pica/output_vertex.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_proctex.h"
+#include "video_core/renderer_software/sw_texturing.h"
 
 namespace Pica {
 struct RegsInternal;
@@ -23,10 +27,14 @@ struct Vertex;
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
 
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
-    void DrawTriangles() override {}
+    void DrawTriangles() override {
+        ClipTriangles();
+        FlushTiles();
+    }
     void FlushAll() override {}
     void FlushRegion(PAddr addr, u32 size) override {}
     void InvalidateRegion(PAddr addr, u32 size) override {}
@@ -34,13 +42,39 @@ public:
     void ClearAll(bool flush) override {}
 
 private:
+    struct Triangle;
+
+    /// Width and height in pixels of the screen tiles triangles are binned to.
+    static constexpr u32 TILE_SIZE = 32;
+    /// Number of tiles along each axis, covering the whole 12.4 fixed point coordinate range.
+    static constexpr u32 TILE_GRID_SIZE = 4096 / TILE_SIZE;
+    /// Number of horizontally adjacent fragments combined together.
+    static constexpr u32 QUAD_SIZE = std::tuple_size_v<FragmentQuad>;
+    /// Number of triangles whose clip codes are computed together.
+    static constexpr std::size_t CLIP_BATCH_SIZE = 8;
+
+    /// Clips the batched triangles and sets up the visible parts of them.
+    void ClipTriangles();
+
+    /// Sets up the triangle fan of the provided clipped polygon.
+    void SetupPolygon(std::span<Vertex> vertices, std::span<const u8> indices);
+
     /// Computes the screen coordinates of the provided vertex.
     void MakeScreenCoords(Vertex& vtx);
 
-    /// Processes the triangle defined by the provided vertices.
+    /// Sets up the triangle defined by the provided vertices and bins it to the tiles it covers.
     void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                          bool reversed = false);
 
+    /// Rasterizes the binned triangles, processing the tiles in parallel.
+    void FlushTiles();
+
+    /// Rasterizes the pixels of the triangle inside the provided 12.4 fixed point bounds.
+    void RasterizeTriangle(const Triangle& triangle, u16 begin_x, u16 begin_y, u16 end_x,
+                           u16 end_y,
+                           std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures,
+                           std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages);
+
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
         std::span<const Common::Vec2<f24>, 3> uv,
@@ -49,12 +83,12 @@ private:
     /// Returns the final pixel color with blending or logic ops applied.
     Common::Vec4<u8> PixelColor(u16 x, u16 y, Common::Vec4<u8> combiner_output) const;
 
-    /// Emulates the TEV configuration and returns the combiner output.
-    Common::Vec4<u8> WriteTevConfig(
-        std::span<const Common::Vec4<u8>, 4> texture_color,
-        std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-        Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-        Common::Vec4<u8> secondary_fragment_color);
+    /// Emulates the TEV configuration and returns the combiner outputs of a fragment quad.
+    FragmentQuad WriteTevConfig(std::span<const FragmentQuad, 4> texture_color,
+                                std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
+                                const FragmentQuad& primary_color,
+                                const FragmentQuad& primary_fragment_color,
+                                const FragmentQuad& secondary_fragment_color);
 
     /// Blends fog to the combiner output if enabled.
     void WriteFog(float depth, Common::Vec4<u8>& combiner_output) const;
@@ -69,9 +103,14 @@ private:
     Memory::MemorySystem& memory;
     Pica::PicaCore& pica;
     Pica::RegsInternal& regs;
-    std::size_t num_sw_threads;
-    Common::ThreadWorker sw_workers;
     Framebuffer fb;
+    std::array<Pica::OutputVertex, CLIP_BATCH_SIZE * 3> clip_batch;
+    std::size_t num_clip_batch{};
+    std::vector<Triangle> triangles;
+    /// Indices of the triangles overlapping each tile, in submission order.
+    std::vector<std::vector<u32>> tile_bins;
+    std::vector<u32> active_tiles;
+    ProcTexCache proctex_cache;
 };
 
 } // namespace SwRenderer
@@ -204,4 +204,177 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     }
 };
 
+namespace {
+
+/// Applies func to the red, green, blue and alpha components of every fragment.
+template <typename Func>
+FragmentQuad MapColor(std::span<const FragmentQuad, 3> input, Func&& func) {
+    FragmentQuad result;
+    for (std::size_t lane = 0; lane < result.size(); ++lane) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            result[lane][comp] = static_cast<u8>(
+                func(s32{input[0][lane][comp]}, s32{input[1][lane][comp]},
+                     s32{input[2][lane][comp]}));
+        }
+    }
+    return result;
+}
+
+template <typename Func>
+AlphaQuad MapAlpha(std::span<const AlphaQuad, 3> input, Func&& func) {
+    AlphaQuad result;
+    for (std::size_t lane = 0; lane < result.size(); ++lane) {
+        result[lane] =
+            static_cast<u8>(func(s32{input[0][lane]}, s32{input[1][lane]}, s32{input[2][lane]}));
+    }
+    return result;
+}
+
+} // Anonymous namespace
+
+FragmentQuad GetColorModifier(TevStageConfig::ColorModifier factor, const FragmentQuad& values) {
+    using ColorModifier = TevStageConfig::ColorModifier;
+
+    std::array<std::size_t, 3> swizzle;
+    switch (factor) {
+    case ColorModifier::SourceColor:
+    case ColorModifier::OneMinusSourceColor:
+        swizzle = {0, 1, 2};
+        break;
+    case ColorModifier::SourceAlpha:
+    case ColorModifier::OneMinusSourceAlpha:
+        swizzle = {3, 3, 3};
+        break;
+    case ColorModifier::SourceRed:
+    case ColorModifier::OneMinusSourceRed:
+        swizzle = {0, 0, 0};
+        break;
+    case ColorModifier::SourceGreen:
+    case ColorModifier::OneMinusSourceGreen:
+        swizzle = {1, 1, 1};
+        break;
+    case ColorModifier::SourceBlue:
+    case ColorModifier::OneMinusSourceBlue:
+        swizzle = {2, 2, 2};
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    // Every inverted modifier has the lowest bit set.
+    const u8 invert = (static_cast<u32>(factor) & 1) != 0 ? 255 : 0;
+    FragmentQuad result{};
+    for (std::size_t lane = 0; lane < result.size(); ++lane) {
+        for (std::size_t comp = 0; comp < swizzle.size(); ++comp) {
+            result[lane][comp] = values[lane][swizzle[comp]] ^ invert;
+        }
+    }
+    return result;
+}
+
+AlphaQuad GetAlphaModifier(TevStageConfig::AlphaModifier factor, const FragmentQuad& values) {
+    using AlphaModifier = TevStageConfig::AlphaModifier;
+
+    std::size_t comp;
+    switch (factor) {
+    case AlphaModifier::SourceAlpha:
+    case AlphaModifier::OneMinusSourceAlpha:
+        comp = 3;
+        break;
+    case AlphaModifier::SourceRed:
+    case AlphaModifier::OneMinusSourceRed:
+        comp = 0;
+        break;
+    case AlphaModifier::SourceGreen:
+    case AlphaModifier::OneMinusSourceGreen:
+        comp = 1;
+        break;
+    case AlphaModifier::SourceBlue:
+    case AlphaModifier::OneMinusSourceBlue:
+        comp = 2;
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    const u8 invert = (static_cast<u32>(factor) & 1) != 0 ? 255 : 0;
+    AlphaQuad result;
+    for (std::size_t lane = 0; lane < result.size(); ++lane) {
+        result[lane] = values[lane][comp] ^ invert;
+    }
+    return result;
+}
+
+FragmentQuad ColorCombine(TevStageConfig::Operation op, std::span<const FragmentQuad, 3> input) {
+    using Operation = TevStageConfig::Operation;
+
+    switch (op) {
+    case Operation::Replace:
+        return input[0];
+    case Operation::Modulate:
+        return MapColor(input, [](s32 a, s32 b, s32) { return a * b / 255; });
+    case Operation::Add:
+        return MapColor(input, [](s32 a, s32 b, s32) { return std::min(255, a + b); });
+    case Operation::AddSigned:
+        return MapColor(input, [](s32 a, s32 b, s32) { return std::clamp(a + b - 128, 0, 255); });
+    case Operation::Lerp:
+        return MapColor(input, [](s32 a, s32 b, s32 c) { return (a * c + b * (255 - c)) / 255; });
+    case Operation::Subtract:
+        return MapColor(input, [](s32 a, s32 b, s32) { return std::max(0, a - b); });
+    case Operation::MultiplyThenAdd:
+        return MapColor(input,
+                        [](s32 a, s32 b, s32 c) { return std::min(255, (a * b + 255 * c) / 255); });
+    case Operation::AddThenMultiply:
+        return MapColor(input,
+                        [](s32 a, s32 b, s32 c) { return std::min(255, a + b) * c / 255; });
+    case Operation::Dot3_RGB:
+    case Operation::Dot3_RGBA: {
+        FragmentQuad result{};
+        for (std::size_t lane = 0; lane < result.size(); ++lane) {
+            s32 dot = 0;
+            for (std::size_t comp = 0; comp < 3; ++comp) {
+                dot += ((input[0][lane][comp] * 2 - 255) * (input[1][lane][comp] * 2 - 255) + 128) /
+                       256;
+            }
+            const u8 value = static_cast<u8>(std::clamp(dot, 0, 255));
+            result[lane] = {value, value, value, 0};
+        }
+        return result;
+    }
+    default:
+        LOG_ERROR(HW_GPU, "Unknown color combiner operation {}", (int)op);
+        UNIMPLEMENTED();
+        return {};
+    }
+}
+
+AlphaQuad AlphaCombine(TevStageConfig::Operation op, std::span<const AlphaQuad, 3> input) {
+    using Operation = TevStageConfig::Operation;
+
+    switch (op) {
+    case Operation::Replace:
+        return input[0];
+    case Operation::Modulate:
+        return MapAlpha(input, [](s32 a, s32 b, s32) { return a * b / 255; });
+    case Operation::Add:
+        return MapAlpha(input, [](s32 a, s32 b, s32) { return std::min(255, a + b); });
+    case Operation::AddSigned:
+        return MapAlpha(input, [](s32 a, s32 b, s32) { return std::clamp(a + b - 128, 0, 255); });
+    case Operation::Lerp:
+        return MapAlpha(input, [](s32 a, s32 b, s32 c) { return (a * c + b * (255 - c)) / 255; });
+    case Operation::Subtract:
+        return MapAlpha(input, [](s32 a, s32 b, s32) { return std::max(0, a - b); });
+    case Operation::MultiplyThenAdd:
+        return MapAlpha(input,
+                        [](s32 a, s32 b, s32 c) { return std::min(255, (a * b + 255 * c) / 255); });
+    case Operation::AddThenMultiply:
+        return MapAlpha(input,
+                        [](s32 a, s32 b, s32 c) { return std::min(255, a + b) * c / 255; });
+    default:
+        LOG_ERROR(HW_GPU, "Unknown alpha combiner operation {}", (int)op);
+        UNIMPLEMENTED();
+        return {};
+    }
+}
+
 } // namespace SwRenderer
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <span>
 
 #include "common/common_types.h"
@@ -25,4 +26,26 @@ Common::Vec3<u8> ColorCombine(Pica::TexturingRegs::TevStageConfig::Operation op,
 
 u8 AlphaCombine(Pica::TexturingRegs::TevStageConfig::Operation op, const std::array<u8, 3>& input);
 
+/**
+ * Colors of four fragments processed together. The quad variants of the combiner functions apply
+ * the same operation to every lane with the operation resolved once, matching the results of the
+ * scalar functions exactly while letting the compiler vectorize the component loops.
+ */
+using FragmentQuad = std::array<Common::Vec4<u8>, 4>;
+using AlphaQuad = std::array<u8, 4>;
+
+/// Returns the modified color of each fragment, the alpha component of the result is unspecified.
+FragmentQuad GetColorModifier(Pica::TexturingRegs::TevStageConfig::ColorModifier factor,
+                              const FragmentQuad& values);
+
+AlphaQuad GetAlphaModifier(Pica::TexturingRegs::TevStageConfig::AlphaModifier factor,
+                           const FragmentQuad& values);
+
+/// Returns the combined color of each fragment, the alpha component of the result is unspecified.
+FragmentQuad ColorCombine(Pica::TexturingRegs::TevStageConfig::Operation op,
+                          std::span<const FragmentQuad, 3> input);
+
+AlphaQuad AlphaCombine(Pica::TexturingRegs::TevStageConfig::Operation op,
+                       std::span<const AlphaQuad, 3> input);
+
 } // namespace SwRenderer
@@ -18,6 +18,7 @@
 #include "video_core/host_shaders/vulkan_present_anaglyph_frag.h"
 #include "video_core/host_shaders/vulkan_present_frag.h"
 #include "video_core/host_shaders/vulkan_present_interlaced_frag.h"
+#include "video_core/host_shaders/vulkan_present_upscale_frag.h"
 #include "video_core/host_shaders/vulkan_present_vert.h"
 #include "common/cpu_affinity.h"
 
@@ -124,6 +125,7 @@ RendererVulkan::RendererVulkan(Core::System& system, Pica::PicaCore& pica_,
     CompileShaders();
     BuildLayouts();
     BuildPipelines();
+    ReloadPipeline(Settings::values.render_3d.GetValue());
     if (secondary_window) {
         secondary_present_window_ptr = std::make_unique<PresentWindow>(
             *secondary_window, instance, scheduler, IsLowRefreshRate());
@@ -177,7 +179,7 @@ void RendererVulkan::PrepareRendertarget() {
 }
 
 void RendererVulkan::PrepareDraw(Frame* frame, const Layout::FramebufferLayout& layout) {
-    const auto sampler = present_samplers[!Settings::values.filter_mode.GetValue()];
+    const auto sampler = present_samplers[!pica.runtime_settings.filter_mode];
     const auto present_set = present_heap.Commit();
     for (u32 index = 0; index < screen_infos.size(); index++) {
         update_queue.AddImageSampler(present_set, 0, index, screen_infos[index].image_view,
@@ -185,6 +187,7 @@ void RendererVulkan::PrepareDraw(Frame* frame, const Layout::FramebufferLayout&
     }
 
     renderpass_cache.EndRendering();
+    scheduler.BeginPassTiming(Core::PerfStats::GpuPass::Present);
     scheduler.Record([this, layout, frame, present_set,
                       renderpass = main_present_window.Renderpass(),
                       index = current_pipeline](vk::CommandBuffer cmdbuf) {
@@ -290,6 +293,8 @@ void RendererVulkan::CompileShaders() {
                                  vk::ShaderStageFlagBits::eFragment, device, preamble);
     present_shaders[2] = Compile(HostShaders::VULKAN_PRESENT_INTERLACED_FRAG,
                                  vk::ShaderStageFlagBits::eFragment, device, preamble);
+    present_shaders[3] = Compile(HostShaders::VULKAN_PRESENT_UPSCALE_FRAG,
+                                 vk::ShaderStageFlagBits::eFragment, device, preamble);
 
     auto properties = instance.GetPhysicalDevice().getProperties();
     for (std::size_t i = 0; i < present_samplers.size(); i++) {
@@ -587,7 +592,7 @@ void RendererVulkan::ReloadPipeline(Settings::StereoRenderOption render_3d) {
         draw_info.reverse_interlaced = render_3d == Settings::StereoRenderOption::ReverseInterlaced;
         break;
     default:
-        current_pipeline = 0;
+        current_pipeline = Settings::values.spatial_upscaling.GetValue() ? 3 : 0;
         break;
     }
 }
@@ -749,8 +754,8 @@ void RendererVulkan::DrawTopScreen(const Layout::FramebufferLayout& layout,
         return;
     }
     int leftside, rightside;
-    leftside = Settings::values.swap_eyes_3d.GetValue() ? 1 : 0;
-    rightside = Settings::values.swap_eyes_3d.GetValue() ? 0 : 1;
+    leftside = pica.runtime_settings.swap_eyes_3d ? 1 : 0;
+    rightside = pica.runtime_settings.swap_eyes_3d ? 0 : 1;
     const float top_screen_left = static_cast<float>(top_screen.left);
     const float top_screen_top = static_cast<float>(top_screen.top);
     const float top_screen_width = static_cast<float>(top_screen.GetWidth());
@@ -760,7 +765,7 @@ void RendererVulkan::DrawTopScreen(const Layout::FramebufferLayout& layout,
                                                : Layout::DisplayOrientation::Portrait;
     switch (layout.render_3d_mode) {
     case Settings::StereoRenderOption::Off: {
-        const int eye = static_cast<int>(Settings::values.mono_render_option.GetValue());
+        const int eye = static_cast<int>(pica.runtime_settings.mono_render_option);
         DrawSingleScreen(eye, top_screen_left, top_screen_top, top_screen_width, top_screen_height,
                          orientation);
         break;
@@ -907,13 +912,13 @@ void RendererVulkan::DrawScreens(Frame* frame, const Layout::FramebufferLayout&
     }
 
     scheduler.Record([](vk::CommandBuffer cmdbuf) { cmdbuf.endRenderPass(); });
+    scheduler.EndPassTiming();
 }
 
 void RendererVulkan::SwapBuffers() {
-    static bool affinity_set = false;
-    if (!affinity_set) {
-        Common::SetBigCoreAffinity(); // <-- AJOUTER ICI
-        affinity_set = true;
+    // Presenting from the emulation thread keeps it on the prime cores
+    if (Common::GetCurrentThreadCoreClass() == Common::CoreClass::Any) {
+        Common::SetCurrentThreadCoreClass(Common::CoreClass::Performance);
     }
     system.perf_stats->StartSwap();
     const Layout::FramebufferLayout& layout = render_window.GetFramebufferLayout();
@@ -946,7 +951,13 @@ void RendererVulkan::SwapBuffers() {
 #endif
 
     system.perf_stats->EndSwap();
+    if (const auto gpu_times = scheduler.EndFrameTiming()) {
+        ReportGpuFrameTime(std::chrono::duration_cast<std::chrono::nanoseconds>(gpu_times->busy));
+        system.perf_stats->ReportGpuTimes(*gpu_times);
+    }
     rasterizer.TickFrame();
+    system.perf_stats->ReportTextureMemoryUsage(rasterizer.GetTextureMemoryUsage());
+    system.perf_stats->ReportPresentLatency(main_present_window.PresentLatency());
     EndFrame();
 }
 
@@ -14,7 +14,10 @@
 #include "video_core/host_shaders/format_reinterpreter/vulkan_d24s8_to_rgba8_comp.h"
 #include "video_core/host_shaders/full_screen_triangle_vert.h"
 #include "video_core/host_shaders/vulkan_blit_depth_stencil_frag.h"
+#include "video_core/host_shaders/vulkan_decode_tiled_comp.h"
 #include "video_core/host_shaders/vulkan_depth_to_buffer_comp.h"
+#include "video_core/host_shaders/vulkan_encode_tiled_comp.h"
+#include "video_core/host_shaders/vulkan_expand_indices_comp.h"
 
 namespace Vulkan {
 
@@ -32,12 +35,32 @@ struct ComputeInfo {
     Common::Vec2i src_extent;
 };
 
+struct TiledInfo {
+    u32 input_offset;
+    u32 output_offset;
+    u32 width;
+    u32 height;
+    u32 format;
+    u32 converted;
+};
+
+struct ExpandInfo {
+    u32 output_offset;
+    u32 num_indices;
+};
+
 inline constexpr vk::PushConstantRange COMPUTE_PUSH_CONSTANT_RANGE{
     .stageFlags = vk::ShaderStageFlagBits::eCompute,
     .offset = 0,
     .size = sizeof(ComputeInfo),
 };
 
+inline constexpr vk::PushConstantRange TILED_PUSH_CONSTANT_RANGE{
+    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+    .offset = 0,
+    .size = sizeof(TiledInfo),
+};
+
 constexpr std::array<vk::DescriptorSetLayoutBinding, 3> COMPUTE_BINDINGS = {{
     {0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
     {1, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
@@ -50,6 +73,10 @@ constexpr std::array<vk::DescriptorSetLayoutBinding, 3> COMPUTE_BUFFER_BINDINGS
     {2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
 }};
 
+constexpr std::array<vk::DescriptorSetLayoutBinding, 1> TILED_BINDINGS = {{
+    {0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+}};
+
 constexpr std::array<vk::DescriptorSetLayoutBinding, 2> TWO_TEXTURES_BINDINGS = {{
     {0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment},
     {1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment},
@@ -185,12 +212,19 @@ BlitHelper::BlitHelper(const Instance& instance_, Scheduler& scheduler_,
       compute_provider{instance, scheduler.GetMasterSemaphore(), COMPUTE_BINDINGS},
       compute_buffer_provider{instance, scheduler.GetMasterSemaphore(), COMPUTE_BUFFER_BINDINGS},
       two_textures_provider{instance, scheduler.GetMasterSemaphore(), TWO_TEXTURES_BINDINGS, 16},
+      tiled_provider{instance, scheduler.GetMasterSemaphore(), TILED_BINDINGS},
       compute_pipeline_layout{
           device.createPipelineLayout(PipelineLayoutCreateInfo(&compute_provider.Layout(), true))},
       compute_buffer_pipeline_layout{device.createPipelineLayout(
           PipelineLayoutCreateInfo(&compute_buffer_provider.Layout(), true))},
       two_textures_pipeline_layout{
           device.createPipelineLayout(PipelineLayoutCreateInfo(&two_textures_provider.Layout()))},
+      tiled_pipeline_layout{device.createPipelineLayout({
+          .setLayoutCount = 1,
+          .pSetLayouts = &tiled_provider.Layout(),
+          .pushConstantRangeCount = 1,
+          .pPushConstantRanges = &TILED_PUSH_CONSTANT_RANGE,
+      })},
       full_screen_vert{Compile(HostShaders::FULL_SCREEN_TRIANGLE_VERT,
                                vk::ShaderStageFlagBits::eVertex, device)},
       d24s8_to_rgba8_comp{Compile(HostShaders::VULKAN_D24S8_TO_RGBA8_COMP,
@@ -199,9 +233,18 @@ BlitHelper::BlitHelper(const Instance& instance_, Scheduler& scheduler_,
                                    vk::ShaderStageFlagBits::eCompute, device)},
       blit_depth_stencil_frag{Compile(HostShaders::VULKAN_BLIT_DEPTH_STENCIL_FRAG,
                                       vk::ShaderStageFlagBits::eFragment, device)},
+      decode_tiled_comp{Compile(HostShaders::VULKAN_DECODE_TILED_COMP,
+                                vk::ShaderStageFlagBits::eCompute, device)},
+      encode_tiled_comp{Compile(HostShaders::VULKAN_ENCODE_TILED_COMP,
+                                vk::ShaderStageFlagBits::eCompute, device)},
+      expand_indices_comp{Compile(HostShaders::VULKAN_EXPAND_INDICES_COMP,
+                                  vk::ShaderStageFlagBits::eCompute, device)},
       d24s8_to_rgba8_pipeline{MakeComputePipeline(d24s8_to_rgba8_comp, compute_pipeline_layout)},
       depth_to_buffer_pipeline{
           MakeComputePipeline(depth_to_buffer_comp, compute_buffer_pipeline_layout)},
+      decode_tiled_pipeline{MakeComputePipeline(decode_tiled_comp, tiled_pipeline_layout)},
+      encode_tiled_pipeline{MakeComputePipeline(encode_tiled_comp, tiled_pipeline_layout)},
+      expand_indices_pipeline{MakeComputePipeline(expand_indices_comp, tiled_pipeline_layout)},
       depth_blit_pipeline{MakeDepthStencilBlitPipeline()},
       linear_sampler{device.createSampler(SAMPLER_CREATE_INFO<vk::Filter::eLinear>)},
       nearest_sampler{device.createSampler(SAMPLER_CREATE_INFO<vk::Filter::eNearest>)} {
@@ -212,12 +255,20 @@ BlitHelper::BlitHelper(const Instance& instance_, Scheduler& scheduler_,
                       "BlitHelper: compute_buffer_pipeline_layout");
         SetObjectName(device, two_textures_pipeline_layout,
                       "BlitHelper: two_textures_pipeline_layout");
+        SetObjectName(device, tiled_pipeline_layout,
+                      "BlitHelper: tiled_pipeline_layout");
         SetObjectName(device, full_screen_vert, "BlitHelper: full_screen_vert");
         SetObjectName(device, d24s8_to_rgba8_comp, "BlitHelper: d24s8_to_rgba8_comp");
         SetObjectName(device, depth_to_buffer_comp, "BlitHelper: depth_to_buffer_comp");
         SetObjectName(device, blit_depth_stencil_frag, "BlitHelper: blit_depth_stencil_frag");
+        SetObjectName(device, decode_tiled_comp, "BlitHelper: decode_tiled_comp");
+        SetObjectName(device, encode_tiled_comp, "BlitHelper: encode_tiled_comp");
+        SetObjectName(device, expand_indices_comp, "BlitHelper: expand_indices_comp");
         SetObjectName(device, d24s8_to_rgba8_pipeline, "BlitHelper: d24s8_to_rgba8_pipeline");
         SetObjectName(device, depth_to_buffer_pipeline, "BlitHelper: depth_to_buffer_pipeline");
+        SetObjectName(device, decode_tiled_pipeline, "BlitHelper: decode_tiled_pipeline");
+        SetObjectName(device, encode_tiled_pipeline, "BlitHelper: encode_tiled_pipeline");
+        SetObjectName(device, expand_indices_pipeline, "BlitHelper: expand_indices_pipeline");
         if (depth_blit_pipeline) {
             SetObjectName(device, depth_blit_pipeline, "BlitHelper: depth_blit_pipeline");
         }
@@ -230,12 +281,19 @@ BlitHelper::~BlitHelper() {
     device.destroyPipelineLayout(compute_pipeline_layout);
     device.destroyPipelineLayout(compute_buffer_pipeline_layout);
     device.destroyPipelineLayout(two_textures_pipeline_layout);
+    device.destroyPipelineLayout(tiled_pipeline_layout);
     device.destroyShaderModule(full_screen_vert);
     device.destroyShaderModule(d24s8_to_rgba8_comp);
     device.destroyShaderModule(depth_to_buffer_comp);
     device.destroyShaderModule(blit_depth_stencil_frag);
+    device.destroyShaderModule(decode_tiled_comp);
+    device.destroyShaderModule(encode_tiled_comp);
+    device.destroyShaderModule(expand_indices_comp);
     device.destroyPipeline(depth_to_buffer_pipeline);
     device.destroyPipeline(d24s8_to_rgba8_pipeline);
+    device.destroyPipeline(decode_tiled_pipeline);
+    device.destroyPipeline(encode_tiled_pipeline);
+    device.destroyPipeline(expand_indices_pipeline);
     device.destroyPipeline(depth_blit_pipeline);
     device.destroySampler(linear_sampler);
     device.destroySampler(nearest_sampler);
@@ -498,6 +556,180 @@ bool BlitHelper::DepthToBuffer(Surface& source, vk::Buffer buffer,
     return true;
 }
 
+bool BlitHelper::CanDecodeTiled(PixelFormat format, bool converted) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+    case PixelFormat::RGBA4:
+    case PixelFormat::IA8:
+    case PixelFormat::RG8:
+    case PixelFormat::I8:
+    case PixelFormat::A8:
+    case PixelFormat::IA4:
+    case PixelFormat::I4:
+    case PixelFormat::A4:
+        return true;
+    case PixelFormat::RGB8:
+        // The unconverted format is 3 bytes per texel, which the shader cannot write.
+        return converted;
+    case PixelFormat::D16:
+        return !converted;
+    default:
+        return false;
+    }
+}
+
+void BlitHelper::DecodeTiled(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                             PixelFormat format, bool converted, u32 width, u32 height) {
+    const auto descriptor_set = tiled_provider.Commit();
+    update_queue.AddBuffer(descriptor_set, 0, buffer, offset, size,
+                           vk::DescriptorType::eStorageBuffer);
+
+    // 16-bit formats that are copied as is pack two texels in each invocation.
+    const bool is_16bit =
+        !converted && (format == PixelFormat::RGB5A1 || format == PixelFormat::RGB565 ||
+                       format == PixelFormat::RGBA4 || format == PixelFormat::D16);
+    const TiledInfo info = {
+        .input_offset = 0,
+        .output_offset = output_offset / sizeof(u32),
+        .width = width,
+        .height = height,
+        .format = static_cast<u32>(format),
+        .converted = converted,
+    };
+
+    renderpass_cache.EndRendering();
+    auto decode = [this, descriptor_set, info, is_16bit](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eCompute, tiled_pipeline_layout,
+                                  0, descriptor_set, {});
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, decode_tiled_pipeline);
+        cmdbuf.pushConstants(tiled_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0,
+                             sizeof(info), &info);
+
+        const u32 group_width = is_16bit ? 16 : 8;
+        cmdbuf.dispatch((info.width + group_width - 1) / group_width, info.height / 8, 1);
+    };
+
+    // The decoded texels are only read by the upload copy, which waits for the compute queue.
+    if (scheduler.HasAsyncCompute()) {
+        scheduler.RecordCompute(std::move(decode));
+        return;
+    }
+
+    scheduler.Record([decode](vk::CommandBuffer cmdbuf) {
+        const vk::MemoryBarrier post_barrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead,
+        };
+
+        decode(cmdbuf);
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                               vk::PipelineStageFlagBits::eTransfer,
+                               vk::DependencyFlagBits::eByRegion, post_barrier, {}, {});
+    });
+}
+
+bool BlitHelper::CanEncodeTiled(PixelFormat format, bool converted) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB8:
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+    case PixelFormat::RGBA4:
+    case PixelFormat::D24S8:
+        return true;
+    case PixelFormat::D16:
+    case PixelFormat::D24:
+        return !converted;
+    default:
+        return false;
+    }
+}
+
+void BlitHelper::EncodeTiled(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                             PixelFormat format, bool converted, u32 width, u32 height) {
+    const auto descriptor_set = tiled_provider.Commit();
+    update_queue.AddBuffer(descriptor_set, 0, buffer, offset, size,
+                           vk::DescriptorType::eStorageBuffer);
+
+    // Each invocation writes whole words, which is one texel for 32-bit formats,
+    // two for 16-bit formats and four for 24-bit formats.
+    const u32 bpp = VideoCore::GetFormatBpp(format);
+    const u32 texels_per_invocation = bpp == 32 ? 1 : (bpp == 16 ? 2 : 4);
+    const u32 num_invocations = width * height / texels_per_invocation;
+    const TiledInfo info = {
+        .input_offset = 0,
+        .output_offset = output_offset / sizeof(u32),
+        .width = width,
+        .height = height,
+        .format = static_cast<u32>(format),
+        .converted = converted,
+    };
+
+    renderpass_cache.EndRendering();
+    scheduler.Record([this, descriptor_set, info, num_invocations](vk::CommandBuffer cmdbuf) {
+        const vk::MemoryBarrier pre_barrier = {
+            .srcAccessMask =
+                vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+        };
+        const vk::MemoryBarrier post_barrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eHostRead,
+        };
+
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer |
+                                   vk::PipelineStageFlagBits::eComputeShader,
+                               vk::PipelineStageFlagBits::eComputeShader,
+                               vk::DependencyFlagBits::eByRegion, pre_barrier, {}, {});
+
+        cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eCompute, tiled_pipeline_layout, 0,
+                                  descriptor_set, {});
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, encode_tiled_pipeline);
+        cmdbuf.pushConstants(tiled_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0,
+                             sizeof(info), &info);
+        cmdbuf.dispatch((num_invocations + 63) / 64, 1, 1);
+
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                               vk::PipelineStageFlagBits::eHost,
+                               vk::DependencyFlagBits::eByRegion, post_barrier, {}, {});
+    });
+}
+
+void BlitHelper::ExpandIndices(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                               u32 num_indices) {
+    // The indices are a single storage buffer like tiled data, so the tiled layout is shared.
+    const auto descriptor_set = tiled_provider.Commit();
+    update_queue.AddBuffer(descriptor_set, 0, buffer, offset, size,
+                           vk::DescriptorType::eStorageBuffer);
+
+    const ExpandInfo info = {
+        .output_offset = output_offset / static_cast<u32>(sizeof(u32)),
+        .num_indices = num_indices,
+    };
+    const u32 num_invocations = (num_indices + 3) / 4;
+
+    renderpass_cache.EndRendering();
+    scheduler.Record([this, descriptor_set, info, num_invocations](vk::CommandBuffer cmdbuf) {
+        const vk::MemoryBarrier post_barrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eIndexRead,
+        };
+
+        cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eCompute, tiled_pipeline_layout, 0,
+                                  descriptor_set, {});
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, expand_indices_pipeline);
+        cmdbuf.pushConstants(tiled_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0,
+                             sizeof(info), &info);
+        cmdbuf.dispatch((num_invocations + 63) / 64, 1, 1);
+
+        cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                               vk::PipelineStageFlagBits::eVertexInput,
+                               vk::DependencyFlagBits::eByRegion, post_barrier, {}, {});
+    });
+}
+
 vk::Pipeline BlitHelper::MakeComputePipeline(vk::ShaderModule shader, vk::PipelineLayout layout) {
     const vk::ComputePipelineCreateInfo compute_info = {
         .stage = MakeStages(shader),
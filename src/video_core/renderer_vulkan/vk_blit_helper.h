@@ -7,6 +7,7 @@
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
 
 namespace VideoCore {
+enum class PixelFormat : u32;
 struct TextureBlit;
 struct TextureCopy;
 struct BufferTextureCopy;
@@ -35,6 +36,37 @@ public:
     bool DepthToBuffer(Surface& source, vk::Buffer buffer,
                        const VideoCore::BufferTextureCopy& copy);
 
+    /// Returns true if tiled data of the provided format can be decoded by DecodeTiled
+    static bool CanDecodeTiled(VideoCore::PixelFormat format, bool converted);
+
+    /**
+     * Detiles and converts guest texture data in the provided buffer range.
+     * @param offset Start of the range, which must satisfy the storage buffer alignment
+     * @param output_offset Location of the decoded texels, relative to offset
+     */
+    void DecodeTiled(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                     VideoCore::PixelFormat format, bool converted, u32 width, u32 height);
+
+    /// Returns true if linear texels of the provided format can be encoded by EncodeTiled
+    static bool CanEncodeTiled(VideoCore::PixelFormat format, bool converted);
+
+    /**
+     * Converts and tiles linear texels in the provided buffer range to the guest layout.
+     * @param offset Start of the range, which must satisfy the storage buffer alignment
+     * @param output_offset Location of the tiled guest data, relative to offset
+     */
+    void EncodeTiled(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                     VideoCore::PixelFormat format, bool converted, u32 width, u32 height);
+
+    /**
+     * Widens 8-bit indices in the provided buffer range to 16 bits, for drivers that cannot draw
+     * 8-bit indices. The widened indices can be read by the index input of later draws.
+     * @param offset Start of the range, which must satisfy the storage buffer alignment
+     * @param output_offset Location of the widened indices, relative to offset
+     */
+    void ExpandIndices(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                       u32 num_indices);
+
 private:
     vk::Pipeline MakeComputePipeline(vk::ShaderModule shader, vk::PipelineLayout layout);
     vk::Pipeline MakeDepthStencilBlitPipeline();
@@ -51,17 +83,25 @@ private:
     DescriptorHeap compute_provider;
     DescriptorHeap compute_buffer_provider;
     DescriptorHeap two_textures_provider;
+    DescriptorHeap tiled_provider;
     vk::PipelineLayout compute_pipeline_layout;
     vk::PipelineLayout compute_buffer_pipeline_layout;
     vk::PipelineLayout two_textures_pipeline_layout;
+    vk::PipelineLayout tiled_pipeline_layout;
 
     vk::ShaderModule full_screen_vert;
     vk::ShaderModule d24s8_to_rgba8_comp;
     vk::ShaderModule depth_to_buffer_comp;
     vk::ShaderModule blit_depth_stencil_frag;
+    vk::ShaderModule decode_tiled_comp;
+    vk::ShaderModule encode_tiled_comp;
+    vk::ShaderModule expand_indices_comp;
 
     vk::Pipeline d24s8_to_rgba8_pipeline;
     vk::Pipeline depth_to_buffer_pipeline;
+    vk::Pipeline decode_tiled_pipeline;
+    vk::Pipeline encode_tiled_pipeline;
+    vk::Pipeline expand_indices_pipeline;
     vk::Pipeline depth_blit_pipeline;
     vk::Sampler linear_sampler;
     vk::Sampler nearest_sampler;
@@ -0,0 +1,202 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/assert.h"
+#include "common/literals.h"
+#include "video_core/renderer_vulkan/vk_descriptor_buffer.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+
+namespace Vulkan {
+
+namespace {
+
+using namespace Common::Literals;
+
+constexpr u64 DESCRIPTOR_BUFFER_SIZE = 1_MiB;
+
+constexpr vk::BufferUsageFlags DESCRIPTOR_BUFFER_USAGE =
+    vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT |
+    vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT |
+    vk::BufferUsageFlagBits::eShaderDeviceAddress;
+
+/// Returns the descriptor buffer size, limited by the maximum range it may be bound with
+u64 DescriptorBufferSize(const Instance& instance) {
+    const auto& properties = instance.GetDescriptorBufferProperties();
+    return std::min({DESCRIPTOR_BUFFER_SIZE, properties.maxResourceDescriptorBufferRange,
+                     properties.maxSamplerDescriptorBufferRange});
+}
+
+} // Anonymous namespace
+
+DescriptorBuffer::DescriptorBuffer(
+    const Instance& instance_, Scheduler& scheduler,
+    std::span<const std::span<const vk::DescriptorSetLayoutBinding>> set_bindings)
+    : instance{instance_}, device{instance.GetDevice()},
+      buffer{instance, scheduler, DESCRIPTOR_BUFFER_USAGE, DescriptorBufferSize(instance)} {
+    sets.resize(set_bindings.size());
+    for (std::size_t i = 0; i < set_bindings.size(); i++) {
+        DescriptorSet& set = sets[i];
+        set.bindings.assign(set_bindings[i].begin(), set_bindings[i].end());
+
+        // Dynamic uniform buffers cannot be stored in descriptor buffers, their offsets are
+        // applied by rewriting the descriptor instead.
+        for (vk::DescriptorSetLayoutBinding& binding : set.bindings) {
+            if (binding.descriptorType == vk::DescriptorType::eUniformBufferDynamic) {
+                binding.descriptorType = vk::DescriptorType::eUniformBuffer;
+            }
+        }
+
+        set.layout = device.createDescriptorSetLayoutUnique({
+            .flags = vk::DescriptorSetLayoutCreateFlagBits::eDescriptorBufferEXT,
+            .bindingCount = static_cast<u32>(set.bindings.size()),
+            .pBindings = set.bindings.data(),
+        });
+        if (instance.HasDebuggingToolAttached()) {
+            SetObjectName(device, *set.layout, "DescriptorBufferSetLayout");
+        }
+
+        set.uniforms.resize(set.bindings.size());
+        for (const vk::DescriptorSetLayoutBinding& binding : set.bindings) {
+            set.binding_offsets.push_back(
+                device.getDescriptorSetLayoutBindingOffsetEXT(*set.layout, binding.binding));
+        }
+        set.data.resize(device.getDescriptorSetLayoutSizeEXT(*set.layout));
+    }
+}
+
+DescriptorBuffer::~DescriptorBuffer() = default;
+
+vk::DescriptorBufferBindingInfoEXT DescriptorBuffer::BindingInfo() const {
+    return vk::DescriptorBufferBindingInfoEXT{
+        .address = buffer.Address(),
+        .usage = DESCRIPTOR_BUFFER_USAGE,
+    };
+}
+
+void DescriptorBuffer::WriteStorageImage(u32 set, u8 binding, vk::ImageView image_view,
+                                         vk::ImageLayout image_layout) {
+    const vk::DescriptorImageInfo image_info = {
+        .sampler = VK_NULL_HANDLE,
+        .imageView = image_view,
+        .imageLayout = image_layout,
+    };
+    vk::DescriptorGetInfoEXT info = {.type = vk::DescriptorType::eStorageImage};
+    info.data.pStorageImage = &image_info;
+    WriteDescriptor(set, binding, 0, info);
+}
+
+void DescriptorBuffer::WriteImageSampler(u32 set, u8 binding, u8 array_index,
+                                         vk::ImageView image_view, vk::Sampler sampler,
+                                         vk::ImageLayout image_layout) {
+    const vk::DescriptorImageInfo image_info = {
+        .sampler = sampler,
+        .imageView = image_view,
+        .imageLayout = image_layout,
+    };
+    vk::DescriptorGetInfoEXT info = {.type = vk::DescriptorType::eCombinedImageSampler};
+    info.data.pCombinedImageSampler = &image_info;
+    WriteDescriptor(set, binding, array_index, info);
+}
+
+void DescriptorBuffer::WriteUniformBuffer(u32 set, u8 binding, vk::Buffer uniform_buffer,
+                                          vk::DeviceSize size) {
+    UniformRange& range = sets[set].uniforms[binding];
+    range.address = device.getBufferAddressKHR({.buffer = uniform_buffer});
+    range.size = size;
+    range.offset = 0;
+
+    const vk::DescriptorAddressInfoEXT address_info = {
+        .address = range.address,
+        .range = size,
+    };
+    vk::DescriptorGetInfoEXT info = {.type = vk::DescriptorType::eUniformBuffer};
+    info.data.pUniformBuffer = &address_info;
+    WriteDescriptor(set, binding, 0, info);
+}
+
+void DescriptorBuffer::WriteTexelBuffer(u32 set, u8 binding, vk::Buffer texel_buffer,
+                                        vk::Format format, vk::DeviceSize size) {
+    const vk::DescriptorAddressInfoEXT address_info = {
+        .address = device.getBufferAddressKHR({.buffer = texel_buffer}),
+        .range = size,
+        .format = format,
+    };
+    vk::DescriptorGetInfoEXT info = {.type = vk::DescriptorType::eUniformTexelBuffer};
+    info.data.pUniformTexelBuffer = &address_info;
+    WriteDescriptor(set, binding, 0, info);
+}
+
+void DescriptorBuffer::SetUniformOffset(u32 set, u8 binding, u32 offset) {
+    UniformRange& range = sets[set].uniforms[binding];
+    if (range.offset == offset) {
+        return;
+    }
+    range.offset = offset;
+
+    const vk::DescriptorAddressInfoEXT address_info = {
+        .address = range.address + offset,
+        .range = range.size,
+    };
+    vk::DescriptorGetInfoEXT info = {.type = vk::DescriptorType::eUniformBuffer};
+    info.data.pUniformBuffer = &address_info;
+    WriteDescriptor(set, binding, 0, info);
+}
+
+void DescriptorBuffer::Commit(std::span<vk::DeviceSize> offsets) {
+    ASSERT(offsets.size() == sets.size());
+    const u64 alignment = instance.GetDescriptorBufferProperties().descriptorBufferOffsetAlignment;
+    for (std::size_t i = 0; i < sets.size(); i++) {
+        DescriptorSet& set = sets[i];
+        if (set.dirty) {
+            const u32 size = static_cast<u32>(set.data.size());
+            auto [data, offset, invalidate] = buffer.Map(size, alignment);
+            std::memcpy(data, set.data.data(), size);
+            buffer.Commit(size);
+            set.offset = offset;
+            set.dirty = false;
+        }
+        offsets[i] = set.offset;
+    }
+}
+
+u8* DescriptorBuffer::DescriptorData(u32 set_index, u8 binding, u32 array_index) {
+    DescriptorSet& set = sets[set_index];
+    std::size_t index = binding;
+    while (array_index >= set.bindings[index].descriptorCount) {
+        array_index -= set.bindings[index].descriptorCount;
+        index++;
+        ASSERT_MSG(index < set.bindings.size(), "Descriptor write is out of the set bounds");
+    }
+    const std::size_t descriptor_size = DescriptorSize(set.bindings[index].descriptorType);
+    return set.data.data() + set.binding_offsets[index] + array_index * descriptor_size;
+}
+
+void DescriptorBuffer::WriteDescriptor(u32 set, u8 binding, u32 array_index,
+                                       const vk::DescriptorGetInfoEXT& info) {
+    u8* data = DescriptorData(set, binding, array_index);
+    device.getDescriptorEXT(info, DescriptorSize(info.type), data);
+    sets[set].dirty = true;
+}
+
+std::size_t DescriptorBuffer::DescriptorSize(vk::DescriptorType type) const {
+    const auto& properties = instance.GetDescriptorBufferProperties();
+    switch (type) {
+    case vk::DescriptorType::eStorageImage:
+        return properties.storageImageDescriptorSize;
+    case vk::DescriptorType::eCombinedImageSampler:
+        return properties.combinedImageSamplerDescriptorSize;
+    case vk::DescriptorType::eUniformBuffer:
+        return properties.uniformBufferDescriptorSize;
+    case vk::DescriptorType::eUniformTexelBuffer:
+        return properties.uniformTexelBufferDescriptorSize;
+    default:
+        UNREACHABLE_MSG("Unsupported descriptor type {}", vk::to_string(type));
+        return 0;
+    }
+}
+
+} // namespace Vulkan
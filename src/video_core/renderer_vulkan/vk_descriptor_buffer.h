@@ -0,0 +1,92 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+#include "video_core/renderer_vulkan/vk_stream_buffer.h"
+
+namespace Vulkan {
+
+class Instance;
+class Scheduler;
+
+/**
+ * Stores descriptor sets in a ring buffered VK_EXT_descriptor_buffer. Every set keeps a host copy
+ * of its descriptors that writes go to, and a modified set is copied to a new block of the ring
+ * on commit, so blocks the GPU may still read are never touched and no descriptor set has to be
+ * allocated or updated.
+ */
+class DescriptorBuffer {
+public:
+    explicit DescriptorBuffer(
+        const Instance& instance, Scheduler& scheduler,
+        std::span<const std::span<const vk::DescriptorSetLayoutBinding>> set_bindings);
+    ~DescriptorBuffer();
+
+    /// Returns the descriptor buffer compatible layout of the set
+    vk::DescriptorSetLayout Layout(u32 set) const {
+        return *sets[set].layout;
+    }
+
+    /// Returns the binding info of the descriptor buffer
+    vk::DescriptorBufferBindingInfoEXT BindingInfo() const;
+
+    void WriteStorageImage(u32 set, u8 binding, vk::ImageView image_view,
+                           vk::ImageLayout image_layout = vk::ImageLayout::eGeneral);
+
+    void WriteImageSampler(u32 set, u8 binding, u8 array_index, vk::ImageView image_view,
+                           vk::Sampler sampler,
+                           vk::ImageLayout image_layout = vk::ImageLayout::eGeneral);
+
+    void WriteUniformBuffer(u32 set, u8 binding, vk::Buffer buffer, vk::DeviceSize size);
+
+    void WriteTexelBuffer(u32 set, u8 binding, vk::Buffer buffer, vk::Format format,
+                          vk::DeviceSize size);
+
+    /// Moves the uniform buffer descriptor at binding to the provided offset of its buffer
+    void SetUniformOffset(u32 set, u8 binding, u32 offset);
+
+    /// Uploads the modified sets and writes the ring offsets of every set to offsets
+    void Commit(std::span<vk::DeviceSize> offsets);
+
+private:
+    struct UniformRange {
+        vk::DeviceAddress address;
+        vk::DeviceSize size;
+        u32 offset;
+    };
+
+    struct DescriptorSet {
+        vk::UniqueDescriptorSetLayout layout;
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        std::vector<vk::DeviceSize> binding_offsets;
+        std::vector<UniformRange> uniforms;
+        std::vector<u8> data;
+        vk::DeviceSize offset{};
+        bool dirty{true};
+    };
+
+    /// Returns the host copy of a descriptor, following consecutive bindings like set updates
+    u8* DescriptorData(u32 set, u8 binding, u32 array_index);
+
+    /// Writes a descriptor to the host copy of the set
+    void WriteDescriptor(u32 set, u8 binding, u32 array_index,
+                         const vk::DescriptorGetInfoEXT& info);
+
+    /// Returns the size of a descriptor of the provided type
+    std::size_t DescriptorSize(vk::DescriptorType type) const;
+
+private:
+    const Instance& instance;
+    vk::Device device;
+    StreamBuffer buffer;
+    std::vector<DescriptorSet> sets;
+};
+
+} // namespace Vulkan
@@ -6,6 +6,8 @@
 
 #include "common/hash.h"
 #include "common/microprofile.h"
+#include "common/tracing.h"
+#include "core/perf_stats.h"
 #include "video_core/renderer_vulkan/pica_to_vk.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -40,7 +42,9 @@ u64 PipelineInfo::Hash(const Instance& instance) const {
 
     append_hash(vertex_layout);
     append_hash(attachments);
-    append_hash(blending);
+    if (!instance.IsExtendedDynamicState3BlendSupported()) {
+        append_hash(blending);
+    }
 
     if (!instance.IsExtendedDynamicStateSupported()) {
         append_hash(rasterization);
@@ -64,12 +68,51 @@ Shader::~Shader() {
     }
 }
 
+PipelineLibraryCache::PipelineLibraryCache(const Instance& instance_) : instance{instance_} {}
+
+PipelineLibraryCache::~PipelineLibraryCache() = default;
+
+vk::Pipeline PipelineLibraryCache::Get(u64 key, vk::GraphicsPipelineLibraryFlagsEXT subset,
+                                       const vk::GraphicsPipelineCreateInfo& pipeline_info,
+                                       vk::PipelineCache pipeline_cache) {
+    key = Common::HashCombine(key, static_cast<u64>(static_cast<u32>(subset)));
+    {
+        std::scoped_lock lock{mutex};
+        if (const auto it = libraries.find(key); it != libraries.end()) {
+            return *it->second;
+        }
+    }
+
+    // The library is compiled without holding the lock so workers building other pipelines are
+    // not serialized. If two workers race on the same library the first one is kept.
+    const vk::GraphicsPipelineLibraryCreateInfoEXT library_info = {
+        .flags = subset,
+    };
+    vk::GraphicsPipelineCreateInfo create_info = pipeline_info;
+    create_info.pNext = &library_info;
+    create_info.flags |= vk::PipelineCreateFlagBits::eLibraryKHR;
+
+    Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::PipelineCompile};
+    auto result = instance.GetDevice().createGraphicsPipelineUnique(pipeline_cache, create_info);
+    if (result.result == vk::Result::eErrorPipelineCompileRequiredEXT) {
+        return VK_NULL_HANDLE;
+    } else if (result.result != vk::Result::eSuccess) {
+        UNREACHABLE_MSG("Graphics pipeline library creation failed!");
+    }
+
+    std::scoped_lock lock{mutex};
+    const auto [it, _] = libraries.try_emplace(key, std::move(result.value));
+    return *it->second;
+}
+
 GraphicsPipeline::GraphicsPipeline(const Instance& instance_, RenderManager& renderpass_cache_,
                                    const PipelineInfo& info_, vk::PipelineCache pipeline_cache_,
                                    vk::PipelineLayout layout_, std::array<Shader*, 3> stages_,
-                                   Common::ThreadWorker* worker_)
+                                   Common::TaskGroup* worker_,
+                                   PipelineLibraryCache* library_cache_)
     : instance{instance_}, renderpass_cache{renderpass_cache_}, worker{worker_},
-      pipeline_layout{layout_}, pipeline_cache{pipeline_cache_}, info{info_}, stages{stages_} {}
+      library_cache{library_cache_}, pipeline_layout{layout_}, pipeline_cache{pipeline_cache_},
+      info{info_}, stages{stages_} {}
 
 GraphicsPipeline::~GraphicsPipeline() = default;
 
@@ -93,11 +136,20 @@ bool GraphicsPipeline::TryBuild(bool wait_built) {
     }
 
     // Fallback to (a)synchronous compilation
-    worker->QueueWork([this] { Build(); });
-    is_pending = true;
+    QueueBuild();
     return wait_built;
 }
 
+void GraphicsPipeline::QueueBuild(std::function<void()> on_built) {
+    worker->Run([this, on_built = std::move(on_built)] {
+        Build();
+        if (on_built) {
+            on_built();
+        }
+    });
+    is_pending = true;
+}
+
 bool GraphicsPipeline::Build(bool fail_on_compile_required) {
     MICROPROFILE_SCOPE(Vulkan_Pipeline);
     std::array<vk::VertexInputBindingDescription, MAX_VERTEX_BINDINGS> bindings;
@@ -197,7 +249,7 @@ bool GraphicsPipeline::Build(bool fail_on_compile_required) {
         .pScissors = &scissor,
     };
 
-    boost::container::static_vector<vk::DynamicState, 14> dynamic_states = {
+    boost::container::static_vector<vk::DynamicState, 19> dynamic_states = {
         vk::DynamicState::eViewport,           vk::DynamicState::eScissor,
         vk::DynamicState::eStencilCompareMask, vk::DynamicState::eStencilWriteMask,
         vk::DynamicState::eStencilReference,   vk::DynamicState::eBlendConstants,
@@ -213,6 +265,17 @@ bool GraphicsPipeline::Build(bool fail_on_compile_required) {
         dynamic_states.insert(dynamic_states.end(), extended.begin(), extended.end());
     }
 
+    if (instance.IsExtendedDynamicState3BlendSupported()) {
+        constexpr std::array blend = {
+            vk::DynamicState::eLogicOpEXT,
+            vk::DynamicState::eLogicOpEnableEXT,
+            vk::DynamicState::eColorBlendEnableEXT,
+            vk::DynamicState::eColorBlendEquationEXT,
+            vk::DynamicState::eColorWriteMaskEXT,
+        };
+        dynamic_states.insert(dynamic_states.end(), blend.begin(), blend.end());
+    }
+
     const vk::PipelineDynamicStateCreateInfo dynamic_info = {
         .dynamicStateCount = static_cast<u32>(dynamic_states.size()),
         .pDynamicStates = dynamic_states.data(),
@@ -270,9 +333,89 @@ bool GraphicsPipeline::Build(bool fail_on_compile_required) {
     if (fail_on_compile_required) {
         pipeline_info.flags |= vk::PipelineCreateFlagBits::eFailOnPipelineCompileRequiredEXT;
     }
+    if (instance.IsDescriptorBufferSupported()) {
+        pipeline_info.flags |= vk::PipelineCreateFlagBits::eDescriptorBufferEXT;
+    }
+
+    if (library_cache) {
+        return Link(pipeline_info, {shader_stages.data(), shader_count});
+    }
+    return Create(pipeline_info);
+}
+
+bool GraphicsPipeline::Link(const vk::GraphicsPipelineCreateInfo& pipeline_info,
+                            std::span<const vk::PipelineShaderStageCreateInfo> shader_stages) {
+    using LibraryFlags = vk::GraphicsPipelineLibraryFlagBitsEXT;
+    const auto combine = [](u64 seed, const auto& data) {
+        return Common::HashCombine(seed, Common::ComputeStructHash64(data));
+    };
+
+    // Each library key only holds the state its subset uses, leaving out what is dynamic.
+    const bool dynamic_state = instance.IsExtendedDynamicStateSupported();
+    const u64 attachments_hash = Common::ComputeStructHash64(info.attachments);
+
+    u64 vertex_input_key = Common::ComputeStructHash64(info.vertex_layout);
+    u64 pre_raster_key = combine(attachments_hash, std::array{stages[0], stages[2]});
+    u64 fragment_shader_key = combine(attachments_hash, stages[1]);
+    u64 fragment_output_key = attachments_hash;
+    if (!dynamic_state) {
+        vertex_input_key = combine(vertex_input_key, info.rasterization.value);
+        pre_raster_key = combine(pre_raster_key, info.rasterization.value);
+        fragment_shader_key = combine(fragment_shader_key, info.depth_stencil.value);
+    }
+    if (!instance.IsExtendedDynamicState3BlendSupported()) {
+        fragment_output_key = combine(fragment_output_key, info.blending);
+    }
+
+    boost::container::static_vector<vk::PipelineShaderStageCreateInfo, MAX_SHADER_STAGES>
+        pre_raster_stages;
+    boost::container::static_vector<vk::PipelineShaderStageCreateInfo, MAX_SHADER_STAGES>
+        fragment_stages;
+    for (const vk::PipelineShaderStageCreateInfo& stage : shader_stages) {
+        if (stage.stage == vk::ShaderStageFlagBits::eFragment) {
+            fragment_stages.push_back(stage);
+        } else {
+            pre_raster_stages.push_back(stage);
+        }
+    }
+
+    vk::GraphicsPipelineCreateInfo library_info = pipeline_info;
+    const auto get_library = [&](u64 key, LibraryFlags subset,
+                                 std::span<const vk::PipelineShaderStageCreateInfo> subset_stages) {
+        library_info.stageCount = static_cast<u32>(subset_stages.size());
+        library_info.pStages = subset_stages.data();
+        return library_cache->Get(key, subset, library_info, pipeline_cache);
+    };
+
+    const std::array libraries = {
+        get_library(vertex_input_key, LibraryFlags::eVertexInputInterface, {}),
+        get_library(pre_raster_key, LibraryFlags::ePreRasterizationShaders,
+                    {pre_raster_stages.data(), pre_raster_stages.size()}),
+        get_library(fragment_shader_key, LibraryFlags::eFragmentShader,
+                    {fragment_stages.data(), fragment_stages.size()}),
+        get_library(fragment_output_key, LibraryFlags::eFragmentOutputInterface, {}),
+    };
+    if (std::ranges::any_of(libraries, [](vk::Pipeline library) { return !library; })) {
+        return false;
+    }
+
+    const vk::PipelineLibraryCreateInfoKHR link_info = {
+        .libraryCount = static_cast<u32>(libraries.size()),
+        .pLibraries = libraries.data(),
+    };
+    const vk::GraphicsPipelineCreateInfo linked_info = {
+        .pNext = &link_info,
+        .flags = pipeline_info.flags,
+        .layout = pipeline_layout,
+    };
+    return Create(linked_info);
+}
 
+bool GraphicsPipeline::Create(const vk::GraphicsPipelineCreateInfo& pipeline_info) {
+    Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::PipelineCompile};
     auto result = instance.GetDevice().createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
     if (result.result == vk::Result::eSuccess) {
+        Common::Tracing::IncrementCounter(Common::Tracing::Counter::PipelineCompile);
         pipeline = std::move(result.value);
     } else if (result.result == vk::Result::eErrorPipelineCompileRequiredEXT) {
         return false;
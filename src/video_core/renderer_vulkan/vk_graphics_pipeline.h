@@ -2,7 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include "common/thread_worker.h"
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+#include "common/task_scheduler.h"
 #include "video_core/pica/regs_pipeline.h"
 #include "video_core/pica/regs_rasterizer.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
@@ -164,26 +171,63 @@ struct Shader : public Common::AsyncHandle {
     std::string program;
 };
 
+/**
+ * Caches the libraries of VK_EXT_graphics_pipeline_library. Pipelines are linked from a vertex
+ * input, a pre-rasterization shaders, a fragment shader and a fragment output library, so a new
+ * state combination only compiles the parts it does not share with existing pipelines.
+ */
+class PipelineLibraryCache {
+public:
+    explicit PipelineLibraryCache(const Instance& instance);
+    ~PipelineLibraryCache();
+
+    /**
+     * Returns the library of the subset with the provided key, creating it from pipeline_info
+     * if needed. Returns a null handle when pipeline_info fails on required compilation and the
+     * library has not been built yet.
+     */
+    vk::Pipeline Get(u64 key, vk::GraphicsPipelineLibraryFlagsEXT subset,
+                     const vk::GraphicsPipelineCreateInfo& pipeline_info,
+                     vk::PipelineCache pipeline_cache);
+
+private:
+    const Instance& instance;
+    std::mutex mutex;
+    std::unordered_map<u64, vk::UniquePipeline> libraries;
+};
+
 class GraphicsPipeline : public Common::AsyncHandle {
 public:
     explicit GraphicsPipeline(const Instance& instance, RenderManager& renderpass_cache,
                               const PipelineInfo& info, vk::PipelineCache pipeline_cache,
                               vk::PipelineLayout layout, std::array<Shader*, 3> stages,
-                              Common::ThreadWorker* worker);
+                              Common::TaskGroup* worker, PipelineLibraryCache* library_cache);
     ~GraphicsPipeline();
 
     bool TryBuild(bool wait_built);
 
+    /// Queues the pipeline build on the worker, calling on_built once it finishes
+    void QueueBuild(std::function<void()> on_built = {});
+
     bool Build(bool fail_on_compile_required = false);
 
     [[nodiscard]] vk::Pipeline Handle() const noexcept {
         return *pipeline;
     }
 
+private:
+    /// Links the pipeline from the libraries of its state subsets
+    bool Link(const vk::GraphicsPipelineCreateInfo& pipeline_info,
+              std::span<const vk::PipelineShaderStageCreateInfo> shader_stages);
+
+    /// Creates the pipeline handle, returns false if the driver requires it to be compiled
+    bool Create(const vk::GraphicsPipelineCreateInfo& pipeline_info);
+
 private:
     const Instance& instance;
     RenderManager& renderpass_cache;
-    Common::ThreadWorker* worker;
+    Common::TaskGroup* worker;
+    PipelineLibraryCache* library_cache;
 
     vk::UniquePipeline pipeline;
     vk::PipelineLayout pipeline_layout;
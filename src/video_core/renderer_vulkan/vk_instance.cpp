@@ -63,6 +63,8 @@ vk::Format MakeCustomFormat(VideoCore::CustomPixelFormat format) {
         return vk::Format::eAstc6x6UnormBlock;
     case VideoCore::CustomPixelFormat::ASTC8:
         return vk::Format::eAstc8x6UnormBlock;
+    case VideoCore::CustomPixelFormat::ETC2:
+        return vk::Format::eEtc2R8G8B8A8UnormBlock;
     default:
         LOG_ERROR(Render_Vulkan, "Unknown custom format {}", format);
     }
@@ -319,7 +321,7 @@ void Instance::CreateCustomFormatTable() {
         VideoCore::CustomPixelFormat::BC1,   VideoCore::CustomPixelFormat::BC3,
         VideoCore::CustomPixelFormat::BC5,   VideoCore::CustomPixelFormat::BC7,
         VideoCore::CustomPixelFormat::ASTC4, VideoCore::CustomPixelFormat::ASTC6,
-        VideoCore::CustomPixelFormat::ASTC8,
+        VideoCore::CustomPixelFormat::ASTC8, VideoCore::CustomPixelFormat::ETC2,
     };
 
     for (const auto& custom_format : custom_formats) {
@@ -404,12 +406,17 @@ bool Instance::CreateDevice() {
         vk::PhysicalDeviceCustomBorderColorFeaturesEXT, vk::PhysicalDeviceIndexTypeUint8FeaturesEXT,
         vk::PhysicalDeviceFragmentShaderInterlockFeaturesEXT,
         vk::PhysicalDevicePipelineCreationCacheControlFeaturesEXT,
-        vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR>();
+        vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR,
+        vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR,
+        vk::PhysicalDeviceDescriptorBufferFeaturesEXT,
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
     const vk::StructureChain properties_chain =
         physical_device
             .getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDriverProperties,
                             vk::PhysicalDevicePortabilitySubsetPropertiesKHR,
-                            vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+                            vk::PhysicalDeviceExternalMemoryHostPropertiesEXT,
+                            vk::PhysicalDeviceDescriptorBufferPropertiesEXT,
+                            vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>();
     const vk::PhysicalDeviceDriverProperties driver =
         properties_chain.get<vk::PhysicalDeviceDriverProperties>();
 
@@ -422,7 +429,7 @@ bool Instance::CreateDevice() {
         return false;
     }
 
-    boost::container::static_vector<const char*, 13> enabled_extensions;
+    boost::container::static_vector<const char*, 22> enabled_extensions;
     const auto add_extension = [&](std::string_view extension, bool blacklist = false,
                                    std::string_view reason = "") -> bool {
         const auto result =
@@ -454,6 +461,8 @@ bool Instance::CreateDevice() {
     shader_stencil_export = add_extension(VK_EXT_SHADER_STENCIL_EXPORT_EXTENSION_NAME);
     external_memory_host = add_extension(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
     tooling_info = add_extension(VK_EXT_TOOLING_INFO_EXTENSION_NAME);
+    display_timing = Settings::values.frame_pacing.GetValue() &&
+                     add_extension(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
     const bool has_timeline_semaphores =
         add_extension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, is_qualcomm || is_turnip,
                       "it is broken on Qualcomm drivers");
@@ -474,6 +483,21 @@ bool Instance::CreateDevice() {
     const bool has_fragment_shader_barycentric =
         add_extension(VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME, is_moltenvk,
                       "the PerVertexKHR attribute is not supported by MoltenVK");
+    const bool has_extended_dynamic_state2 =
+        add_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+    const bool has_extended_dynamic_state3 =
+        add_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    const bool has_graphics_pipeline_library =
+        add_extension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+        add_extension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    // Descriptor buffers replace the descriptor sets of the rasterizer, so they are only enabled
+    // on request and the existing update queue is used otherwise.
+    const bool has_descriptor_buffer =
+        Settings::values.use_descriptor_buffer.GetValue() &&
+        add_extension(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME) &&
+        add_extension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) &&
+        add_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) &&
+        add_extension(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
 
     const auto family_properties = physical_device.getQueueFamilyProperties();
     if (family_properties.empty()) {
@@ -495,11 +519,12 @@ bool Instance::CreateDevice() {
         return false;
     }
 
-    static constexpr std::array<f32, 1> queue_priorities = {1.0f};
+    static constexpr std::array<f32, 2> queue_priorities = {1.0f, 1.0f};
 
-    const vk::DeviceQueueCreateInfo queue_info = {
+    // The compute queue is requested once timeline semaphores are known to be supported.
+    vk::DeviceQueueCreateInfo queue_info = {
         .queueFamilyIndex = queue_family_index,
-        .queueCount = static_cast<u32>(queue_priorities.size()),
+        .queueCount = 1,
         .pQueuePriorities = queue_priorities.data(),
     };
 
@@ -530,6 +555,9 @@ bool Instance::CreateDevice() {
         vk::PhysicalDeviceFragmentShaderInterlockFeaturesEXT{},
         vk::PhysicalDevicePipelineCreationCacheControlFeaturesEXT{},
         vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR{},
+        vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR{},
+        vk::PhysicalDeviceDescriptorBufferFeaturesEXT{},
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT{},
     };
 
 #define PROP_GET(structName, prop, property) property = properties_chain.get<structName>().prop;
@@ -581,6 +609,40 @@ bool Instance::CreateDevice() {
         device_chain.unlink<vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>();
     }
 
+    // Blending is only made dynamic when every part of it can be, otherwise it stays in the
+    // pipeline key.
+    if (has_extended_dynamic_state2 && has_extended_dynamic_state3) {
+        bool logic_op{}, logic_op_enable{}, blend_enable{}, blend_equation{}, write_mask{};
+        FEAT_SET(vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT, extendedDynamicState2LogicOp,
+                 logic_op)
+        FEAT_SET(vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT,
+                 extendedDynamicState3LogicOpEnable, logic_op_enable)
+        FEAT_SET(vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT,
+                 extendedDynamicState3ColorBlendEnable, blend_enable)
+        FEAT_SET(vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT,
+                 extendedDynamicState3ColorBlendEquation, blend_equation)
+        FEAT_SET(vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT,
+                 extendedDynamicState3ColorWriteMask, write_mask)
+        extended_dynamic_state3_blend =
+            logic_op && logic_op_enable && blend_enable && blend_equation && write_mask;
+    } else {
+        device_chain.unlink<vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>();
+        device_chain.unlink<vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>();
+    }
+
+    if (has_graphics_pipeline_library) {
+        FEAT_SET(vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT, graphicsPipelineLibrary,
+                 graphics_pipeline_library)
+        // Without fast linking every linked pipeline is compiled again, which is slower than
+        // building it in one go.
+        graphics_pipeline_library =
+            graphics_pipeline_library &&
+            properties_chain.get<vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>()
+                .graphicsPipelineLibraryFastLinking;
+    } else {
+        device_chain.unlink<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+    }
+
     if (has_custom_border_color) {
         FEAT_SET(vk::PhysicalDeviceCustomBorderColorFeaturesEXT, customBorderColors,
                  custom_border_color)
@@ -609,9 +671,35 @@ bool Instance::CreateDevice() {
         device_chain.unlink<vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR>();
     }
 
+    if (has_descriptor_buffer) {
+        bool buffer_device_address{};
+        FEAT_SET(vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR, bufferDeviceAddress,
+                 buffer_device_address)
+        FEAT_SET(vk::PhysicalDeviceDescriptorBufferFeaturesEXT, descriptorBuffer,
+                 descriptor_buffer)
+        descriptor_buffer_properties =
+            properties_chain.get<vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
+        descriptor_buffer_properties.pNext = nullptr;
+        // The texture set has a cube array binding, which is only written contiguously when
+        // combined image sampler arrays are laid out as single descriptors.
+        descriptor_buffer = descriptor_buffer && buffer_device_address &&
+                            descriptor_buffer_properties.combinedImageSamplerDescriptorSingleArray;
+    } else {
+        device_chain.unlink<vk::PhysicalDeviceBufferDeviceAddressFeaturesKHR>();
+        device_chain.unlink<vk::PhysicalDeviceDescriptorBufferFeaturesEXT>();
+    }
+
 #undef PROP_GET
 #undef FEAT_SET
 
+    // A second queue of the graphics family runs compute work next to the graphics queue without
+    // queue family ownership transfers. Submissions to it are ordered with timeline semaphores.
+    async_compute = Settings::values.async_compute.GetValue() && timeline_semaphores &&
+                    family_properties[queue_family_index].queueCount >= 2;
+    if (async_compute) {
+        queue_info.queueCount = 2;
+    }
+
     try {
         device = physical_device.createDeviceUnique(device_chain.get());
     } catch (vk::ExtensionNotPresentError& err) {
@@ -623,6 +711,9 @@ bool Instance::CreateDevice() {
 
     graphics_queue = device->getQueue(queue_family_index, 0);
     present_queue = device->getQueue(queue_family_index, 0);
+    if (async_compute) {
+        compute_queue = device->getQueue(queue_family_index, 1);
+    }
 
     CreateAllocator();
     return true;
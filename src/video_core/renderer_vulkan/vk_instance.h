@@ -93,6 +93,16 @@ public:
         return present_queue;
     }
 
+    /// Returns the queue compute work runs on asynchronously to the graphics queue
+    vk::Queue GetComputeQueue() const {
+        return compute_queue;
+    }
+
+    /// Returns true when compute work can be submitted to a queue of its own
+    bool HasAsyncCompute() const {
+        return async_compute;
+    }
+
     /// Returns true when a known debugging tool is attached.
     bool HasDebuggingToolAttached() const {
         return has_renderdoc || has_nsight_graphics;
@@ -133,6 +143,17 @@ public:
         return extended_dynamic_state;
     }
 
+    /// Returns true when the color blend and logic op state of VK_EXT_extended_dynamic_state3 and
+    /// VK_EXT_extended_dynamic_state2 can be set dynamically
+    bool IsExtendedDynamicState3BlendSupported() const {
+        return extended_dynamic_state3_blend;
+    }
+
+    /// Returns true when VK_EXT_graphics_pipeline_library is supported with fast linking
+    bool IsGraphicsPipelineLibrarySupported() const {
+        return graphics_pipeline_library;
+    }
+
     /// Returns true when VK_EXT_custom_border_color is supported
     bool IsCustomBorderColorSupported() const {
         return custom_border_color;
@@ -173,6 +194,21 @@ public:
         return fragment_shader_barycentric;
     }
 
+    /// Returns true when VK_GOOGLE_display_timing is supported and enabled
+    bool IsDisplayTimingSupported() const {
+        return display_timing;
+    }
+
+    /// Returns true when VK_EXT_descriptor_buffer is supported and enabled
+    bool IsDescriptorBufferSupported() const {
+        return descriptor_buffer;
+    }
+
+    /// Returns the descriptor sizes and alignments of VK_EXT_descriptor_buffer
+    const vk::PhysicalDeviceDescriptorBufferPropertiesEXT& GetDescriptorBufferProperties() const {
+        return descriptor_buffer_properties;
+    }
+
     /// Returns the vendor ID of the physical device
     u32 GetVendorID() const {
         return properties.vendorID;
@@ -223,6 +259,11 @@ public:
         return properties.limits.minUniformBufferOffsetAlignment;
     }
 
+    /// Returns the minimum required alignment for storage buffers
+    vk::DeviceSize StorageMinAlignment() const {
+        return properties.limits.minStorageBufferOffsetAlignment;
+    }
+
     /// Returns the minimum alignemt required for accessing host-mapped device memory
     vk::DeviceSize NonCoherentAtomSize() const {
         return properties.limits.nonCoherentAtomSize;
@@ -233,6 +274,16 @@ public:
         return properties.limits.maxTexelBufferElements;
     }
 
+    /// Returns true if timestamps can be written on the graphics queue
+    bool IsTimestampSupported() const {
+        return properties.limits.timestampComputeAndGraphics;
+    }
+
+    /// Returns the number of nanoseconds it takes for a timestamp to be incremented by one
+    float GetTimestampPeriod() const {
+        return properties.limits.timestampPeriod;
+    }
+
     /// Returns true if shaders can declare the ClipDistance attribute
     bool IsShaderClipDistanceSupported() const {
         return features.shaderClipDistance;
@@ -301,6 +352,7 @@ private:
     VmaAllocator allocator{};
     vk::Queue present_queue;
     vk::Queue graphics_queue;
+    vk::Queue compute_queue;
     std::vector<vk::PhysicalDevice> physical_devices;
     FormatTraits null_traits;
     std::array<FormatTraits, VideoCore::PIXEL_FORMAT_COUNT> format_table;
@@ -312,7 +364,10 @@ private:
     bool image_view_reinterpretation{true};
     u32 min_vertex_stride_alignment{1};
     bool timeline_semaphores{};
+    bool async_compute{};
     bool extended_dynamic_state{};
+    bool extended_dynamic_state3_blend{};
+    bool graphics_pipeline_library{};
     bool custom_border_color{};
     bool index_type_uint8{};
     bool fragment_shader_interlock{};
@@ -321,8 +376,11 @@ private:
     bool fragment_shader_barycentric{};
     bool shader_stencil_export{};
     bool external_memory_host{};
+    bool descriptor_buffer{};
+    vk::PhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties{};
     u64 min_imported_host_pointer_alignment{};
     bool tooling_info{};
+    bool display_timing{};
     bool debug_utils_supported{};
     bool has_nsight_graphics{};
     bool has_renderdoc{};
@@ -19,6 +19,9 @@ MasterSemaphoreTimeline::MasterSemaphoreTimeline(const Instance& instance_) : in
         },
     };
     semaphore = instance.GetDevice().createSemaphoreUnique(semaphore_chain.get());
+    if (instance.HasAsyncCompute()) {
+        compute_semaphore = instance.GetDevice().createSemaphoreUnique(semaphore_chain.get());
+    }
 }
 
 MasterSemaphoreTimeline::~MasterSemaphoreTimeline() = default;
@@ -68,14 +71,22 @@ void MasterSemaphoreTimeline::SubmitWork(vk::CommandBuffer cmdbuf, vk::Semaphore
     const std::array signal_values{signal_value, u64(0)};
     const std::array signal_semaphores{Handle(), signal};
 
-    const u32 num_wait_semaphores = wait ? 1U : 0U;
-    const std::array wait_values{u64(1)};
-    const std::array wait_semaphores{wait};
-
-    static constexpr std::array<vk::PipelineStageFlags, 2> wait_stage_masks = {
-        vk::PipelineStageFlagBits::eAllCommands,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput,
-    };
+    // Compute work is only consumed by transfers, the rest of the submission runs alongside it.
+    u32 num_wait_semaphores = 0;
+    std::array<u64, 2> wait_values{};
+    std::array<vk::Semaphore, 2> wait_semaphores{};
+    std::array<vk::PipelineStageFlags, 2> wait_stage_masks{};
+    if (wait) {
+        wait_values[num_wait_semaphores] = 1;
+        wait_semaphores[num_wait_semaphores] = wait;
+        wait_stage_masks[num_wait_semaphores++] = vk::PipelineStageFlagBits::eAllCommands;
+    }
+    if (compute_tick != waited_compute_tick) {
+        wait_values[num_wait_semaphores] = compute_tick;
+        wait_semaphores[num_wait_semaphores] = *compute_semaphore;
+        wait_stage_masks[num_wait_semaphores++] = vk::PipelineStageFlagBits::eTransfer;
+        waited_compute_tick = compute_tick;
+    }
 
     const vk::TimelineSemaphoreSubmitInfoKHR timeline_si = {
         .waitSemaphoreValueCount = num_wait_semaphores,
@@ -102,6 +113,30 @@ void MasterSemaphoreTimeline::SubmitWork(vk::CommandBuffer cmdbuf, vk::Semaphore
     }
 }
 
+void MasterSemaphoreTimeline::SubmitCompute(vk::CommandBuffer cmdbuf) {
+    cmdbuf.end();
+
+    const u64 signal_value = ++compute_tick;
+    const vk::TimelineSemaphoreSubmitInfoKHR timeline_si = {
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &signal_value,
+    };
+
+    const vk::SubmitInfo submit_info = {
+        .pNext = &timeline_si,
+        .commandBufferCount = 1u,
+        .pCommandBuffers = &cmdbuf,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &compute_semaphore.get(),
+    };
+
+    try {
+        instance.GetComputeQueue().submit(submit_info);
+    } catch (vk::DeviceLostError& err) {
+        UNREACHABLE_MSG("Device lost during compute submit: {}", err.what());
+    }
+}
+
 constexpr u64 FENCE_RESERVE = 8;
 
 MasterSemaphoreFence::MasterSemaphoreFence(const Instance& instance_) : instance{instance_} {
@@ -158,6 +193,10 @@ void MasterSemaphoreFence::SubmitWork(vk::CommandBuffer cmdbuf, vk::Semaphore wa
     wait_cv.notify_one();
 }
 
+void MasterSemaphoreFence::SubmitCompute(vk::CommandBuffer cmdbuf) {
+    UNREACHABLE_MSG("Asynchronous compute requires timeline semaphores");
+}
+
 void MasterSemaphoreFence::WaitThread(std::stop_token token) {
     const vk::Device device{instance.GetDevice()};
     while (!token.stop_requested()) {
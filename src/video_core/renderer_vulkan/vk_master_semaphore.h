@@ -45,6 +45,10 @@ public:
     virtual void SubmitWork(vk::CommandBuffer cmdbuf, vk::Semaphore wait, vk::Semaphore signal,
                             u64 signal_value) = 0;
 
+    /// Submits the provided command buffer to the compute queue. The transfers of the next
+    /// submission wait for it to complete.
+    virtual void SubmitCompute(vk::CommandBuffer cmdbuf) = 0;
+
 protected:
     std::atomic<u64> gpu_tick{0};     ///< Current known GPU tick.
     std::atomic<u64> current_tick{1}; ///< Current logical tick.
@@ -66,9 +70,14 @@ public:
     void SubmitWork(vk::CommandBuffer cmdbuf, vk::Semaphore wait, vk::Semaphore signal,
                     u64 signal_value) override;
 
+    void SubmitCompute(vk::CommandBuffer cmdbuf) override;
+
 private:
     const Instance& instance;
-    vk::UniqueSemaphore semaphore; ///< Timeline semaphore.
+    vk::UniqueSemaphore semaphore;         ///< Timeline semaphore.
+    vk::UniqueSemaphore compute_semaphore; ///< Timeline semaphore of the compute queue.
+    u64 compute_tick{0};                   ///< Last compute tick submitted.
+    u64 waited_compute_tick{0};            ///< Last compute tick waited by a submission.
 };
 
 class MasterSemaphoreFence : public MasterSemaphore {
@@ -85,6 +94,8 @@ public:
     void SubmitWork(vk::CommandBuffer cmdbuf, vk::Semaphore wait, vk::Semaphore signal,
                     u64 signal_value) override;
 
+    void SubmitCompute(vk::CommandBuffer cmdbuf) override;
+
 private:
     void WaitThread(std::stop_token token);
 
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <cstring>
 #include <boost/container/static_vector.hpp>
 
 #include "common/common_paths.h"
@@ -15,23 +17,34 @@
 #include "core/loader/loader.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/renderer_vulkan/pica_to_vk.h"
+#include "video_core/renderer_vulkan/vk_descriptor_buffer.h"
 #include "video_core/renderer_vulkan/vk_descriptor_update_queue.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/renderer_vulkan/vk_pipeline_trace.h"
 #include "video_core/renderer_vulkan/vk_render_manager.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
 #include "video_core/shader/generator/glsl_fs_shader_gen.h"
 #include "video_core/shader/generator/glsl_shader_gen.h"
 #include "video_core/shader/generator/spv_fs_shader_gen.h"
+#include "video_core/shader/generator/spv_vs_shader_gen.h"
 
 using namespace Pica::Shader::Generator;
 using Pica::Shader::FSConfig;
+using Pica::Shader::FSUberConfig;
 
 MICROPROFILE_DEFINE(Vulkan_Bind, "Vulkan", "Pipeline Bind", MP_RGB(192, 32, 32));
+MICROPROFILE_DEFINE(Vulkan_FragmentShaderLookup, "Vulkan", "Fragment Shader Lookup",
+                    MP_RGB(192, 96, 32));
+MICROPROFILE_DEFINE(Vulkan_FragmentShaderGen, "Vulkan", "Fragment Shader Generation",
+                    MP_RGB(192, 160, 32));
 
 namespace Vulkan {
 
+/// Fragment shader hash of the pipelines using the ubershader, distinct from any FSConfig hash
+constexpr u64 UBER_SHADER_HASH = 0x55424552'53484452ULL;
+
 u32 AttribBytes(Pica::PipelineRegs::VertexAttributeFormat format, u32 size) {
     switch (format) {
     case Pica::PipelineRegs::VertexAttributeFormat::FLOAT:
@@ -81,20 +94,69 @@ constexpr std::array<vk::DescriptorSetLayoutBinding, 2> UTILITY_BINDINGS = {{
      vk::ShaderStageFlagBits::eFragment}, // tex_normal
 }};
 
+DescriptorWriter::DescriptorWriter(DescriptorUpdateQueue& update_queue_,
+                                   DescriptorBuffer* descriptor_buffer_, vk::DescriptorSet set_,
+                                   u32 set_index_)
+    : update_queue{&update_queue_}, descriptor_buffer{descriptor_buffer_}, set{set_},
+      set_index{set_index_} {}
+
+void DescriptorWriter::AddStorageImage(u8 binding, vk::ImageView image_view) {
+    if (descriptor_buffer) {
+        descriptor_buffer->WriteStorageImage(set_index, binding, image_view);
+        return;
+    }
+    update_queue->AddStorageImage(set, binding, image_view);
+}
+
+void DescriptorWriter::AddImageSampler(u8 binding, u8 array_index, vk::ImageView image_view,
+                                       vk::Sampler sampler) {
+    if (descriptor_buffer) {
+        descriptor_buffer->WriteImageSampler(set_index, binding, array_index, image_view, sampler);
+        return;
+    }
+    update_queue->AddImageSampler(set, binding, array_index, image_view, sampler);
+}
+
+void DescriptorWriter::AddUniformBuffer(u8 binding, vk::Buffer buffer, vk::DeviceSize size) {
+    if (descriptor_buffer) {
+        descriptor_buffer->WriteUniformBuffer(set_index, binding, buffer, size);
+        return;
+    }
+    update_queue->AddBuffer(set, binding, buffer, 0, size);
+}
+
+void DescriptorWriter::AddTexelBuffer(u8 binding, vk::BufferView buffer_view, vk::Buffer buffer,
+                                      vk::Format format, vk::DeviceSize size) {
+    if (descriptor_buffer) {
+        descriptor_buffer->WriteTexelBuffer(set_index, binding, buffer, format, size);
+        return;
+    }
+    update_queue->AddTexelBuffer(set, binding, buffer_view);
+}
+
 PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
                              RenderManager& renderpass_cache_, DescriptorUpdateQueue& update_queue_)
     : instance{instance_}, scheduler{scheduler_}, renderpass_cache{renderpass_cache_},
       update_queue{update_queue_},
-      num_worker_threads{std::max(std::thread::hardware_concurrency(), 2U) >> 1},
-      workers{num_worker_threads, "Pipeline workers"},
       descriptor_heaps{
           DescriptorHeap{instance, scheduler.GetMasterSemaphore(), BUFFER_BINDINGS, 32},
           DescriptorHeap{instance, scheduler.GetMasterSemaphore(), TEXTURE_BINDINGS<1>},
           DescriptorHeap{instance, scheduler.GetMasterSemaphore(), UTILITY_BINDINGS, 32}},
       trivial_vertex_shader{
           instance, vk::ShaderStageFlagBits::eVertex,
-          GLSL::GenerateTrivialVertexShader(instance.IsShaderClipDistanceSupported(), true)} {
+          GLSL::GenerateTrivialVertexShader(instance.IsShaderClipDistanceSupported(), true)},
+      uber_fragment_shader{instance} {
     scheduler.RegisterOnDispatch([this] { update_queue.Flush(); });
+    if (instance.IsDescriptorBufferSupported()) {
+        const std::array<std::span<const vk::DescriptorSetLayoutBinding>, NumRasterizerSets>
+            set_bindings = {BUFFER_BINDINGS, TEXTURE_BINDINGS<1>, UTILITY_BINDINGS};
+        descriptor_buffer = std::make_unique<DescriptorBuffer>(instance, scheduler, set_bindings);
+        LOG_INFO(Render_Vulkan, "Using descriptor buffers for the rasterizer descriptors");
+    }
+    if (instance.IsGraphicsPipelineLibrarySupported()) {
+        library_cache = std::make_unique<PipelineLibraryCache>(instance);
+        LOG_INFO(Render_Vulkan, "Linking rasterizer pipelines from pipeline libraries");
+    }
     profile = Pica::Shader::Profile{
         .has_separable_shaders = true,
         .has_clip_planes = instance.IsShaderClipDistanceSupported(),
@@ -108,27 +170,59 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
         .is_vulkan = true,
     };
     BuildLayout();
+
+    // The SPIR-V cache does not depend on the title, so it is mapped once for all of them
+    if (Settings::values.use_disk_shader_cache && EnsureDirectories()) {
+        spirv_cache.Open(GetSpirvCachePath());
+    }
+
+    // With asynchronous shaders, draws whose pipeline is not ready yet use the ubershader
+    // instead of being skipped
+    if (Settings::values.async_shader_compilation.GetValue()) {
+        workers.Run([this] {
+            const std::string code = GLSL::GenerateFragmentUberShader(profile);
+            uber_fragment_shader.module =
+                spirv_cache.Compile(code, vk::ShaderStageFlagBits::eFragment, instance.GetDevice());
+            uber_fragment_shader.MarkDone();
+        });
+    }
 }
 
 void PipelineCache::BuildLayout() {
     std::array<vk::DescriptorSetLayout, NumRasterizerSets> descriptor_set_layouts;
-    descriptor_set_layouts[0] = descriptor_heaps[0].Layout();
-    descriptor_set_layouts[1] = descriptor_heaps[1].Layout();
-    descriptor_set_layouts[2] = descriptor_heaps[2].Layout();
+    for (u32 i = 0; i < NumRasterizerSets; i++) {
+        descriptor_set_layouts[i] =
+            descriptor_buffer ? descriptor_buffer->Layout(i) : descriptor_heaps[i].Layout();
+    }
 
+    const vk::PushConstantRange push_range = {
+        .stageFlags = vk::ShaderStageFlagBits::eFragment,
+        .offset = 0,
+        .size = sizeof(FSUberConfig),
+    };
     const vk::PipelineLayoutCreateInfo layout_info = {
         .setLayoutCount = NumRasterizerSets,
         .pSetLayouts = descriptor_set_layouts.data(),
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = nullptr,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_range,
     };
     pipeline_layout = instance.GetDevice().createPipelineLayoutUnique(layout_info);
 }
 
 PipelineCache::~PipelineCache() {
+    workers.Wait();
     SaveDiskCache();
 }
 
+void PipelineCache::UpdateRange(u8 binding, u32 offset) {
+    if (descriptor_buffer) {
+        descriptor_buffer->SetUniformOffset(static_cast<u32>(DescriptorHeapType::Buffer), binding,
+                                            offset);
+        return;
+    }
+    offsets[binding] = offset;
+}
+
 void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
                                   const VideoCore::DiskResourceLoadCallback& callback) {
     vk::PipelineCacheCreateInfo cache_info{};
@@ -140,7 +234,7 @@ void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
         callback(VideoCore::LoadCallbackStage::Build, 0, 1);
     }
 
-    auto load_cache = [this, &cache_info, &callback](bool allow_fallback) {
+    auto load_cache = [this, &cache_info, &stop_loading, &callback](bool allow_fallback) {
         const vk::Device device = instance.GetDevice();
         try {
             pipeline_cache = device.createPipelineCacheUnique(cache_info);
@@ -158,12 +252,16 @@ void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
                 }
             }
         }
+        if (trace && pipeline_cache) {
+            PrecompileTrace(stop_loading, callback);
+        }
         if (callback) {
             callback(VideoCore::LoadCallbackStage::Complete, 0, 0);
         }
     };
 
     // Try to load existing pipeline cache if disk cache is enabled and directories exist
+    trace.reset();
     if (!Settings::values.use_disk_shader_cache || !EnsureDirectories()) {
         load_cache(false);
         return;
@@ -174,6 +272,8 @@ void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
     const u32 vendor_id = instance.GetVendorID();
     const u32 device_id = instance.GetDeviceID();
     const u64 program_id = GetProgramID();
+    const auto trace_file_path = fmt::format("{}{:016X}-trace.bin", cache_dir, program_id);
+    trace = std::make_unique<PipelineTrace>(trace_file_path, Common::ComputeStructHash64(profile));
     const auto cache_file_path =
         fmt::format("{}{:016X}-{:X}{:X}.bin", cache_dir, program_id, vendor_id, device_id);
 
@@ -240,38 +340,225 @@ void PipelineCache::SaveDiskCache() {
     }
 }
 
-bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
-    MICROPROFILE_SCOPE(Vulkan_Bind);
+void PipelineCache::PrecompileTrace(const std::atomic_bool& stop_loading,
+                                    const VideoCore::DiskResourceLoadCallback& callback) {
+    std::vector<PipelineTraceShader> shaders;
+    std::vector<PipelineTraceKey> pipelines;
+    trace->Load(shaders, pipelines);
+    if (pipelines.empty()) {
+        return;
+    }
+
+    LOG_INFO(Render_Vulkan, "Precompiling {} shaders and {} pipelines from the pipeline trace",
+             shaders.size(), pipelines.size());
+
+    const vk::Device device = instance.GetDevice();
+    const auto compile = [this, device](Shader& shader, PipelineTraceShader& trace_shader,
+                                        vk::ShaderStageFlagBits stage) {
+        workers.Run([this, device, stage, &shader, code = std::move(trace_shader.code),
+                           is_spirv = trace_shader.is_spirv] {
+            if (is_spirv) {
+                std::vector<u32> spirv(code.size() / sizeof(u32));
+                std::memcpy(spirv.data(), code.data(), spirv.size() * sizeof(u32));
+                shader.module = CompileSPV(spirv, device);
+            } else {
+                const std::string_view glsl{reinterpret_cast<const char*>(code.data()),
+                                            code.size()};
+                shader.module = spirv_cache.Compile(glsl, stage, device);
+            }
+            shader.MarkDone();
+        });
+    };
+
+    for (PipelineTraceShader& trace_shader : shaders) {
+        switch (trace_shader.stage) {
+        case ProgramType::VS: {
+            if (programmable_vertex_map.contains(trace_shader.key)) {
+                break;
+            }
+            const u64 code_hash =
+                Common::ComputeHash64(trace_shader.code.data(), trace_shader.code.size());
+            auto [it, new_program] = programmable_vertex_cache.try_emplace(code_hash, instance);
+            programmable_vertex_map[trace_shader.key] = &it->second;
+            if (new_program) {
+                compile(it->second, trace_shader, vk::ShaderStageFlagBits::eVertex);
+            }
+            break;
+        }
+        case ProgramType::GS: {
+            auto [it, new_shader] = fixed_geometry_shaders.try_emplace(trace_shader.key, instance);
+            if (new_shader) {
+                compile(it->second, trace_shader, vk::ShaderStageFlagBits::eGeometry);
+            }
+            break;
+        }
+        case ProgramType::FS: {
+            auto [it, new_shader] = fragment_shaders.try_emplace(trace_shader.key);
+            if (new_shader) {
+                it.value() = std::make_unique<Shader>(instance);
+                compile(*it->second, trace_shader, vk::ShaderStageFlagBits::eFragment);
+            }
+            break;
+        }
+        }
+    }
 
+    const auto find_shader = [](auto& shader_map, u64 key) -> Shader* {
+        const auto it = shader_map.find(key);
+        return it != shader_map.end() ? &it->second : nullptr;
+    };
+
+    std::atomic<std::size_t> num_built{0};
+    std::size_t num_queued = 0;
+    for (const PipelineTraceKey& key : pipelines) {
+        std::array<Shader*, MAX_SHADER_STAGES> stages{};
+        const u64 vs_key = key.shader_hashes[ProgramType::VS];
+        if (vs_key == 0) {
+            stages[ProgramType::VS] = &trivial_vertex_shader;
+        } else if (const auto it = programmable_vertex_map.find(vs_key);
+                   it != programmable_vertex_map.end()) {
+            stages[ProgramType::VS] = it->second;
+        }
+        const u64 gs_key = key.shader_hashes[ProgramType::GS];
+        if (gs_key != 0) {
+            stages[ProgramType::GS] = find_shader(fixed_geometry_shaders, gs_key);
+        }
+        if (const auto it = fragment_shaders.find(key.shader_hashes[ProgramType::FS]);
+            it != fragment_shaders.end()) {
+            stages[ProgramType::FS] = it->second.get();
+        }
+
+        // Skip pipelines whose shaders were not recorded, they are built on first use instead.
+        if (!stages[ProgramType::VS] || !stages[ProgramType::FS] ||
+            (gs_key != 0 && !stages[ProgramType::GS])) {
+            continue;
+        }
+
+        auto [it, new_pipeline] =
+            graphics_pipelines.try_emplace(PipelineHash(key.info, key.shader_hashes));
+        if (!new_pipeline) {
+            continue;
+        }
+        it.value() = std::make_unique<GraphicsPipeline>(instance, renderpass_cache, key.info,
+                                                        *pipeline_cache, *pipeline_layout, stages,
+                                                        &workers, library_cache.get());
+        it->second->QueueBuild([&num_built] { ++num_built; });
+        ++num_queued;
+    }
+
+    // Report the progress to the loading screen until every pipeline has been built.
+    while (num_built.load() < num_queued && !stop_loading) {
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Build, num_built.load(), num_queued);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{16});
+    }
+    workers.Wait();
+}
+
+u64 PipelineCache::PipelineHash(const PipelineInfo& info,
+                                std::span<const u64, MAX_SHADER_STAGES> hashes) const {
     u64 shader_hash = 0;
     for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
-        shader_hash = Common::HashCombine(shader_hash, shader_hashes[i]);
+        shader_hash = Common::HashCombine(shader_hash, hashes[i]);
     }
 
     const u64 info_hash = info.Hash(instance);
-    const u64 pipeline_hash = Common::HashCombine(shader_hash, info_hash);
+    return Common::HashCombine(shader_hash, info_hash);
+}
+
+u64 PipelineCache::CurrentPipelineHash(const PipelineInfo& info) {
+    // Consecutive draws mostly share their state, so the key of the previous one is reused
+    // instead of hashing the state again
+    const auto equal = [](const auto& lhs, const auto& rhs) {
+        return std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+    };
+    if (!hashed_key || shader_hashes != hashed_shaders ||
+        !equal(info.vertex_layout, hashed_info.vertex_layout) ||
+        !equal(info.attachments, hashed_info.attachments) ||
+        !equal(info.blending, hashed_info.blending) ||
+        !equal(info.rasterization, hashed_info.rasterization) ||
+        !equal(info.depth_stencil, hashed_info.depth_stencil)) {
+        hashed_key = PipelineHash(info, shader_hashes);
+        hashed_info = info;
+        hashed_shaders = shader_hashes;
+    }
+    return *hashed_key;
+}
+
+GraphicsPipeline* PipelineCache::GetUberPipeline(const PipelineInfo& info) {
+    if (!uber_compatible || !uber_fragment_shader.IsDone()) {
+        return nullptr;
+    }
+    // The ubershader only stands in for the fragment stage
+    const auto is_pending = [](Shader* shader) { return shader && !shader->IsDone(); };
+    if (is_pending(current_shaders[ProgramType::VS]) ||
+        is_pending(current_shaders[ProgramType::GS])) {
+        return nullptr;
+    }
+
+    std::array<u64, MAX_SHADER_STAGES> hashes = shader_hashes;
+    hashes[ProgramType::FS] = UBER_SHADER_HASH;
+    auto [it, new_pipeline] = graphics_pipelines.try_emplace(PipelineHash(info, hashes));
+    if (new_pipeline) {
+        std::array<Shader*, MAX_SHADER_STAGES> stages = current_shaders;
+        stages[ProgramType::FS] = &uber_fragment_shader;
+        it.value() = std::make_unique<GraphicsPipeline>(instance, renderpass_cache, info,
+                                                        *pipeline_cache, *pipeline_layout, stages,
+                                                        &workers, library_cache.get());
+    }
+
+    // The ubershader pipelines are shared by every fragment config with the same state, so the
+    // rare build is waited on
+    GraphicsPipeline* const pipeline{it->second.get()};
+    if (!pipeline->IsDone() && !pipeline->TryBuild(true)) {
+        return nullptr;
+    }
+    return pipeline;
+}
+
+bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
+    MICROPROFILE_SCOPE(Vulkan_Bind);
 
+    const u64 pipeline_hash = CurrentPipelineHash(info);
     auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash);
     if (new_pipeline) {
         it.value() =
             std::make_unique<GraphicsPipeline>(instance, renderpass_cache, info, *pipeline_cache,
-                                               *pipeline_layout, current_shaders, &workers);
+                                               *pipeline_layout, current_shaders, &workers,
+                                               library_cache.get());
+        if (trace) {
+            trace->AppendPipeline({info, shader_hashes});
+        }
     }
 
-    GraphicsPipeline* const pipeline{it->second.get()};
+    GraphicsPipeline* pipeline{it->second.get()};
+    bool use_uber_shader = false;
     if (!pipeline->IsDone() && !pipeline->TryBuild(wait_built)) {
-        return false;
+        pipeline = GetUberPipeline(info);
+        if (!pipeline) {
+            return false;
+        }
+        use_uber_shader = true;
+    }
+
+    if (descriptor_buffer) {
+        descriptor_buffer->Commit(descriptor_buffer_offsets);
     }
 
     const bool is_dirty = scheduler.IsStateDirty(StateFlags::Pipeline);
     const bool pipeline_dirty = (current_pipeline != pipeline) || is_dirty;
-    scheduler.Record([this, is_dirty, pipeline_dirty, pipeline,
+    // Pipelines that are still building are waited for by the worker thread
+    const bool wait_pipeline = pipeline_dirty && !pipeline->IsDone();
+    scheduler.Record([this, is_dirty, wait_pipeline, pipeline,
                       current_dynamic = current_info.dynamic, dynamic = info.dynamic,
                       descriptor_sets = bound_descriptor_sets, offsets = offsets,
+                      buffer_offsets = descriptor_buffer_offsets,
                       current_rasterization = current_info.rasterization,
                       current_depth_stencil = current_info.depth_stencil,
-                      rasterization = info.rasterization,
-                      depth_stencil = info.depth_stencil](vk::CommandBuffer cmdbuf) {
+                      current_blending = current_info.blending, rasterization = info.rasterization,
+                      depth_stencil = info.depth_stencil,
+                      blending = info.blending](vk::CommandBuffer cmdbuf) {
         if (dynamic.viewport != current_dynamic.viewport || is_dirty) {
             const vk::Viewport vk_viewport = {
                 .x = static_cast<f32>(dynamic.viewport.left),
@@ -366,17 +653,61 @@ bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
             }
         }
 
-        if (pipeline_dirty) {
-            if (!pipeline->IsDone()) {
-                pipeline->WaitDone();
+        if (instance.IsExtendedDynamicState3BlendSupported()) {
+            if (blending.blend_enable != current_blending.blend_enable || is_dirty) {
+                const bool logic_op_enable =
+                    !blending.blend_enable && !instance.NeedsLogicOpEmulation();
+                cmdbuf.setColorBlendEnableEXT(0, vk::Bool32{blending.blend_enable != 0});
+                cmdbuf.setLogicOpEnableEXT(logic_op_enable);
             }
+
+            if (blending.value != current_blending.value || is_dirty) {
+                const vk::ColorBlendEquationEXT equation = {
+                    .srcColorBlendFactor = PicaToVK::BlendFunc(blending.src_color_blend_factor),
+                    .dstColorBlendFactor = PicaToVK::BlendFunc(blending.dst_color_blend_factor),
+                    .colorBlendOp = PicaToVK::BlendEquation(blending.color_blend_eq),
+                    .srcAlphaBlendFactor = PicaToVK::BlendFunc(blending.src_alpha_blend_factor),
+                    .dstAlphaBlendFactor = PicaToVK::BlendFunc(blending.dst_alpha_blend_factor),
+                    .alphaBlendOp = PicaToVK::BlendEquation(blending.alpha_blend_eq),
+                };
+                cmdbuf.setColorBlendEquationEXT(0, equation);
+            }
+
+            if (blending.color_write_mask != current_blending.color_write_mask || is_dirty) {
+                cmdbuf.setColorWriteMaskEXT(
+                    0, static_cast<vk::ColorComponentFlags>(blending.color_write_mask));
+            }
+
+            if (blending.logic_op != current_blending.logic_op || is_dirty) {
+                cmdbuf.setLogicOpEXT(PicaToVK::LogicOp(blending.logic_op));
+            }
+        }
+
+        if (wait_pipeline) {
+            pipeline->WaitDone();
             cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->Handle());
         }
 
-        cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0,
-                                  descriptor_sets, offsets);
+        if (descriptor_buffer) {
+            static constexpr std::array<u32, NumRasterizerSets> buffer_indices{};
+            cmdbuf.bindDescriptorBuffersEXT(descriptor_buffer->BindingInfo());
+            cmdbuf.setDescriptorBufferOffsetsEXT(vk::PipelineBindPoint::eGraphics,
+                                                 *pipeline_layout, 0, buffer_indices,
+                                                 buffer_offsets);
+        } else {
+            cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0,
+                                      descriptor_sets, offsets);
+        }
     });
 
+    if (pipeline_dirty && !wait_pipeline) {
+        scheduler.RecordBindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->Handle());
+    }
+    if (use_uber_shader) {
+        scheduler.RecordPushConstants(*pipeline_layout, vk::ShaderStageFlagBits::eFragment, 0,
+                                      uber_config);
+    }
+
     current_info = info;
     current_pipeline = pipeline;
     scheduler.MarkStateNonDirty(StateFlags::Pipeline | StateFlags::DescriptorSets);
@@ -412,7 +743,34 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::RegsInternal& regs,
     const auto config_hash = config.Hash();
 
     const auto [it, new_config] = programmable_vertex_map.try_emplace(config_hash);
-    if (new_config) {
+    if (new_config && Settings::values.spirv_shader_gen.GetValue() &&
+        !config.state.use_geometry_shader) {
+        // Emitting SPIR-V directly avoids the runtime GLSL compilation, programs that cannot be
+        // decompiled this way fall back to the GLSL path below.
+        std::vector code = SPIRV::GenerateVertexShader(setup, config);
+        if (!code.empty()) {
+            const u64 code_hash = Common::ComputeHash64(code.data(), code.size() * sizeof(u32));
+            auto [iter, new_program] =
+                programmable_vertex_cache.try_emplace(code_hash, instance);
+            auto& shader = iter->second;
+
+            if (trace) {
+                trace->AppendShader(ProgramType::VS, config_hash, true,
+                                    {reinterpret_cast<const u8*>(code.data()),
+                                     code.size() * sizeof(u32)});
+            }
+            if (new_program) {
+                const vk::Device device = instance.GetDevice();
+                workers.Run([device, code = std::move(code), &shader] {
+                    shader.module = CompileSPV(code, device);
+                    shader.MarkDone();
+                });
+            }
+
+            it->second = &shader;
+        }
+    }
+    if (new_config && !it->second) {
         auto program = Common::HashableString(GLSL::GenerateVertexShader(setup, config, true));
         if (program.empty()) {
             LOG_ERROR(Render_Vulkan, "Failed to retrieve programmable vertex shader");
@@ -420,14 +778,20 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::RegsInternal& regs,
             return false;
         }
 
+        if (trace) {
+            trace->AppendShader(ProgramType::VS, config_hash, false,
+                                {reinterpret_cast<const u8*>(program.data()), program.size()});
+        }
+
         auto [iter, new_program] = programmable_vertex_cache.try_emplace(program.Hash(), instance);
         auto& shader = iter->second;
 
         if (new_program) {
             shader.program = std::move(program);
             const vk::Device device = instance.GetDevice();
-            workers.QueueWork([device, &shader] {
-                shader.module = Compile(shader.program, vk::ShaderStageFlagBits::eVertex, device);
+            workers.Run([this, device, &shader] {
+                shader.module = spirv_cache.Compile(shader.program,
+                                                    vk::ShaderStageFlagBits::eVertex, device);
                 shader.MarkDone();
             });
         }
@@ -463,9 +827,14 @@ bool PipelineCache::UseFixedGeometryShader(const Pica::RegsInternal& regs) {
     auto& shader = it->second;
 
     if (new_shader) {
-        workers.QueueWork([gs_config, device = instance.GetDevice(), &shader]() {
+        workers.Run([gs_config, device = instance.GetDevice(), trace = trace.get(),
+                           &spirv_cache = spirv_cache, &shader]() {
             const auto code = GLSL::GenerateFixedGeometryShader(gs_config, true);
-            shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
+            if (trace) {
+                trace->AppendShader(ProgramType::GS, gs_config.Hash(), false,
+                                    {reinterpret_cast<const u8*>(code.data()), code.size()});
+            }
+            shader.module = spirv_cache.Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
             shader.MarkDone();
         });
     }
@@ -482,28 +851,58 @@ void PipelineCache::UseTrivialGeometryShader() {
 }
 
 void PipelineCache::UseFragmentShader(const Pica::RegsInternal& regs,
-                                      const Pica::Shader::UserConfig& user) {
+                                      const Pica::Shader::UserConfig& user, bool regs_dirty) {
+    // The config only changes when one of the regs it is built from was written
+    if (!regs_dirty && current_shaders[ProgramType::FS] && user.raw == current_fs_user.raw) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(Vulkan_FragmentShaderLookup);
     const FSConfig fs_config{regs, user, profile};
-    const auto [it, new_shader] = fragment_shaders.try_emplace(fs_config.Hash(), instance);
-    auto& shader = it->second;
+    const u64 fs_hash = fs_config.Hash();
+    current_fs_user = user;
+    uber_compatible = !fs_config.UsesUberShaderIncompatibleConfig();
+    if (uber_compatible) {
+        uber_config = FSUberConfig{fs_config};
+    }
 
+    auto [it, new_shader] = fragment_shaders.try_emplace(fs_hash);
     if (new_shader) {
-        workers.QueueWork([fs_config, this, &shader]() {
+        it.value() = std::make_unique<Shader>(instance);
+        Shader* const shader = it->second.get();
+        workers.Run([fs_config, fs_hash, this, trace = trace.get(), shader]() {
             const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
             if (use_spirv && !fs_config.UsesSpirvIncompatibleConfig()) {
-                const std::vector code = SPIRV::GenerateFragmentShader(fs_config, profile);
-                shader.module = CompileSPV(code, instance.GetDevice());
+                std::vector<u32> code;
+                {
+                    MICROPROFILE_SCOPE(Vulkan_FragmentShaderGen);
+                    code = SPIRV::GenerateFragmentShader(fs_config, profile);
+                }
+                if (trace) {
+                    trace->AppendShader(ProgramType::FS, fs_hash, true,
+                                        {reinterpret_cast<const u8*>(code.data()),
+                                         code.size() * sizeof(u32)});
+                }
+                shader->module = CompileSPV(code, instance.GetDevice());
             } else {
-                const std::string code = GLSL::GenerateFragmentShader(fs_config, profile);
-                shader.module =
-                    Compile(code, vk::ShaderStageFlagBits::eFragment, instance.GetDevice());
+                std::string code;
+                {
+                    MICROPROFILE_SCOPE(Vulkan_FragmentShaderGen);
+                    code = GLSL::GenerateFragmentShader(fs_config, profile);
+                }
+                if (trace) {
+                    trace->AppendShader(ProgramType::FS, fs_hash, false,
+                                        {reinterpret_cast<const u8*>(code.data()), code.size()});
+                }
+                shader->module = spirv_cache.Compile(code, vk::ShaderStageFlagBits::eFragment,
+                                                     instance.GetDevice());
             }
-            shader.MarkDone();
+            shader->MarkDone();
         });
     }
 
-    current_shaders[ProgramType::FS] = &shader;
-    shader_hashes[ProgramType::FS] = fs_config.Hash();
+    current_shaders[ProgramType::FS] = it->second.get();
+    shader_hashes[ProgramType::FS] = fs_hash;
 }
 
 bool PipelineCache::IsCacheValid(std::span<const u8> data) const {
@@ -570,6 +969,10 @@ std::string PipelineCache::GetPipelineCacheDir() const {
     return GetVulkanDir() + "pipeline" + DIR_SEP;
 }
 
+std::string PipelineCache::GetSpirvCachePath() const {
+    return GetVulkanDir() + "spirv.bin";
+}
+
 void PipelineCache::SwitchPipelineCache(u64 title_id, const std::atomic_bool& stop_loading,
                                         const VideoCore::DiskResourceLoadCallback& callback) {
     if (!Settings::values.use_disk_shader_cache || GetProgramID() == title_id) {
@@ -579,13 +982,6 @@ void PipelineCache::SwitchPipelineCache(u64 title_id, const std::atomic_bool& st
         return;
     }
 
-    if (callback) {
-        callback(VideoCore::LoadCallbackStage::Prepare, 0, 0);
-    }
-    if (callback) {
-        callback(VideoCore::LoadCallbackStage::Build, 0, 1);
-    }
-
     // Make sure we have a valid pipeline cache before switching
     if (!pipeline_cache) {
         vk::PipelineCacheCreateInfo cache_info{};
@@ -599,16 +995,13 @@ void PipelineCache::SwitchPipelineCache(u64 title_id, const std::atomic_bool& st
 
     LOG_INFO(Render_Vulkan, "Switching pipeline cache to title_id={:016X}", title_id);
 
-    // Save current cache before switching
+    // Save current cache before switching, shaders still being generated may record to the trace
+    workers.Wait();
     SaveDiskCache();
 
     // Update program ID and load the new pipeline cache
     SetProgramID(title_id);
-    LoadDiskCache(stop_loading, nullptr);
-
-    if (callback) {
-        callback(VideoCore::LoadCallbackStage::Complete, 0, 0);
-    }
+    LoadDiskCache(stop_loading, callback);
 }
 
 } // namespace Vulkan
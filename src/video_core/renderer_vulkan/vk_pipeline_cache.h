@@ -5,11 +5,14 @@
 #pragma once
 
 #include <bitset>
+#include <memory>
+#include <optional>
 #include <tsl/robin_map.h>
 
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
+#include "video_core/renderer_vulkan/vk_spirv_cache.h"
 #include "video_core/shader/generator/pica_fs_config.h"
 #include "video_core/shader/generator/profile.h"
 #include "video_core/shader/generator/shader_gen.h"
@@ -25,6 +28,8 @@ class Instance;
 class Scheduler;
 class RenderManager;
 class DescriptorUpdateQueue;
+class DescriptorBuffer;
+class PipelineTrace;
 
 enum class DescriptorHeapType : u32 {
     Buffer,
@@ -32,6 +37,33 @@ enum class DescriptorHeapType : u32 {
     Utility,
 };
 
+/**
+ * Writes the descriptors of an acquired rasterizer set, either through the descriptor update queue
+ * or straight into the descriptor buffer when it is used.
+ */
+class DescriptorWriter {
+public:
+    explicit DescriptorWriter(DescriptorUpdateQueue& update_queue,
+                              DescriptorBuffer* descriptor_buffer, vk::DescriptorSet set,
+                              u32 set_index);
+
+    void AddStorageImage(u8 binding, vk::ImageView image_view);
+
+    void AddImageSampler(u8 binding, u8 array_index, vk::ImageView image_view,
+                         vk::Sampler sampler);
+
+    void AddUniformBuffer(u8 binding, vk::Buffer buffer, vk::DeviceSize size);
+
+    void AddTexelBuffer(u8 binding, vk::BufferView buffer_view, vk::Buffer buffer,
+                        vk::Format format, vk::DeviceSize size);
+
+private:
+    DescriptorUpdateQueue* update_queue;
+    DescriptorBuffer* descriptor_buffer;
+    vk::DescriptorSet set;
+    u32 set_index;
+};
+
 /**
  * Stores a collection of rasterizer pipelines used during rendering.
  */
@@ -45,18 +77,22 @@ public:
                            RenderManager& renderpass_cache, DescriptorUpdateQueue& update_queue);
     ~PipelineCache();
 
-    /// Acquires and binds a free descriptor set from the appropriate heap.
-    vk::DescriptorSet Acquire(DescriptorHeapType type) {
+    /**
+     * Acquires and binds a free descriptor set from the appropriate heap. When descriptor buffers
+     * are used the set is written in place instead, preserving the previous descriptors.
+     */
+    DescriptorWriter Acquire(DescriptorHeapType type) {
         const u32 index = static_cast<u32>(type);
+        if (descriptor_buffer) {
+            return DescriptorWriter{update_queue, descriptor_buffer.get(), VK_NULL_HANDLE, index};
+        }
         const auto descriptor_set = descriptor_heaps[index].Commit();
         bound_descriptor_sets[index] = descriptor_set;
-        return descriptor_set;
+        return DescriptorWriter{update_queue, nullptr, descriptor_set, index};
     }
 
     /// Sets the dynamic offset for the uniform buffer at binding
-    void UpdateRange(u8 binding, u32 offset) {
-        offsets[binding] = offset;
-    }
+    void UpdateRange(u8 binding, u32 offset);
 
     /// Loads the pipeline cache stored to disk
     void LoadDiskCache(const std::atomic_bool& stop_loading = std::atomic_bool{false},
@@ -81,8 +117,12 @@ public:
     /// Binds a passthrough geometry shader
     void UseTrivialGeometryShader();
 
-    /// Binds a fragment shader generated from PICA state
-    void UseFragmentShader(const Pica::RegsInternal& regs, const Pica::Shader::UserConfig& user);
+    /**
+     * Binds a fragment shader generated from PICA state. The config is only rebuilt and looked up
+     * when regs_dirty is set or the user config changed.
+     */
+    void UseFragmentShader(const Pica::RegsInternal& regs, const Pica::Shader::UserConfig& user,
+                           bool regs_dirty = true);
 
     /// Switches the shader disk cache to the specified title
     void SwitchPipelineCache(u64 title_id,
@@ -102,6 +142,23 @@ private:
     /// Builds the rasterizer pipeline layout
     void BuildLayout();
 
+    /**
+     * Returns the pipeline of the state with the fragment ubershader in place of the current
+     * fragment shader, or nullptr if the ubershader cannot draw with the current config.
+     */
+    GraphicsPipeline* GetUberPipeline(const PipelineInfo& info);
+
+    /// Returns the key of the pipeline with the provided state and shader hashes
+    u64 PipelineHash(const PipelineInfo& info,
+                     std::span<const u64, MAX_SHADER_STAGES> hashes) const;
+
+    /// Returns the key of the pipeline with the provided state and the current shaders
+    u64 CurrentPipelineHash(const PipelineInfo& info);
+
+    /// Compiles the shaders and pipelines recorded in the pipeline trace of the title
+    void PrecompileTrace(const std::atomic_bool& stop_loading,
+                         const VideoCore::DiskResourceLoadCallback& callback);
+
     /// Returns true when the disk data can be used by the current driver
     bool IsCacheValid(std::span<const u8> cache_data) const;
 
@@ -114,6 +171,9 @@ private:
     /// Returns the pipeline cache storage dir
     std::string GetPipelineCacheDir() const;
 
+    /// Returns the path of the SPIR-V cache shared by all titles
+    std::string GetSpirvCachePath() const;
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -123,24 +183,35 @@ private:
     Pica::Shader::Profile profile{};
     vk::UniquePipelineCache pipeline_cache;
     vk::UniquePipelineLayout pipeline_layout;
-    std::size_t num_worker_threads;
-    Common::ThreadWorker workers;
+    Common::TaskGroup workers{Common::GetTaskScheduler()};
     PipelineInfo current_info{};
     GraphicsPipeline* current_pipeline{};
+    std::unique_ptr<PipelineLibraryCache> library_cache;
+    std::unique_ptr<PipelineTrace> trace;
+    SpirvCache spirv_cache;
     tsl::robin_map<u64, std::unique_ptr<GraphicsPipeline>, Common::IdentityHash<u64>>
         graphics_pipelines;
     std::array<DescriptorHeap, NumDescriptorHeaps> descriptor_heaps;
     std::array<vk::DescriptorSet, NumRasterizerSets> bound_descriptor_sets{};
     std::array<u32, NumDynamicOffsets> offsets{};
+    std::unique_ptr<DescriptorBuffer> descriptor_buffer;
+    std::array<vk::DeviceSize, NumRasterizerSets> descriptor_buffer_offsets{};
 
-    std::array<u64, MAX_SHADER_STAGES> shader_hashes;
-    std::array<Shader*, MAX_SHADER_STAGES> current_shaders;
+    std::array<u64, MAX_SHADER_STAGES> shader_hashes{};
+    std::array<Shader*, MAX_SHADER_STAGES> current_shaders{};
+    PipelineInfo hashed_info{};
+    std::array<u64, MAX_SHADER_STAGES> hashed_shaders{};
+    std::optional<u64> hashed_key;
+    Pica::Shader::UserConfig current_fs_user{};
 
     std::unordered_map<size_t, Shader*> programmable_vertex_map;
     std::unordered_map<size_t, Shader> programmable_vertex_cache;
     std::unordered_map<size_t, Shader> fixed_geometry_shaders;
-    std::unordered_map<size_t, Shader> fragment_shaders;
+    tsl::robin_map<u64, std::unique_ptr<Shader>, Common::IdentityHash<u64>> fragment_shaders;
     Shader trivial_vertex_shader;
+    Shader uber_fragment_shader;
+    Pica::Shader::FSUberConfig uber_config{};
+    bool uber_compatible{};
 
     u64 current_program_id{0};
 };
@@ -0,0 +1,169 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/zstd_compression.h"
+#include "video_core/renderer_vulkan/vk_pipeline_trace.h"
+
+namespace Vulkan {
+
+namespace {
+
+constexpr std::array<u8, 4> TRACE_MAGIC = {'V', 'K', 'P', 'T'};
+constexpr u32 TRACE_VERSION = 1;
+
+enum EntryType : u32 {
+    Shader = 0,
+    Pipeline = 1,
+};
+
+struct TraceHeader {
+    std::array<u8, 4> magic;
+    u32 version;
+    u64 profile_hash;
+    std::array<char, 64> build_id;
+};
+static_assert(sizeof(TraceHeader) == 80, "TraceHeader has incorrect size!");
+
+struct EntryHeader {
+    u32 type;
+    u32 reserved;
+    u64 compressed_size;
+    u64 checksum;
+};
+
+struct ShaderHeader {
+    u32 stage;
+    u32 is_spirv;
+    u64 key;
+};
+
+static_assert(std::is_trivially_copyable_v<PipelineTraceKey>,
+              "PipelineTraceKey must be trivially copyable");
+
+TraceHeader MakeHeader(u64 profile_hash) {
+    TraceHeader header{};
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.profile_hash = profile_hash;
+    std::strncpy(header.build_id.data(), Common::g_scm_rev, header.build_id.size() - 1);
+    return header;
+}
+
+bool ReadHeader(FileUtil::IOFile& file, u64 profile_hash) {
+    TraceHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    const TraceHeader expected = MakeHeader(profile_hash);
+    return std::memcmp(&header, &expected, sizeof(header)) == 0;
+}
+
+} // Anonymous namespace
+
+PipelineTrace::PipelineTrace(std::string path_, u64 profile_hash_)
+    : path{std::move(path_)}, profile_hash{profile_hash_} {
+    FileUtil::IOFile trace_file{path, "rb"};
+    file_valid = trace_file.IsOpen() && ReadHeader(trace_file, profile_hash);
+}
+
+PipelineTrace::~PipelineTrace() = default;
+
+void PipelineTrace::Load(std::vector<PipelineTraceShader>& shaders,
+                         std::vector<PipelineTraceKey>& pipelines) {
+    std::scoped_lock lock{mutex};
+    if (!file_valid) {
+        return;
+    }
+
+    FileUtil::IOFile trace_file{path, "rb"};
+    if (!trace_file.IsOpen() || !ReadHeader(trace_file, profile_hash)) {
+        file_valid = false;
+        return;
+    }
+
+    std::vector<u8> compressed;
+    while (true) {
+        EntryHeader header{};
+        if (trace_file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+            break;
+        }
+        compressed.resize(header.compressed_size);
+        if (trace_file.ReadSpan(std::span<u8>{compressed}) != compressed.size() ||
+            Common::ComputeHash64(compressed.data(), compressed.size()) != header.checksum) {
+            LOG_WARNING(Render_Vulkan, "Pipeline trace {} is truncated", path);
+            break;
+        }
+
+        const auto data = Common::Compression::DecompressDataZSTD(compressed);
+        if (header.type == EntryType::Shader && data.size() > sizeof(ShaderHeader)) {
+            ShaderHeader shader_header;
+            std::memcpy(&shader_header, data.data(), sizeof(shader_header));
+            shaders.push_back(PipelineTraceShader{
+                .stage = shader_header.stage,
+                .is_spirv = shader_header.is_spirv != 0,
+                .key = shader_header.key,
+                .code{data.begin() + sizeof(ShaderHeader), data.end()},
+            });
+        } else if (header.type == EntryType::Pipeline && data.size() == sizeof(PipelineTraceKey)) {
+            std::memcpy(&pipelines.emplace_back(), data.data(), sizeof(PipelineTraceKey));
+        }
+    }
+}
+
+void PipelineTrace::AppendShader(u32 stage, u64 key, bool is_spirv, std::span<const u8> code) {
+    const ShaderHeader header = {
+        .stage = stage,
+        .is_spirv = is_spirv,
+        .key = key,
+    };
+    std::vector<u8> payload(sizeof(header) + code.size());
+    std::memcpy(payload.data(), &header, sizeof(header));
+    std::memcpy(payload.data() + sizeof(header), code.data(), code.size());
+    Append(EntryType::Shader, payload);
+}
+
+void PipelineTrace::AppendPipeline(const PipelineTraceKey& pipeline) {
+    Append(EntryType::Pipeline, {reinterpret_cast<const u8*>(&pipeline), sizeof(pipeline)});
+}
+
+void PipelineTrace::Append(u32 type, std::span<const u8> payload) {
+    std::scoped_lock lock{mutex};
+
+    if (!file.IsOpen()) {
+        file = FileUtil::IOFile{path, file_valid ? "ab" : "wb"};
+        if (!file.IsOpen()) {
+            LOG_ERROR(Render_Vulkan, "Failed to open pipeline trace file={}", path);
+            return;
+        }
+        if (!file_valid) {
+            if (file.WriteObject(MakeHeader(profile_hash)) != 1) {
+                LOG_ERROR(Render_Vulkan, "Failed to write pipeline trace header");
+                file.Close();
+                return;
+            }
+            file_valid = true;
+        }
+    }
+
+    const auto compressed = Common::Compression::CompressDataZSTDDefault(payload);
+    const EntryHeader header = {
+        .type = type,
+        .reserved = 0,
+        .compressed_size = compressed.size(),
+        .checksum = Common::ComputeHash64(compressed.data(), compressed.size()),
+    };
+    if (file.WriteObject(header) != 1 ||
+        file.WriteSpan(std::span<const u8>{compressed}) != compressed.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to write pipeline trace entry");
+    }
+    file.Flush();
+}
+
+} // namespace Vulkan
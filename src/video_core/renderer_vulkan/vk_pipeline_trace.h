@@ -0,0 +1,63 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+
+namespace Vulkan {
+
+/// A shader generated by the pipeline cache, with the code needed to compile it again.
+struct PipelineTraceShader {
+    u32 stage;
+    bool is_spirv;
+    u64 key;
+    std::vector<u8> code;
+};
+
+/// The state and shader keys of a pipeline built by the pipeline cache.
+struct PipelineTraceKey {
+    PipelineInfo info;
+    std::array<u64, MAX_SHADER_STAGES> shader_hashes;
+};
+
+/**
+ * Per-title file recording the shaders and pipelines the pipeline cache built, so that the next
+ * boot can compile them ahead of time even when the driver pipeline cache is empty. Shaders are
+ * keyed by the hashes the pipeline cache uses for its stages, the file is discarded when it was
+ * written by a different build or for a different shader profile.
+ */
+class PipelineTrace {
+public:
+    explicit PipelineTrace(std::string path, u64 profile_hash);
+    ~PipelineTrace();
+
+    /// Reads the shaders and pipelines recorded by previous runs. Corrupted entries are dropped.
+    void Load(std::vector<PipelineTraceShader>& shaders, std::vector<PipelineTraceKey>& pipelines);
+
+    /// Records a newly generated shader.
+    void AppendShader(u32 stage, u64 key, bool is_spirv, std::span<const u8> code);
+
+    /// Records a newly built pipeline.
+    void AppendPipeline(const PipelineTraceKey& pipeline);
+
+private:
+    /// Appends an entry to the file, opening it on first use.
+    void Append(u32 type, std::span<const u8> payload);
+
+    std::string path;
+    u64 profile_hash;
+    std::mutex mutex;
+    FileUtil::IOFile file;
+    bool file_valid{};
+};
+
+} // namespace Vulkan
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/microprofile.h"
 #include "common/settings.h"
 #include "common/thread.h"
@@ -109,9 +110,11 @@ PresentWindow::PresentWindow(Frontend::EmuWindow& emu_window_, const Instance& i
       blit_supported{
           CanBlitToSwapchain(instance.GetPhysicalDevice(), swapchain.GetSurfaceFormat().format)},
       use_present_thread{Settings::values.async_presentation.GetValue()},
+      present_queue_depth{Settings::values.present_queue_depth.GetValue()},
       last_render_surface{emu_window.GetWindowInfo().render_surface} {
 
-    const u32 num_images = swapchain.GetImageCount();
+    // Keep enough frames to render the next one while the queue is full and one is presented
+    const u32 num_images = std::max(swapchain.GetImageCount(), present_queue_depth + 2);
     const vk::Device device = instance.GetDevice();
 
     const vk::CommandPoolCreateInfo pool_info = {
@@ -284,12 +287,49 @@ void PresentWindow::Present(Frame* frame) {
     }
 
     scheduler.Record([this, frame](vk::CommandBuffer) {
-        std::unique_lock lock{queue_mutex};
-        present_queue.push(frame);
-        frame_cv.notify_one();
+        Frame* dropped = nullptr;
+        {
+            std::unique_lock lock{queue_mutex};
+            present_queue.push(frame);
+            // When the queue is full the oldest frame is replaced, like a mailbox
+            if (present_queue_depth != 0 && present_queue.size() > present_queue_depth) {
+                dropped = present_queue.front();
+                present_queue.pop();
+            }
+            frame_cv.notify_one();
+        }
+        if (dropped) {
+            DropFrame(dropped);
+        }
     });
 }
 
+void PresentWindow::DropFrame(Frame* frame) {
+    // The render_ready semaphore was signaled by the render submission and still has to be
+    // waited on, the fence signals when the frame resources are free again
+    static constexpr vk::PipelineStageFlags wait_stage_mask =
+        vk::PipelineStageFlagBits::eAllCommands;
+    const vk::SubmitInfo submit_info = {
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &frame->render_ready,
+        .pWaitDstStageMask = &wait_stage_mask,
+    };
+
+    {
+        std::scoped_lock submit_lock{scheduler.submit_mutex};
+        try {
+            graphics_queue.submit(submit_info, frame->present_done);
+        } catch (vk::DeviceLostError& err) {
+            LOG_CRITICAL(Render_Vulkan, "Device lost during frame drop submit: {}", err.what());
+            UNREACHABLE();
+        }
+    }
+
+    std::scoped_lock lock{free_mutex};
+    free_queue.push(frame);
+    free_cv.notify_one();
+}
+
 void PresentWindow::WaitPresent() {
     if (!use_present_thread) {
         return;
@@ -349,13 +389,19 @@ void PresentWindow::CopyToSwapchain(Frame* frame) {
     const auto recreate_swapchain = [&] {
 #ifdef ANDROID
         {
+            // Rotation and resizes keep the window, only a lost surface needs a new one
             std::unique_lock lock{recreate_surface_mutex};
-            recreate_surface_cv.wait(lock, [this]() { return surface != next_surface; });
+            if (swapchain.IsSurfaceLost()) {
+                recreate_surface_cv.wait(lock, [this]() { return surface != next_surface; });
+            }
             surface = next_surface;
         }
 #endif
         std::scoped_lock submit_lock{scheduler.submit_mutex};
-        graphics_queue.waitIdle();
+        // A swapchain of the same surface is retired instead, letting in flight frames finish
+        if (swapchain.GetSurface() != surface) {
+            graphics_queue.waitIdle();
+        }
         swapchain.Create(frame->width, frame->height, surface, low_refresh_rate);
     };
 
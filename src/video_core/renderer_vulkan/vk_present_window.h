@@ -63,11 +63,19 @@ public:
         return swapchain.GetImageCount();
     }
 
+    /// Returns the latest measured delay between queueing a present and its display
+    std::chrono::nanoseconds PresentLatency() const noexcept {
+        return swapchain.GetPresentLatency();
+    }
+
 private:
     void PresentThread(std::stop_token token);
 
     void CopyToSwapchain(Frame* frame);
 
+    /// Returns a queued frame to the free queue without presenting it
+    void DropFrame(Frame* frame);
+
     vk::RenderPass CreateRenderpass();
 
 private:
@@ -95,6 +103,7 @@ private:
     bool vsync_enabled{};
     bool blit_supported;
     bool use_present_thread{true};
+    u32 present_queue_depth{};
     void* last_render_surface{};
 };
 
@@ -27,6 +27,8 @@ MICROPROFILE_DEFINE(Vulkan_GS, "Vulkan", "Geometry Shader Setup", MP_RGB(128, 19
 MICROPROFILE_DEFINE(Vulkan_Drawing, "Vulkan", "Drawing", MP_RGB(128, 128, 192));
 
 using TriangleTopology = Pica::PipelineRegs::TriangleTopology;
+using VideoCore::GeometryCache;
+using VideoCore::LutSlotCache;
 using VideoCore::SurfaceType;
 
 using namespace Common::Literals;
@@ -39,13 +41,25 @@ constexpr u64 TEXTURE_BUFFER_SIZE = 2_MiB;
 constexpr vk::BufferUsageFlags BUFFER_USAGE =
     vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer;
 
-struct DrawParams {
-    u32 vertex_count;
-    s32 vertex_offset;
-    u32 binding_count;
-    std::array<u32, 16> bindings;
-    bool is_indexed;
-};
+/// Copies vertex_num vertices of byte_count bytes each to dst, placing them stride bytes apart
+void CopyVertices(u8* dst, const u8* src, u32 vertex_num, u32 byte_count, u32 stride) {
+    if (stride == byte_count) {
+        std::memcpy(dst, src, vertex_num * byte_count);
+        return;
+    }
+    for (std::size_t vertex = 0; vertex < vertex_num; vertex++) {
+        std::memcpy(dst + vertex * stride, src + vertex * byte_count, byte_count);
+    }
+}
+
+/// Adds the storage usage required to widen 8-bit indices in the buffer when they are unsupported
+[[nodiscard]] vk::BufferUsageFlags GeometryUsage(const Instance& instance) {
+    vk::BufferUsageFlags usage = BUFFER_USAGE;
+    if (!instance.IsIndexTypeUint8Supported()) {
+        usage |= vk::BufferUsageFlagBits::eStorageBuffer;
+    }
+    return usage;
+}
 
 [[nodiscard]] u64 TextureBufferSize(const Instance& instance) {
     // Use the smallest texel size from the texel views
@@ -54,6 +68,15 @@ struct DrawParams {
     return std::min(max_size, TEXTURE_BUFFER_SIZE);
 }
 
+/// Adds the device address usage required to reference the buffer from a descriptor buffer
+[[nodiscard]] vk::BufferUsageFlags DescriptorUsage(const Instance& instance,
+                                                  vk::BufferUsageFlags usage) {
+    if (instance.IsDescriptorBufferSupported()) {
+        usage |= vk::BufferUsageFlagBits::eShaderDeviceAddress;
+    }
+    return usage;
+}
+
 } // Anonymous namespace
 
 RasterizerVulkan::RasterizerVulkan(Memory::MemorySystem& memory, Pica::PicaCore& pica,
@@ -66,18 +89,20 @@ RasterizerVulkan::RasterizerVulkan(Memory::MemorySystem& memory, Pica::PicaCore&
       renderpass_cache{renderpass_cache}, update_queue{update_queue_},
       pipeline_cache{instance, scheduler, renderpass_cache, update_queue},
       runtime{instance, scheduler, renderpass_cache, update_queue, image_count},
-      res_cache{memory, custom_tex_manager, runtime, regs, renderer},
+      res_cache{memory, custom_tex_manager, runtime, regs, renderer, pica.runtime_settings},
       stream_buffer{instance, scheduler, BUFFER_USAGE, STREAM_BUFFER_SIZE},
-      uniform_buffer{instance, scheduler, vk::BufferUsageFlagBits::eUniformBuffer,
+      uniform_buffer{instance, scheduler,
+                     DescriptorUsage(instance, vk::BufferUsageFlagBits::eUniformBuffer),
                      UNIFORM_BUFFER_SIZE},
-      texture_buffer{instance, scheduler, vk::BufferUsageFlagBits::eUniformTexelBuffer,
+      texture_buffer{instance, scheduler,
+                     DescriptorUsage(instance, vk::BufferUsageFlagBits::eUniformTexelBuffer),
                      TextureBufferSize(instance)},
-      texture_lf_buffer{instance, scheduler, vk::BufferUsageFlagBits::eUniformTexelBuffer,
+      texture_lf_buffer{instance, scheduler,
+                        DescriptorUsage(instance, vk::BufferUsageFlagBits::eUniformTexelBuffer),
                         TextureBufferSize(instance)},
+      geometry_buffer{instance, scheduler, GeometryUsage(instance), GeometryCache::BUFFER_SIZE},
       async_shaders{Settings::values.async_shader_compilation.GetValue()} {
 
-    vertex_buffers.fill(stream_buffer.Handle());
-
     // Query uniform buffer alignment.
     uniform_buffer_alignment = instance.UniformMinAlignment();
     uniform_size_aligned_vs_pica =
@@ -112,28 +137,30 @@ RasterizerVulkan::RasterizerVulkan(Memory::MemorySystem& memory, Pica::PicaCore&
     scheduler.RegisterOnSubmit([&renderpass_cache] { renderpass_cache.EndRendering(); });
 
     // Prepare the static buffer descriptor set.
-    const auto buffer_set = pipeline_cache.Acquire(DescriptorHeapType::Buffer);
-    update_queue.AddBuffer(buffer_set, 0, uniform_buffer.Handle(), 0, sizeof(VSPicaUniformData));
-    update_queue.AddBuffer(buffer_set, 1, uniform_buffer.Handle(), 0, sizeof(VSUniformData));
-    update_queue.AddBuffer(buffer_set, 2, uniform_buffer.Handle(), 0, sizeof(FSUniformData));
-    update_queue.AddTexelBuffer(buffer_set, 3, *texture_lf_view);
-    update_queue.AddTexelBuffer(buffer_set, 4, *texture_rg_view);
-    update_queue.AddTexelBuffer(buffer_set, 5, *texture_rgba_view);
-
-    const auto texture_set = pipeline_cache.Acquire(DescriptorHeapType::Texture);
+    const u64 texture_buffer_size = TextureBufferSize(instance);
+    auto buffer_set = pipeline_cache.Acquire(DescriptorHeapType::Buffer);
+    buffer_set.AddUniformBuffer(0, uniform_buffer.Handle(), sizeof(VSPicaUniformData));
+    buffer_set.AddUniformBuffer(1, uniform_buffer.Handle(), sizeof(VSUniformData));
+    buffer_set.AddUniformBuffer(2, uniform_buffer.Handle(), sizeof(FSUniformData));
+    buffer_set.AddTexelBuffer(3, *texture_lf_view, texture_lf_buffer.Handle(),
+                              vk::Format::eR32G32Sfloat, texture_buffer_size);
+    buffer_set.AddTexelBuffer(4, *texture_rg_view, texture_buffer.Handle(),
+                              vk::Format::eR32G32Sfloat, texture_buffer_size);
+    buffer_set.AddTexelBuffer(5, *texture_rgba_view, texture_buffer.Handle(),
+                              vk::Format::eR32G32B32A32Sfloat, texture_buffer_size);
+
+    auto texture_set = pipeline_cache.Acquire(DescriptorHeapType::Texture);
     Surface& null_surface = res_cache.GetSurface(VideoCore::NULL_SURFACE_ID);
     Sampler& null_sampler = res_cache.GetSampler(VideoCore::NULL_SAMPLER_ID);
 
     // Prepare texture and utility descriptor sets.
     for (u32 i = 0; i < 3; i++) {
-        update_queue.AddImageSampler(texture_set, i, 0, null_surface.ImageView(),
-                                     null_sampler.Handle());
+        texture_set.AddImageSampler(i, 0, null_surface.ImageView(), null_sampler.Handle());
     }
 
-    const auto utility_set = pipeline_cache.Acquire(DescriptorHeapType::Utility);
-    update_queue.AddStorageImage(utility_set, 0, null_surface.StorageView());
-    update_queue.AddImageSampler(utility_set, 1, 0, null_surface.ImageView(),
-                                 null_sampler.Handle());
+    auto utility_set = pipeline_cache.Acquire(DescriptorHeapType::Utility);
+    utility_set.AddStorageImage(0, null_surface.StorageView());
+    utility_set.AddImageSampler(1, 0, null_surface.ImageView(), null_sampler.Handle());
     update_queue.Flush();
 }
 
@@ -143,6 +170,10 @@ void RasterizerVulkan::TickFrame() {
     res_cache.TickFrame();
 }
 
+u64 RasterizerVulkan::GetTextureMemoryUsage() const {
+    return res_cache.GetTextureMemoryUsage();
+}
+
 void RasterizerVulkan::LoadDefaultDiskResources(
     const std::atomic_bool& stop_loading, const VideoCore::DiskResourceLoadCallback& callback) {
 
@@ -158,6 +189,9 @@ void RasterizerVulkan::LoadDefaultDiskResources(
 
 void RasterizerVulkan::SyncDrawState() {
     SyncDrawUniforms();
+    if (!std::exchange(fixed_state_dirty, false)) {
+        return;
+    }
 
     // SyncCullMode();
     pipeline_info.rasterization.cull_mode.Assign(regs.rasterizer.cull_mode);
@@ -250,6 +284,7 @@ void RasterizerVulkan::SetupVertexArray() {
     layout.binding_count = 0;
     layout.attribute_count = 16;
     enable_attributes.fill(false);
+    geometry_bindings = 0;
 
     u32 buffer_offset = 0;
     for (const auto& loader : vertex_attributes.attribute_loaders) {
@@ -293,28 +328,40 @@ void RasterizerVulkan::SetupVertexArray() {
         const PAddr data_addr =
             base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
         const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
-        u32 data_size = loader.byte_count * vertex_num;
-        res_cache.FlushRegion(data_addr, data_size);
-
-        const MemoryRef src_ref = memory.GetPhysicalRef(data_addr);
-        if (src_ref.GetSize() < data_size) {
-            LOG_ERROR(Render_Vulkan,
-                      "Vertex buffer size {} exceeds available space {} at address {:#016X}",
-                      data_size, src_ref.GetSize(), data_addr);
-        }
-
-        const u8* src_ptr = src_ref.GetPtr();
-        u8* dst_ptr = array_ptr + buffer_offset;
+        const u32 data_size = loader.byte_count * vertex_num;
 
         // Align stride up if required by Vulkan implementation.
         const u32 aligned_stride =
             Common::AlignUp(static_cast<u32>(loader.byte_count), stride_alignment);
-        if (aligned_stride == loader.byte_count) {
-            std::memcpy(dst_ptr, src_ptr, data_size);
-        } else {
-            for (std::size_t vertex = 0; vertex < vertex_num; vertex++) {
-                std::memcpy(dst_ptr + vertex * aligned_stride, src_ptr + vertex * loader.byte_count,
-                            loader.byte_count);
+        const u32 upload_size = aligned_stride * vertex_num;
+
+        // Static meshes are read from their upload to the geometry buffer by an earlier draw
+        const GeometryCache::Key key = {
+            .addr = data_addr,
+            .size = data_size,
+            .format = GeometryCache::VertexFormat(loader.byte_count, aligned_stride),
+        };
+        std::optional<u32> geometry_offset = geometry_cache.Find(res_cache, key);
+        if (!geometry_offset) {
+            res_cache.FlushRegion(data_addr, data_size);
+
+            const MemoryRef src_ref = memory.GetPhysicalRef(data_addr);
+            if (src_ref.GetSize() < data_size) {
+                LOG_ERROR(Render_Vulkan,
+                          "Vertex buffer size {} exceeds available space {} at address {:#016X}",
+                          data_size, src_ref.GetSize(), data_addr);
+            }
+
+            const u8* src_ptr = src_ref.GetPtr();
+            if (geometry_cache.Reserve(res_cache, key, upload_size)) {
+                u8* dst_ptr;
+                std::tie(dst_ptr, geometry_offset) = MapGeometry(upload_size, 16);
+                CopyVertices(dst_ptr, src_ptr, vertex_num, loader.byte_count, aligned_stride);
+                geometry_buffer.Commit(upload_size);
+                geometry_cache.Insert(key, *geometry_offset, upload_size);
+            } else {
+                CopyVertices(array_ptr + buffer_offset, src_ptr, vertex_num, loader.byte_count,
+                             aligned_stride);
             }
         }
 
@@ -325,11 +372,19 @@ void RasterizerVulkan::SetupVertexArray() {
         binding.stride.Assign(aligned_stride);
 
         // Keep track of the binding offsets so we can bind the vertex buffer later
-        binding_offsets[layout.binding_count++] = static_cast<u32>(array_offset + buffer_offset);
-        buffer_offset += Common::AlignUp(aligned_stride * vertex_num, 4);
+        if (geometry_offset) {
+            geometry_bindings |= 1U << layout.binding_count;
+            binding_offsets[layout.binding_count++] = *geometry_offset;
+        } else {
+            binding_offsets[layout.binding_count++] =
+                static_cast<u32>(array_offset + buffer_offset);
+            buffer_offset += Common::AlignUp(upload_size, 4);
+        }
     }
 
-    stream_buffer.Commit(buffer_offset);
+    if (buffer_offset > 0) {
+        stream_buffer.Commit(buffer_offset);
+    }
 
     // Assign the rest of the attributes to the last binding
     SetupFixedAttribs();
@@ -439,10 +494,19 @@ bool RasterizerVulkan::AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
 
+    if (geometry_cache.TakePendingWrap()) {
+        // Mapping the whole buffer makes it start over from the beginning
+        std::ignore = geometry_buffer.Map(GeometryCache::BUFFER_SIZE, 0);
+        geometry_cache.Invalidate();
+    }
+
     // Vertex data setup might involve scheduler flushes so perform it
     // early to avoid invalidating our state in the middle of the draw.
     vertex_info = AnalyzeVertexArray(is_indexed, instance.GetMinVertexStrideAlignment());
     SetupVertexArray();
+    if (is_indexed) {
+        SetupIndexArray();
+    }
 
     if (!SetupVertexShader()) {
         return false;
@@ -455,34 +519,30 @@ bool RasterizerVulkan::AccelerateDrawBatch(bool is_indexed) {
 }
 
 bool RasterizerVulkan::AccelerateDrawBatchInternal(bool is_indexed) {
-    if (is_indexed) {
-        SetupIndexArray();
-    }
-
     const bool wait_built = !async_shaders || regs.pipeline.num_vertices <= 6;
     if (!pipeline_cache.BindPipeline(pipeline_info, wait_built)) {
         return true;
     }
 
-    const DrawParams params = {
-        .vertex_count = regs.pipeline.num_vertices,
-        .vertex_offset = -static_cast<s32>(vertex_info.vs_input_index_min),
-        .binding_count = pipeline_info.vertex_layout.binding_count,
-        .bindings = binding_offsets,
-        .is_indexed = is_indexed,
-    };
+    const u32 binding_count = pipeline_info.vertex_layout.binding_count;
+    std::array<vk::Buffer, 16> buffers;
+    std::array<vk::DeviceSize, 16> offsets;
+    for (u32 i = 0; i < binding_count; i++) {
+        const bool geometry = (geometry_bindings >> i) & 1;
+        buffers[i] = geometry ? geometry_buffer.Handle() : stream_buffer.Handle();
+        offsets[i] = binding_offsets[i];
+    }
+    scheduler.RecordBindVertexBuffers(0, std::span{buffers.data(), binding_count},
+                                      std::span{offsets.data(), binding_count});
 
-    scheduler.Record([this, params](vk::CommandBuffer cmdbuf) {
-        std::array<vk::DeviceSize, 16> offsets;
-        std::transform(params.bindings.begin(), params.bindings.end(), offsets.begin(),
-                       [](u32 offset) { return static_cast<vk::DeviceSize>(offset); });
-        cmdbuf.bindVertexBuffers(0, params.binding_count, vertex_buffers.data(), offsets.data());
-        if (params.is_indexed) {
-            cmdbuf.drawIndexed(params.vertex_count, 1, 0, params.vertex_offset, 0);
-        } else {
-            cmdbuf.draw(params.vertex_count, 1, 0, 0);
-        }
-    });
+    const u32 vertex_count = regs.pipeline.num_vertices;
+    if (is_indexed) {
+        scheduler.RecordBindIndexBuffer(index_buffer, index_offset, index_type);
+        scheduler.RecordDrawIndexed(vertex_count, 1, 0,
+                                    -static_cast<s32>(vertex_info.vs_input_index_min), 0);
+    } else {
+        scheduler.RecordDraw(vertex_count, 1, 0, 0);
+    }
 
     return true;
 }
@@ -490,18 +550,61 @@ bool RasterizerVulkan::AccelerateDrawBatchInternal(bool is_indexed) {
 void RasterizerVulkan::SetupIndexArray() {
     const bool index_u8 = regs.pipeline.index_array.format == 0;
     const bool native_u8 = index_u8 && instance.IsIndexTypeUint8Supported();
-    const u32 index_buffer_size = regs.pipeline.num_vertices * (native_u8 ? 1 : 2);
-    const vk::IndexType index_type = native_u8 ? vk::IndexType::eUint8EXT : vk::IndexType::eUint16;
+    const bool expand_u8 = index_u8 && !native_u8;
+    const u32 num_indices = regs.pipeline.num_vertices;
+    const u32 index_buffer_size = num_indices * (native_u8 ? 1 : 2);
+    index_type = native_u8 ? vk::IndexType::eUint8EXT : vk::IndexType::eUint16;
+
+    const PAddr index_addr = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
+                             regs.pipeline.index_array.offset;
+    const u8* index_data = memory.GetPhysicalPointer(index_addr);
+
+    const GeometryCache::Key key = {
+        .addr = index_addr,
+        .size = num_indices * (index_u8 ? 1 : 2),
+        .format = GeometryCache::IndexFormat(!index_u8, !native_u8),
+    };
+    if (const auto cached_offset = geometry_cache.Find(res_cache, key)) {
+        index_buffer = geometry_buffer.Handle();
+        index_offset = *cached_offset;
+        return;
+    }
 
-    const u8* index_data =
-        memory.GetPhysicalPointer(regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
-                                  regs.pipeline.index_array.offset);
+    if (expand_u8) {
+        // Reused 8-bit indices are copied as is and widened by a compute pass, which writes them
+        // after the raw indices in the geometry buffer.
+        const u32 raw_size = Common::AlignUp(num_indices, 4);
+        const u32 upload_size = raw_size * 3;
+        if (geometry_cache.Reserve(res_cache, key, upload_size)) {
+            const auto [index_ptr, offset] =
+                MapGeometry(upload_size, std::max<u64>(instance.StorageMinAlignment(), 4));
+            std::memcpy(index_ptr, index_data, num_indices);
+            geometry_buffer.Commit(upload_size);
+            runtime.ExpandIndices(geometry_buffer.Handle(), offset, upload_size, raw_size,
+                                  num_indices);
+
+            geometry_cache.Insert(key, offset + raw_size, raw_size * 2);
+            index_buffer = geometry_buffer.Handle();
+            index_offset = offset + raw_size;
+            return;
+        }
+    } else if (geometry_cache.Reserve(res_cache, key, index_buffer_size)) {
+        const auto [index_ptr, offset] = MapGeometry(index_buffer_size, 2);
+        std::memcpy(index_ptr, index_data, index_buffer_size);
+        geometry_buffer.Commit(index_buffer_size);
+
+        geometry_cache.Insert(key, offset, index_buffer_size);
+        index_buffer = geometry_buffer.Handle();
+        index_offset = offset;
+        return;
+    }
 
-    auto [index_ptr, index_offset, _] = stream_buffer.Map(index_buffer_size, 2);
+    // Indices that are not reused are widened here, as a compute pass would end the render pass
+    auto [index_ptr, offset, _] = stream_buffer.Map(index_buffer_size, 2);
 
-    if (index_u8 && !native_u8) {
+    if (expand_u8) {
         u16* index_ptr_u16 = reinterpret_cast<u16*>(index_ptr);
-        for (u32 i = 0; i < regs.pipeline.num_vertices; i++) {
+        for (u32 i = 0; i < num_indices; i++) {
             index_ptr_u16[i] = index_data[i];
         }
     } else {
@@ -509,11 +612,16 @@ void RasterizerVulkan::SetupIndexArray() {
     }
 
     stream_buffer.Commit(index_buffer_size);
+    index_buffer = stream_buffer.Handle();
+    index_offset = offset;
+}
 
-    scheduler.Record(
-        [this, index_offset = index_offset, index_type = index_type](vk::CommandBuffer cmdbuf) {
-            cmdbuf.bindIndexBuffer(stream_buffer.Handle(), index_offset, index_type);
-        });
+std::pair<u8*, u32> RasterizerVulkan::MapGeometry(u32 size, u64 alignment) {
+    const auto [ptr, offset, invalidate] = geometry_buffer.Map(size, alignment);
+    if (invalidate) {
+        geometry_cache.Invalidate();
+    }
+    return {ptr, offset};
 }
 
 void RasterizerVulkan::DrawTriangles() {
@@ -532,6 +640,7 @@ void RasterizerVulkan::DrawTriangles() {
 
 bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(Vulkan_Drawing);
+    Core::PerfStats::ScopedRendererTimer timer{Core::PerfStats::FrameStage::RasterizerSubmit};
     SyncDrawState();
 
     const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
@@ -552,6 +661,12 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
         return true;
     }
 
+    // The surfaces are still invalidated as if drawn to when fb_helper goes out of scope
+    if (skip_frame && res_cache.CanSkipDraw(*framebuffer)) {
+        vertex_batch.clear();
+        return true;
+    }
+
     pipeline_info.attachments.color = framebuffer->Format(SurfaceType::Color);
     pipeline_info.attachments.depth = framebuffer->Format(SurfaceType::Depth);
 
@@ -572,7 +687,7 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
     SyncUtilityTextures(framebuffer);
 
     // Sync and bind the shader
-    pipeline_cache.UseFragmentShader(regs, user_config);
+    pipeline_cache.UseFragmentShader(regs, user_config, std::exchange(fs_config_dirty, false));
 
     // Sync the LUTs within the texture buffer
     SyncAndUploadLUTs();
@@ -581,7 +696,9 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
 
     // Begin rendering
     const auto draw_rect = fb_helper.DrawRect();
-    renderpass_cache.BeginRendering(framebuffer, draw_rect);
+    renderpass_cache.BeginRendering(framebuffer, draw_rect,
+                                    shadow_rendering ? Core::PerfStats::GpuPass::Shadow
+                                                     : Core::PerfStats::GpuPass::Scene);
 
     // Configure viewport and scissor
     const auto viewport = fb_helper.Viewport();
@@ -607,10 +724,10 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
         std::memcpy(buffer, vertex_batch.data(), vertex_size);
         stream_buffer.Commit(vertex_size);
 
-        scheduler.Record([this, offset = offset, vertex_count](vk::CommandBuffer cmdbuf) {
-            cmdbuf.bindVertexBuffers(0, stream_buffer.Handle(), offset);
-            cmdbuf.draw(vertex_count, 1, 0, 0);
-        });
+        const vk::Buffer vertex_buffer = stream_buffer.Handle();
+        const vk::DeviceSize vertex_offset = offset;
+        scheduler.RecordBindVertexBuffers(0, {&vertex_buffer, 1}, {&vertex_offset, 1});
+        scheduler.RecordDraw(vertex_count, 1, 0, 0);
     }
 
     vertex_batch.clear();
@@ -623,8 +740,8 @@ void RasterizerVulkan::SyncTextureUnits(const Framebuffer* framebuffer) {
     const auto pica_textures = regs.texturing.GetTextures();
     const bool use_cube_heap =
         pica_textures[0].enabled && pica_textures[0].config.type == TextureType::ShadowCube;
-    const auto texture_set = pipeline_cache.Acquire(use_cube_heap ? DescriptorHeapType::Texture
-                                                                  : DescriptorHeapType::Texture);
+    auto texture_set = pipeline_cache.Acquire(use_cube_heap ? DescriptorHeapType::Texture
+                                                            : DescriptorHeapType::Texture);
 
     for (u32 texture_index = 0; texture_index < pica_textures.size(); ++texture_index) {
         const auto& texture = pica_textures[texture_index];
@@ -633,8 +750,8 @@ void RasterizerVulkan::SyncTextureUnits(const Framebuffer* framebuffer) {
         if (!texture.enabled) {
             const Surface& null_surface = res_cache.GetSurface(VideoCore::NULL_SURFACE_ID);
             const Sampler& null_sampler = res_cache.GetSampler(VideoCore::NULL_SAMPLER_ID);
-            update_queue.AddImageSampler(texture_set, texture_index, 0, null_surface.ImageView(),
-                                         null_sampler.Handle());
+            texture_set.AddImageSampler(texture_index, 0, null_surface.ImageView(),
+                                        null_sampler.Handle());
             continue;
         }
 
@@ -645,8 +762,8 @@ void RasterizerVulkan::SyncTextureUnits(const Framebuffer* framebuffer) {
                 Surface& surface = res_cache.GetTextureSurface(texture);
                 Sampler& sampler = res_cache.GetSampler(texture.config);
                 surface.flags |= VideoCore::SurfaceFlagBits::ShadowMap;
-                update_queue.AddImageSampler(texture_set, texture_index, 0, surface.StorageView(),
-                                             sampler.Handle());
+                texture_set.AddImageSampler(texture_index, 0, surface.StorageView(),
+                                            sampler.Handle());
                 continue;
             }
             case TextureType::ShadowCube: {
@@ -669,7 +786,7 @@ void RasterizerVulkan::SyncTextureUnits(const Framebuffer* framebuffer) {
         const bool is_feedback_loop = color_view == surface.ImageView();
         const vk::ImageView texture_view =
             is_feedback_loop ? surface.CopyImageView() : surface.ImageView();
-        update_queue.AddImageSampler(texture_set, texture_index, 0, texture_view, sampler.Handle());
+        texture_set.AddImageSampler(texture_index, 0, texture_view, sampler.Handle());
     }
 }
 
@@ -679,12 +796,12 @@ void RasterizerVulkan::SyncUtilityTextures(const Framebuffer* framebuffer) {
         return;
     }
 
-    const auto utility_set = pipeline_cache.Acquire(DescriptorHeapType::Utility);
-    update_queue.AddStorageImage(utility_set, 0, framebuffer->ImageView(SurfaceType::Color));
+    auto utility_set = pipeline_cache.Acquire(DescriptorHeapType::Utility);
+    utility_set.AddStorageImage(0, framebuffer->ImageView(SurfaceType::Color));
 }
 
 void RasterizerVulkan::BindShadowCube(const Pica::TexturingRegs::FullTextureConfig& texture,
-                                      vk::DescriptorSet texture_set) {
+                                      DescriptorWriter& texture_set) {
     using CubeFace = Pica::TexturingRegs::CubeFace;
     auto info = Pica::Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
     constexpr std::array faces = {
@@ -701,13 +818,12 @@ void RasterizerVulkan::BindShadowCube(const Pica::TexturingRegs::FullTextureConf
         const VideoCore::SurfaceId surface_id = res_cache.GetTextureSurface(info);
         Surface& surface = res_cache.GetSurface(surface_id);
         surface.flags |= VideoCore::SurfaceFlagBits::ShadowMap;
-        update_queue.AddImageSampler(texture_set, 0, binding, surface.StorageView(),
-                                     sampler.Handle());
+        texture_set.AddImageSampler(0, binding, surface.StorageView(), sampler.Handle());
     }
 }
 
 void RasterizerVulkan::BindTextureCube(const Pica::TexturingRegs::FullTextureConfig& texture,
-                                       vk::DescriptorSet texture_set) {
+                                       DescriptorWriter& texture_set) {
     using CubeFace = Pica::TexturingRegs::CubeFace;
     const VideoCore::TextureCubeConfig config = {
         .px = regs.texturing.GetCubePhysicalAddress(CubeFace::PositiveX),
@@ -723,7 +839,7 @@ void RasterizerVulkan::BindTextureCube(const Pica::TexturingRegs::FullTextureCon
 
     Surface& surface = res_cache.GetTextureCube(config);
     Sampler& sampler = res_cache.GetSampler(texture.config);
-    update_queue.AddImageSampler(texture_set, 0, 0, surface.ImageView(), sampler.Handle());
+    texture_set.AddImageSampler(0, 0, surface.ImageView(), sampler.Handle());
 }
 
 void RasterizerVulkan::FlushAll() {
@@ -744,6 +860,7 @@ void RasterizerVulkan::FlushAndInvalidateRegion(PAddr addr, u32 size) {
 }
 
 void RasterizerVulkan::ClearAll(bool flush) {
+    geometry_cache.Clear(res_cache);
     res_cache.ClearAll(flush);
 }
 
@@ -831,10 +948,17 @@ void RasterizerVulkan::SyncAndUploadLUTsLF() {
         return;
     }
 
+    // Only LUTs whose contents are not in the buffer yet are converted and uploaded
+    RebindCachedLUTsLF();
+    if (!pica.lighting.lut_dirty && !pica.fog.lut_dirty) {
+        return;
+    }
+
     std::size_t bytes_used = 0;
     auto [buffer, offset, invalidate] = texture_lf_buffer.Map(max_size, sizeof(Common::Vec4f));
 
     if (invalidate) {
+        lut_lf_slots.Clear();
         pica.lighting.lut_dirty = pica.lighting.LutAllDirty;
         pica.fog.lut_dirty = true;
     }
@@ -849,8 +973,10 @@ void RasterizerVulkan::SyncAndUploadLUTsLF() {
         for (u32 i = 0; i < source_lut.size(); i++) {
             new_data[i] = {source_lut[i].ToFloat(), source_lut[i].DiffToFloat()};
         }
-        fs_data.lighting_lut_offset[index / 4][index % 4] =
-            static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        const int lut_offset = static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        fs_data.lighting_lut_offset[index / 4][index % 4] = lut_offset;
+        lut_lf_slots.Insert(LutSlotCache::Key(source_lut, LutSlotCache::Format::Lighting),
+                            lut_offset);
         fs_data_dirty = true;
         bytes_used += source_lut.size() * sizeof(Common::Vec2f);
     }
@@ -862,6 +988,8 @@ void RasterizerVulkan::SyncAndUploadLUTsLF() {
             new_data[i] = {pica.fog.lut[i].ToFloat(), pica.fog.lut[i].DiffToFloat()};
         }
         fs_data.fog_lut_offset = static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+        lut_lf_slots.Insert(LutSlotCache::Key(pica.fog.lut, LutSlotCache::Format::Fog),
+                            fs_data.fog_lut_offset);
         fs_data_dirty = true;
         bytes_used += pica.fog.lut.size() * sizeof(Common::Vec2f);
         pica.fog.lut_dirty = false;
@@ -877,7 +1005,13 @@ void RasterizerVulkan::SyncAndUploadLUTs() {
         sizeof(Common::Vec4f) * 256 +     // proctex
         sizeof(Common::Vec4f) * 256;      // proctex diff
 
-    if (!pica.proctex.lut_dirty) {
+    if (!pica.proctex.table_dirty) {
+        return;
+    }
+
+    // Only LUTs whose contents are not in the buffer yet are converted and uploaded
+    RebindCachedLUTs();
+    if (!pica.proctex.table_dirty) {
         return;
     }
 
@@ -885,6 +1019,7 @@ void RasterizerVulkan::SyncAndUploadLUTs() {
     auto [buffer, offset, invalidate] = texture_buffer.Map(max_size, sizeof(Common::Vec4f));
 
     if (invalidate) {
+        lut_slots.Clear();
         pica.proctex.table_dirty = pica.proctex.TableAllDirty;
     }
 
@@ -896,6 +1031,8 @@ void RasterizerVulkan::SyncAndUploadLUTs() {
                 new_data[i] = {lut[i].ToFloat(), lut[i].DiffToFloat()};
             }
             lut_offset = static_cast<int>((offset + bytes_used) / sizeof(Common::Vec2f));
+            lut_slots.Insert(LutSlotCache::Key(lut, LutSlotCache::Format::ProcTexValue),
+                             lut_offset);
             fs_data_dirty = true;
             bytes_used += lut.size() * sizeof(Common::Vec2f);
         };
@@ -923,6 +1060,8 @@ void RasterizerVulkan::SyncAndUploadLUTs() {
         }
         fs_data.proctex_lut_offset =
             static_cast<int>((offset + bytes_used) / sizeof(Common::Vec4f));
+        lut_slots.Insert(LutSlotCache::Key(proctex.color_table, LutSlotCache::Format::ProcTexColor),
+                         fs_data.proctex_lut_offset);
         fs_data_dirty = true;
         bytes_used += proctex.color_table.size() * sizeof(Common::Vec4f);
     }
@@ -935,6 +1074,9 @@ void RasterizerVulkan::SyncAndUploadLUTs() {
         }
         fs_data.proctex_diff_lut_offset =
             static_cast<int>((offset + bytes_used) / sizeof(Common::Vec4f));
+        lut_slots.Insert(LutSlotCache::Key(proctex.color_diff_table,
+                                           LutSlotCache::Format::ProcTexColorDifference),
+                         fs_data.proctex_diff_lut_offset);
         fs_data_dirty = true;
         bytes_used += proctex.color_diff_table.size() * sizeof(Common::Vec4f);
     }
@@ -972,11 +1114,9 @@ void RasterizerVulkan::UploadUniforms(bool accelerate_draw) {
     }
 
     if (sync_vs_pica || invalidate) {
-        VSPicaUniformData vs_uniforms;
-        vs_uniforms.SetFromRegs(pica.vs_setup);
-        std::memcpy(uniforms + used_bytes, &vs_uniforms, sizeof(vs_uniforms));
+        SyncVSPicaUniforms();
+        std::memcpy(uniforms + used_bytes, &vs_pica_data, sizeof(vs_pica_data));
         pipeline_cache.UpdateRange(0, offset + used_bytes);
-        pica.vs_setup.uniforms_dirty = false;
         used_bytes += uniform_size_aligned_vs_pica;
     }
 
@@ -988,4 +1128,8 @@ void RasterizerVulkan::SwitchDiskResources(u64 title_id) {
     pipeline_cache.SwitchPipelineCache(title_id, stop_loading, switch_disk_resources_callback);
 }
 
+void RasterizerVulkan::SaveDiskResources() {
+    pipeline_cache.SaveDiskCache();
+}
+
 } // namespace Vulkan
@@ -45,6 +45,7 @@ public:
     ~RasterizerVulkan() override;
 
     void TickFrame();
+    u64 GetTextureMemoryUsage() const;
     void LoadDefaultDiskResources(const std::atomic_bool& stop_loading,
                                   const VideoCore::DiskResourceLoadCallback& callback) override;
 
@@ -63,6 +64,7 @@ public:
 
     /// Switches the disk resources to the specified title
     void SwitchDiskResources(u64 title_id) override;
+    void SaveDiskResources() override;
 
 private:
     /// Syncs pipeline state from PICA registers
@@ -80,11 +82,11 @@ private:
 
     /// Binds the PICA shadow cube required for shadow mapping
     void BindShadowCube(const Pica::TexturingRegs::FullTextureConfig& texture,
-                        vk::DescriptorSet texture_set);
+                        DescriptorWriter& texture_set);
 
     /// Binds a texture cube to texture unit 0
     void BindTextureCube(const Pica::TexturingRegs::FullTextureConfig& texture,
-                         vk::DescriptorSet texture_set);
+                         DescriptorWriter& texture_set);
 
     /// Upload the uniform blocks to the uniform buffer object
     void UploadUniforms(bool accelerate_draw);
@@ -104,6 +106,9 @@ private:
     /// Setup the fixed attribute emulation in vulkan
     void SetupFixedAttribs();
 
+    /// Reserves memory in the geometry buffer for a range reserved by the geometry cache
+    std::pair<u8*, u32> MapGeometry(u32 size, u64 alignment);
+
     /// Setup vertex shader for AccelerateDrawBatch
     bool SetupVertexShader();
 
@@ -125,7 +130,10 @@ private:
     VertexLayout software_layout;
     std::array<u32, 16> binding_offsets{};
     std::array<bool, 16> enable_attributes{};
-    std::array<vk::Buffer, 16> vertex_buffers;
+    u32 geometry_bindings{}; ///< Mask of the vertex bindings read from the geometry buffer
+    vk::Buffer index_buffer; ///< Buffer the indices of the draw are read from
+    u32 index_offset{};      ///< Offset of the indices of the draw in index_buffer
+    vk::IndexType index_type{};
     VertexArrayInfo vertex_info;
     PipelineInfo pipeline_info{};
 
@@ -133,6 +141,7 @@ private:
     StreamBuffer uniform_buffer;    ///< Uniform buffer
     StreamBuffer texture_buffer;    ///< Texture buffer
     StreamBuffer texture_lf_buffer; ///< Texture Light-Fog buffer
+    StreamBuffer geometry_buffer;   ///< Vertex+Index buffer of static meshes
     vk::UniqueBufferView texture_lf_view;
     vk::UniqueBufferView texture_rg_view;
     vk::UniqueBufferView texture_rgba_view;
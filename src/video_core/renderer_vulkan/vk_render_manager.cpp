@@ -2,13 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <boost/container/static_vector.hpp>
 #include "common/assert.h"
+#include "common/tracing.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_render_manager.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_texture_runtime.h"
 
+#include <vulkan/vulkan_format_traits.hpp>
+
 namespace Vulkan {
 
 constexpr u32 MinDrawsToFlush = 20;
@@ -22,7 +27,8 @@ RenderManager::RenderManager(const Instance& instance, Scheduler& scheduler)
 RenderManager::~RenderManager() = default;
 
 void RenderManager::BeginRendering(const Framebuffer* framebuffer,
-                                   Common::Rectangle<u32> draw_rect) {
+                                   Common::Rectangle<u32> draw_rect,
+                                   Core::PerfStats::GpuPass timed_pass) {
     const vk::Rect2D render_area = {
         .offset{
             .x = static_cast<s32>(draw_rect.left),
@@ -33,88 +39,183 @@ void RenderManager::BeginRendering(const Framebuffer* framebuffer,
             .height = draw_rect.GetHeight(),
         },
     };
-    const RenderPass new_pass = {
+    RenderPass new_pass = {
         .framebuffer = framebuffer->Handle(),
         .render_pass = framebuffer->RenderPass(),
         .render_area = render_area,
         .clear = {},
-        .do_clear = false,
+        .clear_count = 0,
     };
+
+    const PixelFormat color_format = framebuffer->Format(SurfaceType::Color);
+    const PixelFormat depth_format = framebuffer->Format(SurfaceType::DepthStencil);
+    const std::array<PixelFormat, 2> formats = {color_format, depth_format};
+    std::array<bool, 2> cleared{};
+    if (!deferred_clears.empty()) {
+        // Clears of images drawn to entirely become the load ops of the render pass
+        const std::array<vk::Image, 2> fb_images = framebuffer->Images();
+        boost::container::static_vector<DeferredClear, 2> folded;
+        u32 attachment = 0;
+        for (u32 i = 0; i < fb_images.size(); i++) {
+            if (formats[i] == PixelFormat::Invalid) {
+                continue;
+            }
+            if (const auto clear = TakeClear(fb_images[i], render_area)) {
+                new_pass.clear[attachment] = clear->value;
+                new_pass.clear_count = attachment + 1;
+                cleared[i] = true;
+                folded.push_back(*clear);
+            }
+            attachment++;
+        }
+
+        if (!folded.empty()) {
+            EndRendering();
+            new_pass.render_pass =
+                GetRenderpass(color_format, depth_format, cleared[0], cleared[1]);
+            scheduler.Record([folded](vk::CommandBuffer cmdbuf) {
+                for (const DeferredClear& clear : folded) {
+                    const bool is_color =
+                        static_cast<bool>(clear.aspect & vk::ImageAspectFlagBits::eColor);
+                    const vk::ImageMemoryBarrier barrier = {
+                        .srcAccessMask = clear.access,
+                        .dstAccessMask = is_color
+                                             ? vk::AccessFlagBits::eColorAttachmentWrite
+                                             : vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                        .oldLayout = vk::ImageLayout::eGeneral,
+                        .newLayout = vk::ImageLayout::eGeneral,
+                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .image = clear.image,
+                        .subresourceRange{
+                            .aspectMask = clear.aspect,
+                            .baseMipLevel = 0,
+                            .levelCount = 1,
+                            .baseArrayLayer = 0,
+                            .layerCount = VK_REMAINING_ARRAY_LAYERS,
+                        },
+                    };
+                    cmdbuf.pipelineBarrier(clear.pipeline_flags,
+                                           is_color
+                                               ? vk::PipelineStageFlagBits::eColorAttachmentOutput
+                                               : vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                                           vk::DependencyFlagBits::eByRegion, {}, {}, barrier);
+                }
+            });
+        }
+    }
+
+    if (!(pass == new_pass) && Common::Tracing::IsEnabled()) {
+        // Attachments are stored at the end of every pass, only the cleared ones skip the load
+        const u64 area = u64{render_area.extent.width} * render_area.extent.height;
+        u64 traffic = 0;
+        for (u32 i = 0; i < formats.size(); i++) {
+            if (formats[i] != PixelFormat::Invalid) {
+                const u64 size = area * vk::blockSize(instance.GetTraits(formats[i]).native);
+                traffic += cleared[i] ? size : 2 * size;
+            }
+        }
+        Common::Tracing::IncrementCounter(Common::Tracing::Counter::AttachmentTraffic, traffic);
+    }
+
+    BeginRendering(new_pass, timed_pass);
     images = framebuffer->Images();
     aspects = framebuffer->Aspects();
-    BeginRendering(new_pass);
+
+    // Later draws to the framebuffer continue the pass that folded the clears
+    pass.render_pass = framebuffer->RenderPass();
+    pass.clear = {};
+    pass.clear_count = 0;
 }
 
-void RenderManager::BeginRendering(const RenderPass& new_pass) {
+void RenderManager::BeginRendering(const RenderPass& new_pass,
+                                   std::optional<Core::PerfStats::GpuPass> timed_pass) {
     if (pass == new_pass) [[likely]] {
         num_draws++;
         return;
     }
 
     EndRendering();
-    scheduler.Record([info = new_pass](vk::CommandBuffer cmdbuf) {
+    Common::Tracing::IncrementCounter(Common::Tracing::Counter::RenderPass);
+    // The timestamps stay outside of the render pass, which may be recorded to a secondary
+    if (timed_pass) {
+        scheduler.BeginPassTiming(*timed_pass);
+        pass_timed = true;
+    }
+    const bool use_secondary = scheduler.UsesSecondaryCommandBuffers();
+    scheduler.Record([info = new_pass, use_secondary](vk::CommandBuffer cmdbuf) {
         const vk::RenderPassBeginInfo renderpass_begin_info = {
             .renderPass = info.render_pass,
             .framebuffer = info.framebuffer,
             .renderArea = info.render_area,
-            .clearValueCount = info.do_clear ? 1u : 0u,
-            .pClearValues = &info.clear,
+            .clearValueCount = info.clear_count,
+            .pClearValues = info.clear.data(),
         };
-        cmdbuf.beginRenderPass(renderpass_begin_info, vk::SubpassContents::eInline);
+        cmdbuf.beginRenderPass(renderpass_begin_info,
+                               use_secondary ? vk::SubpassContents::eSecondaryCommandBuffers
+                                             : vk::SubpassContents::eInline);
     });
+    if (use_secondary) {
+        scheduler.BeginSecondaryRecording(new_pass.render_pass, new_pass.framebuffer);
+    }
 
     pass = new_pass;
 }
 
 void RenderManager::EndRendering() {
+    if (!deferred_clears.empty()) {
+        FlushClears();
+    }
     if (!pass.render_pass) {
         return;
     }
 
-    scheduler.Record([images = images, aspects = aspects](vk::CommandBuffer cmdbuf) {
-        u32 num_barriers = 0;
-        vk::PipelineStageFlags pipeline_flags{};
-        std::array<vk::ImageMemoryBarrier, 2> barriers;
-        for (u32 i = 0; i < images.size(); i++) {
-            if (!images[i]) {
-                continue;
-            }
-            const bool is_color = static_cast<bool>(aspects[i] & vk::ImageAspectFlagBits::eColor);
-            if (is_color) {
-                pipeline_flags |= vk::PipelineStageFlagBits::eColorAttachmentOutput;
-            } else {
-                pipeline_flags |= vk::PipelineStageFlagBits::eEarlyFragmentTests |
-                                  vk::PipelineStageFlagBits::eLateFragmentTests;
-            }
-            barriers[num_barriers++] = vk::ImageMemoryBarrier{
-                .srcAccessMask = is_color ? vk::AccessFlagBits::eColorAttachmentWrite
-                                          : vk::AccessFlagBits::eDepthStencilAttachmentWrite,
-                .dstAccessMask =
-                    vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead,
-                .oldLayout = vk::ImageLayout::eGeneral,
-                .newLayout = vk::ImageLayout::eGeneral,
-                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image = images[i],
-                .subresourceRange{
-                    .aspectMask = aspects[i],
-                    .baseMipLevel = 0,
-                    .levelCount = 1,
-                    .baseArrayLayer = 0,
-                    .layerCount = VK_REMAINING_ARRAY_LAYERS,
-                },
-            };
+    scheduler.EndSecondaryRecording();
+    u32 num_barriers = 0;
+    vk::PipelineStageFlags pipeline_flags{};
+    std::array<vk::ImageMemoryBarrier, 2> barriers;
+    for (u32 i = 0; i < images.size(); i++) {
+        if (!images[i]) {
+            continue;
         }
-        cmdbuf.endRenderPass();
-        if (num_barriers == 0) {
-            return;
+        const bool is_color = static_cast<bool>(aspects[i] & vk::ImageAspectFlagBits::eColor);
+        if (is_color) {
+            pipeline_flags |= vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        } else {
+            pipeline_flags |= vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                              vk::PipelineStageFlagBits::eLateFragmentTests;
         }
-        cmdbuf.pipelineBarrier(pipeline_flags,
-                               vk::PipelineStageFlagBits::eFragmentShader |
-                                   vk::PipelineStageFlagBits::eTransfer,
-                               vk::DependencyFlagBits::eByRegion, 0, nullptr, 0, nullptr,
-                               num_barriers, barriers.data());
-    });
+        barriers[num_barriers++] = vk::ImageMemoryBarrier{
+            .srcAccessMask = is_color ? vk::AccessFlagBits::eColorAttachmentWrite
+                                      : vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead,
+            .oldLayout = vk::ImageLayout::eGeneral,
+            .newLayout = vk::ImageLayout::eGeneral,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = images[i],
+            .subresourceRange{
+                .aspectMask = aspects[i],
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS,
+            },
+        };
+    }
+    scheduler.Record([](vk::CommandBuffer cmdbuf) { cmdbuf.endRenderPass(); });
+    if (num_barriers != 0) {
+        scheduler.RecordPipelineBarrier(pipeline_flags,
+                                        vk::PipelineStageFlagBits::eFragmentShader |
+                                            vk::PipelineStageFlagBits::eTransfer,
+                                        vk::DependencyFlagBits::eByRegion, {}, {},
+                                        std::span{barriers.data(), num_barriers});
+    }
+
+    if (pass_timed) {
+        scheduler.EndPassTiming();
+        pass_timed = false;
+    }
 
     // Reset state.
     pass.render_pass = VK_NULL_HANDLE;
@@ -129,8 +230,97 @@ void RenderManager::EndRendering() {
     }
 }
 
+void RenderManager::DeferClear(const DeferredClear& clear) {
+    ASSERT(!pass.render_pass);
+    // A later clear of the same image overrides the earlier one
+    std::erase_if(deferred_clears, [&](const DeferredClear& other) {
+        return other.image == clear.image && other.level == clear.level;
+    });
+    deferred_clears.push_back(clear);
+}
+
+std::optional<DeferredClear> RenderManager::TakeClear(vk::Image image, vk::Rect2D render_area) {
+    const auto it = std::find_if(deferred_clears.begin(), deferred_clears.end(),
+                                 [&](const DeferredClear& clear) {
+                                     return clear.image == image && clear.level == 0 &&
+                                            render_area.offset == vk::Offset2D{} &&
+                                            render_area.extent == clear.extent;
+                                 });
+    if (it == deferred_clears.end()) {
+        return std::nullopt;
+    }
+    const DeferredClear clear = *it;
+    deferred_clears.erase(it);
+    return clear;
+}
+
+void RenderManager::FlushClears() {
+    scheduler.Record([clears = std::move(deferred_clears)](vk::CommandBuffer cmdbuf) {
+        for (const DeferredClear& clear : clears) {
+            // The image may have become a render target since the clear was deferred
+            const bool is_color = static_cast<bool>(clear.aspect & vk::ImageAspectFlagBits::eColor);
+            const vk::PipelineStageFlags attachment_flags =
+                is_color ? vk::PipelineStageFlagBits::eColorAttachmentOutput
+                         : vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                               vk::PipelineStageFlagBits::eLateFragmentTests;
+            const vk::PipelineStageFlags dst_flags = clear.pipeline_flags | attachment_flags;
+            const vk::AccessFlags dst_access =
+                clear.access | (is_color ? vk::AccessFlagBits::eColorAttachmentRead |
+                                               vk::AccessFlagBits::eColorAttachmentWrite
+                                         : vk::AccessFlagBits::eDepthStencilAttachmentRead |
+                                               vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+
+            const vk::ImageSubresourceRange range = {
+                .aspectMask = clear.aspect,
+                .baseMipLevel = clear.level,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS,
+            };
+
+            const vk::ImageMemoryBarrier pre_barrier = {
+                .srcAccessMask = clear.access,
+                .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .oldLayout = vk::ImageLayout::eGeneral,
+                .newLayout = vk::ImageLayout::eTransferDstOptimal,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = clear.image,
+                .subresourceRange = range,
+            };
+
+            const vk::ImageMemoryBarrier post_barrier = {
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = dst_access,
+                .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                .newLayout = vk::ImageLayout::eGeneral,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = clear.image,
+                .subresourceRange = range,
+            };
+
+            cmdbuf.pipelineBarrier(clear.pipeline_flags, vk::PipelineStageFlagBits::eTransfer,
+                                   vk::DependencyFlagBits::eByRegion, {}, {}, pre_barrier);
+
+            if (is_color) {
+                cmdbuf.clearColorImage(clear.image, vk::ImageLayout::eTransferDstOptimal,
+                                       clear.value.color, range);
+            } else {
+                cmdbuf.clearDepthStencilImage(clear.image, vk::ImageLayout::eTransferDstOptimal,
+                                              clear.value.depthStencil, range);
+            }
+
+            cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, dst_flags,
+                                   vk::DependencyFlagBits::eByRegion, {}, {}, post_barrier);
+        }
+    });
+    deferred_clears.clear();
+}
+
 vk::RenderPass RenderManager::GetRenderpass(VideoCore::PixelFormat color,
-                                            VideoCore::PixelFormat depth, bool is_clear) {
+                                            VideoCore::PixelFormat depth, bool clear_color,
+                                            bool clear_depth) {
     std::scoped_lock lock{cache_mutex};
 
     const u32 color_index =
@@ -141,20 +331,24 @@ vk::RenderPass RenderManager::GetRenderpass(VideoCore::PixelFormat color,
     ASSERT_MSG(color_index <= NumColorFormats && depth_index <= NumDepthFormats,
                "Invalid color index {} and/or depth_index {}", color_index, depth_index);
 
-    vk::UniqueRenderPass& renderpass = cached_renderpasses[color_index][depth_index][is_clear];
+    vk::UniqueRenderPass& renderpass =
+        cached_renderpasses[color_index][depth_index][clear_color][clear_depth];
     if (!renderpass) {
         const vk::Format color_format = instance.GetTraits(color).native;
         const vk::Format depth_format = instance.GetTraits(depth).native;
-        const vk::AttachmentLoadOp load_op =
-            is_clear ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad;
-        renderpass = CreateRenderPass(color_format, depth_format, load_op);
+        const auto load_op = [](bool clear) {
+            return clear ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad;
+        };
+        renderpass = CreateRenderPass(color_format, depth_format, load_op(clear_color),
+                                      load_op(clear_depth));
     }
 
     return *renderpass;
 }
 
 vk::UniqueRenderPass RenderManager::CreateRenderPass(vk::Format color, vk::Format depth,
-                                                     vk::AttachmentLoadOp load_op) const {
+                                                     vk::AttachmentLoadOp color_load_op,
+                                                     vk::AttachmentLoadOp depth_load_op) const {
     u32 attachment_count = 0;
     std::array<vk::AttachmentDescription, 2> attachments;
 
@@ -166,7 +360,7 @@ vk::UniqueRenderPass RenderManager::CreateRenderPass(vk::Format color, vk::Forma
     if (color != vk::Format::eUndefined) {
         attachments[attachment_count] = vk::AttachmentDescription{
             .format = color,
-            .loadOp = load_op,
+            .loadOp = color_load_op,
             .storeOp = vk::AttachmentStoreOp::eStore,
             .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
             .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
@@ -183,12 +377,16 @@ vk::UniqueRenderPass RenderManager::CreateRenderPass(vk::Format color, vk::Forma
     }
 
     if (depth != vk::Format::eUndefined) {
+        // Depth only formats have no stencil contents to load or store
+        const bool has_stencil =
+            depth == vk::Format::eD24UnormS8Uint || depth == vk::Format::eD32SfloatS8Uint;
         attachments[attachment_count] = vk::AttachmentDescription{
             .format = depth,
-            .loadOp = load_op,
+            .loadOp = depth_load_op,
             .storeOp = vk::AttachmentStoreOp::eStore,
-            .stencilLoadOp = load_op,
-            .stencilStoreOp = vk::AttachmentStoreOp::eStore,
+            .stencilLoadOp = has_stencil ? depth_load_op : vk::AttachmentLoadOp::eDontCare,
+            .stencilStoreOp =
+                has_stencil ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare,
             .initialLayout = vk::ImageLayout::eGeneral,
             .finalLayout = vk::ImageLayout::eGeneral,
         };
@@ -5,8 +5,11 @@
 #pragma once
 
 #include <mutex>
+#include <optional>
+#include <vector>
 
 #include "common/math_util.h"
+#include "core/perf_stats.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
 namespace VideoCore {
@@ -23,17 +26,28 @@ struct RenderPass {
     vk::Framebuffer framebuffer;
     vk::RenderPass render_pass;
     vk::Rect2D render_area;
-    vk::ClearValue clear;
-    u32 do_clear;
+    std::array<vk::ClearValue, 2> clear;
+    u32 clear_count;
 
     bool operator==(const RenderPass& other) const noexcept {
-        return std::tie(framebuffer, render_pass, render_area, do_clear) ==
+        return std::tie(framebuffer, render_pass, render_area, clear_count) ==
                    std::tie(other.framebuffer, other.render_pass, other.render_area,
-                            other.do_clear) &&
-               std::memcmp(&clear, &other.clear, sizeof(vk::ClearValue)) == 0;
+                            other.clear_count) &&
+               std::memcmp(clear.data(), other.clear.data(), sizeof(clear)) == 0;
     }
 };
 
+/// Clear of a whole level of an image that is recorded lazily
+struct DeferredClear {
+    vk::Image image;
+    vk::ImageAspectFlags aspect;
+    vk::PipelineStageFlags pipeline_flags;
+    vk::AccessFlags access;
+    vk::ClearValue value;
+    vk::Extent2D extent;
+    u32 level;
+};
+
 class RenderManager {
     static constexpr u32 NumColorFormats = 13;
     static constexpr u32 NumDepthFormats = 4;
@@ -42,33 +56,57 @@ public:
     explicit RenderManager(const Instance& instance, Scheduler& scheduler);
     ~RenderManager();
 
-    /// Begins a new renderpass with the provided framebuffer as render target.
-    void BeginRendering(const Framebuffer* framebuffer, Common::Rectangle<u32> draw_rect);
+    /// Begins a new renderpass with the provided framebuffer as render target, timed as the pass.
+    void BeginRendering(const Framebuffer* framebuffer, Common::Rectangle<u32> draw_rect,
+                        Core::PerfStats::GpuPass timed_pass = Core::PerfStats::GpuPass::Scene);
 
     /// Begins a new renderpass with the provided render state.
-    void BeginRendering(const RenderPass& new_pass);
+    void BeginRendering(const RenderPass& new_pass,
+                        std::optional<Core::PerfStats::GpuPass> timed_pass = std::nullopt);
 
-    /// Exits from any currently active renderpass instance
+    /// Exits from any currently active renderpass instance and records the deferred clears
     void EndRendering();
 
+    /**
+     * Defers the clear until the next render pass drawing to the whole level, where it becomes the
+     * load op of the attachment and saves tilers a round trip of the image through memory. The
+     * clear is recorded as a transfer instead once anything else may access the image.
+     */
+    void DeferClear(const DeferredClear& clear);
+
     /// Returns the renderpass associated with the color-depth format pair
     vk::RenderPass GetRenderpass(VideoCore::PixelFormat color, VideoCore::PixelFormat depth,
-                                 bool is_clear);
+                                 bool is_clear) {
+        return GetRenderpass(color, depth, is_clear, is_clear);
+    }
+
+    /// Returns the renderpass associated with the color-depth format pair clearing the attachments
+    vk::RenderPass GetRenderpass(VideoCore::PixelFormat color, VideoCore::PixelFormat depth,
+                                 bool clear_color, bool clear_depth);
 
 private:
     /// Creates a renderpass configured appropriately and stores it in cached_renderpasses
     vk::UniqueRenderPass CreateRenderPass(vk::Format color, vk::Format depth,
-                                          vk::AttachmentLoadOp load_op) const;
+                                          vk::AttachmentLoadOp color_load_op,
+                                          vk::AttachmentLoadOp depth_load_op) const;
+
+    /// Removes the deferred clear of the whole image from the list, if any
+    std::optional<DeferredClear> TakeClear(vk::Image image, vk::Rect2D render_area);
+
+    /// Records the deferred clears as transfers
+    void FlushClears();
 
 private:
     const Instance& instance;
     Scheduler& scheduler;
-    vk::UniqueRenderPass cached_renderpasses[NumColorFormats + 1][NumDepthFormats + 1][2];
+    vk::UniqueRenderPass cached_renderpasses[NumColorFormats + 1][NumDepthFormats + 1][2][2];
     std::mutex cache_mutex;
     std::array<vk::Image, 2> images;
     std::array<vk::ImageAspectFlags, 2> aspects;
+    std::vector<DeferredClear> deferred_clears;
     RenderPass pass{};
     u32 num_draws{};
+    bool pass_timed{};
 };
 
 } // namespace Vulkan
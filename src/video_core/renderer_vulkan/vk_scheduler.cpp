@@ -2,20 +2,45 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
 #include <mutex>
 #include <utility>
+#include "common/assert.h"
+#include "common/cpu_affinity.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "common/thread.h"
+#include "common/tracing.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 
 MICROPROFILE_DEFINE(Vulkan_WaitForWorker, "Vulkan", "Wait for worker", MP_RGB(255, 192, 192));
 MICROPROFILE_DEFINE(Vulkan_Submit, "Vulkan", "Submit Exectution", MP_RGB(255, 192, 255));
+MICROPROFILE_DEFINE(Vulkan_RecordSecondary, "Vulkan", "Record Secondary", MP_RGB(192, 255, 192));
+MICROPROFILE_DEFINE(Vulkan_WaitForRecorder, "Vulkan", "Wait for recorder", MP_RGB(255, 255, 192));
 
 namespace Vulkan {
 
 namespace {
 
+constexpr std::array<Common::Tracing::Scope, Core::PerfStats::GpuPassCount> GpuPassScopes = {{
+    {"Host GPU", "Scene"},
+    {"Host GPU", "Shadow"},
+    {"Host GPU", "Blit"},
+    {"Host GPU", "Texture filter"},
+    {"Host GPU", "Present"},
+}};
+
+/// Returns the clock used by the trace export
+u64 SteadyNowNs() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+}
+
 std::unique_ptr<MasterSemaphore> MakeMasterSemaphore(const Instance& instance) {
     if (instance.IsTimelineSemaphoreSupported()) {
         return std::make_unique<MasterSemaphoreTimeline>(instance);
@@ -26,27 +51,145 @@ std::unique_ptr<MasterSemaphore> MakeMasterSemaphore(const Instance& instance) {
 
 } // Anonymous namespace
 
+Scheduler::CommandChunk::CommandChunk() {
+    NextBlock();
+}
+
+Scheduler::CommandChunk::~CommandChunk() = default;
+
+void Scheduler::CommandChunk::NextBlock() {
+    if (cursor) {
+        Block& block = blocks[current_block++];
+        block.used = static_cast<std::size_t>(cursor - block.data.get());
+    }
+    if (current_block == blocks.size()) {
+        blocks.push_back({std::make_unique_for_overwrite<u8[]>(BlockSize), 0});
+    }
+    cursor = blocks[current_block].data.get();
+    block_end = cursor + BlockSize;
+}
+
 void Scheduler::CommandChunk::ExecuteAll(vk::CommandBuffer cmdbuf) {
-    auto command = first;
-    while (command != nullptr) {
-        auto next = command->GetNext();
-        command->Execute(cmdbuf);
-        command->~Command();
-        command = next;
+    static_assert(sizeof(CommandHeader) % CommandAlignment == 0);
+    static_assert(sizeof(BindVertexBuffersCommand) % CommandAlignment == 0);
+    static_assert(sizeof(PushConstantsCommand) % CommandAlignment == 0);
+    static_assert(sizeof(PipelineBarrierCommand) % CommandAlignment == 0);
+
+    Block& last_block = blocks[current_block];
+    last_block.used = static_cast<std::size_t>(cursor - last_block.data.get());
+    for (std::size_t i = 0; i <= current_block; i++) {
+        const u8* entry = blocks[i].data.get();
+        const u8* const end = entry + blocks[i].used;
+        while (entry != end) {
+            const auto& header = *reinterpret_cast<const CommandHeader*>(entry);
+            const u8* const payload = entry + sizeof(CommandHeader);
+            switch (header.opcode) {
+            case Opcode::Lambda: {
+                const auto& command = *reinterpret_cast<const LambdaCommand*>(payload);
+                command.execute(command.object, cmdbuf);
+                break;
+            }
+            case Opcode::Draw: {
+                const auto& command = *reinterpret_cast<const DrawCommand*>(payload);
+                cmdbuf.draw(command.vertex_count, command.instance_count, command.first_vertex,
+                            command.first_instance);
+                break;
+            }
+            case Opcode::DrawIndexed: {
+                const auto& command = *reinterpret_cast<const DrawIndexedCommand*>(payload);
+                cmdbuf.drawIndexed(command.index_count, command.instance_count,
+                                   command.first_index, command.vertex_offset,
+                                   command.first_instance);
+                break;
+            }
+            case Opcode::BindPipeline: {
+                const auto& command = *reinterpret_cast<const BindPipelineCommand*>(payload);
+                cmdbuf.bindPipeline(command.bind_point, command.pipeline);
+                break;
+            }
+            case Opcode::BindVertexBuffers: {
+                const auto& command = *reinterpret_cast<const BindVertexBuffersCommand*>(payload);
+                const auto* const buffers = reinterpret_cast<const vk::Buffer*>(&command + 1);
+                const auto* const offsets =
+                    reinterpret_cast<const vk::DeviceSize*>(buffers + command.count);
+                cmdbuf.bindVertexBuffers(command.first_binding, command.count, buffers, offsets);
+                break;
+            }
+            case Opcode::BindIndexBuffer: {
+                const auto& command = *reinterpret_cast<const BindIndexBufferCommand*>(payload);
+                cmdbuf.bindIndexBuffer(command.buffer, command.offset, command.index_type);
+                break;
+            }
+            case Opcode::PushConstants: {
+                const auto& command = *reinterpret_cast<const PushConstantsCommand*>(payload);
+                cmdbuf.pushConstants(command.layout, command.stages, command.offset, command.size,
+                                     &command + 1);
+                break;
+            }
+            case Opcode::PipelineBarrier: {
+                const auto& command = *reinterpret_cast<const PipelineBarrierCommand*>(payload);
+                const auto* const memory_barriers =
+                    reinterpret_cast<const vk::MemoryBarrier*>(&command + 1);
+                const auto* const buffer_barriers =
+                    reinterpret_cast<const vk::BufferMemoryBarrier*>(memory_barriers +
+                                                                     command.num_memory_barriers);
+                const auto* const image_barriers =
+                    reinterpret_cast<const vk::ImageMemoryBarrier*>(buffer_barriers +
+                                                                    command.num_buffer_barriers);
+                cmdbuf.pipelineBarrier(command.src_stages, command.dst_stages,
+                                       command.dependency_flags, command.num_memory_barriers,
+                                       memory_barriers, command.num_buffer_barriers,
+                                       buffer_barriers, command.num_image_barriers,
+                                       image_barriers);
+                break;
+            }
+            }
+            entry += header.size;
+        }
     }
+
     submit = false;
-    command_offset = 0;
-    first = nullptr;
-    last = nullptr;
+    ends_render_pass = false;
+    current_block = 0;
+    cursor = blocks[0].data.get();
+    block_end = cursor + BlockSize;
+    recorded_counts = 0;
+    recorded_lambdas = 0;
+    recorded_bytes = 0;
 }
 
 Scheduler::Scheduler(const Instance& instance)
     : master_semaphore{MakeMasterSemaphore(instance)},
-      command_pool{instance, master_semaphore.get()}, use_worker_thread{true} {
+      command_pool{instance, master_semaphore.get()}, use_worker_thread{true},
+      device{instance.GetDevice()} {
     AllocateWorkerCommandBuffers();
+    if (instance.IsTimestampSupported()) {
+        timestamp_pool = device.createQueryPoolUnique({
+            .queryType = vk::QueryType::eTimestamp,
+            .queryCount = MaxTimedSubmits * QueriesPerSubmit,
+        });
+        timestamp_period = instance.GetTimestampPeriod();
+    }
+    if (use_worker_thread && Settings::values.parallel_command_recording.GetValue()) {
+        // Each recorder thread owns a command pool, as pools cannot be used concurrently.
+        const std::size_t num_recorders =
+            std::clamp(std::thread::hardware_concurrency() / 2, 1U, 4U);
+        recorders = std::make_unique<Common::StatefulThreadWorker<std::unique_ptr<CommandPool>>>(
+            num_recorders, "VulkanRecorder", [this, &instance](std::size_t) {
+                return std::make_unique<CommandPool>(instance, master_semaphore.get(),
+                                                     vk::CommandBufferLevel::eSecondary);
+            });
+    }
+    if (use_worker_thread && instance.HasAsyncCompute()) {
+        // Compute command buffers are recycled with the graphics ticks, as every compute
+        // submission completes before the graphics submission that follows it.
+        compute_pool = std::make_unique<CommandPool>(instance, master_semaphore.get());
+        compute_chunk = TakeChunk();
+    }
     if (use_worker_thread) {
         AcquireNewChunk();
         worker_thread = std::jthread([this](std::stop_token token) { WorkerThread(token); });
+        BeginSubmitTiming();
     }
 }
 
@@ -95,8 +238,12 @@ void Scheduler::DispatchWork() {
     if (!use_worker_thread || chunk->Empty()) {
         return;
     }
+    QueueChunk();
+}
 
+void Scheduler::QueueChunk() {
     on_dispatch();
+    ReportRecorded(*chunk);
 
     {
         std::scoped_lock ql{queue_mutex};
@@ -107,8 +254,66 @@ void Scheduler::DispatchWork() {
     AcquireNewChunk();
 }
 
+void Scheduler::FlushCompute() {
+    compute_pending = false;
+    ReportRecorded(*compute_chunk);
+    {
+        std::scoped_lock lock{compute_mutex};
+        compute_work.push(std::move(compute_chunk));
+    }
+    compute_chunk = TakeChunk();
+    Record([this](vk::CommandBuffer) { SubmitCompute(); });
+}
+
+void Scheduler::SubmitCompute() {
+    std::unique_ptr<CommandChunk> work;
+    {
+        std::scoped_lock lock{compute_mutex};
+        work = std::move(compute_work.front());
+        compute_work.pop();
+    }
+
+    const vk::CommandBuffer cmdbuf = compute_pool->Commit();
+    cmdbuf.begin({.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    work->ExecuteAll(cmdbuf);
+    {
+        MICROPROFILE_SCOPE(Vulkan_Submit);
+        std::scoped_lock lock{submit_mutex};
+        master_semaphore->SubmitCompute(cmdbuf);
+    }
+
+    std::scoped_lock rl{reserve_mutex};
+    chunk_reserve.emplace_back(std::move(work));
+}
+
+void Scheduler::BeginSecondaryRecording(vk::RenderPass render_pass, vk::Framebuffer framebuffer) {
+    ASSERT(recorders && !secondary_render_pass);
+
+    // The render pass begin command stays in the primary command buffer.
+    DispatchWork();
+    secondary_render_pass = render_pass;
+    secondary_framebuffer = framebuffer;
+    chunk->SetRenderPass(render_pass, framebuffer);
+
+    // Secondary command buffers do not inherit any bound state.
+    state = StateFlags::AllDirty;
+}
+
+void Scheduler::EndSecondaryRecording() {
+    if (!secondary_render_pass) {
+        return;
+    }
+
+    // The chunk is queued even when empty, it closes the render pass for the worker thread.
+    chunk->MarkEndsRenderPass();
+    secondary_render_pass = VK_NULL_HANDLE;
+    secondary_framebuffer = VK_NULL_HANDLE;
+    QueueChunk();
+}
+
 void Scheduler::WorkerThread(std::stop_token stop_token) {
     Common::SetCurrentThreadName("VulkanWorker");
+    Common::SetCurrentThreadCoreClass(Common::CoreClass::Performance);
 
     const auto TryPopQueue{[this](auto& work) -> bool {
         if (work_queue.empty()) {
@@ -135,6 +340,8 @@ void Scheduler::WorkerThread(std::stop_token stop_token) {
                 return;
             }
 
+            const bool queue_empty = work_queue.empty();
+
             // Exchange lock ownership so that we take the execution lock before
             // the queue lock goes out of scope. This allows us to force execution
             // to complete in the next step.
@@ -143,7 +350,28 @@ void Scheduler::WorkerThread(std::stop_token stop_token) {
             // Perform the work, tracking whether the chunk was a submission
             // before executing.
             const bool has_submit = work->HasSubmit();
-            work->ExecuteAll(current_cmdbuf);
+            if (recorders) {
+                // Render passes are handed to the recorder threads as soon as they are closed,
+                // the results are stitched in order once the worker catches up or submits.
+                if (work->IsSecondary()) {
+                    if (!open_secondary) {
+                        open_secondary = std::make_unique<SecondaryRecording>();
+                    }
+                    const bool ends_render_pass = work->EndsRenderPass();
+                    open_secondary->chunks.push_back(std::move(work));
+                    if (ends_render_pass) {
+                        RecordSecondary(*open_secondary);
+                        pending_work.push_back({nullptr, std::move(open_secondary)});
+                    }
+                } else {
+                    pending_work.push_back({std::move(work), nullptr});
+                }
+                if (has_submit || (queue_empty && !open_secondary)) {
+                    StitchPending();
+                }
+            } else {
+                work->ExecuteAll(current_cmdbuf);
+            }
 
             // If the chunk was a submission, reallocate the command buffer.
             if (has_submit) {
@@ -151,6 +379,10 @@ void Scheduler::WorkerThread(std::stop_token stop_token) {
             }
         }
 
+        if (!work) {
+            continue;
+        }
+
         {
             std::scoped_lock rl{reserve_mutex};
 
@@ -160,6 +392,57 @@ void Scheduler::WorkerThread(std::stop_token stop_token) {
     }
 }
 
+void Scheduler::RecordSecondary(SecondaryRecording& secondary) {
+    recorders->QueueWork([&secondary](std::unique_ptr<CommandPool>* pool) {
+        MICROPROFILE_SCOPE(Vulkan_RecordSecondary);
+        const CommandChunk& first_chunk = *secondary.chunks.front();
+        const vk::CommandBufferInheritanceInfo inheritance_info = {
+            .renderPass = first_chunk.RenderPass(),
+            .subpass = 0,
+            .framebuffer = first_chunk.Framebuffer(),
+        };
+        const vk::CommandBufferBeginInfo begin_info = {
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                     vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+            .pInheritanceInfo = &inheritance_info,
+        };
+
+        secondary.cmdbuf = (*pool)->Commit();
+        secondary.cmdbuf.begin(begin_info);
+        for (const auto& secondary_chunk : secondary.chunks) {
+            secondary_chunk->ExecuteAll(secondary.cmdbuf);
+        }
+        secondary.cmdbuf.end();
+
+        secondary.recorded = true;
+        secondary.recorded.notify_one();
+    });
+}
+
+void Scheduler::StitchPending() {
+    std::vector<std::unique_ptr<CommandChunk>> finished;
+    for (PendingWork& work : pending_work) {
+        if (work.chunk) {
+            work.chunk->ExecuteAll(current_cmdbuf);
+            finished.push_back(std::move(work.chunk));
+            continue;
+        }
+
+        SecondaryRecording& secondary = *work.secondary;
+        {
+            MICROPROFILE_SCOPE(Vulkan_WaitForRecorder);
+            secondary.recorded.wait(false);
+        }
+        current_cmdbuf.executeCommands(secondary.cmdbuf);
+        std::move(secondary.chunks.begin(), secondary.chunks.end(), std::back_inserter(finished));
+    }
+    pending_work.clear();
+
+    // Recycle the chunks back to the reserve.
+    std::scoped_lock rl{reserve_mutex};
+    std::move(finished.begin(), finished.end(), std::back_inserter(chunk_reserve));
+}
+
 void Scheduler::AllocateWorkerCommandBuffers() {
     const vk::CommandBufferBeginInfo begin_info = {
         .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
@@ -174,10 +457,15 @@ void Scheduler::SubmitExecution(vk::Semaphore signal_semaphore, vk::Semaphore wa
     const u64 signal_value = master_semaphore->NextTick();
 
     on_submit();
+    std::atomic<u64>* const submit_time = EndSubmitTiming(signal_value);
 
-    Record([signal_semaphore, wait_semaphore, signal_value, this](vk::CommandBuffer cmdbuf) {
+    Record([signal_semaphore, wait_semaphore, signal_value, submit_time,
+            this](vk::CommandBuffer cmdbuf) {
         MICROPROFILE_SCOPE(Vulkan_Submit);
         std::scoped_lock lock{submit_mutex};
+        if (submit_time) {
+            submit_time->store(SteadyNowNs(), std::memory_order_relaxed);
+        }
         master_semaphore->SubmitWork(cmdbuf, wait_semaphore, signal_semaphore, signal_value);
     });
 
@@ -188,18 +476,161 @@ void Scheduler::SubmitExecution(vk::Semaphore signal_semaphore, vk::Semaphore wa
     } else {
         chunk->MarkSubmit();
         DispatchWork();
+        BeginSubmitTiming();
+    }
+}
+
+std::optional<Core::PerfStats::GpuTimes> Scheduler::EndFrameTiming() {
+    timing_frame++;
+
+    // Submissions complete in order, a frame is known once a later frame has started completing
+    std::optional<Core::PerfStats::GpuTimes> frame_times;
+    while (!timed_submits.empty() && IsFree(timed_submits.front().tick)) {
+        const TimedSubmit& submit = timed_submits.front();
+        if (submit.frame != measured_frame) {
+            if (measured_busy != 0) {
+                frame_times.emplace();
+                frame_times->busy = TicksToDuration(measured_busy);
+                for (std::size_t i = 0; i < measured_passes.size(); i++) {
+                    frame_times->passes[i] = TicksToDuration(measured_passes[i]);
+                }
+            }
+            measured_frame = submit.frame;
+            measured_busy = 0;
+            measured_passes = {};
+            trace_offset = std::numeric_limits<s64>::min();
+        }
+        ReadSubmitTiming(submit);
+        timed_submits.pop_front();
+    }
+    return frame_times;
+}
+
+void Scheduler::BeginPassTiming(Core::PerfStats::GpuPass pass) {
+    EndPassTiming();
+    if (!current_submit || current_submit->num_passes == MaxTimedPasses) {
+        return;
+    }
+    const u32 query =
+        current_submit->block * QueriesPerSubmit + 2 + current_submit->num_passes * 2;
+    current_submit->passes[current_submit->num_passes++] = pass;
+    pass_open = true;
+    Record([pool = *timestamp_pool, query](vk::CommandBuffer cmdbuf) {
+        cmdbuf.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, pool, query);
+    });
+}
+
+void Scheduler::EndPassTiming() {
+    if (!pass_open) {
+        return;
+    }
+    pass_open = false;
+    const u32 query = current_submit->block * QueriesPerSubmit + current_submit->num_passes * 2 + 1;
+    Record([pool = *timestamp_pool, query](vk::CommandBuffer cmdbuf) {
+        cmdbuf.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, pool, query);
+    });
+}
+
+void Scheduler::BeginSubmitTiming() {
+    // Blocks are handed out in order, so the blocks of pending submissions never overlap
+    if (!timestamp_pool || timed_submits.size() >= MaxTimedSubmits) {
+        current_submit.reset();
+        return;
+    }
+    const u32 block = next_block;
+    next_block = (next_block + 1) % MaxTimedSubmits;
+    current_submit = TimedSubmit{.block = block};
+    Record([pool = *timestamp_pool, query = block * QueriesPerSubmit](vk::CommandBuffer cmdbuf) {
+        cmdbuf.resetQueryPool(pool, query, QueriesPerSubmit);
+        cmdbuf.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, pool, query);
+    });
+}
+
+std::atomic<u64>* Scheduler::EndSubmitTiming(u64 signal_value) {
+    if (!current_submit) {
+        return nullptr;
+    }
+    EndPassTiming();
+    const u32 block = current_submit->block;
+    const u32 query = block * QueriesPerSubmit + 1;
+    Record([pool = *timestamp_pool, query](vk::CommandBuffer cmdbuf) {
+        cmdbuf.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, pool, query);
+    });
+    current_submit->tick = signal_value;
+    current_submit->frame = timing_frame;
+    timed_submits.push_back(*current_submit);
+    current_submit.reset();
+    return &submit_times[block];
+}
+
+void Scheduler::ReadSubmitTiming(const TimedSubmit& submit) {
+    const u32 num_queries = 2 + submit.num_passes * 2;
+    std::array<u64, QueriesPerSubmit> timestamps;
+    const vk::Result result = device.getQueryPoolResults(
+        *timestamp_pool, submit.block * QueriesPerSubmit, num_queries, num_queries * sizeof(u64),
+        timestamps.data(), sizeof(u64), vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess) {
+        return;
+    }
+    const auto elapsed = [&timestamps](u32 query) -> u64 {
+        return timestamps[query + 1] > timestamps[query] ? timestamps[query + 1] - timestamps[query]
+                                                         : 0;
+    };
+    measured_busy += elapsed(0);
+    for (u32 i = 0; i < submit.num_passes; i++) {
+        measured_passes[static_cast<std::size_t>(submit.passes[i])] += elapsed(2 + i * 2);
+    }
+
+    if (!Common::Tracing::IsEnabled()) {
+        return;
     }
+    // Timestamps have no defined relation to the CPU clock. As the GPU can not start a submission
+    // before it was submitted, the submission times bound the offset between the clocks.
+    const auto to_ns = [this](u64 ticks) {
+        return static_cast<s64>(static_cast<double>(ticks) * timestamp_period);
+    };
+    const s64 submit_ns =
+        static_cast<s64>(submit_times[submit.block].load(std::memory_order_relaxed));
+    trace_offset = std::max(trace_offset, submit_ns - to_ns(timestamps[0]));
+    for (u32 i = 0; i < submit.num_passes; i++) {
+        const u32 query = 2 + i * 2;
+        const u64 duration = elapsed(query);
+        if (duration == 0) {
+            continue;
+        }
+        const u64 begin_ns = static_cast<u64>(to_ns(timestamps[query]) + trace_offset);
+        Common::Tracing::RecordGpuEvent(GpuPassScopes[static_cast<std::size_t>(submit.passes[i])],
+                                        begin_ns, begin_ns + static_cast<u64>(to_ns(duration)));
+    }
+}
+
+Core::PerfStats::Clock::duration Scheduler::TicksToDuration(u64 ticks) const {
+    return std::chrono::duration_cast<Core::PerfStats::Clock::duration>(
+        std::chrono::duration<double, std::nano>{static_cast<double>(ticks) * timestamp_period});
+}
+
+void Scheduler::ReportRecorded(const CommandChunk& recorded) {
+    using Common::Tracing::Counter;
+    Common::Tracing::IncrementCounter(Counter::RecordedCommand, recorded.NumCommands());
+    Common::Tracing::IncrementCounter(Counter::RecordedLambda, recorded.NumLambdas());
+    Common::Tracing::IncrementCounter(Counter::RecordedCommandBytes, recorded.Size());
 }
 
 void Scheduler::AcquireNewChunk() {
+    chunk = TakeChunk();
+
+    // Chunks recorded while a render pass is open belong to its secondary command buffer.
+    chunk->SetRenderPass(secondary_render_pass, secondary_framebuffer);
+}
+
+std::unique_ptr<Scheduler::CommandChunk> Scheduler::TakeChunk() {
     std::scoped_lock lock{reserve_mutex};
     if (chunk_reserve.empty()) {
-        chunk = std::make_unique<CommandChunk>();
-        return;
+        return std::make_unique<CommandChunk>();
     }
-
-    chunk = std::move(chunk_reserve.back());
+    std::unique_ptr<CommandChunk> reserved = std::move(chunk_reserve.back());
     chunk_reserve.pop_back();
+    return reserved;
 }
 
 } // namespace Vulkan
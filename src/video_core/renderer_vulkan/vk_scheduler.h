@@ -4,12 +4,26 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include "common/alignment.h"
+#include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/polyfill_thread.h"
+#include "common/thread_worker.h"
+#include "core/perf_stats.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
 
@@ -47,14 +61,136 @@ public:
     /// Sends currently recorded work to the worker thread.
     void DispatchWork();
 
-    /// Records the command to the current chunk.
+    /// Returns true when render passes are recorded to secondary command buffers.
+    [[nodiscard]] bool UsesSecondaryCommandBuffers() const noexcept {
+        return recorders != nullptr;
+    }
+
+    /// Records the following commands to secondary command buffers executed inside the
+    /// provided render pass, which must have been begun with secondary command buffer contents.
+    void BeginSecondaryRecording(vk::RenderPass render_pass, vk::Framebuffer framebuffer);
+
+    /// Ends the secondary recording, the following commands are recorded to the primary.
+    void EndSecondaryRecording();
+
+    /// Records the command to the current chunk. Commands that have an encoding of their own are
+    /// better recorded with the matching function below, which does not go through a callable.
     template <typename T>
     void Record(T&& command) {
-        if (chunk->Record(command)) {
-            return;
-        }
-        DispatchWork();
-        (void)chunk->Record(command);
+        RecordingChunk().Record(std::move(command));
+    }
+
+    /// Records a non-indexed draw.
+    void RecordDraw(u32 vertex_count, u32 instance_count, u32 first_vertex, u32 first_instance) {
+        RecordingChunk().Emplace(Opcode::Draw, DrawCommand{
+                                                   .vertex_count = vertex_count,
+                                                   .instance_count = instance_count,
+                                                   .first_vertex = first_vertex,
+                                                   .first_instance = first_instance,
+                                               });
+    }
+
+    /// Records an indexed draw.
+    void RecordDrawIndexed(u32 index_count, u32 instance_count, u32 first_index, s32 vertex_offset,
+                           u32 first_instance) {
+        RecordingChunk().Emplace(Opcode::DrawIndexed, DrawIndexedCommand{
+                                                          .index_count = index_count,
+                                                          .instance_count = instance_count,
+                                                          .first_index = first_index,
+                                                          .vertex_offset = vertex_offset,
+                                                          .first_instance = first_instance,
+                                                      });
+    }
+
+    /// Records the binding of a pipeline.
+    void RecordBindPipeline(vk::PipelineBindPoint bind_point, vk::Pipeline pipeline) {
+        RecordingChunk().Emplace(Opcode::BindPipeline, BindPipelineCommand{
+                                                           .bind_point = bind_point,
+                                                           .pipeline = pipeline,
+                                                       });
+    }
+
+    /// Records the binding of vertex buffers, both spans must have the same size.
+    void RecordBindVertexBuffers(u32 first_binding, std::span<const vk::Buffer> buffers,
+                                 std::span<const vk::DeviceSize> offsets) {
+        ASSERT(buffers.size() == offsets.size());
+        const BindVertexBuffersCommand command = {
+            .first_binding = first_binding,
+            .count = static_cast<u32>(buffers.size()),
+        };
+        auto* const recorded = RecordingChunk().Emplace(
+            Opcode::BindVertexBuffers, command, buffers.size_bytes() + offsets.size_bytes());
+        auto* const recorded_buffers = reinterpret_cast<vk::Buffer*>(recorded + 1);
+        auto* const recorded_offsets =
+            reinterpret_cast<vk::DeviceSize*>(recorded_buffers + command.count);
+        std::ranges::copy(buffers, recorded_buffers);
+        std::ranges::copy(offsets, recorded_offsets);
+    }
+
+    /// Records the binding of an index buffer.
+    void RecordBindIndexBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType index_type) {
+        RecordingChunk().Emplace(Opcode::BindIndexBuffer, BindIndexBufferCommand{
+                                                              .buffer = buffer,
+                                                              .offset = offset,
+                                                              .index_type = index_type,
+                                                          });
+    }
+
+    /// Records an update of push constants with the bytes of values.
+    template <typename T>
+    void RecordPushConstants(vk::PipelineLayout layout, vk::ShaderStageFlags stages, u32 offset,
+                             const T& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "Push constants must be trivially copyable");
+        const PushConstantsCommand command = {
+            .layout = layout,
+            .stages = stages,
+            .offset = offset,
+            .size = static_cast<u32>(sizeof(T)),
+        };
+        auto* const recorded = RecordingChunk().Emplace(Opcode::PushConstants, command, sizeof(T));
+        std::memcpy(recorded + 1, &values, sizeof(T));
+    }
+
+    /// Records a pipeline barrier.
+    void RecordPipelineBarrier(vk::PipelineStageFlags src_stages, vk::PipelineStageFlags dst_stages,
+                               vk::DependencyFlags dependency_flags,
+                               std::span<const vk::MemoryBarrier> memory_barriers,
+                               std::span<const vk::BufferMemoryBarrier> buffer_barriers,
+                               std::span<const vk::ImageMemoryBarrier> image_barriers) {
+        const PipelineBarrierCommand command = {
+            .src_stages = src_stages,
+            .dst_stages = dst_stages,
+            .dependency_flags = dependency_flags,
+            .num_memory_barriers = static_cast<u32>(memory_barriers.size()),
+            .num_buffer_barriers = static_cast<u32>(buffer_barriers.size()),
+            .num_image_barriers = static_cast<u32>(image_barriers.size()),
+        };
+        auto* const recorded = RecordingChunk().Emplace(
+            Opcode::PipelineBarrier, command,
+            memory_barriers.size_bytes() + buffer_barriers.size_bytes() +
+                image_barriers.size_bytes());
+        auto* const recorded_memory = reinterpret_cast<vk::MemoryBarrier*>(recorded + 1);
+        auto* const recorded_buffer = reinterpret_cast<vk::BufferMemoryBarrier*>(
+            std::ranges::copy(memory_barriers, recorded_memory).out);
+        auto* const recorded_image = reinterpret_cast<vk::ImageMemoryBarrier*>(
+            std::ranges::copy(buffer_barriers, recorded_buffer).out);
+        std::ranges::copy(image_barriers, recorded_image);
+    }
+
+    /// Returns true when compute work runs on a queue of its own.
+    [[nodiscard]] bool HasAsyncCompute() const noexcept {
+        return compute_pool != nullptr;
+    }
+
+    /**
+     * Records the command to the compute queue. The compute work is submitted before the next
+     * command is recorded, whose transfers wait for it. Must not be called inside a render pass.
+     */
+    template <typename T>
+    void RecordCompute(T&& command) {
+        ASSERT(HasAsyncCompute() && !secondary_render_pass);
+        compute_pending = true;
+        compute_chunk->Record(std::move(command));
     }
 
     /// Marks the provided state as non dirty
@@ -92,6 +228,22 @@ public:
         return master_semaphore->IsFree(tick);
     }
 
+    /**
+     * Times the following commands as a pass of the given type until EndPassTiming, ending the
+     * current pass first. Must not be called inside a render pass.
+     */
+    void BeginPassTiming(Core::PerfStats::GpuPass pass);
+
+    /// Ends the timing of the current pass, if any.
+    void EndPassTiming();
+
+    /**
+     * Ends the GPU timing of the current frame. Returns the GPU times of the latest frame whose
+     * submissions have all completed, if there is a new one since the last call. The passes of
+     * that frame are also recorded to the trace when tracing is enabled.
+     */
+    std::optional<Core::PerfStats::GpuTimes> EndFrameTiming();
+
     /// Returns the master timeline semaphore.
     [[nodiscard]] MasterSemaphore* GetMasterSemaphore() noexcept {
         return master_semaphore.get();
@@ -100,71 +252,167 @@ public:
     std::mutex submit_mutex;
 
 private:
-    class Command {
-    public:
-        virtual ~Command() = default;
+    /// Commands of the compact encoding, replayed by CommandChunk::ExecuteAll.
+    enum class Opcode : u32 {
+        Lambda,
+        Draw,
+        DrawIndexed,
+        BindPipeline,
+        BindVertexBuffers,
+        BindIndexBuffer,
+        PushConstants,
+        PipelineBarrier,
+    };
 
-        virtual void Execute(vk::CommandBuffer cmdbuf) const = 0;
+    /// Precedes every recorded command.
+    struct CommandHeader {
+        Opcode opcode;
+        u32 size; ///< Size of the command including the header, the distance to the next one
+    };
 
-        Command* GetNext() const {
-            return next;
-        }
+    /// A command recorded as a callable, for what has no encoding of its own.
+    struct LambdaCommand {
+        /// Executes the callable, then destroys it
+        void (*execute)(void* object, vk::CommandBuffer cmdbuf);
+        void* object;
+    };
 
-        void SetNext(Command* next_) {
-            next = next_;
-        }
+    struct DrawCommand {
+        u32 vertex_count;
+        u32 instance_count;
+        u32 first_vertex;
+        u32 first_instance;
+    };
 
-    private:
-        Command* next = nullptr;
+    struct DrawIndexedCommand {
+        u32 index_count;
+        u32 instance_count;
+        u32 first_index;
+        s32 vertex_offset;
+        u32 first_instance;
     };
 
-    template <typename T>
-    class TypedCommand final : public Command {
-    public:
-        explicit TypedCommand(T&& command_) : command{std::move(command_)} {}
-        ~TypedCommand() override = default;
+    struct BindPipelineCommand {
+        vk::PipelineBindPoint bind_point;
+        vk::Pipeline pipeline;
+    };
 
-        TypedCommand(TypedCommand&&) = delete;
-        TypedCommand& operator=(TypedCommand&&) = delete;
+    /// Followed by count buffers, then count offsets.
+    struct BindVertexBuffersCommand {
+        u32 first_binding;
+        u32 count;
+    };
 
-        void Execute(vk::CommandBuffer cmdbuf) const override {
-            command(cmdbuf);
-        }
+    struct BindIndexBufferCommand {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+        vk::IndexType index_type;
+    };
 
-    private:
-        T command;
+    /// Followed by size bytes of data.
+    struct PushConstantsCommand {
+        vk::PipelineLayout layout;
+        vk::ShaderStageFlags stages;
+        u32 offset;
+        u32 size;
+    };
+
+    /// Followed by the memory barriers, then the buffer barriers, then the image barriers.
+    struct PipelineBarrierCommand {
+        vk::PipelineStageFlags src_stages;
+        vk::PipelineStageFlags dst_stages;
+        vk::DependencyFlags dependency_flags;
+        u32 num_memory_barriers;
+        u32 num_buffer_barriers;
+        u32 num_image_barriers;
     };
 
+    /**
+     * Commands recorded into an arena of blocks, which grows as needed and keeps its blocks when
+     * the chunk is recycled. Commands are plain structs behind a header and replayed by a switch,
+     * callables are only recorded for what has no encoding of its own.
+     */
     class CommandChunk final {
+        /// Size of the blocks of the arena, a command never straddles two of them
+        static constexpr std::size_t BlockSize = 0x10000;
+        /// Alignment of the commands and of the arrays that follow them
+        static constexpr std::size_t CommandAlignment = 8;
+
     public:
+        CommandChunk();
+        ~CommandChunk();
+
         void ExecuteAll(vk::CommandBuffer cmdbuf);
 
+        /// Moves a callable into the arena.
         template <typename T>
-        bool Record(T& command) {
-            using FuncType = TypedCommand<T>;
-            static_assert(sizeof(FuncType) < sizeof(data), "Lambda is too large");
-
-            recorded_counts++;
-            command_offset = Common::AlignUp(command_offset, alignof(FuncType));
-            if (command_offset > sizeof(data) - sizeof(FuncType)) {
-                return false;
-            }
-            Command* const current_last = last;
-            last = new (data.data() + command_offset) FuncType(std::move(command));
+        void Record(T&& command) {
+            using FuncType = std::decay_t<T>;
+            // The payload is aligned to CommandAlignment, stricter callables are padded
+            constexpr std::size_t padding =
+                alignof(FuncType) > CommandAlignment ? alignof(FuncType) - CommandAlignment : 0;
+            constexpr std::size_t payload_size = sizeof(LambdaCommand) + padding + sizeof(FuncType);
+            static_assert(sizeof(CommandHeader) + payload_size <= BlockSize, "Lambda is too large");
+
+            u8* const payload = Allocate(Opcode::Lambda, payload_size);
+            const uintptr_t address = Common::AlignUp(
+                reinterpret_cast<uintptr_t>(payload + sizeof(LambdaCommand)), alignof(FuncType));
+            void* const storage =
+                new (reinterpret_cast<void*>(address)) FuncType(std::move(command));
+            new (payload) LambdaCommand{
+                .execute =
+                    [](void* object, vk::CommandBuffer cmdbuf) {
+                        FuncType& func = *static_cast<FuncType*>(object);
+                        func(cmdbuf);
+                        func.~FuncType();
+                    },
+                .object = storage,
+            };
+            recorded_lambdas++;
+        }
 
-            if (current_last) {
-                current_last->SetNext(last);
-            } else {
-                first = last;
-            }
-            command_offset += sizeof(FuncType);
-            return true;
+        /**
+         * Copies a command into the arena, reserving trailing_size bytes right after it. Returns
+         * the recorded command. The size of commands followed by data must be a multiple of
+         * CommandAlignment.
+         */
+        template <typename T>
+        T* Emplace(Opcode opcode, const T& command, std::size_t trailing_size = 0) {
+            static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= CommandAlignment);
+            return new (Allocate(opcode, sizeof(T) + trailing_size)) T{command};
         }
 
         void MarkSubmit() {
             submit = true;
         }
 
+        void SetRenderPass(vk::RenderPass render_pass_, vk::Framebuffer framebuffer_) {
+            render_pass = render_pass_;
+            framebuffer = framebuffer_;
+            ends_render_pass = false;
+        }
+
+        void MarkEndsRenderPass() {
+            ends_render_pass = true;
+        }
+
+        /// Returns true when the chunk is recorded to a secondary command buffer
+        bool IsSecondary() const {
+            return static_cast<bool>(render_pass);
+        }
+
+        bool EndsRenderPass() const {
+            return ends_render_pass;
+        }
+
+        vk::RenderPass RenderPass() const {
+            return render_pass;
+        }
+
+        vk::Framebuffer Framebuffer() const {
+            return framebuffer;
+        }
+
         bool Empty() const {
             return recorded_counts == 0;
         }
@@ -173,25 +421,148 @@ private:
             return submit;
         }
 
+        /// Returns the number of recorded commands
+        std::size_t NumCommands() const {
+            return recorded_counts;
+        }
+
+        /// Returns the number of recorded commands that are callables
+        std::size_t NumLambdas() const {
+            return recorded_lambdas;
+        }
+
+        /// Returns the number of bytes taken by the recorded commands
+        std::size_t Size() const {
+            return recorded_bytes;
+        }
+
     private:
-        Command* first = nullptr;
-        Command* last = nullptr;
+        struct Block {
+            std::unique_ptr<u8[]> data;
+            std::size_t used; ///< Bytes of the block taken by commands, set when it is left
+        };
+
+        /// Writes the header of a command and returns where its payload goes.
+        u8* Allocate(Opcode opcode, std::size_t payload_size) {
+            const std::size_t size =
+                Common::AlignUp(sizeof(CommandHeader) + payload_size, CommandAlignment);
+            DEBUG_ASSERT(size <= BlockSize);
+            if (static_cast<std::size_t>(block_end - cursor) < size) [[unlikely]] {
+                NextBlock();
+            }
+            u8* const entry = cursor;
+            cursor += size;
+            new (entry) CommandHeader{opcode, static_cast<u32>(size)};
+            recorded_counts++;
+            recorded_bytes += size;
+            return entry + sizeof(CommandHeader);
+        }
+
+        /// Continues recording in the next block, allocating it if the arena has no more.
+        void NextBlock();
+
+        std::vector<Block> blocks;
+        std::size_t current_block = 0;
+        u8* cursor = nullptr;
+        u8* block_end = nullptr;
 
         std::size_t recorded_counts = 0;
-        std::size_t command_offset = 0;
+        std::size_t recorded_lambdas = 0;
+        std::size_t recorded_bytes = 0;
         bool submit = false;
-        alignas(std::max_align_t) std::array<u8, 0x8000> data{};
+        vk::RenderPass render_pass{};
+        vk::Framebuffer framebuffer{};
+        bool ends_render_pass = false;
+    };
+
+    /// The chunks of a render pass, recorded to a secondary command buffer by a recorder thread.
+    struct SecondaryRecording {
+        std::vector<std::unique_ptr<CommandChunk>> chunks;
+        vk::CommandBuffer cmdbuf;
+        std::atomic_bool recorded{false};
+    };
+
+    /// A chunk waiting to be executed, or a secondary recording waiting to be stitched, in order.
+    struct PendingWork {
+        std::unique_ptr<CommandChunk> chunk;
+        std::unique_ptr<SecondaryRecording> secondary;
     };
 
 private:
+    /// Returns the chunk to record to, sending the current one to the worker thread first when it
+    /// has grown past DispatchThreshold.
+    CommandChunk& RecordingChunk() {
+        if (compute_pending) [[unlikely]] {
+            FlushCompute();
+        }
+        if (chunk->Size() >= DispatchThreshold) [[unlikely]] {
+            DispatchWork();
+        }
+        return *chunk;
+    }
+
     void WorkerThread(std::stop_token stop_token);
 
+    /// Queues the recording of a secondary to the recorder threads.
+    void RecordSecondary(SecondaryRecording& secondary);
+
+    /// Executes the pending chunks and secondary recordings into the primary command buffer.
+    void StitchPending();
+
+    /// Sends the current chunk to the worker thread, even when empty.
+    void QueueChunk();
+
+    /// Queues the submission of the recorded compute work on the worker thread.
+    void FlushCompute();
+
+    /// Executes and submits the oldest queued compute chunk. Called by the worker thread.
+    void SubmitCompute();
+
     void AllocateWorkerCommandBuffers();
 
     void SubmitExecution(vk::Semaphore signal_semaphore, vk::Semaphore wait_semaphore);
 
+    /// Adds the commands of a chunk that is handed to the worker thread to the trace counters.
+    void ReportRecorded(const CommandChunk& recorded);
+
     void AcquireNewChunk();
 
+    /// Returns a chunk from the reserve, or a new one if it is empty.
+    std::unique_ptr<CommandChunk> TakeChunk();
+
+    /// Writes a timestamp at the start of the command buffer, if a query is available for it.
+    void BeginSubmitTiming();
+
+    /**
+     * Writes a timestamp at the end of the command buffer that is about to be submitted. Returns
+     * where the submission time is stored, or nullptr if the submission is not timed.
+     */
+    std::atomic<u64>* EndSubmitTiming(u64 signal_value);
+
+    /// Converts a duration in timestamp ticks.
+    Core::PerfStats::Clock::duration TicksToDuration(u64 ticks) const;
+
+private:
+    /// Recorded bytes past which a chunk is handed to the worker thread, so that its execution
+    /// overlaps with the recording of the next one. The arena of a chunk does not need it.
+    static constexpr std::size_t DispatchThreshold = 0x8000;
+    static constexpr u32 MaxTimedSubmits = 32;
+    static constexpr u32 MaxTimedPasses = 63;
+    /// Every submission owns a block of queries, a pair for itself followed by one for each pass
+    static constexpr u32 QueriesPerSubmit = 2 + MaxTimedPasses * 2;
+
+    /// A submission whose execution time is measured by timestamp queries.
+    struct TimedSubmit {
+        u64 tick;
+        u32 frame;
+        u32 block;
+        u32 num_passes;
+        std::array<Core::PerfStats::GpuPass, MaxTimedPasses> passes;
+    };
+
+    /// Reads back the timestamps of a completed submission and adds them to the measured frame.
+    void ReadSubmitTiming(const TimedSubmit& submit);
+
 private:
     std::unique_ptr<MasterSemaphore> master_semaphore;
     CommandPool command_pool;
@@ -206,8 +577,51 @@ private:
     std::mutex reserve_mutex;
     std::mutex queue_mutex;
     std::condition_variable_any event_cv;
+    vk::RenderPass secondary_render_pass{};
+    vk::Framebuffer secondary_framebuffer{};
+    std::vector<PendingWork> pending_work;
+    std::unique_ptr<SecondaryRecording> open_secondary;
+    std::unique_ptr<Common::StatefulThreadWorker<std::unique_ptr<CommandPool>>> recorders;
+    std::unique_ptr<CommandPool> compute_pool;
+    std::unique_ptr<CommandChunk> compute_chunk;
+    std::queue<std::unique_ptr<CommandChunk>> compute_work;
+    std::mutex compute_mutex;
+    bool compute_pending{};
     std::jthread worker_thread;
     bool use_worker_thread;
+    vk::Device device;
+    vk::UniqueQueryPool timestamp_pool;
+    double timestamp_period{};
+    std::deque<TimedSubmit> timed_submits;
+    std::array<std::atomic<u64>, MaxTimedSubmits> submit_times{};
+    std::optional<TimedSubmit> current_submit;
+    bool pass_open{};
+    u32 next_block{};
+    u32 timing_frame{};
+    u32 measured_frame{};
+    u64 measured_busy{};
+    std::array<u64, Core::PerfStats::GpuPassCount> measured_passes{};
+    s64 trace_offset{std::numeric_limits<s64>::min()};
+};
+
+/// Times the commands recorded during its lifetime as a GPU pass. Must not be created inside a
+/// render pass.
+class ScopedPassTiming {
+public:
+    explicit ScopedPassTiming(Scheduler& scheduler_, Core::PerfStats::GpuPass pass)
+        : scheduler{scheduler_} {
+        scheduler.BeginPassTiming(pass);
+    }
+
+    ~ScopedPassTiming() {
+        scheduler.EndPassTiming();
+    }
+
+    ScopedPassTiming(const ScopedPassTiming&) = delete;
+    ScopedPassTiming& operator=(const ScopedPassTiming&) = delete;
+
+private:
+    Scheduler& scheduler;
 };
 
 } // namespace Vulkan
@@ -7,6 +7,7 @@
 #include <glslang/Include/ResourceLimits.h>
 #include <glslang/Public/ShaderLang.h>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/literals.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
@@ -162,6 +163,15 @@ bool InitializeCompiler() {
 
 vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, vk::Device device,
                          std::string_view premable) {
+    const std::vector<u32> spirv = CompileGLSL(code, stage, premable);
+    if (spirv.empty()) {
+        return {};
+    }
+    return CompileSPV(spirv, device);
+}
+
+std::vector<u32> CompileGLSL(std::string_view code, vk::ShaderStageFlagBits stage,
+                             std::string_view premable) {
     if (!InitializeCompiler()) {
         return {};
     }
@@ -217,7 +227,16 @@ vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, v
         LOG_INFO(Render_Vulkan, "SPIR-V conversion messages: {}", spv_messages);
     }
 
-    return CompileSPV(out_code, device);
+    return out_code;
+}
+
+u64 GetGLSLCompilerHash() {
+    const glslang::Version version = glslang::GetVersion();
+    const u64 version_code = static_cast<u64>(version.major) << 32 |
+                             static_cast<u64>(version.minor) << 16 |
+                             static_cast<u64>(version.patch);
+    return Common::HashCombine(version_code,
+                               static_cast<u64>(glslang::GetSpirvGeneratorVersion()));
 }
 
 vk::ShaderModule CompileSPV(std::span<const u32> code, vk::Device device) {
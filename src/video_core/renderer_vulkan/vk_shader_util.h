@@ -5,6 +5,8 @@
 #pragma once
 
 #include <span>
+#include <string_view>
+#include <vector>
 
 #include "video_core/renderer_vulkan/vk_common.h"
 
@@ -19,6 +21,21 @@ namespace Vulkan {
 vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, vk::Device device,
                          std::string_view premable = "");
 
+/**
+ * @brief Converts GLSL to SPIR-V using glslang.
+ * @param code The string containing GLSL code.
+ * @param stage The pipeline stage the shader will be used in.
+ * @return The SPIR-V bytecode, empty if the code failed to compile.
+ */
+std::vector<u32> CompileGLSL(std::string_view code, vk::ShaderStageFlagBits stage,
+                             std::string_view premable = "");
+
+/**
+ * @brief Identifies the glslang version, which together with the GLSL source determines the
+ * SPIR-V returned by CompileGLSL.
+ */
+u64 GetGLSLCompilerHash();
+
 /**
  * @brief Creates a vulkan shader module from SPIR-V bytecode.
  * @param code The SPIR-V bytecode data.
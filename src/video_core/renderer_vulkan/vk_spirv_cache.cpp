@@ -0,0 +1,205 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/renderer_vulkan/vk_spirv_cache.h"
+
+namespace Vulkan {
+
+namespace {
+
+constexpr std::array<u8, 4> CACHE_MAGIC = {'V', 'K', 'S', 'C'};
+constexpr u32 CACHE_VERSION = 1;
+
+struct CacheHeader {
+    std::array<u8, 4> magic;
+    u32 version;
+    u64 compiler_hash;
+};
+static_assert(sizeof(CacheHeader) == 16, "CacheHeader has incorrect size!");
+
+struct EntryHeader {
+    u64 key;
+    u64 checksum;
+    u32 num_words;
+    u32 reserved;
+};
+static_assert(sizeof(EntryHeader) % sizeof(u32) == 0, "The code of an entry must stay aligned");
+
+CacheHeader MakeHeader() {
+    return CacheHeader{
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+        .compiler_hash = GetGLSLCompilerHash(),
+    };
+}
+
+/// Key of the SPIR-V compiled from the source, which also depends on the optimizer setting.
+u64 MakeKey(std::string_view code, vk::ShaderStageFlagBits stage) {
+    const bool disable_optimizer = Settings::values.disable_spirv_optimizer.GetValue();
+    const u64 config = static_cast<u64>(stage) | static_cast<u64>(disable_optimizer) << 32;
+    return Common::HashCombine(Common::ComputeHash64(code.data(), code.size()), config);
+}
+
+u64 ComputeChecksum(std::span<const u32> code) {
+    return Common::ComputeHash64(code.data(), code.size_bytes());
+}
+
+} // Anonymous namespace
+
+SpirvCache::SpirvCache()
+    : new_code_accounting{Common::MemoryAccounting::Category::ShaderCache, 0} {}
+
+SpirvCache::~SpirvCache() = default;
+
+void SpirvCache::Open(std::string path_) {
+    std::scoped_lock lock{mutex};
+    if (!path.empty()) {
+        return;
+    }
+    path = std::move(path_);
+    record = true;
+
+    FileUtil::IOFile cache_file{path, "rb"};
+    if (!cache_file.IsOpen() || !mapping.Open(cache_file)) {
+        return;
+    }
+
+    const std::span<const u8> data = mapping.Data();
+    const CacheHeader expected = MakeHeader();
+    if (data.size() < sizeof(CacheHeader) ||
+        std::memcmp(data.data(), &expected, sizeof(CacheHeader)) != 0) {
+        LOG_INFO(Render_Vulkan, "SPIR-V cache was written by another glslang version, discarding");
+        mapping.Close();
+        return;
+    }
+
+    std::size_t offset = sizeof(CacheHeader);
+    while (data.size() - offset >= sizeof(EntryHeader)) {
+        EntryHeader header;
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        const std::size_t code_size = static_cast<std::size_t>(header.num_words) * sizeof(u32);
+        if (code_size > data.size() - offset - sizeof(EntryHeader)) {
+            break;
+        }
+        // A module recompiled after its entry was found corrupted is appended again, the later
+        // entry replaces the earlier one.
+        const auto* code = reinterpret_cast<const u32*>(data.data() + offset + sizeof(header));
+        entries.insert_or_assign(header.key, Entry{{code, header.num_words}, header.checksum});
+        offset += sizeof(EntryHeader) + code_size;
+    }
+
+    // Appending after a partially written entry would misalign every later one.
+    if (offset != data.size()) {
+        LOG_WARNING(Render_Vulkan, "SPIR-V cache {} is truncated, discarding", path);
+        entries.clear();
+        mapping.Close();
+        return;
+    }
+
+    file_size = data.size();
+    file_valid = true;
+    LOG_INFO(Render_Vulkan, "Mapped {} SPIR-V modules from the shader cache", entries.size());
+}
+
+vk::ShaderModule SpirvCache::Compile(std::string_view code, vk::ShaderStageFlagBits stage,
+                                     vk::Device device) {
+    const u64 key = MakeKey(code, stage);
+    if (const std::span<const u32> spirv = Find(key); !spirv.empty()) {
+        return CompileSPV(spirv, device);
+    }
+
+    std::vector<u32> spirv = CompileGLSL(code, stage);
+    if (spirv.empty()) {
+        return {};
+    }
+    const vk::ShaderModule module = CompileSPV(spirv, device);
+    Insert(key, std::move(spirv));
+    return module;
+}
+
+std::span<const u32> SpirvCache::Find(u64 key) {
+    std::scoped_lock lock{mutex};
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return {};
+    }
+
+    // The code of the mapped modules is only read when they are used, so it is checked then.
+    Entry& entry = it->second;
+    if (!entry.verified) {
+        if (ComputeChecksum(entry.code) != entry.checksum) {
+            LOG_WARNING(Render_Vulkan, "SPIR-V cache entry {:016X} is corrupted", key);
+            entries.erase(it);
+            return {};
+        }
+        entry.verified = true;
+    }
+    return entry.code;
+}
+
+void SpirvCache::Insert(u64 key, std::vector<u32>&& code) {
+    std::scoped_lock lock{mutex};
+    if (entries.contains(key)) {
+        // Another thread compiled the same source meanwhile
+        return;
+    }
+    const std::vector<u32>& stored = new_code.emplace_back(std::move(code));
+    new_code_accounting.Resize(new_code_accounting.Size() + stored.size() * sizeof(u32));
+    const u64 checksum = ComputeChecksum(stored);
+    entries.emplace(key, Entry{stored, checksum, true});
+    if (!record) {
+        return;
+    }
+
+    const EntryHeader header = {
+        .key = key,
+        .checksum = checksum,
+        .num_words = static_cast<u32>(stored.size()),
+        .reserved = 0,
+    };
+    const std::size_t entry_size = sizeof(header) + stored.size() * sizeof(u32);
+    if (file_size + entry_size > MAX_FILE_SIZE) {
+        return;
+    }
+
+    if (!file.IsOpen()) {
+        file = FileUtil::IOFile{path, file_valid ? "ab" : "wb"};
+        if (!file.IsOpen()) {
+            LOG_ERROR(Render_Vulkan, "Failed to open SPIR-V cache file={}", path);
+            record = false;
+            return;
+        }
+        if (!file_valid) {
+            if (file.WriteObject(MakeHeader()) != 1) {
+                LOG_ERROR(Render_Vulkan, "Failed to write SPIR-V cache header");
+                file.Close();
+                record = false;
+                return;
+            }
+            file_size = sizeof(CacheHeader);
+            file_valid = true;
+        }
+    }
+
+    // The entry is written at once so that an interrupted write only truncates the last entry.
+    std::vector<u8> buffer(entry_size);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + sizeof(header), stored.data(), stored.size() * sizeof(u32));
+    if (file.WriteSpan(std::span<const u8>{buffer}) != buffer.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to write SPIR-V cache entry");
+        file.Close();
+        record = false;
+        return;
+    }
+    file.Flush();
+    file_size += entry_size;
+}
+
+} // namespace Vulkan
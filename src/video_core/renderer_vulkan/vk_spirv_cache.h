@@ -0,0 +1,74 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/mapped_file.h"
+#include "common/memory_accounting.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+/**
+ * On-disk cache of the SPIR-V glslang produces from generated GLSL, keyed by the hash of the
+ * source and shared by all titles. The driver pipeline cache does not keep the SPIR-V of its
+ * pipelines, so without it every shader goes through glslang again when the driver cache is
+ * invalidated. The file is memory-mapped when opened and new modules are appended to it, it is
+ * discarded when it was written by a different glslang version.
+ */
+class SpirvCache {
+    /// Size of the file past which new modules are no longer recorded
+    static constexpr std::size_t MAX_FILE_SIZE = 256 * 1024 * 1024;
+
+public:
+    SpirvCache();
+    ~SpirvCache();
+
+    /// Maps the cache file at path. Does nothing if a file was opened already.
+    void Open(std::string path);
+
+    /**
+     * Creates a shader module from GLSL, using the cached SPIR-V when the same source was
+     * compiled before and recording it otherwise. Safe to call from several threads.
+     */
+    vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage,
+                             vk::Device device);
+
+private:
+    struct Entry {
+        std::span<const u32> code;
+        u64 checksum;
+        bool verified{}; ///< Whether the code was checked against the checksum
+    };
+
+    /// Returns the cached SPIR-V of the key, or an empty span if there is none.
+    std::span<const u32> Find(u64 key);
+
+    /// Records newly compiled SPIR-V, appending it to the file.
+    void Insert(u64 key, std::vector<u32>&& code);
+
+    std::mutex mutex;
+    std::string path;
+    Common::MappedFile mapping;
+    FileUtil::IOFile file;
+    std::size_t file_size{};
+    bool file_valid{}; ///< Whether the file has a valid header, so that entries can be appended
+    bool record{};     ///< Whether new modules are appended to the file
+    std::unordered_map<u64, Entry> entries;
+    /// Code of the modules compiled since the file was mapped
+    std::deque<std::vector<u32>> new_code;
+    Common::MemoryAccounting::Allocation new_code_accounting;
+};
+
+} // namespace Vulkan
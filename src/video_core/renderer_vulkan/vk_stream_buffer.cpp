@@ -194,6 +194,14 @@ void StreamBuffer::CreateBuffers(u64 prefered_size) {
     const auto& dedicated_requirements = requirements_chain.get<vk::MemoryDedicatedRequirements>();
 
     stream_buffer_size = static_cast<u64>(requirements.memoryRequirements.size);
+    accounting = Common::MemoryAccounting::Allocation{
+        Common::MemoryAccounting::Category::StagingBuffers, stream_buffer_size};
+
+    const bool device_address =
+        static_cast<bool>(usage & vk::BufferUsageFlagBits::eShaderDeviceAddress);
+    const vk::MemoryAllocateFlagsInfo flags_info = {
+        .flags = vk::MemoryAllocateFlagBits::eDeviceAddress,
+    };
 
     LOG_INFO(Render_Vulkan, "Creating {} buffer with size {} KiB with flags {}",
              BufferTypeName(type), stream_buffer_size / 1024,
@@ -209,10 +217,14 @@ void StreamBuffer::CreateBuffers(u64 prefered_size) {
 
         auto& dedicated_alloc_info = alloc_chain.get<vk::MemoryDedicatedAllocateInfo>();
         dedicated_alloc_info.buffer = buffer;
+        if (device_address) {
+            dedicated_alloc_info.pNext = &flags_info;
+        }
 
         memory = device.allocateMemory(alloc_chain.get());
     } else {
         memory = device.allocateMemory({
+            .pNext = device_address ? &flags_info : nullptr,
             .allocationSize = requirements.memoryRequirements.size,
             .memoryTypeIndex = preferred_type,
         });
@@ -220,6 +232,9 @@ void StreamBuffer::CreateBuffers(u64 prefered_size) {
 
     device.bindBufferMemory(buffer, memory, 0);
     mapped = reinterpret_cast<u8*>(device.mapMemory(memory, 0, VK_WHOLE_SIZE));
+    if (device_address) {
+        address = device.getBufferAddressKHR({.buffer = buffer});
+    }
 
     if (instance.HasDebuggingToolAttached()) {
         SetObjectName(device, buffer, "StreamBuffer({}): {} KiB {}", BufferTypeName(type),
@@ -8,6 +8,7 @@
 #include <span>
 #include <tuple>
 #include <vector>
+#include "common/memory_accounting.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
 namespace Vulkan {
@@ -44,6 +45,11 @@ public:
         return buffer;
     }
 
+    /// Returns the device address of the buffer, if it was created with device address usage.
+    vk::DeviceAddress Address() const noexcept {
+        return address;
+    }
+
 private:
     struct Watch {
         u64 tick{};
@@ -63,10 +69,12 @@ private:
     Scheduler& scheduler;     ///< Command scheduler.
 
     vk::Device device;
-    vk::Buffer buffer;        ///< Mapped buffer.
-    vk::DeviceMemory memory;  ///< Memory allocation.
-    u8* mapped{};             ///< Pointer to the mapped memory
-    u64 stream_buffer_size{}; ///< Stream buffer size.
+    vk::Buffer buffer;           ///< Mapped buffer.
+    vk::DeviceAddress address{}; ///< Device address of the buffer.
+    vk::DeviceMemory memory;     ///< Memory allocation.
+    u8* mapped{};                ///< Pointer to the mapped memory
+    u64 stream_buffer_size{};    ///< Stream buffer size.
+    Common::MemoryAccounting::Allocation accounting;
     vk::BufferUsageFlags usage{};
     BufferType type;
 
@@ -3,10 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <utility>
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
+#include "core/core_timing.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_swapchain.h"
 
@@ -15,6 +18,17 @@ MICROPROFILE_DEFINE(Vulkan_Present, "Vulkan", "Swapchain Present", MP_RGB(66, 18
 
 namespace Vulkan {
 
+namespace {
+
+/// Returns the current time in the CLOCK_MONOTONIC domain used by VK_GOOGLE_display_timing
+u64 MonotonicNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // Anonymous namespace
+
 Swapchain::Swapchain(const Instance& instance_, u32 width, u32 height, vk::SurfaceKHR surface_,
                      bool low_refresh_rate)
     : instance{instance_}, surface{surface_} {
@@ -29,13 +43,21 @@ Swapchain::~Swapchain() {
 }
 
 void Swapchain::Create(u32 width_, u32 height_, vk::SurfaceKHR surface_, bool low_refresh_rate_) {
+    // A swapchain of the same surface is handed to the new one, which lets presents queued to it
+    // finish without waiting for the device. Another surface needs its window to be released.
+    const bool same_surface = surface == surface_;
+    if (swapchain && same_surface) {
+        Retire();
+    } else {
+        Destroy();
+    }
+
     width = width_;
     height = height_;
     surface = surface_;
     low_refresh_rate = low_refresh_rate_;
     needs_recreation = false;
-
-    Destroy();
+    surface_lost = false;
 
     SetPresentMode();
     SetSurfaceProperties();
@@ -65,7 +87,7 @@ void Swapchain::Create(u32 width_, u32 height_, vk::SurfaceKHR surface_, bool lo
         .compositeAlpha = composite_alpha,
         .presentMode = present_mode,
         .clipped = true,
-        .oldSwapchain = nullptr,
+        .oldSwapchain = same_surface && !retired.empty() ? retired.back().swapchain : nullptr,
     };
 
     try {
@@ -77,6 +99,7 @@ void Swapchain::Create(u32 width_, u32 height_, vk::SurfaceKHR surface_, bool lo
 
     SetupImages();
     RefreshSemaphores();
+    SetupDisplayTiming();
 }
 
 bool Swapchain::AcquireNextImage() {
@@ -93,8 +116,10 @@ bool Swapchain::AcquireNextImage() {
     switch (result) {
     case vk::Result::eSuccess:
         break;
-    case vk::Result::eSuboptimalKHR:
     case vk::Result::eErrorSurfaceLostKHR:
+        surface_lost = true;
+        [[fallthrough]];
+    case vk::Result::eSuboptimalKHR:
     case vk::Result::eErrorOutOfDateKHR:
         needs_recreation = true;
         break;
@@ -108,7 +133,27 @@ bool Swapchain::AcquireNextImage() {
 }
 
 void Swapchain::Present() {
+    vk::PresentTimeGOOGLE present_time{};
+    const vk::PresentTimesInfoGOOGLE present_times = {
+        .swapchainCount = 1,
+        .pTimes = &present_time,
+    };
+    if (present_interval) {
+        UpdatePresentTiming();
+
+        // Aim each present at the refresh cycle following the previous one, so that frames are
+        // shown for the same number of cycles. A frame that is already late is shown as soon as
+        // possible instead and becomes the next anchor once its timing is known.
+        const u64 now = MonotonicNanoseconds();
+        const u64 desired_time = anchor_time + (present_id - anchor_id) * present_interval;
+        present_time.presentID = present_id;
+        present_time.desiredPresentTime = anchor_time != 0 && desired_time > now ? desired_time : 0;
+        queue_times[present_id % NumTrackedPresents] = now;
+        present_id++;
+    }
+
     const vk::PresentInfoKHR present_info = {
+        .pNext = present_interval ? &present_times : nullptr,
         .waitSemaphoreCount = 1,
         .pWaitSemaphores = &present_ready[image_index],
         .swapchainCount = 1,
@@ -124,6 +169,7 @@ void Swapchain::Present() {
         return;
     } catch (vk::SurfaceLostKHRError&) {
         needs_recreation = true;
+        surface_lost = true;
         return;
     } catch (const vk::SystemError& err) {
         LOG_CRITICAL(Render_Vulkan, "Swapchain presentation failed {}", err.what());
@@ -131,6 +177,8 @@ void Swapchain::Present() {
     }
 
     frame_index = (frame_index + 1) % image_count;
+    present_count++;
+    DestroyRetired(false);
 }
 
 void Swapchain::FindPresentFormat() {
@@ -202,6 +250,63 @@ void Swapchain::SetPresentMode() {
     }
 }
 
+void Swapchain::SetupDisplayTiming() {
+    present_interval = 0;
+    present_id = 0;
+    anchor_id = 0;
+    anchor_time = 0;
+    if (!instance.IsDisplayTimingSupported() || present_mode != vk::PresentModeKHR::eFifo) {
+        return;
+    }
+
+    const vk::Device device = instance.GetDevice();
+    const u64 refresh_duration = device.getRefreshCycleDurationGOOGLE(swapchain).refreshDuration;
+    if (refresh_duration == 0) {
+        return;
+    }
+
+    // Pacing is only useful when the emulated frame rate lines up with whole refresh cycles, as
+    // with 60 Hz content on 120 Hz panels. Other rates are presented as soon as they are ready.
+    constexpr double FrameDuration = 1'000'000'000.0 / SCREEN_REFRESH_RATE;
+    const double cycles = FrameDuration / static_cast<double>(refresh_duration);
+    const double whole_cycles = std::max(std::round(cycles), 1.0);
+    if (std::abs(cycles - whole_cycles) > 0.1) {
+        LOG_INFO(Render_Vulkan, "Refresh cycle of {} ns does not match the emulated frame rate",
+                 refresh_duration);
+        return;
+    }
+
+    present_interval = static_cast<u64>(whole_cycles) * refresh_duration;
+    LOG_INFO(Render_Vulkan, "Pacing presents every {} refresh cycles of {} ns",
+             static_cast<u32>(whole_cycles), refresh_duration);
+}
+
+void Swapchain::UpdatePresentTiming() {
+    const vk::Device device = instance.GetDevice();
+    std::array<vk::PastPresentationTimingGOOGLE, NumTrackedPresents> timings;
+    u32 count = NumTrackedPresents;
+    const vk::Result result =
+        device.getPastPresentationTimingGOOGLE(swapchain, &count, timings.data());
+    if (result != vk::Result::eSuccess && result != vk::Result::eIncomplete) {
+        return;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        const vk::PastPresentationTimingGOOGLE& timing = timings[i];
+        if (present_id - timing.presentID > NumTrackedPresents) {
+            continue;
+        }
+        anchor_id = timing.presentID;
+        anchor_time = timing.actualPresentTime;
+
+        const u64 queue_time = queue_times[timing.presentID % NumTrackedPresents];
+        if (timing.actualPresentTime > queue_time) {
+            present_latency.store(static_cast<s64>(timing.actualPresentTime - queue_time),
+                                  std::memory_order_relaxed);
+        }
+    }
+}
+
 void Swapchain::SetSurfaceProperties() {
     const vk::SurfaceCapabilitiesKHR capabilities =
         instance.GetPhysicalDevice().getSurfaceCapabilitiesKHR(surface);
@@ -237,13 +342,44 @@ void Swapchain::Destroy() {
     vk::Device device = instance.GetDevice();
     if (swapchain) {
         device.destroySwapchainKHR(swapchain);
+        swapchain = nullptr;
+    }
+    for (const vk::Semaphore semaphore : image_acquired) {
+        device.destroySemaphore(semaphore);
     }
-    for (u32 i = 0; i < image_count; i++) {
-        device.destroySemaphore(image_acquired[i]);
-        device.destroySemaphore(present_ready[i]);
+    for (const vk::Semaphore semaphore : present_ready) {
+        device.destroySemaphore(semaphore);
     }
     image_acquired.clear();
     present_ready.clear();
+    DestroyRetired(true);
+}
+
+void Swapchain::Retire() {
+    RetiredSwapchain& old = retired.emplace_back();
+    old.swapchain = std::exchange(swapchain, nullptr);
+    old.semaphores = std::move(image_acquired);
+    old.semaphores.insert(old.semaphores.end(), present_ready.begin(), present_ready.end());
+    old.present_count = present_count + image_count + 1;
+    image_acquired.clear();
+    present_ready.clear();
+}
+
+void Swapchain::DestroyRetired(bool all) {
+    // The submission waiting on the last acquire of a retired swapchain and its present are done
+    // once every image of the new swapchain was presented, as the present window waits on the
+    // fence of each frame before reusing it.
+    const vk::Device device = instance.GetDevice();
+    std::erase_if(retired, [&](const RetiredSwapchain& old) {
+        if (!all && old.present_count > present_count) {
+            return false;
+        }
+        device.destroySwapchainKHR(old.swapchain);
+        for (const vk::Semaphore semaphore : old.semaphores) {
+            device.destroySemaphore(semaphore);
+        }
+        return true;
+    });
 }
 
 void Swapchain::RefreshSemaphores() {
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 #include "common/common_types.h"
@@ -61,6 +64,11 @@ public:
         return extent;
     }
 
+    /// Returns true if the surface was lost and the swapchain needs a new one to be recreated
+    [[nodiscard]] bool IsSurfaceLost() const {
+        return surface_lost;
+    }
+
     [[nodiscard]] vk::Semaphore GetImageAcquiredSemaphore() const {
         return image_acquired[frame_index];
     }
@@ -69,6 +77,11 @@ public:
         return present_ready[image_index];
     }
 
+    /// Returns the latest measured delay between queueing a present and its display
+    [[nodiscard]] std::chrono::nanoseconds GetPresentLatency() const {
+        return std::chrono::nanoseconds{present_latency.load(std::memory_order_relaxed)};
+    }
+
 private:
     /// Selects the best available swapchain image format
     void FindPresentFormat();
@@ -79,16 +92,36 @@ private:
     /// Sets the surface properties according to device capabilities
     void SetSurfaceProperties();
 
-    /// Destroys current swapchain resources
+    /// Destroys current swapchain resources, including those of retired swapchains. The device
+    /// must be done with all of them.
     void Destroy();
 
+    /// Moves the current swapchain resources to the retired list, to be destroyed once unused
+    void Retire();
+
+    /// Destroys the retired swapchains that are no longer used, or all of them
+    void DestroyRetired(bool all);
+
     /// Performs creation of image views and framebuffers from the swapchain images
     void SetupImages();
 
     /// Creates the image acquired and present ready semaphores
     void RefreshSemaphores();
 
+    /// Queries the display refresh cycle and picks the present interval when pacing frames
+    void SetupDisplayTiming();
+
+    /// Reads the timing of past presents, updating the pacing anchor and the present latency
+    void UpdatePresentTiming();
+
 private:
+    /// Swapchain handed to a newer one, along with its semaphores
+    struct RetiredSwapchain {
+        vk::SwapchainKHR swapchain;
+        std::vector<vk::Semaphore> semaphores;
+        u64 present_count; ///< Presents after which nothing uses the swapchain anymore
+    };
+
     const Instance& instance;
     vk::SwapchainKHR swapchain{};
     vk::SurfaceKHR surface{};
@@ -106,7 +139,18 @@ private:
     u32 image_index = 0;
     u32 frame_index = 0;
     bool needs_recreation = true;
+    bool surface_lost = false;
     bool low_refresh_rate;
+    std::vector<RetiredSwapchain> retired;
+    u64 present_count{};
+
+    static constexpr std::size_t NumTrackedPresents = 8;
+    u64 present_interval{}; ///< Nanoseconds between paced presents, 0 when not pacing
+    u32 present_id{};
+    u32 anchor_id{};   ///< Last present with a known display time
+    u64 anchor_time{}; ///< Display time of anchor_id in nanoseconds
+    std::array<u64, NumTrackedPresents> queue_times{};
+    std::atomic<s64> present_latency{};
 };
 
 } // namespace Vulkan
@@ -5,9 +5,12 @@
 #include <boost/container/small_vector.hpp>
 #include <boost/container/static_vector.hpp>
 
+#include "common/alignment.h"
+#include "common/hash.h"
 #include "common/literals.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/tracing.h"
 #include "video_core/custom_textures/material.h"
 #include "video_core/rasterizer_cache/texture_codec.h"
 #include "video_core/rasterizer_cache/utils.h"
@@ -32,6 +35,7 @@ namespace Vulkan {
 
 namespace {
 
+using GpuPass = Core::PerfStats::GpuPass;
 using VideoCore::MapType;
 using VideoCore::PixelFormat;
 using VideoCore::SurfaceType;
@@ -142,11 +146,9 @@ boost::container::small_vector<vk::ImageMemoryBarrier, 3> MakeInitBarriers(
     return barriers;
 }
 
-Handle MakeHandle(const Instance* instance, u32 width, u32 height, u32 levels, TextureType type,
-                  vk::Format format, vk::ImageUsageFlags usage, vk::ImageCreateFlags flags,
-                  vk::ImageAspectFlags aspect, bool need_format_list,
-                  std::string_view debug_name = {}) {
-    const u32 layers = type == TextureType::CubeMap ? 6 : 1;
+Handle MakeHandle(const Instance* instance, const ImageKey& key) {
+    MICROPROFILE_SCOPE(Vulkan_ImageAlloc);
+    const u32 layers = key.type == TextureType::CubeMap ? 6 : 1;
 
     const std::array format_list = {
         vk::Format::eR8G8B8A8Unorm,
@@ -158,15 +160,15 @@ Handle MakeHandle(const Instance* instance, u32 width, u32 height, u32 levels, T
     };
 
     const vk::ImageCreateInfo image_info = {
-        .pNext = need_format_list ? &image_format_list : nullptr,
-        .flags = flags,
+        .pNext = key.need_format_list ? &image_format_list : nullptr,
+        .flags = key.flags,
         .imageType = vk::ImageType::e2D,
-        .format = format,
-        .extent = {width, height, 1},
-        .mipLevels = levels,
+        .format = key.format,
+        .extent = {key.width, key.height, 1},
+        .mipLevels = key.levels,
         .arrayLayers = layers,
         .samples = vk::SampleCountFlagBits::e1,
-        .usage = usage,
+        .usage = key.usage,
     };
 
     const VmaAllocationCreateInfo alloc_info = {
@@ -193,28 +195,47 @@ Handle MakeHandle(const Instance* instance, u32 width, u32 height, u32 levels, T
     const vk::ImageViewCreateInfo view_info = {
         .image = image,
         .viewType =
-            type == TextureType::CubeMap ? vk::ImageViewType::eCube : vk::ImageViewType::e2D,
-        .format = format,
+            key.type == TextureType::CubeMap ? vk::ImageViewType::eCube : vk::ImageViewType::e2D,
+        .format = key.format,
         .subresourceRange{
-            .aspectMask = aspect,
+            .aspectMask = key.aspect,
             .baseMipLevel = 0,
-            .levelCount = levels,
+            .levelCount = key.levels,
             .baseArrayLayer = 0,
             .layerCount = layers,
         },
     };
     vk::UniqueImageView image_view = instance->GetDevice().createImageViewUnique(view_info);
 
-    if (!debug_name.empty() && instance->HasDebuggingToolAttached()) {
-        SetObjectName(instance->GetDevice(), image, debug_name);
-        SetObjectName(instance->GetDevice(), image_view.get(), "{} View({})", debug_name,
-                      vk::to_string(aspect));
-    }
-
     return Handle{
         .alloc = allocation,
         .image = image,
         .image_view = std::move(image_view),
+        .key = key,
+    };
+}
+
+void SetHandleName(const Instance* instance, const Handle& handle, std::string_view debug_name) {
+    if (!debug_name.empty() && instance->HasDebuggingToolAttached()) {
+        SetObjectName(instance->GetDevice(), handle.image, debug_name);
+        SetObjectName(instance->GetDevice(), handle.image_view.get(), "{} View({})", debug_name,
+                      vk::to_string(handle.key.aspect));
+    }
+}
+
+ImageKey MakeImageKey(u32 width, u32 height, u32 levels, TextureType type, vk::Format format,
+                      vk::ImageUsageFlags usage, vk::ImageCreateFlags flags,
+                      vk::ImageAspectFlags aspect, bool need_format_list) {
+    return ImageKey{
+        .width = width,
+        .height = height,
+        .levels = levels,
+        .type = type,
+        .format = format,
+        .usage = usage,
+        .flags = flags,
+        .aspect = aspect,
+        .need_format_list = need_format_list,
     };
 }
 
@@ -244,23 +265,103 @@ vk::ImageSubresourceRange MakeSubresourceRange(vk::ImageAspectFlags aspect, u32
 
 constexpr u64 UPLOAD_BUFFER_SIZE = 512_MiB;
 constexpr u64 DOWNLOAD_BUFFER_SIZE = 16_MiB;
+constexpr u64 IMAGE_POOL_SIZE = 128_MiB;
 
 } // Anonymous namespace
 
+u64 ImageKey::Hash() const noexcept {
+    u64 hash = Common::HashCombine(width, height);
+    hash = Common::HashCombine(hash, levels);
+    hash = Common::HashCombine(hash, static_cast<u64>(type));
+    hash = Common::HashCombine(hash, static_cast<u64>(format));
+    hash = Common::HashCombine(hash, static_cast<VkImageUsageFlags>(usage));
+    hash = Common::HashCombine(hash, static_cast<VkImageCreateFlags>(flags));
+    hash = Common::HashCombine(hash, static_cast<VkImageAspectFlags>(aspect));
+    return Common::HashCombine(hash, need_format_list);
+}
+
 TextureRuntime::TextureRuntime(const Instance& instance, Scheduler& scheduler,
                                RenderManager& renderpass_cache, DescriptorUpdateQueue& update_queue,
                                u32 num_swapchain_images_)
     : instance{instance}, scheduler{scheduler}, renderpass_cache{renderpass_cache},
       blit_helper{instance, scheduler, renderpass_cache, update_queue},
-      upload_buffer{instance, scheduler, vk::BufferUsageFlagBits::eTransferSrc, UPLOAD_BUFFER_SIZE,
-                    BufferType::Upload},
+      upload_buffer{instance, scheduler,
+                    vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eStorageBuffer,
+                    UPLOAD_BUFFER_SIZE, BufferType::Upload},
       download_buffer{instance, scheduler,
                       vk::BufferUsageFlagBits::eTransferDst |
                           vk::BufferUsageFlagBits::eStorageBuffer,
                       DOWNLOAD_BUFFER_SIZE, BufferType::Download},
       num_swapchain_images{num_swapchain_images_} {}
 
-TextureRuntime::~TextureRuntime() = default;
+TextureRuntime::~TextureRuntime() {
+    for (auto& [key, pooled] : image_pool) {
+        for (const PooledHandle& entry : pooled) {
+            vmaDestroyImage(instance.GetAllocator(), entry.handle.image, entry.handle.alloc);
+        }
+    }
+    Common::Tracing::SetCounter(Common::Tracing::Counter::PooledImageMemory, 0);
+}
+
+Handle TextureRuntime::AllocateHandle(const ImageKey& key, std::string_view debug_name) {
+    Handle handle;
+    const auto it = image_pool.find(key);
+    if (it != image_pool.end() && !it->second.empty()) {
+        // Reuse the most recently pooled image, which is the most likely to still be resident
+        PooledHandle& entry = it->second.back();
+        pooled_bytes -= entry.size;
+        handle = std::move(entry.handle);
+        it->second.pop_back();
+        Common::Tracing::IncrementCounter(Common::Tracing::Counter::ImageReuse);
+        Common::Tracing::SetCounter(Common::Tracing::Counter::PooledImageMemory, pooled_bytes);
+    } else {
+        handle = MakeHandle(&instance, key);
+        Common::Tracing::IncrementCounter(Common::Tracing::Counter::ImageAllocation);
+    }
+    SetHandleName(&instance, handle, debug_name);
+    return handle;
+}
+
+void TextureRuntime::RecycleHandle(Handle&& handle) {
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(instance.GetAllocator(), handle.alloc, &info);
+    if (info.size > IMAGE_POOL_SIZE) {
+        vmaDestroyImage(instance.GetAllocator(), handle.image, handle.alloc);
+        return;
+    }
+
+    while (pooled_bytes + info.size > IMAGE_POOL_SIZE) {
+        EvictOldestHandle();
+    }
+    pooled_bytes += info.size;
+    image_pool[handle.key].push_back(PooledHandle{
+        .handle = std::move(handle),
+        .size = info.size,
+        .recycle_tick = recycle_tick++,
+    });
+    Common::Tracing::SetCounter(Common::Tracing::Counter::PooledImageMemory, pooled_bytes);
+}
+
+void TextureRuntime::EvictOldestHandle() {
+    // Each bucket is ordered by recycle tick, so the oldest image is at the front of a bucket
+    auto oldest = image_pool.end();
+    for (auto it = image_pool.begin(); it != image_pool.end(); ++it) {
+        if (!it->second.empty() && (oldest == image_pool.end() ||
+                                    it->second.front().recycle_tick <
+                                        oldest->second.front().recycle_tick)) {
+            oldest = it;
+        }
+    }
+    ASSERT(oldest != image_pool.end());
+
+    const PooledHandle& entry = oldest->second.front();
+    vmaDestroyImage(instance.GetAllocator(), entry.handle.image, entry.handle.alloc);
+    pooled_bytes -= entry.size;
+    oldest->second.pop_front();
+    if (oldest->second.empty()) {
+        image_pool.erase(oldest);
+    }
+}
 
 VideoCore::StagingData TextureRuntime::FindStaging(u32 size, bool upload) {
     StreamBuffer& buffer = upload ? upload_buffer : download_buffer;
@@ -293,6 +394,8 @@ bool TextureRuntime::Reinterpret(Surface& source, Surface& dest,
     }
 
     if (src_format == PixelFormat::D24S8 && dst_format == PixelFormat::RGBA8) {
+        renderpass_cache.EndRendering();
+        const ScopedPassTiming timing{scheduler, GpuPass::Blit};
         blit_helper.ConvertDS24S8ToRGBA8(source, dest, copy);
     } else {
         LOG_WARNING(Render_Vulkan, "Unimplemented reinterpretation {} -> {}",
@@ -305,6 +408,7 @@ bool TextureRuntime::Reinterpret(Surface& source, Surface& dest,
 
 bool TextureRuntime::ClearTexture(Surface& surface, const VideoCore::TextureClear& clear) {
     renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{scheduler, GpuPass::Blit};
 
     const RecordParams params = {
         .aspect = surface.Aspect(),
@@ -314,53 +418,21 @@ bool TextureRuntime::ClearTexture(Surface& surface, const VideoCore::TextureClea
     };
 
     if (clear.texture_rect == surface.GetScaledRect()) {
-        scheduler.Record([params, clear](vk::CommandBuffer cmdbuf) {
-            const vk::ImageSubresourceRange range = {
-                .aspectMask = params.aspect,
-                .baseMipLevel = clear.texture_level,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = VK_REMAINING_ARRAY_LAYERS,
-            };
-
-            const vk::ImageMemoryBarrier pre_barrier = {
-                .srcAccessMask = params.src_access,
-                .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
-                .oldLayout = vk::ImageLayout::eGeneral,
-                .newLayout = vk::ImageLayout::eTransferDstOptimal,
-                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image = params.src_image,
-                .subresourceRange = range,
-            };
-
-            const vk::ImageMemoryBarrier post_barrier = {
-                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-                .dstAccessMask = params.src_access,
-                .oldLayout = vk::ImageLayout::eTransferDstOptimal,
-                .newLayout = vk::ImageLayout::eGeneral,
-                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image = params.src_image,
-                .subresourceRange = range,
-            };
-
-            cmdbuf.pipelineBarrier(params.pipeline_flags, vk::PipelineStageFlagBits::eTransfer,
-                                   vk::DependencyFlagBits::eByRegion, {}, {}, pre_barrier);
-
-            const bool is_color =
-                static_cast<bool>(params.aspect & vk::ImageAspectFlagBits::eColor);
-            if (is_color) {
-                cmdbuf.clearColorImage(params.src_image, vk::ImageLayout::eTransferDstOptimal,
-                                       MakeClearColorValue(clear.value.color), range);
-            } else {
-                cmdbuf.clearDepthStencilImage(params.src_image,
-                                              vk::ImageLayout::eTransferDstOptimal,
-                                              MakeClearDepthStencilValue(clear.value), range);
-            }
-
-            cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, params.pipeline_flags,
-                                   vk::DependencyFlagBits::eByRegion, {}, {}, post_barrier);
+        const bool is_color = static_cast<bool>(params.aspect & vk::ImageAspectFlagBits::eColor);
+        vk::ClearValue value{};
+        if (is_color) {
+            value.color = MakeClearColorValue(clear.value.color);
+        } else {
+            value.depthStencil = MakeClearDepthStencilValue(clear.value);
+        }
+        renderpass_cache.DeferClear(DeferredClear{
+            .image = params.src_image,
+            .aspect = params.aspect,
+            .pipeline_flags = params.pipeline_flags,
+            .access = params.src_access,
+            .value = value,
+            .extent = {clear.texture_rect.GetWidth(), clear.texture_rect.GetHeight()},
+            .level = clear.texture_level,
         });
         return true;
     }
@@ -454,6 +526,7 @@ void TextureRuntime::ClearTextureWithRenderpass(Surface& surface,
 bool TextureRuntime::CopyTextures(Surface& source, Surface& dest,
                                   std::span<const VideoCore::TextureCopy> copies) {
     renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{scheduler, GpuPass::Blit};
 
     const RecordParams params = {
         .aspect = source.Aspect(),
@@ -557,12 +630,12 @@ bool TextureRuntime::BlitTextures(Surface& source, Surface& dest,
                                   const VideoCore::TextureBlit& blit) {
     const bool is_depth_stencil = source.type == VideoCore::SurfaceType::DepthStencil;
     const auto& depth_traits = instance.GetTraits(source.pixel_format);
+    renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{scheduler, GpuPass::Blit};
     if (is_depth_stencil && !depth_traits.blit_support) {
         return blit_helper.BlitDepthStencil(source, dest, blit);
     }
 
-    renderpass_cache.EndRendering();
-
     const RecordParams params = {
         .aspect = source.Aspect(),
         .filter = MakeFilter(source.pixel_format),
@@ -670,6 +743,7 @@ void TextureRuntime::GenerateMipmaps(Surface& surface) {
     }
 
     renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{scheduler, GpuPass::TextureFilter};
 
     auto [width, height] = surface.RealExtent();
     const u32 levels = surface.levels;
@@ -696,6 +770,10 @@ bool TextureRuntime::NeedsConversion(VideoCore::PixelFormat format) const {
            traits.aspect != (vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil);
 }
 
+bool TextureRuntime::IsCustomFormatSupported(VideoCore::CustomPixelFormat format) const {
+    return instance.GetTraits(format).transfer_support;
+}
+
 Surface::Surface(TextureRuntime& runtime_, const VideoCore::SurfaceParams& params)
     : SurfaceBase{params}, runtime{&runtime_}, instance{&runtime_.GetInstance()},
       scheduler{&runtime_.GetScheduler()}, traits{instance->GetTraits(pixel_format)} {
@@ -721,14 +799,17 @@ Surface::Surface(TextureRuntime& runtime_, const VideoCore::SurfaceParams& param
     }
 
     const bool need_format_list = is_mutable && instance->IsImageFormatListSupported();
-    handles[0] = MakeHandle(instance, width, height, levels, texture_type, format, traits.usage,
-                            flags, traits.aspect, need_format_list, DebugName(false));
+    handles[0] = runtime->AllocateHandle(MakeImageKey(width, height, levels, texture_type, format,
+                                                      traits.usage, flags, traits.aspect,
+                                                      need_format_list),
+                                         DebugName(false));
     raw_images.emplace_back(handles[0].image);
 
     if (res_scale != 1) {
-        handles[1] =
-            MakeHandle(instance, GetScaledWidth(), GetScaledHeight(), levels, texture_type, format,
-                       traits.usage, flags, traits.aspect, need_format_list, DebugName(true));
+        handles[1] = runtime->AllocateHandle(
+            MakeImageKey(GetScaledWidth(), GetScaledHeight(), levels, texture_type, format,
+                         traits.usage, flags, traits.aspect, need_format_list),
+            DebugName(true));
         raw_images.emplace_back(handles[1].image);
     }
 
@@ -760,19 +841,24 @@ Surface::Surface(TextureRuntime& runtime_, const VideoCore::SurfaceBase& surface
     }
 
     const std::string debug_name = DebugName(false, true);
-    handles[0] = MakeHandle(instance, mat->width, mat->height, levels, texture_type, format,
-                            traits.usage, flags, traits.aspect, false, debug_name);
+    handles[0] = runtime->AllocateHandle(MakeImageKey(mat->width, mat->height, levels,
+                                                      texture_type, format, traits.usage, flags,
+                                                      traits.aspect, false),
+                                         debug_name);
     raw_images.emplace_back(handles[0].image);
 
     if (res_scale != 1) {
-        handles[1] = MakeHandle(instance, mat->width, mat->height, levels, texture_type,
-                                vk::Format::eR8G8B8A8Unorm, traits.usage, flags, traits.aspect,
-                                false, debug_name);
+        handles[1] = runtime->AllocateHandle(
+            MakeImageKey(mat->width, mat->height, levels, texture_type, vk::Format::eR8G8B8A8Unorm,
+                         traits.usage, flags, traits.aspect, false),
+            debug_name);
         raw_images.emplace_back(handles[1].image);
     }
     if (has_normal) {
-        handles[2] = MakeHandle(instance, mat->width, mat->height, levels, texture_type, format,
-                                traits.usage, flags, traits.aspect, false, debug_name);
+        handles[2] = runtime->AllocateHandle(MakeImageKey(mat->width, mat->height, levels,
+                                                          texture_type, format, traits.usage,
+                                                          flags, traits.aspect, false),
+                                             debug_name);
         raw_images.emplace_back(handles[2].image);
     }
 
@@ -792,19 +878,22 @@ Surface::~Surface() {
     if (!handles[0].image_view) {
         return;
     }
-    for (const auto& [alloc, image, image_view] : handles) {
-        if (image) {
-            vmaDestroyImage(instance->GetAllocator(), image, alloc);
+    // The garbage collector only destroys surfaces once the GPU is done with them, so their
+    // images can be handed to new surfaces right away
+    for (Handle& handle : handles) {
+        if (handle.image) {
+            runtime->RecycleHandle(std::move(handle));
         }
     }
     if (copy_handle.image_view) {
-        vmaDestroyImage(instance->GetAllocator(), copy_handle.image, copy_handle.alloc);
+        runtime->RecycleHandle(std::move(copy_handle));
     }
 }
 
 void Surface::Upload(const VideoCore::BufferTextureCopy& upload,
                      const VideoCore::StagingData& staging) {
     runtime->renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{*scheduler, GpuPass::Blit};
 
     const RecordParams params = {
         .aspect = Aspect(),
@@ -887,6 +976,45 @@ void Surface::Upload(const VideoCore::BufferTextureCopy& upload,
     }
 }
 
+bool Surface::UploadTiled(const VideoCore::BufferTextureCopy& upload,
+                          std::span<const u8> tiled_data) {
+    const bool converted = runtime->NeedsConversion(pixel_format);
+    if (!BlitHelper::CanDecodeTiled(pixel_format, converted)) {
+        return false;
+    }
+
+    const u32 width = upload.texture_rect.GetWidth();
+    const u32 height = upload.texture_rect.GetHeight();
+    const u32 tiled_size = static_cast<u32>(tiled_data.size());
+    const u32 output_offset = Common::AlignUp(tiled_size, 16);
+    const u32 output_size = width * height * GetInternalBytesPerPixel();
+    const u32 staging_size = output_offset + output_size;
+
+    const auto [data, offset, invalidate] = runtime->upload_buffer.Map(
+        staging_size, std::max<u64>(16, instance->StorageMinAlignment()));
+    std::memcpy(data, tiled_data.data(), tiled_size);
+
+    runtime->renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{*scheduler, GpuPass::Blit};
+    runtime->blit_helper.DecodeTiled(runtime->upload_buffer.Handle(), offset, staging_size,
+                                     output_offset, pixel_format, converted, width, height);
+
+    const VideoCore::StagingData staging = {
+        .size = staging_size,
+        .offset = offset,
+        .mapped = std::span{data, staging_size},
+    };
+    Upload(
+        {
+            .buffer_offset = offset + output_offset,
+            .buffer_size = output_size,
+            .texture_rect = upload.texture_rect,
+            .texture_level = upload.texture_level,
+        },
+        staging);
+    return true;
+}
+
 void Surface::UploadCustom(const VideoCore::Material* material, u32 level) {
     const u32 width = material->width;
     const u32 height = material->height;
@@ -911,7 +1039,7 @@ void Surface::UploadCustom(const VideoCore::Material* material, u32 level) {
             const vk::BufferImageCopy buffer_image_copy = {
                 .bufferOffset = offset,
                 .bufferRowLength = 0,
-                .bufferImageHeight = rect.GetHeight(),
+                .bufferImageHeight = 0,
                 .imageSubresource{
                     .aspectMask = params.aspect,
                     .mipLevel = level,
@@ -972,7 +1100,52 @@ void Surface::Download(const VideoCore::BufferTextureCopy& download,
         runtime->download_buffer.Commit(staging.size);
     });
 
+    RecordDownload(download);
+}
+
+bool Surface::DownloadTiled(const VideoCore::BufferTextureCopy& download, u32 start_offset,
+                            std::span<u8> tiled_dest) {
+    const bool converted = runtime->NeedsConversion(pixel_format);
+    if (!BlitHelper::CanEncodeTiled(pixel_format, converted)) {
+        return false;
+    }
+
+    const u32 width = download.texture_rect.GetWidth();
+    const u32 height = download.texture_rect.GetHeight();
+    const u32 linear_size = width * height * GetInternalBytesPerPixel();
+    const u32 output_offset = Common::AlignUp(linear_size, 16);
+    const u32 tiled_size = width * height * GetFormatBpp(pixel_format) / 8;
+    const u32 staging_size = output_offset + tiled_size;
+    if (staging_size > DOWNLOAD_BUFFER_SIZE || start_offset + tiled_dest.size() > tiled_size) {
+        return false;
+    }
+
+    const auto [data, offset, invalidate] = runtime->download_buffer.Map(
+        staging_size, std::max<u64>(16, instance->StorageMinAlignment()));
+
+    RecordDownload({
+        .buffer_offset = offset,
+        .buffer_size = linear_size,
+        .texture_rect = download.texture_rect,
+        .texture_level = download.texture_level,
+    });
+    {
+        const ScopedPassTiming timing{*scheduler, GpuPass::Blit};
+        runtime->blit_helper.EncodeTiled(runtime->download_buffer.Handle(), offset,
+                                         staging_size, output_offset, pixel_format, converted,
+                                         width, height);
+    }
+
+    scheduler->Finish();
+    runtime->download_buffer.Commit(staging_size);
+
+    std::memcpy(tiled_dest.data(), data + output_offset + start_offset, tiled_dest.size());
+    return true;
+}
+
+void Surface::RecordDownload(const VideoCore::BufferTextureCopy& download) {
     runtime->renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{*scheduler, GpuPass::Blit};
 
     if (pixel_format == PixelFormat::D24S8) {
         runtime->blit_helper.DepthToBuffer(*this, runtime->download_buffer.Handle(), download);
@@ -1068,11 +1241,13 @@ void Surface::ScaleUp(u32 new_scale) {
         flags |= vk::ImageCreateFlagBits::eMutableFormat;
     }
 
-    handles[1] =
-        MakeHandle(instance, GetScaledWidth(), GetScaledHeight(), levels, texture_type,
-                   traits.native, traits.usage, flags, traits.aspect, false, DebugName(true));
+    handles[1] = runtime->AllocateHandle(MakeImageKey(GetScaledWidth(), GetScaledHeight(), levels,
+                                                      texture_type, traits.native, traits.usage,
+                                                      flags, traits.aspect, false),
+                                         DebugName(true));
 
     runtime->renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{*scheduler, GpuPass::TextureFilter};
     scheduler->Record(
         [raw_images = std::array{Image()}, aspect = traits.aspect](vk::CommandBuffer cmdbuf) {
             const auto barriers = MakeInitBarriers(aspect, raw_images);
@@ -1102,6 +1277,23 @@ u32 Surface::GetInternalBytesPerPixel() const {
     return vk::blockSize(traits.native);
 }
 
+u64 Surface::MemoryUsage() const {
+    u64 usage = 0;
+    const auto add_allocation = [&](const Handle& handle) {
+        if (!handle.image) {
+            return;
+        }
+        VmaAllocationInfo info;
+        vmaGetAllocationInfo(instance->GetAllocator(), handle.alloc, &info);
+        usage += info.size;
+    };
+    for (const Handle& handle : handles) {
+        add_allocation(handle);
+    }
+    add_allocation(copy_handle);
+    return usage;
+}
+
 vk::AccessFlags Surface::AccessFlags() const noexcept {
     const bool is_color = static_cast<bool>(Aspect() & vk::ImageAspectFlagBits::eColor);
     const vk::AccessFlags attachment_flags =
@@ -1144,13 +1336,15 @@ vk::ImageView Surface::CopyImageView() noexcept {
         if (texture_type == VideoCore::TextureType::CubeMap) {
             flags |= vk::ImageCreateFlagBits::eCubeCompatible;
         }
-        copy_handle =
-            MakeHandle(instance, GetScaledWidth(), GetScaledHeight(), levels, texture_type,
-                       traits.native, traits.usage, flags, traits.aspect, false);
+        copy_handle = runtime->AllocateHandle(MakeImageKey(GetScaledWidth(), GetScaledHeight(),
+                                                           levels, texture_type, traits.native,
+                                                           traits.usage, flags, traits.aspect,
+                                                           false));
         copy_layout = vk::ImageLayout::eUndefined;
     }
 
     runtime->renderpass_cache.EndRendering();
+    const ScopedPassTiming timing{*scheduler, GpuPass::Blit};
 
     const RecordParams params = {
         .aspect = Aspect(),
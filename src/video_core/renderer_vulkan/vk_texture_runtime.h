@@ -6,6 +6,7 @@
 
 #include <deque>
 #include <span>
+#include <unordered_map>
 #include "video_core/rasterizer_cache/framebuffer_base.h"
 #include "video_core/rasterizer_cache/rasterizer_cache_base.h"
 #include "video_core/rasterizer_cache/surface_base.h"
@@ -26,10 +27,34 @@ class RenderManager;
 class Surface;
 class DescriptorUpdateQueue;
 
+/// Parameters an image was created with, images with equal keys are interchangeable
+struct ImageKey {
+    u32 width;
+    u32 height;
+    u32 levels;
+    VideoCore::TextureType type;
+    vk::Format format;
+    vk::ImageUsageFlags usage;
+    vk::ImageCreateFlags flags;
+    vk::ImageAspectFlags aspect;
+    bool need_format_list;
+
+    bool operator==(const ImageKey&) const = default;
+
+    u64 Hash() const noexcept;
+};
+
+struct ImageKeyHash {
+    std::size_t operator()(const ImageKey& key) const noexcept {
+        return key.Hash();
+    }
+};
+
 struct Handle {
     VmaAllocation alloc;
     vk::Image image;
     vk::UniqueImageView image_view;
+    ImageKey key;
 };
 
 /**
@@ -66,6 +91,14 @@ public:
     /// Maps an internal staging buffer of the provided size for pixel uploads/downloads
     VideoCore::StagingData FindStaging(u32 size, bool upload);
 
+    /// Downloads wait for the GPU when they are recorded, so they are never batched
+    u32 DownloadBatchSize() const {
+        return 0;
+    }
+
+    /// Downloads are finished by the time Download returns
+    void WaitDownloads() {}
+
     /// Attempts to reinterpret a rectangle of source to another rectangle of dest
     bool Reinterpret(Surface& source, Surface& dest, const VideoCore::TextureCopy& copy);
 
@@ -86,14 +119,39 @@ public:
     /// Generates mipmaps for all the available levels of the texture
     void GenerateMipmaps(Surface& surface);
 
+    /// Widens 8-bit indices in the buffer range to 16 bits on the GPU
+    void ExpandIndices(vk::Buffer buffer, u32 offset, u32 size, u32 output_offset,
+                       u32 num_indices) {
+        blit_helper.ExpandIndices(buffer, offset, size, output_offset, num_indices);
+    }
+
     /// Returns true if the provided pixel format needs convertion
     bool NeedsConversion(VideoCore::PixelFormat format) const;
 
+    /// Returns true if textures of the provided custom format can be created.
+    bool IsCustomFormatSupported(VideoCore::CustomPixelFormat format) const;
+
 private:
     /// Clears a partial texture rect using a clear rectangle
     void ClearTextureWithRenderpass(Surface& surface, const VideoCore::TextureClear& clear);
 
+    /// Returns an image matching the key, reusing a pooled one when available
+    Handle AllocateHandle(const ImageKey& key, std::string_view debug_name = {});
+
+    /// Returns the image of a destroyed surface to the pool, evicting the oldest pooled images
+    /// when the pool grows past its size cap
+    void RecycleHandle(Handle&& handle);
+
+    /// Destroys the pooled image that was recycled first
+    void EvictOldestHandle();
+
 private:
+    struct PooledHandle {
+        Handle handle;
+        u64 size;
+        u64 recycle_tick;
+    };
+
     const Instance& instance;
     Scheduler& scheduler;
     RenderManager& renderpass_cache;
@@ -101,6 +159,9 @@ private:
     StreamBuffer upload_buffer;
     StreamBuffer download_buffer;
     u32 num_swapchain_images;
+    std::unordered_map<ImageKey, std::deque<PooledHandle>, ImageKeyHash> image_pool;
+    u64 pooled_bytes{};
+    u64 recycle_tick{};
 };
 
 class Surface : public VideoCore::SurfaceBase {
@@ -149,6 +210,10 @@ public:
     /// Uploads pixel data in staging to a rectangle region of the surface texture
     void Upload(const VideoCore::BufferTextureCopy& upload, const VideoCore::StagingData& staging);
 
+    /// Uploads raw tiled guest data to a rectangle region of the surface texture, detiling it
+    /// on the GPU. Returns false if the surface format is not supported by the decoder.
+    bool UploadTiled(const VideoCore::BufferTextureCopy& upload, std::span<const u8> tiled_data);
+
     /// Uploads the custom material to the surface allocation.
     void UploadCustom(const VideoCore::Material* material, u32 level);
 
@@ -156,12 +221,21 @@ public:
     void Download(const VideoCore::BufferTextureCopy& download,
                   const VideoCore::StagingData& staging);
 
+    /// Downloads a rectangle region of the surface texture, tiling and converting it to the
+    /// guest format on the GPU. The tiled bytes starting at start_offset are copied to tiled_dest.
+    /// Returns false if the surface format is not supported by the encoder.
+    bool DownloadTiled(const VideoCore::BufferTextureCopy& download, u32 start_offset,
+                       std::span<u8> tiled_dest);
+
     /// Scales up the surface to match the new resolution scale.
     void ScaleUp(u32 new_scale);
 
     /// Returns the bpp of the internal surface format
     u32 GetInternalBytesPerPixel() const;
 
+    /// Returns the size of all host image allocations owned by the surface
+    u64 MemoryUsage() const;
+
     /// Returns the access flags indicative of the surface
     vk::AccessFlags AccessFlags() const noexcept;
 
@@ -172,6 +246,9 @@ private:
     /// Performs blit between the scaled/unscaled images
     void BlitScale(const VideoCore::TextureBlit& blit, bool up_scale);
 
+    /// Records a copy of a rectangle region of the surface texture to the download buffer
+    void RecordDownload(const VideoCore::BufferTextureCopy& download);
+
     /// Downloads scaled depth stencil data
     void DepthStencilDownload(const VideoCore::BufferTextureCopy& download,
                               const VideoCore::StagingData& staging);
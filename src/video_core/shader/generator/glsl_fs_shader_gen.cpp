@@ -12,7 +12,19 @@ using ProcTexCombiner = TexturingRegs::ProcTexCombiner;
 using ProcTexFilter = TexturingRegs::ProcTexFilter;
 using TextureType = Pica::TexturingRegs::TextureConfig::TextureType;
 
-constexpr static std::size_t RESERVE_SIZE = 8 * 1024 * 1024;
+constexpr static std::size_t RESERVE_SIZE = 64 * 1024;
+
+/// Returns the source buffer of the calling thread. It keeps its capacity between shaders, so the
+/// source of a new shader is appended without reallocating.
+static std::string& GetSourceBuffer() {
+    thread_local std::string buffer = [] {
+        std::string out;
+        out.reserve(RESERVE_SIZE);
+        return out;
+    }();
+    buffer.clear();
+    return buffer;
+}
 
 enum class Semantic : u32 {
     Position,
@@ -101,9 +113,357 @@ layout (binding = 2, std140) uniform fs_data {
 };
 )";
 
+constexpr static std::string_view FSUberShaderSource = R"(
+#define TEXTURE_PROJECTION_2D 3u
+#define TEXTURE_DISABLED 5u
+#define SOURCE_PREVIOUS 15u
+#define OPERATION_REPLACE 0u
+#define OPERATION_DOT3_RGBA 7u
+#define ALPHA_TEST_NEVER 0u
+#define SCISSOR_DISABLED 0u
+#define SCISSOR_INCLUDE 3u
+#define DEPTH_W_BUFFERING 0u
+#define FOG_MODE_FOG 5u
+
+layout (push_constant, std430) uniform uber_config {
+    uvec4 tev_stages[NUM_TEV_STAGES];
+    uint framebuffer_config;
+    uint texture_config;
+    uint texture_border_config;
+};
+
+layout(set = 0, binding = 3) uniform samplerBuffer texture_buffer_lut_lf;
+layout(set = 1, binding = 0) uniform sampler2D tex0;
+layout(set = 1, binding = 1) uniform sampler2D tex1;
+layout(set = 1, binding = 2) uniform sampler2D tex2;
+
+vec4 rounded_primary_color;
+vec4 tex_colors[3];
+vec4 combiner_buffer;
+vec4 combiner_output;
+
+float byteround(float x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec3 byteround(vec3 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec4 byteround(vec4 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+float getLod(vec2 coord) {
+    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
+    return log2(max(d.x, d.y));
+}
+
+vec4 applyBorder(int unit, vec2 coord, vec4 color) {
+    bool border_s = bitfieldExtract(texture_border_config, unit * 2, 1) != 0u &&
+                    (coord.x < 0 || coord.x > 1);
+    bool border_t = bitfieldExtract(texture_border_config, unit * 2 + 1, 1) != 0u &&
+                    (coord.y < 0 || coord.y > 1);
+    return border_s || border_t ? tex_border_color[unit] : color;
+}
+
+vec4 sampleTexUnit0() {
+    uint type = bitfieldExtract(texture_config, 0, 3);
+    if (type == TEXTURE_DISABLED) {
+        return vec4(0.0);
+    }
+    vec4 color = type == TEXTURE_PROJECTION_2D
+        ? textureProj(tex0, vec3(texcoord0, texcoord0_w))
+        : textureLod(tex0, texcoord0, getLod(texcoord0 * vec2(textureSize(tex0, 0))) +
+                     tex_lod_bias[0]);
+    return applyBorder(0, texcoord0, color);
+}
+
+vec4 sampleTexUnit1() {
+    vec4 color = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))) +
+                            tex_lod_bias[1]);
+    return applyBorder(1, texcoord1, color);
+}
+
+vec4 sampleTexUnit2() {
+    vec2 coord = bitfieldExtract(texture_config, 3, 1) != 0u ? texcoord1 : texcoord2;
+    vec4 color = textureLod(tex2, coord, getLod(coord * vec2(textureSize(tex2, 0))) +
+                            tex_lod_bias[2]);
+    return applyBorder(2, coord, color);
+}
+
+float getMultiplier(uint scale) {
+    return scale < 3u ? float(1u << scale) : 1.0;
+}
+
+bool isPassThroughTevStage(uvec4 stage) {
+    return bitfieldExtract(stage.z, 0, 4) == OPERATION_REPLACE &&
+           bitfieldExtract(stage.z, 16, 4) == OPERATION_REPLACE &&
+           bitfieldExtract(stage.x, 0, 4) == SOURCE_PREVIOUS &&
+           bitfieldExtract(stage.x, 16, 4) == SOURCE_PREVIOUS &&
+           bitfieldExtract(stage.y, 0, 4) == 0u && bitfieldExtract(stage.y, 12, 3) == 0u &&
+           getMultiplier(bitfieldExtract(stage.w, 0, 2)) == 1.0 &&
+           getMultiplier(bitfieldExtract(stage.w, 16, 2)) == 1.0;
+}
+
+vec4 getSource(uint source, int index) {
+    switch (source) {
+    case 0u:
+        return rounded_primary_color;
+    case 3u:
+        return tex_colors[0];
+    case 4u:
+        return tex_colors[1];
+    case 5u:
+        return tex_colors[2];
+    case 13u:
+        return combiner_buffer;
+    case 14u:
+        return const_color[index];
+    case 15u:
+        return combiner_output;
+    default:
+        // The fragment lighting and procedural texture sources are never enabled here
+        return vec4(0.0);
+    }
+}
+
+vec3 getColorResult(uvec4 stage, int index, int slot) {
+    uint source = bitfieldExtract(stage.x, slot * 4, 4);
+    if (index == 0 && source == SOURCE_PREVIOUS) {
+        source = bitfieldExtract(stage.x, 8, 4);
+    }
+    vec4 value = getSource(source, index);
+    uint modifier = bitfieldExtract(stage.y, slot * 4, 4);
+    vec3 result;
+    switch (modifier & ~1u) {
+    case 0u:
+        result = value.rgb;
+        break;
+    case 2u:
+        result = value.aaa;
+        break;
+    case 4u:
+        result = value.rrr;
+        break;
+    case 8u:
+        result = value.ggg;
+        break;
+    case 12u:
+        result = value.bbb;
+        break;
+    default:
+        return vec3(0.0);
+    }
+    return (modifier & 1u) != 0u ? vec3(1.0) - result : result;
+}
+
+float getAlphaResult(uvec4 stage, int index, int slot) {
+    uint source = bitfieldExtract(stage.x, 16 + slot * 4, 4);
+    if (index == 0 && source == SOURCE_PREVIOUS) {
+        source = bitfieldExtract(stage.x, 24, 4);
+    }
+    vec4 value = getSource(source, index);
+    uint modifier = bitfieldExtract(stage.y, 12 + slot * 4, 3);
+    float result;
+    switch (modifier >> 1) {
+    case 0u:
+        result = value.a;
+        break;
+    case 1u:
+        result = value.r;
+        break;
+    case 2u:
+        result = value.g;
+        break;
+    default:
+        result = value.b;
+        break;
+    }
+    return (modifier & 1u) != 0u ? 1.0 - result : result;
+}
+
+vec3 combineColor(uint operation, vec3 results_1, vec3 results_2, vec3 results_3) {
+    vec3 result;
+    switch (operation) {
+    case 0u:
+        result = results_1;
+        break;
+    case 1u:
+        result = results_1 * results_2;
+        break;
+    case 2u:
+        result = results_1 + results_2;
+        break;
+    case 3u:
+        result = results_1 + results_2 - vec3(0.5);
+        break;
+    case 4u:
+        result = mix(results_2, results_1, results_3);
+        break;
+    case 5u:
+        result = results_1 - results_2;
+        break;
+    case 6u:
+    case 7u:
+        result = vec3(dot(results_1 - vec3(0.5), results_2 - vec3(0.5)) * 4.0);
+        break;
+    case 8u:
+        result = fma(results_1, results_2, results_3);
+        break;
+    case 9u:
+        result = min(results_1 + results_2, vec3(1.0)) * results_3;
+        break;
+    default:
+        result = vec3(0.0);
+        break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float combineAlpha(uint operation, float results_1, float results_2, float results_3) {
+    float result;
+    switch (operation) {
+    case 0u:
+        result = results_1;
+        break;
+    case 1u:
+        result = results_1 * results_2;
+        break;
+    case 2u:
+        result = results_1 + results_2;
+        break;
+    case 3u:
+        result = results_1 + results_2 - 0.5;
+        break;
+    case 4u:
+        result = mix(results_2, results_1, results_3);
+        break;
+    case 5u:
+        result = results_1 - results_2;
+        break;
+    case 8u:
+        result = fma(results_1, results_2, results_3);
+        break;
+    case 9u:
+        result = min(results_1 + results_2, 1.0) * results_3;
+        break;
+    default:
+        result = 0.0;
+        break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+void runTevStage(int index, uvec4 stage) {
+    uint color_op = bitfieldExtract(stage.z, 0, 4);
+    vec3 color_output = byteround(combineColor(color_op, getColorResult(stage, index, 0),
+                                               getColorResult(stage, index, 1),
+                                               getColorResult(stage, index, 2)));
+    float alpha_output;
+    if (color_op == OPERATION_DOT3_RGBA) {
+        // result of Dot3_RGBA operation is also placed to the alpha component
+        alpha_output = color_output[0];
+    } else {
+        alpha_output = byteround(combineAlpha(bitfieldExtract(stage.z, 16, 4),
+                                              getAlphaResult(stage, index, 0),
+                                              getAlphaResult(stage, index, 1),
+                                              getAlphaResult(stage, index, 2)));
+    }
+    float color_multiplier = getMultiplier(bitfieldExtract(stage.w, 0, 2));
+    float alpha_multiplier = getMultiplier(bitfieldExtract(stage.w, 16, 2));
+    combiner_output = vec4(clamp(color_output * color_multiplier, vec3(0.0), vec3(1.0)),
+                           clamp(alpha_output * alpha_multiplier, 0.0, 1.0));
+}
+
+bool alphaTestFails(uint func, int alpha) {
+    switch (func) {
+    case 2u:
+        return alpha != alphatest_ref;
+    case 3u:
+        return alpha == alphatest_ref;
+    case 4u:
+        return alpha >= alphatest_ref;
+    case 5u:
+        return alpha > alphatest_ref;
+    case 6u:
+        return alpha <= alphatest_ref;
+    case 7u:
+        return alpha < alphatest_ref;
+    default:
+        return false;
+    }
+}
+
+void main() {
+    uint alpha_test_func = bitfieldExtract(framebuffer_config, 0, 3);
+    if (alpha_test_func == ALPHA_TEST_NEVER) {
+        discard;
+    }
+
+    uint scissor_mode = bitfieldExtract(framebuffer_config, 3, 2);
+    if (scissor_mode != SCISSOR_DISABLED) {
+        bool inside = gl_FragCoord.x >= float(scissor_x1) && gl_FragCoord.y >= float(scissor_y1) &&
+                      gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+        if (inside != (scissor_mode == SCISSOR_INCLUDE)) {
+            discard;
+        }
+    }
+
+#ifdef MINUS_ONE_TO_ONE_RANGE
+    float z_over_w = -2.0 * gl_FragCoord.z + 1.0;
+#else
+    float z_over_w = -gl_FragCoord.z;
+#endif
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (bitfieldExtract(framebuffer_config, 5, 1) == DEPTH_W_BUFFERING) {
+        depth /= gl_FragCoord.w;
+    }
+
+    rounded_primary_color = byteround(primary_color);
+    tex_colors[0] = sampleTexUnit0();
+    tex_colors[1] = sampleTexUnit1();
+    tex_colors[2] = sampleTexUnit2();
+
+    combiner_buffer = vec4(0.0);
+    combiner_output = vec4(0.0);
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    uint buffer_input = bitfieldExtract(texture_config, 4, 8);
+    for (int i = 0; i < NUM_TEV_STAGES; i++) {
+        uvec4 stage = tev_stages[i];
+        if (!isPassThroughTevStage(stage)) {
+            runTevStage(i, stage);
+        }
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4 && bitfieldExtract(buffer_input, i, 1) != 0u) {
+            next_combiner_buffer.rgb = combiner_output.rgb;
+        }
+        if (i < 4 && bitfieldExtract(buffer_input, i + 4, 1) != 0u) {
+            next_combiner_buffer.a = combiner_output.a;
+        }
+    }
+
+    if (alphaTestFails(alpha_test_func, int(combiner_output.a * 255.0))) {
+        discard;
+    }
+
+    if (bitfieldExtract(texture_config, 12, 3) == FOG_MODE_FOG) {
+        bool fog_flip = bitfieldExtract(texture_config, 15, 1) != 0u;
+        float fog_index = (fog_flip ? 1.0 - depth : depth) * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_lf, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        combiner_output.rgb = mix(fog_color.rgb, combiner_output.rgb, fog_factor);
+    }
+
+    gl_FragDepth = depth;
+    color = byteround(combiner_output);
+}
+)";
+
 FragmentModule::FragmentModule(const FSConfig& config_, const Profile& profile_)
-    : config{config_}, profile{profile_} {
-    out.reserve(RESERVE_SIZE);
+    : config{config_}, profile{profile_}, out{GetSourceBuffer()} {
     DefineExtensions();
     DefineInterface();
     if (profile.is_vulkan) {
@@ -1757,4 +2117,23 @@ std::string GenerateFragmentShader(const FSConfig& config, const Profile& profil
     return module.Generate();
 }
 
+std::string GenerateFragmentUberShader(const Profile& profile) {
+    ASSERT_MSG(profile.is_vulkan, "The fragment ubershader reads its config from push constants");
+    std::string out;
+    if (profile.has_minus_one_to_one_range) {
+        out += "#define MINUS_ONE_TO_ONE_RANGE\n";
+    }
+    out += fmt::format("layout (location = {}) in vec4 primary_color;\n"
+                       "layout (location = {}) in vec2 texcoord0;\n"
+                       "layout (location = {}) in vec2 texcoord1;\n"
+                       "layout (location = {}) in vec2 texcoord2;\n"
+                       "layout (location = {}) in float texcoord0_w;\n"
+                       "layout (location = 0) out vec4 color;\n",
+                       Semantic::Color, Semantic::Texcoord0, Semantic::Texcoord1,
+                       Semantic::Texcoord2, Semantic::Texcoord0_W);
+    out += FSUniformBlockDef;
+    out += FSUberShaderSource;
+    return out;
+}
+
 } // namespace Pica::Shader::Generator::GLSL
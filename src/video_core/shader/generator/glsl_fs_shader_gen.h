@@ -85,7 +85,7 @@ private:
 private:
     const FSConfig& config;
     const Profile& profile;
-    std::string out;
+    std::string& out;
     bool use_blend_fallback{};
     bool use_fragment_shader_interlock{};
     bool use_fragment_shader_barycentric{};
@@ -99,4 +99,11 @@ private:
  */
 std::string GenerateFragmentShader(const FSConfig& config, const Profile& profile);
 
+/**
+ * Generates the GLSL source of the Vulkan fragment ubershader, which interprets the FSUberConfig
+ * in its push constants so it can draw with any config that does not use lighting, procedural
+ * textures or shadows while the specialized shader of the config is compiled.
+ */
+std::string GenerateFragmentUberShader(const Profile& profile);
+
 } // namespace Pica::Shader::Generator::GLSL
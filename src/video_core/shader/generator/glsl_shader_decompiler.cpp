@@ -5,13 +5,12 @@
 #include <map>
 #include <set>
 #include <string>
-#include <tuple>
-#include <utility>
 #include <fmt/format.h>
 #include <nihstro/shader_bytecode.h>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "video_core/shader/generator/glsl_shader_decompiler.h"
+#include "video_core/shader/generator/pica_control_flow.h"
 
 namespace Pica::Shader::Generator::GLSL {
 
@@ -22,181 +21,6 @@ using nihstro::RegisterType;
 using nihstro::SourceRegister;
 using nihstro::SwizzlePattern;
 
-constexpr u32 PROGRAM_END = MAX_PROGRAM_CODE_LENGTH;
-
-class DecompileFail : public std::runtime_error {
-public:
-    using std::runtime_error::runtime_error;
-};
-
-/// Describes the behaviour of code path of a given entry point and a return point.
-enum class ExitMethod {
-    Undetermined, ///< Internal value. Only occur when analyzing JMP loop.
-    AlwaysReturn, ///< All code paths reach the return point.
-    Conditional,  ///< Code path reaches the return point or an END instruction conditionally.
-    AlwaysEnd,    ///< All code paths reach a END instruction.
-};
-
-/// A subroutine is a range of code refereced by a CALL, IF or LOOP instruction.
-struct Subroutine {
-    /// Generates a name suitable for GLSL source code.
-    std::string GetName() const {
-        return "sub_" + std::to_string(begin) + "_" + std::to_string(end);
-    }
-
-    u32 begin;              ///< Entry point of the subroutine.
-    u32 end;                ///< Return point of the subroutine.
-    ExitMethod exit_method; ///< Exit method of the subroutine.
-    std::set<u32> labels;   ///< Addresses refereced by JMP instructions.
-
-    bool operator<(const Subroutine& rhs) const {
-        return std::tie(begin, end) < std::tie(rhs.begin, rhs.end);
-    }
-};
-
-/// Analyzes shader code and produces a set of subroutines.
-class ControlFlowAnalyzer {
-public:
-    ControlFlowAnalyzer(const ProgramCode& program_code, u32 main_offset)
-        : program_code(program_code) {
-
-        // Recursively finds all subroutines.
-        const Subroutine& program_main = AddSubroutine(main_offset, PROGRAM_END);
-        if (program_main.exit_method != ExitMethod::AlwaysEnd)
-            throw DecompileFail("Program does not always end");
-    }
-
-    std::set<Subroutine> MoveSubroutines() {
-        return std::move(subroutines);
-    }
-
-private:
-    const ProgramCode& program_code;
-    std::set<Subroutine> subroutines;
-    std::map<std::pair<u32, u32>, ExitMethod> exit_method_map;
-
-    /// Adds and analyzes a new subroutine if it is not added yet.
-    const Subroutine& AddSubroutine(u32 begin, u32 end) {
-        auto iter = subroutines.find(Subroutine{begin, end});
-        if (iter != subroutines.end())
-            return *iter;
-
-        Subroutine subroutine{begin, end};
-        subroutine.exit_method = Scan(begin, end, subroutine.labels);
-        if (subroutine.exit_method == ExitMethod::Undetermined)
-            throw DecompileFail("Recursive function detected");
-        return *subroutines.insert(std::move(subroutine)).first;
-    }
-
-    /// Merges exit method of two parallel branches.
-    static ExitMethod ParallelExit(ExitMethod a, ExitMethod b) {
-        if (a == ExitMethod::Undetermined) {
-            return b;
-        }
-        if (b == ExitMethod::Undetermined) {
-            return a;
-        }
-        if (a == b) {
-            return a;
-        }
-        return ExitMethod::Conditional;
-    }
-
-    /// Cascades exit method of two blocks of code.
-    static ExitMethod SeriesExit(ExitMethod a, ExitMethod b) {
-        // This should be handled before evaluating b.
-        DEBUG_ASSERT(a != ExitMethod::AlwaysEnd);
-
-        if (a == ExitMethod::Undetermined) {
-            return ExitMethod::Undetermined;
-        }
-
-        if (a == ExitMethod::AlwaysReturn) {
-            return b;
-        }
-
-        if (b == ExitMethod::Undetermined || b == ExitMethod::AlwaysEnd) {
-            return ExitMethod::AlwaysEnd;
-        }
-
-        return ExitMethod::Conditional;
-    }
-
-    /// Scans a range of code for labels and determines the exit method.
-    ExitMethod Scan(u32 begin, u32 end, std::set<u32>& labels) {
-        auto [iter, inserted] =
-            exit_method_map.emplace(std::make_pair(begin, end), ExitMethod::Undetermined);
-        ExitMethod& exit_method = iter->second;
-        if (!inserted)
-            return exit_method;
-
-        for (u32 offset = begin; offset != end && offset != PROGRAM_END; ++offset) {
-            const Instruction instr = {program_code[offset]};
-            switch (instr.opcode.Value()) {
-            case OpCode::Id::END: {
-                return exit_method = ExitMethod::AlwaysEnd;
-            }
-            case OpCode::Id::JMPC:
-            case OpCode::Id::JMPU: {
-                labels.insert(instr.flow_control.dest_offset);
-                ExitMethod no_jmp = Scan(offset + 1, end, labels);
-                ExitMethod jmp = Scan(instr.flow_control.dest_offset, end, labels);
-                return exit_method = ParallelExit(no_jmp, jmp);
-            }
-            case OpCode::Id::CALL: {
-                auto& call = AddSubroutine(instr.flow_control.dest_offset,
-                                           instr.flow_control.dest_offset +
-                                               instr.flow_control.num_instructions);
-                if (call.exit_method == ExitMethod::AlwaysEnd)
-                    return exit_method = ExitMethod::AlwaysEnd;
-                ExitMethod after_call = Scan(offset + 1, end, labels);
-                return exit_method = SeriesExit(call.exit_method, after_call);
-            }
-            case OpCode::Id::LOOP: {
-                auto& loop = AddSubroutine(offset + 1, instr.flow_control.dest_offset + 1);
-                if (loop.exit_method == ExitMethod::AlwaysEnd)
-                    return exit_method = ExitMethod::AlwaysEnd;
-                ExitMethod after_loop = Scan(instr.flow_control.dest_offset + 1, end, labels);
-                return exit_method = SeriesExit(loop.exit_method, after_loop);
-            }
-            case OpCode::Id::CALLC:
-            case OpCode::Id::CALLU: {
-                auto& call = AddSubroutine(instr.flow_control.dest_offset,
-                                           instr.flow_control.dest_offset +
-                                               instr.flow_control.num_instructions);
-                ExitMethod after_call = Scan(offset + 1, end, labels);
-                return exit_method = SeriesExit(
-                           ParallelExit(call.exit_method, ExitMethod::AlwaysReturn), after_call);
-            }
-            case OpCode::Id::IFU:
-            case OpCode::Id::IFC: {
-                auto& if_sub = AddSubroutine(offset + 1, instr.flow_control.dest_offset);
-                ExitMethod else_method;
-                if (instr.flow_control.num_instructions != 0) {
-                    auto& else_sub = AddSubroutine(instr.flow_control.dest_offset,
-                                                   instr.flow_control.dest_offset +
-                                                       instr.flow_control.num_instructions);
-                    else_method = else_sub.exit_method;
-                } else {
-                    else_method = ExitMethod::AlwaysReturn;
-                }
-
-                ExitMethod both = ParallelExit(if_sub.exit_method, else_method);
-                if (both == ExitMethod::AlwaysEnd)
-                    return exit_method = ExitMethod::AlwaysEnd;
-                ExitMethod after_call =
-                    Scan(instr.flow_control.dest_offset + instr.flow_control.num_instructions, end,
-                         labels);
-                return exit_method = SeriesExit(both, after_call);
-            }
-            default:
-                break;
-            }
-        }
-        return exit_method = ExitMethod::AlwaysReturn;
-    }
-};
-
 class ShaderWriter {
 public:
     // Forwards all arguments directly to libfmt.
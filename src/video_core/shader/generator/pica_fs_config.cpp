@@ -190,4 +190,14 @@ FSConfig::FSConfig(const Pica::RegsInternal& regs, const UserConfig& user_, cons
     : framebuffer{regs, profile}, texture{regs.texturing, profile}, lighting{regs.lighting},
       proctex{regs.texturing}, user{user_} {}
 
+FSUberConfig::FSUberConfig(const FSConfig& config)
+    : tev_stages{config.texture.tev_stages}, framebuffer{config.framebuffer.raw},
+      texture{config.texture.raw} {
+    for (u32 i = 0; i < 3; i++) {
+        const auto& border = config.texture.texture_border_color[i];
+        texture_border |= border.enable_s.Value() << (i * 2);
+        texture_border |= border.enable_t.Value() << (i * 2 + 1);
+    }
+}
+
 } // namespace Pica::Shader
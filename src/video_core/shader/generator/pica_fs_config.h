@@ -180,6 +180,19 @@ struct FSConfig {
                framebuffer.shadow_rendering.Value();
     }
 
+    /// Returns true if the config uses features the fragment ubershader does not interpret
+    [[nodiscard]] bool UsesUberShaderIncompatibleConfig() const {
+        using TextureType = Pica::TexturingRegs::TextureConfig::TextureType;
+        const auto texture0_type = texture.texture0_type.Value();
+        const bool texture0_2d = texture0_type == TextureType::Texture2D ||
+                                 texture0_type == TextureType::Projection2D ||
+                                 texture0_type == TextureType::Disabled;
+        return !texture0_2d || lighting.enable || proctex.enable ||
+               framebuffer.shadow_rendering.Value() ||
+               texture.fog_mode == Pica::TexturingRegs::FogMode::Gas ||
+               framebuffer.logic_op != Pica::FramebufferRegs::LogicOp::Copy || EmulateBlend();
+    }
+
     bool operator==(const FSConfig& other) const noexcept {
         return std::memcmp(this, &other, sizeof(FSConfig)) == 0;
     }
@@ -195,6 +208,22 @@ struct FSConfig {
     UserConfig user;
 };
 
+/**
+ * The state of an FSConfig the fragment ubershader reads at runtime instead of having it compiled
+ * in, laid out as the push constant block of the ubershader.
+ */
+struct FSUberConfig {
+    FSUberConfig() = default;
+    explicit FSUberConfig(const FSConfig& config);
+
+    std::array<TevStageConfigRaw, 6> tev_stages{};
+    u32 framebuffer{};    ///< FramebufferConfig::raw
+    u32 texture{};        ///< TextureConfig::raw
+    u32 texture_border{}; ///< Two bits per texture unit, S and T
+    u32 padding{};
+};
+static_assert(sizeof(FSUberConfig) == 112, "FSUberConfig must fit in 128 bytes of push constants");
+
 } // namespace Pica::Shader
 
 namespace std {
@@ -7,7 +7,8 @@
 
 namespace Pica::Shader::Generator {
 
-void VSPicaUniformData::SetFromRegs(const Pica::ShaderSetup& setup) {
+void VSPicaUniformData::SetFromRegs(const Pica::ShaderSetup& setup, u32 float_begin,
+                                    u32 float_end) {
     b = 0;
     for (u32 j = 0; j < setup.uniforms.b.size(); j++) {
         b |= setup.uniforms.b[j] << j;
@@ -16,7 +17,7 @@ void VSPicaUniformData::SetFromRegs(const Pica::ShaderSetup& setup) {
         const auto& value = setup.uniforms.i[j];
         i[j] = Common::MakeVec<u32>(value.x, value.y, value.z, value.w);
     }
-    for (u32 j = 0; j < setup.uniforms.f.size(); j++) {
+    for (u32 j = float_begin; j < float_end; j++) {
         const auto& value = setup.uniforms.f[j];
         f[j] = Common::MakeVec<f32>(value.x.ToFloat32(), value.y.ToFloat32(), value.z.ToFloat32(),
                                     value.w.ToFloat32());
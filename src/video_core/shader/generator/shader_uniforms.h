@@ -83,7 +83,9 @@ static_assert(sizeof(VSUniformData) < 16384,
  * NOTE: the same rule from UniformData also applies here.
  */
 struct VSPicaUniformData {
-    void SetFromRegs(const ShaderSetup& setup);
+    /// Converts the bool and int uniforms of the setup, and its float uniforms in [float_begin,
+    /// float_end). The other float uniforms keep their previous value.
+    void SetFromRegs(const ShaderSetup& setup, u32 float_begin, u32 float_end);
 
     u32 b;
     alignas(16) std::array<Common::Vec4u, 4> i;
@@ -0,0 +1,1254 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <optional>
+#include <boost/container/small_vector.hpp>
+#include <fmt/format.h>
+#include <nihstro/shader_bytecode.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/pica/regs_rasterizer.h"
+#include "video_core/shader/generator/pica_control_flow.h"
+#include "video_core/shader/generator/shader_gen.h"
+#include "video_core/shader/generator/spv_fs_shader_gen.h"
+#include "video_core/shader/generator/spv_vs_shader_gen.h"
+
+namespace Pica::Shader::Generator::SPIRV {
+
+using nihstro::DestRegister;
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::RegisterType;
+using nihstro::SourceRegister;
+using nihstro::SwizzlePattern;
+using VSOutputAttributes = Pica::RasterizerRegs::VSOutputAttributes;
+
+constexpr u32 SPIRV_VERSION_1_3 = 0x00010300;
+constexpr u32 NUM_REGISTERS = 16;
+
+/**
+ * Emits a SPIR-V vertex shader from a PICA vertex program. The structure mirrors the GLSL
+ * decompiler: every subroutine becomes a function returning whether END was reached, and
+ * subroutines with JMP targets dispatch on a jump table inside an infinite loop.
+ */
+class VertexModule : public Sirit::Module {
+public:
+    explicit VertexModule(const std::set<Subroutine>& subroutines_, const ShaderSetup& setup,
+                          const PicaVSConfig& config_)
+        : Sirit::Module{SPIRV_VERSION_1_3}, subroutines{subroutines_},
+          program_code{setup.GetProgramCode()}, swizzle_data{setup.GetSwizzleData()},
+          state{config_.state} {
+        DefineArithmeticTypes();
+        DefineUniformStructs();
+        DefineInterface();
+    }
+
+    void Generate() {
+        DefineSubroutine(GetSubroutine(state.main_offset, PROGRAM_END));
+        DefineEntryPoint();
+    }
+
+private:
+    /// Gets the Subroutine object corresponding to the specified address.
+    const Subroutine& GetSubroutine(u32 begin, u32 end) const {
+        auto iter = subroutines.find(Subroutine{begin, end});
+        ASSERT(iter != subroutines.end());
+        return *iter;
+    }
+
+    /**
+     * Returns the offset of the instruction executed after the one at offset, with the same rules
+     * as CompileInstr, and records the subroutines called by the instruction.
+     */
+    u32 ScanInstr(u32 offset, std::vector<const Subroutine*>& callees) const {
+        const Instruction instr = {program_code[offset]};
+        const u32 dest_offset = instr.flow_control.dest_offset;
+        const u32 num_instructions = instr.flow_control.num_instructions;
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            return PROGRAM_END;
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU: {
+            const Subroutine& call_sub = GetSubroutine(dest_offset, dest_offset + num_instructions);
+            callees.push_back(&call_sub);
+            if (instr.opcode.Value() == OpCode::Id::CALL &&
+                call_sub.exit_method == ExitMethod::AlwaysEnd) {
+                return PROGRAM_END;
+            }
+            return offset + 1;
+        }
+        case OpCode::Id::IFC:
+        case OpCode::Id::IFU: {
+            const Subroutine& if_sub = GetSubroutine(offset + 1, dest_offset);
+            callees.push_back(&if_sub);
+            if (num_instructions == 0) {
+                return dest_offset;
+            }
+            const Subroutine& else_sub = GetSubroutine(dest_offset, dest_offset + num_instructions);
+            callees.push_back(&else_sub);
+            if (if_sub.exit_method == ExitMethod::AlwaysEnd &&
+                else_sub.exit_method == ExitMethod::AlwaysEnd) {
+                return PROGRAM_END;
+            }
+            return dest_offset + num_instructions;
+        }
+        case OpCode::Id::LOOP: {
+            const Subroutine& loop_sub = GetSubroutine(offset + 1, dest_offset + 1);
+            callees.push_back(&loop_sub);
+            if (loop_sub.exit_method == ExitMethod::AlwaysEnd) {
+                return PROGRAM_END;
+            }
+            return dest_offset + 1;
+        }
+        default:
+            return offset + 1;
+        }
+    }
+
+    /// Scans a range of instructions, returns the offset where CompileRange would stop.
+    u32 ScanRange(u32 begin, u32 end, std::vector<const Subroutine*>& callees) const {
+        u32 program_counter;
+        for (program_counter = begin; program_counter < (begin > end ? PROGRAM_END : end);) {
+            program_counter = ScanInstr(program_counter, callees);
+        }
+        return program_counter;
+    }
+
+    /**
+     * Returns the jump table of a subroutine with labels. Besides the JMP targets it contains the
+     * entry point, and the return point of any IF/LOOP block a label range ends in.
+     */
+    std::set<u32> GetJumpTable(const Subroutine& subroutine,
+                               std::vector<const Subroutine*>& callees) const {
+        std::set<u32> labels = subroutine.labels;
+        labels.insert(subroutine.begin);
+        for (auto it = labels.begin(); it != labels.end(); ++it) {
+            const auto next_it = std::next(it);
+            const u32 next_label = next_it == labels.end() ? subroutine.end : *next_it;
+            const u32 compile_end = ScanRange(*it, next_label, callees);
+            if (compile_end > next_label && compile_end != PROGRAM_END) {
+                labels.insert(compile_end);
+            }
+        }
+        return labels;
+    }
+
+    /// Defines the function of a subroutine, after the functions of all the subroutines it calls.
+    void DefineSubroutine(const Subroutine& subroutine) {
+        if (functions.contains(&subroutine)) {
+            return;
+        }
+
+        std::vector<const Subroutine*> callees;
+        std::set<u32> labels;
+        if (subroutine.labels.empty()) {
+            ScanRange(subroutine.begin, subroutine.end, callees);
+        } else {
+            labels = GetJumpTable(subroutine, callees);
+        }
+        for (const Subroutine* callee : callees) {
+            DefineSubroutine(*callee);
+        }
+
+        const Id function{
+            OpFunction(bool_id, spv::FunctionControlMask::MaskNone, TypeFunction(bool_id))};
+        Name(function, subroutine.GetName());
+        functions.emplace(&subroutine, function);
+        BeginBlock(OpLabel());
+
+        if (labels.empty()) {
+            const u32 compile_end = CompileRange(subroutine.begin, subroutine.end);
+            if (!terminated) {
+                if (compile_end == PROGRAM_END) {
+                    Unreachable();
+                } else {
+                    Return(false);
+                }
+            }
+        } else {
+            CompileJumpTable(subroutine, labels);
+        }
+
+        OpFunctionEnd();
+    }
+
+    /// Emits the jump table dispatch loop of a subroutine with labels.
+    void CompileJumpTable(const Subroutine& subroutine, const std::set<u32>& labels) {
+        jmp_to = DefineVar(u32_id, spv::StorageClass::Private);
+        Name(jmp_to, fmt::format("jmp_to_{}_{}", subroutine.begin, subroutine.end));
+        OpStore(jmp_to, ConstU32(subroutine.begin));
+
+        const Id loop_header{OpLabel()};
+        const Id dispatch_label{OpLabel()};
+        const Id loop_continue{OpLabel()};
+        const Id loop_merge{OpLabel()};
+        const Id default_label{OpLabel()};
+        switch_merge = OpLabel();
+        Branch(loop_header);
+
+        BeginBlock(loop_header);
+        OpLoopMerge(loop_merge, loop_continue, spv::LoopControlMask::MaskNone);
+        Branch(dispatch_label);
+
+        jump_labels.clear();
+        boost::container::small_vector<Sirit::Literal, 16> literals;
+        boost::container::small_vector<Id, 16> case_labels;
+        for (const u32 label : labels) {
+            const Id case_label{OpLabel()};
+            jump_labels.emplace(label, case_label);
+            literals.push_back(label);
+            case_labels.push_back(case_label);
+        }
+
+        BeginBlock(dispatch_label);
+        const Id selector{OpLoad(u32_id, jmp_to)};
+        OpSelectionMerge(switch_merge, spv::SelectionControlMask::MaskNone);
+        OpSwitch(selector, default_label, literals, case_labels);
+        terminated = true;
+
+        for (auto it = labels.begin(); it != labels.end(); ++it) {
+            const auto next_it = std::next(it);
+            const u32 next_label = next_it == labels.end() ? subroutine.end : *next_it;
+
+            BeginBlock(jump_labels.at(*it));
+            const u32 compile_end = CompileRange(*it, next_label);
+            if (terminated) {
+                continue;
+            }
+            if (compile_end == PROGRAM_END) {
+                Unreachable();
+            } else if (compile_end > next_label) {
+                // This happens only when there is a label inside a IF/LOOP block
+                Jump(compile_end);
+            } else if (next_it != labels.end()) {
+                // Falling through to the next label
+                Jump(next_label);
+            } else {
+                Return(false);
+            }
+        }
+
+        BeginBlock(default_label);
+        Return(false);
+
+        BeginBlock(switch_merge);
+        Branch(loop_continue);
+
+        BeginBlock(loop_continue);
+        Branch(loop_header);
+
+        // The loop can only be left by returning from the function.
+        BeginBlock(loop_merge);
+        Unreachable();
+
+        jump_labels.clear();
+    }
+
+    /// Sets the jump target of the current jump table and breaks out of its dispatch.
+    void Jump(u32 target) {
+        if (!jump_labels.contains(target)) {
+            // Mirror the default case of the jump table, which leaves the subroutine.
+            Return(false);
+            return;
+        }
+        OpStore(jmp_to, ConstU32(target));
+        Branch(switch_merge);
+    }
+
+    /**
+     * Compiles a range of instructions from PICA to SPIR-V.
+     * @param begin the offset of the starting instruction.
+     * @param end the offset where the compilation should stop (exclusive).
+     * @return the offset of the next instruction to compile. PROGRAM_END if the program terminates.
+     */
+    u32 CompileRange(u32 begin, u32 end) {
+        u32 program_counter;
+        for (program_counter = begin; program_counter < (begin > end ? PROGRAM_END : end);) {
+            program_counter = CompileInstr(program_counter);
+        }
+        return program_counter;
+    }
+
+    /**
+     * Compiles a single instruction from PICA to SPIR-V.
+     * @param offset the offset of the PICA shader instruction.
+     * @return the offset of the next instruction to execute. Usually it is the current offset + 1.
+     * If the current instruction is IF or LOOP, the next instruction is after the IF or LOOP block.
+     * If the current instruction always terminates the program, returns PROGRAM_END.
+     */
+    u32 CompileInstr(u32 offset) {
+        const Instruction instr = {program_code[offset]};
+
+        const std::size_t swizzle_offset =
+            instr.opcode.Value().GetInfo().type == OpCode::Type::MultiplyAdd
+                ? instr.mad.operand_desc_id
+                : instr.common.operand_desc_id;
+        const SwizzlePattern swizzle = {swizzle_data[swizzle_offset]};
+
+        switch (instr.opcode.Value().GetInfo().type) {
+        case OpCode::Type::Arithmetic:
+            CompileArithmetic(instr, swizzle);
+            break;
+        case OpCode::Type::MultiplyAdd:
+            CompileMultiplyAdd(instr, swizzle);
+            break;
+        default:
+            return CompileFlowControl(instr, offset);
+        }
+        return offset + 1;
+    }
+
+    void CompileArithmetic(const Instruction& instr, const SwizzlePattern& swizzle) {
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+        const Id src1{GetSource<&SwizzlePattern::GetSelectorSrc1>(
+            swizzle, instr.common.GetSrc1(is_inverted), swizzle.negate_src1,
+            !is_inverted * instr.common.address_register_index)};
+        const auto src2 = [&] {
+            return GetSource<&SwizzlePattern::GetSelectorSrc2>(
+                swizzle, instr.common.GetSrc2(is_inverted), swizzle.negate_src2,
+                is_inverted * instr.common.address_register_index);
+        };
+        const std::optional<Id> dest_reg{GetDestRegister(instr.common.dest.Value())};
+        const Id vec4_id{vec_ids.Get(4)};
+
+        switch (instr.opcode.Value().EffectiveOpCode()) {
+        case OpCode::Id::ADD: {
+            SetDest(swizzle, dest_reg, OpFAdd(vec4_id, src1, src2()), 4);
+            break;
+        }
+
+        case OpCode::Id::MUL: {
+            SetDest(swizzle, dest_reg, Multiply(src1, src2()), 4);
+            break;
+        }
+
+        case OpCode::Id::FLR: {
+            SetDest(swizzle, dest_reg, OpFloor(vec4_id, src1), 4);
+            break;
+        }
+
+        case OpCode::Id::MAX: {
+            const Id rhs{src2()};
+            if (state.sanitize_mul) {
+                const Id greater{OpFOrdGreaterThan(bvec_ids.Get(4), src1, rhs)};
+                SetDest(swizzle, dest_reg, OpSelect(vec4_id, greater, src1, rhs), 4);
+            } else {
+                SetDest(swizzle, dest_reg, OpFMax(vec4_id, src1, rhs), 4);
+            }
+            break;
+        }
+
+        case OpCode::Id::MIN: {
+            const Id rhs{src2()};
+            if (state.sanitize_mul) {
+                const Id less{OpFOrdLessThan(bvec_ids.Get(4), src1, rhs)};
+                SetDest(swizzle, dest_reg, OpSelect(vec4_id, less, src1, rhs), 4);
+            } else {
+                SetDest(swizzle, dest_reg, OpFMin(vec4_id, src1, rhs), 4);
+            }
+            break;
+        }
+
+        case OpCode::Id::DP3:
+        case OpCode::Id::DP4:
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI: {
+            const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+            Id lhs{src1};
+            if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI) {
+                lhs = OpCompositeInsert(vec4_id, ConstF32(1.f), lhs, 3);
+            }
+            const Id rhs{src2()};
+            Id dot;
+            if (opcode == OpCode::Id::DP3) {
+                const Id vec3_id{vec_ids.Get(3)};
+                if (state.sanitize_mul) {
+                    const Id product{SanitizeMul(lhs, rhs)};
+                    dot = OpDot(f32_id, OpVectorShuffle(vec3_id, product, product, 0, 1, 2),
+                                ConstF32(1.f, 1.f, 1.f));
+                } else {
+                    dot = OpDot(f32_id, OpVectorShuffle(vec3_id, lhs, lhs, 0, 1, 2),
+                                OpVectorShuffle(vec3_id, rhs, rhs, 0, 1, 2));
+                }
+            } else if (state.sanitize_mul) {
+                dot = OpDot(f32_id, SanitizeMul(lhs, rhs), ConstF32(1.f, 1.f, 1.f, 1.f));
+            } else {
+                dot = OpDot(f32_id, lhs, rhs);
+            }
+            SetDest(swizzle, dest_reg, dot, 1);
+            break;
+        }
+
+        case OpCode::Id::RCP: {
+            const Id x{OpCompositeExtract(f32_id, src1, 0)};
+            const auto write = [&] {
+                SetDest(swizzle, dest_reg, OpFDiv(f32_id, ConstF32(1.f), x), 1);
+            };
+            if (state.sanitize_mul) {
+                write();
+            } else {
+                // When accurate multiplication is OFF, NaN are not really handled. This is a
+                // workaround to cheaply avoid NaN. Fixes graphical issues in Ocarina of Time.
+                If(OpFUnordNotEqual(bool_id, x, ConstF32(0.f)), write);
+            }
+            break;
+        }
+
+        case OpCode::Id::RSQ: {
+            const Id x{OpCompositeExtract(f32_id, src1, 0)};
+            const auto write = [&] { SetDest(swizzle, dest_reg, OpInverseSqrt(f32_id, x), 1); };
+            if (state.sanitize_mul) {
+                write();
+            } else {
+                // When accurate multiplication is OFF, NaN are not really handled. This is a
+                // workaround to cheaply avoid NaN. Fixes graphical issues in Ocarina of Time.
+                If(OpFOrdGreaterThan(bool_id, x, ConstF32(0.f)), write);
+            }
+            break;
+        }
+
+        case OpCode::Id::MOVA: {
+            const Id ivec2_id{ivec_ids.Get(2)};
+            const Id src1_xy{OpVectorShuffle(vec_ids.Get(2), src1, src1, 0, 1)};
+            const Id value{OpConvertFToS(ivec2_id, src1_xy)};
+            const bool write_x = swizzle.DestComponentEnabled(0);
+            const bool write_y = swizzle.DestComponentEnabled(1);
+            if (write_x || write_y) {
+                const Id ivec3_id{ivec_ids.Get(3)};
+                const Id old{OpLoad(ivec3_id, address_registers)};
+                OpStore(address_registers, OpVectorShuffle(ivec3_id, old, value, write_x ? 3 : 0,
+                                                           write_y ? 4 : 1, 2));
+            }
+            break;
+        }
+
+        case OpCode::Id::MOV: {
+            SetDest(swizzle, dest_reg, src1, 4);
+            break;
+        }
+
+        case OpCode::Id::SGE:
+        case OpCode::Id::SGEI: {
+            const Id result{OpFOrdGreaterThanEqual(bvec_ids.Get(4), src1, src2())};
+            SetDest(swizzle, dest_reg, BoolToFloat(result), 4);
+            break;
+        }
+
+        case OpCode::Id::SLT:
+        case OpCode::Id::SLTI: {
+            const Id result{OpFOrdLessThan(bvec_ids.Get(4), src1, src2())};
+            SetDest(swizzle, dest_reg, BoolToFloat(result), 4);
+            break;
+        }
+
+        case OpCode::Id::CMP: {
+            using CompareOp = Instruction::Common::CompareOpType::Op;
+            const CompareOp op_x = instr.common.compare_op.x.Value();
+            const CompareOp op_y = instr.common.compare_op.y.Value();
+            const auto is_known = [](CompareOp op) {
+                switch (op) {
+                case CompareOp::Equal:
+                case CompareOp::NotEqual:
+                case CompareOp::LessThan:
+                case CompareOp::LessEqual:
+                case CompareOp::GreaterThan:
+                case CompareOp::GreaterEqual:
+                    return true;
+                default:
+                    return false;
+                }
+            };
+            if (!is_known(op_x)) {
+                LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", op_x);
+                break;
+            }
+            if (!is_known(op_y)) {
+                LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", op_y);
+                break;
+            }
+
+            const Id rhs{src2()};
+            const auto compare = [&](CompareOp op, u32 component) {
+                const Id lhs_comp{OpCompositeExtract(f32_id, src1, component)};
+                const Id rhs_comp{OpCompositeExtract(f32_id, rhs, component)};
+                switch (op) {
+                case CompareOp::Equal:
+                    return OpFOrdEqual(bool_id, lhs_comp, rhs_comp);
+                case CompareOp::NotEqual:
+                    return OpFUnordNotEqual(bool_id, lhs_comp, rhs_comp);
+                case CompareOp::LessThan:
+                    return OpFOrdLessThan(bool_id, lhs_comp, rhs_comp);
+                case CompareOp::LessEqual:
+                    return OpFOrdLessThanEqual(bool_id, lhs_comp, rhs_comp);
+                case CompareOp::GreaterThan:
+                    return OpFOrdGreaterThan(bool_id, lhs_comp, rhs_comp);
+                case CompareOp::GreaterEqual:
+                default:
+                    return OpFOrdGreaterThanEqual(bool_id, lhs_comp, rhs_comp);
+                }
+            };
+            OpStore(conditional_code, OpCompositeConstruct(bvec_ids.Get(2), compare(op_x, 0),
+                                                           compare(op_y, 1)));
+            break;
+        }
+
+        case OpCode::Id::EX2: {
+            SetDest(swizzle, dest_reg, OpExp2(f32_id, OpCompositeExtract(f32_id, src1, 0)), 1);
+            break;
+        }
+
+        case OpCode::Id::LG2: {
+            SetDest(swizzle, dest_reg, OpLog2(f32_id, OpCompositeExtract(f32_id, src1, 0)), 1);
+            break;
+        }
+
+        default: {
+            LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x{:02x} ({}): 0x{:08x}",
+                      (int)instr.opcode.Value().EffectiveOpCode(),
+                      instr.opcode.Value().GetInfo().name, instr.hex);
+            throw DecompileFail("Unhandled instruction");
+        }
+        }
+    }
+
+    void CompileMultiplyAdd(const Instruction& instr, const SwizzlePattern& swizzle) {
+        const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+        if (opcode != OpCode::Id::MAD && opcode != OpCode::Id::MADI) {
+            LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
+                      (int)opcode, instr.opcode.Value().GetInfo().name, instr.hex);
+            throw DecompileFail("Unhandled instruction");
+        }
+
+        const bool is_inverted = opcode == OpCode::Id::MADI;
+        const Id src1{GetSource<&SwizzlePattern::GetSelectorSrc1>(
+            swizzle, instr.mad.GetSrc1(is_inverted), swizzle.negate_src1, 0)};
+        const Id src2{GetSource<&SwizzlePattern::GetSelectorSrc2>(
+            swizzle, instr.mad.GetSrc2(is_inverted), swizzle.negate_src2,
+            !is_inverted * instr.mad.address_register_index)};
+        const Id src3{GetSource<&SwizzlePattern::GetSelectorSrc3>(
+            swizzle, instr.mad.GetSrc3(is_inverted), swizzle.negate_src3,
+            is_inverted * instr.mad.address_register_index)};
+
+        SetDest(swizzle, GetDestRegister(instr.mad.dest.Value()),
+                OpFAdd(vec_ids.Get(4), Multiply(src1, src2), src3), 4);
+    }
+
+    u32 CompileFlowControl(const Instruction& instr, u32 offset) {
+        const u32 dest_offset = instr.flow_control.dest_offset;
+        const u32 num_instructions = instr.flow_control.num_instructions;
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END: {
+            Return(true);
+            return PROGRAM_END;
+        }
+
+        case OpCode::Id::JMPC:
+        case OpCode::Id::JMPU: {
+            Id condition;
+            if (instr.opcode.Value() == OpCode::Id::JMPC) {
+                condition = EvaluateCondition(instr.flow_control);
+            } else {
+                const bool invert_test = num_instructions & 1;
+                condition = GetUniformBool(instr.flow_control.bool_uniform_id, invert_test);
+            }
+            If(condition, [&] { Jump(dest_offset); });
+            return offset + 1;
+        }
+
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU: {
+            const Subroutine& call_sub = GetSubroutine(dest_offset, dest_offset + num_instructions);
+            if (instr.opcode.Value() == OpCode::Id::CALL) {
+                CallSubroutine(call_sub);
+                return call_sub.exit_method == ExitMethod::AlwaysEnd ? PROGRAM_END : offset + 1;
+            }
+
+            const Id condition{
+                instr.opcode.Value() == OpCode::Id::CALLC
+                    ? EvaluateCondition(instr.flow_control)
+                    : GetUniformBool(instr.flow_control.bool_uniform_id)};
+            If(condition, [&] { CallSubroutine(call_sub); });
+            return offset + 1;
+        }
+
+        case OpCode::Id::NOP: {
+            return offset + 1;
+        }
+
+        case OpCode::Id::IFC:
+        case OpCode::Id::IFU: {
+            const Id condition{instr.opcode.Value() == OpCode::Id::IFC
+                                   ? EvaluateCondition(instr.flow_control)
+                                   : GetUniformBool(instr.flow_control.bool_uniform_id)};
+
+            const u32 if_offset = offset + 1;
+            const u32 else_offset = dest_offset;
+            const u32 endif_offset = dest_offset + num_instructions;
+
+            const Subroutine& if_sub = GetSubroutine(if_offset, else_offset);
+            if (num_instructions == 0) {
+                If(condition, [&] { CallSubroutine(if_sub); });
+                return else_offset;
+            }
+
+            const Subroutine& else_sub = GetSubroutine(else_offset, endif_offset);
+            IfElse(
+                condition, [&] { CallSubroutine(if_sub); }, [&] { CallSubroutine(else_sub); });
+            if (if_sub.exit_method == ExitMethod::AlwaysEnd &&
+                else_sub.exit_method == ExitMethod::AlwaysEnd) {
+                return PROGRAM_END;
+            }
+            return endif_offset;
+        }
+
+        case OpCode::Id::LOOP: {
+            const Subroutine& loop_sub = GetSubroutine(offset + 1, dest_offset + 1);
+            CompileLoop(instr.flow_control.int_uniform_id, loop_sub);
+            return loop_sub.exit_method == ExitMethod::AlwaysEnd ? PROGRAM_END : dest_offset + 1;
+        }
+
+        case OpCode::Id::EMIT:
+        case OpCode::Id::SETEMIT:
+            LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+            return offset + 1;
+
+        default: {
+            LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
+                      (int)instr.opcode.Value().EffectiveOpCode(),
+                      instr.opcode.Value().GetInfo().name, instr.hex);
+            throw DecompileFail("Unhandled instruction");
+        }
+        }
+    }
+
+    /// Emits a LOOP block executing the subroutine int_uniform.x + 1 times.
+    void CompileLoop(u32 int_uniform_id, const Subroutine& loop_sub) {
+        const Id int_uniform{GetPicaDataMember(uvec_ids.Get(4), ConstS32(1),
+                                               ConstS32(static_cast<s32>(int_uniform_id)))};
+        const Id count{OpCompositeExtract(u32_id, int_uniform, 0)};
+        const Id start{OpBitcast(i32_id, OpCompositeExtract(u32_id, int_uniform, 1))};
+        const Id step{OpBitcast(i32_id, OpCompositeExtract(u32_id, int_uniform, 2))};
+
+        const Id address_z{
+            OpAccessChain(TypePointer(spv::StorageClass::Private, i32_id), address_registers,
+                          ConstS32(2))};
+        OpStore(address_z, start);
+        const Id loop_var{DefineVar(u32_id, spv::StorageClass::Private)};
+        OpStore(loop_var, ConstU32(0u));
+
+        const Id loop_header{OpLabel()};
+        const Id body_label{OpLabel()};
+        const Id continue_label{OpLabel()};
+        const Id merge_label{OpLabel()};
+        Branch(loop_header);
+
+        BeginBlock(loop_header);
+        const Id condition{OpULessThanEqual(bool_id, OpLoad(u32_id, loop_var), count)};
+        OpLoopMerge(merge_label, continue_label, spv::LoopControlMask::MaskNone);
+        OpBranchConditional(condition, body_label, merge_label);
+
+        BeginBlock(body_label);
+        CallSubroutine(loop_sub);
+        const bool body_terminated = terminated;
+        if (!body_terminated) {
+            Branch(continue_label);
+        }
+
+        BeginBlock(continue_label);
+        if (!body_terminated) {
+            OpStore(address_z, OpIAdd(i32_id, OpLoad(i32_id, address_z), step));
+            OpStore(loop_var, OpIAdd(u32_id, OpLoad(u32_id, loop_var), ConstU32(1u)));
+        }
+        Branch(loop_header);
+
+        BeginBlock(merge_label);
+    }
+
+    /// Emits a call to a subroutine, returning from the caller when END was reached.
+    void CallSubroutine(const Subroutine& subroutine) {
+        const Id result{OpFunctionCall(bool_id, functions.at(&subroutine))};
+        if (subroutine.exit_method == ExitMethod::AlwaysEnd) {
+            Return(true);
+        } else if (subroutine.exit_method == ExitMethod::Conditional) {
+            If(result, [&] { Return(true); });
+        }
+    }
+
+    /// Generates condition evaluation code for the flow control instruction.
+    Id EvaluateCondition(Instruction::FlowControlType flow_control) {
+        using Op = Instruction::FlowControlType::Op;
+
+        const Id code{OpLoad(bvec_ids.Get(2), conditional_code)};
+        const auto result = [&](u32 component, bool ref) {
+            const Id value{OpCompositeExtract(bool_id, code, component)};
+            return ref ? value : OpLogicalNot(bool_id, value);
+        };
+
+        switch (flow_control.op) {
+        case Op::JustX:
+            return result(0, flow_control.refx.Value());
+        case Op::JustY:
+            return result(1, flow_control.refy.Value());
+        case Op::Or:
+            return OpLogicalOr(bool_id, result(0, flow_control.refx.Value()),
+                               result(1, flow_control.refy.Value()));
+        case Op::And:
+            return OpLogicalAnd(bool_id, result(0, flow_control.refx.Value()),
+                                result(1, flow_control.refy.Value()));
+        default:
+            UNREACHABLE();
+            return ConstantFalse(bool_id);
+        }
+    }
+
+    /// Generates code representing a bool uniform
+    Id GetUniformBool(u32 index, bool invert_test = false) {
+        const Id bools{GetPicaDataMember(u32_id, ConstS32(0))};
+        const Id masked{OpBitwiseAnd(u32_id, bools, ConstU32(1u << index))};
+        return invert_test ? OpIEqual(bool_id, masked, ConstU32(0u))
+                           : OpINotEqual(bool_id, masked, ConstU32(0u));
+    }
+
+    /// Loads a source register and applies the swizzle and negation of the instruction.
+    template <SwizzlePattern::Selector (SwizzlePattern::*getter)(int) const>
+    Id GetSource(const SwizzlePattern& swizzle, const SourceRegister& source_reg, bool negate,
+                 u32 address_register_index) {
+        const Id vec4_id{vec_ids.Get(4)};
+        Id value{GetSourceRegister(source_reg, address_register_index)};
+        const u32 x = static_cast<u32>((swizzle.*getter)(0));
+        const u32 y = static_cast<u32>((swizzle.*getter)(1));
+        const u32 z = static_cast<u32>((swizzle.*getter)(2));
+        const u32 w = static_cast<u32>((swizzle.*getter)(3));
+        if (x != 0 || y != 1 || z != 2 || w != 3) {
+            value = OpVectorShuffle(vec4_id, value, value, x, y, z, w);
+        }
+        return negate ? OpFNegate(vec4_id, value) : value;
+    }
+
+    /// Generates code representing a source register.
+    Id GetSourceRegister(const SourceRegister& source_reg, u32 address_register_index) {
+        const u32 index = static_cast<u32>(source_reg.GetIndex());
+        const Id vec4_id{vec_ids.Get(4)};
+
+        switch (source_reg.GetRegisterType()) {
+        case RegisterType::Input:
+            return OpLoad(vec4_id, GetInputRegister(index));
+        case RegisterType::Temporary:
+            return OpLoad(vec4_id, reg_tmp[index]);
+        case RegisterType::FloatUniform:
+            if (address_register_index != 0) {
+                return GetOffsetRegister(index, address_register_index - 1);
+            }
+            return GetPicaDataMember(vec4_id, ConstS32(2), ConstS32(static_cast<s32>(index)));
+        default:
+            UNREACHABLE();
+            return ConstF32(0.f, 0.f, 0.f, 0.f);
+        }
+    }
+
+    /// Loads a float uniform relative to an address register, out of range reads return 1.0.
+    Id GetOffsetRegister(u32 base_index, u32 component) {
+        const Id address{OpLoad(i32_id, OpAccessChain(TypePointer(spv::StorageClass::Private,
+                                                                  i32_id),
+                                                      address_registers, ConstS32(component)))};
+        const Id in_range{
+            OpLogicalAnd(bool_id, OpSGreaterThanEqual(bool_id, address, ConstS32(-128)),
+                         OpSLessThanEqual(bool_id, address, ConstS32(127)))};
+        const Id fixed_offset{OpSelect(i32_id, in_range, address, ConstS32(0))};
+        const Id index{OpBitcast(
+            u32_id, OpBitwiseAnd(i32_id, OpIAdd(i32_id, ConstS32(static_cast<s32>(base_index)),
+                                                fixed_offset),
+                                 ConstS32(0x7F)))};
+        const Id is_valid{OpULessThan(bool_id, index, ConstU32(96u))};
+        const Id safe_index{OpSelect(u32_id, is_valid, index, ConstU32(0u))};
+        const Id value{GetPicaDataMember(vec_ids.Get(4), ConstS32(2), safe_index)};
+        const Id valid_mask{OpCompositeConstruct(bvec_ids.Get(4), is_valid, is_valid, is_valid,
+                                                 is_valid)};
+        return OpSelect(vec_ids.Get(4), valid_mask, value, ConstF32(1.f, 1.f, 1.f, 1.f));
+    }
+
+    /// Returns the input variable of an input register, it is declared on first use.
+    Id GetInputRegister(u32 index) {
+        ASSERT(index < NUM_REGISTERS);
+        if (!vs_in_reg[index]) {
+            vs_in_reg[index] = DefineVar(vec_ids.Get(4), spv::StorageClass::Private);
+            Name(*vs_in_reg[index], fmt::format("vs_in_reg{}", index));
+
+            const AttribLoadFlags flags = state.load_flags[index];
+            const Id type = True(flags & AttribLoadFlags::Sint)   ? ivec_ids.Get(4)
+                            : True(flags & AttribLoadFlags::Uint) ? uvec_ids.Get(4)
+                                                                  : vec_ids.Get(4);
+            vs_in_typed_reg[index] = DefineInput(type, index);
+            Name(vs_in_typed_reg[index], fmt::format("vs_in_typed_reg{}", index));
+        }
+        return *vs_in_reg[index];
+    }
+
+    /// Generates code representing a destination register.
+    std::optional<Id> GetDestRegister(const DestRegister& dest_reg) const {
+        const u32 index = static_cast<u32>(dest_reg.GetIndex());
+
+        switch (dest_reg.GetRegisterType()) {
+        case RegisterType::Output:
+            if (state.output_map[index] < state.num_outputs) {
+                return vs_out_attr[state.output_map[index]];
+            }
+            return std::nullopt;
+        case RegisterType::Temporary:
+            return reg_tmp[index];
+        default:
+            return std::nullopt;
+        }
+    }
+
+    /**
+     * Writes code that does an assignment operation.
+     * @param swizzle the swizzle data of the current instruction.
+     * @param reg the destination register variable.
+     * @param value the vec4 or scalar value to assign.
+     * @param value_num_components number of components of the value to assign.
+     */
+    void SetDest(const SwizzlePattern& swizzle, std::optional<Id> reg, Id value,
+                 u32 value_num_components) {
+        if (!reg) {
+            return;
+        }
+        std::array<u32, 4> components;
+        u32 num_enabled = 0;
+        for (u32 i = 0; i < 4; ++i) {
+            const bool enabled = swizzle.DestComponentEnabled(static_cast<int>(i));
+            components[i] = enabled ? 4 + i : i;
+            num_enabled += enabled;
+        }
+        if (num_enabled == 0) {
+            return;
+        }
+
+        const Id vec4_id{vec_ids.Get(4)};
+        if (value_num_components == 1) {
+            value = OpCompositeConstruct(vec4_id, value, value, value, value);
+        }
+        if (num_enabled != 4) {
+            const Id old{OpLoad(vec4_id, *reg)};
+            value = OpVectorShuffle(vec4_id, old, value, components[0], components[1],
+                                    components[2], components[3]);
+        }
+        OpStore(*reg, value);
+    }
+
+    /// Multiplies two vectors, sanitizing the result when accurate multiplication is enabled.
+    Id Multiply(Id lhs, Id rhs) {
+        return state.sanitize_mul ? SanitizeMul(lhs, rhs) : OpFMul(vec_ids.Get(4), lhs, rhs);
+    }
+
+    /// Multiplies two vectors with the PICA rule of 0 * inf = 0.
+    Id SanitizeMul(Id lhs, Id rhs) {
+        const Id vec4_id{vec_ids.Get(4)};
+        const Id bvec4_id{bvec_ids.Get(4)};
+        const Id product{OpFMul(vec4_id, lhs, rhs)};
+        const Id rhs_nan{OpSelect(vec4_id, OpIsNan(bvec4_id, rhs), product,
+                                  ConstF32(0.f, 0.f, 0.f, 0.f))};
+        const Id any_nan{OpSelect(vec4_id, OpIsNan(bvec4_id, lhs), product, rhs_nan)};
+        return OpSelect(vec4_id, OpIsNan(bvec4_id, product), any_nan, product);
+    }
+
+    /// Converts a boolean vector to 1.0 or 0.0 per component.
+    Id BoolToFloat(Id value) {
+        return OpSelect(vec_ids.Get(4), value, ConstF32(1.f, 1.f, 1.f, 1.f),
+                        ConstF32(0.f, 0.f, 0.f, 0.f));
+    }
+
+    /// Emits a selection construct that executes then_func when condition is true.
+    template <typename Func>
+    void If(Id condition, Func&& then_func) {
+        const Id then_label{OpLabel()};
+        const Id merge_label{OpLabel()};
+        OpSelectionMerge(merge_label, spv::SelectionControlMask::MaskNone);
+        OpBranchConditional(condition, then_label, merge_label);
+
+        BeginBlock(then_label);
+        then_func();
+        if (!terminated) {
+            Branch(merge_label);
+        }
+        BeginBlock(merge_label);
+    }
+
+    /// Emits a selection construct with an else branch.
+    template <typename ThenFunc, typename ElseFunc>
+    void IfElse(Id condition, ThenFunc&& then_func, ElseFunc&& else_func) {
+        const Id then_label{OpLabel()};
+        const Id else_label{OpLabel()};
+        const Id merge_label{OpLabel()};
+        OpSelectionMerge(merge_label, spv::SelectionControlMask::MaskNone);
+        OpBranchConditional(condition, then_label, else_label);
+
+        BeginBlock(then_label);
+        then_func();
+        if (!terminated) {
+            Branch(merge_label);
+        }
+        BeginBlock(else_label);
+        else_func();
+        if (!terminated) {
+            Branch(merge_label);
+        }
+        BeginBlock(merge_label);
+    }
+
+    void BeginBlock(Id label) {
+        AddLabel(label);
+        terminated = false;
+    }
+
+    void Branch(Id label) {
+        OpBranch(label);
+        terminated = true;
+    }
+
+    void Return(bool value) {
+        OpReturnValue(value ? ConstantTrue(bool_id) : ConstantFalse(bool_id));
+        terminated = true;
+    }
+
+    void Unreachable() {
+        OpUnreachable();
+        terminated = true;
+    }
+
+    /// Returns the PICA output attribute component mapped to a semantic, or 1.0 when unmapped.
+    Id GetSemantic(VSOutputAttributes::Semantic slot_semantic) {
+        const u32 slot = static_cast<u32>(slot_semantic);
+        const u32 attrib = state.gs_state.semantic_maps[slot].attribute_index;
+        const u32 comp = state.gs_state.semantic_maps[slot].component_index;
+        if (attrib < state.gs_state.gs_output_attributes && attrib < state.num_outputs) {
+            return OpCompositeExtract(f32_id, OpLoad(vec_ids.Get(4), vs_out_attr[attrib]), comp);
+        }
+        return ConstF32(1.f);
+    }
+
+    template <typename... Semantics>
+    Id GetSemanticVector(Semantics... semantics) {
+        return OpCompositeConstruct(vec_ids.Get(sizeof...(semantics)), GetSemantic(semantics)...);
+    }
+
+    /// Writes the host vertex outputs from the PICA output attributes.
+    void EmitVertex() {
+        const Id vec4_id{vec_ids.Get(4)};
+        Id vtx_pos{GetSemanticVector(VSOutputAttributes::POSITION_X, VSOutputAttributes::POSITION_Y,
+                                     VSOutputAttributes::POSITION_Z,
+                                     VSOutputAttributes::POSITION_W)};
+
+        // Sanitize the vertex depth like the GLSL SanitizeVertex
+        const Id z{OpCompositeExtract(f32_id, vtx_pos, 2)};
+        const Id w{OpCompositeExtract(f32_id, vtx_pos, 3)};
+        const Id ndc_z{OpFDiv(f32_id, z, w)};
+        const Id near_zero{OpLogicalAnd(bool_id, OpFOrdGreaterThan(bool_id, ndc_z, ConstF32(0.f)),
+                                        OpFOrdLessThan(bool_id, ndc_z, ConstF32(0.000001f)))};
+        const Id near_minus_one{
+            OpLogicalAnd(bool_id, OpFOrdLessThan(bool_id, ndc_z, ConstF32(-1.f)),
+                         OpFOrdGreaterThan(bool_id, ndc_z, ConstF32(-1.00001f)))};
+        Id sanitized_z{OpSelect(f32_id, near_zero, ConstF32(0.f), z)};
+        sanitized_z = OpSelect(f32_id, near_minus_one, OpFNegate(f32_id, w), sanitized_z);
+        vtx_pos = OpCompositeInsert(vec4_id, sanitized_z, vtx_pos, 2);
+
+        const Id flip_viewport{
+            OpINotEqual(bool_id, GetVSDataMember(u32_id, ConstS32(1)), ConstU32(0u))};
+        const Id y{OpCompositeExtract(f32_id, vtx_pos, 1)};
+        const Id flipped_y{OpSelect(f32_id, flip_viewport, OpFNegate(f32_id, y), y)};
+        vtx_pos = OpCompositeInsert(vec4_id, flipped_y, vtx_pos, 1);
+
+        OpStore(gl_position_id,
+                OpCompositeInsert(vec4_id, OpFNegate(f32_id, sanitized_z), vtx_pos, 2));
+        if (state.use_clip_planes) {
+            const Id clip_ptr{TypePointer(spv::StorageClass::Output, f32_id)};
+            // fixed PICA clipping plane z <= 0
+            OpStore(OpAccessChain(clip_ptr, gl_clip_distance_id, ConstS32(0)),
+                    OpFNegate(f32_id, sanitized_z));
+            const Id enable_clip1{
+                OpINotEqual(bool_id, GetVSDataMember(u32_id, ConstS32(0)), ConstU32(0u))};
+            const Id clip_coef{GetVSDataMember(vec4_id, ConstS32(2))};
+            OpStore(OpAccessChain(clip_ptr, gl_clip_distance_id, ConstS32(1)),
+                    OpSelect(f32_id, enable_clip1, OpDot(f32_id, clip_coef, vtx_pos),
+                             ConstF32(0.f)));
+        }
+
+        OpStore(normquat_id, GetSemanticVector(VSOutputAttributes::QUATERNION_X,
+                                               VSOutputAttributes::QUATERNION_Y,
+                                               VSOutputAttributes::QUATERNION_Z,
+                                               VSOutputAttributes::QUATERNION_W));
+        const Id vtx_color{GetSemanticVector(VSOutputAttributes::COLOR_R,
+                                             VSOutputAttributes::COLOR_G,
+                                             VSOutputAttributes::COLOR_B,
+                                             VSOutputAttributes::COLOR_A)};
+        OpStore(primary_color_id, OpFMin(vec4_id, OpFAbs(vec4_id, vtx_color),
+                                         ConstF32(1.f, 1.f, 1.f, 1.f)));
+        OpStore(texcoord_id[0], GetSemanticVector(VSOutputAttributes::TEXCOORD0_U,
+                                                  VSOutputAttributes::TEXCOORD0_V));
+        OpStore(texcoord_id[1], GetSemanticVector(VSOutputAttributes::TEXCOORD1_U,
+                                                  VSOutputAttributes::TEXCOORD1_V));
+        OpStore(texcoord0_w_id, GetSemantic(VSOutputAttributes::TEXCOORD0_W));
+        OpStore(view_id, GetSemanticVector(VSOutputAttributes::VIEW_X, VSOutputAttributes::VIEW_Y,
+                                           VSOutputAttributes::VIEW_Z));
+        OpStore(texcoord_id[2], GetSemanticVector(VSOutputAttributes::TEXCOORD2_U,
+                                                  VSOutputAttributes::TEXCOORD2_V));
+    }
+
+    void DefineEntryPoint() {
+        AddCapability(spv::Capability::Shader);
+        if (state.use_clip_planes) {
+            AddCapability(spv::Capability::ClipDistance);
+        }
+        SetMemoryModel(spv::AddressingModel::Logical, spv::MemoryModel::GLSL450);
+
+        const Id main_type{TypeFunction(void_id)};
+        const Id main_func{OpFunction(void_id, spv::FunctionControlMask::MaskNone, main_type)};
+        BeginBlock(OpLabel());
+
+        const Id vec4_id{vec_ids.Get(4)};
+        const std::array false_constituents{ConstantFalse(bool_id), ConstantFalse(bool_id)};
+        OpStore(conditional_code, ConstantComposite(bvec_ids.Get(2), false_constituents));
+        OpStore(address_registers, ConstS32(0, 0, 0));
+        for (const Id reg : reg_tmp) {
+            OpStore(reg, ConstF32(0.f, 0.f, 0.f, 1.f));
+        }
+
+        boost::container::small_vector<Id, 26> interface_ids{
+            primary_color_id, texcoord_id[0], texcoord_id[1], texcoord_id[2], texcoord0_w_id,
+            normquat_id,      view_id,        gl_position_id,
+        };
+        if (state.use_clip_planes) {
+            interface_ids.push_back(gl_clip_distance_id);
+        }
+        for (u32 i = 0; i < NUM_REGISTERS; ++i) {
+            if (!vs_in_reg[i]) {
+                continue;
+            }
+            interface_ids.push_back(vs_in_typed_reg[i]);
+
+            const AttribLoadFlags flags = state.load_flags[i];
+            Id value;
+            if (True(flags & AttribLoadFlags::Sint)) {
+                value = OpConvertSToF(vec4_id, OpLoad(ivec_ids.Get(4), vs_in_typed_reg[i]));
+            } else if (True(flags & AttribLoadFlags::Uint)) {
+                value = OpConvertUToF(vec4_id, OpLoad(uvec_ids.Get(4), vs_in_typed_reg[i]));
+            } else {
+                value = OpLoad(vec4_id, vs_in_typed_reg[i]);
+            }
+            if (True(flags & AttribLoadFlags::ZeroW)) {
+                value = OpCompositeInsert(vec4_id, ConstF32(0.f), value, 3);
+            }
+            OpStore(*vs_in_reg[i], value);
+        }
+        for (u32 i = 0; i < state.num_outputs; ++i) {
+            OpStore(vs_out_attr[i], ConstF32(0.f, 0.f, 0.f, 1.f));
+        }
+
+        OpFunctionCall(bool_id, functions.at(&GetSubroutine(state.main_offset, PROGRAM_END)));
+        EmitVertex();
+        OpReturn();
+        OpFunctionEnd();
+
+        AddEntryPoint(spv::ExecutionModel::Vertex, main_func, "main", interface_ids);
+    }
+
+    void DefineArithmeticTypes() {
+        void_id = Name(TypeVoid(), "void_id");
+        bool_id = Name(TypeBool(), "bool_id");
+        f32_id = Name(TypeFloat(32), "f32_id");
+        i32_id = Name(TypeSInt(32), "i32_id");
+        u32_id = Name(TypeUInt(32), "u32_id");
+
+        for (u32 size = 2; size <= 4; size++) {
+            const u32 i = size - 2;
+            vec_ids.ids[i] = Name(TypeVector(f32_id, size), fmt::format("vec{}_id", size));
+            ivec_ids.ids[i] = Name(TypeVector(i32_id, size), fmt::format("ivec{}_id", size));
+            uvec_ids.ids[i] = Name(TypeVector(u32_id, size), fmt::format("uvec{}_id", size));
+            bvec_ids.ids[i] = Name(TypeVector(bool_id, size), fmt::format("bvec{}_id", size));
+        }
+    }
+
+    void DefineUniformStructs() {
+        const Id int_array_id{TypeArray(uvec_ids.Get(4), ConstU32(4u))};
+        const Id float_array_id{TypeArray(vec_ids.Get(4), ConstU32(96u))};
+        const Id pica_data_struct_id{TypeStruct(u32_id, int_array_id, float_array_id)};
+        Decorate(int_array_id, spv::Decoration::ArrayStride, 16u);
+        Decorate(float_array_id, spv::Decoration::ArrayStride, 16u);
+        MemberDecorate(pica_data_struct_id, 0, spv::Decoration::Offset, 0u);
+        MemberDecorate(pica_data_struct_id, 1, spv::Decoration::Offset, 16u);
+        MemberDecorate(pica_data_struct_id, 2, spv::Decoration::Offset, 80u);
+        Decorate(pica_data_struct_id, spv::Decoration::Block);
+        pica_data_id =
+            AddGlobalVariable(TypePointer(spv::StorageClass::Uniform, pica_data_struct_id),
+                              spv::StorageClass::Uniform);
+        Decorate(pica_data_id, spv::Decoration::DescriptorSet, 0);
+        Decorate(pica_data_id, spv::Decoration::Binding, 0);
+
+        // Booleans are not allowed in uniform blocks, they are loaded as integers instead.
+        const Id vs_data_struct_id{TypeStruct(u32_id, u32_id, vec_ids.Get(4))};
+        MemberDecorate(vs_data_struct_id, 0, spv::Decoration::Offset, 0u);
+        MemberDecorate(vs_data_struct_id, 1, spv::Decoration::Offset, 4u);
+        MemberDecorate(vs_data_struct_id, 2, spv::Decoration::Offset, 16u);
+        Decorate(vs_data_struct_id, spv::Decoration::Block);
+        vs_data_id = AddGlobalVariable(TypePointer(spv::StorageClass::Uniform, vs_data_struct_id),
+                                       spv::StorageClass::Uniform);
+        Decorate(vs_data_id, spv::Decoration::DescriptorSet, 0);
+        Decorate(vs_data_id, spv::Decoration::Binding, 1);
+    }
+
+    void DefineInterface() {
+        primary_color_id = DefineOutput(vec_ids.Get(4), ATTRIBUTE_COLOR);
+        texcoord_id[0] = DefineOutput(vec_ids.Get(2), ATTRIBUTE_TEXCOORD0);
+        texcoord_id[1] = DefineOutput(vec_ids.Get(2), ATTRIBUTE_TEXCOORD1);
+        texcoord_id[2] = DefineOutput(vec_ids.Get(2), ATTRIBUTE_TEXCOORD2);
+        texcoord0_w_id = DefineOutput(f32_id, ATTRIBUTE_TEXCOORD0_W);
+        normquat_id = DefineOutput(vec_ids.Get(4), ATTRIBUTE_NORMQUAT);
+        view_id = DefineOutput(vec_ids.Get(3), ATTRIBUTE_VIEW);
+
+        gl_position_id = DefineVar(vec_ids.Get(4), spv::StorageClass::Output);
+        Decorate(gl_position_id, spv::Decoration::BuiltIn, spv::BuiltIn::Position);
+        // Apple Silicon GPU drivers optimize more aggressively, which can create
+        // too much variance and cause visual artifacting in games like Pokemon.
+#ifdef __APPLE__
+        Decorate(gl_position_id, spv::Decoration::Invariant);
+#endif
+        if (state.use_clip_planes) {
+            gl_clip_distance_id =
+                DefineVar(TypeArray(f32_id, ConstU32(2u)), spv::StorageClass::Output);
+            Decorate(gl_clip_distance_id, spv::Decoration::BuiltIn, spv::BuiltIn::ClipDistance);
+        }
+
+        conditional_code = Name(DefineVar(bvec_ids.Get(2), spv::StorageClass::Private),
+                                "conditional_code");
+        address_registers = Name(DefineVar(ivec_ids.Get(3), spv::StorageClass::Private),
+                                 "address_registers");
+        for (u32 i = 0; i < NUM_REGISTERS; ++i) {
+            reg_tmp[i] = Name(DefineVar(vec_ids.Get(4), spv::StorageClass::Private),
+                              fmt::format("reg_tmp{}", i));
+        }
+        for (u32 i = 0; i < state.num_outputs; ++i) {
+            vs_out_attr[i] = Name(DefineVar(vec_ids.Get(4), spv::StorageClass::Private),
+                                  fmt::format("vs_out_attr{}", i));
+        }
+    }
+
+    /// Loads a member of the vs_pica_data uniform block
+    template <typename... Ids>
+    Id GetPicaDataMember(Id type, Ids... ids) {
+        const Id uniform_ptr{TypePointer(spv::StorageClass::Uniform, type)};
+        return OpLoad(type, OpAccessChain(uniform_ptr, pica_data_id, ids...));
+    }
+
+    /// Loads a member of the vs_data uniform block
+    template <typename... Ids>
+    Id GetVSDataMember(Id type, Ids... ids) {
+        const Id uniform_ptr{TypePointer(spv::StorageClass::Uniform, type)};
+        return OpLoad(type, OpAccessChain(uniform_ptr, vs_data_id, ids...));
+    }
+
+    Id DefineInput(Id type, u32 location) {
+        const Id input_id{DefineVar(type, spv::StorageClass::Input)};
+        Decorate(input_id, spv::Decoration::Location, location);
+        return input_id;
+    }
+
+    Id DefineOutput(Id type, u32 location) {
+        const Id output_id{DefineVar(type, spv::StorageClass::Output)};
+        Decorate(output_id, spv::Decoration::Location, location);
+        return output_id;
+    }
+
+    Id DefineVar(Id type, spv::StorageClass storage_class) {
+        return AddGlobalVariable(TypePointer(storage_class, type), storage_class);
+    }
+
+    Id ConstU32(u32 value) {
+        return Constant(u32_id, value);
+    }
+
+    Id ConstS32(s32 value) {
+        return Constant(i32_id, value);
+    }
+
+    Id ConstS32(s32 x, s32 y, s32 z) {
+        const std::array constituents{ConstS32(x), ConstS32(y), ConstS32(z)};
+        return ConstantComposite(ivec_ids.Get(3), constituents);
+    }
+
+    Id ConstF32(f32 value) {
+        return Constant(f32_id, value);
+    }
+
+    template <typename... Args>
+    Id ConstF32(Args... values) {
+        constexpr u32 size = static_cast<u32>(sizeof...(values));
+        static_assert(size >= 2 && size <= 4);
+        const std::array constituents{Constant(f32_id, values)...};
+        return ConstantComposite(vec_ids.Get(size), constituents);
+    }
+
+private:
+    const std::set<Subroutine>& subroutines;
+    const ProgramCode& program_code;
+    const SwizzleData& swizzle_data;
+    const PicaVSConfigState& state;
+
+    std::map<const Subroutine*, Id> functions;
+    std::map<u32, Id> jump_labels;
+    Id jmp_to{};
+    Id switch_merge{};
+    bool terminated{};
+
+    Id void_id{};
+    Id bool_id{};
+    Id f32_id{};
+    Id i32_id{};
+    Id u32_id{};
+
+    VectorIds vec_ids{};
+    VectorIds ivec_ids{};
+    VectorIds uvec_ids{};
+    VectorIds bvec_ids{};
+
+    Id pica_data_id{};
+    Id vs_data_id{};
+
+    Id primary_color_id{};
+    Id texcoord_id[3]{};
+    Id texcoord0_w_id{};
+    Id normquat_id{};
+    Id view_id{};
+    Id gl_position_id{};
+    Id gl_clip_distance_id{};
+
+    Id conditional_code{};
+    Id address_registers{};
+    std::array<Id, NUM_REGISTERS> reg_tmp{};
+    std::array<std::optional<Id>, NUM_REGISTERS> vs_in_reg{};
+    std::array<Id, NUM_REGISTERS> vs_in_typed_reg{};
+    std::array<Id, NUM_REGISTERS> vs_out_attr{};
+};
+
+std::vector<u32> GenerateVertexShader(const ShaderSetup& setup, const PicaVSConfig& config) {
+    ASSERT(!config.state.use_geometry_shader);
+    try {
+        const auto subroutines =
+            ControlFlowAnalyzer(setup.GetProgramCode(), config.state.main_offset).MoveSubroutines();
+        VertexModule module{subroutines, setup, config};
+        module.Generate();
+        return module.Assemble();
+    } catch (const DecompileFail& exception) {
+        LOG_INFO(HW_GPU, "Shader decompilation failed: {}", exception.what());
+        return {};
+    }
+}
+
+} // namespace Pica::Shader::Generator::SPIRV
@@ -0,0 +1,30 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "common/common_types.h"
+
+namespace Pica {
+struct ShaderSetup;
+}
+
+namespace Pica::Shader::Generator {
+struct PicaVSConfig;
+}
+
+namespace Pica::Shader::Generator::SPIRV {
+
+/**
+ * Decompiles the PICA vertex shader program directly to a SPIR-V vertex shader, with the same
+ * interface as the GLSL one. Configurations that forward the outputs to a geometry shader are
+ * not supported.
+ * @param setup PICA shader setup holding the program and swizzle data
+ * @param config PicaVSConfig generated for the current Pica state
+ * @returns SPIR-V words of the shader, empty if the program could not be decompiled
+ */
+std::vector<u32> GenerateVertexShader(const Pica::ShaderSetup& setup, const PicaVSConfig& config);
+
+} // namespace Pica::Shader::Generator::SPIRV
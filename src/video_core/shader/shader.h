@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "common/common_types.h"
 
 namespace Pica {
@@ -29,6 +30,21 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /**
+     * Runs the currently setup shader on several shader units. Engines that can interleave vertices
+     * process up to SHADER_BATCH_SIZE units per invocation, the others run them one by one.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param units Shader unit states, each setup with the input data of one vertex.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> units) const;
+
+    /**
+     * Switches the on-disk cache of compiled programs to the specified title, engines without
+     * compiled programs ignore it.
+     */
+    virtual void SwitchDiskCache([[maybe_unused]] u64 title_id) {}
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
@@ -3,21 +3,35 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <numeric>
+#include <limits>
+#include <memory>
+#include <span>
 #include <boost/circular_buffer.hpp>
 #include <boost/container/static_vector.hpp>
 #include <nihstro/shader_bytecode.h>
+#include "common/arch.h"
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/memory_accounting.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
 #include "video_core/pica_types.h"
 #include "video_core/shader/shader_interpreter.h"
+#include "video_core/shader/shader_jit_batch.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+using nihstro::DestRegister;
 using nihstro::Instruction;
 using nihstro::OpCode;
 using nihstro::RegisterType;
@@ -26,6 +40,594 @@ using nihstro::SwizzlePattern;
 
 namespace Pica::Shader {
 
+/// Source operand of a decoded instruction, with its swizzle resolved ahead of time.
+struct DecodedSource {
+    RegisterType type{};
+    u8 index{};
+    u8 address_register{};         ///< 0 for none, 1 for a0.x, 2 for a0.y and 3 for aL
+    bool negate{};                 ///< Whether the sign of every component is flipped
+    bool identity{};               ///< Whether the components are read in xyzw order
+    std::array<u8, 4> selectors{}; ///< Component read for each of xyzw
+};
+
+/**
+ * Instruction of a program with its operand descriptor decoded, so that running it does not have
+ * to look up the swizzle data or decode the swizzle pattern again.
+ */
+struct DecodedInstruction {
+    Instruction instr{};      ///< Raw instruction, the flow control fields are read from it
+    OpCode::Id opcode{};      ///< Effective opcode
+    OpCode::Type type{};      ///< Type of the effective opcode
+    u8 operand_desc_id{};     ///< Operand descriptor, only recorded for debugging
+    u8 dest_mask{};           ///< Components written, x in the lowest bit
+    RegisterType dest_type{}; ///< Output, Temporary or Unknown for invalid destinations
+    u8 dest_index{};
+    std::array<DecodedSource, 3> src{};
+};
+
+/// Program decoded by the interpreter for a particular program code and swizzle data.
+struct InterpreterProgram {
+    std::array<DecodedInstruction, MAX_PROGRAM_CODE_LENGTH> code;
+    Common::MemoryAccounting::Allocation accounting{Common::MemoryAccounting::Category::ShaderCache,
+                                                    sizeof(code)};
+};
+
+namespace {
+
+static_assert(sizeof(f24) == sizeof(float), "The vector operations access f24 as float");
+
+// Each vector holds the four components of a register. Arithmetic follows the f24 operators,
+// including the PICA rule that multiplying infinity by zero gives zero instead of NaN.
+#if CITRA_ARCH(x86_64)
+
+using Vec = __m128;
+
+Vec Load(const f24* value) {
+    return _mm_loadu_ps(reinterpret_cast<const float*>(value));
+}
+
+void Store(f24* dest, Vec value) {
+    _mm_storeu_ps(reinterpret_cast<float*>(dest), value);
+}
+
+Vec Gather(const f24* value, const std::array<u8, 4>& selectors) {
+    return _mm_setr_ps(value[selectors[0]].ToFloat32(), value[selectors[1]].ToFloat32(),
+                       value[selectors[2]].ToFloat32(), value[selectors[3]].ToFloat32());
+}
+
+Vec Broadcast(f24 value) {
+    return _mm_set1_ps(value.ToFloat32());
+}
+
+Vec Negate(Vec value) {
+    return _mm_xor_ps(value, _mm_set1_ps(-0.0f));
+}
+
+Vec Add(Vec a, Vec b) {
+    return _mm_add_ps(a, b);
+}
+
+Vec Mul(Vec a, Vec b) {
+    const __m128 product = _mm_mul_ps(a, b);
+    const __m128 nan_product = _mm_cmpunord_ps(product, product);
+    const __m128 nan_input = _mm_cmpunord_ps(a, b);
+    return _mm_andnot_ps(_mm_andnot_ps(nan_input, nan_product), product);
+}
+
+// MAXPS and MINPS return the second operand when either is NaN, which matches the hardware.
+Vec Max(Vec a, Vec b) {
+    return _mm_max_ps(a, b);
+}
+
+Vec Min(Vec a, Vec b) {
+    return _mm_min_ps(a, b);
+}
+
+Vec GreaterEqual(Vec a, Vec b) {
+    return _mm_and_ps(_mm_cmpge_ps(a, b), _mm_set1_ps(1.0f));
+}
+
+Vec LessThan(Vec a, Vec b) {
+    return _mm_and_ps(_mm_cmplt_ps(a, b), _mm_set1_ps(1.0f));
+}
+
+void StoreMasked(f24* dest, Vec value, u8 mask) {
+    const __m128 select = _mm_castsi128_ps(
+        _mm_setr_epi32(-(mask & 1), -((mask >> 1) & 1), -((mask >> 2) & 1), -((mask >> 3) & 1)));
+    Store(dest, _mm_or_ps(_mm_and_ps(select, value), _mm_andnot_ps(select, Load(dest))));
+}
+
+#elif CITRA_ARCH(arm64)
+
+using Vec = float32x4_t;
+
+Vec Load(const f24* value) {
+    return vld1q_f32(reinterpret_cast<const float*>(value));
+}
+
+void Store(f24* dest, Vec value) {
+    vst1q_f32(reinterpret_cast<float*>(dest), value);
+}
+
+Vec Gather(const f24* value, const std::array<u8, 4>& selectors) {
+    Vec result = vdupq_n_f32(value[selectors[0]].ToFloat32());
+    result = vsetq_lane_f32(value[selectors[1]].ToFloat32(), result, 1);
+    result = vsetq_lane_f32(value[selectors[2]].ToFloat32(), result, 2);
+    return vsetq_lane_f32(value[selectors[3]].ToFloat32(), result, 3);
+}
+
+Vec Broadcast(f24 value) {
+    return vdupq_n_f32(value.ToFloat32());
+}
+
+Vec Negate(Vec value) {
+    return vnegq_f32(value);
+}
+
+Vec Add(Vec a, Vec b) {
+    return vaddq_f32(a, b);
+}
+
+Vec Mul(Vec a, Vec b) {
+    const float32x4_t product = vmulq_f32(a, b);
+    const uint32x4_t nan_product = vmvnq_u32(vceqq_f32(product, product));
+    const uint32x4_t ordered_input = vandq_u32(vceqq_f32(a, a), vceqq_f32(b, b));
+    const uint32x4_t zero = vandq_u32(nan_product, ordered_input);
+    return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(product), zero));
+}
+
+// FMAX and FMIN propagate NaN, so the comparison the hardware makes is done explicitly.
+Vec Max(Vec a, Vec b) {
+    return vbslq_f32(vcgtq_f32(a, b), a, b);
+}
+
+Vec Min(Vec a, Vec b) {
+    return vbslq_f32(vcltq_f32(a, b), a, b);
+}
+
+Vec GreaterEqual(Vec a, Vec b) {
+    return vreinterpretq_f32_u32(
+        vandq_u32(vcgeq_f32(a, b), vreinterpretq_u32_f32(vdupq_n_f32(1.0f))));
+}
+
+Vec LessThan(Vec a, Vec b) {
+    return vreinterpretq_f32_u32(
+        vandq_u32(vcltq_f32(a, b), vreinterpretq_u32_f32(vdupq_n_f32(1.0f))));
+}
+
+void StoreMasked(f24* dest, Vec value, u8 mask) {
+    static constexpr std::array<u32, 4> bits = {1, 2, 4, 8};
+    const uint32x4_t select = vtstq_u32(vdupq_n_u32(mask), vld1q_u32(bits.data()));
+    Store(dest, vbslq_f32(select, value, Load(dest)));
+}
+
+#else
+
+using Vec = Common::Vec4<f24>;
+
+Vec Load(const f24* value) {
+    return {value[0], value[1], value[2], value[3]};
+}
+
+void Store(f24* dest, const Vec& value) {
+    std::copy_n(value.AsArray(), 4, dest);
+}
+
+Vec Gather(const f24* value, const std::array<u8, 4>& selectors) {
+    return {value[selectors[0]], value[selectors[1]], value[selectors[2]], value[selectors[3]]};
+}
+
+Vec Broadcast(f24 value) {
+    return Vec::AssignToAll(value);
+}
+
+Vec Negate(const Vec& value) {
+    return {-value.x, -value.y, -value.z, -value.w};
+}
+
+Vec Add(const Vec& a, const Vec& b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+
+Vec Mul(const Vec& a, const Vec& b) {
+    return {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w};
+}
+
+Vec Max(const Vec& a, const Vec& b) {
+    const auto max = [](f24 x, f24 y) { return x > y ? x : y; };
+    return {max(a.x, b.x), max(a.y, b.y), max(a.z, b.z), max(a.w, b.w)};
+}
+
+Vec Min(const Vec& a, const Vec& b) {
+    const auto min = [](f24 x, f24 y) { return x < y ? x : y; };
+    return {min(a.x, b.x), min(a.y, b.y), min(a.z, b.z), min(a.w, b.w)};
+}
+
+Vec GreaterEqual(const Vec& a, const Vec& b) {
+    const auto sge = [](f24 x, f24 y) { return x >= y ? f24::One() : f24::Zero(); };
+    return {sge(a.x, b.x), sge(a.y, b.y), sge(a.z, b.z), sge(a.w, b.w)};
+}
+
+Vec LessThan(const Vec& a, const Vec& b) {
+    const auto slt = [](f24 x, f24 y) { return x < y ? f24::One() : f24::Zero(); };
+    return {slt(a.x, b.x), slt(a.y, b.y), slt(a.z, b.z), slt(a.w, b.w)};
+}
+
+void StoreMasked(f24* dest, const Vec& value, u8 mask) {
+    for (int i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            dest[i] = value[i];
+        }
+    }
+}
+
+#endif
+
+template <SwizzlePattern::Selector (SwizzlePattern::*GetSelector)(int) const>
+DecodedSource DecodeSource(SourceRegister reg, u32 address_register, bool negate,
+                           const SwizzlePattern& swizzle) {
+    DecodedSource source{
+        .type = reg.GetRegisterType(),
+        .index = static_cast<u8>(reg.GetIndex()),
+        .address_register = static_cast<u8>(address_register),
+        .negate = negate,
+    };
+    source.identity = true;
+    for (int i = 0; i < 4; ++i) {
+        source.selectors[i] = static_cast<u8>((swizzle.*GetSelector)(i));
+        source.identity &= source.selectors[i] == i;
+    }
+    return source;
+}
+
+void DecodeDest(DecodedInstruction& decoded, DestRegister dest, const SwizzlePattern& swizzle) {
+    decoded.dest_type = (dest < 0x10)   ? RegisterType::Output
+                        : (dest < 0x20) ? RegisterType::Temporary
+                                        : RegisterType::Unknown;
+    decoded.dest_index = static_cast<u8>(dest.GetIndex());
+    for (int i = 0; i < 4; ++i) {
+        if (swizzle.DestComponentEnabled(i)) {
+            decoded.dest_mask |= static_cast<u8>(1 << i);
+        }
+    }
+}
+
+DecodedInstruction DecodeInstruction(Instruction instr, const SwizzleData& swizzle_data) {
+    DecodedInstruction decoded{
+        .instr = instr,
+        .opcode = instr.opcode.Value().EffectiveOpCode(),
+        .type = instr.opcode.Value().GetInfo().type,
+    };
+
+    if (decoded.type == OpCode::Type::Arithmetic) {
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        decoded.operand_desc_id = static_cast<u8>(instr.common.operand_desc_id);
+        decoded.src[0] = DecodeSource<&SwizzlePattern::GetSelectorSrc1>(
+            instr.common.GetSrc1(is_inverted), !is_inverted * instr.common.address_register_index,
+            swizzle.negate_src1 != 0, swizzle);
+        decoded.src[1] = DecodeSource<&SwizzlePattern::GetSelectorSrc2>(
+            instr.common.GetSrc2(is_inverted), is_inverted * instr.common.address_register_index,
+            swizzle.negate_src2 != 0, swizzle);
+        DecodeDest(decoded, instr.common.dest.Value(), swizzle);
+    } else if (decoded.opcode == OpCode::Id::MAD || decoded.opcode == OpCode::Id::MADI) {
+        const bool is_inverted = decoded.opcode == OpCode::Id::MADI;
+        const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+        decoded.operand_desc_id = static_cast<u8>(instr.mad.operand_desc_id);
+        decoded.src[0] = DecodeSource<&SwizzlePattern::GetSelectorSrc1>(
+            instr.mad.GetSrc1(is_inverted), 0, swizzle.negate_src1 != 0, swizzle);
+        decoded.src[1] = DecodeSource<&SwizzlePattern::GetSelectorSrc2>(
+            instr.mad.GetSrc2(is_inverted), !is_inverted * instr.mad.address_register_index,
+            swizzle.negate_src2 != 0, swizzle);
+        decoded.src[2] = DecodeSource<&SwizzlePattern::GetSelectorSrc3>(
+            instr.mad.GetSrc3(is_inverted), is_inverted * instr.mad.address_register_index,
+            swizzle.negate_src3 != 0, swizzle);
+        DecodeDest(decoded, instr.mad.dest.Value(), swizzle);
+    }
+    return decoded;
+}
+
+std::unique_ptr<InterpreterProgram> DecodeProgram(const ProgramCode& program_code,
+                                                  const SwizzleData& swizzle_data) {
+    auto program = std::make_unique<InterpreterProgram>();
+    for (u32 offset = 0; offset < MAX_PROGRAM_CODE_LENGTH - 1; ++offset) {
+        program->code[offset] = DecodeInstruction({program_code[offset]}, swizzle_data);
+    }
+
+    // Always treat the last instruction of the program code as an
+    // end instruction. This fixes some games such as Thunder Blade
+    // or After Burner II which have malformed geo shaders without an
+    // end instruction crashing the emulator due to the program counter
+    // growing uncontrollably.
+    // TODO(PabloMK7): Find how real HW reacts to this, most likely the
+    // program counter wraps around after reaching the last instruction,
+    // but more testing is needed.
+    Instruction end{};
+    end.opcode.Assign(OpCode::Id::END);
+    program->code[MAX_PROGRAM_CODE_LENGTH - 1] = DecodeInstruction(end, swizzle_data);
+    return program;
+}
+
+// Constants for handling invalid inputs
+alignas(16) constexpr std::array<f24, 4> dummy_vec4_float24_zeros = {
+    f24::Zero(), f24::Zero(), f24::Zero(), f24::Zero()};
+alignas(16) constexpr std::array<f24, 4> dummy_vec4_float24_ones = {f24::One(), f24::One(),
+                                                                     f24::One(), f24::One()};
+
+const f24* LookupSourceRegister(const DecodedSource& source, const ShaderUnit& state,
+                                const s32* address_registers, const Uniforms& uniforms) {
+    switch (source.type) {
+    case RegisterType::Input:
+        return &state.input[source.index].x;
+
+    case RegisterType::Temporary:
+        return &state.temporary[source.index].x;
+
+    case RegisterType::FloatUniform: {
+        int index = source.index;
+        if (source.address_register != 0) {
+            int offset = address_registers[source.address_register - 1];
+            if (offset < std::numeric_limits<s8>::min() ||
+                offset > std::numeric_limits<s8>::max()) [[unlikely]] {
+                offset = 0;
+            }
+            index = (index + offset) & 0x7F;
+            // If the index is above 96, the result is all one.
+            if (index >= 96) [[unlikely]] {
+                return dummy_vec4_float24_ones.data();
+            }
+        }
+        return &uniforms.f[index].x;
+    }
+
+    default:
+        return dummy_vec4_float24_zeros.data();
+    }
+}
+
+Vec LoadSource(const DecodedSource& source, const ShaderUnit& state,
+               const s32* address_registers, const Uniforms& uniforms) {
+    const f24* reg = LookupSourceRegister(source, state, address_registers, uniforms);
+    const Vec value = source.identity ? Load(reg) : Gather(reg, source.selectors);
+    return source.negate ? Negate(value) : value;
+}
+
+template <DebugDataRecord::Type type, bool Debug>
+void RecordVec(DebugData<Debug>& debug_data, u32 iteration, const Vec& value) {
+    if constexpr (Debug) {
+        alignas(16) f24 components[4];
+        Store(components, value);
+        Record<type>(debug_data, iteration, components);
+    }
+}
+
+/**
+ * Runs an arithmetic or multiply-add instruction on one shader unit.
+ * @param address_registers Address registers the float uniforms are indexed with, which are those
+ *                          of the unit running the control flow when several units run at once.
+ */
+template <bool Debug>
+void RunArithmetic(const DecodedInstruction& decoded, ShaderUnit& state,
+                   const s32* address_registers, const Uniforms& uniforms,
+                   DebugData<Debug>& debug_data, u32 iteration) {
+    const auto load_source = [&](std::size_t index) {
+        return LoadSource(decoded.src[index], state, address_registers, uniforms);
+    };
+
+    alignas(16) f24 discarded[4];
+    f24* dest = (decoded.dest_type == RegisterType::Output)
+                    ? &state.output[decoded.dest_index][0]
+                : (decoded.dest_type == RegisterType::Temporary)
+                    ? &state.temporary[decoded.dest_index][0]
+                    : discarded;
+
+    const auto write_dest = [&](const Vec& value) {
+        Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
+        StoreMasked(dest, value, decoded.dest_mask);
+        Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
+    };
+
+    const auto binary_op = [&](auto op) {
+        const Vec src1 = load_source(0);
+        const Vec src2 = load_source(1);
+        RecordVec<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        RecordVec<DebugDataRecord::SRC2>(debug_data, iteration, src2);
+        write_dest(op(src1, src2));
+    };
+
+    // Instructions computing a single value from the first component of src1 and writing it to
+    // all the enabled components.
+    const auto scalar_op = [&](auto op) {
+        alignas(16) f24 src1[4];
+        Store(src1, load_source(0));
+        Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        write_dest(Broadcast(f24::FromFloat32(op(src1[0].ToFloat32()))));
+    };
+
+    if constexpr (Debug) {
+        debug_data.max_opdesc_id =
+            std::max<u32>(debug_data.max_opdesc_id, 1 + decoded.operand_desc_id);
+    }
+
+    switch (decoded.opcode) {
+    case OpCode::Id::ADD:
+        binary_op(Add);
+        break;
+
+    case OpCode::Id::MUL:
+        binary_op(Mul);
+        break;
+
+    case OpCode::Id::FLR: {
+        alignas(16) f24 src1[4];
+        Store(src1, load_source(0));
+        Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        for (f24& component : src1) {
+            component = f24::FromFloat32(std::floor(component.ToFloat32()));
+        }
+        write_dest(Load(src1));
+        break;
+    }
+
+    // NOTE: Exact form required to match NaN semantics to hardware:
+    //   max(0, NaN) -> NaN
+    //   max(NaN, 0) -> 0
+    case OpCode::Id::MAX:
+        binary_op(Max);
+        break;
+
+    case OpCode::Id::MIN:
+        binary_op(Min);
+        break;
+
+    case OpCode::Id::DP3:
+    case OpCode::Id::DP4:
+    case OpCode::Id::DPH:
+    case OpCode::Id::DPHI: {
+        alignas(16) f24 src1[4];
+        Store(src1, load_source(0));
+        const Vec src2 = load_source(1);
+        Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        RecordVec<DebugDataRecord::SRC2>(debug_data, iteration, src2);
+
+        if (decoded.opcode == OpCode::Id::DPH || decoded.opcode == OpCode::Id::DPHI) {
+            src1[3] = f24::One();
+        }
+
+        // The products are summed in order, like the hardware does.
+        alignas(16) f24 products[4];
+        Store(products, Mul(Load(src1), src2));
+        const int num_components = (decoded.opcode == OpCode::Id::DP3) ? 3 : 4;
+        f24 dot = f24::Zero();
+        for (int i = 0; i < num_components; ++i) {
+            dot = dot + products[i];
+        }
+        write_dest(Broadcast(dot));
+        break;
+    }
+
+    // Reciprocal
+    case OpCode::Id::RCP:
+        scalar_op([](float value) { return 1.0f / value; });
+        break;
+
+    // Reciprocal Square Root
+    case OpCode::Id::RSQ:
+        scalar_op([](float value) { return 1.0f / std::sqrt(value); });
+        break;
+
+    // EX2 and LG2 only take the first component and write the result to all dest components
+    case OpCode::Id::EX2:
+        scalar_op([](float value) { return std::exp2(value); });
+        break;
+
+    case OpCode::Id::LG2:
+        scalar_op([](float value) { return std::log2(value); });
+        break;
+
+    case OpCode::Id::MOVA: {
+        alignas(16) f24 src1[4];
+        Store(src1, load_source(0));
+        Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        for (int i = 0; i < 2; ++i) {
+            if (!(decoded.dest_mask & (1 << i)))
+                continue;
+
+            // TODO: Figure out how the rounding is done on hardware
+            state.address_registers[i] = static_cast<s32>(src1[i].ToFloat32());
+        }
+        Record<DebugDataRecord::ADDR_REG_OUT>(debug_data, iteration, state.address_registers);
+        break;
+    }
+
+    case OpCode::Id::MOV: {
+        const Vec src1 = load_source(0);
+        RecordVec<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        write_dest(src1);
+        break;
+    }
+
+    case OpCode::Id::SGE:
+    case OpCode::Id::SGEI:
+        binary_op(GreaterEqual);
+        break;
+
+    case OpCode::Id::SLT:
+    case OpCode::Id::SLTI:
+        binary_op(LessThan);
+        break;
+
+    case OpCode::Id::CMP: {
+        alignas(16) f24 src1[4];
+        alignas(16) f24 src2[4];
+        Store(src1, load_source(0));
+        Store(src2, load_source(1));
+        Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
+        for (int i = 0; i < 2; ++i) {
+            // TODO: Can you restrict to one compare via dest masking?
+
+            auto compare_op = decoded.instr.common.compare_op;
+            auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+
+            switch (op) {
+            case Instruction::Common::CompareOpType::Equal:
+                state.conditional_code[i] = (src1[i] == src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::NotEqual:
+                state.conditional_code[i] = (src1[i] != src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::LessThan:
+                state.conditional_code[i] = (src1[i] < src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::LessEqual:
+                state.conditional_code[i] = (src1[i] <= src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::GreaterThan:
+                state.conditional_code[i] = (src1[i] > src2[i]);
+                break;
+
+            case Instruction::Common::CompareOpType::GreaterEqual:
+                state.conditional_code[i] = (src1[i] >= src2[i]);
+                break;
+
+            default:
+                LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(op));
+                break;
+            }
+        }
+        Record<DebugDataRecord::CMP_RESULT>(debug_data, iteration, state.conditional_code);
+        break;
+    }
+
+    case OpCode::Id::MAD:
+    case OpCode::Id::MADI: {
+        const Vec src1 = load_source(0);
+        const Vec src2 = load_source(1);
+        const Vec src3 = load_source(2);
+        RecordVec<DebugDataRecord::SRC1>(debug_data, iteration, src1);
+        RecordVec<DebugDataRecord::SRC2>(debug_data, iteration, src2);
+        RecordVec<DebugDataRecord::SRC3>(debug_data, iteration, src3);
+        write_dest(Add(Mul(src1, src2), src3));
+        break;
+    }
+
+    default:
+        LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x{:02x} ({}): 0x{:08x}",
+                  (int)decoded.opcode, decoded.instr.opcode.Value().GetInfo().name,
+                  decoded.instr.hex);
+        DEBUG_ASSERT(false);
+        break;
+    }
+}
+
+} // Anonymous namespace
+
 struct IfStackElement {
     u32 else_address;
     u32 end_address;
@@ -44,9 +646,16 @@ struct LoopStackElement {
     u8 previous_aL;
 };
 
+/**
+ * Runs the program on the given shader units. The control flow is evaluated on the first unit
+ * and each instruction is applied to all the units before moving to the next one, so several
+ * units may only run at once with programs that take the same path for every vertex.
+ */
 template <bool Debug>
-static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
-                           DebugData<Debug>& debug_data, unsigned entry_point) {
+static void RunInterpreter(const InterpreterProgram& program, const Uniforms& uniforms,
+                           std::span<ShaderUnit> units, DebugData<Debug>& debug_data,
+                           unsigned entry_point) {
+    ShaderUnit& state = units.front();
     boost::circular_buffer<IfStackElement> if_stack(8);
     boost::circular_buffer<CallStackElement> call_stack(4);
     boost::circular_buffer<LoopStackElement> loop_stack(4);
@@ -104,36 +713,17 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
         }
     };
 
-    const auto& uniforms = setup.uniforms;
-    const auto& swizzle_data = setup.GetSwizzleData();
-    const auto& program_code = setup.GetProgramCode();
-
-    // Constants for handling invalid inputs
-    static f24 dummy_vec4_float24_zeros[4] = {f24::Zero(), f24::Zero(), f24::Zero(), f24::Zero()};
-    static f24 dummy_vec4_float24_ones[4] = {f24::One(), f24::One(), f24::One(), f24::One()};
-
     u32 iteration = 0;
     bool should_stop = false;
     while (!should_stop) {
         bool is_break = false;
         const u32 old_program_counter = program_counter;
 
-        // Always treat the last instruction of the program code as an
-        // end instruction. This fixes some games such as Thunder Blade
-        // or After Burner II which have malformed geo shaders without an
-        // end instruction crashing the emulator due to the program counter
-        // growing uncontrollably.
-        // TODO(PabloMK7): Find how real HW reacts to this, most likely the
-        // program counter wraps around after reaching the last instruction,
-        // but more testing is needed.
-        Instruction instr{};
-        if (program_counter < MAX_PROGRAM_CODE_LENGTH - 1) {
-            instr.hex = program_code[program_counter];
-        } else {
-            instr.opcode.Assign(OpCode::Id::END);
-        }
-
-        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        // The last instruction of the program code is decoded as an end instruction, which the
+        // program counter never moves past.
+        const DecodedInstruction& decoded =
+            program.code[std::min(program_counter, MAX_PROGRAM_CODE_LENGTH - 1)];
+        const Instruction instr = decoded.instr;
 
         Record<DebugDataRecord::CUR_INSTR>(debug_data, iteration, program_counter);
         if (iteration > 0)
@@ -141,428 +731,20 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
 
         debug_data.max_offset = std::max<u32>(debug_data.max_offset, 1 + program_counter);
 
-        auto LookupSourceRegister = [&](const SourceRegister& source_reg,
-                                        int address_register_index) -> const f24* {
-            int index = source_reg.GetIndex();
-            switch (source_reg.GetRegisterType()) {
-            case RegisterType::Input:
-                return &state.input[index].x;
-
-            case RegisterType::Temporary:
-                return &state.temporary[index].x;
-
-            case RegisterType::FloatUniform:
-                if (address_register_index != 0) {
-                    int offset = state.address_registers[address_register_index - 1];
-                    if (offset < std::numeric_limits<s8>::min() ||
-                        offset > std::numeric_limits<s8>::max()) [[unlikely]] {
-                        offset = 0;
-                    }
-                    index = (index + offset) & 0x7F;
-                    // If the index is above 96, the result is all one.
-                    if (index >= 96) [[unlikely]] {
-                        return dummy_vec4_float24_ones;
-                    }
-                }
-                return &uniforms.f[index].x;
-
-            default:
-                return dummy_vec4_float24_zeros;
-            }
-        };
-
-        switch (instr.opcode.Value().GetInfo().type) {
-        case OpCode::Type::Arithmetic: {
-            const bool is_inverted =
-                (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
-
-            const f24* src1_ =
-                LookupSourceRegister(instr.common.GetSrc1(is_inverted),
-                                     !is_inverted * instr.common.address_register_index);
-            const f24* src2_ =
-                LookupSourceRegister(instr.common.GetSrc2(is_inverted),
-                                     is_inverted * instr.common.address_register_index);
-
-            const bool negate_src1 = swizzle.negate_src1.Value() != 0;
-            const bool negate_src2 = swizzle.negate_src2.Value() != 0;
-
-            f24 src1[4] = {
-                src1_[(int)swizzle.src1_selector_0.Value()],
-                src1_[(int)swizzle.src1_selector_1.Value()],
-                src1_[(int)swizzle.src1_selector_2.Value()],
-                src1_[(int)swizzle.src1_selector_3.Value()],
-            };
-            if (negate_src1) {
-                src1[0] = -src1[0];
-                src1[1] = -src1[1];
-                src1[2] = -src1[2];
-                src1[3] = -src1[3];
-            }
-            f24 src2[4] = {
-                src2_[(int)swizzle.src2_selector_0.Value()],
-                src2_[(int)swizzle.src2_selector_1.Value()],
-                src2_[(int)swizzle.src2_selector_2.Value()],
-                src2_[(int)swizzle.src2_selector_3.Value()],
-            };
-            if (negate_src2) {
-                src2[0] = -src2[0];
-                src2[1] = -src2[1];
-                src2[2] = -src2[2];
-                src2[3] = -src2[3];
-            }
-
-            f24* dest = (instr.common.dest.Value() < 0x10)
-                            ? &state.output[instr.common.dest.Value().GetIndex()][0]
-                        : (instr.common.dest.Value() < 0x20)
-                            ? &state.temporary[instr.common.dest.Value().GetIndex()][0]
-                            : dummy_vec4_float24_zeros;
-
-            debug_data.max_opdesc_id =
-                std::max<u32>(debug_data.max_opdesc_id, 1 + instr.common.operand_desc_id);
-
-            switch (instr.opcode.Value().EffectiveOpCode()) {
-            case OpCode::Id::ADD: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] + src2[i];
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            case OpCode::Id::MUL: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] * src2[i];
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
+        switch (decoded.type) {
+        case OpCode::Type::Arithmetic:
+            for (ShaderUnit& unit : units) {
+                RunArithmetic(decoded, unit, state.address_registers, uniforms, debug_data,
+                              iteration);
             }
-
-            case OpCode::Id::FLR:
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = f24::FromFloat32(std::floor(src1[i].ToFloat32()));
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-
-            case OpCode::Id::MAX:
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // NOTE: Exact form required to match NaN semantics to hardware:
-                    //   max(0, NaN) -> NaN
-                    //   max(NaN, 0) -> 0
-                    dest[i] = (src1[i] > src2[i]) ? src1[i] : src2[i];
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-
-            case OpCode::Id::MIN:
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // NOTE: Exact form required to match NaN semantics to hardware:
-                    //   min(0, NaN) -> NaN
-                    //   min(NaN, 0) -> 0
-                    dest[i] = (src1[i] < src2[i]) ? src1[i] : src2[i];
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-
-            case OpCode::Id::DP3:
-            case OpCode::Id::DP4:
-            case OpCode::Id::DPH:
-            case OpCode::Id::DPHI: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-
-                OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
-                if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
-                    src1[3] = f24::One();
-
-                int num_components = (opcode == OpCode::Id::DP3) ? 3 : 4;
-                f24 dot = std::inner_product(src1, src1 + num_components, src2, f24::Zero());
-
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = dot;
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            // Reciprocal
-            case OpCode::Id::RCP: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                f24 rcp_res = f24::FromFloat32(1.0f / src1[0].ToFloat32());
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = rcp_res;
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            // Reciprocal Square Root
-            case OpCode::Id::RSQ: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                f24 rsq_res = f24::FromFloat32(1.0f / std::sqrt(src1[0].ToFloat32()));
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = rsq_res;
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            case OpCode::Id::MOVA: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                for (int i = 0; i < 2; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    // TODO: Figure out how the rounding is done on hardware
-                    state.address_registers[i] = static_cast<s32>(src1[i].ToFloat32());
-                }
-                Record<DebugDataRecord::ADDR_REG_OUT>(debug_data, iteration,
-                                                      state.address_registers);
-                break;
-            }
-
-            case OpCode::Id::MOV: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i];
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            case OpCode::Id::SGE:
-            case OpCode::Id::SGEI:
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = (src1[i] >= src2[i]) ? f24::One() : f24::Zero();
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-
-            case OpCode::Id::SLT:
-            case OpCode::Id::SLTI:
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = (src1[i] < src2[i]) ? f24::One() : f24::Zero();
-                }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-
-            case OpCode::Id::CMP:
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                for (int i = 0; i < 2; ++i) {
-                    // TODO: Can you restrict to one compare via dest masking?
-
-                    auto compare_op = instr.common.compare_op;
-                    auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
-
-                    switch (op) {
-                    case Instruction::Common::CompareOpType::Equal:
-                        state.conditional_code[i] = (src1[i] == src2[i]);
-                        break;
-
-                    case Instruction::Common::CompareOpType::NotEqual:
-                        state.conditional_code[i] = (src1[i] != src2[i]);
-                        break;
-
-                    case Instruction::Common::CompareOpType::LessThan:
-                        state.conditional_code[i] = (src1[i] < src2[i]);
-                        break;
-
-                    case Instruction::Common::CompareOpType::LessEqual:
-                        state.conditional_code[i] = (src1[i] <= src2[i]);
-                        break;
-
-                    case Instruction::Common::CompareOpType::GreaterThan:
-                        state.conditional_code[i] = (src1[i] > src2[i]);
-                        break;
-
-                    case Instruction::Common::CompareOpType::GreaterEqual:
-                        state.conditional_code[i] = (src1[i] >= src2[i]);
-                        break;
-
-                    default:
-                        LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(op));
-                        break;
-                    }
-                }
-                Record<DebugDataRecord::CMP_RESULT>(debug_data, iteration, state.conditional_code);
-                break;
-
-            case OpCode::Id::EX2: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-
-                // EX2 only takes first component exp2 and writes it to all dest components
-                f24 ex2_res = f24::FromFloat32(std::exp2(src1[0].ToFloat32()));
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = ex2_res;
-                }
-
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            case OpCode::Id::LG2: {
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-
-                // LG2 only takes the first component log2 and writes it to all dest components
-                f24 lg2_res = f24::FromFloat32(std::log2(src1[0].ToFloat32()));
-                for (int i = 0; i < 4; ++i) {
-                    if (!swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = lg2_res;
-                }
-
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
-                break;
-            }
-
-            default:
-                LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x{:02x} ({}): 0x{:08x}",
-                          (int)instr.opcode.Value().EffectiveOpCode(),
-                          instr.opcode.Value().GetInfo().name, instr.hex);
-                DEBUG_ASSERT(false);
-                break;
-            }
-
             break;
-        }
 
         case OpCode::Type::MultiplyAdd: {
-            if ((instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD) ||
-                (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI)) {
-                const SwizzlePattern& mad_swizzle = *reinterpret_cast<const SwizzlePattern*>(
-                    &swizzle_data[instr.mad.operand_desc_id]);
-
-                bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
-
-                const f24* src1_ = LookupSourceRegister(instr.mad.GetSrc1(is_inverted), 0);
-                const f24* src2_ =
-                    LookupSourceRegister(instr.mad.GetSrc2(is_inverted),
-                                         !is_inverted * instr.mad.address_register_index);
-                const f24* src3_ = LookupSourceRegister(
-                    instr.mad.GetSrc3(is_inverted), is_inverted * instr.mad.address_register_index);
-
-                const bool negate_src1 = mad_swizzle.negate_src1.Value() != 0;
-                const bool negate_src2 = mad_swizzle.negate_src2.Value() != 0;
-                const bool negate_src3 = mad_swizzle.negate_src3.Value() != 0;
-
-                f24 src1[4] = {
-                    src1_[(int)mad_swizzle.src1_selector_0.Value()],
-                    src1_[(int)mad_swizzle.src1_selector_1.Value()],
-                    src1_[(int)mad_swizzle.src1_selector_2.Value()],
-                    src1_[(int)mad_swizzle.src1_selector_3.Value()],
-                };
-                if (negate_src1) {
-                    src1[0] = -src1[0];
-                    src1[1] = -src1[1];
-                    src1[2] = -src1[2];
-                    src1[3] = -src1[3];
-                }
-                f24 src2[4] = {
-                    src2_[(int)mad_swizzle.src2_selector_0.Value()],
-                    src2_[(int)mad_swizzle.src2_selector_1.Value()],
-                    src2_[(int)mad_swizzle.src2_selector_2.Value()],
-                    src2_[(int)mad_swizzle.src2_selector_3.Value()],
-                };
-                if (negate_src2) {
-                    src2[0] = -src2[0];
-                    src2[1] = -src2[1];
-                    src2[2] = -src2[2];
-                    src2[3] = -src2[3];
-                }
-                f24 src3[4] = {
-                    src3_[(int)mad_swizzle.src3_selector_0.Value()],
-                    src3_[(int)mad_swizzle.src3_selector_1.Value()],
-                    src3_[(int)mad_swizzle.src3_selector_2.Value()],
-                    src3_[(int)mad_swizzle.src3_selector_3.Value()],
-                };
-                if (negate_src3) {
-                    src3[0] = -src3[0];
-                    src3[1] = -src3[1];
-                    src3[2] = -src3[2];
-                    src3[3] = -src3[3];
-                }
-
-                f24* dest = (instr.mad.dest.Value() < 0x10)
-                                ? &state.output[instr.mad.dest.Value().GetIndex()][0]
-                            : (instr.mad.dest.Value() < 0x20)
-                                ? &state.temporary[instr.mad.dest.Value().GetIndex()][0]
-                                : dummy_vec4_float24_zeros;
-
-                Record<DebugDataRecord::SRC1>(debug_data, iteration, src1);
-                Record<DebugDataRecord::SRC2>(debug_data, iteration, src2);
-                Record<DebugDataRecord::SRC3>(debug_data, iteration, src3);
-                Record<DebugDataRecord::DEST_IN>(debug_data, iteration, dest);
-                for (int i = 0; i < 4; ++i) {
-                    if (!mad_swizzle.DestComponentEnabled(i))
-                        continue;
-
-                    dest[i] = src1[i] * src2[i] + src3[i];
+            if ((decoded.opcode == OpCode::Id::MAD) || (decoded.opcode == OpCode::Id::MADI)) {
+                for (ShaderUnit& unit : units) {
+                    RunArithmetic(decoded, unit, state.address_registers, uniforms, debug_data,
+                                  iteration);
                 }
-                Record<DebugDataRecord::DEST_OUT>(debug_data, iteration, dest);
             } else {
                 LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
                           (int)instr.opcode.Value().EffectiveOpCode(),
@@ -732,12 +914,37 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
             }
         }
     }
+
+    for (ShaderUnit& unit : units.subspan(1)) {
+        unit.address_registers[2] = state.address_registers[2];
+    }
 }
 
+InterpreterEngine::InterpreterEngine() = default;
+InterpreterEngine::~InterpreterEngine() = default;
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.DoProgramCodeFixup();
     setup.entry_point = entry_point;
+
+    const u64 cache_key =
+        Common::HashCombine(setup.GetProgramCodeHash(), setup.GetSwizzleDataHash());
+    const u64 batch_key = Common::HashCombine(cache_key, entry_point);
+
+    auto iter = cache.find(cache_key);
+    if (iter == cache.end()) {
+        iter = cache.emplace_hint(iter, cache_key,
+                                  DecodeProgram(setup.GetProgramCode(), setup.GetSwizzleData()));
+    }
+    setup.cached_shader = iter->second.get();
+
+    auto batch_iter = batchable.find(batch_key);
+    if (batch_iter == batchable.end()) {
+        const bool can_batch = AnalyzeBatchProgram(setup.GetProgramCode(), entry_point).has_value();
+        batch_iter = batchable.emplace_hint(batch_iter, batch_key, can_batch);
+    }
+    setup.cached_batch_shader = batch_iter->second ? setup.cached_shader : nullptr;
 }
 
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
@@ -747,7 +954,22 @@ void InterpreterEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     MICROPROFILE_SCOPE(GPU_Shader);
 
     DebugData<false> dummy_debug_data;
-    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
+    const auto& program = *static_cast<const InterpreterProgram*>(setup.cached_shader);
+    RunInterpreter(program, setup.uniforms, std::span{&state, 1}, dummy_debug_data,
+                   setup.entry_point);
+}
+
+void InterpreterEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> units) const {
+    if (!setup.cached_batch_shader || units.size() < 2) {
+        ShaderEngine::RunBatch(setup, units);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    DebugData<false> dummy_debug_data;
+    const auto& program = *static_cast<const InterpreterProgram*>(setup.cached_batch_shader);
+    RunInterpreter(program, setup.uniforms, units, dummy_debug_data, setup.entry_point);
 }
 
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
@@ -759,8 +981,11 @@ DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
     // Setup input register table
     state.input.fill(Common::Vec4<f24>::AssignToAll(f24::Zero()));
     state.LoadInput(config, input);
-    RunInterpreter(setup, state, debug_data, setup.entry_point);
+    const auto program = DecodeProgram(setup.GetProgramCode(), setup.GetSwizzleData());
+    RunInterpreter(*program, setup.uniforms, std::span{&state, 1}, debug_data, setup.entry_point);
     return debug_data;
 }
 
 } // namespace Pica::Shader
+
+
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
 #include "video_core/pica/output_vertex.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
@@ -14,10 +16,16 @@ struct ShaderRegs;
 
 namespace Pica::Shader {
 
+struct InterpreterProgram;
+
 class InterpreterEngine final : public ShaderEngine {
 public:
+    InterpreterEngine();
+    ~InterpreterEngine() override;
+
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> units) const override;
 
     /**
      * Produce debug information based on the given shader and input vertex
@@ -28,6 +36,13 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const AttributeBuffer& input,
                                      const ShaderRegs& config) const;
+
+private:
+    /// Decoded programs, keyed by program code and swizzle data like the shaders of the JIT.
+    std::unordered_map<u64, std::unique_ptr<InterpreterProgram>> cache;
+    /// Whether a program takes the same path for every vertex from an entry point, in which case
+    /// the units of a batch run it together.
+    std::unordered_map<u64, bool> batchable;
 };
 
 } // namespace Pica::Shader
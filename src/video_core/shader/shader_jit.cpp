@@ -5,20 +5,77 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <algorithm>
+#include <cstring>
+#include <nihstro/shader_bytecode.h>
 #include "common/assert.h"
 #include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
+#include "common/thread.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
+#include "video_core/shader/shader_jit_batch.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 #if CITRA_ARCH(arm64)
+#include "video_core/shader/shader_jit_a64_batch_compiler.h"
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
 #if CITRA_ARCH(x86_64)
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 #endif
 
 namespace Pica::Shader {
 
+namespace {
+
+std::unique_ptr<JitShader> CompileShader(const ProgramCode& program_code,
+                                         const SwizzleData& swizzle_data,
+                                         const ControlUniforms* control = nullptr) {
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&program_code, &swizzle_data, control);
+    return shader;
+}
+
+/// Collects the bool and integer uniforms the flow control instructions of the program read.
+void ScanControlUniforms(const ProgramCode& program_code, u16& bool_mask, u8& int_mask) {
+    for (const u32 word : program_code) {
+        const nihstro::Instruction instr = {word};
+        switch (instr.opcode.Value().EffectiveOpCode()) {
+        case nihstro::OpCode::Id::CALLU:
+        case nihstro::OpCode::Id::IFU:
+        case nihstro::OpCode::Id::JMPU:
+            bool_mask |= static_cast<u16>(1U << instr.flow_control.bool_uniform_id);
+            break;
+        case nihstro::OpCode::Id::LOOP:
+            int_mask |= static_cast<u8>(1U << instr.flow_control.int_uniform_id);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/// Returns nullptr when the host or the program does not allow running it batched.
+std::unique_ptr<JitBatchShader> CompileBatchShader(const ProgramCode& program_code,
+                                                   const SwizzleData& swizzle_data,
+                                                   u32 entry_point) {
+    if (!JitBatchShader::IsSupported()) {
+        return nullptr;
+    }
+    const auto info = AnalyzeBatchProgram(program_code, entry_point);
+    if (!info) {
+        return nullptr;
+    }
+    auto batch_shader = std::make_unique<JitBatchShader>();
+    batch_shader->Compile(&program_code, &swizzle_data, *info);
+    return batch_shader;
+}
+
+} // Anonymous namespace
+
 JitEngine::JitEngine() = default;
 JitEngine::~JitEngine() = default;
 
@@ -31,15 +88,172 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     const u64 swizzle_hash = setup.GetSwizzleDataHash();
 
     const u64 cache_key = Common::HashCombine(code_hash, swizzle_hash);
+    const u64 batch_key = Common::HashCombine(cache_key, entry_point);
+
     auto iter = cache.find(cache_key);
-    if (iter != cache.end()) {
-        setup.cached_shader = iter->second.get();
-    } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.GetProgramCode(), &setup.GetSwizzleData());
-        setup.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+    if (iter == cache.end()) {
+        std::unique_ptr<JitShader> shader;
+        {
+            std::scoped_lock lock{preload_mutex};
+            if (auto node = preloaded_shaders.extract(cache_key)) {
+                shader = std::move(node.mapped());
+            }
+        }
+        if (!shader) {
+            shader = CompileShader(setup.GetProgramCode(), setup.GetSwizzleData());
+        }
+        iter = cache.emplace_hint(iter, cache_key, std::move(shader));
+    }
+    setup.cached_shader = GetSpecializedShader(setup, cache_key, iter->second.get());
+
+    auto batch_iter = batch_cache.find(batch_key);
+    if (batch_iter == batch_cache.end()) {
+        std::unique_ptr<JitBatchShader> batch_shader;
+        bool batch_preloaded = false;
+        {
+            std::scoped_lock lock{preload_mutex};
+            if (auto node = preloaded_batch_shaders.extract(batch_key)) {
+                batch_shader = std::move(node.mapped());
+                batch_preloaded = true;
+            }
+        }
+        if (!batch_preloaded) {
+            batch_shader =
+                CompileBatchShader(setup.GetProgramCode(), setup.GetSwizzleData(), entry_point);
+        }
+        batch_iter = batch_cache.emplace_hint(batch_iter, batch_key, std::move(batch_shader));
+
+        // Record every new program and entry point pair so the next boot can compile it ahead of
+        // time. The program code is stored after the fixup, as it was hashed.
+        if (disk_cache && !batch_preloaded) {
+            auto entry = std::make_unique<JitDiskCacheEntry>();
+            entry->cache_key = cache_key;
+            entry->entry_point = entry_point;
+            entry->program_code = setup.GetProgramCode();
+            entry->swizzle_data = setup.GetSwizzleData();
+            disk_cache->Append(*entry);
+        }
+    }
+    setup.cached_batch_shader = batch_iter->second.get();
+}
+
+void JitEngine::SwitchDiskCache(u64 title_id) {
+    if (!Settings::values.use_disk_shader_cache || title_id == 0) {
+        preload_thread = {};
+        disk_cache.reset();
+        return;
+    }
+    if (disk_cache && disk_cache->GetTitleID() == title_id) {
+        return;
+    }
+
+    // Stop the preload of the previous title before replacing its cache.
+    preload_thread = {};
+    {
+        std::scoped_lock lock{preload_mutex};
+        preloaded_shaders.clear();
+        preloaded_batch_shaders.clear();
+    }
+    disk_cache = std::make_unique<JitDiskCache>(title_id);
+    preload_thread =
+        std::jthread([this](std::stop_token stop_token) { PreloadDiskCache(stop_token); });
+}
+
+void JitEngine::PreloadDiskCache(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("ShaderJitPreload");
+
+    const std::vector<JitDiskCacheEntry> entries = disk_cache->Load();
+    std::size_t num_compiled = 0;
+    for (const JitDiskCacheEntry& entry : entries) {
+        if (stop_token.stop_requested()) {
+            return;
+        }
+
+        const u64 batch_key = Common::HashCombine(entry.cache_key, entry.entry_point);
+        bool needs_shader;
+        bool needs_batch_shader;
+        {
+            std::scoped_lock lock{preload_mutex};
+            needs_shader = !preloaded_shaders.contains(entry.cache_key);
+            needs_batch_shader = !preloaded_batch_shaders.contains(batch_key);
+        }
+
+        // Compile outside the lock so the emulation thread is never blocked behind a compile.
+        std::unique_ptr<JitShader> shader;
+        if (needs_shader) {
+            shader = CompileShader(entry.program_code, entry.swizzle_data);
+        }
+        std::unique_ptr<JitBatchShader> batch_shader;
+        if (needs_batch_shader) {
+            batch_shader =
+                CompileBatchShader(entry.program_code, entry.swizzle_data, entry.entry_point);
+        }
+
+        std::scoped_lock lock{preload_mutex};
+        if (shader) {
+            preloaded_shaders.try_emplace(entry.cache_key, std::move(shader));
+        }
+        if (needs_batch_shader) {
+            preloaded_batch_shaders.try_emplace(batch_key, std::move(batch_shader));
+        }
+        ++num_compiled;
+    }
+
+    LOG_INFO(HW_GPU, "Compiled {} programs from the shader JIT cache", num_compiled);
+}
+
+const JitShader* JitEngine::GetSpecializedShader(ShaderSetup& setup, u64 cache_key,
+                                                 const JitShader* generic) {
+    auto [control_iter, new_program] = program_controls.try_emplace(cache_key);
+    ProgramControl& program = control_iter->second;
+    if (new_program) {
+        ScanControlUniforms(setup.GetProgramCode(), program.bool_mask, program.int_mask);
+    }
+    if (program.bool_mask == 0 && program.int_mask == 0) {
+        return generic;
+    }
+
+    // Only the uniforms the program reads tell its variants apart
+    ControlUniforms control{};
+    for (u32 i = 0; i < setup.uniforms.b.size(); ++i) {
+        if (((program.bool_mask >> i) & 1) && setup.uniforms.b[i]) {
+            control.b |= static_cast<u16>(1U << i);
+        }
+    }
+    for (u32 i = 0; i < setup.uniforms.i.size(); ++i) {
+        if ((program.int_mask >> i) & 1) {
+            std::memcpy(&control.i[i], &setup.uniforms.i[i], sizeof(u32));
+        }
     }
+    u64 variant_key = Common::HashCombine(cache_key, control.b);
+    for (const u32 value : control.i) {
+        variant_key = Common::HashCombine(variant_key, value);
+    }
+
+    if (!specialized_shaders.contains(variant_key)) {
+        if (program.num_variants >= MAX_VARIANTS_PER_PROGRAM) {
+            return generic;
+        }
+        program.num_variants++;
+    }
+    auto [found, variant] = specialized_shaders.request(variant_key);
+    if (!found) {
+        // The slot may hold the least recently used shader, which no setup may keep using
+        if (variant.shader) {
+            for (ShaderSetup* other : specialized_setups) {
+                if (other->cached_shader == variant.shader.get()) {
+                    other->cached_shader = variant.generic;
+                }
+            }
+        }
+        variant.shader = CompileShader(setup.GetProgramCode(), setup.GetSwizzleData(), &control);
+        variant.generic = generic;
+    }
+    if (std::find(specialized_setups.begin(), specialized_setups.end(), &setup) ==
+        specialized_setups.end()) {
+        specialized_setups.push_back(&setup);
+    }
+    return variant.shader.get();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
@@ -53,6 +267,25 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+void JitEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> units) const {
+    if (setup.cached_batch_shader == nullptr) {
+        ShaderEngine::RunBatch(setup, units);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitBatchShader* shader = static_cast<const JitBatchShader*>(setup.cached_batch_shader);
+    const BatchProgramInfo& info = shader->GetProgramInfo();
+    BatchShaderUnit batch;
+    for (std::size_t i = 0; i < units.size(); i += SHADER_BATCH_SIZE) {
+        const auto chunk = units.subspan(i, std::min(SHADER_BATCH_SIZE, units.size() - i));
+        GatherBatch(batch, chunk, info);
+        shader->Run(setup, batch, setup.entry_point);
+        ScatterBatch(batch, chunk, info);
+    }
+}
+
 } // namespace Pica::Shader
 
 #endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
@@ -8,13 +8,19 @@
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/static_lru_cache.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
 
 class JitShader;
+class JitBatchShader;
+class JitDiskCache;
 
 class JitEngine final : public ShaderEngine {
 public:
@@ -23,9 +29,55 @@ public:
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> units) const override;
+    void SwitchDiskCache(u64 title_id) override;
 
 private:
+    /// Number of specialized shaders kept before the least recently used one is freed
+    static constexpr std::size_t MAX_SPECIALIZED_SHADERS = 64;
+
+    /// Number of specialized shaders compiled for a program before it only runs generic
+    static constexpr u32 MAX_VARIANTS_PER_PROGRAM = 8;
+
+    /// Bool and integer uniforms a program branches and loops on
+    struct ProgramControl {
+        u16 bool_mask{};
+        u8 int_mask{};
+        u32 num_variants{}; ///< Number of specialized shaders compiled for the program
+    };
+
+    struct SpecializedShader {
+        std::unique_ptr<JitShader> shader;
+        const JitShader* generic{}; ///< Shader of the same program that runs with any uniforms
+    };
+
+    /// Compiles the programs recorded in the disk cache, run on preload_thread.
+    void PreloadDiskCache(std::stop_token stop_token);
+
+    /**
+     * Returns the shader of the program specialized for the current bool and integer uniforms,
+     * or the generic shader when the program does not depend on them or has too many variants.
+     */
+    const JitShader* GetSpecializedShader(ShaderSetup& setup, u64 cache_key,
+                                          const JitShader* generic);
+
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    /// Specializations of the cached shaders, keyed by program and uniform values.
+    std::unordered_map<u64, ProgramControl> program_controls;
+    Common::StaticLRUCache<u64, SpecializedShader, MAX_SPECIALIZED_SHADERS> specialized_shaders;
+    /// Setups that were handed a specialized shader, pointed back to the generic shader when the
+    /// specialized one is freed.
+    std::vector<ShaderSetup*> specialized_setups;
+    /// Batched variants of the cached shaders, keyed by entry point as well since the batching
+    /// analysis depends on it. Programs that cannot be batched map to nullptr.
+    std::unordered_map<u64, std::unique_ptr<JitBatchShader>> batch_cache;
+
+    std::unique_ptr<JitDiskCache> disk_cache;
+    /// Shaders compiled from the disk cache, moved to the caches above on their first use.
+    std::mutex preload_mutex;
+    std::unordered_map<u64, std::unique_ptr<JitShader>> preloaded_shaders;
+    std::unordered_map<u64, std::unique_ptr<JitBatchShader>> preloaded_batch_shaders;
+    std::jthread preload_thread;
 };
 
 } // namespace Pica::Shader
@@ -0,0 +1,899 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#if CITRA_ARCH(arm64)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <nihstro/shader_bytecode.h>
+#include "common/aarch64/oaknut_abi.h"
+#include "common/aarch64/oaknut_util.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/shader/shader_jit_a64_batch_compiler.h"
+
+using namespace Common::A64;
+using namespace oaknut;
+using namespace oaknut::util;
+
+using nihstro::DestRegister;
+using nihstro::RegisterType;
+
+namespace Pica::Shader {
+
+typedef void (JitBatchShader::*BatchJitFunction)(Instruction instr);
+
+// Instructions depending on per vertex state are left out, AnalyzeBatchProgram makes sure they are
+// never reached.
+const std::array<BatchJitFunction, 64> batch_instr_table = {
+    &JitBatchShader::Compile_ADD,   // add
+    &JitBatchShader::Compile_DP3,   // dp3
+    &JitBatchShader::Compile_DP4,   // dp4
+    &JitBatchShader::Compile_DPH,   // dph
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_EX2,   // ex2
+    &JitBatchShader::Compile_LG2,   // lg2
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_MUL,   // mul
+    &JitBatchShader::Compile_SGE,   // sge
+    &JitBatchShader::Compile_SLT,   // slt
+    &JitBatchShader::Compile_FLR,   // flr
+    &JitBatchShader::Compile_MAX,   // max
+    &JitBatchShader::Compile_MIN,   // min
+    &JitBatchShader::Compile_RCP,   // rcp
+    &JitBatchShader::Compile_RSQ,   // rsq
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // mova
+    &JitBatchShader::Compile_MOV,   // mov
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_DPH,   // dphi
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_SGE,   // sgei
+    &JitBatchShader::Compile_SLT,   // slti
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_NOP,   // nop
+    &JitBatchShader::Compile_END,   // end
+    nullptr,                        // breakc
+    &JitBatchShader::Compile_CALL,  // call
+    nullptr,                        // callc
+    &JitBatchShader::Compile_CALLU, // callu
+    &JitBatchShader::Compile_IF,    // ifu
+    nullptr,                        // ifc
+    &JitBatchShader::Compile_LOOP,  // loop
+    nullptr,                        // emit
+    nullptr,                        // sete
+    nullptr,                        // jmpc
+    &JitBatchShader::Compile_JMP,   // jmpu
+    nullptr,                        // cmp
+    nullptr,                        // cmp
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+};
+
+// The following is used to alias some commonly used registers. Each SRC register holds a single
+// component of the swizzled source for all the vertices of the batch.
+/// Pointer to the uniform memory
+constexpr XReg UNIFORMS = X9;
+/// VS loop count register
+constexpr WReg LOOPCOUNT_REG = W12;
+/// Current VS loop iteration number (we could probably use LOOPCOUNT_REG, but this quicker)
+constexpr WReg LOOPCOUNT = W6;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration
+constexpr WReg LOOPINC = W7;
+/// Pointer to the BatchShaderUnit instance for the current batch
+constexpr XReg STATE = X15;
+/// Scratch registers
+constexpr XReg XSCRATCH0 = X4;
+constexpr XReg XSCRATCH1 = X5;
+constexpr QReg VSCRATCH0 = Q0;
+/// Loaded with the components of the first swizzled source register
+constexpr std::array<QReg, 4> SRC1 = {Q1, Q2, Q3, Q4};
+/// Loaded with the components of the second swizzled source register
+constexpr std::array<QReg, 4> SRC2 = {Q16, Q17, Q18, Q19};
+/// Loaded with the components of the third swizzled source register
+constexpr std::array<QReg, 4> SRC3 = {Q20, Q21, Q22, Q23};
+/// Temporaries of the vectorized EX2 and LG2 approximations
+constexpr std::array<QReg, 6> VTEMP = {Q24, Q25, Q26, Q27, Q28, Q29};
+/// Constant vector of [1.0f, 1.0f, 1.0f, 1.0f], used to efficiently set a vector to one
+constexpr QReg ONE = Q14;
+
+// State registers that must not be modified by external functions calls
+static const std::bitset<64> persistent_regs =
+    BuildRegSet({// Pointers to register blocks
+                 UNIFORMS, STATE,
+                 // Cached registers
+                 LOOPCOUNT_REG,
+                 // Constants
+                 ONE,
+                 // Loop variables
+                 LOOPCOUNT, LOOPINC,
+                 // Link Register
+                 X30});
+
+/// Mask of all the components of a register
+constexpr u32 ALL_COMPONENTS = 0b1111;
+
+void JitBatchShader::Compile_Assert(bool condition, const char* msg) {}
+
+u32 JitBatchShader::DestComponents(Instruction instr) const {
+    const bool is_mad = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+                        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+    const SwizzlePattern swiz = {
+        (*swizzle_data)[is_mad ? instr.mad.operand_desc_id : instr.common.operand_desc_id]};
+
+    u32 components = 0;
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            components |= 1U << comp;
+        }
+    }
+    return components;
+}
+
+void JitBatchShader::Compile_LoadConstant(QReg dest, Label& constant) {
+    ADR(XSCRATCH0, constant);
+    LDR(dest, XSCRATCH0);
+}
+
+/**
+ * Loads the swizzled components of a source register into the specified QReg registers.
+ * @param instr VS instruction, used for determining how to load the source register
+ * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, 3 = src3)
+ * @param src_reg SourceRegister object corresponding to the source register to load
+ * @param dest Destination QReg registers, one per component
+ * @param components Mask of the components of dest to load
+ */
+void JitBatchShader::Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                                        const Components& dest, u32 components) {
+    u32 operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    u32 address_register_index;
+    u32 offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    const SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+    const u8 sel = swiz.GetRawSelector(src_num);
+    const auto selector = [sel](u32 comp) -> u32 { return (sel >> (6 - 2 * comp)) & 3; };
+    const auto for_each_component = [components](auto&& func) {
+        for (u32 comp = 0; comp < 4; ++comp) {
+            if (components & (1U << comp)) {
+                func(comp);
+            }
+        }
+    };
+
+    switch (src_reg.GetRegisterType()) {
+    case RegisterType::Input:
+        for_each_component([&](u32 comp) {
+            LDR(dest[comp], STATE,
+                BatchShaderUnit::InputOffset(src_reg.GetIndex(), selector(comp)));
+        });
+        break;
+    case RegisterType::Temporary:
+        for_each_component([&](u32 comp) {
+            LDR(dest[comp], STATE,
+                BatchShaderUnit::TemporaryOffset(src_reg.GetIndex(), selector(comp)));
+        });
+        break;
+    case RegisterType::FloatUniform:
+        // Only the loop counter is uniform across the batch, a0 is never used by batched programs.
+        if (src_num == offset_src && address_register_index == 3) {
+            // s32 offset = address_reg >= -128 && address_reg <= 127 ? address_reg : 0;
+            // u32 index = (src_reg.GetIndex() + offset) & 0x7f;
+            ADD(XSCRATCH1.toW(), LOOPCOUNT_REG, 128);
+            CMP(XSCRATCH1.toW(), 256);
+            CSEL(XSCRATCH0.toW(), LOOPCOUNT_REG, WZR, Cond::LO);
+            ADD(XSCRATCH0.toW(), XSCRATCH0.toW(), src_reg.GetIndex());
+            AND(XSCRATCH0.toW(), XSCRATCH0.toW(), 0x7f);
+
+            // index > 95 ? vec4(1.0) : uniforms.f[index];
+            for_each_component([&](u32 comp) { MOV(dest[comp].B16(), ONE.B16()); });
+            CMP(XSCRATCH0.toW(), 95);
+            Label load_end;
+            B(Cond::GT, load_end);
+            LSL(XSCRATCH0.toW(), XSCRATCH0.toW(), 4);
+            ADD(XSCRATCH1, UNIFORMS, XSCRATCH0);
+            for_each_component([&](u32 comp) {
+                LDR(dest[comp].toS(), XSCRATCH1,
+                    Uniforms::GetFloatUniformOffset(0) + selector(comp) * sizeof(f24));
+                DUP(dest[comp].S4(), dest[comp].Selem()[0]);
+            });
+            l(load_end);
+        } else {
+            for_each_component([&](u32 comp) {
+                LDR(dest[comp].toS(), UNIFORMS,
+                    Uniforms::GetFloatUniformOffset(src_reg.GetIndex()) +
+                        selector(comp) * sizeof(f24));
+                DUP(dest[comp].S4(), dest[comp].Selem()[0]);
+            });
+        }
+        break;
+    default:
+        UNREACHABLE_MSG("Encountered unknown source register type: {}", src_reg.GetRegisterType());
+        break;
+    }
+
+    // If the source register should be negated, flip the negative bit
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        for_each_component([&](u32 comp) { FNEG(dest[comp].S4(), dest[comp].S4()); });
+    }
+}
+
+void JitBatchShader::Compile_DestEnable(Instruction instr, const Components& src) {
+    DestRegister dest;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        dest = instr.mad.dest.Value();
+    } else {
+        dest = instr.common.dest.Value();
+    }
+
+    const u32 components = DestComponents(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (!(components & (1U << comp))) {
+            continue;
+        }
+
+        std::size_t dest_offset_disp;
+        switch (dest.GetRegisterType()) {
+        case RegisterType::Output:
+            dest_offset_disp = BatchShaderUnit::OutputOffset(dest.GetIndex(), comp);
+            break;
+        case RegisterType::Temporary:
+            dest_offset_disp = BatchShaderUnit::TemporaryOffset(dest.GetIndex(), comp);
+            break;
+        default:
+            UNREACHABLE_MSG("Encountered unknown destination register type: {}",
+                            dest.GetRegisterType());
+            break;
+        }
+
+        // Disabled components are simply not stored, no masking is needed
+        STR(src[comp], STATE, dest_offset_disp);
+    }
+}
+
+void JitBatchShader::Compile_SanitizedMul(QReg src1, QReg src2, QReg scratch0) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. This can be implemented by
+    // checking for NaNs before and after the multiplication.  If the multiplication result is NaN
+    // where neither source was, this NaN was generated by a 0 * inf multiplication, and so the
+    // result should be transformed to 0 to match PICA fp rules.
+    FMULX(scratch0.S4(), src1.S4(), src2.S4());
+    FMUL(src1.S4(), src1.S4(), src2.S4());
+    CMEQ(scratch0.S4(), scratch0.S4(), src1.S4());
+    AND(src1.B16(), src1.B16(), scratch0.B16());
+}
+
+void JitBatchShader::Compile_UniformCondition(Instruction instr) {
+    const std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    LDRB(XSCRATCH0.toW(), UNIFORMS, offset);
+    CMP(XSCRATCH0.toW(), 0);
+}
+
+std::bitset<64> JitBatchShader::PersistentCallerSavedRegs() {
+    return persistent_regs & ABI_ALL_CALLER_SAVED;
+}
+
+void JitBatchShader::Compile_ADD(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            FADD(SRC1[comp].S4(), SRC1[comp].S4(), SRC2[comp].S4());
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_DP3(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0111);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, 0b0111);
+
+    for (u32 comp = 0; comp < 3; ++comp) {
+        Compile_SanitizedMul(SRC1[comp], SRC2[comp], VSCRATCH0);
+    }
+    FADD(SRC1[0].S4(), SRC1[0].S4(), SRC1[1].S4());
+    FADD(SRC1[0].S4(), SRC1[0].S4(), SRC1[2].S4());
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_DP4(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, ALL_COMPONENTS);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, ALL_COMPONENTS);
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        Compile_SanitizedMul(SRC1[comp], SRC2[comp], VSCRATCH0);
+    }
+
+    // Same summation order as the FADDP sequence of the scalar JIT
+    FADD(SRC1[0].S4(), SRC1[0].S4(), SRC1[1].S4());
+    FADD(SRC1[2].S4(), SRC1[2].S4(), SRC1[3].S4());
+    FADD(SRC1[0].S4(), SRC1[0].S4(), SRC1[2].S4());
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, 0b0111);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, ALL_COMPONENTS);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0111);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, ALL_COMPONENTS);
+    }
+
+    for (u32 comp = 0; comp < 3; ++comp) {
+        Compile_SanitizedMul(SRC1[comp], SRC2[comp], VSCRATCH0);
+    }
+
+    // The 4th component of src1 is 1.0, so its product is the 4th component of src2
+    MOV(SRC1[3].B16(), SRC2[3].B16());
+
+    FADD(SRC1[0].S4(), SRC1[0].S4(), SRC1[1].S4());
+    FADD(SRC1[2].S4(), SRC1[2].S4(), SRC1[3].S4());
+    FADD(SRC1[0].S4(), SRC1[0].S4(), SRC1[2].S4());
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_EX2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Vectorized version of the scalar JIT approximation: a range reduction into [-0.5, 0.5)
+    // followed by a minimax polynomial fit for exp2(x), lanes holding NaN are passed through.
+    const QReg input = SRC1[0];
+    const QReg ordered_mask = VTEMP[0];
+    const QReg original = VTEMP[1];
+    const QReg rounded = VTEMP[2];
+    const QReg scale = VTEMP[3];
+    const QReg poly = VTEMP[4];
+    const QReg coeff = VTEMP[5];
+
+    FCMEQ(ordered_mask.S4(), input.S4(), input.S4());
+    MOV(original.B16(), input.B16());
+
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    Compile_LoadConstant(coeff, constants.exp2_input_max);
+    FMIN(input.S4(), input.S4(), coeff.S4());
+    Compile_LoadConstant(coeff, constants.exp2_input_min);
+    FMAX(input.S4(), input.S4(), coeff.S4());
+
+    Compile_LoadConstant(coeff, constants.half);
+    FSUB(scale.S4(), input.S4(), coeff.S4());
+    FCVTNS(scale.S4(), scale.S4());
+    SCVTF(rounded.S4(), scale.S4());
+    // rounded now contains input rounded to the nearest integer.
+    Compile_LoadConstant(coeff, constants.exponent_bias);
+    ADD(scale.S4(), scale.S4(), coeff.S4());
+    SHL(scale.S4(), scale.S4(), 23);
+    // scale contains 2^(round(input)).
+    FSUB(input.S4(), input.S4(), rounded.S4());
+    // input contains input - round(input), which is in [-0.5, 0.5).
+
+    // Complete computation of polynomial.
+    Compile_LoadConstant(poly, constants.exp2_coeffs[0]);
+    FMUL(poly.S4(), input.S4(), poly.S4());
+    for (std::size_t i = 1; i < 4; ++i) {
+        Compile_LoadConstant(coeff, constants.exp2_coeffs[i]);
+        FADD(poly.S4(), poly.S4(), coeff.S4());
+        FMUL(poly.S4(), poly.S4(), input.S4());
+    }
+    Compile_LoadConstant(coeff, constants.exp2_coeffs[4]);
+    FADD(input.S4(), coeff.S4(), poly.S4());
+    FMUL(input.S4(), input.S4(), scale.S4());
+
+    BIF(input.B16(), original.B16(), ordered_mask.B16());
+
+    Compile_DestEnable(instr, {input, input, input, input});
+}
+
+void JitBatchShader::Compile_LG2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Vectorized version of the scalar JIT approximation: a range reduction into [1.0, 2.0)
+    // followed by a minimax polynomial fit for log2(x) / (x - 1). NaN lanes are passed through,
+    // zero gives -inf and negative inputs give NaN.
+    const QReg input = SRC1[0];
+    const QReg ordered_mask = VTEMP[0];
+    const QReg negative_mask = VTEMP[1];
+    const QReg zero_mask = VTEMP[2];
+    const QReg mantissa = VTEMP[3];
+    const QReg exponent = VTEMP[4];
+    const QReg coeff = VTEMP[5];
+    const QReg poly = VSCRATCH0;
+
+    FCMEQ(ordered_mask.S4(), input.S4(), input.S4());
+    EOR(coeff.B16(), coeff.B16(), coeff.B16());
+    FCMGE(negative_mask.S4(), coeff.S4(), input.S4());
+    FCMEQ(zero_mask.S4(), input.S4(), coeff.S4());
+
+    // Split input: mantissa=MANT[1,2) exponent=Exponent
+    Compile_LoadConstant(coeff, constants.mantissa_mask);
+    AND(mantissa.B16(), input.B16(), coeff.B16());
+    ORR(mantissa.B16(), mantissa.B16(), ONE.B16());
+    Compile_LoadConstant(coeff, constants.exponent_mask);
+    AND(exponent.B16(), input.B16(), coeff.B16());
+    USHR(exponent.S4(), exponent.S4(), 23);
+    Compile_LoadConstant(coeff, constants.exponent_bias);
+    SUB(exponent.S4(), exponent.S4(), coeff.S4());
+    SCVTF(exponent.S4(), exponent.S4());
+
+    // Complete computation of polynomial
+    Compile_LoadConstant(poly, constants.log2_coeffs[0]);
+    FMUL(poly.S4(), poly.S4(), mantissa.S4());
+    for (std::size_t i = 1; i < 4; ++i) {
+        Compile_LoadConstant(coeff, constants.log2_coeffs[i]);
+        FADD(poly.S4(), poly.S4(), coeff.S4());
+        FMUL(poly.S4(), poly.S4(), mantissa.S4());
+    }
+    FSUB(mantissa.S4(), mantissa.S4(), ONE.S4());
+    Compile_LoadConstant(coeff, constants.log2_coeffs[4]);
+    FADD(poly.S4(), poly.S4(), coeff.S4());
+    FMUL(poly.S4(), poly.S4(), mantissa.S4());
+    FADD(exponent.S4(), poly.S4(), exponent.S4());
+
+    // Patch the edge cases, zero being a subset of the non positive inputs
+    Compile_LoadConstant(coeff, constants.default_qnan);
+    BSL(negative_mask.B16(), coeff.B16(), exponent.B16());
+    Compile_LoadConstant(coeff, constants.negative_infinity);
+    BSL(zero_mask.B16(), coeff.B16(), negative_mask.B16());
+    BIF(zero_mask.B16(), input.B16(), ordered_mask.B16());
+
+    Compile_DestEnable(instr, {zero_mask, zero_mask, zero_mask, zero_mask});
+}
+
+void JitBatchShader::Compile_MUL(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            Compile_SanitizedMul(SRC1[comp], SRC2[comp], VSCRATCH0);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_SGE(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, components);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    }
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            FCMGE(SRC2[comp].S4(), SRC1[comp].S4(), SRC2[comp].S4());
+            AND(SRC2[comp].B16(), SRC2[comp].B16(), ONE.B16());
+        }
+    }
+
+    Compile_DestEnable(instr, SRC2);
+}
+
+void JitBatchShader::Compile_SLT(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, components);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    }
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            FCMGT(SRC1[comp].S4(), SRC2[comp].S4(), SRC1[comp].S4());
+            AND(SRC1[comp].B16(), SRC1[comp].B16(), ONE.B16());
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_FLR(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            FRINTM(SRC1[comp].S4(), SRC1[comp].S4());
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MAX(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            // Equivalent to (b < a) ? a : b with associated NaN caveats
+            FCMGT(VSCRATCH0.S4(), SRC1[comp].S4(), SRC2[comp].S4());
+            BIF(SRC1[comp].B16(), SRC2[comp].B16(), VSCRATCH0.B16());
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MIN(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            // Equivalent to (a < b) ? a : b with associated NaN caveats
+            FCMGT(VSCRATCH0.S4(), SRC2[comp].S4(), SRC1[comp].S4());
+            BIF(SRC1[comp].B16(), SRC2[comp].B16(), VSCRATCH0.B16());
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MOV(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, DestComponents(instr));
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Exact 1.0f / N like the scalar JIT, only the X component is used
+    FDIV(SRC1[0].S4(), ONE.S4(), SRC1[0].S4());
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Exact 1.0f / sqrt(N) like the scalar JIT, only the X component is used
+    FSQRT(SRC1[0].S4(), SRC1[0].S4());
+    FDIV(SRC1[0].S4(), ONE.S4(), SRC1[0].S4());
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_NOP(Instruction instr) {}
+
+void JitBatchShader::Compile_END(Instruction instr) {
+    // Save loop register
+    STR(LOOPCOUNT_REG, STATE, u32(offsetof(BatchShaderUnit, loop_counter)));
+
+    ABI_PopRegisters(*this, ABI_ALL_CALLEE_SAVED, 16);
+    RET();
+}
+
+void JitBatchShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return and link-register
+    MOV(XSCRATCH0, instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+    STP(XSCRATCH0, X30, SP, POST_INDEXED, -16);
+
+    // Call the subroutine
+    BL(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Restore the link-register
+    // Skip over the return offset that's on the stack
+    LDP(XZR, X30, SP, PRE_INDEXED, 16);
+}
+
+void JitBatchShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    B(Cond::EQ, b);
+    Compile_CALL(instr);
+    l(b);
+}
+
+void JitBatchShader::Compile_MAD(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.mad.src1, SRC1, components);
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2i, SRC2, components);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3i, SRC3, components);
+    } else {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2, SRC2, components);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3, components);
+    }
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            Compile_SanitizedMul(SRC1[comp], SRC2[comp], VSCRATCH0);
+            FADD(SRC1[comp].S4(), SRC1[comp].S4(), SRC3[comp].S4());
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_IF(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards if-statements not supported");
+    Label l_else, l_endif;
+
+    // Evaluate the "IF" condition
+    Compile_UniformCondition(instr);
+    B(Cond::EQ, l_else);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        l(l_else);
+        return;
+    }
+
+    B(l_endif);
+
+    l(l_else);
+    // This code corresponds to the "ELSE" condition
+    // Comple the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    l(l_endif);
+}
+
+void JitBatchShader::Compile_LOOP(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards loops not supported");
+    Compile_Assert(loop_depth < 1, "Nested loops may not be supported");
+    if (loop_depth++) {
+        const auto loop_save_regs = BuildRegSet({LOOPCOUNT_REG, LOOPINC, LOOPCOUNT});
+        ABI_PushRegisters(*this, loop_save_regs);
+    }
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id
+    const std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    LDR(LOOPCOUNT, UNIFORMS, offset);
+
+    UBFX(LOOPCOUNT_REG, LOOPCOUNT, 8, 8); // Y-component is the start
+    UBFX(LOOPINC, LOOPCOUNT, 16, 8);      // Z-component is the incrementer
+    UXTB(LOOPCOUNT, LOOPCOUNT);           // X-component is iteration count
+    ADD(LOOPCOUNT, LOOPCOUNT, 1);         // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    l(l_loop_start);
+
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    ADD(LOOPCOUNT_REG, LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    SUBS(LOOPCOUNT, LOOPCOUNT, 1);              // Increment loop count by 1
+    B(Cond::NE, l_loop_start);                  // Loop if not equal
+
+    if (--loop_depth) {
+        const auto loop_save_regs = BuildRegSet({LOOPCOUNT_REG, LOOPINC, LOOPCOUNT});
+        ABI_PopRegisters(*this, loop_save_regs);
+    }
+}
+
+void JitBatchShader::Compile_JMP(Instruction instr) {
+    Compile_UniformCondition(instr);
+
+    const bool inverted_condition = (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        B(Cond::EQ, b);
+    } else {
+        B(Cond::NE, b);
+    }
+}
+
+void JitBatchShader::Compile_Block(u32 end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitBatchShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    LDR(XSCRATCH0, SP, 16);
+    CMP(XSCRATCH0.toW(), program_counter);
+
+    // If so, jump back to before CALL
+    Label b;
+    B(Cond::NE, b);
+    RET();
+    l(b);
+}
+
+void JitBatchShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    l(instruction_labels[program_counter]);
+
+    // Always treat the last instruction of the program code as an end instruction, like the
+    // scalar JIT does.
+    Instruction instr{};
+    if (program_counter < MAX_PROGRAM_CODE_LENGTH - 1) {
+        instr.hex = (*program_code)[program_counter];
+    } else {
+        instr.opcode.Assign(OpCode::Id::END);
+    }
+    ++program_counter;
+
+    const OpCode::Id opcode = instr.opcode.Value();
+    const auto instr_func = batch_instr_table[static_cast<std::size_t>(opcode)];
+
+    // Unsupported instructions are not reachable from the entry point of a batched program, they
+    // are skipped silently since the rest of the program code is still compiled.
+    if (instr_func) {
+        ((*this).*instr_func)(instr);
+    }
+}
+
+void JitBatchShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+void JitBatchShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                             const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_,
+                             const BatchProgramInfo& info) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+    program_info = info;
+
+    // Reset flow control state
+    const std::uintptr_t program_offset = offset();
+    program_counter = 0;
+    loop_depth = 0;
+    instruction_labels.fill(Label());
+
+    // Find all `CALL` instructions and identify return locations
+    FindReturnOffsets();
+
+    // The stack pointer is 8 modulo 16 at the entry of a procedure
+    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine.
+    ABI_PushRegisters(*this, ABI_ALL_CALLEE_SAVED, 16);
+    MVN(XSCRATCH0, XZR);
+    STR(XSCRATCH0, SP, 8);
+
+    MOV(UNIFORMS, ABI_PARAM1);
+    MOV(STATE, ABI_PARAM2);
+
+    // Load loop register
+    LDR(LOOPCOUNT_REG, STATE, u32(offsetof(BatchShaderUnit, loop_counter)));
+
+    // Used to set a register to one
+    FMOV(ONE.S4(), FImm8(false, 7, 0));
+
+    // Jump to start of the shader program
+    BR(ABI_PARAM3);
+
+    // Compile entire program
+    Compile_Block(static_cast<u32>(program_code->size()));
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    // Copy to executable memory
+    const size_t code_size = code_vec.size() * sizeof(u32);
+    code_mem = std::make_unique<oaknut::CodeBlock>(code_size);
+    code_accounting = Common::MemoryAccounting::Allocation{
+        Common::MemoryAccounting::Category::ShaderCache, code_size};
+    code_mem->unprotect();
+    program = reinterpret_cast<CompiledShader*>(reinterpret_cast<std::byte*>(code_mem->ptr()) +
+                                                program_offset);
+    std::memcpy(code_mem->ptr(), code_vec.data(), code_size);
+
+    // Memory is ready to execute
+    code_mem->protect();
+    code_mem->invalidate_all();
+
+    // code_vec is no longer needed
+    code_vec.clear();
+    code_vec.shrink_to_fit();
+
+    LOG_DEBUG(HW_GPU, "Compiled batch shader size={}", code_size);
+}
+
+JitBatchShader::JitBatchShader() : oaknut::VectorCodeGenerator(code_vec) {
+    CompilePrelude();
+}
+
+Label JitBatchShader::CompileConstant(u32 value) {
+    Label constant;
+    l(constant);
+    for (std::size_t lane = 0; lane < SHADER_BATCH_SIZE; ++lane) {
+        dw(value);
+    }
+    return constant;
+}
+
+void JitBatchShader::CompilePrelude() {
+    // Float layout masks shared by the EX2 and LG2 approximations
+    constants.mantissa_mask = CompileConstant(0x007fffff);
+    constants.exponent_mask = CompileConstant(0x7f800000);
+    constants.exponent_bias = CompileConstant(0x7f);
+    constants.negative_infinity = CompileConstant(0xff800000);
+    constants.default_qnan = CompileConstant(0x7fc00000);
+
+    // Coefficients of the minimax polynomial approximating log2(x) / (x - 1).
+    constants.log2_coeffs = {
+        CompileConstant(0x3d74552f), CompileConstant(0xbeee7397), CompileConstant(0x3fbd96dd),
+        CompileConstant(0xc02153f6), CompileConstant(0x4038d96c),
+    };
+
+    // Range and coefficients of the minimax polynomial approximating exp2(x).
+    constants.exp2_input_max = CompileConstant(0x43010000);
+    constants.exp2_input_min = CompileConstant(0xc2fdffff);
+    constants.half = CompileConstant(0x3f000000);
+    constants.exp2_coeffs = {
+        CompileConstant(0x3c5dbe69), CompileConstant(0x3d5509f9), CompileConstant(0x3e773cc5),
+        CompileConstant(0x3f3168b3), CompileConstant(0x3f800016),
+    };
+}
+
+} // namespace Pica::Shader
+
+#endif // CITRA_ARCH(arm64)
@@ -0,0 +1,175 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/arch.h"
+#if CITRA_ARCH(arm64)
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <oaknut/code_block.hpp>
+#include <oaknut/oaknut.hpp>
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/shader/shader_jit_batch.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SourceRegister;
+using nihstro::SwizzlePattern;
+
+namespace Pica::Shader {
+
+/**
+ * This class implements the batched shader JIT compiler. It recompiles a Pica shader program into
+ * arm64 code that runs SHADER_BATCH_SIZE vertices at once, with each NEON lane holding a different
+ * vertex. Only programs accepted by AnalyzeBatchProgram may be run with it.
+ */
+class JitBatchShader : public oaknut::VectorCodeGenerator {
+public:
+    JitBatchShader();
+
+    /// Returns true if the host supports the instructions used by the batched JIT.
+    static bool IsSupported() {
+        return true;
+    }
+
+    void Run(const ShaderSetup& setup, BatchShaderUnit& state, u32 offset) const {
+        program(&setup.uniforms, &state,
+                reinterpret_cast<const std::byte*>(code_mem->ptr()) +
+                    instruction_labels[offset].offset());
+    }
+
+    void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data,
+                 const BatchProgramInfo& info);
+
+    const BatchProgramInfo& GetProgramInfo() const {
+        return program_info;
+    }
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+
+private:
+    /// One host register per component of a Pica vector register
+    using Components = std::array<oaknut::QReg, 4>;
+
+    std::vector<u32> code_vec;
+    std::unique_ptr<oaknut::CodeBlock> code_mem;
+    Common::MemoryAccounting::Allocation code_accounting; ///< Accounts code_mem
+
+    void Compile_Block(u32 end);
+    void Compile_NextInstr();
+
+    /**
+     * Loads the swizzled components of a source register.
+     * @param components Mask of the components to load, bit 0 being the X component
+     */
+    void Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                            const Components& dest, u32 components);
+    void Compile_DestEnable(Instruction instr, const Components& src);
+
+    /**
+     * Compiles a `MUL src1, src2` operation, properly handling the PICA semantics when multiplying
+     * zero by inf. Clobbers `scratch0`.
+     */
+    void Compile_SanitizedMul(oaknut::QReg src1, oaknut::QReg src2, oaknut::QReg scratch0);
+
+    void Compile_UniformCondition(Instruction instr);
+
+    /// Loads one of the constants emitted by CompilePrelude into all the lanes of dest.
+    void Compile_LoadConstant(oaknut::QReg dest, oaknut::Label& constant);
+
+    /**
+     * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
+     */
+    void Compile_Return();
+
+    std::bitset<64> PersistentCallerSavedRegs();
+
+    /**
+     * Assertion evaluated at compile-time, but only triggered if executed at runtime.
+     * @param condition Condition to be evaluated.
+     * @param msg       Message to be logged if the assertion fails.
+     */
+    void Compile_Assert(bool condition, const char* msg);
+
+    /// Returns the mask of components enabled in the destination of the instruction.
+    u32 DestComponents(Instruction instr) const;
+
+    /**
+     * Analyzes the entire shader program for `CALL` instructions before emitting any code,
+     * identifying the locations where a return needs to be inserted.
+     */
+    void FindReturnOffsets();
+
+    /**
+     * Emits the constants used by the vectorized utility functions.
+     */
+    void CompilePrelude();
+    oaknut::Label CompileConstant(u32 value);
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+
+    /// Registers accessed by the compiled program
+    BatchProgramInfo program_info{};
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<oaknut::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<u32> return_offsets;
+
+    u32 program_counter = 0; ///< Offset of the next instruction to decode
+    u8 loop_depth = 0;       ///< Depth of the (nested) loops currently compiled
+
+    using CompiledShader = void(const void* setup, void* state, const std::byte* start_addr);
+    CompiledShader* program = nullptr;
+
+    struct Constants {
+        oaknut::Label mantissa_mask;
+        oaknut::Label exponent_mask;
+        oaknut::Label exponent_bias;
+        oaknut::Label negative_infinity;
+        oaknut::Label default_qnan;
+        std::array<oaknut::Label, 5> log2_coeffs;
+        oaknut::Label exp2_input_max;
+        oaknut::Label exp2_input_min;
+        oaknut::Label half;
+        std::array<oaknut::Label, 5> exp2_coeffs;
+    } constants;
+};
+
+} // namespace Pica::Shader
+
+#endif
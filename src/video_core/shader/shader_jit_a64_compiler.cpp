@@ -443,6 +443,10 @@ void JitShader::Compile_UniformCondition(Instruction instr) {
     CMP(XSCRATCH0.toW(), 0);
 }
 
+bool JitShader::ConstantUniformCondition(Instruction instr) const {
+    return (control_uniforms->b >> instr.flow_control.bool_uniform_id) & 1;
+}
+
 std::bitset<64> JitShader::PersistentCallerSavedRegs() {
     return persistent_regs & ABI_ALL_CALLER_SAVED;
 }
@@ -690,6 +694,12 @@ void JitShader::Compile_CALLC(Instruction instr) {
 }
 
 void JitShader::Compile_CALLU(Instruction instr) {
+    if (control_uniforms) {
+        if (ConstantUniformCondition(instr)) {
+            Compile_CALL(instr);
+        }
+        return;
+    }
     Compile_UniformCondition(instr);
     Label b;
     B(Cond::EQ, b);
@@ -740,13 +750,19 @@ void JitShader::Compile_IF(Instruction instr) {
                    "Backwards if-statements not supported");
     Label l_else, l_endif;
 
-    // Evaluate the "IF" condition
-    if (instr.opcode.Value() == OpCode::Id::IFU) {
-        Compile_UniformCondition(instr);
-    } else if (instr.opcode.Value() == OpCode::Id::IFC) {
-        Compile_EvaluateCondition(instr);
+    // Evaluate the "IF" condition. Constant uniforms leave the untaken block unreachable.
+    if (instr.opcode.Value() == OpCode::Id::IFU && control_uniforms) {
+        if (!ConstantUniformCondition(instr)) {
+            B(l_else);
+        }
+    } else {
+        if (instr.opcode.Value() == OpCode::Id::IFU) {
+            Compile_UniformCondition(instr);
+        } else if (instr.opcode.Value() == OpCode::Id::IFC) {
+            Compile_EvaluateCondition(instr);
+        }
+        B(Cond::EQ, l_else);
     }
-    B(Cond::EQ, l_else);
 
     // Compile the code that corresponds to the condition evaluating as true
     Compile_Block(instr.flow_control.dest_offset);
@@ -777,13 +793,20 @@ void JitShader::Compile_LOOP(Instruction instr) {
     }
 
     // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id
-    const std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
-    LDR(LOOPCOUNT, UNIFORMS, offset);
+    if (control_uniforms) {
+        const u32 value = control_uniforms->i[instr.flow_control.int_uniform_id];
+        MOV(LOOPCOUNT_REG, (value >> 8) & 0xFF);
+        MOV(LOOPINC, (value >> 16) & 0xFF);
+        MOV(LOOPCOUNT, (value & 0xFF) + 1);
+    } else {
+        const std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+        LDR(LOOPCOUNT, UNIFORMS, offset);
 
-    UBFX(LOOPCOUNT_REG, LOOPCOUNT, 8, 8); // Y-component is the start
-    UBFX(LOOPINC, LOOPCOUNT, 16, 8);      // Z-component is the incrementer
-    UXTB(LOOPCOUNT, LOOPCOUNT);           // X-component is iteration count
-    ADD(LOOPCOUNT, LOOPCOUNT, 1);         // Iteration count is X-component + 1
+        UBFX(LOOPCOUNT_REG, LOOPCOUNT, 8, 8); // Y-component is the start
+        UBFX(LOOPINC, LOOPCOUNT, 16, 8);      // Z-component is the incrementer
+        UXTB(LOOPCOUNT, LOOPCOUNT);           // X-component is iteration count
+        ADD(LOOPCOUNT, LOOPCOUNT, 1);         // Iteration count is X-component + 1
+    }
 
     Label l_loop_start;
     l(l_loop_start);
@@ -804,6 +827,14 @@ void JitShader::Compile_LOOP(Instruction instr) {
 }
 
 void JitShader::Compile_JMP(Instruction instr) {
+    if (instr.opcode.Value() == OpCode::Id::JMPU && control_uniforms) {
+        // An odd num_instructions inverts the condition
+        if (ConstantUniformCondition(instr) != (instr.flow_control.num_instructions & 1)) {
+            B(instruction_labels[instr.flow_control.dest_offset]);
+        }
+        return;
+    }
+
     if (instr.opcode.Value() == OpCode::Id::JMPC) {
         Compile_EvaluateCondition(instr);
     } else if (instr.opcode.Value() == OpCode::Id::JMPU) {
@@ -951,9 +982,11 @@ void JitShader::FindReturnOffsets() {
 }
 
 void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
-                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_,
+                        const ControlUniforms* control) {
     program_code = program_code_;
     swizzle_data = swizzle_data_;
+    control_uniforms = control;
 
     // Reset flow control state
     const std::uintptr_t program_offset = offset();
@@ -995,6 +1028,7 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     // Free memory that's no longer needed
     program_code = nullptr;
     swizzle_data = nullptr;
+    control_uniforms = nullptr;
     return_offsets.clear();
     return_offsets.shrink_to_fit();
 
@@ -1002,6 +1036,8 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     const size_t code_size = code_vec.size() * sizeof(u32);
 
     code_mem = std::make_unique<oaknut::CodeBlock>(code_size);
+    code_accounting = Common::MemoryAccounting::Allocation{
+        Common::MemoryAccounting::Category::ShaderCache, code_size};
     code_mem->unprotect();
 
     program = reinterpret_cast<CompiledShader*>(reinterpret_cast<std::byte*>(code_mem->ptr()) +
@@ -1102,7 +1138,7 @@ Label JitShader::CompilePrelude_Log2() {
     UBFX(XSCRATCH0.toW(), XSCRATCH0.toW(), 23, 8);
     SUB(XSCRATCH0.toW(), XSCRATCH0.toW(), 0x7F);
     MOV(VSCRATCH1.Selem()[0], XSCRATCH0.toW());
-    UCVTF(VSCRATCH1.toS(), VSCRATCH1.toS());
+    SCVTF(VSCRATCH1.toS(), VSCRATCH1.toS());
     // VSCRATCH1 now contains the exponent of the input.
 
     ADR(XSCRATCH0, c0);
@@ -17,6 +17,7 @@
 #include <oaknut/code_block.hpp>
 #include <oaknut/oaknut.hpp>
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "video_core/pica/shader_setup.h"
 
 using nihstro::Instruction;
@@ -44,8 +45,13 @@ public:
                     instruction_labels[offset].offset());
     }
 
+    /**
+     * Compiles the program. When control is provided, the bool and integer uniforms are compiled
+     * as the given constants and the shader may only run with those values.
+     */
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
-                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data,
+                 const ControlUniforms* control = nullptr);
 
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
@@ -80,6 +86,7 @@ public:
 private:
     std::vector<u32> code_vec;
     std::unique_ptr<oaknut::CodeBlock> code_mem;
+    Common::MemoryAccounting::Allocation code_accounting; ///< Accounts code_mem
 
     void Compile_Block(u32 end);
     void Compile_NextInstr();
@@ -100,6 +107,9 @@ private:
     void Compile_EvaluateCondition(Instruction instr);
     void Compile_UniformCondition(Instruction instr);
 
+    /// Returns the value of the bool uniform tested by the instruction when compiled as constant
+    bool ConstantUniformCondition(Instruction instr) const;
+
     /**
      * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
      */
@@ -129,6 +139,7 @@ private:
 
     const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
     const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+    const ControlUniforms* control_uniforms = nullptr;
 
     /// Mapping of Pica VS instructions to pointers in the emitted code
     std::array<oaknut::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
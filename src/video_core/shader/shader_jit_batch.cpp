@@ -0,0 +1,196 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include "video_core/shader/shader_jit_batch.h"
+
+using nihstro::DestRegister;
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::RegisterType;
+using nihstro::SourceRegister;
+
+namespace Pica::Shader {
+
+namespace {
+
+void MarkSource(BatchProgramInfo& info, SourceRegister reg) {
+    switch (reg.GetRegisterType()) {
+    case RegisterType::Input:
+        info.inputs.set(reg.GetIndex());
+        break;
+    case RegisterType::Temporary:
+        info.temporaries.set(reg.GetIndex());
+        break;
+    default:
+        break;
+    }
+}
+
+void MarkDest(BatchProgramInfo& info, DestRegister reg) {
+    switch (reg.GetRegisterType()) {
+    case RegisterType::Output:
+        info.outputs.set(reg.GetIndex());
+        break;
+    case RegisterType::Temporary:
+        info.temporaries.set(reg.GetIndex());
+        break;
+    default:
+        break;
+    }
+}
+
+/// Returns true if the instruction reads a float uniform relative to a0.x or a0.y, which are
+/// written per vertex by MOVA.
+constexpr bool UsesAddressRegister(u32 address_register_index) {
+    return address_register_index == 1 || address_register_index == 2;
+}
+
+} // Anonymous namespace
+
+std::optional<BatchProgramInfo> AnalyzeBatchProgram(const ProgramCode& program_code,
+                                                    u32 entry_point) {
+    BatchProgramInfo info{};
+    std::bitset<MAX_PROGRAM_CODE_LENGTH> visited;
+    std::vector<u32> pending{entry_point};
+
+    while (!pending.empty()) {
+        u32 offset = pending.back();
+        pending.pop_back();
+
+        bool path_ends = false;
+        while (!path_ends && offset < MAX_PROGRAM_CODE_LENGTH && !visited[offset]) {
+            visited.set(offset);
+
+            // The JIT treats the last instruction of the program code as an end instruction.
+            if (offset == MAX_PROGRAM_CODE_LENGTH - 1) {
+                break;
+            }
+
+            const Instruction instr = {program_code[offset++]};
+            const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+            switch (opcode) {
+            case OpCode::Id::ADD:
+            case OpCode::Id::DP3:
+            case OpCode::Id::DP4:
+            case OpCode::Id::DPH:
+            case OpCode::Id::DPHI:
+            case OpCode::Id::MUL:
+            case OpCode::Id::SGE:
+            case OpCode::Id::SGEI:
+            case OpCode::Id::SLT:
+            case OpCode::Id::SLTI:
+            case OpCode::Id::MAX:
+            case OpCode::Id::MIN: {
+                const bool is_inverted =
+                    (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+                if (UsesAddressRegister(instr.common.address_register_index)) {
+                    return std::nullopt;
+                }
+                MarkSource(info, instr.common.GetSrc1(is_inverted));
+                MarkSource(info, instr.common.GetSrc2(is_inverted));
+                MarkDest(info, instr.common.dest.Value());
+                break;
+            }
+            case OpCode::Id::EX2:
+            case OpCode::Id::LG2:
+            case OpCode::Id::FLR:
+            case OpCode::Id::RCP:
+            case OpCode::Id::RSQ:
+            case OpCode::Id::MOV:
+                if (UsesAddressRegister(instr.common.address_register_index)) {
+                    return std::nullopt;
+                }
+                MarkSource(info, instr.common.GetSrc1(false));
+                MarkDest(info, instr.common.dest.Value());
+                break;
+            case OpCode::Id::MAD:
+            case OpCode::Id::MADI: {
+                const bool is_inverted = opcode == OpCode::Id::MADI;
+                if (UsesAddressRegister(instr.mad.address_register_index)) {
+                    return std::nullopt;
+                }
+                MarkSource(info, instr.mad.GetSrc1(is_inverted));
+                MarkSource(info, instr.mad.GetSrc2(is_inverted));
+                MarkSource(info, instr.mad.GetSrc3(is_inverted));
+                MarkDest(info, instr.mad.dest.Value());
+                break;
+            }
+            case OpCode::Id::NOP:
+                break;
+            case OpCode::Id::END:
+                path_ends = true;
+                break;
+            case OpCode::Id::CALL:
+            case OpCode::Id::CALLU:
+            case OpCode::Id::JMPU:
+                pending.push_back(instr.flow_control.dest_offset);
+                break;
+            case OpCode::Id::IFU:
+                pending.push_back(instr.flow_control.dest_offset);
+                pending.push_back(instr.flow_control.dest_offset +
+                                  instr.flow_control.num_instructions);
+                break;
+            case OpCode::Id::LOOP:
+                pending.push_back(instr.flow_control.dest_offset + 1);
+                break;
+            default:
+                // MOVA, CMP and the conditional flow control instructions make the program depend
+                // on per vertex state, EMIT and SETEMIT are only valid in geometry shaders.
+                return std::nullopt;
+            }
+        }
+    }
+
+    return info;
+}
+
+void GatherBatch(BatchShaderUnit& batch, std::span<const ShaderUnit> units,
+                 const BatchProgramInfo& info) {
+    const auto gather = [&](std::array<BatchShaderUnit::Register, 16>& dest,
+                            std::array<Common::Vec4<f24>, 16> ShaderUnit::*regs,
+                            const std::bitset<16>& mask) {
+        for (std::size_t reg = 0; reg < dest.size(); ++reg) {
+            if (!mask[reg]) {
+                continue;
+            }
+            for (std::size_t lane = 0; lane < SHADER_BATCH_SIZE; ++lane) {
+                const auto& src = (units[lane < units.size() ? lane : 0].*regs)[reg];
+                for (std::size_t comp = 0; comp < 4; ++comp) {
+                    dest[reg][comp][lane] = src[comp];
+                }
+            }
+        }
+    };
+    gather(batch.input, &ShaderUnit::input, info.inputs);
+    gather(batch.temporary, &ShaderUnit::temporary, info.temporaries);
+    batch.loop_counter = units[0].address_registers[2];
+}
+
+void ScatterBatch(const BatchShaderUnit& batch, std::span<ShaderUnit> units,
+                  const BatchProgramInfo& info) {
+    const auto scatter = [&](const std::array<BatchShaderUnit::Register, 16>& src,
+                             std::array<Common::Vec4<f24>, 16> ShaderUnit::*regs,
+                             const std::bitset<16>& mask) {
+        for (std::size_t reg = 0; reg < src.size(); ++reg) {
+            if (!mask[reg]) {
+                continue;
+            }
+            for (std::size_t lane = 0; lane < units.size(); ++lane) {
+                auto& dest = (units[lane].*regs)[reg];
+                for (std::size_t comp = 0; comp < 4; ++comp) {
+                    dest[comp] = src[reg][comp][lane];
+                }
+            }
+        }
+    };
+    scatter(batch.output, &ShaderUnit::output, info.outputs);
+    scatter(batch.temporary, &ShaderUnit::temporary, info.temporaries);
+    for (ShaderUnit& unit : units) {
+        unit.address_registers[2] = batch.loop_counter;
+    }
+}
+
+} // namespace Pica::Shader
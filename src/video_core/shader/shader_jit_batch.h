@@ -0,0 +1,73 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include "common/common_types.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
+
+namespace Pica::Shader {
+
+/**
+ * Structure-of-arrays shader unit state used by the batched shader JIT. Each component of a
+ * register holds the values of all the vertices of the batch, so that one host vector register
+ * covers a register component for the whole batch.
+ */
+struct BatchShaderUnit {
+    using Component = std::array<f24, SHADER_BATCH_SIZE>;
+    using Register = std::array<Component, 4>;
+
+    static constexpr std::size_t InputOffset(u32 register_index, u32 component) {
+        return offsetof(BatchShaderUnit, input) + register_index * sizeof(Register) +
+               component * sizeof(Component);
+    }
+
+    static constexpr std::size_t OutputOffset(u32 register_index, u32 component) {
+        return offsetof(BatchShaderUnit, output) + register_index * sizeof(Register) +
+               component * sizeof(Component);
+    }
+
+    static constexpr std::size_t TemporaryOffset(u32 register_index, u32 component) {
+        return offsetof(BatchShaderUnit, temporary) + register_index * sizeof(Register) +
+               component * sizeof(Component);
+    }
+
+    alignas(16) std::array<Register, 16> input;
+    alignas(16) std::array<Register, 16> temporary;
+    alignas(16) std::array<Register, 16> output;
+    s32 loop_counter;
+};
+
+/// Registers accessed by a program that can be batched.
+struct BatchProgramInfo {
+    std::bitset<16> inputs;
+    std::bitset<16> temporaries;
+    std::bitset<16> outputs;
+};
+
+/**
+ * Checks whether the program starting at entry_point takes the same path for every vertex, which
+ * is the case when it only branches on uniforms and never reads the address registers or the
+ * conditional codes.
+ * @returns The registers accessed by the program, or nullopt if it cannot be batched.
+ */
+std::optional<BatchProgramInfo> AnalyzeBatchProgram(const ProgramCode& program_code,
+                                                    u32 entry_point);
+
+/// Transposes the state of up to SHADER_BATCH_SIZE shader units into the batch. Missing lanes
+/// replicate the first unit.
+void GatherBatch(BatchShaderUnit& batch, std::span<const ShaderUnit> units,
+                 const BatchProgramInfo& info);
+
+/// Transposes the registers written by the batched program back to the shader units.
+void ScatterBatch(const BatchShaderUnit& batch, std::span<ShaderUnit> units,
+                  const BatchProgramInfo& info);
+
+} // namespace Pica::Shader
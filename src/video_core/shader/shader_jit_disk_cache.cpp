@@ -0,0 +1,188 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/zstd_compression.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+namespace {
+
+constexpr std::array<u8, 4> CACHE_MAGIC = {'P', 'J', 'I', 'T'};
+constexpr u32 CACHE_VERSION = 1;
+
+struct CacheHeader {
+    std::array<u8, 4> magic;
+    u32 version;
+    std::array<char, 64> build_id;
+};
+static_assert(sizeof(CacheHeader) == 72, "CacheHeader has incorrect size!");
+
+struct EntryHeader {
+    u64 compressed_size;
+    u64 checksum;
+};
+
+CacheHeader MakeHeader() {
+    CacheHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    std::strncpy(header.build_id.data(), Common::g_scm_rev, header.build_id.size() - 1);
+    return header;
+}
+
+bool ReadHeader(FileUtil::IOFile& file) {
+    CacheHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    const CacheHeader expected = MakeHeader();
+    return std::memcmp(&header, &expected, sizeof(header)) == 0;
+}
+
+bool WriteEntry(FileUtil::IOFile& file, const JitDiskCacheEntry& entry) {
+    const auto compressed = Common::Compression::CompressDataZSTDDefault(
+        {reinterpret_cast<const u8*>(&entry), sizeof(entry)});
+    const EntryHeader header{
+        .compressed_size = compressed.size(),
+        .checksum = Common::ComputeHash64(compressed.data(), compressed.size()),
+    };
+    return file.WriteObject(header) == 1 &&
+           file.WriteSpan(std::span<const u8>{compressed}) == compressed.size();
+}
+
+} // Anonymous namespace
+
+JitDiskCache::JitDiskCache(u64 title_id_) : title_id{title_id_} {
+    // Entries may be appended before the background preload got to read the file, so the header
+    // is checked right away to avoid truncating a valid cache.
+    FileUtil::IOFile cache_file{GetCachePath(), "rb"};
+    file_valid = cache_file.IsOpen() && ReadHeader(cache_file);
+}
+
+JitDiskCache::~JitDiskCache() = default;
+
+std::vector<JitDiskCacheEntry> JitDiskCache::Load() {
+    std::scoped_lock lock{mutex};
+
+    std::vector<JitDiskCacheEntry> entries;
+    if (!file_valid) {
+        LOG_INFO(HW_GPU, "No shader JIT cache found for title_id={:016X}", title_id);
+        return entries;
+    }
+
+    FileUtil::IOFile cache_file{GetCachePath(), "rb"};
+    if (!cache_file.IsOpen() || !ReadHeader(cache_file)) {
+        file_valid = false;
+        return entries;
+    }
+
+    bool corrupted = false;
+    std::vector<u8> compressed;
+    while (true) {
+        EntryHeader header{};
+        const std::size_t read = cache_file.ReadBytes(&header, sizeof(header));
+        if (read != sizeof(header)) {
+            corrupted = read != 0;
+            break;
+        }
+        compressed.resize(header.compressed_size);
+        if (cache_file.ReadSpan(std::span<u8>{compressed}) != compressed.size() ||
+            Common::ComputeHash64(compressed.data(), compressed.size()) != header.checksum) {
+            corrupted = true;
+            break;
+        }
+        const auto data = Common::Compression::DecompressDataZSTD(compressed);
+        if (data.size() != sizeof(JitDiskCacheEntry)) {
+            corrupted = true;
+            break;
+        }
+        std::memcpy(&entries.emplace_back(), data.data(), sizeof(JitDiskCacheEntry));
+    }
+    cache_file.Close();
+
+    // A partially written entry would hide everything appended after it, so rewrite the file with
+    // the entries that could be read.
+    if (corrupted) {
+        LOG_WARNING(HW_GPU, "Shader JIT cache for title_id={:016X} is corrupted, rewriting it",
+                    title_id);
+        file.Close();
+        file = FileUtil::IOFile{GetCachePath(), "wb"};
+        const CacheHeader header = MakeHeader();
+        bool written = file.IsOpen() && file.WriteObject(header) == 1;
+        for (const JitDiskCacheEntry& entry : entries) {
+            written = written && WriteEntry(file, entry);
+        }
+        file_valid = written;
+        file.Close();
+    }
+
+    LOG_INFO(HW_GPU, "Loaded {} programs from the shader JIT cache for title_id={:016X}",
+             entries.size(), title_id);
+    return entries;
+}
+
+void JitDiskCache::Append(const JitDiskCacheEntry& entry) {
+    std::scoped_lock lock{mutex};
+
+    if (!file.IsOpen()) {
+        if (!EnsureDirectories()) {
+            return;
+        }
+        file = FileUtil::IOFile{GetCachePath(), file_valid ? "ab" : "wb"};
+        if (!file.IsOpen()) {
+            LOG_ERROR(HW_GPU, "Failed to open shader JIT cache file={}", GetCachePath());
+            return;
+        }
+        if (!file_valid) {
+            if (file.WriteObject(MakeHeader()) != 1) {
+                LOG_ERROR(HW_GPU, "Failed to write shader JIT cache header");
+                file.Close();
+                return;
+            }
+            file_valid = true;
+        }
+    }
+
+    if (!WriteEntry(file, entry)) {
+        LOG_ERROR(HW_GPU, "Failed to write shader JIT cache entry");
+    }
+    file.Flush();
+}
+
+bool JitDiskCache::EnsureDirectories() const {
+    const auto create_dir = [](const std::string& dir) {
+        if (!FileUtil::CreateDir(dir)) {
+            LOG_ERROR(HW_GPU, "Failed to create directory={}", dir);
+            return false;
+        }
+        return true;
+    };
+
+    return create_dir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
+           create_dir(GetCacheDir());
+}
+
+std::string JitDiskCache::GetCacheDir() const {
+    return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + "jit" + DIR_SEP;
+}
+
+std::string JitDiskCache::GetCachePath() const {
+    return fmt::format("{}{:016X}.bin", GetCacheDir(), title_id);
+}
+
+} // namespace Pica::Shader
+
+#endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
@@ -0,0 +1,61 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/pica/shader_setup.h"
+
+namespace Pica::Shader {
+
+/// A program compiled by the shader JIT, with everything needed to compile it again.
+struct JitDiskCacheEntry {
+    u64 cache_key;
+    u32 entry_point;
+    ProgramCode program_code;
+    SwizzleData swizzle_data;
+};
+
+/**
+ * Per-title file recording the programs compiled by the shader JIT, so that the next boot can
+ * compile them in the background before the first draw needs them. Entries are keyed by the
+ * program and swizzle hashes the engine computes at SetupBatch, the file is discarded when it was
+ * written by a different build.
+ */
+class JitDiskCache {
+public:
+    explicit JitDiskCache(u64 title_id);
+    ~JitDiskCache();
+
+    u64 GetTitleID() const {
+        return title_id;
+    }
+
+    /// Reads the entries recorded by previous runs. Corrupted entries are skipped.
+    std::vector<JitDiskCacheEntry> Load();
+
+    /// Records a newly compiled program.
+    void Append(const JitDiskCacheEntry& entry);
+
+private:
+    bool EnsureDirectories() const;
+    std::string GetCacheDir() const;
+    std::string GetCachePath() const;
+
+    u64 title_id;
+    std::mutex mutex;
+    FileUtil::IOFile file;
+    bool file_valid{};
+};
+
+} // namespace Pica::Shader
+
+#endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
@@ -0,0 +1,980 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64)
+
+#include <algorithm>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include <xbyak/xbyak_util.h>
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "common/x64/xbyak_util.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+using nihstro::DestRegister;
+using nihstro::RegisterType;
+
+static const Xbyak::util::Cpu host_caps;
+
+namespace Pica::Shader {
+
+typedef void (JitBatchShader::*BatchJitFunction)(Instruction instr);
+
+// Instructions depending on per vertex state are left out, AnalyzeBatchProgram makes sure they are
+// never reached.
+const BatchJitFunction batch_instr_table[64] = {
+    &JitBatchShader::Compile_ADD,   // add
+    &JitBatchShader::Compile_DP3,   // dp3
+    &JitBatchShader::Compile_DP4,   // dp4
+    &JitBatchShader::Compile_DPH,   // dph
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_EX2,   // ex2
+    &JitBatchShader::Compile_LG2,   // lg2
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_MUL,   // mul
+    &JitBatchShader::Compile_SGE,   // sge
+    &JitBatchShader::Compile_SLT,   // slt
+    &JitBatchShader::Compile_FLR,   // flr
+    &JitBatchShader::Compile_MAX,   // max
+    &JitBatchShader::Compile_MIN,   // min
+    &JitBatchShader::Compile_RCP,   // rcp
+    &JitBatchShader::Compile_RSQ,   // rsq
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // mova
+    &JitBatchShader::Compile_MOV,   // mov
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_DPH,   // dphi
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_SGE,   // sgei
+    &JitBatchShader::Compile_SLT,   // slti
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    nullptr,                        // unknown
+    &JitBatchShader::Compile_NOP,   // nop
+    &JitBatchShader::Compile_END,   // end
+    nullptr,                        // breakc
+    &JitBatchShader::Compile_CALL,  // call
+    nullptr,                        // callc
+    &JitBatchShader::Compile_CALLU, // callu
+    &JitBatchShader::Compile_IF,    // ifu
+    nullptr,                        // ifc
+    &JitBatchShader::Compile_LOOP,  // loop
+    nullptr,                        // emit
+    nullptr,                        // sete
+    nullptr,                        // jmpc
+    &JitBatchShader::Compile_JMP,   // jmpu
+    nullptr,                        // cmp
+    nullptr,                        // cmp
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // madi
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+    &JitBatchShader::Compile_MAD,   // mad
+};
+
+// The following is used to alias some commonly used registers. Generally, RAX-RDX and the SRC
+// registers can be used as scratch registers within a compiler function. Each SRC register holds
+// a single component of the swizzled source for all the vertices of the batch.
+
+/// Pointer to the uniform memory
+constexpr Reg64 UNIFORMS = r9;
+/// VS loop count register
+constexpr Reg32 LOOPCOUNT_REG = r12d;
+/// Current VS loop iteration number (we could probably use LOOPCOUNT_REG, but this quicker)
+constexpr Reg32 LOOPCOUNT = esi;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration
+constexpr Reg32 LOOPINC = edi;
+/// Pointer to the BatchShaderUnit instance for the current batch
+constexpr Reg64 STATE = r15;
+/// SIMD scratch register, also used as the implicit mask of BLENDVPS
+constexpr Xmm SCRATCH = xmm0;
+/// Loaded with the components of the first swizzled source register
+constexpr std::array<Xmm, 4> SRC1 = {xmm1, xmm2, xmm3, xmm4};
+/// Loaded with the components of the second swizzled source register
+constexpr std::array<Xmm, 4> SRC2 = {xmm5, xmm6, xmm7, xmm8};
+/// Loaded with the components of the third swizzled source register
+constexpr std::array<Xmm, 4> SRC3 = {xmm9, xmm10, xmm11, xmm12};
+/// Additional scratch register
+constexpr Xmm SCRATCH2 = xmm13;
+/// Constant vector of [1.0f, 1.0f, 1.0f, 1.0f], used to efficiently set a vector to one
+constexpr Xmm ONE = xmm14;
+/// Constant vector of [-0.f, -0.f, -0.f, -0.f], used to efficiently negate a vector with XOR
+constexpr Xmm NEGBIT = xmm15;
+
+// State registers that must not be modified by external functions calls
+static const std::bitset<32> persistent_regs = BuildRegSet({
+    // Pointers to register blocks
+    UNIFORMS,
+    STATE,
+    // Cached registers
+    LOOPCOUNT_REG,
+    // Constants
+    ONE,
+    NEGBIT,
+    // Loop variables
+    LOOPCOUNT,
+    LOOPINC,
+});
+
+/// Mask of all the components of a register
+constexpr u32 ALL_COMPONENTS = 0b1111;
+
+static void LogCritical(const char* msg) {
+    LOG_CRITICAL(HW_GPU, "{}", msg);
+}
+
+bool JitBatchShader::IsSupported() {
+    return host_caps.has(Cpu::tSSE41);
+}
+
+void JitBatchShader::Compile_Assert(bool condition, const char* msg) {
+    if (!condition) {
+        ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
+        mov(ABI_PARAM1, reinterpret_cast<std::size_t>(msg));
+        CallFarFunction(*this, LogCritical);
+        ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
+    }
+}
+
+u32 JitBatchShader::DestComponents(Instruction instr) const {
+    const bool is_mad = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+                        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+    const SwizzlePattern swiz = {
+        (*swizzle_data)[is_mad ? instr.mad.operand_desc_id : instr.common.operand_desc_id]};
+
+    u32 components = 0;
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            components |= 1U << comp;
+        }
+    }
+    return components;
+}
+
+void JitBatchShader::Compile_LoadUniform(Xmm dest, const Xbyak::Address& src) {
+    if (host_caps.has(Cpu::tAVX)) {
+        vbroadcastss(dest, src);
+    } else {
+        movss(dest, src);
+        shufps(dest, dest, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+}
+
+/**
+ * Loads the swizzled components of a source register into the specified XMM registers.
+ * @param instr VS instruction, used for determining how to load the source register
+ * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, 3 = src3)
+ * @param src_reg SourceRegister object corresponding to the source register to load
+ * @param dest Destination XMM registers, one per component
+ * @param components Mask of the components of dest to load
+ */
+void JitBatchShader::Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                                        const Components& dest, u32 components) {
+    u32 operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    u32 address_register_index;
+    u32 offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    const SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+    const u8 sel = swiz.GetRawSelector(src_num);
+    const auto selector = [sel](u32 comp) -> u32 { return (sel >> (6 - 2 * comp)) & 3; };
+    const auto for_each_component = [components](auto&& func) {
+        for (u32 comp = 0; comp < 4; ++comp) {
+            if (components & (1U << comp)) {
+                func(comp);
+            }
+        }
+    };
+
+    switch (src_reg.GetRegisterType()) {
+    case RegisterType::Input:
+        for_each_component([&](u32 comp) {
+            const auto offset = BatchShaderUnit::InputOffset(src_reg.GetIndex(), selector(comp));
+            movaps(dest[comp], xword[STATE + static_cast<int>(offset)]);
+        });
+        break;
+    case RegisterType::Temporary:
+        for_each_component([&](u32 comp) {
+            const auto offset =
+                BatchShaderUnit::TemporaryOffset(src_reg.GetIndex(), selector(comp));
+            movaps(dest[comp], xword[STATE + static_cast<int>(offset)]);
+        });
+        break;
+    case RegisterType::FloatUniform:
+        // Only the loop counter is uniform across the batch, a0 is never used by batched programs.
+        if (src_num == offset_src && address_register_index == 3) {
+            // s32 offset = address_reg >= -128 && address_reg <= 127 ? address_reg : 0;
+            // u32 index = (src_reg.GetIndex() + offset) & 0x7f;
+            lea(eax, ptr[LOOPCOUNT_REG.cvt64() + 128]);
+            mov(ebx, src_reg.GetIndex());
+            mov(ecx, LOOPCOUNT_REG);
+            add(ecx, ebx);
+            cmp(eax, 256);
+            cmovb(ebx, ecx);
+            and_(ebx, 0x7f);
+
+            // index > 95 ? vec4(1.0) : uniforms.f[index];
+            Label load_one, load_end;
+            cmp(ebx, 95);
+            jg(load_one, T_NEAR);
+            shl(rbx, 4);
+            for_each_component([&](u32 comp) {
+                const auto offset =
+                    Uniforms::GetFloatUniformOffset(0) + selector(comp) * sizeof(f24);
+                Compile_LoadUniform(dest[comp], dword[UNIFORMS + rbx + static_cast<int>(offset)]);
+            });
+            jmp(load_end, T_NEAR);
+            L(load_one);
+            for_each_component([&](u32 comp) { movaps(dest[comp], ONE); });
+            L(load_end);
+        } else {
+            for_each_component([&](u32 comp) {
+                const auto offset = Uniforms::GetFloatUniformOffset(src_reg.GetIndex()) +
+                                    selector(comp) * sizeof(f24);
+                Compile_LoadUniform(dest[comp], dword[UNIFORMS + static_cast<int>(offset)]);
+            });
+        }
+        break;
+    default:
+        UNREACHABLE_MSG("Encountered unknown source register type: {}", src_reg.GetRegisterType());
+        break;
+    }
+
+    // If the source register should be negated, flip the negative bit using XOR
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        for_each_component([&](u32 comp) { xorps(dest[comp], NEGBIT); });
+    }
+}
+
+void JitBatchShader::Compile_DestEnable(Instruction instr, const Components& src) {
+    DestRegister dest;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        dest = instr.mad.dest.Value();
+    } else {
+        dest = instr.common.dest.Value();
+    }
+
+    const u32 components = DestComponents(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (!(components & (1U << comp))) {
+            continue;
+        }
+
+        std::size_t dest_offset_disp;
+        switch (dest.GetRegisterType()) {
+        case RegisterType::Output:
+            dest_offset_disp = BatchShaderUnit::OutputOffset(dest.GetIndex(), comp);
+            break;
+        case RegisterType::Temporary:
+            dest_offset_disp = BatchShaderUnit::TemporaryOffset(dest.GetIndex(), comp);
+            break;
+        default:
+            UNREACHABLE_MSG("Encountered unknown destination register type: {}",
+                            dest.GetRegisterType());
+            break;
+        }
+
+        // Disabled components are simply not stored, no blending is needed
+        movaps(xword[STATE + static_cast<int>(dest_offset_disp)], src[comp]);
+    }
+}
+
+void JitBatchShader::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. This can be implemented by
+    // checking for NaNs before and after the multiplication.  If the multiplication result is NaN
+    // where neither source was, this NaN was generated by a 0 * inf multiplication, and so the
+    // result should be transformed to 0 to match PICA fp rules.
+
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL | Cpu::tAVX512DQ)) {
+        vmulps(scratch, src1, src2);
+
+        // Mask of any NaN values found in the result
+        const Xbyak::Opmask zero_mask = k1;
+        vcmpunordps(zero_mask, scratch, scratch);
+
+        // Mask of any non-NaN inputs producing NaN results
+        vcmpordps(zero_mask | zero_mask, src1, src2);
+
+        knotb(zero_mask, zero_mask);
+        vmovaps(src1 | zero_mask | T_z, scratch);
+
+        return;
+    }
+
+    // Set scratch to mask of (src1 != NaN and src2 != NaN)
+    if (host_caps.has(Cpu::tAVX)) {
+        vcmpordps(scratch, src1, src2);
+    } else {
+        movaps(scratch, src1);
+        cmpordps(scratch, src2);
+    }
+
+    mulps(src1, src2);
+
+    // Set src2 to mask of (result == NaN)
+    if (host_caps.has(Cpu::tAVX)) {
+        vcmpunordps(src2, src2, src1);
+    } else {
+        movaps(src2, src1);
+        cmpunordps(src2, src2);
+    }
+
+    // Clear components where scratch != src2 (i.e. if result is NaN where neither source was NaN)
+    xorps(scratch, src2);
+    andps(src1, scratch);
+}
+
+void JitBatchShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+std::bitset<32> JitBatchShader::PersistentCallerSavedRegs() {
+    return persistent_regs & ABI_ALL_CALLER_SAVED;
+}
+
+void JitBatchShader::Compile_ADD(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            addps(SRC1[comp], SRC2[comp]);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_DP3(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0111);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, 0b0111);
+
+    for (u32 comp = 0; comp < 3; ++comp) {
+        Compile_SanitizedMul(SRC1[comp], SRC2[comp], SCRATCH);
+    }
+    addps(SRC1[0], SRC1[1]);
+    addps(SRC1[0], SRC1[2]);
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_DP4(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, ALL_COMPONENTS);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, ALL_COMPONENTS);
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        Compile_SanitizedMul(SRC1[comp], SRC2[comp], SCRATCH);
+    }
+
+    // Same summation order as the HADDPS sequence of the scalar JIT
+    addps(SRC1[0], SRC1[1]);
+    addps(SRC1[2], SRC1[3]);
+    addps(SRC1[0], SRC1[2]);
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, 0b0111);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, ALL_COMPONENTS);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0111);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, ALL_COMPONENTS);
+    }
+
+    for (u32 comp = 0; comp < 3; ++comp) {
+        Compile_SanitizedMul(SRC1[comp], SRC2[comp], SCRATCH);
+    }
+
+    // The 4th component of src1 is 1.0, so its product is the 4th component of src2
+    movaps(SRC1[3], SRC2[3]);
+
+    addps(SRC1[0], SRC1[1]);
+    addps(SRC1[2], SRC1[3]);
+    addps(SRC1[0], SRC1[2]);
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_EX2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Vectorized version of the scalar JIT approximation: a range reduction into [-0.5, 0.5)
+    // followed by a minimax polynomial fit for exp2(x), lanes holding NaN are passed through.
+    const Xmm input = SRC1[0];
+    const Xmm nan_mask = SRC2[0];
+    const Xmm original = SRC2[1];
+    const Xmm rounded = SRC2[2];
+    const Xmm scale = SRC2[3];
+    const Xmm poly = SRC3[0];
+
+    movaps(original, input);
+    movaps(nan_mask, input);
+    cmpunordps(nan_mask, input);
+
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    minps(input, xword[rip + constants.exp2_input_max]);
+    maxps(input, xword[rip + constants.exp2_input_min]);
+
+    movaps(rounded, input);
+    subps(rounded, xword[rip + constants.half]);
+    roundps(rounded, rounded, _MM_FROUND_TRUNC);
+    cvtps2dq(scale, rounded);
+    // rounded now contains input rounded to the nearest integer.
+    paddd(scale, xword[rip + constants.exponent_bias]);
+    pslld(scale, 23);
+    // scale contains 2^(round(input)).
+    subps(input, rounded);
+    // input contains input - round(input), which is in [-0.5, 0.5).
+
+    // Complete computation of polynomial.
+    movaps(poly, xword[rip + constants.exp2_coeffs[0]]);
+    if (host_caps.has(Cpu::tFMA)) {
+        vfmadd213ps(poly, input, xword[rip + constants.exp2_coeffs[1]]);
+        vfmadd213ps(poly, input, xword[rip + constants.exp2_coeffs[2]]);
+        vfmadd213ps(poly, input, xword[rip + constants.exp2_coeffs[3]]);
+        vfmadd213ps(input, poly, xword[rip + constants.exp2_coeffs[4]]);
+    } else {
+        mulps(poly, input);
+        addps(poly, xword[rip + constants.exp2_coeffs[1]]);
+        mulps(poly, input);
+        addps(poly, xword[rip + constants.exp2_coeffs[2]]);
+        mulps(poly, input);
+        addps(poly, xword[rip + constants.exp2_coeffs[3]]);
+        mulps(input, poly);
+        addps(input, xword[rip + constants.exp2_coeffs[4]]);
+    }
+    mulps(input, scale);
+
+    movaps(SCRATCH, nan_mask);
+    blendvps(input, original);
+
+    Compile_DestEnable(instr, {input, input, input, input});
+}
+
+void JitBatchShader::Compile_LG2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Vectorized version of the scalar JIT approximation: a range reduction into [1.0, 2.0)
+    // followed by a minimax polynomial fit for log2(x) / (x - 1). NaN lanes are passed through,
+    // zero gives -inf and negative inputs give NaN.
+    const Xmm input = SRC1[0];
+    const Xmm nan_mask = SRC2[0];
+    const Xmm zero_mask = SRC2[1];
+    const Xmm negative_mask = SRC2[2];
+    const Xmm mantissa = SRC2[3];
+    const Xmm exponent = SRC3[0];
+    const Xmm poly = SRC3[1];
+
+    xorps(SCRATCH, SCRATCH);
+    movaps(nan_mask, input);
+    cmpunordps(nan_mask, input);
+    movaps(zero_mask, input);
+    cmpeqps(zero_mask, SCRATCH);
+    movaps(negative_mask, input);
+    cmpleps(negative_mask, SCRATCH);
+
+    // Split input: mantissa=MANT[1,2) exponent=Exponent
+    movaps(mantissa, input);
+    andps(mantissa, xword[rip + constants.mantissa_mask]);
+    orps(mantissa, ONE);
+    movaps(exponent, input);
+    andps(exponent, xword[rip + constants.exponent_mask]);
+    psrld(exponent, 23);
+    psubd(exponent, xword[rip + constants.exponent_bias]);
+    cvtdq2ps(exponent, exponent);
+
+    // Complete computation of polynomial
+    movaps(poly, xword[rip + constants.log2_coeffs[0]]);
+    if (host_caps.has(Cpu::tFMA)) {
+        vfmadd213ps(poly, mantissa, xword[rip + constants.log2_coeffs[1]]);
+        vfmadd213ps(poly, mantissa, xword[rip + constants.log2_coeffs[2]]);
+        vfmadd213ps(poly, mantissa, xword[rip + constants.log2_coeffs[3]]);
+        vfmadd213ps(poly, mantissa, xword[rip + constants.log2_coeffs[4]]);
+        subps(mantissa, ONE);
+        vfmadd231ps(exponent, poly, mantissa);
+    } else {
+        mulps(poly, mantissa);
+        addps(poly, xword[rip + constants.log2_coeffs[1]]);
+        mulps(poly, mantissa);
+        addps(poly, xword[rip + constants.log2_coeffs[2]]);
+        mulps(poly, mantissa);
+        addps(poly, xword[rip + constants.log2_coeffs[3]]);
+        mulps(poly, mantissa);
+        subps(mantissa, ONE);
+        addps(poly, xword[rip + constants.log2_coeffs[4]]);
+        mulps(poly, mantissa);
+        addps(exponent, poly);
+    }
+
+    // Patch the edge cases, zero being a subset of the non positive inputs
+    movaps(SCRATCH, negative_mask);
+    blendvps(exponent, xword[rip + constants.default_qnan]);
+    movaps(SCRATCH, zero_mask);
+    blendvps(exponent, xword[rip + constants.negative_infinity]);
+    movaps(SCRATCH, nan_mask);
+    blendvps(exponent, input);
+
+    Compile_DestEnable(instr, {exponent, exponent, exponent, exponent});
+}
+
+void JitBatchShader::Compile_MUL(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            Compile_SanitizedMul(SRC1[comp], SRC2[comp], SCRATCH);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_SGE(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, components);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    }
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            cmpleps(SRC2[comp], SRC1[comp]);
+            andps(SRC2[comp], ONE);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC2);
+}
+
+void JitBatchShader::Compile_SLT(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, components);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    }
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            cmpltps(SRC1[comp], SRC2[comp]);
+            andps(SRC1[comp], ONE);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_FLR(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            roundps(SRC1[comp], SRC1[comp], _MM_FROUND_FLOOR);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MAX(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            maxps(SRC1[comp], SRC2[comp]);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MIN(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, components);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, components);
+    // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            minps(SRC1[comp], SRC2[comp]);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MOV(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, DestComponents(instr));
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Uses the same approximations as the scalar JIT, only the X component is used
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL)) {
+        vrcp14ps(SRC1[0], SRC1[0]);
+    } else {
+        rcpps(SRC1[0], SRC1[0]);
+    }
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, 0b0001);
+
+    // Uses the same approximations as the scalar JIT, only the X component is used
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL)) {
+        vrsqrt14ps(SRC1[0], SRC1[0]);
+    } else {
+        rsqrtps(SRC1[0], SRC1[0]);
+    }
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitBatchShader::Compile_NOP(Instruction instr) {}
+
+void JitBatchShader::Compile_END(Instruction instr) {
+    // Save loop register
+    mov(dword[STATE + offsetof(BatchShaderUnit, loop_counter)], LOOPCOUNT_REG);
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
+}
+
+void JitBatchShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return
+    push(qword, (instr.flow_control.dest_offset + instr.flow_control.num_instructions));
+
+    // Call the subroutine
+    call(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitBatchShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitBatchShader::Compile_MAD(Instruction instr) {
+    const u32 components = DestComponents(instr);
+    Compile_SwizzleSrc(instr, 1, instr.mad.src1, SRC1, components);
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2i, SRC2, components);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3i, SRC3, components);
+    } else {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2, SRC2, components);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3, components);
+    }
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (components & (1U << comp)) {
+            Compile_SanitizedMul(SRC1[comp], SRC2[comp], SCRATCH);
+            addps(SRC1[comp], SRC3[comp]);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_IF(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards if-statements not supported");
+    Label l_else, l_endif;
+
+    // Evaluate the "IF" condition
+    Compile_UniformCondition(instr);
+    jz(l_else, T_NEAR);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        L(l_else);
+        return;
+    }
+
+    jmp(l_endif, T_NEAR);
+
+    L(l_else);
+    // This code corresponds to the "ELSE" condition
+    // Comple the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    L(l_endif);
+}
+
+void JitBatchShader::Compile_LOOP(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards loops not supported");
+    Compile_Assert(loop_depth < 1, "Nested loops may not be supported");
+    if (loop_depth++) {
+        const auto loop_save_regs = BuildRegSet({LOOPCOUNT_REG, LOOPINC, LOOPCOUNT});
+        ABI_PushRegistersAndAdjustStack(*this, loop_save_regs, 0);
+    }
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(LOOPCOUNT_REG, LOOPCOUNT);
+    shr(LOOPCOUNT_REG, 8);
+    and_(LOOPCOUNT_REG, 0xFF); // Y-component is the start
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 16);
+    and_(LOOPINC, 0xFF);                // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    sub(LOOPCOUNT, 1);           // Increment loop count by 1
+    jnz(l_loop_start);           // Loop if not equal
+
+    if (--loop_depth) {
+        const auto loop_save_regs = BuildRegSet({LOOPCOUNT_REG, LOOPINC, LOOPCOUNT});
+        ABI_PopRegistersAndAdjustStack(*this, loop_save_regs, 0);
+    }
+}
+
+void JitBatchShader::Compile_JMP(Instruction instr) {
+    Compile_UniformCondition(instr);
+
+    const bool inverted_condition = (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        jz(b, T_NEAR);
+    } else {
+        jnz(b, T_NEAR);
+    }
+}
+
+void JitBatchShader::Compile_Block(u32 end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitBatchShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitBatchShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    // Always treat the last instruction of the program code as an end instruction, like the
+    // scalar JIT does.
+    Instruction instr{};
+    if (program_counter < MAX_PROGRAM_CODE_LENGTH - 1) {
+        instr.hex = (*program_code)[program_counter];
+    } else {
+        instr.opcode.Assign(OpCode::Id::END);
+    }
+    ++program_counter;
+
+    const OpCode::Id opcode = instr.opcode.Value();
+    const auto instr_func = batch_instr_table[static_cast<u32>(opcode)];
+
+    // Unsupported instructions are not reachable from the entry point of a batched program, they
+    // are skipped silently since the rest of the program code is still compiled.
+    if (instr_func) {
+        ((*this).*instr_func)(instr);
+    }
+}
+
+void JitBatchShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+void JitBatchShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                             const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_,
+                             const BatchProgramInfo& info) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+    program_info = info;
+
+    // Reset flow control state
+    program = (CompiledShader*)getCurr();
+    program_counter = 0;
+    loop_depth = 0;
+    instruction_labels.fill(Xbyak::Label());
+
+    // Find all `CALL` instructions and identify return locations
+    FindReturnOffsets();
+
+    // The stack pointer is 8 modulo 16 at the entry of a procedure
+    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine.
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+
+    // Load loop register
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(BatchShaderUnit, loop_counter)]);
+
+    // Used to set a register to one
+    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
+    mov(rax, reinterpret_cast<std::size_t>(&one));
+    movaps(ONE, xword[rax]);
+
+    // Used to negate registers
+    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
+    mov(rax, reinterpret_cast<std::size_t>(&neg));
+    movaps(NEGBIT, xword[rax]);
+
+    // Jump to start of the shader program
+    jmp(ABI_PARAM3);
+
+    // Compile entire program
+    Compile_Block(static_cast<u32>(program_code->size()));
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_BATCH_SHADER_SIZE,
+               "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled batch shader size={}", getSize());
+}
+
+JitBatchShader::JitBatchShader()
+    : Xbyak::CodeGenerator(MAX_BATCH_SHADER_SIZE),
+      code_accounting{Common::MemoryAccounting::Category::ShaderCache, MAX_BATCH_SHADER_SIZE} {
+    CompilePrelude();
+}
+
+const void* JitBatchShader::CompileConstant(u32 value) {
+    align(16);
+    const void* constant = getCurr();
+    for (std::size_t lane = 0; lane < SHADER_BATCH_SIZE; ++lane) {
+        dd(value);
+    }
+    return constant;
+}
+
+void JitBatchShader::CompilePrelude() {
+    // Float layout masks shared by the EX2 and LG2 approximations
+    constants.mantissa_mask = CompileConstant(0x007fffff);
+    constants.exponent_mask = CompileConstant(0x7f800000);
+    constants.exponent_bias = CompileConstant(0x7f);
+    constants.negative_infinity = CompileConstant(0xff800000);
+    constants.default_qnan = CompileConstant(0x7fc00000);
+
+    // Coefficients of the minimax polynomial approximating log2(x) / (x - 1).
+    constants.log2_coeffs = {
+        CompileConstant(0x3d74552f), CompileConstant(0xbeee7397), CompileConstant(0x3fbd96dd),
+        CompileConstant(0xc02153f6), CompileConstant(0x4038d96c),
+    };
+
+    // Range and coefficients of the minimax polynomial approximating exp2(x).
+    constants.exp2_input_max = CompileConstant(0x43010000);
+    constants.exp2_input_min = CompileConstant(0xc2fdffff);
+    constants.half = CompileConstant(0x3f000000);
+    constants.exp2_coeffs = {
+        CompileConstant(0x3c5dbe69), CompileConstant(0x3d5509f9), CompileConstant(0x3e773cc5),
+        CompileConstant(0x3f3168b3), CompileConstant(0x3f800016),
+    };
+}
+
+} // namespace Pica::Shader
+
+#endif // CITRA_ARCH(x86_64)
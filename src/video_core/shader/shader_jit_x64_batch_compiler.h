@@ -0,0 +1,171 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64)
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak/xbyak.h>
+#include "common/common_types.h"
+#include "common/memory_accounting.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/shader/shader_jit_batch.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SourceRegister;
+using nihstro::SwizzlePattern;
+
+namespace Pica::Shader {
+
+/// Memory allocated for each compiled batch shader, every component is emitted separately
+constexpr std::size_t MAX_BATCH_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 256;
+
+/**
+ * This class implements the batched shader JIT compiler. It recompiles a Pica shader program into
+ * x86_64 code that runs SHADER_BATCH_SIZE vertices at once, with each SSE lane holding a different
+ * vertex. Only programs accepted by AnalyzeBatchProgram may be run with it.
+ */
+class JitBatchShader : public Xbyak::CodeGenerator {
+public:
+    JitBatchShader();
+
+    /// Returns true if the host supports the instructions used by the batched JIT.
+    static bool IsSupported();
+
+    void Run(const ShaderSetup& setup, BatchShaderUnit& state, u32 offset) const {
+        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+    }
+
+    void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data,
+                 const BatchProgramInfo& info);
+
+    const BatchProgramInfo& GetProgramInfo() const {
+        return program_info;
+    }
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+
+private:
+    /// Accounts the code buffer reserved by the generator
+    Common::MemoryAccounting::Allocation code_accounting;
+
+    /// One host register per component of a Pica vector register
+    using Components = std::array<Xbyak::Xmm, 4>;
+
+    void Compile_Block(u32 end);
+    void Compile_NextInstr();
+
+    /**
+     * Loads the swizzled components of a source register.
+     * @param components Mask of the components to load, bit 0 being the X component
+     */
+    void Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                            const Components& dest, u32 components);
+    void Compile_DestEnable(Instruction instr, const Components& src);
+
+    /// Broadcasts a float uniform component to all the lanes of dest.
+    void Compile_LoadUniform(Xbyak::Xmm dest, const Xbyak::Address& src);
+
+    /**
+     * Compiles a `MUL src1, src2` operation, properly handling the PICA semantics when multiplying
+     * zero by inf. Clobbers `src2` and `scratch`.
+     */
+    void Compile_SanitizedMul(Xbyak::Xmm src1, Xbyak::Xmm src2, Xbyak::Xmm scratch);
+
+    void Compile_UniformCondition(Instruction instr);
+
+    /**
+     * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
+     */
+    void Compile_Return();
+
+    std::bitset<32> PersistentCallerSavedRegs();
+
+    /**
+     * Assertion evaluated at compile-time, but only triggered if executed at runtime.
+     * @param condition Condition to be evaluated.
+     * @param msg       Message to be logged if the assertion fails.
+     */
+    void Compile_Assert(bool condition, const char* msg);
+
+    /// Returns the mask of components enabled in the destination of the instruction.
+    u32 DestComponents(Instruction instr) const;
+
+    /**
+     * Analyzes the entire shader program for `CALL` instructions before emitting any code,
+     * identifying the locations where a return needs to be inserted.
+     */
+    void FindReturnOffsets();
+
+    /**
+     * Emits the constants used by the vectorized utility functions.
+     */
+    void CompilePrelude();
+    const void* CompileConstant(u32 value);
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+
+    /// Registers accessed by the compiled program
+    BatchProgramInfo program_info{};
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<u32> return_offsets;
+
+    u32 program_counter = 0; ///< Offset of the next instruction to decode
+    u8 loop_depth = 0;       ///< Depth of the (nested) loops currently compiled
+
+    using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
+    CompiledShader* program = nullptr;
+
+    struct Constants {
+        const void* mantissa_mask;
+        const void* exponent_mask;
+        const void* exponent_bias;
+        const void* negative_infinity;
+        const void* default_qnan;
+        std::array<const void*, 5> log2_coeffs;
+        const void* exp2_input_max;
+        const void* exp2_input_min;
+        const void* half;
+        std::array<const void*, 5> exp2_coeffs;
+    } constants{};
+};
+
+} // namespace Pica::Shader
+
+#endif
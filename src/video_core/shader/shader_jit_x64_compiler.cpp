@@ -433,6 +433,10 @@ void JitShader::Compile_UniformCondition(Instruction instr) {
     cmp(byte[UNIFORMS + offset], 0);
 }
 
+bool JitShader::ConstantUniformCondition(Instruction instr) const {
+    return (control_uniforms->b >> instr.flow_control.bool_uniform_id) & 1;
+}
+
 std::bitset<32> JitShader::PersistentCallerSavedRegs() {
     return persistent_regs & ABI_ALL_CALLER_SAVED;
 }
@@ -706,6 +710,12 @@ void JitShader::Compile_CALLC(Instruction instr) {
 }
 
 void JitShader::Compile_CALLU(Instruction instr) {
+    if (control_uniforms) {
+        if (ConstantUniformCondition(instr)) {
+            Compile_CALL(instr);
+        }
+        return;
+    }
     Compile_UniformCondition(instr);
     Label b;
     jz(b);
@@ -778,13 +788,19 @@ void JitShader::Compile_IF(Instruction instr) {
                    "Backwards if-statements not supported");
     Label l_else, l_endif;
 
-    // Evaluate the "IF" condition
-    if (instr.opcode.Value() == OpCode::Id::IFU) {
-        Compile_UniformCondition(instr);
-    } else if (instr.opcode.Value() == OpCode::Id::IFC) {
-        Compile_EvaluateCondition(instr);
+    // Evaluate the "IF" condition. Constant uniforms leave the untaken block unreachable.
+    if (instr.opcode.Value() == OpCode::Id::IFU && control_uniforms) {
+        if (!ConstantUniformCondition(instr)) {
+            jmp(l_else, T_NEAR);
+        }
+    } else {
+        if (instr.opcode.Value() == OpCode::Id::IFU) {
+            Compile_UniformCondition(instr);
+        } else if (instr.opcode.Value() == OpCode::Id::IFC) {
+            Compile_EvaluateCondition(instr);
+        }
+        jz(l_else, T_NEAR);
     }
-    jz(l_else, T_NEAR);
 
     // Compile the code that corresponds to the condition evaluating as true
     Compile_Block(instr.flow_control.dest_offset);
@@ -817,16 +833,23 @@ void JitShader::Compile_LOOP(Instruction instr) {
     // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
     // The Y (LOOPCOUNT_REG) and Z (LOOPINC) component are kept multiplied by 16 (Left shifted by
     // 4 bits) to be used as an offset into the 16-byte vector registers later
-    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
-    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
-    mov(LOOPCOUNT_REG, LOOPCOUNT);
-    shr(LOOPCOUNT_REG, 8);
-    and_(LOOPCOUNT_REG, 0xFF); // Y-component is the start
-    mov(LOOPINC, LOOPCOUNT);
-    shr(LOOPINC, 16);
-    and_(LOOPINC, 0xFF);                // Z-component is the incrementer
-    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
-    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+    if (control_uniforms) {
+        const u32 value = control_uniforms->i[instr.flow_control.int_uniform_id];
+        mov(LOOPCOUNT_REG, (value >> 8) & 0xFF);
+        mov(LOOPINC, (value >> 16) & 0xFF);
+        mov(LOOPCOUNT, (value & 0xFF) + 1);
+    } else {
+        std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+        mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+        mov(LOOPCOUNT_REG, LOOPCOUNT);
+        shr(LOOPCOUNT_REG, 8);
+        and_(LOOPCOUNT_REG, 0xFF); // Y-component is the start
+        mov(LOOPINC, LOOPCOUNT);
+        shr(LOOPINC, 16);
+        and_(LOOPINC, 0xFF);                // Z-component is the incrementer
+        movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+        add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+    }
 
     Label l_loop_start;
     L(l_loop_start);
@@ -848,6 +871,14 @@ void JitShader::Compile_LOOP(Instruction instr) {
 }
 
 void JitShader::Compile_JMP(Instruction instr) {
+    if (instr.opcode.Value() == OpCode::Id::JMPU && control_uniforms) {
+        // An odd num_instructions inverts the condition
+        if (ConstantUniformCondition(instr) != (instr.flow_control.num_instructions & 1)) {
+            jmp(instruction_labels[instr.flow_control.dest_offset], T_NEAR);
+        }
+        return;
+    }
+
     if (instr.opcode.Value() == OpCode::Id::JMPC)
         Compile_EvaluateCondition(instr);
     else if (instr.opcode.Value() == OpCode::Id::JMPU)
@@ -988,9 +1019,11 @@ void JitShader::FindReturnOffsets() {
 }
 
 void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
-                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_,
+                        const ControlUniforms* control) {
     program_code = program_code_;
     swizzle_data = swizzle_data_;
+    control_uniforms = control;
 
     // Reset flow control state
     program = (CompiledShader*)getCurr();
@@ -1038,6 +1071,7 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     // Free memory that's no longer needed
     program_code = nullptr;
     swizzle_data = nullptr;
+    control_uniforms = nullptr;
     return_offsets.clear();
     return_offsets.shrink_to_fit();
 
@@ -1047,7 +1081,9 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     LOG_DEBUG(HW_GPU, "Compiled shader size={}", getSize());
 }
 
-JitShader::JitShader() : Xbyak::CodeGenerator(MAX_SHADER_SIZE) {
+JitShader::JitShader()
+    : Xbyak::CodeGenerator(MAX_SHADER_SIZE),
+      code_accounting{Common::MemoryAccounting::Category::ShaderCache, MAX_SHADER_SIZE} {
     CompilePrelude();
 }
 
@@ -14,6 +14,7 @@
 #include <nihstro/shader_bytecode.h>
 #include <xbyak/xbyak.h>
 #include "common/common_types.h"
+#include "common/memory_accounting.h"
 #include "video_core/pica/shader_setup.h"
 
 using nihstro::Instruction;
@@ -42,8 +43,13 @@ public:
         program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
     }
 
+    /**
+     * Compiles the program. When control is provided, the bool and integer uniforms are compiled
+     * as the given constants and the shader may only run with those values.
+     */
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
-                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data,
+                 const ControlUniforms* control = nullptr);
 
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
@@ -76,6 +82,9 @@ public:
     void Compile_SETE(Instruction instr);
 
 private:
+    /// Accounts the code buffer reserved by the generator
+    Common::MemoryAccounting::Allocation code_accounting;
+
     void Compile_Block(u32 end);
     void Compile_NextInstr();
 
@@ -92,6 +101,9 @@ private:
     void Compile_EvaluateCondition(Instruction instr);
     void Compile_UniformCondition(Instruction instr);
 
+    /// Returns the value of the bool uniform tested by the instruction when compiled as constant
+    bool ConstantUniformCondition(Instruction instr) const;
+
     /**
      * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
      */
@@ -121,6 +133,7 @@ private:
 
     const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
     const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+    const ControlUniforms* control_uniforms = nullptr;
 
     /// Mapping of Pica VS instructions to pointers in the emitted code
     std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
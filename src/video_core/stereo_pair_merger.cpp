@@ -0,0 +1,50 @@
+// Copyright 2026 Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/settings.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_impl.h"
+#include "video_core/stereo_pair_merger.h"
+
+namespace VideoCore {
+bool StereoPairMerger::ShouldSkipDraws(PAddr addr, u32 size) {
+    if (!Settings::values.merge_stereo_renders.GetValue() ||
+        Settings::values.render_3d.GetValue() == Settings::StereoRenderOption::Off) {
+        last_list.reset();
+        return false;
+    }
+
+    auto& pica = gpu.impl->pica;
+    const auto signature = pica.SignCmdList(addr, size);
+    const auto last = std::exchange(last_list, signature);
+    if (!signature || !last || signature->hash != last->hash ||
+        signature->color_address == last->color_address) {
+        return false;
+    }
+
+    // Both lists are identical apart from the targets, so the framebuffer state left by the
+    // previous list describes the buffer to copy.
+    using FramebufferRegs = Pica::FramebufferRegs;
+    const auto& framebuffer = pica.regs.internal.framebuffer.framebuffer;
+    if (framebuffer.GetColorBufferPhysicalAddress() != last->color_address ||
+        framebuffer.color_format.Value() > FramebufferRegs::ColorFormat::RGBA4) {
+        return false;
+    }
+    const u32 bytes_per_pixel = FramebufferRegs::BytesPerColorPixel(framebuffer.color_format);
+
+    Pica::DisplayTransferConfig config{};
+    config.input_address = last->color_address / 8;
+    config.output_address = signature->color_address / 8;
+    config.is_texture_copy.Assign(1);
+    config.texture_copy.size = framebuffer.GetWidth() * framebuffer.GetHeight() * bytes_per_pixel;
+    if (!gpu.impl->rasterizer->AccelerateTextureCopy(config)) {
+        return false;
+    }
+
+    // Never chain a copy to the next list, its source was not rendered by its own commands.
+    last_list.reset();
+    return true;
+}
+} // namespace VideoCore
@@ -0,0 +1,31 @@
+// Copyright 2026 Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include "common/common_types.h"
+#include "video_core/pica/pica_core.h"
+
+namespace VideoCore {
+class GPU;
+
+/**
+ * Detects stereo frames where both eyes submit the same command list for different render
+ * targets, which games do when the 3D depth is zero. The render of the first eye is then copied
+ * to the target of the second one, so the frame is only drawn once.
+ */
+class StereoPairMerger {
+public:
+    explicit StereoPairMerger(GPU& gpu) : gpu{gpu} {}
+
+    /// Returns true when the render of the previous command list was copied to the target of
+    /// this one, so its draws can be skipped.
+    bool ShouldSkipDraws(PAddr addr, u32 size);
+
+private:
+    std::optional<Pica::PicaCore::CmdListSignature> last_list;
+    GPU& gpu;
+};
+} // namespace VideoCore
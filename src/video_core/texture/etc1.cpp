@@ -115,6 +115,31 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    /// Returns the base color of the half of the subtile, 0 being the left or top one
+    Common::Vec3<int> GetBaseColor(unsigned half) const {
+        if (differential_mode) {
+            Common::Vec3<int> ret{static_cast<int>(differential.r),
+                                  static_cast<int>(differential.g),
+                                  static_cast<int>(differential.b)};
+            if (half == 1) {
+                ret.r() += static_cast<int>(differential.dr);
+                ret.g() += static_cast<int>(differential.dg);
+                ret.b() += static_cast<int>(differential.db);
+            }
+            return {Common::Color::Convert5To8(static_cast<u8>(ret.r())),
+                    Common::Color::Convert5To8(static_cast<u8>(ret.g())),
+                    Common::Color::Convert5To8(static_cast<u8>(ret.b()))};
+        }
+        if (half == 0) {
+            return {Common::Color::Convert4To8(static_cast<u8>(separate.r1)),
+                    Common::Color::Convert4To8(static_cast<u8>(separate.g1)),
+                    Common::Color::Convert4To8(static_cast<u8>(separate.b1))};
+        }
+        return {Common::Color::Convert4To8(static_cast<u8>(separate.r2)),
+                Common::Color::Convert4To8(static_cast<u8>(separate.g2)),
+                Common::Color::Convert4To8(static_cast<u8>(separate.b2))};
+    }
 };
 
 } // anonymous namespace
@@ -124,4 +149,40 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::span<Common::Vec4<u8>, 16> texels) {
+    const ETC1Tile tile{value};
+
+    // A subtile only has eight distinct colors: each half picks one of four modifiers from its
+    // table. Evaluate them once, indexed by half, table subindex and negation flag.
+    std::array<Common::Vec4<u8>, 8> palette;
+    for (unsigned half = 0; half < 2; ++half) {
+        const Common::Vec3<int> base = tile.GetBaseColor(half);
+        const unsigned table_index = static_cast<unsigned>(
+            half == 0 ? tile.table_index_1.Value() : tile.table_index_2.Value());
+        for (unsigned entry = 0; entry < 4; ++entry) {
+            int modifier = etc1_modifier_table[table_index][entry >> 1];
+            if (entry & 1) {
+                modifier = -modifier;
+            }
+            palette[half * 4 + entry] = {static_cast<u8>(std::clamp(base.r() + modifier, 0, 255)),
+                                         static_cast<u8>(std::clamp(base.g() + modifier, 0, 255)),
+                                         static_cast<u8>(std::clamp(base.b() + modifier, 0, 255)),
+                                         255};
+        }
+    }
+
+    // The pixel indices are stored in column major order
+    const u32 subindexes = static_cast<u32>(tile.table_subindexes);
+    const u32 negations = static_cast<u32>(tile.negation_flags);
+    for (unsigned x = 0; x < 4; ++x) {
+        for (unsigned y = 0; y < 4; ++y) {
+            const unsigned texel = 4 * x + y;
+            const unsigned half = (tile.flip ? y : x) >> 1;
+            const unsigned entry =
+                half * 4 + ((subindexes >> texel) & 1) * 2 + ((negations >> texel) & 1);
+            texels[4 * y + x] = palette[entry];
+        }
+    }
+}
+
 } // namespace Pica::Texture
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <span>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
@@ -11,4 +12,10 @@ namespace Pica::Texture {
 
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all 16 texels of a 4x4 ETC1 subtile, which is much faster than sampling them one at a
+ * time. Texel (x, y) is written to texels[4 * y + x] with an alpha of 255.
+ */
+void DecodeETC1Subtile(u64 value, std::span<Common::Vec4<u8>, 16> texels);
+
 } // namespace Pica::Texture
@@ -134,11 +134,20 @@ void RoomJson::ClearPlayers() {
 }
 
 AnnounceMultiplayerRoom::RoomList RoomJson::GetRoomList() {
-    auto reply = client.GetJson("/lobby", true).returned_data;
-    if (reply.empty()) {
+    // The room list is only downloaded and parsed again when it changed since the last request
+    const auto result = client.GetJsonIfChanged("/lobby", true, lobby_etag);
+    if (result.result_string == "304") {
+        return lobby_rooms;
+    }
+    if (result.returned_data.empty()) {
+        lobby_etag.clear();
+        lobby_rooms.clear();
         return {};
     }
-    return nlohmann::json::parse(reply).at("rooms").get<AnnounceMultiplayerRoom::RoomList>();
+    lobby_rooms = nlohmann::json::parse(result.returned_data)
+                      .at("rooms")
+                      .get<AnnounceMultiplayerRoom::RoomList>();
+    return lobby_rooms;
 }
 
 void RoomJson::Delete() {
@@ -41,6 +41,8 @@ private:
     std::string username;
     std::string token;
     std::string room_id;
+    std::string lobby_etag;                       ///< ETag of the last received room list
+    AnnounceMultiplayerRoom::RoomList lobby_rooms; ///< The last received room list
 };
 
 } // namespace WebService
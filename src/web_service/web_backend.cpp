@@ -35,7 +35,7 @@ struct Client::Impl {
     /// A generic function handles POST, GET and DELETE request together
     Common::WebResult GenericRequest(const std::string& method, const std::string& path,
                                      const std::string& data, bool allow_anonymous,
-                                     const std::string& accept) {
+                                     const std::string& accept, std::string* etag = nullptr) {
         if (jwt.empty()) {
             UpdateJWT();
         }
@@ -46,11 +46,11 @@ struct Client::Impl {
                                      "Credentials needed"};
         }
 
-        auto result = GenericRequest(method, path, data, accept, jwt);
+        auto result = GenericRequest(method, path, data, accept, jwt, "", "", etag);
         if (result.result_string == "401") {
             // Try again with new JWT
             UpdateJWT();
-            result = GenericRequest(method, path, data, accept, jwt);
+            result = GenericRequest(method, path, data, accept, jwt, "", "", etag);
         }
 
         return result;
@@ -61,11 +61,13 @@ struct Client::Impl {
      * JWT is used if the jwt parameter is not empty
      * username + token is used if jwt is empty but username and token are
      * not empty anonymous if all of jwt, username and token are empty
+     * If etag is not null, the request is conditional on the ETag it holds and the ETag of the
+     * response is stored to it
      */
     Common::WebResult GenericRequest(const std::string& method, const std::string& path,
                                      const std::string& data, const std::string& accept,
                                      const std::string& jwt = "", const std::string& username = "",
-                                     const std::string& token = "") {
+                                     const std::string& token = "", std::string* etag = nullptr) {
         if (cli == nullptr) {
             cli = std::make_unique<httplib::Client>(host.c_str());
             cli->set_connection_timeout(TIMEOUT_SECONDS);
@@ -94,6 +96,9 @@ struct Client::Impl {
         if (method != "GET") {
             params.emplace(std::string("Content-Type"), std::string("application/json"));
         };
+        if (etag && !etag->empty()) {
+            params.emplace(std::string("If-None-Match"), *etag);
+        }
 
         httplib::Request request;
         request.method = method;
@@ -110,6 +115,10 @@ struct Client::Impl {
 
         httplib::Response response = result.value();
 
+        if (response.status == 304) {
+            return Common::WebResult{Common::WebResult::Code::Success, "304"};
+        }
+
         if (response.status >= 400) {
             LOG_ERROR(WebService, "{} to {} returned error status code: {}", method, host + path,
                       response.status);
@@ -129,6 +138,9 @@ struct Client::Impl {
                       content_type->second);
             return Common::WebResult{Common::WebResult::Code::WrongContent, "Wrong content"};
         }
+        if (etag) {
+            *etag = response.get_header_value("ETag");
+        }
         return Common::WebResult{Common::WebResult::Code::Success, "", response.body};
     }
 
@@ -178,6 +190,11 @@ Common::WebResult Client::GetJson(const std::string& path, bool allow_anonymous)
     return impl->GenericRequest("GET", path, "", allow_anonymous, "application/json");
 }
 
+Common::WebResult Client::GetJsonIfChanged(const std::string& path, bool allow_anonymous,
+                                           std::string& etag) {
+    return impl->GenericRequest("GET", path, "", allow_anonymous, "application/json", &etag);
+}
+
 Common::WebResult Client::DeleteJson(const std::string& path, const std::string& data,
                                      bool allow_anonymous) {
     return impl->GenericRequest("DELETE", path, data, allow_anonymous, "application/json");
@@ -36,6 +36,17 @@ public:
      */
     Common::WebResult GetJson(const std::string& path, bool allow_anonymous);
 
+    /**
+     * Gets JSON from the specified path if it changed since it was last fetched.
+     * @param path the URL segment after the host address.
+     * @param allow_anonymous If true, allow anonymous unauthenticated requests.
+     * @param etag The ETag of the last fetched JSON. Replaced by the ETag of the new JSON.
+     * @return the result of the request. Its result_string is "304" and it holds no data if the
+     * JSON did not change.
+     */
+    Common::WebResult GetJsonIfChanged(const std::string& path, bool allow_anonymous,
+                                       std::string& etag);
+
     /**
      * Deletes JSON to the specified path.
      * @param path the URL segment after the host address.